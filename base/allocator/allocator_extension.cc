@@ -24,6 +24,13 @@ void ReleaseFreeMemory() {
     release_free_memory_function();
 }
 
+bool SetMaxTotalThreadCacheBytes(size_t bytes) {
+  if (thunks::SetMaxTotalThreadCacheBytesFunction* function =
+          base::allocator::thunks::GetSetMaxTotalThreadCacheBytesFunction())
+    return function(bytes);
+  return false;
+}
+
 void SetGetStatsFunction(thunks::GetStatsFunction* get_stats_function) {
   DCHECK_EQ(base::allocator::thunks::GetGetStatsFunction(),
             reinterpret_cast<thunks::GetStatsFunction*>(NULL));
@@ -38,5 +45,13 @@ void SetReleaseFreeMemoryFunction(
       release_free_memory_function);
 }
 
+void SetSetMaxTotalThreadCacheBytesFunction(
+    thunks::SetMaxTotalThreadCacheBytesFunction* function) {
+  DCHECK_EQ(base::allocator::thunks::GetSetMaxTotalThreadCacheBytesFunction(),
+            reinterpret_cast<thunks::SetMaxTotalThreadCacheBytesFunction*>(
+                NULL));
+  base::allocator::thunks::SetSetMaxTotalThreadCacheBytesFunction(function);
+}
+
 }  // namespace allocator
 }  // namespace base
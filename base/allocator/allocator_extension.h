@@ -25,6 +25,12 @@ BASE_EXPORT void GetStats(char* buffer, int buffer_length);
 // system.
 BASE_EXPORT void ReleaseFreeMemory();
 
+// Request that the allocator cap the memory held by all of its per-thread
+// caches together at |bytes|. Processes with many busy threads can trade
+// memory for fewer trips to the central free lists, and idle ones the other
+// way round. Returns false if the allocator has no such setting.
+BASE_EXPORT bool SetMaxTotalThreadCacheBytes(size_t bytes);
+
 
 // These settings allow specifying a callback used to implement the allocator
 // extension functions.  These are optional, but if set they must only be set
@@ -39,6 +45,9 @@ BASE_EXPORT void SetGetStatsFunction(
 
 BASE_EXPORT void SetReleaseFreeMemoryFunction(
     thunks::ReleaseFreeMemoryFunction* release_free_memory_function);
+
+BASE_EXPORT void SetSetMaxTotalThreadCacheBytesFunction(
+    thunks::SetMaxTotalThreadCacheBytesFunction* function);
 }  // namespace allocator
 }  // namespace base
 
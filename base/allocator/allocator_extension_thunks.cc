@@ -19,6 +19,8 @@ namespace thunks {
 
 static GetStatsFunction* g_get_stats_function = NULL;
 static ReleaseFreeMemoryFunction* g_release_free_memory_function = NULL;
+static SetMaxTotalThreadCacheBytesFunction*
+    g_set_max_total_thread_cache_bytes_function = NULL;
 
 void SetGetStatsFunction(GetStatsFunction* get_stats_function) {
   g_get_stats_function = get_stats_function;
@@ -37,6 +39,15 @@ ReleaseFreeMemoryFunction* GetReleaseFreeMemoryFunction() {
   return g_release_free_memory_function;
 }
 
+void SetSetMaxTotalThreadCacheBytesFunction(
+    SetMaxTotalThreadCacheBytesFunction* function) {
+  g_set_max_total_thread_cache_bytes_function = function;
+}
+
+SetMaxTotalThreadCacheBytesFunction* GetSetMaxTotalThreadCacheBytesFunction() {
+  return g_set_max_total_thread_cache_bytes_function;
+}
+
 }  // namespace thunks
 }  // namespace allocator
 }  // namespace base
@@ -6,6 +6,8 @@
 #define BASE_ALLOCATOR_ALLOCATOR_THUNKS_EXTENSION_H
 #pragma once
 
+#include <stddef.h>  // for size_t
+
 namespace base {
 namespace allocator {
 namespace thunks {
@@ -23,6 +25,11 @@ void SetReleaseFreeMemoryFunction(
     ReleaseFreeMemoryFunction* release_free_memory_function);
 ReleaseFreeMemoryFunction* GetReleaseFreeMemoryFunction();
 
+typedef bool SetMaxTotalThreadCacheBytesFunction(size_t);
+void SetSetMaxTotalThreadCacheBytesFunction(
+    SetMaxTotalThreadCacheBytesFunction* function);
+SetMaxTotalThreadCacheBytesFunction* GetSetMaxTotalThreadCacheBytesFunction();
+
 }  // namespace thunks
 }  // namespace allocator
 }  // namespace base
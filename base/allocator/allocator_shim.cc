@@ -238,6 +238,11 @@ static void release_free_memory_thunk() {
   MallocExtension::instance()->ReleaseFreeMemory();
 }
 
+static bool set_max_total_thread_cache_bytes_thunk(size_t bytes) {
+  return MallocExtension::instance()->SetNumericProperty(
+      "tcmalloc.max_total_thread_cache_bytes", bytes);
+}
+
 // The CRT heap initialization stub.
 extern "C" int _heap_init() {
 #ifdef ENABLE_DYNAMIC_ALLOCATOR_SWITCHING
@@ -286,6 +291,8 @@ extern "C" int _heap_init() {
   base::allocator::thunks::SetGetStatsFunction(get_stats_thunk);
   base::allocator::thunks::SetReleaseFreeMemoryFunction(
       release_free_memory_thunk);
+  base::allocator::thunks::SetSetMaxTotalThreadCacheBytesFunction(
+      set_max_total_thread_cache_bytes_thunk);
 
   return 1;
 }
@@ -204,6 +204,7 @@
         'metrics/stats_table_unittest.cc',
         'observer_list_unittest.cc',
         'path_service_unittest.cc',
+        'pending_task_unittest.cc',
         'pickle_unittest.cc',
         'platform_file_unittest.cc',
         'pr_time_unittest.cc',
@@ -241,6 +242,7 @@
         'test/sequenced_worker_pool_owner.h',
         'test/trace_event_analyzer_unittest.cc',
         'threading/non_thread_safe_unittest.cc',
+        'threading/parallel_work_unittest.cc',
         'threading/platform_thread_unittest.cc',
         'threading/sequenced_worker_pool_unittest.cc',
         'threading/simple_thread_unittest.cc',
@@ -500,6 +502,20 @@
         },
       ],
     },
+    {
+      'target_name': 'base_perftests',
+      'type': 'executable',
+      'dependencies': [
+        'base',
+        'test_support_base',
+        'test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+      'sources': [
+        'threading/sequenced_worker_pool_perftest.cc',
+        'values_perftest.cc',
+      ],
+    },
     {
       'target_name': 'test_support_perf',
       'type': 'static_library',
@@ -265,6 +265,12 @@ class Callback<R(void)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run() const {
     PolymorphicInvoke f =
         reinterpret_cast<PolymorphicInvoke>(polymorphic_invoke_);
@@ -304,6 +310,12 @@ class Callback<R(A1)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1) const {
     PolymorphicInvoke f =
         reinterpret_cast<PolymorphicInvoke>(polymorphic_invoke_);
@@ -344,6 +356,12 @@ class Callback<R(A1, A2)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2) const {
     PolymorphicInvoke f =
@@ -387,6 +405,12 @@ class Callback<R(A1, A2, A3)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3) const {
@@ -433,6 +457,12 @@ class Callback<R(A1, A2, A3, A4)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3,
@@ -483,6 +513,12 @@ class Callback<R(A1, A2, A3, A4, A5)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3,
@@ -536,6 +572,12 @@ class Callback<R(A1, A2, A3, A4, A5, A6)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3,
@@ -592,6 +634,12 @@ class Callback<R(A1, A2, A3, A4, A5, A6, A7)> : public internal::CallbackBase {
     return CallbackBase::Equals(other);
   }
 
+  // Exchanges the callbacks of |this| and |other| without touching the
+  // reference counts of their bound state.
+  void Swap(Callback* other) {
+    CallbackBase::Swap(other);
+  }
+
   R Run(typename internal::CallbackParamTraits<A1>::ForwardType a1,
         typename internal::CallbackParamTraits<A2>::ForwardType a2,
         typename internal::CallbackParamTraits<A3>::ForwardType a3,
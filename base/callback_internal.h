@@ -53,6 +53,10 @@ class BASE_EXPORT CallbackBase {
   // Returns true if this callback equals |other|. |other| may be null.
   bool Equals(const CallbackBase& other) const;
 
+  // Exchanges the state of this callback and |other|. Only the derived
+  // Callback templates call this, so both sides always have the same type.
+  void Swap(CallbackBase* other);
+
   // Allow initializing of |bind_state_| via the constructor to avoid default
   // initialization of the scoped_refptr.  We do not also initialize
   // |polymorphic_invoke_| here because doing a normal assignment in the
@@ -123,6 +123,19 @@ TEST_F(CallbackTest, Reset) {
   EXPECT_TRUE(callback_a_.Equals(null_callback_));
 }
 
+TEST_F(CallbackTest, Swap) {
+  Callback<void(void)> callback_a2 = callback_a_;
+  Callback<void(void)> callback_c;
+  callback_c.Swap(&callback_a_);
+
+  EXPECT_TRUE(callback_a_.is_null());
+  EXPECT_TRUE(callback_c.Equals(callback_a2));
+
+  callback_c.Swap(&callback_a_);
+  EXPECT_TRUE(callback_c.is_null());
+  EXPECT_TRUE(callback_a_.Equals(callback_a2));
+}
+
 struct TestForReentrancy {
   TestForReentrancy()
       : cb_already_run(false),
@@ -5,6 +5,8 @@
 #include "base/debug/trace_event_impl.h"
 
 #include <algorithm>
+#include <deque>
+#include <map>
 
 #include "base/bind.h"
 #include "base/debug/trace_event.h"
@@ -42,6 +44,9 @@ namespace debug {
 // before throwing them away.
 const size_t kTraceEventBufferSize = 500000;
 const size_t kTraceEventBatchSize = 1000;
+// Number of trace events each thread buffers in the per-thread recording
+// modes.
+const size_t kTraceEventThreadBufferSize = 100000;
 
 #define TRACE_EVENT_MAX_CATEGORIES 100
 
@@ -112,6 +117,258 @@ void AppendValueAsJSON(unsigned char type,
   }
 }
 
+void AppendEventAsJSON(const char* category_name,
+                       int process_id,
+                       int thread_id,
+                       int64 time_int64,
+                       char phase,
+                       const char* name,
+                       const char* const* arg_names,
+                       const unsigned char* arg_types,
+                       const TraceEvent::TraceValue* arg_values,
+                       unsigned char flags,
+                       unsigned long long id,
+                       std::string* out) {
+  // Category name checked at category creation time.
+  DCHECK(!strchr(name, '"'));
+  StringAppendF(out,
+      "{\"cat\":\"%s\",\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64 ","
+      "\"ph\":\"%c\",\"name\":\"%s\",\"args\":{",
+      category_name,
+      process_id,
+      thread_id,
+      time_int64,
+      phase,
+      name);
+
+  // Output argument names and values, stop at first NULL argument name.
+  for (int i = 0; i < kTraceMaxNumArgs && arg_names[i]; ++i) {
+    if (i > 0)
+      *out += ",";
+    *out += "\"";
+    *out += arg_names[i];
+    *out += "\":";
+    AppendValueAsJSON(arg_types[i], arg_values[i], out);
+  }
+  *out += "}";
+
+  // If id is set, print it out as a hex string so we don't loose any
+  // bits (it might be a 64-bit pointer).
+  if (flags & TRACE_EVENT_FLAG_HAS_ID)
+    StringAppendF(out, ",\"id\":\"%" PRIx64 "\"", static_cast<uint64>(id));
+  *out += "}";
+}
+
+// Binary fragments start with this, which can never start a JSON fragment.
+const char kBinaryFragmentMagic[] = { '\0', 'T', 'E', '1' };
+
+// Strings are written once per binary fragment and then referred to by
+// index. A string reference is a varint holding one of these codes, or
+// kStringRefFirstIndex plus the index of a string written earlier.
+enum BinaryStringRef {
+  kStringRefNull = 0,
+  // Followed by the string; later references use its index.
+  kStringRefNewInterned = 1,
+  // Followed by the string, which is not referred to again. Used for strings
+  // copied into the event, since their address is unique to the event.
+  kStringRefInline = 2,
+  kStringRefFirstIndex = 3,
+};
+
+// Writes one binary fragment. Integers are LEB128 varints, signed ones
+// zigzag encoded; doubles are copied in host byte order since fragments never
+// leave the machine.
+class BinaryFragmentWriter {
+ public:
+  BinaryFragmentWriter(int process_id, std::string* out)
+      : out_(out),
+        last_timestamp_(0) {
+    out_->append(kBinaryFragmentMagic, sizeof(kBinaryFragmentMagic));
+    WriteSignedVarint(process_id);
+  }
+
+  void WriteByte(unsigned char value) {
+    out_->push_back(static_cast<char>(value));
+  }
+
+  void WriteVarint(uint64 value) {
+    while (value >= 0x80) {
+      out_->push_back(static_cast<char>((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out_->push_back(static_cast<char>(value));
+  }
+
+  void WriteSignedVarint(int64 value) {
+    WriteVarint((static_cast<uint64>(value) << 1) ^
+                static_cast<uint64>(value >> 63));
+  }
+
+  void WriteDouble(double value) {
+    out_->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  // Timestamps are written relative to the previous event's.
+  void WriteTimestamp(TimeTicks timestamp) {
+    int64 value = timestamp.ToInternalValue();
+    WriteSignedVarint(value - last_timestamp_);
+    last_timestamp_ = value;
+  }
+
+  // Writes a string that lives at a fixed address, such as a literal.
+  void WriteInternedString(const char* str) {
+    if (!str) {
+      WriteVarint(kStringRefNull);
+      return;
+    }
+    std::map<const char*, uint64>::const_iterator it = interned_.find(str);
+    if (it != interned_.end()) {
+      WriteVarint(kStringRefFirstIndex + it->second);
+      return;
+    }
+    uint64 index = interned_.size();
+    interned_[str] = index;
+    WriteVarint(kStringRefNewInterned);
+    WriteStringData(str);
+  }
+
+  void WriteInlineString(const char* str) {
+    if (!str) {
+      WriteVarint(kStringRefNull);
+      return;
+    }
+    WriteVarint(kStringRefInline);
+    WriteStringData(str);
+  }
+
+ private:
+  void WriteStringData(const char* str) {
+    size_t length = strlen(str);
+    WriteVarint(length);
+    out_->append(str, length);
+  }
+
+  std::string* out_;
+  std::map<const char*, uint64> interned_;
+  int64 last_timestamp_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryFragmentWriter);
+};
+
+// Reads a fragment written by BinaryFragmentWriter. Every read fails, rather
+// than overrunning, on truncated or corrupt input.
+class BinaryFragmentReader {
+ public:
+  explicit BinaryFragmentReader(const std::string& fragment)
+      : data_(fragment.data()),
+        end_(fragment.data() + fragment.size()),
+        last_timestamp_(0) {
+  }
+
+  bool ReadMagic() {
+    if (end_ - data_ < static_cast<ptrdiff_t>(sizeof(kBinaryFragmentMagic)) ||
+        memcmp(data_, kBinaryFragmentMagic, sizeof(kBinaryFragmentMagic)))
+      return false;
+    data_ += sizeof(kBinaryFragmentMagic);
+    return true;
+  }
+
+  bool AtEnd() const { return data_ == end_; }
+
+  bool ReadByte(unsigned char* value) {
+    if (data_ == end_)
+      return false;
+    *value = static_cast<unsigned char>(*data_++);
+    return true;
+  }
+
+  bool ReadVarint(uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      unsigned char byte;
+      if (!ReadByte(&byte))
+        return false;
+      *value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool ReadSignedVarint(int64* value) {
+    uint64 encoded;
+    if (!ReadVarint(&encoded))
+      return false;
+    *value = static_cast<int64>(encoded >> 1) ^ -static_cast<int64>(encoded & 1);
+    return true;
+  }
+
+  bool ReadDouble(double* value) {
+    if (end_ - data_ < static_cast<ptrdiff_t>(sizeof(*value)))
+      return false;
+    memcpy(value, data_, sizeof(*value));
+    data_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadTimestamp(int64* value) {
+    int64 delta;
+    if (!ReadSignedVarint(&delta))
+      return false;
+    last_timestamp_ += delta;
+    *value = last_timestamp_;
+    return true;
+  }
+
+  // Sets |*str| to NULL for a NULL string. Otherwise |*str| points either into
+  // the interned table or at |*inline_storage|, and stays valid while both do.
+  bool ReadString(const char** str, std::string* inline_storage) {
+    uint64 ref;
+    if (!ReadVarint(&ref))
+      return false;
+    switch (ref) {
+      case kStringRefNull:
+        *str = NULL;
+        return true;
+      case kStringRefNewInterned:
+        // A deque never moves its elements when growing.
+        interned_.push_back(std::string());
+        if (!ReadStringData(&interned_.back()))
+          return false;
+        *str = interned_.back().c_str();
+        return true;
+      case kStringRefInline:
+        if (!ReadStringData(inline_storage))
+          return false;
+        *str = inline_storage->c_str();
+        return true;
+      default:
+        if (ref - kStringRefFirstIndex >= interned_.size())
+          return false;
+        *str = interned_[ref - kStringRefFirstIndex].c_str();
+        return true;
+    }
+  }
+
+ private:
+  bool ReadStringData(std::string* str) {
+    uint64 length;
+    if (!ReadVarint(&length) ||
+        length > static_cast<uint64>(end_ - data_))
+      return false;
+    str->assign(data_, static_cast<size_t>(length));
+    data_ += length;
+    return true;
+  }
+
+  const char* data_;
+  const char* end_;
+  std::deque<std::string> interned_;
+  int64 last_timestamp_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryFragmentReader);
+};
+
 }  // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -235,36 +492,77 @@ void TraceEvent::AppendEventsAsJSON(const std::vector<TraceEvent>& events,
 }
 
 void TraceEvent::AppendAsJSON(std::string* out) const {
-  int64 time_int64 = timestamp_.ToInternalValue();
-  int process_id = TraceLog::GetInstance()->process_id();
-  // Category name checked at category creation time.
-  DCHECK(!strchr(name_, '"'));
-  StringAppendF(out,
-      "{\"cat\":\"%s\",\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64 ","
-      "\"ph\":\"%c\",\"name\":\"%s\",\"args\":{",
-      TraceLog::GetCategoryName(category_enabled_),
-      process_id,
-      thread_id_,
-      time_int64,
-      phase_,
-      name_);
+  AppendEventAsJSON(TraceLog::GetCategoryName(category_enabled_),
+                    TraceLog::GetInstance()->process_id(),
+                    thread_id_,
+                    timestamp_.ToInternalValue(),
+                    phase_,
+                    name_,
+                    arg_names_,
+                    arg_types_,
+                    arg_values_,
+                    flags_,
+                    id_,
+                    out);
+}
 
-  // Output argument names and values, stop at first NULL argument name.
-  for (int i = 0; i < kTraceMaxNumArgs && arg_names_[i]; ++i) {
-    if (i > 0)
-      *out += ",";
-    *out += "\"";
-    *out += arg_names_[i];
-    *out += "\":";
-    AppendValueAsJSON(arg_types_[i], arg_values_[i], out);
+void TraceEvent::AppendEventsAsBinary(const std::vector<TraceEvent>& events,
+                                      size_t start,
+                                      size_t count,
+                                      std::string* out) {
+  BinaryFragmentWriter writer(TraceLog::GetInstance()->process_id(), out);
+  for (size_t i = 0; i < count && start + i < events.size(); ++i) {
+    const TraceEvent& event = events[i + start];
+    // Strings copied into the event have an address unique to the event, so
+    // there is no point interning them.
+    bool copy = !!(event.flags_ & TRACE_EVENT_FLAG_COPY);
+    writer.WriteSignedVarint(event.thread_id_);
+    writer.WriteTimestamp(event.timestamp_);
+    writer.WriteByte(static_cast<unsigned char>(event.phase_));
+    writer.WriteByte(event.flags_);
+    writer.WriteInternedString(
+        TraceLog::GetCategoryName(event.category_enabled_));
+    if (copy)
+      writer.WriteInlineString(event.name_);
+    else
+      writer.WriteInternedString(event.name_);
+    if (event.flags_ & TRACE_EVENT_FLAG_HAS_ID)
+      writer.WriteVarint(event.id_);
+
+    int num_args = 0;
+    while (num_args < kTraceMaxNumArgs && event.arg_names_[num_args])
+      ++num_args;
+    writer.WriteByte(static_cast<unsigned char>(num_args));
+    for (int j = 0; j < num_args; ++j) {
+      if (copy)
+        writer.WriteInlineString(event.arg_names_[j]);
+      else
+        writer.WriteInternedString(event.arg_names_[j]);
+      const TraceValue& value = event.arg_values_[j];
+      writer.WriteByte(event.arg_types_[j]);
+      switch (event.arg_types_[j]) {
+        case TRACE_VALUE_TYPE_BOOL:
+          writer.WriteByte(value.as_bool ? 1 : 0);
+          break;
+        case TRACE_VALUE_TYPE_INT:
+          writer.WriteSignedVarint(value.as_int);
+          break;
+        case TRACE_VALUE_TYPE_DOUBLE:
+          writer.WriteDouble(value.as_double);
+          break;
+        case TRACE_VALUE_TYPE_STRING:
+          writer.WriteInternedString(value.as_string);
+          break;
+        case TRACE_VALUE_TYPE_COPY_STRING:
+          writer.WriteInlineString(value.as_string);
+          break;
+        default:
+          // Unsigned ints and pointers.
+          writer.WriteVarint(value.as_uint);
+          break;
+      }
+    }
   }
-  *out += "}";
-
-  // If id_ is set, print it out as a hex string so we don't loose any
-  // bits (it might be a 64-bit pointer).
-  if (flags_ & TRACE_EVENT_FLAG_HAS_ID)
-    StringAppendF(out, ",\"id\":\"%" PRIx64 "\"", static_cast<uint64>(id_));
-  *out += "}";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -300,6 +598,17 @@ void TraceResultBuffer::Start() {
 }
 
 void TraceResultBuffer::AddFragment(const std::string& trace_fragment) {
+  if (IsBinaryFragment(trace_fragment)) {
+    std::string json_fragment;
+    if (!AppendBinaryFragmentAsJSON(trace_fragment, &json_fragment)) {
+      DLOG(ERROR) << "Dropping malformed binary trace fragment";
+      return;
+    }
+    if (!json_fragment.empty())
+      AddFragment(json_fragment);
+    return;
+  }
+
   if (append_comma_)
     output_callback_.Run(",");
   append_comma_ = true;
@@ -310,12 +619,203 @@ void TraceResultBuffer::Finish() {
   output_callback_.Run("]");
 }
 
+// static
+bool TraceResultBuffer::IsBinaryFragment(const std::string& trace_fragment) {
+  return trace_fragment.size() >= sizeof(kBinaryFragmentMagic) &&
+      !memcmp(trace_fragment.data(), kBinaryFragmentMagic,
+              sizeof(kBinaryFragmentMagic));
+}
+
+// static
+bool TraceResultBuffer::AppendBinaryFragmentAsJSON(
+    const std::string& trace_fragment,
+    std::string* out) {
+  BinaryFragmentReader reader(trace_fragment);
+  int64 process_id;
+  if (!reader.ReadMagic() || !reader.ReadSignedVarint(&process_id))
+    return false;
+
+  // Backing store for strings that were copied into their event.
+  std::string name_storage;
+  std::string arg_name_storage[kTraceMaxNumArgs];
+  std::string arg_value_storage[kTraceMaxNumArgs];
+
+  bool first_event = true;
+  while (!reader.AtEnd()) {
+    int64 thread_id;
+    int64 timestamp;
+    unsigned char phase;
+    unsigned char flags;
+    const char* category_name;
+    const char* name;
+    uint64 id = 0;
+    unsigned char num_args;
+    if (!reader.ReadSignedVarint(&thread_id) ||
+        !reader.ReadTimestamp(&timestamp) ||
+        !reader.ReadByte(&phase) ||
+        !reader.ReadByte(&flags) ||
+        !reader.ReadString(&category_name, &name_storage) ||
+        !category_name ||
+        !reader.ReadString(&name, &name_storage) ||
+        !name ||
+        ((flags & TRACE_EVENT_FLAG_HAS_ID) && !reader.ReadVarint(&id)) ||
+        !reader.ReadByte(&num_args) ||
+        num_args > kTraceMaxNumArgs)
+      return false;
+
+    const char* arg_names[kTraceMaxNumArgs] = { NULL };
+    unsigned char arg_types[kTraceMaxNumArgs] = { 0 };
+    TraceEvent::TraceValue arg_values[kTraceMaxNumArgs];
+    memset(arg_values, 0, sizeof(arg_values));
+    for (int i = 0; i < num_args; ++i) {
+      if (!reader.ReadString(&arg_names[i], &arg_name_storage[i]) ||
+          !arg_names[i] ||
+          !reader.ReadByte(&arg_types[i]))
+        return false;
+      bool ok;
+      switch (arg_types[i]) {
+        case TRACE_VALUE_TYPE_BOOL: {
+          unsigned char value;
+          ok = reader.ReadByte(&value);
+          arg_values[i].as_bool = !!value;
+          break;
+        }
+        case TRACE_VALUE_TYPE_INT: {
+          int64 value;
+          ok = reader.ReadSignedVarint(&value);
+          arg_values[i].as_int = value;
+          break;
+        }
+        case TRACE_VALUE_TYPE_DOUBLE:
+          ok = reader.ReadDouble(&arg_values[i].as_double);
+          break;
+        case TRACE_VALUE_TYPE_STRING:
+        case TRACE_VALUE_TYPE_COPY_STRING:
+          ok = reader.ReadString(&arg_values[i].as_string,
+                                 &arg_value_storage[i]);
+          break;
+        case TRACE_VALUE_TYPE_UINT:
+        case TRACE_VALUE_TYPE_POINTER: {
+          uint64 value;
+          ok = reader.ReadVarint(&value);
+          arg_values[i].as_uint = value;
+          break;
+        }
+        default:
+          ok = false;
+          break;
+      }
+      if (!ok)
+        return false;
+    }
+
+    if (!first_event)
+      *out += ",";
+    first_event = false;
+    AppendEventAsJSON(category_name,
+                      static_cast<int>(process_id),
+                      static_cast<int>(thread_id),
+                      timestamp,
+                      static_cast<char>(phase),
+                      name,
+                      arg_names,
+                      arg_types,
+                      arg_values,
+                      flags,
+                      id,
+                      out);
+  }
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // TraceLog
 //
 ////////////////////////////////////////////////////////////////////////////////
 
+// Events of one thread in the per-thread recording modes. Only the owning
+// thread adds events, so |lock_| is contended only while flushing.
+class TraceLog::ThreadEventBuffer {
+ public:
+  ThreadEventBuffer() : first_sequence_number_(0), thread_exited_(false) {
+  }
+
+  // Adds |event| and returns its sequence number, or -1 if it was dropped.
+  // When |wrap| is set a full buffer drops its oldest event instead.
+  // |*became_full| is set if this event filled the buffer.
+  int AddEvent(const TraceEvent& event, bool wrap, bool* became_full) {
+    AutoLock lock(lock_);
+    *became_full = false;
+    if (events_.size() >= kTraceEventThreadBufferSize) {
+      if (!wrap)
+        return -1;
+      events_.pop_front();
+      ++first_sequence_number_;
+    }
+    events_.push_back(event);
+    *became_full = !wrap && events_.size() == kTraceEventThreadBufferSize;
+    uint64 sequence_number = first_sequence_number_ + events_.size() - 1;
+    if (sequence_number > static_cast<uint64>(kint32max))
+      return -1;
+    return static_cast<int>(sequence_number);
+  }
+
+  // Implements the threshold of TRACE_EVENT_IF_LONGER_THAN: returns true if
+  // the end event of the begin event |begin_sequence_number| should be added.
+  // It should not be if the begin event is no longer buffered, or if it was
+  // less than |threshold| before |now|, in which case it is removed.
+  bool ShouldAddEndEvent(int begin_sequence_number,
+                         TimeTicks now,
+                         TimeDelta threshold) {
+    AutoLock lock(lock_);
+    uint64 begin = static_cast<uint64>(begin_sequence_number);
+    if (begin < first_sequence_number_ ||
+        begin - first_sequence_number_ >= events_.size())
+      return false;
+    size_t begin_i = static_cast<size_t>(begin - first_sequence_number_);
+    if (now - events_[begin_i].timestamp() < threshold) {
+      // This will be expensive if there have been other events in the mean
+      // time (should be rare).
+      events_.erase(events_.begin() + begin_i);
+      return false;
+    }
+    return true;
+  }
+
+  // Moves the events recorded at or after |cutoff| to |events| and discards
+  // the rest.
+  void TakeEvents(TimeTicks cutoff, std::vector<TraceEvent>* events) {
+    AutoLock lock(lock_);
+    std::deque<TraceEvent>::iterator it = events_.begin();
+    // Events are added in timestamp order, bar the threshold erasures above.
+    while (it != events_.end() && it->timestamp() < cutoff)
+      ++it;
+    events->insert(events->end(), it, events_.end());
+    first_sequence_number_ += events_.size();
+    events_.clear();
+  }
+
+  size_t Size() {
+    AutoLock lock(lock_);
+    return events_.size();
+  }
+
+  // Set once the owning thread exits. Guarded by TraceLog::lock_.
+  bool thread_exited() const { return thread_exited_; }
+  void set_thread_exited() { thread_exited_ = true; }
+
+ private:
+  Lock lock_;
+  std::deque<TraceEvent> events_;
+  // Sequence number of events_.front(). Keeps increasing across flushes so
+  // that a stale begin id can never match a newer event.
+  uint64 first_sequence_number_;
+  bool thread_exited_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadEventBuffer);
+};
+
 // static
 TraceLog* TraceLog::GetInstance() {
   return Singleton<TraceLog, StaticMemorySingletonTraits<TraceLog> >::get();
@@ -323,6 +823,8 @@ TraceLog* TraceLog::GetInstance() {
 
 TraceLog::TraceLog()
     : enabled_(false)
+    , recording_mode_(RECORD_UNTIL_FULL)
+    , thread_event_buffer_(&TraceLog::OnThreadExit)
     , dispatching_to_observer_list_(false) {
   // Trace is enabled or disabled on one thread while other threads are
   // accessing the enabled flag. We don't care whether edge-case events are
@@ -343,6 +845,23 @@ TraceLog::TraceLog()
 }
 
 TraceLog::~TraceLog() {
+  // Threads that exit from now on must not call OnThreadExit().
+  thread_event_buffer_.Free();
+  STLDeleteElements(&thread_event_buffers_);
+}
+
+void TraceLog::SetRecordingMode(RecordingMode mode) {
+  AutoLock lock(lock_);
+  if (enabled_) {
+    DLOG(ERROR) << "Cannot change the recording mode during a trace.";
+    return;
+  }
+  recording_mode_ = mode;
+}
+
+void TraceLog::SetContinuousWindow(TimeDelta window) {
+  AutoLock lock(lock_);
+  continuous_window_ = window;
 }
 
 const unsigned char* TraceLog::GetCategoryEnabled(const char* name) {
@@ -535,7 +1054,24 @@ void TraceLog::RemoveEnabledStateObserver(
 }
 
 float TraceLog::GetBufferPercentFull() const {
-  return (float)((double)logged_events_.size()/(double)kTraceEventBufferSize);
+  switch (recording_mode_) {
+    case RECORD_UNTIL_FULL:
+      return (float)((double)logged_events_.size() /
+                     (double)kTraceEventBufferSize);
+    case RECORD_PER_THREAD_UNTIL_FULL: {
+      // Tracing has to stop when the fullest buffer fills up.
+      AutoLock lock(lock_);
+      size_t max_size = 0;
+      for (size_t i = 0; i < thread_event_buffers_.size(); ++i)
+        max_size = std::max(max_size, thread_event_buffers_[i]->Size());
+      return (float)((double)max_size / (double)kTraceEventThreadBufferSize);
+    }
+    case RECORD_CONTINUOUSLY:
+      // The rings never fill up.
+      return 0.0f;
+  }
+  NOTREACHED();
+  return 0.0f;
 }
 
 void TraceLog::SetOutputCallback(const TraceLog::OutputCallback& cb) {
@@ -551,10 +1087,22 @@ void TraceLog::SetBufferFullCallback(const TraceLog::BufferFullCallback& cb) {
 void TraceLog::Flush() {
   std::vector<TraceEvent> previous_logged_events;
   OutputCallback output_callback_copy;
+  bool binary;
   {
     AutoLock lock(lock_);
     previous_logged_events.swap(logged_events_);
     output_callback_copy = output_callback_;
+    binary = recording_mode_ != RECORD_UNTIL_FULL;
+    if (binary) {
+      TimeTicks cutoff;
+      if (recording_mode_ == RECORD_CONTINUOUSLY &&
+          continuous_window_ > TimeDelta()) {
+        cutoff = TimeTicks::NowFromSystemTraceTime() - continuous_window_;
+      }
+      for (size_t i = 0; i < thread_event_buffers_.size(); ++i)
+        thread_event_buffers_[i]->TakeEvents(cutoff, &previous_logged_events);
+      DeleteExitedThreadEventBuffers();
+    }
   }  // release lock
 
   if (output_callback_copy.is_null())
@@ -563,13 +1111,19 @@ void TraceLog::Flush() {
   for (size_t i = 0;
        i < previous_logged_events.size();
        i += kTraceEventBatchSize) {
-    scoped_refptr<RefCountedString> json_events_str_ptr =
-        new RefCountedString();
-    TraceEvent::AppendEventsAsJSON(previous_logged_events,
-                                   i,
-                                   kTraceEventBatchSize,
-                                   &(json_events_str_ptr->data()));
-    output_callback_copy.Run(json_events_str_ptr);
+    scoped_refptr<RefCountedString> events_str_ptr = new RefCountedString();
+    if (binary) {
+      TraceEvent::AppendEventsAsBinary(previous_logged_events,
+                                       i,
+                                       kTraceEventBatchSize,
+                                       &(events_str_ptr->data()));
+    } else {
+      TraceEvent::AppendEventsAsJSON(previous_logged_events,
+                                     i,
+                                     kTraceEventBatchSize,
+                                     &(events_str_ptr->data()));
+    }
+    output_callback_copy.Run(events_str_ptr);
   }
 }
 
@@ -586,6 +1140,23 @@ int TraceLog::AddTraceEvent(char phase,
                             unsigned char flags) {
   DCHECK(name);
   TimeTicks now = TimeTicks::NowFromSystemTraceTime();
+  if (recording_mode_ != RECORD_UNTIL_FULL) {
+    // The mode can only change while tracing is disabled, so this is racy
+    // only in the same benign way as the category enabled check.
+    if (!*category_enabled)
+      return -1;
+    int thread_id = static_cast<int>(PlatformThread::CurrentId());
+    UpdateThreadName(thread_id);
+    if (flags & TRACE_EVENT_FLAG_MANGLE_ID)
+      id ^= process_id_hash_;
+    return AddTraceEventToThreadBuffer(
+        TraceEvent(thread_id,
+                   now, phase, category_enabled, name, id,
+                   num_args, arg_names, arg_types, arg_values,
+                   flags),
+        threshold_begin_id, threshold);
+  }
+
   BufferFullCallback buffer_full_callback_copy;
   int ret_begin_id = -1;
   {
@@ -604,25 +1175,7 @@ int TraceLog::AddTraceEvent(char phase,
     // favor common case performance over corner case correctness.
     if (new_name != g_current_thread_name.Get().Get() &&
         new_name && *new_name) {
-      g_current_thread_name.Get().Set(new_name);
-      base::hash_map<int, std::string>::iterator existing_name =
-          thread_names_.find(thread_id);
-      if (existing_name == thread_names_.end()) {
-        // This is a new thread id, and a new name.
-        thread_names_[thread_id] = new_name;
-      } else {
-        // This is a thread id that we've seen before, but potentially with a
-        // new name.
-        std::vector<base::StringPiece> existing_names;
-        Tokenize(existing_name->second, ",", &existing_names);
-        bool found = std::find(existing_names.begin(),
-                               existing_names.end(),
-                               new_name) != existing_names.end();
-        if (!found) {
-          existing_name->second.push_back(',');
-          existing_name->second.append(new_name);
-        }
-      }
+      UpdateThreadNameLocked(thread_id, new_name);
     }
 
     if (threshold_begin_id > -1) {
@@ -663,6 +1216,106 @@ int TraceLog::AddTraceEvent(char phase,
   return ret_begin_id;
 }
 
+void TraceLog::UpdateThreadName(int thread_id) {
+  // See the comment in AddTraceEvent.
+  const char* new_name = PlatformThread::GetName();
+  if (new_name != g_current_thread_name.Get().Get() &&
+      new_name && *new_name) {
+    AutoLock lock(lock_);
+    UpdateThreadNameLocked(thread_id, new_name);
+  }
+}
+
+void TraceLog::UpdateThreadNameLocked(int thread_id, const char* new_name) {
+  lock_.AssertAcquired();
+  g_current_thread_name.Get().Set(new_name);
+  base::hash_map<int, std::string>::iterator existing_name =
+      thread_names_.find(thread_id);
+  if (existing_name == thread_names_.end()) {
+    // This is a new thread id, and a new name.
+    thread_names_[thread_id] = new_name;
+  } else {
+    // This is a thread id that we've seen before, but potentially with a
+    // new name.
+    std::vector<base::StringPiece> existing_names;
+    Tokenize(existing_name->second, ",", &existing_names);
+    bool found = std::find(existing_names.begin(),
+                           existing_names.end(),
+                           new_name) != existing_names.end();
+    if (!found) {
+      existing_name->second.push_back(',');
+      existing_name->second.append(new_name);
+    }
+  }
+}
+
+TraceLog::ThreadEventBuffer* TraceLog::GetThreadEventBuffer() {
+  ThreadEventBuffer* buffer =
+      static_cast<ThreadEventBuffer*>(thread_event_buffer_.Get());
+  if (!buffer) {
+    buffer = new ThreadEventBuffer;
+    {
+      AutoLock lock(lock_);
+      thread_event_buffers_.push_back(buffer);
+    }
+    thread_event_buffer_.Set(buffer);
+  }
+  return buffer;
+}
+
+// static
+void TraceLog::OnThreadExit(void* buffer) {
+  TraceLog* trace_log = GetInstance();
+  AutoLock lock(trace_log->lock_);
+  static_cast<ThreadEventBuffer*>(buffer)->set_thread_exited();
+  if (!static_cast<ThreadEventBuffer*>(buffer)->Size())
+    trace_log->DeleteExitedThreadEventBuffers();
+}
+
+void TraceLog::DeleteExitedThreadEventBuffers() {
+  lock_.AssertAcquired();
+  std::vector<ThreadEventBuffer*>::iterator it = thread_event_buffers_.begin();
+  while (it != thread_event_buffers_.end()) {
+    if ((*it)->thread_exited() && !(*it)->Size()) {
+      delete *it;
+      it = thread_event_buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t TraceLog::GetThreadEventBufferCount() const {
+  AutoLock lock(lock_);
+  return thread_event_buffers_.size();
+}
+
+int TraceLog::AddTraceEventToThreadBuffer(const TraceEvent& event,
+                                          int threshold_begin_id,
+                                          long long threshold) {
+  ThreadEventBuffer* buffer = GetThreadEventBuffer();
+  if (threshold_begin_id > -1) {
+    DCHECK(event.phase() == TRACE_EVENT_PHASE_END);
+    if (!buffer->ShouldAddEndEvent(threshold_begin_id, event.timestamp(),
+                                   TimeDelta::FromMicroseconds(threshold)))
+      return -1;
+  }
+
+  bool became_full;
+  int ret_begin_id = buffer->AddEvent(
+      event, recording_mode_ == RECORD_CONTINUOUSLY, &became_full);
+  if (became_full) {
+    BufferFullCallback buffer_full_callback_copy;
+    {
+      AutoLock lock(lock_);
+      buffer_full_callback_copy = buffer_full_callback_;
+    }
+    if (!buffer_full_callback_copy.is_null())
+      buffer_full_callback_copy.Run();
+  }
+  return ret_begin_id;
+}
+
 void TraceLog::AddTraceEventEtw(char phase,
                                 const char* name,
                                 const void* id,
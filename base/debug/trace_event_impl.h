@@ -18,6 +18,7 @@
 #include "base/observer_list.h"
 #include "base/string_util.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/timer.h"
 
 // Older style trace macros with explicit id and extra data
@@ -82,7 +83,16 @@ class BASE_EXPORT TraceEvent {
                                  std::string* out);
   void AppendAsJSON(std::string* out) const;
 
+  // Serialize event data to a self-contained binary fragment. Names are
+  // written once per fragment, so this is much cheaper than JSON. Use
+  // TraceResultBuffer to convert the fragment to JSON.
+  static void AppendEventsAsBinary(const std::vector<TraceEvent>& events,
+                                   size_t start,
+                                   size_t count,
+                                   std::string* out);
+
   TimeTicks timestamp() const { return timestamp_; }
+  char phase() const { return phase_; }
 
   // Exposed for unittesting:
 
@@ -147,6 +157,17 @@ class BASE_EXPORT TraceResultBuffer {
   // formatted output.
   void Finish();
 
+  // Returns true if |trace_fragment| was produced by one of the per-thread
+  // recording modes of TraceLog. AddFragment converts such fragments to JSON
+  // itself; other consumers must use AppendBinaryFragmentAsJSON.
+  static bool IsBinaryFragment(const std::string& trace_fragment);
+
+  // Appends the events of the binary |trace_fragment| to |out| as comma
+  // separated JSON objects, the same as a RECORD_UNTIL_FULL fragment would
+  // hold them. Returns false if the fragment is malformed.
+  static bool AppendBinaryFragmentAsJSON(const std::string& trace_fragment,
+                                         std::string* out);
+
  private:
   OutputCallback output_callback_;
   bool append_comma_;
@@ -155,8 +176,31 @@ class BASE_EXPORT TraceResultBuffer {
 
 class BASE_EXPORT TraceLog {
  public:
+  enum RecordingMode {
+    // All threads append to one buffer under a lock until it is full. The
+    // output callback receives JSON fragments.
+    RECORD_UNTIL_FULL,
+    // Each thread appends to its own fixed-size buffer until it is full, so
+    // threads never contend with each other. The output callback receives
+    // binary fragments.
+    RECORD_PER_THREAD_UNTIL_FULL,
+    // Like RECORD_PER_THREAD_UNTIL_FULL, but each buffer is a ring that keeps
+    // the most recent events of its thread, and the buffer full callback is
+    // never run. Use this to keep tracing on for post-mortem capture.
+    RECORD_CONTINUOUSLY,
+  };
+
   static TraceLog* GetInstance();
 
+  // Selects how events are buffered. Only takes effect while tracing is
+  // disabled; the mode can not change during a trace.
+  void SetRecordingMode(RecordingMode mode);
+  RecordingMode recording_mode() const { return recording_mode_; }
+
+  // In RECORD_CONTINUOUSLY mode, only events recorded within |window| of the
+  // flush are output. A zero window outputs everything still in the rings.
+  void SetContinuousWindow(TimeDelta window);
+
   // Get set of known categories. This can change as new code paths are reached.
   // The known categories are inserted into |categories|.
   void GetKnownCategories(std::vector<std::string>* categories);
@@ -237,7 +281,8 @@ class BASE_EXPORT TraceLog {
   static const char* GetCategoryName(const unsigned char* category_enabled);
 
   // Called by TRACE_EVENT* macros, don't call this directly.
-  // Returns the index in the internal vector of the event if it was added, or
+  // Returns the index in the internal vector (or the sequence number in the
+  //         current thread's buffer) of the event if it was added, or
   //         -1 if the event was not added.
   // On end events, the return value of the begin event can be specified along
   // with a threshold in microseconds. If the elapsed time between begin and end
@@ -274,13 +319,18 @@ class BASE_EXPORT TraceLog {
   // Allows resurrecting our singleton instance post-AtExit processing.
   static void Resurrect();
 
-  // Allow tests to inspect TraceEvents.
+  // Allow tests to inspect TraceEvents. Only events recorded in
+  // RECORD_UNTIL_FULL mode can be inspected.
   size_t GetEventsSize() const { return logged_events_.size(); }
   const TraceEvent& GetEventAt(size_t index) const {
     DCHECK(index < logged_events_.size());
     return logged_events_[index];
   }
 
+  // Returns the number of per-thread buffers, including those of threads
+  // that exited and whose events have yet to be flushed.
+  size_t GetThreadEventBufferCount() const;
+
   void SetProcessID(int process_id);
 
  private:
@@ -288,16 +338,39 @@ class BASE_EXPORT TraceLog {
   // by the Singleton class.
   friend struct StaticMemorySingletonTraits<TraceLog>;
 
+  class ThreadEventBuffer;
+
   TraceLog();
   ~TraceLog();
   const unsigned char* GetCategoryEnabledInternal(const char* name);
+  // Records the name of the calling thread if it changed since its last
+  // event. Takes |lock_| only when it did.
+  void UpdateThreadName(int thread_id);
+  void UpdateThreadNameLocked(int thread_id, const char* new_name);
+  // Returns the calling thread's buffer, creating it on first use.
+  ThreadEventBuffer* GetThreadEventBuffer();
+  // Called as a thread with a buffer exits. Deletes the buffer, or leaves
+  // that to the next Flush() if it still holds events.
+  static void OnThreadExit(void* buffer);
+  // Deletes the buffers of exited threads. Requires |lock_|.
+  void DeleteExitedThreadEventBuffers();
+  int AddTraceEventToThreadBuffer(const TraceEvent& event,
+                                  int threshold_begin_id,
+                                  long long threshold);
   void AddThreadNameMetadataEvents();
   void AddClockSyncMetadataEvents();
 
-  // TODO(nduca): switch to per-thread trace buffers to reduce thread
-  // synchronization.
-  Lock lock_;
+  // Guards everything but the per-thread buffers, which have their own locks
+  // so that threads recording events do not contend with each other.
+  mutable Lock lock_;
   bool enabled_;
+  RecordingMode recording_mode_;
+  TimeDelta continuous_window_;
+  // Holds the calling thread's ThreadEventBuffer, and calls OnThreadExit()
+  // for it as the thread exits.
+  ThreadLocalStorage::Slot thread_event_buffer_;
+  // Owned; buffers outlive their threads until their events are flushed.
+  std::vector<ThreadEventBuffer*> thread_event_buffers_;
   OutputCallback output_callback_;
   BufferFullCallback buffer_full_callback_;
   std::vector<TraceEvent> logged_events_;
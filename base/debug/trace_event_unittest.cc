@@ -4,6 +4,8 @@
 
 #include "base/debug/trace_event.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/json/json_reader.h"
@@ -1370,5 +1372,200 @@ TEST_F(TraceEventTestFixture, TraceResultBuffer) {
   EXPECT_STREQ(json_output_.json_output.c_str(), "[bla1,bla2,bla3,bla4]");
 }
 
+// Test that binary fragments convert to exactly the JSON that the events
+// would have been flushed as, and that malformed fragments are rejected.
+TEST_F(TraceEventTestFixture, BinaryFragment) {
+  ManualTestSetUp();
+
+  const unsigned char* category = TraceLog::GetCategoryEnabled("cat");
+  std::string copied_value("copied \"value\"");
+  const char* arg_names[] = { "arg1", "arg2" };
+  unsigned char arg_types[2];
+  unsigned long long arg_values[2];
+  std::vector<TraceEvent> events;
+
+  trace_event_internal::SetTraceValue(-42, &arg_types[0], &arg_values[0]);
+  trace_event_internal::SetTraceValue(1.5, &arg_types[1], &arg_values[1]);
+  events.push_back(TraceEvent(1, TimeTicks::FromInternalValue(1000),
+                              TRACE_EVENT_PHASE_BEGIN, category, "name1",
+                              trace_event_internal::kNoEventId,
+                              2, arg_names, arg_types, arg_values,
+                              TRACE_EVENT_FLAG_NONE));
+  trace_event_internal::SetTraceValue("value", &arg_types[0], &arg_values[0]);
+  trace_event_internal::SetTraceValue(copied_value, &arg_types[1],
+                                      &arg_values[1]);
+  events.push_back(TraceEvent(2, TimeTicks::FromInternalValue(900),
+                              TRACE_EVENT_PHASE_INSTANT, category, "name2",
+                              0x1234567890ull,
+                              2, arg_names, arg_types, arg_values,
+                              TRACE_EVENT_FLAG_HAS_ID | TRACE_EVENT_FLAG_COPY));
+  trace_event_internal::SetTraceValue(true, &arg_types[0], &arg_values[0]);
+  events.push_back(TraceEvent(1, TimeTicks::FromInternalValue(2000),
+                              TRACE_EVENT_PHASE_END, category, "name1",
+                              trace_event_internal::kNoEventId,
+                              1, arg_names, arg_types, arg_values,
+                              TRACE_EVENT_FLAG_NONE));
+
+  std::string json;
+  TraceEvent::AppendEventsAsJSON(events, 0, events.size(), &json);
+  std::string binary;
+  TraceEvent::AppendEventsAsBinary(events, 0, events.size(), &binary);
+  EXPECT_TRUE(TraceResultBuffer::IsBinaryFragment(binary));
+  EXPECT_FALSE(TraceResultBuffer::IsBinaryFragment(json));
+  EXPECT_LT(binary.size(), json.size());
+
+  std::string converted;
+  EXPECT_TRUE(TraceResultBuffer::AppendBinaryFragmentAsJSON(binary,
+                                                            &converted));
+  EXPECT_EQ(json, converted);
+
+  converted.clear();
+  EXPECT_FALSE(TraceResultBuffer::AppendBinaryFragmentAsJSON(
+      binary.substr(0, binary.size() - 1), &converted));
+}
+
+// Test that the per-thread recording mode captures the same data.
+TEST_F(TraceEventTestFixture, PerThreadDataCaptured) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetRecordingMode(
+      TraceLog::RECORD_PER_THREAD_UNTIL_FULL);
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  TraceWithAllMacroVariants(NULL);
+
+  TraceLog::GetInstance()->SetEnabled(false);
+  ValidateAllTraceMacrosCreatedData(trace_parsed_);
+}
+
+// Test that the per-thread recording mode gathers data from every thread.
+TEST_F(TraceEventTestFixture, PerThreadDataCapturedManyThreads) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetRecordingMode(
+      TraceLog::RECORD_PER_THREAD_UNTIL_FULL);
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  const int num_threads = 4;
+  const int num_events = 4000;
+  Thread* threads[num_threads];
+  WaitableEvent* task_complete_events[num_threads];
+  for (int i = 0; i < num_threads; i++) {
+    threads[i] = new Thread(StringPrintf("Thread %d", i).c_str());
+    task_complete_events[i] = new WaitableEvent(false, false);
+    threads[i]->Start();
+    threads[i]->message_loop()->PostTask(
+        FROM_HERE, base::Bind(&TraceManyInstantEvents,
+                              i, num_events, task_complete_events[i]));
+  }
+
+  for (int i = 0; i < num_threads; i++) {
+    task_complete_events[i]->Wait();
+  }
+
+  for (int i = 0; i < num_threads; i++) {
+    threads[i]->Stop();
+    delete threads[i];
+    delete task_complete_events[i];
+  }
+
+  TraceLog::GetInstance()->SetEnabled(false);
+
+  ValidateInstantEventPresentOnEveryThread(trace_parsed_,
+                                           num_threads, num_events);
+  EXPECT_TRUE(FindNamePhaseKeyValue("thread_name", "M", "name", "Thread 0"));
+}
+
+// Test that the buffers of threads that have exited are kept until their
+// events are flushed, and then deleted.
+TEST_F(TraceEventTestFixture, PerThreadBuffersOfExitedThreads) {
+  ManualTestSetUp();
+  TraceLog* trace_log = TraceLog::GetInstance();
+  trace_log->SetRecordingMode(TraceLog::RECORD_PER_THREAD_UNTIL_FULL);
+  trace_log->SetEnabled(true);
+  size_t buffer_count = trace_log->GetThreadEventBufferCount();
+
+  const int num_threads = 4;
+  const int num_events = 10;
+  for (int i = 0; i < num_threads; i++) {
+    Thread thread(StringPrintf("Thread %d", i).c_str());
+    WaitableEvent task_complete_event(false, false);
+    thread.Start();
+    thread.message_loop()->PostTask(
+        FROM_HERE, base::Bind(&TraceManyInstantEvents,
+                              i, num_events, &task_complete_event));
+    task_complete_event.Wait();
+    thread.Stop();
+  }
+  EXPECT_EQ(buffer_count + num_threads,
+            trace_log->GetThreadEventBufferCount());
+
+  trace_log->SetEnabled(false);
+  ValidateInstantEventPresentOnEveryThread(trace_parsed_,
+                                           num_threads, num_events);
+  EXPECT_GE(buffer_count, trace_log->GetThreadEventBufferCount());
+}
+
+// Test that the recording mode can not change during a trace.
+TEST_F(TraceEventTestFixture, RecordingModeFixedWhileEnabled) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetEnabled(true);
+  TraceLog::GetInstance()->SetRecordingMode(TraceLog::RECORD_CONTINUOUSLY);
+  EXPECT_EQ(TraceLog::RECORD_UNTIL_FULL,
+            TraceLog::GetInstance()->recording_mode());
+  TraceLog::GetInstance()->SetEnabled(false);
+
+  TraceLog::GetInstance()->SetRecordingMode(TraceLog::RECORD_CONTINUOUSLY);
+  EXPECT_EQ(TraceLog::RECORD_CONTINUOUSLY,
+            TraceLog::GetInstance()->recording_mode());
+}
+
+// Test that continuous mode keeps the most recent events once a thread's
+// buffer wraps, and never reports the buffer as full.
+TEST_F(TraceEventTestFixture, ContinuousModeKeepsMostRecentEvents) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetRecordingMode(TraceLog::RECORD_CONTINUOUSLY);
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  const int num_events = 150000;
+  TraceManyInstantEvents(0, num_events, NULL);
+  EXPECT_EQ(0.0f, TraceLog::GetInstance()->GetBufferPercentFull());
+
+  TraceLog::GetInstance()->SetEnabled(false);
+
+  int first_event = num_events;
+  int last_event = -1;
+  size_t count = 0;
+  for (size_t i = 0; i < trace_parsed_.GetSize(); i++) {
+    DictionaryValue* dict = NULL;
+    int event = 0;
+    if (trace_parsed_.GetDictionary(i, &dict) &&
+        dict->GetInteger("args.event", &event)) {
+      first_event = std::min(first_event, event);
+      last_event = std::max(last_event, event);
+      ++count;
+    }
+  }
+  EXPECT_GT(first_event, 0);
+  EXPECT_EQ(num_events - 1, last_event);
+  EXPECT_EQ(static_cast<size_t>(num_events - first_event), count);
+}
+
+// Test that continuous mode only outputs the events within the window.
+TEST_F(TraceEventTestFixture, ContinuousModeWindow) {
+  ManualTestSetUp();
+  TraceLog::GetInstance()->SetRecordingMode(TraceLog::RECORD_CONTINUOUSLY);
+  TraceLog::GetInstance()->SetContinuousWindow(
+      TimeDelta::FromMilliseconds(100));
+  TraceLog::GetInstance()->SetEnabled(true);
+
+  TRACE_EVENT_INSTANT0("all", "before window");
+  PlatformThread::Sleep(TimeDelta::FromMilliseconds(300));
+  TRACE_EVENT_INSTANT0("all", "in window");
+
+  TraceLog::GetInstance()->SetEnabled(false);
+
+  EXPECT_FALSE(FindTraceEntry(trace_parsed_, "before window"));
+  EXPECT_TRUE(FindTraceEntry(trace_parsed_, "in window"));
+}
+
 }  // namespace debug
 }  // namespace base
@@ -92,7 +92,8 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate,
   // Called for each event coming from the watch. |fired_watch| identifies the
   // watch that fired, |child| indicates what has changed, and is relative to
   // the currently watched path for |fired_watch|. The flag |created| is true if
-  // the object appears.
+  // the object appears. Events are queued, and delivered together on the
+  // |message_loop_| thread.
   void OnFilePathChanged(InotifyReader::Watch fired_watch,
                          const FilePath::StringType& child,
                          bool created);
@@ -132,6 +133,36 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate,
   };
   typedef std::vector<WatchEntry> WatchVector;
 
+  // An event queued by OnFilePathChanged().
+  struct PendingChange {
+    PendingChange(InotifyReader::Watch fired_watch,
+                  const FilePath::StringType& child,
+                  bool created)
+        : fired_watch(fired_watch),
+          child(child),
+          created(created) {}
+
+    bool operator==(const PendingChange& other) const {
+      return fired_watch == other.fired_watch && child == other.child &&
+          created == other.created;
+    }
+
+    InotifyReader::Watch fired_watch;
+    FilePath::StringType child;
+    bool created;
+  };
+  typedef std::vector<PendingChange> PendingChangeVector;
+
+  // Handles the events queued since the last call, and notifies |delegate_|
+  // at most once for all of them.
+  void DeliverPendingChanges();
+
+  // Handles one event. Sets |*target_changed| if |delegate_| must be notified
+  // of a change to |target_|. Returns false if the watches could not be
+  // updated.
+  bool HandleChange(const PendingChange& change,
+                    bool* target_changed) WARN_UNUSED_RESULT;
+
   // Reconfigure to watch for the most specific parent directory of |target_|
   // that exists. Updates |watched_path_|. Returns true on success.
   bool UpdateWatches() WARN_UNUSED_RESULT;
@@ -147,6 +178,14 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate,
   // |target_| and always stores an empty next component name in |subdir_|.
   WatchVector watches_;
 
+  // Events from the inotify reader thread not delivered yet. An event that is
+  // already queued is not queued again, so a burst of writes to one file is
+  // reported once.
+  PendingChangeVector pending_changes_;
+
+  // Lock to protect pending_changes_.
+  base::Lock pending_changes_lock_;
+
   DISALLOW_COPY_AND_ASSIGN(FilePathWatcherImpl);
 };
 
@@ -301,23 +340,49 @@ FilePathWatcherImpl::FilePathWatcherImpl()
 void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
                                             const FilePath::StringType& child,
                                             bool created) {
-  if (!message_loop()->BelongsToCurrentThread()) {
+  PendingChange change(fired_watch, child, created);
+  base::AutoLock auto_lock(pending_changes_lock_);
+  if (std::find(pending_changes_.begin(), pending_changes_.end(), change) !=
+      pending_changes_.end()) {
+    return;
+  }
+  pending_changes_.push_back(change);
+  if (pending_changes_.size() == 1) {
     // Switch to message_loop_ to access watches_ safely.
     message_loop()->PostTask(FROM_HERE,
-        base::Bind(&FilePathWatcherImpl::OnFilePathChanged,
-                   this,
-                   fired_watch,
-                   child,
-                   created));
-    return;
+        base::Bind(&FilePathWatcherImpl::DeliverPendingChanges, this));
   }
+}
 
+void FilePathWatcherImpl::DeliverPendingChanges() {
   DCHECK(MessageLoopForIO::current());
 
+  PendingChangeVector changes;
+  {
+    base::AutoLock auto_lock(pending_changes_lock_);
+    changes.swap(pending_changes_);
+  }
+
+  bool target_changed = false;
+  for (PendingChangeVector::const_iterator change = changes.begin();
+       change != changes.end(); ++change) {
+    if (!HandleChange(*change, &target_changed)) {
+      delegate_->OnFilePathError(target_);
+      return;
+    }
+  }
+  if (target_changed)
+    delegate_->OnFilePathChanged(target_);
+}
+
+bool FilePathWatcherImpl::HandleChange(const PendingChange& change,
+                                       bool* target_changed) {
+  const FilePath::StringType& child = change.child;
+
   // Find the entry in |watches_| that corresponds to |fired_watch|.
   WatchVector::const_iterator watch_entry(watches_.begin());
   for ( ; watch_entry != watches_.end(); ++watch_entry) {
-    if (fired_watch == watch_entry->watch_) {
+    if (change.fired_watch == watch_entry->watch_) {
       // Check whether a path component of |target_| changed.
       bool change_on_target_path = child.empty() ||
           ((child == watch_entry->subdir_) && watch_entry->linkname_.empty()) ||
@@ -326,7 +391,7 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
       // Check whether the change references |target_| or a direct child.
       DCHECK(watch_entry->subdir_.empty() ||
           (watch_entry + 1) != watches_.end());
-      bool target_changed =
+      bool target_or_child_changed =
           (watch_entry->subdir_.empty() && (child == watch_entry->linkname_)) ||
           (watch_entry->subdir_.empty() && watch_entry->linkname_.empty()) ||
           (watch_entry->subdir_ == child && (watch_entry + 1)->subdir_.empty());
@@ -337,10 +402,8 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
       // as changes to symlinks on the target path will not have
       // IN_ISDIR set in the event masks. As a result we may sometimes
       // call UpdateWatches() unnecessarily.
-      if (change_on_target_path && !UpdateWatches()) {
-        delegate_->OnFilePathError(target_);
-        return;
-      }
+      if (change_on_target_path && !UpdateWatches())
+        return false;
 
       // Report the following events:
       //  - The target or a direct child of the target got changed (in case the
@@ -350,14 +413,15 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
       //  - One of the parent directories appears. The event corresponding to
       //    the target appearing might have been missed in this case, so
       //    recheck.
-      if (target_changed ||
-          (change_on_target_path && !created) ||
+      if (target_or_child_changed ||
+          (change_on_target_path && !change.created) ||
           (change_on_target_path && file_util::PathExists(target_))) {
-        delegate_->OnFilePathChanged(target_);
-        return;
+        *target_changed = true;
+        return true;
       }
     }
   }
+  return true;
 }
 
 bool FilePathWatcherImpl::Watch(const FilePath& path,
@@ -4,6 +4,8 @@
 
 #include "base/json/json_reader.h"
 
+#include <vector>
+
 #include "base/float_util.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -81,6 +83,119 @@ const char* JSONReader::kUnsupportedEncoding =
     "Unsupported encoding. JSON must be UTF-8.";
 const char* JSONReader::kUnquotedDictionaryKey =
     "Dictionary keys must be quoted.";
+const char* JSONReader::kParseAborted =
+    "Parsing aborted.";
+
+namespace {
+
+// Assembles the events reported by JSONReader::Parse() into a Value tree.
+// The members of each dictionary are collected and handed to it in one batch
+// when the dictionary ends, so large objects with unsorted keys are not built
+// one sorted insert at a time.
+class ValueBuilder : public JSONReader::Visitor {
+ public:
+  ValueBuilder() {}
+  virtual ~ValueBuilder() {
+    for (size_t i = 0; i < members_.size(); ++i)
+      delete members_[i].second;
+  }
+
+  // Returns the root of the parsed document. The caller owns the result.
+  Value* TakeRoot() { return root_.release(); }
+
+  virtual bool OnNull() OVERRIDE {
+    return AddValue(Value::CreateNullValue());
+  }
+
+  virtual bool OnBoolean(bool value) OVERRIDE {
+    return AddValue(Value::CreateBooleanValue(value));
+  }
+
+  virtual bool OnInteger(int value) OVERRIDE {
+    return AddValue(Value::CreateIntegerValue(value));
+  }
+
+  virtual bool OnDouble(double value) OVERRIDE {
+    return AddValue(Value::CreateDoubleValue(value));
+  }
+
+  virtual bool OnString(const std::string& value) OVERRIDE {
+    return AddValue(Value::CreateStringValue(value));
+  }
+
+  virtual bool OnListBegin() OVERRIDE {
+    ListValue* list = new ListValue;
+    AddValue(list);
+    containers_.push_back(list);
+    return true;
+  }
+
+  virtual bool OnListEnd() OVERRIDE {
+    containers_.pop_back();
+    return true;
+  }
+
+  virtual bool OnDictionaryBegin() OVERRIDE {
+    DictionaryValue* dictionary = new DictionaryValue;
+    AddValue(dictionary);
+    containers_.push_back(dictionary);
+    members_begin_.push_back(members_.size());
+    return true;
+  }
+
+  virtual bool OnDictionaryKey(const std::string& key) OVERRIDE {
+    key_ = key;
+    return true;
+  }
+
+  virtual bool OnDictionaryEnd() OVERRIDE {
+    // The members of the innermost dictionary are always at the end of
+    // |members_|, after those of the dictionaries that enclose it.
+    DictionaryValue::Entries entries(
+        members_.begin() + members_begin_.back(), members_.end());
+    members_.resize(members_begin_.back());
+    members_begin_.pop_back();
+    static_cast<DictionaryValue*>(containers_.back())->
+        SetEntriesWithoutPathExpansion(&entries);
+    containers_.pop_back();
+    return true;
+  }
+
+ private:
+  // Stores |value| in the innermost open container, or as the root.
+  bool AddValue(Value* value) {
+    if (containers_.empty()) {
+      DCHECK(!root_.get());
+      root_.reset(value);
+    } else if (containers_.back()->IsType(Value::TYPE_LIST)) {
+      static_cast<ListValue*>(containers_.back())->Append(value);
+    } else {
+      members_.push_back(DictionaryValue::Entry(key_, value));
+    }
+    return true;
+  }
+
+  scoped_ptr<Value> root_;
+
+  // The lists and dictionaries that are still being filled, innermost last.
+  // They are owned by |root_| or by |members_|.
+  std::vector<Value*> containers_;
+
+  // The key of the dictionary member whose value comes next.
+  std::string key_;
+
+  // The members parsed so far for all the open dictionaries, which are not
+  // in their dictionary yet and are owned here.
+  DictionaryValue::Entries members_;
+
+  // For each open dictionary, innermost last, the index in |members_| of its
+  // first member.
+  std::vector<size_t> members_begin_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValueBuilder);
+};
+
+}  // namespace
 
 JSONReader::JSONReader()
     : start_pos_(NULL),
@@ -143,6 +258,8 @@ std::string JSONReader::ErrorCodeToString(JsonParseError error_code) {
       return kUnsupportedEncoding;
     case JSON_UNQUOTED_DICTIONARY_KEY:
       return kUnquotedDictionaryKey;
+    case JSON_PARSE_ABORTED:
+      return kParseAborted;
     default:
       NOTREACHED();
       return std::string();
@@ -156,10 +273,18 @@ std::string JSONReader::GetErrorMessage() const {
 
 Value* JSONReader::JsonToValue(const std::string& json, bool check_root,
                                bool allow_trailing_comma) {
+  ValueBuilder builder;
+  if (!Parse(json, check_root, allow_trailing_comma, &builder))
+    return NULL;
+  return builder.TakeRoot();
+}
+
+bool JSONReader::Parse(const std::string& json, bool check_root,
+                       bool allow_trailing_comma, Visitor* visitor) {
   // The input must be in UTF-8.
   if (!IsStringUTF8(json.data())) {
     error_code_ = JSON_UNSUPPORTED_ENCODING;
-    return NULL;
+    return false;
   }
 
   start_pos_ = json.data();
@@ -167,7 +292,7 @@ Value* JSONReader::JsonToValue(const std::string& json, bool check_root,
 
   // When the input JSON string starts with a UTF-8 Byte-Order-Mark (U+FEFF)
   // or <0xEF 0xBB 0xBF>, advance the start position to avoid the
-  // JSONReader::BuildValue() function from mis-treating a Unicode BOM as an
+  // JSONReader::ParseValue() function from mis-treating a Unicode BOM as an
   // invalid character and returning NULL.
   if (json.size() >= 3 && static_cast<uint8>(start_pos_[0]) == 0xEF &&
       static_cast<uint8>(start_pos_[1]) == 0xBB &&
@@ -180,10 +305,9 @@ Value* JSONReader::JsonToValue(const std::string& json, bool check_root,
   stack_depth_ = 0;
   error_code_ = JSON_NO_ERROR;
 
-  scoped_ptr<Value> root(BuildValue(check_root));
-  if (root.get()) {
+  if (ParseValue(check_root, visitor)) {
     if (ParseToken().type == Token::END_OF_INPUT) {
-      return root.release();
+      return true;
     } else {
       SetErrorCode(JSON_UNEXPECTED_DATA_AFTER_ROOT, json_pos_);
     }
@@ -193,7 +317,7 @@ Value* JSONReader::JsonToValue(const std::string& json, bool check_root,
   if (error_code_ == 0)
     SetErrorCode(JSON_SYNTAX_ERROR, json_pos_);
 
-  return NULL;
+  return false;
 }
 
 // static
@@ -206,11 +330,11 @@ std::string JSONReader::FormatErrorMessage(int line, int column,
   return description;
 }
 
-Value* JSONReader::BuildValue(bool is_root) {
+bool JSONReader::ParseValue(bool is_root, Visitor* visitor) {
   ++stack_depth_;
   if (stack_depth_ > kStackLimit) {
     SetErrorCode(JSON_TOO_MUCH_NESTING, json_pos_);
-    return NULL;
+    return false;
   }
 
   Token token = ParseToken();
@@ -218,51 +342,55 @@ Value* JSONReader::BuildValue(bool is_root) {
   if (is_root && token.type != Token::OBJECT_BEGIN &&
       token.type != Token::ARRAY_BEGIN) {
     SetErrorCode(JSON_BAD_ROOT_ELEMENT_TYPE, json_pos_);
-    return NULL;
+    return false;
   }
 
-  scoped_ptr<Value> node;
-
   switch (token.type) {
     case Token::END_OF_INPUT:
     case Token::INVALID_TOKEN:
-      return NULL;
+      return false;
 
     case Token::NULL_TOKEN:
-      node.reset(Value::CreateNullValue());
+      if (!visitor->OnNull())
+        return AbortParse();
       break;
 
     case Token::BOOL_TRUE:
-      node.reset(Value::CreateBooleanValue(true));
+      if (!visitor->OnBoolean(true))
+        return AbortParse();
       break;
 
     case Token::BOOL_FALSE:
-      node.reset(Value::CreateBooleanValue(false));
+      if (!visitor->OnBoolean(false))
+        return AbortParse();
       break;
 
     case Token::NUMBER:
-      node.reset(DecodeNumber(token));
-      if (!node.get())
-        return NULL;
+      if (!DecodeNumber(token, visitor))
+        return false;
       break;
 
     case Token::STRING:
-      node.reset(DecodeString(token));
-      if (!node.get())
-        return NULL;
-      break;
+      {
+        std::string decoded_str;
+        if (!DecodeString(token, &decoded_str))
+          return false;
+        if (!visitor->OnString(decoded_str))
+          return AbortParse();
+        break;
+      }
 
     case Token::ARRAY_BEGIN:
       {
+        if (!visitor->OnListBegin())
+          return AbortParse();
+
         json_pos_ += token.length;
         token = ParseToken();
 
-        node.reset(new ListValue());
         while (token.type != Token::ARRAY_END) {
-          Value* array_node = BuildValue(false);
-          if (!array_node)
-            return NULL;
-          static_cast<ListValue*>(node.get())->Append(array_node);
+          if (!ParseValue(false, visitor))
+            return false;
 
           // After a list value, we expect a comma or the end of the list.
           token = ParseToken();
@@ -274,54 +402,51 @@ Value* JSONReader::BuildValue(bool is_root) {
             if (token.type == Token::ARRAY_END) {
               if (!allow_trailing_comma_) {
                 SetErrorCode(JSON_TRAILING_COMMA, json_pos_);
-                return NULL;
+                return false;
               }
               // Trailing comma OK, stop parsing the Array.
               break;
             }
           } else if (token.type != Token::ARRAY_END) {
             // Unexpected value after list value.  Bail out.
-            return NULL;
+            return false;
           }
         }
         if (token.type != Token::ARRAY_END) {
-          return NULL;
+          return false;
         }
+        if (!visitor->OnListEnd())
+          return AbortParse();
         break;
       }
 
     case Token::OBJECT_BEGIN:
       {
+        if (!visitor->OnDictionaryBegin())
+          return AbortParse();
+
         json_pos_ += token.length;
         token = ParseToken();
 
-        node.reset(new DictionaryValue);
+        std::string dict_key;
         while (token.type != Token::OBJECT_END) {
           if (token.type != Token::STRING) {
             SetErrorCode(JSON_UNQUOTED_DICTIONARY_KEY, json_pos_);
-            return NULL;
+            return false;
           }
-          scoped_ptr<Value> dict_key_value(DecodeString(token));
-          if (!dict_key_value.get())
-            return NULL;
-
-          // Convert the key into a wstring.
-          std::string dict_key;
-          bool success = dict_key_value->GetAsString(&dict_key);
-          DCHECK(success);
+          if (!DecodeString(token, &dict_key))
+            return false;
+          if (!visitor->OnDictionaryKey(dict_key))
+            return AbortParse();
 
           json_pos_ += token.length;
           token = ParseToken();
           if (token.type != Token::OBJECT_PAIR_SEPARATOR)
-            return NULL;
+            return false;
 
           json_pos_ += token.length;
-          token = ParseToken();
-          Value* dict_value = BuildValue(false);
-          if (!dict_value)
-            return NULL;
-          static_cast<DictionaryValue*>(node.get())->SetWithoutPathExpansion(
-              dict_key, dict_value);
+          if (!ParseValue(false, visitor))
+            return false;
 
           // After a key/value pair, we expect a comma or the end of the
           // object.
@@ -334,30 +459,37 @@ Value* JSONReader::BuildValue(bool is_root) {
             if (token.type == Token::OBJECT_END) {
               if (!allow_trailing_comma_) {
                 SetErrorCode(JSON_TRAILING_COMMA, json_pos_);
-                return NULL;
+                return false;
               }
               // Trailing comma OK, stop parsing the Object.
               break;
             }
           } else if (token.type != Token::OBJECT_END) {
             // Unexpected value after last object value.  Bail out.
-            return NULL;
+            return false;
           }
         }
         if (token.type != Token::OBJECT_END)
-          return NULL;
+          return false;
+        if (!visitor->OnDictionaryEnd())
+          return AbortParse();
 
         break;
       }
 
     default:
       // We got a token that's not a value.
-      return NULL;
+      return false;
   }
   json_pos_ += token.length;
 
   --stack_depth_;
-  return node.release();
+  return true;
+}
+
+bool JSONReader::AbortParse() {
+  SetErrorCode(JSON_PARSE_ABORTED, json_pos_);
+  return false;
 }
 
 JSONReader::Token JSONReader::ParseNumberToken() {
@@ -397,18 +529,24 @@ JSONReader::Token JSONReader::ParseNumberToken() {
   return token;
 }
 
-Value* JSONReader::DecodeNumber(const Token& token) {
+bool JSONReader::DecodeNumber(const Token& token, Visitor* visitor) {
   const std::string num_string(token.begin, token.length);
 
   int num_int;
-  if (StringToInt(num_string, &num_int))
-    return Value::CreateIntegerValue(num_int);
+  if (StringToInt(num_string, &num_int)) {
+    if (!visitor->OnInteger(num_int))
+      return AbortParse();
+    return true;
+  }
 
   double num_double;
-  if (StringToDouble(num_string, &num_double) && base::IsFinite(num_double))
-    return Value::CreateDoubleValue(num_double);
+  if (StringToDouble(num_string, &num_double) && base::IsFinite(num_double)) {
+    if (!visitor->OnDouble(num_double))
+      return AbortParse();
+    return true;
+  }
 
-  return NULL;
+  return false;
 }
 
 JSONReader::Token JSONReader::ParseStringToken() {
@@ -456,9 +594,9 @@ JSONReader::Token JSONReader::ParseStringToken() {
   return Token::CreateInvalidToken();
 }
 
-Value* JSONReader::DecodeString(const Token& token) {
-  std::string decoded_str;
-  decoded_str.reserve(token.length - 2);
+bool JSONReader::DecodeString(const Token& token, std::string* decoded_str) {
+  decoded_str->clear();
+  decoded_str->reserve(token.length - 2);
 
   for (int i = 1; i < token.length - 1; ++i) {
     char c = *(token.begin + i);
@@ -469,54 +607,54 @@ Value* JSONReader::DecodeString(const Token& token) {
         case '"':
         case '/':
         case '\\':
-          decoded_str.push_back(c);
+          decoded_str->push_back(c);
           break;
         case 'b':
-          decoded_str.push_back('\b');
+          decoded_str->push_back('\b');
           break;
         case 'f':
-          decoded_str.push_back('\f');
+          decoded_str->push_back('\f');
           break;
         case 'n':
-          decoded_str.push_back('\n');
+          decoded_str->push_back('\n');
           break;
         case 'r':
-          decoded_str.push_back('\r');
+          decoded_str->push_back('\r');
           break;
         case 't':
-          decoded_str.push_back('\t');
+          decoded_str->push_back('\t');
           break;
         case 'v':
-          decoded_str.push_back('\v');
+          decoded_str->push_back('\v');
           break;
 
         case 'x': {
           if (i + 2 >= token.length)
-            return NULL;
+            return false;
           int hex_digit = 0;
           if (!HexStringToInt(StringPiece(token.begin + i + 1, 2), &hex_digit))
-            return NULL;
-          decoded_str.push_back(hex_digit);
+            return false;
+          decoded_str->push_back(hex_digit);
           i += 2;
           break;
         }
         case 'u':
-          if (!ConvertUTF16Units(token, &i, &decoded_str))
-            return NULL;
+          if (!ConvertUTF16Units(token, &i, decoded_str))
+            return false;
           break;
 
         default:
           // We should only have valid strings at this point.  If not,
           // ParseStringToken didn't do its job.
           NOTREACHED();
-          return NULL;
+          return false;
       }
     } else {
       // Not escaped
-      decoded_str.push_back(c);
+      decoded_str->push_back(c);
     }
   }
-  return Value::CreateStringValue(decoded_str);
+  return true;
 }
 
 bool JSONReader::ConvertUTF16Units(const Token& token,
@@ -3,7 +3,9 @@
 // found in the LICENSE file.
 //
 // A JSON parser.  Converts strings of JSON into a Value object (see
-// base/values.h).
+// base/values.h), or reports the parse as a stream of events to a
+// JSONReader::Visitor so callers can consume the data without building a
+// Value tree.
 // http://www.ietf.org/rfc/rfc4627.txt?number=4627
 //
 // Known limitations/deviations from the RFC:
@@ -101,6 +103,30 @@ class BASE_EXPORT JSONReader {
     int length;
   };
 
+  // Receives the parse events for a document from JSONReader::Parse(), in
+  // document order. Each method returns false to stop parsing, in which case
+  // Parse() fails with JSON_PARSE_ABORTED.
+  class BASE_EXPORT Visitor {
+   public:
+    virtual ~Visitor() {}
+
+    virtual bool OnNull() = 0;
+    virtual bool OnBoolean(bool value) = 0;
+    virtual bool OnInteger(int value) = 0;
+    virtual bool OnDouble(double value) = 0;
+    virtual bool OnString(const std::string& value) = 0;
+
+    // The elements of a list are reported between these two calls.
+    virtual bool OnListBegin() = 0;
+    virtual bool OnListEnd() = 0;
+
+    // Each member of a dictionary is reported as an OnDictionaryKey() call
+    // followed by the events for its value.
+    virtual bool OnDictionaryBegin() = 0;
+    virtual bool OnDictionaryKey(const std::string& key) = 0;
+    virtual bool OnDictionaryEnd() = 0;
+  };
+
   // Error codes during parsing.
   enum JsonParseError {
     JSON_NO_ERROR = 0,
@@ -112,6 +138,7 @@ class BASE_EXPORT JSONReader {
     JSON_UNEXPECTED_DATA_AFTER_ROOT,
     JSON_UNSUPPORTED_ENCODING,
     JSON_UNQUOTED_DICTIONARY_KEY,
+    JSON_PARSE_ABORTED,
   };
 
   // String versions of parse error codes.
@@ -123,6 +150,7 @@ class BASE_EXPORT JSONReader {
   static const char* kUnexpectedDataAfterRoot;
   static const char* kUnsupportedEncoding;
   static const char* kUnquotedDictionaryKey;
+  static const char* kParseAborted;
 
   JSONReader();
 
@@ -148,7 +176,8 @@ class BASE_EXPORT JSONReader {
   // Returns an empty string if error_code is JSON_NO_ERROR.
   static std::string ErrorCodeToString(JsonParseError error_code);
 
-  // Returns the error code if the last call to JsonToValue() failed.
+  // Returns the error code if the last call to JsonToValue() or Parse()
+  // failed.
   // Returns JSON_NO_ERROR otherwise.
   JsonParseError error_code() const { return error_code_; }
 
@@ -166,17 +195,30 @@ class BASE_EXPORT JSONReader {
   Value* JsonToValue(const std::string& json, bool check_root,
                      bool allow_trailing_comma);
 
+  // Parses |json| with the same grammar and checks as JsonToValue(), but
+  // reports the document to |visitor| instead of building a Value. Returns
+  // false on error, in which case error_code() and GetErrorMessage() describe
+  // the failure. |visitor| may have received events for a prefix of the
+  // document before the failure.
+  bool Parse(const std::string& json, bool check_root,
+             bool allow_trailing_comma, Visitor* visitor);
+
  private:
   FRIEND_TEST_ALL_PREFIXES(JSONReaderTest, Reading);
   FRIEND_TEST_ALL_PREFIXES(JSONReaderTest, ErrorMessages);
+  FRIEND_TEST_ALL_PREFIXES(JSONReaderTest, VisitorAbort);
 
   static std::string FormatErrorMessage(int line, int column,
                                         const std::string& description);
 
-  // Recursively build Value.  Returns NULL if we don't have a valid JSON
-  // string.  If |is_root| is true, we verify that the root element is either
-  // an object or an array.
-  Value* BuildValue(bool is_root);
+  // Recursively parses a value, reporting it to |visitor|.  Returns false if
+  // we don't have a valid JSON string or the visitor stopped the parse.  If
+  // |is_root| is true, we verify that the root element is either an object or
+  // an array.
+  bool ParseValue(bool is_root, Visitor* visitor);
+
+  // Records that |visitor| asked to stop parsing. Always returns false.
+  bool AbortParse();
 
   // Parses a sequence of characters into a Token::NUMBER. If the sequence of
   // characters is not a valid number, returns a Token::INVALID_TOKEN. Note
@@ -185,8 +227,9 @@ class BASE_EXPORT JSONReader {
   Token ParseNumberToken();
 
   // Try and convert the substring that token holds into an int or a double. If
-  // we can (ie., no overflow), return the value, else return NULL.
-  Value* DecodeNumber(const Token& token);
+  // we can (ie., no overflow), report the value to |visitor| and return the
+  // visitor's result, else return false.
+  bool DecodeNumber(const Token& token, Visitor* visitor);
 
   // Parses a sequence of characters into a Token::STRING. If the sequence of
   // characters is not a valid string, returns a Token::INVALID_TOKEN. Note
@@ -194,9 +237,9 @@ class BASE_EXPORT JSONReader {
   // actual wstring.
   Token ParseStringToken();
 
-  // Convert the substring into a value string.  This should always succeed
+  // Convert the substring into |decoded_str|.  This should always succeed
   // (otherwise ParseStringToken would have failed).
-  Value* DecodeString(const Token& token);
+  bool DecodeString(const Token& token, std::string* decoded_str);
 
   // Helper function for DecodeString that consumes UTF16 [0,2] code units and
   // convers them to UTF8 code untis.  |token| is the string token in which the
@@ -242,7 +285,8 @@ class BASE_EXPORT JSONReader {
   // A parser flag that allows trailing commas in objects and arrays.
   bool allow_trailing_comma_;
 
-  // Contains the error code for the last call to JsonToValue(), if any.
+  // Contains the error code for the last call to JsonToValue() or Parse(), if
+  // any.
   JsonParseError error_code_;
   int error_line_;
   int error_col_;
@@ -8,6 +8,7 @@
 #include "base/file_util.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/path_service.h"
+#include "base/string_number_conversions.h"
 #include "base/string_piece.h"
 #include "base/utf_string_conversions.h"
 #include "base/values.h"
@@ -16,6 +17,74 @@
 
 namespace base {
 
+namespace {
+
+// Records the events it receives as a compact string, and optionally stops
+// the parse at the first string value.
+class RecordingVisitor : public JSONReader::Visitor {
+ public:
+  explicit RecordingVisitor(bool abort_on_string)
+      : abort_on_string_(abort_on_string) {}
+
+  const std::string& events() const { return events_; }
+
+  virtual bool OnNull() OVERRIDE {
+    events_ += "n ";
+    return true;
+  }
+
+  virtual bool OnBoolean(bool value) OVERRIDE {
+    events_ += value ? "t " : "f ";
+    return true;
+  }
+
+  virtual bool OnInteger(int value) OVERRIDE {
+    events_ += "i" + IntToString(value) + " ";
+    return true;
+  }
+
+  virtual bool OnDouble(double value) OVERRIDE {
+    events_ += "d" + DoubleToString(value) + " ";
+    return true;
+  }
+
+  virtual bool OnString(const std::string& value) OVERRIDE {
+    events_ += "s" + value + " ";
+    return !abort_on_string_;
+  }
+
+  virtual bool OnListBegin() OVERRIDE {
+    events_ += "[ ";
+    return true;
+  }
+
+  virtual bool OnListEnd() OVERRIDE {
+    events_ += "] ";
+    return true;
+  }
+
+  virtual bool OnDictionaryBegin() OVERRIDE {
+    events_ += "{ ";
+    return true;
+  }
+
+  virtual bool OnDictionaryKey(const std::string& key) OVERRIDE {
+    events_ += "k" + key + " ";
+    return true;
+  }
+
+  virtual bool OnDictionaryEnd() OVERRIDE {
+    events_ += "} ";
+    return true;
+  }
+
+ private:
+  bool abort_on_string_;
+  std::string events_;
+};
+
+}  // namespace
+
 TEST(JSONReaderTest, Reading) {
   // some whitespace checking
   scoped_ptr<Value> root;
@@ -607,4 +676,72 @@ TEST(JSONReaderTest, ErrorMessages) {
   EXPECT_EQ(JSONReader::JSON_INVALID_ESCAPE, error_code);
 }
 
+TEST(JSONReaderTest, UnsortedDictionaryKeys) {
+  // Keys come out of order, with a nested object between them and a repeated
+  // key, whose last value is the one kept.
+  scoped_ptr<Value> root(JSONReader::Read(
+      "{\"c\": 1, \"a\": {\"z\": 2, \"y\": [{\"q\": 3, \"p\": 4}]},"
+      " \"b\": 5, \"c\": 6}"));
+  ASSERT_TRUE(root.get());
+  ASSERT_TRUE(root->IsType(Value::TYPE_DICTIONARY));
+  DictionaryValue* dict = static_cast<DictionaryValue*>(root.get());
+
+  std::string keys;
+  for (DictionaryValue::key_iterator it = dict->begin_keys();
+       it != dict->end_keys(); ++it) {
+    keys += *it;
+  }
+  EXPECT_EQ("abc", keys);
+
+  int value = 0;
+  EXPECT_TRUE(dict->GetInteger("c", &value));
+  EXPECT_EQ(6, value);
+  EXPECT_TRUE(dict->GetInteger("b", &value));
+  EXPECT_EQ(5, value);
+  EXPECT_TRUE(dict->GetInteger("a.z", &value));
+  EXPECT_EQ(2, value);
+  ListValue* list = NULL;
+  ASSERT_TRUE(dict->GetList("a.y", &list));
+  DictionaryValue* inner = NULL;
+  ASSERT_TRUE(list->GetDictionary(0, &inner));
+  EXPECT_EQ(2U, inner->size());
+  EXPECT_TRUE(inner->GetInteger("p", &value));
+  EXPECT_EQ(4, value);
+
+  // A document that fails part way through frees what was parsed of it.
+  root.reset(JSONReader::Read("{\"b\": {\"a\": [1, {\"c\": 2}], \"d\": }"));
+  EXPECT_FALSE(root.get());
+}
+
+TEST(JSONReaderTest, Visitor) {
+  JSONReader reader;
+  RecordingVisitor visitor(false);
+  EXPECT_TRUE(reader.Parse(
+      "{\"a\": [1, 2.5, true, false, null], \"b\\n\": {\"c\": \"x\\ty\"},}",
+      false, true, &visitor));
+  EXPECT_EQ("{ ka [ i1 d2.5 t f n ] kb\n { kc sx\ty } } ", visitor.events());
+  EXPECT_EQ(JSONReader::JSON_NO_ERROR, reader.error_code());
+
+  // Errors are reported as for JsonToValue().
+  RecordingVisitor trailing_comma_visitor(false);
+  EXPECT_FALSE(reader.Parse("[1,]", false, false, &trailing_comma_visitor));
+  EXPECT_EQ(JSONReader::JSON_TRAILING_COMMA, reader.error_code());
+  EXPECT_EQ("[ i1 ", trailing_comma_visitor.events());
+
+  RecordingVisitor root_visitor(false);
+  EXPECT_FALSE(reader.Parse("1", true, false, &root_visitor));
+  EXPECT_EQ(JSONReader::JSON_BAD_ROOT_ELEMENT_TYPE, reader.error_code());
+  EXPECT_EQ("", root_visitor.events());
+}
+
+TEST(JSONReaderTest, VisitorAbort) {
+  JSONReader reader;
+  RecordingVisitor visitor(true);
+  EXPECT_FALSE(reader.Parse("[1, \"stop\", 2]", false, false, &visitor));
+  EXPECT_EQ("[ i1 sstop ", visitor.events());
+  EXPECT_EQ(JSONReader::JSON_PARSE_ABORTED, reader.error_code());
+  EXPECT_EQ(JSONReader::FormatErrorMessage(1, 5, JSONReader::kParseAborted),
+            reader.GetErrorMessage());
+}
+
 }  // namespace base
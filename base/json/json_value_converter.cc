@@ -0,0 +1,241 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_value_converter.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Appends the value it builds to a list.
+class ListElementBuilder : public ValueBuildingHandler {
+ public:
+  explicit ListElementBuilder(ListValue* list) : list_(list) {}
+
+ protected:
+  virtual bool OnValue(Value* value) OVERRIDE {
+    list_->Append(value);
+    return true;
+  }
+
+ private:
+  ListValue* list_;
+  DISALLOW_COPY_AND_ASSIGN(ListElementBuilder);
+};
+
+// Stores the value it builds as a member of a dictionary.
+class DictionaryMemberBuilder : public ValueBuildingHandler {
+ public:
+  DictionaryMemberBuilder(DictionaryValue* dictionary, const std::string& key)
+      : dictionary_(dictionary),
+        key_(key) {
+  }
+
+ protected:
+  virtual bool OnValue(Value* value) OVERRIDE {
+    dictionary_->SetWithoutPathExpansion(key_, value);
+    return true;
+  }
+
+ private:
+  DictionaryValue* dictionary_;
+  std::string key_;
+  DISALLOW_COPY_AND_ASSIGN(DictionaryMemberBuilder);
+};
+
+}  // namespace
+
+bool ValueHandler::OnNull() {
+  return false;
+}
+
+bool ValueHandler::OnBoolean(bool value) {
+  return false;
+}
+
+bool ValueHandler::OnInteger(int value) {
+  return false;
+}
+
+bool ValueHandler::OnDouble(double value) {
+  return false;
+}
+
+bool ValueHandler::OnString(const std::string& value) {
+  return false;
+}
+
+bool ValueHandler::OnListBegin() {
+  return false;
+}
+
+ValueHandler* ValueHandler::CreateElementHandler() {
+  NOTREACHED();
+  return NULL;
+}
+
+bool ValueHandler::OnListEnd() {
+  NOTREACHED();
+  return false;
+}
+
+bool ValueHandler::OnDictionaryBegin() {
+  return false;
+}
+
+ValueHandler* ValueHandler::CreateMemberHandler(const std::string& key) {
+  NOTREACHED();
+  return NULL;
+}
+
+bool ValueHandler::OnDictionaryEnd() {
+  NOTREACHED();
+  return false;
+}
+
+ValueBuildingHandler::ValueBuildingHandler() {
+}
+
+ValueBuildingHandler::~ValueBuildingHandler() {
+}
+
+bool ValueBuildingHandler::OnNull() {
+  return OnValue(Value::CreateNullValue());
+}
+
+bool ValueBuildingHandler::OnBoolean(bool value) {
+  return OnValue(Value::CreateBooleanValue(value));
+}
+
+bool ValueBuildingHandler::OnInteger(int value) {
+  return OnValue(Value::CreateIntegerValue(value));
+}
+
+bool ValueBuildingHandler::OnDouble(double value) {
+  return OnValue(Value::CreateDoubleValue(value));
+}
+
+bool ValueBuildingHandler::OnString(const std::string& value) {
+  return OnValue(Value::CreateStringValue(value));
+}
+
+bool ValueBuildingHandler::OnListBegin() {
+  container_.reset(new ListValue);
+  return true;
+}
+
+ValueHandler* ValueBuildingHandler::CreateElementHandler() {
+  DCHECK(container_.get() && container_->IsType(Value::TYPE_LIST));
+  return new ListElementBuilder(static_cast<ListValue*>(container_.get()));
+}
+
+bool ValueBuildingHandler::OnListEnd() {
+  return OnValue(container_.release());
+}
+
+bool ValueBuildingHandler::OnDictionaryBegin() {
+  container_.reset(new DictionaryValue);
+  return true;
+}
+
+ValueHandler* ValueBuildingHandler::CreateMemberHandler(
+    const std::string& key) {
+  DCHECK(container_.get() && container_->IsType(Value::TYPE_DICTIONARY));
+  return new DictionaryMemberBuilder(
+      static_cast<DictionaryValue*>(container_.get()), key);
+}
+
+bool ValueBuildingHandler::OnDictionaryEnd() {
+  return OnValue(container_.release());
+}
+
+ValueHandlerVisitor::ValueHandlerVisitor(ValueHandler* root)
+    : root_(root) {
+}
+
+ValueHandlerVisitor::~ValueHandlerVisitor() {
+  while (!containers_.empty())
+    delete PopContainer();
+}
+
+bool ValueHandlerVisitor::OnNull() {
+  scoped_ptr<ValueHandler> handler(TakeNextHandler());
+  return !handler.get() || handler->OnNull();
+}
+
+bool ValueHandlerVisitor::OnBoolean(bool value) {
+  scoped_ptr<ValueHandler> handler(TakeNextHandler());
+  return !handler.get() || handler->OnBoolean(value);
+}
+
+bool ValueHandlerVisitor::OnInteger(int value) {
+  scoped_ptr<ValueHandler> handler(TakeNextHandler());
+  return !handler.get() || handler->OnInteger(value);
+}
+
+bool ValueHandlerVisitor::OnDouble(double value) {
+  scoped_ptr<ValueHandler> handler(TakeNextHandler());
+  return !handler.get() || handler->OnDouble(value);
+}
+
+bool ValueHandlerVisitor::OnString(const std::string& value) {
+  scoped_ptr<ValueHandler> handler(TakeNextHandler());
+  return !handler.get() || handler->OnString(value);
+}
+
+bool ValueHandlerVisitor::OnListBegin() {
+  scoped_ptr<ValueHandler> handler(TakeNextHandler());
+  if (handler.get() && !handler->OnListBegin())
+    return false;
+  Container container = { handler.release(), true };
+  containers_.push_back(container);
+  return true;
+}
+
+bool ValueHandlerVisitor::OnListEnd() {
+  scoped_ptr<ValueHandler> handler(PopContainer());
+  return !handler.get() || handler->OnListEnd();
+}
+
+bool ValueHandlerVisitor::OnDictionaryBegin() {
+  scoped_ptr<ValueHandler> handler(TakeNextHandler());
+  if (handler.get() && !handler->OnDictionaryBegin())
+    return false;
+  Container container = { handler.release(), false };
+  containers_.push_back(container);
+  return true;
+}
+
+bool ValueHandlerVisitor::OnDictionaryKey(const std::string& key) {
+  DCHECK(!containers_.empty() && !containers_.back().is_list);
+  ValueHandler* dictionary_handler = containers_.back().handler;
+  member_handler_.reset(
+      dictionary_handler ? dictionary_handler->CreateMemberHandler(key) : NULL);
+  return true;
+}
+
+bool ValueHandlerVisitor::OnDictionaryEnd() {
+  scoped_ptr<ValueHandler> handler(PopContainer());
+  return !handler.get() || handler->OnDictionaryEnd();
+}
+
+ValueHandler* ValueHandlerVisitor::TakeNextHandler() {
+  if (containers_.empty())
+    return root_.release();
+  const Container& container = containers_.back();
+  if (!container.is_list)
+    return member_handler_.release();
+  return container.handler ? container.handler->CreateElementHandler() : NULL;
+}
+
+ValueHandler* ValueHandlerVisitor::PopContainer() {
+  DCHECK(!containers_.empty());
+  ValueHandler* handler = containers_.back().handler;
+  containers_.pop_back();
+  return handler;
+}
+
+}  // namespace internal
+}  // namespace base
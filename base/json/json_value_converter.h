@@ -9,13 +9,16 @@
 #include <string>
 #include <vector>
 
+#include "base/base_export.h"
 #include "base/basictypes.h"
+#include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/stl_util.h"
 #include "base/string16.h"
 #include "base/string_piece.h"
+#include "base/utf_string_conversions.h"
 #include "base/values.h"
 
 // JSONValueConverter converts a JSON value into a C++ struct in a
@@ -47,6 +50,13 @@
 //   JSONValueConverter<Message> converter;
 //   converter.Convert(json, &message);
 //
+// When the message comes as JSON text, ConvertJSON() fills |message| directly
+// from the parser's events without building an intermediate base::Value tree.
+// It follows the same rules as Convert(), but fields registered with
+// RegisterCustomValueField() or RegisterRepeatedCustomValue() still get a
+// base::Value built for their own subtree.
+//   converter.ConvertJSON(json_text, &message);
+//
 // Convert() returns false when it fails.  Here "fail" means that the value is
 // structurally different from expected, such like a string value appears
 // for an int field.  Do not report failures for missing fields.
@@ -91,6 +101,111 @@ class JSONValueConverter;
 
 namespace internal {
 
+// Receives the parse events for a single JSON value during ConvertJSON().
+// The default implementations reject the value, so a handler only overrides
+// the events for the types it accepts.
+class BASE_EXPORT ValueHandler {
+ public:
+  virtual ~ValueHandler() {}
+
+  virtual bool OnNull();
+  virtual bool OnBoolean(bool value);
+  virtual bool OnInteger(int value);
+  virtual bool OnDouble(double value);
+  virtual bool OnString(const std::string& value);
+
+  // Called around the elements of a list value. CreateElementHandler() is
+  // called before each element and returns the handler for it, or NULL to
+  // skip the element. The caller owns the returned handler.
+  virtual bool OnListBegin();
+  virtual ValueHandler* CreateElementHandler();
+  virtual bool OnListEnd();
+
+  // Called around the members of a dictionary value. CreateMemberHandler()
+  // returns the handler for the value of the member |key|, or NULL to skip
+  // it. The caller owns the returned handler.
+  virtual bool OnDictionaryBegin();
+  virtual ValueHandler* CreateMemberHandler(const std::string& key);
+  virtual bool OnDictionaryEnd();
+};
+
+// Builds a base::Value for the JSON value it receives and passes it to
+// OnValue(). Used by converters that need a base::Value to work on.
+class BASE_EXPORT ValueBuildingHandler : public ValueHandler {
+ public:
+  ValueBuildingHandler();
+  virtual ~ValueBuildingHandler();
+
+  virtual bool OnNull() OVERRIDE;
+  virtual bool OnBoolean(bool value) OVERRIDE;
+  virtual bool OnInteger(int value) OVERRIDE;
+  virtual bool OnDouble(double value) OVERRIDE;
+  virtual bool OnString(const std::string& value) OVERRIDE;
+  virtual bool OnListBegin() OVERRIDE;
+  virtual ValueHandler* CreateElementHandler() OVERRIDE;
+  virtual bool OnListEnd() OVERRIDE;
+  virtual bool OnDictionaryBegin() OVERRIDE;
+  virtual ValueHandler* CreateMemberHandler(const std::string& key) OVERRIDE;
+  virtual bool OnDictionaryEnd() OVERRIDE;
+
+ protected:
+  // Called once the whole value has been received. Takes ownership of
+  // |value|.
+  virtual bool OnValue(base::Value* value) = 0;
+
+ private:
+  // The list or dictionary being filled, until OnListEnd() or
+  // OnDictionaryEnd().
+  scoped_ptr<base::Value> container_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValueBuildingHandler);
+};
+
+// Feeds the events from JSONReader::Parse() to a tree of ValueHandlers,
+// starting with |root|.
+class BASE_EXPORT ValueHandlerVisitor : public JSONReader::Visitor {
+ public:
+  // Takes ownership of |root|.
+  explicit ValueHandlerVisitor(ValueHandler* root);
+  virtual ~ValueHandlerVisitor();
+
+  virtual bool OnNull() OVERRIDE;
+  virtual bool OnBoolean(bool value) OVERRIDE;
+  virtual bool OnInteger(int value) OVERRIDE;
+  virtual bool OnDouble(double value) OVERRIDE;
+  virtual bool OnString(const std::string& value) OVERRIDE;
+  virtual bool OnListBegin() OVERRIDE;
+  virtual bool OnListEnd() OVERRIDE;
+  virtual bool OnDictionaryBegin() OVERRIDE;
+  virtual bool OnDictionaryKey(const std::string& key) OVERRIDE;
+  virtual bool OnDictionaryEnd() OVERRIDE;
+
+ private:
+  struct Container {
+    // NULL when the container is being skipped.
+    ValueHandler* handler;
+    bool is_list;
+  };
+
+  // Returns the handler for the value whose events come next, or NULL if the
+  // value is skipped. The caller owns the result.
+  ValueHandler* TakeNextHandler();
+
+  // Closes the innermost container, owning its handler.
+  ValueHandler* PopContainer();
+
+  scoped_ptr<ValueHandler> root_;
+
+  // The handler for the value of the last reported dictionary key.
+  scoped_ptr<ValueHandler> member_handler_;
+
+  // The open lists and dictionaries, innermost last. Their handlers are
+  // owned.
+  std::vector<Container> containers_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValueHandlerVisitor);
+};
+
 template<typename StructType>
 class FieldConverterBase {
  public:
@@ -98,6 +213,7 @@ class FieldConverterBase {
   virtual ~FieldConverterBase() {}
   virtual bool ConvertField(const base::Value& value, StructType* obj)
       const = 0;
+  virtual ValueHandler* CreateFieldHandler(StructType* obj) const = 0;
   const std::string& field_path() const { return field_path_; }
 
  private:
@@ -110,6 +226,9 @@ class ValueConverter {
  public:
   virtual ~ValueConverter() {}
   virtual bool Convert(const base::Value& value, FieldType* field) const = 0;
+  // Returns a handler that converts the parse events for a value into
+  // |field|. The caller owns the result.
+  virtual ValueHandler* CreateHandler(FieldType* field) const = 0;
 };
 
 template <typename StructType, typename FieldType>
@@ -128,12 +247,80 @@ class FieldConverter : public FieldConverterBase<StructType> {
     return value_converter_->Convert(value, &(dst->*field_pointer_));
   }
 
+  virtual ValueHandler* CreateFieldHandler(StructType* dst) const OVERRIDE {
+    return value_converter_->CreateHandler(&(dst->*field_pointer_));
+  }
+
  private:
   FieldType StructType::* field_pointer_;
   scoped_ptr<ValueConverter<FieldType> > value_converter_;
   DISALLOW_COPY_AND_ASSIGN(FieldConverter);
 };
 
+// Stores scalar values into fields of the matching type, mirroring the
+// base::Value::GetAs*() accessors that BasicValueConverter uses. The template
+// catches every mismatched combination.
+template <typename InputType, typename FieldType>
+bool StoreBasicValue(const InputType& value, FieldType* field) {
+  return false;
+}
+
+inline bool StoreBasicValue(const bool& value, bool* field) {
+  *field = value;
+  return true;
+}
+
+inline bool StoreBasicValue(const int& value, int* field) {
+  *field = value;
+  return true;
+}
+
+inline bool StoreBasicValue(const int& value, double* field) {
+  *field = value;
+  return true;
+}
+
+inline bool StoreBasicValue(const double& value, double* field) {
+  *field = value;
+  return true;
+}
+
+inline bool StoreBasicValue(const std::string& value, std::string* field) {
+  *field = value;
+  return true;
+}
+
+inline bool StoreBasicValue(const std::string& value, string16* field) {
+  *field = UTF8ToUTF16(value);
+  return true;
+}
+
+template <typename FieldType>
+class BasicValueHandler : public ValueHandler {
+ public:
+  explicit BasicValueHandler(FieldType* field) : field_(field) {}
+
+  virtual bool OnBoolean(bool value) OVERRIDE {
+    return StoreBasicValue(value, field_);
+  }
+
+  virtual bool OnInteger(int value) OVERRIDE {
+    return StoreBasicValue(value, field_);
+  }
+
+  virtual bool OnDouble(double value) OVERRIDE {
+    return StoreBasicValue(value, field_);
+  }
+
+  virtual bool OnString(const std::string& value) OVERRIDE {
+    return StoreBasicValue(value, field_);
+  }
+
+ private:
+  FieldType* field_;
+  DISALLOW_COPY_AND_ASSIGN(BasicValueHandler);
+};
+
 template <typename FieldType>
 class BasicValueConverter;
 
@@ -146,6 +333,10 @@ class BasicValueConverter<int> : public ValueConverter<int> {
     return value.GetAsInteger(field);
   }
 
+  virtual ValueHandler* CreateHandler(int* field) const OVERRIDE {
+    return new BasicValueHandler<int>(field);
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(BasicValueConverter);
 };
@@ -160,6 +351,10 @@ class BasicValueConverter<std::string> : public ValueConverter<std::string> {
     return value.GetAsString(field);
   }
 
+  virtual ValueHandler* CreateHandler(std::string* field) const OVERRIDE {
+    return new BasicValueHandler<std::string>(field);
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(BasicValueConverter);
 };
@@ -174,6 +369,10 @@ class BasicValueConverter<string16> : public ValueConverter<string16> {
     return value.GetAsString(field);
   }
 
+  virtual ValueHandler* CreateHandler(string16* field) const OVERRIDE {
+    return new BasicValueHandler<string16>(field);
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(BasicValueConverter);
 };
@@ -187,6 +386,10 @@ class BasicValueConverter<double> : public ValueConverter<double> {
     return value.GetAsDouble(field);
   }
 
+  virtual ValueHandler* CreateHandler(double* field) const OVERRIDE {
+    return new BasicValueHandler<double>(field);
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(BasicValueConverter);
 };
@@ -200,6 +403,10 @@ class BasicValueConverter<bool> : public ValueConverter<bool> {
     return value.GetAsBoolean(field);
   }
 
+  virtual ValueHandler* CreateHandler(bool* field) const OVERRIDE {
+    return new BasicValueHandler<bool>(field);
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(BasicValueConverter);
 };
@@ -217,7 +424,28 @@ class ValueFieldConverter : public ValueConverter<FieldType> {
     return convert_func_(&value, field);
   }
 
+  virtual ValueHandler* CreateHandler(FieldType* field) const OVERRIDE {
+    return new Handler(convert_func_, field);
+  }
+
  private:
+  class Handler : public ValueBuildingHandler {
+   public:
+    Handler(ConvertFunc convert_func, FieldType* field)
+        : convert_func_(convert_func), field_(field) {}
+
+   protected:
+    virtual bool OnValue(base::Value* value) OVERRIDE {
+      scoped_ptr<base::Value> owned_value(value);
+      return convert_func_(owned_value.get(), field_);
+    }
+
+   private:
+    ConvertFunc convert_func_;
+    FieldType* field_;
+    DISALLOW_COPY_AND_ASSIGN(Handler);
+  };
+
   ConvertFunc convert_func_;
 
   DISALLOW_COPY_AND_ASSIGN(ValueFieldConverter);
@@ -238,7 +466,26 @@ class CustomFieldConverter : public ValueConverter<FieldType> {
         convert_func_(string_value, field);
   }
 
+  virtual ValueHandler* CreateHandler(FieldType* field) const OVERRIDE {
+    return new Handler(convert_func_, field);
+  }
+
  private:
+  class Handler : public ValueHandler {
+   public:
+    Handler(ConvertFunc convert_func, FieldType* field)
+        : convert_func_(convert_func), field_(field) {}
+
+    virtual bool OnString(const std::string& value) OVERRIDE {
+      return convert_func_(value, field_);
+    }
+
+   private:
+    ConvertFunc convert_func_;
+    FieldType* field_;
+    DISALLOW_COPY_AND_ASSIGN(Handler);
+  };
+
   ConvertFunc convert_func_;
 
   DISALLOW_COPY_AND_ASSIGN(CustomFieldConverter);
@@ -254,11 +501,46 @@ class NestedValueConverter : public ValueConverter<NestedType> {
     return converter_.Convert(value, field);
   }
 
+  virtual ValueHandler* CreateHandler(NestedType* field) const OVERRIDE {
+    return converter_.CreateHandler(field);
+  }
+
  private:
   JSONValueConverter<NestedType> converter_;
   DISALLOW_COPY_AND_ASSIGN(NestedValueConverter);
 };
 
+// Appends each element of a list value to |field|, converting it with
+// |element_converter|.
+template <typename Element>
+class RepeatedFieldHandler : public ValueHandler {
+ public:
+  RepeatedFieldHandler(const ValueConverter<Element>* element_converter,
+                       ScopedVector<Element>* field)
+      : element_converter_(element_converter),
+        field_(field) {
+  }
+
+  virtual bool OnListBegin() OVERRIDE {
+    return true;
+  }
+
+  virtual ValueHandler* CreateElementHandler() OVERRIDE {
+    Element* element = new Element;
+    field_->push_back(element);
+    return element_converter_->CreateHandler(element);
+  }
+
+  virtual bool OnListEnd() OVERRIDE {
+    return true;
+  }
+
+ private:
+  const ValueConverter<Element>* element_converter_;
+  ScopedVector<Element>* field_;
+  DISALLOW_COPY_AND_ASSIGN(RepeatedFieldHandler);
+};
+
 template <typename Element>
 class RepeatedValueConverter : public ValueConverter<ScopedVector<Element> > {
  public:
@@ -289,6 +571,11 @@ class RepeatedValueConverter : public ValueConverter<ScopedVector<Element> > {
     return true;
   }
 
+  virtual ValueHandler* CreateHandler(
+      ScopedVector<Element>* field) const OVERRIDE {
+    return new RepeatedFieldHandler<Element>(&basic_converter_, field);
+  }
+
  private:
   BasicValueConverter<Element> basic_converter_;
   DISALLOW_COPY_AND_ASSIGN(RepeatedValueConverter);
@@ -323,8 +610,13 @@ class RepeatedMessageConverter
     return true;
   }
 
+  virtual ValueHandler* CreateHandler(
+      ScopedVector<NestedType>* field) const OVERRIDE {
+    return new RepeatedFieldHandler<NestedType>(&converter_, field);
+  }
+
  private:
-  JSONValueConverter<NestedType> converter_;
+  NestedValueConverter<NestedType> converter_;
   DISALLOW_COPY_AND_ASSIGN(RepeatedMessageConverter);
 };
 
@@ -335,7 +627,8 @@ class RepeatedCustomValueConverter
   typedef bool(*ConvertFunc)(const base::Value* value, NestedType* field);
 
   RepeatedCustomValueConverter(ConvertFunc convert_func)
-      : convert_func_(convert_func) {}
+      : convert_func_(convert_func),
+        element_converter_(convert_func) {}
 
   virtual bool Convert(const base::Value& value,
                        ScopedVector<NestedType>* field) const OVERRIDE {
@@ -360,11 +653,65 @@ class RepeatedCustomValueConverter
     return true;
   }
 
+  virtual ValueHandler* CreateHandler(
+      ScopedVector<NestedType>* field) const OVERRIDE {
+    return new RepeatedFieldHandler<NestedType>(&element_converter_, field);
+  }
+
  private:
   ConvertFunc convert_func_;
+  ValueFieldConverter<NestedType> element_converter_;
   DISALLOW_COPY_AND_ASSIGN(RepeatedCustomValueConverter);
 };
 
+// Fills the registered fields of |obj| from the members of a dictionary
+// value. Members nested in dictionaries whose keys form a prefix of a
+// registered path (e.g. "foo" for "foo.bar") are handled by a child
+// StructHandler with the longer |path_prefix|.
+template <typename StructType>
+class StructHandler : public ValueHandler {
+ public:
+  typedef ScopedVector<FieldConverterBase<StructType> > FieldConverters;
+
+  StructHandler(const FieldConverters* fields,
+                const std::string& path_prefix,
+                StructType* obj)
+      : fields_(fields),
+        path_prefix_(path_prefix),
+        obj_(obj) {
+  }
+
+  virtual bool OnDictionaryBegin() OVERRIDE {
+    return true;
+  }
+
+  virtual ValueHandler* CreateMemberHandler(const std::string& key) OVERRIDE {
+    const std::string path = path_prefix_ + key;
+    const std::string nested_prefix = path + ".";
+    bool has_nested_fields = false;
+    for (size_t i = 0; i < fields_->size(); ++i) {
+      const FieldConverterBase<StructType>* field_converter = (*fields_)[i];
+      const std::string& field_path = field_converter->field_path();
+      if (field_path == path)
+        return field_converter->CreateFieldHandler(obj_);
+      if (field_path.compare(0, nested_prefix.size(), nested_prefix) == 0)
+        has_nested_fields = true;
+    }
+    if (has_nested_fields)
+      return new StructHandler(fields_, nested_prefix, obj_);
+    return NULL;
+  }
+
+  virtual bool OnDictionaryEnd() OVERRIDE {
+    return true;
+  }
+
+ private:
+  const FieldConverters* fields_;
+  const std::string path_prefix_;
+  StructType* obj_;
+  DISALLOW_COPY_AND_ASSIGN(StructHandler);
+};
 
 }  // namespace internal
 
@@ -517,6 +864,27 @@ class JSONValueConverter {
     return true;
   }
 
+  // Parses |json| and fills |output| from the parse events directly, without
+  // building a base::Value for the document. Returns false if |json| is not
+  // valid JSON or the value is structurally different from expected, in
+  // which case |output| may have been partially filled.
+  bool ConvertJSON(const std::string& json, StructType* output) const {
+    internal::ValueHandlerVisitor visitor(CreateHandler(output));
+    JSONReader reader;
+    if (!reader.Parse(json, false, false, &visitor)) {
+      DVLOG(1) << "failure converting JSON: " << reader.GetErrorMessage();
+      return false;
+    }
+    return true;
+  }
+
+  // Returns a handler that fills |output| from the parse events for a
+  // dictionary value. The caller owns the result.
+  internal::ValueHandler* CreateHandler(StructType* output) const {
+    return new internal::StructHandler<StructType>(&fields_, std::string(),
+                                                   output);
+  }
+
  private:
   ScopedVector<internal::FieldConverterBase<StructType> > fields_;
 
@@ -92,6 +92,20 @@ struct NestedMessage {
   }
 };
 
+// For fields registered with a dotted path.
+struct PathMessage {
+  int inner;
+  std::string deeper;
+
+  PathMessage() : inner(0) {}
+
+  static void RegisterJSONConverter(
+      base::JSONValueConverter<PathMessage>* converter) {
+    converter->RegisterIntField("outer.inner", &PathMessage::inner);
+    converter->RegisterStringField("outer.deep.deeper", &PathMessage::deeper);
+  }
+};
+
 }  // namespace
 
 TEST(JSONValueConverterTest, ParseSimpleMessage) {
@@ -253,4 +267,101 @@ TEST(JSONValueConverterTest, RepeatedValueErrorInTheMiddle) {
   // No check the values as mentioned above.
 }
 
+TEST(JSONValueConverterTest, ConvertJSONNestedMessage) {
+  const char normal_data[] =
+      "{\n"
+      "  \"foo\": 1,\n"
+      "  \"unknown\": [{\"foo\": [1, {}]}, \"bar\"],\n"
+      "  \"child\": {\n"
+      "    \"foo\": 1,\n"
+      "    \"bar\": \"bar\",\n"
+      "    \"bstruct\": {},\n"
+      "    \"string_values\": [{\"val\": \"value_1\"}, {\"val\": \"value_2\"}],"
+      "    \"simple_enum\": \"bar\","
+      "    \"ints\": [3, 4, 5],"
+      "    \"baz\": true\n"
+      "  },\n"
+      "  \"children\": [{\n"
+      "    \"foo\": 2,\n"
+      "    \"bar\": \"foobar\",\n"
+      "    \"bstruct\": \"\",\n"
+      "    \"baz\": true\n"
+      "  },\n"
+      "  {\n"
+      "    \"foo\": 3,\n"
+      "    \"bar\": \"barbaz\",\n"
+      "    \"baz\": false\n"
+      "  }]\n"
+      "}\n";
+
+  NestedMessage message;
+  base::JSONValueConverter<NestedMessage> converter;
+  EXPECT_TRUE(converter.ConvertJSON(normal_data, &message));
+
+  // An integer is accepted for a double field, as in Convert().
+  EXPECT_EQ(1.0, message.foo);
+  EXPECT_EQ(1, message.child.foo);
+  EXPECT_EQ("bar", message.child.bar);
+  EXPECT_TRUE(message.child.baz);
+  EXPECT_TRUE(message.child.bstruct);
+  EXPECT_EQ(SimpleMessage::BAR, message.child.simple_enum);
+  ASSERT_EQ(3U, message.child.ints.size());
+  EXPECT_EQ(3, *message.child.ints[0]);
+  EXPECT_EQ(5, *message.child.ints[2]);
+  ASSERT_EQ(2U, message.child.string_values.size());
+  EXPECT_EQ("value_1", *message.child.string_values[0]);
+  EXPECT_EQ("value_2", *message.child.string_values[1]);
+
+  ASSERT_EQ(2U, message.children.size());
+  EXPECT_EQ(2, message.children[0]->foo);
+  EXPECT_EQ("foobar", message.children[0]->bar);
+  EXPECT_TRUE(message.children[0]->bstruct);
+  EXPECT_EQ(3, message.children[1]->foo);
+  EXPECT_EQ("barbaz", message.children[1]->bar);
+  EXPECT_FALSE(message.children[1]->baz);
+  EXPECT_FALSE(message.children[1]->bstruct);
+}
+
+TEST(JSONValueConverterTest, ConvertJSONFailures) {
+  base::JSONValueConverter<SimpleMessage> converter;
+
+  // "bar" is an integer here.
+  SimpleMessage message1;
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": 1, \"bar\": 2}", &message1));
+
+  SimpleMessage message2;
+  EXPECT_FALSE(converter.ConvertJSON("{\"ints\": [1, false]}", &message2));
+
+  SimpleMessage message3;
+  EXPECT_FALSE(converter.ConvertJSON("{\"simple_enum\": \"baz\"}",
+                                     &message3));
+
+  // The root must be a dictionary.
+  SimpleMessage message4;
+  EXPECT_FALSE(converter.ConvertJSON("[1, 2]", &message4));
+
+  // Malformed JSON.
+  SimpleMessage message5;
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": 1,", &message5));
+}
+
+TEST(JSONValueConverterTest, ConvertJSONWithPaths) {
+  const char normal_data[] =
+      "{\"outer\": {\"other\": 1, \"inner\": 2, \"deep\": {\"deeper\": \"x\"}},"
+      " \"inner\": 3}";
+
+  base::JSONValueConverter<PathMessage> converter;
+  PathMessage streamed;
+  EXPECT_TRUE(converter.ConvertJSON(normal_data, &streamed));
+  EXPECT_EQ(2, streamed.inner);
+  EXPECT_EQ("x", streamed.deeper);
+
+  // The result matches converting the Value tree.
+  scoped_ptr<Value> value(base::JSONReader::Read(normal_data));
+  PathMessage converted;
+  EXPECT_TRUE(converter.Convert(*value.get(), &converted));
+  EXPECT_EQ(streamed.inner, converted.inner);
+  EXPECT_EQ(streamed.deeper, converted.deeper);
+}
+
 }  // namespace base
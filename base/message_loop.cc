@@ -480,13 +480,42 @@ bool MessageLoop::DeferOrRunPendingTask(const PendingTask& pending_task) {
 }
 
 void MessageLoop::AddToDelayedWorkQueue(const PendingTask& pending_task) {
-  // Move to the delayed work queue.  Initialize the sequence number
-  // before inserting into the delayed_work_queue_.  The sequence number
-  // is used to faciliate FIFO sorting when two tasks have the same
-  // delayed_run_time value.
-  PendingTask new_pending_task(pending_task);
-  new_pending_task.sequence_num = next_sequence_num_++;
-  delayed_work_queue_.push(new_pending_task);
+  // Move to the delayed work queue.  The sequence number was initialized when
+  // the task was posted, and is used to faciliate FIFO sorting when two tasks
+  // have the same delayed_run_time value.
+  delayed_work_queue_.push(pending_task);
+}
+
+int MessageLoop::NextSequenceNum() {
+  base::AutoLock locked(incoming_queue_lock_);
+  return next_sequence_num_++;
+}
+
+int MessageLoop::PostCancelableDelayedTask(
+    const tracked_objects::Location& from_here,
+    const base::Closure& task,
+    base::TimeDelta delay) {
+  DCHECK_EQ(this, current());
+  DCHECK(!task.is_null()) << from_here.ToString();
+  DCHECK_GT(delay.InMillisecondsRoundedUp(), 0);
+  PendingTask pending_task(from_here, task,
+                           CalculateDelayedRuntime(
+                               delay.InMillisecondsRoundedUp()),
+                           true);
+  pending_task.sequence_num = NextSequenceNum();
+
+  // Unlike AddToIncomingQueue() this can't starve other threads' tasks: the
+  // task only becomes runnable once its delay expires.
+  AddToDelayedWorkQueue(pending_task);
+  // If we changed the topmost task, then it is time to reschedule.
+  if (delayed_work_queue_.top().sequence_num == pending_task.sequence_num)
+    pump_->ScheduleDelayedWork(pending_task.delayed_run_time);
+  return pending_task.sequence_num;
+}
+
+void MessageLoop::CancelDelayedTask(int id) {
+  DCHECK_EQ(this, current());
+  delayed_work_queue_.Remove(id);
 }
 
 void MessageLoop::ReloadWorkQueue() {
@@ -585,9 +614,14 @@ void MessageLoop::AddToIncomingQueue(PendingTask* pending_task) {
   {
     base::AutoLock locked(incoming_queue_lock_);
 
+    pending_task->sequence_num = next_sequence_num_++;
     bool was_empty = incoming_queue_.empty();
+    // Hand the closure over to the queued copy by swapping, which leaves
+    // |pending_task| without it and costs no atomic refcount operations.
+    base::Closure task;
+    task.Swap(&pending_task->task);
     incoming_queue_.push(*pending_task);
-    pending_task->task.Reset();
+    incoming_queue_.back().task.Swap(&task);
     if (!was_empty)
       return;  // Someone else should have started the sub-pump.
 
@@ -636,12 +670,18 @@ bool MessageLoop::DoWork() {
 
     // Execute oldest task.
     do {
+      // Take the closure out of the queue entry by swapping, so that neither
+      // the copy nor the pop touches its refcount.
+      base::Closure task;
+      task.Swap(&work_queue_.front().task);
       PendingTask pending_task = work_queue_.front();
+      pending_task.task.Swap(&task);
       work_queue_.pop();
       if (!pending_task.delayed_run_time.is_null()) {
         AddToDelayedWorkQueue(pending_task);
         // If we changed the topmost task, then it is time to reschedule.
-        if (delayed_work_queue_.top().task.Equals(pending_task.task))
+        if (delayed_work_queue_.top().sequence_num ==
+            pending_task.sequence_num)
           pump_->ScheduleDelayedWork(pending_task.delayed_run_time);
       } else {
         if (DeferOrRunPendingTask(pending_task))
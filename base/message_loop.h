@@ -42,6 +42,7 @@
 
 namespace base {
 class Histogram;
+class Timer;
 }
 
 // A MessageLoop is used to process events for a particular thread.  There is
@@ -429,6 +430,9 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   // Adds the pending task to delayed_work_queue_.
   void AddToDelayedWorkQueue(const base::PendingTask& pending_task);
 
+  // Returns the sequence number for the next posted task.
+  int NextSequenceNum();
+
   // Adds the pending task to our incoming_queue_.
   //
   // Caller retains ownership of |pending_task|, but this function will
@@ -512,7 +516,10 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   bool os_modal_loop_;
 #endif
 
-  // The next sequence number to use for delayed tasks.
+  // The next sequence number to use for posted tasks.  Numbers are assigned
+  // when a task is posted, so delayed tasks with the same delayed_run_time
+  // run in posting order however they reach delayed_work_queue_.  Protected
+  // by incoming_queue_lock_.
   int next_sequence_num_;
 
   ObserverList<TaskObserver> task_observers_;
@@ -521,9 +528,23 @@ class BASE_EXPORT MessageLoop : public base::MessagePump::Delegate {
   scoped_refptr<base::MessageLoopProxy> message_loop_proxy_;
 
  private:
+  friend class base::Timer;
   template <class T, class R> friend class base::subtle::DeleteHelperInternal;
   template <class T, class R> friend class base::subtle::ReleaseHelperInternal;
 
+  // Posts a delayed task that can be cancelled with CancelDelayedTask().  Only
+  // callable on the thread running this loop, with a positive |delay|.  The
+  // task goes straight to delayed_work_queue_, and the returned id lets
+  // base::Timer remove the task (and destroy its callback) when the timer is
+  // stopped or reset, instead of leaving it queued until it expires.
+  int PostCancelableDelayedTask(const tracked_objects::Location& from_here,
+                                const base::Closure& task,
+                                base::TimeDelta delay);
+
+  // Removes the task |id| returned by PostCancelableDelayedTask() if it has
+  // not run yet.  Only callable on the thread running this loop.
+  void CancelDelayedTask(int id);
+
   void DeleteSoonInternal(const tracked_objects::Location& from_here,
                           void(*deleter)(const void*),
                           const void* object);
@@ -58,6 +58,7 @@ static int SetNonBlocking(int fd) {
 
 MessagePumpLibevent::FileDescriptorWatcher::FileDescriptorWatcher()
     : is_persistent_(false),
+      edge_triggered_(false),
       event_(NULL),
       pump_(NULL),
       watcher_(NULL),
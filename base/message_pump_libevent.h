@@ -6,8 +6,11 @@
 #define BASE_MESSAGE_PUMP_LIBEVENT_H_
 #pragma once
 
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/hash_tables.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_pump.h"
 #include "base/observer_list.h"
@@ -21,6 +24,10 @@ struct event;
 namespace base {
 
 // Class to monitor sockets and issue callbacks when sockets are ready for I/O
+// On Linux the pump talks to epoll directly (message_pump_libevent_linux.cc)
+// rather than going through libevent: each wait collects a whole batch of
+// ready descriptors, and watchers stay registered with the kernel between
+// callbacks instead of being re-added after every read.
 // TODO(dkegel): add support for background file IO somehow
 class BASE_EXPORT MessagePumpLibevent : public MessagePump {
  public:
@@ -65,16 +72,28 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
     // to do.
     bool StopWatchingFileDescriptor();
 
+    // Asks for edge-triggered notification, where the pump supports it (the
+    // epoll pump on Linux; elsewhere this is ignored).  The delegate is then
+    // only told about new readiness, so each callback must read or write
+    // until the operation would block.  The descriptor is only registered
+    // edge-triggered when every watcher on it asks for it.  Takes effect on
+    // the next WatchFileDescriptor() call.
+    void set_edge_triggered(bool edge_triggered) {
+      edge_triggered_ = edge_triggered;
+    }
+
    private:
     friend class MessagePumpLibevent;
     friend class MessagePumpLibeventTest;
 
+#if !defined(OS_LINUX)
     // Called by MessagePumpLibevent, ownership of |e| is transferred to this
     // object.
     void Init(event* e, bool is_persistent);
 
     // Used by MessagePumpLibevent to take ownership of event_.
     event *ReleaseEvent();
+#endif
 
     void set_pump(MessagePumpLibevent* pump) { pump_ = pump; }
     MessagePumpLibevent* pump() { return pump_; }
@@ -85,7 +104,17 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
     void OnFileCanWriteWithoutBlocking(int fd, MessagePumpLibevent* pump);
 
     bool is_persistent_;  // false if this event is one-shot.
+    bool edge_triggered_;
+#if defined(OS_LINUX)
+    int fd_;  // -1 when not watching.
+    int mode_;  // The Mode values watched so far.
+    // Cleared when a one-shot watch fires.  The kernel registration is only
+    // dropped before the pump next waits, so re-arming from the callback
+    // costs no system call.
+    bool armed_;
+#else
     event* event_;
+#endif
     MessagePumpLibevent* pump_;
     Watcher* watcher_;
     base::WeakPtrFactory<FileDescriptorWatcher> weak_factory_;
@@ -112,7 +141,6 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
   // event previously attached to |controller| is aborted.
   // Returns true on success.
   // Must be called on the same thread the message_pump is running on.
-  // TODO(dkegel): switch to edge-triggered readiness notification
   bool WatchFileDescriptor(int fd,
                            bool persistent,
                            Mode mode,
@@ -140,6 +168,52 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
   // Risky part of constructor.  Returns true on success.
   bool Init();
 
+#if defined(OS_LINUX)
+  // The kernel-side state of one watched descriptor.  epoll allows a single
+  // registration per descriptor, so it is shared by every controller
+  // watching the descriptor (e.g. a socket's read and write watchers).
+  struct Registration {
+    Registration();
+    ~Registration();
+
+    std::vector<FileDescriptorWatcher*> controllers;
+    // The mask last handed to epoll_ctl(), 0 if not registered.
+    uint32 events;
+    // Tags the registration's events so that a batch entry for a descriptor
+    // that was closed and reused earlier in the same batch is dropped.
+    uint32 generation;
+    // Set when |events| may be wider than the controllers need.
+    bool dirty;
+  };
+  typedef hash_map<int, Registration> RegistrationMap;
+
+  // Drops |controller| from its descriptor's registration.
+  bool StopWatching(FileDescriptorWatcher* controller);
+
+  // Brings the epoll registration of |fd| in line with its armed
+  // controllers.  |resync| forces a call to epoll_ctl() even when the mask
+  // is unchanged.  Returns false if epoll_ctl() fails.
+  bool UpdateRegistration(int fd, Registration* registration, bool resync);
+
+  // Applies the updates deferred by fired one-shot watches.
+  void UpdateDirtyRegistrations();
+
+  // Waits up to |timeout_ms| (-1 for no limit) and dispatches the batch of
+  // events that comes back.
+  void WaitForEvents(int timeout_ms);
+
+  // Dispatches one epoll event to the controllers it concerns.
+  void OnEpollEvent(uint64 data, uint32 events);
+
+  // Tells |controller| that |fd| can be read and/or written to (|ready| is a
+  // Mode).
+  void OnFileDescriptorReady(int fd,
+                             FileDescriptorWatcher* controller,
+                             int ready);
+
+  // Called inside Run() when the wakeup pipe is ready to read.
+  void OnWakeup();
+#else
   // Called by libevent to tell us a registered FD can be read/written to.
   static void OnLibeventNotification(int fd, short flags,
                                      void* context);
@@ -147,6 +221,7 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
   // Unix pipe used to implement ScheduleWork()
   // ... callback; called by libevent inside Run() when pipe is ready to read
   static void OnWakeup(int socket, short flags, void* context);
+#endif
 
   // This flag is set to false when Run should return.
   bool keep_running_;
@@ -160,16 +235,30 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
   // The time at which we should call DoDelayedWork.
   TimeTicks delayed_work_time_;
 
+#if defined(OS_LINUX)
+  // The epoll instance every watched descriptor is registered with.
+  int epoll_fd_;
+
+  RegistrationMap registrations_;
+
+  // Descriptors whose Registration is dirty.
+  std::vector<int> dirty_fds_;
+
+  uint32 next_generation_;
+#else
   // Libevent dispatcher.  Watches all sockets registered with it, and sends
   // readiness callbacks when a socket is ready for I/O.
   event_base* event_base_;
+#endif
 
   // ... write end; ScheduleWork() writes a single byte to it
   int wakeup_pipe_in_;
   // ... read end; OnWakeup reads it and then breaks Run() out of its sleep
   int wakeup_pipe_out_;
+#if !defined(OS_LINUX)
   // ... libevent wrapper for read end
   event* wakeup_event_;
+#endif
 
   ObserverList<IOObserver> io_observers_;
   ThreadChecker watch_file_descriptor_caller_checker_;
@@ -0,0 +1,505 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_pump_libevent.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/auto_reset.h"
+#include "base/eintr_wrapper.h"
+#include "base/logging.h"
+
+// The epoll flavour of MessagePumpLibevent.
+//
+// Every watched descriptor has one Registration, shared by the controllers
+// watching it, holding the mask the kernel currently has for it.  Persistent
+// watches stay registered until StopWatchingFileDescriptor(), so a socket
+// that is read over and over costs no system calls beyond the reads
+// themselves.  When a one-shot watch fires, its registration is only marked
+// dirty; the pump narrows or drops it just before it next waits, by which
+// time the delegate has usually re-armed the watch and nothing needs to
+// change.
+//
+// Each wait collects up to kMaxEventsPerWait ready descriptors.  Delegates
+// may stop or delete any controller while the batch is dispatched, so each
+// event is looked up again by descriptor when its turn comes, and tagged
+// with a generation so that an event for a descriptor which was closed and
+// reused earlier in the batch is dropped.
+
+namespace base {
+
+namespace {
+
+// The number of events collected by one epoll_wait().
+const int kMaxEventsPerWait = 256;
+
+// The generation of the wakeup pipe's registration; watched descriptors
+// start at 1.
+const uint32 kWakeupGeneration = 0;
+
+// Return 0 on success
+int SetNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags == -1)
+    flags = 0;
+  return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+uint64 MakeEventData(int fd, uint32 generation) {
+  return (static_cast<uint64>(generation) << 32) | static_cast<uint32>(fd);
+}
+
+}  // namespace
+
+MessagePumpLibevent::FileDescriptorWatcher::FileDescriptorWatcher()
+    : is_persistent_(false),
+      edge_triggered_(false),
+      fd_(-1),
+      mode_(0),
+      armed_(false),
+      pump_(NULL),
+      watcher_(NULL),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+MessagePumpLibevent::FileDescriptorWatcher::~FileDescriptorWatcher() {
+  if (pump_) {
+    StopWatchingFileDescriptor();
+  }
+}
+
+bool MessagePumpLibevent::FileDescriptorWatcher::StopWatchingFileDescriptor() {
+  if (!pump_)
+    return true;
+
+  bool rv = pump_->StopWatching(this);
+  is_persistent_ = false;
+  fd_ = -1;
+  mode_ = 0;
+  armed_ = false;
+  pump_ = NULL;
+  watcher_ = NULL;
+  return rv;
+}
+
+void MessagePumpLibevent::FileDescriptorWatcher::OnFileCanReadWithoutBlocking(
+    int fd, MessagePumpLibevent* pump) {
+  // Since OnFileCanWriteWithoutBlocking() gets called first, it can stop
+  // watching the file descriptor.
+  if (!watcher_)
+    return;
+  pump->WillProcessIOEvent();
+  watcher_->OnFileCanReadWithoutBlocking(fd);
+  pump->DidProcessIOEvent();
+}
+
+void MessagePumpLibevent::FileDescriptorWatcher::OnFileCanWriteWithoutBlocking(
+    int fd, MessagePumpLibevent* pump) {
+  DCHECK(watcher_);
+  pump->WillProcessIOEvent();
+  watcher_->OnFileCanWriteWithoutBlocking(fd);
+  pump->DidProcessIOEvent();
+}
+
+MessagePumpLibevent::Registration::Registration()
+    : events(0),
+      generation(0),
+      dirty(false) {
+}
+
+MessagePumpLibevent::Registration::~Registration() {
+}
+
+MessagePumpLibevent::MessagePumpLibevent()
+    : keep_running_(true),
+      in_run_(false),
+      processed_io_events_(false),
+      epoll_fd_(epoll_create(kMaxEventsPerWait)),
+      next_generation_(kWakeupGeneration + 1),
+      wakeup_pipe_in_(-1),
+      wakeup_pipe_out_(-1) {
+  if (!Init())
+     NOTREACHED();
+}
+
+MessagePumpLibevent::~MessagePumpLibevent() {
+  // Controllers that outlive the pump are left with nothing to stop.
+  for (RegistrationMap::iterator it = registrations_.begin();
+       it != registrations_.end(); ++it) {
+    const std::vector<FileDescriptorWatcher*>& controllers =
+        it->second.controllers;
+    for (size_t i = 0; i < controllers.size(); ++i) {
+      controllers[i]->fd_ = -1;
+      controllers[i]->mode_ = 0;
+      controllers[i]->armed_ = false;
+      controllers[i]->pump_ = NULL;
+      controllers[i]->watcher_ = NULL;
+    }
+  }
+  if (wakeup_pipe_in_ >= 0) {
+    if (HANDLE_EINTR(close(wakeup_pipe_in_)) < 0)
+      DPLOG(ERROR) << "close";
+  }
+  if (wakeup_pipe_out_ >= 0) {
+    if (HANDLE_EINTR(close(wakeup_pipe_out_)) < 0)
+      DPLOG(ERROR) << "close";
+  }
+  if (epoll_fd_ >= 0) {
+    if (HANDLE_EINTR(close(epoll_fd_)) < 0)
+      DPLOG(ERROR) << "close";
+  }
+}
+
+bool MessagePumpLibevent::WatchFileDescriptor(int fd,
+                                              bool persistent,
+                                              Mode mode,
+                                              FileDescriptorWatcher *controller,
+                                              Watcher *delegate) {
+  DCHECK_GE(fd, 0);
+  DCHECK(controller);
+  DCHECK(delegate);
+  DCHECK(mode == WATCH_READ || mode == WATCH_WRITE || mode == WATCH_READ_WRITE);
+  // WatchFileDescriptor should be called on the pump thread. It is not
+  // threadsafe, and your watcher may never be registered.
+  DCHECK(watch_file_descriptor_caller_checker_.CalledOnValidThread());
+
+  bool joining = controller->pump_ == NULL;
+  if (!joining) {
+    DCHECK_EQ(this, controller->pump_);
+    // It's illegal to use this function to listen on 2 separate fds with the
+    // same |controller|.
+    if (controller->fd_ != fd) {
+      NOTREACHED() << "FDs don't match" << controller->fd_ << "!=" << fd;
+      return false;
+    }
+  }
+
+  Registration* registration = &registrations_[fd];
+  if (joining) {
+    registration->controllers.push_back(controller);
+    controller->fd_ = fd;
+    controller->pump_ = this;
+  }
+  // As with libevent, watching again adds to what was watched before.
+  controller->mode_ |= mode;
+  controller->is_persistent_ |= persistent;
+  controller->armed_ = true;
+  controller->set_watcher(delegate);
+
+  // A controller joining a registration that is believed to be live checks
+  // it with the kernel, in case the descriptor was closed and reused
+  // without the old watchers stopping first.
+  if (!UpdateRegistration(fd, registration,
+                          joining && registration->events != 0)) {
+    controller->StopWatchingFileDescriptor();
+    return false;
+  }
+  return true;
+}
+
+void MessagePumpLibevent::AddIOObserver(IOObserver *obs) {
+  io_observers_.AddObserver(obs);
+}
+
+void MessagePumpLibevent::RemoveIOObserver(IOObserver *obs) {
+  io_observers_.RemoveObserver(obs);
+}
+
+// Reentrant!
+void MessagePumpLibevent::Run(Delegate* delegate) {
+  DCHECK(keep_running_) << "Quit must have been called outside of Run!";
+  AutoReset<bool> auto_reset_in_run(&in_run_, true);
+
+  for (;;) {
+    bool did_work = delegate->DoWork();
+    if (!keep_running_)
+      break;
+
+    WaitForEvents(0);
+    did_work |= processed_io_events_;
+    processed_io_events_ = false;
+    if (!keep_running_)
+      break;
+
+    did_work |= delegate->DoDelayedWork(&delayed_work_time_);
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    did_work = delegate->DoIdleWork();
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    if (delayed_work_time_.is_null()) {
+      WaitForEvents(-1);
+    } else {
+      TimeDelta delay = delayed_work_time_ - TimeTicks::Now();
+      if (delay > TimeDelta()) {
+        WaitForEvents(static_cast<int>(
+            std::min(delay.InMillisecondsRoundedUp(),
+                     static_cast<int64>(INT_MAX))));
+      } else {
+        // It looks like delayed_work_time_ indicates a time in the past, so we
+        // need to call DoDelayedWork now.
+        delayed_work_time_ = TimeTicks();
+      }
+    }
+  }
+
+  keep_running_ = true;
+}
+
+void MessagePumpLibevent::Quit() {
+  DCHECK(in_run_);
+  // Tell Run that it should break out of its loop, waking it if it waits.
+  keep_running_ = false;
+  ScheduleWork();
+}
+
+void MessagePumpLibevent::ScheduleWork() {
+  // Wake up epoll_wait() (in a threadsafe way).
+  char buf = 0;
+  int nwrite = HANDLE_EINTR(write(wakeup_pipe_in_, &buf, 1));
+  DCHECK(nwrite == 1 || errno == EAGAIN)
+      << "[nwrite:" << nwrite << "] [errno:" << errno << "]";
+}
+
+void MessagePumpLibevent::ScheduleDelayedWork(
+    const TimeTicks& delayed_work_time) {
+  // We know that we can't be blocked on Wait right now since this method can
+  // only be called on the same thread as Run, so we only need to update our
+  // record of how long to sleep when we do sleep.
+  delayed_work_time_ = delayed_work_time;
+}
+
+void MessagePumpLibevent::WillProcessIOEvent() {
+  FOR_EACH_OBSERVER(IOObserver, io_observers_, WillProcessIOEvent());
+}
+
+void MessagePumpLibevent::DidProcessIOEvent() {
+  FOR_EACH_OBSERVER(IOObserver, io_observers_, DidProcessIOEvent());
+}
+
+bool MessagePumpLibevent::Init() {
+  if (epoll_fd_ < 0) {
+    DLOG(ERROR) << "epoll_create() failed, errno: " << errno;
+    return false;
+  }
+  int fds[2];
+  if (pipe(fds)) {
+    DLOG(ERROR) << "pipe() failed, errno: " << errno;
+    return false;
+  }
+  if (SetNonBlocking(fds[0])) {
+    DLOG(ERROR) << "SetNonBlocking for pipe fd[0] failed, errno: " << errno;
+    return false;
+  }
+  if (SetNonBlocking(fds[1])) {
+    DLOG(ERROR) << "SetNonBlocking for pipe fd[1] failed, errno: " << errno;
+    return false;
+  }
+  wakeup_pipe_out_ = fds[0];
+  wakeup_pipe_in_ = fds[1];
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.u64 = MakeEventData(wakeup_pipe_out_, kWakeupGeneration);
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_pipe_out_, &event)) {
+    DLOG(ERROR) << "epoll_ctl() for the wakeup pipe failed, errno: " << errno;
+    return false;
+  }
+  return true;
+}
+
+bool MessagePumpLibevent::StopWatching(FileDescriptorWatcher* controller) {
+  RegistrationMap::iterator it = registrations_.find(controller->fd_);
+  DCHECK(it != registrations_.end());
+  std::vector<FileDescriptorWatcher*>& controllers = it->second.controllers;
+  controllers.erase(
+      std::find(controllers.begin(), controllers.end(), controller));
+
+  // Applied right away rather than deferred: the caller is likely to close
+  // the descriptor next.
+  bool rv = UpdateRegistration(it->first, &it->second, false);
+  if (controllers.empty())
+    registrations_.erase(it);
+  return rv;
+}
+
+bool MessagePumpLibevent::UpdateRegistration(int fd,
+                                             Registration* registration,
+                                             bool resync) {
+  uint32 events = 0;
+  bool edge_triggered = true;
+  for (size_t i = 0; i < registration->controllers.size(); ++i) {
+    const FileDescriptorWatcher* controller = registration->controllers[i];
+    if (!controller->armed_)
+      continue;
+    if (controller->mode_ & WATCH_READ)
+      events |= EPOLLIN;
+    if (controller->mode_ & WATCH_WRITE)
+      events |= EPOLLOUT;
+    edge_triggered &= controller->edge_triggered_;
+  }
+  if (events && edge_triggered)
+    events |= EPOLLET;
+
+  registration->dirty = false;
+  if (events == registration->events && !resync)
+    return true;
+
+  int rv;
+  if (!events) {
+    // Kernels before 2.6.9 want an event even though it is ignored.
+    struct epoll_event unused;
+    rv = epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &unused);
+    // Closing the descriptor has already taken it out of the epoll set.
+    if (rv != 0 && (errno == EBADF || errno == ENOENT))
+      rv = 0;
+  } else {
+    int op = registration->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    for (;;) {
+      if (op == EPOLL_CTL_ADD) {
+        registration->generation = next_generation_++;
+        if (next_generation_ == kWakeupGeneration)
+          ++next_generation_;
+      }
+      event.data.u64 = MakeEventData(fd, registration->generation);
+      rv = epoll_ctl(epoll_fd_, op, fd, &event);
+      // A registration that vanished with a closed descriptor is added
+      // again for whatever the descriptor now refers to.
+      if (rv == 0 || op != EPOLL_CTL_MOD || errno != ENOENT)
+        break;
+      op = EPOLL_CTL_ADD;
+    }
+  }
+  if (rv != 0) {
+    DPLOG(ERROR) << "epoll_ctl";
+    registration->events = 0;
+    return false;
+  }
+  registration->events = events;
+  return true;
+}
+
+void MessagePumpLibevent::UpdateDirtyRegistrations() {
+  for (size_t i = 0; i < dirty_fds_.size(); ++i) {
+    RegistrationMap::iterator it = registrations_.find(dirty_fds_[i]);
+    if (it != registrations_.end() && it->second.dirty)
+      UpdateRegistration(it->first, &it->second, false);
+  }
+  dirty_fds_.clear();
+}
+
+void MessagePumpLibevent::WaitForEvents(int timeout_ms) {
+  UpdateDirtyRegistrations();
+
+  struct epoll_event events[kMaxEventsPerWait];
+  int count = epoll_wait(epoll_fd_, events, kMaxEventsPerWait, timeout_ms);
+  if (count < 0) {
+    DPLOG_IF(ERROR, errno != EINTR) << "epoll_wait";
+    return;
+  }
+  for (int i = 0; i < count; ++i)
+    OnEpollEvent(events[i].data.u64, events[i].events);
+}
+
+void MessagePumpLibevent::OnEpollEvent(uint64 data, uint32 events) {
+  int fd = static_cast<int>(data & 0xffffffff);
+  uint32 generation = static_cast<uint32>(data >> 32);
+  if (generation == kWakeupGeneration) {
+    DCHECK_EQ(wakeup_pipe_out_, fd);
+    OnWakeup();
+    return;
+  }
+
+  RegistrationMap::iterator it = registrations_.find(fd);
+  if (it == registrations_.end() || it->second.generation != generation)
+    return;
+
+  // Errors and hangups are reported whatever the interest mask is; the
+  // delegates find out about them from their next read or write.
+  int ready = 0;
+  if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+    ready |= WATCH_READ;
+  if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+    ready |= WATCH_WRITE;
+
+  const std::vector<FileDescriptorWatcher*>& controllers =
+      it->second.controllers;
+  if (controllers.size() == 1) {
+    FileDescriptorWatcher* controller = controllers[0];
+    if (controller->armed_ && (ready & controller->mode_))
+      OnFileDescriptorReady(fd, controller, ready & controller->mode_);
+    return;
+  }
+
+  // A delegate may stop or delete any of the other controllers, which also
+  // invalidates |controllers|.
+  std::vector<WeakPtr<FileDescriptorWatcher> > targets;
+  for (size_t i = 0; i < controllers.size(); ++i)
+    targets.push_back(controllers[i]->weak_factory_.GetWeakPtr());
+  for (size_t i = 0; i < targets.size(); ++i) {
+    FileDescriptorWatcher* controller = targets[i].get();
+    if (!controller || controller->pump_ != this || controller->fd_ != fd ||
+        !controller->armed_ || !(ready & controller->mode_)) {
+      continue;
+    }
+    OnFileDescriptorReady(fd, controller, ready & controller->mode_);
+  }
+}
+
+void MessagePumpLibevent::OnFileDescriptorReady(
+    int fd,
+    FileDescriptorWatcher* controller,
+    int ready) {
+  processed_io_events_ = true;
+
+  if (!controller->is_persistent_ && controller->pump_ == this) {
+    controller->armed_ = false;
+    Registration& registration = registrations_[fd];
+    if (!registration.dirty) {
+      registration.dirty = true;
+      dirty_fds_.push_back(fd);
+    }
+  }
+
+  base::WeakPtr<FileDescriptorWatcher> weak_controller =
+      controller->weak_factory_.GetWeakPtr();
+  if (ready & WATCH_WRITE) {
+    controller->OnFileCanWriteWithoutBlocking(fd, this);
+  }
+  // Check |controller| in case it's been deleted in
+  // controller->OnFileCanWriteWithoutBlocking().
+  if (weak_controller.get() && ready & WATCH_READ) {
+    controller->OnFileCanReadWithoutBlocking(fd, this);
+  }
+}
+
+void MessagePumpLibevent::OnWakeup() {
+  // Remove and discard the wakeup bytes.  A ScheduleWork() after this read
+  // writes another one, so no wakeup is lost.
+  char buf[16];
+  int nread = HANDLE_EINTR(read(wakeup_pipe_out_, buf, sizeof(buf)));
+  DCHECK_GT(nread, 0);
+  processed_io_events_ = true;
+}
+
+}  // namespace base
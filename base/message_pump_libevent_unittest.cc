@@ -4,17 +4,22 @@
 
 #include "base/message_pump_libevent.h"
 
+#include <sys/socket.h>
 #include <unistd.h>
 
+#include "base/eintr_wrapper.h"
+#include "base/memory/scoped_vector.h"
 #include "base/message_loop.h"
 #include "base/threading/thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+#if !defined(OS_LINUX)
 #if defined(USE_SYSTEM_LIBEVENT)
 #include <event.h>
 #else
 #include "third_party/libevent/event.h"
 #endif
+#endif
 
 namespace base {
 
@@ -39,7 +44,12 @@ class MessagePumpLibeventTest : public testing::Test {
   void OnLibeventNotification(
       MessagePumpLibevent* pump,
       MessagePumpLibevent::FileDescriptorWatcher* controller) {
+#if defined(OS_LINUX)
+    pump->OnFileDescriptorReady(
+        0, controller, MessagePumpLibevent::WATCH_READ_WRITE);
+#else
     pump->OnLibeventNotification(0, EV_WRITE | EV_READ, controller);
+#endif
   }
 
   MessageLoop ui_loop_;
@@ -140,6 +150,175 @@ TEST_F(MessagePumpLibeventTest, StopWatcher) {
   OnLibeventNotification(pump, &watcher);
 }
 
+// A connected socket pair, closed on destruction.
+class SocketPair {
+ public:
+  SocketPair() {
+    fds_[0] = fds_[1] = -1;
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+  }
+  ~SocketPair() {
+    for (int i = 0; i < 2; ++i) {
+      if (fds_[i] >= 0)
+        EXPECT_EQ(0, HANDLE_EINTR(close(fds_[i])));
+    }
+  }
+
+  int fd(int i) const { return fds_[i]; }
+
+  void Send(const char* data, size_t size) {
+    EXPECT_EQ(static_cast<ssize_t>(size),
+              HANDLE_EINTR(write(fds_[1], data, size)));
+  }
+
+ private:
+  int fds_[2];
+};
+
+// Reads a single byte per notification and counts the notifications.  If
+// |rearm| is set, it watches again (one-shot) from each notification.
+class ByteReader : public MessagePumpLibevent::Watcher {
+ public:
+  ByteReader(MessagePumpLibevent::FileDescriptorWatcher* controller,
+             bool rearm)
+      : controller_(controller),
+        rearm_(rearm),
+        reads_(0) {
+  }
+  virtual ~ByteReader() {}
+
+  int reads() const { return reads_; }
+
+  // base:MessagePumpLibevent::Watcher interface
+  virtual void OnFileCanReadWithoutBlocking(int fd) OVERRIDE {
+    char c;
+    if (HANDLE_EINTR(read(fd, &c, 1)) == 1)
+      ++reads_;
+    if (rearm_) {
+      EXPECT_TRUE(MessageLoopForIO::current()->WatchFileDescriptor(
+          fd, false, MessageLoopForIO::WATCH_READ, controller_, this));
+    }
+  }
+  virtual void OnFileCanWriteWithoutBlocking(int fd) OVERRIDE {
+    NOTREACHED();
+  }
+
+ private:
+  MessagePumpLibevent::FileDescriptorWatcher* const controller_;
+  const bool rearm_;
+  int reads_;
+};
+
+TEST(MessagePumpLibeventIOTest, PersistentWatchesInOneBatch) {
+  MessageLoopForIO loop;
+  const int kNumSockets = 10;
+  SocketPair sockets[kNumSockets];
+  MessagePumpLibevent::FileDescriptorWatcher controllers[kNumSockets];
+  ScopedVector<ByteReader> readers;
+  for (int i = 0; i < kNumSockets; ++i) {
+    readers.push_back(new ByteReader(&controllers[i], false));
+    ASSERT_TRUE(loop.WatchFileDescriptor(
+        sockets[i].fd(0), true, MessageLoopForIO::WATCH_READ,
+        &controllers[i], readers[i]));
+    sockets[i].Send("ab", 2);
+  }
+
+  loop.RunAllPending();
+  for (int i = 0; i < kNumSockets; ++i)
+    EXPECT_EQ(2, readers[i]->reads());
+}
+
+TEST(MessagePumpLibeventIOTest, RearmOneShotWatch) {
+  MessageLoopForIO loop;
+  SocketPair sockets;
+  MessagePumpLibevent::FileDescriptorWatcher controller;
+  ByteReader reader(&controller, true);
+  ASSERT_TRUE(loop.WatchFileDescriptor(
+      sockets.fd(0), false, MessageLoopForIO::WATCH_READ, &controller,
+      &reader));
+  sockets.Send("abc", 3);
+  loop.RunAllPending();
+  EXPECT_EQ(3, reader.reads());
+
+  // Once the watch is no longer re-armed, further data goes unnoticed.
+  controller.StopWatchingFileDescriptor();
+  sockets.Send("d", 1);
+  loop.RunAllPending();
+  EXPECT_EQ(3, reader.reads());
+}
+
+#if defined(OS_LINUX)
+
+TEST(MessagePumpLibeventIOTest, EdgeTriggered) {
+  MessageLoopForIO loop;
+  SocketPair sockets;
+  MessagePumpLibevent::FileDescriptorWatcher controller;
+  controller.set_edge_triggered(true);
+  ByteReader reader(&controller, false);
+  ASSERT_TRUE(loop.WatchFileDescriptor(
+      sockets.fd(0), true, MessageLoopForIO::WATCH_READ, &controller,
+      &reader));
+
+  // The reader leaves a byte behind, but is only told about new data.
+  sockets.Send("ab", 2);
+  loop.RunAllPending();
+  EXPECT_EQ(1, reader.reads());
+  sockets.Send("c", 1);
+  loop.RunAllPending();
+  EXPECT_EQ(2, reader.reads());
+}
+
+#endif  // defined(OS_LINUX)
+
+// Deletes another controller watching the same descriptor.
+class DeleteOtherWatcher : public MessagePumpLibevent::Watcher {
+ public:
+  explicit DeleteOtherWatcher(
+      MessagePumpLibevent::FileDescriptorWatcher* other)
+      : other_(other) {
+  }
+  virtual ~DeleteOtherWatcher() {}
+
+  bool deleted_other() const { return !other_; }
+
+  // base:MessagePumpLibevent::Watcher interface
+  virtual void OnFileCanReadWithoutBlocking(int /* fd */) OVERRIDE {
+    delete other_;
+    other_ = NULL;
+  }
+  virtual void OnFileCanWriteWithoutBlocking(int /* fd */) OVERRIDE {
+    delete other_;
+    other_ = NULL;
+  }
+
+ private:
+  MessagePumpLibevent::FileDescriptorWatcher* other_;
+};
+
+TEST(MessagePumpLibeventIOTest, DeleteOtherWatcherOnSameDescriptor) {
+  MessageLoopForIO loop;
+  SocketPair sockets;
+  // The descriptor is both readable and writable, so whichever controller
+  // is told first deletes the other.
+  sockets.Send("a", 1);
+  MessagePumpLibevent::FileDescriptorWatcher* first =
+      new MessagePumpLibevent::FileDescriptorWatcher;
+  MessagePumpLibevent::FileDescriptorWatcher* second =
+      new MessagePumpLibevent::FileDescriptorWatcher;
+  DeleteOtherWatcher first_delegate(second);
+  DeleteOtherWatcher second_delegate(first);
+  ASSERT_TRUE(loop.WatchFileDescriptor(
+      sockets.fd(0), false, MessageLoopForIO::WATCH_READ, first,
+      &first_delegate));
+  ASSERT_TRUE(loop.WatchFileDescriptor(
+      sockets.fd(0), false, MessageLoopForIO::WATCH_WRITE, second,
+      &second_delegate));
+  loop.RunAllPending();
+
+  EXPECT_NE(first_delegate.deleted_other(), second_delegate.deleted_other());
+  delete (first_delegate.deleted_other() ? first : second);
+}
+
 }  // namespace
 
 }  // namespace base
@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <string>
 
+#include "base/atomicops.h"
 #include "base/debug/leak_annotations.h"
 #include "base/logging.h"
 #include "base/pickle.h"
@@ -149,7 +150,7 @@ void Histogram::AddBoolean(bool value) {
 }
 
 void Histogram::AddSampleSet(const SampleSet& sample) {
-  sample_.Add(sample);
+  sample_.AtomicAdd(sample);
 }
 
 void Histogram::SetRangeDescriptions(const DescriptionPair descriptions[]) {
@@ -393,11 +394,10 @@ size_t Histogram::bucket_count() const {
   return bucket_count_;
 }
 
-// Do a safe atomic snapshot of sample data.
-// This implementation assumes we are on a safe single thread.
+// Do a safe atomic snapshot of sample data. Samples may be added on other
+// threads while this runs.
 void Histogram::SnapshotSample(SampleSet* sample) const {
-  // Note locking not done in this version!!!
-  *sample = sample_;
+  sample_.AtomicSnapshot(sample);
 }
 
 bool Histogram::HasConstructorArguments(Sample minimum,
@@ -553,8 +553,7 @@ const std::string Histogram::GetAsciiBucketRange(size_t i) const {
 
 // Update histogram data with new sample.
 void Histogram::Accumulate(Sample value, Count count, size_t index) {
-  // Note locking not done in this version!!!
-  sample_.Accumulate(value, count, index);
+  sample_.AtomicAccumulate(value, count, index);
 }
 
 void Histogram::SetBucketRange(size_t i, Sample value) {
@@ -729,6 +728,72 @@ void Histogram::SampleSet::Accumulate(Sample value,  Count count,
   DCHECK_GE(redundant_count_, 0);
 }
 
+// Histogram::Count and the 64-bit totals are updated in place with the
+// atomic operations for the same-sized types.
+COMPILE_ASSERT(sizeof(Histogram::Count) == sizeof(subtle::Atomic32),
+               count_must_be_atomic32);
+#if defined(ARCH_CPU_64_BITS)
+COMPILE_ASSERT(sizeof(int64) == sizeof(subtle::Atomic64),
+               int64_must_be_atomic64);
+
+namespace {
+
+inline volatile subtle::Atomic64* AsAtomic64(int64* value) {
+  return reinterpret_cast<volatile subtle::Atomic64*>(value);
+}
+
+inline int64 AtomicLoad64(const int64* value) {
+  return subtle::NoBarrier_Load(
+      reinterpret_cast<const volatile subtle::Atomic64*>(value));
+}
+
+}  // namespace
+#endif  // defined(ARCH_CPU_64_BITS)
+
+void Histogram::SampleSet::AtomicAccumulate(Sample value, Count count,
+                                            size_t index) {
+  DCHECK(count == 1 || count == -1);
+  DCHECK_LT(index, counts_.size());
+  subtle::NoBarrier_AtomicIncrement(&counts_[index], count);
+#if defined(ARCH_CPU_64_BITS)
+  subtle::NoBarrier_AtomicIncrement(AsAtomic64(&sum_),
+                                    static_cast<int64>(count) * value);
+  subtle::NoBarrier_AtomicIncrement(AsAtomic64(&redundant_count_), count);
+#else
+  sum_ += count * value;
+  redundant_count_ += count;
+#endif
+}
+
+void Histogram::SampleSet::AtomicAdd(const SampleSet& other) {
+  DCHECK_EQ(counts_.size(), other.counts_.size());
+#if defined(ARCH_CPU_64_BITS)
+  subtle::NoBarrier_AtomicIncrement(AsAtomic64(&sum_), other.sum_);
+  subtle::NoBarrier_AtomicIncrement(AsAtomic64(&redundant_count_),
+                                    other.redundant_count_);
+#else
+  sum_ += other.sum_;
+  redundant_count_ += other.redundant_count_;
+#endif
+  for (size_t index = 0; index < counts_.size(); ++index) {
+    if (other.counts_[index])
+      subtle::NoBarrier_AtomicIncrement(&counts_[index], other.counts_[index]);
+  }
+}
+
+void Histogram::SampleSet::AtomicSnapshot(SampleSet* snapshot) const {
+  snapshot->counts_.resize(counts_.size());
+  for (size_t index = 0; index < counts_.size(); ++index)
+    snapshot->counts_[index] = subtle::NoBarrier_Load(&counts_[index]);
+#if defined(ARCH_CPU_64_BITS)
+  snapshot->sum_ = AtomicLoad64(&sum_);
+  snapshot->redundant_count_ = AtomicLoad64(&redundant_count_);
+#else
+  snapshot->sum_ = sum_;
+  snapshot->redundant_count_ = redundant_count_;
+#endif
+}
+
 Count Histogram::SampleSet::TotalCount() const {
   Count total = 0;
   for (Counts::const_iterator it = counts_.begin();
@@ -765,7 +830,18 @@ bool Histogram::SampleSet::Serialize(Pickle* pickle) const {
   pickle->WriteInt64(redundant_count_);
   pickle->WriteUInt64(counts_.size());
 
+  // Most buckets of a delta are empty, so only the non-empty ones are written,
+  // each as its index followed by its count.
+  size_t non_empty_count = 0;
+  for (size_t index = 0; index < counts_.size(); ++index) {
+    if (counts_[index])
+      ++non_empty_count;
+  }
+  pickle->WriteUInt64(non_empty_count);
   for (size_t index = 0; index < counts_.size(); ++index) {
+    if (!counts_[index])
+      continue;
+    pickle->WriteUInt64(index);
     pickle->WriteInt(counts_[index]);
   }
 
@@ -778,23 +854,32 @@ bool Histogram::SampleSet::Deserialize(PickleIterator* iter) {
   DCHECK_EQ(redundant_count_, 0);
 
   uint64 counts_size;
+  uint64 non_empty_count;
 
   if (!iter->ReadInt64(&sum_) ||
       !iter->ReadInt64(&redundant_count_) ||
-      !iter->ReadUInt64(&counts_size)) {
+      !iter->ReadUInt64(&counts_size) ||
+      !iter->ReadUInt64(&non_empty_count)) {
     return false;
   }
 
-  if (counts_size == 0)
+  // The sizes may have come from an untrusted renderer.
+  if (counts_size == 0 || counts_size > kBucketCount_MAX ||
+      non_empty_count > counts_size) {
     return false;
+  }
 
+  counts_.resize(static_cast<size_t>(counts_size), 0);
   int count = 0;
-  for (uint64 index = 0; index < counts_size; ++index) {
-    int i;
-    if (!iter->ReadInt(&i))
+  for (uint64 i = 0; i < non_empty_count; ++i) {
+    uint64 index;
+    int bucket_count;
+    if (!iter->ReadUInt64(&index) || !iter->ReadInt(&bucket_count) ||
+        index >= counts_size) {
       return false;
-    counts_.push_back(i);
-    count += i;
+    }
+    counts_[static_cast<size_t>(index)] += bucket_count;
+    count += bucket_count;
   }
   DCHECK_EQ(count, redundant_count_);
   return count == redundant_count_;
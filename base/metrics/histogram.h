@@ -394,6 +394,23 @@ class BASE_EXPORT Histogram {
     // Accessor for histogram to make routine additions.
     void Accumulate(Sample value, Count count, size_t index);
 
+    // Like Accumulate, but safe to call concurrently from several threads,
+    // and concurrently with AtomicSnapshot(). Bucket counts are updated with
+    // atomic increments, so no samples are lost. On 64-bit platforms the sum
+    // and redundant count are updated atomically as well; on other platforms
+    // they are updated without synchronization, and may (rarely) drift from
+    // the bucket counts, which FindCorruption() already tolerates.
+    void AtomicAccumulate(Sample value, Count count, size_t index);
+
+    // Thread-safe version of Add(), for merging into a live sample set that
+    // is being updated with AtomicAccumulate().
+    void AtomicAdd(const SampleSet& other);
+
+    // Copies the current values into |snapshot| without locking. Each value is
+    // read atomically, but the copy as a whole is not a consistent cut if
+    // samples are being added concurrently.
+    void AtomicSnapshot(SampleSet* snapshot) const;
+
     // Accessor methods.
     Count counts(size_t i) const { return counts_[i]; }
     Count TotalCount() const;
@@ -518,8 +535,9 @@ class BASE_EXPORT Histogram {
   void set_cached_ranges(CachedRanges* cached_ranges) {
     cached_ranges_ = cached_ranges;
   }
-  // Snapshot the current complete set of sample data.
-  // Override with atomic/locked snapshot if needed.
+  // Snapshot the current complete set of sample data. The default
+  // implementation may be called while samples are being added on other
+  // threads; see SampleSet::AtomicSnapshot().
   virtual void SnapshotSample(SampleSet* sample) const;
 
   virtual bool HasConstructorArguments(Sample minimum, Sample maximum,
@@ -569,9 +587,11 @@ class BASE_EXPORT Histogram {
   virtual const std::string GetAsciiBucketRange(size_t it) const;
 
   //----------------------------------------------------------------------------
-  // Methods to override to create thread safe histogram.
+  // Methods to override to create histogram with different accumulation.
   //----------------------------------------------------------------------------
-  // Update all our internal data, including histogram
+  // Update all our internal data, including histogram. The default
+  // implementation is thread safe and lock free; see
+  // SampleSet::AtomicAccumulate().
   virtual void Accumulate(Sample value, Count count, size_t index);
 
   //----------------------------------------------------------------------------
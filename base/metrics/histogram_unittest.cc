@@ -7,8 +7,11 @@
 #include <algorithm>
 #include <vector>
 
+#include "base/memory/linked_ptr.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
+#include "base/pickle.h"
+#include "base/threading/simple_thread.h"
 #include "base/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -18,6 +21,24 @@ namespace {
 class HistogramTest : public testing::Test {
 };
 
+// Adds a fixed number of samples to a histogram when run.
+class SampleAdder : public DelegateSimpleThread::Delegate {
+ public:
+  SampleAdder(Histogram* histogram, int num_samples)
+      : histogram_(histogram),
+        num_samples_(num_samples) {
+  }
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < num_samples_; ++i)
+      histogram_->Add(i % 64);
+  }
+
+ private:
+  Histogram* histogram_;
+  int num_samples_;
+};
+
 // Check for basic syntax and use.
 TEST(HistogramTest, StartupShutdownTest) {
   // Try basic construction
@@ -425,6 +446,80 @@ TEST(HistogramTest, Crc32TableTest) {
   }
 }
 
+// Samples added concurrently from several threads should all be counted.
+TEST(HistogramTest, ConcurrentAdd) {
+  Histogram* histogram(Histogram::FactoryGet(
+      "ConcurrentHistogram", 1, 64, 8, Histogram::kNoFlags));
+
+  const int kNumThreads = 4;
+  const int kSamplesPerThread = 100000;
+  SampleAdder adder(histogram, kSamplesPerThread);
+  std::vector<linked_ptr<DelegateSimpleThread> > threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(make_linked_ptr(
+        new DelegateSimpleThread(&adder, "HistogramTest")));
+    threads.back()->Start();
+  }
+
+  // Snapshots taken while samples are being added must stay sane.
+  Histogram::SampleSet snapshot;
+  histogram->SnapshotSample(&snapshot);
+  EXPECT_LE(snapshot.TotalCount(), kNumThreads * kSamplesPerThread);
+
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Join();
+
+  Histogram::SampleSet final_snapshot;
+  histogram->SnapshotSample(&final_snapshot);
+  EXPECT_EQ(kNumThreads * kSamplesPerThread, final_snapshot.TotalCount());
+#if defined(ARCH_CPU_64_BITS)
+  EXPECT_EQ(kNumThreads * kSamplesPerThread,
+            final_snapshot.redundant_count());
+  EXPECT_EQ(0, histogram->FindCorruption(final_snapshot));
+#endif
+}
+
+// AddSampleSet() merges a snapshot into the live samples.
+TEST(HistogramTest, AddSampleSet) {
+  Histogram* histogram(Histogram::FactoryGet(
+      "AddSampleSetHistogram", 1, 64, 8, Histogram::kNoFlags));
+  histogram->Add(20);
+  histogram->Add(40);
+
+  Histogram::SampleSet snapshot;
+  histogram->SnapshotSample(&snapshot);
+  histogram->AddSampleSet(snapshot);
+
+  Histogram::SampleSet merged;
+  histogram->SnapshotSample(&merged);
+  EXPECT_EQ(4, merged.TotalCount());
+  EXPECT_EQ(4, merged.redundant_count());
+  EXPECT_EQ(120, merged.sum());
+  EXPECT_EQ(0, histogram->FindCorruption(merged));
+}
+
+TEST(HistogramTest, SampleSetSerializeRoundTrip) {
+  Histogram* histogram(Histogram::FactoryGet(
+      "SampleSetSerializeHistogram", 1, 1000, 50, Histogram::kNoFlags));
+  histogram->Add(3);
+  histogram->Add(3);
+  histogram->Add(500);
+
+  Histogram::SampleSet snapshot;
+  histogram->SnapshotSample(&snapshot);
+  Pickle pickle;
+  EXPECT_TRUE(snapshot.Serialize(&pickle));
+
+  Histogram::SampleSet deserialized;
+  PickleIterator iter(pickle);
+  ASSERT_TRUE(deserialized.Deserialize(&iter));
+  EXPECT_EQ(snapshot.sum(), deserialized.sum());
+  EXPECT_EQ(3, deserialized.redundant_count());
+  for (size_t i = 0; i < histogram->bucket_count(); ++i)
+    EXPECT_EQ(snapshot.counts(i), deserialized.counts(i));
+  EXPECT_EQ(0, histogram->FindCorruption(deserialized));
+}
+
 // RangeTest, CustomRangeTest and CorruptBucketBounds test CachedRanges class.
 // The following tests sharing of CachedRanges object.
 TEST(HistogramTest, CachedRangesTest) {
@@ -37,7 +37,10 @@ namespace base {
 // +-------------------------------------------+
 //
 // The data layout is a grid, where the columns are the thread_ids and the
-// rows are the counter_ids.
+// rows are the counter_ids.  The grid is stored column by column, and each
+// column starts on a cache line of its own: a thread only ever writes to its
+// own column, so no two threads write to the same cache line.  Reads sum a
+// row across the columns.
 //
 // If the first character of the thread_name is '\0', then that column is
 // empty.
@@ -72,7 +75,10 @@ namespace {
 
 // An internal version in case we ever change the format of this
 // file, and so that we can identify our table.
-const int kTableVersion = 0x13131313;
+const int kTableVersion = 0x13131314;
+
+// The alignment of each thread's column of counters.
+const int kCacheLineSize = 64;
 
 // The name for un-named counters and threads in the table.
 const char kUnknownName[] = "<unknown>";
@@ -86,6 +92,17 @@ inline int AlignedSize(int size) {
   return size + AlignOffset(size);
 }
 
+// Calculates delta to align an offset to a cache line.
+inline int CacheLineAlignOffset(int offset) {
+  return (kCacheLineSize - (offset % kCacheLineSize)) % kCacheLineSize;
+}
+
+// The space taken by one thread's column of counters.
+inline int ColumnSize(int max_counters) {
+  int size = max_counters * sizeof(int);
+  return size + CacheLineAlignOffset(size);
+}
+
 }  // namespace
 
 // The StatsTable::Private maintains convenience pointers into the
@@ -130,10 +147,14 @@ class StatsTable::Private {
     return &counter_names_table_[
       (counter_id-1) * (StatsTable::kMaxCounterNameLength)];
   }
-  int* row(int counter_id) const {
-    return &data_table_[(counter_id-1) * max_threads()];
+  int* location(int counter_id, int slot_id) const {
+    return &data_table_[(slot_id-1) * column_stride_ + (counter_id-1)];
   }
 
+  // The space the table needs, rounded up so that the columns can start on
+  // cache lines wherever the table is mapped.
+  static int ComputeTableSize(int max_threads, int max_counters);
+
  private:
   // Constructor is private because you should use New() instead.
   Private()
@@ -142,7 +163,8 @@ class StatsTable::Private {
         thread_tid_table_(NULL),
         thread_pid_table_(NULL),
         counter_names_table_(NULL),
-        data_table_(NULL) {
+        data_table_(NULL),
+        column_stride_(0) {
   }
 
   // Initializes the table on first access.  Sets header values
@@ -160,8 +182,22 @@ class StatsTable::Private {
   int* thread_pid_table_;
   char* counter_names_table_;
   int* data_table_;
+  // The distance, in ints, between two threads' columns.
+  int column_stride_;
 };
 
+// static
+int StatsTable::Private::ComputeTableSize(int max_threads, int max_counters) {
+  return
+    AlignedSize(sizeof(TableHeader)) +
+    AlignedSize((max_counters * sizeof(char) * kMaxCounterNameLength)) +
+    AlignedSize((max_threads * sizeof(char) * kMaxThreadNameLength)) +
+    AlignedSize(max_threads * sizeof(int)) +
+    AlignedSize(max_threads * sizeof(int)) +
+    kCacheLineSize +
+    max_threads * ColumnSize(max_counters);
+}
+
 // static
 StatsTable::Private* StatsTable::Private::New(const std::string& name,
                                               int size,
@@ -230,10 +266,11 @@ void StatsTable::Private::ComputeMappedPointers(void* memory) {
             max_counters() * StatsTable::kMaxCounterNameLength;
   offset += AlignOffset(offset);
 
-  data_table_ = reinterpret_cast<int*>(data + offset);
-  offset += sizeof(int) * max_threads() * max_counters();
-
-  DCHECK_EQ(offset, size());
+  // Mappings are page aligned, so aligning the offset aligns the address.
+  int data_offset = offset + CacheLineAlignOffset(offset);
+  data_table_ = reinterpret_cast<int*>(data + data_offset);
+  column_stride_ = ColumnSize(max_counters()) / sizeof(int);
+  DCHECK_LE(data_offset + max_threads() * ColumnSize(max_counters()), size());
 }
 
 // TLSData carries the data stored in the TLS slots for the
@@ -254,13 +291,7 @@ StatsTable::StatsTable(const std::string& name, int max_threads,
                        int max_counters)
     : impl_(NULL),
       tls_index_(SlotReturnFunction) {
-  int table_size =
-    AlignedSize(sizeof(Private::TableHeader)) +
-    AlignedSize((max_counters * sizeof(char) * kMaxCounterNameLength)) +
-    AlignedSize((max_threads * sizeof(char) * kMaxThreadNameLength)) +
-    AlignedSize(max_threads * sizeof(int)) +
-    AlignedSize(max_threads * sizeof(int)) +
-    AlignedSize((sizeof(int) * (max_counters * max_threads)));
+  int table_size = Private::ComputeTableSize(max_threads, max_counters);
 
   impl_ = Private::New(name, table_size, max_threads, max_counters);
 
@@ -349,12 +380,13 @@ int StatsTable::FindCounter(const std::string& name) {
 
   // Create a scope for our auto-lock.
   {
-    AutoLock scoped_lock(counters_lock_);
+    CounterShard* shard = GetCounterShard(name);
+    AutoLock scoped_lock(shard->lock);
 
     // Attempt to find the counter.
     CountersMap::const_iterator iter;
-    iter = counters_.find(name);
-    if (iter != counters_.end())
+    iter = shard->counters.find(name);
+    if (iter != shard->counters.end())
       return iter->second;
   }
 
@@ -368,8 +400,7 @@ int* StatsTable::GetLocation(int counter_id, int slot_id) const {
   if (slot_id > impl_->max_threads())
     return NULL;
 
-  int* row = impl_->row(counter_id);
-  return &(row[slot_id-1]);
+  return impl_->location(counter_id, slot_id);
 }
 
 const char* StatsTable::GetRowName(int index) const {
@@ -388,10 +419,9 @@ int StatsTable::GetRowValue(int index, int pid) const {
     return 0;
 
   int rv = 0;
-  int* row = impl_->row(index);
-  for (int slot_id = 0; slot_id < impl_->max_threads(); slot_id++) {
+  for (int slot_id = 1; slot_id <= impl_->max_threads(); slot_id++) {
     if (pid == 0 || *impl_->thread_pid(slot_id) == pid)
-      rv += row[slot_id];
+      rv += *impl_->location(index, slot_id);
   }
   return rv;
 }
@@ -540,12 +570,19 @@ int StatsTable::AddCounter(const std::string& name) {
 
   // now add to our in-memory cache
   {
-    AutoLock lock(counters_lock_);
-    counters_[name] = counter_id;
+    CounterShard* shard = GetCounterShard(name);
+    AutoLock lock(shard->lock);
+    shard->counters[name] = counter_id;
   }
   return counter_id;
 }
 
+StatsTable::CounterShard* StatsTable::GetCounterShard(
+    const std::string& name) {
+  size_t hash = BASE_HASH_NAMESPACE::hash<std::string>()(name);
+  return &counters_[hash % kNumCounterShards];
+}
+
 StatsTable::TLSData* StatsTable::GetTLSData() const {
   TLSData* data =
     static_cast<TLSData*>(tls_index_.Get());
@@ -135,6 +135,17 @@ class BASE_EXPORT StatsTable {
   struct TLSData;
   typedef hash_map<std::string, int> CountersMap;
 
+  // counters_ is split into shards by name, each with its own lock, so that
+  // threads looking up different counters do not contend.
+  struct CounterShard {
+    base::Lock lock;
+    CountersMap counters;
+  };
+  static const int kNumCounterShards = 16;
+
+  // Returns the shard caching |name|.
+  CounterShard* GetCounterShard(const std::string& name);
+
   // Returns the space occupied by a thread in the table.  Generally used
   // if a thread terminates but the process continues.  This function
   // does not zero out the thread's counters.
@@ -175,15 +186,12 @@ class BASE_EXPORT StatsTable {
 
   Private* impl_;
 
-  // The counters_lock_ protects the counters_ hash table.
-  base::Lock counters_lock_;
-
-  // The counters_ hash map is an in-memory hash of the counters.
-  // It is used for quick lookup of counters, but is cannot be used
+  // The counters_ hash maps are an in-memory hash of the counters.
+  // They are used for quick lookup of counters, but cannot be used
   // as a substitute for what is in the shared memory.  Even though
   // we don't have a counter in our hash table, another process may
   // have created it.
-  CountersMap counters_;
+  CounterShard counters_[kNumCounterShards];
   ThreadLocalStorage::Slot tls_index_;
 
   static StatsTable* global_table_;
@@ -2,6 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+
 #include "base/metrics/stats_counters.h"
 #include "base/metrics/stats_table.h"
 #include "base/shared_memory.h"
@@ -58,6 +60,46 @@ TEST_F(StatsTableTest, VerifySlots) {
   DeleteShmem(kTableName);
 }
 
+// Each thread's counters live in a column of their own, and the columns start
+// on separate cache lines.
+TEST_F(StatsTableTest, ThreadColumnsDoNotShareCacheLines) {
+  const std::string kTableName = "ThreadColumnsStatTable";
+  const int kMaxThreads = 4;
+  const int kMaxCounter = 5;
+  const uintptr_t kCacheLineSize = 64;
+  DeleteShmem(kTableName);
+  StatsTable table(kTableName, kMaxThreads, kMaxCounter);
+
+  int first_counter = table.FindCounter("counter.first");
+  int last_counter = first_counter;
+  for (int index = 1; index < kMaxCounter; index++)
+    last_counter = table.FindCounter(base::StringPrintf("counter.%d", index));
+  ASSERT_GT(first_counter, 0);
+  ASSERT_GT(last_counter, 0);
+
+  for (int slot = 1; slot <= kMaxThreads; slot++) {
+    uintptr_t first = reinterpret_cast<uintptr_t>(
+        table.GetLocation(first_counter, slot));
+    uintptr_t last = reinterpret_cast<uintptr_t>(
+        table.GetLocation(last_counter, slot));
+    EXPECT_EQ(0U, std::min(first, last) % kCacheLineSize);
+    EXPECT_EQ(first / kCacheLineSize, last / kCacheLineSize);
+    if (slot > 1) {
+      uintptr_t previous = reinterpret_cast<uintptr_t>(
+          table.GetLocation(first_counter, slot - 1));
+      EXPECT_GE(std::min(first, last), previous + kCacheLineSize);
+    }
+  }
+
+  // Rows are still summed across the threads.
+  for (int slot = 1; slot <= kMaxThreads; slot++)
+    *table.GetLocation(last_counter, slot) = slot;
+  EXPECT_EQ(1 + 2 + 3 + 4, table.GetRowValue(last_counter));
+  EXPECT_EQ(0, table.GetRowValue(first_counter));
+
+  DeleteShmem(kTableName);
+}
+
 // CounterZero will continually be set to 0.
 const std::string kCounterZero = "CounterZero";
 // Counter1313 will continually be set to 1313.
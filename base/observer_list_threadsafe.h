@@ -8,9 +8,11 @@
 
 #include <algorithm>
 #include <map>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/bind.h"
+#include "base/callback.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
@@ -47,8 +49,10 @@
 //   IMPLEMENTATION NOTES
 //   The ObserverListThreadSafe maintains an ObserverList for each thread
 //   which uses the ThreadSafeObserver.  When Notifying the observers,
-//   we simply call PostTask to each registered thread, and then each thread
-//   will notify its regular ObserverList.
+//   we queue the notification for each registered thread, and then each
+//   thread will notify its regular ObserverList.  A task is only posted to a
+//   thread when its queue was empty, so a burst of notifications costs one
+//   task per thread; they are still delivered one by one and in order.
 //
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -74,6 +78,12 @@ class UnboundMethod {
   Params p_;
 };
 
+// Runs |method| on |obj|. Used to bind an UnboundMethod into a callback.
+template <class T, class Method, class Params>
+void RunUnboundMethod(const UnboundMethod<T, Method, Params>& method, T* obj) {
+  method.Run(obj);
+}
+
 // This class is used to work around VS2005 not accepting:
 //
 // friend class
@@ -206,15 +216,23 @@ class ObserverListThreadSafe
   // See comment above ObserverListThreadSafeTraits' definition.
   friend struct ObserverListThreadSafeTraits<ObserverType>;
 
+  typedef base::Callback<void(ObserverType*)> NotificationCallback;
+
   struct ObserverListContext {
     explicit ObserverListContext(NotificationType type)
         : loop(base::MessageLoopProxy::current()),
-          list(type) {
+          list(type),
+          delivery_pending(false) {
     }
 
     scoped_refptr<base::MessageLoopProxy> loop;
     ObserverList<ObserverType> list;
 
+    // The notifications waiting to be delivered on |loop|, and whether a task
+    // to deliver them has been posted.  Protected by |list_lock_|.
+    std::vector<NotificationCallback> pending_notifications;
+    bool delivery_pending;
+
     DISALLOW_COPY_AND_ASSIGN(ObserverListContext);
   };
 
@@ -227,23 +245,32 @@ class ObserverListThreadSafe
 
   template <class Method, class Params>
   void Notify(const UnboundMethod<ObserverType, Method, Params>& method) {
+    NotificationCallback notification = base::Bind(
+        &RunUnboundMethod<ObserverType, Method, Params>, method);
     base::AutoLock lock(list_lock_);
     typename ObserversListMap::iterator it;
     for (it = observer_lists_.begin(); it != observer_lists_.end(); ++it) {
       ObserverListContext* context = (*it).second;
-      context->loop->PostTask(
-          FROM_HERE,
-          base::Bind(&ObserverListThreadSafe<ObserverType>::
-              template NotifyWrapper<Method, Params>, this, context, method));
+      context->pending_notifications.push_back(notification);
+      if (context->delivery_pending)
+        continue;
+      if (context->loop->PostTask(
+              FROM_HERE,
+              base::Bind(&ObserverListThreadSafe<ObserverType>::NotifyWrapper,
+                         this, context))) {
+        context->delivery_pending = true;
+      } else {
+        // The thread is gone, so the notifications can never be delivered.
+        context->pending_notifications.clear();
+      }
     }
   }
 
-  // Wrapper which is called to fire the notifications for each thread's
-  // ObserverList.  This function MUST be called on the thread which owns
-  // the unsafe ObserverList.
-  template <class Method, class Params>
-  void NotifyWrapper(ObserverListContext* context,
-      const UnboundMethod<ObserverType, Method, Params>& method) {
+  // Wrapper which is called to fire the pending notifications for each
+  // thread's ObserverList.  This function MUST be called on the thread which
+  // owns the unsafe ObserverList.
+  void NotifyWrapper(ObserverListContext* context) {
+    std::vector<NotificationCallback> notifications;
 
     // Check that this list still needs notifications.
     {
@@ -257,13 +284,21 @@ class ObserverListThreadSafe
       // notification.
       if (it == observer_lists_.end() || it->second != context)
         return;
+
+      notifications.swap(context->pending_notifications);
+      context->delivery_pending = false;
     }
 
-    {
-      typename ObserverList<ObserverType>::Iterator it(context->list);
-      ObserverType* obs;
-      while ((obs = it.GetNext()) != NULL)
-        method.Run(obs);
+    for (size_t i = 0; i < notifications.size(); ++i) {
+      {
+        typename ObserverList<ObserverType>::Iterator it(context->list);
+        ObserverType* obs;
+        while ((obs = it.GetNext()) != NULL)
+          notifications[i].Run(obs);
+      }
+      // Stop once every observer has removed itself.
+      if (context->list.size() == 0)
+        break;
     }
 
     // If there are no more observers on the list, we can now delete it.
@@ -269,6 +269,41 @@ TEST(ObserverListThreadSafeTest, RemoveObserver) {
   EXPECT_EQ(b.total, 0);
 }
 
+// Notifications made before the observer thread runs are delivered together,
+// in order, and not to observers removed by an earlier one.
+TEST(ObserverListThreadSafeTest, BatchedNotifications) {
+  MessageLoop loop;
+
+  scoped_refptr<ObserverListThreadSafe<Foo> > observer_list(
+      new ObserverListThreadSafe<Foo>);
+  Adder a(1);
+  Adder c(1);
+  ThreadSafeDisrupter evil(observer_list.get(), &c);
+
+  observer_list->AddObserver(&a);
+  observer_list->AddObserver(&evil);
+  observer_list->AddObserver(&c);
+
+  observer_list->Notify(&Foo::Observe, 1);
+  observer_list->Notify(&Foo::Observe, 2);
+  observer_list->Notify(&Foo::Observe, 3);
+  loop.RunAllPending();
+
+  EXPECT_EQ(6, a.total);
+  EXPECT_EQ(0, c.total);
+
+  observer_list->RemoveObserver(&a);
+  observer_list->RemoveObserver(&evil);
+
+  // An observer removing itself leaves the list empty halfway through a batch.
+  ThreadSafeDisrupter self_remover(observer_list.get(), &self_remover);
+  observer_list->AddObserver(&self_remover);
+  observer_list->Notify(&Foo::Observe, 1);
+  observer_list->Notify(&Foo::Observe, 2);
+  loop.RunAllPending();
+  observer_list->AssertEmpty();
+}
+
 TEST(ObserverListThreadSafeTest, WithoutMessageLoop) {
   scoped_refptr<ObserverListThreadSafe<Foo> > observer_list(
       new ObserverListThreadSafe<Foo>);
@@ -4,6 +4,9 @@
 
 #include "base/pending_task.h"
 
+#include <algorithm>
+
+#include "base/logging.h"
 #include "base/tracked_objects.h"
 
 namespace base {
@@ -51,4 +54,202 @@ void TaskQueue::Swap(TaskQueue* queue) {
   c.swap(queue->c);  // Calls std::deque::swap.
 }
 
+namespace {
+
+// Values of DelayedTaskQueue::Entry::level for entries outside the wheel.
+const int kReadyLevel = -1;
+const int kOverflowLevel = -2;
+
+}  // namespace
+
+struct DelayedTaskQueue::Entry {
+  explicit Entry(const PendingTask& pending_task)
+      : task(pending_task),
+        tick(pending_task.delayed_run_time.ToInternalValue() /
+             Time::kMicrosecondsPerMillisecond),
+        level(kReadyLevel),
+        slot(0),
+        prev(NULL),
+        next(NULL) {
+  }
+
+  PendingTask task;
+  int64 tick;
+
+  // Where the entry is filed: a wheel level and slot, kReadyLevel or
+  // kOverflowLevel.
+  int level;
+  int slot;
+
+  // Links within a slot or |overflow_|.
+  Entry* prev;
+  Entry* next;
+};
+
+bool DelayedTaskQueue::EntryLess::operator()(const Entry* a,
+                                             const Entry* b) const {
+  if (a->task.delayed_run_time != b->task.delayed_run_time)
+    return a->task.delayed_run_time < b->task.delayed_run_time;
+  // Compare the difference to support integer roll-over.
+  int sequence_delta = a->task.sequence_num - b->task.sequence_num;
+  if (sequence_delta != 0)
+    return sequence_delta < 0;
+  // Only reached for callers that do not number their tasks; keep the set
+  // ordering strict.
+  return a < b;
+}
+
+DelayedTaskQueue::DelayedTaskQueue()
+    : overflow_(NULL),
+      current_tick_(0),
+      size_(0) {
+  for (int level = 0; level < kNumLevels; ++level) {
+    for (int slot = 0; slot < kSlotsPerLevel; ++slot)
+      slots_[level][slot] = NULL;
+    level_sizes_[level] = 0;
+  }
+}
+
+DelayedTaskQueue::~DelayedTaskQueue() {
+  // Destroy the tasks in order, as MessageLoop does, in case of dependencies
+  // between them.
+  while (!empty())
+    pop();
+}
+
+const PendingTask& DelayedTaskQueue::top() {
+  DCHECK(!empty());
+  if (ready_.empty())
+    AdvanceToNextTask();
+  return (*ready_.begin())->task;
+}
+
+void DelayedTaskQueue::push(const PendingTask& pending_task) {
+  Entry* entry = new Entry(pending_task);
+  index_[pending_task.sequence_num] = entry;
+  ++size_;
+  Place(entry);
+}
+
+void DelayedTaskQueue::pop() {
+  DCHECK(!empty());
+  if (ready_.empty())
+    AdvanceToNextTask();
+  Destroy(*ready_.begin());
+}
+
+bool DelayedTaskQueue::Remove(int sequence_num) {
+  EntryIndex::iterator it = index_.find(sequence_num);
+  if (it == index_.end())
+    return false;
+  Destroy(it->second);
+  return true;
+}
+
+void DelayedTaskQueue::Place(Entry* entry) {
+  if (entry->tick <= current_tick_) {
+    entry->level = kReadyLevel;
+    ready_.insert(entry);
+    return;
+  }
+
+  Entry** head = &overflow_;
+  entry->level = kOverflowLevel;
+  for (int level = 0; level < kNumLevels; ++level) {
+    int shift = kBitsPerLevel * (level + 1);
+    if ((entry->tick >> shift) == (current_tick_ >> shift)) {
+      entry->level = level;
+      entry->slot = static_cast<int>(
+          (entry->tick >> (kBitsPerLevel * level)) & kSlotMask);
+      head = &slots_[level][entry->slot];
+      ++level_sizes_[level];
+      break;
+    }
+  }
+
+  entry->prev = NULL;
+  entry->next = *head;
+  if (*head)
+    (*head)->prev = entry;
+  *head = entry;
+}
+
+void DelayedTaskQueue::Unlink(Entry* entry) {
+  if (entry->level == kReadyLevel) {
+    ready_.erase(entry);
+    return;
+  }
+
+  Entry** head = &overflow_;
+  if (entry->level != kOverflowLevel) {
+    head = &slots_[entry->level][entry->slot];
+    --level_sizes_[entry->level];
+  }
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    *head = entry->next;
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  entry->prev = entry->next = NULL;
+}
+
+void DelayedTaskQueue::Destroy(Entry* entry) {
+  Unlink(entry);
+  EntryIndex::iterator it = index_.find(entry->task.sequence_num);
+  if (it != index_.end() && it->second == entry)
+    index_.erase(it);
+  --size_;
+  // The task's destructor may re-enter this queue (e.g. a Timer being torn
+  // down cancels its task), so it only runs once the entry is unreachable.
+  delete entry;
+}
+
+void DelayedTaskQueue::AdvanceToNextTask() {
+  DCHECK(ready_.empty());
+  DCHECK(!empty());
+
+  while (ready_.empty()) {
+    // Entries at a lower level are always due before those at a higher one.
+    int level = 0;
+    while (level < kNumLevels && level_sizes_[level] == 0)
+      ++level;
+
+    Entry* entries = NULL;
+    if (level < kNumLevels) {
+      // By the invariant on |slots_|, the first non-empty slot of the level
+      // lies after the cursor.  Move the cursor to the start of that slot.
+      int shift = kBitsPerLevel * level;
+      int slot = static_cast<int>((current_tick_ >> shift) & kSlotMask) + 1;
+      while (!slots_[level][slot]) {
+        ++slot;
+        DCHECK_LT(slot, static_cast<int>(kSlotsPerLevel));
+      }
+      int64 upper_bits = current_tick_ >> (shift + kBitsPerLevel);
+      current_tick_ = ((upper_bits << kBitsPerLevel) | slot) << shift;
+
+      entries = slots_[level][slot];
+      slots_[level][slot] = NULL;
+      for (Entry* entry = entries; entry; entry = entry->next)
+        --level_sizes_[level];
+    } else {
+      // The wheel is empty; jump straight to the earliest overflow entry.
+      DCHECK(overflow_);
+      current_tick_ = overflow_->tick;
+      for (Entry* entry = overflow_; entry; entry = entry->next)
+        current_tick_ = std::min(current_tick_, entry->tick);
+      entries = overflow_;
+      overflow_ = NULL;
+    }
+
+    // Refile the entries relative to the new cursor; the ones due now become
+    // ready and the rest cascade to lower levels.
+    while (entries) {
+      Entry* entry = entries;
+      entries = entry->next;
+      Place(entry);
+    }
+  }
+}
+
 }  // namespace base
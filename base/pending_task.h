@@ -7,9 +7,12 @@
 #pragma once
 
 #include <queue>
+#include <set>
 
 #include "base/base_export.h"
+#include "base/basictypes.h"
 #include "base/callback.h"
+#include "base/hash_tables.h"
 #include "base/location.h"
 #include "base/time.h"
 #include "base/tracking_info.h"
@@ -51,7 +54,87 @@ class BASE_EXPORT TaskQueue : public std::queue<PendingTask> {
 };
 
 // PendingTasks are sorted by their |delayed_run_time| property.
-typedef std::priority_queue<base::PendingTask> DelayedTaskQueue;
+// Holds delayed tasks and hands them out ordered by delayed_run_time, then by
+// sequence_num. The queue is a hierarchical timer wheel with millisecond
+// ticks: push() and Remove() are constant time, and tasks are only sorted
+// exactly once their tick comes up, so a large number of long timeouts that
+// mostly get cancelled (socket and DNS timers on the IO thread) costs little.
+class BASE_EXPORT DelayedTaskQueue {
+ public:
+  DelayedTaskQueue();
+  ~DelayedTaskQueue();
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Returns the task that should run first.  Must not be called when empty.
+  const PendingTask& top();
+
+  void push(const PendingTask& pending_task);
+
+  // Removes and destroys the task returned by top().
+  void pop();
+
+  // Removes and destroys the queued task with |sequence_num|.  Returns false
+  // if there is no such task, e.g. because it has already been popped.
+  bool Remove(int sequence_num);
+
+ private:
+  struct Entry;
+
+  // Orders entries like PendingTask::operator<, earliest first.
+  struct EntryLess {
+    bool operator()(const Entry* a, const Entry* b) const;
+  };
+
+  typedef std::set<Entry*, EntryLess> ReadySet;
+  typedef hash_map<int, Entry*> EntryIndex;
+
+  enum {
+    kBitsPerLevel = 6,
+    kSlotsPerLevel = 1 << kBitsPerLevel,
+    kSlotMask = kSlotsPerLevel - 1,
+    // Five levels of 64 slots span 2^30 ms (about 12 days) ahead of the
+    // cursor; entries further out wait in |overflow_|.
+    kNumLevels = 5,
+  };
+
+  // Files |entry| into |ready_|, a wheel slot or |overflow_| depending on how
+  // far its tick is from |current_tick_|.
+  void Place(Entry* entry);
+
+  // Takes |entry| out of whichever list or set holds it.
+  void Unlink(Entry* entry);
+
+  // Unlinks |entry|, drops it from |index_| and deletes it.
+  void Destroy(Entry* entry);
+
+  // Moves the cursor forward to the earliest pending tick and makes the
+  // entries due at it ready.  Must only be called when |ready_| is empty.
+  void AdvanceToNextTask();
+
+  // Sorted entries whose tick is at or before |current_tick_|.
+  ReadySet ready_;
+
+  // Heads of the doubly linked lists of entries in each slot.  An entry at
+  // level L shares all bits above level L of its tick with |current_tick_|,
+  // and its bits at level L are greater than those of |current_tick_|.
+  Entry* slots_[kNumLevels][kSlotsPerLevel];
+  size_t level_sizes_[kNumLevels];
+
+  // Entries too far ahead of the cursor for the wheel.
+  Entry* overflow_;
+
+  // The tick, in milliseconds since the TimeTicks origin, the wheel is at.
+  int64 current_tick_;
+
+  // Finds entries by sequence number for Remove().
+  EntryIndex index_;
+
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(DelayedTaskQueue);
+};
 
 }  // namespace base
 
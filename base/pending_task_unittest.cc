@@ -0,0 +1,145 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/pending_task.h"
+
+#include <queue>
+
+#include "base/bind.h"
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+void NullTask() {
+}
+
+// Sets |*destroyed| when deleted, to observe when a queued task goes away.
+class DestructionFlag {
+ public:
+  explicit DestructionFlag(bool* destroyed) : destroyed_(destroyed) {}
+  ~DestructionFlag() { *destroyed_ = true; }
+  void Run() {}
+
+ private:
+  bool* destroyed_;
+};
+
+class DelayedTaskQueueTest : public testing::Test {
+ protected:
+  DelayedTaskQueueTest()
+      : origin_(TimeTicks::Now()),
+        next_sequence_num_(0) {
+  }
+
+  PendingTask MakeTask(int64 delay_ms) {
+    return MakeTaskWithClosure(delay_ms, Bind(&NullTask));
+  }
+
+  PendingTask MakeTaskWithClosure(int64 delay_ms, const Closure& closure) {
+    PendingTask task(FROM_HERE, closure,
+                     origin_ + TimeDelta::FromMilliseconds(delay_ms), true);
+    task.sequence_num = next_sequence_num_++;
+    return task;
+  }
+
+  const TimeTicks origin_;
+  int next_sequence_num_;
+};
+
+}  // namespace
+
+TEST_F(DelayedTaskQueueTest, OrdersByRunTimeThenSequence) {
+  DelayedTaskQueue queue;
+  EXPECT_TRUE(queue.empty());
+
+  queue.push(MakeTask(30));  // 0
+  queue.push(MakeTask(10));  // 1
+  queue.push(MakeTask(20));  // 2
+  queue.push(MakeTask(10));  // 3
+  queue.push(MakeTask(0));   // 4
+  EXPECT_EQ(5U, queue.size());
+
+  const int kExpected[] = { 4, 1, 3, 2, 0 };
+  for (size_t i = 0; i < arraysize(kExpected); ++i) {
+    ASSERT_FALSE(queue.empty());
+    EXPECT_EQ(kExpected[i], queue.top().sequence_num);
+    queue.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(DelayedTaskQueueTest, MatchesPriorityQueue) {
+  // Pushes and pops at random, with delays spread from sub-tick to beyond the
+  // wheel's range, and checks the order against std::priority_queue.
+  const int64 kMaxDelaysMs[] = { 5, 5000, 5000000, 5000000000LL };
+  DelayedTaskQueue queue;
+  std::priority_queue<PendingTask> reference;
+  for (int i = 0; i < 20000; ++i) {
+    if (reference.empty() || RandInt(0, 2) != 0) {
+      int64 max_delay = kMaxDelaysMs[RandInt(0, arraysize(kMaxDelaysMs) - 1)];
+      PendingTask task = MakeTask(RandGenerator(max_delay));
+      queue.push(task);
+      reference.push(task);
+    } else {
+      ASSERT_EQ(reference.top().sequence_num, queue.top().sequence_num);
+      queue.pop();
+      reference.pop();
+    }
+    ASSERT_EQ(reference.size(), queue.size());
+  }
+  while (!reference.empty()) {
+    ASSERT_EQ(reference.top().sequence_num, queue.top().sequence_num);
+    queue.pop();
+    reference.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(DelayedTaskQueueTest, PushBehindCursor) {
+  DelayedTaskQueue queue;
+  queue.push(MakeTask(100000));  // 0
+  // Peeking moves the wheel ahead to the only task...
+  EXPECT_EQ(0, queue.top().sequence_num);
+  // ...but earlier tasks pushed afterwards still come out first.
+  queue.push(MakeTask(50));  // 1
+  queue.push(MakeTask(100000));  // 2
+  EXPECT_EQ(1, queue.top().sequence_num);
+  queue.pop();
+  EXPECT_EQ(0, queue.top().sequence_num);
+  queue.pop();
+  EXPECT_EQ(2, queue.top().sequence_num);
+  queue.pop();
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(DelayedTaskQueueTest, Remove) {
+  DelayedTaskQueue queue;
+  bool destroyed = false;
+  queue.push(MakeTask(10));
+  PendingTask removed = MakeTaskWithClosure(
+      1000,
+      Bind(&DestructionFlag::Run, Owned(new DestructionFlag(&destroyed))));
+  queue.push(removed);
+  queue.push(MakeTask(2000));
+  removed.task.Reset();
+
+  EXPECT_TRUE(queue.Remove(removed.sequence_num));
+  EXPECT_TRUE(destroyed);
+  EXPECT_FALSE(queue.Remove(removed.sequence_num));
+  EXPECT_EQ(2U, queue.size());
+
+  EXPECT_EQ(0, queue.top().sequence_num);
+  queue.pop();
+  EXPECT_FALSE(queue.Remove(0));
+  EXPECT_EQ(2, queue.top().sequence_num);
+
+  // Ready tasks can be removed too.
+  EXPECT_TRUE(queue.Remove(2));
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace base
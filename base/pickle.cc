@@ -15,6 +15,9 @@ const int Pickle::kPayloadUnit = 64;
 
 static const size_t kCapacityReadOnly = static_cast<size_t>(-1);
 
+// Pads external data out to the uint32 alignment of the payload.
+static const char kZeroPadding[sizeof(uint32)] = { 0 };
+
 PickleIterator::PickleIterator(const Pickle& pickle)
     : read_ptr_(pickle.payload()),
       read_end_ptr_(pickle.end_of_payload()) {
@@ -91,14 +94,11 @@ bool PickleIterator::ReadUInt64(uint64* result) {
 }
 
 bool PickleIterator::ReadString(std::string* result) {
-  int len;
-  if (!ReadInt(&len))
-    return false;
-  const char* read_from = GetReadPointerAndAdvance(len);
-  if (!read_from)
+  base::StringPiece piece;
+  if (!ReadStringPiece(&piece))
     return false;
 
-  result->assign(read_from, len);
+  piece.CopyToString(result);
   return true;
 }
 
@@ -115,14 +115,11 @@ bool PickleIterator::ReadWString(std::wstring* result) {
 }
 
 bool PickleIterator::ReadString16(string16* result) {
-  int len;
-  if (!ReadInt(&len))
-    return false;
-  const char* read_from = GetReadPointerAndAdvance(len, sizeof(char16));
-  if (!read_from)
+  base::StringPiece16 piece;
+  if (!ReadStringPiece16(&piece))
     return false;
 
-  result->assign(reinterpret_cast<const char16*>(read_from), len);
+  result->assign(piece.data(), piece.size());
   return true;
 }
 
@@ -144,13 +141,39 @@ bool PickleIterator::ReadBytes(const char** data, int length) {
   return true;
 }
 
+bool PickleIterator::ReadStringPiece(base::StringPiece* result) {
+  int len;
+  if (!ReadInt(&len))
+    return false;
+  const char* read_from = GetReadPointerAndAdvance(len);
+  if (!read_from)
+    return false;
+
+  result->set(read_from, len);
+  return true;
+}
+
+bool PickleIterator::ReadStringPiece16(base::StringPiece16* result) {
+  int len;
+  if (!ReadInt(&len))
+    return false;
+  const char* read_from = GetReadPointerAndAdvance(len, sizeof(char16));
+  if (!read_from)
+    return false;
+
+  *result = base::StringPiece16(reinterpret_cast<const char16*>(read_from),
+                                len);
+  return true;
+}
+
 // Payload is uint32 aligned.
 
 Pickle::Pickle()
     : header_(NULL),
       header_size_(sizeof(Header)),
       capacity_(0),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      external_size_(0) {
   Resize(kPayloadUnit);
   header_->payload_size = 0;
 }
@@ -159,7 +182,8 @@ Pickle::Pickle(int header_size)
     : header_(NULL),
       header_size_(AlignInt(header_size, sizeof(uint32))),
       capacity_(0),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      external_size_(0) {
   DCHECK_GE(static_cast<size_t>(header_size), sizeof(Header));
   DCHECK_LE(header_size, kPayloadUnit);
   Resize(kPayloadUnit);
@@ -170,7 +194,8 @@ Pickle::Pickle(const char* data, int data_len)
     : header_(reinterpret_cast<Header*>(const_cast<char*>(data))),
       header_size_(0),
       capacity_(kCapacityReadOnly),
-      variable_buffer_offset_(0) {
+      variable_buffer_offset_(0),
+      external_size_(0) {
   if (data_len >= static_cast<int>(sizeof(Header)))
     header_size_ = data_len - header_->payload_size;
 
@@ -189,11 +214,14 @@ Pickle::Pickle(const Pickle& other)
     : header_(NULL),
       header_size_(other.header_size_),
       capacity_(0),
-      variable_buffer_offset_(other.variable_buffer_offset_) {
-  size_t payload_size = header_size_ + other.header_->payload_size;
-  bool resized = Resize(payload_size);
+      variable_buffer_offset_(other.variable_buffer_offset_),
+      external_data_(other.external_data_),
+      external_size_(other.external_size_) {
+  // External data is shared rather than copied.
+  size_t inline_size = header_size_ + other.inline_payload_size();
+  bool resized = Resize(inline_size);
   CHECK(resized);  // Realloc failed.
-  memcpy(header_, other.header_, payload_size);
+  memcpy(header_, other.header_, inline_size);
 }
 
 Pickle::~Pickle() {
@@ -215,11 +243,14 @@ Pickle& Pickle::operator=(const Pickle& other) {
     header_ = NULL;
     header_size_ = other.header_size_;
   }
-  bool resized = Resize(other.header_size_ + other.header_->payload_size);
+  // External data is shared rather than copied.
+  size_t inline_size = other.header_size_ + other.inline_payload_size();
+  bool resized = Resize(inline_size);
   CHECK(resized);  // Realloc failed.
-  memcpy(header_, other.header_,
-         other.header_size_ + other.header_->payload_size);
+  memcpy(header_, other.header_, inline_size);
   variable_buffer_offset_ = other.variable_buffer_offset_;
+  external_data_ = other.external_data_;
+  external_size_ = other.external_size_;
   return *this;
 }
 
@@ -263,6 +294,98 @@ bool Pickle::WriteBytes(const void* data, int data_len) {
   return true;
 }
 
+bool Pickle::WriteExternalData(
+    const scoped_refptr<base::RefCountedMemory>& data) {
+  DCHECK_NE(kCapacityReadOnly, capacity_) << "oops: pickle is readonly";
+
+  size_t length = data->size();
+  size_t padded_length = AlignInt(length, sizeof(uint32));
+  if (length > static_cast<size_t>(kint32max) ||
+      padded_length > kuint32max - header_->payload_size)
+    return false;
+  if (!WriteInt(static_cast<int>(length)))
+    return false;
+  if (!length)
+    return true;
+
+  ExternalData external;
+  external.inline_offset = inline_payload_size();
+  external.data = data;
+  external_data_.push_back(external);
+  external_size_ += padded_length;
+  header_->payload_size += static_cast<uint32>(padded_length);
+  return true;
+}
+
+void Pickle::GetSegments(std::vector<Segment>* segments) const {
+  const char* inline_data = reinterpret_cast<const char*>(header_);
+  size_t inline_start = 0;
+  for (size_t i = 0; i < external_data_.size(); ++i) {
+    const ExternalData& external = external_data_[i];
+    size_t inline_end = header_size_ + external.inline_offset;
+    size_t length = external.data->size();
+    Segment inline_segment = { inline_data + inline_start,
+                               inline_end - inline_start };
+    Segment external_segment = {
+        reinterpret_cast<const char*>(external.data->front()), length };
+    segments->push_back(inline_segment);
+    segments->push_back(external_segment);
+    if (length % sizeof(uint32)) {
+      Segment padding = { kZeroPadding,
+                          sizeof(uint32) - length % sizeof(uint32) };
+      segments->push_back(padding);
+    }
+    inline_start = inline_end;
+  }
+  size_t inline_end = header_size_ + inline_payload_size();
+  if (inline_end > inline_start) {
+    Segment inline_segment = { inline_data + inline_start,
+                               inline_end - inline_start };
+    segments->push_back(inline_segment);
+  }
+}
+
+void Pickle::FlattenExternalData() {
+  if (external_data_.empty())
+    return;
+
+  // The variable buffer moves up by the external data written before it.
+  size_t variable_buffer_inline_offset =
+      variable_buffer_offset_ ? variable_buffer_offset_ - header_size_ : 0;
+  for (size_t i = 0; i < external_data_.size(); ++i) {
+    if (variable_buffer_offset_ &&
+        external_data_[i].inline_offset <= variable_buffer_inline_offset) {
+      variable_buffer_offset_ +=
+          AlignInt(external_data_[i].data->size(), sizeof(uint32));
+    }
+  }
+
+  size_t inline_end = inline_payload_size();
+  bool resized = Resize(header_size_ + header_->payload_size);
+  CHECK(resized);  // Realloc failed.
+
+  // Working backwards, move each run of inline data to its final place and
+  // copy the external data that precedes it in front of it.
+  char* dest = inline_payload();
+  size_t shift = external_size_;
+  for (size_t i = external_data_.size(); i-- > 0; ) {
+    const ExternalData& external = external_data_[i];
+    size_t length = external.data->size();
+    memmove(dest + external.inline_offset + shift,
+            dest + external.inline_offset,
+            inline_end - external.inline_offset);
+    shift -= AlignInt(length, sizeof(uint32));
+    char* external_dest = dest + external.inline_offset + shift;
+    memcpy(external_dest, external.data->front(), length);
+    EndWrite(external_dest, static_cast<int>(length));
+    inline_end = external.inline_offset;
+  }
+  DCHECK_EQ(0U, shift);
+
+  external_data_.clear();
+  external_size_ = 0;
+}
+
 char* Pickle::BeginWriteData(int length) {
   DCHECK_EQ(variable_buffer_offset_, 0U) <<
     "There can only be one variable buffer in a Pickle";
@@ -302,7 +425,7 @@ void Pickle::TrimWriteData(int new_length) {
 
 char* Pickle::BeginWrite(size_t length) {
   // write at a uint32-aligned offset from the beginning of the header
-  size_t offset = AlignInt(header_->payload_size, sizeof(uint32));
+  size_t offset = AlignInt(inline_payload_size(), sizeof(uint32));
 
   size_t new_size = offset + length;
   size_t needed_size = header_size_ + new_size;
@@ -313,8 +436,8 @@ char* Pickle::BeginWrite(size_t length) {
   DCHECK_LE(length, kuint32max);
 #endif
 
-  header_->payload_size = static_cast<uint32>(new_size);
-  return payload() + offset;
+  header_->payload_size = static_cast<uint32>(new_size + external_size_);
+  return inline_payload() + offset;
 }
 
 void Pickle::EndWrite(char* dest, int length) {
@@ -355,3 +478,17 @@ const char* Pickle::FindNext(size_t header_size,
 
   return (payload_end > end) ? NULL : payload_end;
 }
+
+// static
+size_t Pickle::PeekSize(size_t header_size,
+                        const char* start,
+                        const char* end) {
+  DCHECK_EQ(header_size, AlignInt(header_size, sizeof(uint32)));
+  DCHECK_LE(header_size, static_cast<size_t>(kPayloadUnit));
+
+  if (static_cast<size_t>(end - start) < sizeof(Header))
+    return 0;
+
+  const Header* hdr = reinterpret_cast<const Header*>(start);
+  return header_size + hdr->payload_size;
+}
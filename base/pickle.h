@@ -7,13 +7,16 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
 #include "base/gtest_prod_util.h"
 #include "base/logging.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/string16.h"
+#include "base/string_piece.h"
 
 class Pickle;
 
@@ -41,6 +44,11 @@ class BASE_EXPORT PickleIterator {
   bool ReadData(const char** data, int* length) WARN_UNUSED_RESULT;
   bool ReadBytes(const char** data, int length) WARN_UNUSED_RESULT;
 
+  // Like ReadString and ReadString16, but without copying: the result points
+  // into the Pickle's data and is only valid while the Pickle is.
+  bool ReadStringPiece(base::StringPiece* result) WARN_UNUSED_RESULT;
+  bool ReadStringPiece16(base::StringPiece16* result) WARN_UNUSED_RESULT;
+
   // Safer version of ReadInt() checks for the result not being negative.
   // Use it for reading the object sizes.
   bool ReadLength(int* result) WARN_UNUSED_RESULT {
@@ -132,8 +140,32 @@ class BASE_EXPORT Pickle {
   // Returns the size of the Pickle's data.
   size_t size() const { return header_size_ + header_->payload_size; }
 
-  // Returns the data for this Pickle.
-  const void* data() const { return header_; }
+  // Returns the data for this Pickle. A Pickle with external data (see
+  // WriteExternalData) must be flattened first; use GetSegments to avoid that.
+  const void* data() const {
+    DCHECK(external_data_.empty()) << "Call FlattenExternalData() first";
+    return header_;
+  }
+
+  // A contiguous run of a Pickle's data.
+  struct Segment {
+    const char* data;
+    size_t length;
+  };
+
+  // Appends to |segments| the runs which, concatenated, make up the size()
+  // bytes of data(), without copying any external data. The runs are valid
+  // until the next non-const operation on the Pickle. Use this to send
+  // Pickles with scatter-gather I/O.
+  void GetSegments(std::vector<Segment>* segments) const;
+
+  // Returns true if the Pickle references data it does not hold a copy of.
+  bool has_external_data() const { return !external_data_.empty(); }
+
+  // Copies the external data into the Pickle, after which its data is
+  // contiguous again. Required before calling data() or reading a Pickle
+  // that has external data.
+  void FlattenExternalData();
 
   // For compatibility, these older style read methods pass through to the
   // PickleIterator methods.
@@ -217,6 +249,12 @@ class BASE_EXPORT Pickle {
   bool WriteData(const char* data, int length);
   bool WriteBytes(const void* data, int data_len);
 
+  // Same as WriteData, but the Pickle keeps a reference to |data| instead of
+  // copying it. It is only copied by FlattenExternalData; GetSegments returns
+  // it as a segment of its own. Use ReadData to get the data. Only worthwhile
+  // for large payloads.
+  bool WriteExternalData(const scoped_refptr<base::RefCountedMemory>& data);
+
   // Same as WriteData, but allows the caller to write directly into the
   // Pickle. This saves a copy in cases where the data is not already
   // available in a buffer. The caller should take care to not write more
@@ -260,11 +298,13 @@ class BASE_EXPORT Pickle {
   // The payload is the pickle data immediately following the header.
   size_t payload_size() const { return header_->payload_size; }
   const char* payload() const {
+    DCHECK(external_data_.empty()) << "Call FlattenExternalData() first";
     return reinterpret_cast<const char*>(header_) + header_size_;
   }
 
  protected:
   char* payload() {
+    DCHECK(external_data_.empty()) << "Call FlattenExternalData() first";
     return reinterpret_cast<char*>(header_) + header_size_;
   }
 
@@ -311,21 +351,46 @@ class BASE_EXPORT Pickle {
                               const char* range_start,
                               const char* range_end);
 
+  // Returns the total size of the pickled data that starts at range_start, or
+  // 0 if the given data range is too short to hold its header.
+  static size_t PeekSize(size_t header_size,
+                         const char* range_start,
+                         const char* range_end);
+
   // The allocation granularity of the payload.
   static const int kPayloadUnit;
 
  private:
   friend class PickleIterator;
 
+  // Data written by WriteExternalData, which belongs at |inline_offset| of
+  // the payload held in |header_| (that is, not counting external data).
+  struct ExternalData {
+    size_t inline_offset;
+    scoped_refptr<base::RefCountedMemory> data;
+  };
+
+  // The part of the payload that is held in |header_|.
+  size_t inline_payload_size() const {
+    return header_->payload_size - external_size_;
+  }
+  char* inline_payload() {
+    return reinterpret_cast<char*>(header_) + header_size_;
+  }
+
   Header* header_;
   size_t header_size_;  // Supports extra data between header and payload.
   // Allocation size of payload (or -1 if allocation is const).
   size_t capacity_;
   size_t variable_buffer_offset_;  // IF non-zero, then offset to a buffer.
+  std::vector<ExternalData> external_data_;
+  // Bytes of the payload, including padding, that are in |external_data_|.
+  size_t external_size_;
 
   FRIEND_TEST_ALL_PREFIXES(PickleTest, Resize);
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNext);
   FRIEND_TEST_ALL_PREFIXES(PickleTest, FindNextWithIncompleteHeader);
+  FRIEND_TEST_ALL_PREFIXES(PickleTest, PeekSize);
 };
 
 #endif  // BASE_PICKLE_H__
@@ -5,9 +5,11 @@
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/pickle.h"
 #include "base/string16.h"
+#include "base/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace {
@@ -188,6 +190,22 @@ TEST(PickleTest, FindNextWithIncompleteHeader) {
   EXPECT_TRUE(NULL == Pickle::FindNext(header_size, start, end));
 }
 
+TEST(PickleTest, PeekSize) {
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteInt(1));
+  EXPECT_TRUE(pickle.WriteString("Domo"));
+
+  const char* start = reinterpret_cast<const char*>(pickle.data());
+  const char* end = start + pickle.size();
+
+  EXPECT_EQ(pickle.size(), Pickle::PeekSize(pickle.header_size_, start, end));
+  EXPECT_EQ(pickle.size(),
+            Pickle::PeekSize(pickle.header_size_, start,
+                             start + sizeof(Pickle::Header)));
+  EXPECT_EQ(0U, Pickle::PeekSize(pickle.header_size_, start,
+                                 start + sizeof(Pickle::Header) - 1));
+}
+
 TEST(PickleTest, GetReadPointerAndAdvance) {
   Pickle pickle;
 
@@ -334,3 +352,133 @@ TEST(PickleTest, ReadBytes) {
   memcpy(&outdata, outdata_char, sizeof(outdata));
   EXPECT_EQ(data, outdata);
 }
+
+TEST(PickleTest, ReadStringPiece) {
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteString(teststr));
+  EXPECT_TRUE(pickle.WriteString16(ASCIIToUTF16(teststr)));
+  EXPECT_TRUE(pickle.WriteString(std::string()));
+
+  PickleIterator iter(pickle);
+  base::StringPiece piece;
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_EQ(teststr, piece.as_string());
+  // The piece points into the pickle rather than at a copy.
+  const char* pickle_data = static_cast<const char*>(pickle.data());
+  EXPECT_GT(piece.data(), pickle_data);
+  EXPECT_LT(piece.data(), pickle_data + pickle.size());
+
+  base::StringPiece16 piece16;
+  EXPECT_TRUE(iter.ReadStringPiece16(&piece16));
+  EXPECT_EQ(ASCIIToUTF16(teststr), piece16.as_string());
+
+  EXPECT_TRUE(iter.ReadStringPiece(&piece));
+  EXPECT_TRUE(piece.empty());
+
+  EXPECT_FALSE(iter.ReadStringPiece(&piece));
+}
+
+// Check that external data reads back and serializes like WriteData.
+TEST(PickleTest, ExternalData) {
+  std::vector<unsigned char> bytes(testdata, testdata + testdatalen);
+  bytes.push_back('C');  // Not a multiple of the payload alignment.
+  scoped_refptr<base::RefCountedMemory> data(
+      base::RefCountedBytes::TakeVector(&bytes));
+  std::string empty;
+  scoped_refptr<base::RefCountedMemory> empty_data(
+      base::RefCountedString::TakeString(&empty));
+
+  Pickle expected;
+  Pickle pickle;
+  EXPECT_TRUE(expected.WriteInt(testint));
+  EXPECT_TRUE(pickle.WriteInt(testint));
+  EXPECT_TRUE(expected.WriteData(
+      reinterpret_cast<const char*>(data->front()), data->size()));
+  EXPECT_TRUE(pickle.WriteExternalData(data));
+  EXPECT_TRUE(expected.WriteData(NULL, 0));
+  EXPECT_TRUE(pickle.WriteExternalData(empty_data));
+  EXPECT_TRUE(expected.WriteData(
+      reinterpret_cast<const char*>(data->front()), data->size()));
+  EXPECT_TRUE(pickle.WriteExternalData(data));
+  EXPECT_TRUE(expected.WriteString(teststr));
+  EXPECT_TRUE(pickle.WriteString(teststr));
+  EXPECT_TRUE(pickle.has_external_data());
+  ASSERT_EQ(expected.size(), pickle.size());
+
+  // The segments hold the data without flattening the pickle.
+  std::vector<Pickle::Segment> segments;
+  pickle.GetSegments(&segments);
+  EXPECT_TRUE(pickle.has_external_data());
+  std::string gathered;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    EXPECT_GT(segments[i].length, 0U);
+    gathered.append(segments[i].data, segments[i].length);
+  }
+  EXPECT_EQ(std::string(static_cast<const char*>(expected.data()),
+                        expected.size()), gathered);
+
+  // Copies share the external data.
+  Pickle copy(pickle);
+  EXPECT_TRUE(copy.has_external_data());
+  Pickle assigned;
+  assigned = pickle;
+  EXPECT_TRUE(assigned.has_external_data());
+
+  // Once flattened, the pickle reads back like one written with WriteData.
+  pickle.FlattenExternalData();
+  EXPECT_FALSE(pickle.has_external_data());
+  ASSERT_EQ(expected.size(), pickle.size());
+  EXPECT_EQ(0, memcmp(expected.data(), pickle.data(), expected.size()));
+  PickleIterator iter(pickle);
+  int outint;
+  EXPECT_TRUE(iter.ReadInt(&outint));
+  EXPECT_EQ(testint, outint);
+  const char* outdata;
+  int outdatalen;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(iter.ReadData(&outdata, &outdatalen));
+    int expected_length = i == 1 ? 0 : static_cast<int>(data->size());
+    ASSERT_EQ(expected_length, outdatalen);
+    EXPECT_EQ(0, memcmp(data->front(), outdata, outdatalen));
+  }
+  std::string outstr;
+  EXPECT_TRUE(iter.ReadString(&outstr));
+  EXPECT_EQ(teststr, outstr);
+  EXPECT_FALSE(iter.ReadInt(&outint));
+
+  // Flattening a copy leaves the others alone.
+  copy.FlattenExternalData();
+  EXPECT_TRUE(assigned.has_external_data());
+  assigned.FlattenExternalData();
+  for (size_t i = 0; i < 2; ++i) {
+    const Pickle& other = i ? assigned : copy;
+    ASSERT_EQ(expected.size(), other.size());
+    EXPECT_EQ(0, memcmp(expected.data(), other.data(), expected.size()));
+    EXPECT_FALSE(other.has_external_data());
+  }
+}
+
+// Check that a variable buffer written after external data can still be
+// trimmed once the pickle is flattened.
+TEST(PickleTest, ExternalDataBeforeWriteData) {
+  std::string bytes("external");
+  scoped_refptr<base::RefCountedMemory> data(
+      base::RefCountedString::TakeString(&bytes));
+
+  Pickle pickle;
+  EXPECT_TRUE(pickle.WriteExternalData(data));
+  char* dest = pickle.BeginWriteData(10);
+  ASSERT_TRUE(dest);
+  memcpy(dest, "0123456789", 10);
+  pickle.FlattenExternalData();
+  pickle.TrimWriteData(4);
+
+  PickleIterator iter(pickle);
+  const char* outdata;
+  int outdatalen;
+  EXPECT_TRUE(iter.ReadData(&outdata, &outdatalen));
+  EXPECT_EQ("external", std::string(outdata, outdatalen));
+  EXPECT_TRUE(iter.ReadData(&outdata, &outdatalen));
+  EXPECT_EQ("0123", std::string(outdata, outdatalen));
+  EXPECT_FALSE(iter.ReadData(&outdata, &outdatalen));
+}
@@ -30,6 +30,11 @@ class SequencedWorkerPoolOwner : public SequencedWorkerPool::TestingObserver {
   SequencedWorkerPoolOwner(size_t max_threads,
                            const std::string& thread_name_prefix);
 
+  // Like above, but creates the pool with the given scheduler mode.
+  SequencedWorkerPoolOwner(size_t max_threads,
+                           const std::string& thread_name_prefix,
+                           SequencedWorkerPool::SchedulerMode scheduler_mode);
+
   virtual ~SequencedWorkerPoolOwner();
 
   // Don't change the returned pool's testing observer.
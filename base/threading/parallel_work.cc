@@ -0,0 +1,124 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/parallel_work.h"
+
+#include <algorithm>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/sys_info.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/threading/worker_pool.h"
+
+namespace base {
+
+namespace {
+
+// The state shared by the calling thread and the worker tasks. The tasks keep
+// it alive, since they may start after ParallelWork::Run() returns.
+class Job : public RefCountedThreadSafe<Job> {
+ public:
+  Job(int piece_count, const ParallelWork::PieceCallback& run_piece)
+      : piece_count_(piece_count),
+        run_piece_(run_piece),
+        next_piece_(0),
+        running_workers_(0),
+        finished_(false),
+        workers_done_(&lock_) {
+  }
+
+  // Runs pieces on |thread| until none are left.
+  void RunPieces(int thread) {
+    for (;;) {
+      int piece = subtle::NoBarrier_AtomicIncrement(&next_piece_, 1) - 1;
+      if (piece >= piece_count_)
+        return;
+      run_piece_.Run(piece, thread);
+    }
+  }
+
+  void RunPiecesOnWorker(int thread) {
+    {
+      AutoLock lock(lock_);
+      if (finished_)
+        return;
+      ++running_workers_;
+    }
+    RunPieces(thread);
+    AutoLock lock(lock_);
+    if (!--running_workers_)
+      workers_done_.Signal();
+  }
+
+  // Called on the calling thread once it finds no pieces left. Waits for the
+  // workers still running a piece, and keeps the others from starting.
+  void Finish() {
+    AutoLock lock(lock_);
+    finished_ = true;
+    while (running_workers_)
+      workers_done_.Wait();
+  }
+
+ private:
+  friend class RefCountedThreadSafe<Job>;
+
+  ~Job() {}
+
+  const int piece_count_;
+  const ParallelWork::PieceCallback run_piece_;
+  subtle::Atomic32 next_piece_;
+
+  Lock lock_;
+  int running_workers_;
+  bool finished_;
+  ConditionVariable workers_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(Job);
+};
+
+}  // namespace
+
+// static
+int ParallelWork::ThreadCount(int piece_count) {
+  return std::max(1, std::min(piece_count, SysInfo::NumberOfProcessors()));
+}
+
+// static
+void ParallelWork::Run(const tracked_objects::Location& from_here,
+                       int piece_count,
+                       int thread_count,
+                       const PieceCallback& run_piece,
+                       bool task_is_slow) {
+  DCHECK_GE(thread_count, 1);
+  thread_count = std::min(thread_count, piece_count);
+  if (thread_count <= 1) {
+    for (int piece = 0; piece < piece_count; ++piece)
+      run_piece.Run(piece, 0);
+    return;
+  }
+
+  scoped_refptr<Job> job(new Job(piece_count, run_piece));
+  for (int thread = 1; thread < thread_count; ++thread) {
+    // A task that can't be posted would only find the pieces handed out
+    // already, so it is dropped rather than run here.
+    WorkerPool::PostTask(from_here,
+                         Bind(&Job::RunPiecesOnWorker, job, thread),
+                         task_is_slow);
+  }
+  job->RunPieces(0);
+
+  // The wait is only for pieces that workers started before this thread ran
+  // out of pieces to take.
+  ThreadRestrictions::ScopedAllowWait allow_wait;
+  job->Finish();
+}
+
+}  // namespace base
@@ -0,0 +1,58 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_THREADING_PARALLEL_WORK_H_
+#define BASE_THREADING_PARALLEL_WORK_H_
+#pragma once
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/callback_forward.h"
+
+namespace tracked_objects {
+class Location;
+}  // namespace tracked_objects
+
+namespace base {
+
+// Runs work that the calling thread needs done before it goes on, such as
+// converting or scanning a large image, on the calling thread and on threads
+// of the WorkerPool at the same time. The work is split into pieces that
+// don't depend on each other.
+//
+// The pieces are handed out one at a time, so a slow thread doesn't hold up
+// the others. A worker task that only starts once every piece has been handed
+// out does nothing, so once the calling thread runs out of pieces it waits
+// only for the pieces that workers are already running, never for worker
+// tasks that have yet to start. That wait is no longer than the slowest
+// piece, which is why this may be used on threads that are otherwise not
+// allowed to wait.
+class BASE_EXPORT ParallelWork {
+ public:
+  // Runs one piece. |thread| is 0 on the calling thread, and 1 up to the
+  // thread count less one on the workers, so that pieces running at the same
+  // time can be given separate scratch state.
+  typedef Callback<void(int piece, int thread)> PieceCallback;
+
+  // Returns the number of threads worth running |piece_count| pieces on: one
+  // per processor, but no more than there are pieces.
+  static int ThreadCount(int piece_count);
+
+  // Runs |run_piece| for each piece from 0 up to |piece_count| on the calling
+  // thread and on up to |thread_count| - 1 WorkerPool threads, posted with
+  // |task_is_slow|. Returns once every piece is done. |run_piece| is not run
+  // after Run() returns, so it may refer to the caller's stack.
+  static void Run(const tracked_objects::Location& from_here,
+                  int piece_count,
+                  int thread_count,
+                  const PieceCallback& run_piece,
+                  bool task_is_slow);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(ParallelWork);
+};
+
+}  // namespace base
+
+#endif  // BASE_THREADING_PARALLEL_WORK_H_
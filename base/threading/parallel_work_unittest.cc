@@ -0,0 +1,65 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/parallel_work.h"
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/location.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const int kThreadCount = 4;
+
+void CountPiece(std::vector<subtle::Atomic32>* runs,
+                std::vector<subtle::Atomic32>* threads,
+                int piece,
+                int thread) {
+  subtle::NoBarrier_AtomicIncrement(&(*runs)[piece], 1);
+  ASSERT_GE(thread, 0);
+  ASSERT_LT(thread, kThreadCount);
+  subtle::NoBarrier_AtomicIncrement(&(*threads)[thread], 1);
+}
+
+}  // namespace
+
+// Every piece runs exactly once, and only on threads in the range given.
+TEST(ParallelWorkTest, RunsEachPieceOnce) {
+  const int kPieceCount = 1000;
+  std::vector<subtle::Atomic32> runs(kPieceCount, 0);
+  std::vector<subtle::Atomic32> threads(kThreadCount, 0);
+  ParallelWork::Run(FROM_HERE, kPieceCount, kThreadCount,
+                    Bind(&CountPiece, &runs, &threads), false);
+  for (int piece = 0; piece < kPieceCount; ++piece)
+    EXPECT_EQ(1, runs[piece]) << "piece " << piece;
+  int total = 0;
+  for (int thread = 0; thread < kThreadCount; ++thread)
+    total += threads[thread];
+  EXPECT_EQ(kPieceCount, total);
+}
+
+// Runs with a single thread, or no pieces, stay on the calling thread.
+TEST(ParallelWorkTest, SingleThread) {
+  std::vector<subtle::Atomic32> runs(3, 0);
+  std::vector<subtle::Atomic32> threads(kThreadCount, 0);
+  ParallelWork::Run(FROM_HERE, 3, 1, Bind(&CountPiece, &runs, &threads),
+                    false);
+  EXPECT_EQ(3, threads[0]);
+  ParallelWork::Run(FROM_HERE, 0, kThreadCount,
+                    Bind(&CountPiece, &runs, &threads), false);
+  EXPECT_EQ(3, threads[0]);
+}
+
+TEST(ParallelWorkTest, ThreadCount) {
+  EXPECT_EQ(1, ParallelWork::ThreadCount(0));
+  EXPECT_EQ(1, ParallelWork::ThreadCount(1));
+  EXPECT_GE(ParallelWork::ThreadCount(1000), 1);
+}
+
+}  // namespace base
@@ -4,6 +4,7 @@
 
 #include "base/threading/sequenced_worker_pool.h"
 
+#include <deque>
 #include <list>
 #include <map>
 #include <set>
@@ -23,6 +24,7 @@
 #include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/simple_thread.h"
+#include "base/threading/thread_local.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/time.h"
 #include "base/tracked_objects.h"
@@ -48,6 +50,27 @@ struct SequencedTask {
   Closure task;
 };
 
+// In WORK_STEALING mode, the maximum number of tasks a worker takes from the
+// stealable deques before it checks the shared queue of sequenced tasks
+// again. This keeps a steady stream of unsequenced work from starving
+// sequenced tasks.
+const int kMaxStealableTasksBetweenSharedQueueChecks = 16;
+
+// A deque of unsequenced tasks owned by one worker in WORK_STEALING mode.
+// The owning worker pushes and pops at the back; other workers steal from
+// the front. Each deque has its own lock so that posting and stealing don't
+// contend on the pool lock.
+struct StealableTaskQueue {
+  StealableTaskQueue() : size(0) {}
+
+  Lock lock;
+  std::deque<SequencedTask> tasks;
+
+  // The size of |tasks|, only modified with |lock| held. Lets workers skip
+  // empty deques without taking their locks.
+  volatile subtle::Atomic32 size;
+};
+
 // SequencedWorkerPoolTaskRunner ---------------------------------------------
 // A TaskRunner which posts tasks to a SequencedWorkerPool with a
 // fixed ShutdownBehavior.
@@ -283,8 +306,16 @@ class SequencedWorkerPool::Worker : public SimpleThread {
     return running_sequence_;
   }
 
+  // The 1-based number of this worker. Since threads are created one at a
+  // time, this is unique within the pool and no larger than the maximum
+  // number of threads.
+  int thread_number() const {
+    return thread_number_;
+  }
+
  private:
   scoped_refptr<SequencedWorkerPool> worker_pool_;
+  const int thread_number_;
   SequenceToken running_sequence_;
 
   DISALLOW_COPY_AND_ASSIGN(Worker);
@@ -298,6 +329,7 @@ class SequencedWorkerPool::Inner {
   // by it).
   Inner(SequencedWorkerPool* worker_pool, size_t max_threads,
         const std::string& thread_name_prefix,
+        SchedulerMode scheduler_mode,
         TestingObserver* observer);
 
   ~Inner();
@@ -331,6 +363,39 @@ class SequencedWorkerPool::Inner {
   void ThreadLoop(Worker* this_worker);
 
  private:
+  // The worker loop used in WORK_STEALING mode. Must be called without the
+  // lock held.
+  void WorkStealingThreadLoop(Worker* this_worker);
+
+  // Returns whether this pool uses per-worker stealable deques.
+  bool IsWorkStealing() const { return !stealable_queues_.empty(); }
+
+  // Posts an unsequenced task to one of the stealable deques in
+  // WORK_STEALING mode. Called without the lock held.
+  bool PostStealableTask(const SequencedTask& task);
+
+  // Removes a task from the deque of the worker with the given thread number
+  // or, if that one is empty, steals one from another worker's deque.
+  // Returns false if all the deques are empty. Called without the lock held.
+  bool TakeStealableTask(int thread_number, SequencedTask* task);
+
+  // Takes a task from the stealable deques and runs it on |this_worker|, or
+  // discards it if it isn't allowed to run anymore because of shutdown.
+  // Returns false if there was no task. Called without the lock held.
+  bool RunStealableTask(Worker* this_worker);
+
+  // Called when a BLOCK_SHUTDOWN task from the stealable deques has finished
+  // running or was rejected. Called without the lock held.
+  void DidFinishStealableBlockingTask();
+
+  // Returns whether any of the stealable deques have tasks. Can be called
+  // with or without the lock held.
+  bool HasStealableTasks() const;
+
+  // Wakes up a waiting worker or starts a new one if that's helpful after a
+  // task was added to the stealable deques. Called without the lock held.
+  void SignalStealableWork();
+
   // Returns whether there are no more pending tasks and all threads
   // are idle.  Must be called under lock.
   bool IsIdle() const;
@@ -399,6 +464,39 @@ class SequencedWorkerPool::Inner {
   // tasks are posted or shutdown starts.
   ConditionVariable has_work_cv_;
 
+  // The following members are only used in WORK_STEALING mode and are
+  // accessed without holding |lock_|.
+
+  // One deque per possible worker thread, indexed by thread number - 1.
+  // Allocated up front so that the vector itself never changes. Empty in
+  // SHARED_QUEUE mode.
+  std::vector<linked_ptr<StealableTaskQueue> > stealable_queues_;
+
+  // The deque of the worker running on the current thread, if any. Tasks
+  // posted from a worker go to its own deque.
+  ThreadLocalPointer<StealableTaskQueue> current_stealable_queue_;
+
+  // Used to spread tasks posted from non-worker threads across the deques.
+  volatile subtle::Atomic32 next_stealable_queue_;
+
+  // Total number of tasks in the stealable deques.
+  volatile subtle::Atomic32 stealable_task_count_;
+
+  // Number of BLOCK_SHUTDOWN tasks that are in the stealable deques or are
+  // currently running after being taken from them.
+  volatile subtle::Atomic32 stealable_blocking_task_count_;
+
+  // Mirror of |waiting_thread_count_| that can be read without the lock by
+  // threads posting stealable tasks.
+  volatile subtle::Atomic32 stealable_waiting_thread_count_;
+
+  // Set once |max_threads_| workers have been started, so that posting no
+  // longer needs to take the lock to consider starting a thread.
+  volatile subtle::Atomic32 all_threads_started_;
+
+  // Mirror of |shutdown_called_| that can be read without the lock.
+  volatile subtle::Atomic32 stealable_shutdown_called_;
+
   // Condition variable that is waited on by non-worker threads (in
   // FlushForTesting()) until IsIdle() goes to true.
   ConditionVariable is_idle_cv_;
@@ -464,7 +562,8 @@ SequencedWorkerPool::Worker::Worker(
     const std::string& prefix)
     : SimpleThread(
           prefix + StringPrintf("Worker%d", thread_number).c_str()),
-      worker_pool_(worker_pool) {
+      worker_pool_(worker_pool),
+      thread_number_(thread_number) {
   Start();
 }
 
@@ -488,11 +587,18 @@ SequencedWorkerPool::Inner::Inner(
     SequencedWorkerPool* worker_pool,
     size_t max_threads,
     const std::string& thread_name_prefix,
+    SchedulerMode scheduler_mode,
     TestingObserver* observer)
     : worker_pool_(worker_pool),
       last_sequence_number_(0),
       lock_(),
       has_work_cv_(&lock_),
+      next_stealable_queue_(0),
+      stealable_task_count_(0),
+      stealable_blocking_task_count_(0),
+      stealable_waiting_thread_count_(0),
+      all_threads_started_(0),
+      stealable_shutdown_called_(0),
       is_idle_cv_(&lock_),
       can_shutdown_cv_(&lock_),
       max_threads_(max_threads),
@@ -503,7 +609,12 @@ SequencedWorkerPool::Inner::Inner(
       pending_task_count_(0),
       blocking_shutdown_pending_task_count_(0),
       shutdown_called_(false),
-      testing_observer_(observer) {}
+      testing_observer_(observer) {
+  if (scheduler_mode == WORK_STEALING) {
+    for (size_t i = 0; i < max_threads_; ++i)
+      stealable_queues_.push_back(make_linked_ptr(new StealableTaskQueue));
+  }
+}
 
 SequencedWorkerPool::Inner::~Inner() {
   // You must call Shutdown() before destroying the pool.
@@ -544,6 +655,11 @@ bool SequencedWorkerPool::Inner::PostTask(
   sequenced.location = from_here;
   sequenced.task = task;
 
+  // Unsequenced tasks bypass the shared queue (and the lock) entirely in
+  // WORK_STEALING mode.
+  if (IsWorkStealing() && !optional_token_name && !sequence_token.id_)
+    return PostStealableTask(sequenced);
+
   int create_thread_id = 0;
   {
     AutoLock lock(lock_);
@@ -607,6 +723,12 @@ void SequencedWorkerPool::Inner::Shutdown() {
     if (shutdown_called_)
       return;
     shutdown_called_ = true;
+    if (IsWorkStealing()) {
+      // Pairs with the barrier in PostStealableTask: either the poster sees
+      // that shutdown was called, or CanShutdown() below sees its task.
+      subtle::NoBarrier_Store(&stealable_shutdown_called_, 1);
+      subtle::MemoryBarrier();
+    }
 
     // Tickle the threads. This will wake up a waiting one so it will know that
     // it can exit, which in turn will wake up any other waiting ones.
@@ -645,55 +767,67 @@ void SequencedWorkerPool::Inner::ThreadLoop(Worker* this_worker) {
             std::make_pair(this_worker->tid(), make_linked_ptr(this_worker)));
     DCHECK(result.second);
 
-    while (true) {
+    if (IsWorkStealing()) {
+      current_stealable_queue_.Set(
+          stealable_queues_[this_worker->thread_number() - 1].get());
+      if (threads_.size() == max_threads_)
+        subtle::Release_Store(&all_threads_started_, 1);
+      {
+        AutoUnlock unlock(lock_);
+        WorkStealingThreadLoop(this_worker);
+      }
+      current_stealable_queue_.Set(NULL);
+    } else {
+      while (true) {
 #if defined(OS_MACOSX)
-      base::mac::ScopedNSAutoreleasePool autorelease_pool;
+        base::mac::ScopedNSAutoreleasePool autorelease_pool;
 #endif
 
-      // See GetWork for what delete_these_outside_lock is doing.
-      SequencedTask task;
-      std::vector<Closure> delete_these_outside_lock;
-      if (GetWork(&task, &delete_these_outside_lock)) {
-        int new_thread_id = WillRunWorkerTask(task);
-        {
-          AutoUnlock unlock(lock_);
-          // There may be more work available, so wake up another
-          // worker thread. (Technically not required, since we
-          // already get a signal for each new task, but it doesn't
-          // hurt.)
-          SignalHasWork();
-          delete_these_outside_lock.clear();
-
-          // Complete thread creation outside the lock if necessary.
-          if (new_thread_id)
-            FinishStartingAdditionalThread(new_thread_id);
-
-          this_worker->set_running_sequence(
-              SequenceToken(task.sequence_token_id));
-
-          task.task.Run();
-
-          this_worker->set_running_sequence(SequenceToken());
-
-          // Make sure our task is erased outside the lock for the same reason
-          // we do this with delete_these_oustide_lock.
-          task.task = Closure();
+        // See GetWork for what delete_these_outside_lock is doing.
+        SequencedTask task;
+        std::vector<Closure> delete_these_outside_lock;
+        if (GetWork(&task, &delete_these_outside_lock)) {
+          int new_thread_id = WillRunWorkerTask(task);
+          {
+            AutoUnlock unlock(lock_);
+            // There may be more work available, so wake up another
+            // worker thread. (Technically not required, since we
+            // already get a signal for each new task, but it doesn't
+            // hurt.)
+            SignalHasWork();
+            delete_these_outside_lock.clear();
+
+            // Complete thread creation outside the lock if necessary.
+            if (new_thread_id)
+              FinishStartingAdditionalThread(new_thread_id);
+
+            this_worker->set_running_sequence(
+                SequenceToken(task.sequence_token_id));
+
+            task.task.Run();
+
+            this_worker->set_running_sequence(SequenceToken());
+
+            // Make sure our task is erased outside the lock for the same reason
+            // we do this with delete_these_oustide_lock.
+            task.task = Closure();
+          }
+          DidRunWorkerTask(task);  // Must be done inside the lock.
+        } else {
+          // When we're terminating and there's no more work, we can
+          // shut down.  You can't get more tasks posted once
+          // shutdown_called_ is set. There may be some tasks stuck
+          // behind running ones with the same sequence token, but
+          // additional threads won't help this case.
+          if (shutdown_called_)
+            break;
+          waiting_thread_count_++;
+          // This is the only time that IsIdle() can go to true.
+          if (IsIdle())
+            is_idle_cv_.Signal();
+          has_work_cv_.Wait();
+          waiting_thread_count_--;
         }
-        DidRunWorkerTask(task);  // Must be done inside the lock.
-      } else {
-        // When we're terminating and there's no more work, we can
-        // shut down.  You can't get more tasks posted once
-        // shutdown_called_ is set. There may be some tasks stuck
-        // behind running ones with the same sequence token, but
-        // additional threads won't help this case.
-        if (shutdown_called_)
-          break;
-        waiting_thread_count_++;
-        // This is the only time that IsIdle() can go to true.
-        if (IsIdle())
-          is_idle_cv_.Signal();
-        has_work_cv_.Wait();
-        waiting_thread_count_--;
       }
     }
   }  // Release lock_.
@@ -706,9 +840,216 @@ void SequencedWorkerPool::Inner::ThreadLoop(Worker* this_worker) {
   can_shutdown_cv_.Signal();
 }
 
+void SequencedWorkerPool::Inner::WorkStealingThreadLoop(Worker* this_worker) {
+  int stealable_tasks_run = 0;
+  while (true) {
+#if defined(OS_MACOSX)
+    base::mac::ScopedNSAutoreleasePool autorelease_pool;
+#endif
+
+    // The common case: run unsequenced work without touching |lock_|.
+    if (stealable_tasks_run < kMaxStealableTasksBetweenSharedQueueChecks &&
+        RunStealableTask(this_worker)) {
+      stealable_tasks_run++;
+      continue;
+    }
+    stealable_tasks_run = 0;
+
+    AutoLock lock(lock_);
+
+    // See GetWork for what delete_these_outside_lock is doing.
+    SequencedTask task;
+    std::vector<Closure> delete_these_outside_lock;
+    if (GetWork(&task, &delete_these_outside_lock)) {
+      int new_thread_id = WillRunWorkerTask(task);
+      {
+        AutoUnlock unlock(lock_);
+        // There may be more work available, so wake up another worker
+        // thread, as in ThreadLoop.
+        SignalHasWork();
+        delete_these_outside_lock.clear();
+
+        // Complete thread creation outside the lock if necessary.
+        if (new_thread_id)
+          FinishStartingAdditionalThread(new_thread_id);
+
+        this_worker->set_running_sequence(
+            SequenceToken(task.sequence_token_id));
+
+        task.task.Run();
+
+        this_worker->set_running_sequence(SequenceToken());
+
+        // Make sure our task is erased outside the lock for the same reason
+        // we do this with delete_these_oustide_lock.
+        task.task = Closure();
+      }
+      DidRunWorkerTask(task);  // Must be done inside the lock.
+      continue;
+    }
+
+    // A stealable task may have been posted since we last looked.
+    if (HasStealableTasks())
+      continue;
+
+    // Unlike in SHARED_QUEUE mode, a BLOCK_SHUTDOWN task can still be on its
+    // way into a deque at this point (it is counted before it is pushed), so
+    // only exit once none are outstanding. DidFinishStealableBlockingTask
+    // wakes us up when the last one is done.
+    if (shutdown_called_ &&
+        subtle::Acquire_Load(&stealable_blocking_task_count_) == 0)
+      break;
+
+    waiting_thread_count_++;
+    // Pairs with the barrier in PostStealableTask: either the poster sees
+    // that we're waiting and signals us (which it does with the lock held,
+    // so it can't happen before we're actually waiting), or we see its task.
+    subtle::Barrier_AtomicIncrement(&stealable_waiting_thread_count_, 1);
+    if (!HasStealableTasks()) {
+      // This is the only time that IsIdle() can go to true.
+      if (IsIdle())
+        is_idle_cv_.Signal();
+      has_work_cv_.Wait();
+    }
+    subtle::NoBarrier_AtomicIncrement(&stealable_waiting_thread_count_, -1);
+    waiting_thread_count_--;
+  }
+}
+
+bool SequencedWorkerPool::Inner::PostStealableTask(const SequencedTask& task) {
+  const bool blocks_shutdown = task.shutdown_behavior == BLOCK_SHUTDOWN;
+  // Count a blocking task before checking for shutdown so that Shutdown()
+  // keeps waiting for it if it gets past the check below.
+  if (blocks_shutdown)
+    subtle::Barrier_AtomicIncrement(&stealable_blocking_task_count_, 1);
+  if (subtle::Acquire_Load(&stealable_shutdown_called_)) {
+    if (blocks_shutdown)
+      DidFinishStealableBlockingTask();
+    return false;
+  }
+
+  StealableTaskQueue* queue = current_stealable_queue_.Get();
+  if (!queue) {
+    subtle::Atomic32 index =
+        subtle::NoBarrier_AtomicIncrement(&next_stealable_queue_, 1);
+    queue = stealable_queues_[
+        static_cast<uint32>(index) % stealable_queues_.size()].get();
+  }
+  {
+    AutoLock queue_lock(queue->lock);
+    queue->tasks.push_back(task);
+    subtle::Release_Store(&queue->size,
+                          static_cast<subtle::Atomic32>(queue->tasks.size()));
+  }
+  subtle::Barrier_AtomicIncrement(&stealable_task_count_, 1);
+
+  SignalStealableWork();
+  return true;
+}
+
+bool SequencedWorkerPool::Inner::TakeStealableTask(int thread_number,
+                                                   SequencedTask* task) {
+  if (!HasStealableTasks())
+    return false;
+
+  // Our own deque is used as a stack for locality. Other workers' deques are
+  // stolen from at the front, taking the oldest task.
+  const size_t num_queues = stealable_queues_.size();
+  const size_t own_index = static_cast<size_t>(thread_number - 1);
+  for (size_t i = 0; i < num_queues; ++i) {
+    StealableTaskQueue* queue =
+        stealable_queues_[(own_index + i) % num_queues].get();
+    if (!subtle::Acquire_Load(&queue->size))
+      continue;
+    AutoLock queue_lock(queue->lock);
+    if (queue->tasks.empty())
+      continue;
+    if (i == 0) {
+      *task = queue->tasks.back();
+      queue->tasks.pop_back();
+    } else {
+      *task = queue->tasks.front();
+      queue->tasks.pop_front();
+    }
+    subtle::Release_Store(&queue->size,
+                          static_cast<subtle::Atomic32>(queue->tasks.size()));
+    subtle::NoBarrier_AtomicIncrement(&stealable_task_count_, -1);
+    return true;
+  }
+  return false;
+}
+
+bool SequencedWorkerPool::Inner::RunStealableTask(Worker* this_worker) {
+  SequencedTask task;
+  if (!TakeStealableTask(this_worker->thread_number(), &task))
+    return false;
+
+  if (task.shutdown_behavior != BLOCK_SHUTDOWN &&
+      subtle::Acquire_Load(&stealable_shutdown_called_)) {
+    // Same as in GetWork: drop tasks that aren't allowed to run anymore. The
+    // closure is destroyed when |task| goes out of scope, outside of any
+    // lock.
+    return true;
+  }
+
+  // Like WillRunWorkerTask, ramp up the number of threads before running the
+  // task, which could take arbitrarily long.
+  if (!subtle::Acquire_Load(&all_threads_started_) && HasStealableTasks()) {
+    int new_thread_id = 0;
+    {
+      AutoLock lock(lock_);
+      new_thread_id = PrepareToStartAdditionalThreadIfHelpful();
+    }
+    if (new_thread_id)
+      FinishStartingAdditionalThread(new_thread_id);
+  }
+
+  task.task.Run();
+  task.task = Closure();
+
+  if (task.shutdown_behavior == BLOCK_SHUTDOWN)
+    DidFinishStealableBlockingTask();
+  return true;
+}
+
+void SequencedWorkerPool::Inner::DidFinishStealableBlockingTask() {
+  if (subtle::Barrier_AtomicIncrement(&stealable_blocking_task_count_, -1) ||
+      !subtle::Acquire_Load(&stealable_shutdown_called_))
+    return;
+
+  // The last blocking task is done and we're shutting down. Possibly unblock
+  // Shutdown(), and wake up a waiting worker so the workers can exit.
+  AutoLock lock(lock_);
+  can_shutdown_cv_.Signal();
+  SignalHasWork();
+}
+
+bool SequencedWorkerPool::Inner::HasStealableTasks() const {
+  return subtle::Acquire_Load(&stealable_task_count_) > 0;
+}
+
+void SequencedWorkerPool::Inner::SignalStealableWork() {
+  // Once all threads are running and none of them are waiting, the work
+  // will be picked up without any signaling.
+  if (subtle::Acquire_Load(&all_threads_started_) &&
+      subtle::Acquire_Load(&stealable_waiting_thread_count_) == 0)
+    return;
+
+  int create_thread_id = 0;
+  {
+    AutoLock lock(lock_);
+    create_thread_id = PrepareToStartAdditionalThreadIfHelpful();
+    if (!create_thread_id && waiting_thread_count_ > 0)
+      SignalHasWork();
+  }
+  if (create_thread_id)
+    FinishStartingAdditionalThread(create_thread_id);
+}
+
 bool SequencedWorkerPool::Inner::IsIdle() const {
   lock_.AssertAcquired();
-  return pending_task_count_ == 0 && waiting_thread_count_ == threads_.size();
+  return pending_task_count_ == 0 && !HasStealableTasks() &&
+      waiting_thread_count_ == threads_.size();
 }
 
 int SequencedWorkerPool::Inner::LockedGetNamedTokenID(
@@ -888,11 +1229,23 @@ int SequencedWorkerPool::Inner::PrepareToStartAdditionalThreadIfHelpful() {
   // given the workload, but in reality fewer may be created because the
   // sequence of thread creation on the background threads is racing with the
   // shutdown call.
-  if (!shutdown_called_ &&
+  //
+  // In WORK_STEALING mode, a BLOCK_SHUTDOWN task that raced with Shutdown()
+  // may need the first thread to be created after shutdown was called.
+  // Shutdown() is still waiting for that task at this point, so the thread
+  // can't be leaked.
+  bool can_create_thread = !shutdown_called_ ||
+      (IsWorkStealing() && threads_.empty() &&
+       subtle::Acquire_Load(&stealable_blocking_task_count_) > 0);
+  if (can_create_thread &&
       !thread_being_created_ &&
       threads_.size() < max_threads_ &&
       waiting_thread_count_ == 0) {
     // We could use an additional thread if there's work to be done.
+    if (HasStealableTasks()) {
+      thread_being_created_ = true;
+      return static_cast<int>(threads_.size() + 1);
+    }
     for (std::list<SequencedTask>::iterator i = pending_tasks_.begin();
          i != pending_tasks_.end(); ++i) {
       if (IsSequenceTokenRunnable(i->sequence_token_id)) {
@@ -927,7 +1280,8 @@ bool SequencedWorkerPool::Inner::CanShutdown() const {
   // See PrepareToStartAdditionalThreadIfHelpful for how thread creation works.
   return !thread_being_created_ &&
          blocking_shutdown_thread_count_ == 0 &&
-         blocking_shutdown_pending_task_count_ == 0;
+         blocking_shutdown_pending_task_count_ == 0 &&
+         subtle::Acquire_Load(&stealable_blocking_task_count_) == 0;
 }
 
 // SequencedWorkerPool --------------------------------------------------------
@@ -937,16 +1291,29 @@ SequencedWorkerPool::SequencedWorkerPool(
     const std::string& thread_name_prefix)
     : constructor_message_loop_(MessageLoopProxy::current()),
       inner_(new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
-                       max_threads, thread_name_prefix, NULL)) {
+                       max_threads, thread_name_prefix, SHARED_QUEUE,
+                       NULL)) {
+}
+
+SequencedWorkerPool::SequencedWorkerPool(
+    size_t max_threads,
+    const std::string& thread_name_prefix,
+    TestingObserver* observer)
+    : constructor_message_loop_(MessageLoopProxy::current()),
+      inner_(new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
+                       max_threads, thread_name_prefix, SHARED_QUEUE,
+                       observer)) {
 }
 
 SequencedWorkerPool::SequencedWorkerPool(
     size_t max_threads,
     const std::string& thread_name_prefix,
+    SchedulerMode scheduler_mode,
     TestingObserver* observer)
     : constructor_message_loop_(MessageLoopProxy::current()),
       inner_(new Inner(ALLOW_THIS_IN_INITIALIZER_LIST(this),
-                       max_threads, thread_name_prefix, observer)) {
+                       max_threads, thread_name_prefix, scheduler_mode,
+                       observer)) {
 }
 
 SequencedWorkerPool::~SequencedWorkerPool() {}
@@ -101,6 +101,26 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
     BLOCK_SHUTDOWN,
   };
 
+  // Defines how worker threads find the next task to run.
+  enum SchedulerMode {
+    // All pending tasks are kept in a single queue protected by the pool's
+    // lock. Every post and every task pickup contends on that lock.
+    SHARED_QUEUE,
+
+    // Unsequenced tasks (those posted without a sequence token) are pushed
+    // onto per-worker deques, each with its own lock. A worker runs tasks
+    // from its own deque first and steals from the other workers' deques
+    // when its own is empty, so the pool lock is only taken for sequenced
+    // tasks and when a worker goes to sleep. Sequenced tasks still go through
+    // the shared queue, so the ordering guarantees of SequenceToken and all
+    // of the shutdown behaviors above are unchanged.
+    //
+    // Note that unsequenced tasks posted from a worker thread are placed on
+    // that worker's own deque and executed newest-first by it, so they may
+    // run in a different order than in SHARED_QUEUE mode.
+    WORK_STEALING,
+  };
+
   // Opaque identifier that defines sequencing of tasks posted to the worker
   // pool.
   class SequenceToken {
@@ -134,7 +154,8 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
   // leak it.
 
   // Pass the maximum number of threads (they will be lazily created as needed)
-  // and a prefix for the thread name to aid in debugging.
+  // and a prefix for the thread name to aid in debugging. The pool uses the
+  // SHARED_QUEUE scheduler mode.
   SequencedWorkerPool(size_t max_threads,
                       const std::string& thread_name_prefix);
 
@@ -144,6 +165,13 @@ class BASE_EXPORT SequencedWorkerPool : public TaskRunner {
                       const std::string& thread_name_prefix,
                       TestingObserver* observer);
 
+  // Like above, but allows specification of the scheduler mode. |observer|
+  // may be NULL.
+  SequencedWorkerPool(size_t max_threads,
+                      const std::string& thread_name_prefix,
+                      SchedulerMode scheduler_mode,
+                      TestingObserver* observer);
+
   // Returns a unique token that can be used to sequence tasks posted to
   // PostSequencedWorkerTask(). Valid tokens are alwys nonzero.
   SequenceToken GetSequenceToken();
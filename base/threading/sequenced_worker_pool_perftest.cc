@@ -0,0 +1,137 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/sequenced_worker_pool.h"
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+const size_t kThreadCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+const int kNumTasks = 100000;
+
+// Number of tasks each "spawner" task posts from a worker thread.
+const int kTasksPerSpawner = 100;
+
+void IncrementTask(volatile subtle::Atomic32* counter) {
+  subtle::NoBarrier_AtomicIncrement(counter, 1);
+}
+
+void SpawnTasks(SequencedWorkerPool* pool,
+                volatile subtle::Atomic32* counter) {
+  for (int i = 0; i < kTasksPerSpawner; ++i)
+    pool->PostWorkerTask(FROM_HERE, Bind(&IncrementTask, counter));
+}
+
+const char* ModeName(SequencedWorkerPool::SchedulerMode mode) {
+  return mode == SequencedWorkerPool::WORK_STEALING ?
+      "work_stealing" : "shared_queue";
+}
+
+class SequencedWorkerPoolPerfTest : public testing::Test {
+ protected:
+  // Posts kNumTasks trivial unsequenced tasks from the main thread.
+  void RunPostFromMainThread(SequencedWorkerPool::SchedulerMode mode,
+                             size_t num_threads) {
+    scoped_refptr<SequencedWorkerPool> pool(
+        new SequencedWorkerPool(num_threads, "PerfTest", mode, NULL));
+    volatile subtle::Atomic32 counter = 0;
+
+    PerfTimeLogger timer(StringPrintf("SequencedWorkerPool_post_main_%s_%d",
+                                      ModeName(mode),
+                                      static_cast<int>(num_threads)).c_str());
+    for (int i = 0; i < kNumTasks; ++i)
+      pool->PostWorkerTask(FROM_HERE, Bind(&IncrementTask, &counter));
+    pool->FlushForTesting();
+    timer.Done();
+
+    EXPECT_EQ(kNumTasks, subtle::NoBarrier_Load(&counter));
+    pool->Shutdown();
+  }
+
+  // Posts tasks which in turn post kTasksPerSpawner trivial tasks each from
+  // the worker threads, which is where per-worker deques help most.
+  void RunPostFromWorkers(SequencedWorkerPool::SchedulerMode mode,
+                          size_t num_threads) {
+    scoped_refptr<SequencedWorkerPool> pool(
+        new SequencedWorkerPool(num_threads, "PerfTest", mode, NULL));
+    volatile subtle::Atomic32 counter = 0;
+    const int num_spawners = kNumTasks / kTasksPerSpawner;
+
+    PerfTimeLogger timer(StringPrintf(
+        "SequencedWorkerPool_post_worker_%s_%d",
+        ModeName(mode), static_cast<int>(num_threads)).c_str());
+    for (int i = 0; i < num_spawners; ++i) {
+      pool->PostWorkerTask(FROM_HERE,
+                           Bind(&SpawnTasks, pool, &counter));
+    }
+    pool->FlushForTesting();
+    timer.Done();
+
+    EXPECT_EQ(kNumTasks, subtle::NoBarrier_Load(&counter));
+    pool->Shutdown();
+  }
+
+  // Mixes sequenced and unsequenced tasks to measure the overhead of the
+  // shared queue checks in WORK_STEALING mode.
+  void RunMixed(SequencedWorkerPool::SchedulerMode mode, size_t num_threads) {
+    scoped_refptr<SequencedWorkerPool> pool(
+        new SequencedWorkerPool(num_threads, "PerfTest", mode, NULL));
+    volatile subtle::Atomic32 counter = 0;
+    SequencedWorkerPool::SequenceToken token = pool->GetSequenceToken();
+
+    PerfTimeLogger timer(StringPrintf("SequencedWorkerPool_mixed_%s_%d",
+                                      ModeName(mode),
+                                      static_cast<int>(num_threads)).c_str());
+    for (int i = 0; i < kNumTasks; ++i) {
+      if (i % 10 == 0) {
+        pool->PostSequencedWorkerTask(token, FROM_HERE,
+                                      Bind(&IncrementTask, &counter));
+      } else {
+        pool->PostWorkerTask(FROM_HERE, Bind(&IncrementTask, &counter));
+      }
+    }
+    pool->FlushForTesting();
+    timer.Done();
+
+    EXPECT_EQ(kNumTasks, subtle::NoBarrier_Load(&counter));
+    pool->Shutdown();
+  }
+
+ private:
+  MessageLoop message_loop_;
+};
+
+}  // namespace
+
+TEST_F(SequencedWorkerPoolPerfTest, PostFromMainThread) {
+  for (size_t i = 0; i < arraysize(kThreadCounts); ++i) {
+    RunPostFromMainThread(SequencedWorkerPool::SHARED_QUEUE, kThreadCounts[i]);
+    RunPostFromMainThread(SequencedWorkerPool::WORK_STEALING,
+                          kThreadCounts[i]);
+  }
+}
+
+TEST_F(SequencedWorkerPoolPerfTest, PostFromWorkers) {
+  for (size_t i = 0; i < arraysize(kThreadCounts); ++i) {
+    RunPostFromWorkers(SequencedWorkerPool::SHARED_QUEUE, kThreadCounts[i]);
+    RunPostFromWorkers(SequencedWorkerPool::WORK_STEALING, kThreadCounts[i]);
+  }
+}
+
+TEST_F(SequencedWorkerPoolPerfTest, MixedSequencedAndUnsequenced) {
+  for (size_t i = 0; i < arraysize(kThreadCounts); ++i) {
+    RunMixed(SequencedWorkerPool::SHARED_QUEUE, kThreadCounts[i]);
+    RunMixed(SequencedWorkerPool::WORK_STEALING, kThreadCounts[i]);
+  }
+}
+
+}  // namespace base
@@ -151,10 +151,12 @@ class TestTracker : public base::RefCountedThreadSafe<TestTracker> {
   size_t started_events_;
 };
 
-class SequencedWorkerPoolTest : public testing::Test {
+// The tests below are run against both scheduler modes.
+class SequencedWorkerPoolTest
+    : public testing::TestWithParam<SequencedWorkerPool::SchedulerMode> {
  public:
   SequencedWorkerPoolTest()
-      : pool_owner_(kNumWorkerThreads, "test"),
+      : pool_owner_(kNumWorkerThreads, "test", GetParam()),
         tracker_(new TestTracker) {
   }
 
@@ -234,7 +236,7 @@ void EnsureTasksToCompleteCountAndUnblock(scoped_refptr<TestTracker> tracker,
 }
 
 // Tests that same-named tokens have the same ID.
-TEST_F(SequencedWorkerPoolTest, NamedTokens) {
+TEST_P(SequencedWorkerPoolTest, NamedTokens) {
   const std::string name1("hello");
   SequencedWorkerPool::SequenceToken token1 =
       pool()->GetNamedSequenceToken(name1);
@@ -262,7 +264,7 @@ TEST_F(SequencedWorkerPoolTest, NamedTokens) {
 
 // Tests that posting a bunch of tasks (many more than the number of worker
 // threads) runs them all.
-TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
+TEST_P(SequencedWorkerPoolTest, LotsOfTasks) {
   pool()->PostWorkerTask(FROM_HERE,
                          base::Bind(&TestTracker::SlowTask, tracker(), 0));
 
@@ -280,9 +282,9 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasks) {
 // worker threads) to two pools simultaneously runs them all twice.
 // This test is meant to shake out any concurrency issues between
 // pools (like histograms).
-TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
-  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1");
-  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2");
+TEST_P(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
+  SequencedWorkerPoolOwner pool1(kNumWorkerThreads, "test1", GetParam());
+  SequencedWorkerPoolOwner pool2(kNumWorkerThreads, "test2", GetParam());
 
   base::Closure slow_task = base::Bind(&TestTracker::SlowTask, tracker(), 0);
   pool1.pool()->PostWorkerTask(FROM_HERE, slow_task);
@@ -306,7 +308,7 @@ TEST_F(SequencedWorkerPoolTest, LotsOfTasksTwoPools) {
 
 // Test that tasks with the same sequence token are executed in order but don't
 // affect other tasks.
-TEST_F(SequencedWorkerPoolTest, Sequence) {
+TEST_P(SequencedWorkerPoolTest, Sequence) {
   // Fill all the worker threads except one.
   const size_t kNumBackgroundTasks = kNumWorkerThreads - 1;
   ThreadBlocker background_blocker;
@@ -367,7 +369,7 @@ TEST_F(SequencedWorkerPoolTest, Sequence) {
 
 // Tests that unrun tasks are discarded properly according to their shutdown
 // mode.
-TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, DiscardOnShutdown) {
   // Start tasks to take all the threads and block them.
   EnsureAllWorkersCreated();
   ThreadBlocker blocker;
@@ -412,7 +414,7 @@ TEST_F(SequencedWorkerPoolTest, DiscardOnShutdown) {
 }
 
 // Tests that CONTINUE_ON_SHUTDOWN tasks don't block shutdown.
-TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
+TEST_P(SequencedWorkerPoolTest, ContinueOnShutdown) {
   scoped_refptr<TaskRunner> runner(pool()->GetTaskRunnerWithShutdownBehavior(
       SequencedWorkerPool::CONTINUE_ON_SHUTDOWN));
   scoped_refptr<SequencedTaskRunner> sequenced_runner(
@@ -461,7 +463,7 @@ TEST_F(SequencedWorkerPoolTest, ContinueOnShutdown) {
 // Ensure all worker threads are created, and then trigger a spurious
 // work signal. This shouldn't cause any other work signals to be
 // triggered. This is a regression test for http://crbug.com/117469.
-TEST_F(SequencedWorkerPoolTest, SpuriousWorkSignal) {
+TEST_P(SequencedWorkerPoolTest, SpuriousWorkSignal) {
   EnsureAllWorkersCreated();
   int old_has_work_call_count = has_work_call_count();
   pool()->SignalHasWorkForTesting();
@@ -486,13 +488,13 @@ void IsRunningOnCurrentThreadTask(
 }
 
 // Verify correctness of the IsRunningSequenceOnCurrentThread method.
-TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
+TEST_P(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
   SequencedWorkerPool::SequenceToken token1 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken token2 = pool()->GetSequenceToken();
   SequencedWorkerPool::SequenceToken unsequenced_token;
 
   scoped_refptr<SequencedWorkerPool> unused_pool =
-      new SequencedWorkerPool(2, "unused_pool");
+      new SequencedWorkerPool(2, "unused_pool", GetParam(), NULL);
   EXPECT_TRUE(token1.Equals(unused_pool->GetSequenceToken()));
   EXPECT_TRUE(token2.Equals(unused_pool->GetSequenceToken()));
 
@@ -522,6 +524,64 @@ TEST_F(SequencedWorkerPoolTest, IsRunningOnCurrentThread) {
   unused_pool->Shutdown();
 }
 
+// Posts |num_tasks| fast tasks to |pool| and then blocks on |blocker|. When
+// run on a worker in WORK_STEALING mode, the posted tasks land on the
+// blocked worker's own deque.
+void PostFastTasksAndBlock(SequencedWorkerPool* pool,
+                           const scoped_refptr<TestTracker>& tracker,
+                           size_t num_tasks,
+                           ThreadBlocker* blocker) {
+  for (size_t i = 0; i < num_tasks; i++) {
+    pool->PostWorkerTask(FROM_HERE,
+                         base::Bind(&TestTracker::FastTask, tracker, i));
+  }
+  tracker->BlockTask(-1, blocker);
+}
+
+// Tests that tasks posted from a worker which then blocks are run by the
+// other workers.
+TEST_P(SequencedWorkerPoolTest, TasksPostedFromBlockedWorker) {
+  EnsureAllWorkersCreated();
+  ThreadBlocker blocker;
+  const size_t kNumTasks = 10;
+  pool()->PostWorkerTask(FROM_HERE,
+                         base::Bind(&PostFastTasksAndBlock, pool(),
+                                    make_scoped_refptr(tracker()), kNumTasks,
+                                    &blocker));
+
+  // All the fast tasks should complete while the posting worker is blocked.
+  std::vector<int> result = tracker()->WaitUntilTasksComplete(kNumTasks);
+  EXPECT_EQ(kNumTasks, result.size());
+  EXPECT_TRUE(std::find(result.begin(), result.end(), -1) == result.end());
+
+  blocker.Unblock(1);
+  result = tracker()->WaitUntilTasksComplete(kNumTasks + 1);
+  EXPECT_EQ(kNumTasks + 1, result.size());
+}
+
+// Tests that FlushForTesting waits for tasks in all scheduler modes,
+// including ones posted from worker threads.
+TEST_P(SequencedWorkerPoolTest, FlushForTesting) {
+  ThreadBlocker blocker;
+  blocker.Unblock(1);
+  const size_t kNumTasks = 5;
+  for (size_t i = 0; i < kNumTasks; i++) {
+    pool()->PostWorkerTask(FROM_HERE,
+                           base::Bind(&TestTracker::FastTask, tracker(), i));
+  }
+  pool()->PostWorkerTask(FROM_HERE,
+                         base::Bind(&PostFastTasksAndBlock, pool(),
+                                    make_scoped_refptr(tracker()), kNumTasks,
+                                    &blocker));
+  pool()->FlushForTesting();
+  EXPECT_EQ(2 * kNumTasks + 1, tracker()->WaitUntilTasksComplete(0).size());
+}
+
+INSTANTIATE_TEST_CASE_P(
+    SchedulerModes, SequencedWorkerPoolTest,
+    ::testing::Values(SequencedWorkerPool::SHARED_QUEUE,
+                      SequencedWorkerPool::WORK_STEALING));
+
 class SequencedWorkerPoolTaskRunnerTestDelegate {
  public:
   SequencedWorkerPoolTaskRunnerTestDelegate() {}
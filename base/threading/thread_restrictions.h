@@ -57,6 +57,7 @@ class NetworkManagerApi;
 
 namespace base {
 
+class ParallelWork;
 class SequencedWorkerPool;
 class SimpleThread;
 class Thread;
@@ -161,6 +162,7 @@ class BASE_EXPORT ThreadRestrictions {
   friend class ::HistogramSynchronizer;
   friend class ::RenderWidgetHelper;     
   friend class ::TestingAutomationProvider;
+  friend class ParallelWork;  // Waits only for pieces already running.
   friend class SequencedWorkerPool;
   friend class SimpleThread;
   friend class Thread;
@@ -9,6 +9,13 @@
 
 namespace base {
 
+namespace {
+
+// Value of scheduled_task_id_ when the scheduled task can't be cancelled.
+const int kNoCancelableTask = -1;
+
+}  // namespace
+
 // BaseTimerTaskInternal is a simple delegate for scheduling a callback to
 // Timer in the MessageLoop. It also handles the following edge
 // cases:
@@ -23,9 +30,13 @@ class BaseTimerTaskInternal {
   ~BaseTimerTaskInternal() {
     // This task may be getting cleared because the MessageLoop has been
     // destructed.  If so, don't leave Timer with a dangling pointer
-    // to this.
-    if (timer_)
+    // to this.  The MessageLoop is already removing this task, so Timer
+    // must not try to cancel it.
+    if (timer_) {
+      timer_->scheduled_task_ = NULL;
+      timer_->scheduled_task_id_ = kNoCancelableTask;
       timer_->StopAndAbandon();
+    }
   }
 
   void Run() {
@@ -36,6 +47,7 @@ class BaseTimerTaskInternal {
     // *this will be deleted by the MessageLoop, so Timer needs to
     // forget us:
     timer_->scheduled_task_ = NULL;
+    timer_->scheduled_task_id_ = kNoCancelableTask;
 
     // Although Timer should not call back into *this, let's clear
     // the timer_ member first to be pedantic.
@@ -44,8 +56,8 @@ class BaseTimerTaskInternal {
     timer->RunScheduledTask();
   }
 
-  // The task remains in the MessageLoop queue, but nothing will happen when it
-  // runs.
+  // Nothing will happen if the task still runs.  Timer also cancels the task
+  // where it can, which deletes *this.
   void Abandon() {
     timer_ = NULL;
   }
@@ -56,6 +68,7 @@ class BaseTimerTaskInternal {
 
 Timer::Timer(bool retain_user_task, bool is_repeating)
     : scheduled_task_(NULL),
+      scheduled_task_id_(kNoCancelableTask),
       thread_id_(0),
       is_repeating_(is_repeating),
       retain_user_task_(retain_user_task),
@@ -67,6 +80,7 @@ Timer::Timer(const tracked_objects::Location& posted_from,
              const base::Closure& user_task,
              bool is_repeating)
     : scheduled_task_(NULL),
+      scheduled_task_id_(kNoCancelableTask),
       posted_from_(posted_from),
       delay_(delay),
       user_task_(user_task),
@@ -91,6 +105,11 @@ void Timer::Stop() {
   is_running_ = false;
   if (!retain_user_task_)
     user_task_.Reset();
+  // The scheduled task would only be reused by a Reset() before it runs.
+  // When it can be removed from the MessageLoop, do so rather than leave it
+  // queued until it expires.
+  if (scheduled_task_id_ != kNoCancelableTask)
+    AbandonScheduledTask();
 }
 
 void Timer::Reset() {
@@ -129,9 +148,18 @@ void Timer::PostNewScheduledTask(TimeDelta delay) {
   DCHECK(scheduled_task_ == NULL);
   is_running_ = true;
   scheduled_task_ = new BaseTimerTaskInternal(this);
-  MessageLoop::current()->PostDelayedTask(posted_from_,
-      base::Bind(&BaseTimerTaskInternal::Run, base::Owned(scheduled_task_)),
-      delay);
+  base::Closure task =
+      base::Bind(&BaseTimerTaskInternal::Run, base::Owned(scheduled_task_));
+  // Tasks with a delay go straight into the MessageLoop's delayed queue, so
+  // they can be removed when the timer is stopped or reset.  Zero-delay tasks
+  // must keep their place among the loop's immediate tasks.
+  if (delay > TimeDelta()) {
+    scheduled_task_id_ = MessageLoop::current()->PostCancelableDelayedTask(
+        posted_from_, task, delay);
+  } else {
+    scheduled_task_id_ = kNoCancelableTask;
+    MessageLoop::current()->PostDelayedTask(posted_from_, task, delay);
+  }
   scheduled_run_time_ = desired_run_time_ = TimeTicks::Now() + delay;
   // Remember the thread ID that posts the first task -- this will be verified
   // later when the task is abandoned to detect misuse from multiple threads.
@@ -145,6 +173,15 @@ void Timer::AbandonScheduledTask() {
   if (scheduled_task_) {
     scheduled_task_->Abandon();
     scheduled_task_ = NULL;
+    int task_id = scheduled_task_id_;
+    scheduled_task_id_ = kNoCancelableTask;
+    // The task can only be removed from the thread of the MessageLoop it was
+    // posted to; elsewhere it stays queued and does nothing when it runs.
+    if (task_id != kNoCancelableTask &&
+        thread_id_ == static_cast<int>(PlatformThread::CurrentId())) {
+      // Deletes the abandoned task.
+      MessageLoop::current()->CancelDelayedTask(task_id);
+    }
   }
 }
 
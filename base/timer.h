@@ -142,6 +142,10 @@ class BASE_EXPORT Timer {
   // RunScheduledTask() at scheduled_run_time_.
   BaseTimerTaskInternal* scheduled_task_;
 
+  // The MessageLoop id of scheduled_task_ when it can be cancelled, i.e. it
+  // was posted with a positive delay; otherwise kNoCancelableTask.
+  int scheduled_task_id_;
+
   // Location in user code.
   tracked_objects::Location posted_from_;
   // Delay requested by user.
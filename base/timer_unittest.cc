@@ -474,4 +474,51 @@ TEST(TimerTest, ContinuationReset) {
   }
 }
 
+// Sets |*destroyed| when deleted, to observe when a timer's task goes away.
+class TaskDestructionFlag {
+ public:
+  explicit TaskDestructionFlag(bool* destroyed) : destroyed_(destroyed) {}
+  ~TaskDestructionFlag() { *destroyed_ = true; }
+  void Run() {}
+
+ private:
+  bool* destroyed_;
+};
+
+TEST(TimerTest, StopRemovesScheduledTask) {
+  MessageLoop loop(MessageLoop::TYPE_DEFAULT);
+  bool destroyed = false;
+  base::Timer timer(false, false);
+  timer.Start(FROM_HERE, TimeDelta::FromDays(1),
+              base::Bind(&TaskDestructionFlag::Run,
+                         base::Owned(new TaskDestructionFlag(&destroyed))));
+  EXPECT_FALSE(destroyed);
+  // Stopping a non-retaining timer drops the user task, and the task the
+  // timer scheduled is removed from the loop rather than left for a day.
+  timer.Stop();
+  EXPECT_TRUE(destroyed);
+
+  // The timer still works afterwards.
+  ClearAllCallbackHappened();
+  timer.Start(FROM_HERE, TimeDelta::FromMilliseconds(10),
+              base::Bind(&SetCallbackHappened1));
+  MessageLoop::current()->Run();
+  EXPECT_TRUE(g_callback_happened1);
+}
+
+TEST(TimerTest, ResetEarlierRunsOnce) {
+  ClearAllCallbackHappened();
+  MessageLoop loop(MessageLoop::TYPE_DEFAULT);
+  base::Timer timer(false, false);
+  // The first scheduled task is replaced by a sooner one and removed.
+  timer.Start(FROM_HERE, TimeDelta::FromDays(1),
+              base::Bind(&SetCallbackHappened2));
+  timer.Start(FROM_HERE, TimeDelta::FromMilliseconds(10),
+              base::Bind(&SetCallbackHappened1));
+  MessageLoop::current()->Run();
+  EXPECT_TRUE(g_callback_happened1);
+  EXPECT_FALSE(g_callback_happened2);
+  EXPECT_FALSE(timer.IsRunning());
+}
+
 }  // namespace
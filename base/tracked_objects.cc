@@ -367,9 +367,11 @@ void ThreadData::Snapshot(bool reset_max, ProcessDataSnapshot* process_data) {
 }
 
 Births* ThreadData::TallyABirth(const Location& location) {
-  BirthMap::iterator it = birth_map_.find(location);
+  // Look the location up once, and use the result as the insertion hint for
+  // a new entry, as this runs for every task posted.
+  BirthMap::iterator it = birth_map_.lower_bound(location);
   Births* child;
-  if (it != birth_map_.end()) {
+  if (it != birth_map_.end() && !(location < it->first)) {
     child =  it->second;
     child->RecordBirth();
   } else {
@@ -377,7 +379,7 @@ Births* ThreadData::TallyABirth(const Location& location) {
     // Lock since the map may get relocated now, and other threads sometimes
     // snapshot it (but they lock before copying it).
     base::AutoLock lock(map_lock_);
-    birth_map_[location] = child;
+    birth_map_.insert(it, BirthMap::value_type(location, child));
   }
 
   if (kTrackParentChildLinks && status_ > PROFILING_ACTIVE &&
@@ -410,13 +412,14 @@ void ThreadData::TallyADeath(const Births& birth,
   if (kAllowAlternateTimeSourceHandling && now_function_)
     queue_duration = 0;
 
-  DeathMap::iterator it = death_map_.find(&birth);
+  DeathMap::iterator it = death_map_.lower_bound(&birth);
   DeathData* death_data;
-  if (it != death_map_.end()) {
+  if (it != death_map_.end() && it->first == &birth) {
     death_data = &it->second;
   } else {
     base::AutoLock lock(map_lock_);  // Lock as the map may get relocated now.
-    death_data = &death_map_[&birth];
+    death_data = &death_map_.insert(
+        it, DeathMap::value_type(&birth, DeathData()))->second;
   }  // Release lock ASAP.
   death_data->RecordDeath(queue_duration, run_duration, random_number_);
 
@@ -17,6 +17,14 @@ namespace {
 
 // Generalized Unicode converter -----------------------------------------------
 
+// Returns true if |c| is an ASCII character, which is a single code unit with
+// the same value in UTF-8, UTF-16 and UTF-32. The cast makes negative values
+// of signed char types count as non-ASCII.
+template<typename CHAR>
+inline bool IsASCIIUnit(CHAR c) {
+  return static_cast<uint32>(c) < 0x80;
+}
+
 // Converts the given source Unicode character type to the given destination
 // Unicode character type as a STL string. The given input buffer and size
 // determine the source, and the given output STL string will be replaced by
@@ -29,6 +37,17 @@ bool ConvertUnicode(const SRC_CHAR* src,
   bool success = true;
   int32 src_len32 = static_cast<int32>(src_len);
   for (int32 i = 0; i < src_len32; i++) {
+    // Most text is ASCII, which is the same in every encoding, so copy runs of
+    // it over directly instead of decoding and encoding each character.
+    int32 ascii_end = i;
+    while (ascii_end < src_len32 && IsASCIIUnit(src[ascii_end]))
+      ascii_end++;
+    if (ascii_end > i) {
+      output->append(src + i, src + ascii_end);
+      i = ascii_end - 1;
+      continue;
+    }
+
     uint32 code_point;
     if (ReadUnicodeCharacter(src, src_len32, &i, &code_point)) {
       WriteUnicodeCharacter(code_point, output);
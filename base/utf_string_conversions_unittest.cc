@@ -184,6 +184,21 @@ TEST(UTFStringConversionsTest, ConvertUTF32ToUTF8) {
 }
 #endif  // defined(WCHAR_T_IS_UTF32)
 
+// ASCII runs are copied over directly, so check that they join up correctly
+// with the characters that are converted one at a time around them.
+TEST(UTFStringConversionsTest, ConvertMixedASCII) {
+  const char kUTF8[] = "ab\xe4\xbd\xa0" "cd\xe5\xa5\xbd\xff" "ef";
+  const char16 kUTF16[] = { 'a', 'b', 0x4f60, 'c', 'd', 0x597d, 0xfffd,
+                            'e', 'f', 0 };
+  string16 utf16;
+  EXPECT_FALSE(UTF8ToUTF16(kUTF8, arraysize(kUTF8) - 1, &utf16));
+  EXPECT_EQ(string16(kUTF16), utf16);
+
+  std::string utf8;
+  EXPECT_TRUE(UTF16ToUTF8(utf16.data(), utf16.length(), &utf8));
+  EXPECT_EQ("ab\xe4\xbd\xa0" "cd\xe5\xa5\xbd\xef\xbf\xbd" "ef", utf8);
+}
+
 TEST(UTFStringConversionsTest, ConvertMultiString) {
   static wchar_t wmulti[] = {
     L'f', L'o', L'o', L'\0',
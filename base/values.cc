@@ -345,6 +345,24 @@ BinaryValue::BinaryValue(char* buffer, size_t size)
 
 ///////////////////// DictionaryValue ////////////////////
 
+namespace {
+
+// Orders dictionary entries by key, and against a key alone for binary
+// searches.
+struct EntryKeyLess {
+  bool operator()(const std::pair<std::string, Value*>& lhs,
+                  const std::pair<std::string, Value*>& rhs) const {
+    return lhs.first < rhs.first;
+  }
+
+  bool operator()(const std::pair<std::string, Value*>& entry,
+                  const std::string& key) const {
+    return entry.first < key;
+  }
+};
+
+}  // namespace
+
 DictionaryValue::DictionaryValue()
     : Value(TYPE_DICTIONARY) {
 }
@@ -367,13 +385,13 @@ bool DictionaryValue::GetAsDictionary(const DictionaryValue** out_value) const {
 
 bool DictionaryValue::HasKey(const std::string& key) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator current_entry = dictionary_.find(key);
+  Entries::const_iterator current_entry = Find(key);
   DCHECK((current_entry == dictionary_.end()) || current_entry->second);
   return current_entry != dictionary_.end();
 }
 
 void DictionaryValue::Clear() {
-  ValueMap::iterator dict_iterator = dictionary_.begin();
+  Entries::iterator dict_iterator = dictionary_.begin();
   while (dict_iterator != dictionary_.end()) {
     delete dict_iterator->second;
     ++dict_iterator;
@@ -430,15 +448,54 @@ void DictionaryValue::SetString(const std::string& path,
 
 void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
                                               Value* in_value) {
+  // Keys usually arrive in order (e.g. from DeepCopy() or sorted JSON), so
+  // check for an append before searching.
+  if (dictionary_.empty() || dictionary_.back().first < key) {
+    dictionary_.push_back(Entry(key, in_value));
+    return;
+  }
+
   // If there's an existing value here, we need to delete it, because
   // we own all our children.
-  std::pair<ValueMap::iterator, bool> ins_res =
-      dictionary_.insert(std::make_pair(key, in_value));
-  if (!ins_res.second) {
-    DCHECK_NE(ins_res.first->second, in_value);  // This would be bogus
-    delete ins_res.first->second;
-    ins_res.first->second = in_value;
+  Entries::iterator entry = LowerBound(key);
+  if (entry != dictionary_.end() && entry->first == key) {
+    DCHECK_NE(entry->second, in_value);  // This would be bogus
+    delete entry->second;
+    entry->second = in_value;
+    return;
+  }
+  dictionary_.insert(entry, Entry(key, in_value));
+}
+
+void DictionaryValue::SetEntriesWithoutPathExpansion(Entries* entries) {
+  // The sort is stable, so of several new entries with the same key the one
+  // added last comes last, and it is the one kept.
+  std::stable_sort(entries->begin(), entries->end(), EntryKeyLess());
+
+  Entries merged;
+  merged.reserve(dictionary_.size() + entries->size());
+  Entries::iterator old_entry = dictionary_.begin();
+  for (Entries::iterator entry = entries->begin(); entry != entries->end();
+       ++entry) {
+    Entries::iterator next = entry + 1;
+    if (next != entries->end() && next->first == entry->first) {
+      DCHECK_NE(next->second, entry->second);  // This would be bogus
+      delete entry->second;
+      continue;
+    }
+    while (old_entry != dictionary_.end() && old_entry->first < entry->first)
+      merged.push_back(*old_entry++);
+    if (old_entry != dictionary_.end() && old_entry->first == entry->first) {
+      DCHECK_NE(old_entry->second, entry->second);  // This would be bogus
+      delete old_entry->second;
+      ++old_entry;
+    }
+    merged.push_back(*entry);
   }
+  merged.insert(merged.end(), old_entry, dictionary_.end());
+
+  dictionary_.swap(merged);
+  entries->clear();
 }
 
 bool DictionaryValue::Get(const std::string& path, Value** out_value) const {
@@ -562,7 +619,7 @@ bool DictionaryValue::GetList(const std::string& path,
 bool DictionaryValue::GetWithoutPathExpansion(const std::string& key,
                                               Value** out_value) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator entry_iterator = dictionary_.find(key);
+  Entries::const_iterator entry_iterator = Find(key);
   if (entry_iterator == dictionary_.end())
     return false;
 
@@ -656,7 +713,7 @@ bool DictionaryValue::Remove(const std::string& path, Value** out_value) {
 bool DictionaryValue::RemoveWithoutPathExpansion(const std::string& key,
                                                  Value** out_value) {
   DCHECK(IsStringUTF8(key));
-  ValueMap::iterator entry_iterator = dictionary_.find(key);
+  Entries::iterator entry_iterator = Find(key);
   if (entry_iterator == dictionary_.end())
     return false;
 
@@ -697,10 +754,12 @@ void DictionaryValue::MergeDictionary(const DictionaryValue* dictionary) {
 DictionaryValue* DictionaryValue::DeepCopy() const {
   DictionaryValue* result = new DictionaryValue;
 
-  for (ValueMap::const_iterator current_entry(dictionary_.begin());
+  // The entries are already sorted, so they can be copied in order.
+  result->dictionary_.reserve(dictionary_.size());
+  for (Entries::const_iterator current_entry(dictionary_.begin());
        current_entry != dictionary_.end(); ++current_entry) {
-    result->SetWithoutPathExpansion(current_entry->first,
-                                    current_entry->second->DeepCopy());
+    result->dictionary_.push_back(
+        Entry(current_entry->first, current_entry->second->DeepCopy()));
   }
 
   return result;
@@ -712,26 +771,50 @@ bool DictionaryValue::Equals(const Value* other) const {
 
   const DictionaryValue* other_dict =
       static_cast<const DictionaryValue*>(other);
-  key_iterator lhs_it(begin_keys());
-  key_iterator rhs_it(other_dict->begin_keys());
-  while (lhs_it != end_keys() && rhs_it != other_dict->end_keys()) {
-    Value* lhs;
-    Value* rhs;
-    if (*lhs_it != *rhs_it ||
-        !GetWithoutPathExpansion(*lhs_it, &lhs) ||
-        !other_dict->GetWithoutPathExpansion(*rhs_it, &rhs) ||
-        !lhs->Equals(rhs)) {
+  if (dictionary_.size() != other_dict->dictionary_.size())
+    return false;
+
+  // Both sides are sorted by key, so they can be compared entry by entry.
+  Entries::const_iterator lhs_it(dictionary_.begin());
+  Entries::const_iterator rhs_it(other_dict->dictionary_.begin());
+  for (; lhs_it != dictionary_.end(); ++lhs_it, ++rhs_it) {
+    if (lhs_it->first != rhs_it->first ||
+        !lhs_it->second->Equals(rhs_it->second)) {
       return false;
     }
-    ++lhs_it;
-    ++rhs_it;
   }
-  if (lhs_it != end_keys() || rhs_it != other_dict->end_keys())
-    return false;
 
   return true;
 }
 
+DictionaryValue::Entries::iterator DictionaryValue::LowerBound(
+    const std::string& key) {
+  return std::lower_bound(dictionary_.begin(), dictionary_.end(), key,
+                          EntryKeyLess());
+}
+
+DictionaryValue::Entries::const_iterator DictionaryValue::LowerBound(
+    const std::string& key) const {
+  return std::lower_bound(dictionary_.begin(), dictionary_.end(), key,
+                          EntryKeyLess());
+}
+
+DictionaryValue::Entries::iterator DictionaryValue::Find(
+    const std::string& key) {
+  Entries::iterator entry = LowerBound(key);
+  if (entry != dictionary_.end() && entry->first == key)
+    return entry;
+  return dictionary_.end();
+}
+
+DictionaryValue::Entries::const_iterator DictionaryValue::Find(
+    const std::string& key) const {
+  Entries::const_iterator entry = LowerBound(key);
+  if (entry != dictionary_.end() && entry->first == key)
+    return entry;
+  return dictionary_.end();
+}
+
 ///////////////////// ListValue ////////////////////
 
 ListValue::ListValue() : Value(TYPE_LIST) {
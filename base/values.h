@@ -47,7 +47,6 @@ class StringValue;
 class Value;
 
 typedef std::vector<Value*> ValueVector;
-typedef std::map<std::string, Value*> ValueMap;
 
 // The Value class is the base class for Values. A Value can be instantiated
 // via the Create*Value() factory methods, or by directly creating instances of
@@ -212,8 +211,20 @@ class BASE_EXPORT BinaryValue: public Value {
 // DictionaryValue provides a key-value dictionary with (optional) "path"
 // parsing for recursive access; see the comment at the top of the file. Keys
 // are |std::string|s and should be UTF-8 encoded.
+//
+// The entries are kept in a single vector sorted by key rather than in a
+// node-based map, so a dictionary costs one allocation for its entries and
+// copying, comparing and destroying it walk contiguous memory. Lookups are
+// binary searches; inserting or removing a key in the middle is linear in the
+// size of the dictionary, which is cheap for the small-to-medium dictionaries
+// that make up preference and policy trees. Code that adds many keys in no
+// particular order should collect them and pass them all to
+// SetEntriesWithoutPathExpansion(), which sorts them once.
 class BASE_EXPORT DictionaryValue : public Value {
  public:
+  typedef std::pair<std::string, Value*> Entry;
+  typedef std::vector<Entry> Entries;
+
   DictionaryValue();
   virtual ~DictionaryValue();
 
@@ -257,6 +268,13 @@ class BASE_EXPORT DictionaryValue : public Value {
   // be used as paths.
   void SetWithoutPathExpansion(const std::string& key, Value* in_value);
 
+  // Adds every entry of |entries|, in any order, with the same result as
+  // calling SetWithoutPathExpansion() for each of them in turn: a later entry
+  // replaces an earlier one with the same key. Takes ownership of the values
+  // and leaves |entries| empty. Costs one sort of |entries| and one merge,
+  // rather than a vector insert per key.
+  void SetEntriesWithoutPathExpansion(Entries* entries);
+
   // Gets the Value associated with the given path starting from this object.
   // A path has the form "<key>" or "<key>.<key>.[...]", where "." indexes
   // into the next DictionaryValue down.  If the path can be resolved
@@ -333,7 +351,7 @@ class BASE_EXPORT DictionaryValue : public Value {
   class key_iterator
       : private std::iterator<std::input_iterator_tag, const std::string> {
    public:
-    explicit key_iterator(ValueMap::const_iterator itr) { itr_ = itr; }
+    explicit key_iterator(Entries::const_iterator itr) { itr_ = itr; }
     key_iterator operator++() {
       ++itr_;
       return *this;
@@ -343,7 +361,7 @@ class BASE_EXPORT DictionaryValue : public Value {
     bool operator==(const key_iterator& other) { return itr_ == other.itr_; }
 
    private:
-    ValueMap::const_iterator itr_;
+    Entries::const_iterator itr_;
   };
 
   key_iterator begin_keys() const { return key_iterator(dictionary_.begin()); }
@@ -364,7 +382,7 @@ class BASE_EXPORT DictionaryValue : public Value {
 
    private:
     const DictionaryValue& target_;
-    ValueMap::const_iterator it_;
+    Entries::const_iterator it_;
   };
 
   // Overridden from Value:
@@ -372,7 +390,16 @@ class BASE_EXPORT DictionaryValue : public Value {
   virtual bool Equals(const Value* other) const OVERRIDE;
 
  private:
-  ValueMap dictionary_;
+  // Returns the first entry whose key is not less than |key|.
+  Entries::iterator LowerBound(const std::string& key);
+  Entries::const_iterator LowerBound(const std::string& key) const;
+
+  // Returns the entry for |key|, or dictionary_.end() if there is none.
+  Entries::iterator Find(const std::string& key);
+  Entries::const_iterator Find(const std::string& key) const;
+
+  // Sorted by key, with unique keys. The values are owned.
+  Entries dictionary_;
 
   DISALLOW_COPY_AND_ASSIGN(DictionaryValue);
 };
@@ -0,0 +1,192 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/values.h"
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Shape of the synthetic preference tree: a few top-level sections, each
+// with a number of groups holding a mix of scalar, string and list prefs,
+// roughly like a profile's Preferences file.
+const int kNumSections = 20;
+const int kGroupsPerSection = 20;
+const int kPrefsPerGroup = 10;
+
+const int kNumGetIterations = 20;
+const int kNumCopyIterations = 20;
+
+// A single flat dictionary with many keys, like a large policy or extension
+// settings object. Its keys are visited in a scrambled order; the stride is
+// prime to the size so every key is used once.
+const int kLargeDictionarySize = 20000;
+const int kLargeDictionaryStride = 7919;
+
+std::string SectionKey(int section) {
+  return StringPrintf("section%d", section);
+}
+
+std::string GroupKey(int group) {
+  return StringPrintf("group%d", group);
+}
+
+std::string PrefKey(int pref) {
+  return StringPrintf("pref%d", pref);
+}
+
+std::string PrefPath(int section, int group, int pref) {
+  return SectionKey(section) + "." + GroupKey(group) + "." + PrefKey(pref);
+}
+
+void SetPref(DictionaryValue* root, int section, int group, int pref) {
+  const std::string path = PrefPath(section, group, pref);
+  switch (pref % 4) {
+    case 0:
+      root->SetInteger(path, pref);
+      break;
+    case 1:
+      root->SetBoolean(path, true);
+      break;
+    case 2:
+      root->SetString(path, "http://www.example.com/" + path);
+      break;
+    default: {
+      ListValue* list = new ListValue;
+      for (int i = 0; i < 3; ++i)
+        list->Append(Value::CreateStringValue(PrefKey(i)));
+      root->Set(path, list);
+      break;
+    }
+  }
+}
+
+// Builds the tree with the keys in reverse order, so the inserts do not all
+// land at the end of each dictionary.
+DictionaryValue* BuildPrefTree() {
+  DictionaryValue* root = new DictionaryValue;
+  for (int section = kNumSections - 1; section >= 0; --section) {
+    for (int group = kGroupsPerSection - 1; group >= 0; --group) {
+      for (int pref = kPrefsPerGroup - 1; pref >= 0; --pref)
+        SetPref(root, section, group, pref);
+    }
+  }
+  return root;
+}
+
+std::string LargeDictionaryKey(int i) {
+  return StringPrintf("key%d", (i * kLargeDictionaryStride) %
+                                   kLargeDictionarySize);
+}
+
+}  // namespace
+
+TEST(ValuesPerfTest, Set) {
+  PerfTimeLogger timer("DictionaryValue_set");
+  scoped_ptr<DictionaryValue> root(BuildPrefTree());
+  timer.Done();
+  EXPECT_EQ(static_cast<size_t>(kNumSections), root->size());
+}
+
+TEST(ValuesPerfTest, Get) {
+  scoped_ptr<DictionaryValue> root(BuildPrefTree());
+  int found = 0;
+
+  PerfTimeLogger timer("DictionaryValue_get");
+  for (int i = 0; i < kNumGetIterations; ++i) {
+    for (int section = 0; section < kNumSections; ++section) {
+      for (int group = 0; group < kGroupsPerSection; ++group) {
+        for (int pref = 0; pref < kPrefsPerGroup; ++pref) {
+          Value* value = NULL;
+          if (root->Get(PrefPath(section, group, pref), &value))
+            ++found;
+        }
+      }
+    }
+  }
+  timer.Done();
+
+  EXPECT_EQ(kNumGetIterations * kNumSections * kGroupsPerSection *
+                kPrefsPerGroup,
+            found);
+}
+
+TEST(ValuesPerfTest, DeepCopyAndDestroy) {
+  scoped_ptr<DictionaryValue> root(BuildPrefTree());
+
+  PerfTimeLogger timer("DictionaryValue_deep_copy");
+  for (int i = 0; i < kNumCopyIterations; ++i) {
+    scoped_ptr<DictionaryValue> copy(root->DeepCopy());
+    EXPECT_EQ(root->size(), copy->size());
+  }
+  timer.Done();
+}
+
+TEST(ValuesPerfTest, Equals) {
+  scoped_ptr<DictionaryValue> root(BuildPrefTree());
+  scoped_ptr<DictionaryValue> copy(root->DeepCopy());
+
+  PerfTimeLogger timer("DictionaryValue_equals");
+  for (int i = 0; i < kNumCopyIterations; ++i)
+    EXPECT_TRUE(root->Equals(copy.get()));
+  timer.Done();
+}
+
+TEST(ValuesPerfTest, LargeDictionaryFromJSON) {
+  std::string json = "{";
+  for (int i = 0; i < kLargeDictionarySize; ++i) {
+    if (i > 0)
+      json += ",";
+    json += StringPrintf("\"%s\": %d", LargeDictionaryKey(i).c_str(), i);
+  }
+  json += "}";
+
+  PerfTimeLogger timer("DictionaryValue_large_from_json");
+  scoped_ptr<Value> root(JSONReader::Read(json));
+  timer.Done();
+
+  ASSERT_TRUE(root.get());
+  ASSERT_TRUE(root->IsType(Value::TYPE_DICTIONARY));
+  EXPECT_EQ(static_cast<size_t>(kLargeDictionarySize),
+            static_cast<DictionaryValue*>(root.get())->size());
+}
+
+TEST(ValuesPerfTest, LargeDictionarySetEntries) {
+  DictionaryValue::Entries entries;
+  for (int i = 0; i < kLargeDictionarySize; ++i) {
+    entries.push_back(DictionaryValue::Entry(LargeDictionaryKey(i),
+                                             Value::CreateIntegerValue(i)));
+  }
+
+  PerfTimeLogger timer("DictionaryValue_large_set_entries");
+  DictionaryValue dict;
+  dict.SetEntriesWithoutPathExpansion(&entries);
+  timer.Done();
+
+  EXPECT_EQ(static_cast<size_t>(kLargeDictionarySize), dict.size());
+}
+
+// Sets the same keys one at a time, which is quadratic in the size of the
+// dictionary. This is the cost SetEntriesWithoutPathExpansion() avoids.
+TEST(ValuesPerfTest, LargeDictionarySetOneByOne) {
+  PerfTimeLogger timer("DictionaryValue_large_set_one_by_one");
+  DictionaryValue dict;
+  for (int i = 0; i < kLargeDictionarySize; ++i) {
+    dict.SetWithoutPathExpansion(LargeDictionaryKey(i),
+                                 Value::CreateIntegerValue(i));
+  }
+  timer.Done();
+
+  EXPECT_EQ(static_cast<size_t>(kLargeDictionarySize), dict.size());
+}
+
+}  // namespace base
@@ -755,4 +755,90 @@ TEST(ValuesTest, DictionaryIterator) {
   EXPECT_TRUE(seen2);
 }
 
+TEST(ValuesTest, DictionaryKeyOrder) {
+  // Keys are inserted out of order, replaced and removed; iteration must
+  // still visit them sorted and each key once.
+  DictionaryValue dict;
+  const char* const kKeys[] = { "m", "c", "x", "a", "q", "c", "b", "z", "a" };
+  for (size_t i = 0; i < arraysize(kKeys); ++i)
+    dict.SetInteger(kKeys[i], static_cast<int>(i));
+  EXPECT_EQ(7U, dict.size());
+  EXPECT_TRUE(dict.RemoveWithoutPathExpansion("q", NULL));
+  EXPECT_FALSE(dict.RemoveWithoutPathExpansion("q", NULL));
+
+  std::string keys;
+  for (DictionaryValue::key_iterator it = dict.begin_keys();
+       it != dict.end_keys(); ++it) {
+    keys += *it;
+  }
+  EXPECT_EQ("abcmxz", keys);
+
+  int value = -1;
+  EXPECT_TRUE(dict.GetInteger("a", &value));
+  EXPECT_EQ(8, value);
+  EXPECT_TRUE(dict.GetInteger("c", &value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(dict.HasKey("d"));
+
+  // Dictionaries with the same contents compare equal regardless of the
+  // order the keys were set in.
+  DictionaryValue other;
+  other.SetInteger("z", 7);
+  other.SetInteger("x", 2);
+  other.SetInteger("m", 0);
+  other.SetInteger("c", 5);
+  other.SetInteger("b", 6);
+  EXPECT_FALSE(dict.Equals(&other));
+  other.SetInteger("a", 8);
+  EXPECT_TRUE(dict.Equals(&other));
+  scoped_ptr<DictionaryValue> copy(dict.DeepCopy());
+  EXPECT_TRUE(copy->Equals(&other));
+}
+
+TEST(ValuesTest, DictionarySetEntries) {
+  DictionaryValue dict;
+  dict.SetInteger("b", 1);
+  dict.SetInteger("d", 2);
+  dict.SetInteger("f", 3);
+
+  // New keys land between the existing ones, "d" is replaced and "a" is
+  // given twice, in which case the later entry wins.
+  DictionaryValue::Entries entries;
+  entries.push_back(DictionaryValue::Entry(
+      "e", Value::CreateIntegerValue(10)));
+  entries.push_back(DictionaryValue::Entry(
+      "a", Value::CreateIntegerValue(11)));
+  entries.push_back(DictionaryValue::Entry(
+      "d", Value::CreateIntegerValue(12)));
+  entries.push_back(DictionaryValue::Entry(
+      "g", Value::CreateIntegerValue(13)));
+  entries.push_back(DictionaryValue::Entry(
+      "a", Value::CreateIntegerValue(14)));
+  dict.SetEntriesWithoutPathExpansion(&entries);
+  EXPECT_TRUE(entries.empty());
+
+  std::string keys;
+  for (DictionaryValue::key_iterator it = dict.begin_keys();
+       it != dict.end_keys(); ++it) {
+    keys += *it;
+  }
+  EXPECT_EQ("abdefg", keys);
+
+  DictionaryValue expected;
+  expected.SetInteger("a", 14);
+  expected.SetInteger("b", 1);
+  expected.SetInteger("d", 12);
+  expected.SetInteger("e", 10);
+  expected.SetInteger("f", 3);
+  expected.SetInteger("g", 13);
+  EXPECT_TRUE(dict.Equals(&expected));
+
+  // Keys with dots are not expanded.
+  entries.push_back(DictionaryValue::Entry(
+      "x.y", Value::CreateIntegerValue(15)));
+  dict.SetEntriesWithoutPathExpansion(&entries);
+  EXPECT_TRUE(dict.HasKey("x.y"));
+  EXPECT_FALSE(dict.HasKey("x"));
+}
+
 }  // namespace base
@@ -842,6 +842,11 @@ const int AutocompleteController::kNoItemSelected = -1;
 // they initiate a query.
 static const int kExpireTimeMS = 500;
 
+// Minimum amount of time (in ms) between merging the matches of providers
+// that update asynchronously. Providers tend to report in bursts, and each
+// merge sorts all the matches and updates the popup.
+static const int kUpdateResultDelayMS = 20;
+
 AutocompleteController::AutocompleteController(
     Profile* profile,
     AutocompleteControllerDelegate* delegate)
@@ -918,6 +923,7 @@ void AutocompleteController::Start(
       (input_.matches_requested() == old_matches_requested);
 
   expire_timer_.Stop();
+  update_result_timer_.Stop();
 
   // Start the new query.
   in_start_ = true;
@@ -953,11 +959,18 @@ void AutocompleteController::Stop(bool clear_result) {
 
   expire_timer_.Stop();
   done_ = true;
-  if (clear_result && !result_.empty()) {
-    result_.Reset();
-    // NOTE: We pass in false since we're trying to only clear the popup, not
-    // touch the edit... this is all a mess and should be cleaned up :(
-    NotifyChanged(false);
+  if (clear_result) {
+    update_result_timer_.Stop();
+    if (!result_.empty()) {
+      result_.Reset();
+      // NOTE: We pass in false since we're trying to only clear the popup, not
+      // touch the edit... this is all a mess and should be cleaned up :(
+      NotifyChanged(false);
+    }
+  } else if (update_result_timer_.IsRunning()) {
+    // Show the matches the providers reported before stopping that are still
+    // waiting to be merged.
+    UpdateResult(false);
   }
 }
 
@@ -985,11 +998,27 @@ void AutocompleteController::OnProviderUpdate(bool updated_matches) {
   CheckIfDone();
   // Multiple providers may provide synchronous results, so we only update the
   // results if we're not in Start().
-  if (!in_start_ && (updated_matches || done_))
+  if (in_start_ || !(updated_matches || done_))
+    return;
+  // The last update of a query is shown right away; earlier ones are batched
+  // with any that follow within kUpdateResultDelayMS.
+  if (done_) {
     UpdateResult(false);
+  } else if (!update_result_timer_.IsRunning()) {
+    update_result_timer_.Start(FROM_HERE,
+        base::TimeDelta::FromMilliseconds(kUpdateResultDelayMS),
+        this, &AutocompleteController::UpdateAsynchronousResult);
+  }
+}
+
+void AutocompleteController::UpdateAsynchronousResult() {
+  UpdateResult(false);
 }
 
 void AutocompleteController::UpdateResult(bool is_synchronous_pass) {
+  // This update includes the matches of any update still waiting to be merged.
+  update_result_timer_.Stop();
+
   AutocompleteResult last_result;
   last_result.Swap(&result_);
 
@@ -717,6 +717,9 @@ class AutocompleteController : public ACProviderListener {
   // Start() is calling this to get the synchronous result.
   void UpdateResult(bool is_synchronous_pass);
 
+  // Calls UpdateResult() for updates batched by |update_result_timer_|.
+  void UpdateAsynchronousResult();
+
   // Updates |result| to populate each match's |associated_keyword| if that
   // match can show a keyword hint.  |result| should be sorted by
   // relevance before this is called.
@@ -755,6 +758,10 @@ class AutocompleteController : public ACProviderListener {
   // invokes |ExpireCopiedEntries|.
   base::OneShotTimer<AutocompleteController> expire_timer_;
 
+  // Timer used to batch the updates of providers that have not finished. When
+  // run invokes |UpdateAsynchronousResult|.
+  base::OneShotTimer<AutocompleteController> update_result_timer_;
+
   // True if a query is not currently running.
   bool done_;
 
@@ -105,6 +105,21 @@ void TestProvider::AddResults(int start_at, int num) {
   }
 }
 
+// Autocomplete provider that has no matches and doesn't finish until it is
+// stopped, so that the controller keeps waiting for it.
+class HangingProvider : public AutocompleteProvider {
+ public:
+  HangingProvider() : AutocompleteProvider(NULL, NULL, "") {}
+
+  virtual void Start(const AutocompleteInput& input,
+                     bool minimal_changes) {
+    done_ = input.matches_requested() != AutocompleteInput::ALL_MATCHES;
+  }
+
+ private:
+  ~HangingProvider() {}
+};
+
 class AutocompleteProviderTest : public testing::Test,
                                  public content::NotificationObserver {
  protected:
@@ -117,6 +132,10 @@ class AutocompleteProviderTest : public testing::Test,
  protected:
   void ResetControllerWithTestProviders(bool same_destinations);
 
+  // Pairs a TestProvider with a HangingProvider, so that the TestProvider's
+  // asynchronous update is never the last one of a query.
+  void ResetControllerWithHangingProvider();
+
   // Runs a query on the input "a", and makes sure both providers' input is
   // properly collected.
   void RunTest();
@@ -177,6 +196,24 @@ void AutocompleteProviderTest::ResetControllerWithTestProviders(
                  content::Source<AutocompleteController>(controller));
 }
 
+void AutocompleteProviderTest::ResetControllerWithHangingProvider() {
+  providers_.clear();
+
+  TestProvider* test_provider = new TestProvider(kResultsPerProvider,
+                                                 ASCIIToUTF16("http://a"));
+  test_provider->AddRef();
+  providers_.push_back(test_provider);
+
+  HangingProvider* hanging_provider = new HangingProvider;
+  hanging_provider->AddRef();
+  providers_.push_back(hanging_provider);
+
+  AutocompleteController* controller =
+      new AutocompleteController(providers_, &profile_);
+  controller_.reset(controller);
+  test_provider->set_listener(controller);
+}
+
 void AutocompleteProviderTest::
     ResetControllerWithTestProvidersWithKeywordAndSearchProviders() {
   profile_.CreateTemplateURLService();
@@ -349,6 +386,58 @@ TEST_F(AutocompleteProviderTest, RemoveDuplicates) {
     EXPECT_EQ(providers_[1], i->provider);
 }
 
+// Tests that an update from a provider that is not the last to finish is
+// merged once the batching timer fires.
+TEST_F(AutocompleteProviderTest, BatchedUpdate) {
+  ResetControllerWithHangingProvider();
+  controller_->Start(ASCIIToUTF16("a"), string16(), true, false, true,
+                     AutocompleteInput::ALL_MATCHES);
+  EXPECT_EQ(1U, controller_->result().size());
+
+  // The TestProvider reports the rest of its matches, which wait for the
+  // timer.
+  MessageLoop::current()->RunAllPending();
+  EXPECT_FALSE(controller_->done());
+  EXPECT_EQ(1U, controller_->result().size());
+
+  MessageLoop::current()->PostDelayedTask(
+      FROM_HERE, MessageLoop::QuitClosure(),
+      base::TimeDelta::FromMilliseconds(100));
+  MessageLoop::current()->Run();
+  EXPECT_FALSE(controller_->done());
+  EXPECT_EQ(kResultsPerProvider, controller_->result().size());
+}
+
+// Tests that Stop(false) merges an update that is waiting for the batching
+// timer, and that Stop(true) drops it along with the rest of the result.
+TEST_F(AutocompleteProviderTest, StopWithBatchedUpdate) {
+  ResetControllerWithHangingProvider();
+  controller_->Start(ASCIIToUTF16("a"), string16(), true, false, true,
+                     AutocompleteInput::ALL_MATCHES);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(1U, controller_->result().size());
+
+  controller_->Stop(false);
+  EXPECT_TRUE(controller_->done());
+  EXPECT_EQ(kResultsPerProvider, controller_->result().size());
+
+  controller_->Start(ASCIIToUTF16("ab"), string16(), true, false, true,
+                     AutocompleteInput::ALL_MATCHES);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_FALSE(controller_->done());
+
+  controller_->Stop(true);
+  EXPECT_TRUE(controller_->done());
+  EXPECT_TRUE(controller_->result().empty());
+
+  // Nothing is merged after the stop.
+  MessageLoop::current()->PostDelayedTask(
+      FROM_HERE, MessageLoop::QuitClosure(),
+      base::TimeDelta::FromMilliseconds(100));
+  MessageLoop::current()->Run();
+  EXPECT_TRUE(controller_->result().empty());
+}
+
 TEST_F(AutocompleteProviderTest, AllowExactKeywordMatch) {
   ResetControllerWithTestProvidersWithKeywordAndSearchProviders();
   RunExactKeymatchTest(true);
@@ -6,8 +6,10 @@
 
 #include <vector>
 
+#include "base/i18n/case_conversion.h"
 #include "base/string16.h"
 #include "base/string_number_conversions.h"
+#include "base/string_util.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/browser/autofill/autofill_external_delegate.h"
 #include "chrome/browser/autofill/credit_card.h"
@@ -112,6 +114,7 @@ AutocompleteHistoryManager::AutocompleteHistoryManager(
     : content::WebContentsObserver(web_contents),
       pending_query_handle_(0),
       query_id_(0),
+      has_cached_values_(false),
       external_delegate_(NULL) {
   profile_ = Profile::FromBrowserContext(web_contents->GetBrowserContext());
   // May be NULL in unit tests.
@@ -158,6 +161,15 @@ void AutocompleteHistoryManager::OnWebDataServiceRequestDone(
   const WDResult<std::vector<string16> >* autofill_result =
       static_cast<const WDResult<std::vector<string16> >*>(result);
   std::vector<string16> suggestions = autofill_result->GetValue();
+
+  // A full page of results may leave out values matching a longer prefix.
+  has_cached_values_ =
+      suggestions.size() < static_cast<size_t>(kMaxAutocompleteMenuItems);
+  if (has_cached_values_) {
+    cached_name_ = pending_name_;
+    cached_prefix_ = pending_prefix_;
+    cached_values_ = suggestions;
+  }
   SendSuggestions(&suggestions);
 }
 
@@ -181,7 +193,15 @@ void AutocompleteHistoryManager::OnGetAutocompleteSuggestions(
     return;
   }
 
+  std::vector<string16> suggestions;
+  if (GetCachedSuggestions(name, prefix, &suggestions)) {
+    SendSuggestions(&suggestions);
+    return;
+  }
+
   if (web_data_service_.get()) {
+    pending_name_ = name;
+    pending_prefix_ = prefix;
     pending_query_handle_ = web_data_service_->GetFormValuesForElementName(
         name, prefix, kMaxAutocompleteMenuItems, this);
   }
@@ -217,12 +237,15 @@ void AutocompleteHistoryManager::OnFormSubmitted(const FormData& form) {
     }
   }
 
-  if (!values.empty() && web_data_service_.get())
+  if (!values.empty() && web_data_service_.get()) {
+    ClearCachedSuggestions();
     web_data_service_->AddFormFields(values);
+  }
 }
 
 void AutocompleteHistoryManager::OnRemoveAutocompleteEntry(
     const string16& name, const string16& value) {
+  ClearCachedSuggestions();
   if (web_data_service_.get())
     web_data_service_->RemoveFormValueForElementName(name, value);
 }
@@ -241,6 +264,7 @@ AutocompleteHistoryManager::AutocompleteHistoryManager(
       web_data_service_(wds),
       pending_query_handle_(0),
       query_id_(0),
+      has_cached_values_(false),
       external_delegate_(NULL) {
   autofill_enabled_.Init(
       prefs::kAutofillEnabled, profile_->GetPrefs(), NULL);
@@ -255,6 +279,38 @@ void AutocompleteHistoryManager::CancelPendingQuery() {
   }
 }
 
+bool AutocompleteHistoryManager::GetCachedSuggestions(
+    const string16& name,
+    const string16& prefix,
+    std::vector<string16>* suggestions) const {
+  if (!has_cached_values_ || name != cached_name_)
+    return false;
+
+  // Only a prefix that extends the cached one, as when typing, is answered
+  // here. Any other query goes to the database, which refreshes the cache
+  // with entries added since, e.g. by other tabs. Matches the database, which
+  // compares the lower case value and prefix.
+  string16 prefix_lower = base::i18n::ToLower(prefix);
+  string16 cached_prefix_lower = base::i18n::ToLower(cached_prefix_);
+  if (prefix_lower.size() <= cached_prefix_lower.size() ||
+      !StartsWith(prefix_lower, cached_prefix_lower, true)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < cached_values_.size(); ++i) {
+    if (StartsWith(base::i18n::ToLower(cached_values_[i]), prefix_lower, true))
+      suggestions->push_back(cached_values_[i]);
+  }
+  return true;
+}
+
+void AutocompleteHistoryManager::ClearCachedSuggestions() {
+  has_cached_values_ = false;
+  cached_name_.clear();
+  cached_prefix_.clear();
+  cached_values_.clear();
+}
+
 void AutocompleteHistoryManager::SendSuggestions(
     const std::vector<string16>* suggestions) {
   if (suggestions) {
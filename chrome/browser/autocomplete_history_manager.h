@@ -71,6 +71,14 @@ class AutocompleteHistoryManager : public content::WebContentsObserver,
   void SendSuggestions(const std::vector<string16>* suggestions);
   void CancelPendingQuery();
 
+  // If the last query for |name| returned all the values matching a prefix of
+  // |prefix|, puts the ones matching |prefix| in |suggestions| and returns
+  // true, so the database need not be queried again.
+  bool GetCachedSuggestions(const string16& name,
+                            const string16& prefix,
+                            std::vector<string16>* suggestions) const;
+  void ClearCachedSuggestions();
+
   // Exposed for testing.
   AutofillExternalDelegate* external_delegate() {
     return external_delegate_;
@@ -92,6 +100,18 @@ class AutocompleteHistoryManager : public content::WebContentsObserver,
   std::vector<string16> autofill_icons_;
   std::vector<int> autofill_unique_ids_;
 
+  // The field name and prefix of the pending query.
+  string16 pending_name_;
+  string16 pending_prefix_;
+
+  // The values returned for the last completed query, when they are all the
+  // values matching |cached_prefix_| for |cached_name_|. Typing into a field
+  // then only extends the prefix, and is answered from these values.
+  bool has_cached_values_;
+  string16 cached_name_;
+  string16 cached_prefix_;
+  std::vector<string16> cached_values_;
+
   // Delegate to perform external processing (display, selection) on
   // our behalf.  Weak.
   AutofillExternalDelegate* external_delegate_;
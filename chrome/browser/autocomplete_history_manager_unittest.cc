@@ -23,12 +23,20 @@
 using content::BrowserThread;
 using content::WebContents;
 using testing::_;
+using testing::Return;
 using webkit::forms::FormData;
 
 class MockWebDataService : public WebDataService {
  public:
   MOCK_METHOD1(AddFormFields,
                void(const std::vector<webkit::forms::FormField>&));  // NOLINT
+  MOCK_METHOD4(GetFormValuesForElementName,
+               Handle(const string16& name,
+                      const string16& prefix,
+                      int limit,
+                      WebDataServiceConsumer* consumer));
+  MOCK_METHOD2(RemoveFormValueForElementName,
+               void(const string16& name, const string16& value));
 
  protected:
   virtual ~MockWebDataService() {}
@@ -47,6 +55,21 @@ class AutocompleteHistoryManagerTest : public ChromeRenderViewHostTestHarness {
         contents(), &profile_, web_data_service_));
   }
 
+  // Asks for the suggestions for |prefix| in the field |name|, as
+  // AutofillManager does on each keystroke.
+  void GetSuggestions(const string16& name, const string16& prefix) {
+    autocomplete_manager_->OnGetAutocompleteSuggestions(
+        1, name, prefix, std::vector<string16>(), std::vector<string16>(),
+        std::vector<string16>(), std::vector<int>());
+  }
+
+  // Completes the query |handle| with |values| from the database.
+  void QueryDone(WebDataService::Handle handle,
+                 const std::vector<string16>& values) {
+    WDResult<std::vector<string16> > result(AUTOFILL_VALUE_RESULT, values);
+    autocomplete_manager_->OnWebDataServiceRequestDone(handle, &result);
+  }
+
   content::TestBrowserThread ui_thread_;
 
   TestingProfile profile_;
@@ -192,3 +215,163 @@ TEST_F(AutocompleteHistoryManagerTest, ExternalDelegate) {
   // Should trigger a call to OnSuggestionsReturned, verified by the mock.
   autocomplete_history_manager.SendSuggestions(NULL);
 }
+
+namespace {
+
+std::vector<string16> MakeValues(const char* value1,
+                                 const char* value2,
+                                 const char* value3) {
+  std::vector<string16> values;
+  values.push_back(ASCIIToUTF16(value1));
+  if (value2)
+    values.push_back(ASCIIToUTF16(value2));
+  if (value3)
+    values.push_back(ASCIIToUTF16(value3));
+  return values;
+}
+
+}  // namespace
+
+// Typing a longer prefix into a field is answered from the values the
+// database returned for the shorter one.
+TEST_F(AutocompleteHistoryManagerTest, CachedSuggestions) {
+  MockAutofillExternalDelegate external_delegate(
+      TabContentsWrapper::GetCurrentWrapperForContents(contents()));
+  autocomplete_manager_->SetExternalDelegate(&external_delegate);
+  const string16 kCity = ASCIIToUTF16("city");
+  std::vector<string16> values = MakeValues("Paris", "Palo Alto", "Pasadena");
+
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("p"), _, _))
+      .WillOnce(Return(1));
+  EXPECT_CALL(external_delegate, OnSuggestionsReturned(_, values, _, _, _));
+  GetSuggestions(kCity, ASCIIToUTF16("p"));
+  QueryDone(1, values);
+
+  // Matched without regard to case, like the database does.
+  EXPECT_CALL(*web_data_service_, GetFormValuesForElementName(_, _, _, _))
+      .Times(0);
+  EXPECT_CALL(external_delegate,
+              OnSuggestionsReturned(_, MakeValues("Paris", "Pasadena", NULL),
+                                    _, _, _));
+  GetSuggestions(kCity, ASCIIToUTF16("Pa"));
+  EXPECT_CALL(external_delegate,
+              OnSuggestionsReturned(_, MakeValues("Pasadena", NULL, NULL),
+                                    _, _, _));
+  GetSuggestions(kCity, ASCIIToUTF16("PAS"));
+  EXPECT_CALL(external_delegate,
+              OnSuggestionsReturned(_, std::vector<string16>(), _, _, _));
+  GetSuggestions(kCity, ASCIIToUTF16("pz"));
+}
+
+// Queries that don't extend the cached prefix of the same field go to the
+// database.
+TEST_F(AutocompleteHistoryManagerTest, CachedSuggestionsOtherQueries) {
+  MockAutofillExternalDelegate external_delegate(
+      TabContentsWrapper::GetCurrentWrapperForContents(contents()));
+  autocomplete_manager_->SetExternalDelegate(&external_delegate);
+  EXPECT_CALL(external_delegate, OnSuggestionsReturned(_, _, _, _, _))
+      .Times(4);
+  const string16 kCity = ASCIIToUTF16("city");
+  std::vector<string16> values = MakeValues("Paris", "Palo Alto", "Pasadena");
+
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("pa"), _, _))
+      .WillOnce(Return(1));
+  GetSuggestions(kCity, ASCIIToUTF16("pa"));
+  QueryDone(1, values);
+
+  // The same prefix, or a shorter one.
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("pa"), _, _))
+      .WillOnce(Return(2));
+  GetSuggestions(kCity, ASCIIToUTF16("pa"));
+  QueryDone(2, values);
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("p"), _, _))
+      .WillOnce(Return(3));
+  GetSuggestions(kCity, ASCIIToUTF16("p"));
+  QueryDone(3, values);
+
+  // Another field.
+  const string16 kStreet = ASCIIToUTF16("street");
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kStreet, ASCIIToUTF16("par"), _, _))
+      .WillOnce(Return(4));
+  GetSuggestions(kStreet, ASCIIToUTF16("par"));
+  QueryDone(4, std::vector<string16>());
+}
+
+// A full menu of values may leave out some matching a longer prefix, so it is
+// not cached.
+TEST_F(AutocompleteHistoryManagerTest, FullMenuIsNotCached) {
+  MockAutofillExternalDelegate external_delegate(
+      TabContentsWrapper::GetCurrentWrapperForContents(contents()));
+  autocomplete_manager_->SetExternalDelegate(&external_delegate);
+  EXPECT_CALL(external_delegate, OnSuggestionsReturned(_, _, _, _, _))
+      .Times(2);
+  const string16 kCity = ASCIIToUTF16("city");
+  std::vector<string16> values = MakeValues("a1", "a2", "a3");
+  std::vector<string16> more_values = MakeValues("a4", "a5", "a6");
+  values.insert(values.end(), more_values.begin(), more_values.end());
+
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("a"), _, _))
+      .WillOnce(Return(1));
+  GetSuggestions(kCity, ASCIIToUTF16("a"));
+  QueryDone(1, values);
+
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("a1"), _, _))
+      .WillOnce(Return(2));
+  GetSuggestions(kCity, ASCIIToUTF16("a1"));
+  QueryDone(2, MakeValues("a1", NULL, NULL));
+}
+
+// Removing an entry or submitting a form drops the cached values.
+TEST_F(AutocompleteHistoryManagerTest, CachedSuggestionsCleared) {
+  MockAutofillExternalDelegate external_delegate(
+      TabContentsWrapper::GetCurrentWrapperForContents(contents()));
+  autocomplete_manager_->SetExternalDelegate(&external_delegate);
+  EXPECT_CALL(external_delegate, OnSuggestionsReturned(_, _, _, _, _))
+      .Times(3);
+  const string16 kCity = ASCIIToUTF16("city");
+  std::vector<string16> values = MakeValues("Paris", "Palo Alto", "Pasadena");
+
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("p"), _, _))
+      .WillOnce(Return(1));
+  GetSuggestions(kCity, ASCIIToUTF16("p"));
+  QueryDone(1, values);
+
+  EXPECT_CALL(*web_data_service_,
+              RemoveFormValueForElementName(kCity, ASCIIToUTF16("Paris")));
+  autocomplete_manager_->OnRemoveAutocompleteEntry(kCity,
+                                                   ASCIIToUTF16("Paris"));
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("pa"), _, _))
+      .WillOnce(Return(2));
+  GetSuggestions(kCity, ASCIIToUTF16("pa"));
+  QueryDone(2, MakeValues("Palo Alto", "Pasadena", NULL));
+
+  FormData form;
+  form.name = ASCIIToUTF16("MyForm");
+  form.method = ASCIIToUTF16("POST");
+  form.origin = GURL("http://myform.com/form.html");
+  form.action = GURL("http://myform.com/submit.html");
+  form.user_submitted = true;
+  webkit::forms::FormField city;
+  city.label = ASCIIToUTF16("City");
+  city.name = kCity;
+  city.value = ASCIIToUTF16("Paris");
+  city.form_control_type = ASCIIToUTF16("text");
+  form.fields.push_back(city);
+
+  EXPECT_CALL(*web_data_service_, AddFormFields(_));
+  autocomplete_manager_->OnFormSubmitted(form);
+  EXPECT_CALL(*web_data_service_,
+              GetFormValuesForElementName(kCity, ASCIIToUTF16("par"), _, _))
+      .WillOnce(Return(3));
+  GetSuggestions(kCity, ASCIIToUTF16("par"));
+  QueryDone(3, MakeValues("Paris", NULL, NULL));
+}
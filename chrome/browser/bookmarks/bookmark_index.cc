@@ -116,8 +116,13 @@ void BookmarkIndex::SortMatches(const Matches& matches,
   history::URLDatabase* url_db = history_service ?
       history_service->InMemoryDatabase() : NULL;
 
+  // A node matches once for each combination of index terms its title has
+  // for the query, e.g. "abcd abce" matches "abc" twice. Collect each node
+  // once, so that it is looked up and returned only once.
+  NodeSet nodes;
   for (Matches::const_iterator i = matches.begin(); i != matches.end(); ++i)
-    ExtractBookmarkNodePairs(url_db, *i, node_typed_counts);
+    nodes.insert(i->nodes_begin(), i->nodes_end());
+  ExtractBookmarkNodePairs(url_db, nodes, node_typed_counts);
 
   std::sort(node_typed_counts->begin(), node_typed_counts->end(),
             &NodeTypedCountPairSortFunc);
@@ -125,11 +130,10 @@ void BookmarkIndex::SortMatches(const Matches& matches,
 
 void BookmarkIndex::ExtractBookmarkNodePairs(
     history::URLDatabase* url_db,
-    const Match& match,
+    const NodeSet& nodes,
     NodeTypedCountPairs* node_typed_counts) const {
-
-  for (NodeSet::const_iterator i = match.nodes_begin();
-       i != match.nodes_end(); ++i) {
+  node_typed_counts->reserve(node_typed_counts->size() + nodes.size());
+  for (NodeSet::const_iterator i = nodes.begin(); i != nodes.end(); ++i) {
     history::URLRow url;
     if (url_db)
       url_db->GetRowForURL((*i)->url(), &url);
@@ -251,11 +255,8 @@ std::vector<string16> BookmarkIndex::ExtractQueryWords(const string16& query) {
 
 void BookmarkIndex::RegisterNode(const string16& term,
                                  const BookmarkNode* node) {
-  if (std::find(index_[term].begin(), index_[term].end(), node) !=
-      index_[term].end()) {
-    // We've already added node for term.
-    return;
-  }
+  // A node whose title has |term| more than once is only added once, since
+  // NodeSet is a set.
   index_[term].insert(node);
 }
 
@@ -68,12 +68,11 @@ class BookmarkIndex {
   void SortMatches(const Matches& matches,
                    NodeTypedCountPairs* node_typed_counts) const;
 
-  // Extracts BookmarkNodes from |match| and retrieves typed counts for each
-  // node from the in-memory database. Inserts pairs containing the node and
-  // typed count into the vector |node_typed_counts|. |node_typed_counts| is
-  // sorted in decreasing order of typed count.
+  // Retrieves typed counts for each of |nodes| from the in-memory database.
+  // Inserts pairs containing the node and typed count into the vector
+  // |node_typed_counts|.
   void ExtractBookmarkNodePairs(history::URLDatabase* url_db,
-                                const Match& match,
+                                const NodeSet& nodes,
                                 NodeTypedCountPairs* node_typed_counts) const;
 
   // Sort function for NodeTypedCountPairs. We sort in decreasing order of typed
@@ -149,6 +149,15 @@ TEST_F(BookmarkIndexTest, Tests) {
   }
 }
 
+// A bookmark with several words matching a prefix is only returned once.
+TEST_F(BookmarkIndexTest, PrefixMatchesNodeOnce) {
+  const char* input[] = { "abcd abce" };
+  AddBookmarksWithTitles(input, ARRAYSIZE_UNSAFE(input));
+
+  const char* expected[] = { "abcd abce" };
+  ExpectMatches("abc", expected, ARRAYSIZE_UNSAFE(expected));
+}
+
 // Makes sure match positions are updated appropriately.
 TEST_F(BookmarkIndexTest, MatchPositions) {
   struct TestData {
@@ -798,6 +798,20 @@ void BookmarkModel::LoadFavicon(BookmarkNode* node) {
     return;
 
   DCHECK(node->url().is_valid());
+
+  // Bookmarks with the same URL have the same favicon, so reuse one that has
+  // already been loaded instead of querying and decoding it again.
+  std::vector<const BookmarkNode*> same_url_nodes;
+  GetNodesByURL(node->url(), &same_url_nodes);
+  for (size_t i = 0; i < same_url_nodes.size(); ++i) {
+    const BookmarkNode* other = same_url_nodes[i];
+    if (other != node && other->is_favicon_loaded() &&
+        !other->favicon_load_handle() && !other->favicon().isNull()) {
+      node->set_favicon(other->favicon());
+      return;
+    }
+  }
+
   FaviconService* favicon_service =
       profile_->GetFaviconService(Profile::EXPLICIT_ACCESS);
   if (!favicon_service)
@@ -836,13 +850,17 @@ void BookmarkModel::Observe(int type,
            i != favicon_details->urls.end(); ++i) {
         std::vector<const BookmarkNode*> nodes;
         GetNodesByURL(*i, &nodes);
+        // Got an updated favicon, for a URL, do a new request. All the nodes
+        // are invalidated before notifying, so that LoadFavicon() does not
+        // reuse the old favicon of a node not yet invalidated.
         for (size_t i = 0; i < nodes.size(); ++i) {
-          // Got an updated favicon, for a URL, do a new request.
           BookmarkNode* node = AsMutable(nodes[i]);
           node->InvalidateFavicon();
           CancelPendingFaviconLoadRequests(node);
+        }
+        for (size_t i = 0; i < nodes.size(); ++i) {
           FOR_EACH_OBSERVER(BookmarkModelObserver, observers_,
-                            BookmarkNodeFaviconChanged(this, node));
+                            BookmarkNodeFaviconChanged(this, nodes[i]));
         }
       }
       break;
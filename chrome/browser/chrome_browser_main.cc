@@ -509,6 +509,22 @@ bool HasImportSwitch(const CommandLine& command_line) {
           command_line.HasSwitch(switches::kImportFromFile));
 }
 
+// Records the startup metrics that are not needed to show the first browser
+// window. This runs as a task on the UI thread once the main message loop is
+// running, so it stays off the startup critical path.
+void RecordDeferredStartupMetrics(MetricsService* metrics_service,
+                                  const PrefService* local_state,
+                                  const std::string& accept_languages,
+                                  const std::string& application_locale) {
+  TRACE_EVENT0("startup", "RecordDeferredStartupMetrics");
+  RecordBreakpadStatusUMA(metrics_service);
+#if !defined(OS_ANDROID)
+  about_flags::RecordUMAStatistics(local_state);
+#endif
+  LanguageUsageMetrics::RecordAcceptLanguages(accept_languages);
+  LanguageUsageMetrics::RecordApplicationLanguage(application_locale);
+}
+
 }  // namespace
 
 namespace chrome_browser {
@@ -1437,6 +1453,7 @@ void ChromeBrowserMainParts::PostBrowserStart() {
 }
 
 int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
+  TRACE_EVENT0("startup", "ChromeBrowserMainParts::PreMainMessageLoopRunImpl");
   // Now that the file thread has been started, start recording.
   StartMetricsRecording();
 
@@ -1731,14 +1748,13 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
 #endif
 
   HandleTestParameters(parsed_command_line());
-  RecordBreakpadStatusUMA(browser_process_->metrics_service());
-#if !defined(OS_ANDROID)
-  about_flags::RecordUMAStatistics(local_state_);
-#endif
-  LanguageUsageMetrics::RecordAcceptLanguages(
-      profile_->GetPrefs()->GetString(prefs::kAcceptLanguages));
-  LanguageUsageMetrics::RecordApplicationLanguage(
-      browser_process_->GetApplicationLocale());
+  content::BrowserThread::PostTask(
+      content::BrowserThread::UI, FROM_HERE,
+      base::Bind(&RecordDeferredStartupMetrics,
+                 browser_process_->metrics_service(),
+                 local_state_,
+                 profile_->GetPrefs()->GetString(prefs::kAcceptLanguages),
+                 browser_process_->GetApplicationLocale()));
 
   // The extension service may be available at this point. If the command line
   // specifies --uninstall-extension, attempt the uninstall extension startup
@@ -1807,8 +1823,12 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
     std::vector<Profile*> last_opened_profiles =
         g_browser_process->profile_manager()->GetLastOpenedProfiles();
 #endif
-    if (browser_init_->Start(parsed_command_line(), FilePath(),
-                             profile_, last_opened_profiles, &result_code)) {
+    TRACE_EVENT_BEGIN0("startup", "BrowserInit::Start");
+    bool started = browser_init_->Start(parsed_command_line(), FilePath(),
+                                        profile_, last_opened_profiles,
+                                        &result_code);
+    TRACE_EVENT_END0("startup", "BrowserInit::Start");
+    if (started) {
 #if defined(OS_WIN) || (defined(OS_LINUX) && !defined(OS_CHROMEOS))
       // Initialize autoupdate timer. Timer callback costs basically nothing
       // when browser is not in persistent mode, so it's OK to let it ride on
@@ -192,6 +192,9 @@ struct CrxUpdateItem {
   base::Time last_check;
   CrxComponent component;
   Version next_version;
+  // The last version whose package was downloaded but could not be
+  // installed. It is not downloaded again, since it would fail the same way.
+  Version failed_version;
 
   CrxUpdateItem() : status(kNew) {}
 
@@ -645,6 +648,12 @@ void CrxUpdateService::OnParseUpdateManifestSucceeded(
         continue;
       }
     }
+    if (crx->failed_version.IsValid() &&
+        crx->failed_version.Equals(Version(it->version))) {
+      // This package already failed to install, don't download it again.
+      crx->status = CrxUpdateItem::kNoUpdate;
+      continue;
+    }
     // All test passed. Queue an upgrade for this component and fire the
     // notifications.
     crx->crx_url = it->crx_url;
@@ -764,6 +773,20 @@ void CrxUpdateService::DoneInstalling(const std::string& component_id,
       break;
   }
 
+  // A package that is well formed but rejected would be rejected again. A
+  // truncated or unreadable download is worth fetching again.
+  switch (error) {
+    case ComponentUnpacker::kNoManifest:
+    case ComponentUnpacker::kBadManifest:
+    case ComponentUnpacker::kBadExtension:
+    case ComponentUnpacker::kInvalidId:
+    case ComponentUnpacker::kInstallerError:
+      item->failed_version = item->next_version;
+      break;
+    default:
+      break;
+  }
+
   config_->OnEvent(event, CrxIdtoUMAId(component_id));
   ScheduleNextRun(false);
 }
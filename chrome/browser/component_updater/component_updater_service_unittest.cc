@@ -82,7 +82,7 @@ class TestConfigurator : public ComponentUpdateService::Configurator {
 class TestInstaller : public ComponentInstaller {
  public :
   explicit TestInstaller()
-      : error_(0), install_count_(0) {
+      : error_(0), install_count_(0), fail_install_(false) {
   }
 
   virtual void OnUpdateError(int error) OVERRIDE {
@@ -94,6 +94,8 @@ class TestInstaller : public ComponentInstaller {
                        const FilePath& unpack_path) OVERRIDE {
     ++install_count_;
     delete manifest;
+    if (fail_install_)
+      return false;
     return file_util::Delete(unpack_path, true);
   }
 
@@ -101,9 +103,12 @@ class TestInstaller : public ComponentInstaller {
 
   int install_count() const { return install_count_; }
 
+  void set_fail_install(bool fail_install) { fail_install_ = fail_install; }
+
  private:
   int error_;
   int install_count_;
+  bool fail_install_;
 };
 
 // component 1 has extension id "jebgalgnebhfojomionfpkfelancnnkf", and
@@ -413,3 +418,42 @@ TEST_F(ComponentUpdaterTest, ProdVersionCheck) {
 
   component_updater()->Stop();
 }
+
+// Checks that a package the installer rejected is not downloaded again when
+// the next update check offers the same version.
+TEST_F(ComponentUpdaterTest, FailedInstallNotDownloadedAgain) {
+  MessageLoop message_loop;
+  content::TestBrowserThread ui_thread(BrowserThread::UI, &message_loop);
+  content::TestBrowserThread file_thread(BrowserThread::FILE);
+  content::TestBrowserThread io_thread(BrowserThread::IO);
+
+  io_thread.StartIOThread();
+  file_thread.Start();
+
+  scoped_refptr<ComponentUpdateInterceptor>
+      interceptor(new ComponentUpdateInterceptor());
+
+  CrxComponent com;
+  RegisterComponent(&com, kTestComponent_jebg, Version("0.9"));
+  static_cast<TestInstaller*>(com.installer)->set_fail_install(true);
+
+  const char expected_update_url[] =
+      "http://localhost/upd?extra=foo&x=id%3D"
+      "jebgalgnebhfojomionfpkfelancnnkf%26v%3D0.9%26uc";
+
+  interceptor->SetResponse(expected_update_url,
+                           header_ok_reply,
+                           test_file("updatecheck_reply_1.xml"));
+  interceptor->SetResponse(expected_crx_url, header_ok_reply,
+                           test_file("jebgalgnebhfojomionfpkfelancnnkf.crx"));
+
+  test_configurator()->SetLoopCount(2);
+  component_updater()->Start();
+  message_loop.Run();
+
+  // Two update checks, and a single download.
+  EXPECT_EQ(3, interceptor->hit_count());
+  EXPECT_EQ(1, static_cast<TestInstaller*>(com.installer)->install_count());
+
+  component_updater()->Stop();
+}
@@ -112,6 +112,7 @@ void CrashHandlerHostLinux::InitCrashUploaderThread() {
   uploader_thread_.reset(
       new base::Thread(std::string(process_type_ + "_crash_uploader").c_str()));
   uploader_thread_->Start();
+  dump_writer_token_ = BrowserThread::GetBlockingPool()->GetSequenceToken();
 }
 
 void CrashHandlerHostLinux::OnFileCanWriteWithoutBlocking(int fd) {
@@ -333,21 +334,30 @@ void CrashHandlerHostLinux::OnFileCanReadWithoutBlocking(int fd) {
   info->process_start_time = uptime;
   info->oom_size = oom_size;
 
-  BrowserThread::PostTask(
-      BrowserThread::FILE, FROM_HERE,
+  // Write the minidump in the blocking pool rather than on the FILE thread, so
+  // that a burst of crashes does not stall everything else that does file
+  // I/O in the browser. It is not written on the uploader thread either: the
+  // crashed process waits for its dump to be written, and uploads can keep
+  // that thread busy for several seconds each.
+  base::SequencedWorkerPool* pool = BrowserThread::GetBlockingPool();
+  pool->PostSequencedWorkerTaskWithShutdownBehavior(
+      dump_writer_token_,
+      FROM_HERE,
       base::Bind(&CrashHandlerHostLinux::WriteDumpFile,
                  base::Unretained(this),
                  info,
                  crashing_pid,
                  crash_context,
-                 signal_fd));
+                 signal_fd),
+      base::SequencedWorkerPool::SKIP_ON_SHUTDOWN);
 }
 
 void CrashHandlerHostLinux::WriteDumpFile(BreakpadInfo* info,
                                           pid_t crashing_pid,
                                           char* crash_context,
                                           int signal_fd) {
-  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  DCHECK(BrowserThread::GetBlockingPool()->IsRunningSequenceOnCurrentThread(
+      dump_writer_token_));
 
   FilePath dumps_path("/tmp");
   PathService::Get(base::DIR_TEMP, &dumps_path);
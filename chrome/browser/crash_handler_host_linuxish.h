@@ -15,6 +15,7 @@
 #include <string>
 
 #include "base/memory/scoped_ptr.h"
+#include "base/threading/sequenced_worker_pool.h"
 
 class BreakpadInfo;
 
@@ -74,7 +75,7 @@ class CrashHandlerHostLinux : public MessageLoopForIO::Watcher,
   // This is here on purpose to make CrashHandlerHostLinux abstract.
   virtual void SetProcessType() = 0;
 
-  // Do work on the FILE thread for OnFileCanReadWithoutBlocking().
+  // Do work in the blocking pool for OnFileCanReadWithoutBlocking().
   void WriteDumpFile(BreakpadInfo* info,
                      pid_t crashing_pid,
                      char* crash_context,
@@ -90,6 +91,9 @@ class CrashHandlerHostLinux : public MessageLoopForIO::Watcher,
 #if defined(USE_LINUX_BREAKPAD)
   MessageLoopForIO::FileDescriptorWatcher file_descriptor_watcher_;
   scoped_ptr<base::Thread> uploader_thread_;
+  // Minidumps are written in this sequence of the blocking pool, apart from
+  // the uploads, which can block the uploader thread for several seconds.
+  base::SequencedWorkerPool::SequenceToken dump_writer_token_;
   bool shutting_down_;
 #endif
 
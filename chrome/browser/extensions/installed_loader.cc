@@ -64,6 +64,12 @@ InstalledLoader::~InstalledLoader() {
 }
 
 void InstalledLoader::Load(const ExtensionInfo& info, bool write_to_prefs) {
+  LoadWithExtension(info, NULL, write_to_prefs);
+}
+
+void InstalledLoader::LoadWithExtension(const ExtensionInfo& info,
+                                        const Extension* loaded_extension,
+                                        bool write_to_prefs) {
   std::string error;
   scoped_refptr<const Extension> extension(NULL);
   // An explicit check against policy is required to behave correctly during
@@ -72,6 +78,8 @@ void InstalledLoader::Load(const ExtensionInfo& info, bool write_to_prefs) {
   if (!extension_prefs_->IsExtensionAllowedByPolicy(info.extension_id,
                                                     info.extension_location)) {
     error = errors::kDisabledByPolicy;
+  } else if (loaded_extension) {
+    extension = loaded_extension;
   } else if (info.extension_manifest.get()) {
     extension = Extension::Create(
         info.extension_path,
@@ -115,7 +123,10 @@ void InstalledLoader::LoadAllExtensions() {
       extension_prefs_->GetInstalledExtensionsInfo());
 
   std::vector<int> reload_reason_counts(NUM_MANIFEST_RELOAD_REASONS, 0);
-  bool should_write_prefs = false;
+  // The extensions that were loaded from disk again, so that they don't have
+  // to be created a second time from their new manifests.
+  std::vector<scoped_refptr<const Extension> > reloaded_extensions(
+      extensions_info->size());
 
   for (size_t i = 0; i < extensions_info->size(); ++i) {
     ExtensionInfo* info = extensions_info->at(i).get();
@@ -148,15 +159,16 @@ void InstalledLoader::LoadAllExtensions() {
         continue;
       }
 
-      extensions_info->at(i)->extension_manifest.reset(
-          static_cast<DictionaryValue*>(
-              extension->manifest()->value()->DeepCopy()));
-      should_write_prefs = true;
+      reloaded_extensions[i] = extension;
     }
   }
 
+  // Only the manifests of the reloaded extensions can differ from the ones in
+  // the prefs.
   for (size_t i = 0; i < extensions_info->size(); ++i) {
-    Load(*extensions_info->at(i), should_write_prefs);
+    const Extension* reloaded_extension = reloaded_extensions[i].get();
+    LoadWithExtension(*extensions_info->at(i), reloaded_extension,
+                      reloaded_extension != NULL);
   }
 
   extension_service_->OnLoadedInstalledExtensions();
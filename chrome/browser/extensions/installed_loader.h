@@ -26,6 +26,13 @@ class InstalledLoader {
   void LoadAllExtensions();
 
  private:
+  // Like Load(), but uses |extension| if it is non-NULL, instead of creating
+  // the extension again from the manifest in |info|. |extension| must have
+  // been loaded from |info|'s path.
+  void LoadWithExtension(const ExtensionInfo& info,
+                         const Extension* extension,
+                         bool write_to_prefs);
+
   // Returns the flags that should be used with Extension::Create() for an
   // extension that is already installed.
   int GetCreationFlags(const ExtensionInfo* info);
@@ -309,6 +309,7 @@ SegmentID HistoryBackend::GetLastSegmentID(VisitID from_visit) {
 
 SegmentID HistoryBackend::UpdateSegments(
     const GURL& url,
+    URLID url_id,
     VisitID from_visit,
     VisitID visit_id,
     content::PageTransition transition_type,
@@ -329,7 +330,6 @@ SegmentID HistoryBackend::UpdateSegments(
       t == content::PAGE_TRANSITION_AUTO_BOOKMARK) {
     // If so, create or get the segment.
     std::string segment_name = db_->ComputeSegmentName(url);
-    URLID url_id = db_->GetRowForURL(url, NULL);
     if (!url_id)
       return 0;
 
@@ -462,8 +462,8 @@ void HistoryBackend::AddPage(scoped_refptr<HistoryAddPageArgs> request) {
     // result in changing most visited, so we don't update segments (most
     // visited db).
     if (!is_keyword_generated) {
-      UpdateSegments(request->url, from_visit_id, last_ids.second, t,
-                     last_recorded_time_);
+      UpdateSegments(request->url, last_ids.first, from_visit_id,
+                     last_ids.second, t, last_recorded_time_);
 
       // Update the referrer's duration.
       UpdateVisitDuration(from_visit_id, last_recorded_time_);
@@ -534,7 +534,7 @@ void HistoryBackend::AddPage(scoped_refptr<HistoryAddPageArgs> request) {
                               t, request->visit_source);
       if (t & content::PAGE_TRANSITION_CHAIN_START) {
         // Update the segment for this visit.
-        UpdateSegments(request->redirects[redirect_index],
+        UpdateSegments(request->redirects[redirect_index], last_ids.first,
                        from_visit_id, last_ids.second, t, last_recorded_time_);
 
         // Update the visit_details for this visit.
@@ -84,6 +84,7 @@ sql::InitStatus HistoryDatabase::Init(const FilePath& history_name,
   // 6000 * 4MB = 24MB
   // TODO(brettw) scale this value to the amount of available memory.
   db_.set_cache_size(6000);
+  db_.set_histogram_tag("History");
 
   // Note that we don't set exclusive locking here. That's done by
   // BeginExclusiveMode below which is called later (we have to be in shared
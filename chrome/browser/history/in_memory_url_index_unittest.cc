@@ -811,6 +811,26 @@ TEST_F(InMemoryURLIndexTest, Scoring) {
   EXPECT_LT(scored_i.raw_score, 1400);
 }
 
+TEST_F(InMemoryURLIndexTest, MaxRawScoreForRow) {
+  RowWordStarts word_starts;
+  // The bound holds for the best possible match, a single term matching the
+  // whole URL.
+  URLRow row_a(MakeURLRow("http://abcdef", "fedcba", 3, 30, 1));
+  ScoredHistoryMatch scored_a(URLIndexPrivateData::ScoredMatchForURL(
+      row_a, ASCIIToUTF16("http://abcdef"), Make1Term("http://abcdef"),
+      word_starts));
+  EXPECT_GT(scored_a.raw_score, 0);
+  EXPECT_LE(scored_a.raw_score, URLIndexPrivateData::MaxRawScoreForRow(row_a));
+
+  // Rows with more history have higher bounds.
+  URLRow row_b(MakeURLRow("http://abcdef", "fedcba", 10, 1, 10));
+  ScoredHistoryMatch scored_b(URLIndexPrivateData::ScoredMatchForURL(
+      row_b, ASCIIToUTF16("abc"), Make1Term("abc"), word_starts));
+  EXPECT_LE(scored_b.raw_score, URLIndexPrivateData::MaxRawScoreForRow(row_b));
+  EXPECT_GT(URLIndexPrivateData::MaxRawScoreForRow(row_b),
+            URLIndexPrivateData::MaxRawScoreForRow(row_a));
+}
+
 TEST_F(InMemoryURLIndexTest, AddNewRows) {
   // Verify that the row we're going to add does not already exist.
   URLID new_row_id = 87654321;
@@ -1038,6 +1058,28 @@ TEST_F(InMemoryURLIndexTest, CacheSaveRestore) {
   }
 }
 
+TEST_F(InMemoryURLIndexTest, CacheRestoresFreedWords) {
+  URLIndexPrivateData& private_data(*GetPrivateData());
+
+  // Deleting a URL frees the IDs of the words no other URL uses.
+  ScoredHistoryMatches matches =
+      url_index_->HistoryItemsForTerms(ASCIIToUTF16("DrudgeReport"));
+  ASSERT_EQ(1U, matches.size());
+  EXPECT_TRUE(DeleteURL(matches[0].url_info.url()));
+  EXPECT_FALSE(private_data.available_words_.empty());
+
+  imui::InMemoryURLIndexCacheItem cache;
+  private_data.SavePrivateData(&cache);
+  // The word map is rebuilt from the word list rather than saved.
+  EXPECT_FALSE(cache.has_word_map());
+
+  scoped_refptr<URLIndexPrivateData> restored_data(new URLIndexPrivateData);
+  ASSERT_TRUE(restored_data->RestorePrivateData(cache, "en,ja,hi,zh"));
+  ExpectPrivateDataEqual(private_data, *restored_data);
+  EXPECT_TRUE(private_data.word_map_ == restored_data->word_map_);
+  EXPECT_TRUE(private_data.available_words_ == restored_data->available_words_);
+}
+
 class InMemoryURLIndexCacheTest : public testing::Test {
  public:
   InMemoryURLIndexCacheTest() {}
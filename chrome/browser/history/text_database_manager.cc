@@ -442,11 +442,14 @@ void TextDatabaseManager::GetTextMatches(
       *present_databases_.rbegin() :
       TimeToID(options.end_time);
 
-  // Iterate over the databases from the most recent backwards.
+  // Iterate over the databases from the most recent backwards. This goes
+  // over a copy of |present_databases_|, since GetDB() drops databases that
+  // turn out to be missing from it.
   bool checked_one = false;
   TextDatabase::URLSet found_urls;
-  for (DBIdentSet::reverse_iterator i = present_databases_.rbegin();
-       i != present_databases_.rend();
+  const DBIdentSet databases(present_databases_);
+  for (DBIdentSet::const_reverse_iterator i = databases.rbegin();
+       i != databases.rend();
        ++i) {
     // TODO(brettw) allow canceling the query in the middle.
     // if (canceled_or_something)
@@ -504,10 +507,23 @@ TextDatabase* TextDatabaseManager::GetDB(TextDatabase::DBIdent id,
     return found_db->second;
   }
 
+  // A database that is only to be read from need not be looked for on disk
+  // when it was not there at startup and was not created since. Expiring old
+  // history asks for the database of every indexed visit it deletes, long
+  // after the database of that month is gone.
+  if (!for_writing) {
+    InitDBList();
+    if (present_databases_.find(id) == present_databases_.end())
+      return NULL;
+  }
+
   // Need to make the database.
   TextDatabase* new_db = new TextDatabase(dir_, id, for_writing);
   if (!new_db->Init()) {
     delete new_db;
+    // The file is gone, most likely expired, so don't look for it again.
+    if (!for_writing)
+      present_databases_.erase(id);
     return NULL;
   }
   db_cache_.Put(id, new_db);
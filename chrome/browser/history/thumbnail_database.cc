@@ -152,6 +152,7 @@ sql::InitStatus ThumbnailDatabase::OpenDatabase(sql::Connection* db,
   // size or cache.
   db->set_page_size(2048);
   db->set_cache_size(32);
+  db->set_histogram_tag("Thumbnail");
 
   // Run the database in exclusive mode. Nobody else should be accessing the
   // database while we're running, and this will give somewhat improved perf.
@@ -203,6 +203,14 @@ bool TopSites::SetPageThumbnail(const GURL& url,
   if (!HistoryService::CanAddURL(url))
     return false;  // It's not a real webpage.
 
+  // Most thumbnails captured for a known URL are not better than the one
+  // already cached, so check before spending time encoding them.
+  ThumbnailScore score_with_redirects;
+  if (!add_temp_thumbnail &&
+      !ShouldReplaceCachedThumbnail(url, score, &score_with_redirects)) {
+    return false;
+  }
+
   scoped_refptr<base::RefCountedBytes> thumbnail_data;
   if (!EncodeBitmap(thumbnail, &thumbnail_data))
     return false;
@@ -502,9 +510,10 @@ bool TopSites::IsFull() {
 TopSites::~TopSites() {
 }
 
-bool TopSites::SetPageThumbnailNoDB(const GURL& url,
-                                    const base::RefCountedBytes* thumbnail_data,
-                                    const ThumbnailScore& score) {
+bool TopSites::ShouldReplaceCachedThumbnail(
+    const GURL& url,
+    const ThumbnailScore& score,
+    ThumbnailScore* score_with_redirects) {
   // This should only be invoked when we know about the url.
   DCHECK(cache_->IsKnownURL(url));
 
@@ -515,15 +524,23 @@ bool TopSites::SetPageThumbnailNoDB(const GURL& url,
   // When comparing the thumbnail scores, we need to take into account the
   // redirect hops, which are not generated when the thumbnail is because the
   // redirects weren't known. We fill that in here since we know the redirects.
-  ThumbnailScore new_score_with_redirects(score);
-  new_score_with_redirects.redirect_hops_from_dest =
+  *score_with_redirects = score;
+  score_with_redirects->redirect_hops_from_dest =
       GetRedirectDistanceForURL(most_visited, url);
 
-  if (!ShouldReplaceThumbnailWith(image->thumbnail_score,
-                                  new_score_with_redirects) &&
-      image->thumbnail.get())
+  return ShouldReplaceThumbnailWith(image->thumbnail_score,
+                                    *score_with_redirects) ||
+      !image->thumbnail.get();
+}
+
+bool TopSites::SetPageThumbnailNoDB(const GURL& url,
+                                    const base::RefCountedBytes* thumbnail_data,
+                                    const ThumbnailScore& score) {
+  ThumbnailScore new_score_with_redirects;
+  if (!ShouldReplaceCachedThumbnail(url, score, &new_score_with_redirects))
     return false;  // The one we already have is better.
 
+  Images* image = cache_->GetImage(url);
   image->thumbnail = const_cast<base::RefCountedBytes*>(thumbnail_data);
   image->thumbnail_score = new_score_with_redirects;
 
@@ -212,6 +212,13 @@ class TopSites
     TOP_SITES_LOADED
   };
 
+  // Returns true if a thumbnail with |score| for the known |url| should
+  // replace the cached one. |score_with_redirects| is set to |score| with the
+  // redirect hops to |url| filled in.
+  bool ShouldReplaceCachedThumbnail(const GURL& url,
+                                    const ThumbnailScore& score,
+                                    ThumbnailScore* score_with_redirects);
+
   // Sets the thumbnail without writing to the database. Useful when
   // reading last known top sites from the DB.
   // Returns true if the thumbnail was set, false if the existing one is better.
@@ -9,6 +9,7 @@
 #include <iterator>
 #include <limits>
 #include <numeric>
+#include <queue>
 
 #include "base/file_util.h"
 #include "base/i18n/case_conversion.h"
@@ -118,6 +119,41 @@ int ScoreForValue(int value, const int* value_ranks) {
   return score;
 }
 
+// The relevance of each factor in the raw score of a match. The raw score is
+// the average of the factors weighted by these.
+const int kTermScoreRelevance = 4;
+const int kDaysAgoRelevance = 2;
+const int kVisitCountRelevance = 2;
+const int kTypedCountRelevance = 5;
+const int kTotalRelevance = kTermScoreRelevance + kDaysAgoRelevance +
+    kVisitCountRelevance + kTypedCountRelevance;
+
+// Returns the weighted sum of the recency of visit, visit count and typed
+// count factors of the raw score of |row|, which do not depend on the terms.
+int WeightedRowScore(const URLRow& row) {
+  const int kDaysAgoLevel[] = { 1, 10, 20, 30 };
+  int days_ago_value = ScoreForValue((base::Time::Now() -
+      row.last_visit()).InDays(), kDaysAgoLevel);
+  const int kVisitCountLevel[] = { 50, 30, 10, 5 };
+  int visit_count_value = ScoreForValue(row.visit_count(), kVisitCountLevel);
+  const int kTypedCountLevel[] = { 50, 30, 10, 5 };
+  int typed_count_value = ScoreForValue(row.typed_count(), kTypedCountLevel);
+
+  // Note that visit_count is reduced by typed_count because both are bumped
+  // when a typed URL is recorded thus giving visit_count too much weight.
+  int effective_visit_count_value =
+      std::max(0, visit_count_value - typed_count_value);
+  return days_ago_value * kDaysAgoRelevance +
+         effective_visit_count_value * kVisitCountRelevance +
+         typed_count_value * kTypedCountRelevance;
+}
+
+// Orders (score bound, history ID) pairs by descending score bound.
+bool ScoreBoundGreater(const std::pair<int, HistoryID>& a,
+                       const std::pair<int, HistoryID>& b) {
+  return a.first > b.first;
+}
+
 // InMemoryURLIndex's Private Data ---------------------------------------------
 
 URLIndexPrivateData::URLIndexPrivateData()
@@ -521,9 +557,40 @@ ScoredHistoryMatches URLIndexPrivateData::HistoryItemsForTerms(
   // get two 'terms': "colspec=id%20mstone" and "release".
   history::String16Vector lower_raw_terms;
   Tokenize(lower_raw_string, kWhitespaceUTF16, &lower_raw_terms);
-  scored_items = std::for_each(history_id_set.begin(), history_id_set.end(),
-      AddHistoryMatch(*this, lower_raw_string,
-                      lower_raw_terms)).ScoredMatches();
+
+  // Substring matching and scoring is the costly part, so the candidates are
+  // scored in descending order of the best score each could get. Once that
+  // bound falls below the lowest of the top kMaxMatches scores so far, none
+  // of the remaining candidates can make the results and they are skipped.
+  std::vector<std::pair<int, HistoryID> > candidates;
+  candidates.reserve(history_id_set.size());
+  for (HistoryIDSet::const_iterator iter = history_id_set.begin();
+       iter != history_id_set.end(); ++iter) {
+    HistoryInfoMap::const_iterator hist_pos = history_info_map_.find(*iter);
+    if (hist_pos != history_info_map_.end()) {
+      candidates.push_back(
+          std::make_pair(MaxRawScoreForRow(hist_pos->second), *iter));
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), ScoreBoundGreater);
+
+  AddHistoryMatch add_history_match(*this, lower_raw_string, lower_raw_terms);
+  // The lowest of the top kMaxMatches scores is at the top of this heap.
+  std::priority_queue<int, std::vector<int>, std::greater<int> > top_scores;
+  for (std::vector<std::pair<int, HistoryID> >::const_iterator iter =
+       candidates.begin(); iter != candidates.end(); ++iter) {
+    if (top_scores.size() == AutocompleteProvider::kMaxMatches &&
+        iter->first < top_scores.top())
+      break;
+    size_t match_count = add_history_match.ScoredMatches().size();
+    add_history_match(iter->second);
+    if (add_history_match.ScoredMatches().size() == match_count)
+      continue;
+    top_scores.push(add_history_match.ScoredMatches().back().raw_score);
+    if (top_scores.size() > AutocompleteProvider::kMaxMatches)
+      top_scores.pop();
+  }
+  scored_items = add_history_match.ScoredMatches();
 
   // Select and sort only the top kMaxMatches results.
   if (scored_items.size() > AutocompleteProvider::kMaxMatches) {
@@ -653,38 +720,28 @@ ScoredHistoryMatch URLIndexPrivateData::ScoredMatchForURL(
   if (term_score == 0)
     return match;
 
-  // Determine scoring factors for the recency of visit, visit count and typed
-  // count attributes of the URLRow.
-  const int kDaysAgoLevel[] = { 1, 10, 20, 30 };
-  int days_ago_value = ScoreForValue((base::Time::Now() -
-      row.last_visit()).InDays(), kDaysAgoLevel);
-  const int kVisitCountLevel[] = { 50, 30, 10, 5 };
-  int visit_count_value = ScoreForValue(row.visit_count(), kVisitCountLevel);
-  const int kTypedCountLevel[] = { 50, 30, 10, 5 };
-  int typed_count_value = ScoreForValue(row.typed_count(), kTypedCountLevel);
-
   // The final raw score is calculated by:
   //   - multiplying each factor by a 'relevance'
   //   - calculating the average.
-  // Note that visit_count is reduced by typed_count because both are bumped
-  // when a typed URL is recorded thus giving visit_count too much weight.
-  const int kTermScoreRelevance = 4;
-  const int kDaysAgoRelevance = 2;
-  const int kVisitCountRelevance = 2;
-  const int kTypedCountRelevance = 5;
-  int effective_visit_count_value =
-      std::max(0, visit_count_value - typed_count_value);
-  match.raw_score = term_score * kTermScoreRelevance +
-                    days_ago_value * kDaysAgoRelevance +
-                    effective_visit_count_value * kVisitCountRelevance +
-                    typed_count_value * kTypedCountRelevance;
-  match.raw_score /= (kTermScoreRelevance + kDaysAgoRelevance +
-                      kVisitCountRelevance + kTypedCountRelevance);
+  // The factors other than the term score come from the recency of visit,
+  // visit count and typed count attributes of the URLRow.
+  match.raw_score =
+      (term_score * kTermScoreRelevance + WeightedRowScore(row)) /
+      kTotalRelevance;
   match.raw_score = std::min(kMaxTotalScore, match.raw_score);
 
   return match;
 }
 
+// static
+int URLIndexPrivateData::MaxRawScoreForRow(const URLRow& row) {
+  // The term score is at most the top score rank.
+  int max_raw_score =
+      (kScoreRank[0] * kTermScoreRelevance + WeightedRowScore(row)) /
+      kTotalRelevance;
+  return std::min(kMaxTotalScore, max_raw_score);
+}
+
 int URLIndexPrivateData::ScoreComponentForMatches(const TermMatches& matches,
                                                   size_t max_length) {
   if (matches.empty())
@@ -990,7 +1047,8 @@ void URLIndexPrivateData::SaveWordList(InMemoryURLIndexCacheItem* cache) const {
 }
 
 void URLIndexPrivateData::SaveWordMap(InMemoryURLIndexCacheItem* cache) const {
-  if (word_map_.empty())
+  // Since version 2 the word map is rebuilt from the word list on restore.
+  if (word_map_.empty() || saved_cache_version_ >= 2)
     return;
   WordMapItem* map_item = cache->mutable_word_map();
   map_item->set_item_count(word_map_.size());
@@ -1014,9 +1072,15 @@ void URLIndexPrivateData::SaveCharWordMap(
     map_entry->set_char_16(iter->first);
     const WordIDSet& word_id_set(iter->second);
     map_entry->set_item_count(word_id_set.size());
+    // Since version 2 each ID is saved as the difference from the one before
+    // it, which packs the ascending IDs into far fewer varint bytes.
+    WordID previous_word_id = 0;
     for (WordIDSet::const_iterator set_iter = word_id_set.begin();
-         set_iter != word_id_set.end(); ++set_iter)
-      map_entry->add_word_id(*set_iter);
+         set_iter != word_id_set.end(); ++set_iter) {
+      map_entry->add_word_id(saved_cache_version_ >= 2 ?
+          *set_iter - previous_word_id : *set_iter);
+      previous_word_id = *set_iter;
+    }
   }
 }
 
@@ -1033,9 +1097,14 @@ void URLIndexPrivateData::SaveWordIDHistoryMap(
     map_entry->set_word_id(iter->first);
     const HistoryIDSet& history_id_set(iter->second);
     map_entry->set_item_count(history_id_set.size());
+    // Delta-coded since version 2, as in SaveCharWordMap().
+    HistoryID previous_history_id = 0;
     for (HistoryIDSet::const_iterator set_iter = history_id_set.begin();
-         set_iter != history_id_set.end(); ++set_iter)
-      map_entry->add_history_id(*set_iter);
+         set_iter != history_id_set.end(); ++set_iter) {
+      map_entry->add_history_id(saved_cache_version_ >= 2 ?
+          *set_iter - previous_history_id : *set_iter);
+      previous_history_id = *set_iter;
+    }
   }
 }
 
@@ -1192,6 +1261,17 @@ bool URLIndexPrivateData::RestoreWordList(
 
 bool URLIndexPrivateData::RestoreWordMap(
     const InMemoryURLIndexCacheItem& cache) {
+  if (restored_cache_version_ >= 2) {
+    // The word map is the inverse of the word list. The empty slots in the
+    // word list are the IDs of words no longer in use.
+    for (WordID word_id = 0; word_id < word_list_.size(); ++word_id) {
+      if (word_list_[word_id].empty())
+        available_words_.insert(available_words_.end(), word_id);
+      else
+        word_map_[word_list_[word_id]] = word_id;
+    }
+    return !word_map_.empty();
+  }
   if (!cache.has_word_map())
     return false;
   const WordMapItem& list_item(cache.word_map());
@@ -1224,12 +1304,15 @@ bool URLIndexPrivateData::RestoreCharWordMap(
     if (actual_item_count == 0 || actual_item_count != expected_item_count)
       return false;
     char16 uni_char = static_cast<char16>(iter->char_16());
-    WordIDSet word_id_set;
+    WordIDSet& word_id_set(char_word_map_[uni_char]);
     const RepeatedField<int32>& word_ids(iter->word_id());
+    // The IDs were saved in ascending order, so each one goes at the end.
+    WordID word_id = 0;
     for (RepeatedField<int32>::const_iterator jiter = word_ids.begin();
-         jiter != word_ids.end(); ++jiter)
-      word_id_set.insert(*jiter);
-    char_word_map_[uni_char] = word_id_set;
+         jiter != word_ids.end(); ++jiter) {
+      word_id = restored_cache_version_ >= 2 ? word_id + *jiter : *jiter;
+      word_id_set.insert(word_id_set.end(), word_id);
+    }
   }
   return true;
 }
@@ -1252,14 +1335,17 @@ bool URLIndexPrivateData::RestoreWordIDHistoryMap(
     if (actual_item_count == 0 || actual_item_count != expected_item_count)
       return false;
     WordID word_id = iter->word_id();
-    HistoryIDSet history_id_set;
+    HistoryIDSet& history_id_set(word_id_history_map_.insert(
+        word_id_history_map_.end(),
+        std::make_pair(word_id, HistoryIDSet()))->second);
     const RepeatedField<int64>& history_ids(iter->history_id());
+    HistoryID history_id = 0;
     for (RepeatedField<int64>::const_iterator jiter = history_ids.begin();
          jiter != history_ids.end(); ++jiter) {
-      history_id_set.insert(*jiter);
-      AddToHistoryIDWordMap(*jiter, word_id);
+      history_id = restored_cache_version_ >= 2 ? history_id + *jiter : *jiter;
+      history_id_set.insert(history_id_set.end(), history_id);
+      AddToHistoryIDWordMap(history_id, word_id);
     }
-    word_id_history_map_[word_id] = history_id_set;
   }
   return true;
 }
@@ -31,7 +31,7 @@ class InMemoryURLIndex;
 class RefCountedBool;
 
 // Current version of the cache file.
-static const int kCurrentCacheFileVersion = 1;
+static const int kCurrentCacheFileVersion = 2;
 
 // A structure describing the InMemoryURLIndex's internal data and providing for
 // restoring, rebuilding and updating that internal data.
@@ -49,7 +49,9 @@ class URLIndexPrivateData
   friend class InMemoryURLIndex;
   friend class InMemoryURLIndexTest;
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CacheSaveRestore);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, CacheRestoresFreedWords);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, HugeResultSet);
+  FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, MaxRawScoreForRow);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, Scoring);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, TitleSearch);
   FRIEND_TEST_ALL_PREFIXES(InMemoryURLIndexTest, TypedCharacterCaching);
@@ -99,7 +101,9 @@ class URLIndexPrivateData
 
     void operator()(const HistoryID history_id);
 
-    ScoredHistoryMatches ScoredMatches() const { return scored_matches_; }
+    const ScoredHistoryMatches& ScoredMatches() const {
+      return scored_matches_;
+    }
 
    private:
     const URLIndexPrivateData& private_data_;
@@ -274,6 +278,11 @@ class URLIndexPrivateData
       const String16Vector& terms_vector,
       const RowWordStarts& word_starts);
 
+  // Returns the highest raw score ScoredMatchForURL() could give |row| for any
+  // search terms. It depends only on the visit history of |row|, so it is
+  // cheap enough to compute for every candidate before scoring any of them.
+  static int MaxRawScoreForRow(const URLRow& row);
+
   // Calculates a component score based on position, ordering and total
   // substring match size using metrics recorded in |matches|. |max_length|
   // is the length of the string against which the terms are being searched.
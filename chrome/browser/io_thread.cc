@@ -12,6 +12,7 @@
 #include "base/compiler_specific.h"
 #include "base/debug/leak_tracker.h"
 #include "base/logging.h"
+#include "base/path_service.h"
 #include "base/stl_util.h"
 #include "base/string_number_conversions.h"
 #include "base/string_split.h"
@@ -29,6 +30,8 @@
 #include "chrome/browser/net/proxy_service_factory.h"
 #include "chrome/browser/net/sdch_dictionary_fetcher.h"
 #include "chrome/browser/prefs/pref_service.h"
+#include "chrome/common/chrome_constants.h"
+#include "chrome/common/chrome_paths.h"
 #include "chrome/common/chrome_switches.h"
 #include "chrome/common/pref_names.h"
 #include "content/public/browser/browser_thread.h"
@@ -452,6 +455,13 @@ void IOThread::Init() {
           switches::kDisableExtensionsHttpThrottling)) {
     globals_->throttler_manager->set_enforce_throttling(false);
   }
+  int background_limit_kb = 0;
+  if (base::StringToInt(CommandLine::ForCurrentProcess()->GetSwitchValueASCII(
+          switches::kBackgroundBandwidthLimit), &background_limit_kb) &&
+      background_limit_kb > 0) {
+    globals_->throttler_manager->SetPriorityBandwidthLimit(
+        net::LOWEST, static_cast<int64>(background_limit_kb) * 1024);
+  }
   globals_->throttler_manager->set_net_log(net_log_);
 
   globals_->proxy_script_fetcher_context =
@@ -582,16 +592,22 @@ void IOThread::InitSystemRequestContext() {
   }
   system_url_request_context_getter_ =
       new SystemURLRequestContextGetter(this);
+  FilePath sdch_dictionaries_path;
+  if (PathService::Get(chrome::DIR_USER_DATA, &sdch_dictionaries_path)) {
+    sdch_dictionaries_path =
+        sdch_dictionaries_path.Append(chrome::kSdchDictionariesDirname);
+  }
   // Safe to post an unretained this pointer, since IOThread is
   // guaranteed to outlive the IO BrowserThread.
   BrowserThread::PostTask(
       BrowserThread::IO,
       FROM_HERE,
       base::Bind(&IOThread::InitSystemRequestContextOnIOThread,
-                 base::Unretained(this)));
+                 base::Unretained(this), sdch_dictionaries_path));
 }
 
-void IOThread::InitSystemRequestContextOnIOThread() {
+void IOThread::InitSystemRequestContextOnIOThread(
+    const FilePath& sdch_dictionaries_path) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
   DCHECK(!globals_->system_proxy_service.get());
   DCHECK(system_proxy_config_service_.get());
@@ -627,5 +643,6 @@ void IOThread::InitSystemRequestContextOnIOThread() {
       ConstructSystemRequestContext(globals_, net_log_);
 
   sdch_manager_->set_sdch_fetcher(
-      new SdchDictionaryFetcher(system_url_request_context_getter_.get()));
+      new SdchDictionaryFetcher(system_url_request_context_getter_.get(),
+                                sdch_dictionaries_path));
 }
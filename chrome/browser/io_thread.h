@@ -21,6 +21,7 @@
 
 class ChromeNetLog;
 class ExtensionEventRouterForwarder;
+class FilePath;
 class PrefProxyConfigTrackerImpl;
 class PrefService;
 class SystemURLRequestContextGetter;
@@ -153,7 +154,9 @@ class IOThread : public content::BrowserThreadDelegate {
   // SystemURLRequestContextGetter. To be called on IO thread only
   // after global state has been initialized on the IO thread, and
   // SystemRequestContext state has been initialized on the UI thread.
-  void InitSystemRequestContextOnIOThread();
+  // |sdch_dictionaries_path| is where downloaded SDCH dictionaries are kept.
+  void InitSystemRequestContextOnIOThread(
+      const FilePath& sdch_dictionaries_path);
 
   static void RegisterPrefs(PrefService* local_state);
 
@@ -93,12 +93,10 @@ void MetricsLogSerializer::SerializeLogs(
   };
 
   // Write the XML version.
-  ListPrefUpdate update_xml(local_state, pref_xml);
-  WriteLogsToPrefList(logs, true, max_store_count, update_xml.Get());
+  WriteLogsToPrefIfChanged(logs, true, max_store_count, pref_xml);
 
   // Write the protobuf version.
-  ListPrefUpdate update_proto(local_state, pref_proto);
-  WriteLogsToPrefList(logs, false, max_store_count, update_proto.Get());
+  WriteLogsToPrefIfChanged(logs, false, max_store_count, pref_proto);
 }
 
 void MetricsLogSerializer::DeserializeLogs(
@@ -127,6 +125,23 @@ void MetricsLogSerializer::DeserializeLogs(
   }
 }
 
+// static
+void MetricsLogSerializer::WriteLogsToPrefIfChanged(
+    const std::vector<MetricsLogManager::SerializedLog>& local_list,
+    bool is_xml,
+    size_t max_list_size,
+    const char* pref) {
+  PrefService* local_state = g_browser_process->local_state();
+  ListValue list;
+  WriteLogsToPrefList(local_list, is_xml, max_list_size, &list);
+  // Usually only one of the lists changed since they were last stored, and
+  // writing the other one again would needlessly rewrite Local State.
+  if (list.Equals(local_state->GetList(pref)))
+    return;
+  ListPrefUpdate update(local_state, pref);
+  update->Swap(&list);
+}
+
 // static
 void MetricsLogSerializer::WriteLogsToPrefList(
     const std::vector<MetricsLogManager::SerializedLog>& local_list,
@@ -55,6 +55,14 @@ class MetricsLogSerializer : public MetricsLogManager::LogSerializer {
       size_t max_list_size,
       base::ListValue* list);
 
+  // Like WriteLogsToPrefList(), but writes to the Local State list |pref|, and
+  // leaves it alone if it already holds the same data.
+  static void WriteLogsToPrefIfChanged(
+      const std::vector<MetricsLogManager::SerializedLog>& local_list,
+      bool is_xml,
+      size_t max_list_size,
+      const char* pref);
+
   // Decodes and verifies the textual log data from |list|, populating
   // |local_list| and returning a status code.  If |is_xml| is true, populates
   // the XML data in |local_list|; otherwise populates the protobuf data.
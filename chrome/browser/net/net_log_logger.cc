@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 
+#include "base/bind.h"
 #include "base/file_util.h"
 #include "base/json/json_writer.h"
 #include "base/logging.h"
@@ -14,7 +15,14 @@
 #include "base/values.h"
 #include "chrome/browser/ui/webui/net_internals/net_internals_ui.h"
 
-NetLogLogger::NetLogLogger(const FilePath &log_path) {
+// Enough to ride out a burst of activity while the disk is slow, without
+// letting a stuck disk use up memory.
+const int NetLogLogger::kMaxPendingEntries = 10000;
+
+NetLogLogger::NetLogLogger(const FilePath &log_path)
+    : pending_entries_(0),
+      dropped_entries_(0),
+      writer_thread_("NetLogLogger") {
   if (!log_path.empty()) {
     base::ThreadRestrictions::ScopedAllowIO allow_io;
     file_.Set(file_util::OpenFile(log_path, "w"));
@@ -28,9 +36,19 @@ NetLogLogger::NetLogLogger(const FilePath &log_path) {
     fprintf(file_.get(), "{\"constants\": %s,\n", json.c_str());
     fprintf(file_.get(), "\"events\": [\n");
   }
+
+  if (file_.get() && !writer_thread_.Start())
+    file_.Close();
 }
 
 NetLogLogger::~NetLogLogger() {
+  if (writer_thread_.IsRunning()) {
+    // Stopping the thread runs the writes still queued on it.
+    base::ThreadRestrictions::ScopedAllowIO allow_io;
+    writer_thread_.Stop();
+  }
+  if (dropped_entries_ > 0)
+    LOG(WARNING) << "NetLogLogger dropped " << dropped_entries_ << " entries";
 }
 
 void NetLogLogger::StartObserving(net::NetLog* net_log) {
@@ -42,18 +60,41 @@ void NetLogLogger::OnAddEntry(net::NetLog::EventType type,
                               const net::NetLog::Source& source,
                               net::NetLog::EventPhase phase,
                               net::NetLog::EventParameters* params) {
+  if (writer_thread_.IsRunning()) {
+    if (base::subtle::NoBarrier_Load(&pending_entries_) >=
+        kMaxPendingEntries) {
+      ++dropped_entries_;
+      return;
+    }
+    // |params| are turned into a Value here, as their owners need not expect
+    // them to be used on another thread.  Serializing and writing, which take
+    // most of the time, are left to |writer_thread_|.
+    base::subtle::NoBarrier_AtomicIncrement(&pending_entries_, 1);
+    writer_thread_.message_loop()->PostTask(
+        FROM_HERE,
+        base::Bind(&NetLogLogger::WriteEntry, base::Unretained(this),
+                   base::Owned(net::NetLog::EntryToDictionaryValue(
+                       type, time, source, phase, params, false))));
+    return;
+  }
+
   scoped_ptr<Value> value(
       net::NetLog::EntryToDictionaryValue(
           type, time, source, phase, params, false));
+  WriteEntry(value.get());
+}
+
+void NetLogLogger::WriteEntry(Value* value) {
   // Don't pretty print, so each JSON value occupies a single line, with no
   // breaks (Line breaks in any text field will be escaped).  Using strings
   // instead of integer identifiers allows logs from older versions to be
   // loaded, though a little extra parsing has to be done when loading a log.
   std::string json;
-  base::JSONWriter::Write(value.get(), &json);
+  base::JSONWriter::Write(value, &json);
   if (!file_.get()) {
     VLOG(1) << json;
   } else {
     fprintf(file_.get(), "%s,\n", json.c_str());
+    base::subtle::NoBarrier_AtomicIncrement(&pending_entries_, -1);
   }
 }
@@ -6,11 +6,17 @@
 #define CHROME_BROWSER_NET_NET_LOG_LOGGER_H_
 #pragma once
 
+#include "base/atomicops.h"
 #include "base/memory/scoped_handle.h"
+#include "base/threading/thread.h"
 #include "net/base/net_log.h"
 
 class FilePath;
 
+namespace base {
+class Value;
+}
+
 // NetLogLogger watches the NetLog event stream, and sends all entries to
 // VLOG(1) or a path specified on creation.  This is to debug errors that
 // prevent getting to the about:net-internals page.
@@ -19,6 +25,12 @@ class FilePath;
 // contain a single JSON object, with an extra comma on the end and missing
 // a terminal "]}".
 //
+// When writing to a file, entries are serialized and written on a thread of
+// the logger's own, so that the threads adding entries never wait on the disk.
+// At most kMaxPendingEntries entries are queued at once; entries added while
+// the queue is full are dropped and counted rather than slowing the network
+// stack down.
+//
 // Relies on ChromeNetLog only calling an Observer once at a time for
 // thread-safety.
 class NetLogLogger : public net::NetLog::ThreadSafeObserver {
@@ -27,8 +39,13 @@ class NetLogLogger : public net::NetLog::ThreadSafeObserver {
   // Otherwise, writes to |log_path|.  Uses one line per entry, for
   // easy parsing.
   explicit NetLogLogger(const FilePath &log_path);
+  // Writes out all queued entries before returning.
   virtual ~NetLogLogger();
 
+  // The number of entries that may wait to be written before new ones are
+  // dropped.
+  static const int kMaxPendingEntries;
+
   // Starts observing specified NetLog.  Must not already be watching a NetLog.
   // Separate from constructor to enforce thread safety.
   void StartObserving(net::NetLog* net_log);
@@ -41,8 +58,20 @@ class NetLogLogger : public net::NetLog::ThreadSafeObserver {
                           net::NetLog::EventParameters* params) OVERRIDE;
 
  private:
+  // Writes |value| to |file_|.  Called on |writer_thread_| when writing to a
+  // file.
+  void WriteEntry(base::Value* value);
+
+  // Only used on |writer_thread_| once the constructor has returned.
   ScopedStdioHandle file_;
 
+  // Entries posted to |writer_thread_| and not yet written, and entries
+  // dropped because too many were pending.
+  base::subtle::Atomic32 pending_entries_;
+  int dropped_entries_;
+
+  base::Thread writer_thread_;
+
   DISALLOW_COPY_AND_ASSIGN(NetLogLogger);
 };
 
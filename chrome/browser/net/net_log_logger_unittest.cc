@@ -0,0 +1,38 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/net_log_logger.h"
+
+#include <algorithm>
+
+#include "base/file_util.h"
+#include "base/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+TEST(NetLogLoggerTest, WritesQueuedEntriesOnDestruction) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath log_path = temp_dir.path().AppendASCII("net-log.json");
+
+  const int kEntries = 5;
+  {
+    NetLogLogger logger(log_path);
+    for (int i = 0; i < kEntries; ++i) {
+      logger.OnAddEntry(net::NetLog::TYPE_CANCELLED, base::TimeTicks::Now(),
+                        net::NetLog::Source(), net::NetLog::PHASE_NONE, NULL);
+    }
+  }
+
+  std::string contents;
+  ASSERT_TRUE(file_util::ReadFileToString(log_path, &contents));
+  // Each entry is written on a line of its own after the constants.
+  size_t events = contents.find("\"events\": [\n");
+  ASSERT_NE(std::string::npos, events);
+  EXPECT_EQ(kEntries, std::count(contents.begin() + events, contents.end(),
+                                 '\n') - 1);
+}
+
+}  // namespace
@@ -31,6 +31,7 @@
 #include "content/public/browser/browser_thread.h"
 #include "net/base/address_list.h"
 #include "net/base/completion_callback.h"
+#include "net/base/host_cache.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/host_resolver.h"
 #include "net/base/net_errors.h"
@@ -79,6 +80,9 @@ static size_t g_max_parallel_resolves = 0u;
 // we change the format so that we discard old data.
 static const int kPredictorStartupFormatVersion = 1;
 
+// The number of host cache entries saved for the next startup.
+static const size_t kMaxSavedHostCacheEntries = 50;
+
 class Predictor::LookupRequest {
  public:
   LookupRequest(Predictor* predictor,
@@ -101,6 +105,9 @@ class Predictor::LookupRequest {
     // to separate it from real navigations in the observer's callback, and
     // lets the HostResolver know it can de-prioritize it.
     resolve_info.set_is_speculative(true);
+    // An expired address is good enough to warm up a connection with, and
+    // the HostResolver refreshes it in the background.
+    resolve_info.set_allow_stale_response(true);
     return resolver_.Resolve(
         resolve_info, &addresses_,
         base::Bind(&LookupRequest::OnLookupFinished, base::Unretained(this)),
@@ -157,6 +164,8 @@ void Predictor::RegisterUserPrefs(PrefService* user_prefs) {
                                PrefService::UNSYNCABLE_PREF);
   user_prefs->RegisterListPref(prefs::kDnsPrefetchingHostReferralList,
                                PrefService::UNSYNCABLE_PREF);
+  user_prefs->RegisterListPref(prefs::kDnsPrefetchingHostCache,
+                               PrefService::UNSYNCABLE_PREF);
 }
 
 // --------------------- Start UI methods. ------------------------------------
@@ -179,13 +188,17 @@ void Predictor::InitNetworkPredictor(PrefService* user_prefs,
       static_cast<base::ListValue*>(user_prefs->GetList(
           prefs::kDnsPrefetchingHostReferralList)->DeepCopy());
 
+  base::ListValue* host_cache_list =
+      static_cast<base::ListValue*>(user_prefs->GetList(
+          prefs::kDnsPrefetchingHostCache)->DeepCopy());
+
   BrowserThread::PostTask(
       BrowserThread::IO,
       FROM_HERE,
       base::Bind(
           &Predictor::FinalizeInitializationOnIOThread,
           base::Unretained(this),
-          urls, referral_list,
+          urls, referral_list, host_cache_list,
           io_thread, predictor_enabled));
 }
 
@@ -641,6 +654,43 @@ void Predictor::DeserializeReferrersThenDelete(
   delete referral_list;
 }
 
+void Predictor::SaveHostCache(base::ListValue* host_cache_list) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  host_cache_list->Clear();
+  net::HostCache* host_cache =
+      host_resolver_ ? host_resolver_->GetHostCache() : NULL;
+  if (!host_cache)
+    return;
+  // The entries that expire last were resolved most recently, which makes
+  // them the best guess at what the next session needs.
+  scoped_ptr<base::ListValue> entries(host_cache->GetAsListValue(
+      base::TimeTicks::Now(), base::Time::Now(), kMaxSavedHostCacheEntries));
+  host_cache_list->Swap(entries.get());
+}
+
+void Predictor::RestoreHostCache(const base::ListValue& host_cache_list) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  net::HostCache* host_cache =
+      host_resolver_ ? host_resolver_->GetHostCache() : NULL;
+  if (!host_cache)
+    return;
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (!host_cache->RestoreFromListValue(host_cache_list, now,
+                                        base::Time::Now())) {
+    return;
+  }
+
+  // Our lookups accept stale entries, so resolving the expired ones serves
+  // them at once and has the HostResolver refresh them at idle priority.
+  UrlList expired_urls;
+  for (net::HostCache::EntryMap::Iterator it(host_cache->entries());
+       it.HasNext(); it.Advance()) {
+    if (it.expiration() <= now)
+      expired_urls.push_back(GURL("http://" + it.key().hostname + ":80"));
+  }
+  DnsPrefetchMotivatedList(expired_urls, UrlInfo::STARTUP_LIST_MOTIVATED);
+}
+
 void Predictor::DiscardInitialNavigationHistory() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
   if (initial_observer_.get())
@@ -650,6 +700,7 @@ void Predictor::DiscardInitialNavigationHistory() {
 void Predictor::FinalizeInitializationOnIOThread(
     const UrlList& startup_urls,
     base::ListValue* referral_list,
+    base::ListValue* host_cache_list,
     IOThread* io_thread,
     bool predictor_enabled) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
@@ -668,6 +719,10 @@ void Predictor::FinalizeInitializationOnIOThread(
   // Prefetch these hostnames on startup.
   DnsPrefetchMotivatedList(startup_urls, UrlInfo::STARTUP_LIST_MOTIVATED);
   DeserializeReferrersThenDelete(referral_list);
+
+  scoped_ptr<base::ListValue> scoped_host_cache_list(host_cache_list);
+  if (predictor_enabled_)
+    RestoreHostCache(*host_cache_list);
 }
 
 //-----------------------------------------------------------------------------
@@ -728,6 +783,7 @@ void Predictor::DnsPrefetchMotivatedList(
 static void SaveDnsPrefetchStateForNextStartupAndTrimOnIOThread(
     base::ListValue* startup_list,
     base::ListValue* referral_list,
+    base::ListValue* host_cache_list,
     base::WaitableEvent* completion,
     Predictor* predictor) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
@@ -737,7 +793,7 @@ static void SaveDnsPrefetchStateForNextStartupAndTrimOnIOThread(
     return;
   }
   predictor->SaveDnsPrefetchStateForNextStartupAndTrim(
-      startup_list, referral_list, completion);
+      startup_list, referral_list, host_cache_list, completion);
 }
 
 void Predictor::SaveStateForNextStartupAndTrim(PrefService* prefs) {
@@ -749,10 +805,13 @@ void Predictor::SaveStateForNextStartupAndTrim(PrefService* prefs) {
   ListPrefUpdate update_startup_list(prefs, prefs::kDnsPrefetchingStartupList);
   ListPrefUpdate update_referral_list(prefs,
                                       prefs::kDnsPrefetchingHostReferralList);
+  ListPrefUpdate update_host_cache_list(prefs,
+                                        prefs::kDnsPrefetchingHostCache);
   if (BrowserThread::CurrentlyOn(BrowserThread::IO)) {
     SaveDnsPrefetchStateForNextStartupAndTrimOnIOThread(
         update_startup_list.Get(),
         update_referral_list.Get(),
+        update_host_cache_list.Get(),
         &completion,
         this);
   } else {
@@ -763,6 +822,7 @@ void Predictor::SaveStateForNextStartupAndTrim(PrefService* prefs) {
             &SaveDnsPrefetchStateForNextStartupAndTrimOnIOThread,
             update_startup_list.Get(),
             update_referral_list.Get(),
+            update_host_cache_list.Get(),
             &completion,
             this));
 
@@ -780,6 +840,7 @@ void Predictor::SaveStateForNextStartupAndTrim(PrefService* prefs) {
 void Predictor::SaveDnsPrefetchStateForNextStartupAndTrim(
     base::ListValue* startup_list,
     base::ListValue* referral_list,
+    base::ListValue* host_cache_list,
     base::WaitableEvent* completion) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
   if (initial_observer_.get())
@@ -789,6 +850,7 @@ void Predictor::SaveDnsPrefetchStateForNextStartupAndTrim(
   // enough to do any regular trimming of referrers.
   TrimReferrersNow();
   SerializeReferrers(referral_list);
+  SaveHostCache(host_cache_list);
 
   completion->Signal();
 }
@@ -183,11 +183,22 @@ class Predictor {
 
   void DeserializeReferrersThenDelete(base::ListValue* referral_list);
 
+  // Construct a ListValue object that contains the host cache entries that
+  // are worth keeping for the next startup, so that it can be persisted in a
+  // pref.
+  void SaveHostCache(base::ListValue* host_cache_list);
+
+  // Add the entries of a list constructed by SaveHostCache() to the host
+  // cache. Entries that have expired since are used as they are, and resolved
+  // again in the background.
+  void RestoreHostCache(const base::ListValue& host_cache_list);
+
   void DiscardInitialNavigationHistory();
 
   void FinalizeInitializationOnIOThread(
       const std::vector<GURL>& urls_to_prefetch,
       base::ListValue* referral_list,
+      base::ListValue* host_cache_list,
       IOThread* io_thread,
       bool predictor_enabled);
 
@@ -211,6 +222,7 @@ class Predictor {
   void SaveDnsPrefetchStateForNextStartupAndTrim(
       base::ListValue* startup_list,
       base::ListValue* referral_list,
+      base::ListValue* host_cache_list,
       base::WaitableEvent* completion);
 
   // May be called from either the IO or UI thread and will PostTask
@@ -18,7 +18,10 @@
 #include "chrome/common/net/predictor_common.h"
 #include "content/test/test_browser_thread.h"
 #include "net/base/address_list.h"
+#include "net/base/host_cache.h"
 #include "net/base/mock_host_resolver.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_util.h"
 #include "net/base/winsock_init.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -674,4 +677,53 @@ TEST_F(PredictorTest, DiscardPredictorResults) {
   predictor.Shutdown();
 }
 
+// Make sure that host cache entries saved at shutdown are put back at startup,
+// and that the ones that expired in between are resolved again.
+TEST_F(PredictorTest, HostCacheSaveAndRestore) {
+  const net::HostCache::Key key("www.google.com",
+                                net::ADDRESS_FAMILY_UNSPECIFIED, 0);
+  net::HostCache* host_cache = host_resolver_->GetHostCache();
+  net::IPAddressNumber address;
+  ASSERT_TRUE(net::ParseIPLiteralToNumber("10.0.0.1", &address));
+  host_cache->Set(key, net::OK,
+                  net::AddressList::CreateFromIPAddress(address, 0),
+                  base::TimeTicks::Now(), TimeDelta::FromHours(1));
+
+  Predictor predictor(true);
+  predictor.SetHostResolver(host_resolver_.get());
+  ListValue host_cache_list;
+  predictor.SaveHostCache(&host_cache_list);
+  EXPECT_EQ(1U, host_cache_list.GetSize());
+  predictor.Shutdown();
+
+  // An entry that is still valid is used as it is.
+  scoped_ptr<net::MockCachingHostResolver> restored_resolver(
+      new net::MockCachingHostResolver());
+  Predictor restored_predictor(true);
+  restored_predictor.SetHostResolver(restored_resolver.get());
+  restored_predictor.RestoreHostCache(host_cache_list);
+  const net::HostCache::Entry* entry =
+      restored_resolver->GetHostCache()->Lookup(key, base::TimeTicks::Now());
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("10.0.0.1", net::NetAddressToString(entry->addrlist.head()));
+  restored_predictor.Shutdown();
+
+  // An entry that expired since it was saved is resolved again.
+  DictionaryValue* saved_entry;
+  ASSERT_TRUE(host_cache_list.GetDictionary(0, &saved_entry));
+  saved_entry->SetDouble(
+      "expiration", (Time::Now() - TimeDelta::FromHours(1)).ToDoubleT());
+  host_cache->clear();
+  Predictor stale_predictor(true);
+  stale_predictor.SetHostResolver(host_resolver_.get());
+  stale_predictor.RestoreHostCache(host_cache_list);
+  UrlList urls;
+  urls.push_back(GURL("http://www.google.com:80"));
+  WaitForResolution(&stale_predictor, urls);
+  entry = host_cache->Lookup(key, base::TimeTicks::Now());
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("127.0.0.1", net::NetAddressToString(entry->addrlist.head()));
+  stale_predictor.Shutdown();
+}
+
 }  // namespace chrome_browser_net
@@ -4,21 +4,141 @@
 
 #include "chrome/browser/net/sdch_dictionary_fetcher.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
+#include "base/bind_helpers.h"
 #include "base/compiler_specific.h"
+#include "base/file_util.h"
 #include "base/message_loop.h"
+#include "base/string_number_conversions.h"
 #include "chrome/browser/profiles/profile.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/common/url_fetcher.h"
 #include "net/base/load_flags.h"
 #include "net/url_request/url_request_context_getter.h"
 #include "net/url_request/url_request_status.h"
 
+using content::BrowserThread;
+
+namespace {
+
+const FilePath::CharType kDictionaryExtension[] = FILE_PATH_LITERAL(".sdch");
+const FilePath::CharType kDictionaryPattern[] = FILE_PATH_LITERAL("*.sdch");
+
+// A stored dictionary is its URL and fetch time, each on a line of its own,
+// followed by the dictionary text.
+bool ParseStoredDictionary(const std::string& contents,
+                           GURL* url,
+                           base::Time* fetch_time,
+                           std::string* text) {
+  size_t url_end = contents.find('\n');
+  if (url_end == std::string::npos)
+    return false;
+  size_t time_end = contents.find('\n', url_end + 1);
+  if (time_end == std::string::npos)
+    return false;
+  int64 internal_time;
+  if (!base::StringToInt64(contents.substr(url_end + 1,
+                                           time_end - url_end - 1),
+                           &internal_time)) {
+    return false;
+  }
+  *url = GURL(contents.substr(0, url_end));
+  if (!url->is_valid())
+    return false;
+  *fetch_time = base::Time::FromInternalValue(internal_time);
+  *text = contents.substr(time_end + 1);
+  return true;
+}
+
+// Runs on the FILE thread.
+void WriteStoredDictionary(const FilePath& store_path,
+                           const FilePath& file_name,
+                           const GURL& url,
+                           const base::Time& fetch_time,
+                           const std::string& text) {
+  if (!file_util::CreateDirectory(store_path))
+    return;
+  std::string contents(url.spec() + "\n" +
+                       base::Int64ToString(fetch_time.ToInternalValue()) +
+                       "\n" + text);
+  FilePath path(store_path.Append(file_name));
+  if (file_util::WriteFile(path, contents.data(), contents.size()) !=
+      static_cast<int>(contents.size())) {
+    file_util::Delete(path, false);
+    return;
+  }
+
+  // The SdchManager keeps no more dictionaries than this anyway, so drop the
+  // files that were written longest ago.
+  std::vector<std::pair<base::Time, FilePath> > files;
+  file_util::FileEnumerator enumerator(store_path, false,
+                                       file_util::FileEnumerator::FILES,
+                                       kDictionaryPattern);
+  for (FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    file_util::FileEnumerator::FindInfo info;
+    enumerator.GetFindInfo(&info);
+    files.push_back(std::make_pair(
+        file_util::FileEnumerator::GetLastModifiedTime(info), file));
+  }
+  if (files.size() <= net::SdchManager::kMaxDictionaryCount)
+    return;
+  std::sort(files.begin(), files.end());
+  for (size_t i = 0;
+       i < files.size() - net::SdchManager::kMaxDictionaryCount; ++i) {
+    file_util::Delete(files[i].second, false);
+  }
+}
+
+// Runs on the FILE thread. Files that cannot be parsed are deleted.
+void ReadStoredDictionaries(
+    const FilePath& store_path,
+    std::vector<SdchDictionaryFetcher::StoredDictionary>* dictionaries) {
+  file_util::FileEnumerator enumerator(store_path, false,
+                                       file_util::FileEnumerator::FILES,
+                                       kDictionaryPattern);
+  for (FilePath file = enumerator.Next(); !file.empty();
+       file = enumerator.Next()) {
+    std::string contents;
+    SdchDictionaryFetcher::StoredDictionary dictionary;
+    if (!file_util::ReadFileToString(file, &contents) ||
+        !ParseStoredDictionary(contents, &dictionary.url,
+                               &dictionary.fetch_time, &dictionary.text)) {
+      file_util::Delete(file, false);
+      continue;
+    }
+    dictionary.path = file;
+    dictionaries->push_back(dictionary);
+  }
+}
+
+}  // namespace
+
+SdchDictionaryFetcher::StoredDictionary::StoredDictionary() {
+}
+
+SdchDictionaryFetcher::StoredDictionary::~StoredDictionary() {
+}
+
 SdchDictionaryFetcher::SdchDictionaryFetcher(
-    net::URLRequestContextGetter* context)
+    net::URLRequestContextGetter* context,
+    const FilePath& store_path)
     : ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)),
       task_is_pending_(false),
-      context_(context) {
+      context_(context),
+      store_path_(store_path) {
   DCHECK(CalledOnValidThread());
+  if (store_path_.empty())
+    return;
+  StoredDictionaries* dictionaries = new StoredDictionaries;
+  BrowserThread::PostTaskAndReply(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&ReadStoredDictionaries, store_path_,
+                 base::Unretained(dictionaries)),
+      base::Bind(&SdchDictionaryFetcher::OnStoredDictionariesRead,
+                 weak_factory_.GetWeakPtr(), base::Owned(dictionaries)));
 }
 
 SdchDictionaryFetcher::~SdchDictionaryFetcher() {
@@ -81,8 +201,37 @@ void SdchDictionaryFetcher::OnURLFetchComplete(
       (source->GetStatus().status() == net::URLRequestStatus::SUCCESS)) {
     std::string data;
     source->GetResponseAsString(&data);
-    net::SdchManager::Global()->AddSdchDictionary(data, source->GetURL());
+    if (net::SdchManager::Global()->AddSdchDictionary(data, source->GetURL()) &&
+        !store_path_.empty()) {
+      std::string client_hash;
+      std::string server_hash;
+      net::SdchManager::GenerateHash(data, &client_hash, &server_hash);
+      // Hex, since file names may not be case sensitive.
+      FilePath file_name(FilePath::FromUTF8Unsafe(
+          base::HexEncode(server_hash.data(), server_hash.size())).
+              AddExtension(kDictionaryExtension));
+      BrowserThread::PostTask(
+          BrowserThread::FILE, FROM_HERE,
+          base::Bind(&WriteStoredDictionary, store_path_, file_name,
+                     source->GetURL(), base::Time::Now(), data));
+    }
   }
   current_fetch_.reset(NULL);
   ScheduleDelayedRun();
 }
+
+void SdchDictionaryFetcher::OnStoredDictionariesRead(
+    StoredDictionaries* dictionaries) {
+  DCHECK(CalledOnValidThread());
+  for (StoredDictionaries::const_iterator it = dictionaries->begin();
+       it != dictionaries->end(); ++it) {
+    // Like a downloaded dictionary, a stored one is not fetched again.
+    attempted_load_.insert(it->url);
+    if (!net::SdchManager::Global()->RestoreSdchDictionary(
+            it->text, it->url, it->fetch_time)) {
+      BrowserThread::PostTask(
+          BrowserThread::FILE, FROM_HERE,
+          base::Bind(base::IgnoreResult(&file_util::Delete), it->path, false));
+    }
+  }
+}
@@ -13,10 +13,13 @@
 #include <queue>
 #include <set>
 #include <string>
+#include <vector>
 
+#include "base/file_path.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/time.h"
 #include "content/public/common/url_fetcher_delegate.h"
 #include "net/base/sdch_manager.h"
 
@@ -29,7 +32,23 @@ class SdchDictionaryFetcher
       public net::SdchFetcher,
       public base::NonThreadSafe {
  public:
-  explicit SdchDictionaryFetcher(net::URLRequestContextGetter* context);
+  // A dictionary kept in the store directory.
+  struct StoredDictionary {
+    StoredDictionary();
+    ~StoredDictionary();
+
+    FilePath path;
+    GURL url;
+    base::Time fetch_time;
+    std::string text;
+  };
+  typedef std::vector<StoredDictionary> StoredDictionaries;
+
+  // If |store_path| is not empty, dictionaries are kept in files in that
+  // directory, and the ones found there are loaded at startup, so that they
+  // need not be downloaded again after a restart.
+  SdchDictionaryFetcher(net::URLRequestContextGetter* context,
+                        const FilePath& store_path);
   virtual ~SdchDictionaryFetcher();
 
   // Stop fetching dictionaries, and abandon any current URLFetcheer operations
@@ -59,6 +78,9 @@ class SdchDictionaryFetcher
   // completes (either successfully or with failure).
   virtual void OnURLFetchComplete(const content::URLFetcher* source) OVERRIDE;
 
+  // Hands the dictionaries read from |store_path_| to the SdchManager.
+  void OnStoredDictionariesRead(StoredDictionaries* dictionaries);
+
   // A queue of URLs that are being used to download dictionaries.
   std::queue<GURL> fetch_queue_;
   // The currently outstanding URL fetch of a dicitonary.
@@ -90,6 +112,9 @@ class SdchDictionaryFetcher
   // fetching.
   scoped_refptr<net::URLRequestContextGetter> context_;
 
+  // Where downloaded dictionaries are kept, or empty if they are not.
+  const FilePath store_path_;
+
   DISALLOW_COPY_AND_ASSIGN(SdchDictionaryFetcher);
 };
 
@@ -4,10 +4,14 @@
 
 #include "chrome/browser/net/sqlite_persistent_cookie_store.h"
 
+#include <algorithm>
+#include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/bind.h"
@@ -41,7 +45,8 @@ using content::BrowserThread;
 // delegates to Backend::Load, which posts a Backend::LoadAndNotifyOnDBThread
 // task to the DB thread.  This task calls Backend::ChainLoadCookies(), which
 // repeatedly posts itself to the DB thread to load each eTLD+1's cookies in
-// separate tasks.  When this is complete, Backend::CompleteLoadOnIOThread is
+// separate tasks, starting with the eTLD+1s whose cookies were used most
+// recently.  When this is complete, Backend::CompleteLoadOnIOThread is
 // posted to the IO thread, which notifies the caller of
 // SQLitePersistentCookieStore::Load that the load is complete.
 //
@@ -122,12 +127,15 @@ class SQLitePersistentCookieStore::Backend
 
     OperationType op() const { return op_; }
     const net::CookieMonster::CanonicalCookie& cc() const { return cc_; }
+    void set_cc(const net::CookieMonster::CanonicalCookie& cc) { cc_ = cc; }
 
    private:
     OperationType op_;
     net::CookieMonster::CanonicalCookie cc_;
   };
 
+  typedef std::list<PendingOperation*> PendingOperationsList;
+
  private:
   // Creates or loads the SQLite database on DB thread.
   void LoadAndNotifyOnDBThread(const LoadedCallback& loaded_callback,
@@ -178,6 +186,10 @@ class SQLitePersistentCookieStore::Backend
                       const net::CookieMonster::CanonicalCookie& cc);
   // Commit our pending operations to the database.
   void Commit();
+  // Folds the operations in |ops| that target the same cookie into as few
+  // statements as give the same end result, and deletes the others. Returns
+  // the number of operations removed.
+  static size_t CoalesceOperations(PendingOperationsList* ops);
   // Close() executed on the background thread.
   void InternalBackgroundClose();
 
@@ -187,7 +199,6 @@ class SQLitePersistentCookieStore::Backend
   scoped_ptr<sql::Connection> db_;
   sql::MetaTable meta_table_;
 
-  typedef std::list<PendingOperation*> PendingOperationsList;
   PendingOperationsList pending_;
   PendingOperationsList::size_type num_pending_;
   // True if the persistent store should be deleted upon destruction.
@@ -203,6 +214,12 @@ class SQLitePersistentCookieStore::Backend
   // Map of domain keys(eTLD+1) to domains/hosts that are to be loaded from DB.
   std::map<std::string, std::set<std::string> > keys_to_load_;
 
+  // The domain keys in the order ChainLoadCookies() loads them, most recently
+  // accessed first, since those are the ones likely to be asked for soon.
+  // Keys that were loaded by a priority request are no longer in
+  // |keys_to_load_| and are skipped.
+  std::deque<std::string> keys_in_load_order_;
+
   // Indicates if DB has been initialized.
   bool initialized_;
 
@@ -479,6 +496,12 @@ bool SQLitePersistentCookieStore::Backend::InitializeDatabase() {
   }
 
   db_.reset(new sql::Connection);
+  // Commits are small and frequent, so append them to a write-ahead log and
+  // only sync when it is checkpointed. A power loss may lose the last few
+  // commits, but does not corrupt the database.
+  db_->set_write_ahead_logging();
+  db_->set_synchronous(sql::Connection::SYNCHRONOUS_NORMAL);
+  db_->set_histogram_tag("Cookie");
   if (!db_->Open(path_)) {
     NOTREACHED() << "Unable to open cookie DB.";
     db_.reset();
@@ -501,9 +524,9 @@ bool SQLitePersistentCookieStore::Backend::InitializeDatabase() {
 
   start = base::Time::Now();
 
-  // Retrieve all the domains
+  // Retrieve all the domains, with the time their cookies were last used.
   sql::Statement smt(db_->GetUniqueStatement(
-    "SELECT DISTINCT host_key FROM cookies"));
+    "SELECT host_key, MAX(last_access_utc) FROM cookies GROUP BY host_key"));
 
   if (!smt.is_valid()) {
     db_.reset();
@@ -511,6 +534,7 @@ bool SQLitePersistentCookieStore::Backend::InitializeDatabase() {
   }
 
   // Build a map of domain keys (always eTLD+1) to domains.
+  std::map<std::string, int64> key_last_access;
   while (smt.Step()) {
     std::string domain = smt.ColumnString(0);
     std::string key =
@@ -522,8 +546,21 @@ bool SQLitePersistentCookieStore::Backend::InitializeDatabase() {
       it = keys_to_load_.insert(std::make_pair
                                 (key, std::set<std::string>())).first;
     it->second.insert(domain);
+
+    int64& last_access = key_last_access[key];
+    last_access = std::max(last_access, smt.ColumnInt64(1));
   }
 
+  std::vector<std::pair<int64, std::string> > keys_by_last_access;
+  for (std::map<std::string, int64>::const_iterator it =
+           key_last_access.begin(); it != key_last_access.end(); ++it) {
+    keys_by_last_access.push_back(std::make_pair(it->second, it->first));
+  }
+  std::sort(keys_by_last_access.begin(), keys_by_last_access.end(),
+            std::greater<std::pair<int64, std::string> >());
+  for (size_t i = 0; i < keys_by_last_access.size(); ++i)
+    keys_in_load_order_.push_back(keys_by_last_access[i].second);
+
   UMA_HISTOGRAM_CUSTOM_TIMES(
     "Cookie.TimeInitializeDomainMap",
     base::Time::Now() - start,
@@ -544,12 +581,18 @@ void SQLitePersistentCookieStore::Backend::ChainLoadCookies(
   if (!db_.get()) {
     // Close() has been called on this store.
     load_success = false;
-  } else if (keys_to_load_.size() > 0) {
-    // Load cookies for the first domain key.
-    std::map<std::string, std::set<std::string> >::iterator
-      it = keys_to_load_.begin();
-    load_success = LoadCookiesForDomains(it->second);
-    keys_to_load_.erase(it);
+  } else {
+    // Load cookies for the next domain key that has not been loaded yet.
+    while (!keys_in_load_order_.empty()) {
+      std::map<std::string, std::set<std::string> >::iterator
+        it = keys_to_load_.find(keys_in_load_order_.front());
+      keys_in_load_order_.pop_front();
+      if (it != keys_to_load_.end()) {
+        load_success = LoadCookiesForDomains(it->second);
+        keys_to_load_.erase(it);
+        break;
+      }
+    }
   }
 
   // If load is successful and there are more domain keys to be loaded,
@@ -798,6 +841,13 @@ void SQLitePersistentCookieStore::Backend::Commit() {
   if (!db_.get() || ops.empty())
     return;
 
+  size_t num_ops = ops.size();
+  size_t num_coalesced = CoalesceOperations(&ops);
+  UMA_HISTOGRAM_PERCENTAGE("Cookie.CoalescedOperationsPercent",
+                           static_cast<int>(num_coalesced * 100 / num_ops));
+  if (ops.empty())
+    return;
+
   sql::Statement add_smt(db_->GetCachedStatement(SQL_FROM_HERE,
       "INSERT INTO cookies (creation_utc, host_key, name, value, path, "
       "expires_utc, secure, httponly, last_access_utc, has_expires, "
@@ -869,6 +919,82 @@ void SQLitePersistentCookieStore::Backend::Commit() {
                             succeeded ? 0 : 1, 2);
 }
 
+// static
+size_t SQLitePersistentCookieStore::Backend::CoalesceOperations(
+    PendingOperationsList* ops) {
+  // For each cookie (keyed by its creation time, the primary key of the
+  // table), the last operation kept so far, and whether the batch inserts the
+  // row rather than modifying one that is already in the database.
+  struct CookieOperations {
+    PendingOperationsList::iterator last;
+    bool added_in_batch;
+  };
+  typedef std::map<int64, CookieOperations> CookieOperationsMap;
+  CookieOperationsMap cookies;
+
+  size_t num_removed = 0;
+  PendingOperationsList::iterator it = ops->begin();
+  while (it != ops->end()) {
+    int64 key = (*it)->cc().CreationDate().ToInternalValue();
+    CookieOperationsMap::iterator found = cookies.find(key);
+    if (found == cookies.end()) {
+      CookieOperations cookie_ops = {
+        it, (*it)->op() == PendingOperation::COOKIE_ADD };
+      cookies.insert(std::make_pair(key, cookie_ops));
+      ++it;
+      continue;
+    }
+
+    PendingOperation* previous = *found->second.last;
+    bool keep = true;
+    switch ((*it)->op()) {
+      case PendingOperation::COOKIE_ADD:
+        break;
+
+      case PendingOperation::COOKIE_UPDATEACCESS:
+        // A pending insertion or update can take the new access time itself,
+        // and a deleted row has nothing left to update.
+        if (previous->op() != PendingOperation::COOKIE_DELETE)
+          previous->set_cc((*it)->cc());
+        keep = false;
+        break;
+
+      case PendingOperation::COOKIE_DELETE:
+        if (previous->op() == PendingOperation::COOKIE_DELETE) {
+          keep = false;
+          break;
+        }
+        // Whatever was added or updated is deleted anyway.
+        delete previous;
+        ops->erase(found->second.last);
+        ++num_removed;
+        if (found->second.added_in_batch) {
+          // The row never reaches the database.
+          cookies.erase(found);
+          keep = false;
+        } else {
+          found->second.last = it;
+        }
+        break;
+
+      default:
+        NOTREACHED();
+        break;
+    }
+
+    if (keep) {
+      if ((*it)->op() == PendingOperation::COOKIE_ADD)
+        found->second.last = it;
+      ++it;
+    } else {
+      delete *it;
+      it = ops->erase(it);
+      ++num_removed;
+    }
+  }
+  return num_removed;
+}
+
 void SQLitePersistentCookieStore::Backend::Flush(
     const base::Closure& callback) {
   DCHECK(!BrowserThread::CurrentlyOn(BrowserThread::DB));
@@ -16,6 +16,7 @@
 #include "chrome/common/chrome_constants.h"
 #include "content/test/test_browser_thread.h"
 #include "googleurl/src/gurl.h"
+#include "net/base/registry_controlled_domain.h"
 #include "sql/connection.h"
 #include "sql/meta_table.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -208,6 +209,65 @@ TEST_F(SQLitePersistentCookieStoreTest, TestPersistance) {
   ASSERT_EQ(0U, cookies.size());
 }
 
+// Test that operations on the same cookie within one batch are folded
+// together without changing what ends up on disk.
+TEST_F(SQLitePersistentCookieStoreTest, TestCoalescedOperations) {
+  InitializeStore(false);
+  base::Time creation = base::Time::Now() - base::TimeDelta::FromDays(1);
+  base::Time access = base::Time::Now();
+  net::CookieMonster::CanonicalCookie kept(
+      GURL(), "A", "B", "http://foo.bar", "/", std::string(), std::string(),
+      creation, creation, creation, false, false, true, true);
+  net::CookieMonster::CanonicalCookie kept_accessed(
+      GURL(), "A", "B", "http://foo.bar", "/", std::string(), std::string(),
+      creation, creation, access, false, false, true, true);
+
+  // Added, then accessed: a single insertion with the new access time.
+  store_->AddCookie(kept);
+  store_->UpdateCookieAccessTime(kept_accessed);
+  store_->UpdateCookieAccessTime(kept_accessed);
+  // Added, then deleted: never written.
+  AddCookie("C", "D", "http://foo.bar", "/",
+            creation + base::TimeDelta::FromSeconds(1));
+  AddCookie("E", "F", "http://foo.bar", "/",
+            creation + base::TimeDelta::FromSeconds(2));
+  store_->DeleteCookie(net::CookieMonster::CanonicalCookie(
+      GURL(), "C", "D", "http://foo.bar", "/", std::string(), std::string(),
+      creation + base::TimeDelta::FromSeconds(1),
+      creation + base::TimeDelta::FromSeconds(1),
+      creation + base::TimeDelta::FromSeconds(1), false, false, true, true));
+  DestroyStore();
+
+  std::vector<net::CookieMonster::CanonicalCookie*> cookies;
+  CreateAndLoad(false, &cookies);
+  ASSERT_EQ(2U, cookies.size());
+  std::map<std::string, net::CookieMonster::CanonicalCookie*> cookie_map;
+  for (size_t i = 0; i < cookies.size(); ++i)
+    cookie_map[cookies[i]->Name()] = cookies[i];
+  ASSERT_EQ(1U, cookie_map.count("A"));
+  EXPECT_EQ(access, cookie_map["A"]->LastAccessDate());
+  EXPECT_EQ(1U, cookie_map.count("E"));
+
+  // Deleted, then re-added with the same creation time: the old row is
+  // replaced.
+  store_->DeleteCookie(*cookie_map["A"]);
+  store_->AddCookie(net::CookieMonster::CanonicalCookie(
+      GURL(), "A", "G", "http://foo.bar", "/", std::string(), std::string(),
+      creation, creation, access, false, false, true, true));
+  DestroyStore();
+  STLDeleteContainerPointers(cookies.begin(), cookies.end());
+  cookies.clear();
+
+  CreateAndLoad(false, &cookies);
+  ASSERT_EQ(2U, cookies.size());
+  for (size_t i = 0; i < cookies.size(); ++i) {
+    if (cookies[i]->Name() == "A")
+      EXPECT_EQ("G", cookies[i]->Value());
+  }
+  STLDeleteContainerPointers(cookies.begin(), cookies.end());
+  cookies.clear();
+}
+
 // Test that priority load of cookies for a specfic domain key could be
 // completed before the entire store is loaded
 TEST_F(SQLitePersistentCookieStoreTest, TestLoadCookiesForKey) {
@@ -270,6 +330,34 @@ TEST_F(SQLitePersistentCookieStoreTest, TestLoadCookiesForKey) {
   ASSERT_EQ(cookies_loaded.find("www.bbb.com") != cookies_loaded.end(), true);
 }
 
+// Test that the cookies used most recently are loaded first.
+TEST_F(SQLitePersistentCookieStoreTest, TestLoadOrder) {
+  InitializeStore(false);
+  base::Time t = base::Time::Now();
+  AddCookie("A", "B", "www.aaa.com", "/", t);
+  t += base::TimeDelta::FromInternalValue(10);
+  AddCookie("A", "B", "www.ccc.com", "/", t);
+  t += base::TimeDelta::FromInternalValue(10);
+  AddCookie("A", "B", "www.bbb.com", "/", t);
+  t += base::TimeDelta::FromInternalValue(10);
+  AddCookie("C", "D", "travel.aaa.com", "/", t);
+  DestroyStore();
+
+  std::vector<net::CookieMonster::CanonicalCookie*> cookies;
+  CreateAndLoad(false, &cookies);
+  ASSERT_EQ(4U, cookies.size());
+  // The cookies of a domain key are loaded together.
+  EXPECT_EQ("aaa.com",
+      net::RegistryControlledDomainService::GetDomainAndRegistry(
+          cookies[0]->Domain()));
+  EXPECT_EQ("aaa.com",
+      net::RegistryControlledDomainService::GetDomainAndRegistry(
+          cookies[1]->Domain()));
+  EXPECT_EQ("www.bbb.com", cookies[2]->Domain());
+  EXPECT_EQ("www.ccc.com", cookies[3]->Domain());
+  STLDeleteContainerPointers(cookies.begin(), cookies.end());
+}
+
 // Test that we can force the database to be written by calling Flush().
 TEST_F(SQLitePersistentCookieStoreTest, TestFlush) {
   InitializeStore(false);
@@ -10,6 +10,7 @@
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/command_line.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram.h"
 #include "base/process.h"
@@ -135,6 +136,7 @@ void OomMemoryDetails::OnDetailsAvailable() {
 OomPriorityManager::TabStats::TabStats()
   : is_pinned(false),
     is_selected(false),
+    is_discarded(false),
     renderer_handle(0),
     sudden_termination_allowed(false),
     tab_contents_id(0) {
@@ -208,10 +210,13 @@ bool OomPriorityManager::DiscardTab() {
   TabStatsList stats = GetTabStatsOnUIThread();
   if (stats.empty())
     return false;
-  // Loop until we find a non-discarded tab to kill.
+  // Loop until we find a non-discarded tab to kill. Skip the tabs we already
+  // know to be discarded, as looking each of them up walks every tab strip.
   for (TabStatsList::const_reverse_iterator stats_rit = stats.rbegin();
        stats_rit != stats.rend();
        ++stats_rit) {
+    if (stats_rit->is_discarded)
+      continue;
     int64 least_important_tab_id = stats_rit->tab_contents_id;
     if (DiscardTabById(least_important_tab_id))
       return true;
@@ -241,7 +246,7 @@ bool OomPriorityManager::DiscardTabById(int64 target_web_contents_id) {
             << " id " << target_web_contents_id;
         // Record statistics before discarding because we want to capture the
         // memory state that lead to the discard.
-        RecordDiscardStatistics();
+        RecordDiscardStatistics(web_contents);
         model->DiscardTabContentsAt(idx);
         return true;
       }
@@ -250,7 +255,7 @@ bool OomPriorityManager::DiscardTabById(int64 target_web_contents_id) {
   return false;
 }
 
-void OomPriorityManager::RecordDiscardStatistics() {
+void OomPriorityManager::RecordDiscardStatistics(WebContents* web_contents) {
   // Record a raw count so we can compare to discard reloads.
   discard_count_++;
   EXPERIMENT_CUSTOM_COUNTS("Tabs.Discard.DiscardCount",
@@ -285,6 +290,18 @@ void OomPriorityManager::RecordDiscardStatistics() {
     EXPERIMENT_HISTOGRAM_MEGABYTES("Tabs.Discard.MemAvailableMB",
                                    mem_available_mb);
   }
+  // Record the memory the discard gives back, which is the private memory of
+  // the renderer if no other tab shares it.
+  content::RenderProcessHost* renderer = web_contents->GetRenderProcessHost();
+  if (GetTabCountForRenderer(renderer) == 1) {
+    scoped_ptr<ProcessMetrics> metrics(
+        ProcessMetrics::CreateProcessMetrics(renderer->GetHandle()));
+    base::WorkingSetKBytes working_set;
+    if (metrics->GetWorkingSetKBytes(&working_set)) {
+      EXPERIMENT_HISTOGRAM_MEGABYTES("Tabs.Discard.ReclaimedMB",
+                                     static_cast<int>(working_set.priv / 1024));
+    }
+  }
   // Set up to record the next interval.
   last_discard_time_ = TimeTicks::Now();
 }
@@ -299,6 +316,21 @@ int OomPriorityManager::GetTabCount() const {
   return tab_count;
 }
 
+int OomPriorityManager::GetTabCountForRenderer(
+    content::RenderProcessHost* renderer) const {
+  int tab_count = 0;
+  for (BrowserList::const_iterator browser_it = BrowserList::begin();
+      browser_it != BrowserList::end(); ++browser_it) {
+    TabStripModel* model = (*browser_it)->tabstrip_model();
+    for (int i = 0; i < model->count(); i++) {
+      WebContents* contents = model->GetTabContentsAt(i)->web_contents();
+      if (contents->GetRenderProcessHost() == renderer)
+        tab_count++;
+    }
+  }
+  return tab_count;
+}
+
 // Returns true if |first| is considered less desirable to be killed
 // than |second|.
 bool OomPriorityManager::CompareTabStats(TabStats first,
@@ -436,6 +468,7 @@ OomPriorityManager::TabStatsList OomPriorityManager::GetTabStatsOnUIThread() {
         TabStats stats;
         stats.is_pinned = model->IsTabPinned(i);
         stats.is_selected = model->IsTabSelected(i);
+        stats.is_discarded = model->IsTabDiscarded(i);
         stats.last_selected = contents->GetLastSelectedTime();
         stats.renderer_handle = contents->GetRenderProcessHost()->GetHandle();
         stats.sudden_termination_allowed =
@@ -20,6 +20,11 @@
 #include "content/public/browser/notification_observer.h"
 #include "content/public/browser/notification_registrar.h"
 
+namespace content {
+class RenderProcessHost;
+class WebContents;
+}
+
 namespace browser {
 
 class LowMemoryObserver;
@@ -63,6 +68,7 @@ class OomPriorityManager : public content::NotificationObserver {
     ~TabStats();
     bool is_pinned;
     bool is_selected;
+    bool is_discarded;
     base::TimeTicks last_selected;
     base::ProcessHandle renderer_handle;
     bool sudden_termination_allowed;
@@ -76,12 +82,16 @@ class OomPriorityManager : public content::NotificationObserver {
 
   // Records UMA histogram statistics for a tab discard. We record statistics
   // for user triggered discards via chrome://discards/ because that allows us
-  // to manually test the system.
-  void RecordDiscardStatistics();
+  // to manually test the system. |web_contents| is the tab being discarded.
+  void RecordDiscardStatistics(content::WebContents* web_contents);
 
   // Returns the number of tabs open in all browser instances.
   int GetTabCount() const;
 
+  // Returns the number of tabs in all browser instances rendered by
+  // |renderer|.
+  int GetTabCountForRenderer(content::RenderProcessHost* renderer) const;
+
   TabStatsList GetTabStatsOnUIThread();
 
   // Called when the timer fires, sets oom_adjust_score for all renderers.
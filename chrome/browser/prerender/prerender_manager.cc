@@ -19,6 +19,7 @@
 #include "chrome/browser/cancelable_request.h"
 #include "chrome/browser/favicon/favicon_tab_helper.h"
 #include "chrome/browser/history/top_sites.h"
+#include "chrome/browser/net/predictor.h"
 #include "chrome/browser/prerender/prerender_condition.h"
 #include "chrome/browser/prerender/prerender_contents.h"
 #include "chrome/browser/prerender/prerender_field_trial.h"
@@ -879,6 +880,7 @@ bool PrerenderManager::AddPrerender(
           profile_, url) &&
       !content::RenderProcessHost::run_renderer_in_process()) {
     RecordFinalStatus(origin, experiment, FINAL_STATUS_TOO_MANY_PROCESSES);
+    PreconnectInsteadOfPrerender(url);
     return false;
   }
 #endif
@@ -889,6 +891,7 @@ bool PrerenderManager::AddPrerender(
     // this doesn't make sense as the next prerender request will be triggered
     // by a navigation and is unlikely to be the same site.
     RecordFinalStatus(origin, experiment, FINAL_STATUS_RATE_LIMIT_EXCEEDED);
+    PreconnectInsteadOfPrerender(url);
     return false;
   }
 
@@ -1123,6 +1126,16 @@ bool PrerenderManager::DoesRateLimitAllowPrerender() const {
       base::TimeDelta::FromMilliseconds(kMinTimeBetweenPrerendersMs);
 }
 
+void PrerenderManager::PreconnectInsteadOfPrerender(const GURL& url) {
+  DCHECK(CalledOnValidThread());
+  // The control group must not get any of the benefit of prerendering.
+  if (IsControlGroup())
+    return;
+  chrome_browser_net::Predictor* predictor = profile_->GetNetworkPredictor();
+  if (predictor)
+    predictor->PreconnectUrlAndSubresources(url);
+}
+
 void PrerenderManager::DeleteOldTabContents() {
   while (!old_tab_contents_list_.empty()) {
     TabContentsWrapper* tab_contents = old_tab_contents_list_.front();
@@ -354,6 +354,12 @@ class PrerenderManager : public base::SupportsWeakPtr<PrerenderManager>,
 
   bool DoesRateLimitAllowPrerender() const;
 
+  // Called when |url| can't be prerendered because of the number of render
+  // processes or the rate limit. Preconnects to |url| and the subresources
+  // the network predictor has learned for it instead, which warms up the
+  // navigation without the cost of a renderer.
+  void PreconnectInsteadOfPrerender(const GURL& url);
+
   // Deletes old WebContents that have been replaced by prerendered ones.  This
   // is needed because they're replaced in a callback from the old WebContents,
   // so cannot immediately be deleted.
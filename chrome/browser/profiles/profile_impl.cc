@@ -82,6 +82,7 @@
 #include "content/public/browser/notification_service.h"
 #include "content/public/browser/user_metrics.h"
 #include "grit/chromium_strings.h"
+#include "sql/connection.h"
 #include "ui/base/l10n/l10n_util.h"
 
 #if defined(OS_WIN)
@@ -150,6 +151,25 @@ FilePath GetMediaCachePath(const FilePath& base) {
   return base.Append(chrome::kMediaCacheDirname);
 }
 
+// Databases that are opened at startup, in the order they are usually opened,
+// and how much of each is worth reading ahead of time.
+const struct {
+  const FilePath::CharType* file_name;
+  int64 max_bytes;
+} kStartupDatabases[] = {
+  { chrome::kCookieFilename, 4 * 1024 * 1024 },
+  { chrome::kHistoryFilename, 16 * 1024 * 1024 },
+  { chrome::kFaviconsFilename, 4 * 1024 * 1024 },
+  { chrome::kWebDataFilename, 4 * 1024 * 1024 },
+};
+
+void PreloadStartupDatabases(const FilePath& base) {
+  for (size_t i = 0; i < arraysize(kStartupDatabases); ++i) {
+    sql::Connection::PrefetchFile(base.Append(kStartupDatabases[i].file_name),
+                                  kStartupDatabases[i].max_bytes);
+  }
+}
+
 void EnsureReadmeFile(const FilePath& base) {
   FilePath readme_path = base.Append(chrome::kReadmeFilename);
   if (file_util::PathExists(readme_path))
@@ -290,6 +310,14 @@ void ProfileImpl::DoFinalInit(bool is_new_profile) {
       BrowserThread::FILE, FROM_HERE,
       base::Bind(&CreateDirectoryNoResult, base_cache_path_));
 
+  if (CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kPreloadProfileDatabases)) {
+    // Use the blocking pool rather than the FILE thread, which is busy at
+    // startup with work that other things wait on.
+    BrowserThread::PostBlockingPoolTask(
+        FROM_HERE, base::Bind(&PreloadStartupDatabases, GetPath()));
+  }
+
   // Now that the profile is hooked up to receive pref change notifications to
   // kGoogleServicesUsername, initialize components that depend on it to reflect
   // the current value.
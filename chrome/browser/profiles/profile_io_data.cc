@@ -54,6 +54,7 @@
 #include "net/proxy/proxy_script_fetcher_impl.h"
 #include "net/proxy/proxy_service.h"
 #include "net/url_request/url_request.h"
+#include "net/url_request/url_request_coalescer.h"
 
 #if defined(OS_CHROMEOS)
 #include "chrome/browser/chromeos/cros_settings.h"
@@ -520,6 +521,18 @@ void ProfileIOData::LazyInitialize() const {
       chrome::kChromeDevToolsScheme,
       CreateDevToolsProtocolHandler(chrome_url_data_manager_backend_.get()));
   DCHECK(set_protocol);
+  if (command_line.HasSwitch(switches::kEnableRequestCoalescing)) {
+    scoped_refptr<net::URLRequestCoalescer> coalescer(
+        new net::URLRequestCoalescer);
+    set_protocol = job_factory_->SetProtocolHandler(
+        chrome::kHttpScheme,
+        net::URLRequestCoalescer::CreateProtocolHandler(coalescer, NULL));
+    DCHECK(set_protocol);
+    set_protocol = job_factory_->SetProtocolHandler(
+        chrome::kHttpsScheme,
+        net::URLRequestCoalescer::CreateProtocolHandler(coalescer, NULL));
+    DCHECK(set_protocol);
+  }
 #if defined(OS_CHROMEOS) && !defined(GOOGLE_CHROME_BUILD)
   // Install the GView request interceptor that will redirect requests
   // of compatible documents (PDF, etc) to the GView document viewer.
@@ -110,6 +110,10 @@ PrefixSet::PrefixSet(std::vector<std::pair<SBPrefix,size_t> > *index,
   DCHECK(index && deltas);
   index_.swap(*index);
   deltas_.swap(*deltas);
+
+  // The file's digest already vouches for the data, so take the checksum
+  // from what was read for |CheckChecksum()| to compare against later.
+  checksum_ = ComputeChecksum();
 }
 
 PrefixSet::~PrefixSet() {}
@@ -352,6 +356,10 @@ uint16 PrefixSet::DeltaAt(size_t target_index) const {
 }
 
 bool PrefixSet::CheckChecksum() const {
+  return ComputeChecksum() == checksum_;
+}
+
+uint32 PrefixSet::ComputeChecksum() const {
   uint32 checksum = 0;
 
   for (size_t ii = 0; ii < index_.size(); ++ii) {
@@ -363,7 +371,7 @@ bool PrefixSet::CheckChecksum() const {
     checksum ^= static_cast<uint32>(deltas_[di]);
   }
 
-  return checksum == checksum_;
+  return checksum;
 }
 
 }  // namespace safe_browsing
@@ -105,6 +105,9 @@ class PrefixSet {
   PrefixSet(std::vector<std::pair<SBPrefix,size_t> > *index,
             std::vector<uint16> *deltas);
 
+  // The checksum of |index_| and |deltas_| as they are now.
+  uint32 ComputeChecksum() const;
+
   // Top-level index of prefix to offset in |deltas_|.  Each pair
   // indicates a base prefix and where the deltas from that prefix
   // begin in |deltas_|.  The deltas for a pair end at the next pair's
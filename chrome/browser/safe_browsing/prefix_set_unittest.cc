@@ -317,6 +317,7 @@ TEST_F(PrefixSetTest, ReadWrite) {
   ASSERT_TRUE(prefix_set.get());
 
   CheckPrefixes(prefix_set.get(), shared_prefixes_);
+  EXPECT_TRUE(prefix_set->CheckChecksum());
 }
 
 // Check that |CleanChecksum()| makes an acceptable checksum.
@@ -31,6 +31,8 @@ namespace {
 
 // Filename suffix for the bloom filter.
 const FilePath::CharType kBloomFilterFile[] = FILE_PATH_LITERAL(" Filter 2");
+// Filename suffix for the prefix set.
+const FilePath::CharType kPrefixSetFile[] = FILE_PATH_LITERAL(" Prefix Set");
 // Filename suffix for download store.
 const FilePath::CharType kDownloadDBFile[] = FILE_PATH_LITERAL(" Download");
 // Filename suffix for client-side phishing detection whitelist store.
@@ -458,6 +460,12 @@ FilePath SafeBrowsingDatabase::BloomFilterForFilename(
   return FilePath(db_filename.value() + kBloomFilterFile);
 }
 
+// static
+FilePath SafeBrowsingDatabase::PrefixSetForFilename(
+    const FilePath& db_filename) {
+  return FilePath(db_filename.value() + kPrefixSetFile);
+}
+
 // static
 FilePath SafeBrowsingDatabase::CsdWhitelistDBFilename(
     const FilePath& db_filename) {
@@ -533,6 +541,7 @@ void SafeBrowsingDatabaseNew::Init(const FilePath& filename_base) {
 
   browse_filename_ = BrowseDBFilename(filename_base);
   bloom_filter_filename_ = BloomFilterForFilename(browse_filename_);
+  prefix_set_filename_ = PrefixSetForFilename(browse_filename_);
 
   browse_store_->Init(
       browse_filename_,
@@ -1379,8 +1388,21 @@ void SafeBrowsingDatabaseNew::LoadBloomFilter() {
   if (!browse_bloom_filter_.get())
     RecordFailure(FAILURE_DATABASE_FILTER_READ);
 
-  // Manually re-generate the prefix set from the main database.
-  // TODO(shess): Write/read for prefix set.
+  // The prefix set is written along with the bloom filter, so it matches
+  // the main database unless it is missing or damaged.  Only then is it
+  // re-generated from the main database, which means reading every add
+  // prefix in it.
+  if (file_util::PathExists(prefix_set_filename_)) {
+    const base::TimeTicks before_prefix_set = base::TimeTicks::Now();
+    prefix_set_.reset(safe_browsing::PrefixSet::LoadFile(prefix_set_filename_));
+    DVLOG(1) << "SafeBrowsingDatabaseNew read prefix set in "
+             << (base::TimeTicks::Now() - before_prefix_set).InMilliseconds()
+             << " ms";
+    if (prefix_set_.get())
+      return;
+    RecordFailure(FAILURE_DATABASE_PREFIX_SET_READ);
+  }
+
   SBAddPrefixes add_prefixes;
   browse_store_->GetAddPrefixes(&add_prefixes);
   prefix_set_.reset(PrefixSetFromAddPrefixes(add_prefixes));
@@ -1410,7 +1432,11 @@ bool SafeBrowsingDatabaseNew::Delete() {
   const bool r5 = file_util::Delete(bloom_filter_filename_, false);
   if (!r5)
     RecordFailure(FAILURE_DATABASE_FILTER_DELETE);
-  return r1 && r2 && r3 && r4 && r5;
+
+  const bool r6 = file_util::Delete(prefix_set_filename_, false);
+  if (!r6)
+    RecordFailure(FAILURE_DATABASE_PREFIX_SET_DELETE);
+  return r1 && r2 && r3 && r4 && r5 && r6;
 }
 
 void SafeBrowsingDatabaseNew::WriteBloomFilter() {
@@ -1430,6 +1456,28 @@ void SafeBrowsingDatabaseNew::WriteBloomFilter() {
 #if defined(OS_MACOSX)
   base::mac::SetFileBackupExclusion(bloom_filter_filename_);
 #endif
+
+  // A prefix set file which does not match the main database must not be
+  // left behind, so it is deleted if it cannot be written.  An empty set is
+  // not written at all, it is cheap to re-generate.
+  bool prefix_set_ok = false;
+  if (prefix_set_.get() && prefix_set_->GetSize()) {
+    const base::TimeTicks before_prefix_set = base::TimeTicks::Now();
+    prefix_set_ok = prefix_set_->WriteFile(prefix_set_filename_);
+    DVLOG(1) << "SafeBrowsingDatabaseNew wrote prefix set in "
+             << (base::TimeTicks::Now() - before_prefix_set).InMilliseconds()
+             << " ms";
+    if (!prefix_set_ok)
+      RecordFailure(FAILURE_DATABASE_PREFIX_SET_WRITE);
+  }
+  if (!prefix_set_ok) {
+    file_util::Delete(prefix_set_filename_, false);
+    return;
+  }
+
+#if defined(OS_MACOSX)
+  base::mac::SetFileBackupExclusion(prefix_set_filename_);
+#endif
 }
 
 void SafeBrowsingDatabaseNew::WhitelistEverything(SBWhitelist* whitelist) {
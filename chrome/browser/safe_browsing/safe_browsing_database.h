@@ -159,6 +159,9 @@ class SafeBrowsingDatabase {
   // The name of the bloom-filter file for the given database file.
   static FilePath BloomFilterForFilename(const FilePath& db_filename);
 
+  // The name of the prefix set file for the given database file.
+  static FilePath PrefixSetForFilename(const FilePath& db_filename);
+
   // Filename for malware and phishing URL database.
   static FilePath BrowseDBFilename(const FilePath& db_base_filename);
 
@@ -190,6 +193,9 @@ class SafeBrowsingDatabase {
     FAILURE_DOWNLOAD_DATABASE_UPDATE_FINISH,
     FAILURE_WHITELIST_DATABASE_UPDATE_BEGIN,
     FAILURE_WHITELIST_DATABASE_UPDATE_FINISH,
+    FAILURE_DATABASE_PREFIX_SET_READ,
+    FAILURE_DATABASE_PREFIX_SET_WRITE,
+    FAILURE_DATABASE_PREFIX_SET_DELETE,
     // Memory space for histograms is determined by the max.  ALWAYS
     // ADD NEW VALUES BEFORE THIS ONE.
     FAILURE_DATABASE_MAX
@@ -268,10 +274,11 @@ class SafeBrowsingDatabaseNew : public SafeBrowsingDatabase {
     // Deletes the files on disk.
   bool Delete();
 
-  // Load the bloom filter off disk, or generates one if it doesn't exist.
+  // Load the bloom filter and prefix set off disk, or generates them if they
+  // don't exist.
   void LoadBloomFilter();
 
-  // Writes the current bloom filter to disk.
+  // Writes the current bloom filter and prefix set to disk.
   void WriteBloomFilter();
 
   // Loads the given full-length hashes to the given whitelist.  If the number
@@ -377,7 +384,10 @@ class SafeBrowsingDatabaseNew : public SafeBrowsingDatabase {
   // Used to optimize away database update.
   bool change_detected_;
 
-  // Used to check if a prefix was in the database.
+  // Used to check if a prefix was in the database.  It is written to
+  // |prefix_set_filename_| along with the bloom filter, so that startup
+  // does not need to read every add prefix out of |browse_store_|.
+  FilePath prefix_set_filename_;
   scoped_ptr<safe_browsing::PrefixSet> prefix_set_;
 };
 
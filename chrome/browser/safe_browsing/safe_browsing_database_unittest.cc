@@ -1585,3 +1585,41 @@ TEST_F(SafeBrowsingDatabaseTest, EmptyUpdate) {
   ASSERT_TRUE(file_util::GetFileInfo(filename, &after_info));
   EXPECT_EQ(before_info.last_modified, after_info.last_modified);
 }
+
+// The prefix set is written out with each update and read back when the
+// database is opened, rather than re-generated from the add prefixes.
+TEST_F(SafeBrowsingDatabaseTest, PrefixSetFile) {
+  SBChunkList chunks;
+  SBChunk chunk;
+
+  FilePath filename = database_->PrefixSetForFilename(
+      database_->BrowseDBFilename(database_filename_));
+
+  std::vector<SBListChunkRanges> lists;
+  EXPECT_TRUE(database_->UpdateStarted(&lists));
+  InsertAddChunkHostPrefixUrl(&chunk, 1, "www.evil.com/",
+                              "www.evil.com/malware.html");
+  chunks.push_back(chunk);
+  database_->InsertChunks(safe_browsing_util::kMalwareList, chunks);
+  database_->UpdateFinished(true);
+  EXPECT_TRUE(file_util::PathExists(filename));
+
+  // Re-open the database.
+  database_.reset(new SafeBrowsingDatabaseNew);
+  database_->Init(database_filename_);
+
+  std::string matching_list;
+  std::vector<SBPrefix> prefix_hits;
+  std::vector<SBFullHashResult> full_hashes;
+  const base::Time now = base::Time::Now();
+  EXPECT_TRUE(database_->ContainsBrowseUrl(
+      GURL("http://www.evil.com/malware.html"),
+      &matching_list, &prefix_hits, &full_hashes, now));
+  EXPECT_FALSE(database_->ContainsBrowseUrl(
+      GURL("http://www.evil.com/notevil.html"),
+      &matching_list, &prefix_hits, &full_hashes, now));
+
+  // Resetting the database removes the file.
+  EXPECT_TRUE(database_->ResetDatabase());
+  EXPECT_FALSE(file_util::PathExists(filename));
+}
@@ -4,6 +4,10 @@
 
 #include "chrome/browser/safe_browsing/safe_browsing_store_file.h"
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "base/md5.h"
 #include "base/metrics/histogram.h"
 
@@ -81,6 +85,11 @@ bool WriteItem(const T& item, FILE* fp, base::MD5Context* context) {
   return true;
 }
 
+// The number of items |ReadToContainer()| and |WriteContainer()| move
+// per stdio call.  Going through stdio and MD5 an item at a time made
+// them the bulk of the CPU cost of an update.
+const size_t kIOBatchItems = 1024;
+
 // Read |count| items into |values| from |fp|, and fold them into the
 // checksum in |context|.  Returns true on success.
 template <typename CT>
@@ -89,14 +98,23 @@ bool ReadToContainer(CT* values, size_t count, FILE* fp,
   if (!count)
     return true;
 
-  for (size_t i = 0; i < count; ++i) {
-    typename CT::value_type value;
-    if (!ReadItem(&value, fp, context))
+  std::vector<typename CT::value_type> batch;
+  while (count) {
+    batch.resize(std::min(count, kIOBatchItems));
+    const size_t ret = fread(&batch[0], sizeof(batch[0]), batch.size(), fp);
+    if (ret != batch.size())
       return false;
 
-    // push_back() is more obvious, but coded this way std::set can
-    // also be read.
-    values->insert(values->end(), value);
+    if (context) {
+      base::MD5Update(context,
+                      base::StringPiece(reinterpret_cast<char*>(&batch[0]),
+                                        batch.size() * sizeof(batch[0])));
+    }
+
+    // Appending with an inserter lets std::set be read, too.
+    std::copy(batch.begin(), batch.end(),
+              std::inserter(*values, values->end()));
+    count -= batch.size();
   }
 
   return true;
@@ -110,10 +128,24 @@ bool WriteContainer(const CT& values, FILE* fp,
   if (values.empty())
     return true;
 
+  std::vector<typename CT::value_type> batch;
+  batch.reserve(std::min(values.size(), kIOBatchItems));
   for (typename CT::const_iterator iter = values.begin();
-       iter != values.end(); ++iter) {
-    if (!WriteItem(*iter, fp, context))
+       iter != values.end();) {
+    batch.clear();
+    for (; iter != values.end() && batch.size() < kIOBatchItems; ++iter)
+      batch.push_back(*iter);
+
+    const size_t ret = fwrite(&batch[0], sizeof(batch[0]), batch.size(), fp);
+    if (ret != batch.size())
       return false;
+
+    if (context) {
+      base::MD5Update(context,
+                      base::StringPiece(
+                          reinterpret_cast<const char*>(&batch[0]),
+                          batch.size() * sizeof(batch[0])));
+    }
   }
   return true;
 }
@@ -193,4 +193,42 @@ TEST_F(SafeBrowsingStoreFileTest, CheckValidityChecksum) {
   EXPECT_TRUE(store_->CancelUpdate());
 }
 
+// Stores more items than are read or written in one batch, and makes
+// sure they all survive being written out and read back in.
+TEST_F(SafeBrowsingStoreFileTest, ManyPrefixes) {
+  const int32 kAddChunk = 1;
+  const SBPrefix kPrefixCount = 2500;
+
+  std::vector<SBAddFullHash> pending_adds;
+  std::set<SBPrefix> prefix_misses;
+  SBAddPrefixes add_prefixes_result;
+  std::vector<SBAddFullHash> add_full_hashes_result;
+
+  ASSERT_TRUE(store_->BeginUpdate());
+  EXPECT_TRUE(store_->BeginChunk());
+  store_->SetAddChunk(kAddChunk);
+  for (SBPrefix i = 0; i < kPrefixCount; ++i)
+    EXPECT_TRUE(store_->WriteAddPrefix(kAddChunk, i * 7));
+  EXPECT_TRUE(store_->FinishChunk());
+  EXPECT_TRUE(store_->FinishUpdate(pending_adds, prefix_misses,
+                                   &add_prefixes_result,
+                                   &add_full_hashes_result));
+  EXPECT_EQ(static_cast<size_t>(kPrefixCount), add_prefixes_result.size());
+
+  // An update with no new chunks reads the same prefixes back.
+  add_prefixes_result.clear();
+  ASSERT_TRUE(store_->BeginUpdate());
+  EXPECT_TRUE(store_->CheckValidity());
+  EXPECT_TRUE(store_->CheckAddChunk(kAddChunk));
+  EXPECT_TRUE(store_->FinishUpdate(pending_adds, prefix_misses,
+                                   &add_prefixes_result,
+                                   &add_full_hashes_result));
+  ASSERT_EQ(static_cast<size_t>(kPrefixCount), add_prefixes_result.size());
+  for (SBPrefix i = 0; i < kPrefixCount; ++i) {
+    EXPECT_EQ(kAddChunk, add_prefixes_result[i].chunk_id);
+    EXPECT_EQ(i * 7, add_prefixes_result[i].prefix);
+  }
+  EXPECT_FALSE(corruption_detected_);
+}
+
 }  // namespace
@@ -18,6 +18,7 @@
 #include "base/platform_file.h"
 #include "base/stl_util.h"
 #include "base/stringprintf.h"
+#include "base/sys_info.h"
 #include "chrome/browser/browser_process.h"
 #include "chrome/browser/extensions/extension_service.h"
 #include "chrome/browser/profiles/profile.h"
@@ -66,11 +67,23 @@ std::set<SessionRestoreImpl*>* active_session_restorers = NULL;
 // Initial delay (see class decription for details).
 static const int kInitialDelayTimerMS = 100;
 
+// Bounds on the number of tabs loaded at once, and the physical memory
+// assumed to be needed by each of them (see class description for details).
+static const size_t kMinParallelTabLoads = 2;
+static const size_t kMaxParallelTabLoads = 8;
+static const int kMemoryPerTabLoadMB = 256;
+
 // TabLoader is responsible for loading tabs after session restore creates
 // tabs. New tabs are loaded after the current tab finishes loading, or a delay
 // is reached (initially kInitialDelayTimerMS). If the delay is reached before
 // a tab finishes loading a new tab is loaded and the time of the delay
-// doubled.
+// doubled. Tabs that finish loading start the next one only while fewer than
+// |max_parallel_tab_loads_allowed_| tabs are loading; that limit is derived
+// from the number of processors and the amount of physical memory, so that
+// restoring a large session on a small machine doesn't start every renderer at
+// the same time. The delay timer keeps running at the limit, and starts one
+// more tab each time it fires, so tabs that never stop loading don't hold up
+// the rest of the session.
 //
 // TabLoader keeps a reference to itself when it's loading. When it has finished
 // loading, it drops the reference. If another profile is restored while the
@@ -110,10 +123,18 @@ class TabLoader : public content::NotificationObserver,
   explicit TabLoader(base::TimeTicks restore_started);
   virtual ~TabLoader();
 
-  // Loads the next tab. If there are no more tabs to load this deletes itself,
-  // otherwise |force_load_timer_| is restarted.
+  // Loads the next tab, unless |max_parallel_tab_loads_allowed_| tabs are
+  // already loading. If there are more tabs to load |force_load_timer_| is
+  // restarted.
   void LoadNextTab();
 
+  // Starts loading the first tab in |tabs_to_load_|, if any, regardless of how
+  // many tabs are loading.
+  void StartNextTabLoad();
+
+  // Restarts |force_load_timer_| if there are more tabs to load.
+  void RestartForceLoadTimer();
+
   // NotificationObserver method. Removes the specified tab and loads the next
   // tab.
   virtual void Observe(int type,
@@ -128,10 +149,14 @@ class TabLoader : public content::NotificationObserver,
   // from.
   void RemoveTab(NavigationController* tab);
 
-  // Invoked from |force_load_timer_|. Doubles |force_load_delay_| and invokes
-  // |LoadNextTab| to load the next tab
+  // Invoked from |force_load_timer_|. Doubles |force_load_delay_| and loads the
+  // next tab, even if |max_parallel_tab_loads_allowed_| tabs are loading.
   void ForceLoadTimerFired();
 
+  // Returns the number of tabs that may be loading at once on this machine,
+  // or SessionRestore::max_parallel_tab_loads_ if that is non-zero.
+  static size_t ComputeMaxParallelTabLoads();
+
   // Returns the RenderWidgetHost associated with a tab if there is one,
   // NULL otherwise.
   static RenderWidgetHost* GetRenderWidgetHost(NavigationController* tab);
@@ -178,6 +203,9 @@ class TabLoader : public content::NotificationObserver,
   // Max number of tabs that were loaded in parallel (for metrics).
   size_t max_parallel_tab_loads_;
 
+  // Max number of tabs LoadNextTab lets load in parallel.
+  const size_t max_parallel_tab_loads_allowed_;
+
   // For keeping TabLoader alive while it's loading even if no
   // SessionRestoreImpls reference it.
   scoped_refptr<TabLoader> this_retainer_;
@@ -240,7 +268,8 @@ TabLoader::TabLoader(base::TimeTicks restore_started)
       got_first_paint_(false),
       tab_count_(0),
       restore_started_(restore_started),
-      max_parallel_tab_loads_(0) {
+      max_parallel_tab_loads_(0),
+      max_parallel_tab_loads_allowed_(ComputeMaxParallelTabLoads()) {
 }
 
 TabLoader::~TabLoader() {
@@ -251,6 +280,14 @@ TabLoader::~TabLoader() {
 }
 
 void TabLoader::LoadNextTab() {
+  // Once the limit is reached the next tab is loaded when one of the loading
+  // tabs stops loading or is closed, or when |force_load_timer_| fires.
+  if (tabs_loading_.size() < max_parallel_tab_loads_allowed_)
+    StartNextTabLoad();
+  RestartForceLoadTimer();
+}
+
+void TabLoader::StartNextTabLoad() {
   if (!tabs_to_load_.empty()) {
     NavigationController* tab = tabs_to_load_.front();
     DCHECK(tab);
@@ -274,7 +311,9 @@ void TabLoader::LoadNextTab() {
       }
     }
   }
+}
 
+void TabLoader::RestartForceLoadTimer() {
   if (!tabs_to_load_.empty()) {
     force_load_timer_.Stop();
     // Each time we load a tab we also set a timer to force us to start loading
@@ -400,7 +439,20 @@ void TabLoader::RemoveTab(NavigationController* tab) {
 
 void TabLoader::ForceLoadTimerFired() {
   force_load_delay_ *= 2;
-  LoadNextTab();
+  StartNextTabLoad();
+  RestartForceLoadTimer();
+}
+
+// static
+size_t TabLoader::ComputeMaxParallelTabLoads() {
+  if (SessionRestore::max_parallel_tab_loads_)
+    return SessionRestore::max_parallel_tab_loads_;
+  size_t limit = static_cast<size_t>(std::max(
+      1, std::min(base::SysInfo::NumberOfProcessors(),
+                  base::SysInfo::AmountOfPhysicalMemoryMB() /
+                      kMemoryPerTabLoadMB)));
+  return std::max(kMinParallelTabLoads,
+                  std::min(kMaxParallelTabLoads, limit));
 }
 
 RenderWidgetHost* TabLoader::GetRenderWidgetHost(NavigationController* tab) {
@@ -1011,6 +1063,9 @@ class SessionRestoreImpl : public content::NotificationObserver {
 
 // SessionRestore -------------------------------------------------------------
 
+// static
+size_t SessionRestore::max_parallel_tab_loads_ = 0;
+
 // static
 Browser* SessionRestore::RestoreSession(Profile* profile,
                                         Browser* browser,
@@ -64,6 +64,11 @@ class SessionRestore {
   // a session. A value of 0 indicates all tabs are loaded at once.
   static size_t num_tabs_to_load_;
 
+  // The max number of tabs SessionRestore starts loading before waiting for
+  // one of them to finish or for its load delay to pass. A value of 0 uses a
+  // limit derived from the processors and memory of the machine.
+  static size_t max_parallel_tab_loads_;
+
  private:
   SessionRestore();
 
@@ -2,12 +2,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/file_path.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/browser/browser_process.h"
 #include "chrome/browser/defaults.h"
 #include "chrome/browser/first_run/first_run.h"
+#include "chrome/browser/net/url_request_mock_util.h"
 #include "chrome/browser/profiles/profile.h"
 #include "chrome/browser/profiles/profile_manager.h"
 #include "chrome/browser/sessions/session_restore.h"
@@ -25,6 +27,7 @@
 #include "chrome/common/chrome_switches.h"
 #include "chrome/test/base/in_process_browser_test.h"
 #include "chrome/test/base/ui_test_utils.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/navigation_controller.h"
 #include "content/public/browser/navigation_entry.h"
 #include "content/public/browser/notification_service.h"
@@ -32,6 +35,7 @@
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/common/page_transition_types.h"
+#include "content/test/net/url_request_slow_download_job.h"
 #include "content/test/test_navigation_observer.h"
 
 #if defined(OS_MACOSX)
@@ -656,6 +660,55 @@ IN_PROC_BROWSER_TEST_F(SessionRestoreTest, TwoWindowsCloseOneRestoreOnlyOne) {
 // Unfortunately, the fix at http://codereview.chromium.org/6546078
 // breaks NTP background image refreshing, so ThemeSource had to revert to
 // replacing the existing data source.
+// Restores two tabs that never finish loading followed by a regular tab, with
+// only two tabs allowed to load at once, and makes sure the regular tab is
+// still loaded.
+IN_PROC_BROWSER_TEST_F(SessionRestoreTest, HungTabsDontBlockRestore) {
+  content::BrowserThread::PostTask(
+      content::BrowserThread::IO, FROM_HERE,
+      base::Bind(&chrome_browser_net::SetUrlRequestMocksEnabled, true));
+  SessionRestore::max_parallel_tab_loads_ = 2;
+
+  // The image never finishes downloading, so the page never stops loading.
+  GURL hung_url(std::string("data:text/html,<img src='") +
+                URLRequestSlowDownloadJob::kUnknownSizeUrl + "'>");
+  for (int i = 0; i < 2; ++i) {
+    ui_test_utils::WindowedNotificationObserver observer(
+        content::NOTIFICATION_NAV_ENTRY_COMMITTED,
+        content::NotificationService::AllSources());
+    ui_test_utils::NavigateToURLWithDisposition(
+        browser(), hung_url, i == 0 ? CURRENT_TAB : NEW_BACKGROUND_TAB,
+        ui_test_utils::BROWSER_TEST_NONE);
+    observer.Wait();
+  }
+  ui_test_utils::NavigateToURLWithDisposition(
+      browser(), url1_, NEW_BACKGROUND_TAB,
+      ui_test_utils::BROWSER_TEST_WAIT_FOR_NAVIGATION);
+  ASSERT_EQ(0, browser()->active_index());
+
+  // Close the browser and restore the session. Only the last tab can stop
+  // loading, and it does so only if the force load timer starts it while the
+  // two hung tabs are at the limit.
+  Profile* profile = browser()->profile();
+  g_browser_process->AddRefModule();
+  CloseBrowserSynchronously(browser());
+  ui_test_utils::BrowserAddedObserver window_observer;
+  ui_test_utils::WindowedNotificationObserver load_stop_observer(
+      content::NOTIFICATION_LOAD_STOP,
+      content::NotificationService::AllSources());
+  Browser::NewEmptyWindow(profile);
+  Browser* new_browser = window_observer.WaitForSingleNewBrowser();
+  load_stop_observer.Wait();
+  g_browser_process->ReleaseModule();
+
+  ASSERT_EQ(3, new_browser->tab_count());
+  EXPECT_EQ(url1_, new_browser->GetWebContentsAt(2)->GetURL());
+  EXPECT_FALSE(new_browser->GetWebContentsAt(2)->IsLoading());
+  EXPECT_TRUE(new_browser->GetWebContentsAt(0)->IsLoading());
+
+  SessionRestore::max_parallel_tab_loads_ = 0;
+}
+
 IN_PROC_BROWSER_TEST_F(SessionRestoreTest, ShareProcessesOnRestore) {
   // Create two new tabs.
   ui_test_utils::NavigateToURLWithDisposition(
@@ -1378,7 +1378,17 @@ bool SessionService::ReplacePendingCommand(SessionCommand* command) {
         pending_commands().push_back(command);
         return true;
       }
-      return false;
+      // Updates for other tabs or indices don't affect this one, so keep
+      // looking. With many tabs loading at once their updates interleave.
+    } else if (existing_command->id() ==
+               kCommandTabNavigationPathPrunedFromFront) {
+      // Pruning from the front shifts the indices of the tab, so updates
+      // before it refer to other navigations than |command| does.
+      TabNavigationPathPrunedFromFrontPayload payload;
+      if (!existing_command->GetPayload(&payload, sizeof(payload)) ||
+          payload.id == command_tab_id) {
+        return false;
+      }
     }
   }
   return false;
@@ -629,6 +629,54 @@ TEST_F(SessionServiceTest, PruneFromFront) {
               tab->navigations[2].virtual_url());
 }
 
+// Updates to the same navigation of a tab are collapsed even when updates for
+// other tabs come in between, but not across a prune from the front.
+TEST_F(SessionServiceTest, ReplaceInterleavedNavigationUpdates) {
+  const std::string base_url("http://google.com/");
+  SessionID tab_id;
+  SessionID tab2_id;
+
+  helper_.PrepareTabInWindow(window_id, tab_id, 0, true);
+  helper_.PrepareTabInWindow(window_id, tab2_id, 1, false);
+
+  for (int i = 0; i < 3; ++i) {
+    TabNavigation nav(0, GURL(base_url + base::IntToString(i)),
+                      content::Referrer(),
+                      ASCIIToUTF16("a"), "b",
+                      content::PAGE_TRANSITION_QUALIFIER_MASK);
+    UpdateNavigation(window_id, tab_id, nav, i, (i == 2));
+    UpdateNavigation(window_id, tab2_id, nav, 0, true);
+  }
+  TabNavigation updated(0, GURL(base_url + "updated"), content::Referrer(),
+                        ASCIIToUTF16("a"), "b",
+                        content::PAGE_TRANSITION_QUALIFIER_MASK);
+  UpdateNavigation(window_id, tab_id, updated, 2, false);
+
+  // After the prune the update for index 0 is for what was index 1.
+  helper_.service()->TabNavigationPathPrunedFromFront(window_id, tab_id, 1);
+  TabNavigation shifted(0, GURL(base_url + "shifted"), content::Referrer(),
+                        ASCIIToUTF16("a"), "b",
+                        content::PAGE_TRANSITION_QUALIFIER_MASK);
+  UpdateNavigation(window_id, tab_id, shifted, 0, false);
+
+  ScopedVector<SessionWindow> windows;
+  ReadWindows(&(windows.get()));
+
+  ASSERT_EQ(1U, windows->size());
+  ASSERT_EQ(2U, windows[0]->tabs.size());
+
+  SessionTab* tab = windows[0]->tabs[0];
+  ASSERT_EQ(2U, tab->navigations.size());
+  EXPECT_EQ(1, tab->current_navigation_index);
+  EXPECT_TRUE(GURL(base_url + "shifted") == tab->navigations[0].virtual_url());
+  EXPECT_TRUE(GURL(base_url + "updated") == tab->navigations[1].virtual_url());
+
+  SessionTab* tab2 = windows[0]->tabs[1];
+  ASSERT_EQ(1U, tab2->navigations.size());
+  EXPECT_TRUE(GURL(base_url + base::IntToString(2)) ==
+              tab2->navigations[0].virtual_url());
+}
+
 // Prunes from front so that we have no entries.
 TEST_F(SessionServiceTest, PruneToEmpty) {
   const std::string base_url("http://google.com/");
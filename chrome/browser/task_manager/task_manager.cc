@@ -534,6 +534,13 @@ bool TaskManagerModel::GetSharedMemory(int index, size_t* result) const {
 
 bool TaskManagerModel::GetPhysicalMemory(int index, size_t* result) const {
   *result = 0;
+  PhysicalMemoryMap::const_iterator iter =
+      physical_memory_map_.find(resources_[index]->GetProcess());
+  if (iter != physical_memory_map_.end()) {
+    *result = iter->second;
+    return true;
+  }
+
   base::ProcessMetrics* process_metrics;
   if (!GetProcessMetricsForRow(index, &process_metrics))
     return false;
@@ -546,6 +553,7 @@ bool TaskManagerModel::GetPhysicalMemory(int index, size_t* result) const {
   size_t total_bytes = process_metrics->GetWorkingSetSize();
   total_bytes -= ws_usage.shared * 1024;
   *result = total_bytes;
+  physical_memory_map_[resources_[index]->GetProcess()] = total_bytes;
   return true;
 }
 
@@ -878,6 +886,7 @@ void TaskManagerModel::Refresh() {
 
   // Clear the memory values so they can be querried lazily.
   memory_usage_map_.clear();
+  physical_memory_map_.clear();
 
   // Compute the new network usage values.
   displayed_network_usage_map_.clear();
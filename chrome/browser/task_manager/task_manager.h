@@ -462,6 +462,7 @@ class TaskManagerModel : public base::RefCountedThreadSafe<TaskManagerModel> {
   // Private memory in bytes, shared memory in bytes.
   typedef std::pair<size_t, size_t> MemoryUsageEntry;
   typedef std::map<base::ProcessHandle, MemoryUsageEntry> MemoryUsageMap;
+  typedef std::map<base::ProcessHandle, size_t> PhysicalMemoryMap;
 
   // Updates the values for all rows.
   void Refresh();
@@ -536,6 +537,11 @@ class TaskManagerModel : public base::RefCountedThreadSafe<TaskManagerModel> {
   // every Refresh().
   mutable MemoryUsageMap memory_usage_map_;
 
+  // A map that contains the physical memory usage of the process, cached for
+  // the same reasons as |memory_usage_map_|. Sorting by the memory column
+  // queries it for each comparison. This cache is cleared on every Refresh().
+  mutable PhysicalMemoryMap physical_memory_map_;
+
   ObserverList<TaskManagerModelObserver> observer_list_;
 
   // How many calls to StartUpdating have been made without matching calls to
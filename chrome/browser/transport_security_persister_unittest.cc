@@ -4,6 +4,7 @@
 
 #include "chrome/browser/transport_security_persister.h"
 
+#include <map>
 #include <string>
 
 #include "base/bind.h"
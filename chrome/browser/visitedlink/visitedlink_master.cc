@@ -260,12 +260,32 @@ void VisitedLinkMaster::AddURL(const GURL& url) {
 }
 
 void VisitedLinkMaster::AddURLs(const std::vector<GURL>& url) {
+  // Grow the table once up front for the whole batch. Otherwise a big import
+  // rehashes the table and sends every renderer a new one several times over
+  // as it passes each size on the way. The table is not resized again until
+  // the batch is in, since it would look underfull until then.
+  bool presized = false;
+  if (!table_builder_) {
+    int32 new_count = used_items_ + static_cast<int32>(url.size());
+    uint32 new_size = NewTableSizeForCount(new_count);
+    if (new_size > static_cast<uint32>(table_length_) &&
+        new_count > table_length_ / 2) {
+      // ResizeTable() leaves the table as it was if it can't get the memory,
+      // and then the batch has to resize as it goes.
+      int32 old_table_length = table_length_;
+      ResizeTable(new_size);
+      presized = table_length_ > old_table_length;
+    }
+  }
+
   for (std::vector<GURL>::const_iterator i = url.begin();
        i != url.end(); ++i) {
     Hash index = TryToAddURL(*i);
-    if (!table_builder_ && index != null_hash_)
+    if (!presized && !table_builder_ && index != null_hash_)
       ResizeTableIfNecessary();
   }
+  if (presized && !table_builder_)
+    ResizeTableIfNecessary();
 
   // Keeps the file on disk up-to-date.
   if (!table_builder_)
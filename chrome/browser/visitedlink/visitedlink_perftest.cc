@@ -22,6 +22,7 @@ namespace {
 // how we generate URLs, note that the two strings should be the same length
 const int add_count = 10000;
 const int load_test_add_count = 250000;
+const int bulk_add_count = 1000000;
 const char added_prefix[] = "http://www.google.com/stuff/something/foo?session=85025602345625&id=1345142319023&seq=";
 const char unadded_prefix[] = "http://www.google.org/stuff/something/foo?session=39586739476365&id=2347624314402&seq=";
 
@@ -106,6 +107,28 @@ TEST_F(VisitedLink, TestAddAndQuery) {
   CheckVisited(master, unadded_prefix, 0, add_count);
 }
 
+// Tests adding a million URLs in one batch, as an import does, and how long
+// it takes to query the table once it holds them.
+TEST_F(VisitedLink, TestBulkAddAndQuery) {
+  VisitedLinkMaster master(DummyVisitedLinkEventListener::GetInstance(),
+                           NULL, true, db_path_, 0);
+  ASSERT_TRUE(master.Init());
+
+  std::vector<GURL> urls;
+  urls.reserve(bulk_add_count);
+  for (int i = 0; i < bulk_add_count; i++)
+    urls.push_back(TestURL(added_prefix, i));
+
+  PerfTimeLogger add_timer("Visited_link_bulk_add");
+  master.AddURLs(urls);
+  add_timer.Done();
+
+  PerfTimeLogger query_timer("Visited_link_bulk_query");
+  CheckVisited(master, added_prefix, 0, bulk_add_count);
+  CheckVisited(master, unadded_prefix, 0, bulk_add_count);
+  query_timer.Done();
+}
+
 // Tests how long it takes to write and read a large database to and from disk.
 TEST_F(VisitedLink, TestLoad) {
   // create a big DB
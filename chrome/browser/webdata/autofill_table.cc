@@ -361,7 +361,8 @@ bool AutofillTable::GetFormValuesForElementName(const string16& name,
   sql::Statement s;
 
   if (prefix.empty()) {
-    s.Assign(db_->GetUniqueStatement(
+    s.Assign(db_->GetCachedStatement(
+        SQL_FROM_HERE,
         "SELECT value FROM autofill "
         "WHERE name = ? "
         "ORDER BY count DESC "
@@ -373,7 +374,8 @@ bool AutofillTable::GetFormValuesForElementName(const string16& name,
     string16 next_prefix = prefix_lower;
     next_prefix[next_prefix.length() - 1]++;
 
-    s.Assign(db_->GetUniqueStatement(
+    s.Assign(db_->GetCachedStatement(
+        SQL_FROM_HERE,
         "SELECT value FROM autofill "
         "WHERE name = ? AND "
         "value_lower >= ? AND "
@@ -572,7 +574,8 @@ bool AutofillTable::GetIDAndCountOfFormElement(
   DCHECK(pair_id);
   DCHECK(count);
 
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "SELECT pair_id, count FROM autofill "
       "WHERE name = ? AND value = ?"));
   s.BindString16(0, element.name);
@@ -594,8 +597,8 @@ bool AutofillTable::GetIDAndCountOfFormElement(
 
 bool AutofillTable::GetCountOfFormElement(int64 pair_id, int* count) {
   DCHECK(count);
-  sql::Statement s(db_->GetUniqueStatement(
-      "SELECT count FROM autofill WHERE pair_id = ?"));
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE, "SELECT count FROM autofill WHERE pair_id = ?"));
   s.BindInt64(0, pair_id);
 
   if (s.Step()) {
@@ -606,8 +609,8 @@ bool AutofillTable::GetCountOfFormElement(int64 pair_id, int* count) {
 }
 
 bool AutofillTable::SetCountOfFormElement(int64 pair_id, int count) {
-  sql::Statement s(db_->GetUniqueStatement(
-      "UPDATE autofill SET count = ? WHERE pair_id = ?"));
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE, "UPDATE autofill SET count = ? WHERE pair_id = ?"));
   s.BindInt(0, count);
   s.BindInt64(1, pair_id);
 
@@ -617,7 +620,8 @@ bool AutofillTable::SetCountOfFormElement(int64 pair_id, int count) {
 bool AutofillTable::InsertFormElement(const FormField& element,
                                       int64* pair_id) {
   DCHECK(pair_id);
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "INSERT INTO autofill (name, value, value_lower) VALUES (?,?,?)"));
   s.BindString16(0, element.name);
   s.BindString16(1, element.value);
@@ -632,7 +636,8 @@ bool AutofillTable::InsertFormElement(const FormField& element,
 
 bool AutofillTable::InsertPairIDAndDate(int64 pair_id,
                                         const Time& date_created) {
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "INSERT INTO autofill_dates "
       "(pair_id, date_created) VALUES (?, ?)"));
   s.BindInt64(0, pair_id);
@@ -644,7 +649,8 @@ bool AutofillTable::InsertPairIDAndDate(int64 pair_id,
 bool AutofillTable::DeleteLastAccess(int64 pair_id) {
   // Inner SELECT selects the newest |date_created| for a given |pair_id|.
   // DELETE deletes only that entry.
-  sql::Statement s(db_->GetUniqueStatement(
+  sql::Statement s(db_->GetCachedStatement(
+      SQL_FROM_HERE,
       "DELETE FROM autofill_dates WHERE pair_id = ? and date_created IN "
       "(SELECT date_created FROM autofill_dates WHERE pair_id = ? "
       "ORDER BY date_created DESC LIMIT 1)"));
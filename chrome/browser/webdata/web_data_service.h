@@ -463,17 +463,17 @@ class WebDataService
   // form input fields named |name|.  The method OnWebDataServiceRequestDone of
   // |consumer| gets called back when the request is finished, with the vector
   // included in the argument |result|.
-  Handle GetFormValuesForElementName(const string16& name,
-                                     const string16& prefix,
-                                     int limit,
-                                     WebDataServiceConsumer* consumer);
+  virtual Handle GetFormValuesForElementName(const string16& name,
+                                             const string16& prefix,
+                                             int limit,
+                                             WebDataServiceConsumer* consumer);
 
   // Removes form elements recorded for Autocomplete from the database.
   void RemoveFormElementsAddedBetween(const base::Time& delete_begin,
                                       const base::Time& delete_end);
   void RemoveExpiredFormElements();
-  void RemoveFormValueForElementName(const string16& name,
-                                     const string16& value);
+  virtual void RemoveFormValueForElementName(const string16& name,
+                                             const string16& value);
 
   // Schedules a task to add an Autofill profile to the web database.
   void AddAutofillProfile(const AutofillProfile& profile);
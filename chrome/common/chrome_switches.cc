@@ -125,6 +125,11 @@ const char kAutomationClientChannelID[]     = "automation-channel";
 const char kAutomationReinitializeOnChannelError[] =
     "automation-reinitialize-on-channel-error";
 
+// Limits the combined bandwidth, in kilobytes per second, that response bodies
+// of the lowest priority requests (prefetches, updates and other background
+// traffic) are read with.
+const char kBackgroundBandwidthLimit[]      = "background-bandwidth-limit";
+
 // How often (in seconds) to check for updates. Should only be used for testing
 // purposes.
 const char kCheckForUpdateIntervalSec[]     = "check-for-update-interval";
@@ -574,6 +579,10 @@ const char kEnablePasswordGeneration[]      = "enable-password-generation";
 // Enables advanced app capabilities.
 const char kEnablePlatformApps[]            = "enable-platform-apps";
 
+// Lets HTTP requests for the same resource that are in flight at the same
+// time share one fetch.
+const char kEnableRequestCoalescing[]       = "enable-request-coalescing";
+
 // Enables content settings based on host *and* plug-in in the user
 // preferences.
 const char kEnableResourceContentSettings[] =
@@ -980,6 +989,11 @@ const char kPpapiFlashInProcess[]           = "ppapi-flash-in-process";
 // Instant for faster searching and browsing" in Preferences -> Basics).
 const char kPreloadInstantSearch[]          = "preload-instant-search";
 
+// Reads the cookie, history, favicon and web data databases of the profile
+// front to back on a background thread at startup, so that opening them later
+// does not have to seek for each page on a cold disk.
+const char kPreloadProfileDatabases[]       = "preload-profile-databases";
+
 // Triggers prerendering of pages from suggestions in the omnibox. Only has an
 // effect when Instant is either disabled or restricted to search, and when
 // prerender is enabled.
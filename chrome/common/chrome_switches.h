@@ -50,6 +50,7 @@ extern const char kAuthServerWhitelist[];
 extern const char kAutoLaunchAtStartup[];
 extern const char kAutomationClientChannelID[];
 extern const char kAutomationReinitializeOnChannelError[];
+extern const char kBackgroundBandwidthLimit[];
 extern const char kCheckForUpdateIntervalSec[];
 extern const char kCheckCloudPrintConnectorPolicy[];
 extern const char kChromeFrameShutdownDelay[];
@@ -167,6 +168,7 @@ extern const char kEnablePasswordGeneration[];
 extern const char kEnablePlatformApps[];
 extern const char kEnablePnacl[];
 extern const char kEnableProfiling[];
+extern const char kEnableRequestCoalescing[];
 extern const char kEnableResourceContentSettings[];
 extern const char kEnableSdch[];
 extern const char kEnableSpdy3[];
@@ -267,6 +269,7 @@ extern const char kPpapiFlashFieldTrialDisableByDefault[];
 extern const char kPpapiFlashFieldTrialEnableByDefault[];
 extern const char kPpapiFlashInProcess[];
 extern const char kPreloadInstantSearch[];
+extern const char kPreloadProfileDatabases[];
 extern const char kPrerenderFromOmnibox[];
 extern const char kPrerenderFromOmniboxSwitchValueAuto[];
 extern const char kPrerenderFromOmniboxSwitchValueDisabled[];
@@ -310,12 +310,16 @@ bool URLPattern::MatchesURL(const GURL& test) const {
   if (match_all_urls_)
     return true;
 
+  // Most patterns in a set fail on the host, so check it before building the
+  // path string.
+  if (!MatchesSecurityOriginHelper(*test_url))
+    return false;
+
   std::string path_for_request = test.PathForRequest();
   if (has_inner_url)
     path_for_request = test_url->path() + path_for_request;
 
-  return MatchesSecurityOriginHelper(*test_url) &&
-         MatchesPath(path_for_request);
+  return MatchesPath(path_for_request);
 }
 
 bool URLPattern::MatchesSecurityOrigin(const GURL& test) const {
@@ -353,8 +357,11 @@ bool URLPattern::MatchesHost(const std::string& host) const {
 }
 
 bool URLPattern::MatchesHost(const GURL& test) const {
+  // GURL::host() returns a copy, so only make it once.
+  const std::string test_host = test.host();
+
   // If the hosts are exactly equal, we have a match.
-  if (test.host() == host_)
+  if (test_host == host_)
     return true;
 
   // If we're matching subdomains, and we have no host in the match pattern,
@@ -367,20 +374,20 @@ bool URLPattern::MatchesHost(const GURL& test) const {
   if (!match_subdomains_)
     return false;
 
-  // We don't do subdomain matching against IP addresses, so we can give up now
-  // if the test host is an IP address.
-  if (test.HostIsIPAddress())
+  // Check if the test host is a subdomain of our host.
+  if (test_host.length() <= (host_.length() + 1))
     return false;
 
-  // Check if the test host is a subdomain of our host.
-  if (test.host().length() <= (host_.length() + 1))
+  if (test_host.compare(test_host.length() - host_.length(),
+                        host_.length(), host_) != 0)
     return false;
 
-  if (test.host().compare(test.host().length() - host_.length(),
-                          host_.length(), host_) != 0)
+  if (test_host[test_host.length() - host_.length() - 1] != '.')
     return false;
 
-  return test.host()[test.host().length() - host_.length() - 1] == '.';
+  // We don't do subdomain matching against IP addresses. This is checked last
+  // because it is the most expensive test.
+  return !test.HostIsIPAddress();
 }
 
 bool URLPattern::MatchesPath(const std::string& test) const {
@@ -84,6 +84,20 @@ void WriteToDiskTask(const FilePath& path, const std::string& data) {
     file_util::Delete(tmp_file_path, false);
     return;
   }
+
+  UMA_HISTOGRAM_COUNTS("ImportantFile.BytesWritten", bytes_written);
+}
+
+void SerializeAndWriteToDiskTask(
+    const FilePath& path,
+    const ImportantFileWriter::DataSerializer::SerializeCallback& serializer) {
+  std::string data;
+  if (!serializer.Run(&data)) {
+    DLOG(WARNING) << "failed to serialize data to be saved in "
+                  << path.value();
+    return;
+  }
+  WriteToDiskTask(path, data);
 }
 
 }  // namespace
@@ -147,6 +161,21 @@ void ImportantFileWriter::ScheduleWrite(DataSerializer* serializer) {
 
 void ImportantFileWriter::DoScheduledWrite() {
   DCHECK(serializer_);
+  DataSerializer::SerializeCallback background_serializer =
+      serializer_->GetBackgroundSerializer();
+  if (!background_serializer.is_null()) {
+    if (HasPendingWrite())
+      timer_.Stop();
+    if (!blocking_task_runner_->PostTask(
+        FROM_HERE, base::Bind(&SerializeAndWriteToDiskTask, path_,
+                              background_serializer))) {
+      NOTREACHED();
+      SerializeAndWriteToDiskTask(path_, background_serializer);
+    }
+    serializer_ = NULL;
+    return;
+  }
+
   std::string data;
   if (serializer_->SerializeData(&data)) {
     WriteNow(data);
@@ -9,6 +9,7 @@
 #include <string>
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/file_path.h"
 #include "base/memory/ref_counted.h"
 #include "base/threading/non_thread_safe.h"
@@ -42,12 +43,24 @@ class ImportantFileWriter : public base::NonThreadSafe {
   // to also batch data serializations.
   class DataSerializer {
    public:
+    // Puts the serialized data in its argument and returns true on success.
+    typedef base::Callback<bool(std::string*)> SerializeCallback;
+
     virtual ~DataSerializer() {}
 
     // Should put serialized string in |data| and return true on successful
     // serialization. Will be called on the same thread on which
     // ImportantFileWriter has been created.
     virtual bool SerializeData(std::string* data) = 0;
+
+    // Can return a callback to be run on the blocking task runner instead of
+    // SerializeData(), to keep expensive serialization off the calling
+    // thread. The callback must only use state it owns, such as a snapshot of
+    // the data. Will be called on the same thread on which
+    // ImportantFileWriter has been created.
+    virtual SerializeCallback GetBackgroundSerializer() {
+      return SerializeCallback();
+    }
   };
 
   // Initialize the writer.
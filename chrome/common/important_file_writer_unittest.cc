@@ -4,6 +4,7 @@
 
 #include "chrome/common/important_file_writer.h"
 
+#include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
@@ -38,6 +39,27 @@ class DataSerializer : public ImportantFileWriter::DataSerializer {
   const std::string data_;
 };
 
+bool SerializeString(const std::string& data, std::string* output) {
+  output->assign(data);
+  return true;
+}
+
+// Serializes on the blocking task runner.
+class BackgroundDataSerializer : public DataSerializer {
+ public:
+  explicit BackgroundDataSerializer(const std::string& data)
+      : DataSerializer("not written"),
+        background_data_(data) {
+  }
+
+  virtual SerializeCallback GetBackgroundSerializer() OVERRIDE {
+    return base::Bind(&SerializeString, background_data_);
+  }
+
+ private:
+  const std::string background_data_;
+};
+
 }  // namespace
 
 class ImportantFileWriterTest : public testing::Test {
@@ -103,6 +125,18 @@ TEST_F(ImportantFileWriterTest, DoScheduledWrite) {
   EXPECT_EQ("foo", GetFileContent(writer.path()));
 }
 
+TEST_F(ImportantFileWriterTest, BackgroundSerializer) {
+  ImportantFileWriter writer(file_,
+                             base::MessageLoopProxy::current());
+  BackgroundDataSerializer serializer("foo");
+  writer.ScheduleWrite(&serializer);
+  writer.DoScheduledWrite();
+  EXPECT_FALSE(writer.HasPendingWrite());
+  loop_.RunAllPending();
+  ASSERT_TRUE(file_util::PathExists(writer.path()));
+  EXPECT_EQ("foo", GetFileContent(writer.path()));
+}
+
 // Flaky - http://crbug.com/109292
 TEST_F(ImportantFileWriterTest, DISABLED_BatchingWrites) {
   ImportantFileWriter writer(file_,
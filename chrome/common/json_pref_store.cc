@@ -134,6 +134,14 @@ void FileThreadDeserializer::HandleErrors(
   }
 }
 
+// Formats |prefs| as the contents of the Preferences file. Can run on any
+// thread.
+bool SerializePrefs(const DictionaryValue* prefs, std::string* output) {
+  JSONStringValueSerializer serializer(output);
+  serializer.set_pretty_print(true);
+  return serializer.Serialize(*prefs);
+}
+
 }  // namespace
 
 JsonPrefStore::JsonPrefStore(const FilePath& filename,
@@ -309,11 +317,21 @@ JsonPrefStore::~JsonPrefStore() {
 }
 
 bool JsonPrefStore::SerializeData(std::string* output) {
+  scoped_ptr<DictionaryValue> copy(CopyPrefsForWriting());
+  return SerializePrefs(copy.get(), output);
+}
+
+ImportantFileWriter::DataSerializer::SerializeCallback
+JsonPrefStore::GetBackgroundSerializer() {
+  // Only the copy is made here; formatting the JSON, which is the bulk of the
+  // work for large profiles, happens on the blocking task runner.
+  return base::Bind(&SerializePrefs, base::Owned(CopyPrefsForWriting()));
+}
+
+DictionaryValue* JsonPrefStore::CopyPrefsForWriting() const {
   // TODO(tc): Do we want to prune webkit preferences that match the default
   // value?
-  JSONStringValueSerializer serializer(output);
-  serializer.set_pretty_print(true);
-  scoped_ptr<DictionaryValue> copy(prefs_->DeepCopyWithoutEmptyChildren());
+  DictionaryValue* copy = prefs_->DeepCopyWithoutEmptyChildren();
 
   // Iterates |keys_need_empty_value_| and if the key exists in |prefs_|,
   // ensure its empty ListValue or DictonaryValue is preserved.
@@ -338,5 +356,5 @@ bool JsonPrefStore::SerializeData(std::string* output) {
     }
   }
 
-  return serializer.Serialize(*(copy.get()));
+  return copy;
 }
@@ -68,6 +68,11 @@ class JsonPrefStore : public PersistentPrefStore,
 
   // ImportantFileWriter::DataSerializer overrides:
   virtual bool SerializeData(std::string* output) OVERRIDE;
+  virtual SerializeCallback GetBackgroundSerializer() OVERRIDE;
+
+  // Returns a copy of |prefs_| as it should be written to disk. The caller
+  // takes ownership.
+  base::DictionaryValue* CopyPrefsForWriting() const;
 
   FilePath path_;
   scoped_refptr<base::SequencedTaskRunner> blocking_task_runner_;
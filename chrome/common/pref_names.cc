@@ -383,6 +383,10 @@ const char kDnsHostReferralList[] = "HostReferralList";
 const char kDnsPrefetchingHostReferralList[] =
     "dns_prefetching.host_referral_list";
 
+// The host cache entries that expire last, saved at shutdown so that the next
+// startup can use them, and refresh them, without first waiting for DNS.
+const char kDnsPrefetchingHostCache[] = "dns_prefetching.host_cache";
+
 // Disables the SPDY protocol.
 const char kDisableSpdy[] = "spdy.disabled";
 
@@ -152,8 +152,9 @@ void SpellCheck::Init(base::PlatformFile file,
 
   character_attributes_.SetDefaultLanguage(language);
 
-  custom_words_.insert(custom_words_.end(),
-                       custom_words.begin(), custom_words.end());
+  // |custom_words| is the whole custom dictionary, including any word sent by
+  // OnWordAdded() before this, so it replaces the pending list.
+  custom_words_ = custom_words;
 
   // We delay the actual initialization of hunspell until it is needed.
 }
@@ -362,6 +363,8 @@ void SpellCheck::InitializeHunspell() {
          it != custom_words_.end(); ++it) {
       AddWordToHunspell(*it);
     }
+    // Hunspell keeps its own copy of the words.
+    std::vector<std::string>().swap(custom_words_);
 
     DHISTOGRAM_TIMES("Spellcheck.InitTime",
                      base::Histogram::DebugNow() - debug_start_time);
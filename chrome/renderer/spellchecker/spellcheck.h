@@ -162,6 +162,8 @@ class SpellCheck : public content::RenderProcessObserver,
   scoped_ptr<Hunspell> hunspell_;
 
   base::PlatformFile file_;
+
+  // The custom words to add to |hunspell_| when it is initialized.
   std::vector<std::string> custom_words_;
 
   // Represents character attributes used for filtering out characters which
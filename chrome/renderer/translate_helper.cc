@@ -9,6 +9,7 @@
 #include "base/logging.h"
 #include "base/message_loop.h"
 #include "base/metrics/histogram.h"
+#include "base/string_util.h"
 #include "base/utf_string_conversions.h"
 #include "chrome/common/chrome_constants.h"
 #include "chrome/common/render_messages.h"
@@ -44,6 +45,11 @@ static const int kTranslateStatusCheckDelayMs = 400;
 // Language name passed to the Translate element for it to detect the language.
 static const char* const kAutoDetectionLanguage = "auto";
 
+// The maximum number of characters of the page text handed to the CLD. The
+// CLD is reliable well before this many characters, and its running time on
+// the render thread grows with the length of the text.
+static const size_t kMaxLanguageDetectionChars = 16384;
+
 ////////////////////////////////////////////////////////////////////////////////
 // TranslateHelper, public:
 //
@@ -65,7 +71,16 @@ void TranslateHelper::PageCaptured(const string16& contents) {
   std::string language = GetPageLanguageFromMetaTag(&document);
   if (language.empty()) {
     base::TimeTicks begin_time = base::TimeTicks::Now();
-    language = DetermineTextLanguage(contents);
+    if (contents.size() > kMaxLanguageDetectionChars) {
+      // Cut the text at a word boundary so the last word is not misdetected.
+      string16 text = contents.substr(0, kMaxLanguageDetectionChars);
+      size_t last_space_index = text.find_last_of(kWhitespaceUTF16);
+      if (last_space_index != string16::npos)
+        text.resize(last_space_index);
+      language = DetermineTextLanguage(text);
+    } else {
+      language = DetermineTextLanguage(contents);
+    }
     UMA_HISTOGRAM_MEDIUM_TIMES("Renderer4.LanguageDetection",
                                base::TimeTicks::Now() - begin_time);
   } else {
@@ -44,12 +44,13 @@ void TaskMarshallerThroughMessageQueue::PostDelayedTask(
   base::AutoLock lock(lock_);
   base::PendingTask delayed_task(source, task, base::TimeTicks::Now() + delay,
                                  true);
-  base::TimeTicks top_run_time = delayed_tasks_.top().delayed_run_time;
-  delayed_tasks_.push(delayed_task);
-
   // Reschedule the timer if |delayed_task| will be the next delayed task to
   // run.
-  if (delayed_task.delayed_run_time < top_run_time) {
+  bool reschedule = delayed_tasks_.empty() ||
+      delayed_task.delayed_run_time < delayed_tasks_.top().delayed_run_time;
+  delayed_tasks_.push(delayed_task);
+
+  if (reschedule) {
     ::SetTimer(wnd_, reinterpret_cast<UINT_PTR>(this),
                static_cast<DWORD>(delay.InMilliseconds()), NULL);
   }
@@ -327,6 +327,11 @@ static void GetStatsThunk(char* buffer, int buffer_length) {
 static void ReleaseFreeMemoryThunk() {
   MallocExtension::instance()->ReleaseFreeMemory();
 }
+
+static bool SetMaxTotalThreadCacheBytesThunk(size_t bytes) {
+  return MallocExtension::instance()->SetNumericProperty(
+      "tcmalloc.max_total_thread_cache_bytes", bytes);
+}
 #endif
 
 
@@ -363,6 +368,8 @@ static void ReleaseFreeMemoryThunk() {
     // On windows, we've already set these thunks up in _heap_init()
     base::allocator::SetGetStatsFunction(GetStatsThunk);
     base::allocator::SetReleaseFreeMemoryFunction(ReleaseFreeMemoryThunk);
+    base::allocator::SetSetMaxTotalThreadCacheBytesFunction(
+        SetMaxTotalThreadCacheBytesThunk);
 #endif
 
 #if !defined(OS_ANDROID)
@@ -414,6 +421,19 @@ static void ReleaseFreeMemoryThunk() {
     std::string process_type =
           command_line.GetSwitchValueASCII(switches::kProcessType);
 
+    if (command_line.HasSwitch(switches::kTcmallocMaxTotalThreadCacheBytes)) {
+      int64 bytes = 0;
+      if (base::StringToInt64(command_line.GetSwitchValueASCII(
+              switches::kTcmallocMaxTotalThreadCacheBytes), &bytes) &&
+          bytes > 0) {
+        base::allocator::SetMaxTotalThreadCacheBytes(
+            static_cast<size_t>(bytes));
+      } else {
+        LOG(ERROR) << "Invalid --"
+                   << switches::kTcmallocMaxTotalThreadCacheBytes;
+      }
+    }
+
     // Enable startup tracing asap to avoid early TRACE_EVENT calls being
     // ignored.
     if (command_line.HasSwitch(switches::kTraceStartup)) {
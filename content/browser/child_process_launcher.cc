@@ -11,9 +11,11 @@
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
 #include "base/process_util.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread.h"
+#include "base/time.h"
 #include "content/common/chrome_descriptors.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/content_browser_client.h"
@@ -37,6 +39,24 @@
 
 using content::BrowserThread;
 
+namespace {
+
+// Records |time| in the histogram named |name| followed by the process type,
+// e.g. "MPArch.ChildProcessLaunchTime_renderer".
+void RecordTimeForProcessType(const std::string& name,
+                              const std::string& process_type,
+                              base::TimeDelta time) {
+  base::Histogram* histogram = base::Histogram::FactoryTimeGet(
+      name + "_" + (process_type.empty() ? "browser" : process_type),
+      base::TimeDelta::FromMilliseconds(1),
+      base::TimeDelta::FromSeconds(10),
+      50,
+      base::Histogram::kUmaTargetedHistogramFlag);
+  histogram->AddTime(time);
+}
+
+}  // namespace
+
 // Having the functionality of ChildProcessLauncher be in an internal
 // ref counted object allows us to automatically terminate the process when the
 // parent class destructs, while still holding on to state that we need.
@@ -81,6 +101,7 @@ class ChildProcessLauncher::Context
             &Context::LaunchInternal,
             make_scoped_refptr(this),
             client_thread_id_,
+            base::TimeTicks::Now(),
 #if defined(OS_WIN)
             exposed_dir,
 #elif defined(OS_POSIX)
@@ -114,6 +135,7 @@ class ChildProcessLauncher::Context
       // |this_object| is NOT thread safe. Only use it to post a task back.
       scoped_refptr<Context> this_object,
       BrowserThread::ID client_thread_id,
+      base::TimeTicks request_time,
 #if defined(OS_WIN)
       const FilePath& exposed_dir,
 #elif defined(OS_POSIX)
@@ -123,6 +145,13 @@ class ChildProcessLauncher::Context
 #endif
       CommandLine* cmd_line) {
     scoped_ptr<CommandLine> cmd_line_deleter(cmd_line);
+    const std::string process_type =
+        cmd_line->GetSwitchValueASCII(switches::kProcessType);
+    // Launches are serialized on this thread, so during session restore a
+    // launch can wait behind many others.
+    base::TimeTicks launch_start_time = base::TimeTicks::Now();
+    RecordTimeForProcessType("MPArch.ChildProcessLaunchQueueTime",
+                             process_type, launch_start_time - request_time);
 
     base::ProcessHandle handle = base::kNullProcessHandle;
 #if defined(OS_WIN)
@@ -134,8 +163,6 @@ class ChildProcessLauncher::Context
 
 #if defined(OS_POSIX) && !defined(OS_MACOSX) && !defined(OS_ANDROID)
     // On Linux, we need to add some extra file descriptors for crash handling.
-    std::string process_type =
-        cmd_line->GetSwitchValueASCII(switches::kProcessType);
     int crash_signal_fd =
         content::GetContentClient()->browser()->GetCrashSignalFD(*cmd_line);
     if (use_zygote) {
@@ -209,6 +236,11 @@ class ChildProcessLauncher::Context
     }
 #endif  // else defined(OS_POSIX)
 
+    if (handle) {
+      RecordTimeForProcessType("MPArch.ChildProcessLaunchTime", process_type,
+                               base::TimeTicks::Now() - launch_start_time);
+    }
+
     BrowserThread::PostTask(
         client_thread_id, FROM_HERE,
         base::Bind(
@@ -117,12 +117,17 @@ void DOMStorageMessageFilter::OnCloseStorageArea(int connection_id) {
 }
 
 void DOMStorageMessageFilter::OnLoadStorageArea(int connection_id,
+                                                int operation_id,
                                                 dom_storage::ValuesMap* map) {
   DCHECK(!BrowserThread::CurrentlyOn(BrowserThread::IO));
   if (!host_->ExtractAreaValues(connection_id, map)) {
     content::RecordAction(UserMetricsAction("BadMessageTerminate_DSMF_2"));
     BadMessageReceived();
+    return;
   }
+  // The sync reply goes out after this, so the renderer sees the
+  // completion once it has seen every event the values reflect.
+  Send(new DOMStorageMsg_AsyncOperationComplete(operation_id, true));
 }
 
 void DOMStorageMessageFilter::OnLength(int connection_id,
@@ -49,7 +49,8 @@ class DOMStorageMessageFilter
   void OnOpenStorageArea(int connection_id, int64 namespace_id,
                          const GURL& origin);
   void OnCloseStorageArea(int connection_id);
-  void OnLoadStorageArea(int connection_id, dom_storage::ValuesMap* map);
+  void OnLoadStorageArea(int connection_id, int operation_id,
+                         dom_storage::ValuesMap* map);
   void OnLength(int connection_id, unsigned* length);
   void OnKey(int connection_id, unsigned index, NullableString16* key);
   void OnGetItem(int connection_id, const string16& key,
@@ -494,6 +494,28 @@ TEST_F(DownloadFileManagerTest, CancelBeforeFinished) {
   CleanUp(dummy_id);
 }
 
+// The buffers received between two updates are written with one call.
+TEST_F(DownloadFileManagerTest, CoalescedWrite) {
+  DownloadCreateInfo* info = new DownloadCreateInfo;
+  DownloadId dummy_id(download_manager_.get(), kDummyDownloadId);
+
+  StartDownload(info, dummy_id);
+
+  size_t length = strlen(kTestData1) + strlen(kTestData2);
+  EXPECT_TRUE(UpdateBuffer(kTestData1, strlen(kTestData1)));
+  EXPECT_TRUE(UpdateBuffer(kTestData2, strlen(kTestData2)));
+  byte_count_[dummy_id] += length;
+  MockDownloadFile* file = download_file_factory_->GetExistingFile(dummy_id);
+  ASSERT_TRUE(file != NULL);
+  EXPECT_CALL(*file, AppendDataToFile(_, length))
+      .Times(1)
+      .WillOnce(Return(net::OK));
+  download_file_manager_->UpdateDownload(dummy_id, download_buffer_.get());
+  ClearExpectations(dummy_id);
+
+  CleanUp(dummy_id);
+}
+
 TEST_F(DownloadFileManagerTest, DownloadWithError) {
   // Same as StartDownload, at first.
   DownloadCreateInfo* info = new DownloadCreateInfo;
@@ -4,7 +4,10 @@
 
 #include "content/browser/plugin_loader_posix.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
+#include "base/file_util.h"
 #include "base/message_loop.h"
 #include "base/message_loop_proxy.h"
 #include "base/metrics/histogram.h"
@@ -17,6 +20,41 @@
 using content::BrowserThread;
 using content::ChildProcessHost;
 
+namespace {
+
+// Gets the size and the modification time that tell whether the plugin at
+// |path| changed since it was last loaded.
+bool GetPluginFileInfo(const FilePath& path, base::PlatformFileInfo* info) {
+  if (!file_util::GetFileInfo(path, info))
+    return false;
+#if defined(OS_MACOSX)
+  // Mac plugins are .plugin bundles, and updating the code or the Info.plist
+  // inside one need not touch the bundle directory. Use the total size and the
+  // latest modification time of those files instead.
+  if (info->is_directory) {
+    FilePath contents = path.Append(FILE_PATH_LITERAL("Contents"));
+    FilePath plist = contents.Append(FILE_PATH_LITERAL("Info.plist"));
+    if (!file_util::GetFileInfo(plist, info))
+      return false;
+    file_util::FileEnumerator executables(
+        contents.Append(FILE_PATH_LITERAL("MacOS")), false,
+        file_util::FileEnumerator::FILES);
+    for (FilePath file = executables.Next(); !file.empty();
+         file = executables.Next()) {
+      file_util::FileEnumerator::FindInfo find_info;
+      executables.GetFindInfo(&find_info);
+      info->size += file_util::FileEnumerator::GetFilesize(find_info);
+      info->last_modified = std::max(
+          info->last_modified,
+          file_util::FileEnumerator::GetLastModifiedTime(find_info));
+    }
+  }
+#endif
+  return true;
+}
+
+}  // namespace
+
 PluginLoaderPosix::PluginLoaderPosix()
     : next_load_index_(0) {
 }
@@ -83,8 +121,16 @@ void PluginLoaderPosix::GetPluginsToLoad() {
   PluginServiceImpl::GetInstance()->GetPluginList()->GetInternalPlugins(
       &internal_plugins_);
 
+  file_infos_.clear();
+  for (std::vector<FilePath>::const_iterator it = canonical_list_.begin();
+       it != canonical_list_.end(); ++it) {
+    base::PlatformFileInfo file_info;
+    if (GetPluginFileInfo(*it, &file_info))
+      file_infos_[*it] = file_info;
+  }
+
   BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
-      base::Bind(&PluginLoaderPosix::LoadPluginsInternal,
+      base::Bind(&PluginLoaderPosix::ApplyPluginCache,
                  make_scoped_refptr(this)));
 
   HISTOGRAM_TIMES("PluginLoaderPosix.GetPluginList",
@@ -92,6 +138,35 @@ void PluginLoaderPosix::GetPluginsToLoad() {
                       base::Time::kMicrosecondsPerMillisecond);
 }
 
+void PluginLoaderPosix::ApplyPluginCache() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+
+  ordered_paths_.clear();
+  std::vector<FilePath> uncached_paths;
+  for (std::vector<FilePath>::const_iterator it = canonical_list_.begin();
+       it != canonical_list_.end(); ++it) {
+    PluginCache::const_iterator cached = plugin_cache_.find(*it);
+    FileInfoMap::const_iterator file_info = file_infos_.find(*it);
+    if (cached == plugin_cache_.end() || file_info == file_infos_.end() ||
+        cached->second.size != file_info->second.size ||
+        cached->second.last_modified != file_info->second.last_modified) {
+      uncached_paths.push_back(*it);
+      continue;
+    }
+    if (!MaybeAddInternalPlugin(*it) && cached->second.loaded)
+      loaded_plugins_.push_back(cached->second.plugin);
+  }
+
+  HISTOGRAM_COUNTS_100("PluginLoaderPosix.CachedPlugins",
+                       canonical_list_.size() - uncached_paths.size());
+  if (uncached_paths.size() != canonical_list_.size()) {
+    ordered_paths_.swap(canonical_list_);
+    canonical_list_.swap(uncached_paths);
+  }
+
+  LoadPluginsInternal();
+}
+
 void PluginLoaderPosix::LoadPluginsInternal() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
 
@@ -116,12 +191,13 @@ void PluginLoaderPosix::LoadPluginsInternal() {
 
 void PluginLoaderPosix::OnPluginLoaded(uint32 index,
                                        const webkit::WebPluginInfo& plugin) {
-  if (index != next_load_index_) {
+  if (index != next_load_index_ || index >= canonical_list_.size()) {
     LOG(ERROR) << "Received unexpected plugin load message for "
                << plugin.path.value() << "; index=" << index;
     return;
   }
 
+  UpdatePluginCache(canonical_list_[index], true, plugin);
   if (!MaybeAddInternalPlugin(plugin.path))
     loaded_plugins_.push_back(plugin);
 
@@ -132,18 +208,34 @@ void PluginLoaderPosix::OnPluginLoaded(uint32 index,
 
 void PluginLoaderPosix::OnPluginLoadFailed(uint32 index,
                                            const FilePath& plugin_path) {
-  if (index != next_load_index_) {
+  if (index != next_load_index_ || index >= canonical_list_.size()) {
     LOG(ERROR) << "Received unexpected plugin load failure message for "
                << plugin_path.value() << "; index=" << index;
     return;
   }
 
+  UpdatePluginCache(canonical_list_[index], false, webkit::WebPluginInfo());
   ++next_load_index_;
 
   MaybeAddInternalPlugin(plugin_path);
   MaybeRunPendingCallbacks();
 }
 
+void PluginLoaderPosix::UpdatePluginCache(const FilePath& plugin_path,
+                                          bool loaded,
+                                          const webkit::WebPluginInfo& plugin) {
+  FileInfoMap::const_iterator file_info = file_infos_.find(plugin_path);
+  if (file_info == file_infos_.end()) {
+    plugin_cache_.erase(plugin_path);
+    return;
+  }
+  CachedPlugin& cached = plugin_cache_[plugin_path];
+  cached.size = file_info->second.size;
+  cached.last_modified = file_info->second.last_modified;
+  cached.loaded = loaded;
+  cached.plugin = plugin;
+}
+
 bool PluginLoaderPosix::MaybeAddInternalPlugin(const FilePath& plugin_path) {
   for (std::vector<webkit::WebPluginInfo>::iterator it =
            internal_plugins_.begin();
@@ -162,6 +254,29 @@ bool PluginLoaderPosix::MaybeRunPendingCallbacks() {
   if (next_load_index_ < canonical_list_.size())
     return false;
 
+  if (!ordered_paths_.empty()) {
+    // The cached plugins were added first; put them back in the order of the
+    // plugin list, which decides which plugin handles a MIME type.
+    std::vector<webkit::WebPluginInfo> ordered_plugins;
+    std::vector<bool> used(loaded_plugins_.size(), false);
+    for (std::vector<FilePath>::const_iterator it = ordered_paths_.begin();
+         it != ordered_paths_.end(); ++it) {
+      for (size_t i = 0; i < loaded_plugins_.size(); ++i) {
+        if (!used[i] && loaded_plugins_[i].path == *it) {
+          ordered_plugins.push_back(loaded_plugins_[i]);
+          used[i] = true;
+          break;
+        }
+      }
+    }
+    for (size_t i = 0; i < loaded_plugins_.size(); ++i) {
+      if (!used[i])
+        ordered_plugins.push_back(loaded_plugins_[i]);
+    }
+    loaded_plugins_.swap(ordered_plugins);
+    ordered_paths_.clear();
+  }
+
   PluginServiceImpl::GetInstance()->GetPluginList()->SetPlugins(
       loaded_plugins_);
 
@@ -197,3 +312,11 @@ PluginLoaderPosix::PendingCallback::PendingCallback(
 
 PluginLoaderPosix::PendingCallback::~PendingCallback() {
 }
+
+PluginLoaderPosix::CachedPlugin::CachedPlugin()
+    : size(0),
+      loaded(false) {
+}
+
+PluginLoaderPosix::CachedPlugin::~CachedPlugin() {
+}
@@ -6,10 +6,12 @@
 #define CONTENT_BROWSER_PLUGIN_LOADER_POSIX_H_
 
 #include <deque>
+#include <map>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/platform_file.h"
 #include "base/memory/ref_counted.h"
 #include "base/time.h"
 #include "content/browser/plugin_service_impl.h"
@@ -46,6 +48,13 @@ class UtilityProcessHost;
 // 5. This algorithm continues until the canonical list has been walked to the
 //    end, after which the list of loaded plugins is set on the PluginList and
 //    the completion callback is run.
+//
+// The result of loading each plugin is cached along with the size and the
+// modification time of its file. On a later load, plugins whose files have not
+// changed are taken from the cache, and only the others are sent to the child
+// process. If every plugin is cached, no child process is started at all. On
+// Mac, where plugins are bundle directories, the files checked are the
+// bundle's Info.plist and its executables.
 class CONTENT_EXPORT PluginLoaderPosix
     : public NON_EXPORTED_BASE(content::UtilityProcessHostClient),
       public IPC::Message::Sender {
@@ -74,14 +83,40 @@ class CONTENT_EXPORT PluginLoaderPosix
     content::PluginService::GetPluginsCallback callback;
   };
 
+  // The result of loading the plugin at a path, and the state of its file at
+  // the time.
+  struct CachedPlugin {
+    CachedPlugin();
+    ~CachedPlugin();
+
+    int64 size;
+    base::Time last_modified;
+    // False if the plugin failed to load.
+    bool loaded;
+    webkit::WebPluginInfo plugin;
+  };
+  typedef std::map<FilePath, CachedPlugin> PluginCache;
+  typedef std::map<FilePath, base::PlatformFileInfo> FileInfoMap;
+
   virtual ~PluginLoaderPosix();
 
   // Called on the FILE thread to get the list of plugin paths to probe.
   void GetPluginsToLoad();
 
+  // Called on the IO thread once the plugin paths are known. Takes the plugins
+  // whose files are unchanged from |plugin_cache_| and leaves the rest in
+  // |canonical_list_| to be loaded by the child process.
+  void ApplyPluginCache();
+
   // Must be called on the IO thread.
   virtual void LoadPluginsInternal();
 
+  // Records the result of loading the plugin at |plugin_path| in
+  // |plugin_cache_|.
+  void UpdatePluginCache(const FilePath& plugin_path,
+                         bool loaded,
+                         const webkit::WebPluginInfo& plugin);
+
   // Message handlers.
   void OnPluginLoaded(uint32 index, const webkit::WebPluginInfo& plugin);
   void OnPluginLoadFailed(uint32 index, const FilePath& plugin_path);
@@ -116,6 +151,18 @@ class CONTENT_EXPORT PluginLoaderPosix
   // plugin loading process has been completed.
   std::deque<PendingCallback> callbacks_;
 
+  // The size and modification time of each file in |canonical_list_|, read on
+  // the FILE thread along with the list.
+  FileInfoMap file_infos_;
+
+  // All the plugin paths of the current load, in order, when some of them
+  // were taken from |plugin_cache_|. Used to restore the order of
+  // |loaded_plugins_|. Empty otherwise.
+  std::vector<FilePath> ordered_paths_;
+
+  // The plugins loaded so far, by path. Only used on the IO thread.
+  PluginCache plugin_cache_;
+
   // The time at which plugin loading started.
   base::TimeTicks load_start_time_;
 
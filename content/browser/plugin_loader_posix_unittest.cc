@@ -42,6 +42,17 @@ class MockPluginLoaderPosix : public PluginLoaderPosix {
     return &internal_plugins_;
   }
 
+  void SetFileInfo(const FilePath& path, int64 size) {
+    base::PlatformFileInfo file_info;
+    file_info.size = size;
+    file_info.last_modified = base::Time::FromDoubleT(1000);
+    file_infos_[path] = file_info;
+  }
+
+  void TestApplyPluginCache() {
+    ApplyPluginCache();
+  }
+
   void RealLoadPluginsInternal() {
     PluginLoaderPosix::LoadPluginsInternal();
   }
@@ -376,3 +387,56 @@ TEST_F(PluginLoaderPosixTest, AllCrashed) {
 
   EXPECT_EQ(0u, plugin_loader()->loaded_plugins().size());
 }
+
+TEST_F(PluginLoaderPosixTest, UnchangedPluginsNotLoadedAgain) {
+  int did_callback = 0;
+  content::PluginService::GetPluginsCallback callback =
+      base::Bind(&VerifyCallback, base::Unretained(&did_callback));
+
+  plugin_loader()->LoadPlugins(message_loop()->message_loop_proxy(), callback);
+
+  EXPECT_CALL(*plugin_loader(), LoadPluginsInternal()).Times(1);
+  message_loop()->RunAllPending();
+
+  AddThreePlugins();
+  plugin_loader()->SetFileInfo(plugin1_.path, 10);
+  plugin_loader()->SetFileInfo(plugin2_.path, 20);
+  plugin_loader()->SetFileInfo(plugin3_.path, 30);
+
+  plugin_loader()->TestOnPluginLoaded(0, plugin1_);
+  plugin_loader()->TestOnPluginLoadFailed(1, plugin2_.path);
+  plugin_loader()->TestOnPluginLoaded(2, plugin3_);
+  message_loop()->RunAllPending();
+  EXPECT_EQ(1, did_callback);
+
+  // Load again, with the first plugin's file changed.
+  plugin_loader()->LoadPlugins(message_loop()->message_loop_proxy(), callback);
+
+  EXPECT_CALL(*plugin_loader(), LoadPluginsInternal()).Times(2);
+  message_loop()->RunAllPending();
+
+  AddThreePlugins();
+  plugin_loader()->SetFileInfo(plugin1_.path, 11);
+  plugin_loader()->SetFileInfo(plugin2_.path, 20);
+  plugin_loader()->SetFileInfo(plugin3_.path, 30);
+  plugin_loader()->TestApplyPluginCache();
+
+  // Only the changed plugin is left to load.
+  ASSERT_EQ(1u, plugin_loader()->canonical_list()->size());
+  EXPECT_EQ(plugin1_.path.value(),
+            plugin_loader()->canonical_list()->at(0).value());
+
+  const std::vector<webkit::WebPluginInfo>& plugins(
+      plugin_loader()->loaded_plugins());
+  ASSERT_EQ(1u, plugins.size());
+  EXPECT_EQ(plugin3_.name, plugins[0].name);
+
+  plugin_loader()->TestOnPluginLoaded(0, plugin1_);
+  message_loop()->RunAllPending();
+  EXPECT_EQ(2, did_callback);
+
+  // The plugins are back in the order of the plugin list.
+  ASSERT_EQ(2u, plugins.size());
+  EXPECT_EQ(plugin1_.name, plugins[0].name);
+  EXPECT_EQ(plugin3_.name, plugins[1].name);
+}
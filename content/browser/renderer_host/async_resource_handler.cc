@@ -15,6 +15,7 @@
 #include "content/browser/host_zoom_map_impl.h"
 #include "content/browser/renderer_host/resource_dispatcher_host_impl.h"
 #include "content/browser/renderer_host/resource_message_filter.h"
+#include "content/browser/renderer_host/resource_request_info_impl.h"
 #include "content/browser/resource_context_impl.h"
 #include "content/common/resource_messages.h"
 #include "content/common/view_messages.h"
@@ -44,6 +45,33 @@ const int kInitialReadBufSize = 32768;
 // The maximum size of the shared memory buffer. (512 kilobytes).
 const int kMaxReadBufSize = 524288;
 
+// The size of the shared memory buffer that responses too big for one read
+// buffer are read into. (512 kilobytes).
+const int kDataBufferSize = 524288;
+
+// The most data read into the data buffer at once, so that several reads can
+// wait for the renderer without stalling the next. (128 kilobytes).
+const int kMaxDataBufferRead = 131072;
+
+// Reads into smaller runs of free space in the data buffer are not worth the
+// messages they cost; a read buffer of its own is used instead.
+const int kMinDataBufferRead = 4096;
+
+// An IOBuffer for the part of another IOBuffer that starts at |offset|. It
+// keeps the other one alive.
+class DependentIOBuffer : public net::WrappedIOBuffer {
+ public:
+  DependentIOBuffer(net::IOBuffer* backing, int offset)
+      : net::WrappedIOBuffer(backing->data() + offset),
+        backing_(backing) {
+  }
+
+ private:
+  virtual ~DependentIOBuffer() {}
+
+  scoped_refptr<net::IOBuffer> backing_;
+};
+
 }  // namespace
 
 // Our version of IOBuffer that uses shared memory.
@@ -87,6 +115,9 @@ AsyncResourceHandler::AsyncResourceHandler(
       routing_id_(routing_id),
       rdh_(rdh),
       next_buffer_size_(kInitialReadBufSize),
+      data_buffer_shared_(false),
+      data_acks_seen_(0),
+      read_offset_(-1),
       url_(url) {
 }
 
@@ -173,6 +204,14 @@ bool AsyncResourceHandler::OnWillRead(int request_id, net::IOBuffer** buf,
                                       int* buf_size, int min_size) {
   DCHECK_EQ(-1, min_size);
 
+  int offset;
+  if (GetDataBufferSpace(request_id, &offset, buf_size)) {
+    read_offset_ = offset;
+    *buf = new DependentIOBuffer(data_buffer_.get(), offset);
+    return true;
+  }
+  read_offset_ = -1;
+
   if (g_spare_read_buffer) {
     DCHECK(!read_buffer_);
     read_buffer_.swap(&g_spare_read_buffer);
@@ -198,6 +237,8 @@ bool AsyncResourceHandler::OnWillRead(int request_id, net::IOBuffer** buf,
 bool AsyncResourceHandler::OnReadCompleted(int request_id, int* bytes_read) {
   if (!*bytes_read)
     return true;
+  if (read_offset_ >= 0)
+    return SendDataBufferData(request_id, *bytes_read);
   DCHECK(read_buffer_.get());
 
   if (read_buffer_->buffer_size() == *bytes_read) {
@@ -233,6 +274,7 @@ bool AsyncResourceHandler::OnReadCompleted(int request_id, int* bytes_read) {
       DevToolsNetLogObserver::GetAndResetEncodedDataLength(request);
   filter_->Send(new ResourceMsg_DataReceived(
       routing_id_, request_id, handle, *bytes_read, encoded_data_length));
+  sent_data_.push_back(SentData(-1, 0));
 
   return true;
 }
@@ -276,6 +318,97 @@ bool AsyncResourceHandler::OnResponseCompleted(
 void AsyncResourceHandler::OnRequestClosed() {
 }
 
+bool AsyncResourceHandler::GetDataBufferSpace(int request_id,
+                                              int* offset,
+                                              int* size) {
+  // Responses that fit in the first read buffer don't need a data buffer.
+  if (next_buffer_size_ == kInitialReadBufSize)
+    return false;
+
+  if (!data_buffer_) {
+    data_buffer_ = new SharedIOBuffer(kDataBufferSize);
+    if (!data_buffer_->Init()) {
+      DLOG(ERROR) << "Couldn't allocate shared data buffer";
+      data_buffer_ = NULL;
+      return false;
+    }
+  }
+
+  // Acknowledgements come in the order the data was sent, so they free the
+  // oldest data first.
+  net::URLRequest* request = rdh_->GetURLRequest(
+      GlobalRequestID(filter_->child_id(), request_id));
+  ResourceRequestInfoImpl* info = ResourceRequestInfoImpl::ForRequest(request);
+  while (data_acks_seen_ < info->data_ack_count() && !sent_data_.empty()) {
+    sent_data_.pop_front();
+    data_acks_seen_++;
+  }
+
+  // Find the data the renderer may still be reading, and the free space
+  // after it or, once that runs out, before it.
+  int first = -1;
+  int end = -1;
+  for (std::deque<SentData>::const_iterator it = sent_data_.begin();
+       it != sent_data_.end(); ++it) {
+    if (it->offset < 0)
+      continue;
+    if (first < 0)
+      first = it->offset;
+    end = it->offset + it->size;
+  }
+
+  if (first < 0) {
+    *offset = 0;
+    *size = kDataBufferSize;
+  } else if (end > first) {
+    if (kDataBufferSize - end >= kMinDataBufferRead) {
+      *offset = end;
+      *size = kDataBufferSize - end;
+    } else {
+      *offset = 0;
+      *size = first;
+    }
+  } else {
+    *offset = end;
+    *size = first - end;
+  }
+
+  *size = std::min(*size, kMaxDataBufferRead);
+  return *size >= kMinDataBufferRead;
+}
+
+bool AsyncResourceHandler::SendDataBufferData(int request_id,
+                                              int bytes_read) {
+  if (!rdh_->WillSendData(filter_->child_id(), request_id)) {
+    // We should not send this data now, we have too many pending requests.
+    // It stays in the data buffer until the request resumes.
+    return true;
+  }
+
+  if (!data_buffer_shared_) {
+    base::SharedMemoryHandle handle;
+    if (!data_buffer_->shared_memory()->ShareToProcess(
+            filter_->peer_handle(), &handle)) {
+      // Undo the pending data count that WillSendData added.
+      rdh_->DataReceivedACK(filter_->child_id(), request_id);
+      return false;
+    }
+    filter_->Send(new ResourceMsg_SetDataBuffer(
+        routing_id_, request_id, handle, data_buffer_->buffer_size()));
+    data_buffer_shared_ = true;
+  }
+
+  net::URLRequest* request = rdh_->GetURLRequest(
+      GlobalRequestID(filter_->child_id(), request_id));
+  int encoded_data_length =
+      DevToolsNetLogObserver::GetAndResetEncodedDataLength(request);
+  filter_->Send(new ResourceMsg_DataReceivedInBuffer(
+      routing_id_, request_id, read_offset_, bytes_read,
+      encoded_data_length));
+  sent_data_.push_back(SentData(read_offset_, bytes_read));
+  return true;
+}
+
 // static
 void AsyncResourceHandler::GlobalCleanup() {
   if (g_spare_read_buffer) {
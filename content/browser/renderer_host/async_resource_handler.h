@@ -6,6 +6,7 @@
 #define CONTENT_BROWSER_RENDERER_HOST_ASYNC_RESOURCE_HANDLER_H_
 #pragma once
 
+#include <deque>
 #include <string>
 
 #include "content/browser/renderer_host/resource_handler.h"
@@ -55,8 +56,25 @@ class AsyncResourceHandler : public ResourceHandler {
   static void GlobalCleanup();
 
  private:
+  // A run of |data_buffer_| sent to the renderer. Data sent in a read buffer
+  // of its own has an |offset| of -1.
+  struct SentData {
+    SentData(int offset, int size) : offset(offset), size(size) {}
+    int offset;
+    int size;
+  };
+
   virtual ~AsyncResourceHandler();
 
+  // Sets |*offset| and |*size| to the run of |data_buffer_| the next read
+  // goes into, making the buffer if needed. Returns false if the read should
+  // go into a read buffer of its own instead.
+  bool GetDataBufferSpace(int request_id, int* offset, int* size);
+
+  // Tells the renderer about data read into |data_buffer_|, sharing the
+  // buffer with it first if needed.
+  bool SendDataBufferData(int request_id, int bytes_read);
+
   scoped_refptr<SharedIOBuffer> read_buffer_;
   scoped_refptr<ResourceMessageFilter> filter_;
   int routing_id_;
@@ -69,6 +87,23 @@ class AsyncResourceHandler : public ResourceHandler {
   // was filled, up to a maximum size of 512k.
   int next_buffer_size_;
 
+  // Once a response has filled a read buffer, the rest of it is read into
+  // this buffer instead. It is shared with the renderer once and then used
+  // as a ring: reads go into its free space while the renderer consumes
+  // earlier data, so that neither new shared memory nor the acknowledgement
+  // of each read is waited for.
+  scoped_refptr<SharedIOBuffer> data_buffer_;
+  bool data_buffer_shared_;
+
+  // The data messages sent and not known to be acknowledged, oldest first,
+  // and the number of acknowledgements accounted for.
+  std::deque<SentData> sent_data_;
+  int data_acks_seen_;
+
+  // Where in |data_buffer_| the current read goes, or -1 if it goes into
+  // |read_buffer_|.
+  int read_offset_;
+
   // TODO(battre): Remove url. This is only for debugging
   // http://crbug.com/107692.
   GURL url_;
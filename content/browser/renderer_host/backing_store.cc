@@ -16,3 +16,11 @@ BackingStore::~BackingStore() {
 size_t BackingStore::MemorySize() {
   return size_.GetArea() * 4;
 }
+
+bool BackingStore::GetPixels(SkBitmap* bitmap) {
+  return false;
+}
+
+bool BackingStore::PaintFromPixels(const SkBitmap& bitmap) {
+  return false;
+}
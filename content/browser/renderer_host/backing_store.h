@@ -16,6 +16,8 @@
 
 class RenderProcessHost;
 
+class SkBitmap;
+
 namespace gfx {
 class Rect;
 }
@@ -72,6 +74,16 @@ class CONTENT_EXPORT BackingStore {
   virtual void ScrollBackingStore(int dx, int dy,
                                   const gfx::Rect& clip_rect,
                                   const gfx::Size& view_size) = 0;
+
+  // Sets |bitmap| to the pixels of the whole backing store, which it may
+  // share, and paints |bitmap|, the size of the backing store, over all of
+  // it. BackingStoreManager uses these to keep the contents of backing stores
+  // it evicts. The default implementations return false, for backing stores
+  // whose pixels aren't cheaply reachable; those are repainted by the
+  // renderer instead.
+  virtual bool GetPixels(SkBitmap* bitmap);
+  virtual bool PaintFromPixels(const SkBitmap& bitmap);
+
  protected:
   // Can only be constructed via subclasses.
   BackingStore(content::RenderWidgetHost* widget, const gfx::Size& size);
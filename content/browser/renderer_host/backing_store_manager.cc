@@ -8,9 +8,12 @@
 #include "base/command_line.h"
 #include "base/memory/mru_cache.h"
 #include "base/sys_info.h"
+#include "base/memory/scoped_ptr.h"
 #include "content/browser/renderer_host/backing_store.h"
+#include "content/browser/renderer_host/compressed_bitmap.h"
 #include "content/browser/renderer_host/render_widget_host_impl.h"
 #include "content/public/common/content_switches.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 using content::RenderWidgetHost;
 
@@ -26,6 +29,14 @@ typedef base::OwningMRUCache<RenderWidgetHost*, BackingStore*>
 static BackingStoreCache* large_cache = NULL;
 static BackingStoreCache* small_cache = NULL;
 
+// Backing stores evicted from the caches above leave their pixels here,
+// compressed, so that switching back to their widget doesn't have to wait for
+// the renderer to repaint. The cache is bounded by a fraction of
+// MaxBackingStoreMemory().
+typedef base::OwningMRUCache<RenderWidgetHost*, CompressedBitmap*>
+    CompressedBitmapCache;
+static CompressedBitmapCache* compressed_cache = NULL;
+
 // Threshold is based on a single large-monitor-width toolstrip.
 // (32bpp, 32 pixels high, 1920 pixels wide)
 // TODO(aa): The extension system no longer supports toolstrips, but we think
@@ -44,6 +55,10 @@ const size_t kSmallThreshold = 4 * 32 * 1920;
 // TODO(erikkay) 32bpp assumption isn't great.
 const size_t kMemoryMultiplier = 4 * 1920 * 1200;  // ~9MB
 
+// The compressed pixels of evicted backing stores may use up to this fraction
+// of MaxBackingStoreMemory().
+const size_t kCompressedMemoryDivisor = 4;
+
 // The maximum number of large BackingStoreCache objects (tabs) to use.
 // Use a minimum of 2, and add one for each 256MB of physical memory you have.
 // Cap at 5, the thinking being that even if you have a gigantic amount of
@@ -72,9 +87,39 @@ static size_t MaxBackingStoreMemory() {
   return MaxNumberOfBackingStores() * kMemoryMultiplier;
 }
 
+size_t CompressedMemorySize() {
+  size_t mem = 0;
+  for (CompressedBitmapCache::iterator it = compressed_cache->begin();
+       it != compressed_cache->end(); ++it) {
+    mem += it->second->MemorySize();
+  }
+  return mem;
+}
+
+// Keeps the pixels of |backing_store|, which is being evicted, in
+// |compressed_cache| if it can.
+void KeepCompressedPixels(RenderWidgetHost* host,
+                          BackingStore* backing_store) {
+  SkBitmap pixels;
+  if (!backing_store->GetPixels(&pixels))
+    return;
+
+  scoped_ptr<CompressedBitmap> compressed(new CompressedBitmap);
+  if (!compressed->Compress(pixels))
+    return;
+
+  size_t max_mem = MaxBackingStoreMemory() / kCompressedMemoryDivisor;
+  if (compressed->MemorySize() > max_mem)
+    return;
+  while (CompressedMemorySize() + compressed->MemorySize() > max_mem)
+    compressed_cache->Erase(compressed_cache->rbegin());
+  compressed_cache->Put(host, compressed.release());
+}
+
 // Expires the given |backing_store| from |cache|.
 void ExpireBackingStoreAt(BackingStoreCache* cache,
                           BackingStoreCache::iterator backing_store) {
+  KeepCompressedPixels(backing_store->first, backing_store->second);
   cache->Erase(backing_store);
 }
 
@@ -82,9 +127,21 @@ size_t ExpireLastBackingStore(BackingStoreCache* cache) {
   if (cache->size() < 1)
     return 0;
 
-  // Crazy C++ alert: rbegin.base() is a forward iterator pointing to end(),
-  // so we need to do -- to move one back to the actual last item.
-  BackingStoreCache::iterator entry = --cache->rbegin().base();
+  // Evict the least recently used backing store of a hidden widget, since the
+  // visible ones are about to be painted again. If every widget is visible,
+  // evict the least recently used one.
+  BackingStoreCache::reverse_iterator last = cache->rbegin();
+  for (BackingStoreCache::reverse_iterator it = cache->rbegin();
+       it != cache->rend(); ++it) {
+    if (content::RenderWidgetHostImpl::From(it->first)->is_hidden()) {
+      last = it;
+      break;
+    }
+  }
+
+  // Crazy C++ alert: a reverse iterator's base() is a forward iterator
+  // pointing one past its item, so we need to do -- to move back to it.
+  BackingStoreCache::iterator entry = --last.base();
   size_t entry_size = entry->second->MemorySize();
   ExpireBackingStoreAt(cache, entry);
   return entry_size;
@@ -118,6 +175,8 @@ BackingStore* CreateBackingStore(RenderWidgetHost* host,
   if (!large_cache) {
     large_cache = new BackingStoreCache(BackingStoreCache::NO_AUTO_EVICT);
     small_cache = new BackingStoreCache(BackingStoreCache::NO_AUTO_EVICT);
+    compressed_cache =
+        new CompressedBitmapCache(CompressedBitmapCache::NO_AUTO_EVICT);
   }
 
   // TODO(erikkay) 32bpp is not always accurate
@@ -154,6 +213,28 @@ BackingStore* CreateBackingStore(RenderWidgetHost* host,
   return backing_store;
 }
 
+// Makes a backing store for |host| from the pixels its last one left in
+// |compressed_cache|, if there are any.
+BackingStore* RestoreBackingStore(RenderWidgetHost* host) {
+  CompressedBitmapCache::iterator it = compressed_cache->Peek(host);
+  if (it == compressed_cache->end())
+    return NULL;
+
+  SkBitmap pixels;
+  bool decompressed = it->second->Decompress(&pixels);
+  compressed_cache->Erase(it);
+  if (!decompressed)
+    return NULL;
+
+  BackingStore* backing_store = CreateBackingStore(
+      host, gfx::Size(pixels.width(), pixels.height()));
+  if (backing_store && !backing_store->PaintFromPixels(pixels)) {
+    BackingStoreManager::RemoveBackingStore(host);
+    return NULL;
+  }
+  return backing_store;
+}
+
 int ComputeTotalArea(const std::vector<gfx::Rect>& rects) {
   // We assume that the given rects are non-overlapping, which is a property of
   // the paint rects generated by the PaintAggregator.
@@ -235,6 +316,8 @@ BackingStore* BackingStoreManager::Lookup(RenderWidgetHost* host) {
     it = small_cache->Get(host);
     if (it != small_cache->end())
       return it->second;
+
+    return RestoreBackingStore(host);
   }
   return NULL;
 }
@@ -244,6 +327,10 @@ void BackingStoreManager::RemoveBackingStore(RenderWidgetHost* host) {
   if (!large_cache)
     return;
 
+  CompressedBitmapCache::iterator compressed = compressed_cache->Peek(host);
+  if (compressed != compressed_cache->end())
+    compressed_cache->Erase(compressed);
+
   BackingStoreCache* cache = large_cache;
   BackingStoreCache::iterator it = cache->Peek(host);
   if (it == cache->end()) {
@@ -260,6 +347,7 @@ void BackingStoreManager::RemoveAllBackingStores() {
   if (large_cache) {
     large_cache->Clear();
     small_cache->Clear();
+    compressed_cache->Clear();
   }
 }
 
@@ -7,7 +7,9 @@
 #include "content/browser/renderer_host/render_process_host_impl.h"
 #include "skia/ext/platform_canvas.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "ui/gfx/blit.h"
 #include "ui/gfx/canvas.h"
+#include "ui/gfx/point.h"
 #include "ui/gfx/rect.h"
 
 // Assume that somewhere along the line, someone will do width * height * 4
@@ -62,24 +64,39 @@ void BackingStoreSkia::PaintToBackingStore(
   if (!dib)
     return;
 
-  SkPaint copy_paint;
-  copy_paint.setXfermodeMode(SkXfermode::kSrc_Mode);
-
-  SkBitmap sk_bitmap;
-  sk_bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
-  sk_bitmap.setPixels(dib->memory());
-  for (size_t i = 0; i < copy_rects.size(); i++) {
-    const gfx::Rect& copy_rect = copy_rects[i];
-    int x = copy_rect.x() - bitmap_rect.x();
-    int y = copy_rect.y() - bitmap_rect.y();
-    int w = copy_rect.width();
-    int h = copy_rect.height();
-    SkIRect srcrect = SkIRect::MakeXYWH(x, y, w, h);
-    SkRect dstrect = SkRect::MakeXYWH(
-        SkIntToScalar(copy_rect.x()), SkIntToScalar(copy_rect.y()),
-        SkIntToScalar(w), SkIntToScalar(h));
-    canvas_.get()->drawBitmapRect(sk_bitmap, &srcrect, dstrect, &copy_paint);
+  // The DIB and the backing store are both unscaled 32bpp, so the rects are
+  // copied row by row rather than drawn. Rects that continue one another
+  // down the same columns, as the paint aggregator makes of a band of
+  // invalidations, are copied together, which is a single copy when they
+  // span the whole width.
+  SkAutoLockPixels lock(bitmap_);
+  const uint8* dib_pixels = static_cast<const uint8*>(dib->memory());
+  const gfx::Rect bounds = bitmap_rect.Intersect(gfx::Rect(size()));
+  gfx::Rect pending;
+  for (size_t i = 0; i <= copy_rects.size(); i++) {
+    gfx::Rect copy_rect;
+    if (i < copy_rects.size())
+      copy_rect = copy_rects[i].Intersect(bounds);
+    if (!copy_rect.IsEmpty() && !pending.IsEmpty() &&
+        copy_rect.x() == pending.x() && copy_rect.width() == pending.width() &&
+        copy_rect.y() == pending.bottom()) {
+      pending.set_height(pending.height() + copy_rect.height());
+      continue;
+    }
+
+    if (!pending.IsEmpty()) {
+      int x = pending.x() - bitmap_rect.x();
+      int y = pending.y() - bitmap_rect.y();
+      gfx::MovePixelRows(bitmap_.getAddr32(pending.x(), pending.y()),
+                         bitmap_.rowBytes(),
+                         dib_pixels + (y * width + x) * 4,
+                         width * 4,
+                         pending.width() * 4,
+                         pending.height());
+    }
+    pending = copy_rect;
   }
+  bitmap_.notifyPixelsChanged();
 }
 
 void BackingStoreSkia::ScrollBackingStore(int dx, int dy,
@@ -89,8 +106,8 @@ void BackingStoreSkia::ScrollBackingStore(int dx, int dy,
   int y = std::min(clip_rect.y(), clip_rect.y() - dy);
   int w = clip_rect.width() + abs(dx);
   int h = clip_rect.height() + abs(dy);
-  SkIRect rect = SkIRect::MakeXYWH(x, y, w, h);
-  bitmap_.scrollRect(&rect, dx, dy);
+  gfx::ScrollCanvas(canvas_.get(), gfx::Rect(x, y, w, h),
+                    gfx::Point(dx, dy));
 }
 
 bool BackingStoreSkia::CopyFromBackingStore(const gfx::Rect& rect,
@@ -108,3 +125,18 @@ bool BackingStoreSkia::CopyFromBackingStore(const gfx::Rect& rect,
   output->writePixels(b, rect.x(), rect.y());
   return true;
 }
+
+bool BackingStoreSkia::GetPixels(SkBitmap* bitmap) {
+  *bitmap = bitmap_;
+  return true;
+}
+
+bool BackingStoreSkia::PaintFromPixels(const SkBitmap& bitmap) {
+  if (bitmap.width() != size().width() || bitmap.height() != size().height())
+    return false;
+
+  SkPaint copy_paint;
+  copy_paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+  canvas_->drawBitmap(bitmap, 0, 0, &copy_paint);
+  return true;
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/compressed_bitmap.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace {
+
+const uint32 kRepeatFlag = 0x80000000;
+
+// Repeats shorter than this are cheaper as literals.
+const int kMinRepeat = 3;
+
+// Returns the number of pixels from |pixels| on that have its color, up to
+// |max|.
+int RepeatLength(const uint32* pixels, int max) {
+  int length = 1;
+  while (length < max && pixels[length] == pixels[0])
+    length++;
+  return length;
+}
+
+void EncodeRow(const uint32* pixels, int width, std::vector<uint32>* data) {
+  int x = 0;
+  while (x < width) {
+    int repeat = RepeatLength(pixels + x, width - x);
+    if (repeat >= kMinRepeat) {
+      data->push_back(kRepeatFlag | repeat);
+      data->push_back(pixels[x]);
+      x += repeat;
+      continue;
+    }
+
+    // Take pixels literally up to the next repeat worth encoding as one.
+    int start = x;
+    while (x < width) {
+      repeat = RepeatLength(pixels + x, std::min(width - x, kMinRepeat));
+      if (repeat >= kMinRepeat)
+        break;
+      x += repeat;
+    }
+    data->push_back(x - start);
+    data->insert(data->end(), pixels + start, pixels + x);
+  }
+}
+
+}  // namespace
+
+CompressedBitmap::CompressedBitmap() {
+}
+
+CompressedBitmap::~CompressedBitmap() {
+}
+
+bool CompressedBitmap::Compress(const SkBitmap& bitmap) {
+  DCHECK_EQ(SkBitmap::kARGB_8888_Config, bitmap.config());
+  size_ = gfx::Size();
+  data_.clear();
+
+  size_t max_words = bitmap.width() * bitmap.height() / 2;
+  SkAutoLockPixels lock(bitmap);
+  std::vector<uint32> data;
+  for (int y = 0; y < bitmap.height(); ++y) {
+    EncodeRow(bitmap.getAddr32(0, y), bitmap.width(), &data);
+    if (data.size() > max_words)
+      return false;
+  }
+
+  // Copying drops the spare capacity that growing |data| left.
+  std::vector<uint32>(data).swap(data_);
+  size_.SetSize(bitmap.width(), bitmap.height());
+  return true;
+}
+
+bool CompressedBitmap::Decompress(SkBitmap* bitmap) const {
+  if (size_.IsEmpty())
+    return false;
+
+  bitmap->setConfig(SkBitmap::kARGB_8888_Config, size_.width(),
+                    size_.height());
+  if (!bitmap->allocPixels())
+    return false;
+
+  SkAutoLockPixels lock(*bitmap);
+  std::vector<uint32>::const_iterator it = data_.begin();
+  for (int y = 0; y < size_.height(); ++y) {
+    uint32* pixels = bitmap->getAddr32(0, y);
+    uint32* end = pixels + size_.width();
+    while (pixels < end) {
+      uint32 length = *it & ~kRepeatFlag;
+      DCHECK_LE(length, static_cast<uint32>(end - pixels));
+      if (*it++ & kRepeatFlag) {
+        std::fill(pixels, pixels + length, *it++);
+      } else {
+        std::copy(it, it + length, pixels);
+        it += length;
+      }
+      pixels += length;
+    }
+  }
+  DCHECK(it == data_.end());
+  return true;
+}
+
+size_t CompressedBitmap::MemorySize() const {
+  return data_.size() * sizeof(uint32);
+}
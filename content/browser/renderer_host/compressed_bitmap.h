@@ -0,0 +1,51 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_RENDERER_HOST_COMPRESSED_BITMAP_H_
+#define CONTENT_BROWSER_RENDERER_HOST_COMPRESSED_BITMAP_H_
+#pragma once
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "content/common/content_export.h"
+#include "ui/gfx/size.h"
+
+class SkBitmap;
+
+// Holds the pixels of a 32bpp bitmap run-length encoded, so that
+// BackingStoreManager can keep the contents of evicted backing stores for
+// less memory than the backing stores took. Rendered web pages are mostly
+// long runs of the same color, which this encodes quickly in both
+// directions; photos barely shrink, and Compress() refuses them.
+class CONTENT_EXPORT CompressedBitmap {
+ public:
+  CompressedBitmap();
+  ~CompressedBitmap();
+
+  // Encodes |bitmap|, which must be 32bpp. Returns false, holding nothing, if
+  // the result would be more than half the size of |bitmap|.
+  bool Compress(const SkBitmap& bitmap);
+
+  // Allocates |bitmap| and decodes the pixels into it. Returns false if there
+  // is nothing to decode.
+  bool Decompress(SkBitmap* bitmap) const;
+
+  const gfx::Size& size() const { return size_; }
+
+  // The number of bytes the encoded pixels take.
+  size_t MemorySize() const;
+
+ private:
+  gfx::Size size_;
+
+  // Each row is a sequence of runs. A run starts with a word holding its
+  // length. If |kRepeatFlag| is set in it, the next word is the color
+  // repeated that many times; otherwise that many literal pixels follow.
+  std::vector<uint32> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompressedBitmap);
+};
+
+#endif  // CONTENT_BROWSER_RENDERER_HOST_COMPRESSED_BITMAP_H_
@@ -0,0 +1,77 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/compressed_bitmap.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace {
+
+void AllocBitmap(SkBitmap* bitmap, int width, int height) {
+  bitmap->setConfig(SkBitmap::kARGB_8888_Config, width, height);
+  ASSERT_TRUE(bitmap->allocPixels());
+}
+
+void ExpectSamePixels(const SkBitmap& a, const SkBitmap& b) {
+  ASSERT_EQ(a.width(), b.width());
+  ASSERT_EQ(a.height(), b.height());
+  SkAutoLockPixels lock_a(a);
+  SkAutoLockPixels lock_b(b);
+  for (int y = 0; y < a.height(); ++y) {
+    for (int x = 0; x < a.width(); ++x)
+      ASSERT_EQ(*a.getAddr32(x, y), *b.getAddr32(x, y)) << x << "," << y;
+  }
+}
+
+}  // namespace
+
+// A page-like bitmap, with solid areas broken up by short runs of detail,
+// comes back the same and takes much less memory.
+TEST(CompressedBitmapTest, RoundTrip) {
+  SkBitmap bitmap;
+  AllocBitmap(&bitmap, 200, 100);
+  bitmap.eraseARGB(255, 255, 255, 255);
+  {
+    SkAutoLockPixels lock(bitmap);
+    for (int y = 10; y < 90; y += 3) {
+      for (int x = 20; x < 180; x += 7) {
+        *bitmap.getAddr32(x, y) = 0xff000000;
+        *bitmap.getAddr32(x + 1, y) = 0xff102030 + x;
+        *bitmap.getAddr32(x + 3, y) = 0xff000000 + y;
+      }
+    }
+    *bitmap.getAddr32(199, 99) = 0xff00ff00;
+  }
+
+  CompressedBitmap compressed;
+  ASSERT_TRUE(compressed.Compress(bitmap));
+  EXPECT_EQ(gfx::Size(200, 100), compressed.size());
+  EXPECT_LT(compressed.MemorySize(), bitmap.getSize() / 4);
+
+  SkBitmap decompressed;
+  ASSERT_TRUE(compressed.Decompress(&decompressed));
+  ExpectSamePixels(bitmap, decompressed);
+}
+
+// Bitmaps with no runs aren't worth keeping compressed.
+TEST(CompressedBitmapTest, RefusesNoise) {
+  SkBitmap bitmap;
+  AllocBitmap(&bitmap, 64, 64);
+  {
+    SkAutoLockPixels lock(bitmap);
+    uint32 value = 12345;
+    for (int y = 0; y < 64; ++y) {
+      for (int x = 0; x < 64; ++x) {
+        value = value * 1103515245 + 12345;
+        *bitmap.getAddr32(x, y) = value;
+      }
+    }
+  }
+
+  CompressedBitmap compressed;
+  EXPECT_FALSE(compressed.Compress(bitmap));
+  SkBitmap decompressed;
+  EXPECT_FALSE(compressed.Decompress(&decompressed));
+}
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "base/metrics/histogram.h"
 #include "base/process_util.h"
 #include "base/shared_memory.h"
 #include "base/threading/platform_thread.h"
@@ -15,10 +16,22 @@
 const int kMinIntervalBetweenReadCallsInMs = 10;
 
 AudioSyncReader::AudioSyncReader(base::SharedMemory* shared_memory)
-    : shared_memory_(shared_memory) {
+    : shared_memory_(shared_memory),
+      renderer_started_(false),
+      renderer_callback_count_(0),
+      renderer_missed_callback_count_(0) {
 }
 
 AudioSyncReader::~AudioSyncReader() {
+  if (!renderer_callback_count_)
+    return;
+
+  // Each missed callback is a glitch the user heard.
+  UMA_HISTOGRAM_COUNTS("Media.AudioRendererMissedDeadline",
+                       renderer_missed_callback_count_);
+  UMA_HISTOGRAM_PERCENTAGE(
+      "Media.AudioRendererMissedDeadlinePercentage",
+      100 * renderer_missed_callback_count_ / renderer_callback_count_);
 }
 
 bool AudioSyncReader::DataReady() {
@@ -54,6 +67,9 @@ uint32 AudioSyncReader::Read(void* data, uint32 size) {
   // Optimization: if renderer is "new" one that writes length of data we can
   // stop yielding the moment length is written -- not ideal solution,
   // but better than nothing.
+  // The wait ends 10ms after this reader's previous call, not 10ms from now,
+  // so when the mixer reads its streams in turn their waits overlap instead
+  // of adding up.
   while (!DataReady() &&
          ((base::Time::Now() - previous_call_time_).InMilliseconds() <
           kMinIntervalBetweenReadCallsInMs)) {
@@ -62,6 +78,15 @@ uint32 AudioSyncReader::Read(void* data, uint32 size) {
   previous_call_time_ = base::Time::Now();
 #endif
 
+  // Reads before the renderer first wrote a buffer are startup, not misses.
+  const bool data_ready = DataReady();
+  renderer_started_ = renderer_started_ || data_ready;
+  if (renderer_started_) {
+    ++renderer_callback_count_;
+    if (!data_ready)
+      ++renderer_missed_callback_count_;
+  }
+
   uint32 read_size = std::min(media::GetActualDataSizeInBytes(shared_memory_,
                                                               max_size),
                               size);
@@ -45,6 +45,16 @@ class AudioSyncReader : public media::AudioOutputController::SyncReader {
   base::SharedMemory* shared_memory_;
   base::Time previous_call_time_;
 
+  // Whether the renderer has written a buffer yet.
+  bool renderer_started_;
+
+  // The number of Read() calls since the renderer first wrote a buffer, and
+  // how many of them found that the renderer had not written one in time, so
+  // that silence was played instead. Only used on the hardware audio thread,
+  // and reported to UMA on destruction.
+  int renderer_callback_count_;
+  int renderer_missed_callback_count_;
+
   // Socket for transmitting audio data.
   scoped_ptr<base::CancelableSyncSocket> socket_;
 
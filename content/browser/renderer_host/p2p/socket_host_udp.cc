@@ -4,6 +4,8 @@
 
 #include "content/browser/renderer_host/p2p/socket_host_udp.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "content/common/p2p_messages.h"
 #include "net/base/io_buffer.h"
@@ -15,6 +17,10 @@ namespace {
 // UDP packets cannot be bigger than 64k.
 const int kReadBufferSize = 65536;
 
+// Number of packets read or sent per batch. The read slots are sized for the
+// largest packet, but pages that no packet reaches are never touched.
+const int kMaxBatchPackets = 8;
+
 }  // namespace
 
 namespace content {
@@ -71,6 +77,12 @@ bool P2PSocketHostUdp::Init(const net::IPEndPoint& local_address,
   message_sender_->Send(new P2PMsg_OnSocketCreated(routing_id_, id_, address));
 
   recv_buffer_ = new net::IOBuffer(kReadBufferSize);
+  batch_buffer_ = new net::IOBuffer(kReadBufferSize * kMaxBatchPackets);
+  batch_lengths_.resize(kMaxBatchPackets);
+  batch_addresses_.resize(kMaxBatchPackets);
+  send_batch_buffers_.resize(kMaxBatchPackets);
+  send_batch_sizes_.resize(kMaxBatchPackets);
+  send_batch_addresses_.resize(kMaxBatchPackets);
   DoRead();
 
   return true;
@@ -89,11 +101,39 @@ void P2PSocketHostUdp::OnError() {
 void P2PSocketHostUdp::DoRead() {
   int result;
   do {
+    // Packets that are already waiting are read in batches; RecvFrom() is
+    // only needed to wait for the next one.
+    if (!ReadBatches())
+      return;
     result = socket_->RecvFrom(recv_buffer_, kReadBufferSize, &recv_address_,
                                base::Bind(&P2PSocketHostUdp::OnRecv,
                                           base::Unretained(this)));
     DidCompleteRead(result);
-  } while (result > 0);
+  } while (result > 0 && state_ == STATE_OPEN);
+}
+
+bool P2PSocketHostUdp::ReadBatches() {
+  while (true) {
+    int count = socket_->RecvBatch(batch_buffer_, kReadBufferSize,
+                                   kMaxBatchPackets, &batch_lengths_[0],
+                                   &batch_addresses_[0]);
+    if (count < 0) {
+      LOG(ERROR) << "Error when reading from UDP socket: " << count;
+      OnError();
+      return false;
+    }
+    for (int i = 0; i < count; ++i) {
+      if (batch_lengths_[i] <= 0) {
+        LOG(WARNING) << "Dropping a packet that could not be read: "
+                     << batch_lengths_[i];
+        continue;
+      }
+      HandleIncomingPacket(batch_buffer_->data() + i * kReadBufferSize,
+                           batch_lengths_[i], batch_addresses_[i]);
+    }
+    if (count < kMaxBatchPackets)
+      return true;
+  }
 }
 
 void P2PSocketHostUdp::OnRecv(int result) {
@@ -107,29 +147,34 @@ void P2PSocketHostUdp::DidCompleteRead(int result) {
   DCHECK_EQ(state_, STATE_OPEN);
 
   if (result > 0) {
-    std::vector<char> data(recv_buffer_->data(), recv_buffer_->data() + result);
-
-    if (connected_peers_.find(recv_address_) == connected_peers_.end()) {
-      P2PSocketHost::StunMessageType type;
-      bool stun = GetStunPacketType(&*data.begin(), data.size(), &type);
-      if (stun && IsRequestOrResponse(type)) {
-        connected_peers_.insert(recv_address_);
-      } else if (!stun || type == STUN_DATA_INDICATION) {
-        LOG(ERROR) << "Received unexpected data packet from "
-                   << recv_address_.ToString()
-                   << " before STUN binding is finished.";
-        return;
-      }
-    }
-
-    message_sender_->Send(new P2PMsg_OnDataReceived(routing_id_, id_,
-                                                    recv_address_, data));
+    HandleIncomingPacket(recv_buffer_->data(), result, recv_address_);
   } else if (result < 0 && result != net::ERR_IO_PENDING) {
     LOG(ERROR) << "Error when reading from UDP socket: " << result;
     OnError();
   }
 }
 
+void P2PSocketHostUdp::HandleIncomingPacket(const char* data, int size,
+                                            const net::IPEndPoint& address) {
+  std::vector<char> packet(data, data + size);
+
+  if (connected_peers_.find(address) == connected_peers_.end()) {
+    P2PSocketHost::StunMessageType type;
+    bool stun = GetStunPacketType(&*packet.begin(), packet.size(), &type);
+    if (stun && IsRequestOrResponse(type)) {
+      connected_peers_.insert(address);
+    } else if (!stun || type == STUN_DATA_INDICATION) {
+      LOG(ERROR) << "Received unexpected data packet from "
+                 << address.ToString()
+                 << " before STUN binding is finished.";
+      return;
+    }
+  }
+
+  message_sender_->Send(new P2PMsg_OnDataReceived(routing_id_, id_,
+                                                  address, packet));
+}
+
 void P2PSocketHostUdp::Send(const net::IPEndPoint& to,
                             const std::vector<char>& data) {
   if (!socket_.get()) {
@@ -186,12 +231,40 @@ void P2PSocketHostUdp::OnSend(int result) {
   }
 
   while (!send_queue_.empty() && !send_pending_) {
+    // Send what the socket takes in batches, and fall back to SendTo() when
+    // it takes none so that a full socket buffer is waited for.
+    int sent = SendQueuedBatch();
+    if (sent < 0) {
+      LOG(ERROR) << "Error when sending data in UDP socket: " << sent;
+      OnError();
+      return;
+    }
+    if (sent > 0)
+      continue;
+
     DoSend(send_queue_.front());
     send_queue_bytes_ -= send_queue_.front().size;
     send_queue_.pop_front();
   }
 }
 
+int P2PSocketHostUdp::SendQueuedBatch() {
+  int count = std::min(static_cast<int>(send_queue_.size()), kMaxBatchPackets);
+  for (int i = 0; i < count; ++i) {
+    send_batch_buffers_[i] = send_queue_[i].data;
+    send_batch_sizes_[i] = send_queue_[i].size;
+    send_batch_addresses_[i] = send_queue_[i].to;
+  }
+
+  int sent = socket_->SendBatch(&send_batch_buffers_[0], &send_batch_sizes_[0],
+                                &send_batch_addresses_[0], count);
+  for (int i = 0; i < sent; ++i) {
+    send_queue_bytes_ -= send_queue_.front().size;
+    send_queue_.pop_front();
+  }
+  return sent;
+}
+
 P2PSocketHost* P2PSocketHostUdp::AcceptIncomingTcpConnection(
     const net::IPEndPoint& remote_address, int id) {
   NOTREACHED();
@@ -52,6 +52,16 @@ class CONTENT_EXPORT P2PSocketHostUdp : public P2PSocketHost {
   void DoRead();
   void DoSend(const PendingPacket& packet);
   void DidCompleteRead(int result);
+  void HandleIncomingPacket(const char* data, int size,
+                            const net::IPEndPoint& address);
+
+  // Reads the packets that have already arrived in batches. Returns false if
+  // the socket failed.
+  bool ReadBatches();
+
+  // Sends packets from the head of |send_queue_| in one batch. Returns the
+  // number sent, or a net error.
+  int SendQueuedBatch();
 
   // Callbacks for RecvFrom() and SendTo().
   void OnRecv(int result);
@@ -61,6 +71,16 @@ class CONTENT_EXPORT P2PSocketHostUdp : public P2PSocketHost {
   scoped_refptr<net::IOBuffer> recv_buffer_;
   net::IPEndPoint recv_address_;
 
+  // Slots for RecvBatch(), and the size and sender of each packet read.
+  scoped_refptr<net::IOBuffer> batch_buffer_;
+  std::vector<int> batch_lengths_;
+  std::vector<net::IPEndPoint> batch_addresses_;
+
+  // Slots for SendBatch(), filled from the head of |send_queue_|.
+  std::vector<net::IOBuffer*> send_batch_buffers_;
+  std::vector<int> send_batch_sizes_;
+  std::vector<net::IPEndPoint> send_batch_addresses_;
+
   std::deque<PendingPacket> send_queue_;
   int send_queue_bytes_;
   bool send_pending_;
@@ -30,7 +30,8 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
   // P2PSocketHostUdp destroyes a socket on errors so sent packets
   // need to be stored outside of this object.
   explicit FakeDatagramServerSocket(std::deque<UDPPacket>* sent_packets)
-      : sent_packets_(sent_packets) {
+      : sent_packets_(sent_packets),
+        batched_packets_(0) {
   }
 
   virtual void Close() OVERRIDE {
@@ -81,6 +82,34 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
     return buf_len;
   }
 
+  virtual int RecvBatch(net::IOBuffer* buf, int buf_len, int max_packets,
+                        int* lengths, net::IPEndPoint* addresses) OVERRIDE {
+    CHECK(recv_callback_.is_null());
+    int count = 0;
+    while (count < max_packets && incoming_packets_.size() > 0) {
+      const UDPPacket& packet = incoming_packets_.front();
+      int size = std::min(static_cast<int>(packet.second.size()), buf_len);
+      memcpy(buf->data() + count * buf_len, &*packet.second.begin(), size);
+      lengths[count] = size;
+      addresses[count] = packet.first;
+      incoming_packets_.pop_front();
+      ++count;
+    }
+    batched_packets_ += count;
+    return count;
+  }
+
+  virtual int SendBatch(net::IOBuffer* const* bufs, const int* buf_lens,
+                        const net::IPEndPoint* addresses,
+                        int count) OVERRIDE {
+    for (int i = 0; i < count; ++i) {
+      std::vector<char> data_vector(bufs[i]->data(),
+                                    bufs[i]->data() + buf_lens[i]);
+      sent_packets_->push_back(UDPPacket(addresses[i], data_vector));
+    }
+    return count;
+  }
+
   virtual bool SetReceiveBufferSize(int32 size) OVERRIDE {
     return true;
   }
@@ -103,6 +132,15 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
     }
   }
 
+  // Holds a packet until the next read, as if it arrived while the host was
+  // busy.
+  void QueuePacket(const net::IPEndPoint& address, std::vector<char> data) {
+    incoming_packets_.push_back(UDPPacket(address, data));
+  }
+
+  // Number of packets handed out by RecvBatch().
+  int batched_packets() const { return batched_packets_; }
+
   virtual const net::BoundNetLog& NetLog() const {
     return net_log_;
   }
@@ -112,6 +150,7 @@ class FakeDatagramServerSocket : public net::DatagramServerSocket {
   std::deque<UDPPacket>* sent_packets_;
   std::deque<UDPPacket> incoming_packets_;
   net::BoundNetLog net_log_;
+  int batched_packets_;
 
   scoped_refptr<net::IOBuffer> recv_buffer_;
   net::IPEndPoint* recv_address_;
@@ -247,4 +286,21 @@ TEST_F(P2PSocketHostUdpTest, SendAfterStunResponseDifferentHost) {
   socket_host_->Send(dest2_, packet);
 }
 
+// Verify that packets that arrive while the host is busy are read in
+// batches and all delivered.
+TEST_F(P2PSocketHostUdpTest, ReceiveQueuedPacketsInBatches) {
+  std::vector<char> request_packet;
+  CreateStunRequest(&request_packet);
+
+  const int kQueuedPackets = 10;
+  EXPECT_CALL(sender_, Send(MatchPacketMessage(request_packet)))
+      .Times(kQueuedPackets + 1)
+      .WillRepeatedly(DoAll(DeleteArg<0>(), Return(true)));
+  for (int i = 0; i < kQueuedPackets; ++i)
+    socket_->QueuePacket(dest1_, request_packet);
+  socket_->ReceivePacket(dest1_, request_packet);
+
+  EXPECT_EQ(kQueuedPackets, socket_->batched_packets());
+}
+
 }  // namespace content
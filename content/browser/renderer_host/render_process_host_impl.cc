@@ -730,6 +730,7 @@ void RenderProcessHostImpl::PropagateBrowserCommandLineToRenderer(
 #endif
     switches::kRendererStartupDialog,
     switches::kShowPaintRects,
+    switches::kTcmallocMaxTotalThreadCacheBytes,
     switches::kTestSandbox,
     switches::kTraceStartup,
     // This flag needs to be propagated to the renderer process for
@@ -23,11 +23,13 @@
 #include "content/browser/renderer_host/render_process_host_impl.h"
 #include "content/browser/renderer_host/render_view_host_impl.h"
 #include "content/browser/renderer_host/render_widget_helper.h"
+#include "content/browser/renderer_host/resource_dispatcher_host_impl.h"
 #include "content/browser/renderer_host/tap_suppression_controller.h"
 #include "content/common/accessibility_messages.h"
 #include "content/common/gpu/gpu_messages.h"
 #include "content/common/view_messages.h"
 #include "content/port/browser/render_widget_host_view_port.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/native_web_keyboard_event.h"
 #include "content/public/browser/notification_service.h"
 #include "content/public/browser/notification_types.h"
@@ -81,6 +83,16 @@ bool ShouldCoalesceMouseWheelEvents(const WebMouseWheelEvent& last_event,
          last_event.momentumPhase == new_event.momentumPhase;
 }
 
+// Runs on the IO thread to let the resource scheduler know that a view was
+// shown or hidden.
+void NotifyRouteVisibilityChanged(int child_id, int route_id, bool visible) {
+  content::ResourceDispatcherHostImpl* rdh =
+      content::ResourceDispatcherHostImpl::Get();
+  // Unit tests may not have one.
+  if (rdh)
+    rdh->OnRouteVisibilityChanged(child_id, route_id, visible);
+}
+
 }  // namespace
 
 namespace content {
@@ -336,6 +348,11 @@ void RenderWidgetHostImpl::WasHidden() {
   // Tell the RenderProcessHost we were hidden.
   process_->WidgetHidden();
 
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&NotifyRouteVisibilityChanged, process_->GetID(),
+                 routing_id_, false));
+
   bool is_visible = false;
   NotificationService::current()->Notify(
       NOTIFICATION_RENDER_WIDGET_VISIBILITY_CHANGED,
@@ -366,6 +383,11 @@ void RenderWidgetHostImpl::WasRestored() {
 
   process_->WidgetRestored();
 
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&NotifyRouteVisibilityChanged, process_->GetID(),
+                 routing_id_, true));
+
   bool is_visible = true;
   NotificationService::current()->Notify(
       NOTIFICATION_RENDER_WIDGET_VISIBILITY_CHANGED,
@@ -4,10 +4,13 @@
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/shared_memory.h"
 #include "base/timer.h"
 #include "content/browser/browser_thread_impl.h"
 #include "content/browser/renderer_host/backing_store.h"
+#include "content/browser/renderer_host/backing_store_manager.h"
+#include "content/browser/renderer_host/test_backing_store.h"
 #include "content/browser/renderer_host/test_render_view_host.h"
 #include "content/common/view_messages.h"
 #include "content/port/browser/render_widget_host_view_port.h"
@@ -19,6 +22,7 @@
 #include "content/test/mock_render_process_host.h"
 #include "content/test/test_browser_context.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 #include "ui/base/keycodes/keyboard_codes.h"
 #include "ui/gfx/canvas.h"
 
@@ -147,6 +151,62 @@ class TestView : public content::TestRenderWidgetHostView {
   DISALLOW_COPY_AND_ASSIGN(TestView);
 };
 
+// PixelBackingStore -----------------------------------------------------------
+
+// This backing store is filled with one color. Unlike TestBackingStore, it
+// hands its pixels to the BackingStoreManager when evicted, and can be
+// rebuilt from them.
+class PixelBackingStore : public TestBackingStore {
+ public:
+  PixelBackingStore(RenderWidgetHost* widget, const gfx::Size& size)
+      : TestBackingStore(widget, size) {
+    pixels_.setConfig(SkBitmap::kARGB_8888_Config, size.width(),
+                      size.height());
+    pixels_.allocPixels();
+    pixels_.eraseColor(SK_ColorBLACK);
+  }
+
+  void set_color(SkColor color) { pixels_.eraseColor(color); }
+
+  // Returns the color of the first pixel.
+  SkColor color() {
+    SkAutoLockPixels lock(pixels_);
+    return pixels_.getColor(0, 0);
+  }
+
+  // BackingStore implementation.
+  virtual bool GetPixels(SkBitmap* bitmap) OVERRIDE {
+    *bitmap = pixels_;
+    return true;
+  }
+
+  virtual bool PaintFromPixels(const SkBitmap& bitmap) OVERRIDE {
+    if (bitmap.width() != size().width() || bitmap.height() != size().height())
+      return false;
+    return bitmap.copyTo(&pixels_, SkBitmap::kARGB_8888_Config);
+  }
+
+ private:
+  SkBitmap pixels_;
+
+  DISALLOW_COPY_AND_ASSIGN(PixelBackingStore);
+};
+
+// This test view makes PixelBackingStores.
+class PixelTestView : public TestView {
+ public:
+  explicit PixelTestView(RenderWidgetHostImpl* rwh) : TestView(rwh) {
+  }
+
+  // RenderWidgetHostView override.
+  virtual BackingStore* AllocBackingStore(const gfx::Size& size) OVERRIDE {
+    return new PixelBackingStore(rwh_, size);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(PixelTestView);
+};
+
 // MockRenderWidgetHost ----------------------------------------------------
 
 class MockRenderWidgetHost : public RenderWidgetHostImpl {
@@ -602,6 +662,88 @@ TEST_F(RenderWidgetHostTest, HiddenPaint) {
   EXPECT_TRUE(needs_repaint.a);
 }
 
+// Gives |host| a backing store of |size|, as a full paint from the renderer
+// does.
+static void PrepareBackingStore(RenderWidgetHost* host,
+                                const gfx::Size& size) {
+  bool needs_full_paint = false;
+  bool scheduled_completion_callback = false;
+  BackingStoreManager::PrepareBackingStore(
+      host, size, TransportDIB::Id(), gfx::Rect(size),
+      std::vector<gfx::Rect>(1, gfx::Rect(size)), base::Closure(),
+      &needs_full_paint, &scheduled_completion_callback);
+  EXPECT_FALSE(needs_full_paint);
+}
+
+// Gives each of |hosts| from |first| on a backing store big enough to count as
+// a tab, until one of them evicts another backing store. Returns the index of
+// that host, or |hosts|.size() if nothing was evicted.
+static size_t PrepareBackingStoresUntilEviction(
+    const std::vector<MockRenderWidgetHost*>& hosts,
+    size_t first) {
+  for (size_t i = first; i < hosts.size(); ++i) {
+    size_t memory = BackingStoreManager::MemorySize();
+    PrepareBackingStore(hosts[i], gfx::Size(400, 400));
+    if (BackingStoreManager::MemorySize() == memory)
+      return i;
+  }
+  return hosts.size();
+}
+
+// Tests that the backing store of a hidden widget is evicted before those of
+// visible widgets that were used less recently.
+TEST_F(RenderWidgetHostTest, BackingStoreEvictsHiddenFirst) {
+  // No more than five backing stores of this size are kept, so the last
+  // widgets always evict one.
+  ScopedVector<MockRenderWidgetHost> hosts;
+  ScopedVector<TestView> views;
+  for (size_t i = 0; i < 7; ++i) {
+    hosts.push_back(new MockRenderWidgetHost(process_, MSG_ROUTING_NONE));
+    views.push_back(new TestView(hosts[i]));
+    hosts[i]->SetView(views[i]);
+  }
+  hosts[1]->is_hidden_ = true;
+
+  ASSERT_LT(PrepareBackingStoresUntilEviction(hosts.get(), 0), hosts.size());
+  EXPECT_TRUE(BackingStoreManager::Lookup(hosts[0]));
+  EXPECT_FALSE(BackingStoreManager::Lookup(hosts[1]));
+}
+
+// Tests that an evicted backing store is rebuilt from its pixels when its
+// widget needs it again.
+TEST_F(RenderWidgetHostTest, BackingStoreRestoredAfterEviction) {
+  ScopedVector<MockRenderWidgetHost> hosts;
+  ScopedVector<TestView> views;
+  for (size_t i = 0; i < 7; ++i) {
+    hosts.push_back(new MockRenderWidgetHost(process_, MSG_ROUTING_NONE));
+    views.push_back(i == 0 ? new PixelTestView(hosts[i])
+                           : new TestView(hosts[i]));
+    hosts[i]->SetView(views[i]);
+  }
+
+  const gfx::Size size(400, 400);
+  PrepareBackingStore(hosts[0], size);
+  PixelBackingStore* backing = static_cast<PixelBackingStore*>(
+      BackingStoreManager::Lookup(hosts[0]));
+  ASSERT_TRUE(backing);
+  backing->set_color(SK_ColorBLUE);
+  hosts[0]->is_hidden_ = true;
+
+  // Being hidden, the first widget's backing store is the one evicted.
+  ASSERT_LT(PrepareBackingStoresUntilEviction(hosts.get(), 1), hosts.size());
+
+  backing = static_cast<PixelBackingStore*>(
+      BackingStoreManager::Lookup(hosts[0]));
+  ASSERT_TRUE(backing);
+  EXPECT_EQ(size, backing->size());
+  EXPECT_EQ(SK_ColorBLUE, backing->color());
+
+  // The pixels are used up; once the backing store is removed, there is
+  // nothing left to rebuild it from.
+  BackingStoreManager::RemoveBackingStore(hosts[0]);
+  EXPECT_FALSE(BackingStoreManager::Lookup(hosts[0]));
+}
+
 TEST_F(RenderWidgetHostTest, PaintAtSize) {
   const int kPaintAtSizeTag = 42;
   host_->PaintAtSize(TransportDIB::GetFakeHandleForTest(), kPaintAtSizeTag,
@@ -41,6 +41,7 @@
 #include "content/browser/renderer_host/resource_message_filter.h"
 #include "content/public/browser/resource_request_details.h"
 #include "content/browser/renderer_host/resource_request_info_impl.h"
+#include "content/browser/renderer_host/resource_scheduler.h"
 #include "content/browser/renderer_host/sync_resource_handler.h"
 #include "content/browser/renderer_host/throttling_resource_handler.h"
 #include "content/browser/resource_context_impl.h"
@@ -343,6 +344,9 @@ ResourceDispatcherHostImpl::ResourceDispatcherHostImpl()
 
   update_load_states_timer_.reset(
       new base::RepeatingTimer<ResourceDispatcherHostImpl>());
+  scheduler_.reset(new ResourceScheduler(
+      base::Bind(&ResourceDispatcherHostImpl::StartScheduledRequest,
+                 base::Unretained(this))));
 }
 
 ResourceDispatcherHostImpl::~ResourceDispatcherHostImpl() {
@@ -616,6 +620,7 @@ void ResourceDispatcherHostImpl::OnShutdown() {
   for (PendingRequestList::const_iterator i = pending_requests_.begin();
        i != pending_requests_.end(); ++i) {
     transferred_navigations_.erase(i->first);
+    scheduler_->RemoveRequest(i->second);
   }
   STLDeleteValues(&pending_requests_);
   // Make sure we shutdown the timer now, otherwise by the time our destructor
@@ -977,6 +982,7 @@ void ResourceDispatcherHostImpl::DataReceivedACK(int child_id,
 
   // Decrement the number of pending data messages.
   info->DecrementPendingDataCount();
+  info->IncrementDataAckCount();
 
   // If the pending data count was higher than the max, resume the request.
   if (info->pending_data_count() == kMaxPendingDataMessages) {
@@ -1302,6 +1308,7 @@ int ResourceDispatcherHostImpl::GetOutstandingRequestsMemoryCost(
 void ResourceDispatcherHostImpl::CancelRequestsForProcess(int child_id) {
   CancelRequestsForRoute(child_id, -1 /* cancel all */);
   registered_temp_files_.erase(child_id);
+  scheduler_->OnProcessDeleted(child_id);
 }
 
 void ResourceDispatcherHostImpl::CancelRequestsForRoute(int child_id,
@@ -1402,6 +1409,7 @@ void ResourceDispatcherHostImpl::RemovePendingRequest(
     info->ssl_client_auth_handler()->OnRequestCancelled();
   transferred_navigations_.erase(
       GlobalRequestID(info->GetChildID(), info->GetRequestID()));
+  scheduler_->RemoveRequest(iter->second);
 
   delete iter->second;
   pending_requests_.erase(iter);
@@ -1767,6 +1775,16 @@ void ResourceDispatcherHostImpl::BeginRequestInternal(
 }
 
 void ResourceDispatcherHostImpl::StartRequest(net::URLRequest* request) {
+  ResourceRequestInfoImpl* info = ResourceRequestInfoImpl::ForRequest(request);
+  scheduler_->ScheduleRequest(info->GetChildID(), info->GetRouteID(), request);
+}
+
+void ResourceDispatcherHostImpl::StartScheduledRequest(
+    net::URLRequest* request) {
+  // A request cancelled while it waited is finished by ResponseCompleted.
+  if (is_shutdown_ || !request->status().is_success())
+    return;
+
   request->Start();
 
   // Make sure we have the load state monitor running
@@ -2306,6 +2324,12 @@ void ResourceDispatcherHostImpl::ProcessBlockedRequestsForRoute(
   delete requests;
 }
 
+void ResourceDispatcherHostImpl::OnRouteVisibilityChanged(int child_id,
+                                                          int route_id,
+                                                          bool visible) {
+  scheduler_->OnVisibilityChanged(child_id, route_id, visible);
+}
+
 bool ResourceDispatcherHostImpl::IsValidRequest(net::URLRequest* request) {
   if (!request)
     return false;
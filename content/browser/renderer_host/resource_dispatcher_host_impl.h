@@ -55,6 +55,7 @@ namespace content {
 class ResourceContext;
 class ResourceDispatcherHostDelegate;
 class ResourceRequestInfoImpl;
+class ResourceScheduler;
 struct DownloadSaveInfo;
 struct GlobalRequestID;
 
@@ -225,6 +226,10 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
   // Cancels any blocked request for the specified route id.
   void CancelBlockedRequestsForRoute(int child_id, int route_id);
 
+  // Called when the view identified by |child_id| and |route_id| is shown or
+  // hidden, so that the requests of visible views can go first.
+  void OnRouteVisibilityChanged(int child_id, int route_id, bool visible);
+
   // Decrements the pending_data_count for the request and resumes
   // the request if it was paused due to too many pending data
   // messages sent.
@@ -286,7 +291,10 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
   // this method with the proper value for the timed_out parameter.
   void HandleSwapOutACK(const ViewMsg_SwapOut_Params& params, bool timed_out);
 
+  // Hands |request| to |scheduler_|, which calls StartScheduledRequest when
+  // it is time to start it.
   void StartRequest(net::URLRequest* request);
+  void StartScheduledRequest(net::URLRequest* request);
 
   // Returns true if the request is paused.
   bool PauseRequestIfNeeded(ResourceRequestInfoImpl* info);
@@ -475,6 +483,9 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
   // True if the resource dispatcher host has been shut down.
   bool is_shutdown_;
 
+  // Decides when the requests of each view start.
+  scoped_ptr<ResourceScheduler> scheduler_;
+
   typedef std::vector<net::URLRequest*> BlockedRequestsList;
   typedef std::pair<int, int> ProcessRouteIDs;
   typedef std::map<ProcessRouteIDs, BlockedRequestsList*> BlockedRequestMap;
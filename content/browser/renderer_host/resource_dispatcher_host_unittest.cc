@@ -8,9 +8,11 @@
 
 #include "base/bind.h"
 #include "base/file_path.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/message_loop.h"
 #include "base/process_util.h"
+#include "base/shared_memory.h"
 #include "content/browser/browser_thread_impl.h"
 #include "content/browser/child_process_security_policy_impl.h"
 #include "content/browser/renderer_host/resource_dispatcher_host_impl.h"
@@ -63,6 +65,8 @@ static int RequestIDForMessage(const IPC::Message& msg) {
     case ResourceMsg_ReceivedResponse::ID:
     case ResourceMsg_ReceivedRedirect::ID:
     case ResourceMsg_DataReceived::ID:
+    case ResourceMsg_SetDataBuffer::ID:
+    case ResourceMsg_DataReceivedInBuffer::ID:
     case ResourceMsg_RequestComplete::ID:
       request_id = IPC::MessageIterator(msg).NextInt();
       break;
@@ -188,6 +192,108 @@ class ForwardingFilter : public ResourceMessageFilter {
   DISALLOW_COPY_AND_ASSIGN(ForwardingFilter);
 };
 
+// Plays the renderer for requests whose data may come in a data buffer. It
+// puts the data back together and, like ResourceDispatcher, acknowledges each
+// data message once it has handled it, here in a task of its own.
+class DataBufferRenderer : public IPC::Message::Sender {
+ public:
+  explicit DataBufferRenderer(ResourceDispatcherHostImpl* host)
+      : host_(host),
+        child_id_(-1),
+        data_buffer_size_(0),
+        data_received_count_(0),
+        data_in_buffer_count_(0),
+        last_offset_(-1),
+        wrapped_(false),
+        complete_(false) {
+  }
+
+  void set_child_id(int child_id) { child_id_ = child_id; }
+
+  // IPC::Message::Sender implementation
+  virtual bool Send(IPC::Message* msg) OVERRIDE {
+    scoped_ptr<IPC::Message> message(msg);
+    PickleIterator iter(*msg);
+    int request_id;
+    EXPECT_TRUE(IPC::ReadParam(msg, &iter, &request_id));
+
+    switch (msg->type()) {
+      case ResourceMsg_DataReceived::ID: {
+        base::SharedMemoryHandle shm_handle;
+        int data_len;
+        EXPECT_TRUE(IPC::ReadParam(msg, &iter, &shm_handle));
+        EXPECT_TRUE(IPC::ReadParam(msg, &iter, &data_len));
+        base::SharedMemory shared_mem(shm_handle, true);  // read only
+        EXPECT_TRUE(shared_mem.Map(data_len));
+        data_.append(static_cast<char*>(shared_mem.memory()), data_len);
+        data_received_count_++;
+        PostDataReceivedACK(request_id);
+        break;
+      }
+      case ResourceMsg_SetDataBuffer::ID: {
+        base::SharedMemoryHandle shm_handle;
+        EXPECT_FALSE(data_buffer_.get());
+        EXPECT_TRUE(IPC::ReadParam(msg, &iter, &shm_handle));
+        EXPECT_TRUE(IPC::ReadParam(msg, &iter, &data_buffer_size_));
+        data_buffer_.reset(new base::SharedMemory(shm_handle, true));
+        EXPECT_TRUE(data_buffer_->Map(data_buffer_size_));
+        break;
+      }
+      case ResourceMsg_DataReceivedInBuffer::ID: {
+        int data_offset;
+        int data_length;
+        EXPECT_TRUE(IPC::ReadParam(msg, &iter, &data_offset));
+        EXPECT_TRUE(IPC::ReadParam(msg, &iter, &data_length));
+        EXPECT_TRUE(data_buffer_.get());
+        EXPECT_GE(data_offset, 0);
+        EXPECT_GT(data_length, 0);
+        EXPECT_LE(data_offset + data_length, data_buffer_size_);
+        if (data_buffer_.get()) {
+          data_.append(static_cast<char*>(data_buffer_->memory()) + data_offset,
+                       data_length);
+        }
+        if (data_offset < last_offset_)
+          wrapped_ = true;
+        last_offset_ = data_offset;
+        data_in_buffer_count_++;
+        PostDataReceivedACK(request_id);
+        break;
+      }
+      case ResourceMsg_RequestComplete::ID:
+        complete_ = true;
+        break;
+    }
+    return true;
+  }
+
+  const std::string& data() const { return data_; }
+  int data_received_count() const { return data_received_count_; }
+  int data_in_buffer_count() const { return data_in_buffer_count_; }
+  bool wrapped() const { return wrapped_; }
+  bool complete() const { return complete_; }
+
+ private:
+  void PostDataReceivedACK(int request_id) {
+    MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&ResourceDispatcherHostImpl::DataReceivedACK,
+                   base::Unretained(host_), child_id_, request_id));
+  }
+
+  ResourceDispatcherHostImpl* host_;
+  int child_id_;
+  scoped_ptr<base::SharedMemory> data_buffer_;
+  int data_buffer_size_;
+  std::string data_;
+  int data_received_count_;
+  int data_in_buffer_count_;
+  int last_offset_;
+  bool wrapped_;
+  bool complete_;
+
+  DISALLOW_COPY_AND_ASSIGN(DataBufferRenderer);
+};
+
 // This class is a variation on URLRequestTestJob in that it does
 // not complete start upon entry, only when specifically told to.
 class URLRequestTestDelayedStartJob : public net::URLRequestTestJob {
@@ -1369,6 +1475,111 @@ TEST_F(ResourceDispatcherHostTest, CancelRequestsForContextTransferred) {
   EXPECT_EQ(0, host_.pending_requests());
 }
 
+// Tests that once a response has filled its first read buffer, the rest of it
+// is read into a shared data buffer, and that reads that find no room left in
+// it fall back to a buffer of their own.
+TEST_F(ResourceDispatcherHostTest, DataBuffer) {
+  const int kDataBufferSize = 524288;
+  const int kMaxDataBufferRead = 131072;
+
+  std::string response("HTTP/1.1 200 OK\n"
+                       "Content-type: image/jpeg\n\n");
+  std::string raw_headers(net::HttpUtil::AssembleRawHeaders(response.data(),
+                                                            response.size()));
+  // More than the first read buffer and the data buffer hold together. No
+  // data is acknowledged, so the data buffer fills up.
+  std::string response_data(65536 + kDataBufferSize + 10000, 'a');
+  SetResponse(raw_headers, response_data);
+
+  HandleScheme("http");
+  MakeTestRequest(0, 1, GURL("http:bla"));
+
+  // Flush all pending requests, and the reads that were put off to let other
+  // work run.
+  while (net::URLRequestTestJob::ProcessOnePendingMessage()) {}
+  message_loop_.RunAllPending();
+
+  ResourceIPCAccumulator::ClassifiedMessages msgs;
+  accum_.GetClassifiedMessages(&msgs);
+  ASSERT_EQ(1U, msgs.size());
+  const std::vector<IPC::Message>& messages = msgs[0];
+
+  // ReceivedResponse, DataReceived, SetDataBuffer, four DataReceivedInBuffer
+  // that fill the data buffer, DataReceived and RequestComplete.
+  ASSERT_EQ(9U, messages.size());
+  EXPECT_EQ(ResourceMsg_ReceivedResponse::ID, messages[0].type());
+  EXPECT_EQ(ResourceMsg_DataReceived::ID, messages[1].type());
+  EXPECT_EQ(ResourceMsg_SetDataBuffer::ID, messages[2].type());
+  EXPECT_EQ(ResourceMsg_DataReceived::ID, messages[7].type());
+  EXPECT_EQ(ResourceMsg_RequestComplete::ID, messages[8].type());
+
+  size_t total_length = 0;
+  for (size_t i = 1; i < 8; ++i) {
+    PickleIterator iter(messages[i]);
+    int request_id;
+    ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &request_id));
+    EXPECT_EQ(1, request_id);
+    if (messages[i].type() == ResourceMsg_DataReceived::ID) {
+      base::SharedMemoryHandle shm_handle;
+      int data_len;
+      ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &shm_handle));
+      ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &data_len));
+      base::SharedMemory::CloseHandle(shm_handle);
+      total_length += data_len;
+    } else if (messages[i].type() == ResourceMsg_SetDataBuffer::ID) {
+      base::SharedMemoryHandle shm_handle;
+      int shm_size;
+      ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &shm_handle));
+      ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &shm_size));
+      base::SharedMemory::CloseHandle(shm_handle);
+      EXPECT_EQ(kDataBufferSize, shm_size);
+    } else {
+      ASSERT_EQ(ResourceMsg_DataReceivedInBuffer::ID, messages[i].type());
+      int data_offset;
+      int data_length;
+      ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &data_offset));
+      ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &data_length));
+      EXPECT_EQ(static_cast<int>(i - 3) * kMaxDataBufferRead, data_offset);
+      EXPECT_EQ(kMaxDataBufferRead, data_length);
+      total_length += data_length;
+    }
+  }
+  EXPECT_EQ(response_data.size(), total_length);
+}
+
+// Tests that the data buffer is reused once the renderer acknowledges the
+// data in it, so that a response much bigger than it goes through it whole.
+TEST_F(ResourceDispatcherHostTest, DataBufferReused) {
+  std::string response("HTTP/1.1 200 OK\n"
+                       "Content-type: image/jpeg\n\n");
+  std::string raw_headers(net::HttpUtil::AssembleRawHeaders(response.data(),
+                                                            response.size()));
+  std::string response_data(2 * 1024 * 1024, 0);
+  for (size_t i = 0; i < response_data.size(); ++i)
+    response_data[i] = static_cast<char>(i * 7 + i / 4096);
+  SetResponse(raw_headers, response_data);
+
+  DataBufferRenderer renderer(&host_);
+  scoped_refptr<ForwardingFilter> filter = new ForwardingFilter(
+      &renderer, browser_context_->GetResourceContext());
+  renderer.set_child_id(filter->child_id());
+
+  HandleScheme("http");
+  MakeTestRequest(filter.get(), 0, 1, GURL("http:bla"));
+
+  while (net::URLRequestTestJob::ProcessOnePendingMessage()) {}
+  message_loop_.RunAllPending();
+
+  EXPECT_TRUE(renderer.complete());
+  EXPECT_EQ(response_data.size(), renderer.data().size());
+  EXPECT_TRUE(response_data == renderer.data());
+
+  // Only the first read used a buffer of its own.
+  EXPECT_EQ(1, renderer.data_received_count());
+  EXPECT_GT(renderer.data_in_buffer_count(), 4);
+  EXPECT_TRUE(renderer.wrapped());
+}
+
 TEST_F(ResourceDispatcherHostTest, UnknownURLScheme) {
   EXPECT_EQ(0, host_.pending_requests());
 
@@ -111,6 +111,7 @@ ResourceRequestInfoImpl::ResourceRequestInfoImpl(
       parent_is_main_frame_(parent_is_main_frame),
       parent_frame_id_(parent_frame_id),
       pending_data_count_(0),
+      data_ack_count_(0),
       is_download_(is_download),
       allow_download_(allow_download),
       has_user_gesture_(has_user_gesture),
@@ -127,6 +127,12 @@ class ResourceRequestInfoImpl : public ResourceRequestInfo,
   void IncrementPendingDataCount() { pending_data_count_++; }
   void DecrementPendingDataCount() { pending_data_count_--; }
 
+  // Number of data messages the renderer has acknowledged. Unlike
+  // pending_data_count(), this is not adjusted when the request is paused,
+  // so it tells exactly which of the messages sent so far were processed.
+  int data_ack_count() const { return data_ack_count_; }
+  void IncrementDataAckCount() { data_ack_count_++; }
+
   // Downloads are allowed only as a top level request.
   bool allow_download() const { return allow_download_; }
 
@@ -227,6 +233,7 @@ class ResourceRequestInfoImpl : public ResourceRequestInfo,
   bool parent_is_main_frame_;
   int64 parent_frame_id_;
   int pending_data_count_;
+  int data_ack_count_;
   bool is_download_;
   bool allow_download_;
   bool has_user_gesture_;
@@ -0,0 +1,171 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/resource_scheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+#include "net/url_request/url_request.h"
+
+namespace content {
+
+namespace {
+
+bool IsCritical(net::RequestPriority priority) {
+  return priority >= net::MEDIUM;
+}
+
+bool IsDelayable(net::RequestPriority priority) {
+  return priority <= net::LOWEST;
+}
+
+net::RequestPriority HiddenPriority(net::RequestPriority priority) {
+  return std::min(priority, net::LOWEST);
+}
+
+}  // namespace
+
+// static
+const int ResourceScheduler::kMaxDelayableRequests = 10;
+
+ResourceScheduler::RequestState::RequestState()
+    : priority(net::IDLE),
+      started(false) {
+}
+
+ResourceScheduler::Client::Client()
+    : in_flight(0),
+      critical_in_flight(0),
+      delayable_in_flight(0) {
+}
+
+ResourceScheduler::ResourceScheduler(const StartCallback& start_callback)
+    : start_callback_(start_callback) {
+}
+
+ResourceScheduler::~ResourceScheduler() {
+}
+
+void ResourceScheduler::ScheduleRequest(int child_id,
+                                        int route_id,
+                                        net::URLRequest* request) {
+  DCHECK(requests_.find(request) == requests_.end());
+  ProcessRouteIDs ids(child_id, route_id);
+
+  RequestState& state = requests_[request];
+  state.ids = ids;
+  state.priority = request->priority();
+  if (hidden_routes_.find(ids) != hidden_routes_.end())
+    request->set_priority(HiddenPriority(state.priority));
+
+  std::deque<net::URLRequest*>& pending = clients_[ids].pending;
+  std::deque<net::URLRequest*>::iterator it = pending.end();
+  while (it != pending.begin() &&
+         requests_[*(it - 1)].priority < state.priority) {
+    --it;
+  }
+  pending.insert(it, request);
+
+  StartPendingRequests(ids);
+}
+
+void ResourceScheduler::RemoveRequest(net::URLRequest* request) {
+  RequestMap::iterator it = requests_.find(request);
+  if (it == requests_.end())
+    return;
+  ProcessRouteIDs ids = it->second.ids;
+  Client& client = clients_[ids];
+
+  if (it->second.started) {
+    client.in_flight--;
+    if (IsCritical(it->second.priority))
+      client.critical_in_flight--;
+    if (IsDelayable(it->second.priority))
+      client.delayable_in_flight--;
+  } else {
+    client.pending.erase(
+        std::find(client.pending.begin(), client.pending.end(), request));
+  }
+  requests_.erase(it);
+
+  if (!client.in_flight && client.pending.empty())
+    clients_.erase(ids);
+  else
+    StartPendingRequests(ids);
+}
+
+void ResourceScheduler::OnVisibilityChanged(int child_id,
+                                            int route_id,
+                                            bool visible) {
+  ProcessRouteIDs ids(child_id, route_id);
+  if (visible)
+    hidden_routes_.erase(ids);
+  else
+    hidden_routes_.insert(ids);
+
+  for (RequestMap::iterator it = requests_.begin(); it != requests_.end();
+       ++it) {
+    if (it->second.ids != ids)
+      continue;
+    it->first->set_priority(visible ? it->second.priority :
+                                      HiddenPriority(it->second.priority));
+  }
+}
+
+void ResourceScheduler::OnProcessDeleted(int child_id) {
+  std::set<ProcessRouteIDs>::iterator it = hidden_routes_.begin();
+  while (it != hidden_routes_.end()) {
+    if (it->first == child_id)
+      hidden_routes_.erase(it++);
+    else
+      ++it;
+  }
+}
+
+bool ResourceScheduler::IsRequestDelayed(net::URLRequest* request) const {
+  RequestMap::const_iterator it = requests_.find(request);
+  return it != requests_.end() && !it->second.started;
+}
+
+void ResourceScheduler::StartPendingRequests(const ProcessRouteIDs& ids) {
+  // The requests are started once the bookkeeping is done, since starting
+  // one may remove others.
+  std::vector<net::URLRequest*> to_start;
+  Client& client = clients_[ids];
+  while (!client.pending.empty()) {
+    net::URLRequest* request = client.pending.front();
+    RequestState& state = requests_[request];
+    // The pending requests are in priority order, so none after one that
+    // must wait may start either.
+    if (!CanStart(client, state.priority))
+      break;
+    client.pending.pop_front();
+    state.started = true;
+    client.in_flight++;
+    if (IsCritical(state.priority))
+      client.critical_in_flight++;
+    if (IsDelayable(state.priority))
+      client.delayable_in_flight++;
+    to_start.push_back(request);
+  }
+
+  for (size_t i = 0; i < to_start.size(); ++i) {
+    if (requests_.find(to_start[i]) != requests_.end())
+      start_callback_.Run(to_start[i]);
+  }
+}
+
+bool ResourceScheduler::CanStart(const Client& client,
+                                 net::RequestPriority priority) const {
+  if (!IsDelayable(priority))
+    return true;
+  if (priority == net::IDLE && client.in_flight)
+    return false;
+  int limit = client.critical_in_flight ? 1 : kMaxDelayableRequests;
+  return client.delayable_in_flight < limit;
+}
+
+}  // namespace content
@@ -0,0 +1,111 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_RENDERER_HOST_RESOURCE_SCHEDULER_H_
+#define CONTENT_BROWSER_RENDERER_HOST_RESOURCE_SCHEDULER_H_
+#pragma once
+
+#include <deque>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "content/common/content_export.h"
+#include "net/base/request_priority.h"
+
+namespace net {
+class URLRequest;
+}
+
+namespace content {
+
+// Decides when the requests of each view start, so that the requests a page
+// needs to render get the network before those it can do without for now.
+//
+// Requests of LOWEST and IDLE priority (images, favicons, prefetches) are
+// "delayable". While a view has a request of MEDIUM or higher priority (a
+// frame, a stylesheet, a script or a font) in flight, only one delayable
+// request of that view is in flight at a time; otherwise up to
+// |kMaxDelayableRequests| are. IDLE requests also wait for the view to have
+// nothing else in flight. Other requests start right away.
+//
+// The requests of hidden views are lowered to LOWEST priority, so that the
+// network stack serves the views the user is looking at first. They get their
+// priority back when the view is shown again.
+//
+// Lives on the IO thread.
+class CONTENT_EXPORT ResourceScheduler {
+ public:
+  typedef base::Callback<void(net::URLRequest*)> StartCallback;
+
+  // The most delayable requests of one view in flight at once.
+  static const int kMaxDelayableRequests;
+
+  // |start_callback| is run to start each request.
+  explicit ResourceScheduler(const StartCallback& start_callback);
+  ~ResourceScheduler();
+
+  // Starts |request|, which belongs to the view |route_id| of |child_id|,
+  // now or once the requests ahead of it allow.
+  void ScheduleRequest(int child_id, int route_id, net::URLRequest* request);
+
+  // Forgets |request|, which is done or about to be deleted, and starts the
+  // requests it was holding back. Does nothing for requests it doesn't know.
+  void RemoveRequest(net::URLRequest* request);
+
+  // Called when the view |route_id| of |child_id| is shown or hidden.
+  void OnVisibilityChanged(int child_id, int route_id, bool visible);
+
+  // Forgets the views of |child_id|, whose process is gone.
+  void OnProcessDeleted(int child_id);
+
+  // Returns whether |request| was scheduled and is waiting to start.
+  bool IsRequestDelayed(net::URLRequest* request) const;
+
+ private:
+  typedef std::pair<int, int> ProcessRouteIDs;
+
+  struct RequestState {
+    RequestState();
+
+    ProcessRouteIDs ids;
+    // The priority the request was scheduled with, which is what it is
+    // scheduled by and what it goes back to when its view is shown.
+    net::RequestPriority priority;
+    bool started;
+  };
+
+  // The requests of one view.
+  struct Client {
+    Client();
+
+    // The requests waiting to start, highest priority first, in the order
+    // they were scheduled within one priority.
+    std::deque<net::URLRequest*> pending;
+    int in_flight;
+    int critical_in_flight;
+    int delayable_in_flight;
+  };
+
+  typedef std::map<net::URLRequest*, RequestState> RequestMap;
+  typedef std::map<ProcessRouteIDs, Client> ClientMap;
+
+  // Starts the pending requests of |ids| that may start now.
+  void StartPendingRequests(const ProcessRouteIDs& ids);
+
+  bool CanStart(const Client& client, net::RequestPriority priority) const;
+
+  StartCallback start_callback_;
+  RequestMap requests_;
+  ClientMap clients_;
+  std::set<ProcessRouteIDs> hidden_routes_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResourceScheduler);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_RENDERER_HOST_RESOURCE_SCHEDULER_H_
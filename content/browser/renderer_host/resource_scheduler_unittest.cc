@@ -0,0 +1,143 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/resource_scheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/memory/scoped_vector.h"
+#include "base/message_loop.h"
+#include "googleurl/src/gurl.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+const int kChildId = 30;
+const int kRouteId = 75;
+
+class ResourceSchedulerTest : public testing::Test {
+ protected:
+  ResourceSchedulerTest()
+      : scheduler_(base::Bind(&ResourceSchedulerTest::OnStart,
+                              base::Unretained(this))) {
+  }
+
+  // Schedules a new request of |priority| for the test view.
+  net::URLRequest* Schedule(net::RequestPriority priority) {
+    net::URLRequest* request =
+        new net::URLRequest(GURL("http://host/"), &delegate_);
+    request->set_priority(priority);
+    requests_.push_back(request);
+    scheduler_.ScheduleRequest(kChildId, kRouteId, request);
+    return request;
+  }
+
+  bool IsStarted(net::URLRequest* request) const {
+    return std::find(started_.begin(), started_.end(), request) !=
+        started_.end();
+  }
+
+  void OnStart(net::URLRequest* request) {
+    started_.push_back(request);
+  }
+
+  MessageLoopForIO message_loop_;
+  TestDelegate delegate_;
+  ScopedVector<net::URLRequest> requests_;
+  std::vector<net::URLRequest*> started_;
+  ResourceScheduler scheduler_;
+};
+
+TEST_F(ResourceSchedulerTest, OneDelayableWhileCriticalInFlight) {
+  net::URLRequest* script = Schedule(net::MEDIUM);
+  net::URLRequest* image1 = Schedule(net::LOWEST);
+  net::URLRequest* image2 = Schedule(net::LOWEST);
+  net::URLRequest* xhr = Schedule(net::LOW);
+  EXPECT_TRUE(IsStarted(script));
+  EXPECT_TRUE(IsStarted(image1));
+  EXPECT_FALSE(IsStarted(image2));
+  EXPECT_TRUE(scheduler_.IsRequestDelayed(image2));
+  EXPECT_TRUE(IsStarted(xhr));
+
+  scheduler_.RemoveRequest(script);
+  EXPECT_TRUE(IsStarted(image2));
+}
+
+TEST_F(ResourceSchedulerTest, DelayableLimit) {
+  std::vector<net::URLRequest*> images;
+  for (int i = 0; i <= ResourceScheduler::kMaxDelayableRequests; ++i)
+    images.push_back(Schedule(net::LOWEST));
+  EXPECT_EQ(static_cast<size_t>(ResourceScheduler::kMaxDelayableRequests),
+            started_.size());
+  EXPECT_FALSE(IsStarted(images.back()));
+
+  scheduler_.RemoveRequest(images.front());
+  EXPECT_TRUE(IsStarted(images.back()));
+}
+
+TEST_F(ResourceSchedulerTest, IdleWaitsForEverythingElse) {
+  net::URLRequest* xhr = Schedule(net::LOW);
+  net::URLRequest* prefetch = Schedule(net::IDLE);
+  EXPECT_FALSE(IsStarted(prefetch));
+
+  scheduler_.RemoveRequest(xhr);
+  EXPECT_TRUE(IsStarted(prefetch));
+}
+
+TEST_F(ResourceSchedulerTest, HigherPriorityDelayedRequestsGoFirst) {
+  net::URLRequest* script = Schedule(net::MEDIUM);
+  Schedule(net::LOWEST);
+  net::URLRequest* prefetch = Schedule(net::IDLE);
+  net::URLRequest* image = Schedule(net::LOWEST);
+
+  scheduler_.RemoveRequest(script);
+  EXPECT_TRUE(IsStarted(image));
+  EXPECT_FALSE(IsStarted(prefetch));
+}
+
+TEST_F(ResourceSchedulerTest, RemoveDelayedRequest) {
+  Schedule(net::MEDIUM);
+  Schedule(net::LOWEST);
+  net::URLRequest* image = Schedule(net::LOWEST);
+  scheduler_.RemoveRequest(image);
+  EXPECT_FALSE(scheduler_.IsRequestDelayed(image));
+  EXPECT_FALSE(IsStarted(image));
+}
+
+TEST_F(ResourceSchedulerTest, OtherViewsAreIndependent) {
+  Schedule(net::MEDIUM);
+  Schedule(net::LOWEST);
+  net::URLRequest* other = new net::URLRequest(GURL("http://host/"),
+                                               &delegate_);
+  other->set_priority(net::LOWEST);
+  requests_.push_back(other);
+  scheduler_.ScheduleRequest(kChildId, kRouteId + 1, other);
+  EXPECT_TRUE(IsStarted(other));
+}
+
+TEST_F(ResourceSchedulerTest, HiddenViewsAreDeprioritized) {
+  net::URLRequest* frame = Schedule(net::HIGHEST);
+  scheduler_.OnVisibilityChanged(kChildId, kRouteId, false);
+  EXPECT_EQ(net::LOWEST, frame->priority());
+
+  // Requests scheduled while hidden start lowered too, but are still
+  // scheduled by the priority they asked for.
+  net::URLRequest* script = Schedule(net::MEDIUM);
+  EXPECT_EQ(net::LOWEST, script->priority());
+  EXPECT_TRUE(IsStarted(script));
+
+  scheduler_.OnVisibilityChanged(kChildId, kRouteId, true);
+  EXPECT_EQ(net::HIGHEST, frame->priority());
+  EXPECT_EQ(net::MEDIUM, script->priority());
+}
+
+}  // namespace
+
+}  // namespace content
@@ -320,8 +320,22 @@ void TraceControllerImpl::OnTraceDataCollected(
   }
 
   // Drop trace events if we are just getting categories.
-  if (subscriber_ && !is_get_categories_)
-    subscriber_->OnTraceDataCollected(events_str_ptr);
+  if (!subscriber_ || is_get_categories_)
+    return;
+
+  // Processes tracing in one of the per-thread recording modes send binary
+  // fragments; subscribers only ever see JSON.
+  scoped_refptr<base::RefCountedString> json_events_str_ptr = events_str_ptr;
+  if (base::debug::TraceResultBuffer::IsBinaryFragment(
+          events_str_ptr->data())) {
+    json_events_str_ptr = new base::RefCountedString();
+    if (!base::debug::TraceResultBuffer::AppendBinaryFragmentAsJSON(
+            events_str_ptr->data(), &json_events_str_ptr->data())) {
+      DLOG(ERROR) << "Dropping malformed binary trace fragment";
+      return;
+    }
+  }
+  subscriber_->OnTraceDataCollected(json_events_str_ptr);
 }
 
 void TraceControllerImpl::OnTraceBufferFull() {
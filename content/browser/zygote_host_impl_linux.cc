@@ -121,6 +121,7 @@ void ZygoteHostImpl::Init(const std::string& sandbox_cmd) {
     switches::kRegisterPepperPlugins,
     switches::kDisableSeccompSandbox,
     switches::kEnableSeccompSandbox,
+    switches::kZygoteSpareRenderers,
   };
   cmd_line.CopySwitchesFrom(browser_command_line, kForwardSwitches,
                             arraysize(kForwardSwitches));
@@ -14,6 +14,9 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <deque>
+
 #include "base/basictypes.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
@@ -28,7 +31,9 @@
 #include "base/process_util.h"
 #include "base/rand_util.h"
 #include "base/rand_util_c.h"
+#include "base/string_number_conversions.h"
 #include "base/sys_info.h"
+#include "base/time.h"
 #include "build/build_config.h"
 #include "crypto/nss_util.h"
 #include "content/common/chrome_descriptors.h"
@@ -69,6 +74,13 @@ static bool g_suid_sandbox_active = false;
 
 static const char kUrandomDevPath[] = "/dev/urandom";
 
+// The most spare renderers the zygote keeps when --zygote-spare-renderers
+// isn't given.
+static const int kDefaultMaxSpareRenderers = 2;
+// The zygote keeps as many spare renderers as it was asked for renderers in
+// this many seconds, and at least one.
+static const int kSpareRendererWindowSeconds = 10;
+
 #if defined(SECCOMP_SANDBOX)
 static int g_proc_fd = -1;
 #endif
@@ -102,11 +114,23 @@ class Zygote {
       : sandbox_flags_(sandbox_flags),
         helper_(helper),
         initial_uma_sample_(0),
-        initial_uma_boundary_value_(0) {
+        initial_uma_boundary_value_(0),
+        max_spare_renderers_(kDefaultMaxSpareRenderers) {
     if (helper_)
       helper_->InitialUMA(&initial_uma_name_,
                           &initial_uma_sample_,
                           &initial_uma_boundary_value_);
+    const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+    if (command_line.HasSwitch(switches::kZygoteSpareRenderers)) {
+      int max_spares;
+      if (base::StringToInt(command_line.GetSwitchValueASCII(
+              switches::kZygoteSpareRenderers), &max_spares) &&
+          max_spares >= 0) {
+        max_spare_renderers_ = max_spares;
+      } else {
+        LOG(WARNING) << "Bad --" << switches::kZygoteSpareRenderers;
+      }
+    }
   }
 
   bool ProcessRequests() {
@@ -141,7 +165,9 @@ class Zygote {
     }
 
     for (;;) {
-      // This function call can return multiple times, once per fork().
+      // Both calls can return multiple times, once per fork().
+      if (FillSparePool())
+        return true;
       if (HandleRequestFromBrowser(kBrowserDescriptor))
         return true;
     }
@@ -400,98 +426,273 @@ class Zygote {
     return -1;
   }
 
-  // Unpacks process type and arguments from |pickle| and forks a new process.
-  // Returns -1 on error, otherwise returns twice, returning 0 to the child
-  // process and the child process ID to the parent process, like fork().
-  base::ProcessId ReadArgsAndFork(const Pickle& pickle,
-                                  PickleIterator iter,
-                                  std::vector<int>& fds,
-                                  std::string* uma_name,
-                                  int* uma_sample,
-                                  int* uma_boundary_value) {
-    std::vector<std::string> args;
+  // Unpacks process type, arguments and descriptor mapping from |pickle|.
+  // Returns false if the request is malformed.
+  bool ReadArgs(const Pickle& pickle,
+                PickleIterator iter,
+                const std::vector<int>& fds,
+                std::string* process_type,
+                std::vector<std::string>* args,
+                base::GlobalDescriptors::Mapping* mapping,
+                std::string* channel_id) {
     int argc = 0;
     int numfds = 0;
-    base::GlobalDescriptors::Mapping mapping;
-    std::string process_type;
-    std::string channel_id;
     const std::string channel_id_prefix = std::string("--")
         + switches::kProcessChannelID + std::string("=");
 
-    if (!pickle.ReadString(&iter, &process_type))
-      return -1;
+    if (!pickle.ReadString(&iter, process_type))
+      return false;
     if (!pickle.ReadInt(&iter, &argc))
-      return -1;
+      return false;
 
     for (int i = 0; i < argc; ++i) {
       std::string arg;
       if (!pickle.ReadString(&iter, &arg))
-        return -1;
-      args.push_back(arg);
+        return false;
+      args->push_back(arg);
       if (arg.compare(0, channel_id_prefix.length(), channel_id_prefix) == 0)
-        channel_id = arg;
+        *channel_id = arg;
     }
 
     if (!pickle.ReadInt(&iter, &numfds))
-      return -1;
+      return false;
     if (numfds != static_cast<int>(fds.size()))
-      return -1;
+      return false;
 
     for (int i = 0; i < numfds; ++i) {
       base::GlobalDescriptors::Key key;
       if (!pickle.ReadUInt32(&iter, &key))
-        return -1;
-      mapping.push_back(std::make_pair(key, fds[i]));
+        return false;
+      mapping->push_back(std::make_pair(key, fds[i]));
     }
 
-    mapping.push_back(std::make_pair(
+    mapping->push_back(std::make_pair(
         static_cast<uint32_t>(kSandboxIPCChannel), kMagicSandboxIPCDescriptor));
+    return true;
+  }
 
-    // Returns twice, once per process.
-    base::ProcessId child_pid = ForkWithRealPid(process_type, fds, channel_id,
-                                                uma_name, uma_sample,
-                                                uma_boundary_value);
-    if (!child_pid) {
-      // This is the child process.
+  // Closes the descriptors that only the zygote itself uses. Every child of
+  // the zygote does this first, so that spares see the zygote go away and the
+  // browser's sockets are not kept open by processes waiting to be renderers.
+  void CloseZygoteDescriptors() {
+    close(kBrowserDescriptor);  // our socket from the browser
+    if (g_suid_sandbox_active)
+      close(kZygoteIdDescriptor);  // another socket from the browser
+    CloseSpareSockets();
+  }
+
+  // Turns a freshly forked child into the process described by |args| and
+  // |mapping|.
+  void SetUpChild(const std::vector<std::string>& args,
+                  const base::GlobalDescriptors::Mapping& mapping) {
 #if defined(SECCOMP_SANDBOX)
-      if (SeccompSandboxEnabled() && g_proc_fd >= 0) {
-        // Try to open /proc/self/maps as the seccomp sandbox needs access to it
-        int proc_self_maps = openat(g_proc_fd, "self/maps", O_RDONLY);
-        if (proc_self_maps >= 0) {
-          SeccompSandboxSetProcSelfMaps(proc_self_maps);
-        } else {
-          PLOG(ERROR) << "openat(/proc/self/maps)";
-        }
-        close(g_proc_fd);
-        g_proc_fd = -1;
+    if (SeccompSandboxEnabled() && g_proc_fd >= 0) {
+      // Try to open /proc/self/maps as the seccomp sandbox needs access to it
+      int proc_self_maps = openat(g_proc_fd, "self/maps", O_RDONLY);
+      if (proc_self_maps >= 0) {
+        SeccompSandboxSetProcSelfMaps(proc_self_maps);
+      } else {
+        PLOG(ERROR) << "openat(/proc/self/maps)";
       }
+      close(g_proc_fd);
+      g_proc_fd = -1;
+    }
 #endif
 
-      close(kBrowserDescriptor);  // our socket from the browser
-      if (g_suid_sandbox_active)
-        close(kZygoteIdDescriptor);  // another socket from the browser
-      base::GlobalDescriptors::GetInstance()->Reset(mapping);
+    base::GlobalDescriptors::GetInstance()->Reset(mapping);
 
 #if defined(CHROMIUM_SELINUX)
-      SELinuxTransitionToTypeOrDie("chromium_renderer_t");
+    SELinuxTransitionToTypeOrDie("chromium_renderer_t");
 #endif
 
-      // Reset the process-wide command line to our new command line.
-      CommandLine::Reset();
-      CommandLine::Init(0, NULL);
-      CommandLine::ForCurrentProcess()->InitFromArgv(args);
+    // Reset the process-wide command line to our new command line.
+    CommandLine::Reset();
+    CommandLine::Init(0, NULL);
+    CommandLine::ForCurrentProcess()->InitFromArgv(args);
+
+    // Update the process title. The argv was already cached by the call to
+    // SetProcessTitleFromCommandLine in ChromeMain, so we can pass NULL here
+    // (we don't have the original argv at this point).
+    SetProcessTitleFromCommandLine(NULL);
+  }
+
+  // Unpacks process type and arguments from |pickle| and forks a new process.
+  // Returns -1 on error, otherwise returns twice, returning 0 to the child
+  // process and the child process ID to the parent process, like fork().
+  base::ProcessId ReadArgsAndFork(const Pickle& pickle,
+                                  PickleIterator iter,
+                                  std::vector<int>& fds,
+                                  std::string* uma_name,
+                                  int* uma_sample,
+                                  int* uma_boundary_value) {
+    std::vector<std::string> args;
+    base::GlobalDescriptors::Mapping mapping;
+    std::string process_type;
+    std::string channel_id;
+
+    if (!ReadArgs(pickle, iter, fds, &process_type, &args, &mapping,
+                  &channel_id)) {
+      return -1;
+    }
 
-      // Update the process title. The argv was already cached by the call to
-      // SetProcessTitleFromCommandLine in ChromeMain, so we can pass NULL here
-      // (we don't have the original argv at this point).
-      SetProcessTitleFromCommandLine(NULL);
+    // Returns twice, once per process.
+    base::ProcessId child_pid = ForkWithRealPid(process_type, fds, channel_id,
+                                                uma_name, uma_sample,
+                                                uma_boundary_value);
+    if (!child_pid) {
+      // This is the child process.
+      CloseZygoteDescriptors();
+      SetUpChild(args, mapping);
     } else if (child_pid < 0) {
       LOG(ERROR) << "Zygote could not fork: process_type " << process_type
-          << " numfds " << numfds << " child_pid " << child_pid;
+          << " numfds " << fds.size() << " child_pid " << child_pid;
     }
     return child_pid;
   }
 
+  // ---------------------------------------------------------------------------
+  // Spare renderers...
+  //
+  // Forking a renderer and setting up its sandbox is on the critical path of
+  // opening a tab, so the zygote keeps a few renderers forked ahead of time.
+  // A spare waits on its end of a socketpair. A renderer fork request is
+  // passed on to a spare as is, and the spare sets itself up from it just like
+  // a child forked for the request would.
+
+  struct SpareRenderer {
+    base::ProcessId pid;
+    // The zygote's end of the socket the spare waits on.
+    int fd;
+    // The fork helper's UMA report for the spare, sent to the browser along
+    // with the pid of the spare once it is handed a request.
+    std::string uma_name;
+    int uma_sample;
+    int uma_boundary_value;
+  };
+
+  // Returns how many spare renderers to keep, going by how many renderers the
+  // browser asked for lately.
+  size_t SpareRendererTarget() {
+    if (!max_spare_renderers_)
+      return 0;
+    const base::TimeTicks cutoff = base::TimeTicks::Now() -
+        base::TimeDelta::FromSeconds(kSpareRendererWindowSeconds);
+    while (!renderer_request_times_.empty() &&
+           renderer_request_times_.front() < cutoff) {
+      renderer_request_times_.pop_front();
+    }
+    return std::max<size_t>(1, std::min<size_t>(max_spare_renderers_,
+                                                renderer_request_times_.size()));
+  }
+
+  // Forks spare renderers until there are as many as SpareRendererTarget()
+  // asks for. Returns true if we are in a spare that has been given a request
+  // and thus need to unwind back into ChromeMain.
+  bool FillSparePool() {
+    const size_t target = SpareRendererTarget();
+    while (spares_.size() < target) {
+      int sockets[2];
+      if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0) {
+        PLOG(ERROR) << "socketpair";
+        return false;
+      }
+      std::vector<int> no_fds;
+      SpareRenderer spare;
+      // Returns twice, once per process.
+      spare.pid = ForkWithRealPid(switches::kRendererProcess, no_fds,
+                                  std::string(), &spare.uma_name,
+                                  &spare.uma_sample, &spare.uma_boundary_value);
+      if (spare.pid == 0) {
+        close(sockets[0]);
+        WaitToBecomeRenderer(sockets[1]);
+        return true;
+      }
+      close(sockets[1]);
+      if (spare.pid < 0) {
+        LOG(ERROR) << "Zygote could not fork a spare renderer";
+        close(sockets[0]);
+        return false;
+      }
+      spare.fd = sockets[0];
+      spares_.push_back(spare);
+    }
+    return false;
+  }
+
+  // Runs in a spare renderer: blocks until the zygote passes on a fork
+  // request over |fd|, then sets this process up as the child it asks for.
+  // Exits if the zygote goes away first.
+  void WaitToBecomeRenderer(int fd) {
+    CloseZygoteDescriptors();
+
+    std::vector<int> fds;
+    static const unsigned kMaxMessageLength = 2048;
+    char buf[kMaxMessageLength];
+    const ssize_t len = UnixDomainSocket::RecvMsg(fd, buf, sizeof(buf), &fds);
+    if (len <= 0)
+      _exit(0);
+    close(fd);
+
+    Pickle pickle(buf, len);
+    PickleIterator iter(pickle);
+    int kind;
+    std::vector<std::string> args;
+    base::GlobalDescriptors::Mapping mapping;
+    std::string process_type;
+    std::string channel_id;
+    if (!pickle.ReadInt(&iter, &kind) || kind != ZygoteHostImpl::kCmdFork ||
+        !ReadArgs(pickle, iter, fds, &process_type, &args, &mapping,
+                  &channel_id)) {
+      // The zygote already checked the request, so this can't happen.
+      LOG(ERROR) << "Spare renderer got a bad fork request";
+      _exit(1);
+    }
+    SetUpChild(args, mapping);
+  }
+
+  // Passes the fork request in |pickle| with |fds| on to a spare renderer.
+  // Returns the spare's pid and fills in uma_name et al with the report from
+  // forking it, or returns -1 if there is no spare to take the request.
+  base::ProcessId HandToSpareRenderer(const Pickle& pickle,
+                                      const std::vector<int>& fds,
+                                      std::string* uma_name,
+                                      int* uma_sample,
+                                      int* uma_boundary_value) {
+    while (!spares_.empty()) {
+      SpareRenderer spare = spares_.front();
+      spares_.pop_front();
+      const bool sent = UnixDomainSocket::SendMsg(spare.fd, pickle.data(),
+                                                  pickle.size(), fds);
+      close(spare.fd);
+      if (sent) {
+        uma_name->swap(spare.uma_name);
+        *uma_sample = spare.uma_sample;
+        *uma_boundary_value = spare.uma_boundary_value;
+        return spare.pid;
+      }
+      // The spare died. Reap it and try the next one.
+      LOG(WARNING) << "Spare renderer " << spare.pid << " is gone";
+      base::ProcessId actual_pid = spare.pid;
+      if (g_suid_sandbox_active) {
+        actual_pid = real_pids_to_sandbox_pids[spare.pid];
+        real_pids_to_sandbox_pids.erase(spare.pid);
+      }
+      if (actual_pid)
+        base::EnsureProcessTerminated(actual_pid);
+    }
+    return -1;
+  }
+
+  // Closes the zygote's ends of the spares' sockets. Every child of the zygote
+  // does this, so that spares see the zygote go away.
+  void CloseSpareSockets() {
+    for (std::deque<SpareRenderer>::const_iterator it = spares_.begin();
+         it != spares_.end(); ++it) {
+      close(it->fd);
+    }
+    spares_.clear();
+  }
+
   // Handle a 'fork' request from the browser: this means that the browser
   // wishes to start a new renderer.  Returns true if we are in a new process,
   // otherwise writes the child_pid back to the browser via |fd|.  Writes a
@@ -501,11 +702,25 @@ class Zygote {
     std::string uma_name;
     int uma_sample;
     int uma_boundary_value;
-    base::ProcessId child_pid = ReadArgsAndFork(pickle, iter, fds,
-                                                &uma_name, &uma_sample,
-                                                &uma_boundary_value);
-    if (child_pid == 0)
-      return true;
+    base::ProcessId child_pid = -1;
+
+    std::vector<std::string> args;
+    base::GlobalDescriptors::Mapping mapping;
+    std::string process_type;
+    std::string channel_id;
+    if (ReadArgs(pickle, iter, fds, &process_type, &args, &mapping,
+                 &channel_id) &&
+        process_type == switches::kRendererProcess) {
+      renderer_request_times_.push_back(base::TimeTicks::Now());
+      child_pid = HandToSpareRenderer(pickle, fds, &uma_name, &uma_sample,
+                                      &uma_boundary_value);
+    }
+    if (child_pid < 0) {
+      child_pid = ReadArgsAndFork(pickle, iter, fds, &uma_name, &uma_sample,
+                                  &uma_boundary_value);
+      if (child_pid == 0)
+        return true;
+    }
     for (std::vector<int>::const_iterator
          i = fds.begin(); i != fds.end(); ++i)
       close(*i);
@@ -557,6 +772,13 @@ class Zygote {
   std::string initial_uma_name_;
   int initial_uma_sample_;
   int initial_uma_boundary_value_;
+
+  // The spare renderers waiting for a request, oldest first.
+  std::deque<SpareRenderer> spares_;
+  size_t max_spare_renderers_;
+  // When the browser asked for renderers within the last
+  // kSpareRendererWindowSeconds, oldest first.
+  std::deque<base::TimeTicks> renderer_request_times_;
 };
 
 // With SELinux we can carve out a precise sandbox, so we don't have to play
@@ -4,10 +4,18 @@
 
 #include "content/common/clipboard_messages.h"
 
+#include "base/memory/ref_counted_memory.h"
 #include "ui/base/clipboard/clipboard.h"
 
 namespace IPC {
 
+namespace {
+
+// Parameters at least this big are written with WriteExternalData().
+const size_t kExternalParamSize = 64 * 1024;
+
+}  // namespace
+
 void ParamTraits<ui::Clipboard::FormatType>::Write(
     Message* m, const param_type& p) {
   m->WriteString(p.Serialize());
@@ -27,4 +35,48 @@ void ParamTraits<ui::Clipboard::FormatType>::Log(
   *l = p.Serialize();
 }
 
+void ParamTraits<ui::Clipboard::ObjectMap>::Write(
+    Message* m, const param_type& p) {
+  WriteParam(m, static_cast<int>(p.size()));
+  for (param_type::const_iterator it = p.begin(); it != p.end(); ++it) {
+    WriteParam(m, it->first);
+    const ui::Clipboard::ObjectMapParams& params = it->second;
+    WriteParam(m, static_cast<int>(params.size()));
+    for (size_t i = 0; i < params.size(); ++i) {
+      const ui::Clipboard::ObjectMapParam& param = params[i];
+      // The sender of a sync message reads its header back to match the
+      // reply, which needs contiguous data.
+      if (m->is_sync() || param.size() < kExternalParamSize) {
+        WriteParam(m, param);
+        continue;
+      }
+      // |p| is const, so the data still takes one copy, but it goes into a
+      // buffer of its own rather than growing the message, and the POSIX
+      // channel sends it from there.
+      std::string data(param.begin(), param.end());
+      m->WriteExternalData(base::RefCountedString::TakeString(&data));
+    }
+  }
+}
+
+bool ParamTraits<ui::Clipboard::ObjectMap>::Read(
+    const Message* m, PickleIterator* iter, param_type* r) {
+  int size;
+  if (!ReadParam(m, iter, &size) || size < 0)
+    return false;
+  for (int i = 0; i < size; ++i) {
+    int type;
+    if (!ReadParam(m, iter, &type))
+      return false;
+    if (!ReadParam(m, iter, &(*r)[type]))
+      return false;
+  }
+  return true;
+}
+
+void ParamTraits<ui::Clipboard::ObjectMap>::Log(
+    const param_type& p, std::string* l) {
+  l->append("<ui::Clipboard::ObjectMap>");
+}
+
 }  // namespace IPC
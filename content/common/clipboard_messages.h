@@ -28,6 +28,17 @@ struct ParamTraits<ui::Clipboard::FormatType> {
   static void Log(const param_type& p, std::string* l);
 };
 
+// Same wire format as the generic std::map traits, but large parameters,
+// such as pasted HTML or custom data, are sent without being copied into the
+// message's buffer, unless the message is sync.
+template<>
+struct ParamTraits<ui::Clipboard::ObjectMap> {
+  typedef ui::Clipboard::ObjectMap param_type;
+  static void Write(Message* m, const param_type& p);
+  static bool Read(const Message* m, PickleIterator* iter, param_type* r);
+  static void Log(const param_type& p, std::string* l);
+};
+
 }  // namespace IPC
 
 #endif  // CONTENT_COMMON_CLIPBOARD_MESSAGES_H_
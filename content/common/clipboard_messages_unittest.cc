@@ -0,0 +1,58 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/common/clipboard_messages.h"
+
+#include <string>
+
+#include "base/shared_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "ui/base/clipboard/clipboard.h"
+
+namespace {
+
+ui::Clipboard::ObjectMapParam MakeParam(size_t size, char value) {
+  return ui::Clipboard::ObjectMapParam(size, value);
+}
+
+// Returns objects with one parameter big enough to be sent externally.
+ui::Clipboard::ObjectMap MakeObjects() {
+  ui::Clipboard::ObjectMap objects;
+  objects[ui::Clipboard::CBF_TEXT].push_back(MakeParam(10, 't'));
+  ui::Clipboard::ObjectMapParams& data = objects[ui::Clipboard::CBF_DATA];
+  data.push_back(MakeParam(20, 'f'));
+  data.push_back(MakeParam(300000, 'd'));
+  objects[ui::Clipboard::CBF_HTML].push_back(MakeParam(0, 'h'));
+  return objects;
+}
+
+}  // namespace
+
+// Large parameters of an async write are sent from their own buffers, and
+// read back the same as the others.
+TEST(ClipboardMessagesTest, WriteObjectsAsyncSendsLargeDataExternally) {
+  ui::Clipboard::ObjectMap objects = MakeObjects();
+  ClipboardHostMsg_WriteObjectsAsync message(objects);
+  EXPECT_TRUE(message.has_external_data());
+
+  // What the receiving end gets.
+  IPC::Message received(message);
+  received.FlattenExternalData();
+  ClipboardHostMsg_WriteObjectsAsync::Schema::Param param;
+  ASSERT_TRUE(ClipboardHostMsg_WriteObjectsAsync::Read(&received, &param));
+  EXPECT_TRUE(objects == param.a);
+}
+
+// Sync writes, which also carry the bitmap, stay contiguous.
+TEST(ClipboardMessagesTest, WriteObjectsSyncIsContiguous) {
+  ui::Clipboard::ObjectMap objects = MakeObjects();
+  ClipboardHostMsg_WriteObjectsSync message(
+      objects, base::SharedMemory::NULLHandle());
+  EXPECT_FALSE(message.has_external_data());
+
+  ClipboardHostMsg_WriteObjectsSync::SendParam param;
+  ASSERT_TRUE(ClipboardHostMsg_WriteObjectsSync::ReadSendParam(&message,
+                                                               &param));
+  EXPECT_TRUE(objects == param.a);
+}
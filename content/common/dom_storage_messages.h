@@ -47,7 +47,7 @@ IPC_MESSAGE_CONTROL1(DOMStorageMsg_Event,
                      DOMStorageMsg_Event_Params)
 
 // Completion notification sent in response to each async
-// set, remove, and clear operation. Used to maintain the integrity
+// load, set, remove, and clear operation. Used to maintain the integrity
 // of the renderer-side cache.
 IPC_MESSAGE_CONTROL2(DOMStorageMsg_AsyncOperationComplete,
                      int /* operation_id */,
@@ -67,9 +67,11 @@ IPC_MESSAGE_CONTROL1(DOMStorageHostMsg_CloseStorageArea,
                      int /* connection_id */)
 
 // Retrieves the set of key/value pairs for the area. Used to prime
-// the renderer-side cache.
-IPC_SYNC_MESSAGE_CONTROL1_1(DOMStorageHostMsg_LoadStorageArea,
+// the renderer-side cache. A completion notification for |operation_id|
+// is sent ahead of the reply, after any storage events that predate it.
+IPC_SYNC_MESSAGE_CONTROL2_1(DOMStorageHostMsg_LoadStorageArea,
                             int /* connection_id */,
+                            int /* operation_id */,
                             dom_storage::ValuesMap)
 
 // Get the length of a storage area.
@@ -294,9 +294,12 @@ void GpuChannel::HandleMessage() {
         Send(reply);
       }
     } else {
-      // If the command buffer becomes unscheduled as a result of handling the
-      // message but still has more commands to process, synthesize an IPC
-      // message to flush that command buffer.
+      // If the command buffer becomes unscheduled or uses up its time slice
+      // as a result of handling the message but still has more commands to
+      // process, synthesize an IPC message to flush that command buffer. It is
+      // handled from a newly posted task, so the other channels get a turn
+      // first. The messages of this channel keep their order, since the
+      // renderer relies on its contexts' commands running in flush order.
       if (stub) {
         if (stub->HasUnprocessedCommands()) {
           deferred_messages_.push_front(new GpuCommandBufferMsg_Rescheduled(
@@ -8,7 +8,10 @@
 #include "base/bind_helpers.h"
 #include "base/command_line.h"
 #include "base/debug/trace_event.h"
+#include "base/file_path.h"
+#include "base/process_util.h"
 #include "base/shared_memory.h"
+#include "base/stringprintf.h"
 #include "base/time.h"
 #include "build/build_config.h"
 #include "content/common/gpu/gpu_channel.h"
@@ -20,6 +23,9 @@
 #include "content/common/gpu/image_transport_surface.h"
 #include "gpu/command_buffer/common/constants.h"
 #include "gpu/command_buffer/common/gles2_cmd_utils.h"
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+#include "gpu/command_buffer/service/gpu_switches.h"
+#include "gpu/command_buffer/service/texture_manager.h"
 #include "ui/gfx/gl/gl_bindings.h"
 #include "ui/gfx/gl/gl_switches.h"
 
@@ -27,6 +33,15 @@
 #include "content/public/common/sandbox_init.h"
 #endif
 
+namespace {
+
+// How long an offscreen context (WebGL, accelerated canvas) may run commands
+// before it yields to other contexts. Onscreen contexts, which draw the
+// compositor and the UI, are never made to yield.
+const int64 kOffscreenTimeSliceMs = 4;
+
+}  // namespace
+
 GpuCommandBufferStub::SurfaceState::SurfaceState(int32 surface_id,
                                                  bool visible,
                                                  base::TimeTicks last_used_time)
@@ -60,6 +75,7 @@ GpuCommandBufferStub::GpuCommandBufferStub(
       software_(software),
       client_has_memory_allocation_changed_callback_(false),
       last_flush_count_(0),
+      last_texture_memory_(0),
       allocation_(GpuMemoryAllocation::INVALID_RESOURCE_SIZE,
                   GpuMemoryAllocation::kHasFrontbuffer |
                   GpuMemoryAllocation::kHasBackbuffer),
@@ -247,6 +263,17 @@ void GpuCommandBufferStub::OnInitialize(
     return;
   }
 
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(switches::kRecordGPUCommandBuffers)) {
+    FilePath path = command_line.GetSwitchValuePath(
+        switches::kRecordGPUCommandBuffers).AppendASCII(base::StringPrintf(
+            "command_buffer_%d_%d.rec", base::GetCurrentProcId(), route_id_));
+    scoped_ptr<gpu::CommandBufferRecorder> recorder(
+        new gpu::CommandBufferRecorder);
+    if (recorder->Initialize(path))
+      command_buffer_->SetRecorder(recorder.release());
+  }
+
   decoder_.reset(::gpu::gles2::GLES2Decoder::Create(context_group_.get()));
 
   scheduler_.reset(new gpu::GpuScheduler(command_buffer_.get(),
@@ -331,6 +358,10 @@ void GpuCommandBufferStub::OnInitialize(
       base::Bind(&GpuCommandBufferStub::OnParseError, base::Unretained(this)));
   scheduler_->SetScheduledCallback(
       base::Bind(&GpuCommandBufferStub::OnReschedule, base::Unretained(this)));
+  if (handle_.is_null()) {
+    scheduler_->SetPreemptionCallback(
+        base::Bind(&GpuCommandBufferStub::ShouldYield, base::Unretained(this)));
+  }
 
   if (watchdog_) {
     scheduler_->SetCommandProcessedCallback(
@@ -442,7 +473,7 @@ void GpuCommandBufferStub::OnAsyncFlush(int32 put_offset,
   DCHECK(command_buffer_.get());
   if (flush_count - last_flush_count_ < 0x8000000U) {
     last_flush_count_ = flush_count;
-    command_buffer_->Flush(put_offset);
+    FlushWithTimeSlice(put_offset);
   } else {
     // We received this message out-of-order. This should not happen but is here
     // to catch regressions. Ignore the message.
@@ -454,7 +485,7 @@ void GpuCommandBufferStub::OnAsyncFlush(int32 put_offset,
 
 void GpuCommandBufferStub::OnRescheduled() {
   gpu::CommandBuffer::State pre_state = command_buffer_->GetLastState();
-  command_buffer_->Flush(pre_state.put_offset);
+  FlushWithTimeSlice(pre_state.put_offset);
   gpu::CommandBuffer::State post_state = command_buffer_->GetLastState();
 
   if (pre_state.get_offset != post_state.get_offset)
@@ -541,6 +572,32 @@ void GpuCommandBufferStub::OnCommandProcessed() {
     watchdog_->CheckArmed();
 }
 
+void GpuCommandBufferStub::FlushWithTimeSlice(int32 put_offset) {
+  time_slice_start_ = base::TimeTicks::Now();
+  command_buffer_->Flush(put_offset);
+  CheckTextureMemory();
+}
+
+void GpuCommandBufferStub::CheckTextureMemory() {
+  gpu::gles2::TextureManager* textures = texture_manager();
+  if (!textures)
+    return;
+  uint32 texture_memory = textures->mem_represented();
+  if (texture_memory > last_texture_memory_) {
+    channel_->gpu_channel_manager()->gpu_memory_manager()->
+        ScheduleEnforceTextureBudget();
+  }
+  last_texture_memory_ = texture_memory;
+}
+
+bool GpuCommandBufferStub::ShouldYield() {
+  // Commands left over when this returns true are run on a
+  // GpuCommandBufferMsg_Rescheduled that GpuChannel queues, after the tasks
+  // already posted to the GPU thread, which include the other channels'.
+  return base::TimeTicks::Now() - time_slice_start_ >
+      base::TimeDelta::FromMilliseconds(kOffscreenTimeSliceMs);
+}
+
 void GpuCommandBufferStub::ReportState() {
   gpu::CommandBuffer::State state = command_buffer_->GetState();
   if (state.error == gpu::error::kLostContext &&
@@ -656,4 +713,16 @@ void GpuCommandBufferStub::SetMemoryAllocation(
   SendMemoryAllocationToProxy(allocation);
 }
 
+gpu::gles2::TextureManager* GpuCommandBufferStub::texture_manager() const {
+  if (!decoder_.get())
+    return NULL;
+  return context_group_->texture_manager();
+}
+
+bool GpuCommandBufferStub::EvictTexture(uint32 client_texture_id) {
+  if (!decoder_.get() || !decoder_->MakeCurrent())
+    return false;
+  return decoder_->EvictTexture(client_texture_id);
+}
+
 #endif  // defined(ENABLE_GPU)
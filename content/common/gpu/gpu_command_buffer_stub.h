@@ -14,6 +14,7 @@
 #include "base/id_map.h"
 #include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
+#include "base/time.h"
 #include "content/common/content_export.h"
 #include "content/common/gpu/gpu_memory_allocation.h"
 #include "content/common/gpu/gpu_memory_allocation.h"
@@ -42,6 +43,7 @@ class GpuWatchdog;
 namespace gpu {
 namespace gles2 {
 class MailboxManager;
+class TextureManager;
 }
 }
 
@@ -75,6 +77,14 @@ class CONTENT_EXPORT GpuCommandBufferStubBase {
 
   virtual void SetMemoryAllocation(
       const GpuMemoryAllocation& allocation) = 0;
+
+  // The texture manager of this context's share group, or NULL if the context
+  // is not initialized.
+  virtual gpu::gles2::TextureManager* texture_manager() const = 0;
+
+  // Makes this context current and evicts one of the textures of its share
+  // group. Returns false if the texture could not be evicted.
+  virtual bool EvictTexture(uint32 client_texture_id) = 0;
 };
 
 class GpuCommandBufferStub
@@ -132,6 +142,9 @@ class GpuCommandBufferStub
   virtual void SetMemoryAllocation(
       const GpuMemoryAllocation& allocation) OVERRIDE;
 
+  virtual gpu::gles2::TextureManager* texture_manager() const OVERRIDE;
+  virtual bool EvictTexture(uint32 client_texture_id) OVERRIDE;
+
   // Whether this command buffer can currently handle IPC messages.
   bool IsScheduled();
 
@@ -214,6 +227,17 @@ class GpuCommandBufferStub
   void OnCommandProcessed();
   void OnParseError();
 
+  // Runs the commands flushed up to |put_offset|, starting a new time slice.
+  void FlushWithTimeSlice(int32 put_offset);
+
+  // Has the memory manager check the texture budget if the textures of this
+  // context's share group have grown since the last flush.
+  void CheckTextureMemory();
+
+  // Whether an offscreen context has used up its time slice and should let
+  // other contexts run.
+  bool ShouldYield();
+
   void ReportState();
 
   // The lifetime of objects of this class is managed by a GpuChannel. The
@@ -234,6 +258,9 @@ class GpuCommandBufferStub
   bool software_;
   bool client_has_memory_allocation_changed_callback_;
   uint32 last_flush_count_;
+  uint32 last_texture_memory_;
+  // When the current run of commands started.
+  base::TimeTicks time_slice_start_;
   scoped_ptr<GpuCommandBufferStubBase::SurfaceState> surface_state_;
   GpuMemoryAllocation allocation_;
 
@@ -7,11 +7,15 @@
 #if defined(ENABLE_GPU)
 
 #include <algorithm>
+#include <map>
+#include <set>
 
 #include "base/bind.h"
+#include "base/debug/trace_event.h"
 #include "base/message_loop.h"
 #include "content/common/gpu/gpu_command_buffer_stub.h"
 #include "content/common/gpu/gpu_memory_allocation.h"
+#include "gpu/command_buffer/service/texture_manager.h"
 
 namespace {
 
@@ -34,14 +38,29 @@ void AssignMemoryAllocations(std::vector<GpuCommandBufferStubBase*>& stubs,
   }
 }
 
+// A texture that may be evicted, with the stub to evict it through.
+struct EvictionCandidate {
+  GpuCommandBufferStubBase* stub;
+  uint32 client_id;
+  gpu::gles2::TextureManager::TextureInfo* info;
+};
+
+bool EvictBefore(const EvictionCandidate& lhs, const EvictionCandidate& rhs) {
+  if (lhs.info->residency_priority() != rhs.info->residency_priority())
+    return lhs.info->residency_priority() < rhs.info->residency_priority();
+  return lhs.info->estimated_size() > rhs.info->estimated_size();
+}
+
 }
 
 GpuMemoryManager::GpuMemoryManager(GpuMemoryManagerClient* client,
         size_t max_surfaces_with_frontbuffer_soft_limit)
     : client_(client),
       manage_scheduled_(false),
+      enforce_texture_budget_scheduled_(false),
       max_surfaces_with_frontbuffer_soft_limit_(
           max_surfaces_with_frontbuffer_soft_limit),
+      texture_memory_budget_(kDefaultTextureMemoryBudget),
       weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
 }
 
@@ -69,6 +88,16 @@ void GpuMemoryManager::ScheduleManage() {
   manage_scheduled_ = true;
 }
 
+void GpuMemoryManager::ScheduleEnforceTextureBudget() {
+  if (enforce_texture_budget_scheduled_ || manage_scheduled_)
+    return;
+  MessageLoop::current()->PostTask(
+    FROM_HERE,
+    base::Bind(&GpuMemoryManager::EnforceTextureBudgetForAllStubs,
+               weak_factory_.GetWeakPtr()));
+  enforce_texture_budget_scheduled_ = true;
+}
+
 // The current Manage algorithm simply classifies contexts (stubs) into
 // "foreground", "background", or "hibernated" categories.
 // For each of these three categories, there are predefined memory allocation
@@ -107,6 +136,7 @@ void GpuMemoryManager::Manage() {
   {
     std::vector<GpuCommandBufferStubBase*> stubs;
     client_->AppendAllCommandBufferStubs(stubs);
+    EnforceTextureBudget(stubs);
 
     for (std::vector<GpuCommandBufferStubBase*>::iterator it = stubs.begin();
         it != stubs.end(); ++it) {
@@ -198,4 +228,64 @@ void GpuMemoryManager::Manage() {
       GpuMemoryAllocation(0, GpuMemoryAllocation::kHasNoBuffers));
 }
 
+void GpuMemoryManager::EnforceTextureBudgetForAllStubs() {
+  enforce_texture_budget_scheduled_ = false;
+  std::vector<GpuCommandBufferStubBase*> stubs;
+  client_->AppendAllCommandBufferStubs(stubs);
+  EnforceTextureBudget(stubs);
+}
+
+void GpuMemoryManager::EnforceTextureBudget(
+    const std::vector<GpuCommandBufferStubBase*>& stubs) {
+  // Contexts in a share group have one texture manager. Its textures are only
+  // evicted if a single context uses it, because evicting a texture deletes
+  // its service id and the other contexts would keep the deleted texture, and
+  // its memory, bound.
+  typedef std::map<gpu::gles2::TextureManager*,
+                   GpuCommandBufferStubBase*> OwnerMap;
+  OwnerMap owners;
+  std::set<gpu::gles2::TextureManager*> shared;
+  for (std::vector<GpuCommandBufferStubBase*>::const_iterator it =
+      stubs.begin(); it != stubs.end(); ++it) {
+    gpu::gles2::TextureManager* texture_manager = (*it)->texture_manager();
+    if (!texture_manager)
+      continue;
+    if (!owners.insert(std::make_pair(texture_manager, *it)).second)
+      shared.insert(texture_manager);
+  }
+
+  size_t texture_memory = 0;
+  for (OwnerMap::const_iterator it = owners.begin(); it != owners.end(); ++it)
+    texture_memory += it->first->mem_represented();
+  if (texture_memory <= texture_memory_budget_)
+    return;
+
+  std::vector<EvictionCandidate> candidates;
+  for (OwnerMap::const_iterator it = owners.begin(); it != owners.end(); ++it) {
+    gpu::gles2::TextureManager* texture_manager = it->first;
+    if (shared.count(texture_manager))
+      continue;
+    std::vector<GLuint> client_ids;
+    texture_manager->AppendEvictableTextures(&client_ids);
+    for (size_t i = 0; i < client_ids.size(); ++i) {
+      EvictionCandidate candidate = {
+          it->second,
+          client_ids[i],
+          texture_manager->GetTextureInfo(client_ids[i]) };
+      candidates.push_back(candidate);
+    }
+  }
+
+  TRACE_EVENT1("gpu", "GpuMemoryManager::EnforceTextureBudget",
+               "texture_memory", texture_memory);
+  std::sort(candidates.begin(), candidates.end(), EvictBefore);
+  for (size_t i = 0; i < candidates.size() &&
+       texture_memory > texture_memory_budget_; ++i) {
+    const EvictionCandidate& candidate = candidates[i];
+    size_t size = candidate.info->estimated_size();
+    if (candidate.stub->EvictTexture(candidate.client_id))
+      texture_memory -= size;
+  }
+}
+
 #endif
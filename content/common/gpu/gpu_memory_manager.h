@@ -45,16 +45,43 @@ class CONTENT_EXPORT GpuMemoryManager {
 #endif
   };
 
+  // The default texture memory budget, in bytes, for all contexts together.
+  enum {
+#if defined(OS_ANDROID)
+    kDefaultTextureMemoryBudget = 64 * 1024 * 1024,
+#else
+    kDefaultTextureMemoryBudget = 512 * 1024 * 1024,
+#endif
+  };
+
   GpuMemoryManager(GpuMemoryManagerClient* client,
                    size_t max_surfaces_with_frontbuffer_soft_limit);
   ~GpuMemoryManager();
 
   void ScheduleManage();
 
+  // Schedules a check of the texture budget alone, for contexts whose
+  // textures have grown.
+  void ScheduleEnforceTextureBudget();
+
+  // The most texture memory, in bytes, all contexts together may use before
+  // textures are evicted.
+  void set_texture_memory_budget(size_t budget) {
+    texture_memory_budget_ = budget;
+  }
+
  private:
   friend class GpuMemoryManagerTest;
   void Manage();
 
+  void EnforceTextureBudgetForAllStubs();
+
+  // Evicts textures that have a residency priority, lowest priority and then
+  // largest first, until the textures of all contexts fit in
+  // texture_memory_budget_.
+  void EnforceTextureBudget(
+      const std::vector<GpuCommandBufferStubBase*>& stubs);
+
   class CONTENT_EXPORT StubWithSurfaceComparator {
    public:
     bool operator()(GpuCommandBufferStubBase* lhs,
@@ -63,7 +90,9 @@ class CONTENT_EXPORT GpuMemoryManager {
 
   GpuMemoryManagerClient* client_;
   bool manage_scheduled_;
+  bool enforce_texture_budget_scheduled_;
   size_t max_surfaces_with_frontbuffer_soft_limit_;
+  size_t texture_memory_budget_;
   base::WeakPtrFactory<GpuMemoryManager> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(GpuMemoryManager);
@@ -5,6 +5,8 @@
 #include "content/common/gpu/gpu_command_buffer_stub.h"
 #include "content/common/gpu/gpu_memory_allocation.h"
 #include "content/common/gpu/gpu_memory_manager.h"
+#include "gpu/command_buffer/service/feature_info.h"
+#include "gpu/command_buffer/service/texture_manager.h"
 
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -12,15 +14,19 @@ class FakeCommandBufferStub : public GpuCommandBufferStubBase {
  public:
   SurfaceState surface_state_;
   GpuMemoryAllocation allocation_;
+  gpu::gles2::TextureManager* texture_manager_;
+  std::vector<uint32> evicted_textures_;
 
   FakeCommandBufferStub()
-      : surface_state_(0, false, base::TimeTicks()) {
+      : surface_state_(0, false, base::TimeTicks()),
+        texture_manager_(NULL) {
   }
 
   FakeCommandBufferStub(int32 surface_id,
                         bool visible,
                         base::TimeTicks last_used_time)
-      : surface_state_(surface_id, visible, last_used_time) {
+      : surface_state_(surface_id, visible, last_used_time),
+        texture_manager_(NULL) {
   }
 
   virtual bool client_has_memory_allocation_changed_callback() const {
@@ -42,6 +48,13 @@ class FakeCommandBufferStub : public GpuCommandBufferStubBase {
   virtual void SetMemoryAllocation(const GpuMemoryAllocation& alloc) {
     allocation_ = alloc;
   }
+  virtual gpu::gles2::TextureManager* texture_manager() const {
+    return texture_manager_;
+  }
+  virtual bool EvictTexture(uint32 client_texture_id) {
+    evicted_textures_.push_back(client_texture_id);
+    return true;
+  }
 };
 
 class FakeCommandBufferStubWithoutSurface : public GpuCommandBufferStubBase {
@@ -75,6 +88,12 @@ class FakeCommandBufferStubWithoutSurface : public GpuCommandBufferStubBase {
   virtual void SetMemoryAllocation(const GpuMemoryAllocation& alloc) {
     allocation_ = alloc;
   }
+  virtual gpu::gles2::TextureManager* texture_manager() const {
+    return NULL;
+  }
+  virtual bool EvictTexture(uint32 client_texture_id) {
+    return false;
+  }
 };
 
 class FakeClient : public GpuMemoryManagerClient {
@@ -155,6 +174,25 @@ class GpuMemoryManagerTest : public testing::Test {
     memory_manager_.Manage();
   }
 
+  // Defines a |size|x|size| RGBA texture, which has a residency priority if
+  // |has_priority| is true.
+  static void DefineTexture(gpu::gles2::TextureManager* manager,
+                            GLuint client_id,
+                            GLsizei size,
+                            bool has_priority,
+                            GLint priority) {
+    manager->CreateTextureInfo(client_id, client_id + 100);
+    gpu::gles2::TextureManager::TextureInfo* info =
+        manager->GetTextureInfo(client_id);
+    manager->SetInfoTarget(info, GL_TEXTURE_2D);
+    manager->SetLevelInfo(info, GL_TEXTURE_2D, 0, GL_RGBA, size, size, 1, 0,
+                          GL_RGBA, GL_UNSIGNED_BYTE, true);
+    if (has_priority) {
+      EXPECT_TRUE(manager->SetParameter(
+          info, GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM, priority));
+    }
+  }
+
   base::TimeTicks older_, newer_, newest_;
   FakeClient client_;
   GpuMemoryManager memory_manager_;
@@ -561,3 +599,55 @@ TEST_F(GpuMemoryManagerTest, GpuMemoryAllocationCompareTests) {
     }
   }
 }
+
+// Test GpuMemoryManager evicts only the textures that have a residency
+// priority, lowest priority and then largest first, until the textures of all
+// contexts fit in the budget. Textures of shared texture managers are kept.
+TEST_F(GpuMemoryManagerTest, TextureEviction) {
+  scoped_refptr<gpu::gles2::FeatureInfo> feature_info(
+      new gpu::gles2::FeatureInfo());
+  gpu::gles2::TextureManager textures1(feature_info.get(), 1024, 1024);
+  gpu::gles2::TextureManager textures2(feature_info.get(), 1024, 1024);
+  const size_t kSmall = 64 * 64 * 4;
+  const size_t kLarge = 128 * 128 * 4;
+  DefineTexture(&textures1, 1, 64, true, -1);
+  DefineTexture(&textures1, 2, 128, false, 0);
+  DefineTexture(&textures2, 3, 64, true, 1);
+  DefineTexture(&textures2, 4, 128, true, 1);
+
+  FakeCommandBufferStub stub1(GenerateUniqueSurfaceId(), true, older_),
+                        stub2(GenerateUniqueSurfaceId(), true, older_);
+  stub1.texture_manager_ = &textures1;
+  stub2.texture_manager_ = &textures2;
+  client_.stubs_.push_back(&stub1);
+  client_.stubs_.push_back(&stub2);
+
+  // Everything fits.
+  memory_manager_.set_texture_memory_budget(2 * kSmall + 2 * kLarge);
+  Manage();
+  EXPECT_TRUE(stub1.evicted_textures_.empty());
+  EXPECT_TRUE(stub2.evicted_textures_.empty());
+
+  // Texture 2 is larger but has no priority, and texture 3 is not needed.
+  memory_manager_.set_texture_memory_budget(kSmall + kLarge + kSmall / 2);
+  Manage();
+  ASSERT_EQ(1u, stub1.evicted_textures_.size());
+  EXPECT_EQ(1u, stub1.evicted_textures_[0]);
+  ASSERT_EQ(1u, stub2.evicted_textures_.size());
+  EXPECT_EQ(4u, stub2.evicted_textures_[0]);
+
+  // A second context shares the textures of stub2.
+  FakeCommandBufferStub stub3(GenerateUniqueSurfaceId(), true, older_);
+  stub3.texture_manager_ = &textures2;
+  client_.stubs_.push_back(&stub3);
+  stub1.evicted_textures_.clear();
+  stub2.evicted_textures_.clear();
+  Manage();
+  ASSERT_EQ(1u, stub1.evicted_textures_.size());
+  EXPECT_EQ(1u, stub1.evicted_textures_[0]);
+  EXPECT_TRUE(stub2.evicted_textures_.empty());
+  EXPECT_TRUE(stub3.evicted_textures_.empty());
+
+  textures1.Destroy(false);
+  textures2.Destroy(false);
+}
@@ -405,6 +405,47 @@ void ResourceDispatcher::OnReceivedData(const IPC::Message& message,
   }
 }
 
+void ResourceDispatcher::OnSetDataBuffer(const IPC::Message& message,
+                                         int request_id,
+                                         base::SharedMemoryHandle shm_handle,
+                                         int shm_size) {
+  PendingRequestInfo* request_info = GetPendingRequestInfo(request_id);
+  if (!request_info) {
+    base::SharedMemory::CloseHandle(shm_handle);
+    return;
+  }
+
+  request_info->buffer.reset(
+      new base::SharedMemory(shm_handle, true));  // read only
+  if (shm_size <= 0 || !request_info->buffer->Map(shm_size)) {
+    // Data received in the buffer is dropped from here on.
+    request_info->buffer.reset();
+    request_info->buffer_size = 0;
+    return;
+  }
+  request_info->buffer_size = shm_size;
+}
+
+void ResourceDispatcher::OnReceivedDataInBuffer(const IPC::Message& message,
+                                                int request_id,
+                                                int data_offset,
+                                                int data_length,
+                                                int encoded_data_length) {
+  PendingRequestInfo* request_info = GetPendingRequestInfo(request_id);
+  if (request_info && request_info->buffer.get() && data_offset >= 0 &&
+      data_length > 0 && data_length <= request_info->buffer_size &&
+      data_offset <= request_info->buffer_size - data_length) {
+    const char* data =
+        static_cast<char*>(request_info->buffer->memory()) + data_offset;
+    request_info->peer->OnReceivedData(data, data_length, encoded_data_length);
+  }
+
+  // Acknowledge the data only once it has been handled, since the browser
+  // then reuses that part of the buffer.
+  message_sender()->Send(
+      new ResourceHostMsg_DataReceived_ACK(message.routing_id(), request_id));
+}
+
 void ResourceDispatcher::OnDownloadedData(const IPC::Message& message,
                                           int request_id,
                                           int data_len) {
@@ -557,6 +598,9 @@ void ResourceDispatcher::DispatchMessage(const IPC::Message& message) {
                         OnReceivedCachedMetadata)
     IPC_MESSAGE_HANDLER(ResourceMsg_ReceivedRedirect, OnReceivedRedirect)
     IPC_MESSAGE_HANDLER(ResourceMsg_DataReceived, OnReceivedData)
+    IPC_MESSAGE_HANDLER(ResourceMsg_SetDataBuffer, OnSetDataBuffer)
+    IPC_MESSAGE_HANDLER(ResourceMsg_DataReceivedInBuffer,
+                        OnReceivedDataInBuffer)
     IPC_MESSAGE_HANDLER(ResourceMsg_DataDownloaded, OnDownloadedData)
     IPC_MESSAGE_HANDLER(ResourceMsg_RequestComplete, OnRequestComplete)
   IPC_END_MESSAGE_MAP()
@@ -665,6 +709,8 @@ bool ResourceDispatcher::IsResourceDispatcherMessage(
     case ResourceMsg_ReceivedCachedMetadata::ID:
     case ResourceMsg_ReceivedRedirect::ID:
     case ResourceMsg_DataReceived::ID:
+    case ResourceMsg_SetDataBuffer::ID:
+    case ResourceMsg_DataReceivedInBuffer::ID:
     case ResourceMsg_DataDownloaded::ID:
     case ResourceMsg_RequestComplete::ID:
       return true;
@@ -688,7 +734,8 @@ void ResourceDispatcher::ReleaseResourcesInDataMessage(
 
   // If the message contains a shared memory handle, we should close the
   // handle or there will be a memory leak.
-  if (message.type() == ResourceMsg_DataReceived::ID) {
+  if (message.type() == ResourceMsg_DataReceived::ID ||
+      message.type() == ResourceMsg_SetDataBuffer::ID) {
     base::SharedMemoryHandle shm_handle;
     if (IPC::ParamTraits<base::SharedMemoryHandle>::Read(&message,
                                                          &iter,
@@ -81,6 +81,7 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Channel::Listener {
           resource_type(resource_type),
           is_deferred(false),
           url(request_url),
+          buffer_size(0),
           request_start(base::TimeTicks::Now()) {
     }
     ~PendingRequestInfo() { }
@@ -93,6 +94,10 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Channel::Listener {
     base::TimeTicks request_start;
     base::TimeTicks response_start;
     base::TimeTicks completion_time;
+    // The buffer the browser shares with ResourceMsg_SetDataBuffer, mapped
+    // for the rest of the request.
+    linked_ptr<base::SharedMemory> buffer;
+    int buffer_size;
   };
   typedef base::hash_map<int, PendingRequestInfo> PendingRequestList;
 
@@ -122,6 +127,17 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Channel::Listener {
       base::SharedMemoryHandle data,
       int data_len,
       int encoded_data_length);
+  void OnSetDataBuffer(
+      const IPC::Message& message,
+      int request_id,
+      base::SharedMemoryHandle shm_handle,
+      int shm_size);
+  void OnReceivedDataInBuffer(
+      const IPC::Message& message,
+      int request_id,
+      int data_offset,
+      int data_length,
+      int encoded_data_length);
   void OnDownloadedData(
       const IPC::Message& message,
       int request_id,
@@ -204,6 +204,64 @@ TEST_F(ResourceDispatcherTest, RoundTrip) {
   delete bridge;
 }
 
+// Tests that data received in a shared buffer reaches the peer, that each
+// message is acknowledged, and that runs outside the buffer are ignored.
+TEST_F(ResourceDispatcherTest, DataBuffer) {
+  TestRequestCallback callback;
+  ResourceLoaderBridge* bridge = CreateBridge();
+  bridge->Start(&callback);
+
+  int request_id;
+  ResourceHostMsg_Request request;
+  ASSERT_TRUE(ResourceHostMsg_RequestResource::Read(
+      &message_queue_[0], &request_id, &request));
+  message_queue_.clear();
+
+  content::ResourceResponseHead response;
+  std::string raw_headers(test_page_headers);
+  std::replace(raw_headers.begin(), raw_headers.end(), '\n', '\0');
+  response.headers = new net::HttpResponseHeaders(raw_headers);
+  dispatcher_->OnMessageReceived(
+      ResourceMsg_ReceivedResponse(0, request_id, response));
+
+  // The buffer holds the second half of the page before the first, as a ring
+  // does once the browser wraps around.
+  const int kBufferSize = 4096;
+  const int kSplit = test_page_contents_len / 2;
+  const int kTailOffset = kBufferSize - kSplit;
+  base::SharedMemory shared_mem;
+  ASSERT_TRUE(shared_mem.CreateAndMapAnonymous(kBufferSize));
+  char* buffer = static_cast<char*>(shared_mem.memory());
+  memcpy(buffer + kTailOffset, test_page_contents, kSplit);
+  memcpy(buffer, test_page_contents + kSplit,
+         test_page_contents_len - kSplit);
+  base::SharedMemoryHandle dup_handle;
+  ASSERT_TRUE(shared_mem.GiveToProcess(
+      base::Process::Current().handle(), &dup_handle));
+  dispatcher_->OnMessageReceived(
+      ResourceMsg_SetDataBuffer(0, request_id, dup_handle, kBufferSize));
+
+  dispatcher_->OnMessageReceived(ResourceMsg_DataReceivedInBuffer(
+      0, request_id, kTailOffset, kSplit, kSplit));
+  dispatcher_->OnMessageReceived(ResourceMsg_DataReceivedInBuffer(
+      0, request_id, kBufferSize - 10, 20, 20));
+  dispatcher_->OnMessageReceived(ResourceMsg_DataReceivedInBuffer(
+      0, request_id, 0, test_page_contents_len - kSplit,
+      test_page_contents_len - kSplit));
+  EXPECT_EQ(test_page_contents, callback.data());
+
+  ASSERT_EQ(3U, message_queue_.size());
+  for (size_t i = 0; i < message_queue_.size(); ++i) {
+    Tuple1<int> request_ack;
+    ASSERT_TRUE(ResourceHostMsg_DataReceived_ACK::Read(
+        &message_queue_[i], &request_ack));
+    EXPECT_EQ(request_id, request_ack.a);
+  }
+  message_queue_.clear();
+
+  delete bridge;
+}
+
 // Tests that the request IDs are straight when there are multiple requests.
 TEST_F(ResourceDispatcherTest, MultipleRequests) {
   // FIXME
@@ -161,6 +161,25 @@ IPC_MESSAGE_ROUTED4(ResourceMsg_DataReceived,
                     int /* data_len */,
                     int /* encoded_data_length */)
 
+// Sent before the first ResourceMsg_DataReceivedInBuffer of a request with
+// the shared memory the browser reads the rest of the response into. The
+// handle should already be mapped into the process that receives this
+// message. The buffer lives until the request completes.
+IPC_MESSAGE_ROUTED3(ResourceMsg_SetDataBuffer,
+                    int /* request_id */,
+                    base::SharedMemoryHandle /* shm_handle */,
+                    int /* shm_size */)
+
+// Sent when some data from a resource request is ready in the buffer of the
+// last ResourceMsg_SetDataBuffer. The browser may reuse that part of the
+// buffer once the renderer acknowledges this message with
+// ResourceHostMsg_DataReceived_ACK.
+IPC_MESSAGE_ROUTED4(ResourceMsg_DataReceivedInBuffer,
+                    int /* request_id */,
+                    int /* data_offset */,
+                    int /* data_length */,
+                    int /* encoded_data_length */)
+
 // Sent when some data from a resource request has been downloaded to
 // file. This is only called in the 'download_to_file' case and replaces
 // ResourceMsg_DataReceived in the call sequence in that case.
@@ -16,12 +16,14 @@
 #include <ucontext.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "base/command_line.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/time.h"
+#include "content/common/sandbox_init_linux.h"
 #include "content/public/common/content_switches.h"
 
 #ifndef PR_SET_NO_NEW_PRIVS
@@ -36,16 +38,6 @@
   #define __NR_eventfd2 290
 #endif
 
-// Constants from very new header files that we can't yet include.
-#ifndef SECCOMP_MODE_FILTER
-  #define SECCOMP_MODE_FILTER 2
-  #define SECCOMP_RET_KILL        0x00000000U
-  #define SECCOMP_RET_TRAP        0x00030000U
-  #define SECCOMP_RET_ERRNO       0x00050000U
-  #define SECCOMP_RET_ALLOW       0x7fff0000U
-#endif
-
-
 namespace {
 
 static void CheckSingleThreaded() {
@@ -153,6 +145,39 @@ static void EmitPreamble(std::vector<struct sock_filter>* program) {
   EmitLoad(0, program);
 }
 
+using content::SyscallRule;
+using content::SyscallRules;
+
+// Ranges of at most this many rules are checked one by one rather than split
+// further.
+const size_t kMaxLinearRules = 4;
+
+static bool SyscallRuleLess(const SyscallRule& lhs, const SyscallRule& rhs) {
+  return lhs.nr < rhs.nr;
+}
+
+static void AllowSyscall(int nr, SyscallRules* rules) {
+  SyscallRule rule = { nr, SyscallRule::ALLOW, 0, 0, 0 };
+  rules->push_back(rule);
+}
+
+static void AllowSyscallArgN(int nr,
+                             int arg_nr,
+                             int arg_val,
+                             SyscallRules* rules) {
+  SyscallRule rule = { nr, SyscallRule::ALLOW_ARG_N, arg_nr, arg_val, 0 };
+  rules->push_back(rule);
+}
+
+static void FailSyscall(int nr, int err, SyscallRules* rules) {
+  SyscallRule rule = { nr, SyscallRule::FAIL, 0, 0, err };
+  rules->push_back(rule);
+}
+
+static void AllowKillSelf(int signal, SyscallRules* rules) {
+  AllowSyscallArgN(__NR_kill, 2, signal, rules);
+}
+
 static void EmitAllowSyscall(int nr, std::vector<struct sock_filter>* program) {
   EmitJEQJF(nr, 1, program);
   EmitRet(SECCOMP_RET_ALLOW, program);
@@ -182,117 +207,58 @@ static void EmitTrap(std::vector<struct sock_filter>* program) {
   EmitRet(SECCOMP_RET_TRAP, program);
 }
 
-static void EmitAllowKillSelf(int signal,
-                              std::vector<struct sock_filter>* program) {
-  EmitAllowSyscallArgN(__NR_kill, 2, signal, program);
+static void EmitRule(const SyscallRule& rule,
+                     std::vector<struct sock_filter>* program) {
+  switch (rule.type) {
+    case SyscallRule::ALLOW:
+      EmitAllowSyscall(rule.nr, program);
+      break;
+    case SyscallRule::ALLOW_ARG_N:
+      EmitAllowSyscallArgN(rule.nr, rule.arg_nr, rule.arg_val, program);
+      break;
+    case SyscallRule::FAIL:
+      EmitFailSyscall(rule.nr, rule.err, program);
+      break;
+  }
 }
 
-static void ApplyGPUPolicy(std::vector<struct sock_filter>* program) {
-  // "Hot" syscalls go first.
-  EmitAllowSyscall(__NR_read, program);
-  EmitAllowSyscall(__NR_ioctl, program);
-  EmitAllowSyscall(__NR_poll, program);
-  EmitAllowSyscall(__NR_epoll_wait, program);
-  EmitAllowSyscall(__NR_recvfrom, program);
-  EmitAllowSyscall(__NR_write, program);
-  EmitAllowSyscall(__NR_writev, program);
-  EmitAllowSyscall(__NR_gettid, program);
-
-  // Less hot syscalls.
-  EmitAllowSyscall(__NR_clock_gettime, program);
-  EmitAllowSyscall(__NR_futex, program);
-  EmitAllowSyscall(__NR_madvise, program);
-  EmitAllowSyscall(__NR_sendmsg, program);
-  EmitAllowSyscall(__NR_recvmsg, program);
-  EmitAllowSyscall(__NR_eventfd2, program);
-  EmitAllowSyscall(__NR_pipe, program);
-  EmitAllowSyscall(__NR_mmap, program);
-  EmitAllowSyscall(__NR_mprotect, program);
-  EmitAllowSyscall(__NR_clone, program);
-  EmitAllowSyscall(__NR_set_robust_list, program);
-  EmitAllowSyscall(__NR_getuid, program);
-  EmitAllowSyscall(__NR_geteuid, program);
-  EmitAllowSyscall(__NR_getgid, program);
-  EmitAllowSyscall(__NR_getegid, program);
-  EmitAllowSyscall(__NR_epoll_create, program);
-  EmitAllowSyscall(__NR_fcntl, program);
-  EmitAllowSyscall(__NR_socketpair, program);
-  EmitAllowSyscall(__NR_epoll_ctl, program);
-  EmitAllowSyscall(__NR_prctl, program);
-  EmitAllowSyscall(__NR_fstat, program);
-  EmitAllowSyscall(__NR_close, program);
-  EmitAllowSyscall(__NR_restart_syscall, program);
-  EmitAllowSyscall(__NR_rt_sigreturn, program);
-  EmitAllowSyscall(__NR_brk, program);
-  EmitAllowSyscall(__NR_rt_sigprocmask, program);
-  EmitAllowSyscall(__NR_munmap, program);
-  EmitAllowSyscall(__NR_dup, program);
-  EmitAllowSyscall(__NR_mlock, program);
-  EmitAllowSyscall(__NR_munlock, program);
-  EmitAllowSyscall(__NR_exit, program);
-  EmitAllowSyscall(__NR_exit_group, program);
-  EmitAllowSyscall(__NR_getpid, program);  // Seen in Nvidia binary driver.
-  EmitAllowSyscall(__NR_getppid, program);  // Seen in ATI binary driver.
-  EmitAllowKillSelf(SIGTERM, program);  // GPU watchdog.
-
-  // Generally, filename-based syscalls will fail with ENOENT to behave
-  // similarly to a possible future setuid sandbox.
-  EmitFailSyscall(__NR_open, ENOENT, program);
-  EmitFailSyscall(__NR_access, ENOENT, program);
-  EmitFailSyscall(__NR_mkdir, ENOENT, program);  // Nvidia binary driver.
-  EmitFailSyscall(__NR_readlink, ENOENT, program);  // ATI binary driver.
-}
+// Emits the checks for |rules| in [begin, end), which are sorted by syscall
+// number, followed by a trap for any syscall none of them matches. Expects
+// the syscall number in the accumulator.
+static void EmitRuleRange(const SyscallRules& rules,
+                          size_t begin,
+                          size_t end,
+                          std::vector<struct sock_filter>* program) {
+  if (end - begin <= kMaxLinearRules) {
+    for (size_t i = begin; i < end; ++i)
+      EmitRule(rules[i], program);
+    EmitTrap(program);
+    return;
+  }
 
-static void ApplyFlashPolicy(std::vector<struct sock_filter>* program) {
-  // "Hot" syscalls go first.
-  EmitAllowSyscall(__NR_futex, program);
-  EmitAllowSyscall(__NR_write, program);
-  EmitAllowSyscall(__NR_epoll_wait, program);
-  EmitAllowSyscall(__NR_read, program);
-  EmitAllowSyscall(__NR_times, program);
-
-  // Less hot syscalls.
-  EmitAllowSyscall(__NR_gettimeofday, program);
-  EmitAllowSyscall(__NR_clone, program);
-  EmitAllowSyscall(__NR_set_robust_list, program);
-  EmitAllowSyscall(__NR_getuid, program);
-  EmitAllowSyscall(__NR_geteuid, program);
-  EmitAllowSyscall(__NR_getgid, program);
-  EmitAllowSyscall(__NR_getegid, program);
-  EmitAllowSyscall(__NR_epoll_create, program);
-  EmitAllowSyscall(__NR_fcntl, program);
-  EmitAllowSyscall(__NR_socketpair, program);
-  EmitAllowSyscall(__NR_pipe, program);
-  EmitAllowSyscall(__NR_epoll_ctl, program);
-  EmitAllowSyscall(__NR_gettid, program);
-  EmitAllowSyscall(__NR_prctl, program);
-  EmitAllowSyscall(__NR_fstat, program);
-  EmitAllowSyscall(__NR_sendmsg, program);
-  EmitAllowSyscall(__NR_mmap, program);
-  EmitAllowSyscall(__NR_munmap, program);
-  EmitAllowSyscall(__NR_mprotect, program);
-  EmitAllowSyscall(__NR_madvise, program);
-  EmitAllowSyscall(__NR_rt_sigaction, program);
-  EmitAllowSyscall(__NR_rt_sigprocmask, program);
-  EmitAllowSyscall(__NR_wait4, program);
-  EmitAllowSyscall(__NR_exit_group, program);
-  EmitAllowSyscall(__NR_exit, program);
-  EmitAllowSyscall(__NR_rt_sigreturn, program);
-  EmitAllowSyscall(__NR_restart_syscall, program);
-  EmitAllowSyscall(__NR_close, program);
-  EmitAllowSyscall(__NR_recvmsg, program);
-  EmitAllowSyscall(__NR_lseek, program);
-  EmitAllowSyscall(__NR_brk, program);
-  EmitAllowSyscall(__NR_sched_yield, program);
+  // Syscalls below the middle rule fall through into the lower half; the
+  // others jump over it to the upper half.
+  size_t middle = begin + (end - begin) / 2;
+  std::vector<struct sock_filter> lower;
+  EmitRuleRange(rules, begin, middle, &lower);
+  CHECK_LE(lower.size(), 255u) << "Seccomp jump out of range.";
 
-  // These are under investigation, and hopefully not here for the long term.
-  EmitAllowSyscall(__NR_shmctl, program);
-  EmitAllowSyscall(__NR_shmat, program);
-  EmitAllowSyscall(__NR_shmdt, program);
+  struct sock_filter filter;
+  filter.code = BPF_JMP+BPF_JGE+BPF_K;
+  filter.jt = lower.size();
+  filter.jf = 0;
+  filter.k = rules[middle].nr;
+  program->push_back(filter);
+  program->insert(program->end(), lower.begin(), lower.end());
+  EmitRuleRange(rules, middle, end, program);
+}
 
-  EmitFailSyscall(__NR_open, ENOENT, program);
-  EmitFailSyscall(__NR_execve, ENOENT, program);
-  EmitFailSyscall(__NR_access, ENOENT, program);
+static void CompilePolicy(SyscallRules rules,
+                          std::vector<struct sock_filter>* program) {
+  std::sort(rules.begin(), rules.end(), SyscallRuleLess);
+  for (size_t i = 1; i < rules.size(); ++i)
+    DCHECK_NE(rules[i - 1].nr, rules[i].nr) << "Duplicate seccomp rule.";
+  EmitRuleRange(rules, 0, rules.size(), program);
 }
 
 static bool CanUseSeccompFilters() {
@@ -318,6 +284,114 @@ static void InstallFilter(const std::vector<struct sock_filter>& program) {
 
 namespace content {
 
+void ApplyGPUPolicy(SyscallRules* rules) {
+  AllowSyscall(__NR_read, rules);
+  AllowSyscall(__NR_ioctl, rules);
+  AllowSyscall(__NR_poll, rules);
+  AllowSyscall(__NR_epoll_wait, rules);
+  AllowSyscall(__NR_recvfrom, rules);
+  AllowSyscall(__NR_write, rules);
+  AllowSyscall(__NR_writev, rules);
+  AllowSyscall(__NR_gettid, rules);
+  AllowSyscall(__NR_clock_gettime, rules);
+  AllowSyscall(__NR_futex, rules);
+  AllowSyscall(__NR_madvise, rules);
+  AllowSyscall(__NR_sendmsg, rules);
+  AllowSyscall(__NR_recvmsg, rules);
+  AllowSyscall(__NR_eventfd2, rules);
+  AllowSyscall(__NR_pipe, rules);
+  AllowSyscall(__NR_mmap, rules);
+  AllowSyscall(__NR_mprotect, rules);
+  AllowSyscall(__NR_clone, rules);
+  AllowSyscall(__NR_set_robust_list, rules);
+  AllowSyscall(__NR_getuid, rules);
+  AllowSyscall(__NR_geteuid, rules);
+  AllowSyscall(__NR_getgid, rules);
+  AllowSyscall(__NR_getegid, rules);
+  AllowSyscall(__NR_epoll_create, rules);
+  AllowSyscall(__NR_fcntl, rules);
+  AllowSyscall(__NR_socketpair, rules);
+  AllowSyscall(__NR_epoll_ctl, rules);
+  AllowSyscall(__NR_prctl, rules);
+  AllowSyscall(__NR_fstat, rules);
+  AllowSyscall(__NR_close, rules);
+  AllowSyscall(__NR_restart_syscall, rules);
+  AllowSyscall(__NR_rt_sigreturn, rules);
+  AllowSyscall(__NR_brk, rules);
+  AllowSyscall(__NR_rt_sigprocmask, rules);
+  AllowSyscall(__NR_munmap, rules);
+  AllowSyscall(__NR_dup, rules);
+  AllowSyscall(__NR_mlock, rules);
+  AllowSyscall(__NR_munlock, rules);
+  AllowSyscall(__NR_exit, rules);
+  AllowSyscall(__NR_exit_group, rules);
+  AllowSyscall(__NR_getpid, rules);  // Seen in Nvidia binary driver.
+  AllowSyscall(__NR_getppid, rules);  // Seen in ATI binary driver.
+  AllowKillSelf(SIGTERM, rules);  // GPU watchdog.
+
+  // Generally, filename-based syscalls will fail with ENOENT to behave
+  // similarly to a possible future setuid sandbox.
+  FailSyscall(__NR_open, ENOENT, rules);
+  FailSyscall(__NR_access, ENOENT, rules);
+  FailSyscall(__NR_mkdir, ENOENT, rules);  // Nvidia binary driver.
+  FailSyscall(__NR_readlink, ENOENT, rules);  // ATI binary driver.
+}
+
+void ApplyFlashPolicy(SyscallRules* rules) {
+  AllowSyscall(__NR_futex, rules);
+  AllowSyscall(__NR_write, rules);
+  AllowSyscall(__NR_epoll_wait, rules);
+  AllowSyscall(__NR_read, rules);
+  AllowSyscall(__NR_times, rules);
+  AllowSyscall(__NR_gettimeofday, rules);
+  AllowSyscall(__NR_clone, rules);
+  AllowSyscall(__NR_set_robust_list, rules);
+  AllowSyscall(__NR_getuid, rules);
+  AllowSyscall(__NR_geteuid, rules);
+  AllowSyscall(__NR_getgid, rules);
+  AllowSyscall(__NR_getegid, rules);
+  AllowSyscall(__NR_epoll_create, rules);
+  AllowSyscall(__NR_fcntl, rules);
+  AllowSyscall(__NR_socketpair, rules);
+  AllowSyscall(__NR_pipe, rules);
+  AllowSyscall(__NR_epoll_ctl, rules);
+  AllowSyscall(__NR_gettid, rules);
+  AllowSyscall(__NR_prctl, rules);
+  AllowSyscall(__NR_fstat, rules);
+  AllowSyscall(__NR_sendmsg, rules);
+  AllowSyscall(__NR_mmap, rules);
+  AllowSyscall(__NR_munmap, rules);
+  AllowSyscall(__NR_mprotect, rules);
+  AllowSyscall(__NR_madvise, rules);
+  AllowSyscall(__NR_rt_sigaction, rules);
+  AllowSyscall(__NR_rt_sigprocmask, rules);
+  AllowSyscall(__NR_wait4, rules);
+  AllowSyscall(__NR_exit_group, rules);
+  AllowSyscall(__NR_exit, rules);
+  AllowSyscall(__NR_rt_sigreturn, rules);
+  AllowSyscall(__NR_restart_syscall, rules);
+  AllowSyscall(__NR_close, rules);
+  AllowSyscall(__NR_recvmsg, rules);
+  AllowSyscall(__NR_lseek, rules);
+  AllowSyscall(__NR_brk, rules);
+  AllowSyscall(__NR_sched_yield, rules);
+
+  // These are under investigation, and hopefully not here for the long term.
+  AllowSyscall(__NR_shmctl, rules);
+  AllowSyscall(__NR_shmat, rules);
+  AllowSyscall(__NR_shmdt, rules);
+
+  FailSyscall(__NR_open, ENOENT, rules);
+  FailSyscall(__NR_execve, ENOENT, rules);
+  FailSyscall(__NR_access, ENOENT, rules);
+}
+
+void CompileSeccompPolicy(const SyscallRules& rules,
+                          std::vector<struct sock_filter>* program) {
+  EmitPreamble(program);
+  CompilePolicy(rules, program);
+}
+
 void InitializeSandbox() {
   const CommandLine& command_line = *CommandLine::ForCurrentProcess();
   if (command_line.HasSwitch(switches::kNoSandbox) ||
@@ -335,18 +409,17 @@ void InitializeSandbox() {
 
   CheckSingleThreaded();
 
-  std::vector<struct sock_filter> program;
-  EmitPreamble(&program);
-
+  SyscallRules rules;
   if (process_type == switches::kGpuProcess) {
-    ApplyGPUPolicy(&program);
+    ApplyGPUPolicy(&rules);
   } else if (process_type == switches::kPpapiPluginProcess) {
-    ApplyFlashPolicy(&program);
+    ApplyFlashPolicy(&rules);
   } else {
     NOTREACHED();
   }
 
-  EmitTrap(&program);
+  std::vector<struct sock_filter> program;
+  CompileSeccompPolicy(rules, &program);
 
   InstallSIGSYSHandler();
   InstallFilter(program);
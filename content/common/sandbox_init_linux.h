@@ -0,0 +1,64 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_COMMON_SANDBOX_INIT_LINUX_H_
+#define CONTENT_COMMON_SANDBOX_INIT_LINUX_H_
+#pragma once
+
+#include "build/build_config.h"
+
+#if defined(OS_LINUX) && defined(__x86_64__)
+
+#include <linux/filter.h>
+
+#include <vector>
+
+#include "content/common/content_export.h"
+
+// Constants from very new header files that we can't yet include.
+#ifndef SECCOMP_MODE_FILTER
+  #define SECCOMP_MODE_FILTER 2
+  #define SECCOMP_RET_KILL        0x00000000U
+  #define SECCOMP_RET_TRAP        0x00030000U
+  #define SECCOMP_RET_ERRNO       0x00050000U
+  #define SECCOMP_RET_ALLOW       0x7fff0000U
+#endif
+
+namespace content {
+
+// How a seccomp-BPF policy treats one syscall. Syscalls without a rule trap.
+// Policies list their rules in any order; CompileSeccompPolicy() turns them
+// into a binary search on the syscall number, so a syscall costs a few
+// comparisons however long the policy is.
+struct SyscallRule {
+  enum Type {
+    ALLOW,
+    ALLOW_ARG_N,  // Allowed only if argument |arg_nr| (from 1) is |arg_val|.
+    FAIL,  // Fails with |err|.
+  };
+
+  int nr;
+  Type type;
+  int arg_nr;  // For ALLOW_ARG_N.
+  int arg_val;  // For ALLOW_ARG_N.
+  int err;  // For FAIL.
+};
+
+typedef std::vector<SyscallRule> SyscallRules;
+
+// Add the rules for the GPU process and for the PPAPI Flash process.
+CONTENT_EXPORT void ApplyGPUPolicy(SyscallRules* rules);
+CONTENT_EXPORT void ApplyFlashPolicy(SyscallRules* rules);
+
+// Compiles |rules| into the filter that InitializeSandbox() installs, which
+// also kills calls made with another architecture's syscall convention.
+CONTENT_EXPORT void CompileSeccompPolicy(
+    const SyscallRules& rules,
+    std::vector<struct sock_filter>* program);
+
+}  // namespace content
+
+#endif  // defined(OS_LINUX) && defined(__x86_64__)
+
+#endif  // CONTENT_COMMON_SANDBOX_INIT_LINUX_H_
@@ -0,0 +1,183 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/common/sandbox_init_linux.h"
+
+#if defined(OS_LINUX) && defined(__x86_64__)
+
+#include <asm/unistd.h>
+#include <linux/audit.h>
+#include <signal.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+// Syscall numbers checked against each policy, past the last x86-64 one.
+const int kMaxSyscall = 600;
+
+// The data a seccomp filter sees for one syscall.
+struct SeccompData {
+  int nr;
+  uint32 arch;
+  uint64 instruction_pointer;
+  uint64 args[6];
+};
+
+// Runs |program| on |data| the way the kernel does, for the instructions the
+// policy compiler emits. Returns the filter's verdict, or fails the test and
+// returns SECCOMP_RET_KILL for a malformed program.
+uint32 RunFilter(const std::vector<struct sock_filter>& program,
+                 const SeccompData& data) {
+  uint32 accumulator = 0;
+  size_t pc = 0;
+  while (pc < program.size()) {
+    const struct sock_filter& insn = program[pc++];
+    switch (insn.code) {
+      case BPF_LD+BPF_W+BPF_ABS:
+        if (insn.k + sizeof(accumulator) > sizeof(data)) {
+          ADD_FAILURE() << "Load out of range at " << pc - 1;
+          return SECCOMP_RET_KILL;
+        }
+        memcpy(&accumulator, reinterpret_cast<const char*>(&data) + insn.k,
+               sizeof(accumulator));
+        break;
+      case BPF_JMP+BPF_JEQ+BPF_K:
+        pc += accumulator == insn.k ? insn.jt : insn.jf;
+        break;
+      case BPF_JMP+BPF_JGE+BPF_K:
+        pc += accumulator >= insn.k ? insn.jt : insn.jf;
+        break;
+      case BPF_RET+BPF_K:
+        return insn.k;
+      default:
+        ADD_FAILURE() << "Unexpected instruction " << insn.code << " at "
+                      << pc - 1;
+        return SECCOMP_RET_KILL;
+    }
+  }
+  ADD_FAILURE() << "Ran off the end of the program";
+  return SECCOMP_RET_KILL;
+}
+
+// Returns the verdict that |rules| give for |data|.
+uint32 ExpectedVerdict(const SyscallRules& rules, const SeccompData& data) {
+  if (data.arch != AUDIT_ARCH_X86_64)
+    return SECCOMP_RET_KILL;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    const SyscallRule& rule = rules[i];
+    if (rule.nr != data.nr)
+      continue;
+    switch (rule.type) {
+      case SyscallRule::ALLOW:
+        return SECCOMP_RET_ALLOW;
+      case SyscallRule::ALLOW_ARG_N:
+        if (static_cast<uint32>(data.args[rule.arg_nr - 1]) ==
+            static_cast<uint32>(rule.arg_val)) {
+          return SECCOMP_RET_ALLOW;
+        }
+        return SECCOMP_RET_TRAP;
+      case SyscallRule::FAIL:
+        return SECCOMP_RET_ERRNO | rule.err;
+    }
+  }
+  return SECCOMP_RET_TRAP;
+}
+
+SeccompData MakeData(int nr) {
+  SeccompData data;
+  memset(&data, 0, sizeof(data));
+  data.nr = nr;
+  data.arch = AUDIT_ARCH_X86_64;
+  return data;
+}
+
+// Checks that the compiled |rules| give the verdict of the rule list for
+// every syscall, and for a range of values of each argument that a rule
+// looks at.
+void CheckPolicy(const SyscallRules& rules) {
+  std::vector<struct sock_filter> program;
+  CompileSeccompPolicy(rules, &program);
+
+  for (int nr = 0; nr < kMaxSyscall; ++nr) {
+    SeccompData data = MakeData(nr);
+    EXPECT_EQ(ExpectedVerdict(rules, data), RunFilter(program, data))
+        << "syscall " << nr;
+  }
+
+  for (size_t i = 0; i < rules.size(); ++i) {
+    if (rules[i].type != SyscallRule::ALLOW_ARG_N)
+      continue;
+    for (int value = 0; value < 2 * rules[i].arg_val + 2; ++value) {
+      SeccompData data = MakeData(rules[i].nr);
+      data.args[rules[i].arg_nr - 1] = value;
+      EXPECT_EQ(ExpectedVerdict(rules, data), RunFilter(program, data))
+          << "syscall " << rules[i].nr << " argument " << rules[i].arg_nr
+          << " = " << value;
+    }
+  }
+
+  // Calls through another architecture's syscall convention are killed.
+  SeccompData data = MakeData(__NR_read);
+  data.arch = AUDIT_ARCH_I386;
+  EXPECT_EQ(SECCOMP_RET_KILL, RunFilter(program, data));
+}
+
+}  // namespace
+
+TEST(SandboxInitLinuxTest, GPUPolicy) {
+  SyscallRules rules;
+  ApplyGPUPolicy(&rules);
+  CheckPolicy(rules);
+
+  SeccompData data = MakeData(__NR_kill);
+  data.args[1] = SIGTERM;
+  std::vector<struct sock_filter> program;
+  CompileSeccompPolicy(rules, &program);
+  EXPECT_EQ(SECCOMP_RET_ALLOW, RunFilter(program, data));
+  data.args[1] = SIGKILL;
+  EXPECT_EQ(SECCOMP_RET_TRAP, RunFilter(program, data));
+}
+
+TEST(SandboxInitLinuxTest, FlashPolicy) {
+  SyscallRules rules;
+  ApplyFlashPolicy(&rules);
+  CheckPolicy(rules);
+}
+
+// Rules of every type spread over the syscall numbers, so that the search
+// splits several times and ends in linear runs of each length.
+TEST(SandboxInitLinuxTest, LargePolicy) {
+  for (size_t count = 0; count < 40; ++count) {
+    SyscallRules rules;
+    for (size_t i = 0; i < count; ++i) {
+      SyscallRule rule = { static_cast<int>(i * 13 + 1), SyscallRule::ALLOW,
+                           0, 0, 0 };
+      if (i % 3 == 1) {
+        rule.type = SyscallRule::ALLOW_ARG_N;
+        rule.arg_nr = i % 6 + 1;
+        rule.arg_val = i % 5;
+      } else if (i % 3 == 2) {
+        rule.type = SyscallRule::FAIL;
+        rule.err = i % 30 + 1;
+      }
+      rules.push_back(rule);
+    }
+    // The compiler sorts the rules itself.
+    std::reverse(rules.begin(), rules.end());
+    SCOPED_TRACE(testing::Message() << count << " rules");
+    CheckPolicy(rules);
+  }
+}
+
+}  // namespace content
+
+#endif  // defined(OS_LINUX) && defined(__x86_64__)
@@ -534,6 +534,11 @@ const char kSingleProcess[]                 = "single-process";
 // content. The switch is intended only for tests.
 const char kSkipGpuDataLoading[]            = "skip-gpu-data-loading";
 
+// Caps the memory that tcmalloc's per-thread caches hold in total, in bytes.
+// Passed on to renderers.
+const char kTcmallocMaxTotalThreadCacheBytes[] =
+    "tcmalloc-max-total-thread-cache-bytes";
+
 // Runs the security test for the renderer sandbox.
 const char kTestSandbox[]                   = "test-sandbox";
 
@@ -603,6 +608,10 @@ const char kZygoteCmdPrefix[]               = "zygote-cmd-prefix";
 // Causes the process to run as a renderer zygote.
 const char kZygoteProcess[]                 = "zygote";
 
+// The most renderers the zygote keeps forked ahead of time, so that opening a
+// tab doesn't wait for a fork. 0 disables them.
+const char kZygoteSpareRenderers[]          = "zygote-spare-renderers";
+
 // Enables moving cursor by word in visual order.
 const char kEnableVisualWordMovement[]      = "enable-visual-word-movement";
 
@@ -166,6 +166,7 @@ extern const char kShowFPSCounter[];
 extern const char kShowPaintRects[];
 CONTENT_EXPORT extern const char kSingleProcess[];
 CONTENT_EXPORT extern const char kSkipGpuDataLoading[];
+extern const char kTcmallocMaxTotalThreadCacheBytes[];
 CONTENT_EXPORT extern const char kTestSandbox[];
 extern const char kTraceStartup[];
 extern const char kTraceStartupFile[];
@@ -182,6 +183,7 @@ extern const char kWebWorkerShareProcesses[];
 CONTENT_EXPORT extern const char kWorkerProcess[];
 CONTENT_EXPORT extern const char kZygoteCmdPrefix[];
 CONTENT_EXPORT extern const char kZygoteProcess[];
+CONTENT_EXPORT extern const char kZygoteSpareRenderers[];
 CONTENT_EXPORT extern const char kDisableSoftwareRasterizer[];
 
 extern const char kEnableVisualWordMovement[];
@@ -0,0 +1,54 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_RENDERER_DOM_STORAGE_DISPATCHER_H_
+#define CONTENT_RENDERER_DOM_STORAGE_DISPATCHER_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "ipc/ipc_message.h"
+
+class GURL;
+struct DOMStorageMsg_Event_Params;
+
+namespace dom_storage {
+class DomStorageCachedArea;
+}
+
+// Dispatches DomStorage related messages sent to a renderer process from
+// the main browser process and owns the renderer-side caches of the
+// storage areas. There is one instance per renderer process, created and
+// used on the main thread.
+class DomStorageDispatcher {
+ public:
+  explicit DomStorageDispatcher(IPC::Message::Sender* sender);
+  ~DomStorageDispatcher();
+
+  // Opens the area for |origin| within |namespace_id| on the browser side
+  // and returns the cache of its values, shared by all connections to it.
+  // Each call must be balanced with a call to CloseCachedArea.
+  scoped_refptr<dom_storage::DomStorageCachedArea> OpenCachedArea(
+      int connection_id, int64 namespace_id, const GURL& origin);
+  void CloseCachedArea(int connection_id,
+                       dom_storage::DomStorageCachedArea* area);
+
+  // Applies the mutation announced by a storage event to the cache of the
+  // area it happened in, if there is one.
+  void ApplyStorageEvent(const DOMStorageMsg_Event_Params& params);
+
+  bool OnMessageReceived(const IPC::Message& msg);
+
+ private:
+  class ProxyImpl;
+
+  // Message handlers.
+  void OnAsyncOperationComplete(int operation_id, bool success);
+
+  scoped_refptr<ProxyImpl> proxy_;
+
+  DISALLOW_COPY_AND_ASSIGN(DomStorageDispatcher);
+};
+
+#endif  // CONTENT_RENDERER_DOM_STORAGE_DISPATCHER_H_
@@ -74,6 +74,10 @@ using content::RenderThread;
 
 namespace {
 
+// Software rendering is not paced by vsync, so the next software update does
+// not begin sooner than this after the previous one began.
+const int kSoftwareFrameIntervalMs = 16;
+
 bool CanSendMessageWhileClosing(const IPC::Message* msg) {
   // We filter out most IPC messages when closing. However, some are
   // important for allowing pepper plugins to update their unsaved state
@@ -453,6 +457,26 @@ void RenderWidget::OnUpdateRectAck() {
   // Notify subclasses that software rendering was flushed to the screen.
   DidFlushPaint();
 
+  // The ack can arrive well within a frame of the previous update, e.g. while
+  // scrolling. Rather than painting again right away, wait for the rest of
+  // the frame and let the invalidations in between coalesce into one update.
+  if (!is_accelerated_compositing_active_ &&
+      !invalidation_task_posted_ &&
+      paint_aggregator_.HasPendingUpdate() &&
+      !last_do_deferred_update_time_.is_null()) {
+    base::TimeDelta remaining =
+        base::TimeDelta::FromMilliseconds(kSoftwareFrameIntervalMs) -
+        (base::TimeTicks::Now() - last_do_deferred_update_time_);
+    if (remaining > base::TimeDelta()) {
+      TRACE_EVENT0("renderer", "EarlyOut_PacingSoftwareUpdate");
+      invalidation_task_posted_ = true;
+      MessageLoop::current()->PostDelayedTask(
+          FROM_HERE, base::Bind(&RenderWidget::InvalidationCallback, this),
+          remaining);
+      return;
+    }
+  }
+
   // Continue painting if necessary...
   DoDeferredUpdateAndSendInputAck();
 }
@@ -976,8 +1000,14 @@ void RenderWidget::DoDeferredUpdate() {
     if (!scroll_damage.IsEmpty())
       copy_rects.push_back(scroll_damage);
 
+    base::TimeTicks paint_begin_ticks = base::TimeTicks::Now();
     for (size_t i = 0; i < copy_rects.size(); ++i)
       PaintRect(copy_rects[i], bounds.origin(), canvas.get());
+    UMA_HISTOGRAM_CUSTOM_TIMES("Renderer4.SoftwarePaintDuration",
+                               base::TimeTicks::Now() - paint_begin_ticks,
+                               base::TimeDelta::FromMilliseconds(1),
+                               base::TimeDelta::FromMilliseconds(120),
+                               30);
 
     // Software FPS tick for performance tests. The accelerated path traces the
     // frame events in didCommitAndDrawCompositorFrame. See throughput_tests.cc.
@@ -4,13 +4,14 @@
 
 #include "content/renderer/renderer_webstoragearea_impl.h"
 
+#include "base/id_map.h"
 #include "base/lazy_instance.h"
-#include "base/metrics/histogram.h"
-#include "base/time.h"
 #include "base/utf_string_conversions.h"
-#include "content/common/dom_storage_messages.h"
+#include "content/renderer/dom_storage_dispatcher.h"
 #include "content/renderer/render_thread_impl.h"
+#include "googleurl/src/gurl.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebURL.h"
+#include "webkit/dom_storage/dom_storage_cached_area.h"
 #include "webkit/dom_storage/dom_storage_types.h"
 
 using WebKit::WebString;
@@ -34,50 +35,31 @@ RendererWebStorageAreaImpl::RendererWebStorageAreaImpl(
   // TODO(michaeln): fix the webkit api to have the 'origin' input
   // be a URL instead of a string.
   DCHECK(connection_id_);
-  RenderThreadImpl::current()->Send(
-      new DOMStorageHostMsg_OpenStorageArea(
-          connection_id_, namespace_id, GURL(origin)));
+  cached_area_ = RenderThreadImpl::current()->dom_storage_dispatcher()->
+      OpenCachedArea(connection_id_, namespace_id, GURL(origin));
 }
 
 RendererWebStorageAreaImpl::~RendererWebStorageAreaImpl() {
   g_all_areas_map.Pointer()->Remove(connection_id_);
-  RenderThreadImpl::current()->Send(
-      new DOMStorageHostMsg_CloseStorageArea(connection_id_));
+  RenderThreadImpl::current()->dom_storage_dispatcher()->
+      CloseCachedArea(connection_id_, cached_area_);
 }
 
-// In November 2011 stats were recorded about performance of each of the
-// DOMStorage operations. Results of median, 99% quantile, and 99.9% quantile
-// are provided in milliseconds. The ratio of number of calls for each operation
-// relative to the number of calls to getItem is also provided.
-//
-// Operation    Freq     50%     99%     99.9%
-// -------------------------------------------
-// getItem      1.00     0.6     2.0     27.9
-// setItem      .029     0.7     13.6    114.9
-// removeItem   .003     0.9     11.8    90.7
-// length       .017     0.6     2.0     12.0
-// key          .591     0.6     2.0     29.9
-// clear        1e-6     1.0     32.4    605.2
+// The values of the area are cached in the renderer, so reads don't leave
+// the process and writes are sent to the browser without waiting for a
+// reply. Only the first access to an area waits on the browser, to load
+// the cache.
 
 unsigned RendererWebStorageAreaImpl::length() {
-  unsigned length;
-  RenderThreadImpl::current()->Send(
-      new DOMStorageHostMsg_Length(connection_id_, &length));
-  return length;
+  return cached_area_->GetLength(connection_id_);
 }
 
 WebString RendererWebStorageAreaImpl::key(unsigned index) {
-  NullableString16 key;
-  RenderThreadImpl::current()->Send(
-      new DOMStorageHostMsg_Key(connection_id_, index, &key));
-  return key;
+  return cached_area_->GetKey(connection_id_, index);
 }
 
 WebString RendererWebStorageAreaImpl::getItem(const WebString& key) {
-  NullableString16 value;
-  RenderThreadImpl::current()->Send(
-      new DOMStorageHostMsg_GetItem(connection_id_, key, &value));
-  return value;
+  return cached_area_->GetItem(connection_id_, key);
 }
 
 void RendererWebStorageAreaImpl::setItem(
@@ -88,21 +70,22 @@ void RendererWebStorageAreaImpl::setItem(
     return;
   }
   NullableString16 old_value;
-  RenderThreadImpl::current()->Send(new DOMStorageHostMsg_SetItem(
-      connection_id_, key, value, url, &result, &old_value));
+  if (!cached_area_->SetItem(connection_id_, key, value, url, &old_value)) {
+    result = ResultBlockedByQuota;
+    return;
+  }
+  result = ResultOK;
   old_value_webkit = old_value;
 }
 
 void RendererWebStorageAreaImpl::removeItem(
     const WebString& key, const WebURL& url, WebString& old_value_webkit) {
-  NullableString16 old_value;
-  RenderThreadImpl::current()->Send(
-      new DOMStorageHostMsg_RemoveItem(connection_id_, key, url, &old_value));
-  old_value_webkit = old_value;
+  string16 old_value;
+  if (cached_area_->RemoveItem(connection_id_, key, url, &old_value))
+    old_value_webkit = old_value;
 }
 
 void RendererWebStorageAreaImpl::clear(
     const WebURL& url, bool& cleared_something) {
-  RenderThreadImpl::current()->Send(
-      new DOMStorageHostMsg_Clear(connection_id_, url, &cleared_something));
+  cleared_something = cached_area_->Clear(connection_id_, url);
 }
@@ -1,4 +1,4 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
@@ -7,9 +7,14 @@
 #pragma once
 
 #include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebStorageArea.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebString.h"
 
+namespace dom_storage {
+class DomStorageCachedArea;
+}
+
 class RendererWebStorageAreaImpl : public WebKit::WebStorageArea {
  public:
   static RendererWebStorageAreaImpl* FromConnectionId(int id);
@@ -33,6 +38,7 @@ class RendererWebStorageAreaImpl : public WebKit::WebStorageArea {
 
  private:
   int connection_id_;
+  scoped_refptr<dom_storage::DomStorageCachedArea> cached_area_;
 };
 
 #endif  // CONTENT_RENDERER_RENDERER_WEBSTORAGEAREA_IMPL_H_
@@ -827,7 +827,10 @@ class AssignmentProblem {
   }
 
  private:
-  typedef std::set<Shingle*, Shingle::PointerLess> ShingleSet;
+  // Shingles in Shingle::PointerLess order, without duplicates.  This is a
+  // sorted vector rather than a std::set because one is built for every
+  // assignment, and the set's node allocations dominated the cost.
+  typedef std::vector<Shingle*> ShingleSet;
 
   typedef std::set<const ShinglePattern*, ShinglePatternPointerLess>
       ShinglePatternSet;
@@ -941,6 +944,7 @@ class AssignmentProblem {
   }
 
   // For the positions in |info|, find the shingles that overlap that position.
+  // Call SortAffectedShingles() once all positions are added.
   void AddAffectedPositions(LabelInfo* info, ShingleSet* affected_shingles) {
     const size_t kWidth = Shingle::kWidth;
     for (size_t i = 0;  i < info->positions_.size();  ++i) {
@@ -959,11 +963,19 @@ class AssignmentProblem {
            shingle_position < high;
            ++shingle_position) {
         Shingle* overlapping_shingle = instances_.at(shingle_position);
-        affected_shingles->insert(overlapping_shingle);
+        affected_shingles->push_back(overlapping_shingle);
       }
     }
   }
 
+  void SortAffectedShingles(ShingleSet* affected_shingles) {
+    std::sort(affected_shingles->begin(), affected_shingles->end(),
+              Shingle::PointerLess());
+    affected_shingles->erase(
+        std::unique(affected_shingles->begin(), affected_shingles->end()),
+        affected_shingles->end());
+  }
+
   void RemovePatternsNeedingUpdatesFromQueues() {
     for (ShinglePatternSet::iterator p = patterns_needing_updates_.begin();
          p != patterns_needing_updates_.end();
@@ -1117,6 +1129,7 @@ class AssignmentProblem {
     ShingleSet affected_shingles;
     AddAffectedPositions(model_info, &affected_shingles);
     AddAffectedPositions(program_info, &affected_shingles);
+    SortAffectedShingles(&affected_shingles);
 
     for (ShingleSet::iterator p = affected_shingles.begin();
          p != affected_shingles.end();
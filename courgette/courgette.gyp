@@ -101,6 +101,7 @@
         'run_all_unittests.cc',
         'streams_unittest.cc',
         'versioning_unittest.cc',
+        'third_party/bsdiff_create_unittest.cc',
         'third_party/paged_array_unittest.cc'
       ],
       'dependencies': [
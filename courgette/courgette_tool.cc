@@ -13,8 +13,10 @@
 #include "base/logging.h"
 #include "base/string_number_conversions.h"
 #include "base/string_util.h"
+#include "base/time.h"
 #include "base/utf_string_conversions.h"
 #include "courgette/third_party/bsdiff.h"
+#include "courgette/adjustment_method.h"
 #include "courgette/courgette.h"
 #include "courgette/streams.h"
 
@@ -28,6 +30,7 @@ void PrintHelp() {
     "  courgette -disadj <executable_file> <reference> <binary_assembly_file>\n"
     "  courgette -gen <v1> <v2> <patch>\n"
     "  courgette -apply <v1> <patch> <v2>\n"
+    "  courgette -gen1a [-adjustment=trie|shingle|none] <v1> <v2> <root>\n"
     "\n");
 }
 
@@ -191,15 +194,33 @@ void DisassembleAndAdjust(const FilePath& program_file,
   WriteSinkToFile(&sink, output_file);
 }
 
+// Returns the adjustment method named |name|, or the production method if
+// |name| is empty.
+courgette::AdjustmentMethod* MakeAdjustmentMethod(const std::string& name) {
+  if (name.empty())
+    return courgette::AdjustmentMethod::MakeProductionAdjustmentMethod();
+  if (name == "trie")
+    return courgette::AdjustmentMethod::MakeTrieAdjustmentMethod();
+  if (name == "shingle")
+    return courgette::AdjustmentMethod::MakeShingleAdjustmentMethod();
+  if (name == "none")
+    return courgette::AdjustmentMethod::MakeNullAdjustmentMethod();
+  UsageProblem("-adjustment must be trie, shingle or none.");
+  return NULL;
+}
+
 // Diffs two executable files, write a set of files for the diff, one file per
 // stream of the EncodedProgram format.  Each file is the bsdiff between the
 // original file's stream and the new file's stream.  This is completely
 // uninteresting to users, but it is handy for seeing how much each which
-// streams are contributing to the final file size.  Adjustment is optional.
+// streams are contributing to the final file size.  Adjustment is optional,
+// and is done with |adjustment_method|, so that the time it takes and the
+// size of the patches can be compared between methods.
 void DisassembleAdjustDiff(const FilePath& model_file,
                            const FilePath& program_file,
                            const FilePath& output_file_root,
-                           bool adjust) {
+                           bool adjust,
+                           const std::string& adjustment_method) {
   std::string model_buffer = ReadOrFail(model_file, "'old'");
   std::string program_buffer = ReadOrFail(program_file, "'new'");
 
@@ -220,9 +241,15 @@ void DisassembleAdjustDiff(const FilePath& model_file,
     Problem("Can't parse program input.");
 
   if (adjust) {
-    const courgette::Status adjust_status = Adjust(*model, program);
-    if (adjust_status != courgette::C_OK)
+    courgette::AdjustmentMethod* method =
+        MakeAdjustmentMethod(adjustment_method);
+    base::Time start_time = base::Time::Now();
+    bool adjusted = method->Adjust(*model, program);
+    method->Destroy();
+    if (!adjusted)
       Problem("Can't adjust program.");
+    printf("Adjusted in %.3fs\n",
+           (base::Time::Now() - start_time).InSecondsF());
   }
 
   courgette::EncodedProgram* encoded_program = NULL;
@@ -253,6 +280,7 @@ void DisassembleAdjustDiff(const FilePath& model_file,
   courgette::DeleteEncodedProgram(encoded_model);
 
   courgette::SinkStream empty_sink;
+  size_t total_patch_size = 0;
   for (int i = 0;  ; ++i) {
     courgette::SinkStream* old_stream = model_sinks.stream(i);
     courgette::SinkStream* new_stream = program_sinks.stream(i);
@@ -272,7 +300,10 @@ void DisassembleAdjustDiff(const FilePath& model_file,
 
     WriteSinkToFile(&patch_stream,
                     output_file_root.InsertBeforeExtensionASCII(append));
+    total_patch_size += patch_stream.Length();
   }
+  printf("Uncompressed stream patches total %u bytes\n",
+         static_cast<unsigned int>(total_patch_size));
 }
 
 void Assemble(const FilePath& input_file,
@@ -498,7 +529,8 @@ int main(int argc, const char* argv[]) {
       if (values.size() != 3)
         UsageProblem("-gen1[au] <old_file> <new_file> <patch_files_root>");
       DisassembleAdjustDiff(values[0], values[1], values[2],
-                            cmd_spread_1_adjusted);
+                            cmd_spread_1_adjusted,
+                            command_line.GetSwitchValueASCII("adjustment"));
     } else {
       UsageProblem("No operation specified");
     }
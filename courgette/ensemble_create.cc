@@ -14,11 +14,15 @@
 
 #include "courgette/ensemble.h"
 
+#include <algorithm>
 #include <vector>
 #include <limits>
 
 #include "base/basictypes.h"
+#include "base/bind.h"
 #include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/threading/parallel_work.h"
 #include "base/time.h"
 
 #include "courgette/third_party/bsdiff.h"
@@ -213,6 +217,42 @@ Status FindGenerators(Ensemble* old_ensemble, Ensemble* new_ensemble,
   return C_OK;
 }
 
+// The inputs and outputs of transforming one element.
+struct ElementTransform {
+  ElementTransform() : generator(NULL), status(C_OK) {}
+
+  TransformationPatchGenerator* generator;
+  SourceStreamSet parameters;
+  SinkStreamSet predicted_transformed_element;
+  SinkStreamSet corrected_transformed_element;
+  Status status;
+};
+
+// The elements transformed by one patch.
+struct TransformJob {
+  ScopedVector<ElementTransform> elements;
+};
+
+void TransformElement(TransformJob* job, int index, int /* thread */) {
+  ElementTransform* element = job->elements[index];
+  element->status = element->generator->Transform(
+      &element->parameters,
+      &element->predicted_transformed_element,
+      &element->corrected_transformed_element);
+}
+
+// Transforms the elements of |job| on the calling thread and the worker pool.
+// Disassembling, adjusting and encoding an element doesn't depend on the
+// other elements, and is where most of the time goes for large ensembles.
+// Elements are handed out one at a time because their sizes vary a lot.
+void RunTransformJob(TransformJob* job) {
+  int element_count = static_cast<int>(job->elements.size());
+  base::ParallelWork::Run(FROM_HERE, element_count,
+                          base::ParallelWork::ThreadCount(element_count),
+                          base::Bind(&TransformElement, job),
+                          true);
+}
+
 void FreeGenerators(std::vector<TransformationPatchGenerator*>* generators) {
   for (size_t i = 0;  i < generators->size();  ++i) {
     delete (*generators)[i];
@@ -317,30 +357,39 @@ Status GenerateEnsemblePatch(SourceStream* base,
   SinkStreamSet predicted_transformed_elements;
   SinkStreamSet corrected_transformed_elements;
 
+  TransformJob transform_job;
   for (size_t i = 0;  i < number_of_transformations;  ++i) {
-    SourceStreamSet single_parameters;
-    if (!corrected_parameters_source_set.ReadSet(&single_parameters))
+    ElementTransform* element = new ElementTransform;
+    transform_job.elements.push_back(element);
+    element->generator = generators[i];
+    if (!corrected_parameters_source_set.ReadSet(&element->parameters))
       return C_STREAM_ERROR;
-    SinkStreamSet single_predicted_transformed_element;
-    SinkStreamSet single_corrected_transformed_element;
-    Status status = generators[i]->Transform(
-        &single_parameters,
-        &single_predicted_transformed_element,
-        &single_corrected_transformed_element);
-    if (status != C_OK)
-      return status;
-    if (!single_parameters.Empty())
+  }
+
+  if (!corrected_parameters_source_set.Empty())
+    return C_STREAM_NOT_CONSUMED;
+
+  base::Time start_transform_time = base::Time::Now();
+  RunTransformJob(&transform_job);
+  VLOG(1) << "done Transform "
+          << (base::Time::Now() - start_transform_time).InSecondsF() << "s";
+
+  // The transformed elements are written in order, so the patch doesn't
+  // depend on which thread finished first.
+  for (size_t i = 0;  i < number_of_transformations;  ++i) {
+    ElementTransform* element = transform_job.elements[i];
+    if (element->status != C_OK)
+      return element->status;
+    if (!element->parameters.Empty())
       return C_STREAM_NOT_CONSUMED;
     if (!predicted_transformed_elements.WriteSet(
-            &single_predicted_transformed_element))
+            &element->predicted_transformed_element))
       return C_STREAM_ERROR;
     if (!corrected_transformed_elements.WriteSet(
-            &single_corrected_transformed_element))
+            &element->corrected_transformed_element))
       return C_STREAM_ERROR;
   }
-
-  if (!corrected_parameters_source_set.Empty())
-    return C_STREAM_NOT_CONSUMED;
+  transform_job.elements.reset();
 
   SinkStream linearized_predicted_transformed_elements;
   SinkStream linearized_corrected_transformed_elements;
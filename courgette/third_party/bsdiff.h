@@ -49,6 +49,7 @@ enum BSDiffStatus {
 
 class SourceStream;
 class SinkStream;
+template <typename T> class PagedArray;
 
 // Creates a binary patch.
 //
@@ -64,6 +65,12 @@ BSDiffStatus ApplyBinaryPatch(SourceStream* old_stream,
                               SourceStream* patch_stream,
                               SinkStream* new_stream);
 
+// Builds the suffix array of the |oldsize| bytes at |old| into |I|, which
+// holds |oldsize| + 1 entries, the first being the empty suffix.  Returns false
+// if memory runs out.  Used by CreateBinaryPatch, and exposed for testing.
+bool BuildSuffixArray(PagedArray<int>& I, const unsigned char* old,
+                      int oldsize);
+
 
 // The following declarations are common to the patch-creation and
 // patch-application code.
@@ -20,6 +20,9 @@
   2010-05-26 - Use a paged array for V and I. The address space may be too
                fragmented for these big arrays to be contiguous.
                  --Stephen Adams <sra@chromium.org>
+  2012-06-14 - Build the suffix array with SA-IS instead of qsufsort, which
+               drops V[], and narrow each search with a table of the suffix
+               array ranges for two-byte prefixes.
 */
 
 #include "courgette/third_party/bsdiff.h"
@@ -43,112 +46,7 @@ namespace courgette {
 // The following code is taken verbatim from 'bsdiff.c'. Please keep all the
 // code formatting and variable names.  The changes from the original are (1)
 // replacing tabs with spaces, (2) indentation, (3) using 'const', and (4)
-// changing the V and I parameters from int* to PagedArray<int>&.
-//
-// The code appears to be a rewritten version of the suffix array algorithm
-// presented in "Faster Suffix Sorting" by N. Jesper Larsson and Kunihiko
-// Sadakane, special cased for bytes.
-
-static void
-split(PagedArray<int>& I,PagedArray<int>& V,int start,int len,int h)
-{
-  int i,j,k,x,tmp,jj,kk;
-
-  if(len<16) {
-    for(k=start;k<start+len;k+=j) {
-      j=1;x=V[I[k]+h];
-      for(i=1;k+i<start+len;i++) {
-        if(V[I[k+i]+h]<x) {
-          x=V[I[k+i]+h];
-          j=0;
-        };
-        if(V[I[k+i]+h]==x) {
-          tmp=I[k+j];I[k+j]=I[k+i];I[k+i]=tmp;
-          j++;
-        };
-      };
-      for(i=0;i<j;i++) V[I[k+i]]=k+j-1;
-      if(j==1) I[k]=-1;
-    };
-    return;
-  };
-
-  x=V[I[start+len/2]+h];
-  jj=0;kk=0;
-  for(i=start;i<start+len;i++) {
-    if(V[I[i]+h]<x) jj++;
-    if(V[I[i]+h]==x) kk++;
-  };
-  jj+=start;kk+=jj;
-
-  i=start;j=0;k=0;
-  while(i<jj) {
-    if(V[I[i]+h]<x) {
-      i++;
-    } else if(V[I[i]+h]==x) {
-      tmp=I[i];I[i]=I[jj+j];I[jj+j]=tmp;
-      j++;
-    } else {
-      tmp=I[i];I[i]=I[kk+k];I[kk+k]=tmp;
-      k++;
-    };
-  };
-
-  while(jj+j<kk) {
-    if(V[I[jj+j]+h]==x) {
-      j++;
-    } else {
-      tmp=I[jj+j];I[jj+j]=I[kk+k];I[kk+k]=tmp;
-      k++;
-    };
-  };
-
-  if(jj>start) split(I,V,start,jj-start,h);
-
-  for(i=0;i<kk-jj;i++) V[I[jj+i]]=kk-1;
-  if(jj==kk-1) I[jj]=-1;
-
-  if(start+len>kk) split(I,V,kk,start+len-kk,h);
-}
-
-static void
-qsufsort(PagedArray<int>& I, PagedArray<int>& V,const unsigned char *old,int oldsize)
-{
-  int buckets[256];
-  int i,h,len;
-
-  for(i=0;i<256;i++) buckets[i]=0;
-  for(i=0;i<oldsize;i++) buckets[old[i]]++;
-  for(i=1;i<256;i++) buckets[i]+=buckets[i-1];
-  for(i=255;i>0;i--) buckets[i]=buckets[i-1];
-  buckets[0]=0;
-
-  for(i=0;i<oldsize;i++) I[++buckets[old[i]]]=i;
-  I[0]=oldsize;
-  for(i=0;i<oldsize;i++) V[i]=buckets[old[i]];
-  V[oldsize]=0;
-  for(i=1;i<256;i++) if(buckets[i]==buckets[i-1]+1) I[buckets[i]]=-1;
-  I[0]=-1;
-
-  for(h=1;I[0]!=-(oldsize+1);h+=h) {
-    len=0;
-    for(i=0;i<oldsize+1;) {
-      if(I[i]<0) {
-        len-=I[i];
-        i-=I[i];
-      } else {
-        if(len) I[i-len]=-len;
-        len=V[I[i]]+1-i;
-        split(I,V,i,len,h);
-        i+=len;
-        len=0;
-      };
-    };
-    if(len) I[i-len]=-len;
-  };
-
-  for(i=0;i<oldsize+1;i++) I[V[i]]=i;
-}
+// changing the I parameter from int* to PagedArray<int>&.
 
 static int
 matchlen(const unsigned char *old,int oldsize,const unsigned char *newbuf,int newsize)
@@ -191,6 +89,270 @@ search(PagedArray<int>& I,const unsigned char *old,int oldsize,
 //  End of 'verbatim' code.
 // ------------------------------------------------------------------------
 
+// The suffix array is built with SA-IS, from "Two Efficient Algorithms for
+// Linear Time Suffix Array Construction" by Ge Nong, Sen Zhang and Wai Hong
+// Chan.  It runs in linear time and, unlike qsufsort, needs no second array
+// of suffix ranks.  The result is the same array qsufsort gives: the empty
+// suffix, then the suffixes of |old| in order.
+//
+// Besides the 4 bytes per input byte of the suffix array, each recursion level
+// keeps one bit per suffix, and a level's buckets have one int per character
+// of its alphabet.  Below the top level the alphabet is the names of the LMS
+// substrings, of which there can be up to half as many as suffixes, so in the
+// worst case the sort peaks at a little over 6 bytes per input byte, against
+// 8 for qsufsort.
+
+namespace {
+
+// The bytes of |old| followed by a sentinel that sorts before every byte.
+class SentinelString {
+ public:
+  SentinelString(const unsigned char* old, int oldsize)
+      : old_(old), oldsize_(oldsize) {
+  }
+
+  // The alphabet is 0 for the sentinel and 1 to 256 for the bytes.
+  static const int kAlphabetSize = 257;
+
+  int operator[](int i) const { return i == oldsize_ ? 0 : old_[i] + 1; }
+
+ private:
+  const unsigned char* old_;
+  int oldsize_;
+};
+
+// A part of a PagedArray<int> starting at |offset|.  SA-IS sorts the reduced
+// string of each recursion level inside the suffix array of the level above.
+class PagedArrayWindow {
+ public:
+  PagedArrayWindow(PagedArray<int>* array, int offset)
+      : array_(array), offset_(offset) {
+  }
+
+  int& operator[](int i) const { return (*array_)[offset_ + i]; }
+
+  PagedArrayWindow Offset(int offset) const {
+    return PagedArrayWindow(array_, offset_ + offset);
+  }
+
+ private:
+  PagedArray<int>* array_;
+  int offset_;
+};
+
+// One bit per suffix: whether it is S-type (smaller than the suffix after it)
+// or L-type (larger).
+class SuffixTypes {
+ public:
+  bool Allocate(int size) { return bits_.Allocate((size + 31) / 32); }
+
+  bool IsS(int i) { return (bits_[i >> 5] >> (i & 31)) & 1; }
+
+  void Set(int i, bool is_s) {
+    uint32 bit = 1u << (i & 31);
+    if (is_s)
+      bits_[i >> 5] |= bit;
+    else
+      bits_[i >> 5] &= ~bit;
+  }
+
+  // Whether suffix |i| is the leftmost of a run of S-type suffixes.
+  bool IsLMS(int i) { return i > 0 && IsS(i) && !IsS(i - 1); }
+
+ private:
+  PagedArray<uint32> bits_;
+};
+
+// Sets |buckets| to the start (or the end, if |end|) of the range of the
+// suffix array for each character of |s|.
+template <typename String>
+void GetBuckets(const String& s, PagedArray<int>* buckets, int n,
+                int alphabet_size, bool end) {
+  for (int c = 0; c < alphabet_size; ++c)
+    (*buckets)[c] = 0;
+  for (int i = 0; i < n; ++i)
+    ++(*buckets)[s[i]];
+  int sum = 0;
+  for (int c = 0; c < alphabet_size; ++c) {
+    sum += (*buckets)[c];
+    (*buckets)[c] = end ? sum : sum - (*buckets)[c];
+  }
+}
+
+// Places the L-type suffixes, given the sorted LMS suffixes, then the S-type
+// suffixes from the L-type ones.
+template <typename String>
+void InduceSA(const String& s, const PagedArrayWindow& sa, SuffixTypes* types,
+              PagedArray<int>* buckets, int n, int alphabet_size) {
+  GetBuckets(s, buckets, n, alphabet_size, false);
+  for (int i = 0; i < n; ++i) {
+    int j = sa[i] - 1;
+    if (j >= 0 && !types->IsS(j))
+      sa[(*buckets)[s[j]]++] = j;
+  }
+  GetBuckets(s, buckets, n, alphabet_size, true);
+  for (int i = n - 1; i >= 0; --i) {
+    int j = sa[i] - 1;
+    if (j >= 0 && types->IsS(j))
+      sa[--(*buckets)[s[j]]] = j;
+  }
+}
+
+// Sorts the suffixes of |s| into |sa|.  |s| has |n| characters less than
+// |alphabet_size|, and ends with a sentinel that is its only 0.  Returns false
+// if memory runs out.
+template <typename String>
+bool SuffixSort(const String& s, const PagedArrayWindow& sa, int n,
+                int alphabet_size) {
+  if (n == 1) {
+    sa[0] = 0;
+    return true;
+  }
+
+  SuffixTypes types;
+  PagedArray<int> buckets;
+  if (!types.Allocate(n) || !buckets.Allocate(alphabet_size))
+    return false;
+
+  types.Set(n - 1, true);
+  types.Set(n - 2, false);
+  for (int i = n - 3; i >= 0; --i)
+    types.Set(i, s[i] < s[i + 1] || (s[i] == s[i + 1] && types.IsS(i + 1)));
+
+  // Sort the LMS substrings by placing the LMS suffixes at the ends of their
+  // buckets and inducing.
+  GetBuckets(s, &buckets, n, alphabet_size, true);
+  for (int i = 0; i < n; ++i)
+    sa[i] = -1;
+  for (int i = 1; i < n; ++i) {
+    if (types.IsLMS(i))
+      sa[--buckets[s[i]]] = i;
+  }
+  InduceSA(s, sa, &types, &buckets, n, alphabet_size);
+
+  // Move the sorted LMS substrings to the front of |sa|.
+  int n1 = 0;
+  for (int i = 0; i < n; ++i) {
+    if (types.IsLMS(sa[i]))
+      sa[n1++] = sa[i];
+  }
+
+  // Name the LMS substrings by rank, storing each name at half its position
+  // in the free back part of |sa|.  No two LMS positions are adjacent, so the
+  // halves don't collide.
+  for (int i = n1; i < n; ++i)
+    sa[i] = -1;
+  int name = 0;
+  int prev = -1;
+  for (int i = 0; i < n1; ++i) {
+    int pos = sa[i];
+    bool differs = false;
+    for (int d = 0; d < n; ++d) {
+      if (prev == -1 || s[pos + d] != s[prev + d] ||
+          types.IsS(pos + d) != types.IsS(prev + d)) {
+        differs = true;
+        break;
+      }
+      if (d > 0 && (types.IsLMS(pos + d) || types.IsLMS(prev + d)))
+        break;
+    }
+    if (differs) {
+      ++name;
+      prev = pos;
+    }
+    sa[n1 + pos / 2] = name - 1;
+  }
+  for (int i = n - 1, j = n - 1; i >= n1; --i) {
+    if (sa[i] >= 0)
+      sa[j--] = sa[i];
+  }
+
+  // Sort the reduced string of names, recursing if the names are not unique.
+  PagedArrayWindow s1 = sa.Offset(n - n1);
+  if (name < n1) {
+    // Free this level's buckets while the level below runs.
+    buckets.clear();
+    if (!SuffixSort(s1, sa, n1, name))
+      return false;
+    if (!buckets.Allocate(alphabet_size))
+      return false;
+  } else {
+    for (int i = 0; i < n1; ++i)
+      sa[s1[i]] = i;
+  }
+
+  // Place the LMS suffixes in sorted order at the ends of their buckets, and
+  // induce the order of the rest from them.
+  for (int i = 1, j = 0; i < n; ++i) {
+    if (types.IsLMS(i))
+      s1[j++] = i;
+  }
+  for (int i = 0; i < n1; ++i)
+    sa[i] = s1[sa[i]];
+  for (int i = n1; i < n; ++i)
+    sa[i] = -1;
+  GetBuckets(s, &buckets, n, alphabet_size, true);
+  for (int i = n1 - 1; i >= 0; --i) {
+    int j = sa[i];
+    sa[i] = -1;
+    sa[--buckets[s[j]]] = j;
+  }
+  InduceSA(s, sa, &types, &buckets, n, alphabet_size);
+  return true;
+}
+
+}  // namespace
+
+bool BuildSuffixArray(PagedArray<int>& I, const unsigned char* old,
+                      int oldsize) {
+  return SuffixSort(SentinelString(old, oldsize), PagedArrayWindow(&I, 0),
+                    oldsize + 1, SentinelString::kAlphabetSize);
+}
+
+// The range of |I| holding the suffixes that start with each two-byte
+// prefix, so that a search only has to look within it.
+class PrefixRanges {
+ public:
+  static const int kPrefixCount = 256 * 256;
+
+  bool Allocate() {
+    return first_.Allocate(kPrefixCount) && last_.Allocate(kPrefixCount);
+  }
+
+  void Init(PagedArray<int>& I, const unsigned char* old, int oldsize) {
+    for (int prefix = 0; prefix < kPrefixCount; ++prefix)
+      first_[prefix] = -1;
+    // The suffixes are sorted, so the ones with a prefix are contiguous,
+    // apart from the one-byte suffix, which is skipped.
+    for (int i = 1; i <= oldsize; ++i) {
+      int pos = I[i];
+      if (pos + 1 >= oldsize)
+        continue;
+      int prefix = old[pos] * 256 + old[pos + 1];
+      if (first_[prefix] < 0)
+        first_[prefix] = i;
+      last_[prefix] = i;
+    }
+  }
+
+  // Sets |st| and |en| to the range of suffixes that start with the first two
+  // bytes of |newbuf|.  Returns false if there are none.
+  bool Find(const unsigned char* newbuf, int newsize, int* st, int* en) {
+    if (newsize < 2)
+      return false;
+    int prefix = newbuf[0] * 256 + newbuf[1];
+    if (first_[prefix] < 0)
+      return false;
+    *st = first_[prefix];
+    *en = last_[prefix];
+    return true;
+  }
+
+ private:
+  PagedArray<int> first_;
+  PagedArray<int> last_;
+};
+
 static CheckBool WriteHeader(SinkStream* stream, MBSPatchHeader* header) {
   bool ok = stream->Write(header->tag, sizeof(header->tag));
   ok &= stream->WriteVarint32(header->slen);
@@ -221,7 +383,6 @@ BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
   uint32 pending_diff_zeros = 0;
 
   PagedArray<int> I;
-  PagedArray<int> V;
 
   if (!I.Allocate(oldsize + 1)) {
     LOG(ERROR) << "Could not allocate I[], " << ((oldsize + 1) * sizeof(int))
@@ -229,17 +390,20 @@ BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
     return MEM_ERROR;
   }
 
-  if (!V.Allocate(oldsize + 1)) {
-    LOG(ERROR) << "Could not allocate V[], " << ((oldsize + 1) * sizeof(int))
-               << " bytes";
+  base::Time q_start_time = base::Time::Now();
+  if (!BuildSuffixArray(I, old, oldsize)) {
+    LOG(ERROR) << "Could not allocate memory to build the suffix array";
     return MEM_ERROR;
   }
-
-  base::Time q_start_time = base::Time::Now();
-  qsufsort(I, V, old, oldsize);
-  VLOG(1) << " done qsufsort "
+  VLOG(1) << " done suffix array "
           << (base::Time::Now() - q_start_time).InSecondsF();
-  V.clear();
+
+  PrefixRanges prefix_ranges;
+  if (!prefix_ranges.Allocate()) {
+    LOG(ERROR) << "Could not allocate prefix ranges";
+    return MEM_ERROR;
+  }
+  prefix_ranges.Init(I, old, oldsize);
 
   const uint8* newbuf = new_stream->Buffer();
   const int newsize = static_cast<int>(new_stream->Remaining());
@@ -300,9 +464,12 @@ BSDiffStatus CreateBinaryPatch(SourceStream* old_stream,
 
     scan += match_length;
     for (int scsc = scan;  scan < newsize;  ++scan) {
+      int st = 0;
+      int en = oldsize;
+      prefix_ranges.Find(newbuf + scan, newsize - scan, &st, &en);
       match_length = search(I, old, oldsize,
                             newbuf + scan, newsize - scan,
-                            0, oldsize, &pos);
+                            st, en, &pos);
 
       for ( ; scsc < scan + match_length ; scsc++)
         if ((scsc + lastoffset < oldsize) &&
@@ -0,0 +1,117 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "courgette/third_party/bsdiff.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "courgette/third_party/paged_array.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Orders the suffixes of a string by their bytes, a suffix before the longer
+// ones it is a prefix of.
+class SuffixLess {
+ public:
+  SuffixLess(const unsigned char* s, int size) : s_(s), size_(size) {}
+
+  bool operator()(int a, int b) const {
+    int length = std::min(size_ - a, size_ - b);
+    int result = memcmp(s_ + a, s_ + b, length);
+    if (result != 0)
+      return result < 0;
+    return a > b;
+  }
+
+ private:
+  const unsigned char* s_;
+  int size_;
+};
+
+class BSDiffCreateTest : public testing::Test {
+ public:
+  // Checks that BuildSuffixArray gives the suffix array std::sort gives.
+  void TestSuffixArray(const std::vector<unsigned char>& old) const {
+    int oldsize = static_cast<int>(old.size());
+    const unsigned char* data = oldsize ? &old[0] : NULL;
+
+    std::vector<int> expected;
+    for (int i = 0; i <= oldsize; ++i)
+      expected.push_back(i);
+    std::sort(expected.begin(), expected.end(), SuffixLess(data, oldsize));
+
+    courgette::PagedArray<int> I;
+    ASSERT_TRUE(I.Allocate(oldsize + 1));
+    ASSERT_TRUE(courgette::BuildSuffixArray(I, data, oldsize));
+    for (int i = 0; i <= oldsize; ++i)
+      ASSERT_EQ(expected[i], I[i]) << "at " << i << " of " << oldsize;
+  }
+
+  // Returns |size| bytes picked at random from the first |alphabet_size|
+  // byte values.
+  std::vector<unsigned char> RandomBytes(int size, int alphabet_size) const {
+    std::vector<unsigned char> bytes(size);
+    for (int i = 0; i < size; ++i)
+      bytes[i] = static_cast<unsigned char>(rand() % alphabet_size);
+    return bytes;
+  }
+};
+
+}  // namespace
+
+TEST_F(BSDiffCreateTest, SuffixArrayOfShortStrings) {
+  TestSuffixArray(std::vector<unsigned char>());
+  TestSuffixArray(std::vector<unsigned char>(1, 'a'));
+  TestSuffixArray(std::vector<unsigned char>(2, 'a'));
+
+  const char kBanana[] = "banana";
+  TestSuffixArray(std::vector<unsigned char>(kBanana,
+                                             kBanana + strlen(kBanana)));
+}
+
+TEST_F(BSDiffCreateTest, SuffixArrayOfRandomBytes) {
+  srand(1);
+  TestSuffixArray(RandomBytes(100000, 256));
+  // A small alphabet gives repeated LMS substrings, so the sort recurses.
+  TestSuffixArray(RandomBytes(100000, 2));
+  TestSuffixArray(RandomBytes(100000, 4));
+}
+
+TEST_F(BSDiffCreateTest, SuffixArrayOfRepetitiveBytes) {
+  // All the same byte, so there are no LMS suffixes at all.
+  TestSuffixArray(std::vector<unsigned char>(5000, 0));
+  TestSuffixArray(std::vector<unsigned char>(5000, 255));
+
+  // Ascending and descending runs.
+  std::vector<unsigned char> bytes;
+  for (int i = 0; i < 5000; ++i)
+    bytes.push_back(static_cast<unsigned char>(i));
+  TestSuffixArray(bytes);
+  std::reverse(bytes.begin(), bytes.end());
+  TestSuffixArray(bytes);
+
+  // A short pattern repeated many times, so the recursion goes several levels
+  // deep.
+  bytes.clear();
+  const char kPattern[] = "abaabaaab";
+  for (int i = 0; i < 5000; ++i)
+    bytes.push_back(kPattern[i % strlen(kPattern)]);
+  TestSuffixArray(bytes);
+
+  // Fibonacci words repeat their LMS substrings at every level.
+  std::vector<unsigned char> previous(1, 'a');
+  bytes.assign(1, 'b');
+  while (bytes.size() < 5000) {
+    std::vector<unsigned char> next = bytes;
+    next.insert(next.end(), previous.begin(), previous.end());
+    previous.swap(bytes);
+    bytes.swap(next);
+  }
+  TestSuffixArray(bytes);
+}
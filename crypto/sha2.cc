@@ -4,16 +4,40 @@
 
 #include "crypto/sha2.h"
 
-#include "base/memory/scoped_ptr.h"
 #include "base/stl_util.h"
-#include "crypto/secure_hash.h"
+
+#if defined(USE_OPENSSL)
+#include <openssl/sha.h>
+
+#include "crypto/openssl_util.h"
+#else
+#include "crypto/third_party/nss/chromium-blapi.h"
+#include "crypto/third_party/nss/chromium-sha256.h"
+#endif
 
 namespace crypto {
 
+// One-shot hashes are common (e.g. safe browsing prefixes), so they hash on a
+// stack context rather than allocating a SecureHash for each string.
 void SHA256HashString(const base::StringPiece& str, void* output, size_t len) {
-  scoped_ptr<SecureHash> ctx(SecureHash::Create(SecureHash::SHA256));
-  ctx->Update(str.data(), str.length());
-  ctx->Finish(output, len);
+#if defined(USE_OPENSSL)
+  SHA256_CTX ctx;
+  SHA256_Init(&ctx);
+  SHA256_Update(&ctx, str.data(), str.length());
+  {
+    ScopedOpenSSLSafeSizeBuffer<SHA256_DIGEST_LENGTH> result(
+        static_cast<unsigned char*>(output), len);
+    SHA256_Final(result.safe_buffer(), &ctx);
+  }
+  OPENSSL_cleanse(&ctx, sizeof(ctx));
+#else
+  SHA256Context ctx;
+  SHA256_Begin(&ctx);
+  SHA256_Update(&ctx, reinterpret_cast<const unsigned char*>(str.data()),
+                static_cast<unsigned int>(str.length()));
+  SHA256_End(&ctx, static_cast<unsigned char*>(output), NULL,
+             static_cast<unsigned int>(len));
+#endif
 }
 
 std::string SHA256HashString(const base::StringPiece& str) {
@@ -84,6 +84,15 @@ class GPU_EXPORT CommandBufferHelper {
   //   the value of the token to wait for.
   void WaitForToken(int32 token);
 
+  // Returns whether the token of a particular value has passed through the
+  // command stream, as of the last state read from the service. Doesn't flush
+  // or block.
+  bool HasTokenPassed(int32 token) const {
+    if (token > token_)
+      return true;  // we wrapped
+    return last_token_read() >= token;
+  }
+
   // Called prior to each command being issued. Waits for a certain amount of
   // space to be available. Returns address of space.
   CommandBufferEntry* GetSpace(uint32 entries);
@@ -93,6 +93,18 @@ void RingBuffer::FreePendingToken(RingBuffer::Offset offset,
   GPU_NOTREACHED() << "attempt to free non-existant block";
 }
 
+void RingBuffer::FreePassedBlocks() {
+  while (!blocks_.empty()) {
+    Block& block = blocks_.front();
+    if (block.state == IN_USE ||
+        (block.state == FREE_PENDING_TOKEN &&
+         !helper_->HasTokenPassed(block.token))) {
+      return;
+    }
+    FreeOldestBlock();
+  }
+}
+
 unsigned int RingBuffer::GetLargestFreeSizeNoWaiting() {
   // TODO(gman): Should check what the current token is and free up to that
   //    point.
@@ -55,6 +55,14 @@ class GPU_EXPORT RingBuffer {
   // Gets the size of the largest free block that is available without waiting.
   unsigned int GetLargestFreeSizeNoWaiting();
 
+  // Frees the oldest blocks whose tokens have already passed, without waiting.
+  void FreePassedBlocks();
+
+  // Returns whether no block is in use or pending a token.
+  bool IsIdle() const {
+    return blocks_.empty();
+  }
+
   // Gets the size of the largest free block that can be allocated if the
   // caller can wait. Allocating a block of this size will succeed, but may
   // block.
@@ -181,6 +189,16 @@ class RingBufferWrapper {
     return allocator_.GetLargestFreeSizeNoWaiting();
   }
 
+  // Frees the oldest blocks whose tokens have already passed, without waiting.
+  void FreePassedBlocks() {
+    allocator_.FreePassedBlocks();
+  }
+
+  // Returns whether no block is in use or pending a token.
+  bool IsIdle() const {
+    return allocator_.IsIdle();
+  }
+
   // Gets the size of the largest free block that can be allocated if the
   // caller can wait.
   unsigned int GetLargestFreeOrPendingSize() {
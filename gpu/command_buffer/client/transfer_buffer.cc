@@ -5,6 +5,7 @@
 // A class to Manage a growing transfer buffer.
 
 #include "../client/transfer_buffer.h"
+#include <algorithm>
 #include "../client/cmd_buffer_helper.h"
 
 namespace gpu {
@@ -15,6 +16,8 @@ AlignedRingBuffer::~AlignedRingBuffer() {
 TransferBuffer::TransferBuffer(
     CommandBufferHelper* helper)
     : helper_(helper),
+      retired_size_(0),
+      small_allocations_(0),
       result_size_(0),
       default_buffer_size_(0),
       min_buffer_size_(0),
@@ -50,6 +53,7 @@ bool TransferBuffer::Initialize(
 }
 
 void TransferBuffer::Free() {
+  FreeRetiredSegments(true);
   if (HaveBuffer()) {
     helper_->Finish();
     helper_->command_buffer()->DestroyTransferBuffer(buffer_id_);
@@ -143,17 +147,95 @@ void TransferBuffer::ReallocateRingBuffer(unsigned int size) {
 
   if (usable_ && (!HaveBuffer() || needed_buffer_size > buffer_.size)) {
     if (HaveBuffer()) {
-      Free();
+      RetireRingBuffer();
+    }
+    FreeRetiredSegments(false);
+    if (retired_size_ + needed_buffer_size > max_buffer_size_) {
+      FreeRetiredSegments(true);
     }
     AllocateRingBuffer(needed_buffer_size);
   }
 }
 
+void TransferBuffer::GrowIfFull(unsigned int size) {
+  FreeRetiredSegments(false);
+  if (!HaveBuffer()) {
+    return;
+  }
+  ring_buffer_->FreePassedBlocks();
+  size = std::min(size, ring_buffer_->GetLargestFreeOrPendingSize());
+  size = (size + alignment_ - 1) & ~(alignment_ - 1);
+  if (size <= ring_buffer_->GetLargestFreeSizeNoWaiting()) {
+    return;
+  }
+  unsigned int buffer_size = buffer_.size;
+  unsigned int new_buffer_size = std::min(buffer_size * 2, max_buffer_size_);
+  if (retired_size_ + buffer_size + new_buffer_size > max_buffer_size_) {
+    // Over budget. Wait for the service instead.
+    return;
+  }
+  RetireRingBuffer();
+  AllocateRingBuffer(new_buffer_size);
+  small_allocations_ = 0;
+}
+
+void TransferBuffer::ShrinkIfIdle(unsigned int size) {
+  if (buffer_.size <= default_buffer_size_ ||
+      size + result_size_ > default_buffer_size_) {
+    small_allocations_ = 0;
+    return;
+  }
+  if (++small_allocations_ < kAllocationsBeforeShrink) {
+    return;
+  }
+  ring_buffer_->FreePassedBlocks();
+  if (!ring_buffer_->IsIdle()) {
+    return;
+  }
+  small_allocations_ = 0;
+  RetireRingBuffer();
+  FreeRetiredSegments(false);
+}
+
+void TransferBuffer::RetireRingBuffer() {
+  RetiredSegment segment;
+  segment.id = buffer_id_;
+  segment.size = buffer_.size;
+  segment.ring_buffer = ring_buffer_.release();
+  retired_segments_.push_back(segment);
+  retired_size_ += buffer_.size;
+  buffer_id_ = -1;
+  buffer_.ptr = NULL;
+  buffer_.size = 0;
+  result_buffer_ = NULL;
+  result_shm_offset_ = 0;
+}
+
+void TransferBuffer::FreeRetiredSegments(bool wait) {
+  if (wait && !retired_segments_.empty()) {
+    helper_->Finish();
+  }
+  std::vector<RetiredSegment>::iterator it = retired_segments_.begin();
+  while (it != retired_segments_.end()) {
+    it->ring_buffer->FreePassedBlocks();
+    if (!wait && !it->ring_buffer->IsIdle()) {
+      ++it;
+      continue;
+    }
+    delete it->ring_buffer;
+    helper_->command_buffer()->DestroyTransferBuffer(it->id);
+    retired_size_ -= it->size;
+    it = retired_segments_.erase(it);
+  }
+}
+
 void* TransferBuffer::AllocUpTo(
     unsigned int size, unsigned int* size_allocated) {
   GPU_DCHECK(size_allocated);
 
+  ShrinkIfIdle(size);
   ReallocateRingBuffer(size);
+  GrowIfFull(size);
 
   if (!HaveBuffer()) {
     return NULL;
@@ -166,7 +248,9 @@ void* TransferBuffer::AllocUpTo(
 }
 
 void* TransferBuffer::Alloc(unsigned int size) {
+  ShrinkIfIdle(size);
   ReallocateRingBuffer(size);
+  GrowIfFull(size);
 
   if (!HaveBuffer()) {
     return NULL;
@@ -204,6 +288,10 @@ unsigned int TransferBuffer::GetMaxAllocation() const {
   return HaveBuffer() ? max_buffer_size_ - result_size_ : 0;
 }
 
+size_t TransferBuffer::GetRetiredSegmentCount() const {
+  return retired_segments_.size();
+}
+
 void ScopedTransferBufferPtr::Release() {
   if (buffer_) {
     transfer_buffer_->FreePendingToken(buffer_, helper_->InsertToken());
@@ -5,6 +5,8 @@
 #ifndef GPU_COMMAND_BUFFER_CLIENT_TRANSFER_BUFFER_H_
 #define GPU_COMMAND_BUFFER_CLIENT_TRANSFER_BUFFER_H_
 
+#include <vector>
+
 #include "../../gpu_export.h"
 #include "../common/buffer.h"
 #include "../common/compiler_specific.h"
@@ -85,8 +87,20 @@ class GPU_EXPORT TransferBufferInterface {
 };
 
 // Class that manages the transfer buffer.
+//
+// Allocations come from one segment, a ring buffer in its own shared memory.
+// When that segment is too small for an allocation, or too full to take one
+// without waiting for the service, a larger segment takes its place and the
+// old one is destroyed once the service is done with it. The segments alive
+// at once stay within max_buffer_size bytes. After a long enough run of
+// allocations that would fit in the default size, an idle segment larger
+// than that is replaced by a default size one again.
 class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
  public:
+  // The number of allocations in a row that fit in the default size after
+  // which a larger segment is shrunk back.
+  static const unsigned int kAllocationsBeforeShrink = 256;
+
   TransferBuffer(CommandBufferHelper* helper);
   virtual ~TransferBuffer();
 
@@ -112,16 +126,50 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
   // These are for testing.
   unsigned int GetCurrentMaxAllocationWithoutRealloc() const;
   unsigned int GetMaxAllocation() const;
+  size_t GetRetiredSegmentCount() const;
 
  private:
+  // A segment that no longer takes allocations, kept until the service is
+  // done with the memory freed in it.
+  struct RetiredSegment {
+    int32 id;
+    unsigned int size;
+    AlignedRingBuffer* ring_buffer;
+  };
+
   // Tries to reallocate the ring buffer if it's not large enough for size.
   void ReallocateRingBuffer(unsigned int size);
 
   void AllocateRingBuffer(unsigned int size);
 
+  // Destroys the retired segments the service is done with, then moves to a
+  // larger segment if size bytes can't be allocated from the current one
+  // without waiting for the service, and the budget allows.
+  void GrowIfFull(unsigned int size);
+
+  // Moves back to a default size segment after kAllocationsBeforeShrink
+  // allocations of size bytes or less in a row, once the current one is idle.
+  void ShrinkIfIdle(unsigned int size);
+
+  // Stops allocating from the current segment, keeping it until the service
+  // is done with it.
+  void RetireRingBuffer();
+
+  // Destroys the retired segments the service is done with. If wait is true,
+  // waits for the service to be done with all of them first.
+  void FreeRetiredSegments(bool wait);
+
   CommandBufferHelper* helper_;
   scoped_ptr<AlignedRingBuffer> ring_buffer_;
 
+  std::vector<RetiredSegment> retired_segments_;
+
+  // total size of the retired segments
+  unsigned int retired_size_;
+
+  // allocations in a row that would fit in the default size
+  unsigned int small_allocations_;
+
   // size reserved for results
   unsigned int result_size_;
 
@@ -202,7 +202,8 @@ TEST_F(TransferBufferTest, Flush) {
 
 class MockClientCommandBufferCanFail : public MockClientCommandBufferMockFlush {
  public:
-  MockClientCommandBufferCanFail() {
+  MockClientCommandBufferCanFail()
+      : service_behind_(false) {
   }
   virtual ~MockClientCommandBufferCanFail() {
   }
@@ -212,6 +213,21 @@ class MockClientCommandBufferCanFail : public MockClientCommandBufferMockFlush {
   int32 RealCreateTransferBuffer(size_t size, int32 id_request) {
     return MockCommandBufferBase::CreateTransferBuffer(size, id_request);
   }
+
+  // While the service is behind, none of the tokens have passed.
+  virtual State GetLastState() OVERRIDE {
+    State state = MockCommandBufferBase::GetLastState();
+    if (service_behind_)
+      state.token = 0;
+    return state;
+  }
+
+  void set_service_behind(bool service_behind) {
+    service_behind_ = service_behind;
+  }
+
+ private:
+  bool service_behind_;
 };
 
 class TransferBufferExpandContractTest : public testing::Test {
@@ -453,6 +469,79 @@ TEST_F(TransferBufferExpandContractTest, ReallocsToDefault) {
       transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
 }
 
-}  // namespace gpu
+TEST_F(TransferBufferExpandContractTest, GrowsInsteadOfWaiting) {
+  const size_t kSize = kStartTransferBufferSize - kStartingOffset;
+  command_buffer()->set_service_behind(true);
+
+  // Fill the buffer.
+  void* ptr = transfer_buffer_->Alloc(kSize);
+  ASSERT_TRUE(ptr != NULL);
+  transfer_buffer_->FreePendingToken(ptr, helper_->InsertToken());
 
+  // The next allocation goes to a new segment instead of waiting.
+  EXPECT_CALL(*command_buffer(),
+              CreateTransferBuffer(kStartTransferBufferSize * 2, _))
+      .WillOnce(Invoke(
+          command_buffer(),
+          &MockClientCommandBufferCanFail::RealCreateTransferBuffer))
+      .RetiresOnSaturation();
+  ptr = transfer_buffer_->Alloc(kSize);
+  ASSERT_TRUE(ptr != NULL);
+  EXPECT_EQ(1u, transfer_buffer_->GetRetiredSegmentCount());
+  EXPECT_NE(transfer_buffer_id_, transfer_buffer_->GetShmId());
+  transfer_buffer_->FreePendingToken(ptr, helper_->InsertToken());
 
+  // The old segment goes away once the service is done with it.
+  command_buffer()->set_service_behind(false);
+  EXPECT_CALL(*command_buffer(), DestroyTransferBuffer(transfer_buffer_id_))
+      .Times(1)
+      .RetiresOnSaturation();
+  ptr = transfer_buffer_->Alloc(kSize);
+  ASSERT_TRUE(ptr != NULL);
+  EXPECT_EQ(0u, transfer_buffer_->GetRetiredSegmentCount());
+  transfer_buffer_->FreePendingToken(ptr, 1);
+}
+
+TEST_F(TransferBufferExpandContractTest, ShrinksWhenIdle) {
+  EXPECT_CALL(*command_buffer(), DestroyTransferBuffer(_))
+      .Times(1)
+      .RetiresOnSaturation();
+  EXPECT_CALL(*command_buffer(),
+              CreateTransferBuffer(kStartTransferBufferSize * 2, _))
+      .WillOnce(Invoke(
+          command_buffer(),
+          &MockClientCommandBufferCanFail::RealCreateTransferBuffer))
+      .RetiresOnSaturation();
+  const size_t kSize1 = kStartTransferBufferSize * 2 - kStartingOffset;
+  unsigned int size_allocated = 0;
+  void* ptr = transfer_buffer_->AllocUpTo(kSize1, &size_allocated);
+  ASSERT_TRUE(ptr != NULL);
+  transfer_buffer_->FreePendingToken(ptr, 1);
+
+  // Small allocations keep the larger buffer for a while.
+  for (unsigned int i = 1; i < TransferBuffer::kAllocationsBeforeShrink; ++i) {
+    ptr = transfer_buffer_->Alloc(8u);
+    ASSERT_TRUE(ptr != NULL);
+    transfer_buffer_->FreePendingToken(ptr, 1);
+  }
+  EXPECT_EQ(kSize1, transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
+
+  // Then it shrinks back to the default size.
+  EXPECT_CALL(*command_buffer(), DestroyTransferBuffer(_))
+      .Times(1)
+      .RetiresOnSaturation();
+  EXPECT_CALL(*command_buffer(),
+              CreateTransferBuffer(kStartTransferBufferSize, _))
+      .WillOnce(Invoke(
+          command_buffer(),
+          &MockClientCommandBufferCanFail::RealCreateTransferBuffer))
+      .RetiresOnSaturation();
+  ptr = transfer_buffer_->Alloc(8u);
+  ASSERT_TRUE(ptr != NULL);
+  transfer_buffer_->FreePendingToken(ptr, 1);
+  EXPECT_EQ(
+      kStartTransferBufferSize - kStartingOffset,
+      transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
+}
+
+}  // namespace gpu
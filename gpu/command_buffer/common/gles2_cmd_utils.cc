@@ -294,6 +294,8 @@ int GLES2Util::GLGetNumValuesReturned(int id) const {
       return 1;
     case GL_TEXTURE_MAX_ANISOTROPY_EXT:
       return 1;
+    case GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM:
+      return 1;
 
     // -- glGetVertexAttribfv, glGetVertexAttribiv
     case GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING:
@@ -349,6 +349,7 @@ static GLES2Util::EnumToString enum_to_string_table[] = {
   { 0x93A0, "GL_TRANSLATED_SHADER_SOURCE_LENGTH_ANGLE", },
   { 0x93A3, "GL_FRAMEBUFFER_ATTACHMENT_ANGLE", },
   { 0x93A2, "GL_TEXTURE_USAGE_ANGLE", },
+  { 0x6000, "GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM", },
   { 0x8802, "GL_STENCIL_BACK_PASS_DEPTH_FAIL", },
   { 0x8C01, "GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG", },
   { 0x8C00, "GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG", },
@@ -893,6 +894,7 @@ std::string GLES2Util::GetStringPixelStore(uint32 value) {
     { GL_UNPACK_FLIP_Y_CHROMIUM, "GL_UNPACK_FLIP_Y_CHROMIUM" },
     { GL_UNPACK_PREMULTIPLY_ALPHA_CHROMIUM,
     "GL_UNPACK_PREMULTIPLY_ALPHA_CHROMIUM" },
+    { GL_UNPACK_ASYNC_CHROMIUM, "GL_UNPACK_ASYNC_CHROMIUM" },
   };
   return GLES2Util::GetQualifiedEnumString(
       string_table, arraysize(string_table), value);
@@ -948,6 +950,8 @@ std::string GLES2Util::GetStringQueryTarget(uint32 value) {
     { GL_ANY_SAMPLES_PASSED_CONSERVATIVE_EXT,
     "GL_ANY_SAMPLES_PASSED_CONSERVATIVE_EXT" },
     { GL_COMMANDS_ISSUED_CHROMIUM, "GL_COMMANDS_ISSUED_CHROMIUM" },
+    { GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM,
+    "GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM" },
   };
   return GLES2Util::GetQualifiedEnumString(
       string_table, arraysize(string_table), value);
@@ -1165,6 +1169,8 @@ std::string GLES2Util::GetStringTextureParameter(uint32 value) {
     { GL_TEXTURE_MIN_FILTER, "GL_TEXTURE_MIN_FILTER" },
     { GL_TEXTURE_WRAP_S, "GL_TEXTURE_WRAP_S" },
     { GL_TEXTURE_WRAP_T, "GL_TEXTURE_WRAP_T" },
+    { GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM,
+    "GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM" },
   };
   return GLES2Util::GetQualifiedEnumString(
       string_table, arraysize(string_table), value);
@@ -0,0 +1,217 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "gpu/command_buffer/common/command_buffer.h"
+
+namespace gpu {
+
+namespace {
+
+const char kMagic[] = { 'G', 'P', 'U', 'C', 'B', 'R', 'E', 'C' };
+const uint32 kVersion = 1;
+
+}  // namespace
+
+// GCC requires these declarations, but MSVC requires they not be present
+#ifndef _MSC_VER
+const uint32 CommandBufferRecorder::kPageSize;
+#endif
+
+CommandBufferRecorder::CommandBufferRecorder()
+    : file_(NULL) {
+}
+
+CommandBufferRecorder::~CommandBufferRecorder() {
+  if (file_)
+    file_util::CloseFile(file_);
+}
+
+bool CommandBufferRecorder::Initialize(const FilePath& path) {
+  DCHECK(!file_);
+  file_ = file_util::OpenFile(path, "wb");
+  if (!file_) {
+    DLOG(ERROR) << "Could not create " << path.value();
+    return false;
+  }
+  Write(kMagic, sizeof(kMagic));
+  Write(&kVersion, sizeof(kVersion));
+  return true;
+}
+
+void CommandBufferRecorder::RecordRegisterTransferBuffer(int32 id,
+                                                         const Buffer& buffer) {
+  TrackedBuffer& tracked = buffers_[id];
+  tracked.buffer = buffer;
+  // The played back buffer starts out zeroed, so only the pages that are not
+  // need to be written at the next flush.
+  tracked.contents.assign(buffer.size, 0);
+
+  uint32 type = kRegisterTransferBuffer;
+  uint32 size = buffer.size;
+  Write(&type, sizeof(type));
+  Write(&id, sizeof(id));
+  Write(&size, sizeof(size));
+}
+
+void CommandBufferRecorder::RecordDestroyTransferBuffer(int32 id) {
+  if (!buffers_.erase(id))
+    return;
+  uint32 type = kDestroyTransferBuffer;
+  Write(&type, sizeof(type));
+  Write(&id, sizeof(id));
+}
+
+void CommandBufferRecorder::RecordSetGetBuffer(int32 id) {
+  uint32 type = kSetGetBuffer;
+  Write(&type, sizeof(type));
+  Write(&id, sizeof(id));
+}
+
+void CommandBufferRecorder::RecordFlush(int32 put_offset) {
+  for (TrackedBufferMap::iterator it = buffers_.begin();
+       it != buffers_.end(); ++it) {
+    WriteChangedPages(it->first, &it->second);
+  }
+  uint32 type = kFlush;
+  Write(&type, sizeof(type));
+  Write(&put_offset, sizeof(put_offset));
+  fflush(file_);
+}
+
+void CommandBufferRecorder::WriteChangedPages(int32 id,
+                                              TrackedBuffer* tracked) {
+  const int8* data = static_cast<const int8*>(tracked->buffer.ptr);
+  uint32 buffer_size = tracked->contents.size();
+  uint32 offset = 0;
+  while (offset < buffer_size) {
+    uint32 size = std::min(kPageSize, buffer_size - offset);
+    if (memcmp(&tracked->contents[offset], data + offset, size) == 0) {
+      offset += size;
+      continue;
+    }
+    // Write the run of changed pages starting here as one record.
+    uint32 end = offset + size;
+    while (end < buffer_size) {
+      uint32 next_size = std::min(kPageSize, buffer_size - end);
+      if (memcmp(&tracked->contents[end], data + end, next_size) == 0)
+        break;
+      end += next_size;
+    }
+    memcpy(&tracked->contents[offset], data + offset, end - offset);
+
+    uint32 type = kWriteTransferBuffer;
+    uint32 run_size = end - offset;
+    Write(&type, sizeof(type));
+    Write(&id, sizeof(id));
+    Write(&offset, sizeof(offset));
+    Write(&run_size, sizeof(run_size));
+    Write(data + offset, run_size);
+    offset = end;
+  }
+}
+
+void CommandBufferRecorder::Write(const void* data, size_t size) {
+  if (!file_)
+    return;
+  if (fwrite(data, 1, size, file_) != size) {
+    DLOG(ERROR) << "Could not write the command buffer recording.";
+    file_util::CloseFile(file_);
+    file_ = NULL;
+  }
+}
+
+CommandBufferPlayer::CommandBufferPlayer(CommandBuffer* command_buffer)
+    : command_buffer_(command_buffer),
+      file_(NULL),
+      failed_(false) {
+}
+
+CommandBufferPlayer::~CommandBufferPlayer() {
+  if (file_)
+    file_util::CloseFile(file_);
+}
+
+bool CommandBufferPlayer::Initialize(const FilePath& path) {
+  DCHECK(!file_);
+  file_ = file_util::OpenFile(path, "rb");
+  if (!file_)
+    return false;
+  char magic[sizeof(kMagic)];
+  uint32 version = 0;
+  return Read(magic, sizeof(magic)) &&
+         memcmp(magic, kMagic, sizeof(kMagic)) == 0 &&
+         Read(&version, sizeof(version)) &&
+         version == kVersion;
+}
+
+bool CommandBufferPlayer::PlayNextFlush() {
+  if (!file_ || failed_)
+    return false;
+  uint32 type = 0;
+  while (Read(&type, sizeof(type))) {
+    int32 id = 0;
+    if (!Read(&id, sizeof(id)))
+      return Fail();
+    switch (type) {
+      case CommandBufferRecorder::kRegisterTransferBuffer: {
+        uint32 size = 0;
+        if (!Read(&size, sizeof(size)) ||
+            command_buffer_->CreateTransferBuffer(size, id) != id) {
+          return Fail();
+        }
+        break;
+      }
+      case CommandBufferRecorder::kDestroyTransferBuffer:
+        command_buffer_->DestroyTransferBuffer(id);
+        break;
+      case CommandBufferRecorder::kSetGetBuffer:
+        command_buffer_->SetGetBuffer(id);
+        break;
+      case CommandBufferRecorder::kWriteTransferBuffer: {
+        uint32 offset = 0;
+        uint32 size = 0;
+        if (!Read(&offset, sizeof(offset)) || !Read(&size, sizeof(size)))
+          return Fail();
+        Buffer buffer = command_buffer_->GetTransferBuffer(id);
+        if (!buffer.ptr || offset > buffer.size ||
+            size > buffer.size - offset ||
+            !Read(static_cast<int8*>(buffer.ptr) + offset, size)) {
+          return Fail();
+        }
+        break;
+      }
+      case CommandBufferRecorder::kFlush:
+        // The id of a flush record is its put offset.
+        command_buffer_->Flush(id);
+        return true;
+      default:
+        return Fail();
+    }
+  }
+  // A recording may only end between records.
+  if (!feof(file_))
+    return Fail();
+  return false;
+}
+
+bool CommandBufferPlayer::Read(void* data, size_t size) {
+  return fread(data, 1, size, file_) == size;
+}
+
+bool CommandBufferPlayer::Fail() {
+  DLOG(ERROR) << "Could not play back the command buffer recording.";
+  failed_ = true;
+  return false;
+}
+
+}  // namespace gpu
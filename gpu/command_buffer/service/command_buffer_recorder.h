@@ -0,0 +1,107 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_COMMAND_BUFFER_RECORDER_H_
+#define GPU_COMMAND_BUFFER_SERVICE_COMMAND_BUFFER_RECORDER_H_
+
+#include <stdio.h>
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "gpu/command_buffer/common/buffer.h"
+#include "gpu/gpu_export.h"
+
+class FilePath;
+
+namespace gpu {
+
+class CommandBuffer;
+
+// Writes what a CommandBufferService is asked to do, along with what changed
+// in its transfer buffers before each flush, to a file. CommandBufferPlayer
+// plays such a recording back against another command buffer, so the command
+// stream of a real page can be run through the decoder again and again.
+//
+// A recording is a header followed by records, in host byte order. It is only
+// meant to be played back on the kind of machine it was recorded on.
+class GPU_EXPORT CommandBufferRecorder {
+ public:
+  enum RecordType {
+    kRegisterTransferBuffer = 1,  // int32 id, uint32 size
+    kDestroyTransferBuffer,       // int32 id
+    kSetGetBuffer,                // int32 id
+    kWriteTransferBuffer,         // int32 id, uint32 offset, uint32 size, data
+    kFlush,                       // int32 put_offset
+  };
+
+  // Transfer buffers are compared and written in pages of this size.
+  static const uint32 kPageSize = 4096;
+
+  CommandBufferRecorder();
+  ~CommandBufferRecorder();
+
+  // Starts a recording in |path|. Returns false if the file can't be created.
+  bool Initialize(const FilePath& path);
+
+  void RecordRegisterTransferBuffer(int32 id, const Buffer& buffer);
+  void RecordDestroyTransferBuffer(int32 id);
+  void RecordSetGetBuffer(int32 id);
+
+  // Writes the pages of the transfer buffers that changed since the last
+  // flush, then the flush itself.
+  void RecordFlush(int32 put_offset);
+
+ private:
+  // A transfer buffer, with a copy of its contents as of the last flush.
+  struct TrackedBuffer {
+    Buffer buffer;
+    std::vector<int8> contents;
+  };
+  typedef std::map<int32, TrackedBuffer> TrackedBufferMap;
+
+  void WriteChangedPages(int32 id, TrackedBuffer* tracked);
+  void Write(const void* data, size_t size);
+
+  FILE* file_;
+  TrackedBufferMap buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(CommandBufferRecorder);
+};
+
+// Plays back a recording made by CommandBufferRecorder against a command
+// buffer, one flush at a time. The transfer buffers of the recording get the
+// same ids in the command buffer, which must not have any yet.
+class GPU_EXPORT CommandBufferPlayer {
+ public:
+  explicit CommandBufferPlayer(CommandBuffer* command_buffer);
+  ~CommandBufferPlayer();
+
+  // Opens the recording in |path|. Returns false if it can't be read or is
+  // not a recording.
+  bool Initialize(const FilePath& path);
+
+  // Plays the records up to and including the next flush. Returns false at
+  // the end of the recording, or if it fails.
+  bool PlayNextFlush();
+
+  // Whether playing back failed, because the recording is truncated or
+  // corrupt or the command buffer refused a transfer buffer.
+  bool failed() const { return failed_; }
+
+ private:
+  bool Read(void* data, size_t size);
+  bool Fail();
+
+  CommandBuffer* command_buffer_;
+  FILE* file_;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(CommandBufferPlayer);
+};
+
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_COMMAND_BUFFER_RECORDER_H_
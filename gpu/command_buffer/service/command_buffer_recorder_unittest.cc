@@ -0,0 +1,119 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "gpu/command_buffer/common/cmd_buffer_common.h"
+#include "gpu/command_buffer/service/command_buffer_service.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace gpu {
+
+class CommandBufferRecorderTest : public testing::Test {
+ protected:
+  static const size_t kRingBufferSize = 1024;
+  static const size_t kDataBufferSize = 3 * CommandBufferRecorder::kPageSize;
+
+  CommandBufferRecorderTest()
+      : ring_buffer_id_(-1) {
+  }
+
+  virtual void SetUp() {
+    ASSERT_TRUE(file_util::CreateTemporaryFile(&path_));
+    played_.SetPutOffsetChangeCallback(base::Bind(
+        &CommandBufferRecorderTest::OnPlayedFlush, base::Unretained(this)));
+  }
+
+  virtual void TearDown() {
+    file_util::Delete(path_, false);
+  }
+
+  // Records the put offset and the first ring buffer entries of each flush
+  // played back.
+  void OnPlayedFlush() {
+    CommandBuffer::State state = played_.GetState();
+    put_offsets_.push_back(state.put_offset);
+    CommandBufferEntry* entries = static_cast<CommandBufferEntry*>(
+        played_.GetTransferBuffer(ring_buffer_id_).ptr);
+    first_entries_.push_back(entries[0].value_uint32);
+  }
+
+  FilePath path_;
+  CommandBufferService played_;
+  int32 ring_buffer_id_;
+  std::vector<int32> put_offsets_;
+  std::vector<uint32> first_entries_;
+};
+
+// GCC requires these declarations, but MSVC requires they not be present
+#ifndef _MSC_VER
+const size_t CommandBufferRecorderTest::kRingBufferSize;
+const size_t CommandBufferRecorderTest::kDataBufferSize;
+#endif
+
+TEST_F(CommandBufferRecorderTest, PlaysBackFlushes) {
+  const size_t kDataOffset = CommandBufferRecorder::kPageSize + 10;
+  int32 data_buffer_id = -1;
+  {
+    CommandBufferService recorded;
+    CommandBufferRecorder* recorder = new CommandBufferRecorder;
+    ASSERT_TRUE(recorder->Initialize(path_));
+    recorded.SetRecorder(recorder);
+
+    ring_buffer_id_ = recorded.CreateTransferBuffer(kRingBufferSize, -1);
+    data_buffer_id = recorded.CreateTransferBuffer(kDataBufferSize, -1);
+    recorded.SetGetBuffer(ring_buffer_id_);
+    CommandBufferEntry* entries = static_cast<CommandBufferEntry*>(
+        recorded.GetTransferBuffer(ring_buffer_id_).ptr);
+    int8* data = static_cast<int8*>(
+        recorded.GetTransferBuffer(data_buffer_id).ptr);
+
+    entries[0].value_uint32 = 42;
+    data[kDataOffset] = 7;
+    recorded.Flush(1);
+
+    entries[0].value_uint32 = 43;
+    recorded.DestroyTransferBuffer(data_buffer_id);
+    recorded.Flush(2);
+  }
+
+  CommandBufferPlayer player(&played_);
+  ASSERT_TRUE(player.Initialize(path_));
+
+  EXPECT_TRUE(player.PlayNextFlush());
+  ASSERT_EQ(1u, put_offsets_.size());
+  EXPECT_EQ(1, put_offsets_[0]);
+  EXPECT_EQ(42u, first_entries_[0]);
+  Buffer data_buffer = played_.GetTransferBuffer(data_buffer_id);
+  ASSERT_TRUE(data_buffer.ptr != NULL);
+  EXPECT_EQ(kDataBufferSize, data_buffer.size);
+  EXPECT_EQ(7, static_cast<int8*>(data_buffer.ptr)[kDataOffset]);
+
+  EXPECT_TRUE(player.PlayNextFlush());
+  ASSERT_EQ(2u, put_offsets_.size());
+  EXPECT_EQ(2, put_offsets_[1]);
+  EXPECT_EQ(43u, first_entries_[1]);
+  EXPECT_TRUE(played_.GetTransferBuffer(data_buffer_id).ptr == NULL);
+
+  EXPECT_FALSE(player.PlayNextFlush());
+  EXPECT_FALSE(player.failed());
+}
+
+TEST_F(CommandBufferRecorderTest, RejectsOtherFiles) {
+  const char kNotARecording[] = "not a recording";
+  ASSERT_EQ(static_cast<int>(sizeof(kNotARecording)),
+            file_util::WriteFile(path_, kNotARecording,
+                                 sizeof(kNotARecording)));
+  CommandBufferPlayer player(&played_);
+  EXPECT_FALSE(player.Initialize(path_));
+}
+
+}  // namespace gpu
@@ -10,6 +10,7 @@
 #include "base/debug/trace_event.h"
 #include "gpu/command_buffer/common/cmd_buffer_common.h"
 #include "gpu/command_buffer/common/command_buffer_shared.h"
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
 
 using ::base::SharedMemory;
 
@@ -77,6 +78,9 @@ CommandBufferService::State CommandBufferService::FlushSync(
 
   put_offset_ = put_offset;
 
+  if (recorder_.get())
+    recorder_->RecordFlush(put_offset);
+
   if (!put_offset_change_callback_.is_null())
     put_offset_change_callback_.Run();
 
@@ -91,6 +95,9 @@ void CommandBufferService::Flush(int32 put_offset) {
 
   put_offset_ = put_offset;
 
+  if (recorder_.get())
+    recorder_->RecordFlush(put_offset);
+
   if (!put_offset_change_callback_.is_null())
     put_offset_change_callback_.Run();
 }
@@ -98,6 +105,8 @@ void CommandBufferService::Flush(int32 put_offset) {
 void CommandBufferService::SetGetBuffer(int32 transfer_buffer_id) {
   DCHECK_EQ(-1, ring_buffer_id_);
   DCHECK_EQ(put_offset_, get_offset_);  // Only if it's empty.
+  if (recorder_.get())
+    recorder_->RecordSetGetBuffer(transfer_buffer_id);
   ring_buffer_ = GetTransferBuffer(transfer_buffer_id);
   DCHECK(ring_buffer_.ptr);
   ring_buffer_id_ = transfer_buffer_id;
@@ -168,6 +177,14 @@ int32 CommandBufferService::RegisterTransferBuffer(
   buffer.size = size;
   buffer.shared_memory = duped_shared_memory.release();
 
+  int32 handle = AddRegisteredObject(buffer, id_request);
+  if (recorder_.get())
+    recorder_->RecordRegisterTransferBuffer(handle, buffer);
+  return handle;
+}
+
+int32 CommandBufferService::AddRegisteredObject(const Buffer& buffer,
+                                                int32 id_request) {
   // If caller requested specific id, first try to use id_request.
   if (id_request != -1) {
     int32 cur_size = static_cast<int32>(registered_objects_.size());
@@ -207,6 +224,9 @@ void CommandBufferService::DestroyTransferBuffer(int32 handle) {
   if (static_cast<size_t>(handle) >= registered_objects_.size())
     return;
 
+  if (recorder_.get())
+    recorder_->RecordDestroyTransferBuffer(handle);
+
   shared_memory_bytes_allocated_ -= registered_objects_[handle].size;
   TRACE_COUNTER_ID1(
       "CommandBuffer", "SharedMemory", this, shared_memory_bytes_allocated_);
@@ -276,4 +296,9 @@ void CommandBufferService::SetParseErrorCallback(
   parse_error_callback_ = callback;
 }
 
+void CommandBufferService::SetRecorder(CommandBufferRecorder* recorder) {
+  DCHECK_EQ(1u, registered_objects_.size());
+  recorder_.reset(recorder);
+}
+
 }  // namespace gpu
@@ -17,6 +17,8 @@
 
 namespace gpu {
 
+class CommandBufferRecorder;
+
 // An object that implements a shared memory command buffer and a synchronous
 // API to manage the put and get pointers.
 class GPU_EXPORT CommandBufferService : public CommandBuffer {
@@ -63,7 +65,15 @@ class GPU_EXPORT CommandBufferService : public CommandBuffer {
   // Copy the current state into the shared state transfer buffer.
   void UpdateState();
 
+  // Records what this command buffer is asked to do with |recorder|, which
+  // this takes ownership of. Must be called before any transfer buffer is
+  // registered.
+  void SetRecorder(CommandBufferRecorder* recorder);
+
  private:
+  // Registers |buffer| under |id_request| or a free id, and returns the id.
+  int32 AddRegisteredObject(const Buffer& buffer, int32 id_request);
+
   int32 ring_buffer_id_;
   Buffer ring_buffer_;
   CommandBufferSharedState* shared_state_;
@@ -80,6 +90,7 @@ class GPU_EXPORT CommandBufferService : public CommandBuffer {
   error::Error error_;
   error::ContextLostReason context_lost_reason_;
   size_t shared_memory_bytes_allocated_;
+  scoped_ptr<CommandBufferRecorder> recorder_;
 };
 
 }  // namespace gpu
@@ -17,6 +17,7 @@
 #include "gpu/command_buffer/service/program_manager.h"
 #include "gpu/command_buffer/service/renderbuffer_manager.h"
 #include "gpu/command_buffer/service/shader_manager.h"
+#include "gpu/command_buffer/service/shader_translator.h"
 #include "gpu/command_buffer/service/texture_manager.h"
 #include "ui/gfx/gl/gl_implementation.h"
 
@@ -37,6 +38,7 @@ ContextGroup::ContextGroup(MailboxManager* mailbox_manager,
       max_fragment_uniform_vectors_(0u),
       max_varying_vectors_(0u),
       max_vertex_uniform_vectors_(0u),
+      shader_translation_cache_(new ShaderTranslationCache),
       feature_info_(new FeatureInfo()) {
   id_namespaces_[id_namespaces::kBuffers].reset(new IdAllocator);
   id_namespaces_[id_namespaces::kFramebuffers].reset(new IdAllocator);
@@ -29,6 +29,7 @@ class MailboxManager;
 class RenderbufferManager;
 class ProgramManager;
 class ShaderManager;
+class ShaderTranslationCache;
 class TextureManager;
 struct DisallowedFeatures;
 
@@ -115,6 +116,11 @@ class GPU_EXPORT ContextGroup : public base::RefCounted<ContextGroup> {
     return shader_manager_.get();
   }
 
+  // The shader translations of all the contexts in the group.
+  ShaderTranslationCache* shader_translation_cache() const {
+    return shader_translation_cache_.get();
+  }
+
   IdAllocatorInterface* GetIdAllocator(unsigned namespace_id);
 
  private:
@@ -150,6 +156,8 @@ class GPU_EXPORT ContextGroup : public base::RefCounted<ContextGroup> {
 
   scoped_ptr<ShaderManager> shader_manager_;
 
+  scoped_ptr<ShaderTranslationCache> shader_translation_cache_;
+
   linked_ptr<IdAllocatorInterface>
       id_namespaces_[id_namespaces::kNumIdNamespaces];
 
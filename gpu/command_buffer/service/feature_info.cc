@@ -122,11 +122,20 @@ void FeatureInfo::AddFeatures(const char* desired_features) {
   AddExtensionString("GL_CHROMIUM_copy_texture");
   AddExtensionString("GL_CHROMIUM_texture_mailbox");
   AddExtensionString("GL_ANGLE_translated_shader_source");
+  AddExtensionString("GL_CHROMIUM_async_pixel_transfers");
+  AddExtensionString("GL_CHROMIUM_texture_residency_priority");
 
   if (ext.Have("GL_ANGLE_translated_shader_source")) {
     feature_flags_.angle_translated_shader_source = true;
   }
 
+  // Asynchronous pixel transfers are staged through pixel buffer objects
+  // where there are any. Without them they are synchronous.
+  if (ext.Have("GL_ARB_pixel_buffer_object") ||
+      ext.Have("GL_NV_pixel_buffer_object")) {
+    feature_flags_.pixel_buffer_object = true;
+  }
+
   // Only turn this feature on if it is requested. Not by default.
   if (desired_features && ext.Desire("GL_CHROMIUM_webglsl")) {
     AddExtensionString("GL_CHROMIUM_webglsl");
@@ -34,7 +34,8 @@ class GPU_EXPORT FeatureInfo : public base::RefCounted<FeatureInfo> {
           arb_texture_rectangle(false),
           angle_instanced_arrays(false),
           occlusion_query_boolean(false),
-          use_arb_occlusion_query2_for_occlusion_query_boolean(false) {
+          use_arb_occlusion_query2_for_occlusion_query_boolean(false),
+          pixel_buffer_object(false) {
     }
 
     bool chromium_framebuffer_multisample;
@@ -51,6 +52,7 @@ class GPU_EXPORT FeatureInfo : public base::RefCounted<FeatureInfo> {
     bool angle_instanced_arrays;
     bool occlusion_query_boolean;
     bool use_arb_occlusion_query2_for_occlusion_query_boolean;
+    bool pixel_buffer_object;
   };
 
   FeatureInfo();
@@ -73,6 +73,10 @@ TEST_F(FeatureInfoTest, InitializeNoExtensions) {
   EXPECT_THAT(info_->extensions(), HasSubstr("GL_CHROMIUM_strict_attribs"));
   EXPECT_THAT(info_->extensions(),
               HasSubstr("GL_ANGLE_translated_shader_source"));
+  EXPECT_THAT(info_->extensions(),
+              HasSubstr("GL_CHROMIUM_async_pixel_transfers"));
+  EXPECT_THAT(info_->extensions(),
+              HasSubstr("GL_CHROMIUM_texture_residency_priority"));
 
   // Check a couple of random extensions that should not be there.
   EXPECT_THAT(info_->extensions(), Not(HasSubstr("GL_CHROMIUM_webglsl")));
@@ -89,6 +93,7 @@ TEST_F(FeatureInfoTest, InitializeNoExtensions) {
               Not(HasSubstr("GL_EXT_texture_storage")));
   EXPECT_FALSE(info_->feature_flags().npot_ok);
   EXPECT_FALSE(info_->feature_flags().chromium_webglsl);
+  EXPECT_FALSE(info_->feature_flags().pixel_buffer_object);
   EXPECT_FALSE(info_->validators()->compressed_texture_format.IsValid(
       GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
   EXPECT_FALSE(info_->validators()->compressed_texture_format.IsValid(
@@ -404,6 +409,12 @@ TEST_F(FeatureInfoTest, InitializeOES_standard_derivatives) {
       GL_FRAGMENT_SHADER_DERIVATIVE_HINT_OES));
 }
 
+TEST_F(FeatureInfoTest, InitializeARB_pixel_buffer_object) {
+  SetupInitExpectations("GL_ARB_pixel_buffer_object");
+  info_->Initialize(NULL);
+  EXPECT_TRUE(info_->feature_flags().pixel_buffer_object);
+}
+
 TEST_F(FeatureInfoTest, InitializeCHROMIUM_webglsl) {
   SetupInitExpectations("");
   info_->Initialize("GL_CHROMIUM_webglsl");
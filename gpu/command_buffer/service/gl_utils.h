@@ -85,6 +85,13 @@
 // GL_CHROMIUM_command_buffer_query
 #define GL_COMMANDS_ISSUED_CHROMIUM            0x84F2
 
+// GL_CHROMIUM_async_pixel_transfers
+#define GL_UNPACK_ASYNC_CHROMIUM                    0x9244
+#define GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM 0x84F5
+
+// GL_CHROMIUM_texture_residency_priority
+#define GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM 0x6000
+
 
 #define GL_GLEXT_PROTOTYPES 1
 
@@ -502,6 +502,7 @@ class GLES2DecoderImpl : public base::SupportsWeakPtr<GLES2DecoderImpl>,
   virtual void SetStreamTextureManager(StreamTextureManager* manager);
   virtual bool GetServiceTextureId(uint32 client_texture_id,
                                    uint32* service_texture_id);
+  virtual bool EvictTexture(uint32 client_texture_id);
 
   // Restores the current state to the user's settings.
   void RestoreCurrentFramebufferBindings();
@@ -729,6 +730,20 @@ class GLES2DecoderImpl : public base::SupportsWeakPtr<GLES2DecoderImpl>,
     GLenum type,
     const void * data);
 
+  // Calls glTexSubImage2D. If the client asked for asynchronous uploads, the
+  // pixels are staged through a pixel buffer object, so that the GPU can
+  // copy them into the texture after this returns.
+  void TexSubImage2DMaybeAsync(
+    GLenum target,
+    GLint level,
+    GLint xoffset,
+    GLint yoffset,
+    GLsizei width,
+    GLsizei height,
+    GLenum format,
+    GLenum type,
+    const void * data);
+
   // Wrapper for TexImageIOSurface2DCHROMIUM.
   void DoTexImageIOSurface2DCHROMIUM(
     GLenum target,
@@ -1068,6 +1083,11 @@ class GLES2DecoderImpl : public base::SupportsWeakPtr<GLES2DecoderImpl>,
   GLuint DoGetMaxValueInBufferCHROMIUM(
       GLuint buffer_id, GLsizei count, GLenum type, GLuint offset);
 
+  // Wrappers for glGetTexParameter, which answer the pnames the decoder
+  // handles itself.
+  void DoGetTexParameterfv(GLenum target, GLenum pname, GLfloat* params);
+  void DoGetTexParameteriv(GLenum target, GLenum pname, GLint* params);
+
   // Wrapper for glGetProgramiv.
   void DoGetProgramiv(
       GLuint program_id, GLenum pname, GLint* params);
@@ -1361,6 +1381,13 @@ class GLES2DecoderImpl : public base::SupportsWeakPtr<GLES2DecoderImpl>,
   // unpack premultiply alpha as last set by glPixelStorei
   bool unpack_premultiply_alpha_;
 
+  // unpack async as last set by glPixelStorei
+  bool unpack_async_;
+
+  // The pixel buffer object asynchronous uploads are staged through, or 0
+  // before the first one.
+  GLuint async_upload_buffer_id_;
+
   // The currently bound array buffer. If this is 0 it is illegal to call
   // glVertexAttribPointer.
   BufferManager::BufferInfo::Ref bound_array_buffer_;
@@ -1869,6 +1896,8 @@ GLES2DecoderImpl::GLES2DecoderImpl(ContextGroup* group)
       unpack_alignment_(4),
       unpack_flip_y_(false),
       unpack_premultiply_alpha_(false),
+      unpack_async_(false),
+      async_upload_buffer_id_(0),
       attrib_0_buffer_id_(0),
       attrib_0_buffer_matches_value_(true),
       attrib_0_size_(0),
@@ -2287,6 +2316,7 @@ bool GLES2DecoderImpl::InitializeShaderTranslator() {
   }
 
   vertex_translator_.reset(new ShaderTranslator);
+  vertex_translator_->set_cache(group_->shader_translation_cache());
   ShShaderSpec shader_spec = force_webgl_glsl_validation_ ||
       feature_info_->feature_flags().chromium_webglsl ?
           SH_WEBGL_SPEC : SH_GLES2_SPEC;
@@ -2305,6 +2335,7 @@ bool GLES2DecoderImpl::InitializeShaderTranslator() {
     return false;
   }
   fragment_translator_.reset(new ShaderTranslator);
+  fragment_translator_->set_cache(group_->shader_translation_cache());
   if (!fragment_translator_->Init(
           SH_FRAGMENT_SHADER, shader_spec, &resources,
           implementation_type, function_behavior)) {
@@ -2727,6 +2758,32 @@ bool GLES2DecoderImpl::GetServiceTextureId(uint32 client_texture_id,
   return false;
 }
 
+bool GLES2DecoderImpl::EvictTexture(uint32 client_texture_id) {
+  TextureManager::TextureInfo* info = GetTextureInfo(client_texture_id);
+  if (!info || !texture_manager()->EvictTexture(info))
+    return false;
+
+  BindAndApplyTextureParameters(info);
+  TextureManager::TextureInfo* bound_info =
+      GetTextureInfoForTarget(info->target());
+  glBindTexture(info->target(), bound_info ? bound_info->service_id() : 0);
+
+  // Deleting the old service id unbound it from every texture unit it was
+  // bound to, so bind the new one in its place.
+  for (uint32 ii = 0; ii < group_->max_texture_units(); ++ii) {
+    TextureUnit& unit = texture_units_[ii];
+    if (unit.bound_texture_2d == info ||
+        unit.bound_texture_cube_map == info ||
+        unit.bound_texture_external_oes == info ||
+        unit.bound_texture_rectangle_arb == info) {
+      glActiveTexture(GL_TEXTURE0 + ii);
+      glBindTexture(info->target(), info->service_id());
+    }
+  }
+  glActiveTexture(GL_TEXTURE0 + active_texture_unit_);
+  return true;
+}
+
 void GLES2DecoderImpl::Destroy() {
   bool have_context = context_.get() && MakeCurrent();
 
@@ -2761,6 +2818,9 @@ void GLES2DecoderImpl::Destroy() {
     if (fixed_attrib_buffer_id_) {
       glDeleteBuffersARB(1, &fixed_attrib_buffer_id_);
     }
+    if (async_upload_buffer_id_) {
+      glDeleteBuffersARB(1, &async_upload_buffer_id_);
+    }
 
     if (offscreen_target_frame_buffer_.get())
       offscreen_target_frame_buffer_->Destroy();
@@ -4490,6 +4550,31 @@ void GLES2DecoderImpl::DoLinkProgram(GLuint program) {
   }
 };
 
+void GLES2DecoderImpl::DoGetTexParameterfv(
+    GLenum target, GLenum pname, GLfloat* params) {
+  if (pname == GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM) {
+    GLint value = 0;
+    DoGetTexParameteriv(target, pname, &value);
+    *params = static_cast<GLfloat>(value);
+    return;
+  }
+  glGetTexParameterfv(target, pname, params);
+}
+
+void GLES2DecoderImpl::DoGetTexParameteriv(
+    GLenum target, GLenum pname, GLint* params) {
+  if (pname == GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM) {
+    TextureManager::TextureInfo* info = GetTextureInfoForTarget(target);
+    if (!info) {
+      SetGLError(GL_INVALID_OPERATION, "glGetTexParameteriv: no texture bound");
+      return;
+    }
+    *params = info->residency_priority();
+    return;
+  }
+  glGetTexParameteriv(target, pname, params);
+}
+
 void GLES2DecoderImpl::DoTexParameterf(
     GLenum target, GLenum pname, GLfloat param) {
   TextureManager::TextureInfo* info = GetTextureInfoForTarget(target);
@@ -4503,6 +4588,8 @@ void GLES2DecoderImpl::DoTexParameterf(
     SetGLError(GL_INVALID_ENUM, "glTexParameterf: param GL_INVALID_ENUM");
     return;
   }
+  if (pname == GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM)
+    return;
   glTexParameterf(target, pname, param);
 }
 
@@ -4518,6 +4605,9 @@ void GLES2DecoderImpl::DoTexParameteri(
     SetGLError(GL_INVALID_ENUM, "glTexParameteri: param GL_INVALID_ENUM");
     return;
   }
+  // The residency priority is only used by the GPU process, not by GL.
+  if (pname == GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM)
+    return;
   glTexParameteri(target, pname, param);
 }
 
@@ -4534,6 +4624,8 @@ void GLES2DecoderImpl::DoTexParameterfv(
     SetGLError(GL_INVALID_ENUM, "glTexParameterfv: param GL_INVALID_ENUM");
     return;
   }
+  if (pname == GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM)
+    return;
   glTexParameterfv(target, pname, params);
 }
 
@@ -4549,6 +4641,8 @@ void GLES2DecoderImpl::DoTexParameteriv(
     SetGLError(GL_INVALID_ENUM, "glTexParameteriv: param GL_INVALID_ENUM");
     return;
   }
+  if (pname == GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM)
+    return;
   glTexParameteriv(target, pname, params);
 }
 
@@ -6231,6 +6325,11 @@ error::Error GLES2DecoderImpl::HandlePixelStorei(
                        "glPixelSTore: param GL_INVALID_VALUE");
             return error::kNoError;
         }
+        break;
+    case GL_UNPACK_ASYNC_CHROMIUM:
+        // This is ours alone; GL doesn't know it.
+        unpack_async_ = (param != 0);
+        return error::kNoError;
     default:
         break;
   }
@@ -7236,23 +7335,59 @@ void GLES2DecoderImpl::DoTexSubImage2D(
       SetGLError(GL_OUT_OF_MEMORY, "glTexSubImage2D: dimensions too big");
       return;
     }
-    glTexSubImage2D(
+    TexSubImage2DMaybeAsync(
         target, level, xoffset, yoffset, width, height, format, type, data);
     return;
   }
 
-  if (teximage2d_faster_than_texsubimage2d_ && !info->IsImmutable()) {
+  if (teximage2d_faster_than_texsubimage2d_ && !info->IsImmutable() &&
+      !unpack_async_) {
     // NOTE: In OpenGL ES 2.0 border is always zero and format is always the
     // same as internal_foramt. If that changes we'll need to look them up.
     WrappedTexImage2D(
         target, level, format, width, height, 0, format, type, data);
   } else {
-    glTexSubImage2D(
+    TexSubImage2DMaybeAsync(
         target, level, xoffset, yoffset, width, height, format, type, data);
   }
   texture_manager()->SetLevelCleared(info, target, level);
 }
 
+void GLES2DecoderImpl::TexSubImage2DMaybeAsync(
+  GLenum target,
+  GLint level,
+  GLint xoffset,
+  GLint yoffset,
+  GLsizei width,
+  GLsizei height,
+  GLenum format,
+  GLenum type,
+  const void * data) {
+  uint32 data_size = 0;
+  if (!unpack_async_ || !feature_info_->feature_flags().pixel_buffer_object ||
+      !GLES2Util::ComputeImageDataSizes(width, height, format, type,
+                                        unpack_alignment_, &data_size,
+                                        NULL, NULL)) {
+    glTexSubImage2D(
+        target, level, xoffset, yoffset, width, height, format, type, data);
+    return;
+  }
+
+  // The pixels are copied out of shared memory into the buffer right away.
+  // Every upload reuses the same buffer: glBufferData gives it new storage,
+  // and GL keeps the old storage until the copy out of it into the texture is
+  // done, so an upload doesn't wait for the one before it. A
+  // GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM query tells the client when
+  // the copies are done.
+  if (!async_upload_buffer_id_)
+    glGenBuffersARB(1, &async_upload_buffer_id_);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, async_upload_buffer_id_);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, data_size, data, GL_STREAM_DRAW);
+  glTexSubImage2D(
+      target, level, xoffset, yoffset, width, height, format, type, NULL);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+}
+
 error::Error GLES2DecoderImpl::HandleTexSubImage2D(
     uint32 immediate_data_size, const gles2::TexSubImage2D& c) {
   TRACE_EVENT0("gpu", "GLES2DecoderImpl::HandleTexSubImage2D");
@@ -8050,6 +8185,7 @@ error::Error GLES2DecoderImpl::HandleBeginQueryEXT(
 
   switch (target) {
     case GL_COMMANDS_ISSUED_CHROMIUM:
+    case GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM:
       break;
     default:
       if (!feature_info_->feature_flags().occlusion_query_boolean) {
@@ -151,6 +151,12 @@ class GPU_EXPORT GLES2Decoder : public CommonDecoder {
   virtual bool GetServiceTextureId(uint32 client_texture_id,
                                    uint32* service_texture_id);
 
+  // Frees the memory of a texture, leaving its levels defined as 0x0 so it
+  // renders black until the client redefines them. The decoder's context must
+  // be current. Returns false if there is no such texture or it can't be
+  // evicted.
+  virtual bool EvictTexture(uint32 client_texture_id) = 0;
+
   // Provides detail about a lost context if one occurred.
   virtual error::ContextLostReason GetContextLostReason() = 0;
 
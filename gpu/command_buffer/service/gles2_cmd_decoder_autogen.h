@@ -1206,7 +1206,7 @@ error::Error GLES2DecoderImpl::HandleGetTexParameterfv(
     return error::kInvalidArguments;
   }
   CopyRealGLErrorsToWrapper();
-  glGetTexParameterfv(target, pname, params);
+  DoGetTexParameterfv(target, pname, params);
   GLenum error = glGetError();
   if (error == GL_NO_ERROR) {
     result->SetNumResults(num_values);
@@ -1242,7 +1242,7 @@ error::Error GLES2DecoderImpl::HandleGetTexParameteriv(
     return error::kInvalidArguments;
   }
   CopyRealGLErrorsToWrapper();
-  glGetTexParameteriv(target, pname, params);
+  DoGetTexParameteriv(target, pname, params);
   GLenum error = glGetError();
   if (error == GL_NO_ERROR) {
     result->SetNumResults(num_values);
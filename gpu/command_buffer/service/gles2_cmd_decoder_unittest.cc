@@ -3155,6 +3155,74 @@ TEST_F(GLES2DecoderTest, TexSubImage2DBadArgs) {
   EXPECT_NE(error::kNoError, ExecuteCmd(cmd));
 }
 
+// With GL_UNPACK_ASYNC_CHROMIUM set, uploads are staged through one pixel
+// buffer object that every upload reuses.
+TEST_F(GLES2DecoderManualInitTest, TexSubImage2DAsync) {
+  InitDecoder(
+      "GL_ARB_pixel_buffer_object",  // extensions
+      false,   // has alpha
+      false,   // has depth
+      false,   // has stencil
+      false,   // request alpha
+      false,   // request depth
+      false,   // request stencil
+      true);   // bind generates resource
+
+  const int kWidth = 16;
+  const int kHeight = 8;
+  const GLuint kServiceUploadBufferId = 401;
+  DoBindTexture(GL_TEXTURE_2D, client_texture_id_, kServiceTextureId);
+  DoTexImage2D(
+      GL_TEXTURE_2D, 1, GL_RGBA, kWidth, kHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+      kSharedMemoryId, kSharedMemoryOffset);
+
+  // The alignment still reaches GL; the async flag does not.
+  EXPECT_CALL(*gl_, PixelStorei(GL_UNPACK_ALIGNMENT, 4))
+      .Times(1)
+      .RetiresOnSaturation();
+  PixelStorei storei_cmd;
+  storei_cmd.Init(GL_UNPACK_ALIGNMENT, 4);
+  EXPECT_EQ(error::kNoError, ExecuteCmd(storei_cmd));
+  storei_cmd.Init(GL_UNPACK_ASYNC_CHROMIUM, 1);
+  EXPECT_EQ(error::kNoError, ExecuteCmd(storei_cmd));
+  EXPECT_EQ(GL_NO_ERROR, GetGLError());
+
+  EXPECT_CALL(*gl_, GenBuffersARB(1, _))
+      .WillOnce(SetArgumentPointee<1>(kServiceUploadBufferId))
+      .RetiresOnSaturation();
+  for (int i = 0; i < 2; ++i) {
+    InSequence sequence;
+    EXPECT_CALL(*gl_, BindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB,
+                                 kServiceUploadBufferId))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, BufferData(GL_PIXEL_UNPACK_BUFFER_ARB,
+                                 (kWidth - 1) * kHeight * 4,
+                                 shared_memory_address_, GL_STREAM_DRAW))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, TexSubImage2D(
+        GL_TEXTURE_2D, 1, 1, 0, kWidth - 1, kHeight, GL_RGBA, GL_UNSIGNED_BYTE,
+        NULL))
+        .Times(1)
+        .RetiresOnSaturation();
+    EXPECT_CALL(*gl_, BindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0))
+        .Times(1)
+        .RetiresOnSaturation();
+    TexSubImage2D cmd;
+    cmd.Init(
+        GL_TEXTURE_2D, 1, 1, 0, kWidth - 1, kHeight, GL_RGBA,
+        GL_UNSIGNED_BYTE, kSharedMemoryId, kSharedMemoryOffset, GL_FALSE);
+    EXPECT_EQ(error::kNoError, ExecuteCmd(cmd));
+    EXPECT_EQ(GL_NO_ERROR, GetGLError());
+  }
+
+  // The buffer goes when the decoder does.
+  EXPECT_CALL(*gl_, DeleteBuffersARB(1, Pointee(kServiceUploadBufferId)))
+      .Times(1)
+      .RetiresOnSaturation();
+}
+
 TEST_F(GLES2DecoderTest, CopyTexSubImage2DValidArgs) {
   const int kWidth = 16;
   const int kHeight = 8;
@@ -6935,6 +7003,33 @@ TEST_F(GLES2DecoderTest, ProduceAndConsumeTextureCHROMIUM) {
   EXPECT_EQ(kServiceTextureId, info->service_id());
 }
 
+TEST_F(GLES2DecoderTest, TextureResidencyPriority) {
+  DoBindTexture(GL_TEXTURE_2D, client_texture_id_, kServiceTextureId);
+
+  // The decoder keeps the priority; it never reaches GL.
+  EXPECT_CALL(*gl_, TexParameteri(_, _, _)).Times(0);
+  TexParameteri cmd;
+  cmd.Init(GL_TEXTURE_2D, GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM, -3);
+  EXPECT_EQ(error::kNoError, ExecuteCmd(cmd));
+  EXPECT_EQ(GL_NO_ERROR, GetGLError());
+
+  EXPECT_CALL(*gl_, GetError())
+      .WillOnce(Return(GL_NO_ERROR))
+      .WillOnce(Return(GL_NO_ERROR))
+      .RetiresOnSaturation();
+  EXPECT_CALL(*gl_, GetTexParameteriv(_, _, _)).Times(0);
+  typedef GetTexParameteriv::Result Result;
+  Result* result = static_cast<Result*>(shared_memory_address_);
+  result->size = 0;
+  GetTexParameteriv get_cmd;
+  get_cmd.Init(GL_TEXTURE_2D, GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM,
+               shared_memory_id_, shared_memory_offset_);
+  EXPECT_EQ(error::kNoError, ExecuteCmd(get_cmd));
+  EXPECT_EQ(1, result->GetNumResults());
+  EXPECT_EQ(-3, result->GetData()[0]);
+  EXPECT_EQ(GL_NO_ERROR, GetGLError());
+}
+
 // TODO(gman): Complete this test.
 // TEST_F(GLES2DecoderTest, CompressedTexImage2DGLError) {
 // }
@@ -241,6 +241,7 @@ static GLenum valid_pixel_store_table[] = {
   GL_UNPACK_ALIGNMENT,
   GL_UNPACK_FLIP_Y_CHROMIUM,
   GL_UNPACK_PREMULTIPLY_ALPHA_CHROMIUM,
+  GL_UNPACK_ASYNC_CHROMIUM,
 };
 
 static GLint valid_pixel_store_alignment_table[] = {
@@ -282,6 +283,7 @@ static GLenum valid_query_target_table[] = {
   GL_ANY_SAMPLES_PASSED_EXT,
   GL_ANY_SAMPLES_PASSED_CONSERVATIVE_EXT,
   GL_COMMANDS_ISSUED_CHROMIUM,
+  GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM,
 };
 
 static GLenum valid_read_pixel_format_table[] = {
@@ -429,6 +431,7 @@ static GLenum valid_texture_parameter_table[] = {
   GL_TEXTURE_MIN_FILTER,
   GL_TEXTURE_WRAP_S,
   GL_TEXTURE_WRAP_T,
+  GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM,
 };
 
 static GLenum valid_texture_target_table[] = {
@@ -65,6 +65,11 @@ class GPU_EXPORT GpuScheduler
 
   void SetCommandProcessedCallback(const base::Closure& callback);
 
+  // Sets a callback that is run between commands. When it returns true,
+  // PutChanged stops and leaves the remaining commands for its next call, so
+  // that other contexts get a turn on the GPU thread.
+  void SetPreemptionCallback(const base::Callback<bool(void)>& callback);
+
   void DeferToFence(base::Closure task);
 
   // Polls the fences, invoking callbacks that were waiting to be triggered
@@ -122,6 +127,7 @@ class GPU_EXPORT GpuScheduler
 
   base::Closure scheduled_callback_;
   base::Closure command_processed_callback_;
+  base::Callback<bool(void)> preemption_callback_;
 
   DISALLOW_COPY_AND_ASSIGN(GpuScheduler);
 };
@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/bind.h"
 #include "base/message_loop.h"
 #include "gpu/command_buffer/common/command_buffer_mock.h"
 #include "gpu/command_buffer/service/gpu_scheduler.h"
@@ -33,6 +34,7 @@ class GpuSchedulerTest : public testing::Test {
   static const int32 kTransferBufferId = 123;
 
   virtual void SetUp() {
+    preempt_ = false;
     shared_memory_.reset(new ::base::SharedMemory);
     shared_memory_->CreateAndMapAnonymous(kRingBufferSize);
     buffer_ = static_cast<int32*>(shared_memory_->memory());
@@ -67,6 +69,10 @@ class GpuSchedulerTest : public testing::Test {
     return command_buffer_->GetState().error;
   }
 
+  bool Preempt() {
+    return preempt_;
+  }
+
 #if defined(OS_MACOSX)
   base::mac::ScopedNSAutoreleasePool autorelease_pool_;
 #endif
@@ -77,6 +83,7 @@ class GpuSchedulerTest : public testing::Test {
   int32* buffer_;
   scoped_ptr<gles2::MockGLES2Decoder> decoder_;
   scoped_ptr<GpuScheduler> scheduler_;
+  bool preempt_;
 };
 
 TEST_F(GpuSchedulerTest, SchedulerDoesNothingIfRingBufferIsEmpty) {
@@ -157,6 +164,39 @@ TEST_F(GpuSchedulerTest, ProcessesTwoCommands) {
   scheduler_->PutChanged();
 }
 
+TEST_F(GpuSchedulerTest, StopsWhenPreempted) {
+  CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
+  header[0].command = 7;
+  header[0].size = 2;
+  buffer_[1] = 123;
+  header[2].command = 8;
+  header[2].size = 1;
+
+  CommandBuffer::State state;
+
+  state.put_offset = 3;
+  EXPECT_CALL(*command_buffer_, GetState())
+    .WillRepeatedly(Return(state));
+
+  scheduler_->SetPreemptionCallback(
+      base::Bind(&GpuSchedulerTest::Preempt, base::Unretained(this)));
+
+  EXPECT_CALL(*decoder_, DoCommand(7, 1, &buffer_[0]))
+    .WillOnce(Return(error::kNoError));
+  EXPECT_CALL(*command_buffer_, SetGetOffset(2));
+  preempt_ = true;
+  scheduler_->PutChanged();
+  EXPECT_EQ(2, scheduler_->GetGetOffset());
+
+  // The next call picks up where the preempted one stopped.
+  EXPECT_CALL(*decoder_, DoCommand(8, 0, &buffer_[2]))
+    .WillOnce(Return(error::kNoError));
+  EXPECT_CALL(*command_buffer_, SetGetOffset(3));
+  preempt_ = false;
+  scheduler_->PutChanged();
+  EXPECT_EQ(3, scheduler_->GetGetOffset());
+}
+
 TEST_F(GpuSchedulerTest, SetsErrorCodeOnCommandBuffer) {
   CommandHeader* header = reinterpret_cast<CommandHeader*>(&buffer_[0]);
   header[0].command = 7;
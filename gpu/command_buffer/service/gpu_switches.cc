@@ -22,12 +22,18 @@ const char kEnableGPUDebugging[]            = "enable-gpu-debugging";
 // Enforce GL minimums.
 const char kEnforceGLMinimums[]             = "enforce-gl-minimums";
 
+// Records the command buffers of the GPU process, and the contents of their
+// transfer buffers, to files in the given directory. They can be played back
+// with the command_buffer_replay tool.
+const char kRecordGPUCommandBuffers[]       = "record-gpu-command-buffers";
+
 const char* kGpuSwitches[] = {
   kCompileShaderAlwaysSucceeds,
   kDisableGLSLTranslator,
   kEnableGPUCommandLogging,
   kEnableGPUDebugging,
   kEnforceGLMinimums,
+  kRecordGPUCommandBuffers,
 };
 
 const int kNumGpuSwitches = arraysize(kGpuSwitches);
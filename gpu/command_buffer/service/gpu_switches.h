@@ -17,6 +17,7 @@ GPU_EXPORT extern const char kDisableGLSLTranslator[];
 GPU_EXPORT extern const char kEnableGPUCommandLogging[];
 GPU_EXPORT extern const char kEnableGPUDebugging[];
 GPU_EXPORT extern const char kEnforceGLMinimums[];
+GPU_EXPORT extern const char kRecordGPUCommandBuffers[];
 
 GPU_EXPORT extern const char* kGpuSwitches[];
 GPU_EXPORT extern const int kNumGpuSwitches;
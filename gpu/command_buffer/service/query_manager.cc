@@ -8,6 +8,7 @@
 #include "base/time.h"
 #include "gpu/command_buffer/common/gles2_cmd_format.h"
 #include "gpu/command_buffer/service/common_decoder.h"
+#include "ui/gfx/gl/gl_fence.h"
 
 namespace gpu {
 namespace gles2 {
@@ -115,6 +116,62 @@ void CommandsIssuedQuery::Destroy(bool /* have_context */) {
   }
 }
 
+class AsyncPixelTransfersCompletedQuery : public QueryManager::Query {
+ public:
+  AsyncPixelTransfersCompletedQuery(
+      QueryManager* manager, GLenum target, int32 shm_id, uint32 shm_offset);
+  virtual ~AsyncPixelTransfersCompletedQuery();
+
+  virtual bool Begin() OVERRIDE;
+  virtual bool End(uint32 submit_count) OVERRIDE;
+  virtual bool Process() OVERRIDE;
+  virtual void Destroy(bool have_context) OVERRIDE;
+
+ private:
+  // Passed once the GPU has done the transfers issued before End.
+  scoped_ptr<gfx::GLFence> fence_;
+};
+
+AsyncPixelTransfersCompletedQuery::AsyncPixelTransfersCompletedQuery(
+    QueryManager* manager, GLenum target, int32 shm_id, uint32 shm_offset)
+    : Query(manager, target, shm_id, shm_offset) {
+}
+
+AsyncPixelTransfersCompletedQuery::~AsyncPixelTransfersCompletedQuery() {
+}
+
+bool AsyncPixelTransfersCompletedQuery::Begin() {
+  return true;
+}
+
+bool AsyncPixelTransfersCompletedQuery::End(uint32 submit_count) {
+  fence_.reset(gfx::GLFence::Create());
+  if (!fence_.get()) {
+    // Without fences there is no telling when the GPU is done, so the
+    // transfers count as complete once they are issued.
+    MarkAsPending(submit_count);
+    return MarkAsCompleted(1);
+  }
+  return AddToPendingQueue(submit_count);
+}
+
+bool AsyncPixelTransfersCompletedQuery::Process() {
+  if (!fence_->HasCompleted())
+    return true;
+  fence_.reset();
+  return MarkAsCompleted(1);
+}
+
+void AsyncPixelTransfersCompletedQuery::Destroy(bool have_context) {
+  // The fence can only be deleted with its context current.
+  if (!have_context)
+    ignore_result(fence_.release());
+  fence_.reset();
+  if (!IsDeleted()) {
+    MarkAsDeleted();
+  }
+}
+
 QueryManager::QueryManager(
     CommonDecoder* decoder,
     bool use_arb_occlusion_query2_for_occlusion_query_boolean)
@@ -148,6 +205,10 @@ QueryManager::Query* QueryManager::CreateQuery(
     case GL_COMMANDS_ISSUED_CHROMIUM:
       query = new CommandsIssuedQuery(this, target, shm_id, shm_offset);
       break;
+    case GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM:
+      query = new AsyncPixelTransfersCompletedQuery(
+          this, target, shm_id, shm_offset);
+      break;
     default: {
       GLuint service_id = 0;
       glGenQueriesARB(1, &service_id);
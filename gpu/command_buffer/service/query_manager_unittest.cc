@@ -462,6 +462,28 @@ TEST_F(QueryManagerTest, ExitWithPendingQuery) {
   QueueQuery(query.get(), kService1Id, kSubmitCount);
 }
 
+TEST_F(QueryManagerTest, AsyncPixelTransfersCompletedWithoutFences) {
+  const GLuint kClient1Id = 1;
+  const GLenum kTarget = GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM;
+  const uint32 kSubmitCount = 123;
+
+  // The GL in these tests has no fences, so the query completes as soon as it
+  // ends, without touching GL.
+  QueryManager::Query* query = manager_->CreateQuery(
+      kTarget, kClient1Id, kSharedMemoryId, kSharedMemoryOffset);
+  ASSERT_TRUE(query != NULL);
+  EXPECT_TRUE(manager_->BeginQuery(query));
+  EXPECT_TRUE(manager_->EndQuery(query, kSubmitCount));
+  EXPECT_FALSE(query->pending());
+  EXPECT_FALSE(manager_->HavePendingQueries());
+
+  QuerySync* sync = decoder_->GetSharedMemoryAs<QuerySync*>(
+      kSharedMemoryId, kSharedMemoryOffset, sizeof(*sync));
+  ASSERT_TRUE(sync != NULL);
+  EXPECT_EQ(kSubmitCount, sync->process_count);
+  EXPECT_EQ(1u, sync->result);
+}
+
 TEST_F(QueryManagerTest, ARBOcclusionQuery2) {
   const GLuint kClient1Id = 1;
   const GLuint kService1Id = 11;
@@ -8,6 +8,7 @@
 
 #include "base/at_exit.h"
 #include "base/logging.h"
+#include "base/sha1.h"
 
 namespace {
 void FinalizeShaderTranslator(void* /* dummy */) {
@@ -71,15 +72,50 @@ void GetVariableInfo(ShHandle compiler, ShShaderInfo var_type,
     (*var_map)[mapped_name.get()] = info;
   }
 }
+
+// Copies |str| into |array|, leaving |array| NULL if |str| is empty.
+void CopyToArray(const std::string& str, scoped_array<char>* array) {
+  if (str.empty()) {
+    array->reset();
+    return;
+  }
+  array->reset(new char[str.size() + 1]);
+  memcpy(array->get(), str.c_str(), str.size() + 1);
+}
 }  // namespace
 
 namespace gpu {
 namespace gles2 {
 
+ShaderTranslationCache::Entry::Entry()
+    : success(false) {
+}
+
+ShaderTranslationCache::Entry::~Entry() {
+}
+
+ShaderTranslationCache::ShaderTranslationCache()
+    : cache_(kMaxEntries) {
+}
+
+ShaderTranslationCache::~ShaderTranslationCache() {
+}
+
+const ShaderTranslationCache::Entry* ShaderTranslationCache::Get(
+    const std::string& key) {
+  base::MRUCache<std::string, Entry>::iterator it = cache_.Get(key);
+  return it == cache_.end() ? NULL : &it->second;
+}
+
+void ShaderTranslationCache::Put(const std::string& key, const Entry& entry) {
+  cache_.Put(key, entry);
+}
+
 ShaderTranslator::ShaderTranslator()
     : compiler_(NULL),
       implementation_is_glsl_es_(false),
-      needs_built_in_function_emulation_(false) {
+      needs_built_in_function_emulation_(false),
+      cache_(NULL) {
 }
 
 ShaderTranslator::~ShaderTranslator() {
@@ -111,6 +147,15 @@ bool ShaderTranslator::Init(
   implementation_is_glsl_es_ = (glsl_implementation_type == kGlslES);
   needs_built_in_function_emulation_ =
       (glsl_built_in_function_behavior == kGlslBuiltInFunctionEmulated);
+
+  // ShBuiltInResources holds nothing but ints, so its bytes identify it.
+  options_key_.clear();
+  options_key_.push_back(static_cast<char>(shader_type));
+  options_key_.push_back(static_cast<char>(shader_spec));
+  options_key_.push_back(static_cast<char>(shader_output));
+  options_key_.push_back(needs_built_in_function_emulation_);
+  options_key_.append(reinterpret_cast<const char*>(resources),
+                      sizeof(*resources));
   return compiler_ != NULL;
 }
 
@@ -120,6 +165,16 @@ bool ShaderTranslator::Translate(const char* shader) {
   DCHECK(shader != NULL);
   ClearResults();
 
+  std::string cache_key;
+  if (cache_) {
+    cache_key = options_key_ + base::SHA1HashString(shader);
+    const ShaderTranslationCache::Entry* entry = cache_->Get(cache_key);
+    if (entry) {
+      LoadResults(*entry);
+      return entry->success;
+    }
+  }
+
   bool success = false;
   int compile_options =
       SH_OBJECT_CODE | SH_ATTRIBUTES_UNIFORMS | SH_MAP_LONG_VARIABLE_NAMES;
@@ -149,6 +204,12 @@ bool ShaderTranslator::Translate(const char* shader) {
     info_log_.reset();
   }
 
+  if (cache_) {
+    ShaderTranslationCache::Entry entry;
+    SaveResults(success, &entry);
+    cache_->Put(cache_key, entry);
+  }
+
   return success;
 }
 
@@ -177,6 +238,25 @@ void ShaderTranslator::ClearResults() {
   uniform_map_.clear();
 }
 
+void ShaderTranslator::LoadResults(
+    const ShaderTranslationCache::Entry& entry) {
+  CopyToArray(entry.translated_shader, &translated_shader_);
+  CopyToArray(entry.info_log, &info_log_);
+  attrib_map_ = entry.attrib_map;
+  uniform_map_ = entry.uniform_map;
+}
+
+void ShaderTranslator::SaveResults(
+    bool success, ShaderTranslationCache::Entry* entry) const {
+  entry->success = success;
+  if (translated_shader_.get())
+    entry->translated_shader = translated_shader_.get();
+  if (info_log_.get())
+    entry->info_log = info_log_.get();
+  entry->attrib_map = attrib_map_;
+  entry->uniform_map = uniform_map_;
+}
+
 }  // namespace gles2
 }  // namespace gpu
 
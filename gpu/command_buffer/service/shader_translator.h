@@ -9,6 +9,7 @@
 
 #include "base/basictypes.h"
 #include "base/hash_tables.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/scoped_ptr.h"
 #include "gpu/gpu_export.h"
 #include "third_party/angle/include/GLSLANG/ShaderLang.h"
@@ -72,6 +73,44 @@ class ShaderTranslatorInterface {
   virtual const VariableMap& uniform_map() const = 0;
 };
 
+// Remembers the results of recent translations, so that translators that
+// share it translate each shader only once. The translators of the contexts of
+// a ContextGroup share the group's cache.
+class GPU_EXPORT ShaderTranslationCache {
+ public:
+  // The results of translating one shader. Empty strings stand for NULL.
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    bool success;
+    std::string translated_shader;
+    std::string info_log;
+    ShaderTranslatorInterface::VariableMap attrib_map;
+    ShaderTranslatorInterface::VariableMap uniform_map;
+  };
+
+  // The most translations the cache keeps.
+  static const size_t kMaxEntries = 256;
+
+  ShaderTranslationCache();
+  ~ShaderTranslationCache();
+
+  // Returns the results stored for |key|, or NULL if there are none.
+  const Entry* Get(const std::string& key);
+
+  // Stores |entry| for |key|, evicting the least recently used results if the
+  // cache is full.
+  void Put(const std::string& key, const Entry& entry);
+
+  size_t size() const { return cache_.size(); }
+
+ private:
+  base::MRUCache<std::string, Entry> cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShaderTranslationCache);
+};
+
 // Implementation of ShaderTranslatorInterface
 class GPU_EXPORT ShaderTranslator
     : NON_EXPORTED_BASE(public ShaderTranslatorInterface) {
@@ -79,6 +118,12 @@ class GPU_EXPORT ShaderTranslator
   ShaderTranslator();
   virtual ~ShaderTranslator();
 
+  // Makes Translate look shaders up in |cache| first, and store the results
+  // of those it has to translate there. |cache| must outlive this translator.
+  void set_cache(ShaderTranslationCache* cache) {
+    cache_ = cache;
+  }
+
   // Overridden from ShaderTranslatorInterface.
   virtual bool Init(
       ShShaderType shader_type,
@@ -100,6 +145,8 @@ class GPU_EXPORT ShaderTranslator
 
  private:
   void ClearResults();
+  void LoadResults(const ShaderTranslationCache::Entry& entry);
+  void SaveResults(bool success, ShaderTranslationCache::Entry* entry) const;
 
   ShHandle compiler_;
   scoped_array<char> translated_shader_;
@@ -109,6 +156,11 @@ class GPU_EXPORT ShaderTranslator
   bool implementation_is_glsl_es_;
   bool needs_built_in_function_emulation_;
 
+  ShaderTranslationCache* cache_;
+  // Identifies the options passed to Init, which the results of a
+  // translation depend on along with the shader source.
+  std::string options_key_;
+
   DISALLOW_COPY_AND_ASSIGN(ShaderTranslator);
 };
 
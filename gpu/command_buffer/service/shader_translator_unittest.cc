@@ -194,6 +194,53 @@ TEST_F(ShaderTranslatorTest, GetUniforms) {
   EXPECT_EQ("bar[1].foo.color[0]", iter->second.name);
 }
 
+TEST_F(ShaderTranslatorTest, SharedCache) {
+  const char* shader =
+      "attribute vec4 vPosition;\n"
+      "void main() {\n"
+      "  gl_Position = vPosition;\n"
+      "}";
+  const char* bad_shader = "foo-bar";
+
+  ShaderTranslationCache cache;
+  ShBuiltInResources resources;
+  ShInitBuiltInResources(&resources);
+  ShaderTranslator translator;
+  ASSERT_TRUE(translator.Init(
+      SH_VERTEX_SHADER, SH_GLES2_SPEC, &resources,
+      ShaderTranslatorInterface::kGlsl,
+      ShaderTranslatorInterface::kGlslBuiltInFunctionEmulated));
+  translator.set_cache(&cache);
+  vertex_translator_.set_cache(&cache);
+
+  EXPECT_TRUE(vertex_translator_.Translate(shader));
+  EXPECT_EQ(1u, cache.size());
+
+  // A translator with the same options gets the same results from the cache.
+  EXPECT_TRUE(translator.Translate(shader));
+  EXPECT_EQ(1u, cache.size());
+  ASSERT_TRUE(translator.translated_shader() != NULL);
+  EXPECT_STREQ(vertex_translator_.translated_shader(),
+               translator.translated_shader());
+  EXPECT_TRUE(translator.info_log() == NULL);
+  ASSERT_EQ(1u, translator.attrib_map().size());
+  EXPECT_EQ("vPosition", translator.attrib_map().begin()->second.name);
+
+  // Failures are cached too.
+  EXPECT_FALSE(vertex_translator_.Translate(bad_shader));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_FALSE(translator.Translate(bad_shader));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(translator.translated_shader() == NULL);
+  ASSERT_TRUE(translator.info_log() != NULL);
+  EXPECT_STREQ(vertex_translator_.info_log(), translator.info_log());
+
+  // A translator with other options doesn't.
+  fragment_translator_.set_cache(&cache);
+  EXPECT_FALSE(fragment_translator_.Translate(shader));
+  EXPECT_EQ(3u, cache.size());
+}
+
 #if defined(OS_MACOSX)
 TEST_F(ShaderTranslatorTest, BuiltInFunctionEmulation) {
   // This test might become invalid in the future when ANGLE Translator is no
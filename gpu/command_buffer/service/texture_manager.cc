@@ -102,6 +102,8 @@ TextureManager::TextureInfo::TextureInfo(TextureManager* manager,
       wrap_s_(GL_REPEAT),
       wrap_t_(GL_REPEAT),
       usage_(GL_NONE),
+      residency_priority_(0),
+      has_residency_priority_(false),
       max_level_set_(-1),
       texture_complete_(false),
       cube_complete_(false),
@@ -425,6 +427,10 @@ bool TextureManager::TextureInfo::SetParameter(
       }
       usage_ = param;
       break;
+    case GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM:
+      residency_priority_ = param;
+      has_residency_priority_ = true;
+      break;
     default:
       NOTREACHED();
       return false;
@@ -605,6 +611,7 @@ TextureManager::TextureManager(
       texture_info_count_(0),
       mem_represented_(0),
       last_reported_mem_represented_(1),
+      mem_evicted_(0),
       have_context_(true) {
   for (int ii = 0; ii < kNumDefaultTextures; ++ii) {
     black_texture_ids_[ii] = 0;
@@ -928,6 +935,61 @@ bool TextureManager::Restore(TextureInfo* info,
   return true;
 }
 
+void TextureManager::AppendEvictableTextures(
+    std::vector<GLuint>* client_ids) {
+  for (TextureInfoMap::iterator it = texture_infos_.begin();
+       it != texture_infos_.end(); ++it) {
+    TextureInfo* info = it->second;
+    if (info->owned_ && info->has_residency_priority() &&
+        info->estimated_size() > 0 && !info->IsImmutable() && !info->IsStreamTexture() &&
+        !info->IsAttachedToFramebuffer()) {
+      client_ids->push_back(it->first);
+    }
+  }
+}
+
+bool TextureManager::EvictTexture(TextureInfo* info) {
+  DCHECK(info->owned_);
+
+  if (!info->has_residency_priority() || info->IsAttachedToFramebuffer() ||
+      info->IsImmutable() || info->IsStreamTexture())
+    return false;
+
+  uint32 size = info->estimated_size();
+  for (size_t face = 0; face < info->level_infos_.size(); ++face) {
+    GLenum target = info->target() == GL_TEXTURE_CUBE_MAP ?
+        FaceIndexToGLTarget(face) : info->target();
+    for (size_t level = 0; level < info->level_infos_[face].size(); ++level) {
+      const TextureInfo::LevelInfo& level_info =
+          info->level_infos_[face][level];
+      if (level_info.target == 0)
+        continue;
+      SetLevelInfo(info,
+                   target,
+                   level,
+                   level_info.internal_format,
+                   0,
+                   0,
+                   0,
+                   0,
+                   level_info.format,
+                   level_info.type,
+                   true);
+    }
+  }
+
+  GLuint old_service_id = info->service_id();
+  glDeleteTextures(1, &old_service_id);
+  GLuint new_service_id = 0;
+  glGenTextures(1, &new_service_id);
+  info->SetServiceId(new_service_id);
+
+  mem_evicted_ += size;
+  TRACE_COUNTER_ID1("TextureManager", "EvictedTextureMemory", this,
+                    mem_evicted_);
+  return true;
+}
+
 bool TextureManager::SetParameter(
     TextureManager::TextureInfo* info, GLenum pname, GLint param) {
   DCHECK(info);
@@ -63,6 +63,19 @@ class GPU_EXPORT TextureManager {
       return usage_;
     }
 
+    // Set by the client through GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM.
+    // Textures with lower priorities are evicted first when the GPU process
+    // is over its memory budget.
+    GLint residency_priority() const {
+      return residency_priority_;
+    }
+
+    // Only textures the client gave a residency priority can be evicted,
+    // since the client has to be ready to redefine them.
+    bool has_residency_priority() const {
+      return has_residency_priority_;
+    }
+
     int num_uncleared_mips() const {
       return num_uncleared_mips_;
     }
@@ -315,6 +328,8 @@ class GPU_EXPORT TextureManager {
     GLenum wrap_s_;
     GLenum wrap_t_;
     GLenum usage_;
+    GLint residency_priority_;
+    bool has_residency_priority_;
 
     // The maximum level that has been set.
     GLint max_level_set_;
@@ -434,6 +449,17 @@ class GPU_EXPORT TextureManager {
   bool Restore(TextureInfo* info,
                TextureDefinition* definition);
 
+  // Appends the client ids of the textures that may be evicted to
+  // |client_ids|: those that have a residency priority, take memory and are
+  // owned, mutable and neither stream textures nor attached to a framebuffer.
+  void AppendEvictableTextures(std::vector<GLuint>* client_ids);
+
+  // Frees the memory of a texture by moving it to a new, empty service id and
+  // leaving all its levels defined as 0x0, so that it renders black until the
+  // client defines them again. The caller must rebind the texture and apply
+  // its parameters. Returns false if the texture can't be evicted.
+  bool EvictTexture(TextureInfo* info);
+
   // Sets a mip as cleared.
   void SetLevelCleared(TextureInfo* info, GLenum target, GLint level);
 
@@ -493,6 +519,10 @@ class GPU_EXPORT TextureManager {
     return num_uncleared_mips_ > 0;
   }
 
+  uint32 mem_represented() const {
+    return mem_represented_;
+  }
+
   GLuint black_texture_id(GLenum target) const {
     switch (target) {
       case GL_SAMPLER_2D:
@@ -542,6 +572,9 @@ class GPU_EXPORT TextureManager {
   uint32 mem_represented_;
   uint32 last_reported_mem_represented_;
 
+  // Total size of the textures evicted so far, for tracing.
+  uint32 mem_evicted_;
+
   bool have_context_;
 
   // Black (0,0,0,1) textures for when non-renderable textures are used.
@@ -13,6 +13,7 @@
 
 using ::testing::Pointee;
 using ::testing::Return;
+using ::testing::SetArgumentPointee;
 using ::testing::_;
 
 namespace gpu {
@@ -958,6 +959,73 @@ TEST_F(TextureInfoTest, UseDeletedTexture) {
   info = NULL;
 }
 
+TEST_F(TextureInfoTest, ResidencyPriority) {
+  EXPECT_EQ(0, info_->residency_priority());
+  EXPECT_FALSE(info_->has_residency_priority());
+  EXPECT_TRUE(manager_.SetParameter(
+      info_, GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM, -2));
+  EXPECT_EQ(-2, info_->residency_priority());
+  EXPECT_TRUE(info_->has_residency_priority());
+}
+
+TEST_F(TextureInfoTest, Evict) {
+  static const GLuint kNewServiceId = 12;
+  std::vector<GLuint> client_ids;
+  manager_.AppendEvictableTextures(&client_ids);
+  EXPECT_TRUE(client_ids.empty());
+
+  manager_.SetInfoTarget(info_, GL_TEXTURE_2D);
+  manager_.SetLevelInfo(info_,
+      GL_TEXTURE_2D, 0, GL_RGBA, 4, 4, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, true);
+  manager_.SetLevelInfo(info_,
+      GL_TEXTURE_2D, 1, GL_RGBA, 2, 2, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, true);
+  EXPECT_TRUE(manager_.CanRender(info_));
+  EXPECT_EQ(info_->estimated_size(), manager_.mem_represented());
+
+  // Textures without a residency priority can't be evicted.
+  manager_.AppendEvictableTextures(&client_ids);
+  EXPECT_TRUE(client_ids.empty());
+  EXPECT_FALSE(manager_.EvictTexture(info_));
+  EXPECT_TRUE(manager_.SetParameter(
+      info_, GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM, 0));
+
+  // Textures attached to a framebuffer can't be evicted.
+  info_->AttachToFramebuffer();
+  manager_.AppendEvictableTextures(&client_ids);
+  EXPECT_TRUE(client_ids.empty());
+  EXPECT_FALSE(manager_.EvictTexture(info_));
+  info_->DetachFromFramebuffer();
+
+  manager_.AppendEvictableTextures(&client_ids);
+  ASSERT_EQ(1u, client_ids.size());
+  EXPECT_EQ(kClient1Id, client_ids[0]);
+
+  EXPECT_CALL(*gl_, DeleteTextures(1, Pointee(kService1Id)))
+      .Times(1)
+      .RetiresOnSaturation();
+  EXPECT_CALL(*gl_, GenTextures(1, _))
+      .WillOnce(SetArgumentPointee<1>(kNewServiceId))
+      .RetiresOnSaturation();
+  EXPECT_TRUE(manager_.EvictTexture(info_));
+  EXPECT_EQ(kNewServiceId, info_->service_id());
+  EXPECT_EQ(0u, info_->estimated_size());
+  EXPECT_EQ(0u, manager_.mem_represented());
+  EXPECT_FALSE(manager_.CanRender(info_));
+  GLsizei width = -1;
+  GLsizei height = -1;
+  EXPECT_TRUE(info_->GetLevelSize(GL_TEXTURE_2D, 0, &width, &height));
+  EXPECT_EQ(0, width);
+  EXPECT_EQ(0, height);
+  GLuint client_id = 0;
+  EXPECT_TRUE(manager_.GetClientId(kNewServiceId, &client_id));
+  EXPECT_EQ(kClient1Id, client_id);
+
+  // The texture can be defined again.
+  manager_.SetLevelInfo(info_,
+      GL_TEXTURE_2D, 0, GL_RGBA, 4, 4, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, true);
+  EXPECT_EQ(4u * 4u * 4u, info_->estimated_size());
+}
+
 }  // namespace gles2
 }  // namespace gpu
 
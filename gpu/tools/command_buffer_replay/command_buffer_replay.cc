@@ -0,0 +1,224 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This tool plays back a command buffer recorded by a GPU process run with
+// --record-gpu-command-buffers=DIR against the GLES2 decoder, and reports how
+// long each kind of command took. Use --use-gl=osmesa to play it back on
+// OSMesa instead of the system GL.
+//
+// With --finish-each-command, glFinish() is called after each command and the
+// time it takes is reported as GL time, apart from the decode time.
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/string_number_conversions.h"
+#include "base/string_split.h"
+#include "base/time.h"
+#include "gpu/command_buffer/service/cmd_parser.h"
+#include "gpu/command_buffer/service/command_buffer_recorder.h"
+#include "gpu/command_buffer/service/command_buffer_service.h"
+#include "gpu/command_buffer/service/context_group.h"
+#include "gpu/command_buffer/service/gles2_cmd_decoder.h"
+#include "gpu/command_buffer/service/gpu_scheduler.h"
+#include "gpu/command_buffer/service/mailbox_manager.h"
+#include "ui/gfx/gl/gl_bindings.h"
+#include "ui/gfx/gl/gl_context.h"
+#include "ui/gfx/gl/gl_surface.h"
+#include "ui/gfx/size.h"
+
+using base::TimeDelta;
+using base::TimeTicks;
+
+namespace {
+
+const char kFinishEachCommand[] = "finish-each-command";
+const char kSize[] = "size";
+
+// Times the commands it passes on to the decoder, by command.
+class TimingHandler : public gpu::AsyncAPIInterface {
+ public:
+  struct CommandStats {
+    CommandStats() : count(0) {}
+
+    int count;
+    TimeDelta decode_time;
+    TimeDelta gl_time;
+  };
+  typedef std::map<unsigned int, CommandStats> CommandStatsMap;
+
+  TimingHandler(gpu::AsyncAPIInterface* decoder, bool finish_each_command)
+      : decoder_(decoder),
+        finish_each_command_(finish_each_command) {
+  }
+
+  virtual gpu::error::Error DoCommand(unsigned int command,
+                                      unsigned int arg_count,
+                                      const void* cmd_data) OVERRIDE {
+    TimeTicks start = TimeTicks::HighResNow();
+    gpu::error::Error error = decoder_->DoCommand(command, arg_count, cmd_data);
+    TimeTicks decoded = TimeTicks::HighResNow();
+    CommandStats& stats = stats_[command];
+    stats.count++;
+    stats.decode_time += decoded - start;
+    if (finish_each_command_) {
+      glFinish();
+      stats.gl_time += TimeTicks::HighResNow() - decoded;
+    }
+    return error;
+  }
+
+  virtual const char* GetCommandName(unsigned int command_id) const OVERRIDE {
+    return decoder_->GetCommandName(command_id);
+  }
+
+  const CommandStatsMap& stats() const { return stats_; }
+
+ private:
+  gpu::AsyncAPIInterface* decoder_;
+  bool finish_each_command_;
+  CommandStatsMap stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimingHandler);
+};
+
+bool CompareTotalTime(
+    const TimingHandler::CommandStatsMap::value_type* lhs,
+    const TimingHandler::CommandStatsMap::value_type* rhs) {
+  return lhs->second.decode_time + lhs->second.gl_time >
+         rhs->second.decode_time + rhs->second.gl_time;
+}
+
+void PrintStats(const TimingHandler& handler, int flushes,
+                TimeDelta elapsed) {
+  std::vector<const TimingHandler::CommandStatsMap::value_type*> sorted;
+  for (TimingHandler::CommandStatsMap::const_iterator it =
+           handler.stats().begin();
+       it != handler.stats().end(); ++it) {
+    sorted.push_back(&*it);
+  }
+  std::sort(sorted.begin(), sorted.end(), CompareTotalTime);
+
+  printf("%d flushes played back in %.3f ms\n", flushes,
+         elapsed.InMillisecondsF());
+  printf("%-40s %10s %14s %14s %12s\n",
+         "command", "count", "decode (ms)", "gl (ms)", "avg (us)");
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    const TimingHandler::CommandStats& stats = sorted[i]->second;
+    TimeDelta total = stats.decode_time + stats.gl_time;
+    printf("%-40s %10d %14.3f %14.3f %12.2f\n",
+           handler.GetCommandName(sorted[i]->first),
+           stats.count,
+           stats.decode_time.InMillisecondsF(),
+           stats.gl_time.InMillisecondsF(),
+           total.InMicroseconds() / static_cast<double>(stats.count));
+  }
+}
+
+bool ParseSize(const std::string& value, gfx::Size* size) {
+  std::vector<std::string> parts;
+  base::SplitString(value, 'x', &parts);
+  int width = 0;
+  int height = 0;
+  if (parts.size() != 2 ||
+      !base::StringToInt(parts[0], &width) ||
+      !base::StringToInt(parts[1], &height) ||
+      width <= 0 || height <= 0) {
+    return false;
+  }
+  size->SetSize(width, height);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit_manager;
+  CommandLine::Init(argc, argv);
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  MessageLoop message_loop;
+
+  gfx::Size size(1, 1);
+  if (command_line.GetArgs().size() != 1 ||
+      (command_line.HasSwitch(kSize) &&
+       !ParseSize(command_line.GetSwitchValueASCII(kSize), &size))) {
+    fprintf(stderr,
+            "Usage: %s [--use-gl=osmesa] [--size=WIDTHxHEIGHT] "
+            "[--finish-each-command] RECORDING\n", argv[0]);
+    return 1;
+  }
+  FilePath path(command_line.GetArgs()[0]);
+
+  if (!gfx::GLSurface::InitializeOneOff()) {
+    fprintf(stderr, "Could not initialize GL.\n");
+    return 1;
+  }
+
+  gpu::CommandBufferService command_buffer;
+  scoped_ptr<gpu::gles2::GLES2Decoder> decoder(gpu::gles2::GLES2Decoder::Create(
+      new gpu::gles2::ContextGroup(new gpu::gles2::MailboxManager, true)));
+  TimingHandler handler(decoder.get(),
+                        command_line.HasSwitch(kFinishEachCommand));
+  gpu::GpuScheduler scheduler(&command_buffer, &handler, decoder.get());
+  decoder->set_engine(&scheduler);
+
+  scoped_refptr<gfx::GLSurface> surface(
+      gfx::GLSurface::CreateOffscreenGLSurface(false, size));
+  scoped_refptr<gfx::GLContext> context;
+  if (surface.get()) {
+    context = gfx::GLContext::CreateGLContext(NULL, surface.get(),
+                                              gfx::PreferDiscreteGpu);
+  }
+  std::vector<int32> attribs;
+  if (!context.get() ||
+      !decoder->Initialize(surface, context, true, size,
+                           gpu::gles2::DisallowedFeatures(), "*", attribs)) {
+    fprintf(stderr, "Could not create a GL context.\n");
+    return 1;
+  }
+
+  command_buffer.SetPutOffsetChangeCallback(
+      base::Bind(&gpu::GpuScheduler::PutChanged,
+                 base::Unretained(&scheduler)));
+  command_buffer.SetGetBufferChangeCallback(
+      base::Bind(&gpu::GpuScheduler::SetGetBuffer,
+                 base::Unretained(&scheduler)));
+
+  gpu::CommandBufferPlayer player(&command_buffer);
+  if (!player.Initialize(path)) {
+    fprintf(stderr, "Could not read %s.\n", path.value().c_str());
+    return 1;
+  }
+
+  int flushes = 0;
+  TimeTicks start = TimeTicks::HighResNow();
+  while (player.PlayNextFlush())
+    flushes++;
+  glFinish();
+  TimeDelta elapsed = TimeTicks::HighResNow() - start;
+
+  int result = 0;
+  if (player.failed()) {
+    fprintf(stderr, "%s is truncated or corrupt.\n", path.value().c_str());
+    result = 1;
+  } else if (command_buffer.GetState().error != gpu::error::kNoError) {
+    fprintf(stderr, "The decoder failed after %d flushes.\n", flushes);
+    result = 1;
+  }
+  PrintStats(handler, flushes, elapsed);
+
+  decoder->Destroy();
+  return result;
+}
@@ -35,6 +35,7 @@
       'type': '<(gtest_target_type)',
       'dependencies': [
         'ipc',
+        'test_support_ipc',
         '../base/base.gyp:base',
         '../base/base.gyp:base_i18n',
         '../base/base.gyp:test_support_base',
@@ -47,7 +48,9 @@
       'sources': [
         'file_descriptor_set_posix_unittest.cc',
         'ipc_channel_posix_unittest.cc',
+        'ipc_channel_reader_unittest.cc',
         'ipc_fuzzing_tests.cc',
+        'ipc_message_stats_unittest.cc',
         'ipc_message_unittest.cc',
         'ipc_send_fds_test.cc',
         'ipc_sync_channel_unittest.cc',
@@ -79,6 +82,24 @@
         }]
       ],
     },
+    {
+      'target_name': 'ipc_perftests',
+      'type': 'executable',
+      'dependencies': [
+        'ipc',
+        'test_support_ipc',
+        '../base/base.gyp:base',
+        '../base/base.gyp:test_support_base',
+        '../base/base.gyp:test_support_perf',
+        '../testing/gtest.gyp:gtest',
+      ],
+      'include_dirs': [
+        '..'
+      ],
+      'sources': [
+        'ipc_perftests.cc',
+      ],
+    },
     {
       'target_name': 'test_support_ipc',
       'type': 'static_library',
@@ -87,6 +108,8 @@
         '../base/base.gyp:base',
       ],
       'sources': [
+        'ipc_test_reflector.cc',
+        'ipc_test_reflector.h',
         'ipc_test_sink.cc',
         'ipc_test_sink.h',
       ],
@@ -10,14 +10,12 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
-#include <sys/un.h>
-
-#if defined(OS_OPENBSD)
 #include <sys/uio.h>
-#endif
+#include <sys/un.h>
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "base/command_line.h"
 #include "base/eintr_wrapper.h"
@@ -292,6 +290,34 @@ bool SocketWriteErrorIsRecoverable() {
 #endif  // OS_MACOSX
 }
 
+// Maximum number of runs of message data handed to one sendmsg() call.
+const int kMaxIOVecsPerWrite = 16;
+
+// Fills |iov| with up to |max_iovs| runs of |msg|'s data, starting |offset|
+// bytes into it, so that large payloads the message references (see
+// Pickle::WriteExternalData) are written without being copied. Returns the
+// number of runs and sets |*length| to the number of bytes they hold, which
+// is less than the rest of the message if it has more runs than fit.
+int FillIOVecs(const Message& msg, size_t offset, struct iovec* iov,
+               int max_iovs, size_t* length) {
+  std::vector<Pickle::Segment> segments;
+  msg.GetSegments(&segments);
+  int iov_count = 0;
+  *length = 0;
+  for (size_t i = 0; i < segments.size() && iov_count < max_iovs; ++i) {
+    if (offset >= segments[i].length) {
+      offset -= segments[i].length;
+      continue;
+    }
+    iov[iov_count].iov_base = const_cast<char*>(segments[i].data + offset);
+    iov[iov_count].iov_len = segments[i].length - offset;
+    *length += iov[iov_count].iov_len;
+    ++iov_count;
+    offset = 0;
+  }
+  return iov_count;
+}
+
 }  // namespace
 //------------------------------------------------------------------------------
 
@@ -493,15 +519,39 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
   while (!output_queue_.empty()) {
     Message* msg = output_queue_.front();
 
-    size_t amt_to_write = msg->size() - message_send_bytes_written_;
-    DCHECK_NE(0U, amt_to_write);
-    const char* out_bytes = reinterpret_cast<const char*>(msg->data()) +
-        message_send_bytes_written_;
+    size_t amt_left = msg->size() - message_send_bytes_written_;
+    DCHECK_NE(0U, amt_left);
+    struct iovec iov[kMaxIOVecsPerWrite];
+    size_t amt_to_write;
+    int iov_count = FillIOVecs(*msg, message_send_bytes_written_, iov,
+                               kMaxIOVecsPerWrite, &amt_to_write);
+
+    // Messages without descriptors that are queued behind this one go out
+    // in the same write, which saves a system call for each of them when
+    // the channel is busy. Descriptors must arrive with the first byte of
+    // their message, so a message that has some starts a new write.
+    if (message_send_bytes_written_ == 0 && amt_to_write == amt_left &&
+        msg->file_descriptor_set()->empty()) {
+      for (size_t i = 1;
+           i < output_queue_.size() && iov_count < kMaxIOVecsPerWrite;
+           ++i) {
+        const Message* next = output_queue_[i];
+        if (!next->file_descriptor_set()->empty())
+          break;
+        size_t next_length;
+        int next_iov_count = FillIOVecs(*next, 0, iov + iov_count,
+                                        kMaxIOVecsPerWrite - iov_count,
+                                        &next_length);
+        if (next_length != next->size())
+          break;  // Only whole messages are added.
+        iov_count += next_iov_count;
+        amt_to_write += next_length;
+      }
+    }
 
     struct msghdr msgh = {0};
-    struct iovec iov = {const_cast<char*>(out_bytes), amt_to_write};
-    msgh.msg_iov = &iov;
-    msgh.msg_iovlen = 1;
+    msgh.msg_iov = iov;
+    msgh.msg_iovlen = iov_count;
     char buf[CMSG_SPACE(
         sizeof(int) * FileDescriptorSet::kMaxDescriptorsPerMessage)];
 
@@ -546,9 +596,11 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
         // fd_pipe_ which makes Seccomp sandbox operation more efficient.
         struct iovec fd_pipe_iov = { const_cast<char *>(""), 1 };
         msgh.msg_iov = &fd_pipe_iov;
+        msgh.msg_iovlen = 1;
         fd_written = fd_pipe_;
         bytes_written = HANDLE_EINTR(sendmsg(fd_pipe_, &msgh, MSG_DONTWAIT));
-        msgh.msg_iov = &iov;
+        msgh.msg_iov = iov;
+        msgh.msg_iovlen = iov_count;
         msgh.msg_controllen = 0;
         if (bytes_written > 0) {
           msg->file_descriptor_set()->CommitAll();
@@ -564,7 +616,7 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
         DCHECK_EQ(msg->file_descriptor_set()->size(), 1U);
       }
       if (!msgh.msg_controllen) {
-        bytes_written = HANDLE_EINTR(write(pipe_, out_bytes, amt_to_write));
+        bytes_written = HANDLE_EINTR(writev(pipe_, iov, iov_count));
       } else
 #endif  // IPC_USES_READWRITE
       {
@@ -593,12 +645,25 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
       return false;
     }
 
-    if (static_cast<size_t>(bytes_written) != amt_to_write) {
-      if (bytes_written > 0) {
-        // If write() fails with EAGAIN then bytes_written will be -1.
-        message_send_bytes_written_ += bytes_written;
-      }
+    // Retire the messages that were written in full.
+    size_t bytes_left = bytes_written > 0 ? bytes_written : 0;
+    while (bytes_left > 0 && !output_queue_.empty()) {
+      Message* written = output_queue_.front();
+      size_t message_left = written->size() - message_send_bytes_written_;
+      if (bytes_left < message_left)
+        break;
+      bytes_left -= message_left;
+      message_send_bytes_written_ = 0;
+
+      // Message sent OK!
+      DVLOG(2) << "sent message @" << written << " on channel @" << this
+               << " with type " << written->type() << " on fd " << pipe_;
+      delete written;
+      output_queue_.pop_front();
+    }
+    message_send_bytes_written_ += bytes_left;
 
+    if (static_cast<size_t>(bytes_written) != amt_to_write) {
       // Tell libevent to call us back once things are unblocked.
       is_blocked_on_write_ = true;
       MessageLoopForIO::current()->WatchFileDescriptor(
@@ -608,14 +673,6 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages() {
           &write_watcher_,
           this);
       return true;
-    } else {
-      message_send_bytes_written_ = 0;
-
-      // Message sent OK!
-      DVLOG(2) << "sent message @" << msg << " on channel @" << this
-               << " with type " << msg->type() << " on fd " << pipe_;
-      delete output_queue_.front();
-      output_queue_.pop();
     }
   }
   return true;
@@ -630,7 +687,7 @@ bool Channel::ChannelImpl::Send(Message* message) {
   Logging::GetInstance()->OnSendMessage(message, "");
 #endif  // IPC_MESSAGE_LOG_ENABLED
 
-  output_queue_.push(message);
+  output_queue_.push_back(message);
   if (!is_blocked_on_write_ && !waiting_connect_) {
     return ProcessOutgoingMessages();
   }
@@ -724,7 +781,7 @@ void Channel::ChannelImpl::ResetToAcceptingConnectionState() {
 
   while (!output_queue_.empty()) {
     Message* m = output_queue_.front();
-    output_queue_.pop();
+    output_queue_.pop_front();
     delete m;
   }
 
@@ -821,6 +878,9 @@ void Channel::ChannelImpl::OnFileCanWriteWithoutBlocking(int fd) {
 }
 
 bool Channel::ChannelImpl::AcceptConnection() {
+  // ProcessIncomingMessages() reads until the pipe would block, so the
+  // channel only needs to hear about new data.
+  read_watcher_.set_edge_triggered(true);
   MessageLoopForIO::current()->WatchFileDescriptor(pipe_,
                                                    true,
                                                    MessageLoopForIO::WATCH_READ,
@@ -886,7 +946,7 @@ void Channel::ChannelImpl::QueueHelloMessage() {
     DCHECK_EQ(msg->file_descriptor_set()->size(), 1U);
   }
 #endif  // IPC_USES_READWRITE
-  output_queue_.push(msg.release());
+  output_queue_.push_back(msg.release());
 }
 
 Channel::ChannelImpl::ReadState Channel::ChannelImpl::ReadData(
@@ -10,7 +10,7 @@
 
 #include <sys/socket.h>  // for CMSG macros
 
-#include <queue>
+#include <deque>
 #include <string>
 #include <vector>
 
@@ -154,7 +154,7 @@ class Channel::ChannelImpl : public internal::ChannelReader,
   std::string pipe_name_;
 
   // Messages to be sent are queued here.
-  std::queue<Message*> output_queue_;
+  std::deque<Message*> output_queue_;
 
   // We assume a worst case: kReadBufferSize bytes of messages, where each
   // message has no payload and a full complement of descriptors.
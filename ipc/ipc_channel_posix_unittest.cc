@@ -11,19 +11,27 @@
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <utility>
+#include <vector>
+
 #include "base/basictypes.h"
 #include "base/eintr_wrapper.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
+#include "base/memory/ref_counted_memory.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/test/multiprocess_test.h"
 #include "base/test/test_timeouts.h"
+#include "base/threading/thread.h"
+#include "ipc/ipc_channel_proxy.h"
 #include "testing/multiprocess_func_list.h"
 
 namespace {
 
 static const uint32 kQuitMessage = 47;
+static const uint32 kExternalDataMessage = 48;
 
 class IPCChannelPosixTestListener : public IPC::Channel::Listener {
  public:
@@ -90,6 +98,95 @@ class IPCChannelPosixTestListener : public IPC::Channel::Listener {
   bool quit_only_on_message_;
 };
 
+// Checks that every kExternalDataMessage it receives holds |num_runs| copies
+// of |expected_run|, and quits the run loop after |num_messages| of them.
+class ExternalDataListener : public IPC::Channel::Listener {
+ public:
+  ExternalDataListener(int num_messages,
+                       int num_runs,
+                       const std::string& expected_run)
+      : num_messages_(num_messages),
+        num_runs_(num_runs),
+        expected_run_(expected_run),
+        messages_received_(0) {
+  }
+
+  virtual ~ExternalDataListener() {}
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    EXPECT_EQ(kExternalDataMessage, message.type());
+    PickleIterator iter(message);
+    for (int i = 0; i < num_runs_; ++i) {
+      const char* data;
+      int length;
+      EXPECT_TRUE(iter.ReadData(&data, &length));
+      EXPECT_EQ(expected_run_, std::string(data, length));
+    }
+    if (++messages_received_ == num_messages_)
+      MessageLoopForIO::current()->QuitNow();
+    return true;
+  }
+
+  int messages_received() const { return messages_received_; }
+
+ private:
+  int num_messages_;
+  int num_runs_;
+  std::string expected_run_;
+  int messages_received_;
+};
+
+// Counts the messages that reach a ChannelProxy on its IPC thread, and
+// signals |event| once |num_messages| of them have.
+class CountingFilter : public IPC::ChannelProxy::MessageFilter {
+ public:
+  CountingFilter(int num_messages, base::WaitableEvent* event)
+      : num_messages_(num_messages),
+        event_(event),
+        messages_received_(0) {
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    if (++messages_received_ == num_messages_)
+      event_->Signal();
+    return false;
+  }
+
+ private:
+  virtual ~CountingFilter() {}
+
+  int num_messages_;
+  base::WaitableEvent* event_;
+  int messages_received_;
+};
+
+// Records the type and int payload of the messages it is given, and quits
+// the run loop after |num_messages| of them.
+class RecordingListener : public IPC::Channel::Listener {
+ public:
+  explicit RecordingListener(int num_messages)
+      : num_messages_(num_messages) {
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    int value = 0;
+    PickleIterator iter(message);
+    EXPECT_TRUE(message.ReadInt(&iter, &value));
+    received_.push_back(std::make_pair(message.type(), value));
+    if (received_.size() == static_cast<size_t>(num_messages_))
+      MessageLoopForIO::current()->QuitNow();
+    return true;
+  }
+
+  const std::vector<std::pair<uint32, int> >& received() const {
+    return received_;
+  }
+
+ private:
+  int num_messages_;
+  std::vector<std::pair<uint32, int> > received_;
+};
+
 }  // namespace
 
 class IPCChannelPosixTest : public base::MultiProcessTest {
@@ -225,6 +322,155 @@ TEST_F(IPCChannelPosixTest, BasicConnected) {
   ASSERT_FALSE(channel2.AcceptsConnections());
 }
 
+// Test that messages referencing external data arrive intact, including ones
+// made of more runs than one write takes, and ones that block on a full
+// socket buffer midway.
+TEST_F(IPCChannelPosixTest, ExternalData) {
+  const int kNumMessages = 3;
+  const int kNumRuns = 20;
+  // Unaligned, so that every run is followed by padding.
+  std::string run(64 * 1024 + 1, 'x');
+  run[0] = 'a';
+  run[run.size() - 1] = 'z';
+  std::string run_copy(run);
+  scoped_refptr<base::RefCountedMemory> data(
+      base::RefCountedString::TakeString(&run_copy));
+
+  int pipe_fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pipe_fds));
+  std::string socket_name("/var/tmp/IPCChannelPosixTest_ExternalData");
+  ASSERT_GE(fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK), 0);
+  ASSERT_GE(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK), 0);
+  IPCChannelPosixTestListener server_listener(true);
+  ExternalDataListener client_listener(kNumMessages, kNumRuns, run);
+  IPC::Channel server(IPC::ChannelHandle(socket_name,
+                                         base::FileDescriptor(pipe_fds[0],
+                                                              true)),
+                      IPC::Channel::MODE_SERVER, &server_listener);
+  IPC::Channel client(IPC::ChannelHandle(socket_name,
+                                         base::FileDescriptor(pipe_fds[1],
+                                                              true)),
+                      IPC::Channel::MODE_CLIENT, &client_listener);
+  ASSERT_TRUE(server.Connect());
+  ASSERT_TRUE(client.Connect());
+
+  for (int i = 0; i < kNumMessages; ++i) {
+    IPC::Message* message = new IPC::Message(
+        0, kExternalDataMessage, IPC::Message::PRIORITY_NORMAL);
+    for (int j = 0; j < kNumRuns; ++j)
+      ASSERT_TRUE(message->WriteExternalData(data));
+    ASSERT_TRUE(server.Send(message));
+  }
+  SpinRunLoop(TestTimeouts::action_max_timeout_ms());
+  EXPECT_EQ(kNumMessages, client_listener.messages_received());
+}
+
+// Test that a burst of small messages, which are written several at a time,
+// arrives whole and in full even when the socket buffer fills up midway.
+TEST_F(IPCChannelPosixTest, ManySmallMessages) {
+  const int kNumMessages = 2000;
+  std::string run(1000, 'x');
+  run[0] = 'a';
+  std::string run_copy(run);
+  scoped_refptr<base::RefCountedMemory> data(
+      base::RefCountedString::TakeString(&run_copy));
+
+  int pipe_fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pipe_fds));
+  std::string socket_name("/var/tmp/IPCChannelPosixTest_ManySmallMessages");
+  ASSERT_GE(fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK), 0);
+  ASSERT_GE(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK), 0);
+  IPCChannelPosixTestListener server_listener(true);
+  ExternalDataListener client_listener(kNumMessages, 1, run);
+  IPC::Channel server(IPC::ChannelHandle(socket_name,
+                                         base::FileDescriptor(pipe_fds[0],
+                                                              true)),
+                      IPC::Channel::MODE_SERVER, &server_listener);
+  IPC::Channel client(IPC::ChannelHandle(socket_name,
+                                         base::FileDescriptor(pipe_fds[1],
+                                                              true)),
+                      IPC::Channel::MODE_CLIENT, &client_listener);
+  ASSERT_TRUE(server.Connect());
+  ASSERT_TRUE(client.Connect());
+
+  for (int i = 0; i < kNumMessages; ++i) {
+    IPC::Message* message = new IPC::Message(
+        0, kExternalDataMessage, IPC::Message::PRIORITY_NORMAL);
+    ASSERT_TRUE(message->WriteExternalData(data));
+    ASSERT_TRUE(server.Send(message));
+  }
+  SpinRunLoop(TestTimeouts::action_max_timeout_ms());
+  EXPECT_EQ(kNumMessages, client_listener.messages_received());
+}
+
+// Test that a ChannelProxy dispatches waiting messages by priority and
+// drops superseded ones of coalesced types. Messages with an out of range
+// priority are dispatched as normal ones.
+TEST_F(IPCChannelPosixTest, ProxyDispatchOrder) {
+  const uint32 kNormalMessage = 60;
+  const uint32 kLowMessage = 61;
+  const uint32 kMouseMoveMessage = 62;
+  const uint32 kHighMessage = 63;
+  const uint32 kBadPriorityMessage = 64;
+
+  int pipe_fds[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pipe_fds));
+  std::string socket_name("/var/tmp/IPCChannelPosixTest_ProxyDispatchOrder");
+  ASSERT_GE(fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK), 0);
+  ASSERT_GE(fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK), 0);
+
+  base::Thread ipc_thread("ipc");
+  ASSERT_TRUE(ipc_thread.StartWithOptions(
+      base::Thread::Options(MessageLoop::TYPE_IO, 0)));
+  base::WaitableEvent all_received(false, false);
+  RecordingListener proxy_listener(5);
+  IPC::ChannelProxy proxy(&proxy_listener,
+                          ipc_thread.message_loop_proxy());
+  proxy.AddFilter(new CountingFilter(6, &all_received));
+  proxy.SetDispatchPriority(kLowMessage, IPC::Message::PRIORITY_LOW);
+  proxy.SetCoalesced(kMouseMoveMessage);
+  proxy.Init(IPC::ChannelHandle(socket_name,
+                                base::FileDescriptor(pipe_fds[0], true)),
+             IPC::Channel::MODE_SERVER, true);
+
+  IPCChannelPosixTestListener client_listener(true);
+  IPC::Channel client(IPC::ChannelHandle(socket_name,
+                                         base::FileDescriptor(pipe_fds[1],
+                                                              true)),
+                      IPC::Channel::MODE_CLIENT, &client_listener);
+  ASSERT_TRUE(client.Connect());
+
+  const uint32 kTypes[] = {
+    kNormalMessage, kMouseMoveMessage, kLowMessage, kMouseMoveMessage,
+    kHighMessage, kBadPriorityMessage
+  };
+  for (size_t i = 0; i < arraysize(kTypes); ++i) {
+    IPC::Message::PriorityValue priority = IPC::Message::PRIORITY_NORMAL;
+    if (kTypes[i] == kHighMessage)
+      priority = IPC::Message::PRIORITY_HIGH;
+    else if (kTypes[i] == kBadPriorityMessage)
+      priority = static_cast<IPC::Message::PriorityValue>(0);
+    IPC::Message* message = new IPC::Message(0, kTypes[i], priority);
+    message->WriteInt(static_cast<int>(i));
+    ASSERT_TRUE(client.Send(message));
+  }
+
+  // Let all the messages wait on the listener thread before any of them is
+  // dispatched.
+  all_received.Wait();
+  SpinRunLoop(TestTimeouts::action_max_timeout_ms());
+
+  const std::vector<std::pair<uint32, int> >& received =
+      proxy_listener.received();
+  ASSERT_EQ(5U, received.size());
+  EXPECT_EQ(std::make_pair(kHighMessage, 4), received[0]);
+  EXPECT_EQ(std::make_pair(kNormalMessage, 0), received[1]);
+  EXPECT_EQ(std::make_pair(kMouseMoveMessage, 3), received[2]);
+  EXPECT_EQ(std::make_pair(kBadPriorityMessage, 5), received[3]);
+  EXPECT_EQ(std::make_pair(kLowMessage, 2), received[4]);
+  proxy.Close();
+}
+
 TEST_F(IPCChannelPosixTest, AdvancedConnected) {
   // Test creating a connection to an external process.
   IPCChannelPosixTestListener listener(false);
@@ -8,8 +8,11 @@
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/stl_util.h"
+#include "base/time.h"
 #include "ipc/ipc_channel_proxy.h"
 #include "ipc/ipc_logging.h"
+#include "ipc/ipc_message_stats.h"
 #include "ipc/ipc_message_utils.h"
 
 namespace IPC {
@@ -50,6 +53,9 @@ ChannelProxy::Context::Context(Channel::Listener* listener,
 }
 
 ChannelProxy::Context::~Context() {
+  STLDeleteElements(&incoming_messages_);
+  for (size_t i = 0; i < arraysize(dispatch_queues_); ++i)
+    STLDeleteElements(&dispatch_queues_[i]);
 }
 
 void ChannelProxy::Context::CreateChannel(const IPC::ChannelHandle& handle,
@@ -92,8 +98,16 @@ bool ChannelProxy::Context::OnMessageReceivedNoFilter(const Message& message) {
   // this thread is active.  That should be a reasonable assumption, but it
   // feels risky.  We may want to invent some more indirect way of referring to
   // a MessageLoop if this becomes a problem.
-  listener_message_loop_->PostTask(
-      FROM_HERE, base::Bind(&Context::OnDispatchMessage, this, message));
+  bool post_task;
+  {
+    base::AutoLock auto_lock(incoming_messages_lock_);
+    post_task = incoming_messages_.empty();
+    incoming_messages_.push_back(new Message(message));
+  }
+  if (post_task) {
+    listener_message_loop_->PostTask(
+        FROM_HERE, base::Bind(&Context::OnDispatchMessages, this));
+  }
   return true;
 }
 
@@ -216,6 +230,58 @@ void ChannelProxy::Context::AddFilter(MessageFilter* filter) {
       FROM_HERE, base::Bind(&Context::OnAddFilter, this));
 }
 
+// Called on the listener's thread
+void ChannelProxy::Context::OnDispatchMessages() {
+  std::vector<Message*> messages;
+  {
+    base::AutoLock auto_lock(incoming_messages_lock_);
+    messages.swap(incoming_messages_);
+  }
+  for (size_t i = 0; i < messages.size(); ++i)
+    QueueForDispatch(messages[i]);
+
+  while (true) {
+    std::deque<Message*>* queue = NULL;
+    for (int i = Message::PRIORITY_HIGH; i >= 0 && !queue; --i) {
+      if (!dispatch_queues_[i].empty())
+        queue = &dispatch_queues_[i];
+    }
+    if (!queue)
+      return;
+
+    scoped_ptr<Message> message(queue->front());
+    queue->pop_front();
+    OnDispatchMessage(*message);
+  }
+}
+
+// Called on the listener's thread
+void ChannelProxy::Context::QueueForDispatch(Message* message) {
+  int priority = message->priority();
+  std::map<uint32, Message::PriorityValue>::const_iterator it =
+      dispatch_priorities_.find(message->type());
+  if (it != dispatch_priorities_.end())
+    priority = it->second;
+  // The priority bits come from the sender; treat values outside the known
+  // range as normal.
+  if (priority < Message::PRIORITY_LOW || priority > Message::PRIORITY_HIGH)
+    priority = Message::PRIORITY_NORMAL;
+  std::deque<Message*>& queue = dispatch_queues_[priority];
+
+  if (coalesced_types_.count(message->type())) {
+    for (std::deque<Message*>::iterator i = queue.begin(); i != queue.end();
+         ++i) {
+      if ((*i)->type() == message->type() &&
+          (*i)->routing_id() == message->routing_id()) {
+        delete *i;
+        queue.erase(i);
+        break;
+      }
+    }
+  }
+  queue.push_back(message);
+}
+
 // Called on the listener's thread
 void ChannelProxy::Context::OnDispatchMessage(const Message& message) {
 #ifdef IPC_MESSAGE_LOG_ENABLED
@@ -244,7 +310,14 @@ void ChannelProxy::Context::OnDispatchMessage(const Message& message) {
     logger->OnPreDispatchMessage(message);
 #endif
 
-  listener_->OnMessageReceived(message);
+  if (MessageStats::IsEnabled()) {
+    base::TimeTicks start = base::TimeTicks::Now();
+    listener_->OnMessageReceived(message);
+    MessageStats::GetInstance()->RecordDispatched(
+        message.type(), base::TimeTicks::Now() - start);
+  } else {
+    listener_->OnMessageReceived(message);
+  }
 
 #ifdef IPC_MESSAGE_LOG_ENABLED
   if (logger->Enabled())
@@ -361,6 +434,15 @@ void ChannelProxy::RemoveFilter(MessageFilter* filter) {
                             make_scoped_refptr(filter)));
 }
 
+void ChannelProxy::SetDispatchPriority(uint32 type,
+                                       Message::PriorityValue priority) {
+  context_->dispatch_priorities_[type] = priority;
+}
+
+void ChannelProxy::SetCoalesced(uint32 type) {
+  context_->coalesced_types_.insert(type);
+}
+
 void ChannelProxy::ClearIPCMessageLoop() {
   context()->ClearIPCMessageLoop();
 }
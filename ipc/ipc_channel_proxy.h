@@ -6,6 +6,9 @@
 #define IPC_IPC_CHANNEL_PROXY_H_
 #pragma once
 
+#include <deque>
+#include <map>
+#include <set>
 #include <vector>
 
 #include "base/memory/ref_counted.h"
@@ -168,6 +171,20 @@ class IPC_EXPORT ChannelProxy : public Message::Sender {
   void AddFilter(MessageFilter* filter);
   void RemoveFilter(MessageFilter* filter);
 
+  // Messages that wait to be dispatched on the listener thread are taken in
+  // order of priority, and in the order they arrived within a priority. A
+  // message's priority is the one it was created with, unless it was changed
+  // for its type here. Only messages that need not stay in order with others
+  // should be given a priority other than PRIORITY_NORMAL. Must be called on
+  // the listener thread.
+  void SetDispatchPriority(uint32 type, Message::PriorityValue priority);
+
+  // Makes a message of |type| replace an earlier one of the same type and
+  // routing id that is still waiting to be dispatched, so that only the
+  // latest is. This suits messages that carry the latest state of something,
+  // like mouse moves. Must be called on the listener thread.
+  void SetCoalesced(uint32 type);
+
   void set_outgoing_message_filter(OutgoingMessageFilter* filter) {
     outgoing_message_filter_ = filter;
   }
@@ -206,6 +223,13 @@ class IPC_EXPORT ChannelProxy : public Message::Sender {
     // Dispatches a message on the listener thread.
     void OnDispatchMessage(const Message& message);
 
+    // Dispatches the messages queued by OnMessageReceivedNoFilter on the
+    // listener thread.
+    void OnDispatchMessages();
+
+    // Adds |message| to its dispatch queue. Called on the listener thread.
+    void QueueForDispatch(Message* message);
+
    protected:
     friend class base::RefCountedThreadSafe<Context>;
     virtual ~Context();
@@ -268,6 +292,24 @@ class IPC_EXPORT ChannelProxy : public Message::Sender {
     // Cached copy of the peer process ID. Set on IPC but read on both IPC and
     // listener threads.
     base::ProcessId peer_pid_;
+
+    // Messages received on the IPC thread that wait for a task posted to the
+    // listener thread, which takes them all at once. A task is only posted
+    // for the first of them, so a burst of messages costs one task.
+    std::vector<Message*> incoming_messages_;
+    // Lock for incoming_messages_.
+    base::Lock incoming_messages_lock_;
+
+    // Messages taken by OnDispatchMessages that are yet to be dispatched, by
+    // priority. Only accessed on the listener thread. A task that runs in a
+    // nested message loop while one of them is dispatched adds its messages
+    // after them, so that messages are still dispatched in order.
+    std::deque<Message*> dispatch_queues_[Message::PRIORITY_HIGH + 1];
+
+    // Set by SetDispatchPriority and SetCoalesced. Only accessed on the
+    // listener thread.
+    std::map<uint32, Message::PriorityValue> dispatch_priorities_;
+    std::set<uint32> coalesced_types_;
   };
 
   Context* context() { return context_; }
@@ -4,11 +4,14 @@
 
 #include "ipc/ipc_channel_reader.h"
 
+#include "ipc/ipc_message_stats.h"
+
 namespace IPC {
 namespace internal {
 
 ChannelReader::ChannelReader(Channel::Listener* listener)
-    : listener_(listener) {
+    : listener_(listener),
+      overflow_read_offset_(0) {
   memset(input_buf_, 0, sizeof(input_buf_));
 }
 
@@ -17,22 +20,24 @@ ChannelReader::~ChannelReader() {
 
 bool ChannelReader::ProcessIncomingMessages() {
   while (true) {
+    char* buffer;
+    int buffer_len;
+    GetReadBuffer(&buffer, &buffer_len);
     int bytes_read = 0;
-    ReadState read_state = ReadData(input_buf_, Channel::kReadBufferSize,
-                                    &bytes_read);
+    ReadState read_state = ReadData(buffer, buffer_len, &bytes_read);
     if (read_state == READ_FAILED)
       return false;
     if (read_state == READ_PENDING)
       return true;
 
     DCHECK(bytes_read > 0);
-    if (!DispatchInputData(input_buf_, bytes_read))
+    if (!DidReadData(bytes_read))
       return false;
   }
 }
 
 bool ChannelReader::AsyncReadComplete(int bytes_read) {
-  return DispatchInputData(input_buf_, bytes_read);
+  return DidReadData(bytes_read);
 }
 
 bool ChannelReader::IsHelloMessage(const Message& m) const {
@@ -40,6 +45,39 @@ bool ChannelReader::IsHelloMessage(const Message& m) const {
          m.type() == Channel::HELLO_MESSAGE_TYPE;
 }
 
+void ChannelReader::GetReadBuffer(char** buffer, int* buffer_len) {
+  if (overflow_read_offset_) {
+    // The last read into the overflow buffer found no data.
+    input_overflow_buf_.resize(overflow_read_offset_);
+    overflow_read_offset_ = 0;
+  }
+
+  size_t message_size = Message::PeekSize(
+      input_overflow_buf_.data(),
+      input_overflow_buf_.data() + input_overflow_buf_.size());
+  if (message_size <= input_overflow_buf_.size() + Channel::kReadBufferSize ||
+      message_size >= Channel::kMaximumMessageSize) {
+    *buffer = input_buf_;
+    *buffer_len = Channel::kReadBufferSize;
+    return;
+  }
+
+  overflow_read_offset_ = input_overflow_buf_.size();
+  input_overflow_buf_.resize(message_size);
+  *buffer = &input_overflow_buf_[overflow_read_offset_];
+  *buffer_len = static_cast<int>(message_size - overflow_read_offset_);
+}
+
+bool ChannelReader::DidReadData(int bytes_read) {
+  if (!overflow_read_offset_)
+    return DispatchInputData(input_buf_, bytes_read);
+
+  // The data is already in place after the start of the message.
+  input_overflow_buf_.resize(overflow_read_offset_ + bytes_read);
+  overflow_read_offset_ = 0;
+  return DispatchInputData(input_buf_, 0);
+}
+
 bool ChannelReader::DispatchInputData(const char* input_data,
                                       int input_data_len) {
   const char* p;
@@ -70,10 +108,13 @@ bool ChannelReader::DispatchInputData(const char* input_data,
       if (!WillDispatchInputMessage(&m))
         return false;
 
-      if (IsHelloMessage(m))
+      if (IsHelloMessage(m)) {
         HandleHelloMessage(m);
-      else
+      } else {
+        if (MessageStats::IsEnabled())
+          MessageStats::GetInstance()->RecordReceived(m);
         listener_->OnMessageReceived(m);
+      }
       p = message_tail;
     } else {
       // Last message is partial.
@@ -89,6 +130,5 @@ bool ChannelReader::DispatchInputData(const char* input_data,
   return true;
 }
 
-
 }  // namespace internal
 }  // namespace IPC
@@ -80,6 +80,17 @@ class ChannelReader {
   virtual void HandleHelloMessage(const Message& msg) = 0;
 
  private:
+  // Picks the buffer for the next read. This is |input_buf_|, unless the
+  // overflow buffer holds the start of a message too big for it, in which
+  // case the read goes straight into the overflow buffer, sized to hold the
+  // rest of that message. Large messages then take few reads and are not
+  // copied a chunk at a time.
+  void GetReadBuffer(char** buffer, int* buffer_len);
+
+  // Dispatches the messages completed by a read of |bytes_read| bytes into
+  // the buffer given by GetReadBuffer.
+  bool DidReadData(int bytes_read);
+
   // Takes the given data received from the IPC channel and dispatches any
   // fully completed messages.
   //
@@ -96,6 +107,10 @@ class ChannelReader {
   // this buffer.
   std::string input_overflow_buf_;
 
+  // While a read into |input_overflow_buf_| is outstanding, the number of
+  // bytes of it that held data before the read. Zero otherwise.
+  size_t overflow_read_offset_;
+
   DISALLOW_COPY_AND_ASSIGN(ChannelReader);
 };
 
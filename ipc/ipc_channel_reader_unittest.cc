@@ -0,0 +1,142 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ipc/ipc_channel_reader.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace IPC {
+namespace internal {
+
+namespace {
+
+// Keeps the string payload of every message it is given.
+class RecordingListener : public Channel::Listener {
+ public:
+  virtual bool OnMessageReceived(const Message& message) OVERRIDE {
+    PickleIterator iter(message);
+    std::string payload;
+    EXPECT_TRUE(message.ReadString(&iter, &payload));
+    payloads_.push_back(payload);
+    return true;
+  }
+
+  const std::vector<std::string>& payloads() const { return payloads_; }
+
+ private:
+  std::vector<std::string> payloads_;
+};
+
+// Reads from a string of pending data, at most |max_read| bytes at a time,
+// and records the size of every buffer it is asked to fill.
+class TestChannelReader : public ChannelReader {
+ public:
+  TestChannelReader(Channel::Listener* listener, int max_read)
+      : ChannelReader(listener),
+        max_read_(max_read) {
+  }
+
+  void AddData(const char* data, size_t size) {
+    pending_.append(data, size);
+  }
+
+  void AddMessage(const Message& message) {
+    AddData(static_cast<const char*>(message.data()), message.size());
+  }
+
+  const std::vector<int>& buffer_lens() const { return buffer_lens_; }
+
+ protected:
+  virtual ReadState ReadData(char* buffer,
+                             int buffer_len,
+                             int* bytes_read) OVERRIDE {
+    buffer_lens_.push_back(buffer_len);
+    if (pending_.empty())
+      return READ_PENDING;
+    *bytes_read = std::min(std::min(buffer_len, max_read_),
+                           static_cast<int>(pending_.size()));
+    memcpy(buffer, pending_.data(), *bytes_read);
+    pending_.erase(0, *bytes_read);
+    return READ_SUCCEEDED;
+  }
+
+  virtual bool WillDispatchInputMessage(Message* msg) OVERRIDE {
+    return true;
+  }
+
+  virtual bool DidEmptyInputBuffers() OVERRIDE {
+    return true;
+  }
+
+  virtual void HandleHelloMessage(const Message& msg) OVERRIDE {
+  }
+
+ private:
+  int max_read_;
+  std::string pending_;
+  std::vector<int> buffer_lens_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestChannelReader);
+};
+
+Message MakeMessage(const std::string& payload) {
+  Message message(0, 2, Message::PRIORITY_NORMAL);
+  message.WriteString(payload);
+  return message;
+}
+
+}  // namespace
+
+// Once the header of a large message is in, the rest of it is read straight
+// into the overflow buffer in one go, and reads go back to the input buffer
+// after it.
+TEST(ChannelReaderTest, LargeMessageIsReadInPlace) {
+  const std::string large(100000, 'a');
+  Message large_message = MakeMessage(large);
+  RecordingListener listener;
+  TestChannelReader reader(&listener, kint32max);
+  reader.AddMessage(large_message);
+  reader.AddMessage(MakeMessage("small"));
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+
+  ASSERT_EQ(2u, listener.payloads().size());
+  EXPECT_EQ(large, listener.payloads()[0]);
+  EXPECT_EQ("small", listener.payloads()[1]);
+
+  const int kReadBufferSize = static_cast<int>(Channel::kReadBufferSize);
+  ASSERT_EQ(4u, reader.buffer_lens().size());
+  EXPECT_EQ(kReadBufferSize, reader.buffer_lens()[0]);
+  EXPECT_EQ(static_cast<int>(large_message.size()) - kReadBufferSize,
+            reader.buffer_lens()[1]);
+  EXPECT_EQ(kReadBufferSize, reader.buffer_lens()[2]);
+  EXPECT_EQ(kReadBufferSize, reader.buffer_lens()[3]);
+}
+
+// A large message that comes in short reads, with no data ready part way
+// through, is put back together intact.
+TEST(ChannelReaderTest, LargeMessageArrivesInParts) {
+  const std::string large(100000, 'b');
+  Message large_message = MakeMessage(large);
+  const char* data = static_cast<const char*>(large_message.data());
+  const size_t kFirstPart = 20000;
+  RecordingListener listener;
+  TestChannelReader reader(&listener, 1000);
+  reader.AddData(data, kFirstPart);
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+  EXPECT_TRUE(listener.payloads().empty());
+
+  reader.AddData(data + kFirstPart, large_message.size() - kFirstPart);
+  EXPECT_TRUE(reader.ProcessIncomingMessages());
+  ASSERT_EQ(1u, listener.payloads().size());
+  EXPECT_EQ(large, listener.payloads()[0]);
+}
+
+}  // namespace internal
+}  // namespace IPC
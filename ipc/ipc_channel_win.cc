@@ -372,6 +372,7 @@ bool Channel::ChannelImpl::ProcessOutgoingMessages(
 
   // Write to pipe...
   Message* m = output_queue_.front();
+  m->FlattenExternalData();
   DCHECK(m->size() <= INT_MAX);
   BOOL ok = WriteFile(pipe_,
                       m->data(),
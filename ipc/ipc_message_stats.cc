@@ -0,0 +1,70 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ipc/ipc_message_stats.h"
+
+#include "base/atomicops.h"
+#include "base/debug/trace_event.h"
+#include "ipc/ipc_message.h"
+
+namespace IPC {
+
+// static
+MessageStats* MessageStats::GetInstance() {
+  return Singleton<MessageStats>::get();
+}
+
+// static
+bool MessageStats::IsEnabled() {
+  // The flag for a category lives as long as the process, so it is looked up
+  // once. A racing lookup finds the same flag.
+  static base::subtle::AtomicWord category_enabled = 0;
+  const unsigned char* enabled = reinterpret_cast<const unsigned char*>(
+      base::subtle::NoBarrier_Load(&category_enabled));
+  if (!enabled) {
+    enabled = TRACE_EVENT_API_GET_CATEGORY_ENABLED("ipc");
+    base::subtle::NoBarrier_Store(
+        &category_enabled, reinterpret_cast<base::subtle::AtomicWord>(enabled));
+  }
+  return *enabled != 0;
+}
+
+MessageStats::MessageStats() {
+}
+
+MessageStats::~MessageStats() {
+}
+
+void MessageStats::RecordReceived(const Message& message) {
+  TypeStats stats;
+  {
+    base::AutoLock auto_lock(lock_);
+    TypeStats& type_stats = stats_[message.type()];
+    type_stats.count++;
+    type_stats.bytes += message.size();
+    stats = type_stats;
+  }
+  TRACE_COUNTER_ID2("ipc", "IPCMessagesReceived", message.type(),
+                    "count", stats.count, "kilobytes", stats.bytes / 1024);
+}
+
+void MessageStats::RecordDispatched(uint32 type, base::TimeDelta time) {
+  TypeStats stats;
+  {
+    base::AutoLock auto_lock(lock_);
+    TypeStats& type_stats = stats_[type];
+    type_stats.dispatch_time += time;
+    stats = type_stats;
+  }
+  TRACE_COUNTER_ID1("ipc", "IPCDispatchTimeMs", type,
+                    stats.dispatch_time.InMilliseconds());
+}
+
+MessageStats::TypeStats MessageStats::GetTypeStats(uint32 type) const {
+  base::AutoLock auto_lock(lock_);
+  TypeStatsMap::const_iterator it = stats_.find(type);
+  return it == stats_.end() ? TypeStats() : it->second;
+}
+
+}  // namespace IPC
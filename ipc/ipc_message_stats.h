@@ -0,0 +1,71 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IPC_IPC_MESSAGE_STATS_H_
+#define IPC_IPC_MESSAGE_STATS_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/hash_tables.h"
+#include "base/memory/singleton.h"
+#include "base/synchronization/lock.h"
+#include "base/time.h"
+#include "ipc/ipc_export.h"
+
+namespace IPC {
+
+class Message;
+
+// Counts the messages of each type that this process receives, their bytes,
+// and the time the listener thread spends dispatching them. Unlike Logging,
+// it is built in every configuration, so that unexpected IPC traffic can be
+// accounted for in production builds.
+//
+// Channels only record messages while the "ipc" trace category is enabled,
+// so that the lock and the timing cost nothing the rest of the time. Each
+// update is also recorded as an "ipc" category counter in about:tracing, one
+// per message type.
+class IPC_EXPORT MessageStats {
+ public:
+  struct TypeStats {
+    TypeStats() : count(0), bytes(0) {}
+
+    int64 count;
+    int64 bytes;
+    base::TimeDelta dispatch_time;
+  };
+
+  static MessageStats* GetInstance();
+
+  // Returns true if channels should record their messages, which is while
+  // the "ipc" trace category is enabled. This is cheap enough to check for
+  // every message.
+  static bool IsEnabled();
+
+  // Called on the IPC thread for each message a channel reads.
+  void RecordReceived(const Message& message);
+
+  // Called after a listener took |time| to handle a message of |type|.
+  void RecordDispatched(uint32 type, base::TimeDelta time);
+
+  // Returns the totals for |type| since the process started.
+  TypeStats GetTypeStats(uint32 type) const;
+
+ private:
+  friend struct DefaultSingletonTraits<MessageStats>;
+
+  typedef base::hash_map<uint32, TypeStats> TypeStatsMap;
+
+  MessageStats();
+  ~MessageStats();
+
+  mutable base::Lock lock_;
+  TypeStatsMap stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(MessageStats);
+};
+
+}  // namespace IPC
+
+#endif  // IPC_IPC_MESSAGE_STATS_H_
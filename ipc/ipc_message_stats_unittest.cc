@@ -0,0 +1,61 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ipc/ipc_message_stats.h"
+
+#include "base/debug/trace_event.h"
+#include "ipc/ipc_message.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// The stats are process-wide, so these use message types no other test
+// sends, and compare against the totals from before.
+const uint32 kStatsTestMessage = 0xfff0;
+const uint32 kOtherStatsTestMessage = 0xfff1;
+
+TEST(IPCMessageStatsTest, CountsReceivedMessages) {
+  IPC::MessageStats* stats = IPC::MessageStats::GetInstance();
+  IPC::MessageStats::TypeStats before = stats->GetTypeStats(kStatsTestMessage);
+  IPC::MessageStats::TypeStats other_before =
+      stats->GetTypeStats(kOtherStatsTestMessage);
+
+  IPC::Message message(1, kStatsTestMessage, IPC::Message::PRIORITY_NORMAL);
+  message.WriteString("some data");
+  stats->RecordReceived(message);
+  stats->RecordReceived(message);
+
+  IPC::MessageStats::TypeStats after = stats->GetTypeStats(kStatsTestMessage);
+  EXPECT_EQ(before.count + 2, after.count);
+  EXPECT_EQ(before.bytes + 2 * static_cast<int64>(message.size()),
+            after.bytes);
+  EXPECT_EQ(other_before.count,
+            stats->GetTypeStats(kOtherStatsTestMessage).count);
+}
+
+TEST(IPCMessageStatsTest, AddsUpDispatchTime) {
+  IPC::MessageStats* stats = IPC::MessageStats::GetInstance();
+  base::TimeDelta before =
+      stats->GetTypeStats(kStatsTestMessage).dispatch_time;
+
+  stats->RecordDispatched(kStatsTestMessage,
+                          base::TimeDelta::FromMilliseconds(3));
+  stats->RecordDispatched(kStatsTestMessage,
+                          base::TimeDelta::FromMilliseconds(4));
+
+  EXPECT_EQ(before + base::TimeDelta::FromMilliseconds(7),
+            stats->GetTypeStats(kStatsTestMessage).dispatch_time);
+}
+
+TEST(IPCMessageStatsTest, EnabledWhileTracingIPC) {
+  base::debug::TraceLog* trace_log = base::debug::TraceLog::GetInstance();
+  EXPECT_FALSE(IPC::MessageStats::IsEnabled());
+
+  trace_log->SetEnabled("ipc");
+  EXPECT_TRUE(IPC::MessageStats::IsEnabled());
+  trace_log->SetDisabled();
+  EXPECT_FALSE(IPC::MessageStats::IsEnabled());
+
+  trace_log->SetEnabled("-ipc");
+  EXPECT_FALSE(IPC::MessageStats::IsEnabled());
+  trace_log->SetDisabled();
+}
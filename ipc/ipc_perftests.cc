@@ -0,0 +1,194 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the latency and throughput of messages of various sizes over a
+// Channel, a ChannelProxy and a SyncChannel. Each test talks to a peer in
+// this process that answers every message on its IPC thread.
+
+#include <string>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/thread.h"
+#include "ipc/ipc_channel.h"
+#include "ipc/ipc_channel_proxy.h"
+#include "ipc/ipc_sync_channel.h"
+#include "ipc/ipc_sync_message.h"
+#include "ipc/ipc_test_reflector.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const char kChannelName[] = "IPCPerfTest";
+const uint32 kPingMessage = 1;
+
+const size_t kPayloadSizes[] = { 12, 144, 1728, 20736, 248832 };
+
+// Enough messages of each size for a run to take a measurable time, without
+// big payloads taking too long.
+int MessageCount(size_t payload_size) {
+  return payload_size > 20000 ? 1000 : 20000;
+}
+
+IPC::Message* NewPing(const std::string& payload) {
+  IPC::Message* message = new IPC::Message(
+      MSG_ROUTING_CONTROL, kPingMessage, IPC::Message::PRIORITY_NORMAL);
+  message->WriteString(payload);
+  return message;
+}
+
+// Counts down the messages it gets back from the reflector, sending the next
+// ping for each one when |ping_pong| is set, and quits the run loop when all
+// of them are back.
+class PingListener : public IPC::Channel::Listener {
+ public:
+  PingListener() : sender_(NULL), ping_pong_(false), count_down_(0) {}
+
+  void Start(IPC::Message::Sender* sender, const std::string& payload,
+             int count, bool ping_pong) {
+    sender_ = sender;
+    payload_ = payload;
+    count_down_ = count;
+    ping_pong_ = ping_pong;
+    if (ping_pong_) {
+      sender_->Send(NewPing(payload_));
+    } else {
+      for (int i = 0; i < count; ++i)
+        sender_->Send(NewPing(payload_));
+    }
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    if (--count_down_ == 0)
+      MessageLoop::current()->Quit();
+    else if (ping_pong_)
+      sender_->Send(NewPing(payload_));
+    return true;
+  }
+
+ private:
+  IPC::Message::Sender* sender_;
+  std::string payload_;
+  bool ping_pong_;
+  int count_down_;
+};
+
+class IPCPerfTest : public testing::Test {
+ protected:
+  IPCPerfTest()
+      : peer_ipc_thread_("peer_ipc"),
+        ipc_thread_("ipc") {
+  }
+
+  virtual void SetUp() OVERRIDE {
+    base::Thread::Options options(MessageLoop::TYPE_IO, 0);
+    ASSERT_TRUE(peer_ipc_thread_.StartWithOptions(options));
+    ASSERT_TRUE(ipc_thread_.StartWithOptions(options));
+  }
+
+  // Connects the reflecting peer to the server end of |kChannelName|, which
+  // must have been created.
+  void ConnectPeer() {
+    peer_.reset(new IPC::ChannelProxy(NULL,
+                                      peer_ipc_thread_.message_loop_proxy()));
+    peer_->AddFilter(new IPC::ReflectorFilter);
+    peer_->Init(kChannelName, IPC::Channel::MODE_CLIENT, true);
+  }
+
+  void ClosePeer() {
+    peer_->Close();
+    peer_.reset();
+  }
+
+  // Times |count| round trips of |payload| through |sender|, one at a time,
+  // then the same number sent all at once.
+  void TimeRoundTrips(const char* transport, IPC::Message::Sender* sender,
+                      PingListener* listener, size_t payload_size) {
+    std::string payload(payload_size, 'a');
+    int count = MessageCount(payload_size);
+
+    PerfTimer latency_timer;
+    listener->Start(sender, payload, count, true);
+    MessageLoop::current()->Run();
+    LogRoundTrips(transport, "latency", payload_size, count,
+                  latency_timer.Elapsed());
+
+    PerfTimer throughput_timer;
+    listener->Start(sender, payload, count, false);
+    MessageLoop::current()->Run();
+    LogRoundTrips(transport, "throughput", payload_size, count,
+                  throughput_timer.Elapsed());
+  }
+
+  static void LogRoundTrips(const char* transport, const char* mode,
+                            size_t payload_size, int count,
+                            base::TimeDelta elapsed) {
+    std::string name = base::StringPrintf("IPC_%s_%s_%d", transport, mode,
+                                          static_cast<int>(payload_size));
+    LogPerfResult((name + "_round_trip").c_str(),
+                  elapsed.InMicroseconds() / static_cast<double>(count), "us");
+    LogPerfResult((name + "_messages").c_str(),
+                  count / elapsed.InSecondsF(), "messages/s");
+  }
+
+  MessageLoopForIO message_loop_;
+  base::Thread peer_ipc_thread_;
+  base::Thread ipc_thread_;
+  scoped_ptr<IPC::ChannelProxy> peer_;
+};
+
+TEST_F(IPCPerfTest, Channel) {
+  for (size_t i = 0; i < arraysize(kPayloadSizes); ++i) {
+    PingListener listener;
+    IPC::Channel channel(kChannelName, IPC::Channel::MODE_SERVER, &listener);
+    ASSERT_TRUE(channel.Connect());
+    ConnectPeer();
+    TimeRoundTrips("Channel", &channel, &listener, kPayloadSizes[i]);
+    ClosePeer();
+  }
+}
+
+TEST_F(IPCPerfTest, ChannelProxy) {
+  for (size_t i = 0; i < arraysize(kPayloadSizes); ++i) {
+    PingListener listener;
+    IPC::ChannelProxy proxy(kChannelName, IPC::Channel::MODE_SERVER,
+                            &listener, ipc_thread_.message_loop_proxy());
+    ConnectPeer();
+    TimeRoundTrips("ChannelProxy", &proxy, &listener, kPayloadSizes[i]);
+    proxy.Close();
+    ClosePeer();
+  }
+}
+
+TEST_F(IPCPerfTest, SyncChannel) {
+  base::WaitableEvent shutdown_event(true, false);
+  for (size_t i = 0; i < arraysize(kPayloadSizes); ++i) {
+    PingListener listener;
+    IPC::SyncChannel channel(kChannelName, IPC::Channel::MODE_SERVER,
+                             &listener, ipc_thread_.message_loop_proxy(),
+                             true, &shutdown_event);
+    ConnectPeer();
+
+    std::string payload(kPayloadSizes[i], 'a');
+    int count = MessageCount(kPayloadSizes[i]);
+    PerfTimer timer;
+    for (int j = 0; j < count; ++j) {
+      IPC::SyncMessage* message = new IPC::SyncMessage(
+          MSG_ROUTING_CONTROL, kPingMessage, IPC::Message::PRIORITY_NORMAL,
+          new IPC::EmptyReplyDeserializer);
+      message->WriteString(payload);
+      ASSERT_TRUE(channel.Send(message));
+    }
+    LogRoundTrips("SyncChannel", "latency", kPayloadSizes[i], count,
+                  timer.Elapsed());
+
+    channel.Close();
+    ClosePeer();
+  }
+}
+
+}  // namespace
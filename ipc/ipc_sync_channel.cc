@@ -4,10 +4,12 @@
 
 #include "ipc/ipc_sync_channel.h"
 
+#include "base/atomicops.h"
 #include "base/bind.h"
 #include "base/lazy_instance.h"
 #include "base/location.h"
 #include "base/logging.h"
+#include "base/stl_util.h"
 #include "base/threading/thread_local.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/synchronization/waitable_event_watcher.h"
@@ -75,8 +77,16 @@ class SyncChannel::ReceivedSyncMsgQueue :
     }
   }
 
+  // Called on the IPC thread, with the deserializers lock of |context| held.
   void QueueReply(const Message &msg, SyncChannel::SyncContext* context) {
     received_replies_.push_back(QueuedMessage(new Message(msg), context));
+    base::subtle::Barrier_AtomicIncrement(&queued_reply_count_, 1);
+  }
+
+  // Returns true if replies wait for a Send() further down the call stack.
+  // Called on the listener thread.
+  bool HasQueuedReplies() const {
+    return base::subtle::Acquire_Load(&queued_reply_count_) != 0;
   }
 
   // Called on the listener's thread to process any queues synchronous
@@ -161,6 +171,7 @@ class SyncChannel::ReceivedSyncMsgQueue :
       if (received_replies_[i].context->TryToUnblockListener(message)) {
         delete message;
         received_replies_.erase(received_replies_.begin() + i);
+        base::subtle::Barrier_AtomicIncrement(&queued_reply_count_, -1);
         return;
       }
     }
@@ -181,6 +192,7 @@ class SyncChannel::ReceivedSyncMsgQueue :
   // as manual reset.
   ReceivedSyncMsgQueue() :
       message_queue_version_(0),
+      queued_reply_count_(0),
       dispatch_event_(true, false),
       listener_message_loop_(base::MessageLoopProxy::current()),
       task_pending_(false),
@@ -202,6 +214,9 @@ class SyncChannel::ReceivedSyncMsgQueue :
   uint32 message_queue_version_;  // Used to signal DispatchMessages to rescan
 
   std::vector<QueuedMessage> received_replies_;
+  // The size of |received_replies_|, which is only accessed on the IPC
+  // thread, for the listener thread to read.
+  base::subtle::Atomic32 queued_reply_count_;
 
   // Set when we got a synchronous message that we must respond to as the
   // sender needs its reply before it can reply to our original synchronous
@@ -235,6 +250,7 @@ SyncChannel::SyncContext::SyncContext(
 SyncChannel::SyncContext::~SyncContext() {
   while (!deserializers_.empty())
     Pop();
+  STLDeleteElements(&free_done_events_);
 }
 
 // Adds information about an outgoing sync message to the context so that
@@ -249,33 +265,50 @@ void SyncChannel::SyncContext::Push(SyncMessage* sync_msg) {
   // OnObjectSignalled, another Send can happen which would stop the watcher
   // from being called.  The event would get watched later, when the nested
   // Send completes, so the event will need to remain set.
+  WaitableEvent* done_event;
+  if (free_done_events_.empty()) {
+    done_event = new WaitableEvent(true, false);
+  } else {
+    done_event = free_done_events_.back();
+    free_done_events_.pop_back();
+  }
   PendingSyncMsg pending(SyncMessage::GetMessageId(*sync_msg),
                          sync_msg->GetReplyDeserializer(),
-                         new WaitableEvent(true, false));
+                         done_event);
   base::AutoLock auto_lock(deserializers_lock_);
   deserializers_.push_back(pending);
 }
 
 bool SyncChannel::SyncContext::Pop() {
   bool result;
+  bool has_queued_replies;
   {
     base::AutoLock auto_lock(deserializers_lock_);
     PendingSyncMsg msg = deserializers_.back();
     delete msg.deserializer;
-    delete msg.done_event;
+    // The IPC thread is done with the event once it is off the queue, so it
+    // is kept for the next Send() rather than made anew each time.
+    msg.done_event->Reset();
+    free_done_events_.push_back(msg.done_event);
     msg.done_event = NULL;
     deserializers_.pop_back();
     result = msg.send_result;
+    has_queued_replies = received_sync_msgs_->HasQueuedReplies();
   }
 
   // We got a reply to a synchronous Send() call that's blocking the listener
   // thread.  However, further down the call stack there could be another
   // blocking Send() call, whose reply we received after we made this last
   // Send() call.  So check if we have any queued replies available that
-  // can now unblock the listener thread.
-  ipc_message_loop()->PostTask(
-      FROM_HERE, base::Bind(&ReceivedSyncMsgQueue::DispatchReplies,
-                            received_sync_msgs_.get()));
+  // can now unblock the listener thread. Replies are queued with the
+  // deserializers lock held, so one that came in for this context before the
+  // Send() above was popped is seen here. Without any, the trip to the IPC
+  // thread is skipped.
+  if (has_queued_replies) {
+    ipc_message_loop()->PostTask(
+        FROM_HERE, base::Bind(&ReceivedSyncMsgQueue::DispatchReplies,
+                              received_sync_msgs_.get()));
+  }
 
   return result;
 }
@@ -295,6 +328,11 @@ void SyncChannel::SyncContext::DispatchMessages() {
 
 bool SyncChannel::SyncContext::TryToUnblockListener(const Message* msg) {
   base::AutoLock auto_lock(deserializers_lock_);
+  return TryToUnblockListenerLocked(msg);
+}
+
+bool SyncChannel::SyncContext::TryToUnblockListenerLocked(const Message* msg) {
+  deserializers_lock_.AssertAcquired();
   if (deserializers_.empty() ||
       !SyncMessage::IsMessageReplyTo(*msg, deserializers_.back().id)) {
     return false;
@@ -320,11 +358,10 @@ bool SyncChannel::SyncContext::OnMessageReceived(const Message& msg) {
   if (TryFilters(msg))
     return true;
 
-  if (TryToUnblockListener(&msg))
-    return true;
-
   if (msg.is_reply()) {
-    received_sync_msgs_->QueueReply(msg, this);
+    base::AutoLock auto_lock(deserializers_lock_);
+    if (!TryToUnblockListenerLocked(&msg))
+      received_sync_msgs_->QueueReply(msg, this);
     return true;
   }
 
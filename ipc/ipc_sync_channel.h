@@ -8,6 +8,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
@@ -180,6 +181,9 @@ class IPC_EXPORT SyncChannel : public ChannelProxy,
     // Cancels all pending Send calls.
     void CancelPendingSends();
 
+    // Like TryToUnblockListener, for callers that hold deserializers_lock_.
+    bool TryToUnblockListenerLocked(const Message* msg);
+
     // WaitableEventWatcher::Delegate implementation.
     virtual void OnWaitableEventSignaled(base::WaitableEvent* arg) OVERRIDE;
 
@@ -187,6 +191,10 @@ class IPC_EXPORT SyncChannel : public ChannelProxy,
     PendingSyncMessageQueue deserializers_;
     base::Lock deserializers_lock_;
 
+    // Done events of finished Send calls, for later ones to reuse. Only
+    // accessed on the listener thread.
+    std::vector<base::WaitableEvent*> free_done_events_;
+
     scoped_refptr<ReceivedSyncMsgQueue> received_sync_msgs_;
 
     base::WaitableEvent* shutdown_event_;
@@ -0,0 +1,32 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ipc/ipc_test_reflector.h"
+
+namespace IPC {
+
+ReflectorFilter::ReflectorFilter() : channel_(NULL) {
+}
+
+ReflectorFilter::~ReflectorFilter() {
+}
+
+void ReflectorFilter::OnFilterAdded(Channel* channel) {
+  channel_ = channel;
+}
+
+bool ReflectorFilter::OnMessageReceived(const Message& message) {
+  if (message.is_sync())
+    channel_->Send(SyncMessage::GenerateReply(&message));
+  else
+    channel_->Send(new Message(message));
+  return true;
+}
+
+bool EmptyReplyDeserializer::SerializeOutputParameters(const Message& msg,
+                                                       PickleIterator iter) {
+  return true;
+}
+
+}  // namespace IPC
@@ -0,0 +1,44 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef IPC_IPC_TEST_REFLECTOR_H_
+#define IPC_IPC_TEST_REFLECTOR_H_
+#pragma once
+
+#include "base/compiler_specific.h"
+#include "ipc/ipc_channel_proxy.h"
+#include "ipc/ipc_sync_message.h"
+
+namespace IPC {
+
+// Answers every message on the IPC thread: sync messages with an empty
+// reply, and others with a copy of themselves. Round trips through it don't
+// wait for a listener thread on the far side, so tests use it to time the
+// channel alone.
+class ReflectorFilter : public ChannelProxy::MessageFilter {
+ public:
+  ReflectorFilter();
+
+  // ChannelProxy::MessageFilter implementation.
+  virtual void OnFilterAdded(Channel* channel) OVERRIDE;
+  virtual bool OnMessageReceived(const Message& message) OVERRIDE;
+
+ private:
+  virtual ~ReflectorFilter();
+
+  Channel* channel_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReflectorFilter);
+};
+
+// Takes the reply to a sync message that has no output parameters.
+class EmptyReplyDeserializer : public MessageReplyDeserializer {
+ private:
+  virtual bool SerializeOutputParameters(const Message& msg,
+                                         PickleIterator iter) OVERRIDE;
+};
+
+}  // namespace IPC
+
+#endif  // IPC_IPC_TEST_REFLECTOR_H_
@@ -23,12 +23,16 @@
 #include "base/perftimer.h"
 #include "base/test/perf_test_suite.h"
 #include "base/test/test_suite.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/threading/thread.h"
 #include "ipc/ipc_descriptors.h"
 #include "ipc/ipc_channel.h"
 #include "ipc/ipc_channel_proxy.h"
 #include "ipc/ipc_message_utils.h"
+#include "ipc/ipc_sync_channel.h"
+#include "ipc/ipc_sync_message.h"
 #include "ipc/ipc_switches.h"
+#include "ipc/ipc_test_reflector.h"
 #include "testing/multiprocess_func_list.h"
 
 // Define to enable IPC performance testing instead of the regular unit tests
@@ -395,6 +399,76 @@ TEST_F(IPCChannelTest, SendMessageInChannelConnected) {
   base::CloseProcessHandle(process_handle);
 }
 
+// Checks that messages come in the order they were sent, and runs a nested
+// message loop while it handles the first one.
+class OrderCheckingListener : public IPC::Channel::Listener {
+ public:
+  explicit OrderCheckingListener(int message_count)
+      : message_count_(message_count),
+        next_message_(0),
+        nested_(false) {
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    EXPECT_FALSE(next_message_ == message_count_);
+    IPC::MessageIterator iter(message);
+    EXPECT_EQ(next_message_, iter.NextInt());
+    ++next_message_;
+
+    if (next_message_ == 1) {
+      nested_ = true;
+      MessageLoop::ScopedNestableTaskAllower allow(MessageLoop::current());
+      MessageLoop::current()->RunAllPending();
+      nested_ = false;
+    }
+    if (next_message_ == message_count_ && !nested_)
+      MessageLoop::current()->Quit();
+    return true;
+  }
+
+  virtual void OnChannelError() OVERRIDE {
+    ADD_FAILURE() << "Channel error after " << next_message_ << " messages";
+    MessageLoop::current()->Quit();
+  }
+
+ private:
+  int message_count_;
+  int next_message_;
+  bool nested_;
+};
+
+// ChannelProxy hands the messages that arrive in a burst to the listener
+// thread in one task. They are still dispatched one at a time and in order,
+// even when a message handler runs a nested message loop.
+TEST_F(IPCChannelTest, ChannelProxyDispatchesBurstsInOrder) {
+  const int kMessageCount = 200;
+  OrderCheckingListener server_listener(kMessageCount);
+  OrderCheckingListener client_listener(0);
+
+  // The thread needs to out-live the ChannelProxies.
+  base::Thread thread("ChannelProxyBurstTestIO");
+  base::Thread::Options options;
+  options.message_loop_type = MessageLoop::TYPE_IO;
+  thread.StartWithOptions(options);
+  {
+    IPC::ChannelProxy server("ChannelProxyBurstTest",
+                             IPC::Channel::MODE_SERVER, &server_listener,
+                             thread.message_loop_proxy());
+    IPC::ChannelProxy client("ChannelProxyBurstTest",
+                             IPC::Channel::MODE_CLIENT, &client_listener,
+                             thread.message_loop_proxy());
+    for (int i = 0; i < kMessageCount; ++i) {
+      IPC::Message* message = new IPC::Message(0, 2,
+                                               IPC::Message::PRIORITY_NORMAL);
+      message->WriteInt(i);
+      client.Send(message);
+    }
+
+    MessageLoop::current()->Run();
+  }
+  thread.Stop();
+}
+
 MULTIPROCESS_TEST_MAIN(RunTestClient) {
   MessageLoopForIO main_message_loop;
   MyChannelListener channel_listener;
@@ -576,6 +650,71 @@ MULTIPROCESS_TEST_MAIN(RunReflector) {
   return true;
 }
 
+// Sends an async message each time one arrives, until |count| have.
+class AsyncPingListener : public IPC::Channel::Listener {
+ public:
+  AsyncPingListener() : sender_(NULL), count_down_(0) {}
+
+  void Start(IPC::Message::Sender* sender, int count) {
+    sender_ = sender;
+    count_down_ = count;
+    sender_->Send(new IPC::Message(0, 2, IPC::Message::PRIORITY_NORMAL));
+  }
+
+  virtual bool OnMessageReceived(const IPC::Message& message) OVERRIDE {
+    if (--count_down_ == 0) {
+      MessageLoop::current()->Quit();
+      return true;
+    }
+    sender_->Send(new IPC::Message(0, 2, IPC::Message::PRIORITY_NORMAL));
+    return true;
+  }
+
+ private:
+  IPC::Message::Sender* sender_;
+  int count_down_;
+};
+
+// Times round trips of sync messages and of async ones between two channels
+// in this process, each with its own IPC thread.
+TEST_F(IPCChannelTest, SyncRoundTripPerformance) {
+  const int kRoundTrips = 50000;
+  const char kChannelName[] = "SyncRoundTripPerformance";
+
+  base::Thread server_ipc_thread("server_ipc");
+  base::Thread client_ipc_thread("client_ipc");
+  base::Thread::Options options(MessageLoop::TYPE_IO, 0);
+  ASSERT_TRUE(server_ipc_thread.StartWithOptions(options));
+  ASSERT_TRUE(client_ipc_thread.StartWithOptions(options));
+  base::WaitableEvent shutdown_event(true, false);
+
+  AsyncPingListener listener;
+  IPC::SyncChannel server(kChannelName, IPC::Channel::MODE_SERVER, &listener,
+                          server_ipc_thread.message_loop_proxy(), true,
+                          &shutdown_event);
+  IPC::ChannelProxy client(kChannelName, IPC::Channel::MODE_CLIENT, NULL,
+                           client_ipc_thread.message_loop_proxy());
+  client.AddFilter(new IPC::ReflectorFilter);
+
+  {
+    PerfTimeLogger logger("IPC_SyncRoundTrip");
+    for (int i = 0; i < kRoundTrips; ++i) {
+      ASSERT_TRUE(server.Send(new IPC::SyncMessage(
+          MSG_ROUTING_CONTROL, 1, IPC::Message::PRIORITY_NORMAL,
+          new IPC::EmptyReplyDeserializer)));
+    }
+  }
+
+  {
+    PerfTimeLogger logger("IPC_AsyncRoundTrip");
+    listener.Start(&server, kRoundTrips);
+    MessageLoop::current()->Run();
+  }
+
+  client.Close();
+  server.Close();
+}
+
 #endif  // PERFORMANCE_TEST
 
 int main(int argc, char** argv) {
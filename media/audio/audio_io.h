@@ -85,6 +85,10 @@ class MEDIA_EXPORT AudioOutputStream {
     // plugins. In any case, data is usually immediately available,
     // so there would be no delay.
     virtual void WaitTillDataReady() {}
+
+    // Returns false if WaitTillDataReady() would wait. Lets a source that
+    // mixes several others wait for all of them at once.
+    virtual bool DataReady() { return true; }
   };
 
   virtual ~AudioOutputStream() {}
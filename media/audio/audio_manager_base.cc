@@ -142,11 +142,14 @@ AudioOutputStream* AudioManagerBase::MakeAudioOutputStreamProxy(
   if (!dispatcher) {
     base::TimeDelta close_delay =
         base::TimeDelta::FromSeconds(kStreamCloseDelaySeconds);
+    // Streams with the same parameters are mixed into one physical stream,
+    // so that a page playing many sounds at once does not open an OS stream,
+    // with its own thread and wakeups, for each of them.
     const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
-    if (cmd_line->HasSwitch(switches::kEnableAudioMixer)) {
-      dispatcher = new AudioOutputMixer(this, params, close_delay);
-    } else {
+    if (cmd_line->HasSwitch(switches::kDisableAudioMixer)) {
       dispatcher = new AudioOutputDispatcherImpl(this, params, close_delay);
+    } else {
+      dispatcher = new AudioOutputMixer(this, params, close_delay);
     }
   }
   return new AudioOutputProxy(dispatcher);
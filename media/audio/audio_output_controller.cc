@@ -30,6 +30,7 @@ AudioOutputController::AudioOutputController(EventHandler* handler,
       stream_(NULL),
       volume_(1.0),
       state_(kEmpty),
+      playing_(0),
       sync_reader_(sync_reader),
       message_loop_(NULL),
       number_polling_attempts_left_(0),
@@ -197,6 +198,7 @@ void AudioOutputController::PollAndStartIfDataReady() {
 void AudioOutputController::StartStream() {
   DCHECK(message_loop_->BelongsToCurrentThread());
   state_ = kPlaying;
+  base::subtle::Release_Store(&playing_, 1);
 
   // We start the AudioOutputStream lazily.
   stream_->Start(this);
@@ -221,6 +223,7 @@ void AudioOutputController::DoPause() {
       break;
     case kPlaying:
       state_ = kPaused;
+      base::subtle::Release_Store(&playing_, 0);
 
       // Then we stop the audio device. This is not the perfect solution
       // because it discards all the internal buffer in the audio device.
@@ -247,6 +250,7 @@ void AudioOutputController::DoClose() {
   DCHECK(message_loop_->BelongsToCurrentThread());
 
   if (state_ != kClosed) {
+    base::subtle::Release_Store(&playing_, 0);
     DoStopCloseAndClearStream(NULL);
     sync_reader_->Close();
     state_ = kClosed;
@@ -284,14 +288,11 @@ uint32 AudioOutputController::OnMoreData(uint8* dest,
                                          AudioBuffersState buffers_state) {
   TRACE_EVENT0("audio", "AudioOutputController::OnMoreData");
 
-  {
-    // Check state and do nothing if we are not playing.
-    // We are on the hardware audio thread, so lock is needed.
-    base::AutoLock auto_lock(lock_);
-    if (state_ != kPlaying) {
-      return 0;
-    }
-  }
+  // Do nothing if we are not playing. We are on the hardware audio thread, so
+  // |state_| can't be read here.
+  if (!base::subtle::Acquire_Load(&playing_))
+    return 0;
+
   uint32 size = sync_reader_->Read(dest, max_size);
   sync_reader_->UpdatePendingBytes(buffers_state.total_bytes() + size);
   return size;
@@ -311,6 +312,10 @@ void AudioOutputController::WaitTillDataReady() {
   }
 }
 
+bool AudioOutputController::DataReady() {
+  return sync_reader_->DataReady();
+}
+
 void AudioOutputController::OnError(AudioOutputStream* stream, int code) {
   // Handle error on the audio controller thread.
   message_loop_->PostTask(FROM_HERE, base::Bind(
@@ -5,11 +5,11 @@
 #ifndef MEDIA_AUDIO_AUDIO_OUTPUT_CONTROLLER_H_
 #define MEDIA_AUDIO_AUDIO_OUTPUT_CONTROLLER_H_
 
+#include "base/atomicops.h"
 #include "base/callback.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
-#include "base/synchronization/lock.h"
 #include "base/time.h"
 #include "media/audio/audio_buffers_state.h"
 #include "media/audio/audio_io.h"
@@ -152,6 +152,7 @@ class MEDIA_EXPORT AudioOutputController
                             AudioBuffersState buffers_state) OVERRIDE;
   virtual void OnError(AudioOutputStream* stream, int code) OVERRIDE;
   virtual void WaitTillDataReady() OVERRIDE;
+  virtual bool DataReady() OVERRIDE;
 
  protected:
     // Internal state of the source.
@@ -201,14 +202,13 @@ class MEDIA_EXPORT AudioOutputController
   // The current volume of the audio stream.
   double volume_;
 
-  // |state_| is written on the audio manager thread and is read on the
-  // hardware audio thread. These operations need to be locked. But lock
-  // is not required for reading on the audio manager thread.
+  // |state_| is only accessed on the audio manager thread.
   State state_;
 
-  // The |lock_| must be acquired whenever we access |state_| from a thread
-  // other than the audio manager thread.
-  base::Lock lock_;
+  // Non-zero while |state_| is kPlaying. This is what the hardware audio
+  // thread reads in OnMoreData(), so that it never waits on a lock held by the
+  // audio manager thread.
+  base::subtle::Atomic32 playing_;
 
   // SyncReader is used only in low latency mode for synchronous reading.
   SyncReader* sync_reader_;
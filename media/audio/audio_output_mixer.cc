@@ -244,9 +244,26 @@ void AudioOutputMixer::OnError(AudioOutputStream* stream, int code) {
 
 void AudioOutputMixer::WaitTillDataReady() {
   base::AutoLock lock(lock_);
+  // Wait for the sources at once rather than in turn. A source that is still
+  // not ready after waiting has waited as long as it would on its own, and
+  // the rest of them have had that long too, so stop there.
   for (ProxyMap::iterator it = proxies_.begin(); it != proxies_.end(); ++it) {
-    it->second.audio_source_callback->WaitTillDataReady();
+    AudioSourceCallback* source = it->second.audio_source_callback;
+    if (source->DataReady())
+      continue;
+    source->WaitTillDataReady();
+    if (!source->DataReady())
+      break;
   }
 }
 
+bool AudioOutputMixer::DataReady() {
+  base::AutoLock lock(lock_);
+  for (ProxyMap::iterator it = proxies_.begin(); it != proxies_.end(); ++it) {
+    if (!it->second.audio_source_callback->DataReady())
+      return false;
+  }
+  return true;
+}
+
 }  // namespace media
@@ -48,6 +48,7 @@ class MEDIA_EXPORT AudioOutputMixer
                             AudioBuffersState buffers_state) OVERRIDE;
   virtual void OnError(AudioOutputStream* stream, int code) OVERRIDE;
   virtual void WaitTillDataReady() OVERRIDE;
+  virtual bool DataReady() OVERRIDE;
 
  private:
   friend class base::RefCountedThreadSafe<AudioOutputMixer>;
@@ -81,6 +81,38 @@ class MockAudioSourceCallback : public AudioOutputStream::AudioSourceCallback {
   MOCK_METHOD2(OnError, void(AudioOutputStream* stream, int code));
 };
 
+// Source that counts how often it is waited for. Once waited for, it has data
+// if |ready_after_wait| is set.
+class WaitingSourceCallback : public AudioOutputStream::AudioSourceCallback {
+ public:
+  WaitingSourceCallback() : ready_(false), ready_after_wait_(false),
+                            wait_count_(0) {}
+
+  void Reset(bool ready_after_wait) {
+    ready_ = false;
+    ready_after_wait_ = ready_after_wait;
+    wait_count_ = 0;
+  }
+
+  int wait_count() const { return wait_count_; }
+
+  virtual uint32 OnMoreData(uint8* dest, uint32 max_size,
+                            AudioBuffersState buffers_state) OVERRIDE {
+    return 0;
+  }
+  virtual void OnError(AudioOutputStream* stream, int code) OVERRIDE {}
+  virtual void WaitTillDataReady() OVERRIDE {
+    ++wait_count_;
+    ready_ = ready_after_wait_;
+  }
+  virtual bool DataReady() OVERRIDE { return ready_; }
+
+ private:
+  bool ready_;
+  bool ready_after_wait_;
+  int wait_count_;
+};
+
 }  // namespace
 
 namespace media {
@@ -497,6 +529,63 @@ TEST_F(AudioOutputProxyTest, TwoStreams_BothPlaying_Mixer) {
   WaitForCloseTimer(kTestCloseDelayMs);
 }
 
+// The mixer waits for its streams at once, not for each of them in turn.
+TEST_F(AudioOutputProxyTest, TwoStreams_WaitTillDataReady_Mixer) {
+  MockAudioOutputStream stream;
+
+  InitDispatcher(base::TimeDelta::FromMilliseconds(kTestCloseDelayMs));
+
+  EXPECT_CALL(manager(), MakeAudioOutputStream(_))
+      .WillOnce(Return(&stream));
+
+  EXPECT_CALL(stream, Open())
+      .WillOnce(Return(true));
+  EXPECT_CALL(stream, Start(_))
+      .Times(1);
+  EXPECT_CALL(stream, SetVolume(_))
+      .Times(1);
+  EXPECT_CALL(stream, Stop())
+      .Times(1);
+  EXPECT_CALL(stream, Close())
+      .Times(1);
+
+  AudioOutputProxy* proxy1 = new AudioOutputProxy(mixer_);
+  AudioOutputProxy* proxy2 = new AudioOutputProxy(mixer_);
+  EXPECT_TRUE(proxy1->Open());
+  EXPECT_TRUE(proxy2->Open());
+
+  WaitingSourceCallback source1;
+  WaitingSourceCallback source2;
+  proxy1->Start(&source1);
+  proxy2->Start(&source2);
+
+  // Once a source runs out its wait, the other one is not waited for again.
+  EXPECT_FALSE(mixer_->DataReady());
+  mixer_->WaitTillDataReady();
+  EXPECT_EQ(1, source1.wait_count() + source2.wait_count());
+  EXPECT_FALSE(mixer_->DataReady());
+
+  // Sources that get their data while waited for do not stop the wait.
+  source1.Reset(true);
+  source2.Reset(true);
+  mixer_->WaitTillDataReady();
+  EXPECT_EQ(1, source1.wait_count());
+  EXPECT_EQ(1, source2.wait_count());
+  EXPECT_TRUE(mixer_->DataReady());
+
+  // Nobody waits for sources that are ready.
+  mixer_->WaitTillDataReady();
+  EXPECT_EQ(1, source1.wait_count());
+  EXPECT_EQ(1, source2.wait_count());
+
+  proxy1->Stop();
+  proxy2->Stop();
+
+  proxy1->Close();
+  proxy2->Close();
+  WaitForCloseTimer(kTestCloseDelayMs);
+}
+
 TEST_F(AudioOutputProxyTest, OpenFailed) {
   OpenFailed(dispatcher_impl_);
 }
@@ -61,14 +61,14 @@ static const int kChannel_L = 0;
 static const int kChannel_R = 1;
 static const int kChannel_C = 2;
 
+// Clamps with std::min()/std::max() rather than branches, so that the mixing
+// loops below can be vectorized by the compiler.
 template<class Fixed, int min_value, int max_value>
 static int AddSaturated(int val, int adder) {
   Fixed sum = static_cast<Fixed>(val) + static_cast<Fixed>(adder);
-  if (sum > max_value)
-    return max_value;
-  if (sum < min_value)
-    return min_value;
-  return static_cast<int>(sum);
+  return static_cast<int>(std::max(static_cast<Fixed>(min_value),
+                                   std::min(static_cast<Fixed>(max_value),
+                                            sum)));
 }
 
 // FoldChannels() downmixes multichannel (ie 5.1 Surround Sound) to Stereo.
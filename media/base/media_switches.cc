@@ -26,7 +26,11 @@ const char kUsePulseAudio[] = "use-pulseaudio";
 // Set number of threads to use for video decoding.
 const char kVideoThreads[] = "video-threads";
 
-// Enables browser-side audio mixer.
-const char kEnableAudioMixer[] = "enable-audio-mixer";
+// Restrict video decoding to "frame" or "slice" threading.
+const char kVideoThreadType[] = "video-thread-type";
+
+// Disables the browser-side audio mixer, so that every audio output stream
+// opens its own physical stream.
+const char kDisableAudioMixer[] = "disable-audio-mixer";
 
 }  // namespace switches
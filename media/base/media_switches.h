@@ -26,8 +26,9 @@ MEDIA_EXPORT extern const char kUsePulseAudio[];
 #endif
 
 MEDIA_EXPORT extern const char kVideoThreads[];
+MEDIA_EXPORT extern const char kVideoThreadType[];
 
-MEDIA_EXPORT extern const char kEnableAudioMixer[];
+MEDIA_EXPORT extern const char kDisableAudioMixer[];
 
 }  // namespace switches
 
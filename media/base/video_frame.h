@@ -151,6 +151,9 @@ class MEDIA_EXPORT VideoFrame : public base::RefCountedThreadSafe<VideoFrame> {
   // Array of data pointers to each plane.
   uint8* data_[kMaxPlanes];
 
+  // The memory the planes are in, which |data_| points into.
+  uint8* allocation_;
+
   // Native texture ID, if this is a NATIVE_TEXTURE frame.
   uint32 texture_id_;
   uint32 texture_target_;
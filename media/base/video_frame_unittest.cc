@@ -209,4 +209,27 @@ TEST(VideoFrame, CheckFrameExtents) {
       VideoFrame::YV16,   3, 1, "9bb99ac3ff350644ebff4d28dc01b461");
 }
 
+// YUV frames meet the alignment and padding FFmpeg needs to decode into them.
+TEST(VideoFrame, YUVFramesAreAlignedForDecoding) {
+  const size_t kWidth = 61;
+  const size_t kHeight = 31;
+  const VideoFrame::Format kFormats[] = { VideoFrame::YV12, VideoFrame::YV16 };
+  for (size_t i = 0; i < arraysize(kFormats); ++i) {
+    scoped_refptr<VideoFrame> frame = VideoFrame::CreateFrame(
+        kFormats[i], kWidth, kHeight, base::TimeDelta(), base::TimeDelta());
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(
+        frame->data(VideoFrame::kYPlane)) & 31);
+    EXPECT_EQ(0, frame->stride(VideoFrame::kYPlane) % 32);
+    EXPECT_EQ(0, frame->stride(VideoFrame::kUPlane) % 16);
+    EXPECT_EQ(0, frame->stride(VideoFrame::kVPlane) % 16);
+
+    // The planes leave room for the rows of two whole macroblocks.
+    size_t y_rows = (frame->data(VideoFrame::kUPlane) -
+                     frame->data(VideoFrame::kYPlane)) /
+                    frame->stride(VideoFrame::kYPlane);
+    EXPECT_EQ(32u, y_rows);
+  }
+}
+
 }  // namespace media
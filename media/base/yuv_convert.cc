@@ -17,8 +17,12 @@
 
 #include "media/base/yuv_convert.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/threading/parallel_work.h"
 #include "build/build_config.h"
 #include "media/base/cpu_features.h"
 #include "media/base/simd/convert_rgb_to_yuv.h"
@@ -102,6 +106,142 @@ const int kFractionBits = 16;
 const int kFractionMax = 1 << kFractionBits;
 const int kFractionMask = ((1 << kFractionBits) - 1);
 
+// 4096 allows 3 buffers to fit in 12k.
+// Helps performance on CPU with 16K L1 cache.
+// Large enough for 3830x2160 and 30" displays which are 2560x1600.
+const int kFilterBufferSize = 4096;
+
+// ScaleYUVToRGB32() splits outputs of at least this many pixels into bands of
+// rows scaled on several threads, of at least kMinRowsPerBand rows each.
+const int kMinPixelsForBands = 1280 * 720;
+const int kMinRowsPerBand = 64;
+
+// The arguments ScaleYUVToRGB32() scales each row with, once the rotation
+// has been applied to them.
+struct ScaleRowsParams {
+  const uint8* y_buf;
+  const uint8* u_buf;
+  const uint8* v_buf;
+  uint8* rgb_buf;
+  int source_width;
+  int source_height;
+  int source_dx;
+  int width;
+  int y_pitch;
+  int uv_pitch;
+  int rgb_pitch;
+  unsigned int y_shift;
+  int yscale_fixed;
+  ScaleFilter filter;
+  FilterYUVRowsProc filter_proc;
+  ConvertYUVToRGB32RowProc convert_proc;
+  ScaleYUVToRGB32RowProc scale_proc;
+  ScaleYUVToRGB32RowProc linear_scale_proc;
+};
+
+// Scales the rows of the output from |first_row| up to but not including
+// |end_row|. Each row only depends on the source, so bands of rows can be
+// scaled on different threads at the same time.
+static void ScaleYUVToRGB32Rows(const ScaleRowsParams& params,
+                                int first_row,
+                                int end_row) {
+  const uint8* y_buf = params.y_buf;
+  const uint8* u_buf = params.u_buf;
+  const uint8* v_buf = params.v_buf;
+  int source_width = params.source_width;
+  int source_height = params.source_height;
+  int source_dx = params.source_dx;
+  int width = params.width;
+  int y_pitch = params.y_pitch;
+  int uv_pitch = params.uv_pitch;
+  unsigned int y_shift = params.y_shift;
+  int yscale_fixed = params.yscale_fixed;
+  ScaleFilter filter = params.filter;
+  FilterYUVRowsProc filter_proc = params.filter_proc;
+
+  // Need padding because FilterRows() will write 1 to 16 extra pixels
+  // after the end for SSE2 version.
+  uint8 yuvbuf[16 + kFilterBufferSize * 3 + 16];
+  uint8* ybuf =
+      reinterpret_cast<uint8*>(reinterpret_cast<uintptr_t>(yuvbuf + 15) & ~15);
+  uint8* ubuf = ybuf + kFilterBufferSize;
+  uint8* vbuf = ubuf + kFilterBufferSize;
+
+  // TODO(fbarchard): Split this into separate function for better efficiency.
+  for (int y = first_row; y < end_row; ++y) {
+    uint8* dest_pixel = params.rgb_buf + y * params.rgb_pitch;
+    int source_y_subpixel = (y * yscale_fixed);
+    if (yscale_fixed >= (kFractionMax * 2)) {
+      source_y_subpixel += kFractionMax / 2;  // For 1/2 or less, center filter.
+    }
+    int source_y = source_y_subpixel >> kFractionBits;
+
+    const uint8* y0_ptr = y_buf + source_y * y_pitch;
+    const uint8* y1_ptr = y0_ptr + y_pitch;
+
+    const uint8* u0_ptr = u_buf + (source_y >> y_shift) * uv_pitch;
+    const uint8* u1_ptr = u0_ptr + uv_pitch;
+    const uint8* v0_ptr = v_buf + (source_y >> y_shift) * uv_pitch;
+    const uint8* v1_ptr = v0_ptr + uv_pitch;
+
+    // vertical scaler uses 16.8 fixed point
+    int source_y_fraction = (source_y_subpixel & kFractionMask) >> 8;
+    int source_uv_fraction =
+        ((source_y_subpixel >> y_shift) & kFractionMask) >> 8;
+
+    const uint8* y_ptr = y0_ptr;
+    const uint8* u_ptr = u0_ptr;
+    const uint8* v_ptr = v0_ptr;
+    // Apply vertical filtering if necessary.
+    // TODO(fbarchard): Remove memcpy when not necessary.
+    if (filter & media::FILTER_BILINEAR_V) {
+      if (yscale_fixed != kFractionMax &&
+          source_y_fraction && ((source_y + 1) < source_height)) {
+        filter_proc(ybuf, y0_ptr, y1_ptr, source_width, source_y_fraction);
+      } else {
+        memcpy(ybuf, y0_ptr, source_width);
+      }
+      y_ptr = ybuf;
+      ybuf[source_width] = ybuf[source_width-1];
+      int uv_source_width = (source_width + 1) / 2;
+      if (yscale_fixed != kFractionMax &&
+          source_uv_fraction &&
+          (((source_y >> y_shift) + 1) < (source_height >> y_shift))) {
+        filter_proc(ubuf, u0_ptr, u1_ptr, uv_source_width, source_uv_fraction);
+        filter_proc(vbuf, v0_ptr, v1_ptr, uv_source_width, source_uv_fraction);
+      } else {
+        memcpy(ubuf, u0_ptr, uv_source_width);
+        memcpy(vbuf, v0_ptr, uv_source_width);
+      }
+      u_ptr = ubuf;
+      v_ptr = vbuf;
+      ubuf[uv_source_width] = ubuf[uv_source_width - 1];
+      vbuf[uv_source_width] = vbuf[uv_source_width - 1];
+    }
+    if (source_dx == kFractionMax) {  // Not scaled
+      params.convert_proc(y_ptr, u_ptr, v_ptr, dest_pixel, width);
+    } else {
+      if (filter & FILTER_BILINEAR_H) {
+        params.linear_scale_proc(y_ptr, u_ptr, v_ptr, dest_pixel, width,
+                                 source_dx);
+      } else {
+        params.scale_proc(y_ptr, u_ptr, v_ptr, dest_pixel, width, source_dx);
+      }
+    }
+  }
+}
+
+// Scales band |band| of the |band_count| bands of |height| rows.
+static void ScaleYUVToRGB32Band(const ScaleRowsParams* params,
+                                int height,
+                                int band_count,
+                                int band,
+                                int /* thread */) {
+  ScaleYUVToRGB32Rows(*params, height * band / band_count,
+                      height * (band + 1) / band_count);
+  EmptyRegisterState();
+}
+
 // Scale a frame of YUV to 32 bit ARGB.
 void ScaleYUVToRGB32(const uint8* y_buf,
                      const uint8* u_buf,
@@ -137,10 +277,6 @@ void ScaleYUVToRGB32(const uint8* y_buf,
       width == 0 || height == 0)
     return;
 
-  // 4096 allows 3 buffers to fit in 12k.
-  // Helps performance on CPU with 16K L1 cache.
-  // Large enough for 3830x2160 and 30" displays which are 2560x1600.
-  const int kFilterBufferSize = 4096;
   // Disable filtering if the screen is too big (to avoid buffer overflows).
   // This should never happen to regular users: they don't have monitors
   // wider than 4096 pixels.
@@ -198,79 +334,41 @@ void ScaleYUVToRGB32(const uint8* y_buf,
     }
   }
 
-  // Need padding because FilterRows() will write 1 to 16 extra pixels
-  // after the end for SSE2 version.
-  uint8 yuvbuf[16 + kFilterBufferSize * 3 + 16];
-  uint8* ybuf =
-      reinterpret_cast<uint8*>(reinterpret_cast<uintptr_t>(yuvbuf + 15) & ~15);
-  uint8* ubuf = ybuf + kFilterBufferSize;
-  uint8* vbuf = ubuf + kFilterBufferSize;
+  ScaleRowsParams params;
+  params.y_buf = y_buf;
+  params.u_buf = u_buf;
+  params.v_buf = v_buf;
+  params.rgb_buf = rgb_buf;
+  params.source_width = source_width;
+  params.source_height = source_height;
+  params.source_dx = source_dx;
+  params.width = width;
+  params.y_pitch = y_pitch;
+  params.uv_pitch = uv_pitch;
+  params.rgb_pitch = rgb_pitch;
+  params.y_shift = y_shift;
   // TODO(fbarchard): Fixed point math is off by 1 on negatives.
-  int yscale_fixed = (source_height << kFractionBits) / height;
-
-  // TODO(fbarchard): Split this into separate function for better efficiency.
-  for (int y = 0; y < height; ++y) {
-    uint8* dest_pixel = rgb_buf + y * rgb_pitch;
-    int source_y_subpixel = (y * yscale_fixed);
-    if (yscale_fixed >= (kFractionMax * 2)) {
-      source_y_subpixel += kFractionMax / 2;  // For 1/2 or less, center filter.
-    }
-    int source_y = source_y_subpixel >> kFractionBits;
-
-    const uint8* y0_ptr = y_buf + source_y * y_pitch;
-    const uint8* y1_ptr = y0_ptr + y_pitch;
-
-    const uint8* u0_ptr = u_buf + (source_y >> y_shift) * uv_pitch;
-    const uint8* u1_ptr = u0_ptr + uv_pitch;
-    const uint8* v0_ptr = v_buf + (source_y >> y_shift) * uv_pitch;
-    const uint8* v1_ptr = v0_ptr + uv_pitch;
-
-    // vertical scaler uses 16.8 fixed point
-    int source_y_fraction = (source_y_subpixel & kFractionMask) >> 8;
-    int source_uv_fraction =
-        ((source_y_subpixel >> y_shift) & kFractionMask) >> 8;
-
-    const uint8* y_ptr = y0_ptr;
-    const uint8* u_ptr = u0_ptr;
-    const uint8* v_ptr = v0_ptr;
-    // Apply vertical filtering if necessary.
-    // TODO(fbarchard): Remove memcpy when not necessary.
-    if (filter & media::FILTER_BILINEAR_V) {
-      if (yscale_fixed != kFractionMax &&
-          source_y_fraction && ((source_y + 1) < source_height)) {
-        filter_proc(ybuf, y0_ptr, y1_ptr, source_width, source_y_fraction);
-      } else {
-        memcpy(ybuf, y0_ptr, source_width);
-      }
-      y_ptr = ybuf;
-      ybuf[source_width] = ybuf[source_width-1];
-      int uv_source_width = (source_width + 1) / 2;
-      if (yscale_fixed != kFractionMax &&
-          source_uv_fraction &&
-          (((source_y >> y_shift) + 1) < (source_height >> y_shift))) {
-        filter_proc(ubuf, u0_ptr, u1_ptr, uv_source_width, source_uv_fraction);
-        filter_proc(vbuf, v0_ptr, v1_ptr, uv_source_width, source_uv_fraction);
-      } else {
-        memcpy(ubuf, u0_ptr, uv_source_width);
-        memcpy(vbuf, v0_ptr, uv_source_width);
-      }
-      u_ptr = ubuf;
-      v_ptr = vbuf;
-      ubuf[uv_source_width] = ubuf[uv_source_width - 1];
-      vbuf[uv_source_width] = vbuf[uv_source_width - 1];
-    }
-    if (source_dx == kFractionMax) {  // Not scaled
-      convert_proc(y_ptr, u_ptr, v_ptr, dest_pixel, width);
-    } else {
-      if (filter & FILTER_BILINEAR_H) {
-        linear_scale_proc(y_ptr, u_ptr, v_ptr, dest_pixel, width, source_dx);
-      } else {
-        scale_proc(y_ptr, u_ptr, v_ptr, dest_pixel, width, source_dx);
-      }
-    }
+  params.yscale_fixed = (source_height << kFractionBits) / height;
+  params.filter = filter;
+  params.filter_proc = filter_proc;
+  params.convert_proc = convert_proc;
+  params.scale_proc = scale_proc;
+  params.linear_scale_proc = linear_scale_proc;
+
+  int band_count = 1;
+  if (width * height >= kMinPixelsForBands)
+    band_count = base::ParallelWork::ThreadCount(height / kMinRowsPerBand);
+  if (band_count <= 1) {
+    ScaleYUVToRGB32Rows(params, 0, height);
+    EmptyRegisterState();
+    return;
   }
 
-  EmptyRegisterState();
+  base::ParallelWork::Run(FROM_HERE, band_count, band_count,
+                          base::Bind(&ScaleYUVToRGB32Band,
+                                     base::Unretained(&params), height,
+                                     band_count),
+                          false);
 }
 
 // Scale a frame of YV12 to 32 bit ARGB for a specific rectangle.
@@ -245,6 +245,50 @@ INSTANTIATE_TEST_CASE_P(
         YUVScaleTestData(media::YV12, media::FILTER_BILINEAR, 2086305576u),
         YUVScaleTestData(media::YV16, media::FILTER_BILINEAR, 3857179240u)));
 
+// Frames big enough to be scaled in bands of rows on several threads give
+// the same rows as scaling each row on its own.
+TEST(YUVConvertTest, ScaleLargeFrameInBands) {
+  const int kWidth = 960;
+  const int kHeight = 720;
+  const int kScaledLargeWidth = 1920;
+  const int kRowBytes = kScaledLargeWidth * kBpp;
+  scoped_array<uint8> y_bytes(new uint8[kWidth * kHeight]);
+  scoped_array<uint8> u_bytes(new uint8[kWidth / 2 * kHeight]);
+  scoped_array<uint8> v_bytes(new uint8[kWidth / 2 * kHeight]);
+  for (int i = 0; i < kWidth * kHeight; ++i)
+    y_bytes[i] = static_cast<uint8>(i * 7 % 251);
+  for (int i = 0; i < kWidth / 2 * kHeight; ++i) {
+    u_bytes[i] = static_cast<uint8>(i * 13 % 241);
+    v_bytes[i] = static_cast<uint8>(i * 17 % 239);
+  }
+
+  // YV16 has full height chroma, so each output row only reads one row of
+  // each plane when the height is not scaled.
+  scoped_array<uint8> rgb_bytes(new uint8[kRowBytes * kHeight]);
+  media::ScaleYUVToRGB32(y_bytes.get(), u_bytes.get(), v_bytes.get(),
+                         rgb_bytes.get(),
+                         kWidth, kHeight,
+                         kScaledLargeWidth, kHeight,
+                         kWidth, kWidth / 2, kRowBytes,
+                         media::YV16, media::ROTATE_0,
+                         media::FILTER_BILINEAR);
+
+  scoped_array<uint8> rgb_row(new uint8[kRowBytes]);
+  for (int y = 0; y < kHeight; ++y) {
+    media::ScaleYUVToRGB32(y_bytes.get() + y * kWidth,
+                           u_bytes.get() + y * kWidth / 2,
+                           v_bytes.get() + y * kWidth / 2,
+                           rgb_row.get(),
+                           kWidth, 1,
+                           kScaledLargeWidth, 1,
+                           kWidth, kWidth / 2, kRowBytes,
+                           media::YV16, media::ROTATE_0,
+                           media::FILTER_BILINEAR);
+    ASSERT_EQ(0, memcmp(rgb_row.get(), rgb_bytes.get() + y * kRowBytes,
+                        kRowBytes)) << "row " << y;
+  }
+}
+
 // This tests a known worst case YUV value, and for overflow.
 TEST(YUVConvertTest, Clamp) {
   // Allocate all surfaces.
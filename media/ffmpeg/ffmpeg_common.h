@@ -24,6 +24,7 @@ MSVC_PUSH_DISABLE_WARNING(4244);
 #include <libavformat/avio.h>
 #include <libavformat/url.h>
 #include <libavutil/avutil.h>
+#include <libavutil/imgutils.h>
 #include <libavutil/mathematics.h>
 #include <libavutil/log.h>
 MSVC_POP_WARNING();
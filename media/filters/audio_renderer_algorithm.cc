@@ -117,21 +117,22 @@ int AudioRendererAlgorithm::FillBuffer(
     if (index_into_window_ == window_size_)
       ResetWindow();
 
-    bool rendered_frame = true;
+    int frames_left = requested_frames - total_frames_rendered;
+    int frames_rendered = 0;
     if (playback_rate_ > 1.0)
-      rendered_frame = OutputFasterPlayback(output_ptr);
+      frames_rendered = OutputFasterPlayback(output_ptr, frames_left);
     else if (playback_rate_ < 1.0)
-      rendered_frame = OutputSlowerPlayback(output_ptr);
+      frames_rendered = OutputSlowerPlayback(output_ptr, frames_left);
     else
-      rendered_frame = OutputNormalPlayback(output_ptr);
+      frames_rendered = OutputNormalPlayback(output_ptr, frames_left);
 
-    if (!rendered_frame) {
+    if (frames_rendered == 0) {
       needs_more_data_ = true;
       break;
     }
 
-    output_ptr += bytes_per_frame_;
-    total_frames_rendered++;
+    output_ptr += frames_rendered * bytes_per_frame_;
+    total_frames_rendered += frames_rendered;
   }
   return total_frames_rendered;
 }
@@ -142,12 +143,13 @@ void AudioRendererAlgorithm::ResetWindow() {
   crossfade_frame_number_ = 0;
 }
 
-bool AudioRendererAlgorithm::OutputFasterPlayback(uint8* dest) {
+int AudioRendererAlgorithm::OutputFasterPlayback(uint8* dest,
+                                                 int requested_frames) {
   DCHECK_LT(index_into_window_, window_size_);
   DCHECK_GT(playback_rate_, 1.0);
 
   if (audio_buffer_.forward_bytes() < bytes_per_frame_)
-    return false;
+    return 0;
 
   // The audio data is output in a series of windows. For sped-up playback,
   // the window is comprised of the following phases:
@@ -179,65 +181,67 @@ bool AudioRendererAlgorithm::OutputFasterPlayback(uint8* dest) {
   // which point the window restarts.
   int intro_crossfade_begin = input_step - bytes_to_crossfade;
 
-  // a) Output a raw frame if we haven't reached the crossfade section.
+  // a) Output raw frames if we haven't reached the crossfade section.
   if (index_into_window_ < outtro_crossfade_begin) {
-    CopyWithAdvance(dest);
-    index_into_window_ += bytes_per_frame_;
-    return true;
+    int frames = FramesInPhase(outtro_crossfade_begin, 0, requested_frames);
+    CopyWithAdvance(dest, frames);
+    index_into_window_ += frames * bytes_per_frame_;
+    return frames;
   }
 
   // b) Save outtro crossfade frames into intermediate buffer, but do not output
   //    anything to |dest|.
-  while (index_into_window_ < outtro_crossfade_end) {
-    if (audio_buffer_.forward_bytes() < bytes_per_frame_)
-      return false;
-
+  if (index_into_window_ < outtro_crossfade_end) {
     // This phase only applies if there are bytes to crossfade.
     DCHECK_GT(bytes_to_crossfade, 0);
+    int frames = FramesInPhase(outtro_crossfade_end, 0, kint32max);
     uint8* place_to_copy = crossfade_buffer_.get() +
         (index_into_window_ - outtro_crossfade_begin);
-    CopyWithAdvance(place_to_copy);
-    index_into_window_ += bytes_per_frame_;
+    CopyWithAdvance(place_to_copy, frames);
+    index_into_window_ += frames * bytes_per_frame_;
+    if (index_into_window_ < outtro_crossfade_end)
+      return 0;
   }
 
   // c) Drop frames until we reach the intro crossfade section.
-  while (index_into_window_ < intro_crossfade_begin) {
-    if (audio_buffer_.forward_bytes() < bytes_per_frame_)
-      return false;
-
-    DropFrame();
-    index_into_window_ += bytes_per_frame_;
+  if (index_into_window_ < intro_crossfade_begin) {
+    int frames = FramesInPhase(intro_crossfade_begin, 0, kint32max);
+    DropFrames(frames);
+    index_into_window_ += frames * bytes_per_frame_;
+    if (index_into_window_ < intro_crossfade_begin)
+      return 0;
   }
 
   // Return if we have run out of data after Phase c).
   if (audio_buffer_.forward_bytes() < bytes_per_frame_)
-    return false;
+    return 0;
 
   // Phase d) doesn't apply if there are no bytes to crossfade.
   if (bytes_to_crossfade == 0) {
     DCHECK_EQ(index_into_window_, window_size_);
-    return false;
+    return 0;
   }
 
-  // d) Crossfade and output a frame.
+  // d) Crossfade and output frames. The intro is read straight into |dest|
+  //    and crossfaded there with the saved outtro.
   DCHECK_LT(index_into_window_, window_size_);
+  int frames = FramesInPhase(window_size_, 0, requested_frames);
   int offset_into_buffer = index_into_window_ - intro_crossfade_begin;
-  memcpy(dest, crossfade_buffer_.get() + offset_into_buffer,
-         bytes_per_frame_);
-  scoped_array<uint8> intro_frame_ptr(new uint8[bytes_per_frame_]);
-  audio_buffer_.Read(intro_frame_ptr.get(), bytes_per_frame_);
-  OutputCrossfadedFrame(dest, intro_frame_ptr.get());
-  index_into_window_ += bytes_per_frame_;
-  return true;
+  CopyWithAdvance(dest, frames);
+  CrossfadeFrames(crossfade_buffer_.get() + offset_into_buffer, dest, dest,
+                  frames);
+  index_into_window_ += frames * bytes_per_frame_;
+  return frames;
 }
 
-bool AudioRendererAlgorithm::OutputSlowerPlayback(uint8* dest) {
+int AudioRendererAlgorithm::OutputSlowerPlayback(uint8* dest,
+                                                 int requested_frames) {
   DCHECK_LT(index_into_window_, window_size_);
   DCHECK_LT(playback_rate_, 1.0);
   DCHECK_NE(playback_rate_, 0.0);
 
   if (audio_buffer_.forward_bytes() < bytes_per_frame_)
-    return false;
+    return 0;
 
   // The audio data is output in a series of windows. For slowed down playback,
   // the window is comprised of the following phases:
@@ -272,97 +276,111 @@ bool AudioRendererAlgorithm::OutputSlowerPlayback(uint8* dest) {
   // which point the window restarts.
   int outtro_crossfade_begin = output_step - bytes_to_crossfade;
 
-  // a) Output a raw frame.
+  // a) Output raw frames.
   if (index_into_window_ < intro_crossfade_begin) {
-    CopyWithAdvance(dest);
-    index_into_window_ += bytes_per_frame_;
-    return true;
+    int frames = FramesInPhase(intro_crossfade_begin, 0, requested_frames);
+    CopyWithAdvance(dest, frames);
+    index_into_window_ += frames * bytes_per_frame_;
+    return frames;
   }
 
-  // b) Save the raw frame for the intro crossfade section, then output the
-  //    frame to |dest|.
+  // b) Output raw frames to |dest|, and save them for the intro crossfade
+  //    section.
   if (index_into_window_ < intro_crossfade_end) {
+    int frames = FramesInPhase(intro_crossfade_end, 0, requested_frames);
     int offset = index_into_window_ - intro_crossfade_begin;
-    uint8* place_to_copy = crossfade_buffer_.get() + offset;
-    CopyWithoutAdvance(place_to_copy);
-    CopyWithAdvance(dest);
-    index_into_window_ += bytes_per_frame_;
-    return true;
+    CopyWithAdvance(dest, frames);
+    memcpy(crossfade_buffer_.get() + offset, dest, frames * bytes_per_frame_);
+    index_into_window_ += frames * bytes_per_frame_;
+    return frames;
   }
 
   int audio_buffer_offset = index_into_window_ - intro_crossfade_end;
 
   if (audio_buffer_.forward_bytes() < audio_buffer_offset + bytes_per_frame_)
-    return false;
+    return 0;
 
-  // c) Output a raw frame into |dest| without advancing the |audio_buffer_|
+  // c) Output raw frames into |dest| without advancing the |audio_buffer_|
   //    cursor. See function-level comment.
   DCHECK_GE(index_into_window_, intro_crossfade_end);
-  CopyWithoutAdvance(dest, audio_buffer_offset);
-
-  // d) Crossfade the next frame of |crossfade_buffer_| into |dest| if we've
-  //    reached the outtro crossfade section of the window.
-  if (index_into_window_ >= outtro_crossfade_begin) {
-    int offset_into_crossfade_buffer =
-        index_into_window_ - outtro_crossfade_begin;
-    uint8* intro_frame_ptr =
-        crossfade_buffer_.get() + offset_into_crossfade_buffer;
-    OutputCrossfadedFrame(dest, intro_frame_ptr);
+  if (index_into_window_ < outtro_crossfade_begin) {
+    int frames = FramesInPhase(outtro_crossfade_begin, audio_buffer_offset,
+                               requested_frames);
+    CopyWithoutAdvance(dest, frames, audio_buffer_offset);
+    index_into_window_ += frames * bytes_per_frame_;
+    return frames;
   }
 
-  index_into_window_ += bytes_per_frame_;
-  return true;
+  // d) Crossfade the next frames of |crossfade_buffer_| into the raw frames in
+  //    |dest|, since we've reached the outtro crossfade section of the window.
+  int frames = FramesInPhase(window_size_, audio_buffer_offset,
+                             requested_frames);
+  CopyWithoutAdvance(dest, frames, audio_buffer_offset);
+  int offset_into_crossfade_buffer =
+      index_into_window_ - outtro_crossfade_begin;
+  CrossfadeFrames(dest, crossfade_buffer_.get() + offset_into_crossfade_buffer,
+                  dest, frames);
+  index_into_window_ += frames * bytes_per_frame_;
+  return frames;
 }
 
-bool AudioRendererAlgorithm::OutputNormalPlayback(uint8* dest) {
-  if (audio_buffer_.forward_bytes() >= bytes_per_frame_) {
-    CopyWithAdvance(dest);
-    index_into_window_ += bytes_per_frame_;
-    return true;
-  }
-  return false;
+int AudioRendererAlgorithm::OutputNormalPlayback(uint8* dest,
+                                                 int requested_frames) {
+  // Runs end with the window, like those of the other rates, so that
+  // |index_into_window_| stays within it.
+  int frames = FramesInPhase(window_size_, 0, requested_frames);
+  CopyWithAdvance(dest, frames);
+  index_into_window_ += frames * bytes_per_frame_;
+  return frames;
 }
 
-void AudioRendererAlgorithm::CopyWithAdvance(uint8* dest) {
-  CopyWithoutAdvance(dest);
-  DropFrame();
+int AudioRendererAlgorithm::FramesInPhase(int phase_end,
+                                          int buffer_offset,
+                                          int max_frames) {
+  DCHECK_LT(index_into_window_, phase_end);
+  int frames_in_phase = (phase_end - index_into_window_) / bytes_per_frame_;
+  int frames_buffered =
+      (audio_buffer_.forward_bytes() - buffer_offset) / bytes_per_frame_;
+  return std::min(std::min(frames_in_phase, frames_buffered), max_frames);
 }
 
-void AudioRendererAlgorithm::CopyWithoutAdvance(uint8* dest) {
-  CopyWithoutAdvance(dest, 0);
+void AudioRendererAlgorithm::CopyWithAdvance(uint8* dest, int frames) {
+  CopyWithoutAdvance(dest, frames, 0);
+  DropFrames(frames);
 }
 
 void AudioRendererAlgorithm::CopyWithoutAdvance(
-    uint8* dest, int offset) {
+    uint8* dest, int frames, int offset) {
+  int bytes = frames * bytes_per_frame_;
   if (muted_) {
-    memset(dest, 0, bytes_per_frame_);
+    memset(dest, 0, bytes);
     return;
   }
-  int copied = audio_buffer_.Peek(dest, bytes_per_frame_, offset);
-  DCHECK_EQ(bytes_per_frame_, copied);
+  int copied = audio_buffer_.Peek(dest, bytes, offset);
+  DCHECK_EQ(bytes, copied);
 }
 
-void AudioRendererAlgorithm::DropFrame() {
-  audio_buffer_.Seek(bytes_per_frame_);
+void AudioRendererAlgorithm::DropFrames(int frames) {
+  audio_buffer_.Seek(frames * bytes_per_frame_);
 
   if (!IsQueueFull())
     request_read_cb_.Run();
 }
 
-void AudioRendererAlgorithm::OutputCrossfadedFrame(
-    uint8* outtro, const uint8* intro) {
-  DCHECK_LE(index_into_window_, window_size_);
+void AudioRendererAlgorithm::CrossfadeFrames(
+    const uint8* outtro, const uint8* intro, uint8* dest, int frames) {
+  DCHECK_LE(index_into_window_ + frames * bytes_per_frame_, window_size_);
   DCHECK(!muted_);
 
   switch (bytes_per_channel_) {
     case 4:
-      CrossfadeFrame<int32>(outtro, intro);
+      CrossfadeFrames<int32>(outtro, intro, dest, frames);
       break;
     case 2:
-      CrossfadeFrame<int16>(outtro, intro);
+      CrossfadeFrames<int16>(outtro, intro, dest, frames);
       break;
     case 1:
-      CrossfadeFrame<uint8>(outtro, intro);
+      CrossfadeFrames<uint8>(outtro, intro, dest, frames);
       break;
     default:
       NOTREACHED() << "Unsupported audio bit depth in crossfade.";
@@ -370,19 +388,27 @@ void AudioRendererAlgorithm::OutputCrossfadedFrame(
 }
 
 template <class Type>
-void AudioRendererAlgorithm::CrossfadeFrame(
-    uint8* outtro_bytes, const uint8* intro_bytes) {
-  Type* outtro = reinterpret_cast<Type*>(outtro_bytes);
+void AudioRendererAlgorithm::CrossfadeFrames(
+    const uint8* outtro_bytes, const uint8* intro_bytes, uint8* dest_bytes,
+    int frames) {
+  const Type* outtro = reinterpret_cast<const Type*>(outtro_bytes);
   const Type* intro = reinterpret_cast<const Type*>(intro_bytes);
-
-  int frames_in_crossfade = bytes_in_crossfade_ / bytes_per_frame_;
-  float crossfade_ratio =
-      static_cast<float>(crossfade_frame_number_) / frames_in_crossfade;
-  for (int channel = 0; channel < channels_; ++channel) {
-    *outtro *= 1.0 - crossfade_ratio;
-    *outtro++ += (*intro++) * crossfade_ratio;
+  Type* dest = reinterpret_cast<Type*>(dest_bytes);
+
+  // The ratio steps once per frame; the channels of a frame share it. Each
+  // sample is read before it is written, so |dest| may be |outtro| or
+  // |intro|. Samples are rounded to the nearest value, so that crossfading
+  // equal samples leaves them unchanged.
+  float frames_in_crossfade = bytes_in_crossfade_ / bytes_per_frame_;
+  for (int frame = 0; frame < frames; ++frame) {
+    float crossfade_ratio = crossfade_frame_number_ / frames_in_crossfade;
+    float outtro_ratio = 1.0f - crossfade_ratio;
+    for (int channel = 0; channel < channels_; ++channel) {
+      float sample = *outtro++ * outtro_ratio + *intro++ * crossfade_ratio;
+      *dest++ = static_cast<Type>(sample < 0 ? sample - 0.5f : sample + 0.5f);
+    }
+    crossfade_frame_number_++;
   }
-  crossfade_frame_number_++;
 }
 
 void AudioRendererAlgorithm::SetPlaybackRate(float new_rate) {
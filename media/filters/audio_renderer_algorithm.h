@@ -102,22 +102,24 @@ class MEDIA_EXPORT AudioRendererAlgorithm {
   // Returns true if |audio_buffer_| is empty.
   bool IsQueueEmpty();
 
-  // Fills |dest| with one frame of audio data at normal speed. Returns true if
-  // a frame was rendered, false otherwise.
-  bool OutputNormalPlayback(uint8* dest);
+  // Fills |dest| with up to |requested_frames| frames of audio data at normal
+  // speed. Returns the number of frames rendered, 0 if more data is needed.
+  int OutputNormalPlayback(uint8* dest, int requested_frames);
 
-  // Fills |dest| with one frame of audio data at faster than normal speed.
-  // Returns true if a frame was rendered, false otherwise.
+  // Fills |dest| with up to |requested_frames| frames of audio data at faster
+  // than normal speed. Returns the number of frames rendered, 0 if more data
+  // is needed.
   //
   // When the audio playback is > 1.0, we use a variant of Overlap-Add to squish
   // audio output while preserving pitch. Essentially, we play a bit of audio
   // data at normal speed, then we "fast forward" by dropping the next bit of
   // audio data, and then we stich the pieces together by crossfading from one
   // audio chunk to the next.
-  bool OutputFasterPlayback(uint8* dest);
+  int OutputFasterPlayback(uint8* dest, int requested_frames);
 
-  // Fills |dest| with one frame of audio data at slower than normal speed.
-  // Returns true if a frame was rendered, false otherwise.
+  // Fills |dest| with up to |requested_frames| frames of audio data at slower
+  // than normal speed. Returns the number of frames rendered, 0 if more data
+  // is needed.
   //
   // When the audio playback is < 1.0, we use a variant of Overlap-Add to
   // stretch audio output while preserving pitch. This works by outputting a
@@ -125,29 +127,40 @@ class MEDIA_EXPORT AudioRendererAlgorithm {
   // by repeating some of the audio data from the previous audio segment.
   // Segments are stiched together by crossfading from one audio chunk to the
   // next.
-  bool OutputSlowerPlayback(uint8* dest);
+  int OutputSlowerPlayback(uint8* dest, int requested_frames);
+
+  // Each of the Output*Playback() methods above works on whole runs of frames
+  // within one phase of the window, rather than on a frame at a time.
 
   // Resets the window state to the start of a new window.
   void ResetWindow();
 
-  // Copies a raw frame from |audio_buffer_| into |dest| without progressing
-  // |audio_buffer_|'s internal "current" cursor. Optionally peeks at a forward
-  // byte |offset|.
-  void CopyWithoutAdvance(uint8* dest);
-  void CopyWithoutAdvance(uint8* dest, int offset);
-
-  // Copies a raw frame from |audio_buffer_| into |dest| and progresses the
-  // |audio_buffer_| forward.
-  void CopyWithAdvance(uint8* dest);
-
-  // Moves the |audio_buffer_| forward by one frame.
-  void DropFrame();
-
-  // Does a linear crossfade from |intro| into |outtro| for one frame.
-  // Assumes pointers are valid and are at least size of |bytes_per_frame_|.
-  void OutputCrossfadedFrame(uint8* outtro, const uint8* intro);
+  // Returns how many frames there are from |index_into_window_| to
+  // |phase_end|, limited to the frames in |audio_buffer_| after
+  // |buffer_offset| bytes and to |max_frames|.
+  int FramesInPhase(int phase_end, int buffer_offset, int max_frames);
+
+  // Copies |frames| raw frames from |audio_buffer_| into |dest| without
+  // progressing |audio_buffer_|'s internal "current" cursor, starting
+  // |offset| bytes ahead of it.
+  void CopyWithoutAdvance(uint8* dest, int frames, int offset);
+
+  // Copies |frames| raw frames from |audio_buffer_| into |dest| and progresses
+  // the |audio_buffer_| forward.
+  void CopyWithAdvance(uint8* dest, int frames);
+
+  // Moves the |audio_buffer_| forward by |frames| frames.
+  void DropFrames(int frames);
+
+  // Does a linear crossfade from |outtro| into |intro| for |frames| frames,
+  // continuing from |crossfade_frame_number_|, and writes it to |dest|, which
+  // may be either of them. Assumes pointers are valid and are at least
+  // |frames| * |bytes_per_frame_| long.
+  void CrossfadeFrames(const uint8* outtro, const uint8* intro, uint8* dest,
+                       int frames);
   template <class Type>
-  void CrossfadeFrame(uint8* outtro, const uint8* intro);
+  void CrossfadeFrames(const uint8* outtro, const uint8* intro, uint8* dest,
+                       int frames);
 
   // Rounds |*value| down to the nearest frame boundary.
   void AlignToFrameBoundary(int* value);
@@ -8,7 +8,9 @@
 // correct rate.  We always pass in a very large destination buffer with the
 // expectation that FillBuffer() will fill as much as it can but no more.
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback.h"
@@ -26,7 +28,8 @@ namespace media {
 class AudioRendererAlgorithmTest : public testing::Test {
  public:
   AudioRendererAlgorithmTest()
-      : bytes_enqueued_(0) {
+      : bytes_enqueued_(0),
+        fake_data_value_(0) {
   }
 
   ~AudioRendererAlgorithmTest() {}
@@ -44,11 +47,16 @@ class AudioRendererAlgorithmTest : public testing::Test {
   }
 
   void EnqueueData() {
+    EnqueueDataInto(&algorithm_);
+    bytes_enqueued_ += kRawDataSize;
+  }
+
+  void EnqueueDataInto(AudioRendererAlgorithm* algorithm) {
     scoped_array<uint8> audio_data(new uint8[kRawDataSize]);
-    CHECK_EQ(kRawDataSize % algorithm_.bytes_per_channel(), 0u);
-    CHECK_EQ(kRawDataSize % algorithm_.bytes_per_frame(), 0u);
-    size_t length = kRawDataSize / algorithm_.bytes_per_channel();
-    switch (algorithm_.bytes_per_channel()) {
+    CHECK_EQ(kRawDataSize % algorithm->bytes_per_channel(), 0u);
+    CHECK_EQ(kRawDataSize % algorithm->bytes_per_frame(), 0u);
+    size_t length = kRawDataSize / algorithm->bytes_per_channel();
+    switch (algorithm->bytes_per_channel()) {
       case 4:
         WriteFakeData<int32>(audio_data.get(), length);
         break;
@@ -61,13 +69,16 @@ class AudioRendererAlgorithmTest : public testing::Test {
       default:
         NOTREACHED() << "Unsupported audio bit depth in crossfade.";
     }
-    algorithm_.EnqueueBuffer(new DataBuffer(audio_data.Pass(), kRawDataSize));
-    bytes_enqueued_ += kRawDataSize;
+    algorithm->EnqueueBuffer(new DataBuffer(audio_data.Pass(), kRawDataSize));
   }
 
   template <class Type>
   void WriteFakeData(uint8* audio_data, size_t length) {
     Type* output = reinterpret_cast<Type*>(audio_data);
+    if (fake_data_value_) {
+      std::fill(output, output + length, static_cast<Type>(fake_data_value_));
+      return;
+    }
     for (size_t i = 0; i < length; i++) {
       // The value of the data is meaningless; we just want non-zero data to
       // differentiate it from muted data.
@@ -178,9 +189,68 @@ class AudioRendererAlgorithmTest : public testing::Test {
     EXPECT_LE(delta, kMaxAcceptableDelta);
   }
 
+  // Renders |total_frames| frames at |playback_rate| with a new algorithm,
+  // asking for |frames_per_request| frames at a time, into |output|.
+  void Render(int channels, int bits_per_channel, double playback_rate,
+              int frames_per_request, int total_frames,
+              std::vector<uint8>* output) {
+    AudioRendererAlgorithm algorithm;
+    algorithm.Initialize(
+        channels, kSamplesPerSecond, bits_per_channel,
+        static_cast<float>(playback_rate),
+        base::Bind(&AudioRendererAlgorithmTest::EnqueueDataInto,
+                   base::Unretained(this), &algorithm));
+    EnqueueDataInto(&algorithm);
+
+    output->assign(total_frames * algorithm.bytes_per_frame(), 0);
+    int frames_rendered = 0;
+    while (frames_rendered < total_frames) {
+      int frames_written = algorithm.FillBuffer(
+          &(*output)[frames_rendered * algorithm.bytes_per_frame()],
+          std::min(frames_per_request, total_frames - frames_rendered));
+      CHECK_GT(frames_written, 0);
+      frames_rendered += frames_written;
+    }
+  }
+
+  // Checks that rendering in runs of frames gives the same output as
+  // rendering a frame at a time.
+  void TestRunsMatchSingleFrames(int channels, int bits_per_channel,
+                                 double playback_rate) {
+    static const int kFrames = kSamplesPerSecond;
+    std::vector<uint8> single_frames;
+    Render(channels, bits_per_channel, playback_rate, 1, kFrames,
+           &single_frames);
+    std::vector<uint8> runs;
+    Render(channels, bits_per_channel, playback_rate, kFrames, kFrames,
+           &runs);
+    EXPECT_TRUE(single_frames == runs) << "playback rate " << playback_rate;
+  }
+
+  // Checks that audio of a single value keeps that value through the
+  // crossfades at |playback_rate|.
+  template <class Type>
+  void TestConstantData(int channels, Type value, double playback_rate) {
+    static const int kFrames = kSamplesPerSecond;
+    fake_data_value_ = value;
+    std::vector<uint8> output;
+    Render(channels, 8 * sizeof(Type), playback_rate, kFrames, kFrames,
+           &output);
+    const Type* samples = reinterpret_cast<const Type*>(&output[0]);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < output.size() / sizeof(Type); ++i) {
+      if (samples[i] != value)
+        ++mismatches;
+    }
+    EXPECT_EQ(0u, mismatches) << "playback rate " << playback_rate;
+  }
+
  protected:
   AudioRendererAlgorithm algorithm_;
   int bytes_enqueued_;
+
+  // If non-zero, the value of every sample of fake data.
+  int fake_data_value_;
 };
 
 TEST_F(AudioRendererAlgorithmTest, FillBuffer_NormalRate) {
@@ -284,4 +354,26 @@ TEST_F(AudioRendererAlgorithmTest, FillBuffer_HigherQualityAudio) {
   TestPlaybackRate(1.5);
 }
 
+// Each playback method renders whole runs of frames at a time. The output
+// must not depend on how many frames FillBuffer() is asked for.
+TEST_F(AudioRendererAlgorithmTest, FillBuffer_RunsMatchSingleFrames) {
+  TestRunsMatchSingleFrames(kDefaultChannels, kDefaultSampleBits, 1.0);
+  TestRunsMatchSingleFrames(kDefaultChannels, kDefaultSampleBits, 0.5);
+  TestRunsMatchSingleFrames(kDefaultChannels, kDefaultSampleBits, 0.75);
+  TestRunsMatchSingleFrames(kDefaultChannels, kDefaultSampleBits, 1.5);
+  TestRunsMatchSingleFrames(kDefaultChannels, kDefaultSampleBits, 2.0);
+  TestRunsMatchSingleFrames(1, 8, 1.5);
+  TestRunsMatchSingleFrames(2, 32, 0.5);
+}
+
+TEST_F(AudioRendererAlgorithmTest, FillBuffer_CrossfadeKeepsConstantData) {
+  TestConstantData<int16>(kDefaultChannels, 1000, 0.5);
+  TestConstantData<int16>(kDefaultChannels, 1000, 1.5);
+  TestConstantData<int16>(kDefaultChannels, -1000, 1.5);
+  TestConstantData<uint8>(1, 200, 0.5);
+  TestConstantData<uint8>(1, 200, 1.5);
+  TestConstantData<int32>(kDefaultChannels, -100000, 0.75);
+  TestConstantData<int32>(kDefaultChannels, 100000, 2.0);
+}
+
 }  // namespace media
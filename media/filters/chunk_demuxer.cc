@@ -18,6 +18,9 @@ namespace media {
 // TODO(acolwell): Remove this when fixing http://crbug.com/122909 .
 const char* kDefaultSourceType = "video/webm; codecs=\"vp8, vorbis\"";
 
+// The default for ChunkDemuxer::SetMemoryLimit().
+static const int64 kDefaultMemoryLimit = 150 * 1024 * 1024;
+
 class ChunkDemuxerStream : public DemuxerStream {
  public:
   typedef std::deque<scoped_refptr<StreamParserBuffer> > BufferQueue;
@@ -46,6 +49,10 @@ class ChunkDemuxerStream : public DemuxerStream {
 
   bool GetLastBufferTimestamp(base::TimeDelta* timestamp) const;
 
+  // Returns the size of the data in the buffers that have been added but not
+  // yet read.
+  int64 GetQueuedBytes() const;
+
   // DemuxerStream methods.
   virtual void Read(const ReadCB& read_cb) OVERRIDE;
   virtual Type type() OVERRIDE;
@@ -74,6 +81,9 @@ class ChunkDemuxerStream : public DemuxerStream {
   // |buffers_| and pops the callbacks & buffers from the respecive queues.
   void CreateReadDoneClosures_Locked(ClosureQueue* closures);
 
+  // Removes the first buffer in |buffers_| and returns it.
+  scoped_refptr<StreamParserBuffer> PopBuffer_Locked();
+
   Type type_;
   AudioDecoderConfig audio_config_;
   VideoDecoderConfig video_config_;
@@ -83,6 +93,9 @@ class ChunkDemuxerStream : public DemuxerStream {
   ReadCBQueue read_cbs_;
   BufferQueue buffers_;
 
+  // The size of the data in |buffers_|.
+  int64 queued_bytes_;
+
   // Keeps track of the timestamp of the last buffer we have
   // added to |buffers_|. This is used to enforce buffers with strictly
   // monotonically increasing timestamps.
@@ -94,6 +107,7 @@ class ChunkDemuxerStream : public DemuxerStream {
 ChunkDemuxerStream::ChunkDemuxerStream(const AudioDecoderConfig& audio_config)
     : type_(AUDIO),
       state_(RETURNING_DATA_FOR_READS),
+      queued_bytes_(0),
       last_buffer_timestamp_(kNoTimestamp()) {
   audio_config_.CopyFrom(audio_config);
 }
@@ -102,6 +116,7 @@ ChunkDemuxerStream::ChunkDemuxerStream(const AudioDecoderConfig& audio_config)
 ChunkDemuxerStream::ChunkDemuxerStream(const VideoDecoderConfig& video_config)
     : type_(VIDEO),
       state_(RETURNING_DATA_FOR_READS),
+      queued_bytes_(0),
       last_buffer_timestamp_(kNoTimestamp()) {
   video_config_.CopyFrom(video_config);
 }
@@ -114,6 +129,7 @@ void ChunkDemuxerStream::Flush() {
   {
     base::AutoLock auto_lock(lock_);
     buffers_.clear();
+    queued_bytes_ = 0;
     ChangeState_Locked(WAITING_FOR_SEEK);
     last_buffer_timestamp_ = kNoTimestamp();
 
@@ -184,6 +200,7 @@ void ChunkDemuxerStream::AddBuffers(const BufferQueue& buffers) {
 
         last_buffer_timestamp_ = current_ts;
         buffers_.push_back(*itr);
+        queued_bytes_ += (*itr)->GetDataSize();
       }
     }
 
@@ -202,6 +219,7 @@ void ChunkDemuxerStream::Shutdown() {
 
     std::swap(read_cbs_, read_cbs);
     buffers_.clear();
+    queued_bytes_ = 0;
   }
 
   // Pass end of stream buffers to all callbacks to signal that no more data
@@ -238,6 +256,11 @@ bool ChunkDemuxerStream::GetLastBufferTimestamp(
   return true;
 }
 
+int64 ChunkDemuxerStream::GetQueuedBytes() const {
+  base::AutoLock auto_lock(lock_);
+  return queued_bytes_;
+}
+
 // Helper function that makes sure |read_cb| runs on |message_loop|.
 static void RunOnMessageLoop(const DemuxerStream::ReadCB& read_cb,
                              MessageLoop* message_loop,
@@ -267,8 +290,7 @@ void ChunkDemuxerStream::Read(const ReadCB& read_cb) {
           return;
         }
 
-        buffer = buffers_.front();
-        buffers_.pop_front();
+        buffer = PopBuffer_Locked();
         break;
 
       case WAITING_FOR_SEEK:
@@ -285,8 +307,7 @@ void ChunkDemuxerStream::Read(const ReadCB& read_cb) {
           ChangeState_Locked(RETURNING_EOS_FOR_READS);
           buffer = StreamParserBuffer::CreateEOSBuffer();
         } else {
-          buffer = buffers_.front();
-          buffers_.pop_front();
+          buffer = PopBuffer_Locked();
         }
         break;
 
@@ -335,8 +356,7 @@ void ChunkDemuxerStream::CreateReadDoneClosures_Locked(ClosureQueue* closures) {
     return;
 
   while (!buffers_.empty() && !read_cbs_.empty()) {
-    closures->push_back(base::Bind(read_cbs_.front(), buffers_.front()));
-    buffers_.pop_front();
+    closures->push_back(base::Bind(read_cbs_.front(), PopBuffer_Locked()));
     read_cbs_.pop_front();
   }
 
@@ -354,11 +374,22 @@ void ChunkDemuxerStream::CreateReadDoneClosures_Locked(ClosureQueue* closures) {
   ChangeState_Locked(RETURNING_EOS_FOR_READS);
 }
 
+scoped_refptr<StreamParserBuffer> ChunkDemuxerStream::PopBuffer_Locked() {
+  lock_.AssertAcquired();
+  DCHECK(!buffers_.empty());
+  scoped_refptr<StreamParserBuffer> buffer = buffers_.front();
+  buffers_.pop_front();
+  queued_bytes_ -= buffer->GetDataSize();
+  DCHECK_GE(queued_bytes_, 0);
+  return buffer;
+}
+
 ChunkDemuxer::ChunkDemuxer(ChunkDemuxerClient* client)
     : state_(WAITING_FOR_INIT),
       host_(NULL),
       client_(client),
       buffered_bytes_(0),
+      memory_limit_(kDefaultMemoryLimit),
       seek_waits_for_data_(true) {
   DCHECK(client);
 }
@@ -537,9 +568,9 @@ bool ChunkDemuxer::GetBufferedRanges(const std::string& id,
   return true;
 }
 
-bool ChunkDemuxer::AppendData(const std::string& id,
-                              const uint8* data,
-                              size_t length) {
+ChunkDemuxer::AppendStatus ChunkDemuxer::AppendData(const std::string& id,
+                                                     const uint8* data,
+                                                     size_t length) {
   DVLOG(1) << "AppendData(" << id << ", " << length << ")";
 
   // TODO(acolwell): Remove when http://webk.it/83788 fix lands.
@@ -569,14 +600,23 @@ bool ChunkDemuxer::AppendData(const std::string& id,
         if (!source_buffer_->AppendData(data, length)) {
           DCHECK_EQ(state_, INITIALIZING);
           ReportError_Locked(DEMUXER_ERROR_COULD_NOT_OPEN);
-          return true;
+          return kAppendOk;
         }
         break;
 
       case INITIALIZED: {
+        // Buffers are released once they are read, so this only holds back
+        // a page that appends much faster than the media plays.
+        int64 queued_bytes = GetQueuedBytes_Locked();
+        if (queued_bytes >= memory_limit_) {
+          DVLOG(1) << "AppendData(): " << queued_bytes << " bytes are queued, "
+                   << "which reaches the limit of " << memory_limit_;
+          return kAppendQuotaExceeded;
+        }
+
         if (!source_buffer_->AppendData(data, length)) {
           ReportError_Locked(PIPELINE_ERROR_DECODE);
-          return true;
+          return kAppendOk;
         }
       } break;
 
@@ -585,7 +625,7 @@ bool ChunkDemuxer::AppendData(const std::string& id,
       case PARSE_ERROR:
       case SHUTDOWN:
         DVLOG(1) << "AppendData(): called in unexpected state " << state_;
-        return false;
+        return kAppendInvalidState;
     }
 
     // Check to see if parsing triggered seek_waits_for_data_ to go from true to
@@ -621,7 +661,12 @@ bool ChunkDemuxer::AppendData(const std::string& id,
   if (!cb.is_null())
     cb.Run(PIPELINE_OK);
 
-  return true;
+  return kAppendOk;
+}
+
+void ChunkDemuxer::SetMemoryLimit(int64 memory_limit) {
+  base::AutoLock auto_lock(lock_);
+  memory_limit_ = memory_limit;
 }
 
 void ChunkDemuxer::Abort(const std::string& id) {
@@ -696,6 +741,16 @@ void ChunkDemuxer::Shutdown() {
   client_->DemuxerClosed();
 }
 
+int64 ChunkDemuxer::GetQueuedBytes_Locked() const {
+  lock_.AssertAcquired();
+  int64 queued_bytes = 0;
+  if (audio_.get())
+    queued_bytes += audio_->GetQueuedBytes();
+  if (video_.get())
+    queued_bytes += video_->GetQueuedBytes();
+  return queued_bytes;
+}
+
 void ChunkDemuxer::ChangeState_Locked(State new_state) {
   lock_.AssertAcquired();
   state_ = new_state;
@@ -31,6 +31,12 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
     kReachedIdLimit,  // Reached ID limit. We can't handle any more IDs.
   };
 
+  enum AppendStatus {
+    kAppendOk,             // Data accepted, though it may fail to parse.
+    kAppendInvalidState,   // Called before init, after an error or at the end.
+    kAppendQuotaExceeded,  // Unread appended data reached the memory limit.
+  };
+
   typedef std::vector<std::pair<base::TimeDelta, base::TimeDelta> > Ranges;
 
   explicit ChunkDemuxer(ChunkDemuxerClient* client);
@@ -72,8 +78,15 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
   bool GetBufferedRanges(const std::string& id, Ranges* ranges_out) const;
 
   // Appends media data to the source buffer associated with |id|. Returns
-  // false if this method is called in an invalid state.
-  bool AppendData(const std::string& id, const uint8* data, size_t length);
+  // kAppendInvalidState if this method is called in an invalid state, and
+  // kAppendQuotaExceeded if the data that has been appended but not yet read
+  // has reached the memory limit.
+  AppendStatus AppendData(const std::string& id, const uint8* data,
+                          size_t length);
+
+  // Sets how many bytes of appended data, not yet read by the decoders, can
+  // be held before AppendData() refuses more.
+  void SetMemoryLimit(int64 memory_limit);
 
   // Aborts parsing the current segment and reset the parser to a state where
   // it can accept a new segment.
@@ -95,6 +108,9 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
 
   void ChangeState_Locked(State new_state);
 
+  // Returns the size of the data queued in |audio_| and |video_|.
+  int64 GetQueuedBytes_Locked() const;
+
   // Reports an error and puts the demuxer in a state where it won't accept more
   // data.
   void ReportError_Locked(PipelineStatus error);
@@ -120,6 +136,7 @@ class MEDIA_EXPORT ChunkDemuxer : public Demuxer {
   scoped_refptr<ChunkDemuxerStream> video_;
 
   int64 buffered_bytes_;
+  int64 memory_limit_;
 
   base::TimeDelta duration_;
 
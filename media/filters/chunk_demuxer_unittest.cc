@@ -175,7 +175,8 @@ class ChunkDemuxerTest : public testing::Test {
     EXPECT_CALL(host_, SetBufferedTime(_)).Times(AnyNumber());
     EXPECT_CALL(host_, SetNetworkActivity(true))
         .Times(AnyNumber());
-    return demuxer_->AppendData(kSourceId, data, length);
+    return demuxer_->AppendData(kSourceId, data, length) ==
+        ChunkDemuxer::kAppendOk;
   }
 
   bool AppendDataInPieces(const uint8* data, size_t length) {
@@ -480,8 +481,9 @@ TEST_F(ChunkDemuxerTest, TestAppendDataBeforeInit) {
   int info_tracks_size = 0;
   CreateInfoTracks(true, true, false, &info_tracks, &info_tracks_size);
 
-  EXPECT_FALSE(demuxer_->AppendData(kSourceId, info_tracks.get(),
-                                    info_tracks_size));
+  EXPECT_EQ(ChunkDemuxer::kAppendInvalidState,
+            demuxer_->AppendData(kSourceId, info_tracks.get(),
+                                 info_tracks_size));
 }
 
 // Make sure Read() callbacks are dispatched with the proper data.
@@ -515,6 +517,41 @@ TEST_F(ChunkDemuxerTest, TestRead) {
   EXPECT_TRUE(video_read_done);
 }
 
+// Test that AppendData() refuses data while the data appended but not yet
+// read is over the memory limit, and accepts it again once it is read.
+TEST_F(ChunkDemuxerTest, TestMemoryLimit) {
+  ASSERT_TRUE(InitDemuxer(true, true, false));
+  demuxer_->SetMemoryLimit(1);
+
+  ClusterBuilder cb;
+  cb.SetClusterTimecode(0);
+  AddSimpleBlock(&cb, kAudioTrackNum, 0);
+  AddSimpleBlock(&cb, kVideoTrackNum, 0);
+  scoped_ptr<Cluster> cluster_a(cb.Finish());
+  ASSERT_TRUE(AppendData(cluster_a->data(), cluster_a->size()));
+
+  cb.SetClusterTimecode(33);
+  AddSimpleBlock(&cb, kAudioTrackNum, 33);
+  AddSimpleBlock(&cb, kVideoTrackNum, 33);
+  scoped_ptr<Cluster> cluster_b(cb.Finish());
+  EXPECT_EQ(ChunkDemuxer::kAppendQuotaExceeded,
+            demuxer_->AppendData(kSourceId, cluster_b->data(),
+                                 cluster_b->size()));
+
+  scoped_refptr<DemuxerStream> audio =
+      demuxer_->GetStream(DemuxerStream::AUDIO);
+  scoped_refptr<DemuxerStream> video =
+      demuxer_->GetStream(DemuxerStream::VIDEO);
+  bool audio_read_done = false;
+  bool video_read_done = false;
+  audio->Read(base::Bind(&OnReadDone, base::TimeDelta(), &audio_read_done));
+  video->Read(base::Bind(&OnReadDone, base::TimeDelta(), &video_read_done));
+  EXPECT_TRUE(audio_read_done);
+  EXPECT_TRUE(video_read_done);
+
+  EXPECT_TRUE(AppendData(cluster_b->data(), cluster_b->size()));
+}
+
 TEST_F(ChunkDemuxerTest, TestOutOfOrderClusters) {
   ASSERT_TRUE(InitDemuxer(true, true, false));
 
@@ -548,8 +585,9 @@ TEST_F(ChunkDemuxerTest, TestOutOfOrderClusters) {
   AddSimpleBlock(&cb, kAudioTrackNum, 45);
   AddSimpleBlock(&cb, kVideoTrackNum, 45);
   scoped_ptr<Cluster> cluster_c(cb.Finish());
-  EXPECT_FALSE(demuxer_->AppendData(kSourceId, cluster_c->data(),
-                                    cluster_c->size()));
+  EXPECT_EQ(ChunkDemuxer::kAppendInvalidState,
+            demuxer_->AppendData(kSourceId, cluster_c->data(),
+                                 cluster_c->size()));
 }
 
 TEST_F(ChunkDemuxerTest, TestNonMonotonicButAboveClusterTimecode) {
@@ -574,8 +612,9 @@ TEST_F(ChunkDemuxerTest, TestNonMonotonicButAboveClusterTimecode) {
   AddSimpleBlock(&cb, kAudioTrackNum, 20);
   AddSimpleBlock(&cb, kVideoTrackNum, 20);
   scoped_ptr<Cluster> cluster_b(cb.Finish());
-  EXPECT_FALSE(demuxer_->AppendData(kSourceId, cluster_b->data(),
-                                    cluster_b->size()));
+  EXPECT_EQ(ChunkDemuxer::kAppendInvalidState,
+            demuxer_->AppendData(kSourceId, cluster_b->data(),
+                                 cluster_b->size()));
 }
 
 TEST_F(ChunkDemuxerTest, TestBackwardsAndBeforeClusterTimecode) {
@@ -600,8 +639,9 @@ TEST_F(ChunkDemuxerTest, TestBackwardsAndBeforeClusterTimecode) {
   AddSimpleBlock(&cb, kAudioTrackNum, 6);
   AddSimpleBlock(&cb, kVideoTrackNum, 6);
   scoped_ptr<Cluster> cluster_b(cb.Finish());
-  EXPECT_FALSE(demuxer_->AppendData(kSourceId, cluster_b->data(),
-                                    cluster_b->size()));
+  EXPECT_EQ(ChunkDemuxer::kAppendInvalidState,
+            demuxer_->AppendData(kSourceId, cluster_b->data(),
+                                 cluster_b->size()));
 }
 
 
@@ -650,8 +690,9 @@ TEST_F(ChunkDemuxerTest, TestMonotonicallyIncreasingTimestampsAcrossClusters) {
   AddSimpleBlock(&cb, kAudioTrackNum, 10);
   AddSimpleBlock(&cb, kVideoTrackNum, 10);
   scoped_ptr<Cluster> cluster_c(cb.Finish());
-  EXPECT_FALSE(demuxer_->AppendData(kSourceId, cluster_c->data(),
-                                    cluster_c->size()));
+  EXPECT_EQ(ChunkDemuxer::kAppendInvalidState,
+            demuxer_->AppendData(kSourceId, cluster_c->data(),
+                                 cluster_c->size()));
 }
 
 // Test the case where a cluster is passed to AppendData() before
@@ -1068,7 +1109,7 @@ TEST_F(ChunkDemuxerTest, TestParseErrorDuringInit) {
   ASSERT_TRUE(AppendInfoTracks(true, true, false));
 
   uint8 tmp = 0;
-  ASSERT_TRUE(demuxer_->AppendData(kSourceId, &tmp, 1));
+  ASSERT_EQ(ChunkDemuxer::kAppendOk, demuxer_->AppendData(kSourceId, &tmp, 1));
 }
 
 }  // namespace media
@@ -4,24 +4,26 @@
 
 #include "media/filters/ffmpeg_video_decoder.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/command_line.h"
 #include "base/message_loop.h"
 #include "base/string_number_conversions.h"
+#include "base/sys_info.h"
 #include "media/base/demuxer_stream.h"
 #include "media/base/limits.h"
 #include "media/base/media_switches.h"
 #include "media/base/pipeline.h"
 #include "media/base/video_decoder_config.h"
 #include "media/base/video_frame.h"
-#include "media/base/video_util.h"
 #include "media/ffmpeg/ffmpeg_common.h"
 
 namespace media {
 
-// Always try to use three threads for video decoding.  There is little reason
-// not to since current day CPUs tend to be multi-core and we measured
+// Always try to use at least two threads for video decoding.  There is little
+// reason not to since current day CPUs tend to be multi-core and we measured
 // performance benefits on older machines such as P4s with hyperthreading.
 //
 // Handling decoding on separate threads also frees up the pipeline thread to
@@ -32,20 +34,75 @@ namespace media {
 static const int kDecodeThreads = 2;
 static const int kMaxDecodeThreads = 16;
 
-// Returns the number of threads given the FFmpeg CodecID. Also inspects the
-// command line for a valid --video-threads flag.
-static int GetThreadCount(CodecID codec_id) {
+// Frames at least this big get one more thread for H.264 and VP8, whose
+// decoders scale with threads, as long as there are cores for them.
+static const int kLargeFramePixels = 640 * 480;
+static const int kHDFramePixels = 1280 * 720;
+
+// Returns the FF_THREAD_* types FFmpeg may use to decode on several threads.
+// The --video-thread-type flag can restrict this to "frame" or "slice".
+static int GetThreadType() {
+  const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
+  std::string type(cmd_line->GetSwitchValueASCII(switches::kVideoThreadType));
+  if (type == "frame")
+    return FF_THREAD_FRAME;
+  if (type == "slice")
+    return FF_THREAD_SLICE;
+  if (!type.empty())
+    DLOG(WARNING) << "Unknown --" << switches::kVideoThreadType << ": " << type;
+  return FF_THREAD_FRAME | FF_THREAD_SLICE;
+}
+
+// Returns the number of threads to decode |codec_context| with, based on its
+// codec and frame size and on the number of cores. Also inspects the command
+// line for a valid --video-threads flag.
+static int GetThreadCount(const AVCodecContext* codec_context) {
   // Refer to http://crbug.com/93932 for tsan suppressions on decoding.
   int decode_threads = kDecodeThreads;
 
   const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
   std::string threads(cmd_line->GetSwitchValueASCII(switches::kVideoThreads));
-  if (threads.empty() || !base::StringToInt(threads, &decode_threads))
+  if (!threads.empty() && base::StringToInt(threads, &decode_threads)) {
+    decode_threads = std::max(decode_threads, 0);
+    decode_threads = std::min(decode_threads, kMaxDecodeThreads);
     return decode_threads;
+  }
+
+  if (codec_context->codec_id == CODEC_ID_H264 ||
+      codec_context->codec_id == CODEC_ID_VP8) {
+    int pixels = codec_context->width * codec_context->height;
+    if (pixels >= kLargeFramePixels)
+      decode_threads++;
+    if (pixels >= kHDFramePixels)
+      decode_threads++;
+    decode_threads = std::min(decode_threads,
+                              base::SysInfo::NumberOfProcessors());
+  }
+
+  // With frame threading, each thread delays the output by one frame, and
+  // holds on to a frame the renderer doesn't have yet. Decoding further ahead
+  // than the renderer queues frames only uses more memory.
+  if (codec_context->thread_type & FF_THREAD_FRAME)
+    decode_threads = std::min(decode_threads,
+                              static_cast<int>(limits::kMaxVideoFrames));
+
+  return std::max(decode_threads, kDecodeThreads);
+}
+
+static int GetVideoBufferImpl(AVCodecContext* s, AVFrame* frame) {
+  FFmpegVideoDecoder* decoder = static_cast<FFmpegVideoDecoder*>(s->opaque);
+  return decoder->GetVideoBuffer(s, frame);
+}
+
+static void ReleaseVideoBufferImpl(AVCodecContext* s, AVFrame* frame) {
+  // Drop the reference GetVideoBuffer() gave FFmpeg. The frame lives on if
+  // it was delivered and is still being rendered.
+  scoped_refptr<VideoFrame> video_frame;
+  video_frame.swap(reinterpret_cast<VideoFrame**>(&frame->opaque));
 
-  decode_threads = std::max(decode_threads, 0);
-  decode_threads = std::min(decode_threads, kMaxDecodeThreads);
-  return decode_threads;
+  // The FFmpeg API expects us to zero the data pointers in this callback.
+  memset(frame->data, 0, sizeof(frame->data));
+  frame->opaque = NULL;
 }
 
 FFmpegVideoDecoder::FFmpegVideoDecoder(
@@ -105,7 +162,16 @@ void FFmpegVideoDecoder::Initialize(const scoped_refptr<DemuxerStream>& stream,
   // for damaged macroblocks, and set our error detection sensitivity.
   codec_context_->error_concealment = FF_EC_GUESS_MVS | FF_EC_DEBLOCK;
   codec_context_->err_recognition = AV_EF_CAREFUL;
-  codec_context_->thread_count = GetThreadCount(codec_context_->codec_id);
+  codec_context_->thread_type = GetThreadType();
+  codec_context_->thread_count = GetThreadCount(codec_context_);
+
+  // Decode straight into VideoFrames, so they don't need to be copied out of
+  // FFmpeg's own buffers. Emulating the edges lets the buffers be the size
+  // of the picture, without room for a border around it.
+  codec_context_->opaque = this;
+  codec_context_->flags |= CODEC_FLAG_EMU_EDGE;
+  codec_context_->get_buffer = GetVideoBufferImpl;
+  codec_context_->release_buffer = ReleaseVideoBufferImpl;
 
   AVCodec* codec = avcodec_find_decoder(codec_context_->codec_id);
   if (!codec) {
@@ -127,6 +193,51 @@ void FFmpegVideoDecoder::Initialize(const scoped_refptr<DemuxerStream>& stream,
   status_cb.Run(PIPELINE_OK);
 }
 
+int FFmpegVideoDecoder::GetVideoBuffer(AVCodecContext* codec_context,
+                                       AVFrame* frame) {
+  // Don't use |codec_context_| here! With threaded decoding,
+  // it will contain unsynchronized width/height/pix_fmt values,
+  // whereas |codec_context| contains the current threads's
+  // updated width/height/pix_fmt, which can change for adaptive
+  // content.
+  VideoFrame::Format format = PixelFormatToVideoFormat(codec_context->pix_fmt);
+  if (format == VideoFrame::INVALID)
+    return AVERROR(EINVAL);
+  DCHECK(format == VideoFrame::YV12 || format == VideoFrame::YV16);
+
+  int ret = av_image_check_size(codec_context->width, codec_context->height,
+                                0, NULL);
+  if (ret < 0)
+    return ret;
+  if (!VideoFrame::IsValidConfig(format, codec_context->width,
+                                 codec_context->height)) {
+    return AVERROR(EINVAL);
+  }
+
+  scoped_refptr<VideoFrame> video_frame =
+      VideoFrame::CreateFrame(format, codec_context->width,
+                              codec_context->height,
+                              kNoTimestamp(), kNoTimestamp());
+
+  for (int i = 0; i < 3; i++) {
+    frame->base[i] = video_frame->data(i);
+    frame->data[i] = video_frame->data(i);
+    frame->linesize[i] = video_frame->stride(i);
+  }
+
+  // FFmpeg holds a reference to the frame until ReleaseVideoBufferImpl().
+  frame->opaque = NULL;
+  video_frame.swap(reinterpret_cast<VideoFrame**>(&frame->opaque));
+  frame->type = FF_BUFFER_TYPE_USER;
+  frame->pkt_pts = codec_context->pkt ? codec_context->pkt->pts :
+                                        AV_NOPTS_VALUE;
+  frame->reordered_opaque = codec_context->reordered_opaque;
+  frame->width = codec_context->width;
+  frame->height = codec_context->height;
+  frame->format = codec_context->pix_fmt;
+  return 0;
+}
+
 void FFmpegVideoDecoder::Read(const ReadCB& read_cb) {
   // Complete operation asynchronously on different stack of execution as per
   // the API contract of VideoDecoder::Read()
@@ -356,12 +467,14 @@ bool FFmpegVideoDecoder::Decode(
     return false;
   }
 
-  // We've got a frame! Make sure we have a place to store it.
-  *video_frame = AllocateVideoFrame();
-  if (!(*video_frame)) {
-    LOG(ERROR) << "Failed to allocate video frame";
+  // FFmpeg decoded into a frame from GetVideoBuffer(), which is handed out as
+  // is. FFmpeg doesn't write to a picture once it has been output, so the
+  // frame can be rendered while FFmpeg keeps it as a reference picture.
+  if (!av_frame_->opaque) {
+    LOG(ERROR) << "VideoFrame object associated with frame data not set.";
     return false;
   }
+  *video_frame = static_cast<VideoFrame*>(av_frame_->opaque);
 
   // Determine timestamp and calculate the duration based on the repeat picture
   // count.  According to FFmpeg docs, the total duration can be calculated as
@@ -381,19 +494,6 @@ bool FFmpegVideoDecoder::Decode(
   (*video_frame)->SetDuration(
       ConvertFromTimeBase(doubled_time_base, 2 + av_frame_->repeat_pict));
 
-  // Copy the frame data since FFmpeg reuses internal buffers for AVFrame
-  // output, meaning the data is only valid until the next
-  // avcodec_decode_video() call.
-  int y_rows = codec_context_->height;
-  int uv_rows = codec_context_->height;
-  if (codec_context_->pix_fmt == PIX_FMT_YUV420P) {
-    uv_rows /= 2;
-  }
-
-  CopyYPlane(av_frame_->data[0], av_frame_->linesize[0], y_rows, *video_frame);
-  CopyUPlane(av_frame_->data[1], av_frame_->linesize[1], uv_rows, *video_frame);
-  CopyVPlane(av_frame_->data[2], av_frame_->linesize[2], uv_rows, *video_frame);
-
   return true;
 }
 
@@ -416,13 +516,4 @@ void FFmpegVideoDecoder::ReleaseFFmpegResources() {
   }
 }
 
-scoped_refptr<VideoFrame> FFmpegVideoDecoder::AllocateVideoFrame() {
-  VideoFrame::Format format = PixelFormatToVideoFormat(codec_context_->pix_fmt);
-  size_t width = codec_context_->width;
-  size_t height = codec_context_->height;
-
-  return VideoFrame::CreateFrame(format, width, height,
-                                 kNoTimestamp(), kNoTimestamp());
-}
-
 }  // namespace media
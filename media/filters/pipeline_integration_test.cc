@@ -56,9 +56,10 @@ class MockMediaSource : public ChunkDemuxerClient {
     DCHECK(chunk_demuxer_.get());
     DCHECK_LT(current_position_, file_data_size_);
     DCHECK_LE(current_position_ + size, file_data_size_);
-    CHECK(chunk_demuxer_->AppendData(kSourceId,
-                                     file_data_.get() + current_position_,
-                                     size));
+    CHECK_EQ(ChunkDemuxer::kAppendOk,
+             chunk_demuxer_->AppendData(kSourceId,
+                                        file_data_.get() + current_position_,
+                                        size));
     current_position_ += size;
   }
 
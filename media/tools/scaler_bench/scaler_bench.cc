@@ -14,6 +14,9 @@
 #include "base/memory/scoped_vector.h"
 #include "base/string_number_conversions.h"
 #include "base/time.h"
+#include "build/build_config.h"
+#include "media/base/cpu_features.h"
+#include "media/base/simd/convert_yuv_to_rgb.h"
 #include "media/base/video_frame.h"
 #include "media/base/yuv_convert.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -193,6 +196,40 @@ static double BenchmarkScaleWithRect() {
   return static_cast<double>((end - start).InMilliseconds()) / num_frames;
 }
 
+// Times one scaling row kernel on its own, scaling every row of a source
+// frame to a destination frame, without any filtering or threads.
+static double BenchmarkRowKernel(ScaleYUVToRGB32RowProc kernel) {
+  scoped_refptr<VideoFrame> source_frame =
+      VideoFrame::CreateBlackFrame(source_width, source_height);
+  scoped_refptr<VideoFrame> dest_frame =
+      VideoFrame::CreateFrame(VideoFrame::RGB32,
+                              dest_width,
+                              dest_height,
+                              TimeDelta::FromSeconds(0),
+                              TimeDelta::FromSeconds(0));
+  int source_dx = (source_width << 16) / dest_width;
+  int y_stride = source_frame->stride(VideoFrame::kYPlane);
+  int uv_stride = source_frame->stride(VideoFrame::kUPlane);
+
+  TimeTicks start = TimeTicks::HighResNow();
+  for (int i = 0; i < num_frames; i++) {
+    for (int y = 0; y < dest_height; y++) {
+      int source_y = y * source_height / dest_height;
+      kernel(source_frame->data(VideoFrame::kYPlane) + source_y * y_stride,
+             source_frame->data(VideoFrame::kUPlane) +
+                 source_y / 2 * uv_stride,
+             source_frame->data(VideoFrame::kVPlane) +
+                 source_y / 2 * uv_stride,
+             dest_frame->data(0) + y * dest_frame->stride(0),
+             dest_width,
+             source_dx);
+    }
+  }
+  media::EmptyRegisterState();
+  TimeTicks end = TimeTicks::HighResNow();
+  return static_cast<double>((end - start).InMilliseconds()) / num_frames;
+}
+
 int main(int argc, const char** argv) {
   CommandLine::Init(argc, argv);
   const CommandLine* cmd_line = CommandLine::ForCurrentProcess();
@@ -275,5 +312,36 @@ int main(int argc, const char** argv) {
   std::cout << "Bilinear with rect: " << BenchmarkScaleWithRect()
             << "ms/frame" << std::endl;
 
+  std::cout << "Row kernel C: " << BenchmarkRowKernel(&ScaleYUVToRGB32Row_C)
+            << "ms/frame" << std::endl;
+  std::cout << "Row kernel bilinear C: "
+            << BenchmarkRowKernel(&LinearScaleYUVToRGB32Row_C)
+            << "ms/frame" << std::endl;
+#if defined(ARCH_CPU_X86_64)
+  std::cout << "Row kernel SSE2 x64: "
+            << BenchmarkRowKernel(&ScaleYUVToRGB32Row_SSE2_X64)
+            << "ms/frame" << std::endl;
+  std::cout << "Row kernel bilinear MMX x64: "
+            << BenchmarkRowKernel(&LinearScaleYUVToRGB32Row_MMX_X64)
+            << "ms/frame" << std::endl;
+#elif defined(ARCH_CPU_X86_FAMILY)
+  if (media::hasMMX()) {
+    std::cout << "Row kernel MMX: "
+              << BenchmarkRowKernel(&ScaleYUVToRGB32Row_MMX)
+              << "ms/frame" << std::endl;
+    std::cout << "Row kernel bilinear MMX: "
+              << BenchmarkRowKernel(&LinearScaleYUVToRGB32Row_MMX)
+              << "ms/frame" << std::endl;
+  }
+  if (media::hasSSE()) {
+    std::cout << "Row kernel SSE: "
+              << BenchmarkRowKernel(&ScaleYUVToRGB32Row_SSE)
+              << "ms/frame" << std::endl;
+    std::cout << "Row kernel bilinear SSE: "
+              << BenchmarkRowKernel(&LinearScaleYUVToRGB32Row_SSE)
+              << "ms/frame" << std::endl;
+  }
+#endif
+
   return 0;
 }
@@ -78,10 +78,14 @@ bool DataURL::Parse(const GURL& url, std::string* mime_type,
   // bar for text, and it can't hurt, so we allow it.)
   std::string temp_data = std::string(comma + 1, end);
 
+  // Large inline images rarely contain escapes, and unescaping copies the
+  // whole payload, so only do it when there is something to unescape.
+  bool has_escapes = temp_data.find('%') != std::string::npos;
+
   // For base64, we may have url-escaped whitespace which is not part
   // of the data, and should be stripped. Otherwise, the escaped whitespace
   // could be part of the payload, so don't strip it.
-  if (base64_encoded) {
+  if (base64_encoded && has_escapes) {
     temp_data = UnescapeURLComponent(temp_data,
         UnescapeRule::SPACES | UnescapeRule::URL_SPECIAL_CHARS |
         UnescapeRule::CONTROL_CHARS);
@@ -95,7 +99,7 @@ bool DataURL::Parse(const GURL& url, std::string* mime_type,
                     temp_data.end());
   }
 
-  if (!base64_encoded) {
+  if (!base64_encoded && has_escapes) {
     temp_data = UnescapeURLComponent(temp_data,
         UnescapeRule::SPACES | UnescapeRule::URL_SPECIAL_CHARS |
         UnescapeRule::CONTROL_CHARS);
@@ -85,6 +85,17 @@ class ExpiringCache {
     return &it->second.first;
   }
 
+  // Like Get(), but also returns a value that has expired, without removing
+  // it. |*expiration| is set to the time the value expires or expired.
+  const ValueType* GetStale(const KeyType& key,
+                            base::TimeTicks* expiration) const {
+    typename EntryMap::const_iterator it = entries_.find(key);
+    if (it == entries_.end())
+      return NULL;
+    *expiration = it->second.second;
+    return &it->second.first;
+  }
+
   // Updates or replaces the value associated with |key|.
   void Put(const KeyType& key,
            const ValueType& value,
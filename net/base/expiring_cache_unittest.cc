@@ -242,4 +242,24 @@ TEST(ExpiringCache, GetTruncatesExpiredEntries) {
   EXPECT_EQ(6U, cache.size());
 }
 
+TEST(ExpiringCacheTest, GetStale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  Cache cache(kMaxCacheEntries);
+  base::TimeTicks now;
+  base::TimeTicks expiration;
+
+  EXPECT_FALSE(cache.GetStale("test1", &expiration));
+  cache.Put("test1", "foo1", now, kTTL);
+  EXPECT_THAT(cache.GetStale("test1", &expiration), Pointee(StrEq("foo1")));
+  EXPECT_EQ(now + kTTL, expiration);
+
+  // Expired entries are returned and kept.
+  now += kTTL * 2;
+  EXPECT_THAT(cache.GetStale("test1", &expiration), Pointee(StrEq("foo1")));
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_FALSE(cache.Get("test1", now));
+  EXPECT_FALSE(cache.GetStale("test1", &expiration));
+}
+
 }  // namespace net
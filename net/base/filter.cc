@@ -88,21 +88,22 @@ Filter::FilterStatus Filter::ReadData(char* dest_buffer, int* dest_len) {
   const int dest_buffer_capacity = *dest_len;
   if (last_status_ == FILTER_ERROR)
     return last_status_;
-  if (!next_filter_.get())
+  Filter* next_filter = NextNonPassThroughFilter();
+  if (!next_filter)
     return last_status_ = ReadFilteredData(dest_buffer, dest_len);
   if (last_status_ == FILTER_NEED_MORE_DATA && !stream_data_len())
-    return next_filter_->ReadData(dest_buffer, dest_len);
+    return next_filter->ReadData(dest_buffer, dest_len);
 
   do {
-    if (next_filter_->last_status() == FILTER_NEED_MORE_DATA) {
-      PushDataIntoNextFilter();
+    if (next_filter->last_status() == FILTER_NEED_MORE_DATA) {
+      PushDataIntoNextFilter(next_filter);
       if (FILTER_ERROR == last_status_)
         return FILTER_ERROR;
     }
     *dest_len = dest_buffer_capacity;  // Reset the input/output parameter.
-    next_filter_->ReadData(dest_buffer, dest_len);
+    next_filter->ReadData(dest_buffer, dest_len);
     if (FILTER_NEED_MORE_DATA == last_status_)
-        return next_filter_->last_status();
+        return next_filter->last_status();
 
     // In the case where this filter has data internally, and is indicating such
     // with a last_status_ of FILTER_OK, but at the same time the next filter in
@@ -114,10 +115,10 @@ Filter::FilterStatus Filter::ReadData(char* dest_buffer, int* dest_len) {
     // get out of this state (by pumping data into the next filter until it
     // outputs data, or it runs out of data and reports that it NEED_MORE_DATA.)
   } while (FILTER_OK == last_status_ &&
-           FILTER_NEED_MORE_DATA == next_filter_->last_status() &&
+           FILTER_NEED_MORE_DATA == next_filter->last_status() &&
            0 == *dest_len);
 
-  if (next_filter_->last_status() == FILTER_ERROR)
+  if (next_filter->last_status() == FILTER_ERROR)
     return FILTER_ERROR;
   return FILTER_OK;
 }
@@ -396,12 +397,25 @@ void Filter::InitBuffer(int buffer_size) {
   stream_buffer_size_ = buffer_size;
 }
 
-void Filter::PushDataIntoNextFilter() {
-  IOBuffer* next_buffer = next_filter_->stream_buffer();
-  int next_size = next_filter_->stream_buffer_size();
+bool Filter::IsPassThrough() const {
+  return false;
+}
+
+Filter* Filter::NextNonPassThroughFilter() const {
+  Filter* next_filter = next_filter_.get();
+  while (next_filter && next_filter->IsPassThrough() &&
+         !next_filter->stream_data_len()) {
+    next_filter = next_filter->next_filter_.get();
+  }
+  return next_filter;
+}
+
+void Filter::PushDataIntoNextFilter(Filter* next_filter) {
+  IOBuffer* next_buffer = next_filter->stream_buffer();
+  int next_size = next_filter->stream_buffer_size();
   last_status_ = ReadFilteredData(next_buffer->data(), &next_size);
   if (FILTER_ERROR != last_status_)
-    next_filter_->FlushStreamBuffer(next_size);
+    next_filter->FlushStreamBuffer(next_size);
 }
 
 }  // namespace net
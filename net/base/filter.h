@@ -219,6 +219,13 @@ class NET_EXPORT_PRIVATE Filter {
   // Copy pre-filter data directly to destination buffer without decoding.
   FilterStatus CopyOut(char* dest_buffer, int* dest_len);
 
+  // Returns true if the filter has given up on decoding and now only copies
+  // its input to its output, with no output of its own still to be read.
+  // Once such a filter has an empty stream buffer, the chain skips it, and
+  // the filter before it writes straight to the filter after it (or to the
+  // caller's buffer) instead of going through one more copy.
+  virtual bool IsPassThrough() const;
+
   FilterStatus last_status() const { return last_status_; }
 
   // Buffer to hold the data to be filtered (the input queue).
@@ -254,8 +261,12 @@ class NET_EXPORT_PRIVATE Filter {
                                 const FilterContext& filter_context,
                                 int buffer_size);
 
-  // Helper function to empty our output into the next filter's input.
-  void PushDataIntoNextFilter();
+  // Returns the first filter after this one in the chain that is not an
+  // empty pass-through filter, or NULL if there is none.
+  Filter* NextNonPassThroughFilter() const;
+
+  // Helper function to empty our output into |next_filter|'s input.
+  void PushDataIntoNextFilter(Filter* next_filter);
 
   // Constructs a filter with an internal buffer of the given size.
   // Only meant to be called by unit tests that need to control the buffer size.
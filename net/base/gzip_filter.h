@@ -52,6 +52,10 @@ class GZipFilter : public Filter {
   virtual FilterStatus ReadFilteredData(char* dest_buffer,
                                         int* dest_len) OVERRIDE;
 
+ protected:
+  // Filter overrides.
+  virtual bool IsPassThrough() const OVERRIDE;
+
  private:
   enum DecodingStatus {
     DECODING_UNINITIALIZED,
@@ -4,6 +4,7 @@
 
 #include <fstream>
 #include <ostream>
+#include <string>
 
 #if defined(USE_SYSTEM_ZLIB)
 #include <zlib.h>
@@ -231,6 +232,11 @@ class GZipUnitTest : public PlatformTest {
     ASSERT_GE(filter_->stream_buffer_size(), kDefaultBufferSize);
   }
 
+  void InitFilterChain(const std::vector<Filter::FilterType>& filter_types) {
+    filter_.reset(Filter::Factory(filter_types, filter_context_));
+    ASSERT_TRUE(filter_.get());
+  }
+
   void InitFilterWithBufferSize(Filter::FilterType type, int buffer_size) {
     std::vector<Filter::FilterType> filter_types;
     filter_types.push_back(type);
@@ -394,4 +400,30 @@ TEST_F(GZipUnitTest, DecodeCorruptedHeader) {
   EXPECT_TRUE(code == Filter::FILTER_ERROR);
 }
 
+// A tentative gzip filter that gets plain data becomes a pass-through filter,
+// which the chain then skips.
+TEST_F(GZipUnitTest, DecodeThroughPassThroughFilter) {
+  std::vector<Filter::FilterType> filter_types;
+  filter_types.push_back(Filter::FILTER_TYPE_GZIP_HELPING_SDCH);
+  filter_types.push_back(Filter::FILTER_TYPE_GZIP);
+  InitFilterChain(filter_types);
+  ASSERT_GE(filter_->stream_buffer_size(), gzip_encode_len_);
+  memcpy(filter_->stream_buffer()->data(), gzip_encode_buffer_,
+         gzip_encode_len_);
+  filter_->FlushStreamBuffer(gzip_encode_len_);
+
+  // Read with a small buffer, so that the tentative filter is still holding
+  // data when it turns into a pass-through filter.
+  std::string output;
+  Filter::FilterStatus code;
+  do {
+    char decode_buffer[kSmallBufferSize];
+    int decode_len = kSmallBufferSize;
+    code = filter_->ReadData(decode_buffer, &decode_len);
+    ASSERT_NE(Filter::FILTER_ERROR, code);
+    output.append(decode_buffer, decode_len);
+  } while (code == Filter::FILTER_OK);
+  EXPECT_EQ(source_buffer_, output);
+}
+
 }  // namespace net
@@ -4,11 +4,42 @@
 
 #include "net/base/host_cache.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/logging.h"
+#include "base/values.h"
 #include "net/base/net_errors.h"
+#include "net/base/net_util.h"
+#include "net/base/sys_addrinfo.h"
 
 namespace net {
 
+namespace {
+
+// Restored entries that expired longer ago than this are dropped instead of
+// being kept as stale.
+const int kMaxRestoredStalenessSeconds = 24 * 60 * 60;
+
+// An entry picked by GetAsListValue().
+struct EntryToSave {
+  EntryToSave(base::TimeTicks expiration,
+              const HostCache::Key* key,
+              const HostCache::Entry* entry)
+      : expiration(expiration), key(key), entry(entry) {}
+
+  // Sorts the entries that expire last first.
+  bool operator<(const EntryToSave& other) const {
+    return expiration > other.expiration;
+  }
+
+  base::TimeTicks expiration;
+  const HostCache::Key* key;
+  const HostCache::Entry* entry;
+};
+
+}  // namespace
+
 //-----------------------------------------------------------------------------
 
 HostCache::Entry::Entry(int error, const AddressList& addrlist)
@@ -37,6 +68,20 @@ const HostCache::Entry* HostCache::Lookup(const Key& key,
   return entries_.Get(key, now);
 }
 
+const HostCache::Entry* HostCache::LookupStale(const Key& key,
+                                               base::TimeTicks now,
+                                               bool* is_stale) {
+  DCHECK(CalledOnValidThread());
+  if (caching_is_disabled())
+    return NULL;
+
+  base::TimeTicks expiration;
+  const Entry* entry = entries_.GetStale(key, &expiration);
+  if (entry)
+    *is_stale = expiration <= now;
+  return entry;
+}
+
 void HostCache::Set(const Key& key,
                     int error,
                     const AddressList& addrlist,
@@ -70,6 +115,103 @@ const HostCache::EntryMap& HostCache::entries() const {
   return entries_;
 }
 
+base::ListValue* HostCache::GetAsListValue(base::TimeTicks now,
+                                           base::Time wall_now,
+                                           size_t max_entries) const {
+  DCHECK(CalledOnValidThread());
+  std::vector<EntryToSave> entries;
+  for (EntryMap::Iterator it(entries_); it.HasNext(); it.Advance()) {
+    if (it.value().error == OK && it.expiration() > now)
+      entries.push_back(EntryToSave(it.expiration(), &it.key(), &it.value()));
+  }
+  std::sort(entries.begin(), entries.end());
+  if (entries.size() > max_entries)
+    entries.erase(entries.begin() + max_entries, entries.end());
+
+  base::ListValue* list = new base::ListValue();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const EntryToSave& saved = entries[i];
+    base::ListValue* addresses = new base::ListValue();
+    for (const struct addrinfo* ai = saved.entry->addrlist.head(); ai;
+         ai = ai->ai_next) {
+      addresses->Append(base::Value::CreateStringValue(NetAddressToString(ai)));
+    }
+    std::string canonical_name;
+    saved.entry->addrlist.GetCanonicalName(&canonical_name);
+
+    base::DictionaryValue* dict = new base::DictionaryValue();
+    dict->SetString("hostname", saved.key->hostname);
+    dict->SetInteger("address_family", saved.key->address_family);
+    dict->SetInteger("flags", saved.key->host_resolver_flags);
+    dict->SetString("canonical_name", canonical_name);
+    dict->Set("addresses", addresses);
+    base::Time expiration = wall_now + (saved.expiration - now);
+    dict->SetDouble("expiration", expiration.ToDoubleT());
+    list->Append(dict);
+  }
+  return list;
+}
+
+size_t HostCache::RestoreFromListValue(const base::ListValue& list,
+                                       base::TimeTicks now,
+                                       base::Time wall_now) {
+  DCHECK(CalledOnValidThread());
+  if (caching_is_disabled())
+    return 0;
+
+  size_t restored = 0;
+  for (size_t i = 0; i < list.GetSize(); ++i) {
+    base::DictionaryValue* dict;
+    std::string hostname;
+    int address_family;
+    int flags;
+    std::string canonical_name;
+    base::ListValue* addresses;
+    double expiration;
+    if (!list.GetDictionary(i, &dict) ||
+        !dict->GetString("hostname", &hostname) ||
+        !dict->GetInteger("address_family", &address_family) ||
+        !dict->GetInteger("flags", &flags) ||
+        !dict->GetString("canonical_name", &canonical_name) ||
+        !dict->GetList("addresses", &addresses) ||
+        !dict->GetDouble("expiration", &expiration)) {
+      continue;
+    }
+    if (address_family < ADDRESS_FAMILY_UNSPECIFIED ||
+        address_family > ADDRESS_FAMILY_IPV6) {
+      continue;
+    }
+
+    IPAddressList ip_addresses;
+    for (size_t j = 0; j < addresses->GetSize(); ++j) {
+      std::string address;
+      IPAddressNumber ip_address;
+      if (addresses->GetString(j, &address) &&
+          ParseIPLiteralToNumber(address, &ip_address)) {
+        ip_addresses.push_back(ip_address);
+      }
+    }
+    if (ip_addresses.empty())
+      continue;
+
+    base::TimeDelta ttl = base::Time::FromDoubleT(expiration) - wall_now;
+    if (ttl < -base::TimeDelta::FromSeconds(kMaxRestoredStalenessSeconds))
+      continue;
+
+    Key key(hostname, static_cast<AddressFamily>(address_family), flags);
+    base::TimeTicks unused;
+    if (entries_.GetStale(key, &unused))
+      continue;
+
+    entries_.Put(key,
+                 Entry(OK, AddressList::CreateFromIPAddressList(
+                                ip_addresses, canonical_name)),
+                 now, ttl);
+    restored++;
+  }
+  return restored;
+}
+
 // static
 HostCache* HostCache::CreateDefaultCache() {
   static const size_t kMaxHostCacheEntries = 100;
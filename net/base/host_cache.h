@@ -16,6 +16,10 @@
 #include "net/base/expiring_cache.h"
 #include "net/base/net_export.h"
 
+namespace base {
+class ListValue;
+}
+
 namespace net {
 
 // Cache used by HostResolver to map hostnames to their resolved result.
@@ -65,6 +69,11 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // |now|. If there is no such entry, returns NULL.
   const Entry* Lookup(const Key& key, base::TimeTicks now);
 
+  // Like Lookup(), but also returns an entry that has expired, without
+  // removing it. |*is_stale| is set to whether the entry expired at |now|.
+  const Entry* LookupStale(const Key& key, base::TimeTicks now,
+                           bool* is_stale);
+
   // Overwrites or creates an entry for |key|.
   // (|error|, |addrlist|) is the value to set, |now| is the current time
   // |ttl| is the "time to live".
@@ -85,6 +94,23 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
 
   const EntryMap& entries() const;
 
+  // Returns up to |max_entries| successful entries that are valid at |now|,
+  // picking the ones that expire last, so that they can be saved across
+  // restarts. Each item of the list is a dictionary holding the key, the
+  // addresses, and the expiration in wall clock time, computed from
+  // |wall_now|. The caller takes ownership.
+  base::ListValue* GetAsListValue(base::TimeTicks now,
+                                  base::Time wall_now,
+                                  size_t max_entries) const;
+
+  // Adds the entries of a list returned by GetAsListValue(), unless there is
+  // an entry with the same key already. Entries that have expired since are
+  // kept as stale, so that LookupStale() finds them, unless they expired long
+  // ago. Returns the number of entries added.
+  size_t RestoreFromListValue(const base::ListValue& list,
+                              base::TimeTicks now,
+                              base::Time wall_now);
+
   // Creates a default cache.
   static HostCache* CreateDefaultCache();
 
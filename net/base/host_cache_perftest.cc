@@ -0,0 +1,74 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "base/time.h"
+#include "net/base/address_list.h"
+#include "net/base/host_cache.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumIterations = 200000;
+const int kNumHosts = 1000;
+
+HostCache::Key MakeKey(int i) {
+  return HostCache::Key(base::StringPrintf("host%d.example.com", i),
+                        ADDRESS_FAMILY_UNSPECIFIED, 0);
+}
+
+}  // namespace
+
+// Looks up hostnames in a full cache, as the resolver does for every request.
+TEST(HostCachePerfTest, Lookup) {
+  HostCache cache(kNumHosts);
+  base::TimeTicks now = base::TimeTicks::Now();
+  const base::TimeDelta kTTL = base::TimeDelta::FromMinutes(1);
+
+  std::vector<HostCache::Key> keys;
+  for (int i = 0; i < kNumHosts; ++i) {
+    keys.push_back(MakeKey(i));
+    cache.Set(keys.back(), OK, AddressList(), now, kTTL);
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumHosts), cache.size());
+
+  PerfTimeLogger hit_timer("Host_cache_lookup_hit");
+  for (int i = 0; i < kNumIterations; ++i)
+    ASSERT_TRUE(cache.Lookup(keys[i % kNumHosts], now) != NULL);
+  hit_timer.Done();
+
+  HostCache::Key missing_key("missing.example.com",
+                             ADDRESS_FAMILY_UNSPECIFIED, 0);
+  PerfTimeLogger miss_timer("Host_cache_lookup_miss");
+  for (int i = 0; i < kNumIterations; ++i)
+    ASSERT_TRUE(cache.Lookup(missing_key, now) == NULL);
+  miss_timer.Done();
+}
+
+// Keeps setting entries for new hostnames in a full cache, so that each one
+// evicts another.
+TEST(HostCachePerfTest, SetWithEviction) {
+  HostCache cache(kNumHosts);
+  base::TimeTicks now = base::TimeTicks::Now();
+  const base::TimeDelta kTTL = base::TimeDelta::FromMinutes(1);
+
+  std::vector<HostCache::Key> keys;
+  for (int i = 0; i < 2 * kNumHosts; ++i)
+    keys.push_back(MakeKey(i));
+
+  PerfTimeLogger timer("Host_cache_set_with_eviction");
+  for (int i = 0; i < kNumIterations; ++i)
+    cache.Set(keys[i % keys.size()], OK, AddressList(), now, kTTL);
+  timer.Done();
+  EXPECT_EQ(static_cast<size_t>(kNumHosts), cache.size());
+}
+
+}  // namespace net
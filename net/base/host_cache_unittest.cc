@@ -5,10 +5,13 @@
 #include "net/base/host_cache.h"
 
 #include "base/format_macros.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/stl_util.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
+#include "base/values.h"
 #include "net/base/net_errors.h"
+#include "net/base/net_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -22,6 +25,13 @@ HostCache::Key Key(const std::string& hostname) {
   return HostCache::Key(hostname, ADDRESS_FAMILY_UNSPECIFIED, 0);
 }
 
+// Returns an address list holding |ip_literal|.
+AddressList Addresses(const std::string& ip_literal) {
+  IPAddressNumber address;
+  EXPECT_TRUE(ParseIPLiteralToNumber(ip_literal, &address));
+  return AddressList::CreateFromIPAddress(address, 0);
+}
+
 }  // namespace
 
 TEST(HostCacheTest, Basic) {
@@ -287,6 +297,84 @@ TEST(HostCacheTest, Clear) {
   EXPECT_EQ(0u, cache.size());
 }
 
+TEST(HostCacheTest, LookupStale) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+  base::TimeTicks now;
+  HostCache::Key key1 = Key("foobar.com");
+  bool is_stale = false;
+
+  EXPECT_FALSE(cache.LookupStale(key1, now, &is_stale));
+  cache.Set(key1, OK, AddressList(), now, kTTL);
+  EXPECT_TRUE(cache.LookupStale(key1, now, &is_stale));
+  EXPECT_FALSE(is_stale);
+
+  // Expired entries are still found, and kept.
+  now += kTTL;
+  EXPECT_TRUE(cache.LookupStale(key1, now, &is_stale));
+  EXPECT_TRUE(is_stale);
+  EXPECT_EQ(1U, cache.size());
+
+  // Lookup() drops them.
+  EXPECT_FALSE(cache.Lookup(key1, now));
+  EXPECT_FALSE(cache.LookupStale(key1, now, &is_stale));
+}
+
+TEST(HostCacheTest, SaveAndRestore) {
+  const base::TimeDelta kTTL = base::TimeDelta::FromSeconds(10);
+
+  HostCache cache(kMaxCacheEntries);
+  base::TimeTicks now;
+  base::Time wall_now = base::Time::Now();
+
+  cache.Set(Key("a.com"), OK, Addresses("1.2.3.4"), now, kTTL);
+  cache.Set(Key("b.com"), OK, Addresses("::1"), now, kTTL * 2);
+  cache.Set(Key("c.com"), OK, Addresses("5.6.7.8"), now, kTTL * 3);
+  cache.Set(Key("failed.com"), ERR_NAME_NOT_RESOLVED, AddressList(), now,
+            kTTL * 4);
+
+  // Only successful entries are saved, the ones that expire last first.
+  scoped_ptr<base::ListValue> list(cache.GetAsListValue(now, wall_now, 2));
+  ASSERT_EQ(2U, list->GetSize());
+
+  // Restore five seconds later, into an empty cache and one third of the way
+  // to the first expiration.
+  HostCache restored_cache(kMaxCacheEntries);
+  base::TimeTicks later = now + base::TimeDelta::FromSeconds(5);
+  base::Time wall_later = wall_now + base::TimeDelta::FromSeconds(5);
+  restored_cache.Set(Key("c.com"), OK, Addresses("9.9.9.9"), later, kTTL);
+  EXPECT_EQ(1U, restored_cache.RestoreFromListValue(*list, later, wall_later));
+  EXPECT_EQ(2U, restored_cache.size());
+
+  // Existing entries are not replaced.
+  const HostCache::Entry* entry = restored_cache.Lookup(Key("c.com"), later);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ("9.9.9.9", NetAddressToString(entry->addrlist.head()));
+
+  // Restored entries keep their addresses, and what remained of their TTL.
+  entry = restored_cache.Lookup(Key("b.com"), later);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(OK, entry->error);
+  EXPECT_EQ("::1", NetAddressToString(entry->addrlist.head()));
+  EXPECT_FALSE(restored_cache.Lookup(Key("a.com"), later));
+  EXPECT_TRUE(restored_cache.Lookup(Key("b.com"), later + kTTL));
+  EXPECT_FALSE(restored_cache.Lookup(Key("b.com"), later + kTTL * 2));
+
+  // Entries that expired since they were saved are restored as stale.
+  HostCache stale_cache(kMaxCacheEntries);
+  EXPECT_EQ(2U, stale_cache.RestoreFromListValue(
+      *list, now, wall_now + kTTL * 5));
+  bool is_stale = false;
+  EXPECT_TRUE(stale_cache.LookupStale(Key("b.com"), now, &is_stale));
+  EXPECT_TRUE(is_stale);
+
+  // Unless they expired long ago.
+  HostCache old_cache(kMaxCacheEntries);
+  EXPECT_EQ(0U, old_cache.RestoreFromListValue(
+      *list, now, wall_now + base::TimeDelta::FromDays(2)));
+}
+
 // Tests the less than and equal operators for HostCache::Key work.
 TEST(HostCacheTest, KeyComparators) {
   struct {
@@ -68,6 +68,9 @@ class NET_EXPORT HostResolver {
     bool allow_cached_response() const { return allow_cached_response_; }
     void set_allow_cached_response(bool b) { allow_cached_response_ = b; }
 
+    bool allow_stale_response() const { return allow_stale_response_; }
+    void set_allow_stale_response(bool b) { allow_stale_response_ = b; }
+
     bool is_speculative() const { return is_speculative_; }
     void set_is_speculative(bool b) { is_speculative_ = b; }
 
@@ -87,6 +90,10 @@ class NET_EXPORT HostResolver {
     // Whether it is ok to return a result from the host cache.
     bool allow_cached_response_;
 
+    // Whether it is ok to return a successful result from the host cache after
+    // it expired. The entry is then refreshed in the background.
+    bool allow_stale_response_;
+
     // Whether this request was started by the DNS prefetcher.
     bool is_speculative_;
 
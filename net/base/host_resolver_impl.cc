@@ -1043,7 +1043,9 @@ class HostResolverImpl::IPv6ProbeJob
 
 //-----------------------------------------------------------------------------
 
-// Resolves the hostname using DnsTransaction.
+// Resolves the hostname using DnsTransaction. When the address family is
+// unspecified, the A and AAAA queries are sent in parallel and the IPv4
+// addresses are returned ahead of the IPv6 ones.
 // TODO(szym): This could be moved to separate source file as well.
 class HostResolverImpl::DnsTask {
  public:
@@ -1055,27 +1057,48 @@ class HostResolverImpl::DnsTask {
           const Key& key,
           const Callback& callback,
           const BoundNetLog& job_net_log)
-      : callback_(callback), net_log_(job_net_log) {
+      : callback_(callback),
+        net_log_(job_net_log),
+        num_pending_transactions_(0),
+        net_error_(OK),
+        dns_error_(DnsResponse::DNS_SUCCESS),
+        has_ttl_(false) {
     DCHECK(factory);
     DCHECK(!callback.is_null());
 
-    // For now we treat ADDRESS_FAMILY_UNSPEC as if it was IPV4.
-    uint16 qtype = (key.address_family == ADDRESS_FAMILY_IPV6)
-                   ? dns_protocol::kTypeAAAA
-                   : dns_protocol::kTypeA;
-    // TODO(szym): Implement "happy eyeballs".
-    transaction_ = factory->CreateTransaction(
-        key.hostname,
-        qtype,
-        base::Bind(&DnsTask::OnTransactionComplete, base::Unretained(this),
-                   base::TimeTicks::Now()),
-        net_log_);
-    DCHECK(transaction_.get());
+    base::TimeTicks now = base::TimeTicks::Now();
+    if (key.address_family != ADDRESS_FAMILY_IPV6) {
+      transaction_a_ = factory->CreateTransaction(
+          key.hostname,
+          dns_protocol::kTypeA,
+          base::Bind(&DnsTask::OnTransactionComplete, base::Unretained(this),
+                     now),
+          net_log_);
+      DCHECK(transaction_a_.get());
+    }
+    if (key.address_family != ADDRESS_FAMILY_IPV4) {
+      transaction_aaaa_ = factory->CreateTransaction(
+          key.hostname,
+          dns_protocol::kTypeAAAA,
+          base::Bind(&DnsTask::OnTransactionComplete, base::Unretained(this),
+                     now),
+          net_log_);
+      DCHECK(transaction_aaaa_.get());
+    }
   }
 
+  // Returns ERR_IO_PENDING if any of the transactions is running, in which
+  // case the callback is run when the last one completes.
   int Start() {
     net_log_.BeginEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK, NULL);
-    return transaction_->Start();
+    StartTransaction(transaction_a_.get());
+    StartTransaction(transaction_aaaa_.get());
+    if (num_pending_transactions_)
+      return ERR_IO_PENDING;
+    DCHECK_NE(OK, net_error_);
+    net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
+                      new DnsTaskFailedParams(net_error_, dns_error_));
+    return net_error_;
   }
 
   void OnTransactionComplete(const base::TimeTicks& start_time,
@@ -1083,7 +1106,9 @@ class HostResolverImpl::DnsTask {
                              int net_error,
                              const DnsResponse* response) {
     DCHECK(transaction);
-    // Run |callback_| last since the owning Job will then delete this DnsTask.
+    DCHECK_GT(num_pending_transactions_, 0);
+    --num_pending_transactions_;
+
     DnsResponse::Result result = DnsResponse::DNS_SUCCESS;
     if (net_error == OK) {
       CHECK(response);
@@ -1096,28 +1121,88 @@ class HostResolverImpl::DnsTask {
                                 result,
                                 DnsResponse::DNS_PARSE_RESULT_MAX);
       if (result == DnsResponse::DNS_SUCCESS) {
-        net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
-                          new AddressListNetLogParam(addr_list));
-        callback_.Run(net_error, addr_list, ttl);
-        return;
+        if (transaction == transaction_a_.get())
+          addr_list_a_ = addr_list;
+        else
+          addr_list_aaaa_ = addr_list;
+        if (!has_ttl_ || ttl < ttl_)
+          ttl_ = ttl;
+        has_ttl_ = true;
+      } else {
+        RecordFailure(ERR_DNS_MALFORMED_RESPONSE, result);
       }
-      net_error = ERR_DNS_MALFORMED_RESPONSE;
     } else {
       DNS_HISTOGRAM("AsyncDNS.TransactionFailure",
                     base::TimeTicks::Now() - start_time);
+      RecordFailure(net_error, result);
+    }
+
+    if (num_pending_transactions_)
+      return;
+
+    // Run |callback_| last since the owning Job will then delete this DnsTask.
+    // A host with no addresses of one family still resolves if the other
+    // family has some.
+    if (addr_list_a_.head()) {
+      AddressList addr_list = addr_list_a_;
+      if (addr_list_aaaa_.head())
+        addr_list.Append(addr_list_aaaa_.head());
+      CompleteWithAddresses(addr_list);
+    } else if (addr_list_aaaa_.head()) {
+      CompleteWithAddresses(addr_list_aaaa_);
+    } else {
+      DCHECK_NE(OK, net_error_);
+      net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
+                        new DnsTaskFailedParams(net_error_, dns_error_));
+      callback_.Run(net_error_, AddressList(), base::TimeDelta());
     }
-    net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
-                      new DnsTaskFailedParams(net_error, result));
-    callback_.Run(net_error, AddressList(), base::TimeDelta());
   }
 
  private:
+  void StartTransaction(DnsTransaction* transaction) {
+    if (!transaction)
+      return;
+    int rv = transaction->Start();
+    if (rv == ERR_IO_PENDING) {
+      ++num_pending_transactions_;
+    } else {
+      DCHECK_NE(OK, rv);
+      RecordFailure(rv, DnsResponse::DNS_SUCCESS);
+    }
+  }
+
+  // Keeps the first failure, which is reported if no addresses are found.
+  void RecordFailure(int net_error, DnsResponse::Result dns_error) {
+    if (net_error_ != OK)
+      return;
+    net_error_ = net_error;
+    dns_error_ = dns_error;
+  }
+
+  void CompleteWithAddresses(const AddressList& addr_list) {
+    net_log_.EndEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_DNS_TASK,
+                      new AddressListNetLogParam(addr_list));
+    callback_.Run(OK, addr_list, ttl_);
+  }
+
   // The listener to the results of this DnsTask.
   Callback callback_;
 
   const BoundNetLog net_log_;
 
-  scoped_ptr<DnsTransaction> transaction_;
+  scoped_ptr<DnsTransaction> transaction_a_;
+  scoped_ptr<DnsTransaction> transaction_aaaa_;
+  int num_pending_transactions_;
+
+  // The first failure of the transactions.
+  int net_error_;
+  DnsResponse::Result dns_error_;
+
+  // The results of the successful transactions. |ttl_| is the lowest TTL.
+  AddressList addr_list_a_;
+  AddressList addr_list_aaaa_;
+  base::TimeDelta ttl_;
+  bool has_ttl_;
 };
 
 //-----------------------------------------------------------------------------
@@ -1134,6 +1219,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
         key_(key),
         had_non_speculative_request_(false),
         had_dns_config_(false),
+        is_refresh_(false),
         net_log_(BoundNetLog::Make(request_net_log.net_log(),
                                    NetLog::SOURCE_HOST_RESOLVER_IMPL_JOB)) {
     request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CREATE_JOB, NULL);
@@ -1181,6 +1267,12 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
     handle_ = resolver_->dispatcher_.Add(this, priority);
   }
 
+  // Makes this Job run to completion and cache its result even if it has no
+  // Requests. Used to refresh stale cache entries.
+  void set_is_refresh() {
+    is_refresh_ = true;
+  }
+
   void AddRequest(scoped_ptr<Request> req) {
     DCHECK_EQ(key_.hostname, req->info().hostname());
 
@@ -1230,7 +1322,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
     if (num_active_requests() > 0) {
       if (is_queued())
         handle_ = resolver_->dispatcher_.ChangePriority(handle_, priority());
-    } else {
+    } else if (!is_refresh_) {
       // If we were called from a Request's callback within CompleteRequests,
       // that Request could not have been cancelled, so num_active_requests()
       // could not be 0. Therefore, we are not in CompleteRequests().
@@ -1263,7 +1355,11 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
   // Attempts to serve the job from HOSTS. Returns true if succeeded and
   // this Job was destroyed.
   bool ServeFromHosts() {
-    DCHECK_GT(num_active_requests(), 0u);
+    if (!num_active_requests()) {
+      // Nobody is waiting for a refresh, so let it run.
+      DCHECK(is_refresh_);
+      return false;
+    }
     AddressList addr_list;
     if (resolver_->ServeFromHosts(key(),
                                   requests_->front()->info(),
@@ -1415,7 +1511,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
       handle_.Reset();
     }
 
-    if (num_active_requests() == 0) {
+    if (num_active_requests() == 0 && !is_refresh_) {
       net_log_.AddEvent(NetLog::TYPE_CANCELLED, NULL);
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                         OK);
@@ -1425,11 +1521,11 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
     net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                       net_error);
 
-    DCHECK(!requests_.empty());
+    DCHECK(is_refresh_ || !requests_.empty());
 
     // We are the only consumer of |list|, so we can safely change the port
     // without copy-on-write. This pays off, when job has only one request.
-    if (net_error == OK)
+    if (net_error == OK && !requests_.empty())
       MutableSetPort(requests_->front()->info().port(), &list);
 
     if ((net_error != ERR_ABORTED) &&
@@ -1488,6 +1584,9 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job {
   // True if resolver had DnsConfig when the Job was started.
   bool had_dns_config_;
 
+  // True if the Job refreshes a stale cache entry.
+  bool is_refresh_;
+
   BoundNetLog net_log_;
 
   // Resolves the host using a HostResolverProc.
@@ -1660,7 +1759,7 @@ int HostResolverImpl::ResolveHelper(const Key& key,
   int net_error = ERR_UNEXPECTED;
   if (ResolveAsIP(key, info, &net_error, addresses))
     return net_error;
-  if (ServeFromCache(key, info, &net_error, addresses)) {
+  if (ServeFromCache(key, info, &net_error, addresses, request_net_log)) {
     request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT, NULL);
     return net_error;
   }
@@ -1768,23 +1867,56 @@ bool HostResolverImpl::ResolveAsIP(const Key& key,
 bool HostResolverImpl::ServeFromCache(const Key& key,
                                       const RequestInfo& info,
                                       int* net_error,
-                                      AddressList* addresses) {
+                                      AddressList* addresses,
+                                      const BoundNetLog& request_net_log) {
   DCHECK(addresses);
   DCHECK(net_error);
   if (!info.allow_cached_response() || !cache_.get())
     return false;
 
-  const HostCache::Entry* cache_entry = cache_->Lookup(
-      key, base::TimeTicks::Now());
+  const HostCache::Entry* cache_entry = NULL;
+  bool is_stale = false;
+  if (info.allow_stale_response()) {
+    cache_entry = cache_->LookupStale(key, base::TimeTicks::Now(), &is_stale);
+    // Failures are not worth serving once they expired.
+    if (cache_entry && is_stale && cache_entry->error != OK)
+      cache_entry = NULL;
+  } else {
+    cache_entry = cache_->Lookup(key, base::TimeTicks::Now());
+  }
   if (!cache_entry)
     return false;
 
+  if (is_stale) {
+    request_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_STALE_CACHE_HIT,
+                             NULL);
+    // Copy the addresses first, since the refresh may replace the entry.
+    *net_error = OK;
+    *addresses = CreateAddressListUsingPort(cache_entry->addrlist, info.port());
+    RefreshCacheEntry(key, request_net_log);
+    return true;
+  }
+
   *net_error = cache_entry->error;
   if (*net_error == OK)
     *addresses = CreateAddressListUsingPort(cache_entry->addrlist, info.port());
   return true;
 }
 
+void HostResolverImpl::RefreshCacheEntry(const Key& key,
+                                         const BoundNetLog& request_net_log) {
+  if (jobs_.count(key))
+    return;
+  // Do not push out Jobs that have Requests waiting.
+  if (dispatcher_.num_queued_jobs() >= max_queued_jobs_)
+    return;
+
+  Job* job = new Job(this, key, request_net_log);
+  job->set_is_refresh();
+  jobs_.insert(std::make_pair(key, job));
+  job->Schedule(IDLE);
+}
+
 bool HostResolverImpl::ServeFromHosts(const Key& key,
                                       const RequestInfo& info,
                                       AddressList* addresses) {
@@ -178,11 +178,17 @@ class NET_EXPORT HostResolverImpl
 
   // If |key| is not found in cache returns false, otherwise returns
   // true, sets |net_error| to the cached error code and fills |addresses|
-  // if it is a positive entry.
+  // if it is a positive entry. A positive entry that expired is served if
+  // |info| allows stale responses, and a Job is started to refresh it.
   bool ServeFromCache(const Key& key,
                       const RequestInfo& info,
                       int* net_error,
-                      AddressList* addresses);
+                      AddressList* addresses,
+                      const BoundNetLog& request_net_log);
+
+  // Starts a Job without Requests for |key|, unless there is a Job for it
+  // already, so that the result replaces the expired entry in the cache.
+  void RefreshCacheEntry(const Key& key, const BoundNetLog& request_net_log);
 
   // If |key| is not found in the HOSTS file or no HOSTS file known, returns
   // false, otherwise returns true and fills |addresses|.
@@ -1208,6 +1208,61 @@ TEST_F(HostResolverImplTest, ResolveFromCache) {
   EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
 }
 
+TEST_F(HostResolverImplTest, ServeStaleFromCache) {
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+  proc_->SignalMultiple(1u);  // Need only one, for the refresh.
+
+  // Put an expired entry in the cache.
+  IPAddressNumber stale_address;
+  ASSERT_TRUE(ParseIPLiteralToNumber("192.168.1.1", &stale_address));
+  HostCache::Key key("just.testing", ADDRESS_FAMILY_UNSPECIFIED, 0);
+  resolver_->GetHostCache()->Set(
+      key, OK, AddressList::CreateFromIPAddress(stale_address, 0),
+      base::TimeTicks::Now(), base::TimeDelta());
+
+  // Requests that allow it are served the stale addresses right away.
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  info.set_allow_stale_response(true);
+  EXPECT_EQ(OK, CreateRequest(info)->Resolve());
+  EXPECT_TRUE(requests_[0]->HasOneAddress("192.168.1.1", 80));
+
+  // Others wait for the refresh that was started.
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_EQ(OK, requests_[1]->WaitForResult());
+  EXPECT_TRUE(requests_[1]->HasOneAddress("192.168.1.42", 80));
+  EXPECT_EQ(1u, proc_->GetCaptureList().size());
+
+  // The refresh replaced the stale entry.
+  EXPECT_EQ(OK, CreateRequest(info)->ResolveFromCache());
+  EXPECT_TRUE(requests_[2]->HasOneAddress("192.168.1.42", 80));
+}
+
+// A refresh keeps running when it is the only thing left to do.
+TEST_F(HostResolverImplTest, StaleRefreshWithoutRequests) {
+  proc_->AddRuleForAllFamilies("just.testing", "192.168.1.42");
+
+  IPAddressNumber stale_address;
+  ASSERT_TRUE(ParseIPLiteralToNumber("192.168.1.1", &stale_address));
+  HostCache::Key key("just.testing", ADDRESS_FAMILY_UNSPECIFIED, 0);
+  resolver_->GetHostCache()->Set(
+      key, OK, AddressList::CreateFromIPAddress(stale_address, 0),
+      base::TimeTicks::Now(), base::TimeDelta());
+
+  HostResolver::RequestInfo info(HostPortPair("just.testing", 80));
+  info.set_allow_stale_response(true);
+  EXPECT_EQ(OK, CreateRequest(info)->Resolve());
+
+  // A Request that attaches to the refresh and is cancelled does not stop it.
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("just.testing", 80)->Resolve());
+  requests_[1]->Cancel();
+  proc_->SignalMultiple(1u);
+
+  // Wait for the refresh by attaching another Request to it.
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("just.testing", 80)->Resolve());
+  EXPECT_EQ(OK, requests_[2]->WaitForResult());
+  EXPECT_EQ(1u, proc_->GetCaptureList().size());
+}
+
 // Test the retry attempts simulating host resolver proc that takes too long.
 TEST_F(HostResolverImplTest, MultipleAttempts) {
   // Total number of attempts would be 3 and we want the 3rd attempt to resolve
@@ -1293,8 +1348,10 @@ TEST_F(HostResolverImplTest, DnsTask) {
   }
 
   EXPECT_EQ(OK, requests_[1]->result());
-  // Resolved by MockDnsClient.
-  EXPECT_TRUE(requests_[1]->HasOneAddress("127.0.0.1", 80));
+  // Resolved by MockDnsClient, which answers both the A and AAAA queries.
+  EXPECT_TRUE(requests_[1]->HasAddress("127.0.0.1", 80));
+  EXPECT_TRUE(requests_[1]->HasAddress("::1", 80));
+  EXPECT_EQ(2u, requests_[1]->NumberOfAddresses());
   EXPECT_EQ(ERR_NAME_NOT_RESOLVED, requests_[2]->result());
   EXPECT_EQ(ERR_NAME_NOT_RESOLVED, requests_[3]->result());
   EXPECT_EQ(OK, requests_[4]->result());
@@ -1303,6 +1360,30 @@ TEST_F(HostResolverImplTest, DnsTask) {
   EXPECT_TRUE(requests_[5]->HasOneAddress("192.168.1.102", 80));
 }
 
+// Test that the A and AAAA queries of a DnsTask are combined.
+TEST_F(HostResolverImplTest, DnsTaskBothFamilies) {
+  // All hostnames fail in proc_.
+  set_dns_client(CreateMockDnsClient(CreateValidDnsConfig()));
+
+  EXPECT_EQ(ERR_IO_PENDING, CreateRequest("4ok", 80)->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING,
+            CreateRequest("ok", 80, MEDIUM, ADDRESS_FAMILY_IPV6)->Resolve());
+  EXPECT_EQ(ERR_IO_PENDING,
+            CreateRequest("4ok", 80, MEDIUM, ADDRESS_FAMILY_IPV6)->Resolve());
+  proc_->SignalMultiple(requests_.size());
+
+  // A missing AAAA answer does not fail the resolution.
+  EXPECT_EQ(OK, requests_[0]->WaitForResult());
+  EXPECT_TRUE(requests_[0]->HasOneAddress("127.0.0.1", 80));
+
+  // Only AAAA is asked for when the family is IPv6.
+  EXPECT_EQ(OK, requests_[1]->WaitForResult());
+  EXPECT_TRUE(requests_[1]->HasOneAddress("::1", 80));
+
+  // Falls back to proc_, which fails.
+  EXPECT_EQ(ERR_NAME_NOT_RESOLVED, requests_[2]->WaitForResult());
+}
+
 TEST_F(HostResolverImplTest, ServeFromHosts) {
   // Initially, there's DnsConfigService, but no DnsConfig.
   MockDnsConfigService* config_service = new MockDnsConfigService();
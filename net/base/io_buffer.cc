@@ -5,6 +5,7 @@
 #include "net/base/io_buffer.h"
 
 #include "base/logging.h"
+#include "net/base/io_buffer_pool.h"
 
 namespace net {
 
@@ -39,6 +40,16 @@ IOBufferWithSize::IOBufferWithSize(char* data, int size)
 IOBufferWithSize::~IOBufferWithSize() {
 }
 
+PooledIOBuffer::PooledIOBuffer(int size)
+    : IOBufferWithSize(IOBufferPool::Allocate(size), size) {
+}
+
+PooledIOBuffer::~PooledIOBuffer() {
+  IOBufferPool::Release(data_, size_);
+  // Prevent ~IOBuffer() from deleting the pool's storage.
+  data_ = NULL;
+}
+
 StringIOBuffer::StringIOBuffer(const std::string& s)
     : IOBuffer(static_cast<char*>(NULL)),
       string_data_(s) {
@@ -110,6 +110,17 @@ class NET_EXPORT IOBufferWithSize : public IOBuffer {
   int size_;
 };
 
+// This version takes its storage from IOBufferPool, and gives it back when the
+// last reference goes away.  Use it for the transient buffers of busy read and
+// write paths, where it saves a heap allocation and free per operation.
+class NET_EXPORT PooledIOBuffer : public IOBufferWithSize {
+ public:
+  explicit PooledIOBuffer(int size);
+
+ private:
+  virtual ~PooledIOBuffer();
+};
+
 // This is a read only IOBuffer.  The data is stored in a string and
 // the IOBuffer interface does not provide a proper way to modify it.
 class NET_EXPORT StringIOBuffer : public IOBuffer {
@@ -0,0 +1,192 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer_pool.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/threading/thread_local_storage.h"
+#include "base/values.h"
+
+namespace net {
+
+namespace {
+
+const int kSizeClasses[] = {
+  4 * 1024,
+  16 * 1024,
+  32 * 1024,
+  512 * 1024,
+};
+
+// How many free blocks of each size a thread keeps, bounding what an idle
+// thread holds on to at a little over 1MB.
+const size_t kMaxFreeBlocks[] = {
+  32,
+  16,
+  8,
+  1,
+};
+
+const int kNumSizeClasses = arraysize(kSizeClasses);
+COMPILE_ASSERT(arraysize(kMaxFreeBlocks) == kNumSizeClasses,
+               size_class_tables_mismatch);
+
+// Returns the index of the smallest size class holding |size| bytes, or -1
+// if there is none.
+int GetSizeClass(int size) {
+  for (int i = 0; i < kNumSizeClasses; ++i) {
+    if (size <= kSizeClasses[i])
+      return i;
+  }
+  return -1;
+}
+
+// The free blocks of one thread.
+struct FreeLists {
+  ~FreeLists() {
+    for (int i = 0; i < kNumSizeClasses; ++i) {
+      for (size_t j = 0; j < blocks[i].size(); ++j)
+        delete[] blocks[i][j];
+    }
+  }
+
+  std::vector<char*> blocks[kNumSizeClasses];
+};
+
+// Counts for one size class, updated from every thread.
+struct SizeClassStats {
+  // Blocks handed out, and how many of those came off a free list.
+  base::subtle::Atomic32 allocations;
+  base::subtle::Atomic32 reused;
+  // Blocks given back, and how many of those were freed because the free
+  // list was full.
+  base::subtle::Atomic32 releases;
+  base::subtle::Atomic32 discarded;
+};
+
+class Pool {
+ public:
+  Pool() : free_lists_(&DeleteFreeLists), unpooled_allocations_(0) {
+    memset(stats_, 0, sizeof(stats_));
+  }
+
+  char* Allocate(int size) {
+    int size_class = GetSizeClass(size);
+    if (size_class < 0) {
+      base::subtle::NoBarrier_AtomicIncrement(&unpooled_allocations_, 1);
+      return new char[size];
+    }
+
+    SizeClassStats* stats = &stats_[size_class];
+    base::subtle::NoBarrier_AtomicIncrement(&stats->allocations, 1);
+    std::vector<char*>& blocks = GetFreeLists()->blocks[size_class];
+    if (blocks.empty())
+      return new char[kSizeClasses[size_class]];
+
+    base::subtle::NoBarrier_AtomicIncrement(&stats->reused, 1);
+    char* data = blocks.back();
+    blocks.pop_back();
+    return data;
+  }
+
+  void Release(char* data, int size) {
+    int size_class = GetSizeClass(size);
+    if (size_class < 0) {
+      delete[] data;
+      return;
+    }
+
+    SizeClassStats* stats = &stats_[size_class];
+    base::subtle::NoBarrier_AtomicIncrement(&stats->releases, 1);
+    std::vector<char*>& blocks = GetFreeLists()->blocks[size_class];
+    if (blocks.size() >= kMaxFreeBlocks[size_class]) {
+      base::subtle::NoBarrier_AtomicIncrement(&stats->discarded, 1);
+      delete[] data;
+      return;
+    }
+    blocks.push_back(data);
+  }
+
+  base::Value* GetStatsAsValue() const {
+    base::ListValue* size_classes = new base::ListValue();
+    for (int i = 0; i < kNumSizeClasses; ++i) {
+      const SizeClassStats& stats = stats_[i];
+      base::DictionaryValue* dict = new base::DictionaryValue();
+      dict->SetInteger("size", kSizeClasses[i]);
+      dict->SetInteger("allocations",
+                       base::subtle::NoBarrier_Load(&stats.allocations));
+      dict->SetInteger("reused", base::subtle::NoBarrier_Load(&stats.reused));
+      dict->SetInteger("releases",
+                       base::subtle::NoBarrier_Load(&stats.releases));
+      dict->SetInteger("discarded",
+                       base::subtle::NoBarrier_Load(&stats.discarded));
+      size_classes->Append(dict);
+    }
+
+    base::DictionaryValue* value = new base::DictionaryValue();
+    value->Set("size_classes", size_classes);
+    value->SetInteger("unpooled_allocations",
+                      base::subtle::NoBarrier_Load(&unpooled_allocations_));
+    return value;
+  }
+
+ private:
+  FreeLists* GetFreeLists() {
+    FreeLists* free_lists = static_cast<FreeLists*>(free_lists_.Get());
+    if (!free_lists) {
+      free_lists = new FreeLists;
+      free_lists_.Set(free_lists);
+    }
+    return free_lists;
+  }
+
+  static void DeleteFreeLists(void* data) {
+    delete static_cast<FreeLists*>(data);
+  }
+
+  base::ThreadLocalStorage::Slot free_lists_;
+  SizeClassStats stats_[kNumSizeClasses];
+  base::subtle::Atomic32 unpooled_allocations_;
+
+  DISALLOW_COPY_AND_ASSIGN(Pool);
+};
+
+base::LazyInstance<Pool>::Leaky g_pool = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// static
+char* IOBufferPool::Allocate(int size) {
+  DCHECK_GT(size, 0);
+  return g_pool.Get().Allocate(size);
+}
+
+// static
+void IOBufferPool::Release(char* data, int size) {
+  g_pool.Get().Release(data, size);
+}
+
+// static
+base::Value* IOBufferPool::GetStatsAsValue() {
+  return g_pool.Get().GetStatsAsValue();
+}
+
+IOBufferPool::StatsParameters::StatsParameters()
+    : stats_(GetStatsAsValue()) {
+}
+
+base::Value* IOBufferPool::StatsParameters::ToValue() const {
+  return stats_->DeepCopy();
+}
+
+IOBufferPool::StatsParameters::~StatsParameters() {
+}
+
+}  // namespace net
@@ -0,0 +1,62 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_IO_BUFFER_POOL_H_
+#define NET_BASE_IO_BUFFER_POOL_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/net_export.h"
+#include "net/base/net_log.h"
+
+namespace base {
+class Value;
+}
+
+namespace net {
+
+// Per-thread free lists of IOBuffer storage in the sizes the network stack
+// reads into most: 4K, 16K, 32K and the 512K a resource handler grows its
+// read buffer to.  A request is served from the smallest size that fits it;
+// larger requests go straight to the heap.  Storage may be given back on any
+// thread, and then lands on that thread's free lists, which only keep a few
+// blocks of each size and are freed with the thread.
+//
+// Normally used through PooledIOBuffer.
+class NET_EXPORT IOBufferPool {
+ public:
+  // Returns storage for at least |size| bytes.
+  static char* Allocate(int size);
+
+  // Gives back |data|, which Allocate(|size|) returned.
+  static void Release(char* data, int size);
+
+  // Returns the allocation counts so far, for all threads.  The caller takes
+  // ownership of the value.
+  static base::Value* GetStatsAsValue();
+
+  // NetLog parameters holding GetStatsAsValue() at the time of creation.
+  class NET_EXPORT StatsParameters : public NetLog::EventParameters {
+   public:
+    StatsParameters();
+
+    virtual base::Value* ToValue() const OVERRIDE;
+
+   private:
+    virtual ~StatsParameters();
+
+    scoped_ptr<base::Value> stats_;
+
+    DISALLOW_COPY_AND_ASSIGN(StatsParameters);
+  };
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(IOBufferPool);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_IO_BUFFER_POOL_H_
@@ -0,0 +1,103 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/io_buffer_pool.h"
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/values.h"
+#include "net/base/io_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kSmallSizeClass = 0;
+const int kSmallSize = 4 * 1024;
+
+// Returns the count |name| of size class |size_class|.
+int GetStat(int size_class, const char* name) {
+  scoped_ptr<base::Value> value(IOBufferPool::GetStatsAsValue());
+  base::DictionaryValue* stats = NULL;
+  base::ListValue* size_classes = NULL;
+  base::DictionaryValue* size_class_stats = NULL;
+  int count = -1;
+  EXPECT_TRUE(value->GetAsDictionary(&stats));
+  EXPECT_TRUE(stats->GetList("size_classes", &size_classes));
+  EXPECT_TRUE(size_classes->GetDictionary(size_class, &size_class_stats));
+  EXPECT_TRUE(size_class_stats->GetInteger(name, &count));
+  return count;
+}
+
+int GetUnpooledAllocations() {
+  scoped_ptr<base::Value> value(IOBufferPool::GetStatsAsValue());
+  base::DictionaryValue* stats = NULL;
+  int count = -1;
+  EXPECT_TRUE(value->GetAsDictionary(&stats));
+  EXPECT_TRUE(stats->GetInteger("unpooled_allocations", &count));
+  return count;
+}
+
+}  // namespace
+
+TEST(IOBufferPoolTest, ReusesStorage) {
+  scoped_refptr<PooledIOBuffer> buffer(new PooledIOBuffer(1000));
+  EXPECT_EQ(1000, buffer->size());
+  char* data = buffer->data();
+  buffer = NULL;
+
+  // Any size up to the size class gets the block back.
+  int reused = GetStat(kSmallSizeClass, "reused");
+  buffer = new PooledIOBuffer(kSmallSize);
+  EXPECT_EQ(data, buffer->data());
+  EXPECT_EQ(kSmallSize, buffer->size());
+  EXPECT_EQ(reused + 1, GetStat(kSmallSizeClass, "reused"));
+
+  // The whole block can be written to.
+  memset(buffer->data(), 'x', kSmallSize);
+}
+
+TEST(IOBufferPoolTest, SizeClassesAreSeparate) {
+  scoped_refptr<PooledIOBuffer> small(new PooledIOBuffer(kSmallSize));
+  char* small_data = small->data();
+  small = NULL;
+
+  scoped_refptr<PooledIOBuffer> large(new PooledIOBuffer(kSmallSize + 1));
+  EXPECT_NE(small_data, large->data());
+  small = new PooledIOBuffer(kSmallSize);
+  EXPECT_EQ(small_data, small->data());
+}
+
+TEST(IOBufferPoolTest, FreeListsAreBounded) {
+  const int kNumBuffers = 100;
+  scoped_refptr<PooledIOBuffer> buffers[kNumBuffers];
+  for (int i = 0; i < kNumBuffers; ++i)
+    buffers[i] = new PooledIOBuffer(kSmallSize);
+
+  int discarded = GetStat(kSmallSizeClass, "discarded");
+  int releases = GetStat(kSmallSizeClass, "releases");
+  for (int i = 0; i < kNumBuffers; ++i)
+    buffers[i] = NULL;
+  EXPECT_EQ(releases + kNumBuffers, GetStat(kSmallSizeClass, "releases"));
+  EXPECT_LT(discarded, GetStat(kSmallSizeClass, "discarded"));
+}
+
+TEST(IOBufferPoolTest, LargeBuffersAreNotPooled) {
+  const int kLargeSize = 1024 * 1024;
+  int unpooled = GetUnpooledAllocations();
+  scoped_refptr<PooledIOBuffer> buffer(new PooledIOBuffer(kLargeSize));
+  memset(buffer->data(), 'x', kLargeSize);
+  EXPECT_EQ(unpooled + 1, GetUnpooledAllocations());
+}
+
+TEST(IOBufferPoolTest, StatsParameters) {
+  scoped_refptr<IOBufferPool::StatsParameters> params(
+      new IOBufferPool::StatsParameters());
+  scoped_ptr<base::Value> value(params->ToValue());
+  scoped_ptr<base::Value> stats(IOBufferPool::GetStatsAsValue());
+  EXPECT_TRUE(value->Equals(stats.get()));
+}
+
+}  // namespace net
@@ -4,6 +4,7 @@
 
 #include "net/base/multi_threaded_cert_verifier.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "base/bind.h"
@@ -77,6 +78,25 @@ const unsigned kMaxCacheEntries = 256;
 // The number of seconds for which we'll cache a cache entry.
 const unsigned kTTLSecs = 1800;  // 30 minutes.
 
+uint32 GetCRLSetSequence(CRLSet* crl_set) {
+  return crl_set ? crl_set->sequence() : 0;
+}
+
+// Returns the earliest expiry time of |cert| and its intermediates.
+base::Time GetChainExpiry(X509Certificate* cert) {
+  base::Time expiry = cert->valid_expiry();
+  const X509Certificate::OSCertHandles& intermediates =
+      cert->GetIntermediateCertificates();
+  for (size_t i = 0; i < intermediates.size(); ++i) {
+    scoped_refptr<X509Certificate> intermediate(
+        X509Certificate::CreateFromHandle(
+            intermediates[i], X509Certificate::OSCertHandles()));
+    if (intermediate && intermediate->valid_expiry() < expiry)
+      expiry = intermediate->valid_expiry();
+  }
+  return expiry;
+}
+
 }  // namespace
 
 MultiThreadedCertVerifier::CachedResult::CachedResult() : error(ERR_FAILED) {}
@@ -199,6 +219,7 @@ class CertVerifierWorker {
       base::AutoLock locked(lock_);
       if (!canceled_) {
         cert_verifier_->HandleResult(cert_, hostname_, flags_,
+                                     GetCRLSetSequence(crl_set_),
                                      error_, verify_result_);
       }
     }
@@ -360,11 +381,12 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
   requests_++;
 
   const RequestParams key(cert->fingerprint(), cert->ca_fingerprint(),
-                          hostname, flags);
+                          hostname, flags, GetCRLSetSequence(crl_set));
   const CertVerifierCache::value_type* cached_entry =
       cache_.Get(key, base::TimeTicks::Now());
   if (cached_entry) {
     ++cache_hits_;
+    net_log.AddEvent(NetLog::TYPE_CERT_VERIFIER_CACHE_HIT, NULL);
     *out_req = NULL;
     *verify_result = cached_entry->result;
     return cached_entry->error;
@@ -417,18 +439,27 @@ void MultiThreadedCertVerifier::HandleResult(
     X509Certificate* cert,
     const std::string& hostname,
     int flags,
+    uint32 crl_set_sequence,
     int error,
     const CertVerifyResult& verify_result) {
   DCHECK(CalledOnValidThread());
 
   const RequestParams key(cert->fingerprint(), cert->ca_fingerprint(),
-                          hostname, flags);
+                          hostname, flags, crl_set_sequence);
 
   CachedResult cached_result;
   cached_result.error = error;
   cached_result.result = verify_result;
-  cache_.Put(key, cached_result, base::TimeTicks::Now(),
-             base::TimeDelta::FromSeconds(kTTLSecs));
+
+  // A successful result must not outlive the chain it was computed for.
+  base::TimeDelta ttl = base::TimeDelta::FromSeconds(kTTLSecs);
+  if (error == OK) {
+    X509Certificate* chain = verify_result.verified_cert ?
+        verify_result.verified_cert.get() : cert;
+    ttl = std::min(ttl, GetChainExpiry(chain) - base::Time::Now());
+  }
+  if (ttl > base::TimeDelta())
+    cache_.Put(key, cached_result, base::TimeTicks::Now(), ttl);
 
   std::map<RequestParams, CertVerifierJob*>::iterator j;
   j = inflight_.find(key);
@@ -71,18 +71,23 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
     RequestParams(const SHA1Fingerprint& cert_fingerprint_arg,
                   const SHA1Fingerprint& ca_fingerprint_arg,
                   const std::string& hostname_arg,
-                  int flags_arg)
+                  int flags_arg,
+                  uint32 crl_set_sequence_arg)
         : cert_fingerprint(cert_fingerprint_arg),
           ca_fingerprint(ca_fingerprint_arg),
           hostname(hostname_arg),
-          flags(flags_arg) {}
+          flags(flags_arg),
+          crl_set_sequence(crl_set_sequence_arg) {}
 
     bool operator<(const RequestParams& other) const {
-      // |flags| is compared before |cert_fingerprint|, |ca_fingerprint|, and
-      // |hostname| under assumption that integer comparisons are faster than
-      // memory and string comparisons.
+      // |flags| and |crl_set_sequence| are compared before
+      // |cert_fingerprint|, |ca_fingerprint|, and |hostname| under assumption
+      // that integer comparisons are faster than memory and string
+      // comparisons.
       if (flags != other.flags)
         return flags < other.flags;
+      if (crl_set_sequence != other.crl_set_sequence)
+        return crl_set_sequence < other.crl_set_sequence;
       int rv = memcmp(cert_fingerprint.data, other.cert_fingerprint.data,
                       sizeof(cert_fingerprint.data));
       if (rv != 0)
@@ -98,6 +103,9 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
     SHA1Fingerprint ca_fingerprint;
     std::string hostname;
     int flags;
+    // The sequence number of the CRLSet used, or 0 if there was none. A result
+    // is not reused once a newer CRLSet is available.
+    uint32 crl_set_sequence;
   };
 
   // CachedResult contains the result of a certificate verification.
@@ -112,6 +120,7 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
   void HandleResult(X509Certificate* cert,
                     const std::string& hostname,
                     int flags,
+                    uint32 crl_set_sequence,
                     int error,
                     const CertVerifyResult& verify_result);
 
@@ -8,11 +8,13 @@
 #include "base/file_path.h"
 #include "base/format_macros.h"
 #include "base/stringprintf.h"
+#include "net/base/capturing_net_log.h"
 #include "net/base/cert_test_util.h"
 #include "net/base/cert_verify_proc.h"
 #include "net/base/cert_verify_result.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_log.h"
+#include "net/base/net_log_unittest.h"
 #include "net/base/test_completion_callback.h"
 #include "net/base/x509_certificate.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -81,9 +83,10 @@ TEST_F(MultiThreadedCertVerifierTest, CacheHit) {
   ASSERT_EQ(0u, verifier_.inflight_joins());
   ASSERT_EQ(1u, verifier_.GetCacheSize());
 
+  CapturingBoundNetLog log(CapturingNetLog::kUnbounded);
   error = verifier_.Verify(test_cert, "www.example.com", 0, NULL,
                            &verify_result, callback.callback(),
-                           &request_handle, BoundNetLog());
+                           &request_handle, log.bound());
   // Synchronous completion.
   ASSERT_NE(ERR_IO_PENDING, error);
   ASSERT_TRUE(IsCertificateError(error));
@@ -92,6 +95,13 @@ TEST_F(MultiThreadedCertVerifierTest, CacheHit) {
   ASSERT_EQ(1u, verifier_.cache_hits());
   ASSERT_EQ(0u, verifier_.inflight_joins());
   ASSERT_EQ(1u, verifier_.GetCacheSize());
+
+  CapturingNetLog::EntryList entries;
+  log.GetEntries(&entries);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_TRUE(LogContainsEvent(entries, 0,
+                               NetLog::TYPE_CERT_VERIFIER_CACHE_HIT,
+                               NetLog::PHASE_NONE));
 }
 
 // Tests the same server certificate with different intermediate CA
@@ -262,42 +272,51 @@ TEST_F(MultiThreadedCertVerifierTest, RequestParamsComparators) {
   } tests[] = {
     {  // Test for basic equivalence.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       0,
     },
     {  // Test that different certificates but with the same CA and for
        // the same host are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       MultiThreadedCertVerifier::RequestParams(z_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       -1,
     },
     {  // Test that the same EE certificate for the same host, but with
        // different chains are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, z_key, "www.example.test",
-                                               0),
+                                               0, 0),
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               0),
+                                               0, 0),
       1,
     },
     {  // The same certificate, with the same chain, but for different
        // hosts are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key,
-                                               "www1.example.test", 0),
+                                               "www1.example.test", 0, 0),
       MultiThreadedCertVerifier::RequestParams(a_key, a_key,
-                                               "www2.example.test", 0),
+                                               "www2.example.test", 0, 0),
       -1,
     },
     {  // The same certificate, chain, and host, but with different flags
        // are different validation keys.
       MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
-                                               X509Certificate::VERIFY_EV_CERT),
-      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               X509Certificate::VERIFY_EV_CERT,
                                                0),
+      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               0, 0),
       1,
+    },
+    {  // The same certificate, chain, host, and flags, but checked against
+       // different CRLSets are different validation keys.
+      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               0, 1),
+      MultiThreadedCertVerifier::RequestParams(a_key, a_key, "www.example.test",
+                                               0, 2),
+      -1,
     }
   };
   for (size_t i = 0; i < ARRAYSIZE_UNSAFE(tests); ++i) {
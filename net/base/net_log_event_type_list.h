@@ -62,6 +62,10 @@ EVENT_TYPE(HOST_RESOLVER_IMPL_REQUEST)
 // This event is logged when a request is handled by a cache entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_CACHE_HIT)
 
+// This event is logged when a request is handled by a cache entry that has
+// expired, and a Job is started to refresh it.
+EVENT_TYPE(HOST_RESOLVER_IMPL_STALE_CACHE_HIT)
+
 // This event is logged when a request is handled by a HOSTS entry.
 EVENT_TYPE(HOST_RESOLVER_IMPL_HOSTS_HIT)
 
@@ -1408,6 +1412,10 @@ EVENT_TYPE(CHROME_POLICY_ABORTED_REQUEST)
 // This event is created when we start a CertVerifier request.
 EVENT_TYPE(CERT_VERIFIER_REQUEST)
 
+// This event is emitted when a CertVerifier request is answered from the
+// cache of recent results, without starting a request.
+EVENT_TYPE(CERT_VERIFIER_CACHE_HIT)
+
 // This event is created when we start a CertVerifier job.
 // The END phase event parameters are:
 //   {
@@ -1644,3 +1652,24 @@ EVENT_TYPE(FILE_STREAM_CLOSE)
 //     "net_error": <net::Error code>,
 //   }
 EVENT_TYPE(FILE_STREAM_ERROR)
+
+// ------------------------------------------------------------------------
+// IOBufferPool events.
+// ------------------------------------------------------------------------
+
+// A snapshot of the IOBufferPool allocation counts, for all threads, logged
+// when a SPDY session closes.
+//   {
+//     "size_classes": [
+//       {
+//         "size": <The block size>,
+//         "allocations": <Blocks handed out>,
+//         "reused": <How many of those came off a free list>,
+//         "releases": <Blocks given back>,
+//         "discarded": <How many of those were freed, the free list full>,
+//       },
+//       ...
+//     ],
+//     "unpooled_allocations": <Allocations larger than the largest block>,
+//   }
+EVENT_TYPE(IO_BUFFER_POOL_STATS)
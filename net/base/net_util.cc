@@ -1907,6 +1907,10 @@ bool CanStripTrailingSlash(const GURL& url) {
 
 GURL SimplifyUrlForRequest(const GURL& url) {
   DCHECK(url.is_valid());
+  // Most URLs have nothing to strip, and a valid GURL is already canonical,
+  // so skip canonicalizing it all over again.
+  if (!url.has_username() && !url.has_password() && !url.has_ref())
+    return url;
   GURL::Replacements replacements;
   replacements.ClearUsername();
   replacements.ClearPassword();
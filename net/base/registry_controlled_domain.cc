@@ -45,8 +45,10 @@
 
 #include "net/base/registry_controlled_domain.h"
 
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/string_util.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/utf_string_conversions.h"
 #include "googleurl/src/gurl.h"
 #include "googleurl/src/url_parse.h"
@@ -62,6 +64,93 @@ namespace {
 const int kExceptionRule = 1;
 const int kWildcardRule = 2;
 
+// Bumped when the rules change, which makes every thread's recent results
+// stale.
+int g_rules_generation = 0;
+
+// The last few registry lengths found on a thread. Cookie, SDCH and history
+// code ask about the same handful of hosts many times per request, so this
+// saves walking the labels of each against the rules again.
+class RecentRegistryLengths {
+ public:
+  RecentRegistryLengths() {
+    for (size_t i = 0; i < arraysize(entries_); ++i)
+      entries_[i].generation = -1;
+  }
+
+  // Returns true and sets |*length| if the result for |host| is known.
+  bool Lookup(const std::string& host,
+              bool allow_unknown_registries,
+              size_t* length) const {
+    const Entry& entry = entries_[Index(host)];
+    if (entry.generation != g_rules_generation ||
+        entry.allow_unknown_registries != allow_unknown_registries ||
+        entry.host != host)
+      return false;
+    *length = entry.length;
+    return true;
+  }
+
+  void Store(const std::string& host,
+             bool allow_unknown_registries,
+             size_t length) {
+    Entry& entry = entries_[Index(host)];
+    entry.host = host;
+    entry.allow_unknown_registries = allow_unknown_registries;
+    entry.generation = g_rules_generation;
+    entry.length = length;
+  }
+
+ private:
+  struct Entry {
+    std::string host;
+    bool allow_unknown_registries;
+    int generation;
+    size_t length;
+  };
+
+  // Maps |host| to a slot with an FNV-1a hash.
+  static size_t Index(const std::string& host) {
+    uint32 hash = 2166136261u;
+    for (size_t i = 0; i < host.size(); ++i)
+      hash = (hash ^ static_cast<uint8>(host[i])) * 16777619u;
+    return hash % kNumEntries;
+  }
+
+  static const size_t kNumEntries = 32;
+  Entry entries_[kNumEntries];
+
+  DISALLOW_COPY_AND_ASSIGN(RecentRegistryLengths);
+};
+
+// Owns each thread's RecentRegistryLengths.
+class RecentRegistryLengthsSlot {
+ public:
+  RecentRegistryLengthsSlot() : slot_(&Delete) {}
+
+  RecentRegistryLengths* Get() {
+    RecentRegistryLengths* recent =
+        static_cast<RecentRegistryLengths*>(slot_.Get());
+    if (!recent) {
+      recent = new RecentRegistryLengths;
+      slot_.Set(recent);
+    }
+    return recent;
+  }
+
+ private:
+  static void Delete(void* recent) {
+    delete static_cast<RecentRegistryLengths*>(recent);
+  }
+
+  base::ThreadLocalStorage::Slot slot_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecentRegistryLengthsSlot);
+};
+
+base::LazyInstance<RecentRegistryLengthsSlot>::Leaky g_recent_lengths =
+    LAZY_INSTANCE_INITIALIZER;
+
 }  // namespace
 
 RegistryControlledDomainService::FindDomainPtr
@@ -143,6 +232,7 @@ size_t RegistryControlledDomainService::GetRegistryLength(
 void RegistryControlledDomainService::UseFindDomainFunction(
     FindDomainPtr function) {
   find_domain_function_ = function ? function : Perfect_Hash::FindDomain;
+  ++g_rules_generation;
 }
 
 // static
@@ -172,9 +262,23 @@ std::string RegistryControlledDomainService::GetDomainAndRegistryImpl(
   return host.substr(dot + 1);
 }
 
+// static
 size_t RegistryControlledDomainService::GetRegistryLengthImpl(
     const std::string& host,
     bool allow_unknown_registries) {
+  RecentRegistryLengths* recent = g_recent_lengths.Pointer()->Get();
+  size_t length;
+  if (recent->Lookup(host, allow_unknown_registries, &length))
+    return length;
+  length = FindRegistryLength(host, allow_unknown_registries);
+  recent->Store(host, allow_unknown_registries, length);
+  return length;
+}
+
+// static
+size_t RegistryControlledDomainService::FindRegistryLength(
+    const std::string& host,
+    bool allow_unknown_registries) {
   DCHECK(!host.empty());
 
   // Skip leading dots.
@@ -194,12 +194,18 @@ class NET_EXPORT RegistryControlledDomainService {
 
  private:
   friend class RegistryControlledDomainTest;
+  friend class RegistryControlledDomainPerfTest;
 
   // Internal workings of the static public methods.  See above.
   static std::string GetDomainAndRegistryImpl(const std::string& host);
   static size_t GetRegistryLengthImpl(const std::string& host,
                                       bool allow_unknown_registries);
 
+  // Does the work of GetRegistryLengthImpl() without consulting the results
+  // recently found on this thread.
+  static size_t FindRegistryLength(const std::string& host,
+                                   bool allow_unknown_registries);
+
   typedef const struct DomainRule* (*FindDomainPtr)(const char *, unsigned int);
 
   // Used for unit tests, so that a different perfect hash map from the full
@@ -0,0 +1,79 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/perftimer.h"
+#include "net/base/registry_controlled_domain.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumIterations = 100000;
+
+// Hosts of the sort a page and its subresources load from.
+const char* const kHosts[] = {
+  "www.google.com",
+  "ssl.gstatic.com",
+  "mail.google.com",
+  "www.bbc.co.uk",
+  "static.bbci.co.uk",
+  "news.bbc.co.uk",
+  "a.b.c.d.example.com",
+  "foo.bar.kawasaki.jp",
+  "nowhere.foo",
+  "cdn.example.net",
+};
+
+}  // namespace
+
+class RegistryControlledDomainPerfTest : public testing::Test {
+ protected:
+  size_t FindRegistryLength(const std::string& host) {
+    return RegistryControlledDomainService::FindRegistryLength(host, true);
+  }
+
+  size_t GetRegistryLength(const std::string& host) {
+    return RegistryControlledDomainService::GetRegistryLengthImpl(host, true);
+  }
+};
+
+// Compares looking every host up against the rules with looking them up
+// through the results recently found on the thread.
+TEST_F(RegistryControlledDomainPerfTest, GetRegistryLength) {
+  std::string hosts[arraysize(kHosts)];
+  size_t expected[arraysize(kHosts)];
+  for (size_t i = 0; i < arraysize(kHosts); ++i) {
+    hosts[i] = kHosts[i];
+    expected[i] = FindRegistryLength(hosts[i]);
+  }
+
+  PerfTimeLogger uncached_timer("Registry_length_uncached");
+  for (int i = 0; i < kNumIterations; ++i) {
+    size_t j = i % arraysize(kHosts);
+    ASSERT_EQ(expected[j], FindRegistryLength(hosts[j]));
+  }
+  uncached_timer.Done();
+
+  PerfTimeLogger timer("Registry_length");
+  for (int i = 0; i < kNumIterations; ++i) {
+    size_t j = i % arraysize(kHosts);
+    ASSERT_EQ(expected[j], GetRegistryLength(hosts[j]));
+  }
+  timer.Done();
+}
+
+TEST_F(RegistryControlledDomainPerfTest, GetDomainAndRegistry) {
+  PerfTimeLogger timer("Domain_and_registry");
+  for (int i = 0; i < kNumIterations; ++i) {
+    ASSERT_FALSE(RegistryControlledDomainService::GetDomainAndRegistry(
+        kHosts[i % arraysize(kHosts)]).empty());
+  }
+  timer.Done();
+}
+
+}  // namespace net
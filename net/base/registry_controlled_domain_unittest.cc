@@ -216,6 +216,18 @@ TEST_F(RegistryControlledDomainTest, TestSameDomainOrHost) {
                               "file:///C:/file.html"));        // no host
 }
 
+TEST_F(RegistryControlledDomainTest, RepeatedLookupsFollowRuleChanges) {
+  UseDomainData(Perfect_Hash_Test1::FindDomain);
+  EXPECT_EQ("", GetDomainFromHost("a.bar.jp"));  // *.bar.jp
+  EXPECT_EQ("", GetDomainFromHost("a.bar.jp"));
+  EXPECT_EQ(0U, GetRegistryLengthFromHost("a.bar.jp", true));
+
+  UseDomainData(Perfect_Hash_Test2::FindDomain);
+  EXPECT_EQ("a.bar.jp", GetDomainFromHost("a.bar.jp"));  // bar.jp
+  EXPECT_EQ(6U, GetRegistryLengthFromHost("a.bar.jp", true));
+  EXPECT_EQ(6U, GetRegistryLengthFromHost("a.bar.jp", false));
+}
+
 TEST_F(RegistryControlledDomainTest, TestDefaultData) {
   // Note that no data is set: we're using the default rules.
   EXPECT_EQ(3U, GetRegistryLengthFromURL("http://google.com", false));
@@ -311,6 +311,10 @@ Filter::FilterStatus SdchFilter::ReadFilteredData(char* dest_buffer,
   return FILTER_NEED_MORE_DATA;
 }
 
+bool SdchFilter::IsPassThrough() const {
+  return decoding_status_ == PASS_THROUGH && dest_buffer_excess_.empty();
+}
+
 Filter::FilterStatus SdchFilter::InitializeDictionary() {
   const size_t kServerIdLength = 9;  // Dictionary hash plus null from server.
   size_t bytes_needed = kServerIdLength - dictionary_hash_.size();
@@ -1289,10 +1289,11 @@ TEST_F(SdchFilterTest, CanStillSetExactMatchDictionary) {
               GURL("http://" + dictionary_domain)));
 }
 
-// Make sure the DOS protection precludes the addition of too many dictionaries.
+// Make sure adding too many dictionaries evicts the least recently used ones.
 TEST_F(SdchFilterTest, TooManyDictionaries) {
   std::string dictionary_domain(".google.com");
-  std::string dictionary_text(NewSdchDictionary(dictionary_domain));
+  std::string first_dictionary(NewSdchDictionary(dictionary_domain));
+  std::string dictionary_text(first_dictionary);
 
   size_t count = 0;
   while (count <= SdchManager::kMaxDictionaryCount + 1) {
@@ -1303,7 +1304,118 @@ TEST_F(SdchFilterTest, TooManyDictionaries) {
     dictionary_text += " ";  // Create dictionary with different SHA signature.
     ++count;
   }
-  EXPECT_EQ(SdchManager::kMaxDictionaryCount, count);
+  EXPECT_EQ(SdchManager::kMaxDictionaryCount + 2, count);
+
+  std::string list;
+  sdch_manager_->GetAvailDictionaryList(GURL("http://www.google.com"), &list);
+  EXPECT_EQ(SdchManager::kMaxDictionaryCount,
+            static_cast<size_t>(std::count(list.begin(), list.end(), ',') + 1));
+
+  std::string client_hash;
+  std::string server_hash;
+  SdchManager::GenerateHash(first_dictionary, &client_hash, &server_hash);
+  EXPECT_EQ(std::string::npos, list.find(client_hash));
+}
+
+// Make sure the total size of the dictionaries is bounded, and that a
+// dictionary in use survives eviction.
+TEST_F(SdchFilterTest, DictionaryBytesLimitEvictsLeastRecentlyUsed) {
+  std::string dictionary_domain(".google.com");
+  std::string dictionary_text(NewSdchDictionary(dictionary_domain));
+  dictionary_text.append(
+      SdchManager::kMaxDictionarySize - dictionary_text.size() - 10, ' ');
+  GURL url("http://www.google.com");
+
+  std::vector<std::string> server_hashes;
+  size_t fits = SdchManager::kMaxDictionaryBytes /
+      SdchManager::kMaxDictionarySize;
+  for (size_t i = 0; i < fits; ++i) {
+    dictionary_text += " ";
+    EXPECT_TRUE(sdch_manager_->AddSdchDictionary(dictionary_text, url));
+    std::string client_hash;
+    std::string server_hash;
+    SdchManager::GenerateHash(dictionary_text, &client_hash, &server_hash);
+    server_hashes.push_back(server_hash);
+  }
+
+  // Use the oldest dictionary, so the second oldest is evicted instead.
+  SdchManager::Dictionary* dictionary = NULL;
+  sdch_manager_->GetVcdiffDictionary(server_hashes[0], url, &dictionary);
+  EXPECT_TRUE(dictionary != NULL);
+
+  dictionary_text += " ";
+  EXPECT_TRUE(sdch_manager_->AddSdchDictionary(dictionary_text, url));
+
+  dictionary = NULL;
+  sdch_manager_->GetVcdiffDictionary(server_hashes[0], url, &dictionary);
+  EXPECT_TRUE(dictionary != NULL);
+  dictionary = NULL;
+  sdch_manager_->GetVcdiffDictionary(server_hashes[1], url, &dictionary);
+  EXPECT_TRUE(dictionary == NULL);
+}
+
+TEST_F(SdchFilterTest, RestoreDictionary) {
+  std::string dictionary_domain("x.y.z.google.com");
+  GURL url("http://" + dictionary_domain);
+  std::string dictionary_text("Max-Age: 3600\n");
+  dictionary_text.append(NewSdchDictionary(dictionary_domain));
+
+  // A dictionary fetched two hours ago has expired.
+  EXPECT_FALSE(sdch_manager_->RestoreSdchDictionary(
+      dictionary_text, url,
+      base::Time::Now() - base::TimeDelta::FromHours(2)));
+
+  EXPECT_TRUE(sdch_manager_->RestoreSdchDictionary(
+      dictionary_text, url,
+      base::Time::Now() - base::TimeDelta::FromMinutes(30)));
+
+  std::string client_hash;
+  std::string server_hash;
+  SdchManager::GenerateHash(dictionary_text, &client_hash, &server_hash);
+  std::string list;
+  sdch_manager_->GetAvailDictionaryList(url, &list);
+  EXPECT_EQ(client_hash, list);
+}
+
+// The Avail-Dictionary list is cached per server, but must still honor path
+// restrictions and notice new dictionaries.
+TEST_F(SdchFilterTest, AvailDictionaryList) {
+  const std::string kSampleDomain = "sdchtest.com";
+  std::string dictionary(NewSdchDictionary(kSampleDomain));
+  GURL url("http://" + kSampleDomain + "/other");
+  GURL path_url("http://" + kSampleDomain + "/special_path/bin");
+  std::string client_hash;
+  std::string server_hash;
+
+  std::string list;
+  sdch_manager_->GetAvailDictionaryList(url, &list);
+  EXPECT_TRUE(list.empty());
+
+  EXPECT_TRUE(sdch_manager_->AddSdchDictionary(dictionary, url));
+  SdchManager::GenerateHash(dictionary, &client_hash, &server_hash);
+  std::string expected_list(client_hash);
+  sdch_manager_->GetAvailDictionaryList(url, &list);
+  EXPECT_EQ(expected_list, list);
+
+  std::string dictionary_with_path("Path: /special_path\n");
+  dictionary_with_path.append(dictionary);
+  EXPECT_TRUE(sdch_manager_->AddSdchDictionary(dictionary_with_path, url));
+  SdchManager::GenerateHash(dictionary_with_path, &client_hash, &server_hash);
+
+  list.clear();
+  sdch_manager_->GetAvailDictionaryList(url, &list);
+  EXPECT_EQ(expected_list, list);
+
+  list.clear();
+  sdch_manager_->GetAvailDictionaryList(path_url, &list);
+  EXPECT_NE(std::string::npos, list.find(expected_list));
+  EXPECT_NE(std::string::npos, list.find(client_hash));
+
+  // Secure servers are never offered dictionaries.
+  list.clear();
+  sdch_manager_->GetAvailDictionaryList(
+      GURL("https://" + kSampleDomain + "/special_path/bin"), &list);
+  EXPECT_TRUE(list.empty());
 }
 
 TEST_F(SdchFilterTest, DictionaryNotTooLarge) {
@@ -4,6 +4,8 @@
 
 #include "net/base/sdch_manager.h"
 
+#include <algorithm>
+
 #include "base/base64.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
@@ -22,6 +24,12 @@ const size_t SdchManager::kMaxDictionarySize = 1000000;
 // static
 const size_t SdchManager::kMaxDictionaryCount = 20;
 
+// static
+const size_t SdchManager::kMaxDictionaryBytes = 5000000;
+
+// Bounds the number of hosts whose advertisable dictionaries are remembered.
+static const size_t kMaxAvailDictionariesHosts = 100;
+
 // static
 SdchManager* SdchManager::global_ = NULL;
 
@@ -43,7 +51,8 @@ SdchManager::Dictionary::Dictionary(const std::string& dictionary_text,
       domain_(domain),
       path_(path),
       expiration_(expiration),
-      ports_(ports) {
+      ports_(ports),
+      last_use_(0) {
 }
 
 SdchManager::Dictionary::~Dictionary() {
@@ -204,7 +213,17 @@ bool SdchManager::Dictionary::DomainMatch(const GURL& gurl,
 }
 
 //------------------------------------------------------------------------------
-SdchManager::SdchManager() {
+SdchManager::AvailDictionaries::AvailDictionaries()
+    : has_path_restrictions(false) {
+}
+
+SdchManager::AvailDictionaries::~AvailDictionaries() {
+}
+
+//------------------------------------------------------------------------------
+SdchManager::SdchManager()
+    : dictionaries_bytes_(0),
+      use_counter_(0) {
   DCHECK(!global_);
   DCHECK(CalledOnValidThread());
   global_ = this;
@@ -372,6 +391,20 @@ bool SdchManager::CanFetchDictionary(const GURL& referring_url,
 
 bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
     const GURL& dictionary_url) {
+  return AddSdchDictionaryInternal(dictionary_text, dictionary_url,
+                                   base::Time::Now());
+}
+
+bool SdchManager::RestoreSdchDictionary(const std::string& dictionary_text,
+                                        const GURL& dictionary_url,
+                                        const base::Time& fetch_time) {
+  return AddSdchDictionaryInternal(dictionary_text, dictionary_url,
+                                   fetch_time);
+}
+
+bool SdchManager::AddSdchDictionaryInternal(const std::string& dictionary_text,
+                                            const GURL& dictionary_url,
+                                            const base::Time& fetch_time) {
   DCHECK(CalledOnValidThread());
   std::string client_hash;
   std::string server_hash;
@@ -383,7 +416,7 @@ bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
 
   std::string domain, path;
   std::set<int> ports;
-  base::Time expiration(base::Time::Now() + base::TimeDelta::FromDays(30));
+  base::Time expiration(fetch_time + base::TimeDelta::FromDays(30));
 
   if (dictionary_text.empty()) {
     SdchErrorRecovery(DICTIONARY_HAS_NO_TEXT);
@@ -428,7 +461,7 @@ bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
       } else if (name == "max-age") {
         int64 seconds;
         base::StringToInt64(value, &seconds);
-        expiration = base::Time::Now() + base::TimeDelta::FromSeconds(seconds);
+        expiration = fetch_time + base::TimeDelta::FromSeconds(seconds);
       } else if (name == "port") {
         int port;
         base::StringToInt(value, &port);
@@ -445,18 +478,14 @@ bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
   if (!Dictionary::CanSet(domain, path, ports, dictionary_url))
     return false;
 
-  // TODO(jar): Remove these hacks to preclude a DOS attack involving piles of
-  // useless dictionaries.  We should probably have a cache eviction plan,
-  // instead of just blocking additions.  For now, with the spec in flux, it
-  // is probably not worth doing eviction handling.
+  if (base::Time::Now() > expiration)
+    return false;
+
   if (kMaxDictionarySize < dictionary_text.size()) {
     SdchErrorRecovery(DICTIONARY_IS_TOO_LARGE);
     return false;
   }
-  if (kMaxDictionaryCount <= dictionaries_.size()) {
-    SdchErrorRecovery(DICTIONARY_COUNT_EXCEEDED);
-    return false;
-  }
+  EvictDictionariesFor(dictionary_text.size());
 
   UMA_HISTOGRAM_COUNTS("Sdch3.Dictionary size loaded", dictionary_text.size());
   DVLOG(1) << "Loaded dictionary with client hash " << client_hash
@@ -465,10 +494,32 @@ bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
       new Dictionary(dictionary_text, header_end + 2, client_hash,
                      dictionary_url, domain, path, expiration, ports);
   dictionary->AddRef();
+  dictionary->last_use_ = ++use_counter_;
   dictionaries_[server_hash] = dictionary;
+  dictionaries_bytes_ += dictionary->text().size();
+  avail_dictionaries_.clear();
   return true;
 }
 
+void SdchManager::EvictDictionariesFor(size_t size) {
+  while (!dictionaries_.empty() &&
+         (dictionaries_.size() >= kMaxDictionaryCount ||
+          dictionaries_bytes_ + size > kMaxDictionaryBytes)) {
+    DictionaryMap::iterator lru = dictionaries_.begin();
+    for (DictionaryMap::iterator it = dictionaries_.begin();
+         it != dictionaries_.end(); ++it) {
+      if (it->second->last_use_ < lru->second->last_use_)
+        lru = it;
+    }
+    // Filters that are decoding with the dictionary keep their own reference.
+    SdchErrorRecovery(DICTIONARY_EVICTED);
+    dictionaries_bytes_ -= lru->second->text().size();
+    lru->second->Release();
+    dictionaries_.erase(lru);
+    avail_dictionaries_.clear();
+  }
+}
+
 void SdchManager::GetVcdiffDictionary(const std::string& server_hash,
     const GURL& referring_url, Dictionary** dictionary) {
   DCHECK(CalledOnValidThread());
@@ -480,30 +531,91 @@ void SdchManager::GetVcdiffDictionary(const std::string& server_hash,
   Dictionary* matching_dictionary = it->second;
   if (!matching_dictionary->CanUse(referring_url))
     return;
+  matching_dictionary->last_use_ = ++use_counter_;
   *dictionary = matching_dictionary;
 }
 
-// TODO(jar): If we have evictions from the dictionaries_, then we need to
-// change this interface to return a list of reference counted Dictionary
-// instances that can be used if/when a server specifies one.
+// Dictionaries may be evicted after they were advertised. A server that then
+// uses one gets the usual DICTIONARY_HASH_NOT_FOUND recovery.
 void SdchManager::GetAvailDictionaryList(const GURL& target_url,
                                          std::string* list) {
   DCHECK(CalledOnValidThread());
   int count = 0;
-  for (DictionaryMap::iterator it = dictionaries_.begin();
-       it != dictionaries_.end(); ++it) {
-    if (!it->second->CanAdvertise(target_url))
-      continue;
-    ++count;
-    if (!list->empty())
-      list->append(",");
-    list->append(it->second->client_hash());
+  // Blacklisted domains are counted down on each check, so only take the
+  // cached route when there is nothing to count down.
+  if (!g_sdch_enabled_ || !blacklisted_domains_.empty() ||
+      target_url.SchemeIsSecure()) {
+    for (DictionaryMap::iterator it = dictionaries_.begin();
+         it != dictionaries_.end(); ++it) {
+      if (!it->second->CanAdvertise(target_url))
+        continue;
+      ++count;
+      if (!list->empty())
+        list->append(",");
+      list->append(it->second->client_hash());
+    }
+  } else {
+    const std::string key = StringToLowerASCII(target_url.host()) + ":" +
+        base::IntToString(target_url.EffectiveIntPort());
+    AvailDictionariesMap::iterator it = avail_dictionaries_.find(key);
+    if (it == avail_dictionaries_.end() ||
+        base::Time::Now() > it->second.expiration) {
+      if (avail_dictionaries_.size() >= kMaxAvailDictionariesHosts)
+        avail_dictionaries_.clear();
+      it = avail_dictionaries_.insert(
+          std::make_pair(key, AvailDictionaries())).first;
+      ComputeAvailDictionaries(target_url, &it->second);
+    }
+
+    const AvailDictionaries& avail = it->second;
+    if (!avail.has_path_restrictions) {
+      list->append(avail.list);
+      count = avail.dictionaries.size();
+    } else {
+      for (size_t i = 0; i < avail.dictionaries.size(); ++i) {
+        const Dictionary* dictionary = avail.dictionaries[i];
+        if (!dictionary->path().empty() &&
+            !Dictionary::PathMatch(target_url.path(), dictionary->path())) {
+          continue;
+        }
+        ++count;
+        if (!list->empty())
+          list->append(",");
+        list->append(dictionary->client_hash());
+      }
+    }
   }
   // Watch to see if we have corrupt or numerous dictionaries.
   if (count > 0)
     UMA_HISTOGRAM_COUNTS("Sdch3.Advertisement_Count", count);
 }
 
+void SdchManager::ComputeAvailDictionaries(const GURL& target_url,
+                                           AvailDictionaries* avail) {
+  avail->expiration = base::Time::FromInternalValue(kint64max);
+  for (DictionaryMap::iterator it = dictionaries_.begin();
+       it != dictionaries_.end(); ++it) {
+    Dictionary* dictionary = it->second;
+    // Everything CanAdvertise() checks, except the path.
+    if (!Dictionary::DomainMatch(target_url, dictionary->domain_))
+      continue;
+    if (!dictionary->ports_.empty() &&
+        0 == dictionary->ports_.count(target_url.EffectiveIntPort())) {
+      continue;
+    }
+    if (base::Time::Now() > dictionary->expiration())
+      continue;
+
+    avail->dictionaries.push_back(dictionary);
+    avail->expiration = std::min(avail->expiration, dictionary->expiration());
+    if (!dictionary->path().empty())
+      avail->has_path_restrictions = true;
+    if (!avail->list.empty())
+      avail->list.append(",");
+    avail->list.append(dictionary->client_hash());
+  }
+}
+
 // static
 void SdchManager::GenerateHash(const std::string& dictionary_text,
     std::string* client_hash, std::string* server_hash) {
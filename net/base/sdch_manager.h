@@ -24,6 +24,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
@@ -107,6 +108,7 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
     DICTIONARY_COUNT_EXCEEDED = 35,
     DICTIONARY_ALREADY_SCHEDULED_TO_DOWNLOAD = 36,
     DICTIONARY_ALREADY_TRIED_TO_DOWNLOAD = 37,
+    DICTIONARY_EVICTED = 38,  // Made room for another dictionary.
 
     // Failsafe hack.
     ATTEMPT_TO_DECODE_NON_HTTP_DATA = 40,
@@ -156,10 +158,13 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
     MAX_PROBLEM_CODE  // Used to bound histogram.
   };
 
-  // Use the following static limits to block DOS attacks until we implement
-  // a cached dictionary evicition strategy.
+  // Dictionaries larger than kMaxDictionarySize are refused. Adding a
+  // dictionary beyond kMaxDictionaryCount dictionaries, or beyond
+  // kMaxDictionaryBytes of dictionary text in total, evicts the least
+  // recently used ones.
   static const size_t kMaxDictionarySize;
   static const size_t kMaxDictionaryCount;
+  static const size_t kMaxDictionaryBytes;
 
   // There is one instance of |Dictionary| for each memory-cached SDCH
   // dictionary.
@@ -188,6 +193,8 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
 
     const GURL& url() const { return url_; }
     const std::string& client_hash() const { return client_hash_; }
+    const std::string& path() const { return path_; }
+    const base::Time& expiration() const { return expiration_; }
 
     // Security method to check if we can advertise this dictionary for use
     // if the |target_url| returns SDCH compressed data.
@@ -229,6 +236,10 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
     const base::Time expiration_;  // Implied by max-age.
     const std::set<int> ports_;
 
+    // Set by the manager each time the dictionary is added or used, to find
+    // the least recently used one.
+    int64 last_use_;
+
     DISALLOW_COPY_AND_ASSIGN(Dictionary);
   };
 
@@ -301,6 +312,13 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   bool AddSdchDictionary(const std::string& dictionary_text,
                          const GURL& dictionary_url);
 
+  // Like AddSdchDictionary(), for a dictionary that was fetched at
+  // |fetch_time| and kept on disk since. Its max-age counts from
+  // |fetch_time|, so this fails if the dictionary has expired.
+  bool RestoreSdchDictionary(const std::string& dictionary_text,
+                             const GURL& dictionary_url,
+                             const base::Time& fetch_time);
+
   // Find the vcdiff dictionary (the body of the sdch dictionary that appears
   // after the meta-data headers like Domain:...) with the given |server_hash|
   // to use to decompreses data that arrived as SDCH encoded content.  Check to
@@ -316,6 +334,10 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   // Get list of available (pre-cached) dictionaries that we have already loaded
   // into memory.  The list is a comma separated list of (client) hashes per
   // the SDCH spec.
+  //
+  // The dictionaries that can be advertised to a host and port are worked
+  // out once and kept until the set of dictionaries changes, so requests
+  // after the first to a server only check path restrictions, if any.
   void GetAvailDictionaryList(const GURL& target_url, std::string* list);
 
   // Construct the pair of hashes for client and server to identify an SDCH
@@ -339,6 +361,36 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   // A map of dictionaries info indexed by the hash that the server provides.
   typedef std::map<std::string, Dictionary*> DictionaryMap;
 
+  // The dictionaries that may be advertised to one host and port, ignoring
+  // path restrictions and the domain blacklist.
+  struct AvailDictionaries {
+    AvailDictionaries();
+    ~AvailDictionaries();
+
+    std::vector<Dictionary*> dictionaries;
+    // The comma separated client hashes of |dictionaries|, when none of them
+    // has a path restriction.
+    std::string list;
+    bool has_path_restrictions;
+    // When the first of |dictionaries| expires.
+    base::Time expiration;
+  };
+  // Keyed by host and port.
+  typedef std::map<std::string, AvailDictionaries> AvailDictionariesMap;
+
+  bool AddSdchDictionaryInternal(const std::string& dictionary_text,
+                                 const GURL& dictionary_url,
+                                 const base::Time& fetch_time);
+
+  // Evicts least recently used dictionaries until one more of |size| bytes
+  // fits within the limits.
+  void EvictDictionariesFor(size_t size);
+
+  // Fills |avail| with the dictionaries that can be advertised to the host and
+  // port of |target_url|.
+  void ComputeAvailDictionaries(const GURL& target_url,
+                                AvailDictionaries* avail);
+
   // The one global instance of that holds all the data.
   static SdchManager* global_;
 
@@ -350,6 +402,15 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
                                   std::string* output);
   DictionaryMap dictionaries_;
 
+  // Total size of the text of |dictionaries_|.
+  size_t dictionaries_bytes_;
+
+  // Incremented each time a dictionary is added or used.
+  int64 use_counter_;
+
+  // Cleared whenever |dictionaries_| changes.
+  AvailDictionariesMap avail_dictionaries_;
+
   // An instance that can fetch a dictionary given a URL.
   scoped_ptr<SdchFetcher> fetcher_;
 
@@ -10,6 +10,7 @@
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/compiler_specific.h"
+#include "base/lazy_instance.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
@@ -18,6 +19,7 @@
 #include "base/metrics/histogram.h"
 #include "base/rand_util.h"
 #include "base/stl_util.h"
+#include "base/synchronization/lock.h"
 #include "base/threading/worker_pool.h"
 #include "crypto/ec_private_key.h"
 #include "googleurl/src/gurl.h"
@@ -38,6 +40,9 @@ namespace {
 const int kKeySizeInBits = 1024;
 const int kValidityPeriodInDays = 365;
 
+// The number of EC keys generated ahead of time.
+const size_t kECKeyPoolSize = 3;
+
 bool IsSupportedCertType(uint8 type) {
   switch(type) {
     case CLIENT_CERT_ECDSA_SIGN:
@@ -161,6 +166,77 @@ class ServerBoundCertServiceRequest {
   std::string* cert_;
 };
 
+// Keeps a few EC keys generated ahead of time on a worker thread, so that
+// creating a domain bound cert for a new domain only has to sign the cert.
+// Can be used from any thread.
+class ECKeyPool {
+ public:
+  ECKeyPool() : refill_pending_(false) {}
+
+  // Starts generating keys until the pool is full.
+  void Fill() {
+    base::AutoLock locked(lock_);
+    StartRefillLocked();
+  }
+
+  // Returns a key from the pool, or NULL if it is empty, and starts
+  // generating a replacement. The caller takes ownership.
+  crypto::ECPrivateKey* TakeKey() {
+    base::AutoLock locked(lock_);
+    crypto::ECPrivateKey* key = NULL;
+    if (!keys_.empty()) {
+      key = keys_.back();
+      keys_.pop_back();
+    }
+    StartRefillLocked();
+    return key;
+  }
+
+ private:
+  void StartRefillLocked() {
+    lock_.AssertAcquired();
+    if (refill_pending_ || keys_.size() >= kECKeyPoolSize)
+      return;
+    refill_pending_ = base::WorkerPool::PostTask(
+        FROM_HERE,
+        base::Bind(&ECKeyPool::Refill, base::Unretained(this)),
+        true /* task is slow */);
+  }
+
+  // Runs on a worker thread.
+  void Refill() {
+    for (;;) {
+      {
+        base::AutoLock locked(lock_);
+        if (keys_.size() >= kECKeyPoolSize) {
+          refill_pending_ = false;
+          break;
+        }
+      }
+      crypto::ECPrivateKey* key = crypto::ECPrivateKey::Create();
+      base::AutoLock locked(lock_);
+      if (!key) {
+        refill_pending_ = false;
+        break;
+      }
+      keys_.push_back(key);
+    }
+#if defined(USE_NSS)
+    // Detach the thread from NSPR, see ServerBoundCertServiceWorker::Run().
+    PR_DetachThread();
+#endif
+  }
+
+  base::Lock lock_;
+  // The keys are owned, and leaked at exit along with the pool.
+  std::vector<crypto::ECPrivateKey*> keys_;
+  bool refill_pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(ECKeyPool);
+};
+
+base::LazyInstance<ECKeyPool>::Leaky g_ec_key_pool = LAZY_INSTANCE_INITIALIZER;
+
 // ServerBoundCertServiceWorker runs on a worker thread and takes care of the
 // blocking process of performing key generation. Deletes itself eventually
 // if Start() succeeds.
@@ -357,7 +433,9 @@ ServerBoundCertService::ServerBoundCertService(
     : server_bound_cert_store_(server_bound_cert_store),
       requests_(0),
       cert_store_hits_(0),
-      inflight_joins_(0) {}
+      inflight_joins_(0) {
+  g_ec_key_pool.Get().Fill();
+}
 
 ServerBoundCertService::~ServerBoundCertService() {
   STLDeleteValues(&inflight_);
@@ -508,7 +586,9 @@ int ServerBoundCertService::GenerateCert(const std::string& server_identifier,
   std::vector<uint8> private_key_info;
   switch (type) {
     case CLIENT_CERT_ECDSA_SIGN: {
-      scoped_ptr<crypto::ECPrivateKey> key(crypto::ECPrivateKey::Create());
+      scoped_ptr<crypto::ECPrivateKey> key(g_ec_key_pool.Get().TakeKey());
+      if (!key.get())
+        key.reset(crypto::ECPrivateKey::Create());
       if (!key.get()) {
         DLOG(ERROR) << "Unable to create key pair for client";
         return ERR_KEY_GENERATION_FAILED;
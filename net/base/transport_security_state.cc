@@ -93,7 +93,7 @@ bool TransportSecurityState::DeleteHost(const std::string& host) {
   if (canonicalized_host.empty())
     return false;
 
-  std::map<std::string, DomainState>::iterator i = enabled_hosts_.find(
+  DomainStateMap::iterator i = enabled_hosts_.find(
       HashHost(canonicalized_host));
   if (i != enabled_hosts_.end()) {
     enabled_hosts_.erase(i);
@@ -120,16 +120,18 @@ bool TransportSecurityState::GetDomainState(const std::string& host,
   base::Time current_time(base::Time::Now());
 
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
-    std::string host_sub_chunk(&canonicalized_host[i],
-                               canonicalized_host.size() - i);
     // Exact match of a preload always wins.
-    if (has_preload && host_sub_chunk == canonicalized_preload) {
+    if (has_preload &&
+        canonicalized_host.compare(i, std::string::npos,
+                                   canonicalized_preload) == 0) {
       *result = state;
       return true;
     }
 
-    std::map<std::string, DomainState>::iterator j =
-        enabled_hosts_.find(HashHost(host_sub_chunk));
+    if (enabled_hosts_.empty())
+      continue;
+    std::string host_sub_chunk(canonicalized_host, i);
+    DomainStateMap::iterator j = enabled_hosts_.find(HashHost(host_sub_chunk));
     if (j == enabled_hosts_.end())
       continue;
 
@@ -161,7 +163,7 @@ void TransportSecurityState::DeleteSince(const base::Time& time) {
 
   bool dirtied = false;
 
-  std::map<std::string, DomainState>::iterator i = enabled_hosts_.begin();
+  DomainStateMap::iterator i = enabled_hosts_.begin();
   while (i != enabled_hosts_.end()) {
     if (i->second.created >= time) {
       dirtied = true;
@@ -588,41 +590,67 @@ struct HSTSPreload {
   SecondLevelDomainName second_level_domain_name;
 };
 
+// Returns the entry of |entries| whose |dns_name| is the |length| bytes at
+// |name|, or NULL if there is none. The generator sorts |entries| by the
+// length of |dns_name| and then by its bytes, so this is a binary search.
+static const struct HSTSPreload* FindPreload(const struct HSTSPreload* entries,
+                                             size_t num_entries,
+                                             const char* name,
+                                             size_t length) {
+  size_t low = 0;
+  size_t high = num_entries;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    const struct HSTSPreload* entry = entries + mid;
+    int cmp;
+    if (entry->length != length)
+      cmp = entry->length < length ? -1 : 1;
+    else
+      cmp = memcmp(entry->dns_name, name, length);
+    if (cmp == 0)
+      return entry;
+    if (cmp < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return NULL;
+}
+
 static bool HasPreload(const struct HSTSPreload* entries, size_t num_entries,
                        const std::string& canonicalized_host, size_t i,
                        TransportSecurityState::DomainState* out, bool* ret) {
-  for (size_t j = 0; j < num_entries; j++) {
-    if (entries[j].length == canonicalized_host.size() - i &&
-        memcmp(entries[j].dns_name, &canonicalized_host[i],
-               entries[j].length) == 0) {
-      if (!entries[j].include_subdomains && i != 0) {
-        *ret = false;
-      } else {
-        out->include_subdomains = entries[j].include_subdomains;
-        *ret = true;
-        if (!entries[j].https_required)
-          out->upgrade_mode = TransportSecurityState::DomainState::MODE_DEFAULT;
-        if (entries[j].pins.required_hashes) {
-          const char* const* hash = entries[j].pins.required_hashes;
-          while (*hash) {
-            bool ok = AddHash(*hash, &out->static_spki_hashes);
-            DCHECK(ok) << " failed to parse " << *hash;
-            hash++;
-          }
-        }
-        if (entries[j].pins.excluded_hashes) {
-          const char* const* hash = entries[j].pins.excluded_hashes;
-          while (*hash) {
-            bool ok = AddHash(*hash, &out->bad_static_spki_hashes);
-            DCHECK(ok) << " failed to parse " << *hash;
-            hash++;
-          }
-        }
+  const struct HSTSPreload* entry =
+      FindPreload(entries, num_entries, &canonicalized_host[i],
+                  canonicalized_host.size() - i);
+  if (!entry)
+    return false;
+
+  if (!entry->include_subdomains && i != 0) {
+    *ret = false;
+  } else {
+    out->include_subdomains = entry->include_subdomains;
+    *ret = true;
+    if (!entry->https_required)
+      out->upgrade_mode = TransportSecurityState::DomainState::MODE_DEFAULT;
+    if (entry->pins.required_hashes) {
+      const char* const* hash = entry->pins.required_hashes;
+      while (*hash) {
+        bool ok = AddHash(*hash, &out->static_spki_hashes);
+        DCHECK(ok) << " failed to parse " << *hash;
+        hash++;
+      }
+    }
+    if (entry->pins.excluded_hashes) {
+      const char* const* hash = entry->pins.excluded_hashes;
+      while (*hash) {
+        bool ok = AddHash(*hash, &out->bad_static_spki_hashes);
+        DCHECK(ok) << " failed to parse " << *hash;
+        hash++;
       }
-      return true;
     }
   }
-  return false;
+  return true;
 }
 
 #include "net/base/transport_security_state_static.h"
@@ -638,17 +666,11 @@ static const struct HSTSPreload* GetHSTSPreload(
     const struct HSTSPreload* entries,
     size_t num_entries) {
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
-    for (size_t j = 0; j < num_entries; j++) {
-      const struct HSTSPreload* entry = entries + j;
-
-      if (i != 0 && !entry->include_subdomains)
-        continue;
-
-      if (entry->length == canonicalized_host.size() - i &&
-          memcmp(entry->dns_name, &canonicalized_host[i], entry->length) == 0) {
-        return entry;
-      }
-    }
+    const struct HSTSPreload* entry =
+        FindPreload(entries, num_entries, &canonicalized_host[i],
+                    canonicalized_host.size() - i);
+    if (entry && (i == 0 || entry->include_subdomains))
+      return entry;
   }
 
   return NULL;
@@ -704,23 +726,24 @@ bool TransportSecurityState::GetStaticDomainState(
   out->include_subdomains = false;
 
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
-    std::string host_sub_chunk(&canonicalized_host[i],
-                               canonicalized_host.size() - i);
-    out->domain = DNSDomainToString(host_sub_chunk);
-    std::string hashed_host(HashHost(host_sub_chunk));
-    if (forced_hosts_.find(hashed_host) != forced_hosts_.end()) {
-      *out = forced_hosts_[hashed_host];
-      out->domain = DNSDomainToString(host_sub_chunk);
-      return true;
+    // Forced hosts are rare, so don't hash every suffix when there are none.
+    if (!forced_hosts_.empty()) {
+      std::string host_sub_chunk(canonicalized_host, i);
+      DomainStateMap::const_iterator j =
+          forced_hosts_.find(HashHost(host_sub_chunk));
+      if (j != forced_hosts_.end()) {
+        *out = j->second;
+        out->domain = DNSDomainToString(host_sub_chunk);
+        return true;
+      }
     }
     bool ret;
     if (HasPreload(kPreloadedSTS, kNumPreloadedSTS, canonicalized_host, i, out,
-                   &ret)) {
-      return ret;
-    }
-    if (sni_enabled &&
-        HasPreload(kPreloadedSNISTS, kNumPreloadedSNISTS, canonicalized_host, i,
-                   out, &ret)) {
+                   &ret) ||
+        (sni_enabled &&
+         HasPreload(kPreloadedSNISTS, kNumPreloadedSNISTS, canonicalized_host,
+                    i, out, &ret))) {
+      out->domain = DNSDomainToString(canonicalized_host.substr(i));
       return ret;
     }
   }
@@ -6,13 +6,13 @@
 #define NET_BASE_TRANSPORT_SECURITY_STATE_H_
 #pragma once
 
-#include <map>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/gtest_prod_util.h"
+#include "base/hash_tables.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/time.h"
 #include "net/base/net_export.h"
@@ -152,6 +152,9 @@ class NET_EXPORT TransportSecurityState
     std::string domain;
   };
 
+  // Maps the SHA-256 hash of a canonicalized host to its state.
+  typedef base::hash_map<std::string, DomainState> DomainStateMap;
+
   class Iterator {
    public:
     explicit Iterator(const TransportSecurityState& state)
@@ -166,8 +169,8 @@ class NET_EXPORT TransportSecurityState
     const DomainState& domain_state() const { return iterator_->second; }
 
    private:
-    std::map<std::string, DomainState>::const_iterator iterator_;
-    std::map<std::string, DomainState>::const_iterator end_;
+    DomainStateMap::const_iterator iterator_;
+    DomainStateMap::const_iterator end_;
   };
 
   // Assign a |Delegate| for persisting the transport security state. If
@@ -282,11 +285,11 @@ class NET_EXPORT TransportSecurityState
   void DirtyNotify();
 
   // The set of hosts that have enabled TransportSecurity.
-  std::map<std::string, DomainState> enabled_hosts_;
+  DomainStateMap enabled_hosts_;
 
   // Extra entries, provided by the user at run-time, to treat as if they
   // were static.
-  std::map<std::string, DomainState> forced_hosts_;
+  DomainStateMap forced_hosts_;
 
   Delegate* delegate_;
 
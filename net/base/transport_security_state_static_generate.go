@@ -28,6 +28,7 @@ import (
 	"io"
 	"os"
 	"regexp"
+	"sort"
 	"strings"
 )
 
@@ -461,6 +462,32 @@ func toDNS(s string) (string, int) {
 	return name, l
 }
 
+// toDNSBytes returns the domain name |s| in length-prefixed form, including the
+// root label, as TransportSecurityState compares it.
+func toDNSBytes(s string) []byte {
+	var name []byte
+	for _, label := range strings.Split(s, ".") {
+		name = append(name, byte(len(label)))
+		name = append(name, label...)
+	}
+	return append(name, 0)
+}
+
+// hstsEntries sorts entries into the order that TransportSecurityState
+// binary searches: by the length of the DNS form of the name, then by its
+// bytes.
+type hstsEntries []hsts
+
+func (h hstsEntries) Len() int      { return len(h) }
+func (h hstsEntries) Swap(i, j int) { h[i], h[j] = h[j], h[i] }
+func (h hstsEntries) Less(i, j int) bool {
+	a, b := toDNSBytes(h[i].Name), toDNSBytes(h[j].Name)
+	if len(a) != len(b) {
+		return len(a) < len(b)
+	}
+	return bytes.Compare(a, b) < 0
+}
+
 // domainConstant converts the domain name |s| into a string of the form
 // "DOMAIN_" + uppercase last two labels.
 func domainConstant(s string) string {
@@ -511,10 +538,14 @@ static const char* const kNoRejectedPublicKeys[] = {
 `, name, acceptableListName, rejectedListName)
 	}
 
+	sort.Sort(hstsEntries(hsts.Entries))
+
 	out.WriteString(`#define kNoPins {\
   NULL, NULL, \
 }
 
+// The entries are sorted by the length of |dns_name| and then by its bytes so
+// that they can be binary searched.
 static const struct HSTSPreload kPreloadedSTS[] = {
 `)
 
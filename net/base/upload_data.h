@@ -171,6 +171,7 @@ class NET_EXPORT UploadData
     FileStream* file_stream_;
 
     FRIEND_TEST_ALL_PREFIXES(UploadDataStreamTest, FileSmallerThanLength);
+    FRIEND_TEST_ALL_PREFIXES(UploadDataStreamTest, ReadAsync);
     FRIEND_TEST_ALL_PREFIXES(HttpNetworkTransactionTest,
                              UploadFileSmallerThanLength);
     FRIEND_TEST_ALL_PREFIXES(HttpNetworkTransactionSpdy2Test,
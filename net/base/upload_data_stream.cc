@@ -4,6 +4,11 @@
 
 #include "net/base/upload_data_stream.h"
 
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/threading/thread_restrictions.h"
@@ -20,7 +25,9 @@ UploadDataStream::UploadDataStream(UploadData* upload_data)
       element_index_(0),
       total_size_(0),
       current_position_(0),
-      initialized_successfully_(false) {
+      initialized_successfully_(false),
+      file_bytes_remaining_(0),
+      pending_read_buf_len_(0) {
 }
 
 UploadDataStream::~UploadDataStream() {
@@ -64,6 +71,7 @@ int UploadDataStream::Init() {
 }
 
 int UploadDataStream::Read(IOBuffer* buf, int buf_len) {
+  DCHECK(!file_stream_.get());
   std::vector<UploadData::Element>& elements = *upload_data_->elements();
 
   int bytes_copied = 0;
@@ -87,6 +95,50 @@ int UploadDataStream::Read(IOBuffer* buf, int buf_len) {
   return bytes_copied;
 }
 
+int UploadDataStream::Read(IOBuffer* buf, int buf_len,
+                           const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  DCHECK(pending_read_callback_.is_null());
+  std::vector<UploadData::Element>& elements = *upload_data_->elements();
+
+  int bytes_copied = 0;
+  while (bytes_copied < buf_len && element_index_ < elements.size()) {
+    UploadData::Element& element = elements[element_index_];
+
+    if (element.type() == UploadData::TYPE_FILE) {
+      if (!file_stream_.get() && element.GetContentLength() == 0) {
+        ++element_index_;
+        continue;
+      }
+      // Return the in-memory data first, so that the file data can be read
+      // straight into the start of the caller's buffer.
+      if (bytes_copied > 0)
+        break;
+      pending_read_buf_ = buf;
+      pending_read_buf_len_ = buf_len;
+      int rv = DoFileRead();
+      if (rv == ERR_IO_PENDING)
+        pending_read_callback_ = callback;
+      return rv;
+    }
+
+    bytes_copied += element.ReadSync(buf->data() + bytes_copied,
+                                     buf_len - bytes_copied);
+
+    if (element.BytesRemaining() == 0)
+        ++element_index_;
+
+    if (is_chunked() && !merge_chunks_)
+      break;
+  }
+
+  current_position_ += bytes_copied;
+  if (is_chunked() && !IsEOF() && bytes_copied == 0)
+    return ERR_IO_PENDING;
+
+  return bytes_copied;
+}
+
 bool UploadDataStream::IsEOF() const {
   const std::vector<UploadData::Element>& elements = *upload_data_->elements();
 
@@ -108,4 +160,98 @@ bool UploadDataStream::IsInMemory() const {
   return upload_data_->IsInMemory();
 }
 
+int UploadDataStream::DoFileRead() {
+  if (!file_stream_.get()) {
+    UploadData::Element& element = (*upload_data_->elements())[element_index_];
+    file_bytes_remaining_ = element.GetContentLength();
+    file_stream_.reset(new FileStream(NULL));
+    int rv = file_stream_->Open(
+        element.file_path(),
+        base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_READ |
+            base::PLATFORM_FILE_ASYNC,
+        base::Bind(&UploadDataStream::OnFileOpened, base::Unretained(this)));
+    if (rv == ERR_IO_PENDING)
+      return rv;
+  }
+
+  // The file is not open if it is missing or not readable.
+  if (!file_stream_->IsOpen())
+    return FinishFileRead(0);
+
+  const int num_bytes_to_read = static_cast<int>(
+      std::min(file_bytes_remaining_,
+               static_cast<uint64>(pending_read_buf_len_)));
+  int rv = file_stream_->Read(
+      pending_read_buf_, num_bytes_to_read,
+      base::Bind(&UploadDataStream::OnFileRead, base::Unretained(this)));
+  if (rv == ERR_IO_PENDING)
+    return rv;
+  return FinishFileRead(rv);
+}
+
+void UploadDataStream::OnFileOpened(int result) {
+  const UploadData::Element& element =
+      (*upload_data_->elements())[element_index_];
+  if (result != OK) {
+    DLOG(WARNING) << "Failed to open \"" << element.file_path().value()
+                  << "\" for reading: " << result;
+  } else if (element.file_range_offset()) {
+    int64 rv = file_stream_->Seek(
+        FROM_BEGIN, element.file_range_offset(),
+        base::Bind(&UploadDataStream::OnFileSeeked, base::Unretained(this)));
+    if (rv == ERR_IO_PENDING)
+      return;
+    OnFileSeeked(rv);
+    return;
+  }
+  ResumeFileRead();
+}
+
+void UploadDataStream::OnFileSeeked(int64 result) {
+  if (result < 0) {
+    DLOG(WARNING) << "Failed to seek to the upload range: " << result;
+    // An unopened stream makes DoFileRead() send zeros. The old stream is
+    // closed in the background.
+    file_stream_.reset(new FileStream(NULL));
+  }
+  ResumeFileRead();
+}
+
+void UploadDataStream::OnFileRead(int result) {
+  CompletionCallback callback = pending_read_callback_;
+  pending_read_callback_.Reset();
+  callback.Run(FinishFileRead(result));
+}
+
+void UploadDataStream::ResumeFileRead() {
+  int rv = DoFileRead();
+  if (rv == ERR_IO_PENDING)
+    return;
+  CompletionCallback callback = pending_read_callback_;
+  pending_read_callback_.Reset();
+  callback.Run(rv);
+}
+
+int UploadDataStream::FinishFileRead(int result) {
+  int bytes_read = static_cast<int>(
+      std::min(file_bytes_remaining_,
+               static_cast<uint64>(pending_read_buf_len_)));
+  if (result > 0) {
+    bytes_read = std::min(bytes_read, result);
+  } else {
+    // If there's less data to read than we initially observed, then pad with
+    // zero. Otherwise the server will hang waiting for the rest of the data.
+    memset(pending_read_buf_->data(), 0, bytes_read);
+  }
+
+  file_bytes_remaining_ -= bytes_read;
+  if (file_bytes_remaining_ == 0) {
+    file_stream_.reset();
+    ++element_index_;
+  }
+  current_position_ += bytes_read;
+  pending_read_buf_ = NULL;
+  return bytes_read;
+}
+
 }  // namespace net
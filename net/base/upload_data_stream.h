@@ -6,7 +6,9 @@
 #define NET_BASE_UPLOAD_DATA_STREAM_H_
 #pragma once
 
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
 #include "net/base/upload_data.h"
 
@@ -44,6 +46,15 @@ class NET_EXPORT UploadDataStream {
   // won't fail.
   int Read(IOBuffer* buf, int buf_len);
 
+  // Same as above, except that file elements are read on a worker thread
+  // instead of blocking the calling thread. If a file read is started,
+  // ERR_IO_PENDING is returned and |callback| is run with the number of
+  // bytes read once it completes; |buf| must not be touched until then. File
+  // data is read straight into |buf|, so a read returns early rather than
+  // mixing in-memory data and file data. The two Read() methods should not be
+  // used on the same stream.
+  int Read(IOBuffer* buf, int buf_len, const CompletionCallback& callback);
+
   // Sets the callback to be invoked when new chunks are available to upload.
   void set_chunk_callback(ChunkCallback* callback) {
     upload_data_->set_chunk_callback(callback);
@@ -69,6 +80,25 @@ class NET_EXPORT UploadDataStream {
   static void set_merge_chunks(bool merge) { merge_chunks_ = merge; }
 
  private:
+  // Reads from the file element at |element_index_| into |pending_read_buf_|,
+  // opening the file first if needed. Returns the number of bytes read or
+  // ERR_IO_PENDING.
+  int DoFileRead();
+
+  // Callbacks for the asynchronous operations on |file_stream_|.
+  void OnFileOpened(int result);
+  void OnFileSeeked(int64 result);
+  void OnFileRead(int result);
+
+  // Continues DoFileRead() after |file_stream_| is ready to be read, and
+  // runs the pending callback if it completes.
+  void ResumeFileRead();
+
+  // Accounts for |result| bytes read from the current file element. If the
+  // file ended early, the buffer is padded with zeros just like Read() does.
+  // Returns the number of bytes placed in |pending_read_buf_|.
+  int FinishFileRead(int result);
+
   scoped_refptr<UploadData> upload_data_;
 
   // Index of the current upload element (i.e. the element currently being
@@ -83,6 +113,17 @@ class NET_EXPORT UploadDataStream {
   // True if the initialization was successful.
   bool initialized_successfully_;
 
+  // The file of the element being read by the asynchronous Read(), and the
+  // number of bytes left to read from it. |file_stream_| is not open if the
+  // file could not be opened, in which case zeros are sent instead.
+  scoped_ptr<FileStream> file_stream_;
+  uint64 file_bytes_remaining_;
+
+  // The buffer and callback of the asynchronous Read() in progress.
+  scoped_refptr<IOBuffer> pending_read_buf_;
+  int pending_read_buf_len_;
+  CompletionCallback pending_read_callback_;
+
   // TODO(satish): Remove this once we have a better way to unit test POST
   // requests with chunked uploads.
   static bool merge_chunks_;
@@ -4,6 +4,7 @@
 
 #include "net/base/upload_data_stream.h"
 
+#include <string>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -15,6 +16,7 @@
 #include "base/time.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
 #include "net/base/upload_data.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
@@ -104,6 +106,52 @@ TEST_F(UploadDataStreamTest, FileSmallerThanLength) {
   file_util::Delete(temp_file_path, false);
 }
 
+TEST_F(UploadDataStreamTest, ReadAsync) {
+  FilePath temp_file_path;
+  ASSERT_TRUE(file_util::CreateTemporaryFile(&temp_file_path));
+  ASSERT_EQ(static_cast<int>(kTestDataSize),
+            file_util::WriteFile(temp_file_path, kTestData, kTestDataSize));
+
+  // Bytes, a range of the file, a missing file, a truncated file and bytes.
+  std::vector<UploadData::Element> elements(5);
+  elements[0].SetToBytes(kTestData, kTestDataSize);
+  elements[1].SetToFilePathRange(temp_file_path, 2, 5, base::Time());
+  elements[2].SetToFilePath(
+      temp_file_path.InsertBeforeExtensionASCII("_missing"));
+  elements[3].SetToFilePath(temp_file_path);
+  elements[3].SetContentLength(kTestDataSize + 3);
+  elements[4].SetToBytes(kTestData, kTestDataSize);
+  upload_data_->SetElements(elements);
+
+  scoped_ptr<UploadDataStream> stream(new UploadDataStream(upload_data_));
+  ASSERT_EQ(OK, stream->Init());
+  const uint64 kExpectedSize = kTestDataSize * 3 + 5 + 3;
+  EXPECT_EQ(kExpectedSize, stream->size());
+
+  // Use a small buffer so that elements are read in several pieces.
+  const int kBufferSize = 4;
+  scoped_refptr<IOBuffer> buf = new IOBuffer(kBufferSize);
+  std::string data;
+  while (!stream->IsEOF()) {
+    TestCompletionCallback callback;
+    int rv = stream->Read(buf, kBufferSize, callback.callback());
+    if (rv == ERR_IO_PENDING)
+      rv = callback.WaitForResult();
+    ASSERT_LT(0, rv);
+    data.append(buf->data(), rv);
+    EXPECT_EQ(data.size(), stream->position());
+  }
+
+  std::string expected(kTestData);
+  expected.append(kTestData + 2, 5);
+  expected.append(kTestData);
+  expected.append(3, '\0');
+  expected.append(kTestData);
+  EXPECT_EQ(expected, data);
+
+  file_util::Delete(temp_file_path, false);
+}
+
 void UploadDataStreamTest::FileChangedHelper(const FilePath& file_path,
                                              const base::Time& time,
                                              bool error_expected) {
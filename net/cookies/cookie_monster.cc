@@ -362,7 +362,8 @@ void BuildCookieInfoList(const CanonicalCookieVector& cookies,
 bool CookieMonster::enable_file_scheme_ = false;
 
 CookieMonster::CookieMonster(PersistentCookieStore* store, Delegate* delegate)
-    : initialized_(false),
+    : cookie_line_cache_(kMaxCachedCookieLines),
+      initialized_(false),
       loaded_(false),
       store_(store),
       last_access_threshold_(
@@ -378,7 +379,8 @@ CookieMonster::CookieMonster(PersistentCookieStore* store, Delegate* delegate)
 CookieMonster::CookieMonster(PersistentCookieStore* store,
                              Delegate* delegate,
                              int last_access_threshold_milliseconds)
-    : initialized_(false),
+    : cookie_line_cache_(kMaxCachedCookieLines),
+      initialized_(false),
       loaded_(false),
       store_(store),
       last_access_threshold_(base::TimeDelta::FromMilliseconds(
@@ -1412,11 +1414,29 @@ std::string CookieMonster::GetCookiesWithOptions(const GURL& url,
 
   TimeTicks start_time(TimeTicks::Now());
 
+  const std::string cache_key(GetCookieLineCacheKey(url, options));
+  CookieLineCache::iterator cached = cookie_line_cache_.Get(cache_key);
+  if (cached != cookie_line_cache_.end()) {
+    const CachedCookieLine& line = cached->second;
+    const Time current_time(CurrentTime());
+    if ((line.expiry_time.is_null() || current_time < line.expiry_time) &&
+        (line.access_update_time.is_null() ||
+         current_time < line.access_update_time)) {
+      RecordPeriodicStats(current_time);
+      histogram_time_get_->AddTime(TimeTicks::Now() - start_time);
+      VLOG(kVlogGetCookies) << "GetCookies() cached result: "
+                            << line.cookie_line;
+      return line.cookie_line;
+    }
+    cookie_line_cache_.Erase(cached);
+  }
+
   std::vector<CanonicalCookie*> cookies;
   FindCookiesForHostAndDomain(url, options, true, &cookies);
   std::sort(cookies.begin(), cookies.end(), CookieSorter);
 
   std::string cookie_line = BuildCookieLine(cookies);
+  CacheCookieLine(cache_key, GetKey(url.host()), cookies, cookie_line);
 
   histogram_time_get_->AddTime(TimeTicks::Now() - start_time);
 
@@ -1857,6 +1877,54 @@ bool CookieMonster::DeleteAnyEquivalentCookie(const std::string& key,
   return skipped_httponly;
 }
 
+// static
+std::string CookieMonster::GetCookieLineCacheKey(
+    const GURL& url,
+    const CookieOptions& options) {
+  // The port and query do not change which cookies are sent.
+  return (options.exclude_httponly() ? "0" : "1") + url.scheme() + "://" +
+      url.host() + url.path();
+}
+
+void CookieMonster::CacheCookieLine(
+    const std::string& cache_key,
+    const std::string& key,
+    const std::vector<CanonicalCookie*>& cookies,
+    const std::string& cookie_line) {
+  lock_.AssertAcquired();
+
+  CachedCookieLine line;
+  line.key = key;
+  line.cookie_line = cookie_line;
+  for (std::vector<CanonicalCookie*>::const_iterator it = cookies.begin();
+       it != cookies.end(); ++it) {
+    const CanonicalCookie* cc = *it;
+    if (cc->DoesExpire() && !keep_expired_cookies_ &&
+        (line.expiry_time.is_null() || cc->ExpiryDate() < line.expiry_time)) {
+      line.expiry_time = cc->ExpiryDate();
+    }
+    // See InternalUpdateCookieAccessTime().
+    Time access_update_time = cc->LastAccessDate() + last_access_threshold_;
+    if (line.access_update_time.is_null() ||
+        access_update_time < line.access_update_time) {
+      line.access_update_time = access_update_time;
+    }
+  }
+  cookie_line_cache_.Put(cache_key, line);
+}
+
+void CookieMonster::InvalidateCookieLines(const std::string& key) {
+  lock_.AssertAcquired();
+
+  for (CookieLineCache::iterator it = cookie_line_cache_.begin();
+       it != cookie_line_cache_.end(); ) {
+    if (it->second.key == key)
+      it = cookie_line_cache_.Erase(it);
+    else
+      ++it;
+  }
+}
+
 void CookieMonster::InternalInsertCookie(const std::string& key,
                                          CanonicalCookie* cc,
                                          bool sync_to_store) {
@@ -1866,6 +1934,7 @@ void CookieMonster::InternalInsertCookie(const std::string& key,
       store_ && sync_to_store)
     store_->AddCookie(*cc);
   cookies_.insert(CookieMap::value_type(key, cc));
+  InvalidateCookieLines(key);
   if (delegate_.get()) {
     delegate_->OnCookieChanged(
         *cc, false, CookieMonster::Delegate::CHANGE_COOKIE_EXPLICIT);
@@ -2011,6 +2080,7 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
     if (mapping.notify)
       delegate_->OnCookieChanged(*cc, true, mapping.cause);
   }
+  InvalidateCookieLines(it->first);
   cookies_.erase(it);
   delete cc;
 }
@@ -19,6 +19,7 @@
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
 #include "base/gtest_prod_util.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/synchronization/lock.h"
@@ -368,6 +369,25 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // Record statistics every kRecordStatisticsIntervalSeconds of uptime.
   static const int kRecordStatisticsIntervalSeconds = 10 * 60;
 
+  // The number of Cookie header values GetCookiesWithOptions() remembers.
+  static const size_t kMaxCachedCookieLines = 100;
+
+  // A Cookie header value built by GetCookiesWithOptions(), kept so that
+  // repeated requests for the same URL do not have to scan and sort the
+  // cookies of the domain again.
+  struct CachedCookieLine {
+    // The CookieMap key of the cookies the line is built from. The line is
+    // dropped whenever a cookie is added or deleted under this key.
+    std::string key;
+    std::string cookie_line;
+    // The line has to be built again once one of its cookies expires, or the
+    // access time of one of them is due to be updated. Null if there is no
+    // such time.
+    base::Time expiry_time;
+    base::Time access_update_time;
+  };
+  typedef base::MRUCache<std::string, CachedCookieLine> CookieLineCache;
+
   virtual ~CookieMonster();
 
   // The following are synchronous calls to which the asynchronous methods
@@ -494,6 +514,20 @@ class NET_EXPORT CookieMonster : public CookieStore {
                                  bool skip_httponly,
                                  bool already_expired);
 
+  // Returns the key |cookie_line_cache_| uses for the cookies sent to |url|.
+  static std::string GetCookieLineCacheKey(const GURL& url,
+                                           const CookieOptions& options);
+
+  // Remembers |cookie_line|, built from |cookies| for |cache_key|.
+  void CacheCookieLine(const std::string& cache_key,
+                       const std::string& key,
+                       const std::vector<CanonicalCookie*>& cookies,
+                       const std::string& cookie_line);
+
+  // Drops the cached Cookie header values built from the cookies stored
+  // under the CookieMap key |key|.
+  void InvalidateCookieLines(const std::string& key);
+
   // Takes ownership of *cc.
   void InternalInsertCookie(const std::string& key,
                             CanonicalCookie* cc,
@@ -593,6 +627,10 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   CookieMap cookies_;
 
+  // Cookie header values recently returned by GetCookiesWithOptions(),
+  // by GetCookieLineCacheKey().
+  CookieLineCache cookie_line_cache_;
+
   // Indicates whether the cookie store has been initialized. This happens
   // lazily in InitStoreIfNecessary().
   bool initialized_;
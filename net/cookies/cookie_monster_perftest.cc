@@ -166,6 +166,46 @@ TEST_F(CookieMonsterTest, TestAddCookiesOnSingleHost) {
   timer3.Done();
 }
 
+TEST_F(CookieMonsterTest, TestQueryCachedCookieLines) {
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+  SetCookieCallback setCookieCallback;
+  GetCookiesCallback getCookiesCallback;
+
+  // Stay under the per domain limit, so nothing is garbage collected.
+  const int kNumHostCookies = 100;
+  for (int i = 0; i < kNumHostCookies; i++)
+    setCookieCallback.SetCookie(cm, kUrlGoogle,
+                                base::StringPrintf("a%03d=b", i));
+
+  std::vector<GURL> gurls;
+  for (int i = 0; i < kNumCookies; i++) {
+    gurls.push_back(GURL(base::StringPrintf("http://www.google.izzle/%d",
+                                            i)));
+  }
+
+  // The same URL over and over, as for the subresources of a page.
+  PerfTimeLogger timer("Cookie_monster_query_cached_line");
+  for (int i = 0; i < kNumCookies; i++)
+    getCookiesCallback.GetCookies(cm, kUrlGoogle);
+  timer.Done();
+
+  // Every URL is new, so the line is always built from scratch.
+  PerfTimeLogger timer2("Cookie_monster_query_uncached_lines");
+  for (std::vector<GURL>::const_iterator it = gurls.begin();
+       it != gurls.end(); ++it) {
+    getCookiesCallback.GetCookies(cm, *it);
+  }
+  timer2.Done();
+
+  // A cookie is set before every query, so the cached line is always stale.
+  PerfTimeLogger timer3("Cookie_monster_query_after_set");
+  for (int i = 0; i < kNumCookies; i++) {
+    setCookieCallback.SetCookie(cm, kUrlGoogle, "a000=c");
+    getCookiesCallback.GetCookies(cm, kUrlGoogle);
+  }
+  timer3.Done();
+}
+
 TEST_F(CookieMonsterTest, TestAddCookieOnManyHosts) {
   scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
   std::string cookie(kCookieLine);
@@ -1365,6 +1365,37 @@ TEST_F(CookieMonsterTest, TestDeleteSingleCookie) {
   EXPECT_EQ("A=B; E=F", GetCookies(cm, url_google_));
 }
 
+// Cookie header values are remembered per URL, and must not outlive a change
+// to the cookies they were built from.
+TEST_F(CookieMonsterTest, CachedCookieLines) {
+  scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
+  CookieOptions options;
+  options.set_include_httponly();
+
+  EXPECT_TRUE(SetCookie(cm, url_google_, "A=B"));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+
+  EXPECT_TRUE(SetCookieWithOptions(cm, url_google_, "C=D; httponly",
+                                   options));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+  EXPECT_EQ("A=B; C=D", GetCookiesWithOptions(cm, url_google_, options));
+
+  EXPECT_TRUE(SetCookie(cm, url_google_foo_, "E=F; path=/foo"));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_));
+  EXPECT_EQ("E=F; A=B", GetCookies(cm, url_google_foo_));
+  EXPECT_EQ("A=B", GetCookies(cm, url_google_bar_));
+
+  EXPECT_TRUE(SetCookie(cm, url_google_, "A=G"));
+  EXPECT_EQ("A=G", GetCookies(cm, url_google_));
+  EXPECT_EQ("E=F; A=G", GetCookies(cm, url_google_foo_));
+
+  EXPECT_TRUE(FindAndDeleteCookie(cm, url_google_.host(), "A"));
+  EXPECT_EQ("", GetCookies(cm, url_google_));
+  EXPECT_EQ("C=D", GetCookiesWithOptions(cm, url_google_, options));
+  EXPECT_EQ("E=F", GetCookies(cm, url_google_foo_));
+}
+
 TEST_F(CookieMonsterTest, SetCookieableSchemes) {
   scoped_refptr<CookieMonster> cm(new CookieMonster(NULL, NULL));
   scoped_refptr<CookieMonster> cm_foo(new CookieMonster(NULL, NULL));
@@ -4,6 +4,8 @@
 
 #include "net/disk_cache/backend_impl.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
 #include "base/file_path.h"
@@ -52,6 +54,11 @@ const int kDefaultCacheSize = 80 * 1024 * 1024;
 // Avoid trimming the cache for the first 5 minutes (10 timer ticks).
 const int kTrimDelay = 10;
 
+// Buckets of the index added to the hash index by each task, and the longest
+// bucket we are willing to follow.
+const uint32 kHashIndexBucketsPerStep = 4 * 1024;
+const int kMaxBucketLength = 1000;
+
 int DesiredIndexTableLen(int32 storage_size) {
   if (storage_size <= k64kEntriesStore)
     return kBaseTableLen;
@@ -309,6 +316,8 @@ BackendImpl::BackendImpl(const FilePath& path,
       block_files_(path),
       mask_(0),
       max_size_(0),
+      hash_index_position_(0),
+      hash_index_pass_(0),
       up_ticks_(0),
       cache_type_(net::DISK_CACHE),
       uma_report_(0),
@@ -335,6 +344,8 @@ BackendImpl::BackendImpl(const FilePath& path,
       block_files_(path),
       mask_(mask),
       max_size_(0),
+      hash_index_position_(0),
+      hash_index_pass_(0),
       up_ticks_(0),
       cache_type_(net::DISK_CACHE),
       uma_report_(0),
@@ -501,6 +512,9 @@ int BackendImpl::SyncInit() {
   trace_object_->EnableTracing(true);
 #endif
 
+  if (!disabled_)
+    StartHashIndex();
+
   return disabled_ ? net::ERR_FAILED : net::OK;
 }
 
@@ -524,6 +538,7 @@ void BackendImpl::CleanupCache() {
   }
   block_files_.CloseFiles();
   index_ = NULL;
+  hash_index_.Clear();
   ptr_factory_.InvalidateWeakPtrs();
   done_.Signal();
 }
@@ -788,6 +803,7 @@ EntryImpl* BackendImpl::CreateEntryImpl(const std::string& key) {
   } else {
     data_->table[hash & mask_] = entry_address.value();
   }
+  AddToHashIndex(hash);
 
   // Link this entry through the lists.
   eviction_.OnCreateEntry(cache_entry);
@@ -923,6 +939,7 @@ void BackendImpl::RecoveredEntry(CacheRankingsBlock* rankings) {
     return;
 
   data_->table[hash & mask_] = address.value();
+  AddToHashIndex(hash);
 }
 
 void BackendImpl::InternalDoomEntry(EntryImpl* entry) {
@@ -948,8 +965,10 @@ void BackendImpl::InternalDoomEntry(EntryImpl* entry) {
   if (parent_entry) {
     parent_entry->SetNextAddress(Addr(child));
     parent_entry->Release();
+    RemoveFromHashIndex(hash);
   } else if (!error) {
     data_->table[hash & mask_] = child;
+    RemoveFromHashIndex(hash);
   }
 }
 
@@ -1324,6 +1343,14 @@ int32 BackendImpl::GetEntryCount() const {
 int BackendImpl::OpenEntry(const std::string& key, Entry** entry,
                            const CompletionCallback& callback) {
   DCHECK(!callback.is_null());
+  // Misses can be answered without waiting behind the work queued for the
+  // cache thread, unless an entry that is still being created is the one
+  // being asked for.
+  if (!background_queue_.HasPendingCreates() &&
+      !hash_index_.MayContain(Hash(key))) {
+    return net::ERR_FAILED;
+  }
+
   background_queue_.OpenEntry(key, entry, callback);
   return net::ERR_IO_PENDING;
 }
@@ -1538,6 +1565,8 @@ void BackendImpl::PrepareForRestart() {
     new_eviction_ = false;
 
   disabled_ = true;
+  hash_index_.Clear();
+  hash_index_position_ = 0;
   data_->header.crash = 0;
   index_ = NULL;
   data_ = NULL;
@@ -1547,6 +1576,77 @@ void BackendImpl::PrepareForRestart() {
   restarted_ = true;
 }
 
+void BackendImpl::StartHashIndex() {
+  hash_index_.Clear();
+  hash_index_position_ = 0;
+  PopulateHashIndex(++hash_index_pass_);
+}
+
+void BackendImpl::PopulateHashIndex(int pass) {
+  if (pass != hash_index_pass_ || disabled_)
+    return;
+
+  uint32 end = std::min(mask_ + 1,
+                        hash_index_position_ + kHashIndexBucketsPerStep);
+  for (; hash_index_position_ < end; hash_index_position_++) {
+    Addr address(data_->table[hash_index_position_]);
+    for (int length = 0; address.is_initialized(); length++) {
+      uint32 hash;
+      if (length == kMaxBucketLength ||
+          !GetHashAndNextAddr(address, &hash, &address)) {
+        // We cannot trust this bucket, so the hash index will not be used
+        // until the cache is restarted.
+        LOG(WARNING) << "Unable to build the hash index.";
+        hash_index_.Clear();
+        hash_index_position_ = 0;
+        hash_index_pass_++;
+        return;
+      }
+      hash_index_.Insert(hash);
+    }
+  }
+
+  if (hash_index_position_ > mask_) {
+    hash_index_.SetComplete();
+    return;
+  }
+
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&BackendImpl::PopulateHashIndex, GetWeakPtr(), pass));
+}
+
+bool BackendImpl::GetHashAndNextAddr(Addr address, uint32* hash, Addr* next) {
+  EntriesMap::iterator it = open_entries_.find(address.value());
+  if (it != open_entries_.end()) {
+    *hash = it->second->GetHash();
+    next->set_value(it->second->GetNextAddress());
+    return true;
+  }
+
+  if (!address.SanityCheckForEntry())
+    return false;
+
+  CacheEntryBlock entry(File(address), address);
+  if (!entry.Load())
+    return false;
+
+  *hash = entry.Data()->hash;
+  next->set_value(entry.Data()->next);
+  return true;
+}
+
+void BackendImpl::AddToHashIndex(uint32 hash) {
+  // Buckets that have not been added yet will be picked up later.
+  if ((hash & mask_) < hash_index_position_)
+    hash_index_.Insert(hash);
+}
+
+void BackendImpl::RemoveFromHashIndex(uint32 hash) {
+  if ((hash & mask_) < hash_index_position_)
+    hash_index_.Remove(hash);
+}
+
 int BackendImpl::NewEntry(Addr address, EntryImpl** entry) {
   EntriesMap::iterator it = open_entries_.find(address.value());
   if (it != open_entries_.end()) {
@@ -1674,6 +1774,7 @@ EntryImpl* BackendImpl::MatchEntry(const std::string& key, uint32 hash,
             address.value());
 
       if (!error) {
+        RemoveFromHashIndex(cache_entry->GetHash());
         // It is important to call DestroyInvalidEntry after removing this
         // entry from the table.
         DestroyInvalidEntry(cache_entry);
@@ -14,6 +14,7 @@
 #include "net/disk_cache/block_files.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/eviction.h"
+#include "net/disk_cache/hash_index.h"
 #include "net/disk_cache/in_flight_backend_io.h"
 #include "net/disk_cache/rankings.h"
 #include "net/disk_cache/stats.h"
@@ -249,6 +250,9 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   // entries. This method should be called directly on the cache thread.
   void TrimDeletedListForTest(bool empty);
 
+  // Returns the eviction policy in use (after initialization).
+  EvictionPolicy GetEvictionPolicy() const { return eviction_.policy(); }
+
   // Performs a simple self-check, and returns the number of dirty items
   // or an error code (negative value).
   int SelfCheck();
@@ -285,6 +289,20 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   void RestartCache(bool failure);
   void PrepareForRestart();
 
+  // Starts filling |hash_index_| with the entries linked on the index.
+  void StartHashIndex();
+
+  // Adds the next group of buckets to |hash_index_|.
+  void PopulateHashIndex(int pass);
+
+  // Reads the hash and the next address on the bucket of the entry stored at
+  // |address|, without creating an entry object. Returns false on failure.
+  bool GetHashAndNextAddr(Addr address, uint32* hash, Addr* next);
+
+  // Keep |hash_index_| in sync with the entries linked on the index.
+  void AddToHashIndex(uint32 hash);
+  void RemoveFromHashIndex(uint32 hash);
+
   // Creates a new entry object. Returns zero on success, or a disk_cache error
   // on failure.
   int NewEntry(Addr address, EntryImpl** entry);
@@ -358,6 +376,9 @@ class NET_EXPORT_PRIVATE BackendImpl : public Backend {
   int32 max_size_;  // Maximum data size for this instance.
   Eviction eviction_;  // Handler of the eviction algorithm.
   EntriesMap open_entries_;  // Map of open entries.
+  HashIndex hash_index_;  // Hashes of the linked entries, for quick misses.
+  uint32 hash_index_position_;  // Buckets below this one are on hash_index_.
+  int hash_index_pass_;  // Identifies the current population of hash_index_.
   int num_refs_;  // Number of referenced cache entries.
   int max_refs_;  // Max number of referenced cache entries.
   int num_pending_io_;  // Number of pending IO operations.
@@ -585,6 +585,84 @@ TEST_F(DiskCacheBackendTest, MemoryOnlyLoad) {
   BackendLoad();
 }
 
+namespace {
+
+// Creates, writes, reads and closes entries on a memory-only cache.
+class MemoryOnlyUser : public base::PlatformThread::Delegate {
+ public:
+  MemoryOnlyUser(disk_cache::Backend* cache, int id)
+      : cache_(cache), id_(id), failures_(0) {}
+
+  virtual void ThreadMain() OVERRIDE {
+    const int kSize = 4096;
+    scoped_refptr<net::IOBuffer> buffer1(new net::IOBuffer(kSize));
+    scoped_refptr<net::IOBuffer> buffer2(new net::IOBuffer(kSize));
+    CacheTestFillBuffer(buffer1->data(), kSize, false);
+
+    for (int i = 0; i < 400; i++) {
+      std::string key = base::StringPrintf("thread %d key %d", id_, i);
+      disk_cache::Entry* entry;
+      if (cache_->CreateEntry(key, &entry, net::CompletionCallback()) !=
+          net::OK) {
+        failures_++;
+        continue;
+      }
+      // The entry is open, so it cannot be evicted until we close it.
+      if (entry->WriteData(0, 0, buffer1, kSize, net::CompletionCallback(),
+                           false) != kSize ||
+          entry->ReadData(0, 0, buffer2, kSize,
+                          net::CompletionCallback()) != kSize ||
+          memcmp(buffer1->data(), buffer2->data(), kSize)) {
+        failures_++;
+      }
+      entry->Close();
+    }
+  }
+
+  int failures() const { return failures_; }
+
+ private:
+  disk_cache::Backend* cache_;
+  int id_;
+  int failures_;
+};
+
+}  // namespace
+
+// Uses the memory-only cache from a few threads at the same time, with a size
+// limit that forces evictions from every shard.
+TEST_F(DiskCacheBackendTest, MemoryOnlyThreads) {
+  SetMemoryOnlyMode();
+  const int kMaxSize = 2 * 1024 * 1024;
+  scoped_ptr<disk_cache::Backend> cache(
+      disk_cache::MemBackendImpl::CreateBackend(kMaxSize, NULL));
+  ASSERT_TRUE(cache.get());
+
+  const int kNumThreads = 4;
+  scoped_ptr<MemoryOnlyUser> users[kNumThreads];
+  base::PlatformThreadHandle handles[kNumThreads];
+  for (int i = 0; i < kNumThreads; i++) {
+    users[i].reset(new MemoryOnlyUser(cache.get(), i));
+    ASSERT_TRUE(base::PlatformThread::Create(0, users[i].get(), &handles[i]));
+  }
+  for (int i = 0; i < kNumThreads; i++) {
+    base::PlatformThread::Join(handles[i]);
+    EXPECT_EQ(0, users[i]->failures());
+  }
+
+  // Every entry takes a little more than 4 KB.
+  EXPECT_GT(cache->GetEntryCount(), 0);
+  EXPECT_LT(cache->GetEntryCount(), kMaxSize / 4096);
+
+  // The oldest entries are the first ones to go.
+  for (int i = 0; i < kNumThreads; i++) {
+    disk_cache::Entry* entry;
+    std::string key = base::StringPrintf("thread %d key 0", i);
+    EXPECT_NE(net::OK, cache->OpenEntry(key, &entry,
+                                        net::CompletionCallback()));
+  }
+}
+
 TEST_F(DiskCacheBackendTest, AppCacheLoad) {
   SetCacheType(net::APP_CACHE);
   // Work with a tiny index table (16 entries)
@@ -651,6 +729,51 @@ TEST_F(DiskCacheBackendTest, NewEvictionTrim) {
   entry->Close();
 }
 
+// Large entries that were never reused are evicted first.
+TEST_F(DiskCacheBackendTest, NewEvictionTrimLargeEntries) {
+  SetNewEviction();
+  SetDirectMode();
+  SetMaxSize(20 * 1024 * 1024);
+  InitCache();
+  EXPECT_EQ(disk_cache::EVICTION_SIZE_AWARE, cache_impl_->GetEvictionPolicy());
+
+  disk_cache::Entry* entry;
+  for (int i = 0; i < 10; i++) {
+    std::string name(StringPrintf("Key %d", i));
+    ASSERT_EQ(net::OK, CreateEntry(name, &entry));
+    entry->Close();
+    ASSERT_EQ(net::OK, OpenEntry(name, &entry));
+    entry->Close();
+  }
+
+  // The end of list 0 is a small entry, followed by a large one.
+  ASSERT_EQ(net::OK, CreateEntry("Small", &entry));
+  entry->Close();
+
+  const int kLargeSize = 1024 * 1024;
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(kLargeSize));
+  CacheTestFillBuffer(buffer->data(), kLargeSize, false);
+  ASSERT_EQ(net::OK, CreateEntry("Large", &entry));
+  EXPECT_EQ(kLargeSize, WriteData(entry, 1, 0, buffer, kLargeSize, false));
+  entry->Close();
+
+  for (int i = 10; i < 20; i++) {
+    ASSERT_EQ(net::OK, CreateEntry(StringPrintf("Key %d", i), &entry));
+    entry->Close();
+  }
+
+  TrimForTest(false);
+  EXPECT_NE(net::OK, OpenEntry("Large", &entry));
+  ASSERT_EQ(net::OK, OpenEntry("Small", &entry));
+  entry->Close();
+
+  // With no large entries left, the regular order is used.
+  TrimForTest(false);
+  EXPECT_NE(net::OK, OpenEntry("Key 10", &entry));
+  ASSERT_EQ(net::OK, OpenEntry("Key 11", &entry));
+  entry->Close();
+}
+
 // Before looking for invalid entries, let's check a valid entry.
 void DiskCacheBackendTest::BackendValidEntry() {
   SetDirectMode();
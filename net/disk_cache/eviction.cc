@@ -26,8 +26,17 @@
 // size so that we have a chance to see an element again and move it to another
 // list.
 
+// The size-aware flavor of the new eviction deals with large responses (like
+// media files) that are read once and never again: before looking at the
+// lists in the usual order, a few entries from the end of the NO_USE list are
+// checked, and those that are a big chunk of the cache are evicted first. That
+// way a few large entries that were never reused do not push out many small
+// ones that are.
+
 #include "net/disk_cache/eviction.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/logging.h"
@@ -50,6 +59,13 @@ const int kHighUse = 10;  // Reuse count to be on the HIGH_USE list.
 const int kTargetTime = 24 * 7;  // Time to be evicted (hours since last use).
 const int kMaxDelayedTrims = 60;
 
+// Entries at least this big, or kLargeEntryFraction of the cache, whichever is
+// larger, are large for the size-aware eviction. We don't look past
+// kLargeEntrySearch nodes for them.
+const int kMinLargeEntrySize = 1024 * 1024;
+const int kLargeEntryFraction = 32;
+const int kLargeEntrySearch = 32;
+
 int LowWaterAdjust(int high_water) {
   if (high_water < kCleanUpMargin)
     return 0;
@@ -61,6 +77,14 @@ int LowWaterAdjust(int high_water) {
 
 namespace disk_cache {
 
+EvictionPolicy GetEvictionPolicy(net::CacheType type, bool new_eviction) {
+  if (!new_eviction)
+    return EVICTION_LRU;
+
+  // A media cache stores mostly large entries, so size says little there.
+  return type == net::DISK_CACHE ? EVICTION_SIZE_AWARE : EVICTION_REUSE;
+}
+
 // The real initialization happens during Init(), init_ is the only member that
 // has to be initialized here.
 Eviction::Eviction()
@@ -81,6 +105,7 @@ void Eviction::Init(BackendImpl* backend) {
   max_size_ = LowWaterAdjust(backend_->max_size_);
   index_size_ = backend->mask_ + 1;
   new_eviction_ = backend->new_eviction_;
+  policy_ = GetEvictionPolicy(backend->cache_type(), new_eviction_);
   first_trim_ = true;
   trimming_ = false;
   delay_trim_ = false;
@@ -306,6 +331,17 @@ void Eviction::TrimCacheV2(bool empty) {
   trimming_ = true;
   TimeTicks start = TimeTicks::Now();
 
+  int large_entries = 0;
+  if (!empty && policy_ == EVICTION_SIZE_AWARE) {
+    large_entries = TrimLargeEntries(max_size_);
+    CACHE_UMA(COUNTS, "TrimLargeItems", 0, large_entries);
+    if (large_entries && (test_mode_ || header_->num_bytes <= max_size_)) {
+      Trace("*** Trim Cache end ***");
+      trimming_ = false;
+      return;
+    }
+  }
+
   const int kListsToSearch = 3;
   Rankings::ScopedRankingsBlock next[kListsToSearch];
   int list = Rankings::LAST_ELEMENT;
@@ -523,6 +559,52 @@ bool Eviction::RemoveDeletedNode(CacheRankingsBlock* node) {
   return !doomed;
 }
 
+int Eviction::TrimLargeEntries(int target_size) {
+  Rankings::ScopedRankingsBlock node(rankings_);
+  Rankings::ScopedRankingsBlock next(
+      rankings_, rankings_->GetPrev(NULL, Rankings::NO_USE));
+  int deleted_entries = 0;
+  for (int i = 0; i < kLargeEntrySearch && next.get() &&
+       (header_->num_bytes > target_size || test_mode_); i++) {
+    if (!next->HasData())
+      break;
+    node.reset(next.release());
+    next.reset(rankings_->GetPrev(node.get(), Rankings::NO_USE));
+    if (node->Data()->dirty == backend_->GetCurrentEntryId() ||
+        !IsLargeEntry(node.get())) {
+      continue;
+    }
+
+    // Do NOT use node as an iterator after this point.
+    rankings_->TrackRankingsBlock(node.get(), false);
+    if (EvictEntry(node.get(), false, Rankings::NO_USE))
+      deleted_entries++;
+    if (test_mode_)
+      break;
+  }
+  return deleted_entries;
+}
+
+bool Eviction::IsLargeEntry(CacheRankingsBlock* node) {
+  // Peek at the entry without going through the backend, so that problems
+  // with it are found (and handled) by the regular eviction.
+  Addr address(node->Data()->contents);
+  if (!address.SanityCheckForEntry())
+    return false;
+
+  CacheEntryBlock entry(backend_->File(address), address);
+  if (!entry.Load() || entry.Data()->state != ENTRY_NORMAL)
+    return false;
+
+  int64 size = 0;
+  for (size_t i = 0; i < arraysize(entry.Data()->data_size); i++)
+    size += entry.Data()->data_size[i];
+
+  int64 large_size = std::max(kMinLargeEntrySize,
+                              max_size_ / kLargeEntryFraction);
+  return size >= large_size;
+}
+
 bool Eviction::NodeIsOldEnough(CacheRankingsBlock* node, int list) {
   if (!node)
     return false;
@@ -8,6 +8,7 @@
 
 #include "base/basictypes.h"
 #include "base/memory/weak_ptr.h"
+#include "net/base/cache_type.h"
 #include "net/disk_cache/disk_format.h"
 #include "net/disk_cache/rankings.h"
 
@@ -16,6 +17,19 @@ namespace disk_cache {
 class BackendImpl;
 class EntryImpl;
 
+// The ways entries can be picked for eviction. They all share the on-disk
+// rankings lists; see eviction.cc for the details.
+enum EvictionPolicy {
+  EVICTION_LRU,  // A single list, ordered by last use.
+  EVICTION_REUSE,  // Lists by reuse, plus a list of evicted entries.
+  EVICTION_SIZE_AWARE  // Like EVICTION_REUSE, but large entries that were
+                       // never reused go first.
+};
+
+// Returns the policy to use for a cache of the given |type|. |new_eviction|
+// is true if the cache uses the multiple lists of the new eviction.
+EvictionPolicy GetEvictionPolicy(net::CacheType type, bool new_eviction);
+
 // This class implements the eviction algorithm for the cache and it is tightly
 // integrated with BackendImpl.
 class Eviction {
@@ -40,6 +54,8 @@ class Eviction {
   void OnDoomEntry(EntryImpl* entry);
   void OnDestroyEntry(EntryImpl* entry);
 
+  EvictionPolicy policy() const { return policy_; }
+
   // Testing interface.
   void SetTestMode();
   void TrimDeletedList(bool empty);
@@ -66,6 +82,11 @@ class Eviction {
   void TrimDeleted(bool empty);
   bool RemoveDeletedNode(CacheRankingsBlock* node);
 
+  // Evicts large entries from the end of the NO_USE list, until the cache is
+  // below |target_size|. Returns the number of evicted entries.
+  int TrimLargeEntries(int target_size);
+  bool IsLargeEntry(CacheRankingsBlock* node);
+
   bool NodeIsOldEnough(CacheRankingsBlock* node, int list);
   int SelectListByLength(Rankings::ScopedRankingsBlock* next);
   void ReportListStats();
@@ -76,6 +97,7 @@ class Eviction {
   int max_size_;
   int trim_delays_;
   int index_size_;
+  EvictionPolicy policy_;
   bool new_eviction_;
   bool first_trim_;
   bool trimming_;
@@ -9,8 +9,20 @@ namespace disk_cache {
 // Cross platform constructors. Platform specific code is in
 // file_{win,posix}.cc.
 
+#if defined(OS_POSIX)
+File::File()
+    : init_(false), mixed_(false), queued_bytes_(0),
+      flush_scheduled_(false) {
+}
+
+File::File(bool mixed_mode)
+    : init_(false), mixed_(mixed_mode), queued_bytes_(0),
+      flush_scheduled_(false) {
+}
+#else
 File::File() : init_(false), mixed_(false) {}
 
 File::File(bool mixed_mode) : init_(false), mixed_(mixed_mode) {}
+#endif
 
 }  // namespace disk_cache
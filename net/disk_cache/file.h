@@ -8,8 +8,12 @@
 #define NET_DISK_CACHE_FILE_H_
 #pragma once
 
+#include <map>
+#include <string>
+
 #include "base/memory/ref_counted.h"
 #include "base/platform_file.h"
+#include "build/build_config.h"
 #include "net/base/net_export.h"
 
 class FilePath;
@@ -65,6 +69,12 @@ class NET_EXPORT_PRIVATE File : public base::RefCounted<File> {
   bool SetLength(size_t length);
   size_t GetLength();
 
+#if defined(OS_POSIX)
+  // Writes the data queued with QueueWrite() to the file. Returns false if
+  // any of the writes fails.
+  bool FlushQueuedWrites();
+#endif
+
   // Blocks until |num_pending_io| IO operations complete.
   static void WaitForPendingIO(int* num_pending_io);
 
@@ -79,11 +89,35 @@ class NET_EXPORT_PRIVATE File : public base::RefCounted<File> {
   bool AsyncWrite(const void* buffer, size_t buffer_len, size_t offset,
                   FileIOCallback* callback, bool* completed);
 
+#if defined(OS_POSIX)
+  // Copies the data to be written together with the other writes issued
+  // while the current task runs, with as few system calls as possible, when
+  // that task ends. Any other IO that overlaps the queued data writes it
+  // first. Without a running message loop the data is written right away.
+  bool QueueWrite(const void* buffer, size_t buffer_len, size_t offset);
+#endif
+
  private:
+#if defined(OS_POSIX)
+  // Queued data, by file offset.
+  typedef std::map<size_t, std::string> QueuedWrites;
+
+  // Returns true if [offset, offset + len) overlaps queued data.
+  bool OverlapsQueuedWrites(size_t offset, size_t len) const;
+
+  // Flushes overlapping queued data before regular IO.
+  void PrepareForIO(size_t offset, size_t len);
+#endif
+
   bool init_;
   bool mixed_;
   base::PlatformFile platform_file_;  // Regular, asynchronous IO handle.
   base::PlatformFile sync_platform_file_;  // Synchronous IO handle.
+#if defined(OS_POSIX)
+  QueuedWrites queued_writes_;
+  size_t queued_bytes_;
+  bool flush_scheduled_;  // Whether the thread's flusher knows about us.
+#endif
 
   DISALLOW_COPY_AND_ASSIGN(File);
 };
@@ -5,10 +5,18 @@
 #include "net/disk_cache/file.h"
 
 #include <fcntl.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <set>
 
 #include "base/bind.h"
+#include "base/eintr_wrapper.h"
+#include "base/lazy_instance.h"
 #include "base/location.h"
 #include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/threading/thread_local.h"
 #include "base/threading/worker_pool.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/disk_cache.h"
@@ -16,6 +24,64 @@
 
 namespace {
 
+// Queued writes are flushed at the end of the current task, or as soon as
+// this much data is waiting.
+const size_t kMaxQueuedBytes = 64 * 1024;
+
+// The most buffers given to a single pwritev() call.
+const int kMaxBuffersPerWrite = 64;
+
+bool ReadAt(base::PlatformFile file, void* buffer, size_t buffer_len,
+            size_t offset) {
+  if (buffer_len > static_cast<size_t>(kint32max) ||
+      offset > static_cast<size_t>(kint32max))
+    return false;
+
+  int ret = base::ReadPlatformFile(file, offset, static_cast<char*>(buffer),
+                                   buffer_len);
+  return (static_cast<size_t>(ret) == buffer_len);
+}
+
+bool WriteAt(base::PlatformFile file, const void* buffer, size_t buffer_len,
+             size_t offset) {
+  if (buffer_len > static_cast<size_t>(kint32max) ||
+      offset > static_cast<size_t>(kint32max))
+    return false;
+
+  int ret = base::WritePlatformFile(file, offset,
+                                    static_cast<const char*>(buffer),
+                                    buffer_len);
+  return (static_cast<size_t>(ret) == buffer_len);
+}
+
+// Writes |count| buffers that are contiguous on the file, starting at
+// |offset|, with a single system call when possible.
+bool WriteGatheredAt(base::PlatformFile file, const struct iovec* buffers,
+                     int count, size_t offset) {
+  size_t total = 0;
+  for (int i = 0; i < count; i++)
+    total += buffers[i].iov_len;
+  if (total > static_cast<size_t>(kint32max) ||
+      offset > static_cast<size_t>(kint32max))
+    return false;
+
+#if defined(OS_LINUX)
+  ssize_t ret = HANDLE_EINTR(pwritev(file, buffers, count, offset));
+  if (ret >= 0 && static_cast<size_t>(ret) == total)
+    return true;
+  if (ret < 0)
+    return false;
+  // A short write; finish the job one buffer at a time.
+#endif
+
+  for (int i = 0; i < count; i++) {
+    if (!WriteAt(file, buffers[i].iov_base, buffers[i].iov_len, offset))
+      return false;
+    offset += buffers[i].iov_len;
+  }
+  return true;
+}
+
 // This class represents a single asynchronous IO operation while it is being
 // bounced between threads.
 class FileBackgroundIO : public disk_cache::BackgroundIO {
@@ -92,7 +158,8 @@ class FileInFlightIO : public disk_cache::InFlightIO {
 
 // Runs on a worker thread.
 void FileBackgroundIO::Read() {
-  if (file_->Read(const_cast<void*>(buf_), buf_len_, offset_)) {
+  if (ReadAt(file_->platform_file(), const_cast<void*>(buf_), buf_len_,
+             offset_)) {
     result_ = static_cast<int>(buf_len_);
   } else {
     result_ = net::ERR_CACHE_READ_FAILURE;
@@ -102,7 +169,7 @@ void FileBackgroundIO::Read() {
 
 // Runs on a worker thread.
 void FileBackgroundIO::Write() {
-  bool rv = file_->Write(buf_, buf_len_, offset_);
+  bool rv = WriteAt(file_->platform_file(), buf_, buf_len_, offset_);
 
   result_ = rv ? static_cast<int>(buf_len_) : net::ERR_CACHE_WRITE_FAILURE;
   NotifyController();
@@ -164,6 +231,79 @@ void DeleteFileInFlightIO() {
   s_file_operations = NULL;
 }
 
+// Writes the data queued by the files of a thread when the task that queued
+// it ends, so queued data never outlives the backend operation or IO
+// completion that stored it. There is one per thread that queues writes, and
+// it lives as long as the thread's message loop.
+class QueuedWritesFlusher : public MessageLoop::TaskObserver,
+                            public MessageLoop::DestructionObserver {
+ public:
+  // Returns the flusher of the current thread, creating it if needed.
+  static QueuedWritesFlusher* GetForCurrentThread();
+
+  // Returns the flusher of the current thread, or NULL.
+  static QueuedWritesFlusher* current();
+
+  void AddFile(disk_cache::File* file) { files_.insert(file); }
+  void RemoveFile(disk_cache::File* file) { files_.erase(file); }
+
+  // MessageLoop::TaskObserver implementation.
+  virtual void WillProcessTask(base::TimeTicks time_posted) OVERRIDE {}
+  virtual void DidProcessTask(base::TimeTicks time_posted) OVERRIDE;
+
+  // MessageLoop::DestructionObserver implementation.
+  virtual void WillDestroyCurrentMessageLoop() OVERRIDE;
+
+ private:
+  QueuedWritesFlusher() {}
+  virtual ~QueuedWritesFlusher() {}
+
+  void FlushAll();
+
+  // Files with queued data.
+  std::set<disk_cache::File*> files_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueuedWritesFlusher);
+};
+
+base::LazyInstance<base::ThreadLocalPointer<QueuedWritesFlusher> >::Leaky
+    g_flusher = LAZY_INSTANCE_INITIALIZER;
+
+// static
+QueuedWritesFlusher* QueuedWritesFlusher::GetForCurrentThread() {
+  QueuedWritesFlusher* flusher = current();
+  if (!flusher) {
+    flusher = new QueuedWritesFlusher;
+    MessageLoop::current()->AddTaskObserver(flusher);
+    MessageLoop::current()->AddDestructionObserver(flusher);
+    g_flusher.Pointer()->Set(flusher);
+  }
+  return flusher;
+}
+
+// static
+QueuedWritesFlusher* QueuedWritesFlusher::current() {
+  return g_flusher.Pointer()->Get();
+}
+
+void QueuedWritesFlusher::DidProcessTask(base::TimeTicks time_posted) {
+  FlushAll();
+}
+
+void QueuedWritesFlusher::WillDestroyCurrentMessageLoop() {
+  FlushAll();
+  MessageLoop::current()->RemoveTaskObserver(this);
+  MessageLoop::current()->RemoveDestructionObserver(this);
+  g_flusher.Pointer()->Set(NULL);
+  delete this;
+}
+
+void QueuedWritesFlusher::FlushAll() {
+  // Flushing a file takes it out of |files_|.
+  while (!files_.empty())
+    (*files_.begin())->FlushQueuedWrites();
+}
+
 }  // namespace
 
 namespace disk_cache {
@@ -172,7 +312,9 @@ File::File(base::PlatformFile file)
     : init_(true),
       mixed_(true),
       platform_file_(file),
-      sync_platform_file_(base::kInvalidPlatformFileValue) {
+      sync_platform_file_(base::kInvalidPlatformFileValue),
+      queued_bytes_(0),
+      flush_scheduled_(false) {
 }
 
 bool File::Init(const FilePath& name) {
@@ -204,25 +346,14 @@ bool File::IsValid() const {
 
 bool File::Read(void* buffer, size_t buffer_len, size_t offset) {
   DCHECK(init_);
-  if (buffer_len > static_cast<size_t>(kint32max) ||
-      offset > static_cast<size_t>(kint32max))
-    return false;
-
-  int ret = base::ReadPlatformFile(platform_file_, offset,
-                                   static_cast<char*>(buffer), buffer_len);
-  return (static_cast<size_t>(ret) == buffer_len);
+  PrepareForIO(offset, buffer_len);
+  return ReadAt(platform_file_, buffer, buffer_len, offset);
 }
 
 bool File::Write(const void* buffer, size_t buffer_len, size_t offset) {
   DCHECK(init_);
-  if (buffer_len > static_cast<size_t>(kint32max) ||
-      offset > static_cast<size_t>(kint32max))
-    return false;
-
-  int ret = base::WritePlatformFile(platform_file_, offset,
-                                    static_cast<const char*>(buffer),
-                                    buffer_len);
-  return (static_cast<size_t>(ret) == buffer_len);
+  PrepareForIO(offset, buffer_len);
+  return WriteAt(platform_file_, buffer, buffer_len, offset);
 }
 
 // We have to increase the ref counter of the file before performing the IO to
@@ -240,6 +371,7 @@ bool File::Read(void* buffer, size_t buffer_len, size_t offset,
   if (buffer_len > ULONG_MAX || offset > ULONG_MAX)
     return false;
 
+  PrepareForIO(offset, buffer_len);
   GetFileInFlightIO()->PostRead(this, buffer, buffer_len, offset, callback);
 
   *completed = false;
@@ -263,11 +395,13 @@ bool File::SetLength(size_t length) {
   if (length > ULONG_MAX)
     return false;
 
+  FlushQueuedWrites();
   return base::TruncatePlatformFile(platform_file_, length);
 }
 
 size_t File::GetLength() {
   DCHECK(init_);
+  FlushQueuedWrites();
   off_t ret = lseek(platform_file_, 0, SEEK_END);
   if (ret < 0)
     return 0;
@@ -288,7 +422,39 @@ void File::DropPendingIO() {
   DeleteFileInFlightIO();
 }
 
+bool File::FlushQueuedWrites() {
+  if (flush_scheduled_) {
+    flush_scheduled_ = false;
+    DCHECK(QueuedWritesFlusher::current());
+    QueuedWritesFlusher::current()->RemoveFile(this);
+  }
+
+  bool success = true;
+  QueuedWrites::const_iterator it = queued_writes_.begin();
+  while (it != queued_writes_.end()) {
+    // Gather a run of writes that are next to each other on the file.
+    struct iovec buffers[kMaxBuffersPerWrite];
+    size_t offset = it->first;
+    size_t end = offset;
+    int count = 0;
+    for (; it != queued_writes_.end() && it->first == end &&
+           count < kMaxBuffersPerWrite; ++it, ++count) {
+      buffers[count].iov_base = const_cast<char*>(it->second.data());
+      buffers[count].iov_len = it->second.size();
+      end += it->second.size();
+    }
+    if (!WriteGatheredAt(platform_file_, buffers, count, offset)) {
+      LOG(ERROR) << "Failed to write queued data at " << offset;
+      success = false;
+    }
+  }
+  queued_writes_.clear();
+  queued_bytes_ = 0;
+  return success;
+}
+
 File::~File() {
+  FlushQueuedWrites();
   if (IsValid())
     base::ClosePlatformFile(platform_file_);
 }
@@ -299,6 +465,7 @@ bool File::AsyncWrite(const void* buffer, size_t buffer_len, size_t offset,
   if (buffer_len > ULONG_MAX || offset > ULONG_MAX)
     return false;
 
+  PrepareForIO(offset, buffer_len);
   GetFileInFlightIO()->PostWrite(this, buffer, buffer_len, offset, callback);
 
   if (completed)
@@ -306,4 +473,55 @@ bool File::AsyncWrite(const void* buffer, size_t buffer_len, size_t offset,
   return true;
 }
 
+bool File::QueueWrite(const void* buffer, size_t buffer_len, size_t offset) {
+  DCHECK(init_);
+  if (buffer_len > static_cast<size_t>(kint32max) ||
+      offset > static_cast<size_t>(kint32max))
+    return false;
+
+  // Without a running message loop there is no end of task to flush at.
+  if (!MessageLoop::current() || !MessageLoop::current()->is_running())
+    return Write(buffer, buffer_len, offset);
+
+  // Storing the same block again just replaces the queued copy; anything
+  // else that overlaps has to go to the file first.
+  QueuedWrites::iterator it = queued_writes_.find(offset);
+  if (it != queued_writes_.end() && it->second.size() == buffer_len) {
+    it->second.assign(static_cast<const char*>(buffer), buffer_len);
+    return true;
+  }
+  if (OverlapsQueuedWrites(offset, buffer_len) && !FlushQueuedWrites())
+    return false;
+
+  queued_writes_[offset].assign(static_cast<const char*>(buffer), buffer_len);
+  queued_bytes_ += buffer_len;
+  if (queued_bytes_ >= kMaxQueuedBytes)
+    return FlushQueuedWrites();
+
+  if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    QueuedWritesFlusher::GetForCurrentThread()->AddFile(this);
+  }
+  return true;
+}
+
+bool File::OverlapsQueuedWrites(size_t offset, size_t len) const {
+  if (queued_writes_.empty())
+    return false;
+
+  // The first block that starts past |offset|, and the one before it.
+  QueuedWrites::const_iterator it = queued_writes_.upper_bound(offset);
+  if (it != queued_writes_.end() && it->first < offset + len)
+    return true;
+  if (it == queued_writes_.begin())
+    return false;
+  --it;
+  return it->first + it->second.size() > offset;
+}
+
+void File::PrepareForIO(size_t offset, size_t len) {
+  if (OverlapsQueuedWrites(offset, len))
+    FlushQueuedWrites();
+}
+
 }  // namespace disk_cache
@@ -0,0 +1,222 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/hash_index.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+
+using base::subtle::Acquire_Load;
+using base::subtle::AtomicWord;
+using base::subtle::Release_Store;
+
+namespace {
+
+const int kMinCapacity = 1024;
+
+// Reserved slot values. Hashes that collide with them are stored as a
+// different value, which can only cause false positives.
+const uint32 kEmptySlot = 0;
+const uint32 kRemovedSlot = 1;
+
+uint32 SlotValue(uint32 hash) {
+  return hash > kRemovedSlot ? hash : hash + 2;
+}
+
+// Returns the first slot to look at for |value|. The bits are mixed so that
+// runs of nearby values do not end up on a single long probe sequence.
+uint32 FirstSlot(uint32 value, uint32 mask) {
+  value ^= value >> 16;
+  value *= 0x85ebca6b;
+  value ^= value >> 13;
+  value *= 0xc2b2ae35;
+  value ^= value >> 16;
+  return value & mask;
+}
+
+}  // namespace
+
+namespace disk_cache {
+
+HashIndex::Table::Table(int capacity)
+    : capacity(capacity),
+      slots(new base::subtle::Atomic32[capacity]) {
+  DCHECK_EQ(0, capacity & (capacity - 1));
+  memset(slots.get(), 0, sizeof(slots[0]) * capacity);
+}
+
+HashIndex::Table::~Table() {
+}
+
+HashIndex::HashIndex()
+    : current_(0), previous_(0), complete_(0), size_(0), used_(0),
+      move_position_(0), moves_per_update_(0) {
+  Clear();
+}
+
+HashIndex::~HashIndex() {
+}
+
+void HashIndex::Insert(uint32 hash) {
+  MoveSlots(moves_per_update_);
+
+  Table* table = current();
+  if ((used_ + 1) * 4 > table->capacity * 3) {
+    Grow();
+    table = current();
+  }
+
+  if (AddToTable(table, SlotValue(hash)))
+    used_++;
+  size_++;
+}
+
+void HashIndex::Remove(uint32 hash) {
+  MoveSlots(moves_per_update_);
+
+  uint32 value = SlotValue(hash);
+  Table* old_table = previous();
+  if ((old_table && RemoveFromTable(old_table, value)) ||
+      RemoveFromTable(current(), value)) {
+    DCHECK_GT(size_, 0);
+    size_--;
+  }
+}
+
+void HashIndex::Clear() {
+  // Readers must stop trusting the set before it goes empty.
+  Release_Store(&complete_, 0);
+
+  Table* table = new Table(kMinCapacity);
+  tables_.push_back(table);
+  Release_Store(&previous_, 0);
+  Release_Store(&current_, reinterpret_cast<AtomicWord>(table));
+  size_ = 0;
+  used_ = 0;
+  move_position_ = 0;
+  moves_per_update_ = 0;
+}
+
+void HashIndex::SetComplete() {
+  Release_Store(&complete_, 1);
+}
+
+bool HashIndex::MayContain(uint32 hash) const {
+  if (!Acquire_Load(&complete_))
+    return true;
+
+  uint32 value = SlotValue(hash);
+  for (;;) {
+    // Slots are moved from the previous table to the current one by adding
+    // them to the new table before removing them from the old one, so looking
+    // at the old table first cannot miss a moving slot. If another move
+    // started while we were looking, the slot may have gone to a table we did
+    // not see, so look again.
+    const Table* table = current();
+    const Table* old_table = previous();
+    if (old_table && TableContains(old_table, value))
+      return true;
+    if (TableContains(table, value))
+      return true;
+    if (current() == table)
+      break;
+  }
+
+  // The set may have been cleared while we were looking.
+  return !Acquire_Load(&complete_);
+}
+
+HashIndex::Table* HashIndex::current() const {
+  return reinterpret_cast<Table*>(Acquire_Load(&current_));
+}
+
+HashIndex::Table* HashIndex::previous() const {
+  return reinterpret_cast<Table*>(Acquire_Load(&previous_));
+}
+
+// static
+bool HashIndex::TableContains(const Table* table, uint32 value) {
+  uint32 mask = table->capacity - 1;
+  for (uint32 i = FirstSlot(value, mask);; i = (i + 1) & mask) {
+    uint32 slot = Acquire_Load(&table->slots[i]);
+    if (slot == value)
+      return true;
+    if (slot == kEmptySlot)
+      return false;
+  }
+}
+
+// static
+bool HashIndex::AddToTable(Table* table, uint32 value) {
+  uint32 mask = table->capacity - 1;
+  for (uint32 i = FirstSlot(value, mask);; i = (i + 1) & mask) {
+    uint32 slot = table->slots[i];
+    if (slot == kEmptySlot || slot == kRemovedSlot) {
+      Release_Store(&table->slots[i], value);
+      return slot == kEmptySlot;
+    }
+  }
+}
+
+// static
+bool HashIndex::RemoveFromTable(Table* table, uint32 value) {
+  uint32 mask = table->capacity - 1;
+  for (uint32 i = FirstSlot(value, mask);; i = (i + 1) & mask) {
+    uint32 slot = table->slots[i];
+    if (slot == value) {
+      Release_Store(&table->slots[i], kRemovedSlot);
+      return true;
+    }
+    if (slot == kEmptySlot)
+      return false;
+  }
+}
+
+void HashIndex::Grow() {
+  Table* old_table = previous();
+  if (old_table)
+    MoveSlots(old_table->capacity);
+
+  // The new table starts at most a quarter full, and the move completes
+  // before another quarter of it is used, so it never has to grow while
+  // the previous one is still being emptied.
+  old_table = current();
+  int capacity = kMinCapacity;
+  while (capacity < size_ * 4)
+    capacity *= 2;
+  Table* table = new Table(capacity);
+  tables_.push_back(table);
+
+  // Readers that see the new table must also see the old one.
+  Release_Store(&previous_, reinterpret_cast<AtomicWord>(old_table));
+  Release_Store(&current_, reinterpret_cast<AtomicWord>(table));
+  used_ = 0;
+  move_position_ = 0;
+  int updates = capacity / 4;
+  moves_per_update_ = (old_table->capacity + updates - 1) / updates;
+  DVLOG(1) << "Growing the hash index to " << capacity << " slots";
+}
+
+void HashIndex::MoveSlots(int count) {
+  Table* old_table = previous();
+  if (!old_table)
+    return;
+
+  Table* table = current();
+  for (; count > 0 && move_position_ < old_table->capacity; count--) {
+    base::subtle::Atomic32* slot = &old_table->slots[move_position_++];
+    uint32 value = *slot;
+    if (value == kEmptySlot || value == kRemovedSlot)
+      continue;
+    if (AddToTable(table, value))
+      used_++;
+    Release_Store(slot, kRemovedSlot);
+  }
+
+  if (move_position_ == old_table->capacity)
+    Release_Store(&previous_, 0);
+}
+
+}  // namespace disk_cache
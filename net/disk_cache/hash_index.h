@@ -0,0 +1,97 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_HASH_INDEX_H_
+#define NET_DISK_CACHE_HASH_INDEX_H_
+#pragma once
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// An in-memory multiset of the hashes of the entries linked on the cache
+// index. The cache thread keeps it up to date as entries are linked and
+// unlinked, and any thread can ask whether an entry with a given hash may
+// exist without taking a lock or waiting for the cache thread.
+//
+// The set uses open addressing over slots that are written with atomic stores.
+// When it fills up, a larger table is allocated and the slots of the old one
+// are moved over a few at a time by the following updates, so no single
+// update pays for the whole rebuild. Lookups look at both tables while a move
+// is in progress. Tables are not deleted until the set goes away, so a reader
+// never touches freed memory.
+class NET_EXPORT_PRIVATE HashIndex {
+ public:
+  HashIndex();
+  ~HashIndex();
+
+  // Updates the set. These methods should only be called from one thread.
+  void Insert(uint32 hash);
+  void Remove(uint32 hash);
+
+  // Empties the set and marks it as incomplete.
+  void Clear();
+
+  // Marks the set as holding the hash of every linked entry. Until this is
+  // called, MayContain() always returns true.
+  void SetComplete();
+
+  // Returns false if there is certainly no entry with |hash|. It may return
+  // true for a hash that is not on the set. This method can be called from
+  // any thread.
+  bool MayContain(uint32 hash) const;
+
+  // Returns the number of hashes on the set (updating thread only).
+  int size() const { return size_; }
+
+ private:
+  struct Table {
+    explicit Table(int capacity);
+    ~Table();
+
+    int capacity;  // Always a power of two.
+    scoped_array<base::subtle::Atomic32> slots;
+  };
+
+  Table* current() const;
+  Table* previous() const;
+
+  // Returns true if |table| has a slot holding |value|.
+  static bool TableContains(const Table* table, uint32 value);
+
+  // Stores |value| on |table|. Returns true if an empty slot was used (as
+  // opposed to a removed one).
+  static bool AddToTable(Table* table, uint32 value);
+
+  // Marks a slot holding |value| as removed. Returns false if not found.
+  static bool RemoveFromTable(Table* table, uint32 value);
+
+  // Starts moving the contents to a bigger table.
+  void Grow();
+
+  // Moves up to |count| slots from the previous table to the current one.
+  void MoveSlots(int count);
+
+  // Table* values. |previous_| is only set while a move is in progress.
+  base::subtle::AtomicWord current_;
+  base::subtle::AtomicWord previous_;
+  base::subtle::Atomic32 complete_;
+
+  // Members only used by the updating thread.
+  ScopedVector<Table> tables_;  // Every table ever used.
+  int size_;  // Hashes on the set.
+  int used_;  // Slots of the current table that are not empty.
+  int move_position_;  // Next slot of the previous table to move.
+  int moves_per_update_;
+
+  DISALLOW_COPY_AND_ASSIGN(HashIndex);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_HASH_INDEX_H_
@@ -0,0 +1,117 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/hash_index.h"
+
+#include "base/atomicops.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Keeps looking up hashes that are on the set for as long as they are
+// expected to be there.
+class Reader : public base::PlatformThread::Delegate {
+ public:
+  Reader(const disk_cache::HashIndex* index, uint32 num_hashes)
+      : index_(index), num_hashes_(num_hashes), stop_(0), misses_(0) {}
+
+  virtual void ThreadMain() OVERRIDE {
+    while (!base::subtle::Acquire_Load(&stop_)) {
+      for (uint32 i = 0; i < num_hashes_; i++) {
+        if (!index_->MayContain(i * 7919))
+          misses_++;
+      }
+    }
+  }
+
+  void Stop() { base::subtle::Release_Store(&stop_, 1); }
+  int misses() const { return misses_; }
+
+ private:
+  const disk_cache::HashIndex* index_;
+  uint32 num_hashes_;
+  base::subtle::Atomic32 stop_;
+  int misses_;
+};
+
+}  // namespace
+
+TEST(DiskCacheHashIndex, Basics) {
+  disk_cache::HashIndex index;
+
+  // Nothing can be ruled out until the set is complete.
+  EXPECT_TRUE(index.MayContain(5));
+  index.SetComplete();
+  EXPECT_FALSE(index.MayContain(5));
+
+  index.Insert(5);
+  index.Insert(5);
+  index.Insert(0);
+  EXPECT_EQ(3, index.size());
+  EXPECT_TRUE(index.MayContain(5));
+  EXPECT_TRUE(index.MayContain(0));
+
+  // The set keeps one copy per entry.
+  index.Remove(5);
+  EXPECT_TRUE(index.MayContain(5));
+  index.Remove(5);
+  EXPECT_FALSE(index.MayContain(5));
+
+  // Removing something that is not there is fine.
+  index.Remove(5);
+  EXPECT_EQ(1, index.size());
+
+  index.Clear();
+  EXPECT_EQ(0, index.size());
+  EXPECT_TRUE(index.MayContain(5));
+}
+
+TEST(DiskCacheHashIndex, Grow) {
+  disk_cache::HashIndex index;
+  index.SetComplete();
+
+  const uint32 kNumHashes = 100000;
+  for (uint32 i = 0; i < kNumHashes; i++) {
+    index.Insert(i * 3);
+    // Everything inserted so far must be found, even while slots move.
+    if (i % 997 == 0) {
+      for (uint32 j = 0; j <= i; j++)
+        ASSERT_TRUE(index.MayContain(j * 3)) << i << " " << j;
+    }
+  }
+  EXPECT_EQ(static_cast<int>(kNumHashes), index.size());
+
+  for (uint32 i = 0; i < kNumHashes; i += 2)
+    index.Remove(i * 3);
+  EXPECT_EQ(static_cast<int>(kNumHashes / 2), index.size());
+
+  for (uint32 i = 0; i < kNumHashes; i++)
+    EXPECT_EQ(i % 2 == 1, index.MayContain(i * 3)) << i;
+}
+
+TEST(DiskCacheHashIndex, ConcurrentReaders) {
+  disk_cache::HashIndex index;
+  index.SetComplete();
+
+  const uint32 kNumStable = 1000;
+  for (uint32 i = 0; i < kNumStable; i++)
+    index.Insert(i * 7919);
+
+  Reader reader(&index, kNumStable);
+  base::PlatformThreadHandle handle;
+  ASSERT_TRUE(base::PlatformThread::Create(0, &reader, &handle));
+
+  // Force a few moves to bigger tables, and churn removed slots, while the
+  // reader looks up the hashes that stay on the set.
+  for (uint32 i = 1; i <= 200000; i++) {
+    index.Insert(i * 2 + 1);
+    if (i % 3 == 0)
+      index.Remove((i - 1) * 2 + 1);
+  }
+
+  reader.Stop();
+  base::PlatformThread::Join(handle);
+  EXPECT_EQ(0, reader.misses());
+}
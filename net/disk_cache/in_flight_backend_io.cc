@@ -70,6 +70,10 @@ bool BackendIO::IsEntryOperation() {
   return operation_ > OP_MAX_BACKEND;
 }
 
+bool BackendIO::IsCreateOperation() const {
+  return operation_ == OP_CREATE;
+}
+
 // Runs on the background thread.
 void BackendIO::ReferenceEntry() {
   entry_->AddRef();
@@ -330,6 +334,7 @@ InFlightBackendIO::InFlightBackendIO(BackendImpl* backend,
                     base::MessageLoopProxy* background_thread)
     : backend_(backend),
       background_thread_(background_thread),
+      pending_creates_(0),
       ALLOW_THIS_IN_INITIALIZER_LIST(ptr_factory_(this)) {
 }
 
@@ -354,6 +359,7 @@ void InFlightBackendIO::CreateEntry(const std::string& key, Entry** entry,
   scoped_refptr<BackendIO> operation(new BackendIO(this, backend_, callback));
   operation->CreateEntry(key, entry);
   PostOperation(operation);
+  pending_creates_++;
 }
 
 void InFlightBackendIO::DoomEntry(const std::string& key,
@@ -504,6 +510,11 @@ void InFlightBackendIO::OnOperationComplete(BackgroundIO* operation,
   BackendIO* op = static_cast<BackendIO*>(operation);
   op->OnDone(cancel);
 
+  if (op->IsCreateOperation()) {
+    DCHECK_GT(pending_creates_, 0);
+    pending_creates_--;
+  }
+
   if (!op->callback().is_null() && (!cancel || op->IsEntryOperation()))
     op->callback().Run(op->result());
 }
@@ -41,6 +41,9 @@ class BackendIO : public BackgroundIO {
   // Returns true if this operation is directed to an entry (vs. the backend).
   bool IsEntryOperation();
 
+  // Returns true if this operation creates an entry.
+  bool IsCreateOperation() const;
+
   net::CompletionCallback callback() const { return callback_; }
 
   // Grabs an extra reference of entry_.
@@ -194,6 +197,10 @@ class InFlightBackendIO : public InFlightIO {
   // Blocks until all operations are cancelled or completed.
   void WaitForPendingIO();
 
+  // Returns true if there are CreateEntry() operations that have not
+  // completed yet.
+  bool HasPendingCreates() const { return pending_creates_ > 0; }
+
   scoped_refptr<base::MessageLoopProxy> background_thread() {
     return background_thread_;
   }
@@ -214,6 +221,7 @@ class InFlightBackendIO : public InFlightIO {
 
   BackendImpl* backend_;
   scoped_refptr<base::MessageLoopProxy> background_thread_;
+  int pending_creates_;
   base::WeakPtrFactory<InFlightBackendIO> ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(InFlightBackendIO);
@@ -34,7 +34,10 @@ class NET_EXPORT_PRIVATE MappedFile : public File {
     return buffer_;
   }
 
-  // Loads or stores a given block from the backing file (synchronously).
+  // Loads or stores a given block from the backing file (synchronously). On
+  // POSIX, stores to files other than the rankings files may be batched with
+  // other writes until the end of the current task, but a Load() always sees
+  // the stored data.
   bool Load(const FileBlock* block);
   bool Store(const FileBlock* block);
 
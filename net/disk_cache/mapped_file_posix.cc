@@ -9,6 +9,7 @@
 
 #include "base/file_path.h"
 #include "base/logging.h"
+#include "net/disk_cache/addr.h"
 #include "net/disk_cache/disk_cache.h"
 
 namespace disk_cache {
@@ -39,7 +40,16 @@ bool MappedFile::Load(const FileBlock* block) {
 
 bool MappedFile::Store(const FileBlock* block) {
   size_t offset = block->offset() + view_size_;
-  return Write(block->buffer(), block->size(), offset);
+
+  // Rankings nodes are the links of the LRU lists. Rankings updates the list
+  // heads and its transaction record right after storing them, so a crash
+  // must never find those updates on disk without the nodes.
+  BlockFileHeader* header = reinterpret_cast<BlockFileHeader*>(buffer_);
+  if (!header || header->entry_size == Addr::BlockSizeForFileType(RANKINGS))
+    return Write(block->buffer(), block->size(), offset);
+
+  // Entries tend to be stored in bursts, so let the file batch them.
+  return QueueWrite(block->buffer(), block->size(), offset);
 }
 
 MappedFile::~MappedFile() {
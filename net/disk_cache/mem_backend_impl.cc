@@ -8,9 +8,12 @@
 #include "base/sys_info.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/cache_util.h"
+#include "net/disk_cache/hash.h"
 #include "net/disk_cache/mem_entry_impl.h"
 
 using base::Time;
+using base::subtle::NoBarrier_AtomicIncrement;
+using base::subtle::NoBarrier_Load;
 
 namespace {
 
@@ -28,14 +31,25 @@ int LowWaterAdjust(int high_water) {
 
 namespace disk_cache {
 
+MemBackendImpl::Shard::Shard() : size(0) {
+}
+
+MemBackendImpl::Shard::~Shard() {
+}
+
 MemBackendImpl::MemBackendImpl(net::NetLog* net_log)
-    : max_size_(0), current_size_(0), net_log_(net_log) {}
+    : max_size_(0), current_size_(0), last_rank_(0), net_log_(net_log) {}
 
 MemBackendImpl::~MemBackendImpl() {
-  EntryMap::iterator it = entries_.begin();
-  while (it != entries_.end()) {
-    it->second->Doom();
-    it = entries_.begin();
+  for (int i = 0; i < kNumShards; i++) {
+    Shard* shard = &shards_[i];
+    base::AutoLock lock(shard->lock);
+    EntryMap::iterator it = shard->entries.begin();
+    while (it != shard->entries.end()) {
+      it->second->DoomImpl();
+      it = shard->entries.begin();
+    }
+    DCHECK(!shard->size);
   }
   DCHECK(!current_size_);
 }
@@ -87,14 +101,29 @@ bool MemBackendImpl::SetMaxSize(int max_bytes) {
   return true;
 }
 
+int MemBackendImpl::GetShardIndex(const std::string& key) const {
+  return Hash(key) % kNumShards;
+}
+
+base::Lock& MemBackendImpl::GetLock(const MemEntryImpl* entry) {
+  return shards_[entry->shard()].lock;
+}
+
+void MemBackendImpl::TrimIfNeeded() {
+  if (NoBarrier_Load(&current_size_) > max_size_)
+    TrimCache(false);
+}
+
 void MemBackendImpl::InternalDoomEntry(MemEntryImpl* entry) {
   // Only parent entries can be passed into this method.
   DCHECK(entry->type() == MemEntryImpl::kParentEntry);
 
-  rankings_.Remove(entry);
-  EntryMap::iterator it = entries_.find(entry->GetKey());
-  if (it != entries_.end())
-    entries_.erase(it);
+  Shard* shard = &shards_[entry->shard()];
+  shard->lock.AssertAcquired();
+  shard->rankings.Remove(entry);
+  EntryMap::iterator it = shard->entries.find(entry->key());
+  if (it != shard->entries.end())
+    shard->entries.erase(it);
   else
     NOTREACHED();
 
@@ -102,14 +131,18 @@ void MemBackendImpl::InternalDoomEntry(MemEntryImpl* entry) {
 }
 
 void MemBackendImpl::UpdateRank(MemEntryImpl* node) {
-  rankings_.UpdateRank(node);
+  shards_[node->shard()].rankings.UpdateRank(node);
+  SetRank(node);
 }
 
-void MemBackendImpl::ModifyStorageSize(int32 old_size, int32 new_size) {
-  if (old_size >= new_size)
-    SubstractStorageSize(old_size - new_size);
-  else
-    AddStorageSize(new_size - old_size);
+void MemBackendImpl::ModifyStorageSize(MemEntryImpl* entry, int32 old_size,
+                                       int32 new_size) {
+  // The cache is trimmed by the callers, once the shard lock is released.
+  Shard* shard = &shards_[entry->shard()];
+  shard->size += new_size - old_size;
+  DCHECK_GE(shard->size, 0);
+  int32 total = NoBarrier_AtomicIncrement(&current_size_, new_size - old_size);
+  DCHECK_GE(total, 0);
 }
 
 int MemBackendImpl::MaxFileSize() const {
@@ -117,15 +150,21 @@ int MemBackendImpl::MaxFileSize() const {
 }
 
 void MemBackendImpl::InsertIntoRankingList(MemEntryImpl* entry) {
-  rankings_.Insert(entry);
+  shards_[entry->shard()].rankings.Insert(entry);
+  SetRank(entry);
 }
 
 void MemBackendImpl::RemoveFromRankingList(MemEntryImpl* entry) {
-  rankings_.Remove(entry);
+  shards_[entry->shard()].rankings.Remove(entry);
 }
 
 int32 MemBackendImpl::GetEntryCount() const {
-  return static_cast<int32>(entries_.size());
+  size_t count = 0;
+  for (int i = 0; i < kNumShards; i++) {
+    base::AutoLock lock(shards_[i].lock);
+    count += shards_[i].entries.size();
+  }
+  return static_cast<int32>(count);
 }
 
 int MemBackendImpl::OpenEntry(const std::string& key, Entry** entry,
@@ -189,15 +228,19 @@ void MemBackendImpl::EndEnumeration(void** iter) {
 }
 
 void MemBackendImpl::OnExternalCacheHit(const std::string& key) {
-  EntryMap::iterator it = entries_.find(key);
-  if (it != entries_.end()) {
+  Shard* shard = &shards_[GetShardIndex(key)];
+  base::AutoLock lock(shard->lock);
+  EntryMap::iterator it = shard->entries.find(key);
+  if (it != shard->entries.end()) {
     UpdateRank(it->second);
   }
 }
 
 bool MemBackendImpl::OpenEntry(const std::string& key, Entry** entry) {
-  EntryMap::iterator it = entries_.find(key);
-  if (it == entries_.end())
+  Shard* shard = &shards_[GetShardIndex(key)];
+  base::AutoLock lock(shard->lock);
+  EntryMap::iterator it = shard->entries.find(key);
+  if (it == shard->entries.end())
     return false;
 
   it->second->Open();
@@ -207,30 +250,36 @@ bool MemBackendImpl::OpenEntry(const std::string& key, Entry** entry) {
 }
 
 bool MemBackendImpl::CreateEntry(const std::string& key, Entry** entry) {
-  EntryMap::iterator it = entries_.find(key);
-  if (it != entries_.end())
-    return false;
-
-  MemEntryImpl* cache_entry = new MemEntryImpl(this);
-  if (!cache_entry->CreateEntry(key, net_log_)) {
-    delete entry;
-    return false;
-  }
+  {
+    Shard* shard = &shards_[GetShardIndex(key)];
+    base::AutoLock lock(shard->lock);
+    EntryMap::iterator it = shard->entries.find(key);
+    if (it != shard->entries.end())
+      return false;
+
+    MemEntryImpl* cache_entry = new MemEntryImpl(this);
+    if (!cache_entry->CreateEntry(key, net_log_)) {
+      delete entry;
+      return false;
+    }
 
-  rankings_.Insert(cache_entry);
-  entries_[key] = cache_entry;
+    InsertIntoRankingList(cache_entry);
+    shard->entries[key] = cache_entry;
 
-  *entry = cache_entry;
+    *entry = cache_entry;
+  }
+  TrimIfNeeded();
   return true;
 }
 
 bool MemBackendImpl::DoomEntry(const std::string& key) {
-  Entry* entry;
-  if (!OpenEntry(key, &entry))
+  Shard* shard = &shards_[GetShardIndex(key)];
+  base::AutoLock lock(shard->lock);
+  EntryMap::iterator it = shard->entries.find(key);
+  if (it == shard->entries.end())
     return false;
 
-  entry->Doom();
-  entry->Close();
+  it->second->DoomImpl();
   return true;
 }
 
@@ -246,82 +295,136 @@ bool MemBackendImpl::DoomEntriesBetween(const Time initial_time,
 
   DCHECK(end_time >= initial_time);
 
-  MemEntryImpl* next = rankings_.GetNext(NULL);
+  for (int i = 0; i < kNumShards; i++) {
+    Shard* shard = &shards_[i];
+    base::AutoLock lock(shard->lock);
+    MemEntryImpl* next = shard->rankings.GetNext(NULL);
 
-  // rankings_ is ordered by last used, this will descend through the cache
-  // and start dooming items before the end_time, and will stop once it reaches
-  // an item used before the initial time.
-  while (next) {
-    MemEntryImpl* node = next;
-    next = rankings_.GetNext(next);
+    // The rankings are ordered by last used, this will descend through the
+    // shard and start dooming items before the end_time, and will stop once it
+    // reaches an item used before the initial time.
+    while (next) {
+      MemEntryImpl* node = next;
+      next = shard->rankings.GetNext(next);
 
-    if (node->GetLastUsed() < initial_time)
-      break;
+      if (node->last_used() < initial_time)
+        break;
 
-    if (node->GetLastUsed() < end_time)
-      node->Doom();
+      if (node->last_used() < end_time)
+        node->DoomImpl();
+    }
   }
 
   return true;
 }
 
 bool MemBackendImpl::DoomEntriesSince(const Time initial_time) {
-  for (;;) {
-    // Get the entry in the front.
-    Entry* entry = rankings_.GetNext(NULL);
-
-    // Break the loop when there are no more entries or the entry is too old.
-    if (!entry || entry->GetLastUsed() < initial_time)
-      return true;
-    entry->Doom();
+  for (int i = 0; i < kNumShards; i++) {
+    Shard* shard = &shards_[i];
+    base::AutoLock lock(shard->lock);
+    for (;;) {
+      // Get the entry in the front.
+      MemEntryImpl* entry = shard->rankings.GetNext(NULL);
+
+      // Break the loop when there are no more entries or the entry is too old.
+      if (!entry || entry->last_used() < initial_time)
+        break;
+      entry->DoomImpl();
+    }
   }
+  return true;
 }
 
 bool MemBackendImpl::OpenNextEntry(void** iter, Entry** next_entry) {
+  // Entries are returned from the most to the least recently used one, across
+  // all the shards, so they all have to be locked (always in the same order).
+  for (int i = 0; i < kNumShards; i++)
+    shards_[i].lock.Acquire();
+
   MemEntryImpl* current = reinterpret_cast<MemEntryImpl*>(*iter);
-  MemEntryImpl* node = rankings_.GetNext(current);
-  // We should never return a child entry so iterate until we hit a parent
-  // entry.
-  while (node && node->type() != MemEntryImpl::kParentEntry) {
-    node = rankings_.GetNext(node);
+  MemEntryImpl* node = NULL;
+  for (int i = 0; i < kNumShards; i++) {
+    MemRankings* rankings = &shards_[i].rankings;
+    MemEntryImpl* candidate = NULL;
+    if (!current) {
+      candidate = rankings->GetNext(NULL);
+    } else if (current->shard() == i) {
+      candidate = rankings->GetNext(current);
+    } else {
+      // The rankings of each shard are ordered by rank.
+      candidate = rankings->GetNext(NULL);
+      while (candidate && candidate->rank() > current->rank())
+        candidate = rankings->GetNext(candidate);
+    }
+
+    // We should never return a child entry so iterate until we hit a parent
+    // entry.
+    while (candidate && candidate->type() != MemEntryImpl::kParentEntry)
+      candidate = rankings->GetNext(candidate);
+
+    if (candidate && (!node || candidate->rank() > node->rank()))
+      node = candidate;
   }
-  *next_entry = node;
-  *iter = node;
 
   if (node)
     node->Open();
 
+  for (int i = kNumShards - 1; i >= 0; i--)
+    shards_[i].lock.Release();
+
+  *next_entry = node;
+  *iter = node;
+
   return NULL != node;
 }
 
 void MemBackendImpl::TrimCache(bool empty) {
-  MemEntryImpl* next = rankings_.GetPrev(NULL);
-  if (!next)
+  if (empty) {
+    for (int i = 0; i < kNumShards; i++) {
+      Shard* shard = &shards_[i];
+      base::AutoLock lock(shard->lock);
+      while (MemEntryImpl* node = shard->rankings.GetPrev(NULL))
+        node->DoomImpl();
+    }
     return;
+  }
 
-  int target_size = empty ? 0 : LowWaterAdjust(max_size_);
-  while (current_size_ > target_size && next) {
-    MemEntryImpl* node = next;
-    next = rankings_.GetPrev(next);
-    if (!node->InUse() || empty) {
-      node->Doom();
+  // Evict the least recently used entry of the whole cache each time. Shards
+  // are only locked one at a time, so the choice may be slightly off if the
+  // cache is being used while we trim it.
+  int target_size = LowWaterAdjust(max_size_);
+  while (NoBarrier_Load(&current_size_) > target_size) {
+    Shard* oldest = NULL;
+    intptr_t oldest_rank = 0;
+    for (int i = 0; i < kNumShards; i++) {
+      Shard* shard = &shards_[i];
+      base::AutoLock lock(shard->lock);
+      MemEntryImpl* node = GetEvictionCandidate(shard);
+      if (node && (!oldest || node->rank() < oldest_rank)) {
+        oldest = shard;
+        oldest_rank = node->rank();
+      }
     }
-  }
+    if (!oldest)
+      return;
 
-  return;
+    base::AutoLock lock(oldest->lock);
+    MemEntryImpl* node = GetEvictionCandidate(oldest);
+    if (node)
+      node->DoomImpl();
+  }
 }
 
-void MemBackendImpl::AddStorageSize(int32 bytes) {
-  current_size_ += bytes;
-  DCHECK_GE(current_size_, 0);
-
-  if (current_size_ > max_size_)
-    TrimCache(false);
+MemEntryImpl* MemBackendImpl::GetEvictionCandidate(Shard* shard) {
+  shard->lock.AssertAcquired();
+  MemEntryImpl* node = shard->rankings.GetPrev(NULL);
+  while (node && node->InUse())
+    node = shard->rankings.GetPrev(node);
+  return node;
 }
 
-void MemBackendImpl::SubstractStorageSize(int32 bytes) {
-  current_size_ -= bytes;
-  DCHECK_GE(current_size_, 0);
+void MemBackendImpl::SetRank(MemEntryImpl* node) {
+  node->set_rank(NoBarrier_AtomicIncrement(&last_rank_, 1));
 }
 
 }  // namespace disk_cache
@@ -8,8 +8,10 @@
 #define NET_DISK_CACHE_MEM_BACKEND_IMPL_H__
 #pragma once
 
+#include "base/atomicops.h"
 #include "base/compiler_specific.h"
 #include "base/hash_tables.h"
+#include "base/synchronization/lock.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/disk_cache/mem_rankings.h"
 
@@ -23,6 +25,15 @@ class MemEntryImpl;
 
 // This class implements the Backend interface. An object of this class handles
 // the operations of the cache without writing to disk.
+//
+// The entries are spread by key over a few shards, each one with its own map,
+// rankings list and lock, so the cache (and its entries) can be used from any
+// thread, and operations on different shards don't wait for each other. The
+// size limit applies to the whole cache: when it is exceeded, the least
+// recently used entries of all shards are evicted first.
+//
+// The backend methods called by MemEntryImpl expect the lock of the entry's
+// shard to be held by the caller (see GetLock()).
 class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
  public:
   explicit MemBackendImpl(net::NetLog* net_log);
@@ -41,14 +52,24 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
   // Sets the maximum size for the total amount of data stored by this instance.
   bool SetMaxSize(int max_bytes);
 
+  // Returns the shard that stores entries for |key|.
+  int GetShardIndex(const std::string& key) const;
+
+  // Returns the lock that protects |entry|, and the data of its shard.
+  base::Lock& GetLock(const MemEntryImpl* entry);
+
+  // Evicts entries if the cache grew too much. No shard lock can be held by
+  // the caller.
+  void TrimIfNeeded();
+
   // Permanently deletes an entry.
   void InternalDoomEntry(MemEntryImpl* entry);
 
   // Updates the ranking information for an entry.
   void UpdateRank(MemEntryImpl* node);
 
-  // A user data block is being created, extended or truncated.
-  void ModifyStorageSize(int32 old_size, int32 new_size);
+  // A user data block of |entry| is being created, extended or truncated.
+  void ModifyStorageSize(MemEntryImpl* entry, int32 old_size, int32 new_size);
 
   // Returns the maximum size for a file to reside on the cache.
   int MaxFileSize() const;
@@ -86,6 +107,20 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
  private:
   typedef base::hash_map<std::string, MemEntryImpl*> EntryMap;
 
+  enum {
+    kNumShards = 16
+  };
+
+  struct Shard {
+    Shard();
+    ~Shard();
+
+    mutable base::Lock lock;  // Protects everything here, and the entries.
+    EntryMap entries;
+    MemRankings rankings;  // Rankings to be able to trim the cache.
+    int32 size;  // Bytes used by the entries of this shard.
+  };
+
   // Old Backend interface.
   bool OpenEntry(const std::string& key, Entry** entry);
   bool CreateEntry(const std::string& key, Entry** entry);
@@ -101,14 +136,17 @@ class NET_EXPORT_PRIVATE MemBackendImpl : public Backend {
   // use.
   void TrimCache(bool empty);
 
-  // Handles the used storage count.
-  void AddStorageSize(int32 bytes);
-  void SubstractStorageSize(int32 bytes);
+  // Returns the least recently used entry of |shard| that is not in use, or
+  // NULL. The shard lock must be held.
+  MemEntryImpl* GetEvictionCandidate(Shard* shard);
+
+  // Stamps |node| as the most recently used entry of the whole cache.
+  void SetRank(MemEntryImpl* node);
 
-  EntryMap entries_;
-  MemRankings rankings_;  // Rankings to be able to trim the cache.
+  Shard shards_[kNumShards];
   int32 max_size_;        // Maximum data size for this instance.
-  int32 current_size_;
+  base::subtle::Atomic32 current_size_;  // Total size of all the shards.
+  base::subtle::AtomicWord last_rank_;  // Source of SetRank() stamps.
 
   net::NetLog* net_log_;
 
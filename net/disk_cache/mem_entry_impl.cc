@@ -49,6 +49,8 @@ MemEntryImpl::MemEntryImpl(MemBackendImpl* backend) {
   doomed_ = false;
   backend_ = backend;
   ref_count_ = 0;
+  shard_ = 0;
+  rank_ = 0;
   parent_ = NULL;
   child_id_ = 0;
   child_first_pos_ = 0;
@@ -67,11 +69,12 @@ bool MemEntryImpl::CreateEntry(const std::string& key, net::NetLog* net_log) {
       net::NetLog::TYPE_DISK_CACHE_MEM_ENTRY_IMPL,
       make_scoped_refptr(new EntryCreationParameters(key, true)));
   key_ = key;
+  shard_ = backend_->GetShardIndex(key);
   Time current = Time::Now();
   last_modified_ = current;
   last_used_ = current;
   Open();
-  backend_->ModifyStorageSize(0, static_cast<int32>(key.size()));
+  backend_->ModifyStorageSize(this, 0, static_cast<int32>(key.size()));
   return true;
 }
 
@@ -89,7 +92,7 @@ void MemEntryImpl::InternalDoom() {
           // Since a pointer to this object is also saved in the map, avoid
           // dooming it.
           if (i->second != this)
-            i->second->Doom();
+            i->second->DoomImpl();
         }
         DCHECK(children_->empty());
       }
@@ -101,6 +104,19 @@ void MemEntryImpl::InternalDoom() {
   }
 }
 
+void MemEntryImpl::DoomImpl() {
+  if (doomed_)
+    return;
+  if (type() == kParentEntry) {
+    // Perform internal doom from the backend if this is a parent entry.
+    backend_->InternalDoomEntry(this);
+  } else {
+    // Manually detach from the backend and perform internal doom.
+    backend_->RemoveFromRankingList(this);
+    InternalDoom();
+  }
+}
+
 void MemEntryImpl::Open() {
   // Only a parent entry can be opened.
   // TODO(hclam): make sure it's correct to not apply the concept of ref
@@ -125,21 +141,14 @@ bool MemEntryImpl::InUse() {
 // ------------------------------------------------------------------------
 
 void MemEntryImpl::Doom() {
-  if (doomed_)
-    return;
-  if (type() == kParentEntry) {
-    // Perform internal doom from the backend if this is a parent entry.
-    backend_->InternalDoomEntry(this);
-  } else {
-    // Manually detach from the backend and perform internal doom.
-    backend_->RemoveFromRankingList(this);
-    InternalDoom();
-  }
+  base::AutoLock lock(backend_->GetLock(this));
+  DoomImpl();
 }
 
 void MemEntryImpl::Close() {
   // Only a parent entry can be closed.
   DCHECK(type() == kParentEntry);
+  base::AutoLock lock(backend_->GetLock(this));
   ref_count_--;
   DCHECK_GE(ref_count_, 0);
   if (!ref_count_ && doomed_)
@@ -153,16 +162,19 @@ std::string MemEntryImpl::GetKey() const {
 }
 
 Time MemEntryImpl::GetLastUsed() const {
+  base::AutoLock lock(backend_->GetLock(this));
   return last_used_;
 }
 
 Time MemEntryImpl::GetLastModified() const {
+  base::AutoLock lock(backend_->GetLock(this));
   return last_modified_;
 }
 
 int32 MemEntryImpl::GetDataSize(int index) const {
   if (index < 0 || index >= NUM_STREAMS)
     return 0;
+  base::AutoLock lock(backend_->GetLock(this));
   return data_size_[index];
 }
 
@@ -175,7 +187,11 @@ int MemEntryImpl::ReadData(int index, int offset, IOBuffer* buf, int buf_len,
             new ReadWriteDataParameters(index, offset, buf_len, false)));
   }
 
-  int result = InternalReadData(index, offset, buf, buf_len);
+  int result;
+  {
+    base::AutoLock lock(backend_->GetLock(this));
+    result = InternalReadData(index, offset, buf, buf_len);
+  }
 
   if (net_log_.IsLoggingAllEvents()) {
     net_log_.EndEvent(
@@ -194,7 +210,12 @@ int MemEntryImpl::WriteData(int index, int offset, IOBuffer* buf, int buf_len,
             new ReadWriteDataParameters(index, offset, buf_len, truncate)));
   }
 
-  int result = InternalWriteData(index, offset, buf, buf_len, truncate);
+  int result;
+  {
+    base::AutoLock lock(backend_->GetLock(this));
+    result = InternalWriteData(index, offset, buf, buf_len, truncate);
+  }
+  backend_->TrimIfNeeded();
 
   if (net_log_.IsLoggingAllEvents()) {
     net_log_.EndEvent(
@@ -212,7 +233,11 @@ int MemEntryImpl::ReadSparseData(int64 offset, IOBuffer* buf, int buf_len,
         make_scoped_refptr(
             new SparseOperationParameters(offset, buf_len)));
   }
-  int result = InternalReadSparseData(offset, buf, buf_len);
+  int result;
+  {
+    base::AutoLock lock(backend_->GetLock(this));
+    result = InternalReadSparseData(offset, buf, buf_len);
+  }
   if (net_log_.IsLoggingAllEvents())
     net_log_.EndEvent(net::NetLog::TYPE_SPARSE_READ, NULL);
   return result;
@@ -225,7 +250,12 @@ int MemEntryImpl::WriteSparseData(int64 offset, IOBuffer* buf, int buf_len,
         make_scoped_refptr(
             new SparseOperationParameters(offset, buf_len)));
   }
-  int result = InternalWriteSparseData(offset, buf, buf_len);
+  int result;
+  {
+    base::AutoLock lock(backend_->GetLock(this));
+    result = InternalWriteSparseData(offset, buf, buf_len);
+  }
+  backend_->TrimIfNeeded();
   if (net_log_.IsLoggingAllEvents())
     net_log_.EndEvent(net::NetLog::TYPE_SPARSE_WRITE, NULL);
   return result;
@@ -239,7 +269,11 @@ int MemEntryImpl::GetAvailableRange(int64 offset, int len, int64* start,
         make_scoped_refptr(
             new SparseOperationParameters(offset, len)));
   }
-  int result = GetAvailableRange(offset, len, start);
+  int result;
+  {
+    base::AutoLock lock(backend_->GetLock(this));
+    result = GetAvailableRange(offset, len, start);
+  }
   if (net_log_.IsLoggingAllEvents()) {
     net_log_.EndEvent(
         net::NetLog::TYPE_SPARSE_GET_RANGE,
@@ -251,6 +285,7 @@ int MemEntryImpl::GetAvailableRange(int64 offset, int len, int64* start,
 
 bool MemEntryImpl::CouldBeSparse() const {
   DCHECK_EQ(kParentEntry, type());
+  base::AutoLock lock(backend_->GetLock(this));
   return (children_.get() != NULL);
 }
 
@@ -262,8 +297,8 @@ int MemEntryImpl::ReadyForSparseIO(const CompletionCallback& callback) {
 
 MemEntryImpl::~MemEntryImpl() {
   for (int i = 0; i < NUM_STREAMS; i++)
-    backend_->ModifyStorageSize(data_size_[i], 0);
-  backend_->ModifyStorageSize(static_cast<int32>(key_.size()), 0);
+    backend_->ModifyStorageSize(this, data_size_[i], 0);
+  backend_->ModifyStorageSize(this, static_cast<int32>(key_.size()), 0);
   net_log_.EndEvent(net::NetLog::TYPE_DISK_CACHE_MEM_ENTRY_IMPL, NULL);
 }
 
@@ -274,7 +309,7 @@ int MemEntryImpl::InternalReadData(int index, int offset, IOBuffer* buf,
   if (index < 0 || index >= NUM_STREAMS)
     return net::ERR_INVALID_ARGUMENT;
 
-  int entry_size = GetDataSize(index);
+  int entry_size = data_size_[index];
   if (offset >= entry_size || offset < 0 || !buf_len)
     return 0;
 
@@ -309,16 +344,16 @@ int MemEntryImpl::InternalWriteData(int index, int offset, IOBuffer* buf,
   }
 
   // Read the size at this point.
-  int entry_size = GetDataSize(index);
+  int entry_size = data_size_[index];
 
   PrepareTarget(index, offset, buf_len);
 
   if (entry_size < offset + buf_len) {
-    backend_->ModifyStorageSize(entry_size, offset + buf_len);
+    backend_->ModifyStorageSize(this, entry_size, offset + buf_len);
     data_size_[index] = offset + buf_len;
   } else if (truncate) {
     if (entry_size > offset + buf_len) {
-      backend_->ModifyStorageSize(entry_size, offset + buf_len);
+      backend_->ModifyStorageSize(this, entry_size, offset + buf_len);
       data_size_[index] = offset + buf_len;
     }
   }
@@ -368,8 +403,9 @@ int MemEntryImpl::InternalReadSparseData(int64 offset, IOBuffer* buf,
               child->net_log().source(),
               io_buf->BytesRemaining())));
     }
-    int ret = child->ReadData(kSparseData, child_offset, io_buf,
-                              io_buf->BytesRemaining(), CompletionCallback());
+    // The child is protected by the lock that we already hold.
+    int ret = child->InternalReadData(kSparseData, child_offset, io_buf,
+                                      io_buf->BytesRemaining());
     if (net_log_.IsLoggingAllEvents()) {
       net_log_.EndEventWithNetErrorCode(
           net::NetLog::TYPE_SPARSE_READ_CHILD_DATA, ret);
@@ -417,7 +453,7 @@ int MemEntryImpl::InternalWriteSparseData(int64 offset, IOBuffer* buf,
                              kMaxSparseEntrySize - child_offset);
 
     // Keep a record of the last byte position (exclusive) in the child.
-    int data_size = child->GetDataSize(kSparseData);
+    int data_size = child->data_size_[kSparseData];
 
     if (net_log_.IsLoggingAllEvents()) {
       net_log_.BeginEvent(
@@ -431,8 +467,8 @@ int MemEntryImpl::InternalWriteSparseData(int64 offset, IOBuffer* buf,
     // previously written.
     // TODO(hclam): if there is data in the entry and this write is not
     // continuous we may want to discard this write.
-    int ret = child->WriteData(kSparseData, child_offset, io_buf, write_len,
-                               CompletionCallback(), true);
+    int ret = child->InternalWriteData(kSparseData, child_offset, io_buf,
+                                       write_len, true);
     if (net_log_.IsLoggingAllEvents()) {
       net_log_.EndEventWithNetErrorCode(
           net::NetLog::TYPE_SPARSE_WRITE_CHILD_DATA, ret);
@@ -481,7 +517,7 @@ int MemEntryImpl::GetAvailableRange(int64 offset, int len, int64* start) {
     // This loop scan for continuous bytes.
     while (len && current_child) {
       // Number of bytes available in this child.
-      int data_size = current_child->GetDataSize(kSparseData) -
+      int data_size = current_child->data_size_[kSparseData] -
                       ToChildOffset(*start + continuous);
       if (data_size > len)
         data_size = len;
@@ -502,7 +538,7 @@ int MemEntryImpl::GetAvailableRange(int64 offset, int len, int64* start) {
 }
 
 void MemEntryImpl::PrepareTarget(int index, int offset, int buf_len) {
-  int entry_size = GetDataSize(index);
+  int entry_size = data_size_[index];
 
   if (entry_size >= offset + buf_len)
     return;  // Not growing the stored data.
@@ -535,7 +571,7 @@ bool MemEntryImpl::InitSparseInfo() {
   if (!children_.get()) {
     // If we already have some data in sparse stream but we are being
     // initialized as a sparse entry, we should fail.
-    if (GetDataSize(kSparseData))
+    if (data_size_[kSparseData])
       return false;
     children_.reset(new EntryMap());
 
@@ -561,6 +597,7 @@ bool MemEntryImpl::InitChildEntry(MemEntryImpl* parent, int child_id,
 
   parent_ = parent;
   child_id_ = child_id;
+  shard_ = parent->shard_;
   Time current = Time::Now();
   last_modified_ = current;
   last_used_ = current;
@@ -603,7 +640,7 @@ int MemEntryImpl::FindNextChild(int64 offset, int len, MemEntryImpl** child) {
 
       // If the first byte position we should read from doesn't exceed the
       // filled region, we have found the first child.
-      if (first_pos < current_child->GetDataSize(kSparseData)) {
+      if (first_pos < current_child->data_size_[kSparseData]) {
          *child = current_child;
 
          // We need to advance the scanned length.
@@ -57,12 +57,29 @@ class MemEntryImpl : public Entry {
   // cache.
   bool CreateEntry(const std::string& key, net::NetLog* net_log);
 
-  // Permanently destroys this entry.
+  // Permanently destroys this entry. |InternalDoom| and |DoomImpl| (which
+  // also removes the entry from the backend) expect the lock of the entry's
+  // shard to be held.
   void InternalDoom();
+  void DoomImpl();
 
   void Open();
   bool InUse();
 
+  // The backend shard that holds this entry.
+  int shard() const {
+    return shard_;
+  }
+
+  // Orders entries by last use, across shards.
+  intptr_t rank() const {
+    return rank_;
+  }
+
+  void set_rank(intptr_t rank) {
+    rank_ = rank;
+  }
+
   MemEntryImpl* next() const {
     return next_;
   }
@@ -87,6 +104,11 @@ class MemEntryImpl : public Entry {
     return key_;
   }
 
+  // Same as GetLastUsed(), for callers that hold the shard lock.
+  base::Time last_used() const {
+    return last_used_;
+  }
+
   net::BoundNetLog& net_log() {
     return net_log_;
   }
@@ -166,6 +188,8 @@ class MemEntryImpl : public Entry {
   std::vector<char> data_[NUM_STREAMS];  // User data.
   int32 data_size_[NUM_STREAMS];
   int ref_count_;
+  int shard_;
+  intptr_t rank_;
 
   int child_id_;              // The ID of a child entry.
   int child_first_pos_;       // The position of the first byte in a child
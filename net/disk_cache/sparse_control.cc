@@ -415,7 +415,7 @@ int SparseControl::OpenSparseEntry(int data_len) {
     return net::ERR_CACHE_OPERATION_NOT_SUPPORTED;
 
   // Read the actual bitmap.
-  buf = new net::IOBuffer(map_len);
+  buf = new net::PooledIOBuffer(map_len);
   rv = entry_->ReadData(kSparseIndex, sizeof(sparse_header_), buf, map_len,
                         CompletionCallback());
   if (rv != map_len)
@@ -2,7 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
+#include "base/bind.h"
 #include "base/file_util.h"
+#include "base/message_loop.h"
 #include "net/disk_cache/storage_block.h"
 #include "net/disk_cache/storage_block-inl.h"
 #include "net/disk_cache/disk_cache_test_base.h"
@@ -67,3 +71,111 @@ TEST_F(DiskCacheTest, StorageBlock_SetModified) {
   EXPECT_TRUE(entry2.Load());
   EXPECT_TRUE(0x45687912 == entry2.Data()->hash);
 }
+
+namespace {
+
+const int kNumBatchedBlocks = 8;
+
+// Reads the hashes of the first |kNumBatchedBlocks| entry blocks of
+// |filename| through a file of its own, which sees none of the data still
+// queued by other files.
+void ReadEntryHashes(const FilePath& filename, std::vector<uint32>* hashes) {
+  scoped_refptr<disk_cache::File> raw_file(new disk_cache::File(false));
+  ASSERT_TRUE(raw_file->Init(filename));
+  for (int i = 0; i < kNumBatchedBlocks; i++) {
+    disk_cache::EntryStore data;
+    ASSERT_TRUE(raw_file->Read(&data, sizeof(data), 8192 + i * sizeof(data)));
+    hashes->push_back(data.hash);
+  }
+}
+
+// Stores neighboring entry blocks to |file|, one of them twice, and records
+// what is on the file right after.
+void StoreEntryBlocks(disk_cache::MappedFile* file, const FilePath& filename,
+                      std::vector<uint32>* hashes) {
+  for (int i = 0; i < kNumBatchedBlocks; i++) {
+    disk_cache::CacheEntryBlock entry(file, disk_cache::Addr(0xa0010000 + i));
+    memset(entry.Data(), 0, sizeof(disk_cache::EntryStore));
+    entry.Data()->hash = i + 1;
+    EXPECT_TRUE(entry.Store());
+    if (i == 3) {
+      entry.Data()->hash = 0xaa5555aa;
+      EXPECT_TRUE(entry.Store());
+    }
+  }
+
+  // Loading a block sees the last stored data.
+  disk_cache::CacheEntryBlock entry3(file, disk_cache::Addr(0xa0010003));
+  EXPECT_TRUE(entry3.Load());
+  EXPECT_EQ(0xaa5555aa, entry3.Data()->hash);
+
+  ReadEntryHashes(filename, hashes);
+}
+
+}  // namespace
+
+TEST_F(DiskCacheTest, StorageBlock_BatchedStores) {
+  FilePath filename = cache_path_.AppendASCII("a_test");
+  scoped_refptr<disk_cache::MappedFile> file(new disk_cache::MappedFile);
+  ASSERT_TRUE(CreateCacheTestFile(filename));
+  ASSERT_TRUE(file->Init(filename, 8192));
+
+  // The stores wait until the task that made them ends, and not a moment
+  // longer: the task right behind it finds them on the file.
+  std::vector<uint32> during_task;
+  std::vector<uint32> after_task;
+  MessageLoop::current()->PostTask(
+      FROM_HERE, base::Bind(&StoreEntryBlocks, file, filename, &during_task));
+  MessageLoop::current()->PostTask(
+      FROM_HERE, base::Bind(&ReadEntryHashes, filename, &after_task));
+  MessageLoop::current()->RunAllPending();
+
+  ASSERT_EQ(static_cast<size_t>(kNumBatchedBlocks), during_task.size());
+  ASSERT_EQ(static_cast<size_t>(kNumBatchedBlocks), after_task.size());
+  for (int i = 0; i < kNumBatchedBlocks; i++) {
+    EXPECT_EQ(0U, during_task[i]);
+    EXPECT_EQ(i == 3 ? 0xaa5555aa : static_cast<uint32>(i + 1),
+              after_task[i]);
+  }
+}
+
+// Outside of a task, stores go to the file right away.
+TEST_F(DiskCacheTest, StorageBlock_StoresOutsideTask) {
+  FilePath filename = cache_path_.AppendASCII("a_test");
+  scoped_refptr<disk_cache::MappedFile> file(new disk_cache::MappedFile);
+  ASSERT_TRUE(CreateCacheTestFile(filename));
+  ASSERT_TRUE(file->Init(filename, 8192));
+
+  disk_cache::CacheEntryBlock entry(file, disk_cache::Addr(0xa0010002));
+  memset(entry.Data(), 0, sizeof(disk_cache::EntryStore));
+  entry.Data()->hash = 0x12345678;
+  EXPECT_TRUE(entry.Store());
+
+  std::vector<uint32> hashes;
+  ReadEntryHashes(filename, &hashes);
+  ASSERT_EQ(static_cast<size_t>(kNumBatchedBlocks), hashes.size());
+  EXPECT_EQ(0x12345678U, hashes[2]);
+}
+
+TEST_F(DiskCacheTest, StorageBlock_RankingsStoresNotBatched) {
+  FilePath filename = cache_path_.AppendASCII("a_test");
+  scoped_refptr<disk_cache::MappedFile> file(new disk_cache::MappedFile);
+  ASSERT_TRUE(CreateCacheTestFile(filename));
+  ASSERT_TRUE(file->Init(filename, 8192));
+  disk_cache::BlockFileHeader* header =
+      reinterpret_cast<disk_cache::BlockFileHeader*>(file->buffer());
+  header->entry_size =
+      disk_cache::Addr::BlockSizeForFileType(disk_cache::RANKINGS);
+
+  disk_cache::CacheRankingsBlock node(file, disk_cache::Addr(0x90000001));
+  memset(node.Data(), 0, sizeof(disk_cache::RankingsNode));
+  node.Data()->next = 0x90000002;
+  EXPECT_TRUE(node.Store());
+
+  // The node is on the file before the current task is done.
+  scoped_refptr<disk_cache::File> raw_file(new disk_cache::File(false));
+  ASSERT_TRUE(raw_file->Init(filename));
+  disk_cache::RankingsNode data;
+  ASSERT_TRUE(raw_file->Read(&data, sizeof(data), 8192 + sizeof(data)));
+  EXPECT_EQ(0x90000002, data.next);
+}
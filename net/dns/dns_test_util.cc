@@ -27,7 +27,7 @@ namespace {
 
 // A DnsTransaction which responds with loopback to all queries starting with
 // "ok", fails synchronously on all queries starting with "er", and NXDOMAIN to
-// all others.
+// all others. Queries starting with "4ok" only get an answer for type A.
 class MockTransaction : public DnsTransaction,
                         public base::SupportsWeakPtr<MockTransaction> {
  public:
@@ -62,7 +62,9 @@ class MockTransaction : public DnsTransaction,
 
  private:
   void Finish() {
-    if (hostname_.substr(0, 2) == "ok") {
+    if (hostname_.substr(0, 2) == "ok" ||
+        (hostname_.substr(0, 3) == "4ok" &&
+         qtype_ == net::dns_protocol::kTypeA)) {
       std::string qname;
       DNSDomainFromDot(hostname_, &qname);
       DnsQuery query(0, qname, qtype_);
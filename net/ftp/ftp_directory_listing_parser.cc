@@ -4,8 +4,11 @@
 
 #include "net/ftp/ftp_directory_listing_parser.h"
 
+#include <algorithm>
+
 #include "base/i18n/icu_encoding_detection.h"
 #include "base/i18n/icu_string_conversions.h"
+#include "base/logging.h"
 #include "base/stl_util.h"
 #include "base/string_split.h"
 #include "base/string_util.h"
@@ -21,6 +24,9 @@ namespace net {
 
 namespace {
 
+// Bytes of the listing to look at before picking how to parse it.
+const size_t kDetectionBytes = 4096;
+
 // Fills in |raw_name| for all |entries| using |encoding|. Returns network
 // error code.
 int FillInRawName(const std::string& encoding,
@@ -130,4 +136,129 @@ int ParseFtpDirectoryListing(const std::string& text,
   return rv;
 }
 
+FtpDirectoryListingStreamParser::FtpDirectoryListingStreamParser(
+    const base::Time& current_time)
+    : current_time_(current_time),
+      state_(STATE_DETECTING),
+      parsed_bytes_(0),
+      entries_appended_(0),
+      server_type_(SERVER_UNKNOWN),
+      received_total_line_(false) {
+}
+
+FtpDirectoryListingStreamParser::~FtpDirectoryListingStreamParser() {
+}
+
+void FtpDirectoryListingStreamParser::Append(
+    const char* data,
+    int data_len,
+    std::vector<FtpDirectoryListingEntry>* entries) {
+  buffer_.append(data, data_len);
+
+  if (state_ == STATE_DETECTING) {
+    if (buffer_.size() >= kDetectionBytes)
+      Detect(entries);
+    return;
+  }
+
+  if (state_ == STATE_STREAMING) {
+    size_t end = buffer_.rfind('\n');
+    if (end == std::string::npos || end < parsed_bytes_)
+      return;
+    // If the rest of the listing does not parse the same way, it is parsed
+    // as a whole at the end.
+    if (!ParseLines(end + 1, entries))
+      state_ = STATE_WAITING_FOR_END;
+  }
+}
+
+int FtpDirectoryListingStreamParser::Finish(
+    std::vector<FtpDirectoryListingEntry>* entries) {
+  // The last line may have no newline.
+  if (state_ == STATE_STREAMING &&
+      (parsed_bytes_ == buffer_.size() ||
+       ParseLines(buffer_.size(), entries))) {
+    UpdateFtpServerTypeHistograms(server_type_);
+    return OK;
+  }
+
+  std::vector<FtpDirectoryListingEntry> all_entries;
+  int rv = ParseFtpDirectoryListing(buffer_, current_time_, &all_entries);
+  if (rv != OK)
+    return rv;
+
+  // Skip the entries that were handed out while streaming.
+  size_t skip = std::min(entries_appended_, all_entries.size());
+  entries->insert(entries->end(), all_entries.begin() + skip,
+                  all_entries.end());
+  entries_appended_ = all_entries.size();
+  return OK;
+}
+
+void FtpDirectoryListingStreamParser::Detect(
+    std::vector<FtpDirectoryListingEntry>* entries) {
+  DCHECK_EQ(STATE_DETECTING, state_);
+  state_ = STATE_WAITING_FOR_END;
+
+  size_t end = buffer_.rfind('\n');
+  if (end == std::string::npos)
+    return;
+  std::string sample(buffer_, 0, end + 1);
+
+  // Stream in one encoding only: UTF-8 if the sample is valid UTF-8, since
+  // a sample of ASCII text fits many encodings, and the detected one
+  // otherwise. Lines that later fail to decode in it end the streaming.
+  if (IsStringUTF8(sample)) {
+    encoding_ = "UTF-8";
+  } else {
+    std::vector<std::string> encodings;
+    if (!base::DetectAllEncodings(sample, &encodings) || encodings.empty())
+      return;
+    encoding_ = encodings[0];
+  }
+
+  const FtpServerType kStreamedTypes[] = { SERVER_LS, SERVER_WINDOWS };
+  for (size_t i = 0; i < arraysize(kStreamedTypes); i++) {
+    server_type_ = kStreamedTypes[i];
+    received_total_line_ = false;
+    if (ParseLines(end + 1, entries)) {
+      state_ = STATE_STREAMING;
+      return;
+    }
+  }
+  server_type_ = SERVER_UNKNOWN;
+}
+
+bool FtpDirectoryListingStreamParser::ParseLines(
+    size_t end,
+    std::vector<FtpDirectoryListingEntry>* entries) {
+  DCHECK_GE(end, parsed_bytes_);
+  string16 text;
+  if (!base::CodepageToUTF16(buffer_.substr(parsed_bytes_, end - parsed_bytes_),
+                             encoding_.c_str(),
+                             base::OnStringConversionError::FAIL,
+                             &text)) {
+    return false;
+  }
+  std::vector<string16> lines;
+  base::SplitString(text, '\n', &lines);
+
+  std::vector<FtpDirectoryListingEntry> new_entries;
+  bool parsed = false;
+  if (server_type_ == SERVER_LS) {
+    parsed = ParseFtpDirectoryListingLsContinued(lines, current_time_,
+                                                 &new_entries,
+                                                 &received_total_line_);
+  } else if (server_type_ == SERVER_WINDOWS) {
+    parsed = ParseFtpDirectoryListingWindows(lines, &new_entries);
+  }
+  if (!parsed || FillInRawName(encoding_, &new_entries) != OK)
+    return false;
+
+  parsed_bytes_ = end;
+  entries->insert(entries->end(), new_entries.begin(), new_entries.end());
+  entries_appended_ += new_entries.size();
+  return true;
+}
+
 }  // namespace net
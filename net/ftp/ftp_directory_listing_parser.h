@@ -13,6 +13,7 @@
 #include "base/string16.h"
 #include "base/time.h"
 #include "net/base/net_export.h"
+#include "net/ftp/ftp_server_type_histograms.h"
 
 namespace net {
 
@@ -42,6 +43,63 @@ NET_EXPORT int ParseFtpDirectoryListing(
     const base::Time& current_time,
     std::vector<FtpDirectoryListingEntry>* entries);
 
+// Parses an FTP directory listing as it arrives, so that its entries can be
+// shown before all of it is in. The first few kilobytes decide the encoding
+// and the format. Listings in the "ls -l" and Windows formats are parsed a
+// line at a time from then on; others are parsed once they are complete.
+// The entries are the same as ParseFtpDirectoryListing() finds.
+class NET_EXPORT FtpDirectoryListingStreamParser {
+ public:
+  explicit FtpDirectoryListingStreamParser(const base::Time& current_time);
+  ~FtpDirectoryListingStreamParser();
+
+  // Adds |data_len| bytes of the listing, and appends the entries that they
+  // complete to |entries|.
+  void Append(const char* data,
+              int data_len,
+              std::vector<FtpDirectoryListingEntry>* entries);
+
+  // Ends the listing, and appends its remaining entries to |entries|.
+  // Returns network error code.
+  int Finish(std::vector<FtpDirectoryListingEntry>* entries);
+
+ private:
+  enum State {
+    // Waiting for enough of the listing to tell how to parse it.
+    STATE_DETECTING,
+    // Parsing lines as they arrive, as |server_type_| in |encoding_|.
+    STATE_STREAMING,
+    // Parsing the whole listing once it is complete.
+    STATE_WAITING_FOR_END,
+  };
+
+  // Picks the encoding and format from the complete lines received, and
+  // appends their entries to |entries| if they can be parsed as they arrive.
+  void Detect(std::vector<FtpDirectoryListingEntry>* entries);
+
+  // Parses the listing from |parsed_bytes_| up to |end|, and appends its
+  // entries to |entries|. Returns false if it cannot be parsed.
+  bool ParseLines(size_t end, std::vector<FtpDirectoryListingEntry>* entries);
+
+  const base::Time current_time_;
+  State state_;
+
+  // The listing received so far, of which |parsed_bytes_| are parsed.
+  std::string buffer_;
+  size_t parsed_bytes_;
+
+  // Number of entries handed out so far.
+  size_t entries_appended_;
+
+  std::string encoding_;
+  FtpServerType server_type_;
+
+  // Whether an "ls -l" listing had its "total n" header.
+  bool received_total_line_;
+
+  DISALLOW_COPY_AND_ASSIGN(FtpDirectoryListingStreamParser);
+};
+
 }  // namespace net
 
 #endif  // NET_FTP_FTP_DIRECTORY_LISTING_PARSER_H_
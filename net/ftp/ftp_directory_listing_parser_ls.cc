@@ -113,6 +113,15 @@ bool ParseFtpDirectoryListingLs(
   // integer. Only one such header is allowed per listing.
   bool received_total_line = false;
 
+  return ParseFtpDirectoryListingLsContinued(lines, current_time, entries,
+                                             &received_total_line);
+}
+
+bool ParseFtpDirectoryListingLsContinued(
+    const std::vector<string16>& lines,
+    const base::Time& current_time,
+    std::vector<FtpDirectoryListingEntry>* entries,
+    bool* received_total_line) {
   for (size_t i = 0; i < lines.size(); i++) {
     if (lines[i].empty())
       continue;
@@ -125,8 +134,8 @@ bool ParseFtpDirectoryListingLs(
     // the first non-empty line. Do not match the word exactly, because it may
     // be in different languages (at least English and German have been seen
     // in the field).
-    if (columns.size() == 2 && !received_total_line) {
-      received_total_line = true;
+    if (columns.size() == 2 && !*received_total_line) {
+      *received_total_line = true;
 
       int total_number;
       if (!base::StringToInt(columns[1], &total_number))
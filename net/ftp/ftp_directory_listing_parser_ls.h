@@ -25,6 +25,15 @@ NET_EXPORT_PRIVATE bool ParseFtpDirectoryListingLs(
     const base::Time& current_time,
     std::vector<FtpDirectoryListingEntry>* entries);
 
+// Like ParseFtpDirectoryListingLs(), but for |lines| that continue a listing
+// whose earlier lines have been parsed already. |*received_total_line| tells
+// whether those lines held the "total n" header, and is updated.
+NET_EXPORT_PRIVATE bool ParseFtpDirectoryListingLsContinued(
+    const std::vector<string16>& lines,
+    const base::Time& current_time,
+    std::vector<FtpDirectoryListingEntry>* entries,
+    bool* received_total_line);
+
 }  // namespace net
 
 #endif  // NET_FTP_FTP_DIRECTORY_LISTING_PARSER_LS_H_
@@ -4,6 +4,8 @@
 
 #include "net/ftp/ftp_directory_listing_parser.h"
 
+#include <algorithm>
+
 #include "base/file_util.h"
 #include "base/format_macros.h"
 #include "base/path_service.h"
@@ -19,25 +21,55 @@ namespace net {
 
 namespace {
 
-class FtpDirectoryListingParserTest
-    : public testing::TestWithParam<const char*> {
-};
-
-TEST_P(FtpDirectoryListingParserTest, Parse) {
-  FilePath test_dir;
-  PathService::Get(base::DIR_SOURCE_ROOT, &test_dir);
-  test_dir = test_dir.AppendASCII("net");
-  test_dir = test_dir.AppendASCII("data");
-  test_dir = test_dir.AppendASCII("ftp");
-
+base::Time GetMockCurrentTime() {
   base::Time::Exploded mock_current_time_exploded = { 0 };
   mock_current_time_exploded.year = 1994;
   mock_current_time_exploded.month = 11;
   mock_current_time_exploded.day_of_month = 15;
   mock_current_time_exploded.hour = 12;
   mock_current_time_exploded.minute = 45;
-  base::Time mock_current_time(
-      base::Time::FromLocalExploded(mock_current_time_exploded));
+  return base::Time::FromLocalExploded(mock_current_time_exploded);
+}
+
+// Feeds |listing| to a stream parser |chunk_size| bytes at a time.
+int StreamParse(const std::string& listing,
+                size_t chunk_size,
+                std::vector<FtpDirectoryListingEntry>* entries) {
+  FtpDirectoryListingStreamParser parser(GetMockCurrentTime());
+  for (size_t i = 0; i < listing.size(); i += chunk_size) {
+    size_t len = std::min(chunk_size, listing.size() - i);
+    parser.Append(listing.data() + i, static_cast<int>(len), entries);
+  }
+  return parser.Finish(entries);
+}
+
+void ExpectSameEntries(const std::vector<FtpDirectoryListingEntry>& expected,
+                       const std::vector<FtpDirectoryListingEntry>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].type, actual[i].type);
+    EXPECT_EQ(expected[i].name, actual[i].name);
+    EXPECT_EQ(expected[i].raw_name, actual[i].raw_name);
+    EXPECT_EQ(expected[i].size, actual[i].size);
+    EXPECT_EQ(expected[i].last_modified, actual[i].last_modified);
+  }
+}
+
+class FtpDirectoryListingParserTest
+    : public testing::TestWithParam<const char*> {
+ protected:
+  FilePath GetTestDir() {
+    FilePath test_dir;
+    PathService::Get(base::DIR_SOURCE_ROOT, &test_dir);
+    test_dir = test_dir.AppendASCII("net");
+    test_dir = test_dir.AppendASCII("data");
+    return test_dir.AppendASCII("ftp");
+  }
+};
+
+TEST_P(FtpDirectoryListingParserTest, Parse) {
+  FilePath test_dir(GetTestDir());
+  base::Time mock_current_time(GetMockCurrentTime());
 
   SCOPED_TRACE(base::StringPrintf("Test case: %s", GetParam()));
 
@@ -150,9 +182,82 @@ const char* kTestFiles[] = {
   "dir-listing-windows-2",
 };
 
+// Verify that parsing a listing as it arrives finds the same entries as
+// parsing it whole.
+TEST_P(FtpDirectoryListingParserTest, StreamParse) {
+  SCOPED_TRACE(base::StringPrintf("Test case: %s", GetParam()));
+
+  std::string test_listing;
+  ASSERT_TRUE(file_util::ReadFileToString(
+                  GetTestDir().AppendASCII(GetParam()), &test_listing));
+
+  std::vector<FtpDirectoryListingEntry> expected;
+  ASSERT_EQ(OK, ParseFtpDirectoryListing(test_listing, GetMockCurrentTime(),
+                                         &expected));
+
+  std::vector<FtpDirectoryListingEntry> entries;
+  EXPECT_EQ(OK, StreamParse(test_listing, 7, &entries));
+  ExpectSameEntries(expected, entries);
+}
+
 INSTANTIATE_TEST_CASE_P(, FtpDirectoryListingParserTest,
                         testing::ValuesIn(kTestFiles));
 
+// Returns an "ls -l" listing of |num_files| files, long enough to be parsed
+// as it arrives.
+std::string MakeLongLsListing(int num_files) {
+  std::string listing = "total 4096\r\n";
+  for (int i = 0; i < num_files; i++) {
+    listing += base::StringPrintf(
+        "-rw-r--r--    1 ftp      ftp        %6d Nov 10  1994 file%d.txt\r\n",
+        i * 10, i);
+  }
+  return listing;
+}
+
+TEST(FtpDirectoryListingStreamParserTest, EntriesArriveBeforeTheEnd) {
+  std::string listing(MakeLongLsListing(500));
+
+  FtpDirectoryListingStreamParser parser(GetMockCurrentTime());
+  std::vector<FtpDirectoryListingEntry> entries;
+  parser.Append(listing.data(), listing.size() / 2, &entries);
+  EXPECT_GT(entries.size(), 0U);
+  size_t streamed = entries.size();
+  parser.Append(listing.data() + listing.size() / 2,
+                listing.size() - listing.size() / 2, &entries);
+  EXPECT_GT(entries.size(), streamed);
+  EXPECT_EQ(OK, parser.Finish(&entries));
+
+  std::vector<FtpDirectoryListingEntry> expected;
+  ASSERT_EQ(OK, ParseFtpDirectoryListing(listing, GetMockCurrentTime(),
+                                         &expected));
+  ExpectSameEntries(expected, entries);
+}
+
+TEST(FtpDirectoryListingStreamParserTest, LastLineWithoutNewline) {
+  std::string listing(MakeLongLsListing(500));
+  listing += "drwxr-xr-x    2 ftp      ftp          4096 Nov 10  1994 last";
+
+  std::vector<FtpDirectoryListingEntry> expected;
+  ASSERT_EQ(OK, ParseFtpDirectoryListing(listing, GetMockCurrentTime(),
+                                         &expected));
+  std::vector<FtpDirectoryListingEntry> entries;
+  EXPECT_EQ(OK, StreamParse(listing, 100, &entries));
+  ExpectSameEntries(expected, entries);
+  EXPECT_EQ(ASCIIToUTF16("last"), entries.back().name);
+}
+
+// A listing may have only one "total n" header, even when the first one was
+// parsed long before the second arrives.
+TEST(FtpDirectoryListingStreamParserTest, LaterLinesThatDoNotParse) {
+  std::string listing(MakeLongLsListing(500));
+  listing += "total 12\r\n";
+
+  std::vector<FtpDirectoryListingEntry> entries;
+  EXPECT_EQ(ERR_UNRECOGNIZED_FTP_DIRECTORY_LISTING_FORMAT,
+            StreamParse(listing, 100, &entries));
+}
+
 }  // namespace
 
 }  // namespace net
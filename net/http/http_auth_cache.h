@@ -25,6 +25,9 @@ namespace net {
 //   - the last auth handler used (contains realm and authentication scheme)
 //   - the list of paths which used this realm
 // Entries can be looked up by either (origin, realm, scheme) or (origin, path).
+// When the cache is full, the least recently used entry is evicted, so that
+// the credentials for a frequently used server or proxy stay cached and can be
+// sent preemptively.
 class NET_EXPORT_PRIVATE HttpAuthCache {
  public:
   class Entry;
@@ -103,6 +106,12 @@ class NET_EXPORT_PRIVATE HttpAuthCache {
 
  private:
   typedef std::list<Entry> EntryList;
+
+  // Moves the entry at |it| to the front of |entries_|, as the most recently
+  // used one, and returns it.
+  Entry* MoveToFront(EntryList::iterator it);
+
+  // The entries, most recently used first.
   EntryList entries_;
 };
 
@@ -595,6 +595,25 @@ TEST_F(HttpAuthCacheEvictionTest, RealmEntryEviction) {
     CheckRealmExistence(i + 3, true);
 }
 
+// Looking up a realm entry marks it as recently used, so it is not the one
+// evicted when the cache is full.
+TEST_F(HttpAuthCacheEvictionTest, RecentlyUsedRealmEntryKept) {
+  for (int i = 0; i < kMaxRealms; ++i)
+    AddRealm(i);
+
+  CheckRealmExistence(0, true);
+  CheckPathExistence(1, 0, true);
+
+  AddRealm(kMaxRealms);
+  AddRealm(kMaxRealms + 1);
+
+  CheckRealmExistence(0, true);
+  CheckRealmExistence(1, true);
+  CheckRealmExistence(2, false);
+  CheckRealmExistence(3, false);
+  CheckRealmExistence(kMaxRealms + 1, true);
+}
+
 // Add the maximum number of paths to a single realm entry. Each of these
 // paths should be retrievable. Next add 3 more paths -- since the cache is
 // full this causes FIFO eviction of the first three paths.
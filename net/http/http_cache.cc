@@ -42,6 +42,17 @@ namespace net {
 
 namespace {
 
+// The number of parsed HttpResponseInfo objects to keep in memory.
+const size_t kMaxCachedResponseInfos = 128;
+
+// Copies |source| to |dest|, without sharing the response headers, which the
+// user of either copy may modify.
+void CopyResponseInfo(const HttpResponseInfo& source, HttpResponseInfo* dest) {
+  *dest = source;
+  if (source.headers)
+    dest->headers = new HttpResponseHeaders(source.headers->raw_headers());
+}
+
 HttpNetworkSession* CreateNetworkSession(
     HostResolver* host_resolver,
     CertVerifier* cert_verifier,
@@ -106,7 +117,9 @@ HttpCache::ActiveEntry::ActiveEntry(disk_cache::Entry* entry)
     : disk_entry(entry),
       writer(NULL),
       will_process_pending_queue(false),
-      doomed(false) {
+      doomed(false),
+      streaming(false),
+      incomplete(false) {
 }
 
 HttpCache::ActiveEntry::~ActiveEntry() {
@@ -118,6 +131,17 @@ HttpCache::ActiveEntry::~ActiveEntry() {
 
 //-----------------------------------------------------------------------------
 
+struct HttpCache::CachedResponseInfo {
+  CachedResponseInfo() : info_size(0), truncated(false) {}
+  ~CachedResponseInfo() {}
+
+  int info_size;  // Size of the response info stream that was parsed.
+  HttpResponseInfo response;
+  bool truncated;
+};
+
+//-----------------------------------------------------------------------------
+
 // This structure keeps track of work items that are attempting to create or
 // open cache entries or the backend itself.
 struct HttpCache::PendingOp {
@@ -197,6 +221,125 @@ class HttpCache::WorkItem {
 
 //-----------------------------------------------------------------------------
 
+// This class validates an entry after a stale copy of it was returned to the
+// caller, as allowed by stale-while-revalidate. The conditional request goes
+// straight to the network layer, so no lock is held on the entry and readers
+// don't wait for the server. When the response arrives, the entry is opened
+// as a reader: a 304 updates the stored headers (only the response info
+// stream, as MetadataWriter does with metadata), and anything else dooms the
+// entry so that the next request fetches it again.
+class HttpCache::AsyncValidation {
+ public:
+  AsyncValidation(HttpCache* cache, const std::string& key)
+      : cache_(cache),
+        key_(key) {
+  }
+
+  ~AsyncValidation() {}
+
+  // Sends a request like |request|, validating the headers of |response|.
+  void Start(const HttpRequestInfo& request, const HttpResponseInfo& response);
+
+ private:
+  void OnNetworkStarted(int result);
+  void OnCacheStarted(int result);
+  void OnIOComplete(int result);
+
+  HttpCache* cache_;
+  std::string key_;
+  base::Time expected_response_time_;
+  HttpRequestInfo network_request_;
+  HttpRequestInfo cache_request_;
+  scoped_ptr<HttpTransaction> network_trans_;
+  scoped_ptr<HttpCache::Transaction> cache_trans_;
+  HttpResponseInfo validation_response_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncValidation);
+};
+
+void HttpCache::AsyncValidation::Start(const HttpRequestInfo& request,
+                                       const HttpResponseInfo& response) {
+  expected_response_time_ = response.response_time;
+  network_request_ = request;
+  cache_request_ = request;
+  cache_request_.load_flags = LOAD_ONLY_FROM_CACHE;
+
+  // Just use the first available ETag and/or Last-Modified header value, as
+  // HttpCache::Transaction::ConditionalizeRequest does.
+  std::string etag_value;
+  if (response.headers->GetHttpVersion() >= HttpVersion(1, 1))
+    response.headers->EnumerateHeader(NULL, "etag", &etag_value);
+  if (!etag_value.empty()) {
+    network_request_.extra_headers.SetHeader(HttpRequestHeaders::kIfNoneMatch,
+                                             etag_value);
+  }
+
+  std::string last_modified_value;
+  response.headers->EnumerateHeader(NULL, "last-modified",
+                                    &last_modified_value);
+  if (!last_modified_value.empty()) {
+    network_request_.extra_headers.SetHeader(
+        HttpRequestHeaders::kIfModifiedSince, last_modified_value);
+  }
+
+  if (cache_->network_layer_->CreateTransaction(&network_trans_) != OK)
+    return cache_->DeleteAsyncValidation(key_);
+
+  int rv = network_trans_->Start(
+      &network_request_,
+      base::Bind(&AsyncValidation::OnNetworkStarted, base::Unretained(this)),
+      BoundNetLog());
+  if (rv != ERR_IO_PENDING)
+    OnNetworkStarted(rv);
+}
+
+void HttpCache::AsyncValidation::OnNetworkStarted(int result) {
+  if (result != OK)
+    return cache_->DeleteAsyncValidation(key_);
+
+  // There is no need to read the body, even if the resource changed.
+  validation_response_ = *network_trans_->GetResponseInfo();
+  network_trans_.reset();
+  if (!validation_response_.headers)
+    return cache_->DeleteAsyncValidation(key_);
+
+  cache_trans_.reset(new HttpCache::Transaction(cache_));
+  int rv = cache_trans_->Start(
+      &cache_request_,
+      base::Bind(&AsyncValidation::OnCacheStarted, base::Unretained(this)),
+      BoundNetLog());
+  if (rv != ERR_IO_PENDING)
+    OnCacheStarted(rv);
+}
+
+void HttpCache::AsyncValidation::OnCacheStarted(int result) {
+  if (result != OK)
+    return cache_->DeleteAsyncValidation(key_);
+
+  // Leave alone an entry that was replaced in the meantime.
+  const HttpResponseInfo* response_info = cache_trans_->GetResponseInfo();
+  DCHECK(response_info->was_cached);
+  if (response_info->response_time != expected_response_time_)
+    return cache_->DeleteAsyncValidation(key_);
+
+  if (validation_response_.headers->response_code() != 304) {
+    cache_->DoomActiveEntry(key_);
+    return cache_->DeleteAsyncValidation(key_);
+  }
+
+  int rv = cache_trans_->UpdateResponseHeaders(
+      validation_response_,
+      base::Bind(&AsyncValidation::OnIOComplete, base::Unretained(this)));
+  if (rv != ERR_IO_PENDING)
+    OnIOComplete(rv);
+}
+
+void HttpCache::AsyncValidation::OnIOComplete(int result) {
+  cache_->DeleteAsyncValidation(key_);
+}
+
+//-----------------------------------------------------------------------------
+
 // This class encapsulates a transaction whose only purpose is to write metadata
 // to a given entry.
 class HttpCache::MetadataWriter {
@@ -333,7 +476,8 @@ HttpCache::HttpCache(HostResolver* host_resolver,
                   network_delegate,
                   http_server_properties,
                   net_log,
-                  trusted_spdy_proxy))) {
+                  trusted_spdy_proxy))),
+      response_info_cache_(kMaxCachedResponseInfos) {
 }
 
 
@@ -346,7 +490,8 @@ HttpCache::HttpCache(HttpNetworkSession* session,
       ssl_host_info_factory_(new SSLHostInfoFactoryAdaptor(
           session->cert_verifier(),
           ALLOW_THIS_IN_INITIALIZER_LIST(this))),
-      network_layer_(new HttpNetworkLayer(session)) {
+      network_layer_(new HttpNetworkLayer(session)),
+      response_info_cache_(kMaxCachedResponseInfos) {
 }
 
 HttpCache::HttpCache(HttpTransactionFactory* network_layer,
@@ -356,10 +501,14 @@ HttpCache::HttpCache(HttpTransactionFactory* network_layer,
       backend_factory_(backend_factory),
       building_backend_(false),
       mode_(NORMAL),
-      network_layer_(network_layer) {
+      network_layer_(network_layer),
+      response_info_cache_(kMaxCachedResponseInfos) {
 }
 
 HttpCache::~HttpCache() {
+  // The validations may hold transactions that use the entries.
+  STLDeleteValues(&async_validations_);
+
   // If we have any active entries remaining, then we need to deactivate them.
   // We may have some pending calls to OnProcessPendingQueue, but since those
   // won't run (due to our destruction), we can simply ignore the corresponding
@@ -369,6 +518,7 @@ HttpCache::~HttpCache() {
     entry->will_process_pending_queue = false;
     entry->pending_queue.clear();
     entry->readers.clear();
+    entry->data_waiters.clear();
     entry->writer = NULL;
     DeactivateEntry(entry);
   }
@@ -598,6 +748,8 @@ void HttpCache::DoomActiveEntry(const std::string& key) {
 }
 
 int HttpCache::DoomEntry(const std::string& key, Transaction* trans) {
+  InvalidateCachedResponseInfo(key);
+
   // Need to abandon the ActiveEntry, but any transaction attached to the entry
   // should not be impacted.  Dooming an entry only means that it will no
   // longer be returned by FindActiveEntry (and it will also be destroyed once
@@ -617,7 +769,8 @@ int HttpCache::DoomEntry(const std::string& key, Transaction* trans) {
   entry->disk_entry->Doom();
   entry->doomed = true;
 
-  DCHECK(entry->writer || !entry->readers.empty());
+  DCHECK(entry->writer || !entry->readers.empty() ||
+         entry->will_process_pending_queue);
   return OK;
 }
 
@@ -645,6 +798,58 @@ int HttpCache::AsyncDoomEntry(const std::string& key, Transaction* trans) {
   return rv;
 }
 
+bool HttpCache::GetCachedResponseInfo(const std::string& key, int info_size,
+                                      HttpResponseInfo* response,
+                                      bool* truncated) {
+  ResponseInfoCache::iterator it = response_info_cache_.Get(key);
+  if (it == response_info_cache_.end())
+    return false;
+
+  if (it->second->info_size != info_size) {
+    // The entry was modified without going through this object.
+    response_info_cache_.Erase(it);
+    return false;
+  }
+
+  CopyResponseInfo(it->second->response, response);
+  *truncated = it->second->truncated;
+  return true;
+}
+
+void HttpCache::SetCachedResponseInfo(const std::string& key, int info_size,
+                                      const HttpResponseInfo& response,
+                                      bool truncated) {
+  CachedResponseInfo* info = new CachedResponseInfo;
+  info->info_size = info_size;
+  CopyResponseInfo(response, &info->response);
+  info->truncated = truncated;
+  response_info_cache_.Put(key, info);
+}
+
+void HttpCache::ValidateInBackground(const std::string& key,
+                                     const HttpRequestInfo& request,
+                                     const HttpResponseInfo& response) {
+  if (async_validations_.find(key) != async_validations_.end())
+    return;
+
+  AsyncValidation* validation = new AsyncValidation(this, key);
+  async_validations_[key] = validation;
+  validation->Start(request, response);
+}
+
+void HttpCache::DeleteAsyncValidation(const std::string& key) {
+  AsyncValidationMap::iterator it = async_validations_.find(key);
+  DCHECK(it != async_validations_.end());
+  delete it->second;
+  async_validations_.erase(it);
+}
+
+void HttpCache::InvalidateCachedResponseInfo(const std::string& key) {
+  ResponseInfoCache::iterator it = response_info_cache_.Peek(key);
+  if (it != response_info_cache_.end())
+    response_info_cache_.Erase(it);
+}
+
 void HttpCache::FinalizeDoomedEntry(ActiveEntry* entry) {
   DCHECK(entry->doomed);
   DCHECK(!entry->writer);
@@ -772,6 +977,7 @@ int HttpCache::OpenEntry(const std::string& key, ActiveEntry** entry,
 int HttpCache::CreateEntry(const std::string& key, ActiveEntry** entry,
                            Transaction* trans) {
   DCHECK(!FindActiveEntry(key));
+  InvalidateCachedResponseInfo(key);
 
   WorkItem* item = new WorkItem(WI_CREATE_ENTRY, trans, entry);
   PendingOp* pending_op = GetPendingOp(key);
@@ -815,6 +1021,15 @@ int HttpCache::AddTransactionToEntry(ActiveEntry* entry, Transaction* trans) {
   //
   // NOTE: If the transaction can only write, then the entry should not be in
   // use (since any existing entry should have already been doomed).
+  //
+  // While the writer is appending the body, transactions that only read can
+  // share the entry with it.
+
+  if (entry->writer && entry->streaming &&
+      !entry->will_process_pending_queue && trans->CanReadWhileWriting()) {
+    entry->readers.push_back(trans);
+    return OK;
+  }
 
   if (entry->writer || entry->will_process_pending_queue) {
     entry->pending_queue.push_back(trans);
@@ -847,11 +1062,13 @@ void HttpCache::DoneWithEntry(ActiveEntry* entry, Transaction* trans,
                               bool cancel) {
   // If we already posted a task to move on to the next transaction and this was
   // the writer, there is nothing to cancel.
-  if (entry->will_process_pending_queue && entry->readers.empty())
+  if (entry->will_process_pending_queue && entry->readers.empty() &&
+      !entry->writer)
     return;
 
-  if (entry->writer) {
-    DCHECK(trans == entry->writer);
+  if (entry->writer == trans) {
+    // The body was not fully written if the writer is still here.
+    entry->incomplete = true;
 
     // Assume there was a failure.
     bool success = false;
@@ -868,21 +1085,32 @@ void HttpCache::DoneWithEntry(ActiveEntry* entry, Transaction* trans,
 }
 
 void HttpCache::DoneWritingToEntry(ActiveEntry* entry, bool success) {
-  DCHECK(entry->readers.empty());
+  DCHECK(entry->readers.empty() || entry->streaming);
 
   entry->writer = NULL;
+  entry->streaming = false;
+
+  // The readers that joined the writer can now reach the end of the data.
+  NotifyDataWaiters(entry);
 
   if (success) {
     ProcessPendingQueue(entry);
   } else {
-    DCHECK(!entry->will_process_pending_queue);
-
     // We failed to create this entry.
     TransactionList pending_queue;
     pending_queue.swap(entry->pending_queue);
 
-    entry->disk_entry->Doom();
-    DestroyEntry(entry);
+    entry->incomplete = true;
+    if (entry->readers.empty() && !entry->will_process_pending_queue) {
+      InvalidateCachedResponseInfo(entry->disk_entry->GetKey());
+      entry->disk_entry->Doom();
+      DestroyEntry(entry);
+    } else if (!entry->doomed) {
+      // The readers that joined the writer, or the task that was going to
+      // add more of them, will get rid of the entry.
+      int rv = DoomEntry(entry->disk_entry->GetKey(), NULL);
+      DCHECK_EQ(OK, rv);
+    }
 
     // We need to do something about these pending entries, which now need to
     // be added to a new entry.
@@ -895,15 +1123,18 @@ void HttpCache::DoneWritingToEntry(ActiveEntry* entry, bool success) {
 }
 
 void HttpCache::DoneReadingFromEntry(ActiveEntry* entry, Transaction* trans) {
-  DCHECK(!entry->writer);
+  DCHECK(!entry->writer || entry->streaming);
 
   TransactionList::iterator it =
       std::find(entry->readers.begin(), entry->readers.end(), trans);
   DCHECK(it != entry->readers.end());
 
   entry->readers.erase(it);
+  entry->data_waiters.remove(trans);
 
-  ProcessPendingQueue(entry);
+  // The pending transactions have to wait for the writer anyway.
+  if (!entry->writer)
+    ProcessPendingQueue(entry);
 }
 
 void HttpCache::ConvertWriterToReader(ActiveEntry* entry) {
@@ -919,6 +1150,41 @@ void HttpCache::ConvertWriterToReader(ActiveEntry* entry) {
   ProcessPendingQueue(entry);
 }
 
+void HttpCache::StartStreaming(ActiveEntry* entry) {
+  DCHECK(entry->writer);
+  DCHECK(!entry->streaming);
+  entry->streaming = true;
+  entry->incomplete = false;
+
+  // Let the transactions that were waiting for the writer join it.
+  if (!entry->pending_queue.empty())
+    ProcessPendingQueue(entry);
+}
+
+void HttpCache::DataAppendedToEntry(ActiveEntry* entry) {
+  DCHECK(entry->writer);
+  NotifyDataWaiters(entry);
+}
+
+int HttpCache::WaitForEntryData(ActiveEntry* entry, Transaction* trans) {
+  DCHECK(entry->writer);
+  DCHECK(std::find(entry->readers.begin(), entry->readers.end(), trans) !=
+         entry->readers.end());
+  entry->data_waiters.push_back(trans);
+  return ERR_IO_PENDING;
+}
+
+void HttpCache::NotifyDataWaiters(ActiveEntry* entry) {
+  // The callbacks are posted because the writer is in the middle of its own
+  // IO. They go away with the transactions if those are destroyed first.
+  while (!entry->data_waiters.empty()) {
+    Transaction* trans = entry->data_waiters.front();
+    entry->data_waiters.pop_front();
+    MessageLoop::current()->PostTask(FROM_HERE,
+                                     base::Bind(trans->io_callback(), OK));
+  }
+}
+
 LoadState HttpCache::GetLoadStateForPendingTransaction(
       const Transaction* trans) {
   ActiveEntriesMap::const_iterator i = active_entries_.find(trans->key());
@@ -1014,7 +1280,26 @@ void HttpCache::ProcessPendingQueue(ActiveEntry* entry) {
 
 void HttpCache::OnProcessPendingQueue(ActiveEntry* entry) {
   entry->will_process_pending_queue = false;
-  DCHECK(!entry->writer);
+
+  if (entry->writer) {
+    // Only transactions that just read can join the writer.
+    DCHECK(entry->streaming);
+    TransactionList::iterator it = entry->pending_queue.begin();
+    while (it != entry->pending_queue.end() && !(*it)->CanReadWhileWriting())
+      ++it;
+    if (it == entry->pending_queue.end())
+      return;
+
+    Transaction* next = *it;
+    entry->pending_queue.erase(it);
+    entry->readers.push_back(next);
+
+    // Deal with the rest of the queue before handing over the control.
+    if (!entry->pending_queue.empty())
+      ProcessPendingQueue(entry);
+    next->io_callback().Run(OK);
+    return;
+  }
 
   // If no one is interested in this entry, then we can deactivate it.
   if (entry->pending_queue.empty()) {
@@ -22,6 +22,7 @@
 #include "base/basictypes.h"
 #include "base/file_path.h"
 #include "base/hash_tables.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop_proxy.h"
@@ -211,11 +212,13 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
  private:
   // Types --------------------------------------------------------------------
 
+  class AsyncValidation;
   class MetadataWriter;
   class SSLHostInfoFactoryAdaptor;
   class Transaction;
   class WorkItem;
   friend class Transaction;
+  struct CachedResponseInfo;  // Parsed headers of a disk cache entry.
   struct PendingOp;  // Info for an entry under construction.
 
   typedef std::list<Transaction*> TransactionList;
@@ -231,12 +234,26 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
     TransactionList    pending_queue;
     bool               will_process_pending_queue;
     bool               doomed;
+
+    // Set while the writer is appending the body, after it stored the first
+    // part of it. Transactions that only have to read the entry can join it as
+    // readers, and the ones that reach the end of the stored data wait on
+    // |data_waiters| for the writer to append more.
+    bool               streaming;
+    TransactionList    data_waiters;
+
+    // Set when the writer went away before storing the whole body, so the
+    // readers that joined it may not be able to finish.
+    bool               incomplete;
   };
 
   typedef base::hash_map<std::string, ActiveEntry*> ActiveEntriesMap;
   typedef base::hash_map<std::string, PendingOp*> PendingOpsMap;
   typedef std::set<ActiveEntry*> ActiveEntriesSet;
   typedef base::hash_map<std::string, int> PlaybackCacheMap;
+  typedef base::OwningMRUCache<std::string, CachedResponseInfo*>
+      ResponseInfoCache;
+  typedef base::hash_map<std::string, AsyncValidation*> AsyncValidationMap;
 
   // Methods ------------------------------------------------------------------
 
@@ -272,6 +289,34 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // Closes a previously doomed entry.
   void FinalizeDoomedEntry(ActiveEntry* entry);
 
+  // Copies the parsed response info of the entry selected by |key| to
+  // |response| and |truncated|, as long as it was read from |info_size| bytes
+  // of the response info stream. Returns false if the info is not available,
+  // and the stream has to be read and parsed.
+  bool GetCachedResponseInfo(const std::string& key, int info_size,
+                             HttpResponseInfo* response, bool* truncated);
+
+  // Remembers the response info that was just read and parsed from
+  // |info_size| bytes of the response info stream of the entry selected by
+  // |key|.
+  void SetCachedResponseInfo(const std::string& key, int info_size,
+                             const HttpResponseInfo& response, bool truncated);
+
+  // Starts validating the entry selected by |key| in the background, unless
+  // that is already happening. |request| found the entry stale, and |response|
+  // is the stale response that it is going to use.
+  void ValidateInBackground(const std::string& key,
+                            const HttpRequestInfo& request,
+                            const HttpResponseInfo& response);
+
+  // Deletes the background validation of the entry selected by |key|.
+  void DeleteAsyncValidation(const std::string& key);
+
+  // Forgets the response info of the entry selected by |key|. This must be
+  // called before the response info stream is modified, and when the entry is
+  // doomed.
+  void InvalidateCachedResponseInfo(const std::string& key);
+
   // Returns an entry that is currently in use and not doomed, or NULL.
   ActiveEntry* FindActiveEntry(const std::string& key);
 
@@ -330,6 +375,20 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
   // transactions can start reading from this entry.
   void ConvertWriterToReader(ActiveEntry* entry);
 
+  // Called by the writer once it starts appending the body, so that other
+  // transactions can read this entry while it is being written.
+  void StartStreaming(ActiveEntry* entry);
+
+  // Called by the writer after appending data to this entry.
+  void DataAppendedToEntry(ActiveEntry* entry);
+
+  // Makes a reader wait for the writer to append more data to this entry. The
+  // transaction will be notified via its IO callback.
+  int WaitForEntryData(ActiveEntry* entry, Transaction* trans);
+
+  // Lets the readers waiting for data on this entry try again.
+  void NotifyDataWaiters(ActiveEntry* entry);
+
   // Returns the LoadState of the provided pending transaction.
   LoadState GetLoadStateForPendingTransaction(const Transaction* trans);
 
@@ -396,6 +455,13 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
 
   scoped_ptr<PlaybackCacheMap> playback_cache_map_;
 
+  // The response info of recently used entries, to avoid reading it from the
+  // disk cache when an entry is opened again.
+  ResponseInfoCache response_info_cache_;
+
+  // The entries being validated in the background, indexed by cache key.
+  AsyncValidationMap async_validations_;
+
   DISALLOW_COPY_AND_ASSIGN(HttpCache);
 };
 
@@ -118,6 +118,9 @@ HttpCache::Transaction::Transaction(HttpCache* cache)
       handling_206_(false),
       cache_pending_(false),
       done_reading_(false),
+      async_validation_(false),
+      reading_while_writing_(false),
+      wait_for_writer_(false),
       read_offset_(0),
       effective_load_flags_(0),
       write_len_(0),
@@ -178,6 +181,40 @@ int HttpCache::Transaction::WriteMetadata(IOBuffer* buf, int buf_len,
                                        callback, true);
 }
 
+int HttpCache::Transaction::UpdateResponseHeaders(
+    const HttpResponseInfo& validation_response,
+    const CompletionCallback& callback) {
+  DCHECK(!callback.is_null());
+  DCHECK_EQ(304, validation_response.headers->response_code());
+  if (!cache_ || !entry_)
+    return ERR_UNEXPECTED;
+
+  // See DoUpdateCachedResponse.
+  response_.headers->Update(*validation_response.headers);
+  response_.response_time = validation_response.response_time;
+  response_.request_time = validation_response.request_time;
+  if (response_.headers->HasHeaderValue("cache-control", "no-store")) {
+    cache_->DoomActiveEntry(cache_key_);
+    return OK;
+  }
+
+  cache_->InvalidateCachedResponseInfo(cache_key_);
+  scoped_refptr<PickledIOBuffer> data(new PickledIOBuffer());
+  response_.Persist(data->pickle(), cache_->mode() != RECORD, truncated_);
+  data->Done();
+
+  int len = static_cast<int>(data->pickle()->size());
+  return entry_->disk_entry->WriteData(kResponseInfoIndex, 0, data, len,
+                                       callback, true);
+}
+
+bool HttpCache::Transaction::CanReadWhileWriting() const {
+  // Validating or updating the entry requires exclusive access to it, and
+  // ranges need the whole response.
+  return (mode_ == READ || mode_ == READ_WRITE) && !partial_.get() &&
+         !(effective_load_flags_ & LOAD_VALIDATE_CACHE) && !wait_for_writer_;
+}
+
 bool HttpCache::Transaction::AddTruncatedFlag() {
   DCHECK(mode_ & WRITE || mode_ == NONE);
 
@@ -366,9 +403,13 @@ void HttpCache::Transaction::StopCaching() {
   // entry how it is (it will be marked as truncated at destruction), and let
   // the next piece of code that executes know that we are now reading directly
   // from the net.
+  //
+  // If others are reading what we store, keep storing it for them.
   if (cache_ && entry_ && (mode_ & WRITE) && network_trans_.get() &&
-      !is_sparse_ && !range_requested_)
+      !is_sparse_ && !range_requested_ && entry_->readers.empty()) {
+    entry_->streaming = false;
     mode_ = NONE;
+  }
 }
 
 void HttpCache::Transaction::DoneReading() {
@@ -995,6 +1036,7 @@ int HttpCache::Transaction::DoAddToEntryComplete(int result) {
 
   entry_ = new_entry_;
   new_entry_ = NULL;
+  reading_while_writing_ = entry_->writer && entry_->writer != this;
 
   if (mode_ == WRITE) {
     if (partial_.get())
@@ -1198,10 +1240,24 @@ int HttpCache::Transaction::DoPartialHeadersReceived() {
 
 int HttpCache::Transaction::DoCacheReadResponse() {
   DCHECK(entry_);
-  next_state_ = STATE_CACHE_READ_RESPONSE_COMPLETE;
-
   io_buf_len_ = entry_->disk_entry->GetDataSize(kResponseInfoIndex);
-  read_buf_ = new IOBuffer(io_buf_len_);
+
+  // When the entry is being validated, reading and parsing the headers is
+  // most of the work done with the cache, so try to use the info kept in
+  // memory for recently used entries instead.
+  bool validating = mode_ == UPDATE ||
+                    (effective_load_flags_ & LOAD_VALIDATE_CACHE);
+  if (validating &&
+      cache_->GetCachedResponseInfo(cache_key_, io_buf_len_, &response_,
+                                    &truncated_)) {
+    net_log_.BeginEvent(NetLog::TYPE_HTTP_CACHE_READ_INFO, NULL);
+    net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HTTP_CACHE_READ_INFO,
+                                      io_buf_len_);
+    return ContinueWithResponseInfo();
+  }
+
+  next_state_ = STATE_CACHE_READ_RESPONSE_COMPLETE;
+  read_buf_ = new PooledIOBuffer(io_buf_len_);
 
   net_log_.BeginEvent(NetLog::TYPE_HTTP_CACHE_READ_INFO, NULL);
   return entry_->disk_entry->ReadData(kResponseInfoIndex, 0, read_buf_,
@@ -1216,6 +1272,14 @@ int HttpCache::Transaction::DoCacheReadResponseComplete(int result) {
     return OnCacheReadError(result, true);
   }
 
+  cache_->SetCachedResponseInfo(cache_key_, io_buf_len_, response_,
+                                truncated_);
+  return ContinueWithResponseInfo();
+}
+
+int HttpCache::Transaction::ContinueWithResponseInfo() {
+  int result;
+
   // Some resources may have slipped in as truncated when they're not.
   int current_size = entry_->disk_entry->GetDataSize(kResponseContentIndex);
   if (response_.headers->GetContentLength() == current_size)
@@ -1349,6 +1413,22 @@ int HttpCache::Transaction::DoCacheReadDataComplete(int result) {
   if (result > 0) {
     read_offset_ += result;
   } else if (result == 0) {  // End of file.
+    if (reading_while_writing_) {
+      if (entry_->writer) {
+        // Wait for the writer to store more data, if it didn't already.
+        next_state_ = STATE_CACHE_READ_DATA;
+        if (entry_->disk_entry->GetDataSize(kResponseContentIndex) >
+            read_offset_) {
+          return OK;
+        }
+        return cache_->WaitForEntryData(entry_, this);
+      }
+      if (entry_->incomplete &&
+          response_.headers->GetContentLength() != read_offset_) {
+        DLOG(ERROR) << "The writer did not store the whole response";
+        return ERR_CACHE_READ_FAILURE;
+      }
+    }
     cache_->DoneReadingFromEntry(entry_, this);
     entry_ = NULL;
   } else {
@@ -1389,6 +1469,15 @@ int HttpCache::Transaction::DoCacheWriteDataComplete(int result) {
       done_reading_ = true;
   }
 
+  // Once the body is coming, others can read it as we store it.
+  if (entry_ && mode_ == WRITE && !partial_.get() && result > 0) {
+    if (entry_->streaming) {
+      cache_->DataAppendedToEntry(entry_);
+    } else {
+      cache_->StartStreaming(entry_);
+    }
+  }
+
   if (partial_.get()) {
     // This may be the last request.
     if (!(result == 0 && !truncated_ &&
@@ -1573,6 +1662,11 @@ int HttpCache::Transaction::BeginCacheValidation() {
   if ((partial_.get() && !partial_->IsCurrentRangeCached()) || invalid_range_)
     skip_validation = false;
 
+  if (reading_while_writing_ &&
+      (!skip_validation || async_validation_ || entry_->incomplete)) {
+    return WaitForWriter();
+  }
+
   if (skip_validation) {
     if (partial_.get()) {
       // We are going to return the saved response headers to the caller, so
@@ -1580,9 +1674,16 @@ int HttpCache::Transaction::BeginCacheValidation() {
       next_state_ = STATE_PARTIAL_HEADERS_RECEIVED;
       return OK;
     }
-    cache_->ConvertWriterToReader(entry_);
+    // If we joined the writer, we are a reader already.
+    if (!reading_while_writing_)
+      cache_->ConvertWriterToReader(entry_);
     mode_ = READ;
 
+    // The stale response goes to the caller while the server is asked about
+    // the entry in the background.
+    if (async_validation_)
+      cache_->ValidateInBackground(cache_key_, *request_, response_);
+
     if (entry_->disk_entry->GetDataSize(kMetadataIndex))
       next_state_ = STATE_CACHE_READ_METADATA;
   } else {
@@ -1607,6 +1708,9 @@ int HttpCache::Transaction::BeginPartialCacheValidation() {
       !truncated_)
     return BeginCacheValidation();
 
+  if (reading_while_writing_)
+    return WaitForWriter();
+
   if (range_requested_) {
     next_state_ = STATE_CACHE_QUERY_DATA;
     return OK;
@@ -1724,18 +1828,39 @@ bool HttpCache::Transaction::RequiresValidation() {
   if (effective_load_flags_ & LOAD_VALIDATE_CACHE)
     return true;
 
+  async_validation_ = false;
   if (response_.headers->RequiresValidation(
-          response_.request_time, response_.response_time, Time::Now()))
-    return true;
+          response_.request_time, response_.response_time, Time::Now())) {
+    if (!CanValidateInBackground())
+      return true;
+    async_validation_ = true;
+  }
 
   // Since Vary header computation is fairly expensive, we save it for last.
   if (response_.vary_data.is_valid() &&
-      !response_.vary_data.MatchesRequest(*request_, *response_.headers))
+      !response_.vary_data.MatchesRequest(*request_, *response_.headers)) {
+    async_validation_ = false;
     return true;
+  }
 
   return false;
 }
 
+bool HttpCache::Transaction::CanValidateInBackground() {
+  // Byte ranges and entries that don't store the whole resource need the
+  // network response right away, as do the other cache modes.
+  if (cache_->mode() != NORMAL || request_->method != "GET" ||
+      partial_.get() || truncated_) {
+    return false;
+  }
+
+  if (response_.headers->response_code() != 200)
+    return false;
+
+  return response_.headers->IsWithinStaleWhileRevalidate(
+      response_.request_time, response_.response_time, Time::Now());
+}
+
 bool HttpCache::Transaction::ConditionalizeRequest() {
   DCHECK(response_.headers);
 
@@ -1989,6 +2114,8 @@ int HttpCache::Transaction::WriteResponseInfoToEntry(bool truncated) {
     DCHECK_EQ(200, response_.headers->response_code());
   }
 
+  cache_->InvalidateCachedResponseInfo(cache_key_);
+
   scoped_refptr<PickledIOBuffer> data(new PickledIOBuffer());
   response_.Persist(data->pickle(), skip_transient_headers, truncated);
   data->Done();
@@ -2042,6 +2169,26 @@ int HttpCache::Transaction::OnCacheReadError(int result, bool restart) {
   return ERR_CACHE_READ_FAILURE;
 }
 
+int HttpCache::Transaction::WaitForWriter() {
+  DCHECK(reading_while_writing_);
+  DCHECK(!reading_);
+  reading_while_writing_ = false;
+
+  // If the writer already failed, there is nothing to wait for.
+  bool restart = entry_->incomplete;
+  cache_->DoneWithEntry(entry_, this, false);
+  new_entry_ = restart ? NULL : entry_;
+  entry_ = NULL;
+  if (restart) {
+    next_state_ = STATE_INIT_ENTRY;
+    return OK;
+  }
+
+  wait_for_writer_ = true;
+  next_state_ = STATE_ADD_TO_ENTRY;
+  return OK;
+}
+
 void HttpCache::Transaction::DoomPartialEntry(bool delete_object) {
   DVLOG(2) << "DoomPartialEntry";
   int rv = cache_->DoomEntry(cache_key_, NULL);
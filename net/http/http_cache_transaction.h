@@ -83,11 +83,25 @@ class HttpCache::Transaction : public HttpTransaction {
                     int buf_len,
                     const CompletionCallback& callback);
 
+  // Updates the stored headers of the entry that backs this transaction with
+  // the headers of a 304 response to a validation made outside of this
+  // transaction. Only the response info stream is written, so this can be used
+  // by a reader of the entry, as with WriteMetadata. The same considerations
+  // about verifying the response first apply. Returns a net error code, and
+  // may return ERR_IO_PENDING, in which case |callback| will be notified when
+  // the operation finishes.
+  int UpdateResponseHeaders(const HttpResponseInfo& validation_response,
+                            const CompletionCallback& callback);
+
   // This transaction is being deleted and we are not done writing to the cache.
   // We need to indicate that the response data was truncated.  Returns true on
   // success.
   bool AddTruncatedFlag();
 
+  // Returns true if this transaction can start reading an entry while the
+  // writer is still appending the body to it.
+  bool CanReadWhileWriting() const;
+
   // Returns the LoadState of the writer transaction of a given ActiveEntry. In
   // other words, returns the LoadState of this transaction without asking the
   // http cache, because this transaction should be the one currently writing
@@ -232,6 +246,10 @@ class HttpCache::Transaction : public HttpTransaction {
   // layer (skipping the cache entirely).
   bool ShouldPassThrough();
 
+  // Called when response_ holds the headers of the cache entry, to decide what
+  // to do with the entry.  Returns network error code.
+  int ContinueWithResponseInfo();
+
   // Called to begin reading from the cache.  Returns network error code.
   int BeginCacheRead();
 
@@ -265,8 +283,14 @@ class HttpCache::Transaction : public HttpTransaction {
   int RestartNetworkRequestWithAuth(const AuthCredentials& credentials);
 
   // Called to determine if we need to validate the cache entry before using it.
+  // Sets async_validation_ when the entry can be used while it is validated in
+  // the background instead.
   bool RequiresValidation();
 
+  // Returns true if a stale entry can be used right away, and validated in the
+  // background.
+  bool CanValidateInBackground();
+
   // Called to make the request conditional (to ask the server if the cached
   // copy is valid).  Returns true if able to make the request conditional.
   bool ConditionalizeRequest();
@@ -312,6 +336,10 @@ class HttpCache::Transaction : public HttpTransaction {
   // transaction should be restarted.
   int OnCacheReadError(int result, bool restart);
 
+  // Leaves an entry that is still being written, to wait in line for the
+  // writer to be done with it.
+  int WaitForWriter();
+
   // Deletes the current partial cache entry (sparse), and optionally removes
   // the control object (partial_).
   void DoomPartialEntry(bool delete_object);
@@ -360,6 +388,9 @@ class HttpCache::Transaction : public HttpTransaction {
   bool handling_206_;  // We must deal with this 206 response.
   bool cache_pending_;  // We are waiting for the HttpCache.
   bool done_reading_;
+  bool async_validation_;  // The stale entry will be validated later.
+  bool reading_while_writing_;  // Joined the entry before the writer was done.
+  bool wait_for_writer_;  // The entry cannot be used while it is written.
   scoped_refptr<IOBuffer> read_buf_;
   int io_buf_len_;
   int read_offset_;
@@ -921,6 +921,93 @@ TEST(HttpCache, SimpleGET_ManyReaders) {
   }
 }
 
+// Tests that a request can read the body while another one is storing it.
+TEST(HttpCache, SimpleGET_ReadWhileWriting) {
+  MockHttpCache cache;
+
+  MockHttpRequest request(kSimpleGET_Transaction);
+  std::string expected(kSimpleGET_Transaction.data);
+
+  Context writer;
+  ASSERT_EQ(net::OK, cache.http_cache()->CreateTransaction(&writer.trans));
+  writer.result = writer.trans->Start(
+      &request, writer.callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, writer.callback.GetResult(writer.result));
+
+  // Store the first part of the body.
+  scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(256));
+  int rv = writer.trans->Read(buf, 5, writer.callback.callback());
+  ASSERT_EQ(5, writer.callback.GetResult(rv));
+
+  Context reader;
+  ASSERT_EQ(net::OK, cache.http_cache()->CreateTransaction(&reader.trans));
+  reader.result = reader.trans->Start(
+      &request, reader.callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, reader.callback.GetResult(reader.result));
+  EXPECT_TRUE(reader.trans->GetResponseInfo()->was_cached);
+
+  rv = reader.trans->Read(buf, 256, reader.callback.callback());
+  ASSERT_EQ(5, reader.callback.GetResult(rv));
+  EXPECT_EQ(expected.substr(0, 5), std::string(buf->data(), 5));
+
+  // The reader has to wait for the writer to store the rest.
+  rv = reader.trans->Read(buf, 256, reader.callback.callback());
+  EXPECT_EQ(net::ERR_IO_PENDING, rv);
+
+  std::string content;
+  EXPECT_EQ(net::OK, ReadTransaction(writer.trans.get(), &content));
+  EXPECT_EQ(expected.substr(5), content);
+
+  rv = reader.callback.GetResult(rv);
+  ASSERT_GT(rv, 0);
+  EXPECT_EQ(expected.substr(5), std::string(buf->data(), rv));
+
+  rv = reader.trans->Read(buf, 256, reader.callback.callback());
+  EXPECT_EQ(0, reader.callback.GetResult(rv));
+
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+  EXPECT_EQ(0, cache.disk_cache()->open_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+}
+
+// Tests that a request reading the body while another one stores it fails if
+// the writer goes away before storing the whole body.
+TEST(HttpCache, SimpleGET_ReadWhileWriting_CancelWriter) {
+  MockHttpCache cache;
+
+  MockHttpRequest request(kSimpleGET_Transaction);
+
+  Context* writer = new Context();
+  ASSERT_EQ(net::OK, cache.http_cache()->CreateTransaction(&writer->trans));
+  writer->result = writer->trans->Start(
+      &request, writer->callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, writer->callback.GetResult(writer->result));
+
+  scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(256));
+  int rv = writer->trans->Read(buf, 5, writer->callback.callback());
+  ASSERT_EQ(5, writer->callback.GetResult(rv));
+
+  Context reader;
+  ASSERT_EQ(net::OK, cache.http_cache()->CreateTransaction(&reader.trans));
+  reader.result = reader.trans->Start(
+      &request, reader.callback.callback(), net::BoundNetLog());
+  ASSERT_EQ(net::OK, reader.callback.GetResult(reader.result));
+
+  rv = reader.trans->Read(buf, 256, reader.callback.callback());
+  EXPECT_EQ(5, reader.callback.GetResult(rv));
+
+  // Cancel the writer with the rest of the body still on the network.
+  delete writer;
+
+  rv = reader.trans->Read(buf, 256, reader.callback.callback());
+  EXPECT_EQ(net::ERR_CACHE_READ_FAILURE, reader.callback.GetResult(rv));
+
+  // The entry is not used again.
+  RunTransactionTest(cache.http_cache(), kSimpleGET_Transaction);
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(2, cache.disk_cache()->create_count());
+}
+
 // This is a test for http://code.google.com/p/chromium/issues/detail?id=4769.
 // If cancelling a request is racing with another request for the same resource
 // finishing, we have to make sure that we remove both transactions from the
@@ -964,12 +1051,14 @@ TEST(HttpCache, SimpleGET_RacingReaders) {
   ASSERT_EQ(net::ERR_IO_PENDING, c->result);
   c->result = c->callback.WaitForResult();
   ReadAndVerifyTransaction(c->trans.get(), kSimpleGET_Transaction);
+  MessageLoop::current()->RunAllPending();
 
-  // Now we have 2 active readers and two queued transactions.
+  // The other transactions may join the writer as readers while it stores the
+  // body, so by now they are all readers.
 
   EXPECT_EQ(net::LOAD_STATE_IDLE,
             context_list[2]->trans->GetLoadState());
-  EXPECT_EQ(net::LOAD_STATE_WAITING_FOR_CACHE,
+  EXPECT_EQ(net::LOAD_STATE_IDLE,
             context_list[3]->trans->GetLoadState());
 
   c = context_list[1];
@@ -978,10 +1067,8 @@ TEST(HttpCache, SimpleGET_RacingReaders) {
   if (c->result == net::OK)
     ReadAndVerifyTransaction(c->trans.get(), kSimpleGET_Transaction);
 
-  // At this point we have one reader, two pending transactions and a task on
-  // the queue to move to the next transaction. Now we cancel the request that
-  // is the current reader, and expect the queued task to be able to start the
-  // next request.
+  // Now we cancel one of the readers, and expect the others to be able to
+  // finish.
 
   c = context_list[2];
   c->trans.reset();
@@ -1586,6 +1673,84 @@ TEST(HttpCache, ETagGET_ConditionalRequest_304) {
   EXPECT_EQ(1, cache.disk_cache()->create_count());
 }
 
+// Tests that the headers of a recently read entry are not read again from the
+// disk cache when the entry is validated.
+TEST(HttpCache, ETagGET_ConditionalRequest_304_CachedResponseInfo) {
+  MockHttpCache cache;
+
+  ScopedMockTransaction transaction(kETagGET_Transaction);
+
+  // Write to the cache, and read the entry back.
+  RunTransactionTest(cache.http_cache(), transaction);
+  transaction.load_flags = net::LOAD_PREFERRING_CACHE;
+  RunTransactionTest(cache.http_cache(), transaction);
+
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+  EXPECT_EQ(1, cache.disk_cache()->open_count());
+
+  // Replace the stored headers without going through the HttpCache. Reading
+  // them now would fail, and the request would not be conditionalized.
+  disk_cache::Entry* entry;
+  ASSERT_TRUE(cache.OpenBackendEntry(transaction.url, &entry));
+  int len = entry->GetDataSize(0);
+  scoped_refptr<net::IOBuffer> buf(new net::IOBuffer(len));
+  memset(buf->data(), 0, len);
+  net::TestCompletionCallback cb;
+  int rv = entry->WriteData(0, 0, buf, len, cb.callback(), true);
+  EXPECT_EQ(len, cb.GetResult(rv));
+  entry->Close();
+
+  transaction.load_flags = net::LOAD_VALIDATE_CACHE;
+  transaction.handler = ETagGet_ConditionalRequest_Handler;
+  RunTransactionTest(cache.http_cache(), transaction);
+
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(3, cache.disk_cache()->open_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+}
+
+static void StaleWhileRevalidate_Handler(
+    const net::HttpRequestInfo* request,
+    std::string* response_status,
+    std::string* response_headers,
+    std::string* response_data) {
+  EXPECT_TRUE(
+      request->extra_headers.HasHeader(net::HttpRequestHeaders::kIfNoneMatch));
+  response_status->assign("HTTP/1.1 304 Not Modified");
+  response_headers->assign("Cache-Control: max-age=10000\n");
+  response_data->clear();
+}
+
+// Tests that a stale entry within its stale-while-revalidate window is served
+// from the cache and validated in the background.
+TEST(HttpCache, GET_StaleWhileRevalidate) {
+  MockHttpCache cache;
+
+  ScopedMockTransaction transaction(kETagGET_Transaction);
+  transaction.response_headers =
+      "Cache-Control: max-age=100, stale-while-revalidate=3600\n"
+      "Age: 200\n"
+      "Etag: \"foopy\"\n";
+
+  // Write to the cache.
+  RunTransactionTest(cache.http_cache(), transaction);
+  EXPECT_EQ(1, cache.network_layer()->transaction_count());
+
+  // The stale entry is returned right away, and then validated.
+  transaction.handler = StaleWhileRevalidate_Handler;
+  RunTransactionTest(cache.http_cache(), transaction);
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+
+  // The 304 made the entry fresh again.
+  transaction.handler = NULL;
+  RunTransactionTest(cache.http_cache(), transaction);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(2, cache.network_layer()->transaction_count());
+  EXPECT_EQ(1, cache.disk_cache()->create_count());
+}
+
 static void ETagGet_UnconditionalRequest_Handler(
     const net::HttpRequestInfo* request,
     std::string* response_status,
@@ -27,6 +27,10 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnection {
     OLD_HTTP_VERSION,
     MUST_CLOSE_CONNECTION,
     AUTHENTICATION_REQUIRED,
+    // Sent after OK when a response held up the requests behind it, either
+    // because it was large or because a later response waited too long to be
+    // read.
+    HEAD_OF_LINE_BLOCKED,
   };
 
   class Delegate {
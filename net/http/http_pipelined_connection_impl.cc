@@ -25,6 +25,12 @@ namespace net {
 
 namespace {
 
+// A stream that waits longer than this for the responses ahead of it to be
+// read, or a response at least this large with requests queued behind it,
+// means the pipeline is deeper than it should be.
+const int kMaxHeadOfLineBlockingMs = 200;
+const int64 kLargeResponseSize = 128 * 1024;
+
 class ReceivedHeadersParameters : public NetLog::EventParameters {
  public:
   ReceivedHeadersParameters(const NetLog::Source& source,
@@ -350,6 +356,8 @@ int HttpPipelinedConnectionImpl::ReadResponseHeaders(
 
   stream_info_map_[pipeline_id].state = STREAM_READ_PENDING;
   stream_info_map_[pipeline_id].read_headers_callback = callback;
+  stream_info_map_[pipeline_id].read_headers_start_time =
+      base::TimeTicks::Now();
   if (read_next_state_ == READ_STATE_NONE &&
       pipeline_id == request_order_.front()) {
     read_next_state_ = READ_STATE_START_IMMEDIATELY;
@@ -438,11 +446,17 @@ int HttpPipelinedConnectionImpl::DoStartNextDeferredRead(int result) {
   int next_id = request_order_.front();
   CHECK(ContainsKey(stream_info_map_, next_id));
   switch (stream_info_map_[next_id].state) {
-    case STREAM_READ_PENDING:
+    case STREAM_READ_PENDING: {
+      StreamInfo& info = stream_info_map_[next_id];
+      base::TimeDelta blocked_time =
+          base::TimeTicks::Now() - info.read_headers_start_time;
+      if (blocked_time.InMilliseconds() > kMaxHeadOfLineBlockingMs)
+        info.was_head_of_line_blocked = true;
       read_next_state_ = READ_STATE_READ_HEADERS;
       active_read_id_ = next_id;
       request_order_.pop();
       break;
+    }
 
     case STREAM_CLOSED:
       // Since nobody will read whatever data is on the pipeline associated with
@@ -729,6 +743,11 @@ void HttpPipelinedConnectionImpl::CheckHeadersForPipelineCompatibility(
     return;
   }
   ReportPipelineFeedback(pipeline_id, OK);
+  if (stream_info_map_[pipeline_id].was_head_of_line_blocked ||
+      (!request_order_.empty() &&
+       info->headers->GetContentLength() >= kLargeResponseSize)) {
+    ReportPipelineFeedback(pipeline_id, HEAD_OF_LINE_BLOCKED);
+  }
 }
 
 void HttpPipelinedConnectionImpl::ReportPipelineFeedback(int pipeline_id,
@@ -755,6 +774,10 @@ void HttpPipelinedConnectionImpl::ReportPipelineFeedback(int pipeline_id,
       feedback_str = "AUTHENTICATION_REQUIRED";
       break;
 
+    case HEAD_OF_LINE_BLOCKED:
+      feedback_str = "HEAD_OF_LINE_BLOCKED";
+      break;
+
     default:
       NOTREACHED();
       feedback_str = "UNKNOWN";
@@ -832,7 +855,8 @@ HttpPipelinedConnectionImpl::PendingSendRequest::~PendingSendRequest() {
 }
 
 HttpPipelinedConnectionImpl::StreamInfo::StreamInfo()
-    : state(STREAM_CREATED) {
+    : state(STREAM_CREATED),
+      was_head_of_line_blocked(false) {
 }
 
 HttpPipelinedConnectionImpl::StreamInfo::~StreamInfo() {
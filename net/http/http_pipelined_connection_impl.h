@@ -14,6 +14,7 @@
 #include "base/location.h"
 #include "base/memory/linked_ptr.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time.h"
 #include "net/base/completion_callback.h"
 #include "net/base/net_export.h"
 #include "net/base/net_log.h"
@@ -196,6 +197,10 @@ class NET_EXPORT_PRIVATE HttpPipelinedConnectionImpl
     CompletionCallback pending_user_callback;
     StreamState state;
     NetLog::Source source;
+    // When ReadResponseHeaders() was called.
+    base::TimeTicks read_headers_start_time;
+    // True if the stream had to wait too long for earlier responses.
+    bool was_head_of_line_blocked;
   };
 
   typedef std::map<int, StreamInfo> StreamInfoMap;
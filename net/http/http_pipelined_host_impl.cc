@@ -4,6 +4,8 @@
 
 #include "net/http/http_pipelined_host_impl.h"
 
+#include <algorithm>
+
 #include "base/stl_util.h"
 #include "base/values.h"
 #include "net/http/http_pipelined_connection_impl.h"
@@ -19,6 +21,12 @@ namespace net {
 // costing too much performance. Until then, this is just a bad guess.
 static const int kNumKnownSuccessesThreshold = 3;
 
+// The pipeline depth grows by one after this many clean responses per request
+// allowed at the current depth, and is halved when a response blocks the ones
+// behind it.
+static const int kNumSuccessesPerDepthIncrease = 2;
+static const int kMinPipelineDepth = 1;
+
 HttpPipelinedHostImpl::HttpPipelinedHostImpl(
     HttpPipelinedHost::Delegate* delegate,
     const HttpPipelinedHost::Key& key,
@@ -27,7 +35,9 @@ HttpPipelinedHostImpl::HttpPipelinedHostImpl(
     : delegate_(delegate),
       key_(key),
       factory_(factory),
-      capability_(capability) {
+      capability_(capability),
+      pipeline_depth_(initial_pipeline_depth()),
+      num_successes_at_depth_(0) {
   if (!factory) {
     factory_.reset(new HttpPipelinedConnectionImpl::Factory());
   }
@@ -122,9 +132,16 @@ void HttpPipelinedHostImpl::OnPipelineFeedback(
                      kNumKnownSuccessesThreshold) {
         capability_ = PIPELINE_CAPABLE;
         delegate_->OnHostDeterminedCapability(this, PIPELINE_CAPABLE);
+      } else if (capability_ == PIPELINE_CAPABLE) {
+        OnDepthSuccess();
+        // WARNING: |pipeline| might be deleted here.
       }
       break;
 
+    case HttpPipelinedConnection::HEAD_OF_LINE_BLOCKED:
+      OnDepthHeadOfLineBlocked();
+      break;
+
     case HttpPipelinedConnection::PIPELINE_SOCKET_ERROR:
       // Socket errors on the initial request - when no other requests are
       // pipelined - can't be due to pipelining.
@@ -154,7 +171,7 @@ int HttpPipelinedHostImpl::GetPipelineCapacity() const {
   switch (capability_) {
     case PIPELINE_CAPABLE:
     case PIPELINE_PROBABLY_CAPABLE:
-      capacity = max_pipeline_depth();
+      capacity = pipeline_depth_;
       break;
 
     case PIPELINE_INCAPABLE:
@@ -190,6 +207,23 @@ void HttpPipelinedHostImpl::NotifyAllPipelinesHaveCapacity() {
   }
 }
 
+void HttpPipelinedHostImpl::OnDepthSuccess() {
+  if (pipeline_depth_ >= max_pipeline_depth())
+    return;
+  if (++num_successes_at_depth_ <
+      pipeline_depth_ * kNumSuccessesPerDepthIncrease) {
+    return;
+  }
+  ++pipeline_depth_;
+  num_successes_at_depth_ = 0;
+  NotifyAllPipelinesHaveCapacity();
+}
+
+void HttpPipelinedHostImpl::OnDepthHeadOfLineBlocked() {
+  pipeline_depth_ = std::max(kMinPipelineDepth, pipeline_depth_ / 2);
+  num_successes_at_depth_ = 0;
+}
+
 Value* HttpPipelinedHostImpl::PipelineInfoToValue() const {
   ListValue* list_value = new ListValue();
   for (PipelineInfoMap::const_iterator it = pipelines_.begin();
@@ -72,9 +72,19 @@ class NET_EXPORT_PRIVATE HttpPipelinedHostImpl
   // ownership of the returned Value.
   virtual base::Value* PipelineInfoToValue() const OVERRIDE;
 
-  // Returns the maximum number of in-flight pipelined requests we'll allow on a
-  // single connection.
-  static int max_pipeline_depth() { return 3; }
+  // Returns the number of in-flight pipelined requests we'll allow on a single
+  // connection before learning anything about how deep the host's pipelines
+  // should be.
+  static int initial_pipeline_depth() { return 3; }
+
+  // Returns the most in-flight pipelined requests we'll ever allow on a single
+  // connection.
+  static int max_pipeline_depth() { return 6; }
+
+  // Returns the number of in-flight pipelined requests currently allowed on a
+  // single connection once |capability_| allows pipelining. This grows with
+  // successful responses and shrinks on head of line blocking.
+  int pipeline_depth() const { return pipeline_depth_; }
 
  private:
   struct PipelineInfo {
@@ -100,15 +110,23 @@ class NET_EXPORT_PRIVATE HttpPipelinedHostImpl
   // sufficient.
   bool CanPipelineAcceptRequests(HttpPipelinedConnection* pipeline) const;
 
-  // Called when |this| moves from UNKNOWN |capability_| to PROBABLY_CAPABLE.
-  // Causes all pipelines to increase capacity to start pipelining.
+  // Called when |this| moves from UNKNOWN |capability_| to PROBABLY_CAPABLE,
+  // or when |pipeline_depth_| grows. Causes all pipelines to increase capacity
+  // to start pipelining.
   void NotifyAllPipelinesHaveCapacity();
 
+  // Adjusts |pipeline_depth_| after a successful response on a host that is
+  // known to be capable, or after the response blocked the ones behind it.
+  void OnDepthSuccess();
+  void OnDepthHeadOfLineBlocked();
+
   HttpPipelinedHost::Delegate* delegate_;
   const Key key_;
   PipelineInfoMap pipelines_;
   scoped_ptr<HttpPipelinedConnection::Factory> factory_;
   HttpPipelinedHostCapability capability_;
+  int pipeline_depth_;
+  int num_successes_at_depth_;
 
   DISALLOW_COPY_AND_ASSIGN(HttpPipelinedHostImpl);
 };
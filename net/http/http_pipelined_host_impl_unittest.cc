@@ -126,7 +126,7 @@ TEST_F(HttpPipelinedHostImplTest, IgnoresInactivePipeline) {
 
 TEST_F(HttpPipelinedHostImplTest, IgnoresFullPipeline) {
   MockPipeline* pipeline = AddTestPipeline(
-      HttpPipelinedHostImpl::max_pipeline_depth(), true, true);
+      HttpPipelinedHostImpl::initial_pipeline_depth(), true, true);
 
   EXPECT_FALSE(host_->IsExistingPipelineAvailable());
   EXPECT_EQ(NULL, host_->CreateStreamOnExistingPipeline());
@@ -136,9 +136,9 @@ TEST_F(HttpPipelinedHostImplTest, IgnoresFullPipeline) {
 
 TEST_F(HttpPipelinedHostImplTest, PicksLeastLoadedPipeline) {
   MockPipeline* full_pipeline = AddTestPipeline(
-      HttpPipelinedHostImpl::max_pipeline_depth(), true, true);
+      HttpPipelinedHostImpl::initial_pipeline_depth(), true, true);
   MockPipeline* usable_pipeline = AddTestPipeline(
-      HttpPipelinedHostImpl::max_pipeline_depth() - 1, true, true);
+      HttpPipelinedHostImpl::initial_pipeline_depth() - 1, true, true);
   MockPipeline* empty_pipeline = AddTestPipeline(0, true, true);
 
   EXPECT_TRUE(host_->IsExistingPipelineAvailable());
@@ -303,6 +303,54 @@ TEST_F(HttpPipelinedHostImplTest, HeedsSocketErrorOnFirstRequestWithPipeline) {
   ClearTestPipeline(pipeline);
 }
 
+TEST_F(HttpPipelinedHostImplTest, DepthGrowsWithSuccesses) {
+  MockPipeline* pipeline = AddTestPipeline(
+      HttpPipelinedHostImpl::initial_pipeline_depth(), true, true);
+  EXPECT_FALSE(host_->IsExistingPipelineAvailable());
+
+  EXPECT_CALL(delegate_, OnHostHasAdditionalCapacity(host_.get()))
+      .Times(1);
+  for (int i = 0; i < 2 * HttpPipelinedHostImpl::initial_pipeline_depth();
+       ++i) {
+    host_->OnPipelineFeedback(pipeline, HttpPipelinedConnection::OK);
+  }
+  EXPECT_EQ(HttpPipelinedHostImpl::initial_pipeline_depth() + 1,
+            host_->pipeline_depth());
+  EXPECT_TRUE(host_->IsExistingPipelineAvailable());
+
+  // The depth never goes past the maximum.
+  EXPECT_CALL(delegate_, OnHostHasAdditionalCapacity(host_.get()))
+      .Times(HttpPipelinedHostImpl::max_pipeline_depth() -
+             HttpPipelinedHostImpl::initial_pipeline_depth());
+  for (int i = 0; i < 100; ++i)
+    host_->OnPipelineFeedback(pipeline, HttpPipelinedConnection::OK);
+  EXPECT_EQ(HttpPipelinedHostImpl::max_pipeline_depth(),
+            host_->pipeline_depth());
+
+  ClearTestPipeline(pipeline);
+}
+
+TEST_F(HttpPipelinedHostImplTest, DepthShrinksOnHeadOfLineBlocking) {
+  MockPipeline* pipeline = AddTestPipeline(
+      HttpPipelinedHostImpl::initial_pipeline_depth() - 1, true, true);
+  EXPECT_TRUE(host_->IsExistingPipelineAvailable());
+
+  EXPECT_CALL(delegate_, OnHostDeterminedCapability(host_.get(), _))
+      .Times(0);
+  host_->OnPipelineFeedback(pipeline, HttpPipelinedConnection::OK);
+  host_->OnPipelineFeedback(pipeline,
+                            HttpPipelinedConnection::HEAD_OF_LINE_BLOCKED);
+  EXPECT_EQ(HttpPipelinedHostImpl::initial_pipeline_depth() / 2,
+            host_->pipeline_depth());
+  EXPECT_FALSE(host_->IsExistingPipelineAvailable());
+
+  host_->OnPipelineFeedback(pipeline,
+                            HttpPipelinedConnection::HEAD_OF_LINE_BLOCKED);
+  EXPECT_EQ(1, host_->pipeline_depth());
+
+  ClearTestPipeline(pipeline);
+}
+
 }  // anonymous namespace
 
 }  // namespace net
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 
+#include "base/metrics/histogram.h"
 #include "base/time.h"
 #include "base/values.h"
 #include "googleurl/src/gurl.h"
@@ -27,6 +28,27 @@
 
 namespace net {
 
+namespace {
+
+// How the SPDY session carrying a tunnel through a SPDY proxy was obtained.
+enum SpdyProxySessionSource {
+  // An existing session was found before connecting to the proxy.
+  SPDY_PROXY_SESSION_EXISTING = 0,
+  // A session was created while this job was connecting to the proxy, so the
+  // job's own SSL connection was thrown away.
+  SPDY_PROXY_SESSION_EXISTING_AFTER_CONNECT = 1,
+  // The job's SSL connection became a new session.
+  SPDY_PROXY_SESSION_NEW = 2,
+  SPDY_PROXY_SESSION_SOURCE_MAX
+};
+
+void RecordSpdyProxySessionSource(SpdyProxySessionSource source) {
+  UMA_HISTOGRAM_ENUMERATION("Net.SpdyProxySessionSource", source,
+                            SPDY_PROXY_SESSION_SOURCE_MAX);
+}
+
+}  // namespace
+
 HttpProxySocketParams::HttpProxySocketParams(
     const scoped_refptr<TransportSocketParams>& transport_params,
     const scoped_refptr<SSLSocketParams>& ssl_params,
@@ -298,6 +320,11 @@ int HttpProxyConnectJob::DoSpdyProxyCreateStream() {
   scoped_refptr<SpdySession> spdy_session;
   // It's possible that a session to the proxy has recently been created
   if (spdy_pool->HasSession(pair)) {
+    bool connected =
+        transport_socket_handle_.get() && transport_socket_handle_->socket();
+    RecordSpdyProxySessionSource(connected ?
+        SPDY_PROXY_SESSION_EXISTING_AFTER_CONNECT :
+        SPDY_PROXY_SESSION_EXISTING);
     if (transport_socket_handle_.get()) {
       if (transport_socket_handle_->socket())
         transport_socket_handle_->socket()->Disconnect();
@@ -305,6 +332,7 @@ int HttpProxyConnectJob::DoSpdyProxyCreateStream() {
     }
     spdy_session = spdy_pool->Get(pair, net_log());
   } else {
+    RecordSpdyProxySessionSource(SPDY_PROXY_SESSION_NEW);
     // Create a session direct to the proxy itself
     int rv = spdy_pool->GetSpdySessionFromSocket(
         pair, transport_socket_handle_.release(),
@@ -932,6 +932,33 @@ bool HttpResponseHeaders::RequiresValidation(const Time& request_time,
   return lifetime <= GetCurrentAge(request_time, response_time, current_time);
 }
 
+// From RFC 5861 section 3:
+//
+// When present in an HTTP response, the stale-while-revalidate Cache-Control
+// extension indicates that caches MAY serve the response in which it appears
+// after it becomes stale, up to the indicated number of seconds.
+//
+// Responses that are never fresh (no-cache and the like) and responses that
+// must be revalidated once stale are not served this way.
+//
+bool HttpResponseHeaders::IsWithinStaleWhileRevalidate(
+    const Time& request_time,
+    const Time& response_time,
+    const Time& current_time) const {
+  TimeDelta stale_while_revalidate;
+  if (!GetStaleWhileRevalidateValue(&stale_while_revalidate) ||
+      HasHeaderValue("cache-control", "must-revalidate")) {
+    return false;
+  }
+
+  TimeDelta lifetime = GetFreshnessLifetime(response_time);
+  if (lifetime == TimeDelta())
+    return false;
+
+  return lifetime + stale_while_revalidate >
+      GetCurrentAge(request_time, response_time, current_time);
+}
+
 // From RFC 2616 section 13.2.4:
 //
 // The max-age directive takes priority over Expires, so if max-age is present
@@ -1078,20 +1105,29 @@ TimeDelta HttpResponseHeaders::GetCurrentAge(const Time& request_time,
 }
 
 bool HttpResponseHeaders::GetMaxAgeValue(TimeDelta* result) const {
+  return GetCacheControlSeconds("max-age=", result);
+}
+
+bool HttpResponseHeaders::GetStaleWhileRevalidateValue(
+    TimeDelta* result) const {
+  return GetCacheControlSeconds("stale-while-revalidate=", result);
+}
+
+bool HttpResponseHeaders::GetCacheControlSeconds(const char* directive,
+                                                 TimeDelta* result) const {
   std::string name = "cache-control";
   std::string value;
 
-  const char kMaxAgePrefix[] = "max-age=";
-  const size_t kMaxAgePrefixLen = arraysize(kMaxAgePrefix) - 1;
+  const size_t directive_len = strlen(directive);
 
   void* iter = NULL;
   while (EnumerateHeader(&iter, name, &value)) {
-    if (value.size() > kMaxAgePrefixLen) {
+    if (value.size() > directive_len) {
       if (LowerCaseEqualsASCII(value.begin(),
-                               value.begin() + kMaxAgePrefixLen,
-                               kMaxAgePrefix)) {
+                               value.begin() + directive_len,
+                               directive)) {
         int64 seconds;
-        base::StringToInt64(StringPiece(value.begin() + kMaxAgePrefixLen,
+        base::StringToInt64(StringPiece(value.begin() + directive_len,
                                         value.end()),
                             &seconds);
         *result = TimeDelta::FromSeconds(seconds);
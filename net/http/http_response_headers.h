@@ -195,6 +195,15 @@ class NET_EXPORT HttpResponseHeaders
                           const base::Time& response_time,
                           const base::Time& current_time) const;
 
+  // Returns true if a response that requires validation can still be used
+  // while it is validated in the background: the server allowed it with the
+  // stale-while-revalidate Cache-Control extension (RFC 5861), and the
+  // response has been stale for less than the allowed time. See
+  // RequiresValidation for a description of this method's parameters.
+  bool IsWithinStaleWhileRevalidate(const base::Time& request_time,
+                                    const base::Time& response_time,
+                                    const base::Time& current_time) const;
+
   // Returns the amount of time the server claims the response is fresh from
   // the time the response was generated.  See section 13.2.4 of RFC 2616.  See
   // RequiresValidation for a description of the response_time parameter.
@@ -210,6 +219,7 @@ class NET_EXPORT HttpResponseHeaders
   // value is not present, then false is returned.  Otherwise, true is returned
   // and the out param is assigned to the corresponding value.
   bool GetMaxAgeValue(base::TimeDelta* value) const;
+  bool GetStaleWhileRevalidateValue(base::TimeDelta* value) const;
   bool GetAgeValue(base::TimeDelta* value) const;
   bool GetDateValue(base::Time* value) const;
   bool GetLastModifiedValue(base::Time* value) const;
@@ -267,6 +277,11 @@ class NET_EXPORT HttpResponseHeaders
   // Initializes from the given raw headers.
   void Parse(const std::string& raw_input);
 
+  // Looks for a Cache-Control directive of the form |directive|=N, where
+  // |directive| includes the equal sign, and returns N seconds in |value|.
+  bool GetCacheControlSeconds(const char* directive,
+                              base::TimeDelta* value) const;
+
   // Helper function for ParseStatusLine.
   // Tries to extract the "HTTP/X.Y" from a status line formatted like:
   //    HTTP/1.1 200 OK
@@ -840,6 +840,75 @@ TEST(HttpResponseHeadersTest, RequiresValidation) {
   }
 }
 
+TEST(HttpResponseHeadersTest, IsWithinStaleWhileRevalidate) {
+  const struct {
+    const char* headers;
+    bool within_stale_while_revalidate;
+  } tests[] = {
+    // no extension
+    { "HTTP/1.1 200 OK\n"
+      "date: Wed, 28 Nov 2007 00:40:11 GMT\n"
+      "cache-control: max-age=100\n"
+      "\n",
+      false
+    },
+    // stale for less than the allowed time
+    { "HTTP/1.1 200 OK\n"
+      "date: Wed, 28 Nov 2007 00:40:11 GMT\n"
+      "cache-control: max-age=100, stale-while-revalidate=3600\n"
+      "\n",
+      true
+    },
+    // stale for too long
+    { "HTTP/1.1 200 OK\n"
+      "date: Wed, 28 Nov 2007 00:40:11 GMT\n"
+      "cache-control: max-age=100, stale-while-revalidate=60\n"
+      "\n",
+      false
+    },
+    // never fresh
+    { "HTTP/1.1 200 OK\n"
+      "date: Wed, 28 Nov 2007 00:40:11 GMT\n"
+      "cache-control: no-cache, stale-while-revalidate=3600\n"
+      "\n",
+      false
+    },
+    // stale content must be revalidated
+    { "HTTP/1.1 200 OK\n"
+      "date: Wed, 28 Nov 2007 00:40:11 GMT\n"
+      "cache-control: max-age=100, must-revalidate\n"
+      "cache-control: stale-while-revalidate=3600\n"
+      "\n",
+      false
+    },
+    // freshness from expires
+    { "HTTP/1.1 200 OK\n"
+      "date: Wed, 28 Nov 2007 00:40:11 GMT\n"
+      "expires: Wed, 28 Nov 2007 00:41:11 GMT\n"
+      "cache-control: stale-while-revalidate=3600\n"
+      "\n",
+      true
+    },
+  };
+  base::Time request_time, response_time, current_time;
+  base::Time::FromString("Wed, 28 Nov 2007 00:40:09 GMT", &request_time);
+  base::Time::FromString("Wed, 28 Nov 2007 00:40:12 GMT", &response_time);
+  base::Time::FromString("Wed, 28 Nov 2007 00:45:20 GMT", &current_time);
+
+  for (size_t i = 0; i < ARRAYSIZE_UNSAFE(tests); ++i) {
+    std::string headers(tests[i].headers);
+    HeadersToRaw(&headers);
+    scoped_refptr<net::HttpResponseHeaders> parsed(
+        new net::HttpResponseHeaders(headers));
+
+    EXPECT_TRUE(parsed->RequiresValidation(request_time, response_time,
+                                           current_time)) << i;
+    EXPECT_EQ(tests[i].within_stale_while_revalidate,
+              parsed->IsWithinStaleWhileRevalidate(request_time, response_time,
+                                                   current_time)) << i;
+  }
+}
+
 TEST(HttpResponseHeadersTest, Update) {
   const struct {
     const char* orig_headers;
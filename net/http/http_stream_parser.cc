@@ -10,6 +10,7 @@
 #include "net/base/address_list.h"
 #include "net/base/auth.h"
 #include "net/base/io_buffer.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/base/ssl_cert_request_info.h"
 #include "net/http/http_net_log_params.h"
 #include "net/http/http_request_headers.h"
@@ -92,7 +93,7 @@ namespace net {
 class HttpStreamParser::SeekableIOBuffer : public net::IOBuffer {
  public:
   explicit SeekableIOBuffer(int capacity)
-    : IOBuffer(capacity),
+    : IOBuffer(IOBufferPool::Allocate(capacity)),
       real_data_(data_),
       capacity_(capacity),
       size_(0),
@@ -144,8 +145,9 @@ class HttpStreamParser::SeekableIOBuffer : public net::IOBuffer {
 
  private:
   virtual ~SeekableIOBuffer() {
-    // data_ will be deleted in IOBuffer::~IOBuffer().
-    data_ = real_data_;
+    IOBufferPool::Release(real_data_, capacity_);
+    // Prevent ~IOBuffer() from deleting the pool's storage.
+    data_ = NULL;
   }
 
   char* real_data_;
@@ -223,8 +225,8 @@ int HttpStreamParser::SendRequest(const std::string& request_line,
       request_body_->set_chunk_callback(this);
       // The chunk buffer is adjusted to guarantee that |request_body_buf_|
       // is large enough to hold the encoded chunk.
-      chunk_buf_ = new IOBufferWithSize(kRequestBodyBufferSize -
-                                        kChunkHeaderFooterSize);
+      chunk_buf_ = new PooledIOBuffer(kRequestBodyBufferSize -
+                                      kChunkHeaderFooterSize);
     }
   }
 
@@ -374,6 +376,9 @@ int HttpStreamParser::DoLoop(int result) {
         else
           result = DoSendNonChunkedBody(result);
         break;
+      case STATE_READ_NON_CHUNKED_BODY_COMPLETE:
+        result = DoReadNonChunkedBodyComplete(result);
+        break;
       case STATE_REQUEST_SENT:
         DCHECK(result != ERR_IO_PENDING);
         can_do_more = false;
@@ -497,21 +502,28 @@ int HttpStreamParser::DoSendNonChunkedBody(int result) {
                                         io_callback_);
   }
 
+  // File data is read on a worker thread, straight into the buffer that is
+  // written to the socket.
   request_body_buf_->Clear();
-  const int consumed = request_body_->Read(request_body_buf_,
-                                           request_body_buf_->capacity());
-  if (consumed == 0) {  // Reached the end.
+  io_state_ = STATE_READ_NON_CHUNKED_BODY_COMPLETE;
+  return request_body_->Read(request_body_buf_,
+                             request_body_buf_->capacity(),
+                             io_callback_);
+}
+
+int HttpStreamParser::DoReadNonChunkedBodyComplete(int result) {
+  // UploadDataStream::Read() won't fail if not chunked.
+  DCHECK_GE(result, 0);
+  if (result == 0) {  // Reached the end.
     io_state_ = STATE_REQUEST_SENT;
-  } else if (consumed > 0) {
-    request_body_buf_->DidAppend(consumed);
-    result = connection_->socket()->Write(request_body_buf_,
-                                          request_body_buf_->BytesRemaining(),
-                                          io_callback_);
-  } else {
-    // UploadDataStream::Read() won't fail if not chunked.
-    NOTREACHED();
+    return OK;
   }
-  return result;
+
+  io_state_ = STATE_SENDING_NON_CHUNKED_BODY;
+  request_body_buf_->DidAppend(result);
+  return connection_->socket()->Write(request_body_buf_,
+                                      request_body_buf_->BytesRemaining(),
+                                      io_callback_);
 }
 
 int HttpStreamParser::DoReadHeaders() {
@@ -114,6 +114,7 @@ class NET_EXPORT_PRIVATE HttpStreamParser  : public ChunkCallback {
     // or not.
     STATE_SENDING_CHUNKED_BODY,
     STATE_SENDING_NON_CHUNKED_BODY,
+    STATE_READ_NON_CHUNKED_BODY_COMPLETE,
     STATE_REQUEST_SENT,
     STATE_READ_HEADERS,
     STATE_READ_HEADERS_COMPLETE,
@@ -146,6 +147,7 @@ class NET_EXPORT_PRIVATE HttpStreamParser  : public ChunkCallback {
   int DoSendHeaders(int result);
   int DoSendChunkedBody(int result);
   int DoSendNonChunkedBody(int result);
+  int DoReadNonChunkedBodyComplete(int result);
   int DoReadHeaders();
   int DoReadHeadersComplete(int result);
   int DoReadBody();
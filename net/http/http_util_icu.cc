@@ -23,6 +23,8 @@ std::string HttpUtil::PathForRequest(const GURL& url) {
 // static
 std::string HttpUtil::SpecForRequest(const GURL& url) {
   DCHECK(url.is_valid() && (url.SchemeIs("http") || url.SchemeIs("https")));
+  if (!url.has_username() && !url.has_password() && !url.has_ref())
+    return url.spec();
   return SimplifyUrlForRequest(url).spec();
 }
 
@@ -0,0 +1,185 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "googleurl/src/gurl.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumIterations = 100000;
+
+// The byte by byte scan HttpUtil::LocateEndOfHeaders() used to do, kept here
+// to compare against.
+int LocateEndOfHeadersBytewise(const char* buf, int buf_len) {
+  bool was_lf = false;
+  char last_c = '\0';
+  for (int i = 0; i < buf_len; ++i) {
+    char c = buf[i];
+    if (c == '\n') {
+      if (was_lf)
+        return i + 1;
+      was_lf = true;
+    } else if (c != '\r' || last_c != '\n') {
+      was_lf = false;
+    }
+    last_c = c;
+  }
+  return -1;
+}
+
+// Returns a response header block of about the size a typical page sends,
+// with |num_cookies| Set-Cookie lines to make it bigger.
+std::string MakeResponseHeaders(int num_cookies) {
+  std::string headers =
+      "HTTP/1.1 200 OK\r\n"
+      "Date: Tue, 01 May 2012 17:02:31 GMT\r\n"
+      "Expires: -1\r\n"
+      "Cache-Control: private, max-age=0\r\n"
+      "Content-Type: text/html; charset=UTF-8\r\n"
+      "Content-Encoding: gzip\r\n"
+      "Server: gws\r\n"
+      "Content-Length: 35291\r\n"
+      "X-XSS-Protection: 1; mode=block\r\n"
+      "X-Frame-Options: SAMEORIGIN\r\n"
+      "Vary: Accept-Encoding\r\n";
+  for (int i = 0; i < num_cookies; ++i) {
+    headers += base::StringPrintf(
+        "Set-Cookie: PREF%d=ID=2ab51d2f6c3a7e09:FF=0:TM=1335891751:"
+        "LM=1335891751:S=F7pigdHezq0cXvTu; expires=Thu, 01-May-2014 "
+        "17:02:31 GMT; path=/; domain=.example.com\r\n", i);
+  }
+  headers += "\r\n";
+  return headers;
+}
+
+// The way HttpUtil::SpecForRequest() used to strip every URL, kept here to
+// compare against.
+std::string SpecForRequestByReplacing(const GURL& url) {
+  GURL::Replacements replacements;
+  replacements.ClearUsername();
+  replacements.ClearPassword();
+  replacements.ClearRef();
+  return url.ReplaceComponents(replacements).spec();
+}
+
+// URLs as loading a news front page requests them.
+const char* const kPageLoadUrls[] = {
+  "http://www.example.com/",
+  "http://www.example.com/css/main.css?v=20120501",
+  "http://static.example.com/js/jquery.min.js",
+  "http://static.example.com/js/app.js?build=4821",
+  "http://images.example.com/2012/05/01/front/lead-story-620x350.jpg",
+  "http://images.example.com/2012/05/01/front/thumb-1-140x90.jpg",
+  "http://images.example.com/2012/05/01/front/thumb-2-140x90.jpg",
+  "http://ads.example.net/serve?slot=top&size=728x90&ord=8829301",
+  "https://ssl.example-analytics.com/collect?v=1&tid=UA-1234-1&t=pageview",
+  "http://www.example.com/fonts/headline.woff",
+  "http://www.example.com/article/2012/05/01/story.html#comments",
+};
+
+void RunLocateEndOfHeaders(const std::string& name,
+                           const std::string& headers) {
+  int expected = static_cast<int>(headers.size());
+  int size = static_cast<int>(headers.size());
+
+  PerfTimeLogger bytewise_timer((name + "_bytewise").c_str());
+  for (int i = 0; i < kNumIterations; ++i)
+    ASSERT_EQ(expected, LocateEndOfHeadersBytewise(headers.data(), size));
+  bytewise_timer.Done();
+
+  PerfTimeLogger timer(name.c_str());
+  for (int i = 0; i < kNumIterations; ++i)
+    ASSERT_EQ(expected, HttpUtil::LocateEndOfHeaders(headers.data(), size));
+  timer.Done();
+}
+
+}  // namespace
+
+TEST(HttpUtilPerfTest, LocateEndOfHeaders) {
+  RunLocateEndOfHeaders("Locate_end_of_headers_small",
+                        MakeResponseHeaders(0));
+  RunLocateEndOfHeaders("Locate_end_of_headers_large",
+                        MakeResponseHeaders(20));
+}
+
+TEST(HttpUtilPerfTest, SpecForRequest) {
+  std::vector<GURL> urls;
+  for (size_t i = 0; i < arraysize(kPageLoadUrls); ++i)
+    urls.push_back(GURL(kPageLoadUrls[i]));
+
+  PerfTimeLogger replacing_timer("Spec_for_request_replacing");
+  for (int i = 0; i < kNumIterations; ++i) {
+    const GURL& url = urls[i % urls.size()];
+    ASSERT_FALSE(SpecForRequestByReplacing(url).empty());
+  }
+  replacing_timer.Done();
+
+  PerfTimeLogger timer("Spec_for_request");
+  for (int i = 0; i < kNumIterations; ++i) {
+    const GURL& url = urls[i % urls.size()];
+    ASSERT_FALSE(HttpUtil::SpecForRequest(url).empty());
+  }
+  timer.Done();
+}
+
+TEST(HttpUtilPerfTest, ParseResponseHeaders) {
+  std::string headers = MakeResponseHeaders(2);
+  int size = static_cast<int>(headers.size());
+  PerfTimeLogger timer("Parse_response_headers");
+  for (int i = 0; i < kNumIterations; ++i) {
+    int end = HttpUtil::LocateEndOfHeaders(headers.data(), size);
+    scoped_refptr<HttpResponseHeaders> parsed(new HttpResponseHeaders(
+        HttpUtil::AssembleRawHeaders(headers.data(), end)));
+    ASSERT_EQ(200, parsed->response_code());
+  }
+  timer.Done();
+}
+
+// The header lookups done on every response by the network stack and the
+// cache.
+TEST(HttpUtilPerfTest, ResponseHeaderLookups) {
+  std::string headers = MakeResponseHeaders(2);
+  int size = static_cast<int>(headers.size());
+  scoped_refptr<HttpResponseHeaders> parsed(new HttpResponseHeaders(
+      HttpUtil::AssembleRawHeaders(headers.data(), size)));
+
+  PerfTimeLogger normalized_timer("Response_headers_get_normalized_header");
+  std::string value;
+  for (int i = 0; i < kNumIterations; ++i)
+    ASSERT_TRUE(parsed->GetNormalizedHeader("content-type", &value));
+  normalized_timer.Done();
+
+  PerfTimeLogger has_value_timer("Response_headers_has_header_value");
+  for (int i = 0; i < kNumIterations; ++i)
+    ASSERT_TRUE(parsed->HasHeaderValue("vary", "accept-encoding"));
+  has_value_timer.Done();
+
+  PerfTimeLogger enumerate_timer("Response_headers_enumerate_header");
+  for (int i = 0; i < kNumIterations; ++i) {
+    void* iter = NULL;
+    int count = 0;
+    while (parsed->EnumerateHeader(&iter, "set-cookie", &value))
+      ++count;
+    ASSERT_EQ(2, count);
+  }
+  enumerate_timer.Done();
+
+  PerfTimeLogger max_age_timer("Response_headers_get_max_age");
+  base::TimeDelta max_age;
+  for (int i = 0; i < kNumIterations; ++i)
+    ASSERT_TRUE(parsed->GetMaxAgeValue(&max_age));
+  max_age_timer.Done();
+}
+
+}  // namespace net
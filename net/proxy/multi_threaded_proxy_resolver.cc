@@ -4,15 +4,20 @@
 
 #include "net/proxy/multi_threaded_proxy_resolver.h"
 
+#include <set>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/message_loop_proxy.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/utf_string_conversions.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_log.h"
 #include "net/proxy/proxy_info.h"
+#include "net/proxy/proxy_resolver_script_data.h"
 
 // TODO(eroman): Have the MultiThreadedProxyResolver clear its PAC script
 //               data when SetPacScript fails. That will reclaim memory when
@@ -22,6 +27,342 @@ namespace net {
 
 namespace {
 
+// Maximum number of hosts whose results are cached.
+const size_t kMaxCachedResults = 512;
+
+bool IsIdentifierChar(char16 c) {
+  return IsAsciiAlpha(c) || IsAsciiDigit(c) || c == '_' || c == '$';
+}
+
+// Returns the number of times |identifier| appears in |script| as a whole
+// token, not counting property accesses such as "foo.identifier".
+size_t CountIdentifier(const string16& script, const string16& identifier) {
+  size_t count = 0;
+  for (size_t pos = script.find(identifier); pos != string16::npos;
+       pos = script.find(identifier, pos + 1)) {
+    size_t end = pos + identifier.size();
+    if (pos > 0 && (IsIdentifierChar(script[pos - 1]) ||
+                    script[pos - 1] == '.')) {
+      continue;
+    }
+    if (end < script.size() && IsIdentifierChar(script[end]))
+      continue;
+    ++count;
+  }
+  return count;
+}
+
+// A token of a PAC script, as far as IsStatelessScript() needs to know.
+struct ScriptToken {
+  string16 text;
+  // The innermost function the token is in, including its name and
+  // parameters, as an index into the functions found so far; -1 at the top
+  // level.
+  int function;
+  // Whether a line break comes before the token.
+  bool newline_before;
+};
+
+// Punctuators of more than one character, longest first.
+const char* const kMultiCharPunctuators[] = {
+  ">>>=", "===", "!==", ">>>", "<<=", ">>=", "==", "!=", "<=", ">=", "&&",
+  "||", "++", "--", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<",
+  ">>",
+};
+
+// Splits |script| into identifiers, numbers and punctuators, skipping
+// whitespace, comments and string literals. |parents| receives the
+// enclosing function of each function. Returns false for anything it cannot
+// follow, such as regular expression literals.
+bool TokenizeScript(const string16& script,
+                    std::vector<ScriptToken>* tokens,
+                    std::vector<int>* parents) {
+  // For each open brace, the function it is the body of, or -1.
+  std::vector<int> braces;
+  int function = -1;
+  // Set from the "function" keyword to the brace that opens its body.
+  bool in_function_head = false;
+  bool newline_before = false;
+  size_t pos = 0;
+  while (pos < script.size()) {
+    char16 c = script[pos];
+    if (c == '\n' || c == '\r' || c == 0x2028 || c == 0x2029) {
+      newline_before = true;
+      ++pos;
+      continue;
+    }
+    if (IsWhitespace(c)) {
+      ++pos;
+      continue;
+    }
+    if (c == '/' && pos + 1 < script.size() && script[pos + 1] == '/') {
+      while (pos < script.size() && script[pos] != '\n')
+        ++pos;
+      continue;
+    }
+    if (c == '/' && pos + 1 < script.size() && script[pos + 1] == '*') {
+      size_t end = script.find(ASCIIToUTF16("*/"), pos + 2);
+      if (end == string16::npos)
+        return false;
+      if (script.find_first_of(ASCIIToUTF16("\r\n"), pos) < end)
+        newline_before = true;
+      pos = end + 2;
+      continue;
+    }
+    if (c == '\'' || c == '"') {
+      for (++pos; pos < script.size() && script[pos] != c; ++pos) {
+        if (script[pos] == '\\')
+          ++pos;
+        else if (script[pos] == '\n')
+          return false;
+      }
+      if (pos >= script.size())
+        return false;
+      ++pos;
+      // Only whether something is a string matters, not what it holds.
+      ScriptToken token = { ASCIIToUTF16("\"\""), function, newline_before };
+      tokens->push_back(token);
+      newline_before = false;
+      continue;
+    }
+
+    // Escapes in identifiers would hide names from the scan, and V8 treats
+    // "<!--" and "-->" as the start of a comment.
+    if (c == '\\' ||
+        script.compare(pos, 4, ASCIIToUTF16("<!--")) == 0 ||
+        script.compare(pos, 3, ASCIIToUTF16("-->")) == 0) {
+      return false;
+    }
+
+    size_t begin = pos;
+    if (IsIdentifierChar(c)) {
+      while (pos < script.size() && IsIdentifierChar(script[pos]))
+        ++pos;
+    } else {
+      ++pos;
+      for (size_t i = 0; i < arraysize(kMultiCharPunctuators); ++i) {
+        string16 punctuator = ASCIIToUTF16(kMultiCharPunctuators[i]);
+        if (script.compare(begin, punctuator.size(), punctuator) == 0) {
+          pos = begin + punctuator.size();
+          break;
+        }
+      }
+    }
+    ScriptToken token = { script.substr(begin, pos - begin), function,
+                          newline_before };
+    newline_before = false;
+
+    // A slash where an operand is due starts a regular expression.
+    if (token.text == ASCIIToUTF16("/") || token.text == ASCIIToUTF16("/=")) {
+      if (tokens->empty())
+        return false;
+      const string16& previous = tokens->back().text;
+      if (!IsIdentifierChar(previous[0]) &&
+          previous != ASCIIToUTF16(")") && previous != ASCIIToUTF16("]"))
+        return false;
+      if (previous == ASCIIToUTF16("return") ||
+          previous == ASCIIToUTF16("typeof") ||
+          previous == ASCIIToUTF16("case"))
+        return false;
+    }
+
+    if (token.text == ASCIIToUTF16("function")) {
+      parents->push_back(function);
+      function = static_cast<int>(parents->size()) - 1;
+      token.function = function;
+      in_function_head = true;
+    } else if (token.text == ASCIIToUTF16("{")) {
+      braces.push_back(in_function_head ? function : -1);
+      in_function_head = false;
+    } else if (token.text == ASCIIToUTF16("}")) {
+      if (braces.empty())
+        return false;
+      if (braces.back() != -1)
+        function = (*parents)[braces.back()];
+      braces.pop_back();
+    }
+    tokens->push_back(token);
+  }
+  return braces.empty() && !in_function_head;
+}
+
+// Returns true if the token at |index| is an identifier declared by "var"
+// or as a parameter.
+bool IsDeclaration(const std::vector<ScriptToken>& tokens, size_t index) {
+  // Walk back over the declaration list, skipping initializers, to the
+  // "var" or the parameter list that it is part of.
+  int depth = 0;
+  bool after_comma = false;
+  for (size_t i = index; i-- > 0; ) {
+    const string16& text = tokens[i].text;
+    if (text == ASCIIToUTF16(")") || text == ASCIIToUTF16("]") ||
+        text == ASCIIToUTF16("}")) {
+      ++depth;
+    } else if (text == ASCIIToUTF16("(") || text == ASCIIToUTF16("[") ||
+               text == ASCIIToUTF16("{")) {
+      if (!depth) {
+        // A parameter list: "function name(" or "function(".
+        if (text != ASCIIToUTF16("(") || i == 0)
+          return false;
+        const string16& before = tokens[i - 1].text;
+        return before == ASCIIToUTF16("function") ||
+            (i >= 2 && tokens[i - 2].text == ASCIIToUTF16("function"));
+      }
+      --depth;
+    } else if (!depth) {
+      if (text == ASCIIToUTF16("var"))
+        return i + 1 == index || after_comma;
+      if (text == ASCIIToUTF16(";"))
+        return false;
+      // A line break ends the statement unless the line ends in a comma.
+      if (tokens[i + 1].newline_before && text != ASCIIToUTF16(","))
+        return false;
+      if (text == ASCIIToUTF16(",")) {
+        if (i + 1 != index && !after_comma)
+          return false;
+        after_comma = true;
+        continue;
+      }
+      if (i + 1 == index)
+        return false;
+    }
+  }
+  return false;
+}
+
+// Returns true if |function| is |ancestor| or is nested in it.
+bool IsInFunction(int function, int ancestor, const std::vector<int>& parents) {
+  for (; function != -1; function = parents[function]) {
+    if (function == ancestor)
+      return true;
+  }
+  return false;
+}
+
+// Returns true if |script| keeps no state from one call of FindProxyForURL()
+// to the next, so that its results cannot depend on earlier calls. Code at
+// the top level runs once, when the script is loaded, and may assign to
+// anything. A function may assign to its own variables and parameters, which
+// are fresh on every call. It may only assign to those of an enclosing
+// function if that function is FindProxyForURL() or nested in it: any other
+// enclosing function, such as one run once at load time to build a closure,
+// keeps its variables alive from call to call.
+//
+// This is a scan for the ways scripts written in good faith keep state, not
+// a proof; a script that goes out of its way to hide state, e.g. by building
+// property names at run time, can get past it.
+bool IsStatelessScript(const string16& script) {
+  std::vector<ScriptToken> tokens;
+  std::vector<int> parents;
+  if (!TokenizeScript(script, &tokens, &parents))
+    return false;
+
+  // The function declared as FindProxyForURL, or -1.
+  int find_proxy = -1;
+  for (size_t i = 1; i < tokens.size(); ++i) {
+    if (tokens[i].text == ASCIIToUTF16("FindProxyForURL") &&
+        tokens[i - 1].text == ASCIIToUTF16("function")) {
+      find_proxy = tokens[i - 1].function;
+    }
+  }
+
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const string16& text = tokens[i].text;
+    // Getters and setters run code on a property read, and their bodies are
+    // not seen as functions by TokenizeScript().
+    if ((text == ASCIIToUTF16("get") || text == ASCIIToUTF16("set")) &&
+        i + 2 < tokens.size() &&
+        (IsIdentifierChar(tokens[i + 1].text[0]) ||
+         tokens[i + 1].text == ASCIIToUTF16("\"\"")) &&
+        tokens[i + 2].text == ASCIIToUTF16("(")) {
+      return false;
+    }
+    // Ways to change an object without assigning to it, anywhere in the
+    // script.
+    static const char* const kObjectMutators[] = {
+      "defineProperty", "defineProperties", "__defineGetter__",
+      "__defineSetter__", "__proto__", "constructor",
+    };
+    for (size_t j = 0; j < arraysize(kObjectMutators); ++j) {
+      if (text == ASCIIToUTF16(kObjectMutators[j]))
+        return false;
+    }
+  }
+
+  // The variables and parameters of each function.
+  std::vector<std::set<string16> > locals(parents.size());
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (tokens[i].function != -1 && IsIdentifierChar(tokens[i].text[0]) &&
+        IsDeclaration(tokens, i)) {
+      locals[tokens[i].function].insert(tokens[i].text);
+    }
+  }
+
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    const ScriptToken& token = tokens[i];
+    if (token.function == -1)
+      continue;
+    const string16& text = token.text;
+    if (text == ASCIIToUTF16("delete") || text == ASCIIToUTF16("with"))
+      return false;
+    // Methods that change the array they are called on.
+    static const char* const kMutators[] = {
+      "push", "pop", "shift", "unshift", "splice", "sort", "reverse",
+    };
+    for (size_t j = 0; j < arraysize(kMutators); ++j) {
+      if (text == ASCIIToUTF16(kMutators[j]))
+        return false;
+    }
+
+    size_t target;
+    if (text == ASCIIToUTF16("in") && i >= 3 &&
+        tokens[i - 2].text == ASCIIToUTF16("(") &&
+        tokens[i - 3].text == ASCIIToUTF16("for")) {
+      // "for (name in object)" assigns to |name|.
+      target = i - 1;
+    } else if (text == ASCIIToUTF16("++") || text == ASCIIToUTF16("--")) {
+      if (i > 0 && !token.newline_before &&
+          IsIdentifierChar(tokens[i - 1].text[0])) {
+        target = i - 1;
+      } else if (i + 1 < tokens.size()) {
+        target = i + 1;
+      } else {
+        return false;
+      }
+    } else if (text.size() >= 1 && text[text.size() - 1] == '=' &&
+               text != ASCIIToUTF16("==") && text != ASCIIToUTF16("===") &&
+               text != ASCIIToUTF16("!=") && text != ASCIIToUTF16("!==") &&
+               text != ASCIIToUTF16("<=") && text != ASCIIToUTF16(">=")) {
+      if (i == 0)
+        return false;
+      target = i - 1;
+    } else {
+      continue;
+    }
+
+    // Properties and elements may belong to shared objects.
+    const string16& name = tokens[target].text;
+    if (!IsIdentifierChar(name[0]) ||
+        (target > 0 && tokens[target - 1].text == ASCIIToUTF16(".")) ||
+        (target + 1 < tokens.size() &&
+         (tokens[target + 1].text == ASCIIToUTF16(".") ||
+          tokens[target + 1].text == ASCIIToUTF16("[")))) {
+      return false;
+    }
+    // The innermost function that declares |name| is the one it refers to.
+    int owner = token.function;
+    while (owner != -1 && !locals[owner].count(name))
+      owner = parents[owner];
+    if (owner == -1)
+      return false;
+    if (owner != token.function &&
+        (find_proxy == -1 || !IsInFunction(owner, find_proxy, parents))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 class PurgeMemoryTask : public base::RefCountedThreadSafe<PurgeMemoryTask> {
  public:
   explicit PurgeMemoryTask(ProxyResolver* resolver) : resolver_(resolver) {}
@@ -64,6 +405,8 @@ class MultiThreadedProxyResolver::Executor
   // Returns the outstanding job, or NULL.
   Job* outstanding_job() const { return outstanding_job_.get(); }
 
+  MultiThreadedProxyResolver* coordinator() { return coordinator_; }
+
   ProxyResolver* resolver() { return resolver_.get(); }
 
   int thread_number() const { return thread_number_; }
@@ -280,6 +623,9 @@ class MultiThreadedProxyResolver::GetProxyForURLJob
       if (result_code >= OK) {  // Note: unit-tests use values > 0.
         results_->Use(results_buf_);
       }
+      // An executor that is still around means the coordinator is too.
+      if (result_code == OK && executor())
+        executor()->coordinator()->CacheResult(url_, results_buf_);
       RunUserCallback(result_code);
     }
     OnJobCompleted();
@@ -387,12 +733,17 @@ MultiThreadedProxyResolver::Executor::~Executor() {
 
 // MultiThreadedProxyResolver --------------------------------------------------
 
+// static
+const int MultiThreadedProxyResolver::kResultCacheTtlSeconds = 60;
+
 MultiThreadedProxyResolver::MultiThreadedProxyResolver(
     ProxyResolverFactory* resolver_factory,
     size_t max_num_threads)
     : ProxyResolver(resolver_factory->resolvers_expect_pac_bytes()),
       resolver_factory_(resolver_factory),
-      max_num_threads_(max_num_threads) {
+      max_num_threads_(max_num_threads),
+      cache_results_(false),
+      result_cache_(kMaxCachedResults) {
   DCHECK_GE(max_num_threads, 1u);
 }
 
@@ -410,6 +761,9 @@ int MultiThreadedProxyResolver::GetProxyForURL(
   DCHECK(current_script_data_.get())
       << "Resolver is un-initialized. Must call SetPacScript() first!";
 
+  if (GetCachedResult(url, results))
+    return OK;
+
   scoped_refptr<GetProxyForURLJob> job(
       new GetProxyForURLJob(url, results, callback, net_log));
 
@@ -488,12 +842,15 @@ void MultiThreadedProxyResolver::CancelSetPacScript() {
   // Defensively clear some data which shouldn't be getting used
   // anymore.
   current_script_data_ = NULL;
+  cache_results_ = false;
+  result_cache_.Clear();
 
   ReleaseAllExecutors();
 }
 
 void MultiThreadedProxyResolver::PurgeMemory() {
   DCHECK(CalledOnValidThread());
+  result_cache_.Clear();
   for (ExecutorList::iterator it = executors_.begin();
        it != executors_.end(); ++it) {
     Executor* executor = *it;
@@ -510,6 +867,12 @@ int MultiThreadedProxyResolver::SetPacScript(
   // Save the script details, so we can provision new executors later.
   current_script_data_ = script_data;
 
+  // Results of the previous script no longer apply.
+  result_cache_.Clear();
+  cache_results_ =
+      script_data->type() == ProxyResolverScriptData::TYPE_SCRIPT_CONTENTS &&
+      IsHostOnlyScript(script_data->utf16());
+
   // The user should not have any outstanding requests when they call
   // SetPacScript().
   CheckNoOutstandingUserRequests();
@@ -589,4 +952,79 @@ void MultiThreadedProxyResolver::OnExecutorReady(Executor* executor) {
   executor->StartJob(job);
 }
 
+// static
+bool MultiThreadedProxyResolver::IsHostOnlyScript(const string16& script) {
+  const string16 kFunctionName = ASCIIToUTF16("FindProxyForURL");
+  // A second definition, or a call from within the script, would make the
+  // analysis below meaningless.
+  if (CountIdentifier(script, kFunctionName) != 1)
+    return false;
+
+  // Things that let a script get at its arguments, or at anything else that
+  // changes between two calls for the same host. RegExp objects with the
+  // global flag remember where their last match ended.
+  static const char* const kDisqualifiers[] = {
+    "arguments", "eval", "Function", "Date", "Math", "RegExp",
+    "timeRange", "dateRange", "weekdayRange",
+  };
+  for (size_t i = 0; i < arraysize(kDisqualifiers); ++i) {
+    if (CountIdentifier(script, ASCIIToUTF16(kDisqualifiers[i])) > 0)
+      return false;
+  }
+
+  // Find the name of the first parameter in "FindProxyForURL(url, host)".
+  size_t pos = script.find(kFunctionName) + kFunctionName.size();
+  while (pos < script.size() && IsWhitespace(script[pos]))
+    ++pos;
+  if (pos == script.size() || script[pos] != '(')
+    return false;
+  ++pos;
+  while (pos < script.size() && IsWhitespace(script[pos]))
+    ++pos;
+  size_t begin = pos;
+  while (pos < script.size() && IsIdentifierChar(script[pos]))
+    ++pos;
+  if (pos == begin)
+    return false;
+
+  // The parameter must not be used anywhere but in its declaration. This
+  // also rules out other variables of the same name, which is conservative.
+  if (CountIdentifier(script, script.substr(begin, pos - begin)) != 1)
+    return false;
+
+  // A script that keeps state between calls, such as a round-robin over
+  // proxies, can answer differently for the same host.
+  return IsStatelessScript(script);
+}
+
+bool MultiThreadedProxyResolver::GetCachedResult(const GURL& url,
+                                                 ProxyInfo* results) {
+  if (!cache_results_)
+    return false;
+
+  ResultCache::iterator it = result_cache_.Get(url.scheme() + "://" +
+                                               url.host());
+  if (it == result_cache_.end())
+    return false;
+  if (it->second.expiration <= base::TimeTicks::Now()) {
+    result_cache_.Erase(it);
+    return false;
+  }
+  results->Use(it->second.results);
+  return true;
+}
+
+void MultiThreadedProxyResolver::CacheResult(const GURL& url,
+                                             const ProxyInfo& results) {
+  DCHECK(CalledOnValidThread());
+  if (!cache_results_)
+    return;
+
+  CachedResult entry;
+  entry.results.Use(results);
+  entry.expiration = base::TimeTicks::Now() +
+      base::TimeDelta::FromSeconds(kResultCacheTtlSeconds);
+  result_cache_.Put(url.scheme() + "://" + url.host(), entry);
+}
+
 }  // namespace net
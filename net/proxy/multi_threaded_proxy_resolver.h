@@ -7,13 +7,18 @@
 #pragma once
 
 #include <deque>
+#include <string>
 #include <vector>
 
 #include "base/basictypes.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/string16.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/time.h"
 #include "net/base/net_export.h"
+#include "net/proxy/proxy_info.h"
 #include "net/proxy/proxy_resolver.h"
 
 namespace base {
@@ -72,6 +77,11 @@ class ProxyResolverFactory {
 //     a global counter and using that to make a decision. In the
 //     multi-threaded model, each thread may have a different value for this
 //     counter, so it won't globally be seen as monotonically increasing!
+//
+// When the script's FindProxyForURL() never looks at its |url| argument (and
+// does not use the time of day), its result can only depend on the host, so
+// results are cached per scheme and host for a short while. Those requests
+// then complete synchronously without running the script again.
 class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
     : public ProxyResolver,
       NON_EXPORTED_BASE(public base::NonThreadSafe) {
@@ -107,6 +117,14 @@ class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
       const scoped_refptr<ProxyResolverScriptData>& script_data,
       const CompletionCallback& callback) OVERRIDE;
 
+  // Returns true if the FindProxyForURL() defined by |script| only ever
+  // depends on the host of the URL it is given, as far as a simple scan of
+  // the script can tell.
+  static bool IsHostOnlyScript(const string16& script);
+
+  // How long a result of a host-only script is reused.
+  static const int kResultCacheTtlSeconds;
+
  private:
   class Executor;
   class Job;
@@ -134,11 +152,29 @@ class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
   // Starts the next job from |pending_jobs_| if possible.
   void OnExecutorReady(Executor* executor);
 
+  // Looks |url| up in |result_cache_|. Returns true and fills |results| on a
+  // hit.
+  bool GetCachedResult(const GURL& url, ProxyInfo* results);
+
+  // Remembers |results| for |url|, if the current script allows it.
+  void CacheResult(const GURL& url, const ProxyInfo& results);
+
+  struct CachedResult {
+    ProxyInfo results;
+    base::TimeTicks expiration;
+  };
+  // Keyed by the scheme and host of the URL.
+  typedef base::MRUCache<std::string, CachedResult> ResultCache;
+
   const scoped_ptr<ProxyResolverFactory> resolver_factory_;
   const size_t max_num_threads_;
   PendingJobsQueue pending_jobs_;
   ExecutorList executors_;
   scoped_refptr<ProxyResolverScriptData> current_script_data_;
+
+  // Whether results of |current_script_data_| may be cached.
+  bool cache_results_;
+  ResultCache result_cache_;
 };
 
 }  // namespace net
@@ -793,6 +793,333 @@ TEST(MultiThreadedProxyResolverTest, OneThreadBlocked) {
   EXPECT_EQ(3, factory->resolvers()[1]->request_count());
 }
 
+TEST(MultiThreadedProxyResolverTest, IsHostOnlyScript) {
+  EXPECT_TRUE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(url, host) {\n"
+      "  if (dnsDomainIs(host, '.example.com')) return 'DIRECT';\n"
+      "  return 'PROXY proxy:8080';\n"
+      "}")));
+  // Property accesses and longer names that contain the parameter name do
+  // not count as uses.
+  EXPECT_TRUE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL( u , h ) {\n"
+      "  var ux = window.u; return h == 'a' ? 'DIRECT' : 'PROXY p:1'; }")));
+
+  // Uses the URL.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(url, host) {\n"
+      "  if (shExpMatch(url, '*/foo/*')) return 'DIRECT';\n"
+      "  return 'PROXY proxy:8080';\n"
+      "}")));
+  // Can reach the URL through |arguments|.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(url, host) { return arguments[0]; }")));
+  // Depends on the time.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(url, host) {\n"
+      "  return timeRange(9, 17) ? 'PROXY a:1' : 'DIRECT'; }")));
+  // Defined twice.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(a, b) { return 'DIRECT'; }\n"
+      "function FindProxyForURL(url, host) { return url; }")));
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "pac script bytes")));
+
+  // Functions may change their own variables, and those of the functions
+  // they are in. Top-level code only runs once.
+  EXPECT_TRUE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "var prefix = 'PROXY ';\n"
+      "prefix += 'proxy';\n"
+      "function FindProxyForURL(url, host) {\n"
+      "  var n = 0, port = 80;\n"
+      "  function pick(p) { port = p; }\n"
+      "  for (var i = 0; i < 3; i++) n += i;\n"
+      "  if (host == 'a') pick(8080);\n"
+      "  return prefix + ':' + port; }")));
+  // Keeps state between calls: a round-robin, a counter, a table of hosts.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "var proxies = ['PROXY a:1', 'PROXY b:1'], next = 0;\n"
+      "function FindProxyForURL(url, host) {\n"
+      "  next = (next + 1) % 2; return proxies[next]; }")));
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "var count = 0;\n"
+      "function FindProxyForURL(url, host) { count++; return 'DIRECT'; }")));
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "var seen = {};\n"
+      "function FindProxyForURL(url, host) {\n"
+      "  seen[host] = true; return 'DIRECT'; }")));
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "var seen = [];\n"
+      "function FindProxyForURL(url, host) {\n"
+      "  seen.push(host); return 'DIRECT'; }")));
+  // Assigning to an undeclared name makes a global, even on a new line
+  // after a declaration.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(url, host) {\n"
+      "  var a = 1\n"
+      "  last = host; return 'DIRECT'; }")));
+  // Regular expression literals are not scanned.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(url, host) {\n"
+      "  return /^a/.test(host) ? 'DIRECT' : 'PROXY p:1'; }")));
+  // A closure built at load time keeps the variables of the function that
+  // built it from call to call.
+  EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(ASCIIToUTF16(
+      "function FindProxyForURL(url, host) { return pick(host); }\n"
+      "var pick = (function(){ var n = 0; return function(h){ n = n + 1;"
+      " return n % 2 ? \"PROXY a:1\" : \"PROXY b:1\"; }; })();")));
+}
+
+// Scripts that keep state between calls, or that the scan cannot follow,
+// in the ways scripts can be written to. None of them may be cached.
+TEST(MultiThreadedProxyResolverTest, IsHostOnlyScriptRejectsState) {
+  const char* const kScripts[] = {
+    // Closures over variables of functions other than FindProxyForURL().
+    "var next = (function() { var n = 0;\n"
+    "  return function() { n++; return n; }; })();\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  return next() % 2 ? 'PROXY a:1' : 'PROXY b:1'; }",
+    "(function() { var n = 0;\n"
+    "  FindProxyForURLImpl = function(host) { return n += 1; }; })();\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  return 'PROXY p:' + FindProxyForURLImpl(host); }",
+    "function counter() { var n = 0;\n"
+    "  function inc() { n = n + 1; return n; } return inc; }\n"
+    "var inc = counter();\n"
+    "function FindProxyForURL(url, host) { return 'PROXY p:' + inc(); }",
+    "function FindProxyForURL(url, host) {\n"
+    "  return pick(['PROXY a:1', 'PROXY b:1']); }\n"
+    "var pick = (function() { var i = -1;\n"
+    "  return function(list) { i = (i + 1) % list.length;"
+    " return list[i]; }; })();",
+    // State kept in properties of objects and functions.
+    "var state = { n: 0 };\n"
+    "function FindProxyForURL(url, host) { state.n++; return 'DIRECT'; }",
+    "var state = { n: 0 };\n"
+    "function FindProxyForURL(url, host) { ++state.n; return 'DIRECT'; }",
+    "var state = { n: 0, inc: function() { this.n = this.n + 1; } };\n"
+    "function FindProxyForURL(url, host) { state.inc(); return 'DIRECT'; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  FindProxyForURL.calls = 1; return 'DIRECT'; }",
+    "var cache = {};\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  cache[host] = (cache[host] || 0) + 1; return 'DIRECT'; }",
+    "var list = [];\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  list.splice(0, 0, host); return 'DIRECT'; }",
+    "var list = ['PROXY a:1', 'PROXY b:1'];\n"
+    "function FindProxyForURL(url, host) { list.reverse(); return list[0]; }",
+    "var list = ['PROXY a:1', 'PROXY b:1'];\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  var p = list.shift(); list[list.length] = p; return p; }",
+    "var o = {};\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  Object.defineProperty(o, host, { value: 1 }); return 'DIRECT'; }",
+    "var o = {};\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  o.__defineGetter__(host, function() {}); return 'DIRECT'; }",
+    // Getters run code when a property is read.
+    "var n = 0, o = { get next() { n = n + 1; return n; } };\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  return o.next % 2 ? 'PROXY a:1' : 'PROXY b:1'; }",
+    "var n = 0, o = { set last(v) { n = v; } };\n"
+    "function FindProxyForURL(url, host) { o.last = host; return n; }",
+    // Assignments to globals in all their forms.
+    "var last;\n"
+    "function FindProxyForURL(url, host) { last = host; return 'DIRECT'; }",
+    "var n = 0;\n"
+    "function FindProxyForURL(url, host) { n -= 1; return 'DIRECT'; }",
+    "var n = 0;\n"
+    "function FindProxyForURL(url, host) { --n; return 'DIRECT'; }",
+    "var n = 0;\n"
+    "function FindProxyForURL(url, host) { n <<= 1; return 'DIRECT'; }",
+    "var a, b;\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  var x = b = host; return 'DIRECT'; }",
+    "var k, o = { a: 1, b: 2 };\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  for (k in o) {} return 'DIRECT'; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  for (i = 0; i < 2; i++) {} return 'DIRECT'; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  try { throw 1; } catch (e) { e = host; } return 'DIRECT'; }",
+    // An object whose methods share the variables of the call that made it.
+    "var make = function() { var seen = 0;\n"
+    "  return { bump: function() { seen = seen + 1; return seen; } }; };\n"
+    "var bumper = make();\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  return bumper.bump() > 1 ? 'DIRECT' : 'PROXY a:1'; }",
+    // Line breaks that change which name ++ applies to.
+    "var n = 0;\n"
+    "function FindProxyForURL(url, host) { var a = 0; a\n++n;"
+    " return 'DIRECT'; }",
+    // Sources of values that change between calls.
+    "function FindProxyForURL(url, host) {\n"
+    "  return Math.random() < 0.5 ? 'PROXY a:1' : 'PROXY b:1'; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  return new Date().getSeconds() % 2 ? 'PROXY a:1' : 'DIRECT'; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  return weekdayRange('MON', 'FRI') ? 'PROXY a:1' : 'DIRECT'; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  return dateRange(1, 15) ? 'PROXY a:1' : 'DIRECT'; }",
+    "var re = new RegExp('a', 'g');\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  return re.test(host) ? 'PROXY a:1' : 'DIRECT'; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  return eval('1') ? 'PROXY a:1' : 'DIRECT'; }",
+    "var f = new Function('return 1');\n"
+    "function FindProxyForURL(url, host) { return f(); }",
+    "var F = [].constructor.constructor;\n"
+    "function FindProxyForURL(url, host) { return F('return 1')(); }",
+    // Ways to read the URL other than by its parameter.
+    "function FindProxyForURL(url, host) { return url; }",
+    "function FindProxyForURL(url, host) {\n"
+    "  return arguments.length > 1 ? 'DIRECT' : 'PROXY a:1'; }",
+    "function FindProxyForURL(url, host) { return \\u0075rl; }",
+    "function FindProxyForURL(u, h) { var f = function() { return u; };"
+    " return f(); }",
+    // Text the scan does not follow.
+    "function FindProxyForURL(url, host) {\n"
+    "  return /a/g.test(host) ? 'PROXY a:1' : 'DIRECT'; }",
+    "var n = 0;\n"
+    "function FindProxyForURL(url, host) { <!-- }\n"
+    "  n++; return 'DIRECT'; }",
+    "var n = 0;\n"
+    "function FindProxyForURL(url, host) {\n"
+    "--> }\n"
+    "  n++; return 'DIRECT'; }",
+    "function FindProxyForURL(url, host) { return 'DIRECT';",
+    "function FindProxyForURL(url, host) { return 'DIRECT; }",
+    "function FindProxyForURL(url, host) { /* return 'DIRECT'; }",
+    "var FindProxyForURL = function(url, host) { return 'DIRECT'; };",
+  };
+  for (size_t i = 0; i < arraysize(kScripts); ++i) {
+    SCOPED_TRACE(kScripts[i]);
+    EXPECT_FALSE(MultiThreadedProxyResolver::IsHostOnlyScript(
+        ASCIIToUTF16(kScripts[i])));
+  }
+}
+
+// Scripts in the usual shapes that keep no state, which may be cached.
+TEST(MultiThreadedProxyResolverTest, IsHostOnlyScriptAcceptsStateless) {
+  const char* const kScripts[] = {
+    "function FindProxyForURL(url, host) {\n"
+    "  if (isPlainHostName(host) || dnsDomainIs(host, '.corp.example'))\n"
+    "    return 'DIRECT';\n"
+    "  if (isInNet(dnsResolve(host), '10.0.0.0', '255.0.0.0'))\n"
+    "    return 'DIRECT';\n"
+    "  if (shExpMatch(host, '*.example.com')) return 'PROXY a:8080';\n"
+    "  return 'PROXY b:8080; DIRECT';\n"
+    "}",
+    // Lookup tables built once at load time.
+    "var direct = ['a.example', 'b.example'];\n"
+    "var proxies = {}; proxies['c.example'] = 'PROXY c:1';\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  for (var i = 0; i < direct.length; ++i) {\n"
+    "    if (dnsDomainIs(host, direct[i])) return 'DIRECT';\n"
+    "  }\n"
+    "  for (var key in proxies) {\n"
+    "    if (host == key) return proxies[key];\n"
+    "  }\n"
+    "  return 'DIRECT'; }",
+    // Helpers with their own variables and parameters.
+    "function lower(s) { var t = s; t = t.toLowerCase(); return t; }\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  host = lower(host);\n"
+    "  var n = 0; n += host.length; n--;\n"
+    "  return n > 10 ? 'PROXY a:1' : 'DIRECT'; }",
+    // Functions nested in FindProxyForURL() may change its variables, and
+    // those of each other.
+    "function FindProxyForURL(url, host) {\n"
+    "  var result = 'DIRECT';\n"
+    "  function check(suffix, proxy) {\n"
+    "    var matched = false;\n"
+    "    function match() { matched = dnsDomainIs(host, suffix); }\n"
+    "    match();\n"
+    "    if (matched) result = proxy;\n"
+    "  }\n"
+    "  check('.a.example', 'PROXY a:1');\n"
+    "  return result; }",
+    // A closure made inside FindProxyForURL() lives only for that call.
+    "function FindProxyForURL(url, host) {\n"
+    "  var n = 0;\n"
+    "  var bump = function() { n = n + 1; };\n"
+    "  bump(); bump();\n"
+    "  return n == 2 ? 'DIRECT' : 'PROXY a:1'; }",
+    // Names that only look like disqualifiers.
+    "var getter = 1, Dates = 2;\n"
+    "var table = { get: function(h) { return h ? 'DIRECT' : ''; } };\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  var urls = getter + Dates;\n"
+    "  return urls > 2 ? table.get(host) : 'PROXY a:1'; }",
+    // Strings and comments may contain anything.
+    "// var n = 0; n++\n"
+    "function FindProxyForURL(url, host) {\n"
+    "  /* count++ */ var s = 'x = 1; // /*';\n"
+    "  return s ? \"DIRECT\" : 'PROXY a:1'; }",
+  };
+  for (size_t i = 0; i < arraysize(kScripts); ++i) {
+    SCOPED_TRACE(kScripts[i]);
+    EXPECT_TRUE(MultiThreadedProxyResolver::IsHostOnlyScript(
+        ASCIIToUTF16(kScripts[i])));
+  }
+}
+
+TEST(MultiThreadedProxyResolverTest, SingleThread_CachesHostOnlyResults) {
+  const size_t kNumThreads = 1u;
+  scoped_ptr<MockProxyResolver> mock(new MockProxyResolver);
+  MultiThreadedProxyResolver resolver(
+      new ForwardingProxyResolverFactory(mock.get()), kNumThreads);
+
+  TestCompletionCallback set_script_callback;
+  int rv = resolver.SetPacScript(
+      ProxyResolverScriptData::FromUTF8(
+          "function FindProxyForURL(url, host) { return 'PROXY ' + host; }"),
+      set_script_callback.callback());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, set_script_callback.WaitForResult());
+
+  TestCompletionCallback callback0;
+  ProxyInfo results0;
+  rv = resolver.GetProxyForURL(GURL("http://host/path0"), &results0,
+                               callback0.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, callback0.WaitForResult());
+  EXPECT_EQ("PROXY host:80", results0.ToPacString());
+
+  // Another path on the same host is answered from the cache, synchronously.
+  TestCompletionCallback callback1;
+  ProxyInfo results1;
+  rv = resolver.GetProxyForURL(GURL("http://host/path1"), &results1,
+                               callback1.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(OK, rv);
+  EXPECT_EQ("PROXY host:80", results1.ToPacString());
+  EXPECT_EQ(1, mock->request_count());
+
+  // Another scheme is not.
+  TestCompletionCallback callback2;
+  ProxyInfo results2;
+  rv = resolver.GetProxyForURL(GURL("https://host/path1"), &results2,
+                               callback2.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(1, callback2.WaitForResult());
+  EXPECT_EQ(2, mock->request_count());
+
+  // Setting a new script drops the cached results.
+  rv = resolver.SetPacScript(
+      ProxyResolverScriptData::FromUTF8(
+          "function FindProxyForURL(url, host) { return 'PROXY ' + host; }"),
+      set_script_callback.callback());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, set_script_callback.WaitForResult());
+  TestCompletionCallback callback3;
+  ProxyInfo results3;
+  rv = resolver.GetProxyForURL(GURL("http://host/path0"), &results3,
+                               callback3.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(2, callback3.WaitForResult());
+}
+
 }  // namespace
 
 }  // namespace net
@@ -78,7 +78,7 @@ void HttpConnection::DetachSocket() {
 }
 
 void HttpConnection::Shift(int num_bytes) {
-  recv_data_ = recv_data_.substr(num_bytes);
+  recv_data_.erase(0, num_bytes);
 }
 
 }  // namespace net
@@ -4,6 +4,8 @@
 
 #include "net/server/web_socket.h"
 
+#include <string.h>
+
 #include <limits>
 
 #include "base/base64.h"
@@ -164,6 +166,30 @@ const size_t kTwoBytePayloadLengthField = 126;
 const size_t kEightBytePayloadLengthField = 127;
 const size_t kMaskingKeyWidthInBytes = 4;
 
+// Unmasks |payload_length| bytes of |payload| into |output|.  XORs eight bytes
+// at a time with the key repeated twice, which compilers also turn into
+// vector instructions where the target has them.
+void UnmaskPayload(const char* masking_key,
+                   const char* payload,
+                   size_t payload_length,
+                   char* output) {
+  char mask_bytes[8];
+  for (size_t i = 0; i < sizeof(mask_bytes); ++i)
+    mask_bytes[i] = masking_key[i % kMaskingKeyWidthInBytes];
+  uint64 mask;
+  memcpy(&mask, mask_bytes, sizeof(mask));
+
+  size_t i = 0;
+  for (; i + sizeof(mask) <= payload_length; i += sizeof(mask)) {
+    uint64 chunk;
+    memcpy(&chunk, payload + i, sizeof(chunk));
+    chunk ^= mask;
+    memcpy(output + i, &chunk, sizeof(chunk));
+  }
+  for (; i < payload_length; ++i)
+    output[i] = payload[i] ^ masking_key[i % kMaskingKeyWidthInBytes];
+}
+
 class WebSocketHybi17 : public WebSocket {
  public:
   static WebSocket* Create(HttpConnection* connection,
@@ -201,126 +227,174 @@ class WebSocketHybi17 : public WebSocket {
   }
 
   virtual ParseResult Read(std::string* message) {
-    size_t data_length = connection_->recv_data().length();
-    if (data_length < 2)
-      return FRAME_INCOMPLETE;
+    // A fragmented message is built up in |pending_message_| as its frames
+    // arrive, so each frame is unmasked once, straight out of the receive
+    // buffer, and then dropped from it.
+    while (true) {
+      size_t data_length = connection_->recv_data().length();
+      if (data_length < 2)
+        return FRAME_INCOMPLETE;
 
-    const char* p = connection_->recv_data().c_str();
-    const char* buffer_end = p + data_length;
-
-    unsigned char first_byte = *p++;
-    unsigned char second_byte = *p++;
-
-    final_ = (first_byte & kFinalBit) != 0;
-    reserved1_ = (first_byte & kReserved1Bit) != 0;
-    reserved2_ = (first_byte & kReserved2Bit) != 0;
-    reserved3_ = (first_byte & kReserved3Bit) != 0;
-    op_code_ = first_byte & kOpCodeMask;
-    masked_ = (second_byte & kMaskBit) != 0;
-
-    switch (op_code_) {
-    case kOpCodeClose:
-      closed_ = true;
-      break;
-    case kOpCodeText:
-      break;
-    case kOpCodeBinary: // We don't support binary frames yet.
-    case kOpCodeContinuation: // We don't support binary frames yet.
-    case kOpCodePing: // We don't support binary frames yet.
-    case kOpCodePong: // We don't support binary frames yet.
-    default:
-      return FRAME_ERROR;
-    }
+      const char* p = connection_->recv_data().data();
+      const char* buffer_end = p + data_length;
+
+      unsigned char first_byte = *p++;
+      unsigned char second_byte = *p++;
+
+      final_ = (first_byte & kFinalBit) != 0;
+      reserved1_ = (first_byte & kReserved1Bit) != 0;
+      reserved2_ = (first_byte & kReserved2Bit) != 0;
+      reserved3_ = (first_byte & kReserved3Bit) != 0;
+      op_code_ = first_byte & kOpCodeMask;
+      masked_ = (second_byte & kMaskBit) != 0;
+
+      switch (op_code_) {
+      case kOpCodeClose:
+      case kOpCodePing:
+      case kOpCodePong:
+        // Control frames must not be fragmented, and may arrive between the
+        // frames of a fragmented message.
+        if (!final_)
+          return FRAME_ERROR;
+        break;
+      case kOpCodeText:
+        if (in_fragmented_message_)
+          return FRAME_ERROR;
+        break;
+      case kOpCodeContinuation:
+        if (!in_fragmented_message_)
+          return FRAME_ERROR;
+        break;
+      case kOpCodeBinary: // We don't support binary frames yet.
+      default:
+        return FRAME_ERROR;
+      }
 
-    if (!masked_) // According to Hybi-17 spec client MUST mask his frame.
-      return FRAME_ERROR;
+      if (!masked_) // According to Hybi-17 spec client MUST mask his frame.
+        return FRAME_ERROR;
+
+      uint64 payload_length64 = second_byte & kPayloadLengthMask;
+      if (payload_length64 > kMaxSingleBytePayloadLength) {
+        int extended_payload_length_size;
+        if (payload_length64 == kTwoBytePayloadLengthField)
+          extended_payload_length_size = 2;
+        else {
+          DCHECK(payload_length64 == kEightBytePayloadLengthField);
+          extended_payload_length_size = 8;
+        }
+        if (buffer_end - p < extended_payload_length_size)
+          return FRAME_INCOMPLETE;
+        payload_length64 = 0;
+        for (int i = 0; i < extended_payload_length_size; ++i) {
+          payload_length64 <<= 8;
+          payload_length64 |= static_cast<unsigned char>(*p++);
+        }
+      }
 
-    uint64 payload_length64 = second_byte & kPayloadLengthMask;
-    if (payload_length64 > kMaxSingleBytePayloadLength) {
-      int extended_payload_length_size;
-      if (payload_length64 == kTwoBytePayloadLengthField)
-        extended_payload_length_size = 2;
-      else {
-        DCHECK(payload_length64 == kEightBytePayloadLengthField);
-        extended_payload_length_size = 8;
+      static const uint64 max_payload_length = 0x7FFFFFFFFFFFFFFFull;
+      static size_t max_length = std::numeric_limits<size_t>::max();
+      if (payload_length64 > max_payload_length ||
+          payload_length64 + kMaskingKeyWidthInBytes > max_length) {
+        // WebSocket frame length too large.
+        return FRAME_ERROR;
       }
-      if (buffer_end - p < extended_payload_length_size)
-        return FRAME_INCOMPLETE;
-      payload_length64 = 0;
-      for (int i = 0; i < extended_payload_length_size; ++i) {
-        payload_length64 <<= 8;
-        payload_length64 |= static_cast<unsigned char>(*p++);
+      if (IsControlFrame(op_code_) &&
+          payload_length64 > kMaxSingleBytePayloadLength) {
+        return FRAME_ERROR;
       }
-    }
-
-    static const uint64 max_payload_length = 0x7FFFFFFFFFFFFFFFull;
-    static size_t max_length = std::numeric_limits<size_t>::max();
-    if (payload_length64 > max_payload_length ||
-        payload_length64 + kMaskingKeyWidthInBytes > max_length) {
-      // WebSocket frame length too large.
-      return FRAME_ERROR;
-    }
-    payload_length_ = static_cast<size_t>(payload_length64);
+      payload_length_ = static_cast<size_t>(payload_length64);
 
-    size_t total_length = kMaskingKeyWidthInBytes + payload_length_;
-    if (static_cast<size_t>(buffer_end - p) < total_length)
-      return FRAME_INCOMPLETE;
+      size_t total_length = kMaskingKeyWidthInBytes + payload_length_;
+      if (static_cast<size_t>(buffer_end - p) < total_length)
+        return FRAME_INCOMPLETE;
 
-    if (masked_) {
-      message->resize(payload_length_);
       const char* masking_key = p;
-      char* payload = const_cast<char*>(p + kMaskingKeyWidthInBytes);
-      for (size_t i = 0; i < payload_length_; ++i)  // Unmask the payload.
-        (*message)[i] = payload[i] ^ masking_key[i % kMaskingKeyWidthInBytes];
-    } else {
-      std::string buffer(p, p + payload_length_);
-      message->swap(buffer);
-    }
+      const char* payload = p + kMaskingKeyWidthInBytes;
+      size_t pos = payload + payload_length_ - connection_->recv_data().data();
+
+      // Control frames are unmasked on their own, leaving any fragmented
+      // message in |pending_message_| as it is.
+      if (IsControlFrame(op_code_)) {
+        std::string control_payload(payload_length_, '\0');
+        if (payload_length_) {
+          UnmaskPayload(masking_key, payload, payload_length_,
+                        &control_payload[0]);
+        }
+        connection_->Shift(pos);
+        if (op_code_ == kOpCodePing) {
+          SendFrame(kOpCodePong, control_payload.data(),
+                    control_payload.length());
+        }
+        if (op_code_ != kOpCodeClose)
+          continue;
+        closed_ = true;
+        in_fragmented_message_ = false;
+        pending_message_.clear();
+        message->swap(control_payload);
+        return FRAME_CLOSE;
+      }
+
+      size_t offset = pending_message_.length();
+      pending_message_.resize(offset + payload_length_);
+      if (payload_length_) {
+        UnmaskPayload(masking_key, payload, payload_length_,
+                      &pending_message_[offset]);
+      }
+      connection_->Shift(pos);
 
-    size_t pos = p + kMaskingKeyWidthInBytes + payload_length_ -
-        connection_->recv_data().c_str();
-    connection_->Shift(pos);
+      if (!final_) {
+        in_fragmented_message_ = true;
+        continue;
+      }
 
-    return closed_ ? FRAME_CLOSE : FRAME_OK;
+      in_fragmented_message_ = false;
+      message->swap(pending_message_);
+      pending_message_.clear();
+      return FRAME_OK;
+    }
   }
 
   virtual void Send(const std::string& message) {
     if (closed_)
       return;
+    SendFrame(kOpCodeText, message.data(), message.length());
+  }
 
-    std::vector<char> frame;
-    OpCode op_code = kOpCodeText;
-    size_t data_length = message.length();
-
-    frame.push_back(kFinalBit | op_code);
-    if (data_length <= kMaxSingleBytePayloadLength)
-      frame.push_back(data_length);
-    else if (data_length <= 0xFFFF) {
-      frame.push_back(kTwoBytePayloadLengthField);
-      frame.push_back((data_length & 0xFF00) >> 8);
-      frame.push_back(data_length & 0xFF);
+ private:
+  static bool IsControlFrame(OpCode op_code) {
+    return op_code == kOpCodeClose || op_code == kOpCodePing ||
+        op_code == kOpCodePong;
+  }
+
+  // Sends the frame header, then |data| as it is, rather than copying both
+  // into one buffer first.
+  void SendFrame(OpCode op_code, const char* data, size_t data_length) {
+    char header[10];
+    size_t header_length = 0;
+    header[header_length++] = kFinalBit | op_code;
+    if (data_length <= kMaxSingleBytePayloadLength) {
+      header[header_length++] = data_length;
+    } else if (data_length <= 0xFFFF) {
+      header[header_length++] = kTwoBytePayloadLengthField;
+      header[header_length++] = (data_length & 0xFF00) >> 8;
+      header[header_length++] = data_length & 0xFF;
     } else {
-      frame.push_back(kEightBytePayloadLengthField);
-      char extended_payload_length[8];
-      size_t remaining = data_length;
-      // Fill the length into extended_payload_length in the network byte order.
+      header[header_length++] = kEightBytePayloadLengthField;
+      uint64 remaining = data_length;
+      // Fill the length in the network byte order.
       for (int i = 0; i < 8; ++i) {
-        extended_payload_length[7 - i] = remaining & 0xFF;
+        header[header_length + 7 - i] = remaining & 0xFF;
         remaining >>= 8;
       }
-      frame.insert(frame.end(),
-                   extended_payload_length,
-                   extended_payload_length + 8);
+      header_length += 8;
       DCHECK(!remaining);
     }
 
-    const char* data = message.c_str();
-    frame.insert(frame.end(), data, data + data_length);
-
-    connection_->Send(&frame[0], frame.size());
+    connection_->Send(header, header_length);
+    if (data_length)
+      connection_->Send(data, data_length);
   }
 
- private:
   WebSocketHybi17(HttpConnection* connection,
                   const HttpServerRequestInfo& request,
                   size_t* pos)
@@ -334,6 +408,7 @@ class WebSocketHybi17 : public WebSocket {
       payload_(0),
       payload_length_(0),
       frame_end_(0),
+      in_fragmented_message_(false),
       closed_(false) {
   }
 
@@ -346,6 +421,10 @@ class WebSocketHybi17 : public WebSocket {
   const char* payload_;
   size_t payload_length_;
   const char* frame_end_;
+  // True between the first and the final frame of a fragmented message,
+  // which is collected in |pending_message_|.
+  bool in_fragmented_message_;
+  std::string pending_message_;
   bool closed_;
 
   DISALLOW_COPY_AND_ASSIGN(WebSocketHybi17);
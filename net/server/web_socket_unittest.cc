@@ -0,0 +1,214 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/server/web_socket.h"
+
+#include <string>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/memory/ref_counted.h"
+#include "base/message_loop.h"
+#include "net/base/listen_socket.h"
+#include "net/server/http_server.h"
+#include "net/server/http_server_request_info.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const unsigned char kMaskingKey[] = { 0x12, 0x34, 0x56, 0x78 };
+
+const int kOpCodeContinuation = 0x0;
+const int kOpCodeText = 0x1;
+const int kOpCodeClose = 0x8;
+const int kOpCodePing = 0x9;
+const int kOpCodePong = 0xA;
+
+// Returns a client frame holding |payload|, masked with kMaskingKey unless
+// |masked| is false.
+std::string MakeFrame(int op_code, bool final, const std::string& payload,
+                      bool masked) {
+  std::string frame;
+  frame.push_back(static_cast<char>((final ? 0x80 : 0) | op_code));
+  char mask_bit = masked ? 0x80 : 0;
+  if (payload.length() <= 125) {
+    frame.push_back(mask_bit | static_cast<char>(payload.length()));
+  } else {
+    DCHECK_LE(payload.length(), 0xFFFFu);
+    frame.push_back(mask_bit | 126);
+    frame.push_back(static_cast<char>(payload.length() >> 8));
+    frame.push_back(static_cast<char>(payload.length() & 0xFF));
+  }
+  if (!masked)
+    return frame + payload;
+  frame.append(reinterpret_cast<const char*>(kMaskingKey),
+               arraysize(kMaskingKey));
+  for (size_t i = 0; i < payload.length(); ++i)
+    frame.push_back(static_cast<char>(
+        payload[i] ^ kMaskingKey[i % arraysize(kMaskingKey)]));
+  return frame;
+}
+
+std::string MakeFrame(int op_code, bool final, const std::string& payload) {
+  return MakeFrame(op_code, final, payload, true);
+}
+
+// A connected socket that records what the server sends on it.
+class FakeSocket : public ListenSocket {
+ public:
+  explicit FakeSocket(ListenSocketDelegate* delegate)
+      : ListenSocket(delegate) {
+  }
+
+  std::string* sent() { return &sent_; }
+
+ protected:
+  virtual void SendInternal(const char* bytes, int len) OVERRIDE {
+    sent_.append(bytes, len);
+  }
+
+ private:
+  virtual ~FakeSocket() {}
+
+  std::string sent_;
+};
+
+class WebSocketTest : public testing::Test,
+                      public HttpServer::Delegate {
+ public:
+  WebSocketTest() : closed_(false) {}
+
+  virtual void SetUp() OVERRIDE {
+    server_ = new HttpServer("127.0.0.1", 0, this);
+    socket_ = new FakeSocket(server_);
+    server_->DidAccept(NULL, socket_);
+    Receive("GET /ws HTTP/1.1\r\n"
+            "Host: localhost\r\n"
+            "Connection: Upgrade\r\n"
+            "Upgrade: websocket\r\n"
+            "Sec-WebSocket-Version: 13\r\n"
+            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+            "\r\n");
+    ASSERT_EQ(0u, socket_->sent()->find("HTTP/1.1 101 "));
+    socket_->sent()->clear();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    server_ = NULL;
+  }
+
+  // HttpServer::Delegate implementation.
+  virtual void OnHttpRequest(int connection_id,
+                             const HttpServerRequestInfo& info) OVERRIDE {
+    ADD_FAILURE();
+  }
+
+  virtual void OnWebSocketRequest(int connection_id,
+                                  const HttpServerRequestInfo& info) OVERRIDE {
+    server_->AcceptWebSocket(connection_id, info);
+  }
+
+  virtual void OnWebSocketMessage(int connection_id,
+                                  const std::string& data) OVERRIDE {
+    messages_.push_back(data);
+  }
+
+  virtual void OnClose(int connection_id) OVERRIDE {
+    closed_ = true;
+  }
+
+ protected:
+  void Receive(const std::string& data) {
+    server_->DidRead(socket_, data.data(), data.length());
+  }
+
+  MessageLoopForIO message_loop_;
+  scoped_refptr<HttpServer> server_;
+  scoped_refptr<FakeSocket> socket_;
+  std::vector<std::string> messages_;
+  bool closed_;
+};
+
+}  // namespace
+
+TEST_F(WebSocketTest, MaskedFrames) {
+  // Long enough to be unmasked both a word and a byte at a time.
+  std::string long_message(300, 'a');
+  for (size_t i = 0; i < long_message.length(); ++i)
+    long_message[i] += i % 26;
+
+  Receive(MakeFrame(kOpCodeText, true, "Hi"));
+  Receive(MakeFrame(kOpCodeText, true, long_message));
+  ASSERT_EQ(2u, messages_.size());
+  EXPECT_EQ("Hi", messages_[0]);
+  EXPECT_EQ(long_message, messages_[1]);
+  EXPECT_FALSE(closed_);
+}
+
+TEST_F(WebSocketTest, UnmaskedFrameIsRejected) {
+  Receive(MakeFrame(kOpCodeText, true, "Hi", false));
+  EXPECT_TRUE(messages_.empty());
+  EXPECT_TRUE(closed_);
+}
+
+TEST_F(WebSocketTest, FragmentedMessage) {
+  // The frames arrive in one read, and the last one a byte at a time.
+  Receive(MakeFrame(kOpCodeText, false, "Hel") +
+          MakeFrame(kOpCodeContinuation, false, "lo, "));
+  EXPECT_TRUE(messages_.empty());
+  std::string last_frame = MakeFrame(kOpCodeContinuation, true, "world");
+  for (size_t i = 0; i < last_frame.length(); ++i) {
+    EXPECT_TRUE(messages_.empty());
+    Receive(last_frame.substr(i, 1));
+  }
+  ASSERT_EQ(1u, messages_.size());
+  EXPECT_EQ("Hello, world", messages_[0]);
+
+  Receive(MakeFrame(kOpCodeText, true, "next"));
+  ASSERT_EQ(2u, messages_.size());
+  EXPECT_EQ("next", messages_[1]);
+  EXPECT_FALSE(closed_);
+}
+
+TEST_F(WebSocketTest, ContinuationWithoutMessageIsRejected) {
+  Receive(MakeFrame(kOpCodeContinuation, true, "lo"));
+  EXPECT_TRUE(messages_.empty());
+  EXPECT_TRUE(closed_);
+}
+
+TEST_F(WebSocketTest, PingBetweenFragments) {
+  Receive(MakeFrame(kOpCodeText, false, "Hel") +
+          MakeFrame(kOpCodePing, true, "ping") +
+          MakeFrame(kOpCodePong, true, "pong") +
+          MakeFrame(kOpCodeContinuation, true, "lo"));
+  ASSERT_EQ(1u, messages_.size());
+  EXPECT_EQ("Hello", messages_[0]);
+
+  // The ping is answered with an unmasked pong carrying its payload.
+  std::string pong;
+  pong.push_back(static_cast<char>(0x80 | kOpCodePong));
+  pong.push_back(4);
+  pong.append("ping");
+  EXPECT_EQ(pong, *socket_->sent());
+  EXPECT_FALSE(closed_);
+}
+
+TEST_F(WebSocketTest, CloseBetweenFragments) {
+  Receive(MakeFrame(kOpCodeText, false, "Hel") +
+          MakeFrame(kOpCodeClose, true, "bye"));
+  EXPECT_TRUE(messages_.empty());
+  EXPECT_TRUE(closed_);
+}
+
+TEST_F(WebSocketTest, FragmentedControlFrameIsRejected) {
+  Receive(MakeFrame(kOpCodePing, false, "ping"));
+  EXPECT_TRUE(socket_->sent()->empty());
+  EXPECT_TRUE(closed_);
+}
+
+}  // namespace net
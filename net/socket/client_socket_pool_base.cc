@@ -5,6 +5,9 @@
 #include "net/socket/client_socket_pool_base.h"
 
 #include <math.h>
+
+#include <algorithm>
+
 #include "base/compiler_specific.h"
 #include "base/format_macros.h"
 #include "base/logging.h"
@@ -39,6 +42,19 @@ const int kCleanupInterval = 10;  // DO NOT INCREASE THIS TIMEOUT.
 // after a certain timeout has passed without receiving an ACK.
 bool g_connect_backup_jobs_enabled = true;
 
+// Indicate whether pools should keep idle sockets warm for groups with recent
+// demand.
+bool g_prewarm_sockets_enabled = false;
+
+// The length of the windows over which socket requests are counted to decide
+// how many sockets to keep warm in a group.
+const int kDemandWindowSeconds = 10;
+
+// A group gets one warm socket for every this many requests over the last two
+// windows, up to kMaxPrewarmedSocketsPerGroup.
+const int kRequestsPerPrewarmedSocket = 4;
+const int kMaxPrewarmedSocketsPerGroup = 2;
+
 double g_socket_reuse_policy_penalty_exponent = -1;
 int g_socket_reuse_policy = -1;
 
@@ -191,6 +207,7 @@ ClientSocketPoolBaseHelper::ClientSocketPoolBaseHelper(
       used_idle_socket_timeout_(used_idle_socket_timeout),
       connect_job_factory_(connect_job_factory),
       connect_backup_jobs_enabled_(false),
+      prewarm_sockets_enabled_(g_prewarm_sockets_enabled),
       pool_generation_number_(0),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
   DCHECK_LE(0, max_sockets_per_group);
@@ -263,6 +280,8 @@ int ClientSocketPoolBaseHelper::RequestSocket(
 
   request->net_log().BeginEvent(NetLog::TYPE_SOCKET_POOL, NULL);
   Group* group = GetOrCreateGroup(group_name);
+  if (prewarm_sockets_enabled_)
+    RecordGroupDemand(group_name);
 
   int rv = RequestSocketInternal(group_name, request);
   if (rv != ERR_IO_PENDING) {
@@ -733,6 +752,88 @@ void ClientSocketPoolBaseHelper::EnableConnectBackupJobs() {
   connect_backup_jobs_enabled_ = g_connect_backup_jobs_enabled;
 }
 
+// static
+bool ClientSocketPoolBaseHelper::prewarm_sockets_enabled() {
+  return g_prewarm_sockets_enabled;
+}
+
+// static
+bool ClientSocketPoolBaseHelper::set_prewarm_sockets_enabled(bool enabled) {
+  bool old_value = g_prewarm_sockets_enabled;
+  g_prewarm_sockets_enabled = enabled;
+  return old_value;
+}
+
+int ClientSocketPoolBaseHelper::NumSocketsToPrewarm(
+    const std::string& group_name) const {
+  if (!prewarm_sockets_enabled_)
+    return 0;
+
+  GroupDemandMap::const_iterator demand_it =
+      group_demand_map_.find(group_name);
+  if (demand_it == group_demand_map_.end())
+    return 0;
+  const GroupDemand& demand = demand_it->second;
+  int target = std::min(
+      kMaxPrewarmedSocketsPerGroup,
+      (demand.current_window_requests + demand.previous_window_requests) /
+          kRequestsPerPrewarmedSocket);
+
+  int warm_sockets = 0;
+  int active_slots = 0;
+  GroupMap::const_iterator group_it = group_map_.find(group_name);
+  if (group_it != group_map_.end()) {
+    const Group* group = group_it->second;
+    int unbound_jobs = static_cast<int>(group->jobs().size()) -
+        static_cast<int>(group->pending_requests().size());
+    warm_sockets = static_cast<int>(group->idle_sockets().size()) +
+        std::max(0, unbound_jobs);
+    active_slots = group->NumActiveSocketSlots();
+  }
+
+  int num_new_sockets = target - warm_sockets;
+  // Only use socket slots that are free pool-wide, so that warming one group
+  // never closes idle sockets of another.
+  num_new_sockets = std::min(
+      num_new_sockets,
+      max_sockets_ - handed_out_socket_count_ - connecting_socket_count_ -
+          idle_socket_count_);
+  num_new_sockets = std::min(num_new_sockets,
+                             max_sockets_per_group_ - active_slots);
+  if (num_new_sockets <= 0)
+    return 0;
+  return active_slots + num_new_sockets;
+}
+
+void ClientSocketPoolBaseHelper::RecordGroupDemand(
+    const std::string& group_name) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  TimeDelta window = TimeDelta::FromSeconds(kDemandWindowSeconds);
+  if (!ContainsKey(group_demand_map_, group_name))
+    RemoveStaleGroupDemand(now);
+  GroupDemand& demand = group_demand_map_[group_name];
+  if (demand.window_start.is_null() || now - demand.window_start >= window) {
+    // Only the window right before the current one is worth remembering.
+    demand.previous_window_requests =
+        now - demand.window_start < window * 2 ?
+        demand.current_window_requests : 0;
+    demand.current_window_requests = 0;
+    demand.window_start = now;
+  }
+  demand.current_window_requests++;
+}
+
+void ClientSocketPoolBaseHelper::RemoveStaleGroupDemand(base::TimeTicks now) {
+  TimeDelta max_age = TimeDelta::FromSeconds(2 * kDemandWindowSeconds);
+  GroupDemandMap::iterator it = group_demand_map_.begin();
+  while (it != group_demand_map_.end()) {
+    if (now - it->second.window_start >= max_age)
+      group_demand_map_.erase(it++);
+    else
+      ++it;
+  }
+}
+
 void ClientSocketPoolBaseHelper::IncrementIdleCount() {
   if (++idle_socket_count_ == 1 && use_cleanup_timer_)
     StartIdleSocketTimer();
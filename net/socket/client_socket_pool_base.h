@@ -338,6 +338,18 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
 
   void EnableConnectBackupJobs();
 
+  // Called to enable/disable warming idle sockets ahead of demand. When
+  // enabled, pools created afterwards keep a few idle sockets (or connect jobs
+  // not bound to a request) in groups that have seen recent requests, scaled
+  // by their request rate.
+  static bool prewarm_sockets_enabled();
+  static bool set_prewarm_sockets_enabled(bool enabled);
+
+  // Returns the |num_sockets| to pass to RequestSockets() so that
+  // |group_name| has as many warm sockets as its recent demand calls for, or
+  // 0 if none are needed. Stays within the per-group and total limits.
+  int NumSocketsToPrewarm(const std::string& group_name) const;
+
   // ConnectJob::Delegate methods:
   virtual void OnConnectJobComplete(int result, ConnectJob* job) OVERRIDE;
 
@@ -445,6 +457,18 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
 
   typedef std::set<ConnectJob*> ConnectJobSet;
 
+  // Recent socket requests of a group, counted over fixed windows. This
+  // outlives the Group, which goes away whenever it has nothing in it.
+  struct GroupDemand {
+    GroupDemand() : current_window_requests(0), previous_window_requests(0) {}
+
+    base::TimeTicks window_start;
+    int current_window_requests;
+    int previous_window_requests;
+  };
+
+  typedef std::map<std::string, GroupDemand> GroupDemandMap;
+
   struct CallbackResultPair {
     CallbackResultPair() : result(OK) {}
     CallbackResultPair(const CompletionCallback& callback_in, int result_in)
@@ -474,6 +498,12 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // Start cleanup timer for idle sockets.
   void StartIdleSocketTimer();
 
+  // Counts a socket request for |group_name| towards its demand.
+  void RecordGroupDemand(const std::string& group_name);
+
+  // Forgets the demand of groups without requests in the last two windows.
+  void RemoveStaleGroupDemand(base::TimeTicks now);
+
   // Scans the group map for groups which have an available socket slot and
   // at least one pending request. Returns true if any groups are stalled, and
   // if so (and if both |group| and |group_name| are not NULL), fills |group|
@@ -589,6 +619,10 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
   // TODO(vandebo) Remove when backup jobs move to TransportClientSocketPool
   bool connect_backup_jobs_enabled_;
 
+  // Whether to keep warm idle sockets in groups with recent demand.
+  const bool prewarm_sockets_enabled_;
+  GroupDemandMap group_demand_map_;
+
   // A unique id for the pool.  It gets incremented every time we Flush() the
   // pool.  This is so that when sockets get released back to the pool, we can
   // make sure that they are discarded rather than reused.
@@ -683,7 +717,13 @@ class ClientSocketPoolBase {
                     internal::ClientSocketPoolBaseHelper::NORMAL,
                     params->ignore_limits(),
                     params, net_log);
-    return helper_.RequestSocket(group_name, request);
+    int rv = helper_.RequestSocket(group_name, request);
+    if (rv == OK || rv == ERR_IO_PENDING) {
+      int num_sockets = helper_.NumSocketsToPrewarm(group_name);
+      if (num_sockets > 0)
+        RequestSockets(group_name, params, num_sockets, net_log);
+    }
+    return rv;
   }
 
   // RequestSockets bundles up the parameters into a Request and then forwards
@@ -609,6 +609,8 @@ class ClientSocketPoolBaseTest : public testing::Test {
     internal::ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(true);
     cleanup_timer_enabled_ =
         internal::ClientSocketPoolBaseHelper::cleanup_timer_enabled();
+    prewarm_sockets_enabled_ =
+        internal::ClientSocketPoolBaseHelper::prewarm_sockets_enabled();
   }
 
   virtual ~ClientSocketPoolBaseTest() {
@@ -616,6 +618,8 @@ class ClientSocketPoolBaseTest : public testing::Test {
         connect_backup_jobs_enabled_);
     internal::ClientSocketPoolBaseHelper::set_cleanup_timer_enabled(
         cleanup_timer_enabled_);
+    internal::ClientSocketPoolBaseHelper::set_prewarm_sockets_enabled(
+        prewarm_sockets_enabled_);
   }
 
   void CreatePool(int max_sockets, int max_sockets_per_group) {
@@ -666,6 +670,7 @@ class ClientSocketPoolBaseTest : public testing::Test {
 
   bool connect_backup_jobs_enabled_;
   bool cleanup_timer_enabled_;
+  bool prewarm_sockets_enabled_;
   MockClientSocketFactory client_socket_factory_;
   TestConnectJobFactory* connect_job_factory_;
   scoped_refptr<TestSocketParams> params_;
@@ -3416,6 +3421,40 @@ TEST_F(ClientSocketPoolBaseTest, PreconnectWithBackupJob) {
   EXPECT_EQ(1, pool_->NumActiveSocketsInGroup("a"));
 }
 
+// Groups with enough recent requests get an idle socket ahead of the next one.
+TEST_F(ClientSocketPoolBaseTest, PrewarmSockets) {
+  internal::ClientSocketPoolBaseHelper::set_prewarm_sockets_enabled(true);
+  CreatePool(10, 6);
+
+  EXPECT_EQ(OK, StartRequest("a", kDefaultPriority));
+  EXPECT_EQ(OK, StartRequest("a", kDefaultPriority));
+  EXPECT_EQ(OK, StartRequest("a", kDefaultPriority));
+  EXPECT_EQ(OK, StartRequest("b", kDefaultPriority));
+  EXPECT_EQ(0, pool_->IdleSocketCountInGroup("a"));
+
+  EXPECT_EQ(OK, StartRequest("a", kDefaultPriority));
+  EXPECT_EQ(1, pool_->IdleSocketCountInGroup("a"));
+  EXPECT_EQ(0, pool_->IdleSocketCountInGroup("b"));
+
+  // The next request takes the warm socket, and another one is warmed.
+  EXPECT_EQ(OK, StartRequest("a", kDefaultPriority));
+  EXPECT_EQ(5, pool_->NumActiveSocketsInGroup("a"));
+  EXPECT_EQ(1, pool_->IdleSocketCountInGroup("a"));
+  EXPECT_EQ(7, client_socket_factory_.allocation_count());
+}
+
+// Warming never goes past the per-group limit.
+TEST_F(ClientSocketPoolBaseTest, PrewarmSocketsRespectsGroupLimit) {
+  internal::ClientSocketPoolBaseHelper::set_prewarm_sockets_enabled(true);
+  CreatePool(10, 4);
+
+  for (int i = 0; i < 4; ++i)
+    EXPECT_EQ(OK, StartRequest("a", kDefaultPriority));
+  EXPECT_EQ(4, pool_->NumActiveSocketsInGroup("a"));
+  EXPECT_EQ(0, pool_->IdleSocketCountInGroup("a"));
+  EXPECT_EQ(4, client_socket_factory_.allocation_count());
+}
+
 }  // namespace
 
 }  // namespace net
@@ -1051,6 +1051,20 @@ int SSLClientSocketNSS::InitializeSSLPeerName() {
   if (!ssl_session_cache_shard_.empty()) {
     peer_id += "/" + ssl_session_cache_shard_;
   }
+  // Sessions are also keyed by the client certificate we are configured to
+  // send, so that a session authenticated with one certificate (or with none)
+  // is never offered by a socket configured with another. Otherwise the server
+  // would resume without asking for the new certificate.
+  if (ssl_config_.send_client_cert) {
+    if (ssl_config_.client_cert) {
+      const SHA1Fingerprint& fingerprint =
+          ssl_config_.client_cert->fingerprint();
+      peer_id += "/cert:" + base::HexEncode(fingerprint.data,
+                                            sizeof(fingerprint.data));
+    } else {
+      peer_id += "/nocert";
+    }
+  }
   SECStatus rv = SSL_SetSockPeerID(nss_fd_, const_cast<char*>(peer_id.c_str()));
   if (rv != SECSuccess)
     LogFailedNSSFunction(net_log_, "SSL_SetSockPeerID", peer_id.c_str());
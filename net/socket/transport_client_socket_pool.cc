@@ -29,8 +29,13 @@ namespace net {
 // don't synchronize.
 const int TransportConnectJob::kIPv6FallbackTimerInMs = 300;
 
+const int TransportConnectJob::kIPv4PreferredHostTimeoutInSeconds = 10 * 60;
+
 namespace {
 
+// The number of hosts a pool remembers as preferring IPv4.
+const size_t kMaxIPv4PreferredHosts = 256;
+
 bool AddressListStartsWithIPv6AndHasAnIPv4Addr(const AddressList& addrlist) {
   const struct addrinfo* ai = addrlist.head();
   if (ai->ai_family != AF_INET6)
@@ -93,6 +98,7 @@ TransportConnectJob::TransportConnectJob(
     base::TimeDelta timeout_duration,
     ClientSocketFactory* client_socket_factory,
     HostResolver* host_resolver,
+    IPv4PreferredHosts* ipv4_preferred_hosts,
     Delegate* delegate,
     NetLog* net_log)
     : ConnectJob(group_name, timeout_duration, delegate,
@@ -100,6 +106,7 @@ TransportConnectJob::TransportConnectJob(
       params_(params),
       client_socket_factory_(client_socket_factory),
       resolver_(host_resolver),
+      ipv4_preferred_hosts_(ipv4_preferred_hosts),
       next_state_(STATE_NONE) {
 }
 
@@ -208,6 +215,13 @@ int TransportConnectJob::DoResolveHostComplete(int result) {
 
 int TransportConnectJob::DoTransportConnect() {
   next_state_ = STATE_TRANSPORT_CONNECT_COMPLETE;
+  // Don't race again on a host where IPv4 recently won; this also keeps the
+  // fallback timer from being started below.
+  if (ipv4_preferred_hosts_ &&
+      ipv4_preferred_hosts_->Get(params_->destination().hostname(),
+                                 base::TimeTicks::Now())) {
+    MakeAddrListStartWithIPv4(&addresses_);
+  }
   transport_socket_.reset(client_socket_factory_->CreateTransportClientSocket(
         addresses_, net_log().net_log(), net_log().source()));
   connect_start_time_ = base::TimeTicks::Now();
@@ -266,9 +280,14 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
     }
     set_socket(transport_socket_.release());
     fallback_timer_.Stop();
+  } else if (fallback_transport_socket_.get()) {
+    // The IPv4 connect is still running, so let it decide the result.
+    transport_socket_.reset();
+    next_state_ = STATE_TRANSPORT_CONNECT_COMPLETE;
+    return ERR_IO_PENDING;
   } else {
+    fallback_timer_.Stop();
     // Be a bit paranoid and kill off the fallback members to prevent reuse.
-    fallback_transport_socket_.reset();
     fallback_addresses_.reset();
   }
 
@@ -335,6 +354,11 @@ void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
         base::TimeDelta::FromMilliseconds(1),
         base::TimeDelta::FromMinutes(10),
         100);
+    if (ipv4_preferred_hosts_) {
+      ipv4_preferred_hosts_->Put(
+          params_->destination().hostname(), true, now,
+          base::TimeDelta::FromSeconds(kIPv4PreferredHostTimeoutInSeconds));
+    }
     set_socket(fallback_transport_socket_.release());
     next_state_ = STATE_NONE;
     transport_socket_.reset();
@@ -342,6 +366,9 @@ void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
     // Be a bit paranoid and kill off the fallback members to prevent reuse.
     fallback_transport_socket_.reset();
     fallback_addresses_.reset();
+    // Keep waiting for the IPv6 connect if it hasn't failed yet.
+    if (transport_socket_.get())
+      return;
   }
   NotifyDelegateOfCompletion(result);  // Deletes |this|
 }
@@ -362,6 +389,7 @@ ConnectJob*
                                  ConnectionTimeout(),
                                  client_socket_factory_,
                                  host_resolver_,
+                                 ipv4_preferred_hosts_,
                                  delegate,
                                  net_log_);
 }
@@ -379,11 +407,14 @@ TransportClientSocketPool::TransportClientSocketPool(
     HostResolver* host_resolver,
     ClientSocketFactory* client_socket_factory,
     NetLog* net_log)
-    : base_(max_sockets, max_sockets_per_group, histograms,
+    : ipv4_preferred_hosts_(kMaxIPv4PreferredHosts),
+      base_(max_sockets, max_sockets_per_group, histograms,
             ClientSocketPool::unused_idle_socket_timeout(),
             ClientSocketPool::used_idle_socket_timeout(),
             new TransportConnectJobFactory(client_socket_factory,
-                                     host_resolver, net_log)) {
+                                           host_resolver,
+                                           &ipv4_preferred_hosts_,
+                                           net_log)) {
   base_.EnableConnectBackupJobs();
 }
 
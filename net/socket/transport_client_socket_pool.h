@@ -13,6 +13,7 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
 #include "base/timer.h"
+#include "net/base/expiring_cache.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/host_resolver.h"
 #include "net/base/single_request_host_resolver.h"
@@ -55,13 +56,22 @@ class NET_EXPORT_PRIVATE TransportSocketParams
 // (kIPv6FallbackTimerInMs) and start a connect() to a IPv4 address if the timer
 // fires. Then we race the IPv4 connect() against the IPv6 connect() (which has
 // a headstart) and return the one that completes first to the socket pool.
+// The job only fails once both connects have failed. Hosts for which the IPv4
+// connect won are remembered for a while, and later jobs for them connect to
+// IPv4 first instead of racing.
 class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
  public:
+  // Maps the hostnames for which IPv4 won the race to true.
+  typedef ExpiringCache<std::string, bool> IPv4PreferredHosts;
+
+  // |ipv4_preferred_hosts| may be NULL, in which case nothing is remembered
+  // across jobs.
   TransportConnectJob(const std::string& group_name,
                       const scoped_refptr<TransportSocketParams>& params,
                       base::TimeDelta timeout_duration,
                       ClientSocketFactory* client_socket_factory,
                       HostResolver* host_resolver,
+                      IPv4PreferredHosts* ipv4_preferred_hosts,
                       Delegate* delegate,
                       NetLog* net_log);
   virtual ~TransportConnectJob();
@@ -78,6 +88,9 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
 
   static const int kIPv6FallbackTimerInMs;
 
+  // How long a host keeps connecting to IPv4 first after IPv4 won a race.
+  static const int kIPv4PreferredHostTimeoutInSeconds;
+
  private:
   enum State {
     STATE_RESOLVE_HOST,
@@ -109,6 +122,7 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   scoped_refptr<TransportSocketParams> params_;
   ClientSocketFactory* const client_socket_factory_;
   SingleRequestHostResolver resolver_;
+  IPv4PreferredHosts* const ipv4_preferred_hosts_;
   AddressList addresses_;
   State next_state_;
 
@@ -180,11 +194,14 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
   class TransportConnectJobFactory
       : public PoolBase::ConnectJobFactory {
    public:
-    TransportConnectJobFactory(ClientSocketFactory* client_socket_factory,
-                         HostResolver* host_resolver,
-                         NetLog* net_log)
+    TransportConnectJobFactory(
+        ClientSocketFactory* client_socket_factory,
+        HostResolver* host_resolver,
+        TransportConnectJob::IPv4PreferredHosts* ipv4_preferred_hosts,
+        NetLog* net_log)
         : client_socket_factory_(client_socket_factory),
           host_resolver_(host_resolver),
+          ipv4_preferred_hosts_(ipv4_preferred_hosts),
           net_log_(net_log) {}
 
     virtual ~TransportConnectJobFactory() {}
@@ -201,11 +218,16 @@ class NET_EXPORT_PRIVATE TransportClientSocketPool : public ClientSocketPool {
    private:
     ClientSocketFactory* const client_socket_factory_;
     HostResolver* const host_resolver_;
+    TransportConnectJob::IPv4PreferredHosts* const ipv4_preferred_hosts_;
     NetLog* net_log_;
 
     DISALLOW_COPY_AND_ASSIGN(TransportConnectJobFactory);
   };
 
+  // Shared by the connect jobs of this pool. Declared before |base_| so that
+  // it outlives the jobs.
+  TransportConnectJob::IPv4PreferredHosts ipv4_preferred_hosts_;
+
   PoolBase base_;
 
   DISALLOW_COPY_AND_ASSIGN(TransportClientSocketPool);
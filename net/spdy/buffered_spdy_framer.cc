@@ -257,6 +257,16 @@ SpdyControlFrame* BufferedSpdyFramer::CompressControlFrame(
   return spdy_framer_.CompressControlFrame(frame);
 }
 
+void BufferedSpdyFramer::SetHeaderCompressorParams(int level,
+                                                   int window_bits,
+                                                   int mem_level) {
+  spdy_framer_.SetHeaderCompressorParams(level, window_bits, mem_level);
+}
+
+size_t BufferedSpdyFramer::GetHeaderCompressionMemoryUsage() const {
+  return spdy_framer_.GetHeaderCompressionMemoryUsage();
+}
+
 // static
 void BufferedSpdyFramer::set_enable_compression_default(bool value) {
   g_enable_compression_default = value;
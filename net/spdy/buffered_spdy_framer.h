@@ -142,6 +142,8 @@ class NET_EXPORT_PRIVATE BufferedSpdyFramer
   SpdyPriority GetHighestPriority() const;
   bool IsCompressible(const SpdyFrame& frame) const;
   SpdyControlFrame* CompressControlFrame(const SpdyControlFrame& frame);
+  void SetHeaderCompressorParams(int level, int window_bits, int mem_level);
+  size_t GetHeaderCompressionMemoryUsage() const;
   // Specify if newly created SpdySessions should have compression enabled.
   static void set_enable_compression_default(bool value);
 
@@ -51,6 +51,34 @@ struct DictionaryIds {
 // initialized lazily to avoid static initializers.
 base::LazyInstance<DictionaryIds>::Leaky g_dictionary_ids;
 
+// The following compression setting are based on Brian Olson's analysis. See
+// https://groups.google.com/group/spdy-dev/browse_thread/thread/dfaf498542fac792
+// for more details.
+const int kCompressorLevel = 9;
+const int kCompressorWindowSizeInBits = 11;
+const int kCompressorMemLevel = 1;
+
+// zlib allocators that keep track of the memory held by a framer. |opaque|
+// points to the counter. The size of each block is stored in front of it,
+// in a header that keeps the block aligned.
+const size_t kZlibBlockHeaderSize = 16;
+
+voidpf ZlibAlloc(voidpf opaque, uInt items, uInt size) {
+  size_t bytes = static_cast<size_t>(items) * size;
+  char* block = new char[bytes + kZlibBlockHeaderSize];
+  *reinterpret_cast<size_t*>(block) = bytes;
+  *static_cast<size_t*>(opaque) += bytes;
+  return block + kZlibBlockHeaderSize;
+}
+
+void ZlibFree(voidpf opaque, voidpf address) {
+  char* block = static_cast<char*>(address) - kZlibBlockHeaderSize;
+  size_t* counter = static_cast<size_t*>(opaque);
+  DCHECK_GE(*counter, *reinterpret_cast<size_t*>(block));
+  *counter -= *reinterpret_cast<size_t*>(block);
+  delete[] block;
+}
+
 }  // namespace
 
 const int SpdyFramer::kMinSpdyVersion = 2;
@@ -127,6 +155,10 @@ SpdyFramer::SpdyFramer(int version)
       current_frame_buffer_(new char[kControlFrameBufferSize]),
       current_frame_len_(0),
       enable_compression_(true),
+      compressor_level_(kCompressorLevel),
+      compressor_window_bits_(kCompressorWindowSizeInBits),
+      compressor_mem_level_(kCompressorMemLevel),
+      header_compression_memory_(0),
       visitor_(NULL),
       display_protocol_("SPDY"),
       spdy_version_(version),
@@ -1245,25 +1277,21 @@ SpdyDataFrame* SpdyFramer::CreateDataFrame(SpdyStreamId stream_id,
   return reinterpret_cast<SpdyDataFrame*>(frame.take());
 }
 
-// The following compression setting are based on Brian Olson's analysis. See
-// https://groups.google.com/group/spdy-dev/browse_thread/thread/dfaf498542fac792
-// for more details.
-static const int kCompressorLevel = 9;
-static const int kCompressorWindowSizeInBits = 11;
-static const int kCompressorMemLevel = 1;
-
 z_stream* SpdyFramer::GetHeaderCompressor() {
   if (header_compressor_.get())
     return header_compressor_.get();  // Already initialized.
 
   header_compressor_.reset(new z_stream);
   memset(header_compressor_.get(), 0, sizeof(z_stream));
+  header_compressor_->zalloc = ZlibAlloc;
+  header_compressor_->zfree = ZlibFree;
+  header_compressor_->opaque = &header_compression_memory_;
 
   int success = deflateInit2(header_compressor_.get(),
-                             kCompressorLevel,
+                             compressor_level_,
                              Z_DEFLATED,
-                             kCompressorWindowSizeInBits,
-                             kCompressorMemLevel,
+                             compressor_window_bits_,
+                             compressor_mem_level_,
                              Z_DEFAULT_STRATEGY);
   if (success == Z_OK) {
     const char* dictionary = (spdy_version_ < 3) ? kV2Dictionary
@@ -1288,6 +1316,9 @@ z_stream* SpdyFramer::GetHeaderDecompressor() {
 
   header_decompressor_.reset(new z_stream);
   memset(header_decompressor_.get(), 0, sizeof(z_stream));
+  header_decompressor_->zalloc = ZlibAlloc;
+  header_decompressor_->zfree = ZlibFree;
+  header_decompressor_->opaque = &header_compression_memory_;
 
   int success = inflateInit(header_decompressor_.get());
   if (success != Z_OK) {
@@ -1627,4 +1658,12 @@ void SpdyFramer::set_enable_compression(bool value) {
   enable_compression_ = value;
 }
 
+void SpdyFramer::SetHeaderCompressorParams(int level, int window_bits,
+                                           int mem_level) {
+  DCHECK(!header_compressor_.get());
+  compressor_level_ = level;
+  compressor_window_bits_ = window_bits;
+  compressor_mem_level_ = mem_level;
+}
+
 }  // namespace net
@@ -402,6 +402,18 @@ class NET_EXPORT_PRIVATE SpdyFramer {
   // For ease of testing and experimentation we can tweak compression on/off.
   void set_enable_compression(bool value);
 
+  // Sets the zlib parameters of the header compressor. Smaller windows and
+  // memory levels make each session cheaper at the expense of larger header
+  // blocks. This has to be called before any header block is compressed; the
+  // peer does not need to know about it.
+  void SetHeaderCompressorParams(int level, int window_bits, int mem_level);
+
+  // Returns the number of bytes zlib currently holds for the header
+  // compression contexts of this framer.
+  size_t GetHeaderCompressionMemoryUsage() const {
+    return header_compression_memory_;
+  }
+
   // Used only in log messages.
   void set_display_protocol(const std::string& protocol) {
     display_protocol_ = protocol;
@@ -543,6 +555,10 @@ class NET_EXPORT_PRIVATE SpdyFramer {
   // SPDY header compressors.
   scoped_ptr<z_stream> header_compressor_;
   scoped_ptr<z_stream> header_decompressor_;
+  int compressor_level_;
+  int compressor_window_bits_;
+  int compressor_mem_level_;
+  size_t header_compression_memory_;  // Bytes allocated by zlib.
 
   SpdyFramerVisitorInterface* visitor_;
 
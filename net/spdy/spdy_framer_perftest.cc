@@ -0,0 +1,109 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "net/spdy/spdy_framer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kNumFrames = 20000;
+
+// Counts the frames, ignoring everything else.
+class CountingVisitor : public SpdyFramerVisitorInterface {
+ public:
+  CountingVisitor() : frames_(0), errors_(0) {}
+
+  virtual void OnError(SpdyFramer* framer) OVERRIDE { errors_++; }
+  virtual void OnControl(const SpdyControlFrame* frame) OVERRIDE {
+    frames_++;
+  }
+  virtual bool OnControlFrameHeaderData(SpdyStreamId stream_id,
+                                        const char* header_data,
+                                        size_t len) OVERRIDE {
+    return true;
+  }
+  virtual bool OnCredentialFrameData(const char* header_data,
+                                     size_t len) OVERRIDE {
+    return true;
+  }
+  virtual void OnDataFrameHeader(const SpdyDataFrame* frame) OVERRIDE {}
+  virtual void OnStreamFrameData(SpdyStreamId stream_id,
+                                 const char* data,
+                                 size_t len) OVERRIDE {}
+  virtual void OnSetting(SpdySettingsIds id, uint8 flags,
+                         uint32 value) OVERRIDE {}
+
+  int frames() const { return frames_; }
+  int errors() const { return errors_; }
+
+ private:
+  int frames_;
+  int errors_;
+};
+
+void SetRequestHeaders(int i, SpdyHeaderBlock* headers) {
+  (*headers)["method"] = "GET";
+  (*headers)["url"] = base::StringPrintf("http://www.google.com/%d.png", i);
+  (*headers)["version"] = "HTTP/1.1";
+  (*headers)["user-agent"] =
+      "Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/536.5 (KHTML, like Gecko)";
+  (*headers)["accept-encoding"] = "gzip,deflate,sdch";
+  (*headers)["cookie"] = "PREF=ID=1234567890abcdef:U=fedcba0987654321";
+}
+
+// Frames |kNumFrames| requests with the given compressor parameters, and
+// parses them back with another framer.
+void RunFramingTest(int version, int level, int window_bits, int mem_level) {
+  std::string suffix = base::StringPrintf("_v%d_%d_%d_%d", version, level,
+                                          window_bits, mem_level);
+  SpdyFramer framer(version);
+  framer.SetHeaderCompressorParams(level, window_bits, mem_level);
+  SpdyFramer peer(version);
+  CountingVisitor visitor;
+  peer.set_visitor(&visitor);
+
+  size_t total_size = 0;
+  PerfTimeLogger timer(("SpdyFramer_frame_requests" + suffix).c_str());
+  for (int i = 0; i < kNumFrames; i++) {
+    SpdyHeaderBlock headers;
+    SetRequestHeaders(i, &headers);
+    scoped_ptr<SpdySynStreamControlFrame> frame(framer.CreateSynStream(
+        i * 2 + 1, 0, 1, 0, CONTROL_FLAG_NONE, true, &headers));
+    size_t size = frame->length() + SpdyFrame::kHeaderSize;
+    total_size += size;
+    ASSERT_EQ(size, peer.ProcessInput(frame->data(), size));
+  }
+  timer.Done();
+  EXPECT_EQ(kNumFrames, visitor.frames());
+  EXPECT_EQ(0, visitor.errors());
+
+  LogPerfResult(("SpdyFramer_frame_size" + suffix).c_str(),
+                static_cast<double>(total_size) / kNumFrames, "bytes");
+  LogPerfResult(("SpdyFramer_compressor_memory" + suffix).c_str(),
+                framer.GetHeaderCompressionMemoryUsage(), "bytes");
+  LogPerfResult(("SpdyFramer_decompressor_memory" + suffix).c_str(),
+                peer.GetHeaderCompressionMemoryUsage(), "bytes");
+}
+
+}  // namespace
+
+TEST(SpdyFramerPerfTest, DefaultCompressor) {
+  RunFramingTest(2, 9, 11, 1);
+  RunFramingTest(3, 9, 11, 1);
+}
+
+TEST(SpdyFramerPerfTest, SmallCompressor) {
+  RunFramingTest(3, 9, 9, 1);
+}
+
+TEST(SpdyFramerPerfTest, ZlibDefaultCompressor) {
+  RunFramingTest(3, 9, 15, 8);
+}
+
+}  // namespace net
@@ -846,6 +846,40 @@ TEST_P(SpdyFramerTest, BasicCompression) {
       SpdyFrame::kHeaderSize + uncompressed_frame->length()));
 }
 
+TEST_P(SpdyFramerTest, HeaderCompressionMemoryUsage) {
+  SpdyHeaderBlock headers;
+  headers["method"] = "GET";
+  headers["url"] = "http://www.google.com/index.html";
+  headers["version"] = "HTTP/1.1";
+  headers["user-agent"] = "Mozilla/5.0 (X11; Linux x86_64)";
+
+  // Nothing is allocated until a header block is compressed.
+  SpdyFramer framer(spdy_version_);
+  EXPECT_EQ(0u, framer.GetHeaderCompressionMemoryUsage());
+  scoped_ptr<SpdySynStreamControlFrame> frame(
+      framer.CreateSynStream(1, 0, 1, 0, CONTROL_FLAG_NONE, true, &headers));
+  size_t default_usage = framer.GetHeaderCompressionMemoryUsage();
+  EXPECT_LT(0u, default_usage);
+
+  SpdyFramer small_framer(spdy_version_);
+  small_framer.SetHeaderCompressorParams(9, 9, 1);
+  scoped_ptr<SpdySynStreamControlFrame> small_frame(
+      small_framer.CreateSynStream(1, 0, 1, 0, CONTROL_FLAG_NONE, true,
+                                   &headers));
+  EXPECT_LT(small_framer.GetHeaderCompressionMemoryUsage(), default_usage);
+
+  // The peer does not care about the parameters.
+  SpdyFramer peer(spdy_version_);
+  scoped_ptr<SpdyFrame> decompressed(SpdyFramerTestUtil::DecompressFrame(
+      &peer, *small_frame.get()));
+  EXPECT_LT(0u, peer.GetHeaderCompressionMemoryUsage());
+  scoped_ptr<SpdySynStreamControlFrame> uncompressed(
+      framer.CreateSynStream(1, 0, 1, 0, CONTROL_FLAG_NONE, false, &headers));
+  ASSERT_EQ(uncompressed->length(), decompressed->length());
+  EXPECT_EQ(0, memcmp(uncompressed->data(), decompressed->data(),
+                      SpdyFrame::kHeaderSize + uncompressed->length()));
+}
+
 TEST_P(SpdyFramerTest, Basic) {
   const unsigned char kV2Input[] = {
     0x80, spdy_version_, 0x00, 0x01,  // SYN Stream #1
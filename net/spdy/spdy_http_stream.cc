@@ -113,20 +113,14 @@ int SpdyHttpStream::ReadResponseBody(
   if (!response_body_.empty()) {
     int bytes_read = 0;
     while (!response_body_.empty() && buf_len > 0) {
-      scoped_refptr<IOBufferWithSize> data = response_body_.front();
-      const int bytes_to_copy = std::min(buf_len, data->size());
+      DrainableIOBuffer* data = response_body_.front();
+      const int bytes_to_copy = std::min(buf_len, data->BytesRemaining());
       memcpy(&(buf->data()[bytes_read]), data->data(), bytes_to_copy);
       buf_len -= bytes_to_copy;
-      if (bytes_to_copy == data->size()) {
+      if (bytes_to_copy == data->BytesRemaining())
         response_body_.pop_front();
-      } else {
-        const int bytes_remaining = data->size() - bytes_to_copy;
-        IOBufferWithSize* new_buffer = new IOBufferWithSize(bytes_remaining);
-        memcpy(new_buffer->data(), &(data->data()[bytes_to_copy]),
-               bytes_remaining);
-        response_body_.pop_front();
-        response_body_.push_front(make_scoped_refptr(new_buffer));
-      }
+      else
+        data->DidConsume(bytes_to_copy);
       bytes_read += bytes_to_copy;
     }
     stream_->IncreaseRecvWindowSize(bytes_read);
@@ -377,6 +371,16 @@ int SpdyHttpStream::OnResponseReceived(const SpdyHeaderBlock& response,
 }
 
 void SpdyHttpStream::OnDataReceived(const char* data, int length) {
+  if (length <= 0) {
+    OnDataBufferReceived(NULL);
+    return;
+  }
+  scoped_refptr<IOBuffer> io_buffer(new IOBuffer(length));
+  memcpy(io_buffer->data(), data, length);
+  OnDataBufferReceived(new DrainableIOBuffer(io_buffer, length));
+}
+
+void SpdyHttpStream::OnDataBufferReceived(DrainableIOBuffer* buffer) {
   // SpdyStream won't call us with data if the header block didn't contain a
   // valid set of headers.  So we don't expect to not have headers received
   // here.
@@ -386,11 +390,10 @@ void SpdyHttpStream::OnDataReceived(const char* data, int length) {
   // ReadResponseBody(), therefore user_buffer_ may be NULL.  This may often
   // happen for server initiated streams.
   DCHECK(!stream_->closed() || stream_->pushed());
-  if (length > 0) {
-    // Save the received data.
-    IOBufferWithSize* io_buffer = new IOBufferWithSize(length);
-    memcpy(io_buffer->data(), data, length);
-    response_body_.push_back(make_scoped_refptr(io_buffer));
+  if (buffer && buffer->BytesRemaining() > 0) {
+    // Save the received data.  The buffer is usually a slice of the
+    // session's read buffer, which is kept until the data is read.
+    response_body_.push_back(make_scoped_refptr(buffer));
 
     if (user_buffer_) {
       // Handing small chunks of data to the caller creates measurable overhead.
@@ -442,11 +445,11 @@ bool SpdyHttpStream::ShouldWaitForMoreBufferedData() const {
     return false;
 
   int bytes_buffered = 0;
-  std::list<scoped_refptr<IOBufferWithSize> >::const_iterator it;
+  std::list<scoped_refptr<DrainableIOBuffer> >::const_iterator it;
   for (it = response_body_.begin();
        it != response_body_.end() && bytes_buffered < user_buffer_len_;
        ++it)
-    bytes_buffered += (*it)->size();
+    bytes_buffered += (*it)->BytesRemaining();
 
   return bytes_buffered < user_buffer_len_;
 }
@@ -81,6 +81,7 @@ class NET_EXPORT_PRIVATE SpdyHttpStream : public SpdyStream::Delegate,
                                  base::Time response_time,
                                  int status) OVERRIDE;
   virtual void OnDataReceived(const char* buffer, int bytes) OVERRIDE;
+  virtual void OnDataBufferReceived(DrainableIOBuffer* buffer) OVERRIDE;
   virtual void OnDataSent(int length) OVERRIDE;
   virtual void OnClose(int status) OVERRIDE;
   virtual void set_chunk_callback(ChunkCallback* callback) OVERRIDE;
@@ -125,7 +126,7 @@ class NET_EXPORT_PRIVATE SpdyHttpStream : public SpdyStream::Delegate,
 
   // We buffer the response body as it arrives asynchronously from the stream.
   // TODO(mbelshe):  is this infinite buffering?
-  std::list<scoped_refptr<IOBufferWithSize> > response_body_;
+  std::list<scoped_refptr<DrainableIOBuffer> > response_body_;
 
   CompletionCallback callback_;
 
@@ -10,14 +10,17 @@ namespace net {
 // static
 uint64 SpdyIOBuffer::order_ = 0;
 
-SpdyIOBuffer::SpdyIOBuffer(
-    IOBuffer* buffer, int size, RequestPriority priority, SpdyStream* stream)
+SpdyIOBuffer::SpdyIOBuffer(IOBuffer* buffer, int size,
+                           RequestPriority priority, uint64 round,
+                           SpdyStream* stream)
   : buffer_(new DrainableIOBuffer(buffer, size)),
     priority_(priority),
+    round_(round),
     position_(++order_),
     stream_(stream) {}
 
-SpdyIOBuffer::SpdyIOBuffer() : priority_(HIGHEST), position_(0), stream_(NULL) {
+SpdyIOBuffer::SpdyIOBuffer()
+    : priority_(HIGHEST), round_(0), position_(0), stream_(NULL) {
 }
 
 SpdyIOBuffer::~SpdyIOBuffer() {}
@@ -23,9 +23,10 @@ class NET_EXPORT_PRIVATE SpdyIOBuffer {
   // |buffer| is the actual data buffer.
   // |size| is the size of the data buffer.
   // |priority| is the priority of this buffer.
+  // |round| is the scheduling round of this buffer within its priority.
   // |stream| is a pointer to the stream which is managing this buffer.
   SpdyIOBuffer(IOBuffer* buffer, int size, RequestPriority priority,
-               SpdyStream* stream);
+               uint64 round, SpdyStream* stream);
   SpdyIOBuffer();
   ~SpdyIOBuffer();
 
@@ -34,18 +35,23 @@ class NET_EXPORT_PRIVATE SpdyIOBuffer {
   size_t size() const { return buffer_->size(); }
   void release();
   RequestPriority priority() const { return priority_; }
+  uint64 round() const { return round_; }
   const scoped_refptr<SpdyStream>& stream() const { return stream_; }
 
-  // Comparison operator to support sorting.
+  // Comparison operator to support sorting.  Buffers are sent by priority,
+  // then by round, then in FIFO order.
   bool operator<(const SpdyIOBuffer& other) const {
     if (priority_ != other.priority_)
       return priority_ < other.priority_;
+    if (round_ != other.round_)
+      return round_ > other.round_;
     return position_ > other.position_;
   }
 
  private:
   scoped_refptr<DrainableIOBuffer> buffer_;
   RequestPriority priority_;
+  uint64 round_;
   uint64 position_;
   scoped_refptr<SpdyStream> stream_;
   static uint64 order_;  // Maintains a FIFO order for equal priorities.
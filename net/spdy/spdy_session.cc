@@ -25,6 +25,7 @@
 #include "crypto/signature_creator.h"
 #include "net/base/asn1_util.h"
 #include "net/base/connection_type_histograms.h"
+#include "net/base/io_buffer_pool.h"
 #include "net/base/net_log.h"
 #include "net/base/net_util.h"
 #include "net/base/server_bound_cert_service.h"
@@ -106,6 +107,19 @@ const int kDefaultConnectionAtRiskOfLossSeconds = 10;
 const int kTrailingPingDelayTimeSeconds = 1;
 const int kHungIntervalSeconds = 10;
 
+// Unclaimed pushed streams are kept, with their data, until the session
+// closes. Pushes beyond this many unclaimed streams are refused.
+const size_t kMaxUnclaimedPushedStreams = 100;
+
+// Header compressor settings for a session with the trusted SPDY proxy,
+// which are zlib's defaults. That one session carries the requests for every
+// origin, so its headers repeat more and a bigger window pays for itself.
+// Sessions with origin servers keep SpdyFramer's low-memory settings, since
+// there can be many of them.
+const int kProxyCompressorLevel = 9;
+const int kProxyCompressorWindowBits = 15;
+const int kProxyCompressorMemLevel = 8;
+
 class NetLogSpdySessionParameter : public NetLog::EventParameters {
  public:
   NetLogSpdySessionParameter(const HostPortProxyPair& host_pair)
@@ -346,7 +360,7 @@ SpdySession::SpdySession(const HostPortProxyPair& host_port_proxy_pair,
       spdy_session_pool_(spdy_session_pool),
       http_server_properties_(http_server_properties),
       connection_(new ClientSocketHandle),
-      read_buffer_(new IOBuffer(kReadBufferSize)),
+      read_buffer_(new PooledIOBuffer(kReadBufferSize)),
       read_pending_(false),
       stream_hi_water_mark_(1),  // Always start at 1 for the first stream id.
       write_pending_(false),
@@ -360,6 +374,7 @@ SpdySession::SpdySession(const HostPortProxyPair& host_port_proxy_pair,
       streams_pushed_count_(0),
       streams_pushed_and_claimed_count_(0),
       streams_abandoned_count_(0),
+      streams_pushed_refused_count_(0),
       bytes_received_(0),
       sent_settings_(false),
       received_settings_(false),
@@ -388,6 +403,7 @@ SpdySession::SpdySession(const HostPortProxyPair& host_port_proxy_pair,
       NetLog::TYPE_SPDY_SESSION,
       make_scoped_refptr(
           new NetLogSpdySessionParameter(host_port_proxy_pair_)));
+  memset(write_rounds_, 0, sizeof(write_rounds_));
   // TODO(mbelshe): consider randomization of the stream_hi_water_mark.
 }
 
@@ -452,6 +468,11 @@ net::Error SpdySession::InitializeWithSocket(
 
   buffered_spdy_framer_.reset(new BufferedSpdyFramer(version));
   buffered_spdy_framer_->set_visitor(this);
+  if (trusted_spdy_proxy_.Equals(host_port_pair())) {
+    buffered_spdy_framer_->SetHeaderCompressorParams(
+        kProxyCompressorLevel, kProxyCompressorWindowBits,
+        kProxyCompressorMemLevel);
+  }
   SendSettings();
 
   // Write out any data that we might have to send, such as the settings frame.
@@ -834,11 +855,15 @@ void SpdySession::ResetStream(SpdyStreamId stream_id,
 
   // Default to lowest priority unless we know otherwise.
   RequestPriority priority = net::IDLE;
+  uint64 round = write_rounds_[priority];
   if(IsStreamActive(stream_id)) {
     scoped_refptr<SpdyStream> stream = active_streams_[stream_id];
     priority = stream->priority();
+    // The reset must not overtake the frames the stream has already queued.
+    round = std::max(write_rounds_[priority], stream->write_round()) + 1;
+    stream->set_write_round(round);
   }
-  QueueFrame(rst_frame.get(), priority, NULL);
+  QueueFrameInRound(rst_frame.get(), priority, round, NULL);
   RecordProtocolErrorHistogram(
       static_cast<SpdyProtocolErrorDetails>(status + STATUS_CODE_INVALID));
   DeleteStream(stream_id, ERR_SPDY_PROTOCOL_ERROR);
@@ -968,6 +993,10 @@ net::Error SpdySession::ReadSocket() {
 
   CHECK(connection_.get());
   CHECK(connection_->socket());
+  // Streams may hold on to slices of the last read instead of copying the
+  // DATA frames out of it, in which case the next read needs a new buffer.
+  if (!read_buffer_->HasOneRef())
+    read_buffer_ = new PooledIOBuffer(kReadBufferSize);
   int bytes_read = connection_->socket()->Read(
       read_buffer_.get(),
       kReadBufferSize,
@@ -1030,6 +1059,7 @@ void SpdySession::WriteSocket() {
       // Grab the next SpdyFrame to send.
       SpdyIOBuffer next_buffer = queue_.top();
       queue_.pop();
+      write_rounds_[next_buffer.priority()] = next_buffer.round();
 
       // We've deferred compression until just before we write it to the socket,
       // which is now.  At this time, we don't compress our data frames.
@@ -1053,11 +1083,11 @@ void SpdySession::WriteSocket() {
         DCHECK_GT(size, 0u);
 
         // TODO(mbelshe): We have too much copying of data here.
-        IOBufferWithSize* buffer = new IOBufferWithSize(size);
+        IOBufferWithSize* buffer = new PooledIOBuffer(size);
         memcpy(buffer->data(), compressed_frame->data(), size);
 
         // Attempt to send the frame.
-        in_flight_write_ = SpdyIOBuffer(buffer, size, HIGHEST,
+        in_flight_write_ = SpdyIOBuffer(buffer, size, HIGHEST, 0,
                                         next_buffer.stream());
       } else {
         size = uncompressed_frame.length() + SpdyFrame::kHeaderSize;
@@ -1119,6 +1149,7 @@ void SpdySession::CloseAllStreams(net::Error status) {
   // We also need to drain the queue.
   while (queue_.size())
     queue_.pop();
+  memset(write_rounds_, 0, sizeof(write_rounds_));
 }
 
 int SpdySession::GetNewStreamId() {
@@ -1132,10 +1163,22 @@ int SpdySession::GetNewStreamId() {
 void SpdySession::QueueFrame(SpdyFrame* frame,
                              RequestPriority priority,
                              SpdyStream* stream) {
+  uint64 round = write_rounds_[priority];
+  if (stream) {
+    round = std::max(round, stream->write_round()) + 1;
+    stream->set_write_round(round);
+  }
+  QueueFrameInRound(frame, priority, round, stream);
+}
+
+void SpdySession::QueueFrameInRound(SpdyFrame* frame,
+                                    RequestPriority priority,
+                                    uint64 round,
+                                    SpdyStream* stream) {
   int length = SpdyFrame::kHeaderSize + frame->length();
-  IOBuffer* buffer = new IOBuffer(length);
+  IOBuffer* buffer = new PooledIOBuffer(length);
   memcpy(buffer->data(), frame->data(), length);
-  queue_.push(SpdyIOBuffer(buffer, length, priority, stream));
+  queue_.push(SpdyIOBuffer(buffer, length, priority, round, stream));
 
   WriteSocketLater();
 }
@@ -1152,6 +1195,10 @@ void SpdySession::CloseSessionOnError(net::Error err,
       NetLog::TYPE_SPDY_SESSION_CLOSE,
       make_scoped_refptr(
           new NetLogSpdySessionCloseParameter(err, description)));
+  if (net_log_.IsLoggingAllEvents()) {
+    net_log_.AddEvent(NetLog::TYPE_IO_BUFFER_POOL_STATS,
+                      make_scoped_refptr(new IOBufferPool::StatsParameters()));
+  }
 
   // Don't close twice.  This can occur because we can have both
   // a read and a write outstanding, and each can complete with
@@ -1204,6 +1251,8 @@ Value* SpdySession::GetInfoAsValue() const {
   dict->SetInteger("streams_pushed_and_claimed_count",
       streams_pushed_and_claimed_count_);
   dict->SetInteger("streams_abandoned_count", streams_abandoned_count_);
+  dict->SetInteger("streams_pushed_refused_count",
+      streams_pushed_refused_count_);
   DCHECK(buffered_spdy_framer_.get());
   dict->SetInteger("frames_received", buffered_spdy_framer_->frames_received());
 
@@ -1353,6 +1402,17 @@ void SpdySession::OnStreamFrameData(SpdyStreamId stream_id,
   }
 
   scoped_refptr<SpdyStream> stream = active_streams_[stream_id];
+  const char* read_data = read_buffer_->data();
+  if (len && data >= read_data && data + len <= read_data + kReadBufferSize) {
+    // The payload is still in the read buffer, so hand the stream a view of
+    // it rather than a copy.
+    int offset = data - read_data;
+    scoped_refptr<DrainableIOBuffer> buffer(
+        new DrainableIOBuffer(read_buffer_, offset + len));
+    buffer->SetOffset(offset);
+    stream->OnDataBufferReceived(buffer);
+    return;
+  }
   stream->OnDataReceived(data, len);
 }
 
@@ -1420,6 +1480,13 @@ void SpdySession::OnSynStream(
     return;
   }
 
+  if (unclaimed_pushed_streams_.size() >= kMaxUnclaimedPushedStreams) {
+    streams_pushed_refused_count_++;
+    ResetStream(stream_id, REFUSED_STREAM,
+                "Too many unclaimed pushed streams");
+    return;
+  }
+
   streams_pushed_count_++;
 
   // TODO(mbelshe): DCHECK that this is a GET method?
@@ -1908,6 +1975,15 @@ void SpdySession::RecordHistograms() {
   UMA_HISTOGRAM_CUSTOM_COUNTS("Net.SpdyStreamsAbandonedPerSession",
                               streams_abandoned_count_,
                               0, 300, 50);
+  UMA_HISTOGRAM_CUSTOM_COUNTS("Net.SpdyStreamsPushedRefusedPerSession",
+                              streams_pushed_refused_count_,
+                              0, 300, 50);
+  if (streams_pushed_count_ > 0) {
+    // The share of pushed streams that were used, to tune push strategies.
+    UMA_HISTOGRAM_PERCENTAGE(
+        "Net.SpdyPushedStreamsClaimedPercent",
+        streams_pushed_and_claimed_count_ * 100 / streams_pushed_count_);
+  }
   UMA_HISTOGRAM_ENUMERATION("Net.SpdySettingsSent",
                             sent_settings_ ? 1 : 0, 2);
   UMA_HISTOGRAM_ENUMERATION("Net.SpdySettingsReceived",
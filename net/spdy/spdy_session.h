@@ -325,9 +325,11 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
   FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy2Test, Ping);
   FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy2Test, FailedPing);
   FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy2Test, GetActivePushStream);
+  FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy2Test, ProxyCompressorParams);
   FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy3Test, Ping);
   FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy3Test, FailedPing);
   FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy3Test, GetActivePushStream);
+  FRIEND_TEST_ALL_PREFIXES(SpdySessionSpdy3Test, ProxyCompressorParams);
 
   struct PendingCreateStream {
     PendingCreateStream(const GURL& url, RequestPriority priority,
@@ -441,6 +443,10 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
   void QueueFrame(SpdyFrame* frame, RequestPriority priority,
                   SpdyStream* stream);
 
+  // Queue a frame for sending in the given scheduling |round| of |priority|.
+  void QueueFrameInRound(SpdyFrame* frame, RequestPriority priority,
+                         uint64 round, SpdyStream* stream);
+
   // Track active streams in the active stream list.
   void ActivateStream(SpdyStream* stream);
   void DeleteStream(SpdyStreamId id, int status);
@@ -576,6 +582,12 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
   // As we gather data to be sent, we put it into the output queue.
   OutputQueue queue_;
 
+  // The round of the last frame taken off |queue_|, for each priority.  A
+  // stream's frames are queued one round apart, so streams of the same
+  // priority take turns sending instead of one stream's frames going out back
+  // to back.  Frames without a stream go in the current round.
+  uint64 write_rounds_[NUM_PRIORITIES];
+
   // The packet we are currently sending.
   bool write_pending_;            // Will be true when a write is in progress.
   SpdyIOBuffer in_flight_write_;  // This is the write buffer in progress.
@@ -606,6 +618,7 @@ class NET_EXPORT SpdySession : public base::RefCounted<SpdySession>,
   int streams_pushed_count_;
   int streams_pushed_and_claimed_count_;
   int streams_abandoned_count_;
+  int streams_pushed_refused_count_;
   int bytes_received_;
   bool sent_settings_;      // Did this session send settings when it started.
   bool received_settings_;  // Did this session receive at least one settings
@@ -80,6 +80,7 @@ TEST_F(SpdySessionSpdy2Test, SpdyIOBuffer) {
         new IOBufferWithSize(index + 1),
         index + 1,
         static_cast<RequestPriority>(rand() % NUM_PRIORITIES),
+        0,
         NULL));
   }
 
@@ -102,6 +103,29 @@ TEST_F(SpdySessionSpdy2Test, SpdyIOBuffer) {
   EXPECT_EQ(0u, queue_.size());
 }
 
+// Within a priority, buffers of earlier rounds are sent first, so streams
+// with frames queued one round apart take turns.
+TEST_F(SpdySessionSpdy2Test, SpdyIOBufferRounds) {
+  std::priority_queue<SpdyIOBuffer> queue;
+
+  // Three frames from one stream, then two from another, then a frame
+  // without a stream in the current round.
+  const uint64 kRounds[] = { 1, 2, 3, 1, 2, 0 };
+  for (size_t index = 0; index < arraysize(kRounds); ++index) {
+    queue.push(SpdyIOBuffer(new IOBufferWithSize(index + 1), index + 1,
+                            LOW, kRounds[index], NULL));
+  }
+  queue.push(SpdyIOBuffer(new IOBufferWithSize(7), 7, HIGHEST, 5, NULL));
+
+  const size_t kExpectedSizes[] = { 7, 6, 1, 4, 2, 5, 3 };
+  for (size_t index = 0; index < arraysize(kExpectedSizes); ++index) {
+    ASSERT_FALSE(queue.empty());
+    EXPECT_EQ(kExpectedSizes[index], queue.top().size());
+    queue.pop();
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
 TEST_F(SpdySessionSpdy2Test, GoAway) {
   SpdySessionDependencies session_deps;
   session_deps.host_resolver->set_synchronous_mode(true);
@@ -669,6 +693,64 @@ TEST_F(SpdySessionSpdy2Test, CancelPendingCreateStream) {
   MessageLoop::current()->RunAllPending();
 }
 
+// A session with the trusted SPDY proxy gets a bigger header compressor
+// than a session with an origin server.
+TEST_F(SpdySessionSpdy2Test, ProxyCompressorParams) {
+  SpdySessionDependencies session_deps;
+  session_deps.host_resolver->set_synchronous_mode(true);
+  session_deps.trusted_spdy_proxy = "www.proxy.com:443";
+
+  MockConnect connect_data(SYNCHRONOUS, OK);
+  MockRead reads[] = {
+    MockRead(SYNCHRONOUS, ERR_IO_PENDING)  // Stall forever.
+  };
+  StaticSocketDataProvider origin_data(reads, arraysize(reads), NULL, 0);
+  origin_data.set_connect_data(connect_data);
+  session_deps.socket_factory->AddSocketDataProvider(&origin_data);
+  StaticSocketDataProvider proxy_data(reads, arraysize(reads), NULL, 0);
+  proxy_data.set_connect_data(connect_data);
+  session_deps.socket_factory->AddSocketDataProvider(&proxy_data);
+
+  scoped_refptr<HttpNetworkSession> http_session(
+      SpdySessionDependencies::SpdyCreateSession(&session_deps));
+  SpdySessionPool* spdy_session_pool(http_session->spdy_session_pool());
+
+  SpdyHeaderBlock headers;
+  headers["url"] = "http://www.foo.com/";
+  headers["user-agent"] = "Mozilla/5.0";
+
+  // The memory each session's header compressor holds once it has
+  // compressed the same header block.
+  const char* const kHosts[] = { "www.foo.com:80", "www.proxy.com:443" };
+  size_t memory_usage[arraysize(kHosts)];
+  for (size_t i = 0; i < arraysize(kHosts); ++i) {
+    HostPortPair host_port_pair = HostPortPair::FromString(kHosts[i]);
+    HostPortProxyPair pair(host_port_pair, ProxyServer::Direct());
+    scoped_refptr<SpdySession> session =
+        spdy_session_pool->Get(pair, BoundNetLog());
+
+    scoped_refptr<TransportSocketParams> transport_params(
+        new TransportSocketParams(host_port_pair, MEDIUM, false, false));
+    scoped_ptr<ClientSocketHandle> connection(new ClientSocketHandle);
+    EXPECT_EQ(OK, connection->Init(host_port_pair.ToString(),
+                                   transport_params, MEDIUM,
+                                   CompletionCallback(),
+                                   http_session->GetTransportSocketPool(
+                                       HttpNetworkSession::NORMAL_SOCKET_POOL),
+                                   BoundNetLog()));
+    EXPECT_EQ(OK,
+              session->InitializeWithSocket(connection.release(), false, OK));
+
+    scoped_ptr<SpdySynStreamControlFrame> frame(
+        session->buffered_spdy_framer_->CreateSynStream(
+            1, 0, 0, 0, CONTROL_FLAG_NONE, true, &headers));
+    memory_usage[i] =
+        session->buffered_spdy_framer_->GetHeaderCompressionMemoryUsage();
+  }
+  EXPECT_LT(0u, memory_usage[0]);
+  EXPECT_LT(memory_usage[0], memory_usage[1]);
+}
+
 TEST_F(SpdySessionSpdy2Test, SendSettingsOnNewSession) {
   SpdySessionDependencies session_deps;
   session_deps.host_resolver->set_synchronous_mode(true);
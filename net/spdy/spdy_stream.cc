@@ -71,6 +71,13 @@ bool ContainsUpperAscii(const std::string& str) {
 
 }  // namespace
 
+void SpdyStream::Delegate::OnDataBufferReceived(DrainableIOBuffer* buffer) {
+  if (buffer)
+    OnDataReceived(buffer->data(), buffer->BytesRemaining());
+  else
+    OnDataReceived(NULL, 0);
+}
+
 SpdyStream::SpdyStream(SpdySession* session,
                        SpdyStreamId stream_id,
                        bool pushed,
@@ -78,6 +85,7 @@ SpdyStream::SpdyStream(SpdySession* session,
     : continue_buffering_data_(true),
       stream_id_(stream_id),
       priority_(HIGHEST),
+      write_round_(0),
       slot_(0),
       stalled_by_flow_control_(false),
       send_window_size_(kSpdyStreamInitialWindowSize),
@@ -131,7 +139,7 @@ void SpdyStream::PushedStreamReplayData() {
     return;
   }
 
-  std::vector<scoped_refptr<IOBufferWithSize> > buffers;
+  std::vector<scoped_refptr<DrainableIOBuffer> > buffers;
   buffers.swap(pending_buffers_);
   for (size_t i = 0; i < buffers.size(); ++i) {
     // It is always possible that a callback to the delegate results in
@@ -139,7 +147,7 @@ void SpdyStream::PushedStreamReplayData() {
     if (!delegate_)
       break;
     if (buffers[i]) {
-      delegate_->OnDataReceived(buffers[i]->data(), buffers[i]->size());
+      delegate_->OnDataBufferReceived(buffers[i]);
     } else {
       delegate_->OnDataReceived(NULL, 0);
       session_->CloseStream(stream_id_, net::OK);
@@ -392,6 +400,21 @@ int SpdyStream::OnHeaders(const SpdyHeaderBlock& headers) {
 
 void SpdyStream::OnDataReceived(const char* data, int length) {
   DCHECK_GE(length, 0);
+  if (!length) {
+    OnDataBufferReceived(NULL);
+    return;
+  }
+
+  scoped_refptr<IOBuffer> copy(new IOBuffer(length));
+  memcpy(copy->data(), data, length);
+  OnDataBufferReceived(new DrainableIOBuffer(copy, length));
+}
+
+void SpdyStream::OnDataBufferReceived(DrainableIOBuffer* buffer) {
+  // Keep |buffer| alive if nobody else has taken a reference to it.
+  scoped_refptr<DrainableIOBuffer> buffer_ref(buffer);
+  int length = buffer ? buffer->BytesRemaining() : 0;
+  DCHECK(!buffer || length > 0);
 
   // If we don't have a response, then the SYN_REPLY did not come through.
   // We cannot pass data up to the caller unless the reply headers have been
@@ -405,12 +428,8 @@ void SpdyStream::OnDataReceived(const char* data, int length) {
   if (!delegate_ || continue_buffering_data_) {
     // It should be valid for this to happen in the server push case.
     // We'll return received data when delegate gets attached to the stream.
-    if (length > 0) {
-      IOBufferWithSize* buf = new IOBufferWithSize(length);
-      memcpy(buf->data(), data, length);
-      pending_buffers_.push_back(make_scoped_refptr(buf));
-    } else {
-      pending_buffers_.push_back(NULL);
+    pending_buffers_.push_back(buffer_ref);
+    if (!length) {
       metrics_.StopStream();
       // Note: we leave the stream open in the session until the stream
       //       is claimed.
@@ -438,13 +457,11 @@ void SpdyStream::OnDataReceived(const char* data, int length) {
   if (!delegate_) {
     // It should be valid for this to happen in the server push case.
     // We'll return received data when delegate gets attached to the stream.
-    IOBufferWithSize* buf = new IOBufferWithSize(length);
-    memcpy(buf->data(), data, length);
-    pending_buffers_.push_back(make_scoped_refptr(buf));
+    pending_buffers_.push_back(buffer_ref);
     return;
   }
 
-  delegate_->OnDataReceived(data, length);
+  delegate_->OnDataBufferReceived(buffer);
 }
 
 // This function is only called when an entire frame is written.
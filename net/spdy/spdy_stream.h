@@ -77,6 +77,11 @@ class NET_EXPORT_PRIVATE SpdyStream
     // Called when data is received.
     virtual void OnDataReceived(const char* data, int length) = 0;
 
+    // Called when data is received in the unconsumed part of |buffer|. The
+    // delegate may keep a reference to |buffer| instead of copying the data
+    // out of it. The default implementation calls OnDataReceived().
+    virtual void OnDataBufferReceived(DrainableIOBuffer* buffer);
+
     // Called when data is sent.
     virtual void OnDataSent(int length) = 0;
 
@@ -126,6 +131,11 @@ class NET_EXPORT_PRIVATE SpdyStream
   RequestPriority priority() const { return priority_; }
   void set_priority(RequestPriority priority) { priority_ = priority; }
 
+  // The SpdySession's scheduling round of the last frame queued for this
+  // stream.
+  uint64 write_round() const { return write_round_; }
+  void set_write_round(uint64 round) { write_round_ = round; }
+
   int32 send_window_size() const { return send_window_size_; }
   void set_send_window_size(int32 window_size) {
     send_window_size_ = window_size;
@@ -199,6 +209,11 @@ class NET_EXPORT_PRIVATE SpdyStream
   //         A zero-length count does not indicate end-of-stream.
   void OnDataReceived(const char* buffer, int bytes);
 
+  // Like OnDataReceived(), but the data is the unconsumed part of |buffer|,
+  // which the stream and its delegate may keep instead of copying.
+  // |buffer| is NULL at the end of the stream.
+  void OnDataBufferReceived(DrainableIOBuffer* buffer);
+
   // Called by the SpdySession when a write has completed.  This callback
   // will be called multiple times for each write which completes.  Writes
   // include the SYN_STREAM write and also DATA frame writes.
@@ -317,6 +332,7 @@ class NET_EXPORT_PRIVATE SpdyStream
   SpdyStreamId stream_id_;
   std::string path_;
   RequestPriority priority_;
+  uint64 write_round_;
   size_t slot_;
 
   // Flow control variables.
@@ -361,7 +377,7 @@ class NET_EXPORT_PRIVATE SpdyStream
   int send_bytes_;
   int recv_bytes_;
   // Data received before delegate is attached.
-  std::vector<scoped_refptr<IOBufferWithSize> > pending_buffers_;
+  std::vector<scoped_refptr<DrainableIOBuffer> > pending_buffers_;
 
   SSLClientCertType domain_bound_cert_type_;
   std::string domain_bound_private_key_;
@@ -92,6 +92,31 @@ class TestSpdyStreamDelegate : public SpdyStream::Delegate {
   bool closed_;
 };
 
+// Keeps the buffers it is handed instead of copying the data out of them.
+class BufferKeepingDelegate : public TestSpdyStreamDelegate {
+ public:
+  BufferKeepingDelegate()
+      : TestSpdyStreamDelegate(NULL, NULL, CompletionCallback()) {}
+  virtual ~BufferKeepingDelegate() {}
+
+  virtual int OnResponseReceived(const SpdyHeaderBlock& response,
+                                 base::Time response_time,
+                                 int status) OVERRIDE {
+    return status;
+  }
+  virtual void OnDataBufferReceived(DrainableIOBuffer* buffer) OVERRIDE {
+    buffers_.push_back(make_scoped_refptr(buffer));
+  }
+  virtual void OnClose(int status) OVERRIDE {}
+
+  const std::vector<scoped_refptr<DrainableIOBuffer> >& buffers() const {
+    return buffers_;
+  }
+
+ private:
+  std::vector<scoped_refptr<DrainableIOBuffer> > buffers_;
+};
+
 SpdyFrame* ConstructSpdyBodyFrame(const char* data, int length) {
   BufferedSpdyFramer framer(3);
   return framer.CreateDataFrame(1, data, length, DATA_FLAG_NONE);
@@ -242,6 +267,109 @@ TEST_F(SpdyStreamSpdy3Test, SendDataAfterOpen) {
   EXPECT_TRUE(delegate->closed());
 }
 
+// A RST_STREAM queued while the stream still has frames waiting to be written
+// goes out after them.
+TEST_F(SpdyStreamSpdy3Test, ResetAfterQueuedData) {
+  SpdySessionDependencies session_deps;
+
+  session_ = SpdySessionDependencies::SpdyCreateSession(&session_deps);
+  SpdySessionPoolPeer pool_peer_(session_->spdy_session_pool());
+
+  const SpdyHeaderInfo kSynStartHeader = {
+    SYN_STREAM,
+    1,
+    0,
+    ConvertRequestPriorityToSpdyPriority(LOWEST, 3),
+    0,
+    CONTROL_FLAG_NONE,
+    false,
+    INVALID,
+    NULL,
+    0,
+    DATA_FLAG_NONE
+  };
+  static const char* const kGetHeaders[] = {
+    ":method",
+    "GET",
+    ":scheme",
+    "http",
+    ":host",
+    "www.google.com",
+    ":path",
+    "/",
+    ":version",
+    "HTTP/1.1",
+  };
+  scoped_ptr<SpdyFrame> req(
+      ConstructSpdyPacket(
+          kSynStartHeader, NULL, 0, kGetHeaders, arraysize(kGetHeaders) / 2));
+  scoped_ptr<SpdyFrame> msg(
+      ConstructSpdyBodyFrame("\0hello!\xff", 8));
+  scoped_ptr<SpdyFrame> rst(ConstructSpdyRstStream(1, CANCEL));
+  MockWrite writes[] = {
+    CreateMockWrite(*req, 0),
+    CreateMockWrite(*msg, 1),
+    CreateMockWrite(*rst, 2),
+  };
+  MockRead reads[] = {
+    MockRead(ASYNC, 0, 3),  // EOF
+  };
+
+  scoped_ptr<OrderedSocketData> data(
+      new OrderedSocketData(reads, arraysize(reads),
+                            writes, arraysize(writes)));
+  MockConnect connect_data(SYNCHRONOUS, OK);
+  data->set_connect_data(connect_data);
+
+  session_deps.socket_factory->AddSocketDataProvider(data.get());
+
+  scoped_refptr<SpdySession> session(CreateSpdySession());
+  GURL url("http://www.google.com/");
+
+  HostPortPair host_port_pair("www.google.com", 80);
+  scoped_refptr<TransportSocketParams> transport_params(
+      new TransportSocketParams(host_port_pair, LOWEST, false, false));
+
+  scoped_ptr<ClientSocketHandle> connection(new ClientSocketHandle);
+  EXPECT_EQ(OK, connection->Init(host_port_pair.ToString(), transport_params,
+                                 LOWEST, CompletionCallback(),
+                                 session_->GetTransportSocketPool(
+                                     HttpNetworkSession::NORMAL_SOCKET_POOL),
+                                 BoundNetLog()));
+  session->InitializeWithSocket(connection.release(), false, OK);
+
+  scoped_refptr<SpdyStream> stream;
+  ASSERT_EQ(
+      OK,
+      session->CreateStream(url, LOWEST, &stream, BoundNetLog(),
+                            CompletionCallback()));
+  TestCompletionCallback callback;
+  scoped_ptr<TestSpdyStreamDelegate> delegate(
+      new TestSpdyStreamDelegate(stream.get(), NULL, callback.callback()));
+  stream->SetDelegate(delegate.get());
+
+  linked_ptr<SpdyHeaderBlock> headers(new SpdyHeaderBlock);
+  (*headers)[":method"] = "GET";
+  (*headers)[":scheme"] = url.scheme();
+  (*headers)[":host"] = url.host();
+  (*headers)[":path"] = url.path();
+  (*headers)[":version"] = "HTTP/1.1";
+  stream->set_spdy_headers(headers);
+
+  // Queue the SYN_STREAM and a DATA frame, then reset the stream before any
+  // of them is written.
+  EXPECT_EQ(ERR_IO_PENDING, stream->SendRequest(true));
+  scoped_refptr<IOBufferWithSize> buf(new IOBufferWithSize(8));
+  memcpy(buf->data(), "\0hello!\xff", 8);
+  EXPECT_EQ(ERR_IO_PENDING,
+            stream->WriteStreamData(buf.get(), buf->size(), DATA_FLAG_NONE));
+  stream->Cancel();
+  EXPECT_TRUE(delegate->closed());
+
+  MessageLoop::current()->RunAllPending();
+  EXPECT_TRUE(data->at_write_eof());
+}
+
 TEST_F(SpdyStreamSpdy3Test, PushedStream) {
   const char kStreamUrl[] = "http://www.google.com/";
 
@@ -301,6 +429,68 @@ TEST_F(SpdyStreamSpdy3Test, PushedStream) {
   EXPECT_EQ(kStreamUrl, stream->GetUrl().spec());
 }
 
+// Data buffered for a pushed stream is handed to its delegate in the buffers
+// the session read it into.
+TEST_F(SpdyStreamSpdy3Test, PushedStreamReplaysDataBuffers) {
+  const char kStreamUrl[] = "http://www.google.com/";
+
+  SpdySessionDependencies session_deps;
+  session_ = SpdySessionDependencies::SpdyCreateSession(&session_deps);
+  SpdySessionPoolPeer pool_peer_(session_->spdy_session_pool());
+  scoped_refptr<SpdySession> spdy_session(CreateSpdySession());
+
+  MockRead reads[] = {
+    MockRead(ASYNC, 0, 0), // EOF
+  };
+
+  scoped_ptr<OrderedSocketData> data(
+      new OrderedSocketData(reads, arraysize(reads), NULL, 0));
+  MockConnect connect_data(SYNCHRONOUS, OK);
+  data->set_connect_data(connect_data);
+
+  session_deps.socket_factory->AddSocketDataProvider(data.get());
+
+  HostPortPair host_port_pair("www.google.com", 80);
+  scoped_refptr<TransportSocketParams> transport_params(
+      new TransportSocketParams(host_port_pair, LOWEST, false, false));
+  scoped_ptr<ClientSocketHandle> connection(new ClientSocketHandle);
+  EXPECT_EQ(OK, connection->Init(host_port_pair.ToString(), transport_params,
+                                 LOWEST, CompletionCallback(),
+                                 session_->GetTransportSocketPool(
+                                     HttpNetworkSession::NORMAL_SOCKET_POOL),
+                                 BoundNetLog()));
+  spdy_session->InitializeWithSocket(connection.release(), false, OK);
+
+  scoped_refptr<SpdyStream> stream =
+      new SpdyStream(spdy_session, 2, true, BoundNetLog());
+  SpdyHeaderBlock response;
+  GURL url(kStreamUrl);
+  response[":host"] = url.host();
+  response[":scheme"] = url.scheme();
+  response[":path"] = url.path();
+  response[":status"] = "200";
+  response[":version"] = "OK";
+  stream->OnResponseReceived(response);
+  stream->set_response_received();
+
+  // The payload of a DATA frame, in the middle of a read buffer.
+  const char kReadData[] = "frame header|hello!";
+  scoped_refptr<IOBuffer> read_buffer(new IOBuffer(arraysize(kReadData)));
+  memcpy(read_buffer->data(), kReadData, arraysize(kReadData));
+  scoped_refptr<DrainableIOBuffer> payload(
+      new DrainableIOBuffer(read_buffer, arraysize(kReadData) - 1));
+  payload->SetOffset(13);
+  stream->OnDataBufferReceived(payload);
+
+  scoped_ptr<BufferKeepingDelegate> delegate(new BufferKeepingDelegate);
+  stream->SetDelegate(delegate.get());
+  MessageLoop::current()->RunAllPending();
+
+  ASSERT_EQ(1U, delegate->buffers().size());
+  EXPECT_EQ(payload.get(), delegate->buffers()[0].get());
+  EXPECT_EQ("hello!", std::string(payload->data(), payload->BytesRemaining()));
+}
+
 TEST_F(SpdyStreamSpdy3Test, StreamError) {
   SpdySessionDependencies session_deps;
 
@@ -6,6 +6,7 @@
 
 #include <netinet/in.h>
 #include <netinet/tcp.h>  // For TCP_NODELAY
+#include <sched.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -21,9 +22,12 @@
 namespace net {
 
 SMAcceptorThread::SMAcceptorThread(FlipAcceptor *acceptor,
-                                   MemoryCache* memory_cache)
+                                   MemoryCache* memory_cache,
+                                   int listen_fd)
     : SimpleThread("SMAcceptorThread"),
       acceptor_(acceptor),
+      listen_fd_(listen_fd),
+      cpu_(-1),
       ssl_state_(NULL),
       use_ssl_(false),
       idle_socket_timeout_s_(acceptor->idle_socket_timeout_s_),
@@ -77,7 +81,7 @@ SMConnection* SMAcceptorThread::FindOrMakeNewSMConnection() {
 }
 
 void SMAcceptorThread::InitWorker() {
-  epoll_server_.RegisterFD(acceptor_->listen_fd_, this, EPOLLIN | EPOLLET);
+  epoll_server_.RegisterFD(listen_fd_, this, EPOLLIN | EPOLLET);
 }
 
 void SMAcceptorThread::HandleConnection(int server_fd,
@@ -116,11 +120,11 @@ void SMAcceptorThread::AcceptFromListenFD() {
     for (int i = 0; i < acceptor_->accepts_per_wake_; ++i) {
       struct sockaddr address;
       socklen_t socklen = sizeof(address);
-      int fd = accept(acceptor_->listen_fd_, &address, &socklen);
+      int fd = accept(listen_fd_, &address, &socklen);
       if (fd == -1) {
         if (errno != 11) {
           VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Acceptor: accept fail("
-                  << acceptor_->listen_fd_ << "): " << errno << ": "
+                  << listen_fd_ << "): " << errno << ": "
                   << strerror(errno);
         }
         break;
@@ -132,11 +136,11 @@ void SMAcceptorThread::AcceptFromListenFD() {
     while (true) {
       struct sockaddr address;
       socklen_t socklen = sizeof(address);
-      int fd = accept(acceptor_->listen_fd_, &address, &socklen);
+      int fd = accept(listen_fd_, &address, &socklen);
       if (fd == -1) {
         if (errno != 11) {
           VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Acceptor: accept fail("
-                  << acceptor_->listen_fd_ << "): " << errno << ": "
+                  << listen_fd_ << "): " << errno << ": "
                   << strerror(errno);
         }
         break;
@@ -176,6 +180,16 @@ void SMAcceptorThread::HandleConnectionIdleTimeout() {
 }
 
 void SMAcceptorThread::Run() {
+  if (cpu_ >= 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu_, &cpu_set);
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) < 0) {
+      LOG(ERROR) << "Unable to pin acceptor thread to cpu " << cpu_ << ": "
+                 << strerror(errno);
+    }
+  }
+
   while (!quitting_.HasBeenNotified()) {
     epoll_server_.set_timeout_in_us(10 * 1000);  // 10 ms
     epoll_server_.WaitForEventsAndExecuteCallbacks();
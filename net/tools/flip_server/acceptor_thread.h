@@ -46,9 +46,18 @@ class SMAcceptorThread : public base::SimpleThread,
                          public EpollCallbackInterface,
                          public SMConnectionPoolInterface {
  public:
-  SMAcceptorThread(FlipAcceptor *acceptor, MemoryCache* memory_cache);
+  // Accepts connections for |acceptor| from |listen_fd|, which is either
+  // the acceptor's own listening socket or one more socket opened for it with
+  // FlipAcceptor::OpenListeningSocket().
+  SMAcceptorThread(FlipAcceptor *acceptor,
+                   MemoryCache* memory_cache,
+                   int listen_fd);
   virtual ~SMAcceptorThread();
 
+  // Makes the thread run only on |cpu| once started.  Keeping each acceptor
+  // on a core of its own keeps its connections' state in that core's caches.
+  void set_cpu(int cpu) { cpu_ = cpu; }
+
   // EpollCallbackInteface interface
   virtual void OnRegistration(EpollServer* eps,
                               int fd,
@@ -80,6 +89,8 @@ class SMAcceptorThread : public base::SimpleThread,
  private:
   EpollServer epoll_server_;
   FlipAcceptor* acceptor_;
+  int listen_fd_;
+  int cpu_;
   SSLState* ssl_state_;
   bool use_ssl_;
   int idle_socket_timeout_s_;
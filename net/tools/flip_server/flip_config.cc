@@ -35,10 +35,14 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
       accept_backlog_size_(accept_backlog_size),
       disable_nagle_(disable_nagle),
       accepts_per_wake_(accepts_per_wake),
+      reuseport_(reuseport),
+      wait_for_iface_(wait_for_iface),
+      listen_fd_(-1),
       memory_cache_(memory_cache),
       ssl_session_expiry_(300),  // TODO(mbelshe):  Hook these up!
       ssl_disable_compression_(false),
-      idle_socket_timeout_s_(300) {
+      idle_socket_timeout_s_(300),
+      bytes_sent_(0) {
   VLOG(1) << "Attempting to listen on " << listen_ip_.c_str() << ":"
           << listen_port_.c_str();
   if (!https_server_ip_.size())
@@ -46,31 +50,10 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
   if (!https_server_port_.size())
     https_server_port_ = http_server_port_;
 
-  while (1) {
-    int ret = CreateListeningSocket(listen_ip_,
-                                    listen_port_,
-                                    true,
-                                    accept_backlog_size_,
-                                    true,
-                                    reuseport,
-                                    wait_for_iface,
-                                    disable_nagle_,
-                                    &listen_fd_);
-    if ( ret == 0 ) {
-      break;
-    } else if ( ret == -3 && wait_for_iface ) {
-      // Binding error EADDRNOTAVAIL was encounted. We need
-      // to wait for the interfaces to raised. try again.
-      usleep(200000);
-    } else {
-      LOG(ERROR) << "Unable to create listening socket for: ret = " << ret
-                 << ": " << listen_ip_.c_str() << ":"
-                 << listen_port_.c_str();
-      return;
-    }
-  }
+  listen_fd_ = OpenListeningSocket();
+  if (listen_fd_ < 0)
+    return;
 
-  SetNonBlocking(listen_fd_);
   VLOG(1) << "Listening on socket: ";
   if (flip_handler_type == FLIP_HANDLER_PROXY)
     VLOG(1) << "\tType         : Proxy";
@@ -93,6 +76,60 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
 
 FlipAcceptor::~FlipAcceptor() {}
 
+int FlipAcceptor::OpenListeningSocket() {
+  int listen_fd = -1;
+  while (1) {
+    int ret = CreateListeningSocket(listen_ip_,
+                                    listen_port_,
+                                    true,
+                                    accept_backlog_size_,
+                                    true,
+                                    reuseport_,
+                                    wait_for_iface_,
+                                    disable_nagle_,
+                                    &listen_fd);
+    if ( ret == 0 ) {
+      break;
+    } else if ( ret == -3 && wait_for_iface_ ) {
+      // Binding error EADDRNOTAVAIL was encounted. We need
+      // to wait for the interfaces to raised. try again.
+      usleep(200000);
+    } else {
+      LOG(ERROR) << "Unable to create listening socket for: ret = " << ret
+                 << ": " << listen_ip_.c_str() << ":"
+                 << listen_port_.c_str();
+      return -1;
+    }
+  }
+
+  SetNonBlocking(listen_fd);
+  return listen_fd;
+}
+
+void FlipAcceptor::AddBytesSent(int64 bytes) {
+  base::AutoLock lock(bytes_sent_lock_);
+  bytes_sent_ += bytes;
+}
+
+int64 FlipAcceptor::TakeBytesSent() {
+  base::AutoLock lock(bytes_sent_lock_);
+  int64 bytes = bytes_sent_;
+  bytes_sent_ = 0;
+  return bytes;
+}
+
+const char* FlipAcceptor::HandlerTypeName() const {
+  switch (flip_handler_type_) {
+    case FLIP_HANDLER_PROXY:
+      return "Proxy";
+    case FLIP_HANDLER_SPDY_SERVER:
+      return "SPDY Server";
+    case FLIP_HANDLER_HTTP_SERVER:
+      return "HTTP Server";
+  }
+  return "";
+}
+
 FlipConfig::FlipConfig()
     : server_think_time_in_s_(0),
       log_destination_(logging::LOG_ONLY_TO_SYSTEM_DEBUG_LOG),
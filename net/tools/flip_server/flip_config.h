@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/logging.h"
+#include "base/synchronization/lock.h"
 #include "net/tools/flip_server/create_listener.h"
 
 namespace net {
@@ -42,6 +43,20 @@ class FlipAcceptor {
                void *memory_cache);
   ~FlipAcceptor();
 
+  // Creates, binds and listens on a new non-blocking socket for
+  // |listen_ip_|:|listen_port_|. Returns the socket, or -1 on failure.
+  // Several sockets may listen on the same address when |reuseport_| is set,
+  // in which case the kernel spreads incoming connections across them.
+  int OpenListeningSocket();
+
+  // Counts bytes written to this acceptor's clients, from any of its threads.
+  void AddBytesSent(int64 bytes);
+  // Returns the bytes counted since the last call.
+  int64 TakeBytesSent();
+
+  // A name for the kind of acceptor, for logging.
+  const char* HandlerTypeName() const;
+
   enum FlipHandlerType flip_handler_type_;
   std::string listen_ip_;
   std::string listen_port_;
@@ -55,11 +70,17 @@ class FlipAcceptor {
   int accept_backlog_size_;
   bool disable_nagle_;
   int accepts_per_wake_;
+  bool reuseport_;
+  bool wait_for_iface_;
   int listen_fd_;
   void* memory_cache_;
   int ssl_session_expiry_;
   bool ssl_disable_compression_;
   int idle_socket_timeout_s_;
+
+ private:
+  base::Lock bytes_sent_lock_;
+  int64 bytes_sent_;
 };
 
 class FlipConfig {
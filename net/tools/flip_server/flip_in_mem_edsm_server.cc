@@ -6,8 +6,10 @@
 #include <signal.h>
 #include <sys/file.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -46,6 +48,22 @@ int32 FLAGS_accept_backlog_size = 1024;
 //  SO_REUSEPORT);
 bool FLAGS_reuseport = false;
 
+// The number of threads, each with a listening socket of its own, that
+//  accept connections for each listen ip:port. More than one implies
+//  reuseport.
+int32 FLAGS_acceptor_threads = 1;
+
+// The most bytes of responses each in-memory server keeps in memory. The
+//  rest are read from the cache directory when requested. 0 means no limit.
+int64 FLAGS_memory_cache_bytes = 0;
+
+// If true, each acceptor thread is bound to a cpu of its own, round robin.
+bool FLAGS_pin_acceptor_threads = false;
+
+// How often, in seconds, to log the throughput of each acceptor. 0 means
+//  never.
+int32 FLAGS_throughput_interval = 0;
+
 // Flag to force spdy, even if NPN is not negotiated.
 bool FLAGS_force_spdy = false;
 
@@ -204,6 +222,14 @@ int main (int argc, char**argv)
     cout << "\t--ssl-session-expiry=<seconds> (default is 300)\n";
     cout << "\t--ssl-disable-compression\n";
     cout << "\t--idle-timeout=<seconds> (default is 300)\n";
+    cout << "\t--acceptor-threads=<n> (default is 1)\n";
+    cout << "\t  * Each thread accepts from a listening socket of its own,"
+         << " using\n"
+         << "\t    SO_REUSEPORT, so that they don't contend on accept().\n";
+    cout << "\t--pin-acceptor-threads\n";
+    cout << "\t--memory-cache-mb=<megabytes> (default is no limit)\n";
+    cout << "\t--throughput-interval=<seconds>\n";
+    cout << "\t  * Logs the bytes per second sent by each listen ip:port.\n";
     cout << "\t--pidfile=<filepath> (default /var/run/flip-server.pid)\n";
     cout << "\t--help\n";
     exit(0);
@@ -272,6 +298,29 @@ int main (int argc, char**argv)
   if (cl.HasSwitch("force_spdy"))
     net::SMConnection::set_force_spdy(true);
 
+  if (cl.HasSwitch("acceptor-threads")) {
+    FLAGS_acceptor_threads =
+      atoi(cl.GetSwitchValueASCII("acceptor-threads").c_str());
+    if (FLAGS_acceptor_threads < 1)
+      LOG(FATAL) << "There must be at least one acceptor thread.";
+  }
+  // Every socket that shares a port needs SO_REUSEPORT, including the first.
+  if (FLAGS_acceptor_threads > 1)
+    FLAGS_reuseport = true;
+
+  if (cl.HasSwitch("pin-acceptor-threads"))
+    FLAGS_pin_acceptor_threads = true;
+
+  if (cl.HasSwitch("throughput-interval")) {
+    FLAGS_throughput_interval =
+      atoi(cl.GetSwitchValueASCII("throughput-interval").c_str());
+  }
+
+  if (cl.HasSwitch("memory-cache-mb")) {
+    FLAGS_memory_cache_bytes =
+      atoi(cl.GetSwitchValueASCII("memory-cache-mb").c_str()) * 1024LL * 1024;
+  }
+
   InitLogging(g_proxy_config.log_filename_.c_str(),
               g_proxy_config.log_destination_,
               logging::DONT_LOCK_LOG_FILE,
@@ -291,6 +340,11 @@ int main (int argc, char**argv)
             << (FLAGS_disable_nagle?"true":"false");
   LOG(INFO) << "Reuseport               : "
             << (FLAGS_reuseport?"true":"false");
+  LOG(INFO) << "Acceptor threads        : " << FLAGS_acceptor_threads;
+  LOG(INFO) << "Pin acceptor threads    : "
+            << (FLAGS_pin_acceptor_threads?"true":"false");
+  LOG(INFO) << "Memory cache bytes      : " << FLAGS_memory_cache_bytes;
+  LOG(INFO) << "Throughput interval     : " << FLAGS_throughput_interval;
   LOG(INFO) << "Force SPDY              : "
             << (FLAGS_force_spdy?"true":"false");
   LOG(INFO) << "SSL session expiry      : "
@@ -331,6 +385,7 @@ int main (int argc, char**argv)
   // Spdy Server Acceptor
   net::MemoryCache spdy_memory_cache;
   if (cl.HasSwitch("spdy-server")) {
+    spdy_memory_cache.set_max_bytes(FLAGS_memory_cache_bytes);
     spdy_memory_cache.AddFiles();
     std::string value = cl.GetSwitchValueASCII("spdy-server");
     std::vector<std::string> valueArgs = split(value, ',');
@@ -352,6 +407,7 @@ int main (int argc, char**argv)
   // Spdy Server Acceptor
   net::MemoryCache http_memory_cache;
   if (cl.HasSwitch("http-server")) {
+    http_memory_cache.set_max_bytes(FLAGS_memory_cache_bytes);
     http_memory_cache.AddFiles();
     std::string value = cl.GetSwitchValueASCII("http-server");
     std::vector<std::string> valueArgs = split(value, ',');
@@ -371,26 +427,55 @@ int main (int argc, char**argv)
   }
 
   std::vector<net::SMAcceptorThread*> sm_worker_threads_;
+  int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int next_cpu = 0;
 
   for (i = 0; i < g_proxy_config.acceptors_.size(); i++) {
     net::FlipAcceptor *acceptor = g_proxy_config.acceptors_[i];
 
-    sm_worker_threads_.push_back(
-        new net::SMAcceptorThread(acceptor,
-                                  (net::MemoryCache *)acceptor->memory_cache_));
-    // Note that spdy_memory_cache is not threadsafe, it is merely
-    // thread compatible. Thus, if ever we are to spawn multiple threads,
-    // we either must make the MemoryCache threadsafe, or use
-    // a separate MemoryCache for each thread.
-    //
-    // The latter is what is currently being done as we spawn
-    // a separate thread for each http and spdy server acceptor.
-
-    sm_worker_threads_.back()->InitWorker();
-    sm_worker_threads_.back()->Start();
+    for (int thread = 0; thread < FLAGS_acceptor_threads; ++thread) {
+      int listen_fd = acceptor->listen_fd_;
+      if (thread > 0) {
+        listen_fd = acceptor->OpenListeningSocket();
+        if (listen_fd < 0)
+          break;
+      }
+
+      // The memory caches are safe to share between threads.
+      sm_worker_threads_.push_back(
+          new net::SMAcceptorThread(
+              acceptor,
+              (net::MemoryCache *)acceptor->memory_cache_,
+              listen_fd));
+      if (FLAGS_pin_acceptor_threads && num_cpus > 0)
+        sm_worker_threads_.back()->set_cpu(next_cpu++ % num_cpus);
+
+      sm_worker_threads_.back()->InitWorker();
+      sm_worker_threads_.back()->Start();
+    }
   }
 
+  time_t last_throughput_time = time(NULL);
   while (!wantExit) {
+    if (FLAGS_throughput_interval > 0) {
+      time_t now = time(NULL);
+      if (now - last_throughput_time >= FLAGS_throughput_interval) {
+        // All acceptors on one line, so that plain HTTP and SPDY can be
+        // compared over the same interval.
+        std::stringstream throughput;
+        for (i = 0; i < g_proxy_config.acceptors_.size(); i++) {
+          net::FlipAcceptor *acceptor = g_proxy_config.acceptors_[i];
+          throughput << " [" << acceptor->HandlerTypeName() << " "
+                     << acceptor->listen_ip_ << ":" << acceptor->listen_port_
+                     << ": "
+                     << acceptor->TakeBytesSent() / (now - last_throughput_time)
+                     << " B/s]";
+        }
+        LOG(INFO) << "Throughput:" << throughput.str();
+        last_throughput_time = now;
+      }
+    }
+
     // Close logfile when HUP signal is received. Logging system will
     // automatically reopen on next log message.
     if ( wantLogClose ) {
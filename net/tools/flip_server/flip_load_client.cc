@@ -0,0 +1,597 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A load generator for flip_server, and for any other HTTP or SPDY server,
+// such as one built on net::HttpServer.  It keeps a number of connections
+// open, sends requests over them for paths drawn from a weighted mix, and
+// prints latency percentiles and throughput as perf dashboard RESULT lines.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/spdy/spdy_framer.h"
+#include "net/spdy/spdy_protocol.h"
+#include "net/tools/flip_server/balsa_frame.h"
+#include "net/tools/flip_server/create_listener.h"
+#include "net/tools/flip_server/epoll_server.h"
+#include "net/tools/flip_server/mem_cache.h"
+
+using std::cout;
+
+namespace net {
+
+namespace {
+
+// The SPDY version flip_server speaks.
+const int kSpdyVersion = 2;
+
+struct LoadConfig {
+  LoadConfig()
+      : connections(10),
+        requests(1000),
+        use_spdy(false),
+        spdy_streams(1),
+        total_weight(0) {}
+
+  std::string server;
+  std::string port;
+  std::string host;
+  int connections;
+  int requests;
+  bool use_spdy;
+  // The requests each SPDY connection keeps in flight at once.
+  int spdy_streams;
+  // Paths to request, with their relative weights.
+  std::vector<std::pair<std::string, int> > mix;
+  int total_weight;
+};
+
+class LoadConnection;
+
+// Hands out requests to connections and collects their results.
+class LoadClient {
+ public:
+  explicit LoadClient(const LoadConfig& config)
+      : config_(config),
+        requests_issued_(0),
+        requests_finished_(0),
+        errors_(0),
+        bytes_received_(0),
+        start_us_(0),
+        end_us_(0),
+        aborted_(false) {}
+  ~LoadClient();
+
+  // Runs until every request has finished or failed.  Returns false if no
+  // connection could be made.
+  bool Run();
+
+  void PrintResults(const std::string& graph, const std::string& trace);
+
+  // Returns the path for the next request, or false if all requests have
+  // been issued.
+  bool TakeRequest(std::string* path);
+
+  void RecordResponse(int64 latency_us, int64 bytes);
+  void RecordErrors(int count);
+  void Abort() { aborted_ = true; }
+
+  bool HasRequestsLeft() const {
+    return !aborted_ && requests_issued_ < config_.requests;
+  }
+  const LoadConfig& config() const { return config_; }
+  EpollServer* epoll_server() { return &epoll_server_; }
+
+ private:
+  LoadConfig config_;
+  EpollServer epoll_server_;
+  std::vector<LoadConnection*> connections_;
+  int requests_issued_;
+  int requests_finished_;
+  int errors_;
+  int64 bytes_received_;
+  std::vector<int64> latencies_us_;
+  int64 start_us_;
+  int64 end_us_;
+  bool aborted_;
+};
+
+// Collects an HTTP response, noting when it is complete.
+class ResponseVisitor : public StoreBodyAndHeadersVisitor {
+ public:
+  ResponseVisitor() : done_(false) {}
+
+  virtual void MessageDone() OVERRIDE { done_ = true; }
+
+  bool done_;
+};
+
+// One connection to the server, sending one HTTP request at a time, or up to
+// |spdy_streams| SPDY streams at once.
+class LoadConnection : public EpollCallbackInterface,
+                       public SpdyFramerVisitorInterface {
+ public:
+  explicit LoadConnection(LoadClient* client)
+      : client_(client),
+        fd_(-1),
+        write_offset_(0),
+        http_start_us_(0),
+        response_bytes_(0),
+        next_stream_id_(1) {}
+  virtual ~LoadConnection() { Close(); }
+
+  // Connects and starts sending requests.  Returns false on failure.
+  bool Connect();
+
+  // EpollCallbackInterface:
+  virtual void OnRegistration(EpollServer* eps,
+                              int fd,
+                              int event_mask) OVERRIDE {}
+  virtual void OnModification(int fd, int event_mask) OVERRIDE {}
+  virtual void OnEvent(int fd, EpollEvent* event) OVERRIDE;
+  virtual void OnUnregistration(int fd, bool replaced) OVERRIDE {}
+  virtual void OnShutdown(EpollServer* eps, int fd) OVERRIDE { Close(); }
+
+  // SpdyFramerVisitorInterface:
+  virtual void OnError(SpdyFramer* framer) OVERRIDE {}
+  virtual void OnControl(const SpdyControlFrame* frame) OVERRIDE;
+  virtual bool OnControlFrameHeaderData(SpdyStreamId stream_id,
+                                        const char* header_data,
+                                        size_t len) OVERRIDE {
+    return true;
+  }
+  virtual bool OnCredentialFrameData(const char* header_data,
+                                     size_t len) OVERRIDE {
+    return true;
+  }
+  virtual void OnDataFrameHeader(const SpdyDataFrame* frame) OVERRIDE {}
+  virtual void OnStreamFrameData(SpdyStreamId stream_id,
+                                 const char* data,
+                                 size_t len) OVERRIDE;
+  virtual void OnSetting(SpdySettingsIds id,
+                         uint8 flags,
+                         uint32 value) OVERRIDE {}
+
+ private:
+  int outstanding_requests() const {
+    if (client_->config().use_spdy)
+      return spdy_streams_.size();
+    return http_start_us_ ? 1 : 0;
+  }
+
+  // Queues requests until the connection has as many in flight as it may.
+  void SendRequests();
+  void QueueHttpRequest(const std::string& path);
+  void QueueSpdyRequest(const std::string& path);
+
+  bool DoRead();
+  bool DoWrite();
+
+  void HttpResponseDone();
+  void SpdyStreamDone(SpdyStreamId stream_id);
+
+  // Counts the requests in flight as failed, and reconnects if there are
+  // requests left.
+  void Fail(const char* reason);
+  void Close();
+
+  LoadClient* client_;
+  int fd_;
+  std::string write_buffer_;
+  size_t write_offset_;
+
+  // HTTP.
+  BalsaFrame http_framer_;
+  ResponseVisitor http_visitor_;
+  // When the request in flight was sent, or 0 if there is none.
+  int64 http_start_us_;
+  int64 response_bytes_;
+
+  // SPDY.
+  scoped_ptr<SpdyFramer> spdy_framer_;
+  SpdyStreamId next_stream_id_;
+  // When each stream in flight was sent, and the bytes received for it.
+  std::map<SpdyStreamId, std::pair<int64, int64> > spdy_streams_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoadConnection);
+};
+
+LoadClient::~LoadClient() {
+  for (size_t i = 0; i < connections_.size(); ++i)
+    delete connections_[i];
+}
+
+bool LoadClient::Run() {
+  start_us_ = epoll_server_.NowInUsec();
+  for (int i = 0; i < config_.connections && HasRequestsLeft(); ++i) {
+    LoadConnection* connection = new LoadConnection(this);
+    connections_.push_back(connection);
+    if (!connection->Connect())
+      return false;
+  }
+  while (!aborted_ && (requests_finished_ + errors_ < requests_issued_ ||
+                       HasRequestsLeft())) {
+    epoll_server_.set_timeout_in_us(10 * 1000);
+    epoll_server_.WaitForEventsAndExecuteCallbacks();
+  }
+  end_us_ = epoll_server_.NowInUsec();
+  return !aborted_;
+}
+
+bool LoadClient::TakeRequest(std::string* path) {
+  if (!HasRequestsLeft())
+    return false;
+  ++requests_issued_;
+  int pick = rand() % config_.total_weight;
+  for (size_t i = 0; i < config_.mix.size(); ++i) {
+    pick -= config_.mix[i].second;
+    if (pick < 0) {
+      *path = config_.mix[i].first;
+      break;
+    }
+  }
+  return true;
+}
+
+void LoadClient::RecordResponse(int64 latency_us, int64 bytes) {
+  ++requests_finished_;
+  bytes_received_ += bytes;
+  latencies_us_.push_back(latency_us);
+}
+
+void LoadClient::RecordErrors(int count) {
+  errors_ += count;
+}
+
+void LoadClient::PrintResults(const std::string& graph,
+                              const std::string& trace) {
+  std::sort(latencies_us_.begin(), latencies_us_.end());
+  const double kPercentiles[] = { 0.5, 0.99, 0.999 };
+  const char* kNames[] = { "p50", "p99", "p999" };
+  for (size_t i = 0; i < arraysize(kPercentiles); ++i) {
+    double latency_ms = 0;
+    if (!latencies_us_.empty()) {
+      size_t index = std::min(
+          latencies_us_.size() - 1,
+          static_cast<size_t>(latencies_us_.size() * kPercentiles[i]));
+      latency_ms = latencies_us_[index] / 1000.0;
+    }
+    printf("RESULT %s_latency_%s: %s= %.3f ms\n",
+           graph.c_str(), kNames[i], trace.c_str(), latency_ms);
+  }
+
+  double seconds = std::max<int64>(end_us_ - start_us_, 1) / 1000000.0;
+  printf("RESULT %s_throughput: %s= %.1f requests/s\n",
+         graph.c_str(), trace.c_str(), requests_finished_ / seconds);
+  printf("RESULT %s_bandwidth: %s= %.0f bytes/s\n",
+         graph.c_str(), trace.c_str(), bytes_received_ / seconds);
+  printf("RESULT %s_errors: %s= %d count\n",
+         graph.c_str(), trace.c_str(), errors_);
+}
+
+bool LoadConnection::Connect() {
+  const LoadConfig& config = client_->config();
+  if (CreateConnectedSocket(&fd_, config.server, config.port, true,
+                            true) < 0) {
+    return false;
+  }
+  write_buffer_.clear();
+  write_offset_ = 0;
+  http_start_us_ = 0;
+  spdy_streams_.clear();
+  if (config.use_spdy) {
+    spdy_framer_.reset(new SpdyFramer(kSpdyVersion));
+    spdy_framer_->set_visitor(this);
+    next_stream_id_ = 1;
+  } else {
+    http_framer_.Reset();
+    http_framer_.set_is_request(false);
+    http_framer_.set_balsa_visitor(&http_visitor_);
+    http_framer_.set_balsa_headers(&http_visitor_.headers);
+  }
+  client_->epoll_server()->RegisterFD(fd_, this,
+                                      EPOLLIN | EPOLLOUT | EPOLLET);
+  SendRequests();
+  return true;
+}
+
+void LoadConnection::OnEvent(int fd, EpollEvent* event) {
+  if (event->in_events & (EPOLLERR | EPOLLHUP)) {
+    Fail("connection error");
+    return;
+  }
+  if ((event->in_events & EPOLLIN) && !DoRead())
+    return;
+  if (event->in_events & EPOLLOUT)
+    DoWrite();
+}
+
+void LoadConnection::SendRequests() {
+  int max_outstanding =
+      client_->config().use_spdy ? client_->config().spdy_streams : 1;
+  std::string path;
+  while (outstanding_requests() < max_outstanding &&
+         client_->TakeRequest(&path)) {
+    if (client_->config().use_spdy)
+      QueueSpdyRequest(path);
+    else
+      QueueHttpRequest(path);
+  }
+  DoWrite();
+}
+
+void LoadConnection::QueueHttpRequest(const std::string& path) {
+  write_buffer_ += "GET " + path + " HTTP/1.1\r\n"
+                   "Host: " + client_->config().host + "\r\n"
+                   "Connection: keep-alive\r\n\r\n";
+  http_start_us_ = client_->epoll_server()->NowInUsec();
+  response_bytes_ = 0;
+}
+
+void LoadConnection::QueueSpdyRequest(const std::string& path) {
+  SpdyHeaderBlock headers;
+  headers["method"] = "GET";
+  headers["url"] = "http://" + client_->config().host + path;
+  headers["version"] = "HTTP/1.1";
+  headers["scheme"] = "http";
+  headers["host"] = client_->config().host;
+  SpdyStreamId stream_id = next_stream_id_;
+  next_stream_id_ += 2;
+  scoped_ptr<SpdySynStreamControlFrame> frame(
+      spdy_framer_->CreateSynStream(stream_id, 0, 0, 0, CONTROL_FLAG_FIN,
+                                    true, &headers));
+  write_buffer_.append(frame->data(),
+                       frame->length() + SpdyFrame::kHeaderSize);
+  spdy_streams_[stream_id] =
+      std::make_pair(client_->epoll_server()->NowInUsec(), 0);
+}
+
+bool LoadConnection::DoRead() {
+  char buffer[16 * 1024];
+  while (fd_ >= 0) {
+    ssize_t rv = read(fd_, buffer, sizeof(buffer));
+    if (rv < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN)
+        return true;
+      Fail("read error");
+      return false;
+    }
+    if (rv == 0) {
+      Fail("connection closed");
+      return false;
+    }
+
+    if (client_->config().use_spdy) {
+      spdy_framer_->ProcessInput(buffer, rv);
+      if (spdy_framer_->HasError()) {
+        Fail("SPDY framing error");
+        return false;
+      }
+      continue;
+    }
+
+    response_bytes_ += rv;
+    size_t pos = 0;
+    while (pos < static_cast<size_t>(rv)) {
+      pos += http_framer_.ProcessInput(buffer + pos, rv - pos);
+      if (http_framer_.Error()) {
+        Fail("HTTP framing error");
+        return false;
+      }
+      if (http_visitor_.done_)
+        HttpResponseDone();
+    }
+  }
+  return false;
+}
+
+bool LoadConnection::DoWrite() {
+  while (fd_ >= 0 && write_offset_ < write_buffer_.size()) {
+    ssize_t rv = send(fd_, write_buffer_.data() + write_offset_,
+                      write_buffer_.size() - write_offset_,
+                      MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (rv < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == ENOTCONN)
+        return true;
+      Fail("write error");
+      return false;
+    }
+    write_offset_ += rv;
+  }
+  if (write_offset_ == write_buffer_.size()) {
+    write_buffer_.clear();
+    write_offset_ = 0;
+  }
+  return fd_ >= 0;
+}
+
+void LoadConnection::OnControl(const SpdyControlFrame* frame) {
+  if (frame->type() != SYN_REPLY)
+    return;
+  const SpdySynReplyControlFrame* reply =
+      reinterpret_cast<const SpdySynReplyControlFrame*>(frame);
+  std::map<SpdyStreamId, std::pair<int64, int64> >::iterator it =
+      spdy_streams_.find(reply->stream_id());
+  if (it == spdy_streams_.end())
+    return;
+  it->second.second += frame->length() + SpdyFrame::kHeaderSize;
+  if (frame->flags() & CONTROL_FLAG_FIN)
+    SpdyStreamDone(reply->stream_id());
+}
+
+void LoadConnection::OnStreamFrameData(SpdyStreamId stream_id,
+                                       const char* data,
+                                       size_t len) {
+  std::map<SpdyStreamId, std::pair<int64, int64> >::iterator it =
+      spdy_streams_.find(stream_id);
+  if (it == spdy_streams_.end())
+    return;
+  it->second.second += len;
+  if (len == 0)
+    SpdyStreamDone(stream_id);
+}
+
+void LoadConnection::HttpResponseDone() {
+  client_->RecordResponse(
+      client_->epoll_server()->NowInUsec() - http_start_us_, response_bytes_);
+  http_start_us_ = 0;
+  http_visitor_.done_ = false;
+  http_visitor_.body.clear();
+  http_framer_.Reset();
+  http_framer_.set_balsa_headers(&http_visitor_.headers);
+  SendRequests();
+}
+
+void LoadConnection::SpdyStreamDone(SpdyStreamId stream_id) {
+  std::map<SpdyStreamId, std::pair<int64, int64> >::iterator it =
+      spdy_streams_.find(stream_id);
+  client_->RecordResponse(
+      client_->epoll_server()->NowInUsec() - it->second.first,
+      it->second.second);
+  spdy_streams_.erase(it);
+  SendRequests();
+}
+
+void LoadConnection::Fail(const char* reason) {
+  int outstanding = outstanding_requests();
+  VLOG(1) << "Connection failed: " << reason << " with " << outstanding
+          << " requests in flight";
+  Close();
+  client_->RecordErrors(outstanding);
+  if (!client_->HasRequestsLeft())
+    return;
+  // Every reconnect takes new requests, so a server that keeps failing uses
+  // them up rather than keeping the client going forever.
+  if (!Connect()) {
+    LOG(ERROR) << "Unable to reconnect to " << client_->config().server << ":"
+               << client_->config().port;
+    client_->Abort();
+  }
+}
+
+void LoadConnection::Close() {
+  if (fd_ < 0)
+    return;
+  client_->epoll_server()->UnregisterFD(fd_);
+  close(fd_);
+  fd_ = -1;
+  http_start_us_ = 0;
+  spdy_streams_.clear();
+}
+
+// Reads "path [weight]" lines from |filename| into |config|.
+bool ReadRequestMix(const std::string& filename, LoadConfig* config) {
+  std::ifstream file(filename.c_str());
+  if (!file)
+    return false;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string path;
+    int weight = 1;
+    if (!(fields >> path) || path[0] == '#')
+      continue;
+    fields >> weight;
+    if (weight > 0)
+      config->mix.push_back(std::make_pair(path, weight));
+  }
+  return !config->mix.empty();
+}
+
+}  // namespace
+
+}  // namespace net
+
+int main(int argc, char** argv) {
+  CommandLine::Init(argc, argv);
+  const CommandLine& cl = *CommandLine::ForCurrentProcess();
+
+  if (cl.HasSwitch("help") || !cl.HasSwitch("server") ||
+      !cl.HasSwitch("port")) {
+    cout << argv[0] << " <options>\n";
+    cout << "\t--server=<ip>\n";
+    cout << "\t--port=<port>\n";
+    cout << "\t--host=<host header> (default is the server ip)\n";
+    cout << "\t--connections=<n> (default is 10)\n";
+    cout << "\t--requests=<n> (default is 1000)\n";
+    cout << "\t--mix=<filename>\n";
+    cout << "\t  * One \"<path> [weight]\" per line. Default is \"/\".\n";
+    cout << "\t--spdy\n";
+    cout << "\t  * Speaks SPDY/2 without SSL, as flip_server does with"
+         << " --force_spdy.\n";
+    cout << "\t--spdy-streams=<n> (default is 1)\n";
+    cout << "\t  * Requests each SPDY connection keeps in flight.\n";
+    cout << "\t--perf-graph=<name> (default is flip_load)\n";
+    cout << "\t--perf-trace=<name> (default is http or spdy)\n";
+    cout << "\t--help\n";
+    return cl.HasSwitch("help") ? 0 : 1;
+  }
+
+  net::LoadConfig config;
+  config.server = cl.GetSwitchValueASCII("server");
+  config.port = cl.GetSwitchValueASCII("port");
+  config.host = cl.HasSwitch("host") ? cl.GetSwitchValueASCII("host")
+                                     : config.server;
+  if (cl.HasSwitch("connections"))
+    config.connections = atoi(cl.GetSwitchValueASCII("connections").c_str());
+  if (cl.HasSwitch("requests"))
+    config.requests = atoi(cl.GetSwitchValueASCII("requests").c_str());
+  config.use_spdy = cl.HasSwitch("spdy");
+  if (cl.HasSwitch("spdy-streams")) {
+    config.spdy_streams =
+        atoi(cl.GetSwitchValueASCII("spdy-streams").c_str());
+  }
+  if (config.connections < 1 || config.requests < 1 ||
+      config.spdy_streams < 1) {
+    LOG(ERROR) << "Connections, requests and streams must be positive.";
+    return 1;
+  }
+
+  if (cl.HasSwitch("mix")) {
+    if (!net::ReadRequestMix(cl.GetSwitchValueASCII("mix"), &config)) {
+      LOG(ERROR) << "Unable to read a request mix from "
+                 << cl.GetSwitchValueASCII("mix");
+      return 1;
+    }
+  } else {
+    config.mix.push_back(std::make_pair(std::string("/"), 1));
+  }
+  for (size_t i = 0; i < config.mix.size(); ++i)
+    config.total_weight += config.mix[i].second;
+
+  std::string graph = cl.HasSwitch("perf-graph") ?
+      cl.GetSwitchValueASCII("perf-graph") : "flip_load";
+  std::string trace = cl.HasSwitch("perf-trace") ?
+      cl.GetSwitchValueASCII("perf-trace") :
+      (config.use_spdy ? "spdy" : "http");
+
+  net::LoadClient client(config);
+  if (!client.Run()) {
+    LOG(ERROR) << "Unable to connect to " << config.server << ":"
+               << config.port;
+    return 1;
+  }
+  client.PrintResults(graph, trace);
+  return 0;
+}
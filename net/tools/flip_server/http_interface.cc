@@ -317,6 +317,28 @@ void HttpSM::SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
   EnqueueDataFrame(df);
 }
 
+void HttpSM::SendFileDataChunk(FileData* file_data, size_t offset,
+                               size_t len) {
+  char chunk_buf[128];
+  int chunk_len = snprintf(chunk_buf, sizeof(chunk_buf), "%x\r\n",
+                           (unsigned int)len);
+  DataFrame* df = new DataFrame;
+  char* buffer = new char[chunk_len];
+  memcpy(buffer, chunk_buf, chunk_len);
+  df->data = buffer;
+  df->size = chunk_len;
+  df->delete_when_done = true;
+  EnqueueDataFrame(df);
+
+  EnqueueDataFrame(new FileDataFrame(file_data, offset, len));
+
+  df = new DataFrame;
+  df->data = "\r\n";
+  df->size = 2;
+  df->delete_when_done = false;
+  EnqueueDataFrame(df);
+}
+
 void HttpSM::EnqueueDataFrame(DataFrame* df) {
   VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: Enqueue data frame: stream "
           << stream_id_;
@@ -350,9 +372,7 @@ void HttpSM::GetOutput() {
   if (num_to_write > mci->max_segment_size)
     num_to_write = mci->max_segment_size;
 
-  SendDataFrame(mci->stream_id,
-                mci->file_data->body.data() + mci->body_bytes_consumed,
-                num_to_write, 0, true);
+  SendFileDataChunk(mci->file_data, mci->body_bytes_consumed, num_to_write);
   VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: GetOutput SendDataFrame["
           << mci->stream_id << "]: " << num_to_write;
   mci->body_bytes_consumed += num_to_write;
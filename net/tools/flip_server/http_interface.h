@@ -116,6 +116,9 @@ class HttpSM : public BalsaVisitorInterface,
   void SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
                          uint32 flags, bool compress);
   void EnqueueDataFrame(DataFrame* df);
+  // Sends |len| bytes of |file_data|'s body from |offset| as a chunk, without
+  // copying the body.
+  void SendFileDataChunk(FileData* file_data, size_t offset, size_t len);
   virtual void GetOutput() OVERRIDE;
 
  private:
@@ -13,6 +13,7 @@
 
 #include <deque>
 
+#include "base/hash_tables.h"
 #include "base/string_piece.h"
 #include "net/tools/dump_cache/url_to_filename_encoder.h"
 #include "net/tools/dump_cache/url_utilities.h"
@@ -49,32 +50,19 @@ FileData::FileData(BalsaHeaders* h, const std::string& b)
     : headers(h), body(b) {
 }
 
-FileData::FileData() {}
-
 FileData::~FileData() {}
 
-void FileData::CopyFrom(const FileData& file_data) {
-    headers = new BalsaHeaders;
-    headers->CopyFrom(*(file_data.headers));
-    filename = file_data.filename;
-    related_files = file_data.related_files;
-    body = file_data.body;
-  }
+size_t FileData::Size() const {
+  return headers->GetMemoryUsedLowerBound() + filename.size() + body.size();
+}
 
-MemoryCache::MemoryCache() {}
+MemoryCache::Shard::Shard() : bytes(0) {}
 
-MemoryCache::~MemoryCache() {}
+MemoryCache::Shard::~Shard() {}
 
-void MemoryCache::CloneFrom(const MemoryCache& mc) {
-  for (Files::const_iterator i = mc.files_.begin();
-       i != mc.files_.end();
-       ++i) {
-    Files::iterator out_i =
-        files_.insert(make_pair(i->first, FileData())).first;
-    out_i->second.CopyFrom(i->second);
-    cwd_ = mc.cwd_;
-  }
-}
+MemoryCache::MemoryCache() : max_bytes_(0) {}
+
+MemoryCache::~MemoryCache() {}
 
 void MemoryCache::AddFiles() {
   std::deque<std::string> paths;
@@ -137,13 +125,16 @@ void MemoryCache::ReadToString(const char* filename, std::string* output) {
   close(fd);
 }
 
-void MemoryCache::ReadAndStoreFileContents(const char* filename) {
+scoped_refptr<FileData> MemoryCache::ReadAndStoreFileContents(
+    const char* filename) {
   StoreBodyAndHeadersVisitor visitor;
   BalsaFrame framer;
   framer.set_balsa_visitor(&visitor);
   framer.set_balsa_headers(&(visitor.headers));
   std::string filename_contents;
   ReadToString(filename, &filename_contents);
+  if (filename_contents.empty())
+    return NULL;
 
   // Ugly hack to make everything look like 1.1.
   if (filename_contents.find("HTTP/1.0") == 0)
@@ -160,9 +151,9 @@ void MemoryCache::ReadAndStoreFileContents(const char* filename) {
         " framing file: " << filename;
       if (framer.Error()) {
         LOG(INFO) << "********************************************ERROR!";
-        return;
+        return NULL;
       }
-      return;
+      return NULL;
     }
     if (framer.MessageFullyRead()) {
       // If no Content-Length or Transfer-Encoding was captured in the
@@ -196,27 +187,30 @@ void MemoryCache::ReadAndStoreFileContents(const char* filename) {
   std::string filename_stripped = std::string(filename).substr(cwd_.size() + 1);
   LOG(INFO) << "Adding file (" << visitor.body.length() << " bytes): "
             << filename_stripped;
-  files_[filename_stripped] = FileData();
-  FileData& fd = files_[filename_stripped];
-  fd = FileData(headers, visitor.body);
-  fd.filename = std::string(filename_stripped,
-                            filename_stripped.find_first_of('/'));
+  scoped_refptr<FileData> fd(new FileData(headers, visitor.body));
+  fd->filename = std::string(filename_stripped,
+                             filename_stripped.find_first_of('/'));
+  Insert(filename_stripped, fd);
+  return fd;
 }
 
-FileData* MemoryCache::GetFileData(const std::string& filename) {
-  Files::iterator fi = files_.end();
+scoped_refptr<FileData> MemoryCache::GetFileData(const std::string& filename) {
+  std::string html_filename;
   if (filename.compare(filename.length() - 5, 5, ".html", 5) == 0) {
-    std::string new_filename(filename.data(), filename.size() - 5);
-    new_filename += ".http";
-    fi = files_.find(new_filename);
+    html_filename.assign(filename.data(), filename.size() - 5);
+    html_filename += ".http";
   }
-  if (fi == files_.end())
-    fi = files_.find(filename);
 
-  if (fi == files_.end()) {
-    return NULL;
-  }
-  return &(fi->second);
+  scoped_refptr<FileData> file_data;
+  if (!html_filename.empty())
+    file_data = Lookup(html_filename);
+  if (!file_data)
+    file_data = Lookup(filename);
+  if (!file_data && !html_filename.empty())
+    file_data = LoadFromDisk(html_filename);
+  if (!file_data)
+    file_data = LoadFromDisk(filename);
+  return file_data;
 }
 
 bool MemoryCache::AssignFileData(const std::string& filename,
@@ -229,5 +223,63 @@ bool MemoryCache::AssignFileData(const std::string& filename,
   return true;
 }
 
+MemoryCache::Shard* MemoryCache::GetShard(const std::string& filename) {
+  size_t hash = BASE_HASH_NAMESPACE::hash<std::string>()(filename);
+  return &shards_[hash % kNumShards];
+}
+
+void MemoryCache::Insert(const std::string& filename, FileData* file_data) {
+  Shard* shard = GetShard(filename);
+  size_t max_shard_bytes = max_bytes_ / kNumShards;
+
+  base::AutoLock lock(shard->lock);
+  std::map<std::string, Entry>::iterator it = shard->files.find(filename);
+  if (it != shard->files.end()) {
+    shard->bytes -= it->second.file_data->Size();
+    shard->lru.erase(it->second.lru_position);
+  } else {
+    it = shard->files.insert(std::make_pair(filename, Entry())).first;
+  }
+  shard->lru.push_front(filename);
+  it->second.file_data = file_data;
+  it->second.lru_position = shard->lru.begin();
+  shard->bytes += file_data->Size();
+
+  // Always keep the newest response, even if it is larger than the limit.
+  while (max_bytes_ && shard->bytes > max_shard_bytes &&
+         shard->lru.size() > 1) {
+    std::map<std::string, Entry>::iterator oldest =
+        shard->files.find(shard->lru.back());
+    VLOG(1) << "Evicting " << oldest->first;
+    shard->bytes -= oldest->second.file_data->Size();
+    shard->files.erase(oldest);
+    shard->lru.pop_back();
+  }
+}
+
+scoped_refptr<FileData> MemoryCache::Lookup(const std::string& filename) {
+  Shard* shard = GetShard(filename);
+  base::AutoLock lock(shard->lock);
+  std::map<std::string, Entry>::iterator it = shard->files.find(filename);
+  if (it == shard->files.end())
+    return NULL;
+  shard->lru.splice(shard->lru.begin(), shard->lru, it->second.lru_position);
+  return it->second.file_data;
+}
+
+scoped_refptr<FileData> MemoryCache::LoadFromDisk(
+    const std::string& filename) {
+  // Only responses that were evicted, or not loaded for want of room, are
+  // on disk but not in memory.  Also keep requests from reaching files
+  // outside of the cache directory.
+  if (!max_bytes_ || cwd_.empty() ||
+      filename.find("..") != std::string::npos) {
+    return NULL;
+  }
+  // Another thread may evict the response before this one could look it up,
+  // so return the one that was read.
+  return ReadAndStoreFileContents((cwd_ + "/" + filename).c_str());
+}
+
 }  // namespace net
 
@@ -5,11 +5,15 @@
 #ifndef NET_TOOLS_FLIP_SERVER_MEM_CACHE_H_
 #define NET_TOOLS_FLIP_SERVER_MEM_CACHE_H_
 
+#include <list>
 #include <map>
 #include <string>
 #include <vector>
 
 #include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
 #include "net/tools/flip_server/balsa_headers.h"
 #include "net/tools/flip_server/balsa_visitor_interface.h"
 #include "net/tools/flip_server/constants.h"
@@ -62,17 +66,24 @@ class StoreBodyAndHeadersVisitor: public BalsaVisitorInterface {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-struct FileData {
-  FileData();
+// A cached response.  Streams being sent hold a reference, so a response
+// that is evicted or replaced stays alive until they are done with it.
+struct FileData : public base::RefCountedThreadSafe<FileData> {
+  // Takes ownership of |h|.
   FileData(BalsaHeaders* h, const std::string& b);
-  ~FileData();
-  void CopyFrom(const FileData& file_data);
 
-  BalsaHeaders* headers;
+  // The memory the response takes up in the cache.
+  size_t Size() const;
+
+  scoped_ptr<BalsaHeaders> headers;
   std::string filename;
   // priority, filename
   std::vector< std::pair<int, std::string> > related_files;
   std::string body;
+
+ private:
+  friend class base::RefCountedThreadSafe<FileData>;
+  ~FileData();
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -95,7 +106,7 @@ class MemCacheIter {
       stream_id(0),
       max_segment_size(kInitialDataSendersThreshold),
       bytes_sent(0) {}
-  FileData* file_data;
+  scoped_refptr<FileData> file_data;
   int priority;
   bool transformed_header;
   size_t body_bytes_consumed;
@@ -106,28 +117,73 @@ class MemCacheIter {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Responses captured to disk, kept in memory.  The cache is split into shards
+// with a lock each, so that it can be shared by all acceptor threads without
+// them waiting on one another much.  When a byte limit is set, each shard
+// evicts its least recently used responses to stay within its share of it,
+// and responses that are not in memory are read from disk when requested.
 class MemoryCache {
- public:
-  typedef std::map<std::string, FileData> Files;
-
  public:
   MemoryCache();
   ~MemoryCache();
 
-  void CloneFrom(const MemoryCache& mc);
+  // Limits the bytes of responses kept in memory.  0, the default, means no
+  // limit.  Must be called before responses are added.
+  void set_max_bytes(size_t max_bytes) { max_bytes_ = max_bytes; }
 
+  // Loads the responses under FLAGS_cache_base_dir, which are then also where
+  // GetFileData() looks for responses that are not in memory.
   void AddFiles();
 
   void ReadToString(const char* filename, std::string* output);
 
-  void ReadAndStoreFileContents(const char* filename);
+  // Stores |filename| and returns its response, or returns NULL if it could
+  // not be read or parsed.
+  scoped_refptr<FileData> ReadAndStoreFileContents(const char* filename);
 
-  FileData* GetFileData(const std::string& filename);
+  // Returns the response for |filename|, or NULL if there is none.
+  scoped_refptr<FileData> GetFileData(const std::string& filename);
 
   bool AssignFileData(const std::string& filename, MemCacheIter* mci);
 
-  Files files_;
+ private:
+  struct Entry {
+    scoped_refptr<FileData> file_data;
+    // Position of the entry's key in its shard's |lru|.
+    std::list<std::string>::iterator lru_position;
+  };
+
+  struct Shard {
+    Shard();
+    ~Shard();
+
+    base::Lock lock;
+    std::map<std::string, Entry> files;
+    // Keys of |files|, most recently used first.
+    std::list<std::string> lru;
+    size_t bytes;
+  };
+
+  static const int kNumShards = 16;
+
+  Shard* GetShard(const std::string& filename);
+
+  // Stores |file_data| as the response for |filename|, evicting other
+  // responses from its shard as needed.
+  void Insert(const std::string& filename, FileData* file_data);
+
+  // Looks up |filename| in memory, marking it as recently used.
+  scoped_refptr<FileData> Lookup(const std::string& filename);
+
+  // Loads |filename| from disk.
+  scoped_refptr<FileData> LoadFromDisk(const std::string& filename);
+
+  Shard shards_[kNumShards];
+  size_t max_bytes_;
+  // The directory AddFiles() loaded from.  Empty before AddFiles() is called.
   std::string cwd_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryCache);
 };
 
 class NotifierInterface {
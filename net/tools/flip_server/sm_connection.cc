@@ -7,7 +7,9 @@
 #include <errno.h>
 #include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
+#include <algorithm>
 #include <list>
 #include <string>
 
@@ -28,6 +30,16 @@ DataFrame::~DataFrame() {
     delete[] data;
 }
 
+FileDataFrame::FileDataFrame(FileData* file_data, size_t offset,
+                             size_t length)
+    : file_data_(file_data) {
+  DCHECK_LE(offset + length, file_data->body.size());
+  data = file_data->body.data() + offset;
+  size = length;
+}
+
+FileDataFrame::~FileDataFrame() {}
+
 SMConnection::SMConnection(EpollServer* epoll_server,
                            SSLState* ssl_state,
                            MemoryCache* memory_cache,
@@ -224,6 +236,54 @@ int SMConnection::Send(const char* data, int len, int flags) {
   return rv;
 }
 
+ssize_t SMConnection::SendOutputList(size_t max_bytes, int flags) {
+  DCHECK(!ssl_);
+  // Enough for several response chunks along with their framing.
+  const int kMaxIovecs = 16;
+  struct iovec iov[kMaxIovecs];
+  int iov_count = 0;
+  size_t total = 0;
+  for (OutputList::iterator i = output_list_.begin();
+       i != output_list_.end() && iov_count < kMaxIovecs && total < max_bytes;
+       ++i) {
+    DataFrame* data_frame = *i;
+    if (data_frame->index >= data_frame->size)
+      continue;
+    size_t len = std::min(data_frame->size - data_frame->index,
+                          max_bytes - total);
+    iov[iov_count].iov_base =
+        const_cast<char*>(data_frame->data + data_frame->index);
+    iov[iov_count].iov_len = len;
+    ++iov_count;
+    total += len;
+  }
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
+  CorkSocket();
+  ssize_t rv = sendmsg(fd_, &msg, flags);
+  int stored_errno = errno;
+  if (!(flags & MSG_MORE))
+    UncorkSocket();
+  errno = stored_errno;
+  return rv;
+}
+
+void SMConnection::ConsumeOutputList(size_t bytes) {
+  while (bytes > 0 && !output_list_.empty()) {
+    DataFrame* data_frame = output_list_.front();
+    size_t len = std::min(data_frame->size - data_frame->index, bytes);
+    data_frame->index += len;
+    bytes -= len;
+    if (data_frame->index < data_frame->size)
+      break;
+    output_list_.pop_front();
+    delete data_frame;
+  }
+}
+
 void SMConnection::OnRegistration(EpollServer* eps, int fd, int event_mask) {
   registered_in_epoll_server_ = true;
 }
@@ -575,7 +635,17 @@ bool SMConnection::DoWrite() {
       flags |= MSG_MORE;
     }
     VLOG(2) << log_prefix_ << "Attempting to send " << size << " bytes.";
-    ssize_t bytes_written = Send(bytes, size, flags);
+    ssize_t bytes_written;
+    if (ssl_) {
+      bytes_written = Send(bytes, size, flags);
+    } else {
+      // Send several frames at once, and bodies from the cache where they
+      // are, rather than one send() per frame.
+      bytes_written = SendOutputList(
+          std::max(max_bytes_sent_per_dowrite_ - bytes_sent,
+                   static_cast<size_t>(size)),
+          flags);
+    }
     int stored_errno = errno;
     if (bytes_written == -1) {
       switch (stored_errno) {
@@ -597,7 +667,7 @@ bool SMConnection::DoWrite() {
     } else if (bytes_written > 0) {
       VLOG(2) << log_prefix_ << ACCEPTOR_CLIENT_IDENT << "Wrote: "
               << bytes_written << " bytes";
-      data_frame->index += bytes_written;
+      ConsumeOutputList(bytes_written);
       bytes_sent += bytes_written;
       continue;
     } else if (bytes_written == -2) {
@@ -610,6 +680,8 @@ bool SMConnection::DoWrite() {
     goto error_or_close;
   }
  done:
+  if (bytes_sent > 0)
+    acceptor_->AddBytesSent(bytes_sent);
   UncorkSocket();
   return true;
 
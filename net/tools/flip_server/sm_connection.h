@@ -36,6 +36,17 @@ class DataFrame {
   virtual ~DataFrame();
 };
 
+// A frame that sends part of a cached response's body where it is, rather
+// than from a copy.  Holds a reference to the response until it is sent.
+class FileDataFrame : public DataFrame {
+ public:
+  FileDataFrame(FileData* file_data, size_t offset, size_t length);
+  virtual ~FileDataFrame();
+
+ private:
+  scoped_refptr<FileData> file_data_;
+};
+
 typedef std::list<DataFrame*> OutputList;
 
 class SMConnection : public SMConnectionInterface,
@@ -79,6 +90,10 @@ class SMConnection : public SMConnectionInterface,
 
   int Send(const char* data, int len, int flags);
 
+  // Sends as much of the output list as fits in |max_bytes| with a single
+  // gathering write.  Only for connections without SSL.
+  ssize_t SendOutputList(size_t max_bytes, int flags);
+
   // EpollCallbackInterface interface.
   virtual void OnRegistration(EpollServer* eps,
                               int fd,
@@ -107,6 +122,8 @@ class SMConnection : public SMConnectionInterface,
 
   bool DoRead();
   bool DoWrite();
+  // Marks |bytes| of the output list as sent, removing finished frames.
+  void ConsumeOutputList(size_t bytes);
   bool DoConsumeReadData();
   void Reset();
 
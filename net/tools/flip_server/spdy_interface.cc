@@ -483,6 +483,27 @@ void SpdySM::SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
   }
 }
 
+void SpdySM::SendFileDataFrames(uint32 stream_id, FileData* file_data,
+                                size_t offset, size_t len) {
+  while (len > 0) {
+    size_t size = std::min(len, static_cast<size_t>(kSpdySegmentSize));
+    SpdyDataFrame* fdf = buffered_spdy_framer_->CreateDataFrame(
+        stream_id, NULL, 0, DATA_FLAG_NONE);
+    fdf->set_length(size);
+    DataFrame* header = new SpdyFrameDataFrame(fdf);
+    // Only the header is in |fdf|; the body follows in its own frame.
+    header->size = SpdyFrame::kHeaderSize;
+    EnqueueDataFrame(header);
+    EnqueueDataFrame(new FileDataFrame(file_data, offset, size));
+
+    VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: Sending data frame "
+            << stream_id << " [" << size << "] from cache";
+
+    offset += size;
+    len -= size;
+  }
+}
+
 void SpdySM::EnqueueDataFrame(DataFrame* df) {
   connection_->EnqueueDataFrame(df);
 }
@@ -528,19 +549,8 @@ void SpdySM::GetOutput() {
     if (num_to_write > mci->max_segment_size)
       num_to_write = mci->max_segment_size;
 
-    bool should_compress = false;
-    if (!mci->file_data->headers->HasHeader("content-encoding")) {
-      if (mci->file_data->headers->HasHeader("content-type")) {
-        std::string content_type =
-            mci->file_data->headers->GetHeader("content-type").as_string();
-        if (content_type.find("image") == content_type.npos)
-          should_compress = true;
-      }
-    }
-
-    SendDataFrame(mci->stream_id,
-                  mci->file_data->body.data() + mci->body_bytes_consumed,
-                  num_to_write, 0, should_compress);
+    SendFileDataFrames(mci->stream_id, mci->file_data,
+                       mci->body_bytes_consumed, num_to_write);
     VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: GetOutput SendDataFrame["
             << mci->stream_id << "]: " << num_to_write;
     mci->body_bytes_consumed += num_to_write;
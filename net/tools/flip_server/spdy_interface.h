@@ -131,6 +131,11 @@ class SpdySM : public BufferedSpdyFramerVisitorInterface,
   void SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
                          SpdyDataFlags flags, bool compress);
   void EnqueueDataFrame(DataFrame* df);
+  // Sends |len| bytes of |file_data|'s body from |offset| in DATA frames,
+  // writing each frame's header before the body rather than copying the body
+  // into the frame.
+  void SendFileDataFrames(uint32 stream_id, FileData* file_data,
+                          size_t offset, size_t len);
   virtual void GetOutput() OVERRIDE;
  private:
   uint64 seq_num_;
@@ -55,6 +55,36 @@ class NET_EXPORT DatagramServerSocket : public DatagramSocket {
                      const IPEndPoint& address,
                      const CompletionCallback& callback) = 0;
 
+  // Read the datagrams that have already arrived, up to |max_packets| of
+  // them, in as few system calls as possible. Never waits for more.
+  // |buf| holds |max_packets| slots of |buf_len| bytes each; datagram i is
+  //   read into the slot at offset i * |buf_len|.
+  // |lengths| and |addresses| are arrays of |max_packets| entries that
+  //   receive the size and the sender of each datagram. A size is
+  //   ERR_MSG_TOO_BIG if the datagram did not fit its slot.
+  // Returns the number of datagrams read, or a net error. Returns 0 if
+  // nothing was waiting or if the socket cannot read in batches, in which
+  // case RecvFrom() is to be used. Fewer than |max_packets| means that the
+  // queue was emptied, so callers need not call again before RecvFrom().
+  // Must not be called while a RecvFrom() is pending.
+  virtual int RecvBatch(IOBuffer* buf,
+                        int buf_len,
+                        int max_packets,
+                        int* lengths,
+                        IPEndPoint* addresses) = 0;
+
+  // Send |count| datagrams in as few system calls as possible, without
+  // waiting. Datagram i is |buf_lens|[i] bytes of |bufs|[i] sent to
+  // |addresses|[i].
+  // Returns the number of datagrams sent from the start of the arrays, or a
+  // net error. Returns 0 if the socket buffer is full or if the socket
+  // cannot send in batches; the remaining datagrams are to be sent with
+  // SendTo(). Must not be called while a SendTo() is pending.
+  virtual int SendBatch(IOBuffer* const* bufs,
+                        const int* buf_lens,
+                        const IPEndPoint* addresses,
+                        int count) = 0;
+
   // Set the receive buffer size (in bytes) for the socket.
   virtual bool SetReceiveBufferSize(int32 size) = 0;
 
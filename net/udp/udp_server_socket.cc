@@ -37,6 +37,21 @@ int UDPServerSocket::SendTo(IOBuffer* buf,
   return socket_.SendTo(buf, buf_len, address, callback);
 }
 
+int UDPServerSocket::RecvBatch(IOBuffer* buf,
+                               int buf_len,
+                               int max_packets,
+                               int* lengths,
+                               IPEndPoint* addresses) {
+  return socket_.RecvBatch(buf, buf_len, max_packets, lengths, addresses);
+}
+
+int UDPServerSocket::SendBatch(IOBuffer* const* bufs,
+                               const int* buf_lens,
+                               const IPEndPoint* addresses,
+                               int count) {
+  return socket_.SendBatch(bufs, buf_lens, addresses, count);
+}
+
 bool UDPServerSocket::SetReceiveBufferSize(int32 size) {
   return socket_.SetReceiveBufferSize(size);
 }
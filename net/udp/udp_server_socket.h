@@ -32,6 +32,15 @@ class NET_EXPORT UDPServerSocket : public DatagramServerSocket {
                      int buf_len,
                      const IPEndPoint& address,
                      const CompletionCallback& callback) OVERRIDE;
+  virtual int RecvBatch(IOBuffer* buf,
+                        int buf_len,
+                        int max_packets,
+                        int* lengths,
+                        IPEndPoint* addresses) OVERRIDE;
+  virtual int SendBatch(IOBuffer* const* bufs,
+                        const int* buf_lens,
+                        const IPEndPoint* addresses,
+                        int count) OVERRIDE;
   virtual bool SetReceiveBufferSize(int32 size) OVERRIDE;
   virtual bool SetSendBufferSize(int32 size) OVERRIDE;
   virtual void Close() OVERRIDE;
@@ -7,7 +7,12 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netdb.h>
+#include <string.h>
 #include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <vector>
 
 #include "base/eintr_wrapper.h"
 #include "base/logging.h"
@@ -30,10 +35,39 @@ static const int kBindRetries = 10;
 static const int kPortStart = 1024;
 static const int kPortEnd = 65535;
 
-}  // namespace net
+// The kernel's struct mmsghdr, which older C libraries do not declare.
+struct MultipleMessageHeader {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+
+}  // namespace
 
 namespace net {
 
+struct UDPSocketLibevent::BatchBuffers {
+  // Makes room for |count| messages, and points header i at the i-th
+  // iovec and address. The fields the caller fills in are left alone.
+  void Prepare(int count) {
+    if (static_cast<int>(headers.size()) < count) {
+      headers.resize(count);
+      iovs.resize(count);
+      addrs.resize(count);
+    }
+    memset(&headers[0], 0, count * sizeof(headers[0]));
+    for (int i = 0; i < count; ++i) {
+      headers[i].msg_hdr.msg_name = &addrs[i];
+      headers[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      headers[i].msg_hdr.msg_iov = &iovs[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+
+  std::vector<MultipleMessageHeader> headers;
+  std::vector<struct iovec> iovs;
+  std::vector<struct sockaddr_storage> addrs;
+};
+
 UDPSocketLibevent::UDPSocketLibevent(
     DatagramSocket::BindType bind_type,
     const RandIntCallback& rand_int_cb,
@@ -47,6 +81,9 @@ UDPSocketLibevent::UDPSocketLibevent(
           read_buf_len_(0),
           recv_from_address_(NULL),
           write_buf_len_(0),
+          recvmmsg_supported_(true),
+          sendmmsg_supported_(true),
+          recv_queue_empty_(false),
           net_log_(BoundNetLog::Make(net_log, NetLog::SOURCE_UDP_SOCKET)) {
   scoped_refptr<NetLog::EventParameters> params;
   if (source.is_valid())
@@ -76,6 +113,7 @@ void UDPSocketLibevent::Close() {
   write_buf_len_ = 0;
   write_callback_.Reset();
   send_to_address_.reset();
+  recv_queue_empty_ = false;
 
   bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
   DCHECK(ok);
@@ -149,7 +187,10 @@ int UDPSocketLibevent::RecvFrom(IOBuffer* buf,
   DCHECK(!callback.is_null());  // Synchronous operation not supported
   DCHECK_GT(buf_len, 0);
 
-  int nread = InternalRecvFrom(buf, buf_len, address);
+  // After a batch that emptied the queue, a read would only fail with EAGAIN.
+  int nread = recv_queue_empty_ ?
+      ERR_IO_PENDING : InternalRecvFrom(buf, buf_len, address);
+  recv_queue_empty_ = false;
   if (nread != ERR_IO_PENDING)
     return nread;
 
@@ -267,6 +308,115 @@ int UDPSocketLibevent::Bind(const IPEndPoint& address) {
   return rv;
 }
 
+int UDPSocketLibevent::RecvBatch(IOBuffer* buf,
+                                 int buf_len,
+                                 int max_packets,
+                                 int* lengths,
+                                 IPEndPoint* addresses) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(read_callback_.is_null());
+  DCHECK_GT(buf_len, 0);
+  DCHECK_GT(max_packets, 0);
+
+#if defined(__NR_recvmmsg)
+  if (recvmmsg_supported_) {
+    if (!batch_buffers_.get())
+      batch_buffers_.reset(new BatchBuffers);
+    batch_buffers_->Prepare(max_packets);
+    std::vector<MultipleMessageHeader>& headers = batch_buffers_->headers;
+    std::vector<struct iovec>& iovs = batch_buffers_->iovs;
+    std::vector<struct sockaddr_storage>& addrs = batch_buffers_->addrs;
+    for (int i = 0; i < max_packets; ++i) {
+      iovs[i].iov_base = buf->data() + i * buf_len;
+      iovs[i].iov_len = buf_len;
+    }
+
+    int count = HANDLE_EINTR(syscall(__NR_recvmmsg, socket_, &headers[0],
+                                     max_packets, MSG_DONTWAIT, NULL));
+    if (count >= 0) {
+      // With MSG_DONTWAIT, recvmmsg() stops early only when the queue is
+      // empty.
+      recv_queue_empty_ = count < max_packets;
+      for (int i = 0; i < count; ++i) {
+        const struct msghdr& header = headers[i].msg_hdr;
+        struct sockaddr* addr = reinterpret_cast<struct sockaddr*>(&addrs[i]);
+        lengths[i] = headers[i].msg_len;
+        if (header.msg_flags & MSG_TRUNC)
+          lengths[i] = ERR_MSG_TOO_BIG;
+        else if (!addresses[i].FromSockAddr(addr, header.msg_namelen))
+          lengths[i] = ERR_FAILED;
+        LogRead(lengths[i], static_cast<char*>(iovs[i].iov_base),
+                header.msg_namelen, addr);
+      }
+      return count;
+    }
+    if (errno != ENOSYS) {
+      int result = MapSystemError(errno);
+      if (result != ERR_IO_PENDING)
+        return result;
+      recv_queue_empty_ = true;
+      return 0;
+    }
+    // Kernels before 2.6.33 lack recvmmsg().
+    recvmmsg_supported_ = false;
+  }
+#endif
+  return 0;
+}
+
+int UDPSocketLibevent::SendBatch(IOBuffer* const* bufs,
+                                 const int* buf_lens,
+                                 const IPEndPoint* addresses,
+                                 int count) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(write_callback_.is_null());
+  DCHECK_GT(count, 0);
+
+#if defined(__NR_sendmmsg)
+  if (sendmmsg_supported_) {
+    if (!batch_buffers_.get())
+      batch_buffers_.reset(new BatchBuffers);
+    batch_buffers_->Prepare(count);
+    std::vector<MultipleMessageHeader>& headers = batch_buffers_->headers;
+    std::vector<struct iovec>& iovs = batch_buffers_->iovs;
+    std::vector<struct sockaddr_storage>& addrs = batch_buffers_->addrs;
+    for (int i = 0; i < count; ++i) {
+      size_t addr_len = sizeof(addrs[i]);
+      if (!addresses[i].ToSockAddr(reinterpret_cast<struct sockaddr*>(
+              &addrs[i]), &addr_len)) {
+        if (i == 0) {
+          LogWrite(ERR_FAILED, NULL, NULL);
+          return ERR_FAILED;
+        }
+        // Send what comes before; SendTo() reports the error.
+        count = i;
+        break;
+      }
+      iovs[i].iov_base = bufs[i]->data();
+      iovs[i].iov_len = buf_lens[i];
+      headers[i].msg_hdr.msg_namelen = addr_len;
+    }
+
+    int sent = HANDLE_EINTR(syscall(__NR_sendmmsg, socket_, &headers[0],
+                                    count, MSG_DONTWAIT));
+    if (sent >= 0) {
+      for (int i = 0; i < sent; ++i)
+        LogWrite(headers[i].msg_len, bufs[i]->data(), &addresses[i]);
+      return sent;
+    }
+    if (errno != ENOSYS) {
+      int result = MapSystemError(errno);
+      return result == ERR_IO_PENDING ? 0 : result;
+    }
+    // Kernels before 3.0 lack sendmmsg().
+    sendmmsg_supported_ = false;
+  }
+#endif
+  return 0;
+}
+
 bool UDPSocketLibevent::SetReceiveBufferSize(int32 size) {
   DCHECK(CalledOnValidThread());
   int rv = setsockopt(socket_, SOL_SOCKET, SO_RCVBUF,
@@ -94,6 +94,19 @@ class NET_EXPORT UDPSocketLibevent : public base::NonThreadSafe {
              const IPEndPoint& address,
              const CompletionCallback& callback);
 
+  // Read or send many datagrams at once; see DatagramServerSocket. A
+  // RecvFrom() that follows a batch which emptied the receive queue waits for
+  // the socket without trying to read first.
+  int RecvBatch(IOBuffer* buf,
+                int buf_len,
+                int max_packets,
+                int* lengths,
+                IPEndPoint* addresses);
+  int SendBatch(IOBuffer* const* bufs,
+                const int* buf_lens,
+                const IPEndPoint* addresses,
+                int count);
+
   // Set the receive buffer size (in bytes) for the socket.
   bool SetReceiveBufferSize(int32 size);
 
@@ -108,6 +121,11 @@ class NET_EXPORT UDPSocketLibevent : public base::NonThreadSafe {
  private:
   static const int kInvalidSocket = -1;
 
+  // The message headers, buffer descriptions and addresses that recvmmsg()
+  // and sendmmsg() take. Kept between batches so that each batch doesn't
+  // allocate them again.
+  struct BatchBuffers;
+
   class ReadWatcher : public MessageLoopForIO::Watcher {
    public:
     explicit ReadWatcher(UDPSocketLibevent* socket) : socket_(socket) {}
@@ -209,6 +227,18 @@ class NET_EXPORT UDPSocketLibevent : public base::NonThreadSafe {
   int write_buf_len_;
   scoped_ptr<IPEndPoint> send_to_address_;
 
+  // Cleared once the kernel reports that it lacks recvmmsg() or sendmmsg(),
+  // so that batches are not attempted again.
+  bool recvmmsg_supported_;
+  bool sendmmsg_supported_;
+
+  // Set when the last RecvBatch() read fewer datagrams than it asked for, so
+  // that the receive queue was empty, and cleared by the next RecvFrom().
+  bool recv_queue_empty_;
+
+  // Created by the first RecvBatch() or SendBatch().
+  scoped_ptr<BatchBuffers> batch_buffers_;
+
   // External callback; called when read is complete.
   CompletionCallback read_callback_;
 
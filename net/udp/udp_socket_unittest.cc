@@ -444,6 +444,58 @@ TEST_F(UDPSocketTest, CloseWithPendingRead) {
   EXPECT_FALSE(callback.have_result());
 }
 
+// Send and read several datagrams in one batch each. Kernels without
+// sendmmsg() or recvmmsg(), and Windows, do no batches at all.
+TEST_F(UDPSocketTest, SendAndRecvBatch) {
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", 0, &bind_address);
+  UDPServerSocket server(NULL, NetLog::Source());
+  ASSERT_EQ(OK, server.Listen(bind_address));
+  IPEndPoint server_address;
+  ASSERT_EQ(OK, server.GetLocalAddress(&server_address));
+
+  const int kPackets = 3;
+  const char* const kMessages[kPackets] = { "one", "two", "three" };
+  scoped_refptr<IOBuffer> send_buffers[kPackets];
+  IOBuffer* bufs[kPackets];
+  int buf_lens[kPackets];
+  IPEndPoint addresses[kPackets];
+  for (int i = 0; i < kPackets; ++i) {
+    send_buffers[i] = new StringIOBuffer(kMessages[i]);
+    bufs[i] = send_buffers[i];
+    buf_lens[i] = strlen(kMessages[i]);
+    addresses[i] = server_address;
+  }
+  int sent = server.SendBatch(bufs, buf_lens, addresses, kPackets);
+  if (sent == 0)
+    return;
+  ASSERT_EQ(kPackets, sent);
+
+  const int kSlotSize = 16;
+  const int kSlots = 8;
+  scoped_refptr<IOBuffer> recv_buffer(new IOBuffer(kSlotSize * kSlots));
+  int lengths[kSlots];
+  IPEndPoint senders[kSlots];
+  int received = 0;
+  while (received < kPackets) {
+    int rv = server.RecvBatch(recv_buffer, kSlotSize, kSlots, lengths,
+                              senders);
+    ASSERT_GE(rv, 0);
+    if (rv == 0) {
+      // Wait for the datagrams to be looped back.
+      EXPECT_EQ(kMessages[received], RecvFromSocket(&server));
+      ++received;
+      continue;
+    }
+    for (int i = 0; i < rv; ++i, ++received) {
+      EXPECT_EQ(kMessages[received],
+                std::string(recv_buffer->data() + i * kSlotSize, lengths[i]));
+      EXPECT_EQ(server_address, senders[i]);
+    }
+  }
+  EXPECT_EQ(kPackets, received);
+}
+
 }  // namespace
 
 }  // namespace net
@@ -252,6 +252,23 @@ int UDPSocketWin::CreateSocket(const IPEndPoint& address) {
   return OK;
 }
 
+int UDPSocketWin::RecvBatch(IOBuffer* buf,
+                            int buf_len,
+                            int max_packets,
+                            int* lengths,
+                            IPEndPoint* addresses) {
+  DCHECK(CalledOnValidThread());
+  return 0;
+}
+
+int UDPSocketWin::SendBatch(IOBuffer* const* bufs,
+                            const int* buf_lens,
+                            const IPEndPoint* addresses,
+                            int count) {
+  DCHECK(CalledOnValidThread());
+  return 0;
+}
+
 bool UDPSocketWin::SetReceiveBufferSize(int32 size) {
   DCHECK(CalledOnValidThread());
   int rv = setsockopt(socket_, SOL_SOCKET, SO_RCVBUF,
@@ -95,6 +95,18 @@ class NET_EXPORT UDPSocketWin : NON_EXPORTED_BASE(public base::NonThreadSafe) {
              const IPEndPoint& address,
              const CompletionCallback& callback);
 
+  // Read or send many datagrams at once; see DatagramServerSocket.
+  // Batches are not supported on Windows; both return 0.
+  int RecvBatch(IOBuffer* buf,
+                int buf_len,
+                int max_packets,
+                int* lengths,
+                IPEndPoint* addresses);
+  int SendBatch(IOBuffer* const* bufs,
+                const int* buf_lens,
+                const IPEndPoint* addresses,
+                int count);
+
   // Set the receive buffer size (in bytes) for the socket.
   bool SetReceiveBufferSize(int32 size);
 
@@ -0,0 +1,637 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/url_request/url_request_coalescer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop.h"
+#include "base/string_number_conversions.h"
+#include "net/base/io_buffer.h"
+#include "net/base/load_states.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_job.h"
+#include "net/url_request/url_request_status.h"
+
+namespace net {
+
+namespace {
+
+// Size of the reads made by a fetch.
+const int kReadBufferSize = 32 * 1024;
+
+// A fetch stops reading while this much of its body is buffered for the
+// slowest of its requests.
+const size_t kMaxBufferedBytes = 1024 * 1024;
+
+// Consumed data is dropped from the front of the buffer in chunks at least
+// this large.
+const size_t kMinTrimBytes = 64 * 1024;
+
+}  // namespace
+
+// The job of a request that takes its response from a Fetch.
+class URLRequestCoalescer::Job : public URLRequestJob {
+ public:
+  Job(URLRequest* request, URLRequestCoalescer* coalescer, Fetch* fetch);
+
+  // How much of the body this job has read.
+  int64 offset() const { return offset_; }
+  void set_offset(int64 offset) { offset_ = offset; }
+
+  // Called by the fetch.
+  void OnHeadersReceived(const HttpResponseInfo& response_info);
+  void OnStartFailed(int error);
+  void OnRestartRequired();
+  void OnDataAvailable();
+
+  // URLRequestJob methods:
+  virtual void Start() OVERRIDE;
+  virtual void Kill() OVERRIDE;
+  virtual LoadState GetLoadState() const OVERRIDE;
+  virtual bool GetCharset(std::string* charset) OVERRIDE;
+  virtual void GetResponseInfo(HttpResponseInfo* info) OVERRIDE;
+  virtual bool GetMimeType(std::string* mime_type) const OVERRIDE;
+  virtual int GetResponseCode() const OVERRIDE;
+
+ protected:
+  virtual ~Job();
+
+  // URLRequestJob methods:
+  virtual bool ReadRawData(IOBuffer* buf, int buf_size,
+                           int* bytes_read) OVERRIDE;
+
+ private:
+  void DetachFromFetch();
+
+  scoped_refptr<URLRequestCoalescer> coalescer_;
+  Fetch* fetch_;
+  int64 offset_;
+  HttpResponseInfo response_info_;
+
+  // The buffer of a read that waits for the fetch.
+  scoped_refptr<IOBuffer> read_buffer_;
+  int read_buffer_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(Job);
+};
+
+// The request made on behalf of all the jobs that share its response. A fetch
+// deletes itself, soon after its last job is gone.
+class URLRequestCoalescer::Fetch : public URLRequest::Delegate {
+ public:
+  Fetch(URLRequestCoalescer* coalescer,
+        const FetchKey& key,
+        const URLRequest* original);
+  virtual ~Fetch();
+
+  const FetchKey& key() const { return key_; }
+
+  void AddJob(Job* job);
+  void RemoveJob(Job* job);
+
+  LoadState GetLoadState() const;
+
+  // Copies body data that |job| has not read yet to |buf|. Returns the number
+  // of bytes copied, 0 at the end of the body, ERR_IO_PENDING if the fetch is
+  // waiting for more data, or the error the fetch failed with.
+  int Read(Job* job, IOBuffer* buf, int buf_size);
+
+  // URLRequest::Delegate methods:
+  virtual void OnReceivedRedirect(URLRequest* request,
+                                  const GURL& new_url,
+                                  bool* defer_redirect) OVERRIDE;
+  virtual void OnAuthRequired(URLRequest* request,
+                              AuthChallengeInfo* auth_info) OVERRIDE;
+  virtual void OnCertificateRequested(
+      URLRequest* request,
+      SSLCertRequestInfo* cert_request_info) OVERRIDE;
+  virtual void OnSSLCertificateError(URLRequest* request,
+                                     const SSLInfo& ssl_info,
+                                     bool fatal) OVERRIDE;
+  virtual void OnResponseStarted(URLRequest* request) OVERRIDE;
+  virtual void OnReadCompleted(URLRequest* request, int bytes_read) OVERRIDE;
+
+ private:
+  enum State {
+    STATE_WAITING_FOR_HEADERS,
+    STATE_HEADERS_RECEIVED,
+    STATE_START_FAILED,
+    STATE_RESTART_REQUIRED,
+  };
+
+  void StartRequest();
+
+  // Ends the waiting for headers. No more jobs may join after this.
+  void SetState(State state);
+
+  // Reads body data until a read is pending, the body ends, or enough is
+  // buffered.
+  void ReadMore();
+
+  // Handles the completion of a read. Returns false if no more data is to be
+  // read.
+  bool OnBodyRead(int bytes_read);
+
+  // Drops data that all jobs have read.
+  void TrimBuffer();
+
+  // Tells the jobs about the current state, from a task of its own.
+  void PostNotifyJobs();
+  void NotifyJobs();
+
+  scoped_refptr<URLRequestCoalescer> coalescer_;
+  const FetchKey key_;
+  scoped_ptr<URLRequest> request_;
+  State state_;
+  std::set<Job*> jobs_;
+
+  HttpResponseInfo response_info_;
+  int start_error_;
+
+  // The body, from |data_offset_| on.
+  std::string data_;
+  int64 data_offset_;
+  scoped_refptr<IOBuffer> read_buffer_;
+  bool read_pending_;
+  // Set when the body has ended. |body_error_| is OK if it ended normally.
+  bool body_done_;
+  int body_error_;
+
+  bool notify_pending_;
+  base::WeakPtrFactory<Fetch> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(Fetch);
+};
+
+// Installed in a URLRequestJobFactory for each scheme to coalesce.
+class URLRequestCoalescer::Handler
+    : public URLRequestJobFactory::ProtocolHandler {
+ public:
+  Handler(URLRequestCoalescer* coalescer,
+          URLRequestJobFactory::ProtocolHandler* inner)
+      : coalescer_(coalescer),
+        inner_(inner) {
+  }
+
+  virtual URLRequestJob* MaybeCreateJob(URLRequest* request) const OVERRIDE {
+    URLRequestJob* job = coalescer_->MaybeCreateJob(request);
+    if (job)
+      return job;
+    return inner_.get() ? inner_->MaybeCreateJob(request) : NULL;
+  }
+
+ private:
+  scoped_refptr<URLRequestCoalescer> coalescer_;
+  scoped_ptr<URLRequestJobFactory::ProtocolHandler> inner_;
+
+  DISALLOW_COPY_AND_ASSIGN(Handler);
+};
+
+//------------------------------------------------------------------------------
+
+URLRequestCoalescer::Job::Job(URLRequest* request,
+                              URLRequestCoalescer* coalescer,
+                              Fetch* fetch)
+    : URLRequestJob(request),
+      coalescer_(coalescer),
+      fetch_(fetch),
+      offset_(0),
+      read_buffer_size_(0) {
+  fetch_->AddJob(this);
+}
+
+URLRequestCoalescer::Job::~Job() {
+  DetachFromFetch();
+}
+
+void URLRequestCoalescer::Job::Start() {
+  // The fetch reports its progress from tasks of its own.
+}
+
+void URLRequestCoalescer::Job::Kill() {
+  DetachFromFetch();
+  read_buffer_ = NULL;
+  URLRequestJob::Kill();
+}
+
+LoadState URLRequestCoalescer::Job::GetLoadState() const {
+  return fetch_ ? fetch_->GetLoadState() : LOAD_STATE_IDLE;
+}
+
+bool URLRequestCoalescer::Job::GetCharset(std::string* charset) {
+  if (!response_info_.headers)
+    return false;
+  return response_info_.headers->GetCharset(charset);
+}
+
+void URLRequestCoalescer::Job::GetResponseInfo(HttpResponseInfo* info) {
+  *info = response_info_;
+}
+
+bool URLRequestCoalescer::Job::GetMimeType(std::string* mime_type) const {
+  if (!response_info_.headers)
+    return false;
+  return response_info_.headers->GetMimeType(mime_type);
+}
+
+int URLRequestCoalescer::Job::GetResponseCode() const {
+  if (!response_info_.headers)
+    return -1;
+  return response_info_.headers->response_code();
+}
+
+bool URLRequestCoalescer::Job::ReadRawData(IOBuffer* buf, int buf_size,
+                                           int* bytes_read) {
+  DCHECK(bytes_read);
+  DCHECK(!read_buffer_);
+  if (!fetch_) {
+    *bytes_read = 0;
+    return true;
+  }
+
+  int rv = fetch_->Read(this, buf, buf_size);
+  if (rv >= 0) {
+    *bytes_read = rv;
+    if (!rv)
+      DetachFromFetch();
+    return true;
+  }
+
+  if (rv == ERR_IO_PENDING) {
+    read_buffer_ = buf;
+    read_buffer_size_ = buf_size;
+    SetStatus(URLRequestStatus(URLRequestStatus::IO_PENDING, 0));
+  } else {
+    DetachFromFetch();
+    NotifyDone(URLRequestStatus(URLRequestStatus::FAILED, rv));
+  }
+  return false;
+}
+
+void URLRequestCoalescer::Job::OnHeadersReceived(
+    const HttpResponseInfo& response_info) {
+  response_info_ = response_info;
+  // Each request gets headers of its own, since they may be changed.
+  if (response_info.headers) {
+    response_info_.headers =
+        new HttpResponseHeaders(response_info.headers->raw_headers());
+  }
+  NotifyHeadersComplete();
+}
+
+void URLRequestCoalescer::Job::OnStartFailed(int error) {
+  DetachFromFetch();
+  NotifyStartError(URLRequestStatus(URLRequestStatus::FAILED, error));
+}
+
+void URLRequestCoalescer::Job::OnRestartRequired() {
+  DetachFromFetch();
+  if (!request_)
+    return;
+  coalescer_->Bypass(request_);
+  NotifyRestartRequired();
+}
+
+void URLRequestCoalescer::Job::OnDataAvailable() {
+  if (!read_buffer_ || !fetch_)
+    return;
+
+  int rv = fetch_->Read(this, read_buffer_, read_buffer_size_);
+  if (rv == ERR_IO_PENDING)
+    return;
+  read_buffer_ = NULL;
+
+  if (rv == OK) {
+    DetachFromFetch();
+    NotifyDone(URLRequestStatus());
+  } else if (rv < 0) {
+    DetachFromFetch();
+    NotifyDone(URLRequestStatus(URLRequestStatus::FAILED, rv));
+  } else {
+    // Clear the IO_PENDING status.
+    SetStatus(URLRequestStatus());
+  }
+  NotifyReadComplete(rv);
+}
+
+void URLRequestCoalescer::Job::DetachFromFetch() {
+  if (!fetch_)
+    return;
+  Fetch* fetch = fetch_;
+  fetch_ = NULL;
+  fetch->RemoveJob(this);
+}
+
+//------------------------------------------------------------------------------
+
+URLRequestCoalescer::Fetch::Fetch(URLRequestCoalescer* coalescer,
+                                  const FetchKey& key,
+                                  const URLRequest* original)
+    : coalescer_(coalescer),
+      key_(key),
+      request_(new URLRequest(original->url(), this)),
+      state_(STATE_WAITING_FOR_HEADERS),
+      start_error_(OK),
+      data_offset_(0),
+      read_buffer_(new IOBuffer(kReadBufferSize)),
+      read_pending_(false),
+      body_done_(false),
+      body_error_(OK),
+      notify_pending_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+  request_->set_context(original->context());
+  request_->set_method(original->method());
+  request_->set_referrer(original->referrer());
+  request_->set_first_party_for_cookies(original->first_party_for_cookies());
+  request_->set_load_flags(original->load_flags());
+  request_->SetExtraRequestHeaders(original->extra_request_headers());
+  request_->set_priority(original->priority());
+  // The request of the fetch is loaded on its own.
+  coalescer_->Bypass(request_.get());
+
+  // Start the request from a task of its own, rather than from within the
+  // creation of the job of |original|.
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&Fetch::StartRequest, weak_factory_.GetWeakPtr()));
+}
+
+URLRequestCoalescer::Fetch::~Fetch() {
+  DCHECK(jobs_.empty());
+  // In case the request never got as far as creating its job.
+  coalescer_->bypassed_requests_.erase(request_.get());
+}
+
+void URLRequestCoalescer::Fetch::AddJob(Job* job) {
+  DCHECK_EQ(STATE_WAITING_FOR_HEADERS, state_);
+  jobs_.insert(job);
+}
+
+void URLRequestCoalescer::Fetch::RemoveJob(Job* job) {
+  jobs_.erase(job);
+  if (!jobs_.empty()) {
+    TrimBuffer();
+    ReadMore();
+    return;
+  }
+
+  if (state_ == STATE_WAITING_FOR_HEADERS)
+    coalescer_->RemoveFetch(this);
+  weak_factory_.InvalidateWeakPtrs();
+  request_->Cancel();
+  // The request may be calling into this fetch further up the stack.
+  MessageLoop::current()->DeleteSoon(FROM_HERE, this);
+}
+
+LoadState URLRequestCoalescer::Fetch::GetLoadState() const {
+  return request_->GetLoadState().state;
+}
+
+int URLRequestCoalescer::Fetch::Read(Job* job, IOBuffer* buf, int buf_size) {
+  DCHECK_EQ(STATE_HEADERS_RECEIVED, state_);
+  DCHECK_GE(job->offset(), data_offset_);
+
+  int64 available = data_offset_ + static_cast<int64>(data_.size()) -
+      job->offset();
+  if (available > 0) {
+    int bytes = static_cast<int>(std::min<int64>(available, buf_size));
+    memcpy(buf->data(), data_.data() + (job->offset() - data_offset_), bytes);
+    job->set_offset(job->offset() + bytes);
+    TrimBuffer();
+    ReadMore();
+    return bytes;
+  }
+
+  if (body_done_)
+    return body_error_;
+  ReadMore();
+  return ERR_IO_PENDING;
+}
+
+void URLRequestCoalescer::Fetch::OnReceivedRedirect(URLRequest* request,
+                                                    const GURL& new_url,
+                                                    bool* defer_redirect) {
+  DCHECK_EQ(request_.get(), request);
+  // Each request follows the redirect on its own, so the fetch stops here and
+  // hands the redirect response to its jobs.
+  *defer_redirect = true;
+  response_info_ = request->response_info();
+  body_done_ = true;
+  SetState(STATE_HEADERS_RECEIVED);
+}
+
+void URLRequestCoalescer::Fetch::OnAuthRequired(URLRequest* request,
+                                                AuthChallengeInfo* auth_info) {
+  DCHECK_EQ(request_.get(), request);
+  SetState(STATE_RESTART_REQUIRED);
+}
+
+void URLRequestCoalescer::Fetch::OnCertificateRequested(
+    URLRequest* request,
+    SSLCertRequestInfo* cert_request_info) {
+  DCHECK_EQ(request_.get(), request);
+  SetState(STATE_RESTART_REQUIRED);
+}
+
+void URLRequestCoalescer::Fetch::OnSSLCertificateError(URLRequest* request,
+                                                       const SSLInfo& ssl_info,
+                                                       bool fatal) {
+  DCHECK_EQ(request_.get(), request);
+  SetState(STATE_RESTART_REQUIRED);
+}
+
+void URLRequestCoalescer::Fetch::OnResponseStarted(URLRequest* request) {
+  DCHECK_EQ(request_.get(), request);
+  if (state_ != STATE_WAITING_FOR_HEADERS)
+    return;
+
+  if (!request->status().is_success()) {
+    start_error_ = request->status().error();
+    if (start_error_ == OK)
+      start_error_ = ERR_FAILED;
+    SetState(STATE_START_FAILED);
+    return;
+  }
+
+  response_info_ = request->response_info();
+  SetState(STATE_HEADERS_RECEIVED);
+  ReadMore();
+}
+
+void URLRequestCoalescer::Fetch::OnReadCompleted(URLRequest* request,
+                                                 int bytes_read) {
+  DCHECK_EQ(request_.get(), request);
+  read_pending_ = false;
+  if (!request->status().is_success())
+    bytes_read = -1;
+  if (OnBodyRead(bytes_read))
+    ReadMore();
+}
+
+void URLRequestCoalescer::Fetch::StartRequest() {
+  request_->Start();
+}
+
+void URLRequestCoalescer::Fetch::SetState(State state) {
+  DCHECK_EQ(STATE_WAITING_FOR_HEADERS, state_);
+  state_ = state;
+  coalescer_->RemoveFetch(this);
+  PostNotifyJobs();
+}
+
+void URLRequestCoalescer::Fetch::ReadMore() {
+  if (state_ != STATE_HEADERS_RECEIVED)
+    return;
+
+  while (!body_done_ && !read_pending_ && data_.size() < kMaxBufferedBytes) {
+    int bytes_read = 0;
+    if (request_->Read(read_buffer_, kReadBufferSize, &bytes_read)) {
+      if (!OnBodyRead(bytes_read))
+        return;
+    } else if (request_->status().is_io_pending()) {
+      read_pending_ = true;
+    } else {
+      OnBodyRead(-1);
+    }
+  }
+}
+
+bool URLRequestCoalescer::Fetch::OnBodyRead(int bytes_read) {
+  if (bytes_read > 0) {
+    data_.append(read_buffer_->data(), bytes_read);
+  } else {
+    body_done_ = true;
+    if (bytes_read < 0) {
+      body_error_ = request_->status().error();
+      if (body_error_ == OK)
+        body_error_ = ERR_FAILED;
+    }
+  }
+  PostNotifyJobs();
+  return !body_done_;
+}
+
+void URLRequestCoalescer::Fetch::TrimBuffer() {
+  if (jobs_.empty())
+    return;
+  int64 min_offset = (*jobs_.begin())->offset();
+  for (std::set<Job*>::const_iterator it = jobs_.begin(); it != jobs_.end();
+       ++it) {
+    min_offset = std::min(min_offset, (*it)->offset());
+  }
+  size_t consumed = static_cast<size_t>(min_offset - data_offset_);
+  if (consumed < kMinTrimBytes && consumed < data_.size())
+    return;
+  data_.erase(0, consumed);
+  data_offset_ = min_offset;
+}
+
+void URLRequestCoalescer::Fetch::PostNotifyJobs() {
+  if (notify_pending_)
+    return;
+  notify_pending_ = true;
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&Fetch::NotifyJobs, weak_factory_.GetWeakPtr()));
+}
+
+void URLRequestCoalescer::Fetch::NotifyJobs() {
+  notify_pending_ = false;
+
+  // Jobs may leave, and this fetch may be deleted, while they are told.
+  std::vector<scoped_refptr<Job> > jobs(jobs_.begin(), jobs_.end());
+  base::WeakPtr<Fetch> self(weak_factory_.GetWeakPtr());
+  for (size_t i = 0; i < jobs.size() && self; ++i) {
+    Job* job = jobs[i];
+    if (jobs_.find(job) == jobs_.end())
+      continue;
+    switch (state_) {
+      case STATE_HEADERS_RECEIVED:
+        if (!job->has_response_started())
+          job->OnHeadersReceived(response_info_);
+        else
+          job->OnDataAvailable();
+        break;
+      case STATE_START_FAILED:
+        job->OnStartFailed(start_error_);
+        break;
+      case STATE_RESTART_REQUIRED:
+        job->OnRestartRequired();
+        break;
+      case STATE_WAITING_FOR_HEADERS:
+        NOTREACHED();
+        break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+URLRequestCoalescer::URLRequestCoalescer()
+    : coalesced_request_count_(0) {
+}
+
+URLRequestCoalescer::~URLRequestCoalescer() {
+  // Fetches keep the coalescer alive until they are gone.
+  DCHECK(fetches_.empty());
+}
+
+// static
+URLRequestJobFactory::ProtocolHandler*
+URLRequestCoalescer::CreateProtocolHandler(
+    URLRequestCoalescer* coalescer,
+    URLRequestJobFactory::ProtocolHandler* inner) {
+  return new Handler(coalescer, inner);
+}
+
+URLRequestJob* URLRequestCoalescer::MaybeCreateJob(URLRequest* request) {
+  DCHECK(CalledOnValidThread());
+  if (bypassed_requests_.erase(request))
+    return NULL;
+  if (request->method() != "GET" || request->has_upload())
+    return NULL;
+
+  // Requests that differ in anything that could change the response are kept
+  // apart.
+  FetchKey key(request->context(),
+               request->url().spec() + "\n" +
+               base::IntToString(request->load_flags()) + "\n" +
+               request->referrer() + "\n" +
+               request->first_party_for_cookies().spec() + "\n" +
+               request->extra_request_headers().ToString());
+
+  Fetch* fetch = NULL;
+  FetchMap::iterator it = fetches_.find(key);
+  if (it != fetches_.end()) {
+    fetch = it->second;
+    ++coalesced_request_count_;
+  } else {
+    fetch = new Fetch(this, key, request);
+    fetches_[key] = fetch;
+  }
+  return new Job(request, this, fetch);
+}
+
+void URLRequestCoalescer::RemoveFetch(Fetch* fetch) {
+  FetchMap::iterator it = fetches_.find(fetch->key());
+  if (it != fetches_.end() && it->second == fetch)
+    fetches_.erase(it);
+}
+
+void URLRequestCoalescer::Bypass(const URLRequest* request) {
+  bypassed_requests_.insert(request);
+}
+
+}  // namespace net
@@ -0,0 +1,89 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_URL_REQUEST_URL_REQUEST_COALESCER_H_
+#define NET_URL_REQUEST_URL_REQUEST_COALESCER_H_
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/threading/non_thread_safe.h"
+#include "net/base/net_export.h"
+#include "net/url_request/url_request_job_factory.h"
+
+namespace net {
+
+class URLRequest;
+class URLRequestContext;
+class URLRequestJob;
+
+// Merges GET requests for the same resource that are in flight at the same
+// time into a single fetch, and hands its response to all of them. This saves
+// the network and cache work of loading a resource many times over when many
+// documents that use it load at once.
+//
+// A request joins a fetch for the same URL, made with the same load flags,
+// referrer, first party for cookies and extra headers in the same context,
+// until the fetch has received its response headers. The fetch is a request
+// of its own, so cookies and network delegate notifications for it happen
+// once. Each request follows redirects on its own. If the fetch needs
+// credentials or a certificate decision, the requests restart and load on
+// their own, so that the user is asked as usual.
+//
+// The coalescer is installed as the protocol handler of the schemes it
+// covers, so interceptors still see requests before it does.
+class NET_EXPORT URLRequestCoalescer
+    : public base::RefCounted<URLRequestCoalescer>,
+      public base::NonThreadSafe {
+ public:
+  URLRequestCoalescer();
+
+  // Returns a protocol handler that coalesces requests through |coalescer|.
+  // Requests that are not coalesced, and the fetches themselves, are handed
+  // to |inner|, which may be NULL to use the default handling of the scheme.
+  // Takes ownership of |inner|.
+  static URLRequestJobFactory::ProtocolHandler* CreateProtocolHandler(
+      URLRequestCoalescer* coalescer,
+      URLRequestJobFactory::ProtocolHandler* inner);
+
+  // The number of requests that took their response from a fetch made for
+  // another request.
+  int coalesced_request_count() const { return coalesced_request_count_; }
+
+ private:
+  class Fetch;
+  class Handler;
+  class Job;
+  friend class base::RefCounted<URLRequestCoalescer>;
+
+  typedef std::pair<const URLRequestContext*, std::string> FetchKey;
+  typedef std::map<FetchKey, Fetch*> FetchMap;
+
+  ~URLRequestCoalescer();
+
+  // Returns a job that takes its response from a fetch, or NULL if |request|
+  // is to be loaded on its own.
+  URLRequestJob* MaybeCreateJob(URLRequest* request);
+
+  // Called by |fetch| once no more requests may join it.
+  void RemoveFetch(Fetch* fetch);
+
+  // Makes the next job for |request| skip the coalescer.
+  void Bypass(const URLRequest* request);
+
+  FetchMap fetches_;
+  std::set<const URLRequest*> bypassed_requests_;
+  int coalesced_request_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLRequestCoalescer);
+};
+
+}  // namespace net
+
+#endif  // NET_URL_REQUEST_URL_REQUEST_COALESCER_H_
@@ -0,0 +1,140 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/url_request/url_request_coalescer.h"
+
+#include "base/message_loop.h"
+#include "net/url_request/url_request_job_factory.h"
+#include "net/url_request/url_request_test_job.h"
+#include "net/url_request/url_request_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+class CountingProtocolHandler : public URLRequestJobFactory::ProtocolHandler {
+ public:
+  CountingProtocolHandler() : jobs_created_(0) {}
+
+  virtual URLRequestJob* MaybeCreateJob(URLRequest* request) const OVERRIDE {
+    ++jobs_created_;
+    return new URLRequestTestJob(request, true);
+  }
+
+  int jobs_created() const { return jobs_created_; }
+
+ private:
+  mutable int jobs_created_;
+};
+
+class URLRequestCoalescerTest : public testing::Test {
+ protected:
+  URLRequestCoalescerTest()
+      : coalescer_(new URLRequestCoalescer),
+        inner_(new CountingProtocolHandler) {
+    job_factory_.SetProtocolHandler(
+        "test", URLRequestCoalescer::CreateProtocolHandler(coalescer_, inner_));
+    context_.set_job_factory(&job_factory_);
+  }
+
+  virtual void TearDown() OVERRIDE {
+    // Lets finished fetches delete themselves.
+    MessageLoop::current()->RunAllPending();
+  }
+
+  void WaitFor(URLRequest* request1, URLRequest* request2) {
+    while (request1->is_pending() || request2->is_pending())
+      MessageLoop::current()->RunAllPending();
+  }
+
+  TestURLRequestContext context_;
+  URLRequestJobFactory job_factory_;
+  scoped_refptr<URLRequestCoalescer> coalescer_;
+  // Owned by |job_factory_|.
+  CountingProtocolHandler* inner_;
+};
+
+TEST_F(URLRequestCoalescerTest, CoalescesConcurrentRequests) {
+  TestDelegate d1;
+  TestDelegate d2;
+  d1.set_quit_on_complete(false);
+  d2.set_quit_on_complete(false);
+  URLRequest r1(URLRequestTestJob::test_url_1(), &d1);
+  URLRequest r2(URLRequestTestJob::test_url_1(), &d2);
+  r1.set_context(&context_);
+  r2.set_context(&context_);
+  r1.Start();
+  r2.Start();
+  WaitFor(&r1, &r2);
+
+  EXPECT_TRUE(r1.status().is_success());
+  EXPECT_TRUE(r2.status().is_success());
+  EXPECT_EQ(URLRequestTestJob::test_data_1(), d1.data_received());
+  EXPECT_EQ(URLRequestTestJob::test_data_1(), d2.data_received());
+  EXPECT_EQ(200, r2.GetResponseCode());
+  EXPECT_EQ(1, inner_->jobs_created());
+  EXPECT_EQ(1, coalescer_->coalesced_request_count());
+}
+
+TEST_F(URLRequestCoalescerTest, KeepsDifferentRequestsApart) {
+  TestDelegate d1;
+  TestDelegate d2;
+  d1.set_quit_on_complete(false);
+  d2.set_quit_on_complete(false);
+  URLRequest r1(URLRequestTestJob::test_url_1(), &d1);
+  URLRequest r2(URLRequestTestJob::test_url_1(), &d2);
+  r1.set_context(&context_);
+  r2.set_context(&context_);
+  r2.SetExtraRequestHeaderByName("X-Test", "1", true);
+  r1.Start();
+  r2.Start();
+  WaitFor(&r1, &r2);
+
+  EXPECT_EQ(URLRequestTestJob::test_data_1(), d1.data_received());
+  EXPECT_EQ(URLRequestTestJob::test_data_1(), d2.data_received());
+  EXPECT_EQ(2, inner_->jobs_created());
+  EXPECT_EQ(0, coalescer_->coalesced_request_count());
+}
+
+TEST_F(URLRequestCoalescerTest, CanceledRequestLeavesOthersAlone) {
+  TestDelegate d1;
+  TestDelegate d2;
+  d1.set_quit_on_complete(false);
+  d2.set_quit_on_complete(false);
+  URLRequest r1(URLRequestTestJob::test_url_2(), &d1);
+  URLRequest r2(URLRequestTestJob::test_url_2(), &d2);
+  r1.set_context(&context_);
+  r2.set_context(&context_);
+  r1.Start();
+  r2.Start();
+  r1.Cancel();
+  WaitFor(&r1, &r2);
+
+  EXPECT_EQ(URLRequestStatus::CANCELED, r1.status().status());
+  EXPECT_TRUE(r2.status().is_success());
+  EXPECT_EQ(URLRequestTestJob::test_data_2(), d2.data_received());
+  EXPECT_EQ(1, inner_->jobs_created());
+}
+
+TEST_F(URLRequestCoalescerTest, LaterRequestsFetchAgain) {
+  TestDelegate d1;
+  URLRequest r1(URLRequestTestJob::test_url_1(), &d1);
+  r1.set_context(&context_);
+  r1.Start();
+  MessageLoop::current()->Run();
+
+  TestDelegate d2;
+  URLRequest r2(URLRequestTestJob::test_url_1(), &d2);
+  r2.set_context(&context_);
+  r2.Start();
+  MessageLoop::current()->Run();
+
+  EXPECT_EQ(URLRequestTestJob::test_data_1(), d2.data_received());
+  EXPECT_EQ(2, inner_->jobs_created());
+}
+
+}  // namespace
+
+}  // namespace net
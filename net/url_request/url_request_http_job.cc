@@ -20,6 +20,7 @@
 #include "net/base/cert_status_flags.h"
 #include "net/base/filter.h"
 #include "net/base/host_port_pair.h"
+#include "net/base/io_buffer.h"
 #include "net/base/load_flags.h"
 #include "net/base/mime_util.h"
 #include "net/base/net_errors.h"
@@ -759,6 +760,9 @@ void URLRequestHttpJob::OnReadCompleted(int result) {
   } else if (result < 0) {
     NotifyDone(URLRequestStatus(URLRequestStatus::FAILED, result));
   } else {
+    URLRequestThrottlerManager* shaper = GetBandwidthShaper();
+    if (shaper)
+      shaper->OnBytesRead(request_->url(), request_->priority(), result);
     // Clear the IO_PENDING status
     SetStatus(URLRequestStatus());
   }
@@ -766,6 +770,30 @@ void URLRequestHttpJob::OnReadCompleted(int result) {
   NotifyReadComplete(result);
 }
 
+URLRequestThrottlerManager* URLRequestHttpJob::GetBandwidthShaper() const {
+  if (!request_ || !request_->context())
+    return NULL;
+  URLRequestThrottlerManager* manager =
+      request_->context()->throttler_manager();
+  return manager && manager->IsShapingBandwidth() ? manager : NULL;
+}
+
+void URLRequestHttpJob::ResumeShapedRead(scoped_refptr<IOBuffer> buf,
+                                         int buf_size) {
+  read_in_progress_ = false;
+  int bytes_read = 0;
+  if (ReadRawData(buf, buf_size, &bytes_read)) {
+    // Complete the read as if it had been asynchronous all along.
+    if (bytes_read == 0)
+      NotifyDone(URLRequestStatus());
+    else
+      SetStatus(URLRequestStatus());
+    NotifyReadComplete(bytes_read);
+  } else if (!GetStatus().is_io_pending()) {
+    NotifyReadComplete(GetStatus().error());
+  }
+}
+
 void URLRequestHttpJob::RestartTransactionWithAuth(
     const AuthCredentials& credentials) {
   auth_credentials_ = credentials;
@@ -1119,6 +1147,25 @@ bool URLRequestHttpJob::ReadRawData(IOBuffer* buf, int buf_size,
   DCHECK(bytes_read);
   DCHECK(!read_in_progress_);
 
+  URLRequestThrottlerManager* shaper = GetBandwidthShaper();
+  if (shaper) {
+    base::TimeDelta delay;
+    int allowed = shaper->GetAllowedReadSize(
+        request_->url(), request_->priority(), buf_size, &delay);
+    if (!allowed) {
+      read_in_progress_ = true;
+      SetStatus(URLRequestStatus(URLRequestStatus::IO_PENDING, 0));
+      MessageLoop::current()->PostDelayedTask(
+          FROM_HERE,
+          base::Bind(&URLRequestHttpJob::ResumeShapedRead,
+                     weak_factory_.GetWeakPtr(), make_scoped_refptr(buf),
+                     buf_size),
+          delay);
+      return false;
+    }
+    buf_size = allowed;
+  }
+
   int rv = transaction_->Read(
       buf, buf_size,
       base::Bind(&URLRequestHttpJob::OnReadCompleted, base::Unretained(this)));
@@ -1130,6 +1177,8 @@ bool URLRequestHttpJob::ReadRawData(IOBuffer* buf, int buf_size,
     *bytes_read = rv;
     if (!rv)
       DoneWithRequest(FINISHED);
+    else if (shaper)
+      shaper->OnBytesRead(request_->url(), request_->priority(), rv);
     return true;
   }
 
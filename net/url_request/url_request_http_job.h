@@ -26,6 +26,7 @@ class HttpResponseHeaders;
 class HttpResponseInfo;
 class HttpTransaction;
 class URLRequestContext;
+class URLRequestThrottlerManager;
 
 // A URLRequestJob subclass that is built on top of HttpTransaction.  It
 // provides an implementation for both HTTP and HTTPS.
@@ -63,6 +64,12 @@ class URLRequestHttpJob : public URLRequestJob {
   void OnReadCompleted(int result);
   void NotifyBeforeSendHeadersCallback(int result);
 
+  // Returns the throttler manager if it shapes bandwidth, or NULL.
+  URLRequestThrottlerManager* GetBandwidthShaper() const;
+
+  // Retries a read that bandwidth shaping held back.
+  void ResumeShapedRead(scoped_refptr<IOBuffer> buf, int buf_size);
+
   void RestartTransactionWithAuth(const AuthCredentials& credentials);
 
   // Overridden from URLRequestJob:
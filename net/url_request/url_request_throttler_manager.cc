@@ -4,6 +4,9 @@
 
 #include "net/url_request/url_request_throttler_manager.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "base/logging.h"
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram.h"
@@ -13,6 +16,14 @@
 
 namespace net {
 
+namespace {
+
+// Shaped reads are not made smaller than this, unless the reader asks for
+// less, so that a slow limit does not turn into many tiny reads.
+const int kMinShapedReadSize = 2048;
+
+}  // namespace
+
 const unsigned int URLRequestThrottlerManager::kMaximumNumberOfEntries = 1500;
 const unsigned int URLRequestThrottlerManager::kRequestsBetweenCollecting = 200;
 
@@ -162,6 +173,84 @@ NetLog* URLRequestThrottlerManager::net_log() const {
   return net_log_.net_log();
 }
 
+void URLRequestThrottlerManager::SetHostBandwidthLimit(
+    const std::string& host,
+    int64 bytes_per_second) {
+  DCHECK(!enable_thread_checks_ || CalledOnValidThread());
+  std::string key(StringToLowerASCII(host));
+  if (bytes_per_second <= 0) {
+    host_buckets_.erase(key);
+    return;
+  }
+  TokenBucket& bucket = host_buckets_[key];
+  bucket.bytes_per_second = bytes_per_second;
+  bucket.tokens = std::max<int64>(bytes_per_second, kMinShapedReadSize);
+  bucket.last_refill = ImplGetTimeNow();
+}
+
+void URLRequestThrottlerManager::SetPriorityBandwidthLimit(
+    RequestPriority priority,
+    int64 bytes_per_second) {
+  DCHECK(!enable_thread_checks_ || CalledOnValidThread());
+  DCHECK_GE(priority, MINIMUM_PRIORITY);
+  DCHECK_LT(priority, NUM_PRIORITIES);
+  TokenBucket& bucket = priority_buckets_[priority];
+  bucket.bytes_per_second = std::max<int64>(bytes_per_second, 0);
+  bucket.tokens = std::max<int64>(bytes_per_second, kMinShapedReadSize);
+  bucket.last_refill = ImplGetTimeNow();
+}
+
+bool URLRequestThrottlerManager::IsShapingBandwidth() const {
+  if (!host_buckets_.empty())
+    return true;
+  for (int i = MINIMUM_PRIORITY; i < NUM_PRIORITIES; ++i) {
+    if (priority_buckets_[i].bytes_per_second)
+      return true;
+  }
+  return false;
+}
+
+int URLRequestThrottlerManager::GetAllowedReadSize(const GURL& url,
+                                                   RequestPriority priority,
+                                                   int max_bytes,
+                                                   base::TimeDelta* delay) {
+  DCHECK(!enable_thread_checks_ || CalledOnValidThread());
+  std::vector<TokenBucket*> buckets;
+  GetBuckets(url, priority, &buckets);
+
+  double allowed = max_bytes;
+  for (size_t i = 0; i < buckets.size(); ++i)
+    allowed = std::min(allowed, buckets[i]->tokens);
+
+  int min_read_size = std::min(max_bytes, kMinShapedReadSize);
+  if (allowed >= min_read_size)
+    return static_cast<int>(allowed);
+
+  // Wait until every bucket holds enough for a read of the smallest size.
+  double seconds = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    const TokenBucket* bucket = buckets[i];
+    if (bucket->tokens < min_read_size) {
+      seconds = std::max(seconds, (min_read_size - bucket->tokens) /
+                                  bucket->bytes_per_second);
+    }
+  }
+  *delay = base::TimeDelta::FromMilliseconds(
+      std::max<int64>(1, static_cast<int64>(std::ceil(seconds * 1000))));
+  return 0;
+}
+
+void URLRequestThrottlerManager::OnBytesRead(const GURL& url,
+                                             RequestPriority priority,
+                                             int bytes) {
+  DCHECK(!enable_thread_checks_ || CalledOnValidThread());
+  std::vector<TokenBucket*> buckets;
+  GetBuckets(url, priority, &buckets);
+  // Concurrent reads may overdraw a bucket; later reads then wait longer.
+  for (size_t i = 0; i < buckets.size(); ++i)
+    buckets[i]->tokens -= bytes;
+}
+
 void URLRequestThrottlerManager::OnIPAddressChanged() {
   OnNetworkChange();
 }
@@ -203,6 +292,47 @@ void URLRequestThrottlerManager::GarbageCollectEntries() {
   }
 }
 
+base::TimeTicks URLRequestThrottlerManager::ImplGetTimeNow() const {
+  return base::TimeTicks::Now();
+}
+
+URLRequestThrottlerManager::TokenBucket::TokenBucket()
+    : bytes_per_second(0),
+      tokens(0) {
+}
+
+void URLRequestThrottlerManager::TokenBucket::Refill(base::TimeTicks now) {
+  if (now > last_refill) {
+    tokens += (now - last_refill).InSecondsF() * bytes_per_second;
+    // Hold at most one second's worth, so an idle period does not allow a
+    // long burst.
+    tokens = std::min(
+        tokens,
+        static_cast<double>(std::max<int64>(bytes_per_second,
+                                            kMinShapedReadSize)));
+  }
+  last_refill = now;
+}
+
+void URLRequestThrottlerManager::GetBuckets(
+    const GURL& url,
+    RequestPriority priority,
+    std::vector<TokenBucket*>* buckets) {
+  base::TimeTicks now = ImplGetTimeNow();
+  if (!host_buckets_.empty()) {
+    HostBucketMap::iterator it =
+        host_buckets_.find(StringToLowerASCII(url.host()));
+    if (it != host_buckets_.end())
+      buckets->push_back(&it->second);
+  }
+  for (int i = priority; i < NUM_PRIORITIES; ++i) {
+    if (priority_buckets_[i].bytes_per_second)
+      buckets->push_back(&priority_buckets_[i]);
+  }
+  for (size_t i = 0; i < buckets->size(); ++i)
+    (*buckets)[i]->Refill(now);
+}
+
 void URLRequestThrottlerManager::OnNetworkChange() {
   // Remove all entries.  Any entries that in-flight requests have a reference
   // to will live until those requests end, and these entries may be
@@ -9,14 +9,17 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/threading/platform_thread.h"
+#include "base/time.h"
 #include "googleurl/src/gurl.h"
 #include "net/base/net_export.h"
 #include "net/base/network_change_notifier.h"
+#include "net/base/request_priority.h"
 #include "net/url_request/url_request_throttler_entry.h"
 
 namespace net {
@@ -33,6 +36,11 @@ class NetLog;
 // are registered, and does garbage collection from time to time in order to
 // clean out outdated entries. URL ID consists of lowercased scheme, host, port
 // and path. All URLs converted to the same ID will share the same entry.
+//
+// The manager can also shape the bandwidth that response bodies are read
+// with, using token buckets. A limit may be set per host, and per priority
+// for requests at or below that priority, so that background traffic such as
+// prefetches and updates leaves room for interactive loads.
 class NET_EXPORT URLRequestThrottlerManager
     : NON_EXPORTED_BASE(public base::NonThreadSafe),
       public NetworkChangeNotifier::IPAddressObserver,
@@ -78,6 +86,31 @@ class NET_EXPORT URLRequestThrottlerManager
   void set_net_log(NetLog* net_log);
   NetLog* net_log() const;
 
+  // Limits the rate at which the response bodies of requests to |host| are
+  // read to |bytes_per_second|. 0 removes the limit.
+  void SetHostBandwidthLimit(const std::string& host, int64 bytes_per_second);
+
+  // Limits the combined rate at which the response bodies of requests at
+  // |priority| or lower are read to |bytes_per_second|. 0 removes the limit.
+  void SetPriorityBandwidthLimit(RequestPriority priority,
+                                 int64 bytes_per_second);
+
+  // Whether any bandwidth limit is set. When none is, the methods below need
+  // not be called.
+  bool IsShapingBandwidth() const;
+
+  // Returns how many bytes, up to |max_bytes|, of the response body of a
+  // request for |url| at |priority| may be read now. When that is 0, |delay|
+  // is set to how long to wait before asking again.
+  int GetAllowedReadSize(const GURL& url,
+                         RequestPriority priority,
+                         int max_bytes,
+                         base::TimeDelta* delay);
+
+  // Accounts for |bytes| of the response body of a request for |url| at
+  // |priority| having been read.
+  void OnBytesRead(const GURL& url, RequestPriority priority, int bytes);
+
   // IPAddressObserver interface.
   virtual void OnIPAddressChanged() OVERRIDE;
 
@@ -111,7 +144,31 @@ class NET_EXPORT URLRequestThrottlerManager
   // Used by tests.
   int GetNumberOfEntriesForTests() const { return url_entries_.size(); }
 
+ protected:
+  // Returns the current time; tests may override it.
+  virtual base::TimeTicks ImplGetTimeNow() const;
+
  private:
+  // Bytes are taken from the bucket as they are read, and it refills at the
+  // rate of the limit, holding at most one second's worth.
+  struct TokenBucket {
+    TokenBucket();
+
+    // Adds the tokens earned since the last refill.
+    void Refill(base::TimeTicks now);
+
+    int64 bytes_per_second;
+    double tokens;
+    base::TimeTicks last_refill;
+  };
+  typedef std::map<std::string, TokenBucket> HostBucketMap;
+
+  // Fills |buckets| with the refilled buckets whose limits apply to a
+  // request for |url| at |priority|.
+  void GetBuckets(const GURL& url,
+                  RequestPriority priority,
+                  std::vector<TokenBucket*>* buckets);
+
   // From each URL we generate an ID composed of the scheme, host, port and path
   // that allows us to uniquely map an entry to it.
   typedef std::map<std::string, scoped_refptr<URLRequestThrottlerEntry> >
@@ -162,6 +219,10 @@ class NET_EXPORT URLRequestThrottlerManager
   // Valid once we've registered for network notifications.
   base::PlatformThreadId registered_from_thread_;
 
+  // Bandwidth limits, by lowercase host and by priority.
+  HostBucketMap host_buckets_;
+  TokenBucket priority_buckets_[NUM_PRIORITIES];
+
   DISALLOW_COPY_AND_ASSIGN(URLRequestThrottlerManager);
 };
 
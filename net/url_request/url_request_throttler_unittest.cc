@@ -119,6 +119,13 @@ class MockURLRequestThrottlerManager : public URLRequestThrottlerManager {
   // Returns the number of entries in the map.
   int GetNumberOfEntries() const { return GetNumberOfEntriesForTests(); }
 
+  void set_fake_now(const TimeTicks& fake_now) { fake_now_ = fake_now; }
+
+  // Overridden for tests.
+  virtual TimeTicks ImplGetTimeNow() const OVERRIDE {
+    return fake_now_.is_null() ? TimeTicks::Now() : fake_now_;
+  }
+
   void CreateEntry(bool is_outdated) {
     TimeTicks time = TimeTicks::Now();
     if (is_outdated) {
@@ -136,6 +143,7 @@ class MockURLRequestThrottlerManager : public URLRequestThrottlerManager {
 
  private:
   int create_entry_index_;
+  TimeTicks fake_now_;
 };
 
 struct TimeAndBool {
@@ -526,4 +534,53 @@ TEST(URLRequestThrottlerManager, ClearOnNetworkChange) {
   }
 }
 
+TEST(URLRequestThrottlerManager, HostBandwidthLimit) {
+  MockURLRequestThrottlerManager manager;
+  TimeTicks now = TimeTicks::Now();
+  manager.set_fake_now(now);
+  EXPECT_FALSE(manager.IsShapingBandwidth());
+
+  GURL limited("http://www.limited.com/file");
+  GURL other("http://www.other.com/file");
+  manager.SetHostBandwidthLimit("www.LIMITED.com", 10000);
+  EXPECT_TRUE(manager.IsShapingBandwidth());
+
+  // A full bucket holds one second's worth.
+  TimeDelta delay;
+  EXPECT_EQ(10000, manager.GetAllowedReadSize(limited, MEDIUM, 32768, &delay));
+  manager.OnBytesRead(limited, MEDIUM, 10000);
+  EXPECT_EQ(0, manager.GetAllowedReadSize(limited, MEDIUM, 32768, &delay));
+  EXPECT_EQ(TimeDelta::FromMilliseconds(205), delay);
+  EXPECT_EQ(32768, manager.GetAllowedReadSize(other, MEDIUM, 32768, &delay));
+
+  manager.set_fake_now(now + TimeDelta::FromMilliseconds(500));
+  EXPECT_EQ(5000, manager.GetAllowedReadSize(limited, MEDIUM, 32768, &delay));
+
+  manager.SetHostBandwidthLimit("www.limited.com", 0);
+  EXPECT_FALSE(manager.IsShapingBandwidth());
+}
+
+TEST(URLRequestThrottlerManager, PriorityBandwidthLimit) {
+  MockURLRequestThrottlerManager manager;
+  TimeTicks now = TimeTicks::Now();
+  manager.set_fake_now(now);
+  GURL url("http://www.example.com/");
+
+  manager.SetPriorityBandwidthLimit(LOWEST, 4096);
+  TimeDelta delay;
+  EXPECT_EQ(4096, manager.GetAllowedReadSize(url, IDLE, 32768, &delay));
+  manager.OnBytesRead(url, IDLE, 4096);
+
+  // Requests at or below the limited priority share the bucket; higher ones
+  // are not held back.
+  EXPECT_EQ(0, manager.GetAllowedReadSize(url, LOWEST, 32768, &delay));
+  EXPECT_EQ(TimeDelta::FromMilliseconds(500), delay);
+  EXPECT_EQ(32768, manager.GetAllowedReadSize(url, LOW, 32768, &delay));
+
+  // Small reads need not wait for a full read's worth.
+  manager.set_fake_now(now + TimeDelta::FromMilliseconds(250));
+  EXPECT_EQ(0, manager.GetAllowedReadSize(url, LOWEST, 32768, &delay));
+  EXPECT_EQ(1024, manager.GetAllowedReadSize(url, LOWEST, 1024, &delay));
+}
+
 }  // namespace net
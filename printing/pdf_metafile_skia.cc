@@ -118,8 +118,9 @@ bool PdfMetafileSkia::GetData(void* dst_buffer,
   if (dst_buffer_size < GetDataSize())
     return false;
 
-  SkAutoDataUnref data(data_->pdf_stream_.copyToData());
-  memcpy(dst_buffer, data.bytes(), dst_buffer_size);
+  // Copy straight out of the stream's blocks rather than through a flattened
+  // SkData, which would be a second copy of the whole document.
+  data_->pdf_stream_.copyTo(dst_buffer);
   return true;
 }
 
@@ -231,20 +232,19 @@ PdfMetafileSkia::PdfMetafileSkia()
 
 PdfMetafileSkia* PdfMetafileSkia::GetMetafileForCurrentPage() {
   SkPDFDocument pdf_doc(SkPDFDocument::kDraftMode_Flags);
-  SkDynamicMemoryWStream pdf_stream;
   if (!pdf_doc.appendPage(data_->current_page_.get()))
     return NULL;
 
-  if (!pdf_doc.emitPDF(&pdf_stream))
+  // Emit the page straight into the new metafile's stream instead of copying
+  // it over from a temporary one.
+  scoped_ptr<PdfMetafileSkia> metafile(new PdfMetafileSkia);
+  if (!pdf_doc.emitPDF(&metafile->data_->pdf_stream_))
     return NULL;
 
-  SkAutoDataUnref data(pdf_stream.copyToData());
-  if (data.size() == 0)
+  if (metafile->GetDataSize() == 0)
     return NULL;
 
-  PdfMetafileSkia* metafile = new PdfMetafileSkia;
-  metafile->InitFromData(data.bytes(), data.size());
-  return metafile;
+  return metafile.release();
 }
 
 }  // namespace printing
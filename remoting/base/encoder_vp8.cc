@@ -4,8 +4,12 @@
 
 #include "remoting/base/encoder_vp8.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/sys_info.h"
+#include "base/threading/parallel_work.h"
 #include "media/base/yuv_convert.h"
 #include "remoting/base/capture_data.h"
 #include "remoting/base/util.h"
@@ -23,7 +27,60 @@ namespace {
 // map for the encoder.
 const int kMacroBlockSize = 16;
 
-}  // namespace remoting
+// The most threads libvpx is asked to encode with.
+const int kMaxEncoderThreads = 4;
+
+// Updated rectangles with fewer pixels than this are converted to YUV on the
+// encode thread only.
+const int kMinPixelsForBands = 640 * 480;
+
+// The fewest rows of a rectangle converted by one thread.
+const int kMinRowsPerBand = 64;
+
+// The state shared by the threads converting bands of one rectangle.
+struct ConvertJob {
+  ConvertJob(const uint8* in, uint8* y_out, uint8* u_out, uint8* v_out,
+             const SkIRect& rect, int in_stride, int y_stride, int uv_stride)
+      : in(in),
+        y_out(y_out),
+        u_out(u_out),
+        v_out(v_out),
+        rect(rect),
+        in_stride(in_stride),
+        y_stride(y_stride),
+        uv_stride(uv_stride) {
+  }
+
+  const uint8* in;
+  uint8* y_out;
+  uint8* u_out;
+  uint8* v_out;
+  const SkIRect rect;
+  int in_stride;
+  int y_stride;
+  int uv_stride;
+};
+
+// Converts the rows of |job|'s rectangle from |top| up to |bottom|, which
+// must both be even so that bands do not share chroma rows.
+void ConvertBand(const ConvertJob* job, int top, int bottom) {
+  remoting::ConvertRGB32ToYUVWithRect(
+      job->in, job->y_out, job->u_out, job->v_out,
+      job->rect.fLeft, top, job->rect.width(), bottom - top,
+      job->in_stride, job->y_stride, job->uv_stride);
+}
+
+// Converts band |band| of |band_count| bands. Band edges are rounded down to
+// even rows. The rectangle is aligned to even rows already, so the last band
+// ends at its bottom.
+void ConvertNthBand(const ConvertJob* job, int band_count, int band,
+                    int /* thread */) {
+  int rows = job->rect.height();
+  ConvertBand(job, job->rect.fTop + (rows * band / band_count & ~1),
+              job->rect.fTop + (rows * (band + 1) / band_count & ~1));
+}
+
+}  // namespace
 
 namespace remoting {
 
@@ -125,10 +182,16 @@ bool EncoderVp8::Init(const SkISize& size) {
   config.g_profile = 2;
 
   // Using 2 threads gives a great boost in performance for most systems with
-  // adequate processing power. NB: Going to multiple threads on low end
-  // windows systems can really hurt performance.
+  // adequate processing power, and larger machines can take one thread per
+  // two cores. NB: Going to multiple threads on low end windows systems can
+  // really hurt performance.
   // http://crbug.com/99179
-  config.g_threads = (base::SysInfo::NumberOfProcessors() > 2) ? 2 : 1;
+  int num_processors = base::SysInfo::NumberOfProcessors();
+  config.g_threads = 1;
+  if (num_processors > 2) {
+    config.g_threads =
+        std::min(std::max(num_processors / 2, 2), kMaxEncoderThreads);
+  }
   config.rc_min_quantizer = 20;
   config.rc_max_quantizer = 30;
   config.g_timebase.num = 1;
@@ -146,6 +209,16 @@ bool EncoderVp8::Init(const SkISize& size) {
   // on motion estimation and inter-prediction mode.
   if (vpx_codec_control(codec_.get(), VP8E_SET_NOISE_SENSITIVITY, 0))
     return false;
+
+  // The encoder threads work on separate token partitions, so give it one
+  // partition per thread. The value is the log2 of the partition count.
+  int token_partitions = 0;
+  while ((2 << token_partitions) <= static_cast<int>(config.g_threads))
+    ++token_partitions;
+  if (vpx_codec_control(codec_.get(), VP8E_SET_TOKEN_PARTITIONS,
+                        token_partitions)) {
+    return false;
+  }
   return true;
 }
 
@@ -187,14 +260,40 @@ bool EncoderVp8::PrepareImage(scoped_refptr<CaptureData> capture_data,
     if (!rect.isEmpty())
       updated_rects->push_back(rect);
 
-    ConvertRGB32ToYUVWithRect(
-        in, y_out, u_out, v_out,
-        rect.fLeft, rect.fTop, rect.width(), rect.height(),
-        in_stride, y_stride, uv_stride);
+    ConvertRGB32ToYUVInBands(in, y_out, u_out, v_out, rect,
+                             in_stride, y_stride, uv_stride);
   }
   return true;
 }
 
+// static
+void EncoderVp8::ConvertRGB32ToYUVInBands(const uint8* in,
+                                          uint8* y_out,
+                                          uint8* u_out,
+                                          uint8* v_out,
+                                          const SkIRect& rect,
+                                          int in_stride,
+                                          int y_stride,
+                                          int uv_stride) {
+  int band_count = 1;
+  if (rect.width() * rect.height() >= kMinPixelsForBands) {
+    band_count =
+        base::ParallelWork::ThreadCount(rect.height() / kMinRowsPerBand);
+  }
+
+  ConvertJob job(in, y_out, u_out, v_out, rect, in_stride, y_stride,
+                 uv_stride);
+  if (band_count <= 1) {
+    ConvertBand(&job, rect.fTop, rect.fBottom);
+    return;
+  }
+
+  base::ParallelWork::Run(FROM_HERE, band_count, band_count,
+                          base::Bind(&ConvertNthBand, base::Unretained(&job),
+                                     band_count),
+                          false);
+}
+
 void EncoderVp8::PrepareActiveMap(const RectVector& updated_rects) {
   // Clear active map first.
   memset(active_map_.get(), 0, active_map_width_ * active_map_height_);
@@ -31,6 +31,7 @@ class EncoderVp8 : public Encoder {
   typedef std::vector<SkIRect> RectVector;
 
   FRIEND_TEST_ALL_PREFIXES(EncoderVp8Test, AlignAndClipRect);
+  FRIEND_TEST_ALL_PREFIXES(EncoderVp8Test, ConvertRGB32ToYUVInBands);
 
   // Initialize the encoder. Returns true if successful.
   bool Init(const SkISize& size);
@@ -43,6 +44,18 @@ class EncoderVp8 : public Encoder {
   bool PrepareImage(scoped_refptr<CaptureData> capture_data,
                     RectVector* updated_rects);
 
+  // Converts |rect| of the RGB32 image |in| into the YUV planes. Large
+  // rectangles are split into bands of rows that are converted on several
+  // threads. |rect| must be aligned to even coordinates.
+  static void ConvertRGB32ToYUVInBands(const uint8* in,
+                                       uint8* y_out,
+                                       uint8* u_out,
+                                       uint8* v_out,
+                                       const SkIRect& rect,
+                                       int in_stride,
+                                       int y_stride,
+                                       int uv_stride);
+
   // Update the active map according to |updated_rects|. Active map is then
   // given to the encoder to speed up encoding.
   void PrepareActiveMap(const RectVector& updated_rects);
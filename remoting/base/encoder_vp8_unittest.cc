@@ -11,6 +11,7 @@
 #include "remoting/base/capture_data.h"
 #include "remoting/base/codec_test.h"
 #include "remoting/base/encoder_vp8.h"
+#include "remoting/base/util.h"
 #include "remoting/proto/video.pb.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -85,4 +86,33 @@ TEST(EncoderVp8Test, AlignAndClipRect) {
             SkIRect::MakeXYWH(100, 200, 98, 98));
 }
 
+// Converting a large rectangle in bands gives the same planes as converting
+// it at once.
+TEST(EncoderVp8Test, ConvertRGB32ToYUVInBands) {
+  const int kWidth = 1024;
+  const int kHeight = 770;
+  const int kBytesPerPixel = 4;
+  const int kUVStride = kWidth / 2;
+
+  std::vector<uint8> rgb(kWidth * kHeight * kBytesPerPixel);
+  for (size_t i = 0; i < rgb.size(); ++i)
+    rgb[i] = static_cast<uint8>(i * 7 + i / kWidth);
+
+  const int kYSize = kWidth * kHeight;
+  const int kUVSize = kUVStride * kHeight / 2;
+  std::vector<uint8> expected(kYSize + 2 * kUVSize);
+  std::vector<uint8> banded(kYSize + 2 * kUVSize);
+  SkIRect rect(SkIRect::MakeXYWH(2, 2, kWidth - 4, kHeight - 4));
+
+  ConvertRGB32ToYUVWithRect(
+      &rgb.front(), &expected[0], &expected[kYSize],
+      &expected[kYSize + kUVSize], rect.fLeft, rect.fTop, rect.width(),
+      rect.height(), kWidth * kBytesPerPixel, kWidth, kUVStride);
+  EncoderVp8::ConvertRGB32ToYUVInBands(
+      &rgb.front(), &banded[0], &banded[kYSize], &banded[kYSize + kUVSize],
+      rect, kWidth * kBytesPerPixel, kWidth, kUVStride);
+
+  EXPECT_TRUE(expected == banded);
+}
+
 }  // namespace remoting
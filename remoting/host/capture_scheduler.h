@@ -4,7 +4,9 @@
 
 // This class chooses a capture interval so as to limit CPU usage to not exceed
 // a specified %age. It bases this on the CPU usage of recent capture and encode
-// operations, and on the number of available CPUs.
+// operations, and on the number of available CPUs. The interval is also kept
+// no shorter than the time recent frames took to leave the network write
+// queue, so that frames do not pile up there and add latency.
 
 #ifndef REMOTING_HOST_CAPTURE_SCHEDULER_H_
 #define REMOTING_HOST_CAPTURE_SCHEDULER_H_
@@ -26,10 +28,15 @@ class CaptureScheduler {
   void RecordCaptureTime(base::TimeDelta capture_time);
   void RecordEncodeTime(base::TimeDelta encode_time);
 
+  // Record time spent sending an encoded frame, from when its last packet
+  // was queued until it was written.
+  void RecordSendTime(base::TimeDelta send_time);
+
  private:
   int num_of_processors_;
   RunningAverage capture_time_;
   RunningAverage encode_time_;
+  RunningAverage send_time_;
 
   DISALLOW_COPY_AND_ASSIGN(CaptureScheduler);
 };
@@ -0,0 +1,56 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/host/capture_scheduler.h"
+
+#include "base/sys_info.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+
+// The hard limit on the capture rate.
+static const int kMinimumDelayMs = 50;
+
+TEST(CaptureSchedulerTest, MinimumDelay) {
+  CaptureScheduler scheduler;
+  EXPECT_EQ(kMinimumDelayMs, scheduler.NextCaptureDelay().InMilliseconds());
+
+  scheduler.RecordCaptureTime(base::TimeDelta::FromMilliseconds(1));
+  scheduler.RecordEncodeTime(base::TimeDelta::FromMilliseconds(1));
+  scheduler.RecordSendTime(base::TimeDelta::FromMilliseconds(1));
+  EXPECT_EQ(kMinimumDelayMs, scheduler.NextCaptureDelay().InMilliseconds());
+}
+
+// Capture and encode are given half of all processors' time.
+TEST(CaptureSchedulerTest, CpuTimeLimitsRate) {
+  const int num_of_processors = base::SysInfo::NumberOfProcessors();
+  CaptureScheduler scheduler;
+  for (int i = 0; i < 3; ++i) {
+    scheduler.RecordCaptureTime(base::TimeDelta::FromMilliseconds(
+        100 * num_of_processors));
+    scheduler.RecordEncodeTime(base::TimeDelta::FromMilliseconds(
+        50 * num_of_processors));
+  }
+  EXPECT_EQ(300, scheduler.NextCaptureDelay().InMilliseconds());
+}
+
+// Frames are captured no faster than they leave the network write queue,
+// averaged over the last few frames.
+TEST(CaptureSchedulerTest, SendTimeLimitsRate) {
+  CaptureScheduler scheduler;
+  scheduler.RecordCaptureTime(base::TimeDelta::FromMilliseconds(1));
+  scheduler.RecordEncodeTime(base::TimeDelta::FromMilliseconds(1));
+  scheduler.RecordSendTime(base::TimeDelta::FromMilliseconds(200));
+  EXPECT_EQ(200, scheduler.NextCaptureDelay().InMilliseconds());
+
+  scheduler.RecordSendTime(base::TimeDelta::FromMilliseconds(400));
+  EXPECT_EQ(300, scheduler.NextCaptureDelay().InMilliseconds());
+
+  // Once the queue drains, the old samples age out of the average.
+  for (int i = 0; i < 3; ++i)
+    scheduler.RecordSendTime(base::TimeDelta::FromMilliseconds(10));
+  EXPECT_EQ(kMinimumDelayMs, scheduler.NextCaptureDelay().InMilliseconds());
+}
+
+}  // namespace remoting
@@ -119,6 +119,10 @@ class CapturerLinux : public Capturer {
   // |capture_data|.
   void CaptureRect(const SkIRect& rect, CaptureData* capture_data);
 
+  // Returns true if the X server's pixels are 32-bit RGB, so that FastBlit()
+  // can be used.
+  bool IsFastBlitFormat() const;
+
   // We expose two forms of blitting to handle variations in the pixel format.
   // In FastBlit, the operation is effectively a memcpy.
   void FastBlit(uint8* image, const SkIRect& rect, CaptureData* capture_data);
@@ -358,7 +362,6 @@ CaptureData* CapturerLinux::CaptureFrame() {
 
   SkRegion invalid_region;
 
-  x_server_pixel_buffer_.Synchronize();
   if (use_damage_ && last_buffer_) {
     // Atomically fetch and clear the damage region.
     XDamageSubtract(display_, damage_handle_, None, damage_region_);
@@ -374,14 +377,36 @@ CaptureData* CapturerLinux::CaptureFrame() {
     XFree(rects);
     helper_.InvalidateRegion(invalid_region);
 
-    // Capture the damaged portions of the desktop.
+    // Capture the damaged portions of the desktop. The damage is fetched
+    // before the screen is read back, so that nothing drawn in between is
+    // lost, and the read back is skipped altogether if nothing has changed.
     helper_.SwapInvalidRegion(&invalid_region);
+    if (!invalid_region.isEmpty())
+      x_server_pixel_buffer_.Synchronize();
+    for (SkRegion::Iterator it(invalid_region); !it.done(); it.next()) {
+      CaptureRect(it.rect(), capture_data);
+    }
+  } else if (last_buffer_ && x_server_pixel_buffer_.IsScreenSynchronized() &&
+             IsFastBlitFormat() &&
+             x_server_pixel_buffer_.GetStride() == buffer.bytes_per_row()) {
+    // Full-screen polling into shared memory. The screen image has the same
+    // layout as the buffers, so diff it against the previous buffer directly
+    // and copy only what changed, rather than copying the whole screen first.
+    x_server_pixel_buffer_.Synchronize();
+    SkIRect screen_rect = SkIRect::MakeWH(buffer.size().width(),
+                                          buffer.size().height());
+    DCHECK(differ_ != NULL);
+    differ_->CalcDirtyRegion(last_buffer_,
+                             x_server_pixel_buffer_.CaptureRect(screen_rect),
+                             &invalid_region);
+    SynchronizeFrame();
     for (SkRegion::Iterator it(invalid_region); !it.done(); it.next()) {
       CaptureRect(it.rect(), capture_data);
     }
   } else {
     // Doing full-screen polling, or this is the first capture after a
     // screen-resolution change.  In either case, need a full-screen capture.
+    x_server_pixel_buffer_.Synchronize();
     SkIRect screen_rect = SkIRect::MakeWH(buffer.size().width(),
                                           buffer.size().height());
     CaptureRect(screen_rect, capture_data);
@@ -451,10 +476,7 @@ void CapturerLinux::DeinitXlib() {
 void CapturerLinux::CaptureRect(const SkIRect& rect,
                                 CaptureData* capture_data) {
   uint8* image = x_server_pixel_buffer_.CaptureRect(rect);
-  int depth = x_server_pixel_buffer_.GetDepth();
-  int bpp = x_server_pixel_buffer_.GetBitsPerPixel();
-  bool is_rgb = x_server_pixel_buffer_.IsRgb();
-  if ((depth == 24 || depth == 32) && bpp == 32 && is_rgb) {
+  if (IsFastBlitFormat()) {
     DVLOG(3) << "Fast blitting";
     FastBlit(image, rect, capture_data);
   } else {
@@ -463,6 +485,13 @@ void CapturerLinux::CaptureRect(const SkIRect& rect,
   }
 }
 
+bool CapturerLinux::IsFastBlitFormat() const {
+  int depth = x_server_pixel_buffer_.GetDepth();
+  int bpp = x_server_pixel_buffer_.GetBitsPerPixel();
+  bool is_rgb = x_server_pixel_buffer_.IsRgb();
+  return (depth == 24 || depth == 32) && bpp == 32 && is_rgb;
+}
+
 void CapturerLinux::FastBlit(uint8* image, const SkIRect& rect,
                              CaptureData* capture_data) {
   uint8* src_pos = image;
@@ -4,11 +4,22 @@
 
 #include "remoting/host/differ.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
 #include "base/logging.h"
+#include "base/threading/parallel_work.h"
 #include "remoting/host/differ_block.h"
 
 namespace remoting {
 
+// Screens with fewer pixels than this are scanned on the calling thread only;
+// for them, posting to the worker pool costs about as much as it saves.
+static const int kMinPixelsForStripes = 1280 * 1024;
+
+// The fewest block rows a stripe scans.
+static const int kMinBlockRowsPerStripe = 4;
+
 Differ::Differ(int width, int height, int bpp, int stride) {
   // Dimensions of screen.
   width_ = width;
@@ -48,6 +59,39 @@ void Differ::CalcDirtyRegion(const void* prev_buffer, const void* curr_buffer,
 void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   memset(diff_info_.get(), 0, diff_info_size_);
 
+  // Number of block rows, including a partial one at the bottom. Each stripe
+  // writes only the diff info rows of its own block rows.
+  int block_rows = diff_info_height_ - 1;
+  int stripe_count = 1;
+  if (width_ * height_ >= kMinPixelsForStripes) {
+    stripe_count =
+        base::ParallelWork::ThreadCount(block_rows / kMinBlockRowsPerStripe);
+  }
+  if (stripe_count <= 1) {
+    MarkDirtyBlockRows(prev_buffer, curr_buffer, 0, block_rows);
+    return;
+  }
+
+  base::ParallelWork::Run(FROM_HERE, stripe_count, stripe_count,
+                          base::Bind(&Differ::MarkDirtyStripe,
+                                     base::Unretained(this),
+                                     prev_buffer, curr_buffer, block_rows,
+                                     stripe_count),
+                          false);
+}
+
+void Differ::MarkDirtyStripe(const void* prev_buffer, const void* curr_buffer,
+                             int block_rows, int stripe_count, int stripe,
+                             int thread) {
+  MarkDirtyBlockRows(prev_buffer, curr_buffer,
+                     block_rows * stripe / stripe_count,
+                     block_rows * (stripe + 1) / stripe_count);
+}
+
+void Differ::MarkDirtyBlockRows(const void* prev_buffer,
+                                const void* curr_buffer,
+                                int first_block_row,
+                                int end_block_row) {
   // Calc number of full blocks.
   int x_full_blocks = width_ / kBlockSize;
   int y_full_blocks = height_ / kBlockSize;
@@ -59,15 +103,19 @@ void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   // Offset from the start of one block-column to the next.
   int block_x_offset = bytes_per_pixel_ * kBlockSize;
   // Offset from the start of one block-row to the next.
-  int block_y_stride = (width_ * bytes_per_pixel_) * kBlockSize;
+  int block_y_stride = bytes_per_row_ * kBlockSize;
   // Offset from the start of one diff_info row to the next.
   int diff_info_stride = diff_info_width_ * sizeof(DiffInfo);
 
-  const uint8* prev_block_row_start = static_cast<const uint8*>(prev_buffer);
-  const uint8* curr_block_row_start = static_cast<const uint8*>(curr_buffer);
-  DiffInfo* diff_info_row_start = static_cast<DiffInfo*>(diff_info_.get());
+  const uint8* prev_block_row_start = static_cast<const uint8*>(prev_buffer) +
+      first_block_row * block_y_stride;
+  const uint8* curr_block_row_start = static_cast<const uint8*>(curr_buffer) +
+      first_block_row * block_y_stride;
+  DiffInfo* diff_info_row_start = static_cast<DiffInfo*>(diff_info_.get()) +
+      first_block_row * diff_info_stride;
 
-  for (int y = 0; y < y_full_blocks; y++) {
+  for (int y = first_block_row; y < std::min(end_block_row, y_full_blocks);
+       y++) {
     const uint8* prev_block = prev_block_row_start;
     const uint8* curr_block = curr_block_row_start;
     DiffInfo* diff_info = diff_info_row_start;
@@ -98,7 +146,7 @@ void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   // If the screen height is not a multiple of the block size, then this
   // handles the last partial row. This situation is far more common than the
   // 'partial column' case.
-  if (partial_row_height != 0) {
+  if (partial_row_height != 0 && end_block_row > y_full_blocks) {
     const uint8* prev_block = prev_block_row_start;
     const uint8* curr_block = curr_block_row_start;
     DiffInfo* diff_info = diff_info_row_start;
@@ -40,9 +40,21 @@ class Differ {
   // Allow tests to access our private parts.
   friend class DifferTest;
 
-  // Identify all of the blocks that contain changed pixels.
+  // Identify all of the blocks that contain changed pixels. Large screens are
+  // split into stripes of block rows that are scanned on several threads.
   void MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer);
 
+  // Identify the blocks that contain changed pixels in the block rows from
+  // |first_block_row| up to, but not including, |end_block_row|.
+  void MarkDirtyBlockRows(const void* prev_buffer, const void* curr_buffer,
+                          int first_block_row, int end_block_row);
+
+  // Runs MarkDirtyBlockRows() on stripe |stripe| of |stripe_count| stripes
+  // of |block_rows| block rows. Called by base::ParallelWork.
+  void MarkDirtyStripe(const void* prev_buffer, const void* curr_buffer,
+                       int block_rows, int stripe_count, int stripe,
+                       int thread);
+
   // After the dirty blocks have been identified, this routine merges adjacent
   // blocks into a region.
   // The goal is to minimize the region that covers the dirty blocks.
@@ -256,6 +256,30 @@ TEST_F(DifferTest, MarkDirtyBlocks_Sampling) {
   EXPECT_EQ(0, GetDiffInfo(2, 2));
 }
 
+// Large screens are scanned in stripes on several threads. Every block row,
+// including the partial ones at the edges, must still be scanned exactly as
+// on one thread.
+TEST_F(DifferTest, MarkDirtyBlocks_LargeScreen) {
+  InitDiffer(1300, 1030);
+  ClearDiffInfo();
+
+  int block_columns = GetDiffInfoWidth() - 1;
+  int block_rows = GetDiffInfoHeight() - 1;
+  for (int y = 0; y < block_rows; y++) {
+    // Dirty a different column of blocks in each row.
+    WriteBlockPixel(curr_.get(), y % block_columns, y, 0, 0, 0xff00ff);
+  }
+
+  MarkDirtyBlocks(prev_.get(), curr_.get());
+
+  for (int y = 0; y < block_rows; y++) {
+    for (int x = 0; x < block_columns; x++) {
+      EXPECT_EQ(x == y % block_columns ? 1 : 0, GetDiffInfo(x, y))
+          << "when x = " << x << ", and y = " << y;
+    }
+  }
+}
+
 TEST_F(DifferTest, DiffBlock) {
   InitDiffer(kScreenWidth, kScreenHeight);
 
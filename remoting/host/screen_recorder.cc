@@ -214,12 +214,14 @@ void ScreenRecorder::CaptureDoneCallback(
       FROM_HERE, base::Bind(&ScreenRecorder::DoEncode, this, capture_data));
 }
 
-void ScreenRecorder::DoFinishOneRecording() {
+void ScreenRecorder::DoFinishOneRecording(base::TimeDelta send_time) {
   DCHECK_EQ(capture_loop_, MessageLoop::current());
 
   if (!is_recording())
     return;
 
+  scheduler_.RecordSendTime(send_time);
+
   // Decrement the number of recording in process since we have completed
   // one cycle.
   --recordings_;
@@ -247,7 +249,8 @@ void ScreenRecorder::DoSendVideoPacket(scoped_ptr<VideoPacket> packet) {
 
   base::Closure callback;
   if ((packet->flags() & VideoPacket::LAST_PARTITION) != 0)
-    callback = base::Bind(&ScreenRecorder::VideoFrameSentCallback, this);
+    callback = base::Bind(&ScreenRecorder::VideoFrameSentCallback, this,
+                          base::TimeTicks::Now());
 
   // TODO(sergeyu): Currently we send the data only to the first
   // connection. Send it to all connections if necessary.
@@ -255,14 +258,16 @@ void ScreenRecorder::DoSendVideoPacket(scoped_ptr<VideoPacket> packet) {
       packet.Pass(), callback);
 }
 
-void ScreenRecorder::VideoFrameSentCallback() {
+void ScreenRecorder::VideoFrameSentCallback(
+    base::TimeTicks send_start_time) {
   DCHECK(network_loop_->BelongsToCurrentThread());
 
   if (network_stopped_)
     return;
 
   capture_loop_->PostTask(
-      FROM_HERE, base::Bind(&ScreenRecorder::DoFinishOneRecording, this));
+      FROM_HERE, base::Bind(&ScreenRecorder::DoFinishOneRecording, this,
+                            base::TimeTicks::Now() - send_start_time));
 }
 
 void ScreenRecorder::DoStopOnNetworkThread(const base::Closure& done_task) {
@@ -123,7 +123,7 @@ class ScreenRecorder : public base::RefCountedThreadSafe<ScreenRecorder> {
 
   void DoCapture();
   void CaptureDoneCallback(scoped_refptr<CaptureData> capture_data);
-  void DoFinishOneRecording();
+  void DoFinishOneRecording(base::TimeDelta send_time);
   void DoInvalidateFullScreen();
 
   // Network thread -----------------------------------------------------------
@@ -137,8 +137,9 @@ class ScreenRecorder : public base::RefCountedThreadSafe<ScreenRecorder> {
   void DoStopOnNetworkThread(const base::Closure& done_task);
 
   // Callback for VideoStub::ProcessVideoPacket() that is used for
-  // each last packet in a frame.
-  void VideoFrameSentCallback();
+  // each last packet in a frame. |send_start_time| is when that packet was
+  // queued.
+  void VideoFrameSentCallback(base::TimeTicks send_start_time);
 
   // Encoder thread -----------------------------------------------------------
 
@@ -148,6 +148,10 @@ void XServerPixelBuffer::Synchronize() {
   }
 }
 
+bool XServerPixelBuffer::IsScreenSynchronized() const {
+  return shm_segment_info_ && !shm_pixmap_;
+}
+
 uint8* XServerPixelBuffer::CaptureRect(const SkIRect& rect) {
   if (shm_segment_info_) {
     if (shm_pixmap_) {
@@ -33,6 +33,10 @@ class XServerPixelBuffer {
   // beginning.
   void Synchronize();
 
+  // Returns true if Synchronize() reads the whole screen into shared memory,
+  // so that CaptureRect() only returns a pointer into that image.
+  bool IsScreenSynchronized() const;
+
   // Capture the specified rectangle and return a pointer to its top-left pixel
   // or NULL if capture fails. The returned pointer remains valid until the next
   // call to CaptureRect.
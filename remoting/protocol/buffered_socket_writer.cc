@@ -4,6 +4,8 @@
 
 #include "remoting/protocol/buffered_socket_writer.h"
 
+#include <string.h>
+
 #include "base/bind.h"
 #include "base/location.h"
 #include "base/message_loop_proxy.h"
@@ -165,9 +167,15 @@ void BufferedSocketWriterBase::PopQueue() {
   queue_.pop_front();
 }
 
+// GCC requires these declarations, but MSVC requires they not be present
+#ifndef _MSC_VER
+const int BufferedSocketWriter::kMaxGatheredWriteSize;
+#endif
+
 BufferedSocketWriter::BufferedSocketWriter(
     base::MessageLoopProxy* message_loop)
-  : BufferedSocketWriterBase(message_loop) {
+  : BufferedSocketWriterBase(message_loop),
+    current_buf_packets_(0) {
 }
 
 void BufferedSocketWriter::GetNextPacket_Locked(
@@ -177,8 +185,36 @@ void BufferedSocketWriter::GetNextPacket_Locked(
       *buffer = NULL;
       return;  // Nothing to write.
     }
-    current_buf_ = new net::DrainableIOBuffer(
-        queue_.front()->data(), queue_.front()->data()->size());
+
+    // Count the packets at the front of the queue that fit in one write.
+    int gathered_size = 0;
+    int gathered_packets = 0;
+    for (DataQueue::iterator it = queue_.begin(); it != queue_.end(); ++it) {
+      int packet_size = (*it)->data()->size();
+      if (gathered_size + packet_size > kMaxGatheredWriteSize)
+        break;
+      gathered_size += packet_size;
+      ++gathered_packets;
+    }
+
+    if (gathered_packets > 1) {
+      scoped_refptr<net::IOBufferWithSize> gathered(
+          new net::IOBufferWithSize(gathered_size));
+      int offset = 0;
+      DataQueue::iterator it = queue_.begin();
+      for (int i = 0; i < gathered_packets; ++i, ++it) {
+        memcpy(gathered->data() + offset, (*it)->data()->data(),
+               (*it)->data()->size());
+        offset += (*it)->data()->size();
+      }
+      current_buf_ = new net::DrainableIOBuffer(gathered, gathered_size);
+      current_buf_packets_ = gathered_packets;
+    } else {
+      // Large packets are written straight from the queue, without a copy.
+      current_buf_ = new net::DrainableIOBuffer(
+          queue_.front()->data(), queue_.front()->data()->size());
+      current_buf_packets_ = 1;
+    }
   }
 
   *buffer = current_buf_;
@@ -190,13 +226,16 @@ void BufferedSocketWriter::AdvanceBufferPosition_Locked(int written) {
   current_buf_->DidConsume(written);
 
   if (current_buf_->BytesRemaining() == 0) {
-    PopQueue();
+    for (int i = 0; i < current_buf_packets_; ++i)
+      PopQueue();
     current_buf_ = NULL;
+    current_buf_packets_ = 0;
   }
 }
 
 void BufferedSocketWriter::OnError_Locked(int result) {
   current_buf_ = NULL;
+  current_buf_packets_ = 0;
 }
 
 BufferedSocketWriter::~BufferedSocketWriter() {
@@ -105,8 +105,14 @@ class BufferedSocketWriterBase
   bool closed_;
 };
 
+// BufferedSocketWriter gathers small queued packets, such as input events
+// and control messages, into a single socket write, so that a burst of them
+// doesn't take one write each.
 class BufferedSocketWriter : public BufferedSocketWriterBase {
  public:
+  // Packets are gathered into writes of at most this many bytes.
+  static const int kMaxGatheredWriteSize = 16 * 1024;
+
   explicit BufferedSocketWriter(base::MessageLoopProxy* message_loop);
 
  protected:
@@ -118,6 +124,10 @@ class BufferedSocketWriter : public BufferedSocketWriterBase {
   virtual ~BufferedSocketWriter();
 
   scoped_refptr<net::DrainableIOBuffer> current_buf_;
+
+  // The number of packets at the front of |queue_| that |current_buf_|
+  // holds.
+  int current_buf_packets_;
 };
 
 class BufferedDatagramWriter : public BufferedSocketWriterBase {
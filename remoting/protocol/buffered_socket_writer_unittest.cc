@@ -0,0 +1,188 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/protocol/buffered_socket_writer.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "remoting/protocol/fake_session.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+namespace protocol {
+
+namespace {
+
+// FakeSocket that records where each write came from and how big it was.
+// When |async| is set, each write completes only once CompleteWrite() is
+// called.
+class RecordingSocket : public FakeSocket {
+ public:
+  RecordingSocket() : async_(false), pending_result_(0) {}
+
+  void set_async(bool async) { async_ = async; }
+
+  const std::vector<const char*>& write_data() const { return write_data_; }
+  const std::vector<int>& write_sizes() const { return write_sizes_; }
+
+  void CompleteWrite() {
+    ASSERT_FALSE(pending_callback_.is_null());
+    net::CompletionCallback callback = pending_callback_;
+    pending_callback_.Reset();
+    callback.Run(pending_result_);
+  }
+
+  // net::Socket implementation.
+  virtual int Write(net::IOBuffer* buf, int buf_len,
+                    const net::CompletionCallback& callback) OVERRIDE {
+    EXPECT_TRUE(pending_callback_.is_null());
+    write_data_.push_back(buf->data());
+    write_sizes_.push_back(buf_len);
+    int result = FakeSocket::Write(buf, buf_len, callback);
+    if (!async_)
+      return result;
+    pending_callback_ = callback;
+    pending_result_ = result;
+    return net::ERR_IO_PENDING;
+  }
+
+ private:
+  bool async_;
+  std::vector<const char*> write_data_;
+  std::vector<int> write_sizes_;
+  net::CompletionCallback pending_callback_;
+  int pending_result_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordingSocket);
+};
+
+}  // namespace
+
+class BufferedSocketWriterTest : public testing::Test {
+ public:
+  BufferedSocketWriterTest() : done_count_(0) {}
+
+  void OnDone() {
+    ++done_count_;
+  }
+
+ protected:
+  virtual void SetUp() OVERRIDE {
+    writer_ = new BufferedSocketWriter(base::MessageLoopProxy::current());
+    writer_->Init(&socket_, BufferedSocketWriter::WriteFailedCallback());
+  }
+
+  virtual void TearDown() OVERRIDE {
+    writer_ = NULL;
+    message_loop_.RunAllPending();
+  }
+
+  // Queues a packet of |size| bytes, all set to |value|, and returns it.
+  scoped_refptr<net::IOBufferWithSize> WritePacket(int size, char value) {
+    scoped_refptr<net::IOBufferWithSize> packet(
+        new net::IOBufferWithSize(size));
+    memset(packet->data(), value, size);
+    EXPECT_TRUE(writer_->Write(packet, base::Bind(
+        &BufferedSocketWriterTest::OnDone, base::Unretained(this))));
+    return packet;
+  }
+
+  MessageLoop message_loop_;
+  RecordingSocket socket_;
+  scoped_refptr<BufferedSocketWriter> writer_;
+  int done_count_;
+};
+
+// Small packets queued together go out in one write, in order.
+TEST_F(BufferedSocketWriterTest, GathersSmallPackets) {
+  WritePacket(100, 'a');
+  WritePacket(200, 'b');
+  WritePacket(300, 'c');
+  message_loop_.RunAllPending();
+
+  ASSERT_EQ(1U, socket_.write_sizes().size());
+  EXPECT_EQ(600, socket_.write_sizes()[0]);
+  EXPECT_EQ(std::string(100, 'a') + std::string(200, 'b') +
+            std::string(300, 'c'), socket_.written_data());
+  EXPECT_EQ(3, done_count_);
+  EXPECT_EQ(0, writer_->GetBufferSize());
+  EXPECT_EQ(0, writer_->GetBufferChunks());
+}
+
+// A gathered write holds no more than kMaxGatheredWriteSize bytes.
+TEST_F(BufferedSocketWriterTest, LimitsGatheredWriteSize) {
+  const int kPacketSize = BufferedSocketWriter::kMaxGatheredWriteSize / 3 + 1;
+  WritePacket(kPacketSize, 'a');
+  WritePacket(kPacketSize, 'b');
+  WritePacket(kPacketSize, 'c');
+  WritePacket(kPacketSize, 'd');
+  message_loop_.RunAllPending();
+
+  ASSERT_EQ(2U, socket_.write_sizes().size());
+  EXPECT_EQ(2 * kPacketSize, socket_.write_sizes()[0]);
+  EXPECT_EQ(2 * kPacketSize, socket_.write_sizes()[1]);
+  EXPECT_EQ(std::string(kPacketSize, 'a') + std::string(kPacketSize, 'b') +
+            std::string(kPacketSize, 'c') + std::string(kPacketSize, 'd'),
+            socket_.written_data());
+  EXPECT_EQ(4, done_count_);
+}
+
+// Packets that can't be gathered with the next one are written straight from
+// the buffers they were queued in.
+TEST_F(BufferedSocketWriterTest, WritesLargePacketsWithoutCopy) {
+  const int kLargeSize = BufferedSocketWriter::kMaxGatheredWriteSize + 1;
+  scoped_refptr<net::IOBufferWithSize> small1 = WritePacket(100, 'a');
+  scoped_refptr<net::IOBufferWithSize> large = WritePacket(kLargeSize, 'b');
+  scoped_refptr<net::IOBufferWithSize> small2 = WritePacket(100, 'c');
+  message_loop_.RunAllPending();
+
+  ASSERT_EQ(3U, socket_.write_sizes().size());
+  EXPECT_TRUE(small1->data() == socket_.write_data()[0]);
+  EXPECT_TRUE(large->data() == socket_.write_data()[1]);
+  EXPECT_EQ(kLargeSize, socket_.write_sizes()[1]);
+  EXPECT_TRUE(small2->data() == socket_.write_data()[2]);
+  EXPECT_EQ(std::string(100, 'a') + std::string(kLargeSize, 'b') +
+            std::string(100, 'c'), socket_.written_data());
+  EXPECT_EQ(3, done_count_);
+}
+
+// The done tasks of gathered packets run only once the write of all of them
+// completes.
+TEST_F(BufferedSocketWriterTest, DoneTasksRunAfterGatheredWrite) {
+  socket_.set_async(true);
+  WritePacket(100, 'a');
+  WritePacket(200, 'b');
+  message_loop_.RunAllPending();
+
+  ASSERT_EQ(1U, socket_.write_sizes().size());
+  EXPECT_EQ(300, socket_.write_sizes()[0]);
+  EXPECT_EQ(0, done_count_);
+  EXPECT_EQ(2, writer_->GetBufferChunks());
+
+  // Packets queued meanwhile wait for the pending write.
+  WritePacket(300, 'c');
+  message_loop_.RunAllPending();
+  EXPECT_EQ(1U, socket_.write_sizes().size());
+
+  socket_.CompleteWrite();
+  EXPECT_EQ(2, done_count_);
+  message_loop_.RunAllPending();
+  ASSERT_EQ(2U, socket_.write_sizes().size());
+  EXPECT_EQ(300, socket_.write_sizes()[1]);
+
+  socket_.CompleteWrite();
+  EXPECT_EQ(3, done_count_);
+  EXPECT_EQ(0, writer_->GetBufferSize());
+}
+
+}  // namespace protocol
+}  // namespace remoting
@@ -1611,6 +1611,7 @@
         'base/base_mock_objects.h',
         'base/util_unittest.cc',
         'client/key_event_mapper_unittest.cc',
+        'host/capture_scheduler_unittest.cc',
 	'host/capturer_helper_unittest.cc',
         'host/capturer_linux_unittest.cc',
         'host/capturer_mac_unittest.cc',
@@ -1643,6 +1644,7 @@
         'jingle_glue/mock_objects.h',
         'protocol/authenticator_test_base.cc',
         'protocol/authenticator_test_base.h',
+        'protocol/buffered_socket_writer_unittest.cc',
         'protocol/connection_tester.cc',
         'protocol/connection_tester.h',
         'protocol/connection_to_client_unittest.cc',
@@ -4,6 +4,8 @@
 
 #include <string.h>
 #include <time.h>
+
+#include <algorithm>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -210,6 +212,60 @@ TEST(Convolver, AddFilter) {
   ASSERT_EQ(0, filter_length);
 }
 
+// Convolving the output rows in bands gives the same pixels as convolving
+// them all at once, with the C and, if available, the SSE2 code.
+TEST(Convolver, Bands) {
+  const int kSourceWidth = 301;
+  const int kSourceHeight = 253;
+  const int kDestWidth = 137;
+  const int kDestHeight = 101;
+  float filter[] = { 0.05f, -0.15f, 0.6f, 0.6f, -0.15f, 0.05f };
+
+  ConvolutionFilter1D x_filter, y_filter;
+  for (int p = 0; p < kDestWidth; ++p) {
+    int offset = std::min(kSourceWidth * p / kDestWidth,
+                          kSourceWidth - static_cast<int>(arraysize(filter)));
+    x_filter.AddFilter(offset, filter, arraysize(filter));
+  }
+  for (int p = 0; p < kDestHeight; ++p) {
+    int offset = std::min(kSourceHeight * p / kDestHeight,
+                          kSourceHeight - static_cast<int>(arraysize(filter)));
+    y_filter.AddFilter(offset, filter, arraysize(filter));
+  }
+
+  std::vector<unsigned char> source(kSourceWidth * kSourceHeight * 4);
+  for (size_t i = 0; i < source.size(); ++i)
+    source[i] = static_cast<unsigned char>(i * 7919 % 255);
+
+  const int kBandEnds[] = { 1, 33, 34, 80, kDestHeight };
+  int byte_count = kDestWidth * kDestHeight * 4;
+  for (int sse2 = 0; sse2 < 2; sse2++) {
+#if defined(SIMD_SSE2)
+    if (sse2 && !base::CPU().has_sse2())
+      continue;
+#else
+    if (sse2)
+      continue;
+#endif
+    for (int alpha = 0; alpha < 2; alpha++) {
+      std::vector<unsigned char> whole(byte_count);
+      BGRAConvolve2D(&source[0], kSourceWidth * 4, alpha != 0,
+                     x_filter, y_filter, kDestWidth * 4, &whole[0],
+                     sse2 != 0);
+
+      std::vector<unsigned char> banded(byte_count);
+      int first_row = 0;
+      for (size_t i = 0; i < arraysize(kBandEnds); ++i) {
+        BGRAConvolve2DRows(&source[0], kSourceWidth * 4, alpha != 0,
+                           x_filter, y_filter, kDestWidth * 4, &banded[0],
+                           first_row, kBandEnds[i], sse2 != 0);
+        first_row = kBandEnds[i];
+      }
+      EXPECT_EQ(0, memcmp(&whole[0], &banded[0], byte_count));
+    }
+  }
+}
+
 TEST(Convolver, SIMDVerification) {
 #if defined(SIMD_SSE2)
   base::CPU cpu;
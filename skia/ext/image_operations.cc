@@ -10,10 +10,12 @@
 #include "skia/ext/image_operations.h"
 
 // TODO(pkasting): skia/ext should not depend on base/!
+#include "base/bind.h"
 #include "base/debug/trace_event.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
 #include "base/stack_container.h"
+#include "base/threading/parallel_work.h"
 #include "base/time.h"
 #include "build/build_config.h"
 #include "skia/ext/convolver.h"
@@ -26,6 +28,59 @@ namespace skia {
 
 namespace {
 
+// Outputs with fewer pixels than this are convolved on the calling thread
+// only, since posting the bands would cost more than it saves.
+const int kMinPixelsForBands = 512 * 512;
+
+// The fewest output rows worth convolving in a band of their own. Each band
+// also convolves horizontally the source rows its first output rows need,
+// which the band above it convolves too.
+const int kMinRowsPerBand = 64;
+
+// The arguments of one call to ImageOperations::ConvolveInBands, shared by
+// the threads convolving its bands.
+struct ConvolveJob {
+  ConvolveJob(const unsigned char* source_data,
+              int source_byte_row_stride,
+              bool source_has_alpha,
+              const ConvolutionFilter1D& filter_x,
+              const ConvolutionFilter1D& filter_y,
+              int output_byte_row_stride,
+              unsigned char* output,
+              bool use_sse2)
+      : source_data(source_data),
+        source_byte_row_stride(source_byte_row_stride),
+        source_has_alpha(source_has_alpha),
+        filter_x(filter_x),
+        filter_y(filter_y),
+        output_byte_row_stride(output_byte_row_stride),
+        output(output),
+        use_sse2(use_sse2) {
+  }
+
+  const unsigned char* source_data;
+  int source_byte_row_stride;
+  bool source_has_alpha;
+  const ConvolutionFilter1D& filter_x;
+  const ConvolutionFilter1D& filter_y;
+  int output_byte_row_stride;
+  unsigned char* output;
+  bool use_sse2;
+};
+
+// Convolves band |band| of |band_count| bands of output rows.
+void ConvolveBand(const ConvolveJob* job, int band_count, int band,
+                  int /* thread */) {
+  int num_rows = job->filter_y.num_values();
+  int first_row = num_rows * band / band_count;
+  int end_row = num_rows * (band + 1) / band_count;
+  TRACE_EVENT1("skia", "ConvolveBand", "rows", end_row - first_row);
+  BGRAConvolve2DRows(job->source_data, job->source_byte_row_stride,
+                     job->source_has_alpha, job->filter_x, job->filter_y,
+                     job->output_byte_row_stride, job->output,
+                     first_row, end_row, job->use_sse2);
+}
+
 // Returns the ceiling/floor as an integer.
 inline int CeilInt(float val) {
   return static_cast<int>(ceil(val));
@@ -522,11 +577,11 @@ SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
   if (!result.readyToDraw())
     return SkBitmap();
 
-  BGRAConvolve2D(source_subset, static_cast<int>(source.rowBytes()),
-                 !source.isOpaque(), filter.x_filter(), filter.y_filter(),
-                 static_cast<int>(result.rowBytes()),
-                 static_cast<unsigned char*>(result.getPixels()),
-                 cpu.has_sse2());
+  ConvolveInBands(source_subset, static_cast<int>(source.rowBytes()),
+                  !source.isOpaque(), filter.x_filter(), filter.y_filter(),
+                  static_cast<int>(result.rowBytes()),
+                  static_cast<unsigned char*>(result.getPixels()),
+                  cpu.has_sse2());
 
   // Preserve the "opaque" flag for use as an optimization later.
   result.setIsOpaque(source.isOpaque());
@@ -537,6 +592,36 @@ SkBitmap ImageOperations::ResizeBasic(const SkBitmap& source,
   return result;
 }
 
+// static
+void ImageOperations::ConvolveInBands(const unsigned char* source_data,
+                                      int source_byte_row_stride,
+                                      bool source_has_alpha,
+                                      const ConvolutionFilter1D& filter_x,
+                                      const ConvolutionFilter1D& filter_y,
+                                      int output_byte_row_stride,
+                                      unsigned char* output,
+                                      bool use_sse2) {
+  int num_rows = filter_y.num_values();
+  int band_count = 1;
+  if (filter_x.num_values() * num_rows >= kMinPixelsForBands) {
+    band_count = base::ParallelWork::ThreadCount(num_rows / kMinRowsPerBand);
+  }
+  if (band_count <= 1) {
+    BGRAConvolve2D(source_data, source_byte_row_stride, source_has_alpha,
+                   filter_x, filter_y, output_byte_row_stride, output,
+                   use_sse2);
+    return;
+  }
+
+  ConvolveJob job(source_data, source_byte_row_stride, source_has_alpha,
+                  filter_x, filter_y, output_byte_row_stride, output,
+                  use_sse2);
+  base::ParallelWork::Run(FROM_HERE, band_count, band_count,
+                          base::Bind(&ConvolveBand, base::Unretained(&job),
+                                     band_count),
+                          false);
+}
+
 // static
 SkBitmap ImageOperations::Resize(const SkBitmap& source,
                                  ResizeMethod method,
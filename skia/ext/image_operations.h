@@ -13,6 +13,8 @@ struct SkIRect;
 
 namespace skia {
 
+class ConvolutionFilter1D;
+
 class SK_API ImageOperations {
  public:
   enum ResizeMethod {
@@ -123,6 +125,18 @@ class SK_API ImageOperations {
   static SkBitmap ResizeSubpixel(const SkBitmap& source,
                                  int dest_width, int dest_height,
                                  const SkIRect& dest_subset);
+
+  // Same as BGRAConvolve2D, but large outputs are split into bands of rows
+  // that are convolved on the worker pool as well as on this thread, with
+  // base::ParallelWork.
+  static void ConvolveInBands(const unsigned char* source_data,
+                              int source_byte_row_stride,
+                              bool source_has_alpha,
+                              const ConvolutionFilter1D& filter_x,
+                              const ConvolutionFilter1D& filter_y,
+                              int output_byte_row_stride,
+                              unsigned char* output,
+                              bool use_sse2);
 };
 
 }  // namespace skia
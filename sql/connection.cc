@@ -6,8 +6,14 @@
 
 #include <string.h>
 
+#include <algorithm>
+
+#include "base/debug/trace_event.h"
 #include "base/file_path.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/metrics/histogram.h"
+#include "base/platform_file.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "base/utf_string_conversions.h"
@@ -21,6 +27,9 @@ namespace {
 // TODO(shess): Better story on this.  http://crbug.com/56559
 const int kBusyTimeoutSeconds = 1;
 
+// Number of statements GetUniqueStatement() keeps compiled by default.
+const size_t kDefaultUniqueStatementCacheSize = 16;
+
 class ScopedBusyTimeout {
  public:
   explicit ScopedBusyTimeout(sqlite3* db)
@@ -56,6 +65,17 @@ ErrorDelegate::ErrorDelegate() {
 ErrorDelegate::~ErrorDelegate() {
 }
 
+// static
+const int Connection::kSlowStepThresholdMs = 100;
+
+Connection::Stats::Stats()
+    : statements_prepared(0),
+      unique_statement_cache_hits(0),
+      steps(0),
+      rows(0),
+      slow_steps(0) {
+}
+
 Connection::StatementRef::StatementRef()
     : connection_(NULL),
       stmt_(NULL) {
@@ -87,6 +107,13 @@ Connection::Connection()
       page_size_(0),
       cache_size_(0),
       exclusive_locking_(false),
+      write_ahead_logging_(false),
+      synchronous_(SYNCHRONOUS_DEFAULT),
+      unique_statement_cache_(UniqueStatementCache::NO_AUTO_EVICT),
+      unique_statement_cache_size_(kDefaultUniqueStatementCacheSize),
+      open_time_histogram_(NULL),
+      prepare_time_histogram_(NULL),
+      step_time_histogram_(NULL),
       transaction_nesting_(0),
       needs_rollback_(false) {
 }
@@ -96,11 +123,16 @@ Connection::~Connection() {
 }
 
 bool Connection::Open(const FilePath& path) {
+  TRACE_EVENT1("sql", "Connection::Open", "tag", histogram_tag_);
+  const base::TimeTicks start = base::TimeTicks::Now();
 #if defined(OS_WIN)
-  return OpenInternal(WideToUTF8(path.value()));
+  bool success = OpenInternal(WideToUTF8(path.value()));
 #elif defined(OS_POSIX)
-  return OpenInternal(path.value());
+  bool success = OpenInternal(path.value());
 #endif
+  if (success && open_time_histogram_)
+    open_time_histogram_->AddTime(base::TimeTicks::Now() - start);
+  return success;
 }
 
 bool Connection::OpenInMemory() {
@@ -117,6 +149,7 @@ void Connection::Close() {
   // Release all cached statements, then assert that the client has
   // released all statements.
   statement_cache_.clear();
+  unique_statement_cache_.Clear();
   DCHECK(open_statements_.empty());
 
   // Additionally clear the prepared statements, because they contain
@@ -147,6 +180,7 @@ void Connection::Close() {
 }
 
 void Connection::Preload() {
+  TRACE_EVENT1("sql", "Connection::Preload", "tag", histogram_tag_);
   if (!db_) {
     DLOG(FATAL) << "Cannot preload null db";
     return;
@@ -168,6 +202,32 @@ void Connection::Preload() {
 #endif
 }
 
+// static
+bool Connection::PrefetchFile(const FilePath& path, int64 max_bytes) {
+  TRACE_EVENT0("sql", "Connection::PrefetchFile");
+  base::PlatformFile file = base::CreatePlatformFile(
+      path, base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_READ, NULL, NULL);
+  if (file == base::kInvalidPlatformFileValue)
+    return false;
+
+  // Read in large chunks, front to back, so the OS can read ahead and the
+  // disk does not have to seek.
+  const int kChunkSize = 256 * 1024;
+  scoped_array<char> buffer(new char[kChunkSize]);
+  int64 offset = 0;
+  while (offset < max_bytes) {
+    const int to_read =
+        static_cast<int>(std::min<int64>(kChunkSize, max_bytes - offset));
+    const int read = base::ReadPlatformFile(file, offset, buffer.get(),
+                                            to_read);
+    if (read <= 0)
+      break;
+    offset += read;
+  }
+  base::ClosePlatformFile(file);
+  return true;
+}
+
 // Create an in-memory database with the existing database's page
 // size, then backup that database over the existing database.
 bool Connection::Raze() {
@@ -357,18 +417,96 @@ scoped_refptr<Connection::StatementRef> Connection::GetCachedStatement(
 
 scoped_refptr<Connection::StatementRef> Connection::GetUniqueStatement(
     const char* sql) {
+  if (!db_ || unique_statement_cache_size_ == 0)
+    return PrepareStatement(sql);
+
+  const std::string key(sql);
+  UniqueStatementCache::iterator i = unique_statement_cache_.Get(key);
+  if (i != unique_statement_cache_.end()) {
+    // Only give the statement out if nobody else is still using it. Its last
+    // user reset it and cleared its bindings when done with it.
+    if (i->second->HasOneRef() && i->second->is_valid()) {
+      stats_.unique_statement_cache_hits++;
+      return i->second;
+    }
+    return PrepareStatement(sql);
+  }
+
+  scoped_refptr<StatementRef> statement = PrepareStatement(sql);
+  if (statement->is_valid()) {
+    unique_statement_cache_.Put(key, statement);
+    unique_statement_cache_.ShrinkToSize(unique_statement_cache_size_);
+  }
+  return statement;
+}
+
+void Connection::set_unique_statement_cache_size(size_t size) {
+  unique_statement_cache_size_ = size;
+  unique_statement_cache_.ShrinkToSize(size);
+}
+
+void Connection::set_histogram_tag(const std::string& tag) {
+  histogram_tag_ = tag;
+  if (tag.empty()) {
+    open_time_histogram_ = NULL;
+    prepare_time_histogram_ = NULL;
+    step_time_histogram_ = NULL;
+    return;
+  }
+  open_time_histogram_ = base::Histogram::FactoryTimeGet(
+      "Sqlite.OpenTime." + tag,
+      base::TimeDelta::FromMilliseconds(1), base::TimeDelta::FromMinutes(1),
+      50, base::Histogram::kUmaTargetedHistogramFlag);
+  prepare_time_histogram_ = base::Histogram::FactoryTimeGet(
+      "Sqlite.PrepareTime." + tag,
+      base::TimeDelta::FromMicroseconds(10), base::TimeDelta::FromSeconds(1),
+      50, base::Histogram::kUmaTargetedHistogramFlag);
+  step_time_histogram_ = base::Histogram::FactoryTimeGet(
+      "Sqlite.StepTime." + tag,
+      base::TimeDelta::FromMicroseconds(10), base::TimeDelta::FromSeconds(10),
+      50, base::Histogram::kUmaTargetedHistogramFlag);
+}
+
+scoped_refptr<Connection::StatementRef> Connection::PrepareStatement(
+    const char* sql) {
   if (!db_)
     return new StatementRef(this, NULL);  // Return inactive statement.
 
+  base::TimeTicks start;
+  if (prepare_time_histogram_)
+    start = base::TimeTicks::Now();
+
   sqlite3_stmt* stmt = NULL;
   if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK) {
     // This is evidence of a syntax error in the incoming SQL.
     DLOG(FATAL) << "SQL compile error " << GetErrorMessage();
     return new StatementRef(this, NULL);
   }
+
+  stats_.statements_prepared++;
+  if (prepare_time_histogram_)
+    prepare_time_histogram_->AddTime(base::TimeTicks::Now() - start);
   return new StatementRef(this, stmt);
 }
 
+void Connection::OnStatementStep(sqlite3_stmt* stmt,
+                                 const base::TimeTicks& start,
+                                 int rv) {
+  stats_.steps++;
+  if (rv == SQLITE_ROW)
+    stats_.rows++;
+  if (!step_time_histogram_ || start.is_null())
+    return;
+
+  const base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  step_time_histogram_->AddTime(elapsed);
+  if (elapsed.InMilliseconds() >= kSlowStepThresholdMs) {
+    stats_.slow_steps++;
+    DLOG(WARNING) << "Slow SQL step (" << elapsed.InMilliseconds() << " ms): "
+                  << sqlite3_sql(stmt);
+  }
+}
+
 bool Connection::IsSQLValid(const char* sql) {
   sqlite3_stmt* stmt = NULL;
   if (sqlite3_prepare_v2(db_, sql, -1, &stmt, NULL) != SQLITE_OK)
@@ -496,11 +634,15 @@ bool Connection::OpenInternal(const std::string& file_name) {
   // DELETE (default) - delete -journal file to commit.
   // TRUNCATE - truncate -journal file to commit.
   // PERSIST - zero out header of -journal file to commit.
-  // journal_size_limit provides size to trim to in PERSIST.
+  // WAL - append to the -wal file to commit.
+  // journal_size_limit provides size to trim to in PERSIST, and the size
+  // the -wal file is truncated to after a checkpoint in WAL.
   // TODO(shess): Figure out if PERSIST and journal_size_limit really
   // matter.  In theory, it keeps pages pre-allocated, so if
   // transactions usually fit, it should be faster.
-  ignore_result(Execute("PRAGMA journal_mode = PERSIST"));
+  // The write-ahead log is set up below, once the page size is settled.
+  if (!write_ahead_logging_)
+    ignore_result(Execute("PRAGMA journal_mode = PERSIST"));
   ignore_result(Execute("PRAGMA journal_size_limit = 16384"));
 
   const base::TimeDelta kBusyTimeout =
@@ -523,6 +665,31 @@ bool Connection::OpenInternal(const std::string& file_name) {
       DLOG(FATAL) << "Could not set cache size: " << GetErrorMessage();
   }
 
+  // The page size of a database cannot change once it uses a write-ahead log.
+  if (write_ahead_logging_) {
+    bool using_wal = false;
+    {
+      // The pragma returns the mode in effect, which stays the old one if the
+      // database cannot use a log (for instance, when it is in memory).
+      Statement journal_mode(GetUniqueStatement("PRAGMA journal_mode = WAL"));
+      using_wal = journal_mode.Step() &&
+          LowerCaseEqualsASCII(journal_mode.ColumnString(0), "wal");
+    }
+    if (!using_wal) {
+      DLOG(WARNING) << "Could not use a write-ahead log: " << GetErrorMessage();
+      ignore_result(Execute("PRAGMA journal_mode = PERSIST"));
+    }
+  }
+
+  if (synchronous_ != SYNCHRONOUS_DEFAULT) {
+    static const char* kSynchronousModes[] = { NULL, "OFF", "NORMAL", "FULL" };
+    DCHECK_LT(static_cast<size_t>(synchronous_), arraysize(kSynchronousModes));
+    const std::string sql =
+        StringPrintf("PRAGMA synchronous=%s", kSynchronousModes[synchronous_]);
+    if (!ExecuteWithTimeout(sql.c_str(), kBusyTimeout))
+      DLOG(FATAL) << "Could not set synchronous mode: " << GetErrorMessage();
+  }
+
   if (!ExecuteWithTimeout("PRAGMA secure_delete=ON", kBusyTimeout)) {
     DLOG(FATAL) << "Could not enable secure_delete: " << GetErrorMessage();
     Close();
@@ -553,6 +720,7 @@ void Connection::StatementRefDeleted(StatementRef* ref) {
 
 void Connection::ClearCache() {
   statement_cache_.clear();
+  unique_statement_cache_.Clear();
 
   // The cache clear will get most statements. There may be still be references
   // to some statements that are held by others (including one-shot statements).
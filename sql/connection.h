@@ -12,6 +12,7 @@
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/memory/mru_cache.h"
 #include "base/memory/ref_counted.h"
 #include "base/time.h"
 #include "sql/sql_export.h"
@@ -20,6 +21,10 @@ class FilePath;
 struct sqlite3;
 struct sqlite3_stmt;
 
+namespace base {
+class Histogram;
+}
+
 namespace sql {
 
 class Statement;
@@ -139,6 +144,68 @@ class SQL_EXPORT Connection {
   // This must be called before Open() to have an effect.
   void set_exclusive_locking() { exclusive_locking_ = true; }
 
+  // Call to use a write-ahead log instead of the rollback journal. Commits
+  // append to the log rather than rewriting pages of the database, and are
+  // checkpointed into it from time to time, so a database that takes many
+  // small transactions sees far fewer writes. Readers in other connections do
+  // not block the writer. The log is kept in a "-wal" file next to the
+  // database until the last connection closes.
+  //
+  // This must be called before Open() to have an effect.
+  void set_write_ahead_logging() { write_ahead_logging_ = true; }
+
+  // How often sqlite waits for data to reach the disk. See
+  // http://www.sqlite.org/pragma.html#pragma_synchronous
+  enum Synchronous {
+    // Leave the sqlite default (FULL).
+    SYNCHRONOUS_DEFAULT,
+    // Never sync. The database may be corrupted by a power loss.
+    SYNCHRONOUS_OFF,
+    // Sync at the critical moments only. With a write-ahead log, this only
+    // syncs on checkpoints, and a power loss can lose the last commits but
+    // does not corrupt the database.
+    SYNCHRONOUS_NORMAL,
+    // Sync on every commit.
+    SYNCHRONOUS_FULL,
+  };
+
+  // Sets how often the database is synced. This must be called before Open()
+  // to have an effect.
+  void set_synchronous(Synchronous synchronous) { synchronous_ = synchronous; }
+
+  // Sets the number of statements given out by GetUniqueStatement() that are
+  // kept compiled, keyed by their SQL, for the next caller that asks for the
+  // same SQL. Zero turns this off. The least recently used statements are
+  // dropped first.
+  void set_unique_statement_cache_size(size_t size);
+
+  // Sets a tag used to name the histograms this connection reports, such as
+  // "Sqlite.StepTime.History", and to label its trace events. Without a tag
+  // (the default), nothing is timed and no histograms are reported. This
+  // should be called before Open().
+  void set_histogram_tag(const std::string& tag);
+
+  // Counts of the work done through this connection since it was created.
+  struct Stats {
+    Stats();
+
+    // Statements compiled by sqlite.
+    int statements_prepared;
+    // GetUniqueStatement() calls answered from the statement cache.
+    int unique_statement_cache_hits;
+    // Calls to Statement::Step() or Run().
+    int steps;
+    // Rows returned by Statement::Step().
+    int rows;
+    // Steps that took longer than kSlowStepThreshold. Only counted with a
+    // histogram tag.
+    int slow_steps;
+  };
+  const Stats& stats() const { return stats_; }
+
+  // Steps that take longer than this are logged and counted as slow.
+  static const int kSlowStepThresholdMs;
+
   // Sets the object that will handle errors. Recomended that it should be set
   // before calling Open(). If not set, the default is to ignore errors on
   // release and assert on debug builds.
@@ -181,6 +248,14 @@ class SQL_EXPORT Connection {
   // generally exist either.
   void Preload();
 
+  // Reads up to the first |max_bytes| of the file at |path| from front to
+  // back, so that a database opened from it soon after finds its pages in the
+  // OS file cache instead of seeking for each of them. Unlike Preload(), this
+  // does not need a Connection, and can run on any thread that allows I/O,
+  // typically ahead of the thread that opens the database. Returns false if
+  // the file could not be opened.
+  static bool PrefetchFile(const FilePath& path, int64 max_bytes);
+
   // Raze the database to the ground.  This approximates creating a
   // fresh database from scratch, within the constraints of SQLite's
   // locking protocol (locks and open handles can make doing this with
@@ -271,9 +346,14 @@ class SQL_EXPORT Connection {
   // valid SQL, returns true.
   bool IsSQLValid(const char* sql);
 
-  // Returns a non-cached statement for the given SQL. Use this for SQL that
-  // is only executed once or only rarely (there is overhead associated with
-  // keeping a statement cached).
+  // Returns a statement for the given SQL that is not shared with any other
+  // caller. Use this for SQL that is only executed once or only rarely, or
+  // that is built at runtime.
+  //
+  // The last few statements returned here stay compiled once released, and
+  // are given out again for the same SQL (see
+  // set_unique_statement_cache_size()), so a loop over this does not
+  // recompile the SQL every time.
   //
   // See GetCachedStatement above for examples and error information.
   scoped_refptr<StatementRef> GetUniqueStatement(const char* sql);
@@ -380,6 +460,14 @@ class SQL_EXPORT Connection {
   // Frees all cached statements from statement_cache_.
   void ClearCache();
 
+  // Compiles |sql| into a new statement.
+  scoped_refptr<StatementRef> PrepareStatement(const char* sql);
+
+  // Called by Statement after each sqlite3_step() of |stmt| that started at
+  // |start| (null without a histogram tag) and returned |rv|.
+  void OnStatementStep(sqlite3_stmt* stmt, const base::TimeTicks& start,
+                       int rv);
+
   // Called by Statement objects when an sqlite function returns an error.
   // The return value is the error code reflected back to client code.
   int OnSqliteError(int err, Statement* stmt);
@@ -397,6 +485,8 @@ class SQL_EXPORT Connection {
   int page_size_;
   int cache_size_;
   bool exclusive_locking_;
+  bool write_ahead_logging_;
+  Synchronous synchronous_;
 
   // All cached statements. Keeping a reference to these statements means that
   // they'll remain active.
@@ -404,6 +494,21 @@ class SQL_EXPORT Connection {
       CachedStatementMap;
   CachedStatementMap statement_cache_;
 
+  // Statements given out by GetUniqueStatement(), keyed by their SQL. A
+  // statement is only reused when the cache holds the last reference to it.
+  typedef base::MRUCache<std::string, scoped_refptr<StatementRef> >
+      UniqueStatementCache;
+  UniqueStatementCache unique_statement_cache_;
+  size_t unique_statement_cache_size_;
+
+  Stats stats_;
+
+  // Set by set_histogram_tag(). The histograms are NULL when there is no tag.
+  std::string histogram_tag_;
+  base::Histogram* open_time_histogram_;
+  base::Histogram* prepare_time_histogram_;
+  base::Histogram* step_time_histogram_;
+
   // A list of all StatementRefs we've given out. Each ref must register with
   // us when it's created or destroyed. This allows us to potentially close
   // any open statements when we encounter an error.
@@ -258,6 +258,115 @@ TEST_F(SQLConnectionTest, RazeLocked) {
   ASSERT_TRUE(db().Raze());
 }
 
+TEST_F(SQLConnectionTest, WriteAheadLogging) {
+  sql::Connection other_db;
+  other_db.set_write_ahead_logging();
+  other_db.set_synchronous(sql::Connection::SYNCHRONOUS_NORMAL);
+  db().Close();
+  ASSERT_TRUE(other_db.Open(db_path()));
+
+  {
+    sql::Statement s(other_db.GetUniqueStatement("PRAGMA journal_mode"));
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ("wal", s.ColumnString(0));
+  }
+  {
+    // NORMAL is 1.
+    sql::Statement s(other_db.GetUniqueStatement("PRAGMA synchronous"));
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(1, s.ColumnInt(0));
+  }
+
+  ASSERT_TRUE(other_db.Execute("CREATE TABLE foo (a, b)"));
+  ASSERT_TRUE(other_db.Execute("INSERT INTO foo VALUES (1, 2)"));
+  other_db.Close();
+
+  // The log is checkpointed into the database when it is closed.
+  ASSERT_TRUE(db().Open(db_path()));
+  sql::Statement s(db().GetUniqueStatement("SELECT COUNT(*) FROM foo"));
+  ASSERT_TRUE(s.Step());
+  EXPECT_EQ(1, s.ColumnInt(0));
+}
+
+// An in-memory database cannot use a write-ahead log, and keeps working with
+// a rollback journal.
+TEST_F(SQLConnectionTest, WriteAheadLoggingInMemory) {
+  sql::Connection memory_db;
+  memory_db.set_write_ahead_logging();
+  ASSERT_TRUE(memory_db.OpenInMemory());
+  ASSERT_TRUE(memory_db.Execute("CREATE TABLE foo (a, b)"));
+  ASSERT_TRUE(memory_db.Execute("INSERT INTO foo VALUES (1, 2)"));
+}
+
+TEST_F(SQLConnectionTest, UniqueStatementCache) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo VALUES (1, 2)"));
+  const char kQuery[] = "SELECT b FROM foo WHERE a = ?";
+  const int hits = db().stats().unique_statement_cache_hits;
+
+  {
+    sql::Statement s(db().GetUniqueStatement(kQuery));
+    s.BindInt(0, 1);
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(2, s.ColumnInt(0));
+  }
+
+  // The released statement is given out again, without its bindings.
+  {
+    sql::Statement s(db().GetUniqueStatement(kQuery));
+    EXPECT_EQ(hits + 1, db().stats().unique_statement_cache_hits);
+    EXPECT_FALSE(s.Step());
+
+    // A statement still in use is not shared.
+    sql::Statement other(db().GetUniqueStatement(kQuery));
+    EXPECT_EQ(hits + 1, db().stats().unique_statement_cache_hits);
+    other.BindInt(0, 1);
+    ASSERT_TRUE(other.Step());
+    EXPECT_EQ(2, other.ColumnInt(0));
+  }
+
+  db().set_unique_statement_cache_size(0);
+  {
+    sql::Statement s(db().GetUniqueStatement(kQuery));
+    EXPECT_TRUE(s.is_valid());
+  }
+  {
+    sql::Statement s(db().GetUniqueStatement(kQuery));
+    EXPECT_TRUE(s.is_valid());
+  }
+  EXPECT_EQ(hits + 1, db().stats().unique_statement_cache_hits);
+}
+
+TEST_F(SQLConnectionTest, Stats) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo VALUES (1)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo VALUES (2)"));
+  db().set_histogram_tag("Test");
+
+  const sql::Connection::Stats before = db().stats();
+  sql::Statement s(db().GetUniqueStatement("SELECT a FROM foo"));
+  while (s.Step()) {
+  }
+  EXPECT_EQ(before.steps + 3, db().stats().steps);
+  EXPECT_EQ(before.rows + 2, db().stats().rows);
+  EXPECT_EQ(before.statements_prepared + 1, db().stats().statements_prepared);
+}
+
+TEST_F(SQLConnectionTest, PrefetchFile) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (a, b)"));
+  ASSERT_TRUE(db().Execute("INSERT INTO foo VALUES (1, 2)"));
+
+  // Works on an open database, whatever the limit.
+  EXPECT_TRUE(sql::Connection::PrefetchFile(db_path(), 1));
+  EXPECT_TRUE(sql::Connection::PrefetchFile(db_path(), kint64max));
+  sql::Statement s(db().GetUniqueStatement("SELECT COUNT(*) FROM foo"));
+  ASSERT_TRUE(s.Step());
+  EXPECT_EQ(1, s.ColumnInt(0));
+
+  EXPECT_FALSE(sql::Connection::PrefetchFile(
+      db_path().InsertBeforeExtensionASCII("-missing"), kint64max));
+}
+
 // TODO(shess): Spin up a background thread to hold other_db, to more
 // closely match real life.  That would also allow testing
 // RazeWithTimeout().
@@ -51,14 +51,24 @@ bool Statement::Run() {
   if (!CheckValid())
     return false;
 
-  return CheckError(sqlite3_step(ref_->stmt())) == SQLITE_DONE;
+  return CheckError(StepInternal()) == SQLITE_DONE;
 }
 
 bool Statement::Step() {
   if (!CheckValid())
     return false;
 
-  return CheckError(sqlite3_step(ref_->stmt())) == SQLITE_ROW;
+  return CheckError(StepInternal()) == SQLITE_ROW;
+}
+
+int Statement::StepInternal() {
+  Connection* connection = ref_->connection();
+  base::TimeTicks start;
+  if (connection->step_time_histogram_)
+    start = base::TimeTicks::Now();
+  int rv = sqlite3_step(ref_->stmt());
+  connection->OnStatementStep(ref_->stmt(), start, rv);
+  return rv;
 }
 
 void Statement::Reset(bool clear_bound_vars) {
@@ -156,6 +156,10 @@ class SQL_EXPORT Statement {
   // enhanced in the future to do the notification.
   int CheckError(int err);
 
+  // Steps the statement, and lets the connection account for the step.
+  // Returns the sqlite result code.
+  int StepInternal();
+
   // Contraction for checking an error code against SQLITE_OK. Does not set the
   // succeeded flag.
   bool CheckOk(int err) const;
@@ -42,6 +42,7 @@ SyncerError ProcessUpdatesCommand::ModelChangingExecuteImpl(
     return SYNCER_OK;  // Nothing to do.
 
   syncable::WriteTransaction trans(FROM_HERE, syncable::SYNCER, dir);
+  const Cryptographer* cryptographer = dir->GetCryptographer(&trans);
   vector<sessions::VerifiedUpdate>::const_iterator it;
   for (it = progress->VerifiedUpdatesBegin();
        it != progress->VerifiedUpdatesEnd();
@@ -50,9 +51,7 @@ SyncerError ProcessUpdatesCommand::ModelChangingExecuteImpl(
 
     if (it->first != VERIFY_SUCCESS && it->first != VERIFY_UNDELETE)
       continue;
-    switch (ProcessUpdate(update,
-                          dir->GetCryptographer(&trans),
-                          &trans)) {
+    switch (ProcessUpdate(update, cryptographer, &trans)) {
       case SUCCESS_PROCESSED:
       case SUCCESS_STORED:
         break;
@@ -789,18 +789,30 @@ void SyncScheduler::DoSyncSessionJob(const SyncSessionJob& job) {
   SDVLOG(2) << "DoSyncSessionJob with "
             << SyncSessionJob::GetPurposeString(job.purpose) << " job";
 
-  SyncerStep begin(SYNCER_END);
-  SyncerStep end(SYNCER_END);
-  SetSyncerStepsForPurpose(job.purpose, &begin, &end);
-
   bool has_more_to_sync = true;
+  bool commit_only = false;
   while (ShouldRunJob(job) && has_more_to_sync) {
+    SyncerStep begin(SYNCER_END);
+    SyncerStep end(SYNCER_END);
+    SetSyncerStepsForPurpose(job.purpose, &begin, &end);
+    if (commit_only)
+      begin = BUILD_COMMIT_REQUEST;
+
     SDVLOG(2) << "Calling SyncShare.";
     // Synchronously perform the sync session from this thread.
     syncer_->SyncShare(job.session.get(), begin, end);
     has_more_to_sync = job.session->HasMoreToSync();
-    if (has_more_to_sync)
+    if (has_more_to_sync) {
+      // When the only thing left is the rest of a large commit, go straight
+      // to the next commit batch; the updates were downloaded and applied at
+      // the start of this job, and the server reports any conflict with
+      // newer updates in its commit response. A cycle that continues because
+      // conflicts were resolved starts from the beginning again.
+      commit_only = end == SYNCER_END &&
+          !job.session->status_controller().conflicts_resolved() &&
+          job.session->HasMoreToCommit();
       job.session->PrepareForAnotherSyncCycle();
+    }
   }
   SDVLOG(2) << "Done SyncShare looping.";
 
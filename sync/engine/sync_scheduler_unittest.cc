@@ -24,6 +24,7 @@ using testing::_;
 using testing::AtLeast;
 using testing::DoAll;
 using testing::Eq;
+using testing::InSequence;
 using testing::Invoke;
 using testing::Mock;
 using testing::Return;
@@ -722,6 +723,40 @@ TEST_F(SyncSchedulerTest, HasMoreToSync) {
   // cause our expectation to break.
 }
 
+// Test that the rest of a large commit skips downloading updates again.
+TEST_F(SyncSchedulerTest, HasMoreToCommit) {
+  EXPECT_CALL(*syncer(), SyncShare(_, SYNCER_BEGIN, SYNCER_END))
+      .WillOnce(Invoke(sessions::test_util::SimulateHasMoreToCommit));
+  EXPECT_CALL(*syncer(), SyncShare(_, BUILD_COMMIT_REQUEST, SYNCER_END))
+      .WillOnce(DoAll(Invoke(sessions::test_util::SimulateSuccess),
+                      QuitLoopNowAction()));
+  StartSyncScheduler(SyncScheduler::NORMAL_MODE);
+  RunLoop();
+
+  scheduler()->ScheduleNudge(
+      zero(), NUDGE_SOURCE_LOCAL, ModelTypeSet(), FROM_HERE);
+  RunLoop();
+}
+
+// Test that a cycle continued because conflicts were resolved starts from the
+// beginning, even after cycles that only committed.
+TEST_F(SyncSchedulerTest, HasMoreToSyncAfterCommitOnlyCycle) {
+  InSequence seq;
+  EXPECT_CALL(*syncer(), SyncShare(_, SYNCER_BEGIN, SYNCER_END))
+      .WillOnce(Invoke(sessions::test_util::SimulateHasMoreToCommit));
+  EXPECT_CALL(*syncer(), SyncShare(_, BUILD_COMMIT_REQUEST, SYNCER_END))
+      .WillOnce(Invoke(sessions::test_util::SimulateHasMoreToSync));
+  EXPECT_CALL(*syncer(), SyncShare(_, SYNCER_BEGIN, SYNCER_END))
+      .WillOnce(DoAll(Invoke(sessions::test_util::SimulateSuccess),
+                      QuitLoopNowAction()));
+  StartSyncScheduler(SyncScheduler::NORMAL_MODE);
+  RunLoop();
+
+  scheduler()->ScheduleNudge(
+      zero(), NUDGE_SOURCE_LOCAL, ModelTypeSet(), FROM_HERE);
+  RunLoop();
+}
+
 // Test that no syncing occurs when throttled.
 TEST_F(SyncSchedulerTest, ThrottlingDoesThrottle) {
   const ModelTypeSet types(syncable::BOOKMARKS);
@@ -753,7 +788,7 @@ TEST_F(SyncSchedulerTest, ThrottlingExpires) {
   TimeDelta throttle1(TimeDelta::FromMilliseconds(150));
   scheduler()->OnReceivedLongPollIntervalUpdate(poll);
 
-  ::testing::InSequence seq;
+  InSequence seq;
   EXPECT_CALL(*syncer(), SyncShare(_,_,_))
       .WillOnce(WithArg<0>(sessions::test_util::SimulateThrottled(throttle1)))
       .RetiresOnSaturation();
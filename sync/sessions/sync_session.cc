@@ -181,14 +181,17 @@ void SyncSession::SendEventNotification(SyncEngineEvent::EventCause cause) {
 }
 
 bool SyncSession::HasMoreToSync() const {
-  const StatusController* status = status_controller_.get();
-  return ((status->commit_ids().size() < status->unsynced_handles().size()) &&
-      status->syncer_status().num_successful_commits > 0) ||
-      status->conflicts_resolved();
+  return HasMoreToCommit() || status_controller_->conflicts_resolved();
       // Or, we have conflicting updates, but we're making progress on
       // resolving them...
 }
 
+bool SyncSession::HasMoreToCommit() const {
+  const StatusController* status = status_controller_.get();
+  return (status->commit_ids().size() < status->unsynced_handles().size()) &&
+      status->syncer_status().num_successful_commits > 0;
+}
+
 const std::set<ModelSafeGroup>& SyncSession::GetEnabledGroups() const {
   return enabled_groups_;
 }
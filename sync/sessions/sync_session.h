@@ -112,6 +112,11 @@ class SyncSession {
   // engine again.
   bool HasMoreToSync() const;
 
+  // Returns true if the last commit succeeded but left unsynced items that did
+  // not fit in its batch. Those can be committed right away, without another
+  // round of downloading and applying updates first.
+  bool HasMoreToCommit() const;
+
   // Returns true if there we did not detect any errors in this session.
   //
   // There are many errors that could prevent a sync cycle from succeeding.
@@ -210,6 +210,7 @@ TEST_F(SyncSessionTest, MoreToSyncIfUnsyncedGreaterThanCommitted) {
   EXPECT_FALSE(session_->HasMoreToSync());
   status()->increment_num_successful_commits();
   EXPECT_TRUE(session_->HasMoreToSync());
+  EXPECT_TRUE(session_->HasMoreToCommit());
 }
 
 TEST_F(SyncSessionTest, MoreToDownloadIfDownloadFailed) {
@@ -262,6 +263,7 @@ TEST_F(SyncSessionTest, MoreToSyncIfConflictsResolved) {
   // that we have made forward progress.
   status()->update_conflicts_resolved(true);
   EXPECT_TRUE(session_->HasMoreToSync());
+  EXPECT_FALSE(session_->HasMoreToCommit());
 }
 
 TEST_F(SyncSessionTest, ResetTransientState) {
@@ -4,6 +4,8 @@
 
 #include "sync/sessions/test_util.h"
 
+#include <vector>
+
 namespace browser_sync {
 namespace sessions {
 namespace test_util {
@@ -14,6 +16,17 @@ void SimulateHasMoreToSync(sessions::SyncSession* session,
   ASSERT_TRUE(session->HasMoreToSync());
 }
 
+void SimulateHasMoreToCommit(sessions::SyncSession* session,
+                             SyncerStep begin, SyncerStep end) {
+  StatusController* status = session->mutable_status_controller();
+  std::vector<int64> unsynced_handles;
+  unsynced_handles.push_back(1);
+  unsynced_handles.push_back(2);
+  status->set_unsynced_handles(unsynced_handles);
+  status->increment_num_successful_commits();
+  ASSERT_TRUE(session->HasMoreToCommit());
+}
+
 void SimulateDownloadUpdatesFailed(sessions::SyncSession* session,
                                    SyncerStep begin, SyncerStep end) {
   session->mutable_status_controller()->set_last_download_updates_result(
@@ -18,6 +18,8 @@ namespace test_util {
 
 void SimulateHasMoreToSync(sessions::SyncSession* session,
                            SyncerStep begin, SyncerStep end);
+void SimulateHasMoreToCommit(sessions::SyncSession* session,
+                             SyncerStep begin, SyncerStep end);
 void SimulateDownloadUpdatesFailed(sessions::SyncSession* session,
                                    SyncerStep begin, SyncerStep end);
 void SimulateCommitFailed(sessions::SyncSession* session,
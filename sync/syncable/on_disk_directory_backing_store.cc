@@ -14,6 +14,10 @@ OnDiskDirectoryBackingStore::OnDiskDirectoryBackingStore(
       backing_filepath_(backing_filepath) {
   db_->set_exclusive_locking();
   db_->set_page_size(4096);
+  // SaveChanges() commits a small transaction every few seconds while sync is
+  // busy. With a write-ahead log each commit appends the changed pages once,
+  // instead of journaling and then rewriting them in place.
+  db_->set_write_ahead_logging();
 }
 
 DirOpenResult OnDiskDirectoryBackingStore::Load(
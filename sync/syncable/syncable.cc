@@ -200,7 +200,7 @@ namespace {
 // before updating the field.
 //
 // This class is parameterized on the Indexer traits type, which
-// must define a Comparator and a static bool ShouldInclude
+// must define a Comparator or GetKey and a static bool ShouldInclude
 // function for testing whether the item ought to be included
 // in the index.
 template<typename Indexer>
@@ -611,25 +611,14 @@ EntryKernel* Directory::GetEntryById(const Id& id,
                                      ScopedKernelLock* const lock) {
   DCHECK(kernel_);
   // Find it in the in memory ID index.
-  kernel_->needle.put(ID, id);
-  IdsIndex::iterator id_found = kernel_->ids_index->find(&kernel_->needle);
-  if (id_found != kernel_->ids_index->end()) {
-    return *id_found;
-  }
-  return NULL;
+  return kernel_->ids_index->Find(id.value());
 }
 
 EntryKernel* Directory::GetEntryByClientTag(const string& tag) {
   ScopedKernelLock lock(this);
   DCHECK(kernel_);
   // Find it in the ClientTagIndex.
-  kernel_->needle.put(UNIQUE_CLIENT_TAG, tag);
-  ClientTagIndex::iterator found = kernel_->client_tag_index->find(
-      &kernel_->needle);
-  if (found != kernel_->client_tag_index->end()) {
-    return *found;
-  }
-  return NULL;
+  return kernel_->client_tag_index->Find(tag);
 }
 
 EntryKernel* Directory::GetEntryByServerTag(const string& tag) {
@@ -1882,10 +1871,8 @@ bool MutableEntry::PutUniqueClientTag(const string& new_tag) {
   ScopedKernelLock lock(dir());
   if (!new_tag.empty()) {
     // Make sure your new value is not in there already.
-    EntryKernel lookup_kernel_ = *kernel_;
-    lookup_kernel_.put(UNIQUE_CLIENT_TAG, new_tag);
     bool new_tag_conflicts =
-        (dir()->kernel_->client_tag_index->count(&lookup_kernel_) > 0);
+        (dir()->kernel_->client_tag_index->Find(new_tag) != NULL);
     if (new_tag_conflicts) {
       return false;
     }
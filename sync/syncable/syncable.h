@@ -21,6 +21,7 @@
 #include "base/compiler_specific.h"
 #include "base/file_path.h"
 #include "base/gtest_prod_util.h"
+#include "base/hash_tables.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
@@ -658,14 +659,16 @@ base::ListValue* EntryKernelMutationMapToValue(
 // The indices follow a common pattern:
 //   (a) The index allows efficient lookup of an Entry* with particular
 //       field values.  This is done by use of a std::set<> and a custom
-//       comparator.
+//       comparator, or, for indices only ever searched by an exact key, a
+//       hash table of the key.
 //   (b) There may be conditions for inclusion in the index -- for example,
 //       deleted items might not be indexed.
 //   (c) Because the index set contains only Entry*, one must be careful
 //       to remove Entries from the set before updating the value of
 //       an indexed field.
-// The traits of an index are a Comparator (to define the set ordering) and a
-// ShouldInclude function (to define the conditions for inclusion).  For each
+// The traits of an index are a Comparator (to define the set ordering) or a
+// GetKey function (to define the hash key), and a ShouldInclude function (to
+// define the conditions for inclusion).  For each
 // index, the traits are grouped into a class called an Indexer which
 // can be used as a template type parameter.
 
@@ -683,7 +686,9 @@ struct MetahandleIndexer {
 // Traits type for ID field index.
 struct IdIndexer {
   // This index is of the ID field values.
-  typedef LessField<IdField, ID> Comparator;
+  inline static const std::string& GetKey(const EntryKernel* a) {
+    return a->ref(ID).value();
+  }
 
   // This index includes all entries.
   inline static bool ShouldInclude(const EntryKernel* a) {
@@ -694,7 +699,9 @@ struct IdIndexer {
 // Traits type for unique client tag index.
 struct ClientTagIndexer {
   // This index is of the client-tag values.
-  typedef LessField<StringField, UNIQUE_CLIENT_TAG> Comparator;
+  inline static const std::string& GetKey(const EntryKernel* a) {
+    return a->ref(UNIQUE_CLIENT_TAG);
+  }
 
   // Items are only in this index if they have a non-empty client tag value.
   static bool ShouldInclude(const EntryKernel* a);
@@ -722,6 +729,46 @@ struct Index {
   typedef std::set<EntryKernel*, typename Indexer::Comparator> Set;
 };
 
+// The set type of an index that is looked up by key and never walked in
+// order.  It has the parts of the std::set interface used to maintain the
+// indices, plus Find() for lookups.
+template <typename Indexer>
+class HashIndex {
+ public:
+  typedef base::hash_map<std::string, EntryKernel*> Map;
+  typedef typename Map::iterator iterator;
+
+  std::pair<iterator, bool> insert(EntryKernel* entry) {
+    return map_.insert(std::make_pair(Indexer::GetKey(entry), entry));
+  }
+  size_t erase(const EntryKernel* entry) {
+    return map_.erase(Indexer::GetKey(entry));
+  }
+  size_t count(const EntryKernel* entry) const {
+    return map_.count(Indexer::GetKey(entry));
+  }
+  size_t size() const { return map_.size(); }
+
+  // Returns the entry indexed under |key|, or NULL if there is none.
+  EntryKernel* Find(const std::string& key) const {
+    typename Map::const_iterator found = map_.find(key);
+    return found == map_.end() ? NULL : found->second;
+  }
+
+ private:
+  Map map_;
+};
+
+template <>
+struct Index<IdIndexer> {
+  typedef HashIndex<IdIndexer> Set;
+};
+
+template <>
+struct Index<ClientTagIndexer> {
+  typedef HashIndex<ClientTagIndexer> Set;
+};
+
 // The name Directory in this case means the entire directory
 // structure within a single user account.
 //
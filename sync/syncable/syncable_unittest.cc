@@ -1042,6 +1042,26 @@ TEST_F(SyncableDirectoryTest, TestParentIdIndexUpdate) {
   EXPECT_EQ(1, CountEntriesWithName(&wt, parent_folder2.Get(ID), child_name));
 }
 
+TEST_F(SyncableDirectoryTest, TestIdIndexUpdate) {
+  WriteTransaction wt(FROM_HERE, UNITTEST, dir_.get());
+  MutableEntry entry(&wt, CREATE, wt.root_id(), "entry");
+  ASSERT_TRUE(entry.good());
+  const Id old_id = entry.Get(ID);
+  const Id new_id = TestIdFactory::FromNumber(1234);
+
+  ASSERT_TRUE(entry.Put(ID, new_id));
+  Entry by_old_id(&wt, GET_BY_ID, old_id);
+  EXPECT_FALSE(by_old_id.good());
+  Entry by_new_id(&wt, GET_BY_ID, new_id);
+  ASSERT_TRUE(by_new_id.good());
+  EXPECT_EQ(entry.Get(META_HANDLE), by_new_id.Get(META_HANDLE));
+
+  // Another entry can't take an ID that is already in use.
+  MutableEntry other(&wt, CREATE, wt.root_id(), "other");
+  ASSERT_TRUE(other.good());
+  EXPECT_FALSE(other.Put(ID, new_id));
+}
+
 TEST_F(SyncableDirectoryTest, TestNoReindexDeletedItems) {
   std::string folder_name = "folder";
   std::string new_name = "new_name";
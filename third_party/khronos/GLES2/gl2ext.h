@@ -1982,6 +1982,24 @@ typedef void (GL_APIENTRYP PFNGLCOPYTEXTURECHROMIUM) (GLenum target, GLenum sour
 #define GL_COMMANDS_ISSUED_CHROMIUM 0x84F2
 #endif
 
+/* GL_CHROMIUM_async_pixel_transfers */
+/* Exposes GL_CHROMIUM_async_pixel_transfers.
+ */
+#ifndef GL_CHROMIUM_async_pixel_transfers
+#define GL_CHROMIUM_async_pixel_transfers 1
+#define GL_UNPACK_ASYNC_CHROMIUM 0x9244
+#define GL_ASYNC_PIXEL_TRANSFERS_COMPLETED_CHROMIUM 0x84F5
+#endif
+
+/* GL_CHROMIUM_texture_residency_priority */
+/* Exposes GL_CHROMIUM_texture_residency_priority.
+ */
+#ifndef GL_CHROMIUM_texture_residency_priority
+#define GL_CHROMIUM_texture_residency_priority 1
+
+#define GL_TEXTURE_RESIDENCY_PRIORITY_CHROMIUM 0x6000
+#endif
+
 /* GL_CHROMIUM_texture_mailbox */
 #ifndef GL_CHROMIUM_texture_mailbox
 #define GL_CHROMIUM_texture_mailbox 1
@@ -4,6 +4,7 @@
 
 #include "ui/base/resource/resource_bundle.h"
 
+#include <set>
 #include <vector>
 
 #include "base/command_line.h"
@@ -242,10 +243,18 @@ gfx::Image& ResourceBundle::GetImageNamed(int resource_id) {
 
   DCHECK(!data_packs_.empty()) << "Missing call to SetResourcesDataDLL?";
   ScopedVector<const SkBitmap> bitmaps;
+  std::set<float> loaded_scale_factors;
   for (size_t i = 0; i < data_packs_.size(); ++i) {
+    // Only the first bitmap of each scale factor is ever drawn, so don't
+    // decode the ones later packs would add for the same scale.
+    float scale_factor = data_packs_[i]->GetScaleFactor();
+    if (loaded_scale_factors.count(scale_factor))
+      continue;
     SkBitmap* bitmap = LoadBitmap(*data_packs_[i], resource_id);
-    if (bitmap)
+    if (bitmap) {
       bitmaps.push_back(bitmap);
+      loaded_scale_factors.insert(scale_factor);
+    }
   }
 
   if (bitmaps.empty()) {
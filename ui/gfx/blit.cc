@@ -169,33 +169,44 @@ void ScrollCanvas(SkCanvas* canvas,
   gfx::Rect src_rect = dest_rect;
   src_rect.Offset(-amount.x(), -amount.y());
 
-  size_t row_bytes = dest_rect.width() * 4;
-  if (amount.y() > 0) {
-    // Data is moving down, copy from the bottom up.
-    for (int y = dest_rect.height() - 1; y >= 0; y--) {
-      memcpy(bitmap.getAddr32(dest_rect.x(), dest_rect.y() + y),
-             bitmap.getAddr32(src_rect.x(), src_rect.y() + y),
-             row_bytes);
-    }
-  } else if (amount.y() < 0) {
-    // Data is moving up, copy from the top down.
-    for (int y = 0; y < dest_rect.height(); y++) {
-      memcpy(bitmap.getAddr32(dest_rect.x(), dest_rect.y() + y),
-             bitmap.getAddr32(src_rect.x(), src_rect.y() + y),
-             row_bytes);
-    }
-  } else if (amount.x() != 0) {
-    // Horizontal-only scroll. We can do it in either top-to-bottom or bottom-
-    // to-top, but have to be careful about the order for copying each row.
-    // Fortunately, memmove already handles this for us.
-    for (int y = 0; y < dest_rect.height(); y++) {
-      memmove(bitmap.getAddr32(dest_rect.x(), dest_rect.y() + y),
-              bitmap.getAddr32(src_rect.x(), src_rect.y() + y),
-              row_bytes);
-    }
-  }
+  if (amount.x() == 0 && amount.y() == 0)
+    return;
+  MovePixelRows(bitmap.getAddr32(dest_rect.x(), dest_rect.y()),
+                bitmap.rowBytes(),
+                bitmap.getAddr32(src_rect.x(), src_rect.y()),
+                bitmap.rowBytes(),
+                dest_rect.width() * 4,
+                dest_rect.height());
+  bitmap.notifyPixelsChanged();
 }
 
 #endif
 
+void MovePixelRows(void* dst,
+                   size_t dst_stride,
+                   const void* src,
+                   size_t src_stride,
+                   size_t row_bytes,
+                   int rows) {
+  if (rows <= 0)
+    return;
+
+  uint8* dst_row = static_cast<uint8*>(dst);
+  const uint8* src_row = static_cast<const uint8*>(src);
+  if (row_bytes == dst_stride && row_bytes == src_stride) {
+    memmove(dst_row, src_row, row_bytes * rows);
+    return;
+  }
+
+  if (dst_row > src_row) {
+    // Data is moving down, copy from the bottom up so that rows that
+    // overlap are read before they are written.
+    for (int y = rows - 1; y >= 0; y--)
+      memmove(dst_row + y * dst_stride, src_row + y * src_stride, row_bytes);
+  } else {
+    for (int y = 0; y < rows; y++)
+      memmove(dst_row + y * dst_stride, src_row + y * src_stride, row_bytes);
+  }
+}
+
 }  // namespace gfx
@@ -6,6 +6,8 @@
 #define UI_GFX_BLIT_H_
 #pragma once
 
+#include <stddef.h>
+
 #include "ui/gfx/native_widget_types.h"
 #include "ui/base/ui_export.h"
 
@@ -47,6 +49,18 @@ UI_EXPORT void ScrollCanvas(SkCanvas* canvas,
                             const Rect& clip,
                             const Point& amount);
 
+// Copies |rows| rows of |row_bytes| bytes from |src| to |dst|, where the
+// rows start |src_stride| and |dst_stride| bytes apart. The two may overlap.
+// Rows that are contiguous in both, as when a whole bitmap width is copied,
+// are moved with one memmove, which the C library does with the widest
+// copies the CPU has; other rows are moved one at a time.
+UI_EXPORT void MovePixelRows(void* dst,
+                             size_t dst_stride,
+                             const void* src,
+                             size_t src_stride,
+                             size_t row_bytes,
+                             int rows);
+
 }  // namespace gfx
 
 #endif  // UI_GFX_BLIT_H_
@@ -135,6 +135,58 @@ TEST(Blit, ScrollCanvas) {
   VerifyCanvasValues<5, 5>(&canvas, scroll_diagonal_expected);
 }
 
+// Scrolls that span the whole width move all their rows at once.
+TEST(Blit, ScrollCanvasFullWidth) {
+  static const int kCanvasWidth = 5;
+  static const int kCanvasHeight = 5;
+  skia::PlatformCanvas canvas(kCanvasWidth, kCanvasHeight, true);
+  uint8 initial_values[kCanvasHeight][kCanvasWidth] = {
+      { 0x00, 0x01, 0x02, 0x03, 0x04 },
+      { 0x10, 0x11, 0x12, 0x13, 0x14 },
+      { 0x20, 0x21, 0x22, 0x23, 0x24 },
+      { 0x30, 0x31, 0x32, 0x33, 0x34 },
+      { 0x40, 0x41, 0x42, 0x43, 0x44 }};
+  SetToCanvas<5, 5>(&canvas, initial_values);
+
+  gfx::Rect all(0, 0, kCanvasWidth, kCanvasHeight);
+  gfx::ScrollCanvas(&canvas, all, gfx::Point(0, 2));
+  uint8 scroll_down_expected[kCanvasHeight][kCanvasWidth] = {
+      { 0x00, 0x01, 0x02, 0x03, 0x04 },
+      { 0x10, 0x11, 0x12, 0x13, 0x14 },
+      { 0x00, 0x01, 0x02, 0x03, 0x04 },
+      { 0x10, 0x11, 0x12, 0x13, 0x14 },
+      { 0x20, 0x21, 0x22, 0x23, 0x24 }};
+  VerifyCanvasValues<5, 5>(&canvas, scroll_down_expected);
+
+  SetToCanvas<5, 5>(&canvas, initial_values);
+  gfx::ScrollCanvas(&canvas, all, gfx::Point(0, -2));
+  uint8 scroll_up_expected[kCanvasHeight][kCanvasWidth] = {
+      { 0x20, 0x21, 0x22, 0x23, 0x24 },
+      { 0x30, 0x31, 0x32, 0x33, 0x34 },
+      { 0x40, 0x41, 0x42, 0x43, 0x44 },
+      { 0x30, 0x31, 0x32, 0x33, 0x34 },
+      { 0x40, 0x41, 0x42, 0x43, 0x44 }};
+  VerifyCanvasValues<5, 5>(&canvas, scroll_up_expected);
+}
+
+TEST(Blit, MovePixelRows) {
+  // Two 2-byte rows out of a buffer with 4-byte strides, into one with
+  // 3-byte strides.
+  const uint8 src[] = { 1, 2, 0, 0, 3, 4, 0, 0 };
+  uint8 dst[6] = { 0 };
+  gfx::MovePixelRows(dst, 3, src, 4, 2, 2);
+  const uint8 expected[] = { 1, 2, 0, 3, 4, 0 };
+  for (size_t i = 0; i < arraysize(expected); ++i)
+    EXPECT_EQ(expected[i], dst[i]) << i;
+
+  // Overlapping rows moving down are read before they are overwritten.
+  uint8 buffer[] = { 1, 2, 0, 3, 4, 0, 5, 6, 0 };
+  gfx::MovePixelRows(buffer + 3, 3, buffer, 3, 2, 2);
+  const uint8 moved[] = { 1, 2, 0, 1, 2, 0, 3, 4, 0 };
+  for (size_t i = 0; i < arraysize(moved); ++i)
+    EXPECT_EQ(moved[i], buffer[i]) << i;
+}
+
 #if defined(OS_WIN)
 
 TEST(Blit, WithSharedMemory) {
@@ -7,6 +7,7 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/string_util.h"
+#include "build/build_config.h"
 #include "ui/gfx/size.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkUnPreMultiply.h"
@@ -33,6 +34,19 @@ namespace {
 // Converts BGRA->RGBA and RGBA->BGRA.
 void ConvertBetweenBGRAandRGBA(const unsigned char* input, int pixel_width,
                                unsigned char* output, bool* is_opaque) {
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+  // Swap the first and third bytes working on whole pixels, which makes
+  // a loop the compiler can vectorize. The rows need not be aligned, so the
+  // pixels are copied rather than accessed through a uint32 pointer.
+  for (int x = 0; x < pixel_width; x++) {
+    uint32 pixel;
+    memcpy(&pixel, &input[x * 4], sizeof(pixel));
+    pixel = (pixel & 0xFF00FF00) |
+            ((pixel >> 16) & 0xFF) |
+            ((pixel & 0xFF) << 16);
+    memcpy(&output[x * 4], &pixel, sizeof(pixel));
+  }
+#else
   for (int x = 0; x < pixel_width; x++) {
     const unsigned char* pixel_in = &input[x * 4];
     unsigned char* pixel_out = &output[x * 4];
@@ -41,6 +55,7 @@ void ConvertBetweenBGRAandRGBA(const unsigned char* input, int pixel_width,
     pixel_out[2] = pixel_in[0];
     pixel_out[3] = pixel_in[3];
   }
+#endif
 }
 
 void ConvertRGBAtoRGB(const unsigned char* rgba, int pixel_width,
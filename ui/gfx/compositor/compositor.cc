@@ -4,7 +4,9 @@
 
 #include "ui/gfx/compositor/compositor.h"
 
+#include "base/bind.h"
 #include "base/command_line.h"
+#include "base/message_loop.h"
 #include "base/threading/thread_restrictions.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/WebCompositor.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebFloatPoint.h"
@@ -126,7 +128,9 @@ Compositor::Compositor(CompositorDelegate* delegate,
       root_layer_(NULL),
       widget_(widget),
       root_web_layer_(WebKit::WebLayer::create()),
-      swap_posted_(false) {
+      swap_posted_(false),
+      commit_scheduled_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
   WebKit::WebLayerTreeView::Settings settings;
   CommandLine* command_line = CommandLine::ForCurrentProcess();
   settings.showFPSCounter =
@@ -172,10 +176,13 @@ void Compositor::Terminate() {
 
 void Compositor::ScheduleDraw() {
   if (g_compositor_thread) {
-    // TODO(nduca): Temporary while compositor calls
-    // compositeImmediately() directly.
-    layout();
-    host_.composite();
+    if (commit_scheduled_)
+      return;
+    commit_scheduled_ = true;
+    MessageLoop::current()->PostTask(
+        FROM_HERE,
+        base::Bind(&Compositor::CommitAndComposite,
+                   weak_factory_.GetWeakPtr()));
   } else {
     delegate_->ScheduleDraw();
   }
@@ -330,6 +337,14 @@ void Compositor::SwizzleRGBAToBGRAAndFlip(unsigned char* pixels,
   }
 }
 
+void Compositor::CommitAndComposite() {
+  commit_scheduled_ = false;
+  // TODO(nduca): Temporary while compositor calls
+  // compositeImmediately() directly.
+  layout();
+  host_.composite();
+}
+
 void Compositor::NotifyEnd() {
   FOR_EACH_OBSERVER(CompositorObserver,
                     observer_list_,
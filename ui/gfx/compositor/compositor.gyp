@@ -50,6 +50,8 @@
         'scoped_layer_animation_settings.h',
         'screen_rotation.cc',
         'screen_rotation.h',
+        'tiled_rasterizer.cc',
+        'tiled_rasterizer.h',
         # UI tests need TestWebGraphicsContext3D, so we always build it.
         'test_web_graphics_context_3d.cc',
         'test_web_graphics_context_3d.h',
@@ -109,6 +111,7 @@
         'layer_animator_unittest.cc',
         'layer_unittest.cc',
         'run_all_unittests.cc',
+        'tiled_rasterizer_unittest.cc',
         'test/test_compositor_host.h',
         'test/test_compositor_host_linux.cc',
         'test/test_compositor_host_mac.mm',
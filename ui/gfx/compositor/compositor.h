@@ -8,6 +8,7 @@
 
 #include "base/hash_tables.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebLayer.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebLayerTreeView.h"
@@ -221,6 +222,12 @@ class COMPOSITOR_EXPORT Compositor
   // Notifies the compositor that compositing is complete.
   void NotifyEnd();
 
+  // Commits the layer tree to the compositor thread and composites it. Runs
+  // once for all the draws scheduled by a task, so that the layer changes a
+  // task makes, such as one step of each running animation, are committed
+  // together.
+  void CommitAndComposite();
+
   CompositorDelegate* delegate_;
   gfx::Size size_;
 
@@ -237,6 +244,11 @@ class COMPOSITOR_EXPORT Compositor
   // for completion.
   bool swap_posted_;
 
+  // Whether a CommitAndComposite() task is pending.
+  bool commit_scheduled_;
+
+  base::WeakPtrFactory<Compositor> weak_factory_;
+
   friend class base::RefCounted<Compositor>;
 };
 
@@ -23,4 +23,7 @@ const char kUIShowLayerTree[] = "ui-show-layer-tree";
 
 const char kUIEnablePerTilePainting[] = "ui-enable-per-tile-painting";
 
+// Record large layer paints and rasterize them in tiles on several threads.
+const char kUIEnableParallelPainting[] = "ui-enable-parallel-painting";
+
 }  // namespace switches
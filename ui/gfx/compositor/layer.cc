@@ -18,10 +18,13 @@
 #include "third_party/WebKit/Source/Platform/chromium/public/WebFloatRect.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebSize.h"
 #include "third_party/WebKit/Source/Platform/chromium/public/WebSolidColorLayer.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkPicture.h"
 #include "ui/base/animation/animation.h"
 #include "ui/gfx/canvas.h"
 #include "ui/gfx/compositor/compositor_switches.h"
 #include "ui/gfx/compositor/layer_animator.h"
+#include "ui/gfx/compositor/tiled_rasterizer.h"
 #include "ui/gfx/interpolated_transform.h"
 #include "ui/gfx/point3.h"
 
@@ -29,6 +32,10 @@ namespace {
 
 const float EPSILON = 1e-3f;
 
+// Paints smaller than this many pixels are not worth splitting into tiles.
+const int kMinParallelPaintArea =
+    4 * ui::TiledRasterizer::kTileSize * ui::TiledRasterizer::kTileSize;
+
 bool IsApproximateMultipleOf(float value, float base) {
   float remainder = fmod(fabs(value), base);
   return remainder < EPSILON || base - remainder < EPSILON;
@@ -38,6 +45,22 @@ const ui::Layer* GetRoot(const ui::Layer* layer) {
   return layer->parent() ? GetRoot(layer->parent()) : layer;
 }
 
+// Returns true if |transform| only translates by whole pixels.
+bool IsIntegralTranslation(const ui::Transform& transform) {
+  const SkMatrix44& matrix = transform.matrix();
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 4; ++col) {
+      if (col == 3 && row < 3) {
+        if (!IsApproximateMultipleOf(matrix.get(row, col), 1.0f))
+          return false;
+      } else if (matrix.get(row, col) != (row == col ? 1 : 0)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 namespace ui {
@@ -313,9 +336,46 @@ void Layer::ScheduleDraw() {
 }
 
 void Layer::SendDamagedRects() {
+  SkRegion occlusion;
+  SendDamagedRectsWithOcclusion(
+      gfx::Point(), gfx::Rect(bounds_.size()), true, &occlusion);
+}
+
+void Layer::SendDamagedRectsWithOcclusion(const gfx::Point& offset,
+                                          const gfx::Rect& clip,
+                                          bool track_occlusion,
+                                          SkRegion* occlusion) {
+  // Hidden layers neither draw nor cover anything, and neither do their
+  // children.
+  track_occlusion = track_occlusion && visible_;
+
+  gfx::Rect children_clip = clip;
+  if (GetMasksToBounds())
+    children_clip = clip.Intersect(gfx::Rect(offset, bounds_.size()));
+  for (size_t i = children_.size(); i > 0; --i) {
+    Layer* child = children_[i - 1];
+    gfx::Point child_offset = offset.Add(child->bounds_.origin());
+    bool track_child_occlusion =
+        track_occlusion && IsIntegralTranslation(child->transform_);
+    if (track_child_occlusion) {
+      child_offset.Offset(
+          static_cast<int>(floor(child->transform_.matrix().get(0, 3) + 0.5)),
+          static_cast<int>(floor(child->transform_.matrix().get(1, 3) + 0.5)));
+    }
+    child->SendDamagedRectsWithOcclusion(
+        child_offset, children_clip, track_child_occlusion, occlusion);
+  }
+
   if (delegate_ && !damaged_region_.isEmpty()) {
-    for (SkRegion::Iterator iter(damaged_region_);
-         !iter.done(); iter.next()) {
+    SkRegion damage(damaged_region_);
+    damaged_region_.setEmpty();
+    if (track_occlusion && !occlusion->isEmpty()) {
+      SkRegion occluded(*occlusion);
+      occluded.translate(-offset.x(), -offset.y());
+      damaged_region_.op(damage, occluded, SkRegion::kIntersect_Op);
+      damage.op(occluded, SkRegion::kDifference_Op);
+    }
+    for (SkRegion::Iterator iter(damage); !iter.done(); iter.next()) {
       const SkIRect& damaged = iter.rect();
       WebKit::WebFloatRect web_rect(
           damaged.x(),
@@ -328,10 +388,14 @@ void Layer::SendDamagedRects() {
         web_layer_.to<WebKit::WebExternalTextureLayer>().invalidateRect(
             web_rect);
     }
-    damaged_region_.setEmpty();
   }
-  for (size_t i = 0; i < children_.size(); ++i)
-    children_[i]->SendDamagedRects();
+
+  if (track_occlusion && type_ != LAYER_NOT_DRAWN && fills_bounds_opaquely_ &&
+      GetCombinedOpacity() == 1.0f) {
+    gfx::Rect covered = clip.Intersect(gfx::Rect(offset, bounds_.size()));
+    occlusion->op(covered.x(), covered.y(), covered.right(), covered.bottom(),
+                  SkRegion::kUnion_Op);
+  }
 }
 
 void Layer::SuppressPaint() {
@@ -345,9 +409,33 @@ void Layer::SuppressPaint() {
 void Layer::paintContents(WebKit::WebCanvas* web_canvas,
                           const WebKit::WebRect& clip) {
   TRACE_EVENT0("ui", "Layer::paintContents");
+  if (!delegate_)
+    return;
+  gfx::Rect clip_rect(clip.x, clip.y, clip.width, clip.height);
+  if (paint_in_parallel_ &&
+      clip_rect.width() * clip_rect.height() >= kMinParallelPaintArea) {
+    // Record the painting, then play it back a tile per core.
+    SkPicture picture;
+    {
+      gfx::Canvas recording_canvas(picture.beginRecording(bounds_.width(),
+                                                          bounds_.height()));
+      recording_canvas.ClipRect(clip_rect);
+      delegate_->OnPaintLayer(&recording_canvas);
+      picture.endRecording();
+    }
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config,
+                     clip_rect.width(), clip_rect.height());
+    if (bitmap.allocPixels()) {
+      bitmap.eraseARGB(0, 0, 0, 0);
+      TiledRasterizer::Rasterize(&picture, clip_rect, &bitmap);
+      web_canvas->drawBitmap(bitmap, SkIntToScalar(clip_rect.x()),
+                             SkIntToScalar(clip_rect.y()));
+      return;
+    }
+  }
   gfx::Canvas canvas(web_canvas);
-  if (delegate_)
-    delegate_->OnPaintLayer(&canvas);
+  delegate_->OnPaintLayer(&canvas);
 }
 
 float Layer::GetCombinedOpacity() const {
@@ -505,6 +593,8 @@ void Layer::CreateWebLayer() {
   show_debug_borders_ = CommandLine::ForCurrentProcess()->HasSwitch(
       switches::kUIShowLayerBorders);
   web_layer_.setDebugBorderWidth(show_debug_borders_ ? 2 : 0);
+  paint_in_parallel_ = CommandLine::ForCurrentProcess()->HasSwitch(
+      switches::kUIEnableParallelPainting);
   RecomputeDrawsContentAndUVRect();
   RecomputeDebugBorderColor();
 }
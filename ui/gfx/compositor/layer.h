@@ -186,7 +186,9 @@ class COMPOSITOR_EXPORT Layer :
   void ScheduleDraw();
 
   // Sends damaged rectangles recorded in |damaged_region_| to
-  // |compostior_| to repaint the content.
+  // |compostior_| to repaint the content. Damage covered by opaque layers
+  // stacked above is kept until it is uncovered, so that covered layers are
+  // not repainted.
   void SendDamagedRects();
 
   // Suppresses painting the content by disgarding damaged region and ignoring
@@ -225,6 +227,18 @@ class COMPOSITOR_EXPORT Layer :
   bool GetTransformRelativeTo(const Layer* ancestor,
                               Transform* transform) const;
 
+  // Sends the damage of this layer and its descendants that |occlusion| does
+  // not cover, topmost layer first, and adds the bounds of the opaque ones to
+  // |occlusion|. |offset| is the origin of this layer and |clip| the clip of
+  // its ancestors, both in the coordinates of the layer SendDamagedRects()
+  // was called on. |track_occlusion| is false under a transform that is not
+  // an integral translation, as the layers there can't be compared with
+  // |occlusion|.
+  void SendDamagedRectsWithOcclusion(const gfx::Point& offset,
+                                     const gfx::Rect& clip,
+                                     bool track_occlusion,
+                                     SkRegion* occlusion);
+
   // The only externally updated layers are ones that get their pixels from
   // WebKit and WebKit does not produce valid alpha values. All other layers
   // should have valid alpha.
@@ -293,6 +307,9 @@ class COMPOSITOR_EXPORT Layer :
   bool web_layer_is_accelerated_;
   bool show_debug_borders_;
 
+  // Whether large paints are recorded and rasterized in tiles in parallel.
+  bool paint_in_parallel_;
+
   DISALLOW_COPY_AND_ASSIGN(Layer);
 };
 
@@ -1021,4 +1021,33 @@ TEST_F(LayerWithDelegateTest, SchedulePaintFromOnPaintLayer) {
                   gfx::Rect(10, 10, 30, 30)));
 }
 
+// Verifies that damage under an opaque layer is only painted once that layer
+// stops covering it.
+TEST_F(LayerWithDelegateTest, OccludedDamageWaitsUntilUncovered) {
+  scoped_ptr<Layer> root(CreateColorLayer(SK_ColorRED,
+                                          gfx::Rect(0, 0, 500, 500)));
+  SchedulePaintLayerDelegate bottom_delegate;
+  scoped_ptr<Layer> bottom(CreateColorLayer(SK_ColorBLUE,
+                                            gfx::Rect(0, 0, 200, 200)));
+  bottom_delegate.set_layer(bottom.get());
+  scoped_ptr<Layer> top(CreateColorLayer(SK_ColorGREEN,
+                                         gfx::Rect(0, 0, 300, 300)));
+  root->Add(bottom.get());
+  root->Add(top.get());
+
+  SchedulePaintForLayer(root.get());
+  DrawTree(root.get());
+  bottom_delegate.GetPaintCountAndClear();
+
+  bottom->SchedulePaint(gfx::Rect(0, 0, 20, 20));
+  Draw();
+  EXPECT_EQ(0, bottom_delegate.GetPaintCountAndClear());
+
+  top->SetVisible(false);
+  Draw();
+  EXPECT_EQ(1, bottom_delegate.GetPaintCountAndClear());
+  EXPECT_TRUE(bottom_delegate.last_clip_rect().Contains(
+                  gfx::Rect(0, 0, 20, 20)));
+}
+
 } // namespace ui
@@ -0,0 +1,97 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/compositor/tiled_rasterizer.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/debug/trace_event.h"
+#include "base/logging.h"
+#include "base/memory/scoped_vector.h"
+#include "base/threading/parallel_work.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "ui/gfx/rect.h"
+
+namespace ui {
+
+namespace {
+
+// The state shared by the threads rasterizing one bitmap.
+struct RasterJob {
+  RasterJob(const gfx::Rect& rect, SkBitmap* bitmap)
+      : rect(rect),
+        bitmap(bitmap) {
+  }
+
+  const gfx::Rect rect;
+  SkBitmap* const bitmap;
+  std::vector<gfx::Rect> tiles;
+  // SkPicture playback is not thread-safe, so each thread plays back its own
+  // copy of the picture.
+  std::vector<SkPicture*> pictures;
+};
+
+void RasterizeTile(const RasterJob* job, int piece, int thread) {
+  const gfx::Rect& tile = job->tiles[piece];
+  SkBitmap tile_bitmap;
+  if (!job->bitmap->extractSubset(&tile_bitmap,
+                                  SkIRect::MakeXYWH(tile.x() - job->rect.x(),
+                                                    tile.y() - job->rect.y(),
+                                                    tile.width(),
+                                                    tile.height()))) {
+    NOTREACHED();
+    return;
+  }
+  SkCanvas canvas(tile_bitmap);
+  canvas.translate(SkIntToScalar(-tile.x()), SkIntToScalar(-tile.y()));
+  canvas.drawPicture(*job->pictures[thread]);
+}
+
+}  // namespace
+
+// GCC requires these declarations, but MSVC requires they not be present
+#ifndef _MSC_VER
+const int TiledRasterizer::kTileSize;
+#endif
+
+// static
+void TiledRasterizer::Rasterize(SkPicture* picture,
+                                const gfx::Rect& rect,
+                                SkBitmap* bitmap) {
+  TRACE_EVENT2("ui", "TiledRasterizer::Rasterize",
+               "width", rect.width(), "height", rect.height());
+  DCHECK_EQ(rect.width(), bitmap->width());
+  DCHECK_EQ(rect.height(), bitmap->height());
+
+  RasterJob job(rect, bitmap);
+  for (int y = rect.y(); y < rect.bottom(); y += kTileSize) {
+    for (int x = rect.x(); x < rect.right(); x += kTileSize) {
+      job.tiles.push_back(gfx::Rect(x, y,
+                                    std::min(kTileSize, rect.right() - x),
+                                    std::min(kTileSize, rect.bottom() - y)));
+    }
+  }
+
+  int tile_count = static_cast<int>(job.tiles.size());
+  int thread_count = base::ParallelWork::ThreadCount(tile_count);
+  ScopedVector<SkPicture> picture_copies;
+  job.pictures.push_back(picture);
+  for (int i = 1; i < thread_count; ++i) {
+    picture_copies.push_back(new SkPicture(*picture));
+    job.pictures.push_back(picture_copies.back());
+  }
+
+  // This is usually called on the UI thread. It rasterizes tiles itself, and
+  // then waits only for the tiles workers have already started, so it is
+  // blocked for no longer than it would take to rasterize those itself.
+  base::ParallelWork::Run(FROM_HERE, tile_count, thread_count,
+                          base::Bind(&RasterizeTile, base::Unretained(&job)),
+                          false);
+}
+
+}  // namespace ui
@@ -0,0 +1,45 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UI_GFX_COMPOSITOR_TILED_RASTERIZER_H_
+#define UI_GFX_COMPOSITOR_TILED_RASTERIZER_H_
+#pragma once
+
+#include "base/basictypes.h"
+#include "ui/gfx/compositor/compositor_export.h"
+
+class SkBitmap;
+class SkPicture;
+
+namespace gfx {
+class Rect;
+}
+
+namespace ui {
+
+// Plays back an SkPicture, such as one recorded by painting a gfx::Canvas
+// created on SkPicture::beginRecording(), into a bitmap. The bitmap is split
+// into tiles that are rasterized in parallel by the calling thread and the
+// worker pool with base::ParallelWork, so that large invalidations use more
+// than one core.
+class COMPOSITOR_EXPORT TiledRasterizer {
+ public:
+  // The width and height of the tiles.
+  static const int kTileSize = 256;
+
+  // Rasterizes the part of |picture| in |rect| into |bitmap|, which must be
+  // allocated with the size of |rect|. Returns once every tile is done. The
+  // calling thread rasterizes tiles until none are left, then waits for the
+  // ones workers are still rasterizing.
+  static void Rasterize(SkPicture* picture,
+                        const gfx::Rect& rect,
+                        SkBitmap* bitmap);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(TiledRasterizer);
+};
+
+}  // namespace ui
+
+#endif  // UI_GFX_COMPOSITOR_TILED_RASTERIZER_H_
@@ -0,0 +1,65 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ui/gfx/compositor/tiled_rasterizer.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "ui/gfx/canvas.h"
+#include "ui/gfx/rect.h"
+
+namespace ui {
+
+namespace {
+
+void AllocateBitmap(const gfx::Size& size, SkBitmap* bitmap) {
+  bitmap->setConfig(SkBitmap::kARGB_8888_Config, size.width(), size.height());
+  ASSERT_TRUE(bitmap->allocPixels());
+  bitmap->eraseARGB(0, 0, 0, 0);
+}
+
+}  // namespace
+
+// Rasterizing in tiles gives the same pixels as drawing the picture at once,
+// including for the partial tiles at the right and bottom edges.
+TEST(TiledRasterizerTest, MatchesDirectDraw) {
+  const int kTileSize = TiledRasterizer::kTileSize;
+  SkPicture picture;
+  {
+    gfx::Canvas canvas(picture.beginRecording(4 * kTileSize, 3 * kTileSize));
+    canvas.FillRect(gfx::Rect(0, 0, 4 * kTileSize, 3 * kTileSize),
+                    SK_ColorWHITE);
+    canvas.FillRect(gfx::Rect(kTileSize - 10, 20, 300, 2 * kTileSize),
+                    SK_ColorRED);
+    canvas.FillRect(gfx::Rect(3, kTileSize + 5, 3 * kTileSize, 7),
+                    SK_ColorBLUE);
+    picture.endRecording();
+  }
+
+  gfx::Rect rect(10, 20, 2 * kTileSize + 90, kTileSize + 40);
+  SkBitmap expected;
+  AllocateBitmap(rect.size(), &expected);
+  {
+    SkCanvas canvas(expected);
+    canvas.translate(SkIntToScalar(-rect.x()), SkIntToScalar(-rect.y()));
+    canvas.drawPicture(picture);
+  }
+
+  SkBitmap tiled;
+  AllocateBitmap(rect.size(), &tiled);
+  TiledRasterizer::Rasterize(&picture, rect, &tiled);
+
+  SkAutoLockPixels expected_lock(expected);
+  SkAutoLockPixels tiled_lock(tiled);
+  for (int y = 0; y < rect.height(); ++y) {
+    for (int x = 0; x < rect.width(); ++x) {
+      ASSERT_EQ(*expected.getAddr32(x, y), *tiled.getAddr32(x, y))
+          << "at " << x << "," << y;
+    }
+  }
+}
+
+}  // namespace ui
@@ -336,6 +336,10 @@ RenderText::~RenderText() {
 
 void RenderText::SetText(const string16& text) {
   DCHECK(!composition_range_.IsValid());
+  // Views often set the text they already show. The layout depends only on
+  // the text, the styles, the font and the width, so it's kept in that case
+  // rather than shaped again.
+  bool text_changed = text != text_;
   size_t old_text_length = text_.length();
   text_ = text;
 
@@ -369,7 +373,8 @@ void RenderText::SetText(const string16& text) {
   // or SetCursorPosition in upper layer.
   SetSelectionModel(SelectionModel());
 
-  ResetLayout();
+  if (text_changed)
+    ResetLayout();
 }
 
 void RenderText::SetHorizontalAlignment(HorizontalAlignment alignment) {
@@ -921,6 +921,21 @@ TEST_F(RenderTextTest, StringSizeSanity) {
   EXPECT_GT(string_size.height(), 0);
 }
 
+TEST_F(RenderTextTest, SetSameText) {
+  scoped_ptr<RenderText> render_text(RenderText::CreateRenderText());
+  render_text->SetText(ASCIIToUTF16("Hello World"));
+  const Size string_size = render_text->GetStringSize();
+  render_text->SetCursorPosition(5);
+
+  // Setting the same text keeps the layout but still resets the selection.
+  render_text->SetText(ASCIIToUTF16("Hello World"));
+  EXPECT_EQ(0U, render_text->cursor_position());
+  EXPECT_EQ(string_size, render_text->GetStringSize());
+
+  render_text->SetText(ASCIIToUTF16("Hello"));
+  EXPECT_LT(render_text->GetStringSize().width(), string_size.width());
+}
+
 TEST_F(RenderTextTest, StringSizeEmptyString) {
   const Font font;
   scoped_ptr<RenderText> render_text(RenderText::CreateRenderText());
@@ -390,13 +390,22 @@ SelectionModel RenderTextWin::AdjacentWordSelectionModel(
 }
 
 void RenderTextWin::SetSelectionModel(const SelectionModel& model) {
+  const ui::Range old_selection = selection();
+  const size_t old_cursor_position = cursor_position();
   RenderText::SetSelectionModel(model);
   // TODO(xji): The styles are applied to text inside ItemizeLogicalText(). So,
   // we need to update layout here in order for the styles, such as selection
   // foreground, to be picked up. Eventually, we should separate styles from
   // layout by applying foreground, strike, and underline styles during
   // DrawVisualText as what RenderTextLinux does.
-  ResetLayout();
+  // Only a non-empty selection is styled, and the caret only outside insert
+  // mode, so the layout is kept when the change touches neither.
+  bool selection_style_changed = selection() != old_selection &&
+      !(selection().is_empty() && old_selection.is_empty());
+  bool caret_style_changed = !insert_mode() &&
+      cursor_position() != old_cursor_position;
+  if (selection_style_changed || caret_style_changed)
+    ResetLayout();
 }
 
 void RenderTextWin::GetGlyphBounds(size_t index,
@@ -21,7 +21,10 @@
 namespace appcache {
 
 static const int kBufferSize = 32768;
-static const size_t kMaxConcurrentUrlFetches = 2;
+// The socket pools allow six connections per host, and a SPDY session
+// multiplexes all requests to its server on one connection.
+static const size_t kMaxConcurrentUrlFetches = 6;
+static const size_t kMaxConcurrentSpdyUrlFetches = 16;
 static const int kMax503Retries = 3;
 
 // Helper class for collecting hosts per frontend when sending notifications
@@ -109,6 +112,10 @@ void AppCacheUpdateJob::URLFetcher::Start() {
   request_->set_first_party_for_cookies(job_->manifest_url_);
   request_->set_load_flags(request_->load_flags() |
                            net::LOAD_DISABLE_INTERCEPT);
+  // The manifest and the master entries decide whether the update goes
+  // ahead, so they go before the other entries.
+  if (fetch_type_ != URL_FETCH)
+    request_->set_priority(net::LOW);
   if (existing_response_headers_)
     AddConditionalHeaders(existing_response_headers_);
   request_->Start();
@@ -301,6 +308,7 @@ AppCacheUpdateJob::AppCacheUpdateJob(AppCacheService* service,
       internal_state_(FETCH_MANIFEST),
       master_entries_completed_(0),
       url_fetches_completed_(0),
+      max_concurrent_url_fetches_(kMaxConcurrentUrlFetches),
       manifest_fetcher_(NULL),
       stored_state_(UNSTORED) {
 }
@@ -445,6 +453,11 @@ void AppCacheUpdateJob::HandleManifestFetchCompleted(
     is_valid_response_code = (response_code / 100 == 2);
   }
 
+  // Entries mostly come from the manifest's server. If that speaks SPDY,
+  // more fetches at once don't cost more connections.
+  if (request->response_info().was_fetched_via_spdy)
+    max_concurrent_url_fetches_ = kMaxConcurrentSpdyUrlFetches;
+
   if (is_valid_response_code) {
     manifest_data_ = fetcher->manifest_data();
     manifest_response_info_.reset(
@@ -888,6 +901,19 @@ void AppCacheUpdateJob::BuildUrlFileList(const Manifest& manifest) {
     AddUrlToFileList(GURL(*it), AppCacheEntry::EXPLICIT);
   }
 
+  // Add all master entries from newest complete cache. They are fetched
+  // right after the explicit entries, ahead of the fallbacks and intercepts.
+  if (update_type_ == UPGRADE_ATTEMPT) {
+    const AppCache::EntryMap& entries =
+        group_->newest_complete_cache()->entries();
+    for (AppCache::EntryMap::const_iterator it = entries.begin();
+         it != entries.end(); ++it) {
+      const AppCacheEntry& entry = it->second;
+      if (entry.IsMaster())
+        AddUrlToFileList(it->first, AppCacheEntry::MASTER);
+    }
+  }
+
   const std::vector<Namespace>& intercepts =
       manifest.intercept_namespaces;
   for (std::vector<Namespace>::const_iterator it = intercepts.begin();
@@ -901,18 +927,6 @@ void AppCacheUpdateJob::BuildUrlFileList(const Manifest& manifest) {
        it != fallbacks.end(); ++it) {
      AddUrlToFileList(it->target_url, AppCacheEntry::FALLBACK);
   }
-
-  // Add all master entries from newest complete cache.
-  if (update_type_ == UPGRADE_ATTEMPT) {
-    const AppCache::EntryMap& entries =
-        group_->newest_complete_cache()->entries();
-    for (AppCache::EntryMap::const_iterator it = entries.begin();
-         it != entries.end(); ++it) {
-      const AppCacheEntry& entry = it->second;
-      if (entry.IsMaster())
-        AddUrlToFileList(it->first, AppCacheEntry::MASTER);
-    }
-  }
 }
 
 void AppCacheUpdateJob::AddUrlToFileList(const GURL& url, int type) {
@@ -931,7 +945,7 @@ void AppCacheUpdateJob::FetchUrls() {
   // Fetch each URL in the list according to section 6.9.4 step 17.1-17.3.
   // Fetch up to the concurrent limit. Other fetches will be triggered as each
   // each fetch completes.
-  while (pending_url_fetches_.size() < kMaxConcurrentUrlFetches &&
+  while (pending_url_fetches_.size() < max_concurrent_url_fetches_ &&
          !urls_to_fetch_.empty()) {
     UrlToFetch url_to_fetch = urls_to_fetch_.front();
     urls_to_fetch_.pop_front();
@@ -1049,7 +1063,7 @@ void AppCacheUpdateJob::FetchMasterEntries() {
 
   // Fetch each master entry in the list, up to the concurrent limit.
   // Additional fetches will be triggered as each fetch completes.
-  while (master_entry_fetches_.size() < kMaxConcurrentUrlFetches &&
+  while (master_entry_fetches_.size() < max_concurrent_url_fetches_ &&
          !master_entries_to_fetch_.empty()) {
     const GURL& url = *master_entries_to_fetch_.begin();
 
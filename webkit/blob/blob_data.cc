@@ -45,9 +45,9 @@ BlobData::Item::Item()
 
 BlobData::Item::~Item() {}
 
-BlobData::BlobData() {}
+BlobData::BlobData() : memory_usage_(0) {}
 
-BlobData::BlobData(const WebBlobData& data) {
+BlobData::BlobData(const WebBlobData& data) : memory_usage_(0) {
   size_t i = 0;
   WebBlobData::Item item;
   while (data.itemAt(i++, item)) {
@@ -89,6 +89,7 @@ class BLOB_EXPORT BlobData : public base::RefCounted<BlobData> {
     if (length > 0) {
       items_.push_back(Item());
       items_.back().SetToData(data, length);
+      memory_usage_ += length;
     }
   }
 
@@ -122,15 +123,9 @@ class BLOB_EXPORT BlobData : public base::RefCounted<BlobData> {
     content_disposition_ = content_disposition;
   }
 
-  int64 GetMemoryUsage() const {
-    int64 memory = 0;
-    for (std::vector<Item>::const_iterator iter = items_.begin();
-         iter != items_.end(); ++iter) {
-      if (iter->type == TYPE_DATA)
-        memory += iter->data.size();
-    }
-    return memory;
-  }
+  // Returns the size of the data items. It's kept as they are appended, as
+  // the controller asks for it on every append to a blob being built.
+  int64 GetMemoryUsage() const { return memory_usage_; }
 
  private:
   friend class base::RefCounted<BlobData>;
@@ -141,6 +136,7 @@ class BLOB_EXPORT BlobData : public base::RefCounted<BlobData> {
   std::string content_disposition_;
   std::vector<Item> items_;
   std::vector<scoped_refptr<ShareableFileReference> > shareable_files_;
+  int64 memory_usage_;
 
   DISALLOW_COPY_AND_ASSIGN(BlobData);
 };
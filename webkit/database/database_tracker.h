@@ -180,6 +180,8 @@ class DatabaseTracker
       PendingDeletionCallbacks;
   typedef std::map<string16, base::PlatformFile> FileHandlesMap;
   typedef std::map<string16, string16> OriginDirectoriesMap;
+  // Maps an (origin identifier, database name) pair to its database ID.
+  typedef std::map<std::pair<string16, string16>, int64> DatabaseIdMap;
 
   class CachedOriginInfo : public OriginInfo {
    public:
@@ -271,6 +273,11 @@ class DatabaseTracker
   scoped_ptr<sql::MetaTable> meta_table_;
   ObserverList<Observer, true> observers_;
   std::map<string16, CachedOriginInfo> origins_info_map_;
+
+  // The IDs of the databases looked up by GetFullDBFilePath(), which every
+  // file operation the renderers proxy through the VFS calls. An entry is
+  // removed when its database or origin is deleted.
+  DatabaseIdMap database_ids_;
   DatabaseConnections database_connections_;
 
   // The set of databases that should be deleted but are still opened
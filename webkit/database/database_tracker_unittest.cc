@@ -400,6 +400,7 @@ class DatabaseTracker_TestHelper_Test {
     EXPECT_TRUE(origin1_info);
     EXPECT_EQ(1, origin1_info->GetDatabaseSize(kDB1));
     EXPECT_EQ(0, origin1_info->GetDatabaseSize(kDB3));
+    EXPECT_EQ(FilePath(), tracker->GetFullDBFilePath(kOrigin1, kDB3));
 
     // Get all data for all origins
     std::vector<OriginInfo> origins_info;
@@ -0,0 +1,194 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "webkit/dom_storage/dom_storage_cached_area.h"
+
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/compiler_specific.h"
+#include "base/logging.h"
+#include "webkit/dom_storage/dom_storage_map.h"
+#include "webkit/dom_storage/dom_storage_proxy.h"
+#include "webkit/dom_storage/dom_storage_types.h"
+
+namespace dom_storage {
+
+DomStorageCachedArea::DomStorageCachedArea(
+    int64 namespace_id, const GURL& origin, DomStorageProxy* proxy)
+    : ignore_all_mutations_count_(0),
+      namespace_id_(namespace_id), origin_(origin),
+      proxy_(proxy), ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+DomStorageCachedArea::~DomStorageCachedArea() {
+}
+
+unsigned DomStorageCachedArea::GetLength(int connection_id) {
+  PrimeIfNeeded(connection_id);
+  return map_->Length();
+}
+
+NullableString16 DomStorageCachedArea::GetKey(
+    int connection_id, unsigned index) {
+  PrimeIfNeeded(connection_id);
+  return map_->Key(index);
+}
+
+NullableString16 DomStorageCachedArea::GetItem(
+    int connection_id, const string16& key) {
+  PrimeIfNeeded(connection_id);
+  return map_->GetItem(key);
+}
+
+bool DomStorageCachedArea::SetItem(
+    int connection_id, const string16& key,
+    const string16& value, const GURL& page_url,
+    NullableString16* old_value) {
+  PrimeIfNeeded(connection_id);
+  if (!map_->SetItem(key, value, old_value))
+    return false;
+
+  // Ignore mutations to |key| until OnSetItemComplete.
+  ignore_key_mutations_[key]++;
+  proxy_->SetItem(
+      connection_id, key, value, page_url,
+      base::Bind(&DomStorageCachedArea::OnSetItemComplete,
+                 weak_factory_.GetWeakPtr(), key));
+  return true;
+}
+
+bool DomStorageCachedArea::RemoveItem(
+    int connection_id, const string16& key, const GURL& page_url,
+    string16* old_value) {
+  PrimeIfNeeded(connection_id);
+  if (!map_->RemoveItem(key, old_value))
+    return false;
+
+  // Ignore mutations to |key| until OnRemoveItemComplete.
+  ignore_key_mutations_[key]++;
+  proxy_->RemoveItem(
+      connection_id, key, page_url,
+      base::Bind(&DomStorageCachedArea::OnRemoveItemComplete,
+                 weak_factory_.GetWeakPtr(), key));
+  return true;
+}
+
+bool DomStorageCachedArea::Clear(int connection_id, const GURL& page_url) {
+  PrimeIfNeeded(connection_id);
+  bool cleared_something = map_->Length() != 0;
+  map_ = new DomStorageMap(kPerAreaQuota);
+
+  // Ignore all mutations until OnClearComplete time.
+  ++ignore_all_mutations_count_;
+  proxy_->ClearArea(
+      connection_id, page_url,
+      base::Bind(&DomStorageCachedArea::OnClearComplete,
+                 weak_factory_.GetWeakPtr()));
+  return cleared_something;
+}
+
+void DomStorageCachedArea::ApplyMutation(
+    const NullableString16& key, const NullableString16& new_value) {
+  if (!map_ || ignore_all_mutations_count_ > 0)
+    return;
+
+  if (key.is_null()) {
+    // It's a clear event. Keep the local changes that are in flight, they
+    // reach the browser after the clear.
+    scoped_refptr<DomStorageMap> old = map_;
+    map_ = new DomStorageMap(kPerAreaQuota);
+    std::map<string16, int>::const_iterator it = ignore_key_mutations_.begin();
+    for (; it != ignore_key_mutations_.end(); ++it) {
+      NullableString16 value = old->GetItem(it->first);
+      if (!value.is_null()) {
+        NullableString16 unused;
+        map_->SetItem(it->first, value.string(), &unused);
+      }
+    }
+    return;
+  }
+
+  // Local changes in flight win over the mutation.
+  if (should_ignore_key_mutation(key.string()))
+    return;
+
+  if (new_value.is_null()) {
+    // It's a remove item event.
+    string16 unused;
+    map_->RemoveItem(key.string(), &unused);
+    return;
+  }
+
+  // It's a set item event. The browser allows areas that were over budget
+  // before quota was enforced, so don't check the quota here.
+  NullableString16 unused;
+  map_->set_quota(kint32max);
+  map_->SetItem(key.string(), new_value.string(), &unused);
+  map_->set_quota(kPerAreaQuota);
+}
+
+void DomStorageCachedArea::Prime(int connection_id) {
+  DCHECK(!map_);
+
+  // The values are retrieved synchronously, but mutation events that were
+  // sent before the values may still be queued. They are already reflected
+  // in the values, so ignore all mutations until OnLoadComplete time.
+  ++ignore_all_mutations_count_;
+  ValuesMap values;
+  proxy_->LoadArea(
+      connection_id, &values,
+      base::Bind(&DomStorageCachedArea::OnLoadComplete,
+                 weak_factory_.GetWeakPtr()));
+  map_ = new DomStorageMap(kPerAreaQuota);
+  map_->SwapValues(&values);
+}
+
+void DomStorageCachedArea::PrimeIfNeeded(int connection_id) {
+  if (!map_)
+    Prime(connection_id);
+}
+
+void DomStorageCachedArea::Reset() {
+  map_ = NULL;
+  weak_factory_.InvalidateWeakPtrs();
+  ignore_key_mutations_.clear();
+  ignore_all_mutations_count_ = 0;
+}
+
+void DomStorageCachedArea::OnLoadComplete(bool success) {
+  DCHECK_GT(ignore_all_mutations_count_, 0);
+  --ignore_all_mutations_count_;
+}
+
+void DomStorageCachedArea::OnSetItemComplete(const string16& key,
+                                             bool success) {
+  if (!success) {
+    // The browser refused the change, so the cache no longer matches it.
+    // Drop the cache and prime it again on next use.
+    Reset();
+    return;
+  }
+  OnKeyMutationComplete(key);
+}
+
+void DomStorageCachedArea::OnRemoveItemComplete(const string16& key,
+                                                bool success) {
+  DCHECK(success);
+  OnKeyMutationComplete(key);
+}
+
+void DomStorageCachedArea::OnClearComplete(bool success) {
+  DCHECK(success);
+  DCHECK_GT(ignore_all_mutations_count_, 0);
+  --ignore_all_mutations_count_;
+}
+
+void DomStorageCachedArea::OnKeyMutationComplete(const string16& key) {
+  std::map<string16, int>::iterator found = ignore_key_mutations_.find(key);
+  DCHECK(found != ignore_key_mutations_.end());
+  if (--found->second == 0)
+    ignore_key_mutations_.erase(found);
+}
+
+}  // namespace dom_storage
@@ -0,0 +1,214 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <list>
+
+#include "base/bind.h"
+#include "base/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/dom_storage/dom_storage_cached_area.h"
+#include "webkit/dom_storage/dom_storage_proxy.h"
+
+namespace dom_storage {
+
+namespace {
+
+// A proxy that records the operations it is asked to do and holds on to
+// their callbacks until the test completes them.
+class MockProxy : public DomStorageProxy {
+ public:
+  MockProxy() : load_count_(0), set_count_(0), remove_count_(0),
+                clear_count_(0) {}
+
+  virtual void LoadArea(int connection_id, ValuesMap* values,
+                        const CompletionCallback& callback) OVERRIDE {
+    ++load_count_;
+    *values = load_area_return_values_;
+    pending_callbacks_.push_back(callback);
+  }
+
+  virtual void SetItem(int connection_id, const string16& key,
+                       const string16& value, const GURL& page_url,
+                       const CompletionCallback& callback) OVERRIDE {
+    ++set_count_;
+    observed_key_ = key;
+    observed_value_ = value;
+    pending_callbacks_.push_back(callback);
+  }
+
+  virtual void RemoveItem(int connection_id, const string16& key,
+                          const GURL& page_url,
+                          const CompletionCallback& callback) OVERRIDE {
+    ++remove_count_;
+    observed_key_ = key;
+    pending_callbacks_.push_back(callback);
+  }
+
+  virtual void ClearArea(int connection_id, const GURL& page_url,
+                         const CompletionCallback& callback) OVERRIDE {
+    ++clear_count_;
+    pending_callbacks_.push_back(callback);
+  }
+
+  // Runs the oldest pending callback with |success|.
+  void CompleteOnePendingCallback(bool success) {
+    ASSERT_FALSE(pending_callbacks_.empty());
+    CompletionCallback callback = pending_callbacks_.front();
+    pending_callbacks_.pop_front();
+    callback.Run(success);
+  }
+
+  void CompleteAllPendingCallbacks() {
+    while (!pending_callbacks_.empty())
+      CompleteOnePendingCallback(true);
+  }
+
+  ValuesMap load_area_return_values_;
+  std::list<CompletionCallback> pending_callbacks_;
+  int load_count_;
+  int set_count_;
+  int remove_count_;
+  int clear_count_;
+  string16 observed_key_;
+  string16 observed_value_;
+
+ private:
+  virtual ~MockProxy() {}
+};
+
+}  // namespace
+
+class DomStorageCachedAreaTest : public testing::Test {
+ public:
+  DomStorageCachedAreaTest()
+    : kNamespaceId(10),
+      kOrigin("http://dom_storage/"),
+      kKey(ASCIIToUTF16("key")),
+      kValue(ASCIIToUTF16("value")),
+      kValue2(ASCIIToUTF16("value2")),
+      kPageUrl("http://dom_storage/page"),
+      mock_proxy_(new MockProxy()) {
+    mock_proxy_->load_area_return_values_[kKey] =
+        NullableString16(kValue, false);
+  }
+
+  const int64 kNamespaceId;
+  const GURL kOrigin;
+  const string16 kKey;
+  const string16 kValue;
+  const string16 kValue2;
+  const GURL kPageUrl;
+
+ protected:
+  scoped_refptr<MockProxy> mock_proxy_;
+};
+
+TEST_F(DomStorageCachedAreaTest, PrimesOnceAndReadsLocally) {
+  const int kConnectionId = 1;
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+  EXPECT_EQ(kNamespaceId, cached_area->namespace_id());
+  EXPECT_EQ(kOrigin, cached_area->origin());
+  EXPECT_EQ(0, mock_proxy_->load_count_);
+
+  EXPECT_EQ(1u, cached_area->GetLength(kConnectionId));
+  EXPECT_EQ(kKey, cached_area->GetKey(kConnectionId, 0).string());
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+  EXPECT_TRUE(cached_area->GetKey(kConnectionId, 1).is_null());
+  EXPECT_EQ(1, mock_proxy_->load_count_);
+  mock_proxy_->CompleteAllPendingCallbacks();
+}
+
+TEST_F(DomStorageCachedAreaTest, WritesThrough) {
+  const int kConnectionId = 1;
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+
+  NullableString16 old_value;
+  EXPECT_TRUE(cached_area->SetItem(kConnectionId, kKey, kValue2, kPageUrl,
+                                   &old_value));
+  EXPECT_EQ(kValue, old_value.string());
+  EXPECT_EQ(1, mock_proxy_->set_count_);
+  EXPECT_EQ(kKey, mock_proxy_->observed_key_);
+  EXPECT_EQ(kValue2, mock_proxy_->observed_value_);
+  EXPECT_EQ(kValue2, cached_area->GetItem(kConnectionId, kKey).string());
+
+  string16 old_string;
+  EXPECT_TRUE(cached_area->RemoveItem(kConnectionId, kKey, kPageUrl,
+                                      &old_string));
+  EXPECT_EQ(kValue2, old_string);
+  EXPECT_EQ(1, mock_proxy_->remove_count_);
+  EXPECT_FALSE(cached_area->RemoveItem(kConnectionId, kKey, kPageUrl,
+                                       &old_string));
+  EXPECT_EQ(1, mock_proxy_->remove_count_);
+
+  EXPECT_FALSE(cached_area->Clear(kConnectionId, kPageUrl));
+  EXPECT_EQ(1, mock_proxy_->clear_count_);
+  EXPECT_EQ(1, mock_proxy_->load_count_);
+  mock_proxy_->CompleteAllPendingCallbacks();
+}
+
+TEST_F(DomStorageCachedAreaTest, ApplyMutation) {
+  const int kConnectionId = 1;
+  const string16 kOtherKey(ASCIIToUTF16("other"));
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+
+  // Mutations are ignored until the cache is primed and the load has
+  // completed, as the loaded values already reflect them.
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(kValue2, false));
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(kValue2, false));
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+  mock_proxy_->CompleteOnePendingCallback(true);
+
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(kValue2, false));
+  EXPECT_EQ(kValue2, cached_area->GetItem(kConnectionId, kKey).string());
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(true));
+  EXPECT_TRUE(cached_area->GetItem(kConnectionId, kKey).is_null());
+
+  // Mutations of a key with a local change in flight are ignored.
+  NullableString16 old_value;
+  EXPECT_TRUE(cached_area->SetItem(kConnectionId, kKey, kValue, kPageUrl,
+                                   &old_value));
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(kValue2, false));
+  cached_area->ApplyMutation(NullableString16(kOtherKey, false),
+                             NullableString16(kValue2, false));
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+  EXPECT_EQ(kValue2, cached_area->GetItem(kConnectionId, kOtherKey).string());
+
+  // A clear from elsewhere keeps the local change in flight.
+  cached_area->ApplyMutation(NullableString16(true), NullableString16(true));
+  EXPECT_EQ(1u, cached_area->GetLength(kConnectionId));
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+  mock_proxy_->CompleteOnePendingCallback(true);
+
+  cached_area->ApplyMutation(NullableString16(kKey, false),
+                             NullableString16(kValue2, false));
+  EXPECT_EQ(kValue2, cached_area->GetItem(kConnectionId, kKey).string());
+}
+
+TEST_F(DomStorageCachedAreaTest, FailedSetItemResetsCache) {
+  const int kConnectionId = 1;
+  scoped_refptr<DomStorageCachedArea> cached_area =
+      new DomStorageCachedArea(kNamespaceId, kOrigin, mock_proxy_);
+
+  NullableString16 old_value;
+  EXPECT_TRUE(cached_area->SetItem(kConnectionId, kKey, kValue2, kPageUrl,
+                                   &old_value));
+  mock_proxy_->CompleteOnePendingCallback(true);  // The load.
+  mock_proxy_->CompleteOnePendingCallback(false);  // The set.
+
+  // The cache is primed again with what the browser has.
+  EXPECT_EQ(kValue, cached_area->GetItem(kConnectionId, kKey).string());
+  EXPECT_EQ(2, mock_proxy_->load_count_);
+  mock_proxy_->CompleteAllPendingCallbacks();
+}
+
+}  // namespace dom_storage
@@ -93,6 +93,11 @@ void DomStorageContext::DeleteOrigin(const GURL& origin) {
   DCHECK(!is_shutdown_);
   DomStorageNamespace* local = GetStorageNamespace(kLocalStorageNamespaceId);
   local->DeleteOrigin(origin);
+  // Renderers cache the values of the areas they have open, let them
+  // know the data is gone.
+  DomStorageArea* area = local->GetOpenStorageArea(origin);
+  if (area)
+    NotifyAreaCleared(area, GURL());
 }
 
 void DomStorageContext::DeleteDataModifiedSince(const base::Time& cutoff) {
@@ -105,8 +105,8 @@ bool DomStorageDatabase::CommitChanges(bool clear_all_first,
   ValuesMap::const_iterator it = changes.begin();
   for(; it != changes.end(); ++it) {
     sql::Statement statement;
-    string16 key = it->first;
-    NullableString16 value = it->second;
+    const string16& key = it->first;
+    const NullableString16& value = it->second;
     if (value.is_null()) {
       statement.Assign(db_->GetCachedStatement(SQL_FROM_HERE,
          "DELETE FROM ItemTable WHERE key=?"));
@@ -64,7 +64,7 @@ NullableString16 DomStorageMap::GetItem(const string16& key) const {
 bool DomStorageMap::SetItem(
     const string16& key, const string16& value,
     NullableString16* old_value) {
-  ValuesMap::const_iterator found = values_.find(key);
+  ValuesMap::iterator found = values_.find(key);
   if (found == values_.end())
     *old_value = NullableString16(true);
   else
@@ -80,8 +80,15 @@ bool DomStorageMap::SetItem(
   if (new_item_size > old_item_size && new_bytes_used > quota_)
     return false;
 
-  values_[key] = NullableString16(value, false);
-  ResetKeyIterator();
+  if (found == values_.end()) {
+    values_[key] = NullableString16(value, false);
+    ResetKeyIterator();
+  } else {
+    // Replacing a value leaves the order of the keys alone, so the key
+    // iterator stays valid. Keeping it lets a script that walks the keys
+    // and updates each value run in linear time.
+    found->second = NullableString16(value, false);
+  }
   bytes_used_ = new_bytes_used;
   return true;
 }
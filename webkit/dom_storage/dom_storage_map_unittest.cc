@@ -82,6 +82,38 @@ TEST(DomStorageMapTest, DomStorageMapBasics) {
   EXPECT_EQ(0u, map->bytes_used());
 }
 
+TEST(DomStorageMapTest, KeysAfterUpdates) {
+  const string16 kKeyA(ASCIIToUTF16("a"));
+  const string16 kKeyAA(ASCIIToUTF16("aa"));
+  const string16 kKeyB(ASCIIToUTF16("b"));
+  const string16 kKeyC(ASCIIToUTF16("c"));
+  const string16 kValue(ASCIIToUTF16("value"));
+  const string16 kValue2(ASCIIToUTF16("value2"));
+
+  scoped_refptr<DomStorageMap> map(new DomStorageMap(1024));
+  NullableString16 old_value;
+  EXPECT_TRUE(map->SetItem(kKeyA, kValue, &old_value));
+  EXPECT_TRUE(map->SetItem(kKeyB, kValue, &old_value));
+  EXPECT_TRUE(map->SetItem(kKeyC, kValue, &old_value));
+
+  // Updating a value while walking the keys.
+  EXPECT_EQ(kKeyB, map->Key(1).string());
+  EXPECT_TRUE(map->SetItem(kKeyB, kValue2, &old_value));
+  EXPECT_EQ(kValue, old_value.string());
+  EXPECT_EQ(kKeyC, map->Key(2).string());
+  EXPECT_EQ(kKeyA, map->Key(0).string());
+  EXPECT_EQ(kValue2, map->GetItem(kKeyB).string());
+
+  // Adding a key moves the ones after it.
+  EXPECT_EQ(kKeyC, map->Key(2).string());
+  EXPECT_TRUE(map->SetItem(kKeyAA, kValue, &old_value));
+  EXPECT_TRUE(old_value.is_null());
+  EXPECT_EQ(4u, map->Length());
+  EXPECT_EQ(kKeyB, map->Key(2).string());
+  EXPECT_EQ(kKeyAA, map->Key(1).string());
+  EXPECT_EQ(kKeyC, map->Key(3).string());
+}
+
 TEST(DomStorageMapTest, EnforcesQuota) {
   const string16 kKey = ASCIIToUTF16("test_key");
   const string16 kValue = ASCIIToUTF16("test_value");
@@ -51,6 +51,13 @@ void DomStorageNamespace::CloseStorageArea(DomStorageArea* area) {
   // The in-process-webkit based impl didn't do this either, but would be nice.
 }
 
+DomStorageArea* DomStorageNamespace::GetOpenStorageArea(const GURL& origin) {
+  AreaHolder* holder = GetAreaHolder(origin);
+  if (holder && holder->open_count_)
+    return holder->area_;
+  return NULL;
+}
+
 DomStorageNamespace* DomStorageNamespace::Clone(int64 clone_namespace_id) {
   DCHECK_NE(kLocalStorageNamespaceId, namespace_id_);
   DCHECK_NE(kLocalStorageNamespaceId, clone_namespace_id);
@@ -0,0 +1,49 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef WEBKIT_DOM_STORAGE_DOM_STORAGE_PROXY_H_
+#define WEBKIT_DOM_STORAGE_DOM_STORAGE_PROXY_H_
+#pragma once
+
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/string16.h"
+#include "googleurl/src/gurl.h"
+#include "webkit/dom_storage/dom_storage_types.h"
+
+namespace dom_storage {
+
+// Abstract interface for the communication between a DomStorageCachedArea
+// in the renderer and the DomStorageArea it caches in the browser.
+// Each completion callback runs once the browser has applied the operation,
+// in the order the operations were issued.
+class DomStorageProxy : public base::RefCounted<DomStorageProxy> {
+ public:
+  typedef base::Callback<void(bool)> CompletionCallback;
+
+  // Synchronously retrieves the values of the area into |values|.
+  // |callback| runs when the mutation events that were in flight when the
+  // values were retrieved have been delivered.
+  virtual void LoadArea(int connection_id, ValuesMap* values,
+                        const CompletionCallback& callback) = 0;
+
+  virtual void SetItem(int connection_id, const string16& key,
+                       const string16& value, const GURL& page_url,
+                       const CompletionCallback& callback) = 0;
+
+  virtual void RemoveItem(int connection_id, const string16& key,
+                          const GURL& page_url,
+                          const CompletionCallback& callback) = 0;
+
+  virtual void ClearArea(int connection_id, const GURL& page_url,
+                         const CompletionCallback& callback) = 0;
+
+ protected:
+  friend class base::RefCounted<DomStorageProxy>;
+  virtual ~DomStorageProxy() {}
+};
+
+}  // namespace dom_storage
+
+#endif  // WEBKIT_DOM_STORAGE_DOM_STORAGE_PROXY_H_
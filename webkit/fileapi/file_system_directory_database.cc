@@ -71,6 +71,7 @@ const char kLastFileIdKey[] = "LAST_FILE_ID";
 const char kLastIntegerKey[] = "LAST_INTEGER";
 const int64 kMinimumReportIntervalHours = 1;
 const char kInitStatusHistogramLabel[] = "FileSystem.DirectoryDatabaseInit";
+const size_t kMaxChildIdCacheSize = 1024;
 
 enum InitStatus {
   INIT_STATUS_OK = 0,
@@ -392,6 +393,12 @@ bool FileSystemDirectoryDatabase::GetChildWithName(
     return false;
   DCHECK(child_id);
   std::string child_key = GetChildLookupKey(parent_id, name);
+  std::map<std::string, FileId>::const_iterator cached =
+      child_id_cache_.find(child_key);
+  if (cached != child_id_cache_.end()) {
+    *child_id = cached->second;
+    return true;
+  }
   std::string child_id_string;
   leveldb::Status status =
       db_->Get(leveldb::ReadOptions(), child_key, &child_id_string);
@@ -402,6 +409,9 @@ bool FileSystemDirectoryDatabase::GetChildWithName(
       LOG(ERROR) << "Hit database corruption!";
       return false;
     }
+    if (child_id_cache_.size() >= kMaxChildIdCacheSize)
+      child_id_cache_.clear();
+    child_id_cache_[child_key] = *child_id;
     return true;
   }
   HandleError(FROM_HERE, status);
@@ -843,27 +853,32 @@ bool FileSystemDirectoryDatabase::RemoveFileInfoHelper(
   FileInfo info;
   if (!GetFileInfo(file_id, &info))
     return false;
-  if (info.data_path.empty()) {  // It's a directory
-    std::vector<FileId> children;
-    // TODO(ericu): Make a faster is-the-directory-empty check.
-    if (!ListChildren(file_id, &children))
-      return false;
-    if (children.size()) {
-      LOG(ERROR) << "Can't remove a directory with children.";
-      return false;
-    }
+  if (info.data_path.empty() && !IsDirectoryEmpty(file_id)) {
+    LOG(ERROR) << "Can't remove a directory with children.";
+    return false;
   }
-  batch->Delete(GetChildLookupKey(info.parent_id, info.name));
+  std::string child_key = GetChildLookupKey(info.parent_id, info.name);
+  child_id_cache_.erase(child_key);
+  batch->Delete(child_key);
   batch->Delete(GetFileLookupKey(file_id));
   return true;
 }
 
+bool FileSystemDirectoryDatabase::IsDirectoryEmpty(FileId file_id) {
+  std::string child_key_prefix = GetChildListingKeyPrefix(file_id);
+  scoped_ptr<leveldb::Iterator> iter(db_->NewIterator(leveldb::ReadOptions()));
+  iter->Seek(child_key_prefix);
+  return !iter->Valid() ||
+      !StartsWithASCII(iter->key().ToString(), child_key_prefix, true);
+}
+
 void FileSystemDirectoryDatabase::HandleError(
     const tracked_objects::Location& from_here,
     const leveldb::Status& status) {
   LOG(ERROR) << "FileSystemDirectoryDatabase failed at: "
              << from_here.ToString() << " with error: " << status.ToString();
   db_.reset();
+  child_id_cache_.clear();
 }
 
 }  // namespace fileapi
@@ -5,6 +5,7 @@
 #ifndef WEBKIT_FILEAPI_FILE_SYSTEM_DIRECTORY_DATABASE_H_
 #define WEBKIT_FILEAPI_FILE_SYSTEM_DIRECTORY_DATABASE_H_
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -104,6 +105,7 @@ class FileSystemDirectoryDatabase {
   bool StoreDefaultValues();
   bool GetLastFileId(FileId* file_id);
   bool VerifyIsDirectory(FileId file_id);
+  bool IsDirectoryEmpty(FileId file_id);
   bool AddFileInfoHelper(
       const FileInfo& info, FileId file_id, leveldb::WriteBatch* batch);
   bool RemoveFileInfoHelper(FileId file_id, leveldb::WriteBatch* batch);
@@ -113,6 +115,12 @@ class FileSystemDirectoryDatabase {
   FilePath filesystem_data_directory_;
   scoped_ptr<leveldb::DB> db_;
   base::Time last_reported_time_;
+
+  // Maps child lookup keys to FileIds, so that resolving the paths of a
+  // tree walked by a copy or move doesn't read every component from the
+  // database again. An entry is dropped when its file is removed, moved or
+  // renamed, and the whole cache when the database is closed on an error.
+  std::map<std::string, FileId> child_id_cache_;
   DISALLOW_COPY_AND_ASSIGN(FileSystemDirectoryDatabase);
 };
 
@@ -283,6 +283,39 @@ TEST_F(FileSystemDirectoryDatabaseTest, TestGetChildWithName) {
   EXPECT_EQ(file_id1, check_file_id);
 }
 
+TEST_F(FileSystemDirectoryDatabaseTest, TestGetChildWithNameAfterChanges) {
+  FileInfo info;
+  FileId dir_id;
+  FileId file_id;
+  FilePath::StringType dir_name = FILE_PATH_LITERAL("dir");
+  FilePath::StringType name0 = FILE_PATH_LITERAL("foo");
+  FilePath::StringType name1 = FILE_PATH_LITERAL("bar");
+  info.parent_id = 0;
+  info.name = dir_name;
+  EXPECT_TRUE(db()->AddFileInfo(info, &dir_id));
+  info.parent_id = dir_id;
+  info.name = name0;
+  info.data_path = FilePath(FILE_PATH_LITERAL("fake data path"));
+  EXPECT_TRUE(db()->AddFileInfo(info, &file_id));
+
+  // Looked up once, so later lookups may be answered from memory.
+  FileId check_file_id;
+  EXPECT_TRUE(db()->GetChildWithName(dir_id, name0, &check_file_id));
+  EXPECT_EQ(file_id, check_file_id);
+
+  info.name = name1;
+  EXPECT_TRUE(db()->UpdateFileInfo(file_id, info));
+  EXPECT_FALSE(db()->GetChildWithName(dir_id, name0, &check_file_id));
+  EXPECT_TRUE(db()->GetChildWithName(dir_id, name1, &check_file_id));
+  EXPECT_EQ(file_id, check_file_id);
+
+  EXPECT_FALSE(db()->RemoveFileInfo(dir_id));
+  EXPECT_TRUE(db()->RemoveFileInfo(file_id));
+  EXPECT_FALSE(db()->GetChildWithName(dir_id, name1, &check_file_id));
+  EXPECT_TRUE(db()->RemoveFileInfo(dir_id));
+  EXPECT_FALSE(db()->GetChildWithName(0, dir_name, &check_file_id));
+}
+
 TEST_F(FileSystemDirectoryDatabaseTest, TestGetFileWithPath) {
   FileInfo info;
   FileId file_id0;
@@ -59,24 +59,32 @@ FtpDirectoryListingResponseDelegate::FtpDirectoryListingResponseDelegate(
     WebURLLoader* loader,
     const WebURLResponse& response)
     : client_(client),
-      loader_(loader) {
+      loader_(loader),
+      parser_(base::Time::Now()) {
   Init(response.url());
 }
 
 void FtpDirectoryListingResponseDelegate::OnReceivedData(const char* data,
                                                          int data_len) {
-  buffer_.append(data, data_len);
+  std::vector<FtpDirectoryListingEntry> entries;
+  parser_.Append(data, data_len, &entries);
+  SendEntriesToClient(entries);
 }
 
 void FtpDirectoryListingResponseDelegate::OnCompletedRequest() {
   std::vector<FtpDirectoryListingEntry> entries;
-  int rv = net::ParseFtpDirectoryListing(buffer_, base::Time::Now(), &entries);
+  int rv = parser_.Finish(&entries);
   if (rv != net::OK) {
     SendDataToClient("<script>onListingParsingError();</script>\n");
     return;
   }
+  SendEntriesToClient(entries);
+}
+
+void FtpDirectoryListingResponseDelegate::SendEntriesToClient(
+    const std::vector<FtpDirectoryListingEntry>& entries) {
   for (size_t i = 0; i < entries.size(); i++) {
-    FtpDirectoryListingEntry entry = entries[i];
+    const FtpDirectoryListingEntry& entry = entries[i];
 
     // Skip the current and parent directory entries in the listing. Our header
     // always includes them.
@@ -9,8 +9,10 @@
 #define WEBKIT_GLUE_FTP_DIRECTORY_LISTING_RESPONSE_DELEGATE_H_
 
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "net/ftp/ftp_directory_listing_parser.h"
 #include "third_party/WebKit/Source/WebKit/chromium/public/platform/WebURLResponse.h"
 
 namespace WebKit {
@@ -35,6 +37,9 @@ class FtpDirectoryListingResponseDelegate {
  private:
   void Init(const GURL& response_url);
 
+  void SendEntriesToClient(
+      const std::vector<net::FtpDirectoryListingEntry>& entries);
+
   void SendDataToClient(const std::string& data);
 
   // Pointers to the client and associated loader so we can make callbacks as
@@ -42,8 +47,8 @@ class FtpDirectoryListingResponseDelegate {
   WebKit::WebURLLoaderClient* client_;
   WebKit::WebURLLoader* loader_;
 
-  // Buffer for data received from the network.
-  std::string buffer_;
+  // Parses the listing as it is received from the network.
+  net::FtpDirectoryListingStreamParser parser_;
 
   DISALLOW_COPY_AND_ASSIGN(FtpDirectoryListingResponseDelegate);
 };
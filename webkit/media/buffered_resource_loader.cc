@@ -45,10 +45,11 @@ static const int kMinBufferCapacity = 2 * kMegabyte;
 // 20MB is an arbitrary limit; it just seems to be "good enough" in practice.
 static const int kMaxBufferCapacity = 20 * kMegabyte;
 
-// Maximum number of bytes outside the buffer we will wait for in order to
-// fulfill a read. If a read starts more than 2MB away from the data we
-// currently have in the buffer, we will not wait for buffer to reach the read's
-// location and will instead reset the request.
+// Minimum number of bytes outside the buffer we will wait for in order to
+// fulfill a read. If a read starts further away from the data we currently
+// have in the buffer than this or the forward capacity of the buffer, we will
+// not wait for buffer to reach the read's location and will instead reset the
+// request.
 static const int kForwardWaitThreshold = 2 * kMegabyte;
 
 // Computes the suggested backward and forward capacity for the buffer
@@ -674,8 +675,12 @@ bool BufferedResourceLoader::WillFulfillRead() const {
   if (first_offset_ < 0 && (first_offset_ + buffer_->backward_bytes()) < 0)
     return false;
 
-  // Trying to read too far ahead.
-  if ((first_offset_ - buffer_->forward_bytes()) >= kForwardWaitThreshold)
+  // Trying to read too far ahead. Data within the forward capacity, which
+  // follows the bitrate, would be downloaded soon anyway, so waiting for it is
+  // cheaper than restarting the request.
+  int forward_wait_threshold =
+      std::max(kForwardWaitThreshold, buffer_->forward_capacity());
+  if ((first_offset_ - buffer_->forward_bytes()) >= forward_wait_threshold)
     return false;
 
   // The resource request has completed, there's no way we can fulfill the
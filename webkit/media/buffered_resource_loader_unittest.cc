@@ -24,6 +24,7 @@
 #include "webkit/mocks/mock_webframeclient.h"
 #include "webkit/mocks/mock_weburlloader.h"
 
+using ::testing::_;
 using ::testing::InSequence;
 using ::testing::Return;
 using ::testing::Truly;
@@ -985,6 +986,28 @@ TEST_F(BufferedResourceLoaderTest, Tricky_ReadPastThreshold) {
   StopWhenLoad();
 }
 
+TEST_F(BufferedResourceLoaderTest, Tricky_ReadPastThresholdWithinCapacity) {
+  const int kSize = 20 * 1024 * 1024;
+  const int kThreshold = 2 * 1024 * 1024;
+
+  Initialize(kHttpUrl, 10, kSize);
+  Start();
+  PartialResponse(10, kSize - 1, kSize);
+
+  // A high bitrate grows the forward capacity past the wait threshold.
+  loader_->SetBitrate(8 * 1024 * 1024 * 8);  // 8 Mbps.
+  ConfirmLoaderBufferForwardCapacity(20 * 1024 * 1024);
+
+  // Read past the forward wait threshold but within the forward capacity: the
+  // loader waits for the data instead of reporting a cache miss.
+  uint8 buffer[10];
+  EXPECT_CALL(*this, ReadCallback(_, _)).Times(0);
+  ReadLoader(kThreshold + 20, 10, buffer);
+  ConfirmLoaderDeferredState(false);
+
+  StopWhenLoad();
+}
+
 TEST_F(BufferedResourceLoaderTest, HasSingleOrigin) {
   // Make sure no redirect case works as expected.
   Initialize(kHttpUrl, -1, -1);
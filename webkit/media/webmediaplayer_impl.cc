@@ -684,7 +684,14 @@ bool WebMediaPlayerImpl::sourceAppend(const WebKit::WebString& id,
                                       const unsigned char* data,
                                       unsigned length) {
   DCHECK_EQ(main_loop_, MessageLoop::current());
-  return proxy_->DemuxerAppend(id.utf8().data(), data, length);
+  media::ChunkDemuxer::AppendStatus status =
+      proxy_->DemuxerAppend(id.utf8().data(), data, length);
+  // TODO(agent): WebMediaPlayer::sourceAppend() only returns a bool, which
+  // WebKit turns into INVALID_STATE_ERR. Pass kAppendQuotaExceeded up once the
+  // API can report it, so that it becomes QUOTA_EXCEEDED_ERR.
+  DVLOG_IF(1, status == media::ChunkDemuxer::kAppendQuotaExceeded)
+      << "sourceAppend(): the media data queue is full";
+  return status == media::ChunkDemuxer::kAppendOk;
 }
 
 bool WebMediaPlayerImpl::sourceAbort(const WebKit::WebString& id) {
@@ -210,9 +210,10 @@ bool WebMediaPlayerProxy::DemuxerBufferedRange(
   return chunk_demuxer_->GetBufferedRanges(id, ranges_out);
 }
 
-bool WebMediaPlayerProxy::DemuxerAppend(const std::string& id,
-                                        const uint8* data,
-                                        size_t length) {
+media::ChunkDemuxer::AppendStatus WebMediaPlayerProxy::DemuxerAppend(
+    const std::string& id,
+    const uint8* data,
+    size_t length) {
   return chunk_demuxer_->AppendData(id, data, length);
 }
 
@@ -97,7 +97,9 @@ class WebMediaPlayerProxy
   void DemuxerRemoveId(const std::string& id);
   bool DemuxerBufferedRange(const std::string& id,
                             media::ChunkDemuxer::Ranges* ranges_out);
-  bool DemuxerAppend(const std::string& id, const uint8* data, size_t length);
+  media::ChunkDemuxer::AppendStatus DemuxerAppend(const std::string& id,
+                                                  const uint8* data,
+                                                  size_t length);
   void DemuxerAbort(const std::string& id);
   void DemuxerEndOfStream(media::PipelineStatus status);
   void DemuxerShutdown();
@@ -129,6 +129,10 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   HostSet cached_hosts_;
   HostUsageMap cached_usage_;
 
+  // The sum of the usage of each host's origins in |cached_usage_|, kept
+  // up to date so that host usage is looked up rather than summed.
+  std::map<std::string, int64> cached_host_usage_;
+
   GatherGlobalUsageTask* global_usage_task_;
   GlobalUsageCallbackQueue global_usage_callback_;
   std::map<std::string, GatherHostUsageTask*> host_usage_tasks_;